@@ -20,9 +20,11 @@
 
 // Qt includes
 #include <QList>
+#include <QMap>
 #include <QSettings>
 #include <QSplashScreen>
 #include <QString>
+#include <QTime>
 #include <QTimer>
 
 // Slicer includes
@@ -48,6 +50,7 @@
 #include "qSlicerCommandOptions.h"
 #include "qSlicerModuleFactoryManager.h"
 #include "qSlicerModuleManager.h"
+#include "qSlicerStartupTracer.h"
 #include "qSlicerStyle.h"
 
 // ITK includes
@@ -90,11 +93,34 @@ void splashMessage(QScopedPointer<QSplashScreen>& splashScreen, const QString& m
   //splashScreen->repaint();
 }
 
+//----------------------------------------------------------------------------
+void printModuleTimings(qSlicerModuleFactoryManager* moduleFactoryManager)
+{
+  // Slowest modules first
+  QMultiMap<int, QString> modulesByTime;
+  foreach(const QString& name, moduleFactoryManager->loadedModuleNames())
+    {
+    modulesByTime.insert(
+      -(moduleFactoryManager->moduleInstantiationTime(name) +
+        moduleFactoryManager->moduleLoadTime(name)), name);
+    }
+  qDebug() << "Module timings (instantiation + load, in ms):";
+  QMultiMap<int, QString>::const_iterator it;
+  for (it = modulesByTime.constBegin(); it != modulesByTime.constEnd(); ++it)
+    {
+    qDebug() << " " << it.value() << ":"
+             << moduleFactoryManager->moduleInstantiationTime(it.value()) << "+"
+             << moduleFactoryManager->moduleLoadTime(it.value());
+    }
+}
+
 //----------------------------------------------------------------------------
 int SlicerAppMain(int argc, char* argv[])
 {
 #if ITK_VERSION_MAJOR > 3
+  qSlicerStartupTracer::instance()->beginEvent("ITK factory registration", "itk");
   itk::itkFactoryRegistration(); 
+  qSlicerStartupTracer::instance()->endEvent();
 #endif
   
   QCoreApplication::setApplicationName("Slicer");
@@ -141,37 +167,66 @@ int SlicerAppMain(int argc, char* argv[])
   moduleFactoryManager->addSearchPaths(app.commandOptions()->additonalModulePaths());
   qSlicerApplicationHelper::setupModuleFactoryManager(moduleFactoryManager);
 
+  bool printTimings = app.commandOptions()->verboseModuleDiscovery();
+  QTime stageTime;
+
   // Register and instantiate modules
   splashMessage(splashScreen, "Registering modules...");
+  stageTime.start();
+  qSlicerStartupTracer::instance()->beginEvent("Register modules", "modules");
   moduleFactoryManager->registerModules();
+  qSlicerStartupTracer::instance()->endEvent();
   qDebug() << "Number of registered modules:"
            << moduleFactoryManager->registeredModuleNames().count();
+  if (printTimings)
+    {
+    qDebug() << "Modules registered in" << stageTime.elapsed() << "ms";
+    }
   splashMessage(splashScreen, "Instantiating modules...");
+  stageTime.restart();
+  qSlicerStartupTracer::instance()->beginEvent("Instantiate modules", "modules");
   moduleFactoryManager->instantiateModules();
+  qSlicerStartupTracer::instance()->endEvent();
   qDebug() << "Number of instantiated modules:"
            << moduleFactoryManager->instantiatedModuleNames().count();
+  if (printTimings)
+    {
+    qDebug() << "Modules instantiated in" << stageTime.elapsed() << "ms";
+    }
   // Create main window
   splashMessage(splashScreen, "Initializing user interface...");
   QScopedPointer<qSlicerAppMainWindow> window;
   if (enableMainWindow)
     {
+    qSlicerStartupTracer::Scope traceScope("Create main window", "ui");
     window.reset(new qSlicerAppMainWindow);
     window->setWindowTitle(window->windowTitle()+ " " + Slicer_VERSION_FULL);
     }
 
   // Load all available modules
+  // The module widgets are created when the modules are first shown in the
+  // module panel, not here.
+  stageTime.restart();
+  qSlicerStartupTracer::instance()->beginEvent("Load modules", "modules");
   foreach(const QString& name, moduleFactoryManager->instantiatedModuleNames())
     {
     Q_ASSERT(!name.isNull());
     splashMessage(splashScreen, "Loading module \"" + name + "\"...");
     moduleFactoryManager->loadModule(name);
     }
+  qSlicerStartupTracer::instance()->endEvent();
   qDebug() << "Number of loaded modules:" << moduleManager->modulesNames().count();
+  if (printTimings)
+    {
+    qDebug() << "Modules loaded in" << stageTime.elapsed() << "ms";
+    printModuleTimings(moduleFactoryManager);
+    }
 
   splashMessage(splashScreen, QString());
 
   if (window)
     {
+    qSlicerStartupTracer::Scope traceScope("Show main window", "ui");
     window->setHomeModuleCurrent();
     window->show();
     }
@@ -0,0 +1,18 @@
+import slicer
+import slicer.testing
+
+#
+# Benchmarks of the slice views, run by slicer.testing.runPerformanceTest()
+#
+
+def setSliceOffsets():
+  sliceNode = slicer.util.getNode('vtkMRMLSliceNodeRed')
+  for offset in xrange(-50, 50, 5):
+    sliceNode.SetSliceOffset(offset)
+    slicer.app.processEvents()
+
+def benchmarks():
+  return [
+    slicer.testing.Benchmark('RedSliceOffset', setSliceOffsets,
+                             repetitions=10, warmup=1),
+    ]
@@ -5,9 +5,17 @@
 #include <itkContinuousIndex.h>
 #include <itkImage.h>
 #include <itkImageFileReader.h>
+#include <itkImageFileWriter.h>
 #include <itkPluginFilterWatcher.h>
+#include <itkSharedMemoryImageIO.h>
+#include <itkTransformFileWriter.h>
+#ifdef ITK_USE_GPU
+#include <itkOpenCLUtil.h>
+#endif
 
 // STD includes
+#include <iostream>
+#include <sstream>
 #include <vector>
 #include <string>
 
@@ -15,10 +23,13 @@ namespace itk
 {
   //-----------------------------------------------------------------------------
   /// Get the PixelType and ComponentType from fileName
+  /// Registers the SharedMemoryImageIO so the images Slicer passes through
+  /// shared memory ("slicershm:" file names) can be read and written.
   void GetImageType (std::string fileName,
                      ImageIOBase::IOPixelType &pixelType,
                      ImageIOBase::IOComponentType &componentType)
     {
+      RegisterSharedMemoryImageIOFactory();
       typedef itk::Image<unsigned char, 3> ImageType;
       itk::ImageFileReader<ImageType>::Pointer imageReader =
         itk::ImageFileReader<ImageType>::New();
@@ -29,6 +40,29 @@ namespace itk
       componentType = imageReader->GetImageIO()->GetComponentType();
     }
 
+  //-----------------------------------------------------------------------------
+  /// Return true if the filter of a CLI with a "device" parameter should run
+  /// on the GPU: the device is "gpu", ITK is built with GPU support and an
+  /// OpenCL device is available. Otherwise the CLI falls back to its CPU
+  /// filter, and the reason is printed.
+  bool UseGPUDevice (const std::string& device)
+    {
+    if (device != "gpu")
+      {
+      return false;
+      }
+#ifdef ITK_USE_GPU
+    if (IsGPUAvailable())
+      {
+      return true;
+      }
+    std::cerr << "No OpenCL device available, running on the CPU" << std::endl;
+#else
+    std::cerr << "ITK is built without GPU support, running on the CPU" << std::endl;
+#endif
+    return false;
+    }
+
   //-----------------------------------------------------------------------------
   /// Get the PixelTypes and ComponentTypes from fileNames
   void GetImageTypes (std::vector<std::string> fileNames,
@@ -86,6 +120,108 @@ namespace itk
       }
   }
 
+  //-----------------------------------------------------------------------------
+  /// Tell Slicer that intermediateFileName holds an intermediate result of
+  /// the output outputFileName (the file name given on the command line).
+  /// Slicer loads it into the output node while the module keeps running
+  /// and deletes it afterward: the file must be completely written and not
+  /// be modified anymore. Slicer only loads the most recent result at a
+  /// throttled rate, older results are discarded.
+  inline void PublishIntermediateResult(const std::string& outputFileName,
+                                        const std::string& intermediateFileName)
+    {
+      std::cout << "<filter-intermediate-result>"
+                << "<output>" << outputFileName << "</output>"
+                << "<file>" << intermediateFileName << "</file>"
+                << "</filter-intermediate-result>" << std::endl;
+    }
+
+  //-----------------------------------------------------------------------------
+  /// Return a new file name for an intermediate result of outputFileName:
+  /// "intermediate<N>_<name>" in the directory of the output, so the file
+  /// format is kept.
+  /// Return an empty string if the output is not a file (shared memory).
+  inline std::string GetIntermediateResultFileName(const std::string& outputFileName)
+    {
+      static unsigned int count = 0;
+      if (outputFileName.empty() ||
+          SharedMemoryImageIO::IsSharedMemoryFileName(outputFileName.c_str()))
+        {
+        return std::string();
+        }
+      std::string::size_type slash = outputFileName.find_last_of("/\\");
+      std::string::size_type nameStart =
+        (slash == std::string::npos) ? 0 : slash + 1;
+      std::ostringstream fileName;
+      fileName << outputFileName.substr(0, nameStart)
+               << "intermediate" << ++count << "_"
+               << outputFileName.substr(nameStart);
+      return fileName.str();
+    }
+
+  //-----------------------------------------------------------------------------
+  /// Write image as an intermediate result of the output outputFileName and
+  /// publish it.
+  /// Return false if the output doesn't support intermediate results or if
+  /// the image can't be written.
+  template <class TImage>
+  bool WriteIntermediateImage(const TImage* image,
+                              const std::string& outputFileName)
+  {
+    std::string fileName = GetIntermediateResultFileName(outputFileName);
+    if (fileName.empty())
+      {
+      return false;
+      }
+    typename itk::ImageFileWriter<TImage>::Pointer writer =
+      itk::ImageFileWriter<TImage>::New();
+    writer->SetFileName(fileName.c_str());
+    writer->SetInput(image);
+    try
+      {
+      writer->Update();
+      }
+    catch (itk::ExceptionObject&)
+      {
+      return false;
+      }
+    PublishIntermediateResult(outputFileName, fileName);
+    return true;
+  }
+
+  //-----------------------------------------------------------------------------
+  /// Write transform (and additionalTransform if any, e.g. the bulk
+  /// transform of a BSpline transform) as an intermediate result of the
+  /// output outputFileName and publish it.
+  /// Return false if the transform can't be written.
+  inline bool WriteIntermediateTransform(const TransformBase* transform,
+                                         const std::string& outputFileName,
+                                         const TransformBase* additionalTransform = 0)
+    {
+      std::string fileName = GetIntermediateResultFileName(outputFileName);
+      if (fileName.empty() || !transform)
+        {
+        return false;
+        }
+      TransformFileWriter::Pointer writer = TransformFileWriter::New();
+      writer->SetFileName(fileName.c_str());
+      writer->SetInput(transform);
+      if (additionalTransform)
+        {
+        writer->AddTransform(additionalTransform);
+        }
+      try
+        {
+        writer->Update();
+        }
+      catch (itk::ExceptionObject&)
+        {
+        return false;
+        }
+      PublishIntermediateResult(outputFileName, fileName);
+      return true;
+    }
+
 } // end namespace itk
 
 #endif
@@ -0,0 +1,420 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#ifndef __itkSharedMemoryImageIO_h
+#define __itkSharedMemoryImageIO_h
+
+// ITK includes
+#include <itkImageIOBase.h>
+#include <itkObjectFactoryBase.h>
+#include <itkVersion.h>
+
+// STD includes
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+# include <windows.h>
+#else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+namespace itk
+{
+
+/** \class SharedMemoryImageIO
+ * \brief ImageIO reading and writing images in a named shared memory
+ * segment created by Slicer.
+ *
+ * Slicer can give an executable command line module a "file name" such as
+ * "slicershm:1234_vtkMRMLScalarVolumeNodeB" instead of a temporary nrrd
+ * file. The segment holds a small header followed by the raw voxels, which
+ * saves writing and reading the volume on disk on both sides.
+ *
+ * The layout of the segment must match vtkMRMLSharedMemoryImage::HeaderType
+ * (Libs/MRML/Core), the class Slicer uses to create and read the segments.
+ * This ImageIO is header only because command line modules are run without
+ * ITK_AUTOLOAD_PATH and must not depend on MRML.
+ *
+ * The ImageIO is registered by itk::GetImageType() of itkPluginUtilities.h.
+ * Modules that don't call it must call RegisterSharedMemoryImageIOFactory()
+ * before reading or writing their images.
+ */
+class SharedMemoryImageIO : public ImageIOBase
+{
+public:
+  /** Standard class typedefs. */
+  typedef SharedMemoryImageIO Self;
+  typedef ImageIOBase         Superclass;
+  typedef SmartPointer<Self>  Pointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(SharedMemoryImageIO, ImageIOBase);
+
+  /** Same layout as vtkMRMLSharedMemoryImage::HeaderType */
+  struct HeaderType
+    {
+    char Magic[8];
+    unsigned int Version;
+    unsigned int HeaderSize;
+    int ScalarType;
+    int NumberOfComponents;
+    int Dimensions[3];
+    int Padding;
+    double IJKToRAS[16];
+    unsigned long long DataSize;
+    };
+
+  /** Return true if \a fileName uses the "slicershm:" scheme. */
+  static bool IsSharedMemoryFileName(const char* fileName)
+    {
+    return fileName && strncmp(fileName, "slicershm:", 10) == 0;
+    }
+
+  virtual bool CanReadFile(const char* fileName)
+    {
+    return IsSharedMemoryFileName(fileName);
+    }
+
+  /** Set the dimensions, spacing, origin and directions from the header. */
+  virtual void ReadImageInformation()
+    {
+    HeaderType header;
+    this->MapSegment(false, 0);
+    memcpy(&header, this->m_Memory, sizeof(header));
+    this->UnmapSegment();
+
+    this->SetNumberOfDimensions(3);
+    this->SetComponentType(ComponentTypeFromVTK(header.ScalarType));
+    if (this->GetComponentType() == UNKNOWNCOMPONENTTYPE)
+      {
+      itkExceptionMacro(<< m_FileName << ": unsupported scalar type "
+                        << header.ScalarType);
+      }
+    this->SetNumberOfComponents(header.NumberOfComponents);
+    this->SetPixelType(header.NumberOfComponents == 1 ? SCALAR : VECTOR);
+
+    // The header keeps the geometry in RAS, ITK needs it in LPS.
+    const double* ijkToRAS = header.IJKToRAS;
+    for (unsigned int i = 0; i < 3; ++i)
+      {
+      this->SetDimensions(i, header.Dimensions[i]);
+      double spacing = 0.;
+      for (unsigned int j = 0; j < 3; ++j)
+        {
+        spacing += ijkToRAS[j * 4 + i] * ijkToRAS[j * 4 + i];
+        }
+      spacing = spacing == 0. ? 1. : sqrt(spacing);
+      this->SetSpacing(i, spacing);
+      std::vector<double> direction(3);
+      for (unsigned int j = 0; j < 3; ++j)
+        {
+        direction[j] = (j < 2 ? -1. : 1.) * ijkToRAS[j * 4 + i] / spacing;
+        }
+      this->SetDirection(i, direction);
+      this->SetOrigin(i, (i < 2 ? -1. : 1.) * ijkToRAS[i * 4 + 3]);
+      }
+    }
+
+  /** Copy the voxels of the segment into \a buffer. */
+  virtual void Read(void* buffer)
+    {
+    this->MapSegment(false, 0);
+    const HeaderType* header = static_cast<const HeaderType*>(this->m_Memory);
+    if (header->DataSize != this->GetImageSizeInBytes())
+      {
+      this->UnmapSegment();
+      itkExceptionMacro(<< m_FileName << ": unexpected size of the voxels");
+      }
+    memcpy(buffer, static_cast<const char*>(this->m_Memory) + header->HeaderSize,
+           static_cast<size_t>(header->DataSize));
+    this->UnmapSegment();
+    }
+
+  virtual bool CanWriteFile(const char* fileName)
+    {
+    return IsSharedMemoryFileName(fileName);
+    }
+
+  /** The header is written with the voxels. */
+  virtual void WriteImageInformation()
+    {
+    }
+
+  /** Create the segment and copy the header and \a buffer into it.
+   * The segment is not removed, Slicer reads and removes it afterward. */
+  virtual void Write(const void* buffer)
+    {
+    HeaderType header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.Magic, "SLCRSHM", 8);
+    header.Version = 1;
+    header.HeaderSize = sizeof(HeaderType);
+    header.ScalarType = ComponentTypeToVTK(this->GetComponentType());
+    if (header.ScalarType == 0)
+      {
+      itkExceptionMacro(<< m_FileName << ": unsupported component type "
+                        << this->GetComponentTypeAsString(this->GetComponentType()));
+      }
+    header.NumberOfComponents = this->GetNumberOfComponents();
+    header.IJKToRAS[15] = 1.;
+    for (unsigned int i = 0; i < 3; ++i)
+      {
+      bool hasAxis = i < this->GetNumberOfDimensions();
+      header.Dimensions[i] = hasAxis ? this->GetDimensions(i) : 1;
+      double spacing = hasAxis ? this->GetSpacing(i) : 1.;
+      for (unsigned int j = 0; j < 3; ++j)
+        {
+        double direction = hasAxis && j < this->GetNumberOfDimensions() ?
+          this->GetDirection(i)[j] : (i == j ? 1. : 0.);
+        header.IJKToRAS[j * 4 + i] = (j < 2 ? -1. : 1.) * spacing * direction;
+        }
+      header.IJKToRAS[i * 4 + 3] =
+        hasAxis ? (i < 2 ? -1. : 1.) * this->GetOrigin(i) : 0.;
+      }
+    header.DataSize = this->GetImageSizeInBytes();
+
+    this->MapSegment(true, sizeof(HeaderType) + header.DataSize);
+    memcpy(this->m_Memory, &header, sizeof(header));
+    memcpy(static_cast<char*>(this->m_Memory) + sizeof(header), buffer,
+           static_cast<size_t>(header.DataSize));
+    this->UnmapSegment();
+    }
+
+protected:
+  SharedMemoryImageIO()
+    {
+    this->m_Memory = 0;
+    this->m_Size = 0;
+#ifdef _WIN32
+    this->m_Handle = 0;
+#endif
+    }
+  ~SharedMemoryImageIO()
+    {
+    this->UnmapSegment();
+    }
+
+  /** Map the segment of m_FileName, throw an exception on failure. */
+  void MapSegment(bool create, size_t size)
+    {
+    std::string name(m_FileName.substr(strlen("slicershm:")));
+    bool mapped = false;
+#ifdef _WIN32
+    name = "Local\\" + name;
+    if (create)
+      {
+      unsigned long long size64 = size;
+      this->m_Handle = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL,
+        PAGE_READWRITE, static_cast<DWORD>(size64 >> 32),
+        static_cast<DWORD>(size64 & 0xffffffff), name.c_str());
+      }
+    else
+      {
+      this->m_Handle = OpenFileMappingA(FILE_MAP_READ, FALSE, name.c_str());
+      }
+    if (this->m_Handle)
+      {
+      this->m_Memory = MapViewOfFile(this->m_Handle,
+        create ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ, 0, 0, size);
+      }
+    if (this->m_Memory && !create)
+      {
+      MEMORY_BASIC_INFORMATION info;
+      VirtualQuery(this->m_Memory, &info, sizeof(info));
+      size = info.RegionSize;
+      }
+    mapped = this->m_Memory != 0;
+#else
+    name = "/" + name;
+    int fd = create ?
+      shm_open(name.c_str(), O_CREAT | O_TRUNC | O_RDWR, S_IRUSR | S_IWUSR) :
+      shm_open(name.c_str(), O_RDONLY, 0);
+    struct stat status;
+    if (fd != -1 &&
+        ((create && ftruncate(fd, size) == 0) ||
+         (!create && fstat(fd, &status) == 0)))
+      {
+      size = create ? size : static_cast<size_t>(status.st_size);
+      void* memory = size == 0 ? MAP_FAILED :
+        mmap(0, size, create ? PROT_READ | PROT_WRITE : PROT_READ,
+             MAP_SHARED, fd, 0);
+      mapped = memory != MAP_FAILED;
+      this->m_Memory = mapped ? memory : 0;
+      }
+    if (fd != -1)
+      {
+      close(fd);
+      }
+#endif
+    this->m_Size = size;
+    if (!mapped)
+      {
+      this->UnmapSegment();
+      itkExceptionMacro(<< "Failed to " << (create ? "create" : "open")
+                        << " the shared memory " << m_FileName);
+      }
+    const HeaderType* header = static_cast<const HeaderType*>(this->m_Memory);
+    if (!create &&
+        (size < sizeof(HeaderType) ||
+         memcmp(header->Magic, "SLCRSHM", 8) != 0 ||
+         header->Version != 1 ||
+         header->HeaderSize < sizeof(HeaderType) ||
+         header->HeaderSize + header->DataSize > size))
+      {
+      this->UnmapSegment();
+      itkExceptionMacro(<< m_FileName << " is not a valid image segment");
+      }
+    }
+
+  void UnmapSegment()
+    {
+#ifdef _WIN32
+    if (this->m_Memory)
+      {
+      UnmapViewOfFile(this->m_Memory);
+      }
+    if (this->m_Handle)
+      {
+      CloseHandle(this->m_Handle);
+      }
+    this->m_Handle = 0;
+#else
+    if (this->m_Memory)
+      {
+      munmap(this->m_Memory, this->m_Size);
+      }
+#endif
+    this->m_Memory = 0;
+    this->m_Size = 0;
+    }
+
+  /** VTK scalar types (vtkType.h) */
+  static IOComponentType ComponentTypeFromVTK(int scalarType)
+    {
+    switch (scalarType)
+      {
+      case 2: case 15: return CHAR;
+      case 3: return UCHAR;
+      case 4: return SHORT;
+      case 5: return USHORT;
+      case 6: return INT;
+      case 7: return UINT;
+      case 8: return LONG;
+      case 9: return ULONG;
+      case 10: return FLOAT;
+      case 11: return DOUBLE;
+      default: return UNKNOWNCOMPONENTTYPE;
+      }
+    }
+  static int ComponentTypeToVTK(IOComponentType componentType)
+    {
+    switch (componentType)
+      {
+      case CHAR: return 2;
+      case UCHAR: return 3;
+      case SHORT: return 4;
+      case USHORT: return 5;
+      case INT: return 6;
+      case UINT: return 7;
+      case LONG: return 8;
+      case ULONG: return 9;
+      case FLOAT: return 10;
+      case DOUBLE: return 11;
+      default: return 0;
+      }
+    }
+
+  void* m_Memory;
+  size_t m_Size;
+#ifdef _WIN32
+  HANDLE m_Handle;
+#endif
+
+private:
+  SharedMemoryImageIO(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+};
+
+/** \class SharedMemoryImageIOFactory
+ * \brief Create instances of SharedMemoryImageIO objects using an object
+ * factory.
+ */
+class SharedMemoryImageIOFactory : public ObjectFactoryBase
+{
+public:
+  /** Standard class typedefs. */
+  typedef SharedMemoryImageIOFactory Self;
+  typedef ObjectFactoryBase          Superclass;
+  typedef SmartPointer<Self>         Pointer;
+  typedef SmartPointer<const Self>   ConstPointer;
+
+  /** Class methods used to interface with the registered factories. */
+  virtual const char* GetITKSourceVersion(void) const
+    {
+    return ITK_SOURCE_VERSION;
+    }
+  virtual const char* GetDescription(void) const
+    {
+    return "ImageIOFactory that exchanges images with Slicer through shared memory.";
+    }
+
+  /** Method for class instantiation. */
+  itkFactorylessNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(SharedMemoryImageIOFactory, ObjectFactoryBase);
+
+  /** Register one factory of this type  */
+  static void RegisterOneFactory(void)
+    {
+    SharedMemoryImageIOFactory::Pointer factory = SharedMemoryImageIOFactory::New();
+    ObjectFactoryBase::RegisterFactory(factory);
+    }
+
+protected:
+  SharedMemoryImageIOFactory()
+    {
+    this->RegisterOverride("itkImageIOBase",
+                           "itkSharedMemoryImageIO",
+                           "ImageIO to exchange images with Slicer through shared memory.",
+                           1,
+                           CreateObjectFunction<SharedMemoryImageIO>::New());
+    }
+
+private:
+  SharedMemoryImageIOFactory(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+};
+
+//-----------------------------------------------------------------------------
+/// Register the SharedMemoryImageIO factory once.
+inline void RegisterSharedMemoryImageIOFactory()
+{
+  static bool registered = false;
+  if (!registered)
+    {
+    SharedMemoryImageIOFactory::RegisterOneFactory();
+    registered = true;
+    }
+}
+
+} // end namespace itk
+
+#endif
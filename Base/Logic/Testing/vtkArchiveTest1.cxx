@@ -148,6 +148,27 @@ int vtkArchiveTest1(int argc, char * argv[] )
     return EXIT_FAILURE;
     }
 
+  //
+  // zip the extracted files again, removing them once zipped
+  //
+  std::cout << "creating movedArchiveTest.zip" << std::endl;
+  std::string movedZipFilePath = vtksys::SystemTools::GetCurrentWorkingDirectory() +
+                                                    std::string("/movedArchiveTest.zip");
+  std::string movedZipDirPath = vtksys::SystemTools::GetCurrentWorkingDirectory() +
+                                                    std::string("/archiveTest");
+  res = zip(movedZipFilePath.c_str(), movedZipDirPath.c_str(), true);
+  if (!res || !vtksys::SystemTools::FileExists(movedZipFilePath.c_str()))
+    {
+    std::cerr << "failed to create moved archive" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (vtksys::SystemTools::FileExists("archiveTest/vol.mrml") ||
+      vtksys::SystemTools::FileExists("archiveTest/vol_and_cube.mrml"))
+    {
+    std::cerr << "zipped files were not removed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
   return EXIT_SUCCESS;
 }
 
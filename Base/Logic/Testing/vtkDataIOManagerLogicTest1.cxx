@@ -14,6 +14,7 @@
 #include "vtkDataIOManagerLogic.h"
 
 #include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLScene.h"
 
 // VTK includes
 #include <vtkNew.h>
@@ -30,6 +31,12 @@ int vtkDataIOManagerLogicTest1(int , char * [] )
   logic->SetMRMLApplicationLogic(slicerApplictionLogic.GetPointer());
   logic->GetApplicationLogic()->Print(std::cout);
 
+  // Nothing to download at the end of the import
+  vtkNew<vtkMRMLScene> scene;
+  logic->SetMRMLScene(scene.GetPointer());
+  scene->StartState(vtkMRMLScene::ImportState);
+  scene->EndState(vtkMRMLScene::ImportState);
+
   return EXIT_SUCCESS;
 }
 
@@ -0,0 +1,206 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// Slicer includes
+#include "vtkSlicerApplicationLogic.h"
+#include "vtkSlicerTask.h"
+
+// MRML includes
+#include <vtkMRMLAbstractLogic.h>
+
+// VTK includes
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
+
+// ITK includes
+#include <itkMutexLock.h>
+#include <itksys/SystemTools.hxx>
+
+// STD includes
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+//---------------------------------------------------------------------------
+/// vtkSlicerTaskTestLogic records the concurrency and the order of its tasks
+class vtkSlicerTaskTestLogic: public vtkMRMLAbstractLogic
+{
+public:
+  vtkTypeMacro(vtkSlicerTaskTestLogic, vtkMRMLAbstractLogic);
+  static vtkSlicerTaskTestLogic *New(){return new vtkSlicerTaskTestLogic;}
+
+  /// Task function, \a clientdata is the id of the task.
+  /// Tasks with a negative id wait for Gate to be false.
+  void Run(void* clientdata)
+    {
+    long id = reinterpret_cast<long>(clientdata);
+    this->Lock.Lock();
+    this->StartedTasks.push_back(id);
+    ++this->Running;
+    this->MaximumRunning = std::max(this->MaximumRunning, this->Running);
+    this->Lock.Unlock();
+
+    bool wait = true;
+    int delay = 0;
+    while (wait && delay < 10000)
+      {
+      itksys::SystemTools::Delay(50);
+      delay += 50;
+      this->Lock.Lock();
+      wait = id < 0 ? this->Gate : delay < 200;
+      this->Lock.Unlock();
+      }
+
+    this->Lock.Lock();
+    --this->Running;
+    this->Lock.Unlock();
+    }
+
+  vtkSmartPointer<vtkSlicerTask> NewTask(long id, int threads, int priority = 0)
+    {
+    vtkSmartPointer<vtkSlicerTask> task = vtkSmartPointer<vtkSlicerTask>::New();
+    task->SetTypeToProcessing();
+    task->SetTaskFunction(this, (vtkSlicerTask::TaskFunctionPointer)
+                          &vtkSlicerTaskTestLogic::Run,
+                          reinterpret_cast<void*>(id));
+    task->SetNumberOfThreads(threads);
+    task->SetPriority(priority);
+    return task;
+    }
+
+  void SetGate(bool gate)
+    {
+    this->Lock.Lock();
+    this->Gate = gate;
+    this->Lock.Unlock();
+    }
+  std::vector<long> GetStartedTasks()
+    {
+    this->Lock.Lock();
+    std::vector<long> started = this->StartedTasks;
+    this->Lock.Unlock();
+    return started;
+    }
+
+  itk::SimpleMutexLock Lock;
+  bool Gate;
+  int Running;
+  int MaximumRunning;
+  std::vector<long> StartedTasks;
+
+protected:
+  vtkSlicerTaskTestLogic() : Gate(false), Running(0), MaximumRunning(0) {}
+  virtual ~vtkSlicerTaskTestLogic(){}
+};
+
+//---------------------------------------------------------------------------
+bool waitForTasks(vtkSlicerApplicationLogic* appLogic)
+{
+  for (int delay = 0; delay < 20000; delay += 50)
+    {
+    if (appLogic->GetNumberOfQueuedTasks() == 0 &&
+        appLogic->GetNumberOfRunningTasks() == 0)
+      {
+      return true;
+      }
+    itksys::SystemTools::Delay(50);
+    }
+  return false;
+}
+
+//---------------------------------------------------------------------------
+int vtkSlicerApplicationLogicSchedulingTest(int , char * [])
+{
+  vtkNew<vtkSlicerApplicationLogic> appLogic;
+  appLogic->SetNumberOfProcessingCores(4);
+  appLogic->SetNumberOfProcessingThreads(0);
+  if (appLogic->GetNumberOfProcessingThreads() != 4)
+    {
+    std::cerr << "Line " << __LINE__
+              << " - Problem with SetNumberOfProcessingThreads(0)" << std::endl;
+    return EXIT_FAILURE;
+    }
+  appLogic->SetNumberOfProcessingThreads(3);
+  if (appLogic->GetNumberOfProcessingThreads() != 3 ||
+      appLogic->GetDefaultNumberOfThreadsPerTask() != 1)
+    {
+    std::cerr << "Line " << __LINE__
+              << " - Problem with SetNumberOfProcessingThreads()" << std::endl;
+    return EXIT_FAILURE;
+    }
+  appLogic->CreateProcessingThread();
+
+  vtkNew<vtkSlicerTaskTestLogic> logic;
+
+  // Tasks of 2 cores: only 2 of them run at the same time.
+  for (long i = 0; i < 6; ++i)
+    {
+    appLogic->ScheduleTask(logic->NewTask(i, 2));
+    }
+  if (!waitForTasks(appLogic.GetPointer()) ||
+      logic->GetStartedTasks().size() != 6 ||
+      logic->MaximumRunning != 2)
+    {
+    std::cerr << "Line " << __LINE__
+              << " - Problem with the cores limit, " << logic->MaximumRunning
+              << " tasks run at the same time" << std::endl;
+    appLogic->TerminateProcessingThread();
+    return EXIT_FAILURE;
+    }
+  logic->StartedTasks.clear();
+
+  // A task using all the cores blocks the queue, the queued tasks are
+  // started by priority.
+  logic->SetGate(true);
+  appLogic->ScheduleTask(logic->NewTask(-1, 4));
+  itksys::SystemTools::Delay(300);
+  appLogic->ScheduleTask(logic->NewTask(10, 4, 0));
+  appLogic->ScheduleTask(logic->NewTask(11, 4, 5));
+  vtkSmartPointer<vtkSlicerTask> cancelledTask = logic->NewTask(12, 4, 0);
+  appLogic->ScheduleTask(cancelledTask);
+
+  // A cancelled task doesn't wait for the cores.
+  if (!appLogic->CancelTask(cancelledTask))
+    {
+    std::cerr << "Line " << __LINE__
+              << " - Problem with CancelTask()" << std::endl;
+    logic->SetGate(false);
+    appLogic->TerminateProcessingThread();
+    return EXIT_FAILURE;
+    }
+  itksys::SystemTools::Delay(500);
+  std::vector<long> started = logic->GetStartedTasks();
+  logic->SetGate(false);
+  bool finished = waitForTasks(appLogic.GetPointer());
+  std::vector<long> allStarted = logic->GetStartedTasks();
+  appLogic->TerminateProcessingThread();
+
+  if (started.size() != 2 || started[0] != -1 || started[1] != 12)
+    {
+    std::cerr << "Line " << __LINE__
+              << " - The cancelled task was not run first" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (!finished || allStarted.size() != 4 ||
+      allStarted[2] != 11 || allStarted[3] != 10)
+    {
+    std::cerr << "Line " << __LINE__
+              << " - The tasks were not run by priority" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (appLogic->CancelTask(cancelledTask))
+    {
+    std::cerr << "Line " << __LINE__
+              << " - CancelTask() should fail on a task already run" << std::endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
@@ -7,10 +7,15 @@
 #include "vtkMRMLStorageNode.h"
 #include "vtkMRMLStorableNode.h"
 #include "vtkPermissionPrompter.h"
+#include <vtkMRMLScene.h>
+#include <vtkMRMLSliceCompositeNode.h>
 #include <vtkURIHandler.h>
 
 // VTK includes
 #include <vtkCallbackCommand.h>
+#include <vtkCollection.h>
+#include <vtkNew.h>
+#include <vtkStringArray.h>
 
 // VTKsys includes
 #include <vtksys/SystemTools.hxx>
@@ -18,7 +23,10 @@
 // ITKsys includes
 
 // STD includes
+#include <algorithm>
 #include <cassert>
+#include <map>
+#include <set>
 
 #ifdef linux 
 #include "unistd.h"
@@ -49,6 +57,27 @@ vtkCxxRevisionMacro(vtkDataIOManagerLogic, "$Revision$");
 
 typedef std::pair< vtkDataTransfer *, vtkMRMLNode * > TransferNodePair;
 
+//----------------------------------------------------------------------------
+/// Files staged by a handler in ApplyPrefetch()
+struct vtkDataIOManagerLogicPrefetch
+{
+  vtkDataIOManagerLogic* Logic;
+  /// Batch of each staged file
+  std::vector<vtkCollection*> FileBatches;
+  std::map<vtkCollection*, int> RemainingFiles;
+  std::set<vtkCollection*> FinishedBatches;
+};
+
+namespace
+{
+//----------------------------------------------------------------------------
+bool HasHigherPriority(const std::pair<int, vtkCollection*>& first,
+                       const std::pair<int, vtkCollection*>& second)
+{
+  return first.first > second.first;
+}
+}
+
 //----------------------------------------------------------------------------
 vtkDataIOManagerLogic::vtkDataIOManagerLogic()
 {
@@ -76,6 +105,10 @@ vtkDataIOManagerLogic::~vtkDataIOManagerLogic()
     {
     this->DataIOObserverManager->Delete();
     }
+  for (size_t i = 0; i < this->PendingPrefetches.size(); ++i)
+    {
+    this->PendingPrefetches[i].second->Delete();
+    }
 }
 
 
@@ -86,6 +119,82 @@ void vtkDataIOManagerLogic::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "DataIOManager: " << this->GetDataIOManager() << "\n";
 }
 
+//----------------------------------------------------------------------------
+void vtkDataIOManagerLogic::SetMRMLSceneInternal(vtkMRMLScene* newScene)
+{
+  vtkNew<vtkIntArray> events;
+  events->InsertNextValue(vtkMRMLScene::EndImportEvent);
+  this->SetAndObserveMRMLSceneEventsInternal(newScene, events.GetPointer());
+}
+
+//----------------------------------------------------------------------------
+void vtkDataIOManagerLogic::OnMRMLSceneEndImport()
+{
+  if (this->PendingPrefetches.empty())
+    {
+    return;
+    }
+  //--- the volumes shown in the slice views first, then in scene order
+  std::stable_sort(this->PendingPrefetches.begin(),
+                   this->PendingPrefetches.end(), HasHigherPriority);
+  vtkCollection *batches = vtkCollection::New();
+  for (size_t i = 0; i < this->PendingPrefetches.size(); ++i)
+    {
+    batches->AddItem(this->PendingPrefetches[i].second);
+    this->PendingPrefetches[i].second->Delete();
+    }
+  this->PendingPrefetches.clear();
+
+  vtkDebugMacro("OnMRMLSceneEndImport: Schedule an ASYNCHRONOUS transfer of " << batches->GetNumberOfItems() << " nodes");
+  vtkSlicerTask *task = vtkSlicerTask::New();
+  task->SetTypeToNetworking();
+  // The task owns the batches, ApplyPrefetch deletes them.
+  task->SetTaskFunction(this, (vtkSlicerTask::TaskFunctionPointer)
+                        &vtkDataIOManagerLogic::ApplyPrefetch, batches);
+  if ( ! this->GetApplicationLogic()->ScheduleTask( task ) )
+    {
+    for (int i = 0; i < batches->GetNumberOfItems(); i++)
+      {
+      vtkCollection *batch = vtkCollection::SafeDownCast( batches->GetItemAsObject(i) );
+      for (int j = 0; j < batch->GetNumberOfItems(); j++)
+        {
+        vtkDataTransfer::SafeDownCast( batch->GetItemAsObject(j) )
+          ->SetTransferStatus( vtkDataTransfer::CompletedWithErrors);
+        }
+      }
+    batches->Delete();
+    }
+  task->Delete();
+}
+
+//----------------------------------------------------------------------------
+int vtkDataIOManagerLogic::GetReadPriority(vtkMRMLNode *node)
+{
+  vtkMRMLScene *scene = this->GetMRMLScene();
+  if (scene == NULL || node == NULL || node->GetID() == NULL)
+    {
+    return 0;
+    }
+  std::vector<vtkMRMLNode*> compositeNodes;
+  scene->GetNodesByClass("vtkMRMLSliceCompositeNode", compositeNodes);
+  for (size_t i = 0; i < compositeNodes.size(); ++i)
+    {
+    vtkMRMLSliceCompositeNode *compositeNode =
+      vtkMRMLSliceCompositeNode::SafeDownCast(compositeNodes[i]);
+    const char *volumeIDs[3] = { compositeNode->GetBackgroundVolumeID(),
+                                 compositeNode->GetForegroundVolumeID(),
+                                 compositeNode->GetLabelVolumeID() };
+    for (int j = 0; j < 3; ++j)
+      {
+      if (volumeIDs[j] != NULL && strcmp(volumeIDs[j], node->GetID()) == 0)
+        {
+        return 1;
+        }
+      }
+    }
+  return 0;
+}
+
 //----------------------------------------------------------------------------
 vtkObserverManager* vtkDataIOManagerLogic::GetDataIOObserverManager()
 {
@@ -407,7 +516,22 @@ int vtkDataIOManagerLogic::QueueRead ( vtkMRMLNode *node )
   
   vtkDebugMacro("QueueRead: asynchronous enabled = " << this->GetDataIOManager()->GetEnableAsynchronousIO());
   
-  if ( this->GetDataIOManager()->GetEnableAsynchronousIO() )
+  //--- When the storage node has a list of files, they are all downloaded
+  //--- by a single task so that the handler can transfer them at the same
+  //--- time, and the node is read once all of them are there.
+  //--- While the scene is imported, the files of all the nodes are
+  //--- collected and downloaded together at the end of the import.
+  bool prefetch = this->GetDataIOManager()->GetEnableAsynchronousIO() &&
+    this->GetMRMLScene() != NULL && this->GetMRMLScene()->IsImporting();
+  vtkCollection *batch = NULL;
+  if ( this->GetDataIOManager()->GetEnableAsynchronousIO() &&
+       ( dnode->GetNthStorageNode(storageNodeIndex)->GetNumberOfURIs() > 0 || prefetch ) )
+    {
+    batch = vtkCollection::New();
+    transfer0->SetTransferStatus ( vtkDataTransfer::Pending );
+    batch->AddItem ( transfer0 );
+    }
+  else if ( this->GetDataIOManager()->GetEnableAsynchronousIO() )
     {
     vtkDebugMacro("QueueRead: Schedule an ASYNCHRONOUS data transfer");
     //---
@@ -423,6 +547,7 @@ int vtkDataIOManagerLogic::QueueRead ( vtkMRMLNode *node )
       return 0;
       }
     task->SetTypeToNetworking();
+    task->SetPriority ( this->GetReadPriority ( node ) );
     transfer0->SetTransferStatus ( vtkDataTransfer::Pending );
     task->SetTaskFunction(this, (vtkSlicerTask::TaskFunctionPointer)
                           &vtkDataIOManagerLogic::ApplyTransfer, transfer0);
@@ -466,6 +591,10 @@ int vtkDataIOManagerLogic::QueueRead ( vtkMRMLNode *node )
     if ( transfer1 == NULL )
       {
       vtkErrorMacro("QueueRead: failed to add new data transfer for file " << n);
+      if ( batch )
+        {
+        batch->Delete();
+        }
       return 0;
       }
     transfer1->SetTransferID ( this->GetDataIOManager()->GetUniqueTransferID() );
@@ -480,29 +609,11 @@ int vtkDataIOManagerLogic::QueueRead ( vtkMRMLNode *node )
     this->AddNewDataTransfer ( transfer1, node );
     this->GetDataIOManager()->InvokeEvent ( vtkDataIOManager::RefreshDisplayEvent );
     
-    if ( this->GetDataIOManager()->GetEnableAsynchronousIO() )
+    if ( batch )
       {
-      vtkDebugMacro("QueueRead: Schedule an ASYNCHRONOUS data transfer, n = " << n);
-      vtkSlicerTask *task = vtkSlicerTask::New();
-      
-      if ( !task )
-        {
-        transfer1->Delete();
-        return 0;
-        }
-      task->SetTypeToNetworking();
+      vtkDebugMacro("QueueRead: Add an ASYNCHRONOUS data transfer to the batch, n = " << n);
       transfer1->SetTransferStatus ( vtkDataTransfer::Pending );
-      task->SetTaskFunction(this, (vtkSlicerTask::TaskFunctionPointer)
-                            &vtkDataIOManagerLogic::ApplyTransfer, transfer1);
-  
-      // Schedule the transfer
-      if ( ! this->GetApplicationLogic()->ScheduleTask( task ) )
-        {
-        transfer1->SetTransferStatus( vtkDataTransfer::CompletedWithErrors);
-        task->Delete();
-        return 0;      
-        }
-      task->Delete();
+      batch->AddItem ( transfer1 );
       }
     else
       {
@@ -515,6 +626,34 @@ int vtkDataIOManagerLogic::QueueRead ( vtkMRMLNode *node )
       }
     transfer1->Delete();
     }
+  if ( batch && prefetch )
+    {
+    vtkDebugMacro("QueueRead: Queue an ASYNCHRONOUS transfer of " << batch->GetNumberOfItems() << " files until the end of the import");
+    this->PendingPrefetches.push_back(
+      std::make_pair( this->GetReadPriority ( node ), batch ) );
+    }
+  else if ( batch )
+    {
+    vtkDebugMacro("QueueRead: Schedule an ASYNCHRONOUS transfer of " << batch->GetNumberOfItems() << " files");
+    vtkSlicerTask *task = vtkSlicerTask::New();
+    task->SetTypeToNetworking();
+    task->SetPriority ( this->GetReadPriority ( node ) );
+    // The task owns the batch, ApplyTransfers deletes it.
+    task->SetTaskFunction(this, (vtkSlicerTask::TaskFunctionPointer)
+                          &vtkDataIOManagerLogic::ApplyTransfers, batch);
+    if ( ! this->GetApplicationLogic()->ScheduleTask( task ) )
+      {
+      for (int i = 0; i < batch->GetNumberOfItems(); i++)
+        {
+        vtkDataTransfer::SafeDownCast( batch->GetItemAsObject(i) )
+          ->SetTransferStatus( vtkDataTransfer::CompletedWithErrors);
+        }
+      batch->Delete();
+      task->Delete();
+      return 0;
+      }
+    task->Delete();
+    }
   if ( dnode->GetNthStorageNode(storageNodeIndex)->GetNumberOfURIs() > 0 &&
        !this->GetDataIOManager()->GetEnableAsynchronousIO())
     {
@@ -712,6 +851,236 @@ int vtkDataIOManagerLogic::QueueWrite ( vtkMRMLNode *node )
 
 
 
+//----------------------------------------------------------------------------
+void vtkDataIOManagerLogic::FinishRemoteRead( vtkMRMLNode *node, const char *source, const char *dest )
+{
+  vtkMRMLStorableNode *storableNode = vtkMRMLStorableNode::SafeDownCast( node );
+  if ( !storableNode )
+    {
+    vtkErrorMacro( "FinishRemoteRead: could not get storable node for scheduled data transfer" );
+    return;
+    }
+  // find the storage node that's been scheduled  and we're working on it
+  int storageNodeIndex = -1;
+  for (int i = 0; i < storableNode->GetNumberOfStorageNodes(); i++)
+    {
+    if (storableNode->GetNthStorageNode(i)->GetReadState() == vtkMRMLStorageNode::Transferring &&
+        strcmp(storableNode->GetNthStorageNode(i)->GetURI(),source) == 0)
+      {
+      vtkDebugMacro("FinishRemoteRead: found a working storage node who's uri matches source " << source << " at " << i);
+      storageNodeIndex = i;
+      break;
+      }
+    }
+  if (storageNodeIndex == -1)
+    {
+    vtkErrorMacro("FinishRemoteRead: unable to find a storage node in scheduled state.");
+    }
+  vtkMRMLStorageNode *storageNode = storableNode->GetNthStorageNode(storageNodeIndex);
+  if ( !storageNode )
+    {
+    vtkErrorMacro( "FinishRemoteRead: no storage node for scheduled data transfer" );
+    return;
+    }
+  storageNode->SetDisableModifiedEvent( 1 );
+  // let the storage node know that the remote transfer is done
+  vtkDebugMacro("FinishRemoteRead: setting storage node read state to transfer done for uri " << storageNode->GetURI());
+  storageNode->SetReadStateTransferDone();
+  storageNode->SetDisableModifiedEvent( 0 );
+  this->GetApplicationLogic()->RequestReadData( node->GetID(), dest, 0, 0 );
+}
+
+//----------------------------------------------------------------------------
+void vtkDataIOManagerLogic::AddCachedFile( const char *source, const char *dest )
+{
+  vtkDataIOManager *iom = this->GetDataIOManager();
+  if ( iom == NULL || iom->GetCacheManager() == NULL )
+    {
+    return;
+    }
+  iom->GetCacheManager()->AddCachedFile ( source, dest );
+}
+
+//----------------------------------------------------------------------------
+void vtkDataIOManagerLogic::ApplyTransfers( void *clientdata )
+{
+  //--- the transfers are on the input, we own the collection
+  vtkCollection *transfers = reinterpret_cast < vtkCollection*> (clientdata);
+  if ( transfers == NULL || transfers->GetNumberOfItems() == 0 )
+    {
+    vtkErrorMacro ( "ApplyTransfers: No transfer target was found");
+    if ( transfers )
+      {
+      transfers->Delete();
+      }
+    return;
+    }
+
+  //--- all the transfers download the files of the same storage node
+  //--- with the same handler.
+  vtkDataTransfer *dt0 = vtkDataTransfer::SafeDownCast ( transfers->GetItemAsObject(0) );
+  vtkMRMLNode *node = this->GetMRMLScene()->GetNodeByID ((dt0->GetTransferNodeID() ));
+  vtkURIHandler *handler = dt0->GetHandler();
+  if ( node == NULL || handler == NULL )
+    {
+    vtkErrorMacro("ApplyTransfers: can't get mrml node or handler from transfer node id " << dt0->GetTransferNodeID());
+    transfers->Delete();
+    return;
+    }
+
+  vtkStringArray *sources = vtkStringArray::New();
+  vtkStringArray *destinations = vtkStringArray::New();
+  for (int i = 0; i < transfers->GetNumberOfItems(); i++)
+    {
+    vtkDataTransfer *dt = vtkDataTransfer::SafeDownCast ( transfers->GetItemAsObject(i) );
+    if ( dt->GetSourceURI() == NULL || dt->GetDestinationURI() == NULL )
+      {
+      continue;
+      }
+    sources->InsertNextValue ( dt->GetSourceURI() );
+    destinations->InsertNextValue ( dt->GetDestinationURI() );
+    dt->SetTransferStatusNoModify ( vtkDataTransfer::Running );
+    this->GetApplicationLogic()->RequestModified( dt );
+    }
+
+  //--- the handler downloads the files at the same time if it can
+  vtkDebugMacro("ApplyTransfers: stage " << sources->GetNumberOfValues() << " files read on the handler");
+  handler->StageFilesRead ( sources, destinations );
+  sources->Delete();
+  destinations->Delete();
+
+  //--- the node can be read only when all its files are there
+  this->FinishTransfers ( transfers );
+  transfers->Delete();
+}
+
+//----------------------------------------------------------------------------
+void vtkDataIOManagerLogic::FinishTransfers( vtkCollection *transfers )
+{
+  vtkDataTransfer *dt0 = vtkDataTransfer::SafeDownCast ( transfers->GetItemAsObject(0) );
+  for (int i = 0; i < transfers->GetNumberOfItems(); i++)
+    {
+    vtkDataTransfer *dt = vtkDataTransfer::SafeDownCast ( transfers->GetItemAsObject(i) );
+    if ( dt->GetSourceURI() != NULL && dt->GetDestinationURI() != NULL )
+      {
+      this->AddCachedFile ( dt->GetSourceURI(), dt->GetDestinationURI() );
+      }
+    dt->SetTransferStatusNoModify ( vtkDataTransfer::Completed );
+    this->GetApplicationLogic()->RequestModified( dt );
+    }
+
+  vtkMRMLNode *node = this->GetMRMLScene()->GetNodeByID ((dt0->GetTransferNodeID() ));
+  if ( node != NULL &&
+       dt0->GetSourceURI() != NULL && dt0->GetDestinationURI() != NULL )
+    {
+    this->FinishRemoteRead ( node, dt0->GetSourceURI(), dt0->GetDestinationURI() );
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkDataIOManagerLogic::ApplyPrefetch( void *clientdata )
+{
+  //--- the batches are on the input, we own the collection
+  vtkCollection *batches = reinterpret_cast < vtkCollection*> (clientdata);
+  if ( batches == NULL )
+    {
+    vtkErrorMacro ( "ApplyPrefetch: No transfer target was found");
+    return;
+    }
+
+  //--- the handlers in the order of their first batch
+  std::vector<vtkURIHandler*> handlers;
+  for (int i = 0; i < batches->GetNumberOfItems(); i++)
+    {
+    vtkCollection *batch = vtkCollection::SafeDownCast ( batches->GetItemAsObject(i) );
+    vtkDataTransfer *dt0 = vtkDataTransfer::SafeDownCast ( batch->GetItemAsObject(0) );
+    if ( dt0->GetHandler() == NULL )
+      {
+      vtkErrorMacro("ApplyPrefetch: no handler for the transfer of node " << dt0->GetTransferNodeID());
+      continue;
+      }
+    if ( std::find ( handlers.begin(), handlers.end(), dt0->GetHandler() ) == handlers.end() )
+      {
+      handlers.push_back ( dt0->GetHandler() );
+      }
+    }
+
+  for (size_t h = 0; h < handlers.size(); ++h)
+    {
+    vtkDataIOManagerLogicPrefetch prefetch;
+    prefetch.Logic = this;
+    std::vector<vtkCollection*> handlerBatches;
+    vtkNew<vtkStringArray> sources;
+    vtkNew<vtkStringArray> destinations;
+    for (int i = 0; i < batches->GetNumberOfItems(); i++)
+      {
+      vtkCollection *batch = vtkCollection::SafeDownCast ( batches->GetItemAsObject(i) );
+      if ( vtkDataTransfer::SafeDownCast ( batch->GetItemAsObject(0) )->GetHandler() != handlers[h] )
+        {
+        continue;
+        }
+      handlerBatches.push_back ( batch );
+      prefetch.RemainingFiles[batch] = 0;
+      for (int j = 0; j < batch->GetNumberOfItems(); j++)
+        {
+        vtkDataTransfer *dt = vtkDataTransfer::SafeDownCast ( batch->GetItemAsObject(j) );
+        if ( dt->GetSourceURI() == NULL || dt->GetDestinationURI() == NULL )
+          {
+          continue;
+          }
+        sources->InsertNextValue ( dt->GetSourceURI() );
+        destinations->InsertNextValue ( dt->GetDestinationURI() );
+        prefetch.FileBatches.push_back ( batch );
+        ++prefetch.RemainingFiles[batch];
+        dt->SetTransferStatusNoModify ( vtkDataTransfer::Running );
+        this->GetApplicationLogic()->RequestModified( dt );
+        }
+      }
+
+    //--- the files are staged in the order of the batches and each node
+    //--- is read as soon as its files are there
+    vtkDebugMacro("ApplyPrefetch: stage " << sources->GetNumberOfValues() << " files read on the handler");
+    vtkNew<vtkCallbackCommand> callback;
+    callback->SetCallback ( vtkDataIOManagerLogic::FileStagedCallback );
+    callback->SetClientData ( &prefetch );
+    unsigned long tag = handlers[h]->AddObserver (
+      vtkURIHandler::FileStagedEvent, callback.GetPointer() );
+    handlers[h]->StageFilesRead ( sources.GetPointer(), destinations.GetPointer() );
+    handlers[h]->RemoveObserver ( tag );
+
+    //--- the nodes with missing files are read too, so that they report
+    //--- the error instead of staying in the transferring state
+    for (size_t i = 0; i < handlerBatches.size(); ++i)
+      {
+      if ( prefetch.FinishedBatches.count ( handlerBatches[i] ) == 0 )
+        {
+        this->FinishTransfers ( handlerBatches[i] );
+        }
+      }
+    }
+  batches->Delete();
+}
+
+//----------------------------------------------------------------------------
+void vtkDataIOManagerLogic::FileStagedCallback(
+  vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(eid),
+  void* clientData, void* callData)
+{
+  vtkDataIOManagerLogicPrefetch *prefetch =
+    reinterpret_cast<vtkDataIOManagerLogicPrefetch *>(clientData);
+  vtkIdType index = *reinterpret_cast<vtkIdType *>(callData);
+  if ( index < 0 || index >= static_cast<vtkIdType>( prefetch->FileBatches.size() ) )
+    {
+    return;
+    }
+  vtkCollection *batch = prefetch->FileBatches[index];
+  if ( --prefetch->RemainingFiles[batch] == 0 )
+    {
+    prefetch->FinishedBatches.insert ( batch );
+    prefetch->Logic->FinishTransfers ( batch );
+    }
+}
+
 //----------------------------------------------------------------------------
 void vtkDataIOManagerLogic::ApplyTransfer( void *clientdata )
 {
@@ -762,48 +1131,17 @@ void vtkDataIOManagerLogic::ApplyTransfer( void *clientdata )
         dt->SetTransferStatusNoModify ( vtkDataTransfer::Running );
         this->GetApplicationLogic()->RequestModified( dt );
         handler->StageFileRead( source, dest);
+        this->AddCachedFile ( source, dest );
         dt->SetTransferStatusNoModify ( vtkDataTransfer::Completed );
         this->GetApplicationLogic()->RequestModified( dt );
 
-        vtkMRMLStorableNode *storableNode = vtkMRMLStorableNode::SafeDownCast( node );
-        if ( !storableNode )
-          {
-          vtkErrorMacro( "ApplyTransfer: could not get storable node for scheduled data transfer" );
-          return;
-          }
-        // find the storage node that's been scheduled  and we're working on it
-        int storageNodeIndex = -1;
-        for (int i = 0; i < storableNode->GetNumberOfStorageNodes(); i++)
-          {
-          if (storableNode->GetNthStorageNode(i)->GetReadState() == vtkMRMLStorageNode::Transferring &&
-              strcmp(storableNode->GetNthStorageNode(i)->GetURI(),source) == 0)
-            {
-            vtkDebugMacro("ApplyTransfer: found a working storage node who's uri matches source " << source << " at " << i);
-            storageNodeIndex = i;
-            break;
-            }
-          }
-        if (storageNodeIndex == -1)
-          {
-          vtkErrorMacro("ApplyTransfer: unable to find a storage node in scheduled state.");
-          }
-        vtkMRMLStorageNode *storageNode = storableNode->GetNthStorageNode(storageNodeIndex);
-        if ( !storageNode )
-          {
-          vtkErrorMacro( "ApplyTransfer: no storage node for scheduled data transfer" );
-          return;
-          }
-        storageNode->SetDisableModifiedEvent( 1 );
-        // let the storage node know that the remote transfer is done
-        vtkDebugMacro("ApplyTransfer: setting storage node read state to transfer done for uri " << storageNode->GetURI());
-        storageNode->SetReadStateTransferDone();
-        storageNode->SetDisableModifiedEvent( 0 );
-        this->GetApplicationLogic()->RequestReadData( node->GetID(), dest, 0, 0 );
+        this->FinishRemoteRead ( node, source, dest );
         }
       else
         {
         vtkDebugMacro("ApplyTransfer: stage file read on the handler..., source = " << source << ", dest = " << dest);
         handler->StageFileRead( source, dest);
+        this->AddCachedFile ( source, dest );
         }
       }
     }
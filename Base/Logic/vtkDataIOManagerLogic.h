@@ -15,6 +15,10 @@
 #include "vtkDataIOManager.h"
 #include "vtkMRMLNode.h"
 
+// STD includes
+#include <vector>
+
+class vtkCollection;
 
 #ifndef vtkObjectPointer
 #define vtkObjectPointer(xx) (reinterpret_cast <vtkObject **>( (xx) ))
@@ -45,6 +49,21 @@ class VTK_SLICER_BASE_LOGIC_EXPORT vtkDataIOManagerLogic : public vtkSlicerModul
   /// The method that executes the data transfer in another thread
   virtual void ApplyTransfer(void *clientdata);
 
+  /// 
+  /// Execute a batch of downloads of the same storage node in another
+  /// thread. \a clientdata is a vtkCollection of vtkDataTransfer, the
+  /// first one being the transfer of the storage node URI. The
+  /// collection is deleted when the transfers are done.
+  virtual void ApplyTransfers(void *clientdata);
+
+  /// 
+  /// Execute the downloads of several storage nodes in another thread.
+  /// \a clientdata is a vtkCollection of the batches of ApplyTransfers(),
+  /// sorted by priority. The files of the same handler are all staged at
+  /// the same time and each node is read as soon as its files are there.
+  /// The collection is deleted when the transfers are done.
+  virtual void ApplyPrefetch(void *clientdata);
+
   /// Description
   /// Communicates progress back to the DataIOManager
   static void ProgressCallback ( void * );
@@ -66,6 +85,38 @@ class VTK_SLICER_BASE_LOGIC_EXPORT vtkDataIOManagerLogic : public vtkSlicerModul
   vtkDataIOManagerLogic(const vtkDataIOManagerLogic&);
   void operator=(const vtkDataIOManagerLogic&);
 
+  /// 
+  /// Set the storage node of \a node that downloads \a source as
+  /// transferred and request to read \a dest.
+  virtual void FinishRemoteRead(vtkMRMLNode *node, const char *source, const char *dest);
+
+  /// 
+  /// Cache the files of the batch \a transfers, set them as completed
+  /// and finish the read of their node.
+  void FinishTransfers(vtkCollection *transfers);
+
+  /// 
+  /// Priority of the download of \a node: the volumes shown in the slice
+  /// views are downloaded before the other nodes.
+  int GetReadPriority(vtkMRMLNode *node);
+
+  virtual void SetMRMLSceneInternal(vtkMRMLScene* newScene);
+
+  /// 
+  /// Schedule the downloads queued while the scene was imported.
+  virtual void OnMRMLSceneEndImport();
+
+  /// 
+  /// Downloads queued by QueueRead() while the scene is imported, with
+  /// their priority. They are scheduled at once at the end of the import.
+  std::vector<std::pair<int, vtkCollection*> > PendingPrefetches;
+
+  static void FileStagedCallback(vtkObject *caller, unsigned long eid, void *clientData, void *callData);
+
+  /// 
+  /// Register the file \a dest downloaded from \a source in the cache.
+  void AddCachedFile(const char *source, const char *dest);
+
   vtkObserverManager* GetDataIOObserverManager();
   vtkObserverManager* DataIOObserverManager;
   static void DataIOManagerCallback(vtkObject *caller, unsigned long eid, void *clientData, void *callData);
@@ -13,8 +13,10 @@
 #include "vtkSlicerTask.h"
 
 // VTK includes
+#include <vtkNew.h>
 #include <vtkPointData.h>
 #include <vtkPolyData.h>
+#include <vtkTimerLog.h>
 
 // MRML includes
 #include <vtkCacheManager.h>
@@ -38,8 +40,11 @@
 #include <vtkMRMLNRRDStorageNode.h>
 #include <vtkMRMLNonlinearTransformNode.h>
 #include <vtkMRMLSelectionNode.h>
+#include <vtkMRMLSharedMemoryImage.h>
 #include <vtkMRMLSliceCompositeNode.h>
 #include <vtkMRMLSliceNode.h>
+#include <vtkMRMLStorableNode.h>
+#include <vtkMRMLStorageNode.h>
 #include <vtkMRMLTransformStorageNode.h>
 #include <vtkMRMLVectorVolumeDisplayNode.h>
 #include <vtkMRMLVectorVolumeNode.h>
@@ -53,11 +58,23 @@
 #ifdef linux
 # include <unistd.h>
 #endif
+#include <deque>
 #include <queue>
+#include <set>
+#include <vector>
 
 //----------------------------------------------------------------------------
-class ProcessingTaskQueue : public std::queue<vtkSmartPointer<vtkSlicerTask> > {};
-class ModifiedQueue : public std::queue<vtkSmartPointer<vtkObject> > {};
+struct ProcessingTaskQueueItem
+{
+  ProcessingTaskQueueItem(vtkSlicerTask* task)
+    : Task(task), Cancelled(false)
+  {
+  }
+  vtkSmartPointer<vtkSlicerTask> Task;
+  bool Cancelled;
+};
+class ProcessingTaskQueue : public std::deque<ProcessingTaskQueueItem> {};
+class ModifiedQueue : public std::deque<vtkSmartPointer<vtkObject> > {};
 
 //----------------------------------------------------------------------------
 class DataRequest
@@ -199,6 +216,38 @@ public:
 };
 class WriteDataQueue : public std::queue<WriteDataRequest> {} ;
 
+//----------------------------------------------------------------------------
+class StorableNodeReadJob
+{
+public:
+  StorableNodeReadJob()
+  {
+    this->Node = 0;
+    this->StorageNode = 0;
+    this->Result = 0;
+  }
+  vtkMRMLStorableNode* Node;
+  vtkMRMLStorageNode* StorageNode;
+  /// Detached copies that are read in a worker thread
+  vtkSmartPointer<vtkMRMLStorableNode> TemporaryNode;
+  vtkSmartPointer<vtkMRMLStorageNode> TemporaryStorageNode;
+  int Result;
+};
+
+//----------------------------------------------------------------------------
+class StorableNodeReadJobs
+{
+public:
+  StorableNodeReadJobs()
+  {
+    this->NextJob = 0;
+    this->Lock = itk::MutexLock::New();
+  }
+  std::vector<StorableNodeReadJob> Jobs;
+  size_t NextJob;
+  itk::MutexLock::Pointer Lock;
+};
+
 //----------------------------------------------------------------------------
 vtkCxxRevisionMacro(vtkSlicerApplicationLogic, "$Revision$");
 vtkStandardNewMacro(vtkSlicerApplicationLogic);
@@ -207,10 +256,16 @@ vtkStandardNewMacro(vtkSlicerApplicationLogic);
 vtkSlicerApplicationLogic::vtkSlicerApplicationLogic()
 {
   this->ProcessingThreader = itk::MultiThreader::New();
-  this->ProcessingThreadId = -1;
   this->ProcessingThreadActive = false;
-  this->ProcessingThreadActiveLock = itk::MutexLock::New();
-  this->ProcessingTaskQueueLock = itk::MutexLock::New();
+  this->NumberOfProcessingThreads = 1;
+  this->NumberOfProcessingCores =
+    itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+  this->ProcessingMemoryLimit = 0;
+  this->RequestTimeBudget = 20;
+  this->NumberOfRunningTasks = 0;
+  this->UsedProcessingCores = 0;
+  this->UsedProcessingMemory = 0;
+  this->ProcessingTaskQueueCondition = itk::ConditionVariable::New();
 
   this->ModifiedQueueActive = false;
   this->ModifiedQueueActiveLock = itk::MutexLock::New();
@@ -234,21 +289,7 @@ vtkSlicerApplicationLogic::vtkSlicerApplicationLogic()
 //----------------------------------------------------------------------------
 vtkSlicerApplicationLogic::~vtkSlicerApplicationLogic()
 {
-  // Note that TerminateThread does not kill a thread, it only waits
-  // for the thread to finish.  We need to signal the thread that we
-  // want to terminate
-  if (this->ProcessingThreadId != -1 && this->ProcessingThreader)
-    {
-    // Signal the processingThread that we are terminating.
-    this->ProcessingThreadActiveLock->Lock();
-    this->ProcessingThreadActive = false;
-    this->ProcessingThreadActiveLock->Unlock();
-
-    // Wait for the thread to finish and clean up the state of the threader
-    this->ProcessingThreader->TerminateThread( this->ProcessingThreadId );
-
-    this->ProcessingThreadId = -1;
-    }
+  this->TerminateTaskThreads();
 
   delete this->InternalTaskQueue;
 
@@ -256,7 +297,7 @@ vtkSlicerApplicationLogic::~vtkSlicerApplicationLogic()
   while (!(*this->InternalModifiedQueue).empty())
     {
     vtkObject *obj = (*this->InternalModifiedQueue).front();
-    (*this->InternalModifiedQueue).pop();
+    (*this->InternalModifiedQueue).pop_front();
     obj->Delete(); // decrement ref count
     }
   this->ModifiedQueueLock->Unlock();
@@ -290,21 +331,57 @@ void vtkSlicerApplicationLogic::PrintSelf(ostream& os, vtkIndent indent)
   this->vtkObject::PrintSelf(os, indent);
 
   os << indent << "SlicerApplicationLogic:             " << this->GetClassName() << "\n";
+  os << indent << "NumberOfProcessingThreads: " << this->NumberOfProcessingThreads << "\n";
+  os << indent << "NumberOfProcessingCores: " << this->NumberOfProcessingCores << "\n";
+  os << indent << "ProcessingMemoryLimit: " << this->ProcessingMemoryLimit << "\n";
+  os << indent << "RequestTimeBudget: " << this->RequestTimeBudget << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerApplicationLogic::SetNumberOfProcessingThreads(int numberOfThreads)
+{
+  if (numberOfThreads == 0)
+    {
+    numberOfThreads = this->NumberOfProcessingCores;
+    }
+  // The networking thread is spawned by the same threader.
+  numberOfThreads = std::max(1, std::min(numberOfThreads, ITK_MAX_THREADS - 1));
+  if (!this->ProcessingThreadIDs.empty())
+    {
+    vtkWarningMacro(<< "SetNumberOfProcessingThreads: the processing threads "
+                    << "are already created, the change is ignored.");
+    return;
+    }
+  if (this->NumberOfProcessingThreads == numberOfThreads)
+    {
+    return;
+    }
+  this->NumberOfProcessingThreads = numberOfThreads;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerApplicationLogic::GetDefaultNumberOfThreadsPerTask()
+{
+  return std::max(1,
+    this->NumberOfProcessingCores / this->NumberOfProcessingThreads);
 }
 
 //----------------------------------------------------------------------------
 void vtkSlicerApplicationLogic::CreateProcessingThread()
 {
-  if (this->ProcessingThreadId == -1)
+  if (this->ProcessingThreadIDs.empty())
     {
-    this->ProcessingThreadActiveLock->Lock();
+    this->ProcessingTaskQueueLock.Lock();
     this->ProcessingThreadActive = true;
-    this->ProcessingThreadActiveLock->Unlock();
+    this->ProcessingTaskQueueLock.Unlock();
 
-    this->ProcessingThreadId
-      = this->ProcessingThreader
-      ->SpawnThread(vtkSlicerApplicationLogic::ProcessingThreaderCallback,
-                    this);
+    for (int i = 0; i < this->NumberOfProcessingThreads; ++i)
+      {
+      this->ProcessingThreadIDs.push_back( this->ProcessingThreader
+        ->SpawnThread(vtkSlicerApplicationLogic::ProcessingThreaderCallback,
+                      this) );
+      }
 
     // Start four network threads (TODO: make the number of threads a setting)
     this->NetworkingThreadIDs.push_back ( this->ProcessingThreader
@@ -347,7 +424,7 @@ void vtkSlicerApplicationLogic::CreateProcessingThread()
 //----------------------------------------------------------------------------
 void vtkSlicerApplicationLogic::TerminateProcessingThread()
 {
-  if (this->ProcessingThreadId != -1)
+  if (!this->ProcessingThreadIDs.empty())
     {
     std::cout << "vtkSlicerApplicationLogic::TerminateProcessingThread()" << std::endl;
     this->ModifiedQueueActiveLock->Lock();
@@ -362,23 +439,41 @@ void vtkSlicerApplicationLogic::TerminateProcessingThread()
     this->WriteDataQueueActive = false;
     this->WriteDataQueueActiveLock->Unlock();
 
-    this->ProcessingThreadActiveLock->Lock();
-    this->ProcessingThreadActive = false;
-    this->ProcessingThreadActiveLock->Unlock();
+    this->TerminateTaskThreads();
+    }
+}
 
-    this->ProcessingThreader->TerminateThread( this->ProcessingThreadId );
-    this->ProcessingThreadId = -1;
+//----------------------------------------------------------------------------
+void vtkSlicerApplicationLogic::TerminateTaskThreads()
+{
+  if (this->ProcessingThreadIDs.empty() && this->NetworkingThreadIDs.empty())
+    {
+    return;
+    }
+  // Wake up the idle threads, the busy ones stop after their current task.
+  this->ProcessingTaskQueueLock.Lock();
+  this->ProcessingThreadActive = false;
+  this->ProcessingTaskQueueCondition->Broadcast();
+  this->ProcessingTaskQueueLock.Unlock();
 
-    std::vector<int>::const_iterator idIterator;
-    idIterator = this->NetworkingThreadIDs.begin();
-    while (idIterator != this->NetworkingThreadIDs.end())
-      {
-      this->ProcessingThreader->TerminateThread( *idIterator );
-      ++idIterator;
-      }
-    this->NetworkingThreadIDs.clear();
+  // Note that TerminateThread does not kill a thread, it only waits
+  // for the thread to finish.
+  std::vector<int>::const_iterator idIterator;
+  for (idIterator = this->ProcessingThreadIDs.begin();
+       idIterator != this->ProcessingThreadIDs.end();
+       ++idIterator)
+    {
+    this->ProcessingThreader->TerminateThread( *idIterator );
+    }
+  this->ProcessingThreadIDs.clear();
 
+  for (idIterator = this->NetworkingThreadIDs.begin();
+       idIterator != this->NetworkingThreadIDs.end();
+       ++idIterator)
+    {
+    this->ProcessingThreader->TerminateThread( *idIterator );
     }
+  this->NetworkingThreadIDs.clear();
 }
 
 //----------------------------------------------------------------------------
@@ -414,50 +509,90 @@ vtkSlicerApplicationLogic
 //----------------------------------------------------------------------------
 void vtkSlicerApplicationLogic::ProcessProcessingTasks()
 {
-  int active = true;
-  vtkSmartPointer<vtkSlicerTask> task = 0;
+  int cores = 0;
+  unsigned int memory = 0;
 
-  while (active)
+  this->ProcessingTaskQueueLock.Lock();
+  while (this->ProcessingThreadActive)
     {
-    // Check to see if we should be shutting down
-    this->ProcessingThreadActiveLock->Lock();
-    active = this->ProcessingThreadActive;
-    this->ProcessingThreadActiveLock->Unlock();
-
-    if (active)
+    // pull a task off the queue
+    vtkSmartPointer<vtkSlicerTask> task = this->PopProcessingTask(cores, memory);
+    if (!task)
       {
-      // pull a task off the queue
-      this->ProcessingTaskQueueLock->Lock();
-      if ((*this->InternalTaskQueue).size() > 0)
-        {
-        // std::cout << "Number of queued tasks: " << (*this->InternalTaskQueue).size() << std::endl;
+      // sleep until a task is queued, cancelled or done
+      this->ProcessingTaskQueueCondition->Wait(&this->ProcessingTaskQueueLock);
+      continue;
+      }
+    this->ProcessingTaskQueueLock.Unlock();
 
-        // only handle processing tasks in this thread
-        task = (*this->InternalTaskQueue).front();
-        if ( task->GetType() == vtkSlicerTask::Processing )
-          {
-          (*this->InternalTaskQueue).pop();
-          }
-        else
-          {
-          task = NULL;
-          }
-        }
-      this->ProcessingTaskQueueLock->Unlock();
+    task->Execute();
+    task = 0;
 
-      // process the task (should this be in a separate thread?)
-      if (task)
-        {
-        task->Execute();
-        task = 0;
-        }
-      }
+    // give back the resources of the task, they may let queued tasks start
+    this->ProcessingTaskQueueLock.Lock();
+    --this->NumberOfRunningTasks;
+    this->UsedProcessingCores -= cores;
+    this->UsedProcessingMemory -= memory;
+    this->ProcessingTaskQueueCondition->Broadcast();
+    }
+  this->ProcessingTaskQueueLock.Unlock();
+}
 
-    // busy wait
-    itksys::SystemTools::Delay(100);
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkSlicerTask> vtkSlicerApplicationLogic
+::PopProcessingTask(int& cores, unsigned int& memory)
+{
+  cores = 0;
+  memory = 0;
+  // Cancelled tasks are run first, they don't need any resource.
+  ProcessingTaskQueue::iterator it;
+  for (it = this->InternalTaskQueue->begin();
+       it != this->InternalTaskQueue->end(); ++it)
+    {
+    if (it->Cancelled && it->Task->GetType() == vtkSlicerTask::Processing)
+      {
+      vtkSmartPointer<vtkSlicerTask> task = it->Task;
+      this->InternalTaskQueue->erase(it);
+      ++this->NumberOfRunningTasks;
+      return task;
+      }
+    }
+  // Tasks are started in the queue order: a task waiting for resources is
+  // not overtaken by a smaller task.
+  for (it = this->InternalTaskQueue->begin();
+       it != this->InternalTaskQueue->end(); ++it)
+    {
+    if (it->Task->GetType() == vtkSlicerTask::Processing)
+      {
+      break;
+      }
+    }
+  if (it == this->InternalTaskQueue->end())
+    {
+    return 0;
     }
+  vtkSmartPointer<vtkSlicerTask> task = it->Task;
+  // A task larger than the limits is run alone.
+  bool idle = this->NumberOfRunningTasks == 0;
+  if (!idle &&
+      (this->UsedProcessingCores + task->GetNumberOfThreads()
+         > this->NumberOfProcessingCores ||
+       (this->ProcessingMemoryLimit != 0 &&
+        this->UsedProcessingMemory + task->GetRequiredMemory()
+          > this->ProcessingMemoryLimit)))
+    {
+    return 0;
+    }
+  this->InternalTaskQueue->erase(it);
+  cores = task->GetNumberOfThreads();
+  memory = task->GetRequiredMemory();
+  ++this->NumberOfRunningTasks;
+  this->UsedProcessingCores += cores;
+  this->UsedProcessingMemory += memory;
+  return task;
 }
 
+//----------------------------------------------------------------------------
 ITK_THREAD_RETURN_TYPE
 vtkSlicerApplicationLogic
 ::NetworkingThreaderCallback( void *arg )
@@ -490,74 +625,295 @@ vtkSlicerApplicationLogic
 //----------------------------------------------------------------------------
 void vtkSlicerApplicationLogic::ProcessNetworkingTasks()
 {
-  int active = true;
-  vtkSmartPointer<vtkSlicerTask> task = 0;
+  this->ProcessingTaskQueueLock.Lock();
+  while (this->ProcessingThreadActive)
+    {
+    // only handle networking tasks in this thread
+    vtkSmartPointer<vtkSlicerTask> task = this->PopNetworkingTask();
+    if (!task)
+      {
+      // sleep until a task is queued
+      this->ProcessingTaskQueueCondition->Wait(&this->ProcessingTaskQueueLock);
+      continue;
+      }
+    this->ProcessingTaskQueueLock.Unlock();
+
+    task->Execute();
+    task = 0;
+
+    this->ProcessingTaskQueueLock.Lock();
+    }
+  this->ProcessingTaskQueueLock.Unlock();
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkSlicerTask> vtkSlicerApplicationLogic::PopNetworkingTask()
+{
+  ProcessingTaskQueue::iterator it;
+  for (it = this->InternalTaskQueue->begin();
+       it != this->InternalTaskQueue->end(); ++it)
+    {
+    if (it->Task->GetType() == vtkSlicerTask::Networking)
+      {
+      vtkSmartPointer<vtkSlicerTask> task = it->Task;
+      this->InternalTaskQueue->erase(it);
+      return task;
+      }
+    }
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+ITK_THREAD_RETURN_TYPE
+vtkSlicerApplicationLogic
+::ReadStorableNodesDataThreaderCallback( void *arg )
+{
+  StorableNodeReadJobs* jobs = reinterpret_cast<StorableNodeReadJobs*>(
+    ((itk::MultiThreader::ThreadInfoStruct *)(arg))->UserData);
+
+  while (true)
+    {
+    // pull a job off the list
+    jobs->Lock->Lock();
+    size_t jobIndex = jobs->NextJob++;
+    jobs->Lock->Unlock();
+    if (jobIndex >= jobs->Jobs.size())
+      {
+      break;
+      }
+    StorableNodeReadJob& job = jobs->Jobs[jobIndex];
+    try
+      {
+      // the copies are not in the scene and are not observed, no event is
+      // propagated to the main thread.
+      job.Result = job.TemporaryStorageNode->ReadData(job.TemporaryNode);
+      }
+    catch (...)
+      {
+      job.Result = 0;
+      }
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerApplicationLogic::ImportSceneWithParallelRead(
+  const char* filename, int numberOfThreads)
+{
+  vtkMRMLScene* scene = this->GetMRMLScene();
+  if (!scene || !filename)
+    {
+    return 0;
+    }
+  std::vector<vtkMRMLNode*> nodesBeforeImport;
+  scene->GetNodesByClass("vtkMRMLStorableNode", nodesBeforeImport);
+  std::sort(nodesBeforeImport.begin(), nodesBeforeImport.end());
+
+  int readDataOnLoad = scene->GetReadDataOnLoad();
+  scene->SetReadDataOnLoad(0);
+  scene->SetURL(filename);
+  int res = scene->Import();
+  scene->SetReadDataOnLoad(readDataOnLoad);
+  if (!readDataOnLoad)
+    {
+    return res;
+    }
 
-  while (active)
+  std::vector<vtkMRMLNode*> nodesAfterImport;
+  scene->GetNodesByClass("vtkMRMLStorableNode", nodesAfterImport);
+  std::vector<vtkMRMLStorableNode*> importedNodes;
+  std::vector<vtkMRMLNode*>::const_iterator it;
+  for (it = nodesAfterImport.begin(); it != nodesAfterImport.end(); ++it)
+    {
+    if (!std::binary_search(nodesBeforeImport.begin(), nodesBeforeImport.end(), *it))
+      {
+      importedNodes.push_back(vtkMRMLStorableNode::SafeDownCast(*it));
+      }
+    }
+  if (this->ReadStorableNodesData(importedNodes, numberOfThreads) > 0)
     {
-    // Check to see if we should be shutting down
-    this->ProcessingThreadActiveLock->Lock();
-    active = this->ProcessingThreadActive;
-    this->ProcessingThreadActiveLock->Unlock();
+    res = 0;
+    }
+  return res;
+}
 
-    if (active)
+//----------------------------------------------------------------------------
+int vtkSlicerApplicationLogic::ReadStorableNodesData(
+  const std::vector<vtkMRMLStorableNode*>& nodes, int numberOfThreads)
+{
+  vtkMRMLScene* scene = this->GetMRMLScene();
+  StorableNodeReadJobs jobs;
+  std::vector<StorableNodeReadJob> mainThreadJobs;
+
+  std::vector<vtkMRMLStorableNode*>::const_iterator it;
+  for (it = nodes.begin(); it != nodes.end(); ++it)
+    {
+    vtkMRMLStorableNode* node = *it;
+    if (!node || !node->GetAddToScene())
       {
-      // pull a task off the queue
-      this->ProcessingTaskQueueLock->Lock();
-      if ((*this->InternalTaskQueue).size() > 0)
+      continue;
+      }
+    for (int i = 0; i < node->GetNumberOfStorageNodes(); ++i)
+      {
+      StorableNodeReadJob job;
+      job.Node = node;
+      job.StorageNode = node->GetNthStorageNode(i);
+      if (!job.StorageNode)
         {
-        // std::cout << "Number of queued tasks: " << (*this->InternalTaskQueue).size() << std::endl;
-        task = (*this->InternalTaskQueue).front();
-        if ( task->GetType() == vtkSlicerTask::Networking )
-          {
-          (*this->InternalTaskQueue).pop();
-          }
-        else
-          {
-          task = NULL;
-          }
+        continue;
         }
-      this->ProcessingTaskQueueLock->Unlock();
-
-      // process the task (should this be in a separate thread?)
-      if (task)
+      // remote files are staged by the cache manager and file lists are
+      // relative to the scene root directory: read them in the main thread
+      if ((job.StorageNode->GetURI() && strcmp(job.StorageNode->GetURI(), "")) ||
+          job.StorageNode->GetNumberOfFileNames() > 0 ||
+          job.StorageNode->GetFileName() == NULL)
         {
-        task->Execute();
-        task = 0;
+        mainThreadJobs.push_back(job);
+        continue;
         }
+      job.TemporaryNode.TakeReference(
+        vtkMRMLStorableNode::SafeDownCast(node->CreateNodeInstance()));
+      job.TemporaryNode->Copy(node);
+      job.TemporaryStorageNode.TakeReference(
+        vtkMRMLStorageNode::SafeDownCast(job.StorageNode->CreateNodeInstance()));
+      job.TemporaryStorageNode->Copy(job.StorageNode);
+      // the temporary storage node is not in the scene, it can't resolve
+      // the path relative to the scene root directory
+      job.TemporaryStorageNode->SetFileName(
+        job.StorageNode->GetFullNameFromFileName().c_str());
+      jobs.Jobs.push_back(job);
       }
+    }
 
-    // busy wait
-    itksys::SystemTools::Delay(100);
+  if (jobs.Jobs.size() > 0)
+    {
+    if (numberOfThreads <= 0)
+      {
+      numberOfThreads = itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+      }
+    numberOfThreads = std::min(numberOfThreads, static_cast<int>(jobs.Jobs.size()));
+    itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+    threader->SetNumberOfThreads(numberOfThreads);
+    threader->SetSingleMethod(
+      vtkSlicerApplicationLogic::ReadStorableNodesDataThreaderCallback, &jobs);
+    threader->SingleMethodExecute();
     }
+
+  int errors = 0;
+  std::vector<StorableNodeReadJob>::iterator jit;
+  for (jit = jobs.Jobs.begin(); jit != jobs.Jobs.end(); ++jit)
+    {
+    StorableNodeReadJob& job = *jit;
+    if (!job.Result)
+      {
+      ++errors;
+      if (scene)
+        {
+        scene->SetErrorCode(1);
+        scene->SetErrorMessage(std::string("Error reading file ") +
+                               job.StorageNode->GetFileName());
+        }
+      continue;
+      }
+    // Copy() resets the node references, restore the storage nodes
+    std::vector<std::string> storageNodeIDs;
+    for (int i = 0; i < job.Node->GetNumberOfStorageNodes(); ++i)
+      {
+      const char* id = job.Node->GetNthStorageNodeID(i);
+      storageNodeIDs.push_back(id ? id : "");
+      }
+    int wasModifying = job.Node->StartModify();
+    job.Node->Copy(job.TemporaryNode);
+    for (size_t i = 0; i < storageNodeIDs.size(); ++i)
+      {
+      job.Node->SetAndObserveNthStorageNodeID(static_cast<int>(i),
+        storageNodeIDs[i].empty() ? 0 : storageNodeIDs[i].c_str());
+      }
+    job.Node->EndModify(wasModifying);
+    job.StorageNode->SetReadStateIdle();
+    job.StorageNode->StoredTimeModified();
+    }
+  for (jit = mainThreadJobs.begin(); jit != mainThreadJobs.end(); ++jit)
+    {
+    if (jit->StorageNode->ReadData(jit->Node) == 0)
+      {
+      ++errors;
+      if (scene)
+        {
+        const char* fname = jit->StorageNode->GetFileName() ?
+          jit->StorageNode->GetFileName() : jit->StorageNode->GetURI();
+        scene->SetErrorCode(1);
+        scene->SetErrorMessage(std::string("Error reading file ") +
+                               (fname ? fname : "(null)"));
+        }
+      }
+    }
+  return errors;
 }
 
 //----------------------------------------------------------------------------
 int vtkSlicerApplicationLogic::ScheduleTask( vtkSlicerTask *task )
 {
-  int active;
-
   // std::cout << "Scheduling a task ";
 
   // only schedule a task if the processing task is up
-  this->ProcessingThreadActiveLock->Lock();
-  active = this->ProcessingThreadActive;
-  this->ProcessingThreadActiveLock->Unlock();
-
-  if (active)
+  this->ProcessingTaskQueueLock.Lock();
+  if (this->ProcessingThreadActive)
     {
-    this->ProcessingTaskQueueLock->Lock();
-    (*this->InternalTaskQueue).push( task );
+    // queue the task after the tasks of higher or same priority
+    ProcessingTaskQueue::iterator it = this->InternalTaskQueue->end();
+    while (it != this->InternalTaskQueue->begin() &&
+           (it - 1)->Task->GetPriority() < task->GetPriority())
+      {
+      --it;
+      }
+    this->InternalTaskQueue->insert(it, ProcessingTaskQueueItem(task));
     //std::cout << (*this->InternalTaskQueue).size() << std::endl;
-    this->ProcessingTaskQueueLock->Unlock();
+    // wake up the idle threads
+    this->ProcessingTaskQueueCondition->Broadcast();
+    this->ProcessingTaskQueueLock.Unlock();
 
     return true;
     }
+  this->ProcessingTaskQueueLock.Unlock();
 
   // could not schedule the task
   return false;
 }
 
+//----------------------------------------------------------------------------
+int vtkSlicerApplicationLogic::CancelTask( vtkSlicerTask *task )
+{
+  int queued = false;
+  this->ProcessingTaskQueueLock.Lock();
+  ProcessingTaskQueue::iterator it;
+  for (it = this->InternalTaskQueue->begin();
+       it != this->InternalTaskQueue->end(); ++it)
+    {
+    if (it->Task == task)
+      {
+      it->Cancelled = true;
+      queued = true;
+      // a cancelled task doesn't wait for resources
+      this->ProcessingTaskQueueCondition->Broadcast();
+      break;
+      }
+    }
+  this->ProcessingTaskQueueLock.Unlock();
+  return queued;
+}
+
+//----------------------------------------------------------------------------
+unsigned int vtkSlicerApplicationLogic::GetNumberOfQueuedTasks()
+{
+  this->ProcessingTaskQueueLock.Lock();
+  unsigned int size =
+    static_cast<unsigned int>(this->InternalTaskQueue->size());
+  this->ProcessingTaskQueueLock.Unlock();
+  return size;
+}
+
 //----------------------------------------------------------------------------
 int vtkSlicerApplicationLogic::RequestModified( vtkObject *obj )
 {
@@ -576,7 +932,7 @@ int vtkSlicerApplicationLogic::RequestModified( vtkObject *obj )
     this->ModifiedQueueLock->Lock();
     this->RequestTimeStamp.Modified();
     int uid = static_cast<int>(this->RequestTimeStamp.GetMTime());
-    (*this->InternalModifiedQueue).push( obj );
+    (*this->InternalModifiedQueue).push_back( obj );
 //     std::cout << " [" << (*this->InternalModifiedQueue).size()
 //               << "] " << std::endl;
     this->ModifiedQueueLock->Unlock();
@@ -691,36 +1047,52 @@ void vtkSlicerApplicationLogic::ProcessModified()
     return;
     }
 
-  vtkSmartPointer<vtkObject> obj = 0;
-  // pull an object off the queue to modify
+  // Take all the pending requests at once, the requests on the same object
+  // are coalesced.
+  ModifiedQueue requests;
   this->ModifiedQueueLock->Lock();
-  if ((*this->InternalModifiedQueue).size() > 0)
-    {
-    obj = (*this->InternalModifiedQueue).front();
-    (*this->InternalModifiedQueue).pop();
+  requests.swap(*this->InternalModifiedQueue);
+  this->ModifiedQueueLock->Unlock();
 
-    // pop off any extra copies of the same object to save some updates
-    while (!(*this->InternalModifiedQueue).empty()
-           && (obj == (*this->InternalModifiedQueue).front()))
+  double deadline = vtkTimerLog::GetUniversalTime() +
+    this->RequestTimeBudget / 1000.;
+  std::set<vtkObject*> queuedObjects;
+  ModifiedQueue remainingRequests;
+  while (!requests.empty())
+    {
+    vtkSmartPointer<vtkObject> obj = requests.front();
+    requests.pop_front();
+    if (!queuedObjects.insert(obj).second)
       {
-      (*this->InternalModifiedQueue).pop();
+      // already modified or kept
       obj->Delete(); // decrement ref count
+      continue;
       }
-    }
-  this->ModifiedQueueLock->Unlock();
-
-  // Modify the object
-  //  - decrement reference count that was increased when it was added to the queue
-  if (obj.GetPointer())
-    {
+    // at least one object is modified per call
+    if (!remainingRequests.empty() ||
+        (queuedObjects.size() > 1 &&
+         vtkTimerLog::GetUniversalTime() > deadline))
+      {
+      // out of time, keep it for the next call
+      remainingRequests.push_back(obj);
+      continue;
+      }
+    // Modify the object
+    //  - decrement reference count that was increased when it was added to the queue
     obj->Modified();
     obj->Delete();
-    obj = 0;
     }
 
+  // the remaining requests are older than the ones queued in the meantime
+  this->ModifiedQueueLock->Lock();
+  this->InternalModifiedQueue->insert(this->InternalModifiedQueue->begin(),
+                                      remainingRequests.begin(),
+                                      remainingRequests.end());
+  int delay = this->InternalModifiedQueue->size() > 0 ? 0: 200;
+  this->ModifiedQueueLock->Unlock();
+
   // schedule the next timer sooner in case there is stuff in the queue
   // otherwise for a while later
-  int delay = (*this->InternalModifiedQueue).size() > 0 ? 0: 200;
   this->InvokeEvent(vtkSlicerApplicationLogic::RequestModifiedEvent, &delay);
 }
 
@@ -736,36 +1108,71 @@ void vtkSlicerApplicationLogic::ProcessReadData()
     {
     return;
     }
-  ReadDataRequest req;
-  // pull an object off the queue
-  this->ReadDataQueueLock->Lock();
-  if ((*this->InternalReadDataQueue).size() > 0)
-    {
-    req = (*this->InternalReadDataQueue).front();
-    (*this->InternalReadDataQueue).pop();
-    }
-  this->ReadDataQueueLock->Unlock();
 
-  if (!req.GetNode().empty())
+  // Process the requests until the queue is empty or the time budget is
+  // spent. The nodes of several requests are added in one scene batch.
+  double deadline = vtkTimerLog::GetUniversalTime() +
+    this->RequestTimeBudget / 1000.;
+  vtkMRMLScene* scene = this->GetMRMLScene();
+  bool batch = false;
+  std::vector<int> processedUIDs;
+  int delay = 200;
+  while (true)
     {
-    if (req.GetIsScene())
+    ReadDataRequest req;
+    // pull an object off the queue
+    this->ReadDataQueueLock->Lock();
+    bool empty = (*this->InternalReadDataQueue).empty();
+    if (!empty)
       {
-      this->ProcessReadSceneData(req);
+      req = (*this->InternalReadDataQueue).front();
+      (*this->InternalReadDataQueue).pop();
       }
-    else
+    bool more = !(*this->InternalReadDataQueue).empty();
+    this->ReadDataQueueLock->Unlock();
+    if (empty)
       {
-      this->ProcessReadNodeData(req);
+      break;
       }
+
+    if (more && !batch && scene)
+      {
+      scene->StartState(vtkMRMLScene::BatchProcessState);
+      batch = true;
+      }
+    if (!req.GetNode().empty())
+      {
+      if (req.GetIsScene())
+        {
+        this->ProcessReadSceneData(req);
+        }
+      else
+        {
+        this->ProcessReadNodeData(req);
+        }
+      }
+    if (req.GetUID())
+      {
+      processedUIDs.push_back(req.GetUID());
+      }
+    if (more && vtkTimerLog::GetUniversalTime() > deadline)
+      {
+      // schedule the next timer sooner as there is stuff in the queue
+      delay = 0;
+      break;
+      }
+    }
+  if (batch)
+    {
+    scene->EndState(vtkMRMLScene::BatchProcessState);
     }
 
-  int delay = (*this->InternalReadDataQueue).size() > 0 ? 0: 200;
-  // schedule the next timer sooner in case there is stuff in the queue
-  // otherwise for a while later
   this->InvokeEvent(vtkSlicerApplicationLogic::RequestReadDataEvent, &delay);
-  if (req.GetUID())
+  for (std::vector<int>::const_iterator it = processedUIDs.begin();
+       it != processedUIDs.end(); ++it)
     {
     this->InvokeEvent(vtkSlicerApplicationLogic::RequestProcessedEvent,
-                      reinterpret_cast<void*>(req.GetUID()));
+                      reinterpret_cast<void*>(*it));
     }
 }
 
@@ -782,36 +1189,59 @@ void vtkSlicerApplicationLogic::ProcessWriteData()
     return;
     }
 
-  WriteDataRequest req;
-  // pull an object off the queue
-  this->WriteDataQueueLock->Lock();
-  if ((*this->InternalWriteDataQueue).size() > 0)
+  // Process the requests until the queue is empty or the time budget is
+  // spent.
+  double deadline = vtkTimerLog::GetUniversalTime() +
+    this->RequestTimeBudget / 1000.;
+  std::vector<int> processedUIDs;
+  int delay = 200;
+  while (true)
     {
-    req = (*this->InternalWriteDataQueue).front();
-    (*this->InternalWriteDataQueue).pop();
-
-    }
-  this->WriteDataQueueLock->Unlock();
+    WriteDataRequest req;
+    // pull an object off the queue
+    this->WriteDataQueueLock->Lock();
+    bool empty = (*this->InternalWriteDataQueue).empty();
+    if (!empty)
+      {
+      req = (*this->InternalWriteDataQueue).front();
+      (*this->InternalWriteDataQueue).pop();
+      }
+    bool more = !(*this->InternalWriteDataQueue).empty();
+    this->WriteDataQueueLock->Unlock();
+    if (empty)
+      {
+      break;
+      }
 
-  if (!req.GetNode().empty())
-    {
-    if (req.GetIsScene())
+    if (!req.GetNode().empty())
+      {
+      if (req.GetIsScene())
+        {
+        this->ProcessWriteSceneData(req);
+        }
+      else
+        {
+        this->ProcessWriteNodeData(req);
+        }
+      }
+    if (req.GetUID())
       {
-      this->ProcessWriteSceneData(req);
+      processedUIDs.push_back(req.GetUID());
       }
-    else
+    if (more && vtkTimerLog::GetUniversalTime() > deadline)
       {
-      this->ProcessWriteNodeData(req);
+      // schedule the next timer sooner as there is stuff in the queue
+      delay = 0;
+      break;
       }
     }
-  // schedule the next timer sooner in case there is stuff in the queue
-  // otherwise for a while later
-  int delay = (*this->InternalWriteDataQueue).size() > 0 ? 0: 200;
+
   this->InvokeEvent(vtkSlicerApplicationLogic::RequestWriteDataEvent, &delay);
-  if (req.GetUID())
+  for (std::vector<int>::const_iterator it = processedUIDs.begin();
+       it != processedUIDs.end(); ++it)
     {
     this->InvokeEvent(vtkSlicerApplicationLogic::RequestProcessedEvent,
-                      reinterpret_cast<void*>(req.GetUID()));
+                      reinterpret_cast<void*>(*it));
     }
 }
 
@@ -907,8 +1337,22 @@ void vtkSlicerApplicationLogic::ProcessReadNodeData(ReadDataRequest& req)
       }
     }
 
+  // volumes written by executable modules in shared memory are read
+  // without storage node
+  bool sharedMemory = vtkMRMLSharedMemoryImage::IsSharedMemoryFileName(
+    req.GetFilename().c_str());
+  if (sharedMemory && (svnd || vvnd))
+    {
+    vtkNew<vtkMRMLSharedMemoryImage> segment;
+    if (!segment->ReadVolume(req.GetFilename().c_str(),
+                             vtkMRMLVolumeNode::SafeDownCast(nd)))
+      {
+      vtkErrorMacro("ProcessReadNodeData: unable to read shared memory "
+                    << req.GetFilename());
+      }
+    }
   // if there wasn't already a matching storage node on the node, make one
-  if (!storageNodeExists)
+  else if (!storageNodeExists)
     {
     // Read the data into the referenced node
     if (itksys::SystemTools::FileExists( req.GetFilename().c_str() ))
@@ -1090,8 +1534,12 @@ void vtkSlicerApplicationLogic::ProcessReadNodeData(ReadDataRequest& req)
     if (req.GetDeleteFile())
       {
       int removed;
+      if (sharedMemory)
+        {
+        removed = vtkMRMLSharedMemoryImage::Remove(req.GetFilename().c_str());
+        }
       // is it a shared memory location?
-      if (req.GetFilename().find("slicer:") != std::string::npos)
+      else if (req.GetFilename().find("slicer:") != std::string::npos)
         {
         removed = 1;
         }
@@ -1299,8 +1747,7 @@ void vtkSlicerApplicationLogic::ProcessReadSceneData(ReadDataRequest& req)
     // sizes. Just import the scene. (This is where we would put to
     // the code to load into a node heirarchy (with a corresponding
     // change in the conditional above)).
-    this->GetMRMLScene()->SetURL( req.GetFilename().c_str() );
-    this->GetMRMLScene()->Import();
+    this->ImportSceneWithParallelRead( req.GetFilename().c_str() );
 
     // Delete the file if requested
     if (req.GetDeleteFile())
@@ -29,11 +29,13 @@
 #include <vtkSmartPointer.h>
 
 // ITK includes
+#include <itkConditionVariable.h>
 #include <itkMultiThreader.h>
 #include <itkMutexLock.h>
 
 class vtkMRMLSelectionNode;
 class vtkMRMLInteractionNode;
+class vtkMRMLStorableNode;
 class vtkSlicerTask;
 class ModifiedQueue;
 class ProcessingTaskQueue;
@@ -56,11 +58,38 @@ class VTK_SLICER_BASE_LOGIC_EXPORT vtkSlicerApplicationLogic
   /// (display it in the Fiducials GUI)
   void PropagateFiducialListSelection();
 
-  /// Create a thread for processing
+  /// Create the threads for processing
+  /// \sa SetNumberOfProcessingThreads()
   void CreateProcessingThread();
 
-  /// Shutdown the processing thread
+  /// Shutdown the processing threads
   void TerminateProcessingThread();
+
+  /// Number of threads running the processing tasks concurrently.
+  /// Must be set before CreateProcessingThread() is called.
+  /// 0 sizes the threads to the machine: one per processing core.
+  /// 1 by default: the tasks are run one after the other.
+  /// \sa SetNumberOfProcessingCores()
+  void SetNumberOfProcessingThreads(int numberOfThreads);
+  vtkGetMacro(NumberOfProcessingThreads, int);
+
+  /// Number of cores shared by the running processing tasks. A task is not
+  /// started until enough cores are available for its
+  /// vtkSlicerTask::GetNumberOfThreads(), unless no other task is running.
+  /// itk::MultiThreader::GetGlobalDefaultNumberOfThreads() by default.
+  vtkSetClampMacro(NumberOfProcessingCores, int, 1, VTK_INT_MAX);
+  vtkGetMacro(NumberOfProcessingCores, int);
+
+  /// Memory in MB shared by the running processing tasks. A task is not
+  /// started until enough memory is available for its
+  /// vtkSlicerTask::GetRequiredMemory(), unless no other task is running.
+  /// 0 (no limit) by default.
+  vtkSetMacro(ProcessingMemoryLimit, unsigned int);
+  vtkGetMacro(ProcessingMemoryLimit, unsigned int);
+
+  /// Share of the processing cores of a task that doesn't declare its
+  /// number of threads: NumberOfProcessingCores / NumberOfProcessingThreads.
+  int GetDefaultNumberOfThreadsPerTask();
   /// List of events potentially fired by the application logic
   enum RequestEvents
     {
@@ -77,8 +106,21 @@ class VTK_SLICER_BASE_LOGIC_EXPORT vtkSlicerApplicationLogic
   /// Schedule a task to run in the processing thread. Returns true if
   /// task was successfully scheduled. ScheduleTask() is called from the
   /// main thread to run something in the processing thread.
+  /// The tasks are queued by vtkSlicerTask::GetPriority().
   int ScheduleTask( vtkSlicerTask* );
 
+  /// Run \a task as soon as a processing thread is free, without waiting
+  /// for the cores and memory it requires. The task function is still
+  /// called: it is responsible for returning early (e.g. the CLI logic
+  /// checks the Cancelling status of its node).
+  /// Return true if the task was queued and not started yet.
+  int CancelTask( vtkSlicerTask* );
+
+  /// Number of tasks scheduled but not started yet.
+  unsigned int GetNumberOfQueuedTasks();
+  /// Number of processing tasks being run.
+  vtkGetMacro(NumberOfRunningTasks, int);
+
   /// Request a Modified call on an object.  This method allows a
   /// processing thread to request a Modified call on an object to be
   /// performed in the main thread.  This allows the call to Modified
@@ -133,19 +175,49 @@ class VTK_SLICER_BASE_LOGIC_EXPORT vtkSlicerApplicationLogic
                        int displayData = false,
                        int deleteFile = false);
 
-  /// Process a request on the Modified queue.  This method is called
+  /// Import the scene file \a filename into the MRML scene and read the
+  /// data of the imported storable nodes using ReadStorableNodesData().
+  /// Return the result of vtkMRMLScene::Import().
+  /// \sa ReadStorableNodesData(), vtkMRMLScene::SetReadDataOnLoad()
+  int ImportSceneWithParallelRead(const char* filename,
+                                  int numberOfThreads = 0);
+
+  /// Read the data of the storable nodes from their storage nodes using
+  /// \a numberOfThreads threads (0 for the ITK default number of threads).
+  /// Each file is read into a detached copy of its storable node (not in the
+  /// scene and not observed) in a worker thread, the result is then copied
+  /// back into the node in the main thread. Nodes that can't be read that way
+  /// (remote URI, multiple files) are read in the main thread.
+  /// Return the number of nodes that failed to be read.
+  int ReadStorableNodesData(const std::vector<vtkMRMLStorableNode*>& nodes,
+                            int numberOfThreads = 0);
+
+  /// Time in ms ProcessModified(), ProcessReadData() and ProcessWriteData()
+  /// spend processing the queued requests at each call. At least one request
+  /// is processed per call, the next call is scheduled right away if
+  /// requests remain. 20 by default.
+  vtkSetClampMacro(RequestTimeBudget, int, 0, VTK_INT_MAX);
+  vtkGetMacro(RequestTimeBudget, int);
+
+  /// Process the requests on the Modified queue.  This method is called
   /// in the main thread of the application because calls to Modified()
   /// can cause an update to the GUI. (Method needs to be public to fit
   /// in the event callback chain.)
+  /// The requests on the same object are coalesced: it is modified once.
+  /// \sa SetRequestTimeBudget()
   void ProcessModified();
 
-  /// Process a request to read data and set it on a referenced node.
+  /// Process the requests to read data and set it on a referenced node.
   /// This method is called in the main thread of the application
   /// because calls to load data will cause a Modified() on a node
-  /// which can force a render.
+  /// which can force a render. When several requests are processed, the
+  /// scene is in BatchProcessState and RequestProcessedEvent is invoked
+  /// for each request once they are all done.
+  /// \sa SetRequestTimeBudget()
   void ProcessReadData();
 
-  /// Process a request to write data from a referenced node.
+  /// Process the requests to write data from a referenced node.
+  /// \sa SetRequestTimeBudget()
   void ProcessWriteData();
 
   /// These routings act as place holders so that test scripts can
@@ -188,12 +260,32 @@ protected:
   /// Callback used by a MultiThreader to start a networking thread
   static ITK_THREAD_RETURN_TYPE NetworkingThreaderCallback( void * );
 
-  /// Task processing loop that is run in the processing thread
+  /// Task processing loop that is run in the processing threads
   void ProcessProcessingTasks();
 
+  /// Remove from the queue and return the next processing task to run or 0
+  /// if none can be started with the available cores and memory.
+  /// \a cores and \a memory are set to the resources reserved for the task.
+  /// Must be called with ProcessingTaskQueueLock locked.
+  /// The idle threads wait on ProcessingTaskQueueCondition, that is
+  /// broadcast when a task is queued, cancelled or done.
+  vtkSmartPointer<vtkSlicerTask> PopProcessingTask(int& cores,
+                                                   unsigned int& memory);
+
   /// Networking Task processing loop that is run in a networking thread
   void ProcessNetworkingTasks();
 
+  /// Remove from the queue and return the next networking task or 0.
+  /// Must be called with ProcessingTaskQueueLock locked.
+  vtkSmartPointer<vtkSlicerTask> PopNetworkingTask();
+
+  /// Stop the processing and networking threads and wait for them.
+  void TerminateTaskThreads();
+
+  /// Callback used by a MultiThreader to read storable nodes data
+  /// \sa ReadStorableNodesData()
+  static ITK_THREAD_RETURN_TYPE ReadStorableNodesDataThreaderCallback( void * );
+
   /// Process a request to read data into a node.  This method is
   /// called by ProcessReadData() in the application main thread
   /// because calls to load data will cause a Modified() on a node
@@ -213,8 +305,10 @@ private:
   void operator=(const vtkSlicerApplicationLogic&);
 
   itk::MultiThreader::Pointer ProcessingThreader;
-  itk::MutexLock::Pointer ProcessingThreadActiveLock;
-  itk::MutexLock::Pointer ProcessingTaskQueueLock;
+  /// Protects the task queue, the resources of the running tasks and
+  /// ProcessingThreadActive
+  itk::SimpleMutexLock ProcessingTaskQueueLock;
+  itk::ConditionVariable::Pointer ProcessingTaskQueueCondition;
   itk::MutexLock::Pointer ModifiedQueueActiveLock;
   itk::MutexLock::Pointer ModifiedQueueLock;
   itk::MutexLock::Pointer ReadDataQueueActiveLock;
@@ -222,8 +316,16 @@ private:
   itk::MutexLock::Pointer WriteDataQueueActiveLock;
   itk::MutexLock::Pointer WriteDataQueueLock;
   vtkTimeStamp RequestTimeStamp;
-  int ProcessingThreadId;
+  std::vector<int> ProcessingThreadIDs;
   std::vector<int> NetworkingThreadIDs;
+  int NumberOfProcessingThreads;
+  int NumberOfProcessingCores;
+  unsigned int ProcessingMemoryLimit;
+  int RequestTimeBudget;
+  /// Resources of the running tasks
+  int NumberOfRunningTasks;
+  int UsedProcessingCores;
+  unsigned int UsedProcessingMemory;
   int ProcessingThreadActive;
   int ModifiedQueueActive;
   int ReadDataQueueActive;
@@ -48,6 +48,27 @@ public:
     return "Unknown";
   }
 
+  /// 
+  /// Number of cores the task uses, the processing threads don't start
+  /// the task until as many cores are available.
+  /// 1 by default.
+  /// \sa vtkSlicerApplicationLogic::SetNumberOfProcessingCores()
+  vtkSetClampMacro (NumberOfThreads, int, 1, VTK_INT_MAX);
+  vtkGetMacro (NumberOfThreads, int);
+
+  /// 
+  /// Memory in MB the task needs, the processing threads don't start
+  /// the task until as much memory is available. 0 by default.
+  /// \sa vtkSlicerApplicationLogic::SetProcessingMemoryLimit()
+  vtkSetMacro (RequiredMemory, unsigned int);
+  vtkGetMacro (RequiredMemory, unsigned int);
+
+  /// 
+  /// Tasks with a higher priority are started first, tasks with the same
+  /// priority are started in the order they are scheduled. 0 by default.
+  vtkSetMacro (Priority, int);
+  vtkGetMacro (Priority, int);
+
 protected:
   vtkSlicerTask();
   virtual ~vtkSlicerTask();
@@ -60,6 +81,9 @@ private:
   void *TaskClientData;
   
   int Type;
+  int NumberOfThreads;
+  unsigned int RequiredMemory;
+  int Priority;
   
 };
 #endif
@@ -144,6 +144,65 @@ def PushToSlicer(sitkimage, NodeName, compositeView=0, overwrite=False):
     applicationLogic = slicer.app.applicationLogic()
     applicationLogic.FitSliceToAll()
 
+def GetSlicerVolumeGeometry(volumeNode):
+    """ Return the origin, spacing and direction of a volume node in the
+            LPS coordinates of ITK.  The direction is a tuple of the 9
+            elements of the direction matrix, row after row.
+    """
+    directions = vtk.vtkMatrix4x4()
+    volumeNode.GetIJKToRASDirectionMatrix(directions)
+    rasToLps = (-1., -1., 1.)
+    origin = [ rasToLps[i] * volumeNode.GetOrigin()[i] for i in range(3) ]
+    direction = [ rasToLps[i] * directions.GetElement(i, j)
+                  for i in range(3) for j in range(3) ]
+    return tuple(origin), tuple(volumeNode.GetSpacing()), tuple(direction)
+
+def PullVolumeFromSlicer(volumeNode):
+    """ Given a slicer MRML scalar volume node (or its name), return the
+            SimpleITK image object.  The voxels are imported from a numpy
+            view of the node image data with a single copy, without
+            going through the MRML ITK IO.
+    """
+    if isinstance(volumeNode, basestring):
+        volumeNode = slicer.util.getNode(volumeNode)
+    checkVolumeNodeType(volumeNode.GetClassName())
+    sitkimage = sitk.GetImageFromArray(slicer.util.arrayFromVolume(volumeNode))
+    origin, spacing, direction = GetSlicerVolumeGeometry(volumeNode)
+    sitkimage.SetOrigin(origin)
+    sitkimage.SetSpacing(spacing)
+    sitkimage.SetDirection(direction)
+    return sitkimage
+
+def PushVolumeToSlicer(sitkimage, volumeNode, tolerance=1e-6):
+    """ Write a SimpleITK image back into an existing slicer MRML scalar
+            volume node (or the node of the given name).  When the image
+            has the dimensions, pixel type and geometry of the volume, the
+            voxels are copied in place into the node image data, that is
+            not reallocated and keeps its observers.  Otherwise the image
+            replaces the node image data through the MRML ITK IO.
+    """
+    if isinstance(volumeNode, basestring):
+        volumeNode = slicer.util.getNode(volumeNode)
+    checkVolumeNodeType(volumeNode.GetClassName())
+    voxels = slicer.util.arrayFromVolume(volumeNode)
+    sameGeometry = False
+    if voxels is not None:
+        geometry = GetSlicerVolumeGeometry(volumeNode)
+        imageGeometry = (sitkimage.GetOrigin(), sitkimage.GetSpacing(), sitkimage.GetDirection())
+        sameGeometry = (tuple(sitkimage.GetSize()) == tuple(reversed(voxels.shape)) and
+                        all(abs(a - b) <= tolerance
+                            for expected, actual in zip(geometry, imageGeometry)
+                            for a, b in zip(expected, actual)))
+    if sameGeometry:
+        sitkvoxels = sitk.GetArrayFromImage(sitkimage)
+        if sitkvoxels.dtype == voxels.dtype:
+            voxels[:] = sitkvoxels
+            slicer.util.arrayFromVolumeModified(volumeNode)
+            return volumeNode
+    EnsureRegistration()
+    sitk.WriteImage(sitkimage, GetSlicerITKReadWriteAddress(volumeNode.GetID()))
+    return volumeNode
+
 # Helper functions
 def PushBackground(sitkImage, nodeName, overwrite=False):
     PushToSlicer(sitkImage, nodeName, 0, overwrite)
@@ -23,3 +23,194 @@ def runUnitTest(path, testname):
   result = unittest.TextTestRunner(verbosity=2).run(suite)
   if not result.wasSuccessful():
     exitFailure()
+
+#
+# Performance testing
+#
+
+class Benchmark(object):
+  """A named piece of code to time.
+
+  The function is called ``warmup`` times without being timed, then
+  ``repetitions`` times. ``setUp`` and ``tearDown`` are called around each
+  call and are not timed.
+  """
+  def __init__(self, name, function, repetitions=5, warmup=1,
+               setUp=None, tearDown=None):
+    self.name = name
+    self.function = function
+    self.repetitions = repetitions
+    self.warmup = warmup
+    self.setUp = setUp
+    self.tearDown = tearDown
+
+def memoryUsage():
+  """Return the resident memory of the process in KB, None if unknown."""
+  try:
+    for line in open('/proc/self/status'):
+      if line.startswith('VmRSS:'):
+        return int(line.split()[1])
+  except (IOError, ValueError):
+    pass
+  try:
+    import resource
+    import sys
+    # peak usage only, in bytes on Mac
+    maxrss = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+    return maxrss / 1024 if sys.platform == 'darwin' else maxrss
+  except ImportError:
+    return None
+
+def percentile(values, fraction):
+  """Return the percentile of the values, linearly interpolated."""
+  values = sorted(values)
+  if not values:
+    return None
+  position = (len(values) - 1) * fraction
+  lower = int(position)
+  upper = min(lower + 1, len(values) - 1)
+  return values[lower] + (values[upper] - values[lower]) * (position - lower)
+
+def runBenchmark(benchmark):
+  """Run the benchmark and return its result: times in seconds and
+  memory delta in KB."""
+  import time
+  def processEvents():
+    try:
+      import slicer
+      slicer.app.processEvents()
+    except (ImportError, AttributeError):
+      pass
+
+  def call():
+    if benchmark.setUp:
+      benchmark.setUp()
+    startTime = time.time()
+    benchmark.function()
+    processEvents()
+    elapsedTime = time.time() - startTime
+    if benchmark.tearDown:
+      benchmark.tearDown()
+    return elapsedTime
+
+  for i in xrange(benchmark.warmup):
+    call()
+  startMemory = memoryUsage()
+  times = [call() for i in xrange(benchmark.repetitions)]
+  endMemory = memoryUsage()
+  memoryDelta = None
+  if startMemory is not None and endMemory is not None:
+    memoryDelta = endMemory - startMemory
+  return {
+    'repetitions': len(times),
+    'times': times,
+    'min': min(times) if times else None,
+    'max': max(times) if times else None,
+    'mean': sum(times) / len(times) if times else None,
+    'median': percentile(times, 0.5),
+    'p90': percentile(times, 0.9),
+    'memoryDelta': memoryDelta,
+    }
+
+def currentBuild():
+  """Return the key identifying the running build in the history:
+  the repository revision and the platform of the application."""
+  try:
+    import slicer
+    return '%s-%s' % (slicer.app.repositoryRevision, slicer.app.platform)
+  except (ImportError, AttributeError):
+    import platform
+    return 'unknown-%s' % platform.platform()
+
+def loadPerformanceHistory(fileName):
+  """Return the history saved in the JSON file: results of each
+  benchmark keyed by build, or an empty history if there is no file."""
+  import json
+  import os
+  if not fileName or not os.path.exists(fileName):
+    return {}
+  with open(fileName) as historyFile:
+    return json.load(historyFile)
+
+def savePerformanceHistory(fileName, history):
+  import json
+  with open(fileName, 'w') as historyFile:
+    json.dump(history, historyFile, indent=2, sort_keys=True)
+
+def comparePerformance(results, baseline, threshold=0.1, memoryThreshold=None,
+                       statistic='median'):
+  """Return the regressions of the results compared to the baseline
+  results, as a list of messages.
+
+  A benchmark regresses if its statistic is more than ``threshold``
+  (relative) above the baseline, or if its memory delta is more than
+  ``memoryThreshold`` KB above the baseline. Benchmarks missing from
+  the baseline are not compared.
+  """
+  regressions = []
+  for name in sorted(results):
+    if name not in baseline:
+      continue
+    value = results[name].get(statistic)
+    reference = baseline[name].get(statistic)
+    if value is not None and reference and value > reference * (1. + threshold):
+      regressions.append('%s: %s %g s, baseline %g s (+%.0f%%)' % (
+        name, statistic, value, reference, 100. * (value / reference - 1.)))
+    memory = results[name].get('memoryDelta')
+    memoryReference = baseline[name].get('memoryDelta')
+    if (memoryThreshold is not None and memory is not None and
+        memoryReference is not None and memory > memoryReference + memoryThreshold):
+      regressions.append('%s: memory delta %d KB, baseline %d KB' % (
+        name, memory, memoryReference))
+  return regressions
+
+def runBenchmarks(benchmarks, historyFile=None, build=None, baselineBuild=None,
+                  threshold=0.1, memoryThreshold=None):
+  """Run the benchmarks, record their results for the build in the history
+  file and compare them to the results of the baseline build (by default
+  the last other build of the history).
+  Return the regressions, see comparePerformance()."""
+  if build is None:
+    build = currentBuild()
+  history = loadPerformanceHistory(historyFile)
+  results = {}
+  for benchmark in benchmarks:
+    results[benchmark.name] = runBenchmark(benchmark)
+    print "%s: median %g s, p90 %g s, memory delta %s KB" % (
+      benchmark.name, results[benchmark.name]['median'],
+      results[benchmark.name]['p90'], results[benchmark.name]['memoryDelta'])
+
+  if baselineBuild is None:
+    previousBuilds = [key for key in history.get('builds', []) if key != build]
+    if previousBuilds:
+      baselineBuild = previousBuilds[-1]
+  regressions = []
+  if baselineBuild in history.get('results', {}):
+    regressions = comparePerformance(results, history['results'][baselineBuild],
+                                     threshold, memoryThreshold)
+
+  if historyFile:
+    builds = [key for key in history.get('builds', []) if key != build]
+    history['builds'] = builds + [build]
+    history.setdefault('results', {}).setdefault(build, {}).update(results)
+    savePerformanceHistory(historyFile, history)
+  return regressions
+
+def runPerformanceTest(path, testname, historyFile=None, baselineBuild=None,
+                       threshold=0.1, memoryThreshold=None):
+  """Run the benchmarks returned by the benchmarks() function of the module
+  ``testname`` and fail if any regresses. See runBenchmarks()."""
+  import sys
+  if isinstance(path, basestring):
+    sys.path.append(path)
+  else:
+    sys.path.extend(path)
+  print "-------------------------------------------"
+  print "path: %s\ntestname: %s" % (path, testname)
+  print "-------------------------------------------"
+  module = __import__(testname)
+  regressions = runBenchmarks(module.benchmarks(), historyFile,
+                              baselineBuild=baselineBuild, threshold=threshold,
+                              memoryThreshold=memoryThreshold)
+  if regressions:
+    exitFailure('Performance regressions:\n' + '\n'.join(regressions))
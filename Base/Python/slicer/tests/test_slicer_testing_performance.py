@@ -0,0 +1,59 @@
+import unittest
+import slicer
+import slicer.testing
+import os
+
+
+class SlicerTestingPerformanceTests(unittest.TestCase):
+
+  def setUp(self):
+    self.historyFile = slicer.app.temporaryPath + '/SlicerTestingPerformanceTests.json'
+    try:
+      os.remove(self.historyFile)
+    except OSError:
+      pass
+    self.calls = 0
+
+  def count(self):
+    self.calls += 1
+
+  def test_percentile(self):
+    values = [4., 1., 3., 2.]
+    self.assertEqual(slicer.testing.percentile(values, 0.), 1.)
+    self.assertEqual(slicer.testing.percentile(values, 1.), 4.)
+    self.assertEqual(slicer.testing.percentile(values, 0.5), 2.5)
+    self.assertEqual(slicer.testing.percentile([], 0.5), None)
+
+  def test_runBenchmark(self):
+    benchmark = slicer.testing.Benchmark('count', self.count, repetitions=3, warmup=2)
+    result = slicer.testing.runBenchmark(benchmark)
+    self.assertEqual(self.calls, 5)
+    self.assertEqual(result['repetitions'], 3)
+    self.assertEqual(len(result['times']), 3)
+    self.assertTrue(result['min'] <= result['median'] <= result['p90'] <= result['max'])
+
+  def test_comparePerformance(self):
+    baseline = {'a': {'median': 1., 'memoryDelta': 100}, 'b': {'median': 1.}}
+    results = {'a': {'median': 1.05, 'memoryDelta': 300},
+               'b': {'median': 2.},
+               'c': {'median': 10.}}
+    self.assertEqual(len(slicer.testing.comparePerformance(results, baseline, 0.1)), 1)
+    self.assertEqual(len(slicer.testing.comparePerformance(results, baseline, 0.1, 100)), 2)
+    self.assertEqual(len(slicer.testing.comparePerformance(results, baseline, 1.5)), 0)
+
+  def test_runBenchmarks(self):
+    benchmarks = [slicer.testing.Benchmark('count', self.count)]
+    regressions = slicer.testing.runBenchmarks(benchmarks, self.historyFile, build='build1')
+    self.assertEqual(regressions, [])
+    slicer.testing.runBenchmarks(benchmarks, self.historyFile, build='build2')
+    history = slicer.testing.loadPerformanceHistory(self.historyFile)
+    self.assertEqual(history['builds'], ['build1', 'build2'])
+    self.assertTrue('count' in history['results']['build1'])
+    self.assertTrue('count' in history['results']['build2'])
+
+    # Make build1 look much faster than anything can run
+    history['results']['build1']['count']['median'] = 1e-12
+    slicer.testing.savePerformanceHistory(self.historyFile, history)
+    regressions = slicer.testing.runBenchmarks(benchmarks, self.historyFile,
+                                               build='build3', baselineBuild='build1')
+    self.assertEqual(len(regressions), 1)
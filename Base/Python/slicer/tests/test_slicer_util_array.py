@@ -0,0 +1,46 @@
+import unittest
+import slicer
+import vtk
+
+
+class SlicerUtilArrayTests(unittest.TestCase):
+
+  def test_arrayFromVolume(self):
+    node = slicer.util.getNode('MR-head')
+    imageData = node.GetImageData()
+    a = slicer.util.arrayFromVolume(node)
+    dimensions = imageData.GetDimensions()
+    self.assertEqual(a.shape, (dimensions[2], dimensions[1], dimensions[0]))
+    self.assertEqual(a[2,1,0], imageData.GetScalarComponentAsDouble(0, 1, 2, 0))
+
+    # the array is a view on the voxels
+    a[2,1,0] = 123
+    self.assertEqual(imageData.GetScalarComponentAsDouble(0, 1, 2, 0), 123)
+
+    modifiedTime = imageData.GetMTime()
+    slicer.util.arrayFromVolumeModified(node)
+    self.assertTrue(imageData.GetMTime() > modifiedTime)
+
+    self.assertEqual(slicer.util.array('MR-head')[2,1,0], 123)
+
+  def test_arrayFromModelPoints(self):
+    sphere = vtk.vtkSphereSource()
+    sphere.Update()
+    node = slicer.vtkMRMLModelNode()
+    node.SetAndObservePolyData(sphere.GetOutput())
+    slicer.mrmlScene.AddNode(node)
+
+    points = node.GetPolyData().GetPoints()
+    a = slicer.util.arrayFromModelPoints(node)
+    self.assertEqual(a.shape, (points.GetNumberOfPoints(), 3))
+    self.assertEqual(tuple(a[1]), points.GetPoint(1))
+
+    # the array is a view on the points
+    a[1] = [1., 2., 3.]
+    self.assertEqual(points.GetPoint(1), (1., 2., 3.))
+
+    modifiedTime = node.GetPolyData().GetMTime()
+    slicer.util.arrayFromModelPointsModified(node)
+    self.assertTrue(node.GetPolyData().GetMTime() > modifiedTime)
+
+    slicer.mrmlScene.RemoveNode(node)
@@ -343,31 +343,82 @@ def array(pattern = "", index = 0):
   MRML node that matches the pattern.  Meant to be used in the python
   console for quick debugging/testing.  More specific API should be
   used in scripts to be sure you get exactly what you want.
+  The pattern may also be the node itself.
+  """
+  if isinstance(pattern, basestring):
+    n = getNode(pattern=pattern, index=index)
+  else:
+    n = pattern
+  if not n:
+    return None
+  if n.IsA('vtkMRMLVolumeNode'):
+    return arrayFromVolume(n)
+  elif n.IsA('vtkMRMLModelNode'):
+    return arrayFromModelPoints(n)
+  # TODO: accessors for other node types: polydata (verts, polys...), colors
+
+def arrayFromVolume(volumeNode):
+  """Return the voxels of a volume node as a numpy array indexed [k,j,i].
+  The voxels are not copied: the array shares its memory with the scalars
+  (or the tensors of a diffusion tensor volume) of the volume image data,
+  writing in the array changes the volume.  Call arrayFromVolumeModified()
+  once the voxels have been changed so that the views are updated.
+  The array is only valid as long as the image data of the volume is not
+  replaced or reallocated.
   """
-  vectorTypes = ('vtkMRMLVectorVolumeNode', 'vtkMRMLMultiVolumeNode')
-  tensorTypes = ('vtkMRMLDiffusionTensorVolumeNode',)
   import vtk.util.numpy_support
-  n = getNode(pattern=pattern, index=index)
-  if n.GetClassName() == 'vtkMRMLScalarVolumeNode':
-    i = n.GetImageData()
-    shape = list(n.GetImageData().GetDimensions())
-    shape.reverse()
-    a = vtk.util.numpy_support.vtk_to_numpy(i.GetPointData().GetScalars()).reshape(shape)
-    return a
-  elif n.GetClassName() in vectorTypes:
-    i = n.GetImageData()
-    shape = list(n.GetImageData().GetDimensions())
-    shape.reverse()
-    components = i.GetNumberOfScalarComponents()
+  imageData = volumeNode.GetImageData()
+  if not imageData:
+    return None
+  shape = list(imageData.GetDimensions())
+  shape.reverse()
+  if volumeNode.IsA('vtkMRMLDiffusionTensorVolumeNode'):
+    data = imageData.GetPointData().GetTensors()
+    shape += [3,3]
+  else:
+    data = imageData.GetPointData().GetScalars()
+    components = data.GetNumberOfComponents() if data else 0
     if components > 1:
       shape.append(components)
-    a = vtk.util.numpy_support.vtk_to_numpy(i.GetPointData().GetScalars()).reshape(shape)
-    return a
-  elif n.GetClassName() in tensorTypes:
-    i = n.GetImageData()
-    shape = list(n.GetImageData().GetDimensions())
-    shape.reverse()
-    a = vtk.util.numpy_support.vtk_to_numpy(i.GetPointData().GetTensors()).reshape(shape+[3,3])
-    return a
-  # TODO: accessors for other node types: polydata (verts, polys...), colors
+  if not data:
+    return None
+  return vtk.util.numpy_support.vtk_to_numpy(data).reshape(shape)
+
+def arrayFromVolumeModified(volumeNode):
+  """Indicate that the voxels of the array returned by arrayFromVolume()
+  have been changed.  The volume node invokes ImageDataModifiedEvent.
+  """
+  imageData = volumeNode.GetImageData()
+  if not imageData:
+    return
+  pointData = imageData.GetPointData()
+  if pointData.GetScalars():
+    pointData.GetScalars().Modified()
+  if pointData.GetTensors():
+    pointData.GetTensors().Modified()
+  imageData.Modified()
+
+def arrayFromModelPoints(modelNode):
+  """Return the point coordinates of a model node as a numpy array of
+  shape (numberOfPoints, 3).
+  The coordinates are not copied: the array shares its memory with the
+  points of the model polydata, writing in the array moves the points.
+  Call arrayFromModelPointsModified() once the points have been changed.
+  """
+  import vtk.util.numpy_support
+  polyData = modelNode.GetPolyData()
+  if not polyData or not polyData.GetPoints():
+    return None
+  return vtk.util.numpy_support.vtk_to_numpy(polyData.GetPoints().GetData())
+
+def arrayFromModelPointsModified(modelNode):
+  """Indicate that the points of the array returned by arrayFromModelPoints()
+  have been changed.  The model node invokes PolyDataModifiedEvent.
+  """
+  polyData = modelNode.GetPolyData()
+  if not polyData or not polyData.GetPoints():
+    return
+  polyData.GetPoints().GetData().Modified()
+  polyData.GetPoints().Modified()
+  polyData.Modified()
 
@@ -19,7 +19,9 @@
 ==============================================================================*/
 
 // Qt includes
+#include <QList>
 #include <QProcess>
+#include <QThread>
 
 // SlicerQt includes
 #include "qSlicerCLIExecutableModuleFactory.h"
@@ -47,6 +49,18 @@ qSlicerAbstractCoreModule* qSlicerCLIExecutableModuleFactoryItem::instanciator()
   QScopedPointer<qSlicerCLIModule> module(new qSlicerCLIModule());
   module->setModuleType("CommandLineModule");
   module->setEntryPoint(this->path());
+  module->setTempDirectory(this->TempDirectory);
+  module->setPath(this->path());
+  module->setInstalled(qSlicerCLIModuleFactoryHelper::isInstalled(this->path()));
+
+  // A cached description saves running the executable.
+  QString cachedXmlDescription =
+    qSlicerCLIModuleFactoryHelper::cachedXmlDescription(this->path());
+  if (!cachedXmlDescription.isEmpty())
+    {
+    module->setXmlModuleDescription(cachedXmlDescription.toLatin1());
+    return module.take();
+    }
 
   ctkScopedCurrentDir scopedCurrentDir(QFileInfo(this->path()).path());
 
@@ -123,13 +137,57 @@ qSlicerAbstractCoreModule* qSlicerCLIExecutableModuleFactoryItem::instanciator()
     }
 
   module->setXmlModuleDescription(xmlDescription.toLatin1());
-  module->setTempDirectory(this->TempDirectory);
-  module->setPath(this->path());
-  module->setInstalled(qSlicerCLIModuleFactoryHelper::isInstalled(this->path()));
+  if (errors.isEmpty())
+    {
+    qSlicerCLIModuleFactoryHelper::cacheXmlDescription(this->path(), xmlDescription);
+    }
 
   return module.take();
 }
 
+//-----------------------------------------------------------------------------
+void qSlicerCLIExecutableModuleFactoryItem::cacheXmlDescriptions(
+  const QStringList& paths)
+{
+  // Run a few executables at a time, each one is waited for in turn while
+  // the others keep running.
+  const int cliProcessTimeoutInMs = 5000;
+  const int maximumRunningProcesses = qMax(1, QThread::idealThreadCount());
+  QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+  env.insert("ITK_AUTOLOAD_PATH", "");
+  QList<QProcess*> runningProcesses;
+  QStringList runningPaths;
+  int next = 0;
+  while (next < paths.count() || !runningProcesses.isEmpty())
+    {
+    while (runningProcesses.count() < maximumRunningProcesses &&
+           next < paths.count())
+      {
+      QProcess* cli = new QProcess;
+      cli->setProcessEnvironment(env);
+      cli->setWorkingDirectory(QFileInfo(paths[next]).path());
+      cli->start(paths[next], QStringList(QString("--xml")));
+      runningProcesses << cli;
+      runningPaths << paths[next];
+      ++next;
+      }
+    QProcess* cli = runningProcesses.takeFirst();
+    QString path = runningPaths.takeFirst();
+    // Failures are reported when the module is instantiated.
+    if (cli->waitForFinished(cliProcessTimeoutInMs) &&
+        cli->exitStatus() == QProcess::NormalExit &&
+        cli->readAllStandardError().isEmpty())
+      {
+      QString xmlDescription = cli->readAllStandardOutput();
+      if (xmlDescription.startsWith("<?xml"))
+        {
+        qSlicerCLIModuleFactoryHelper::cacheXmlDescription(path, xmlDescription);
+        }
+      }
+    delete cli;
+    }
+}
+
 //-----------------------------------------------------------------------------
 // qSlicerCLIExecutableModuleFactory
 
@@ -150,6 +208,22 @@ void qSlicerCLIExecutableModuleFactory::registerItems()
 {
   QStringList modulePaths = qSlicerCLIModuleFactoryHelper::modulePaths();
   this->registerAllFileItems(modulePaths);
+
+  // Get the descriptions of the new or changed executables all at once
+  // instead of one after the other when the modules are instantiated.
+  QStringList uncachedPaths;
+  foreach(const QString& key, this->itemKeys())
+    {
+    ctkAbstractFactoryFileBasedItem<qSlicerAbstractCoreModule>* fileBasedItem =
+      dynamic_cast<ctkAbstractFactoryFileBasedItem<qSlicerAbstractCoreModule>*>(
+        this->item(key));
+    if (fileBasedItem &&
+        !qSlicerCLIModuleFactoryHelper::hasCachedXmlDescription(fileBasedItem->path()))
+      {
+      uncachedPaths << fileBasedItem->path();
+      }
+    }
+  qSlicerCLIExecutableModuleFactoryItem::cacheXmlDescriptions(uncachedPaths);
 }
 
 //-----------------------------------------------------------------------------
@@ -36,6 +36,11 @@ class qSlicerCLIExecutableModuleFactoryItem
 public:
   qSlicerCLIExecutableModuleFactoryItem(const QString& newTempDirectory);
   virtual bool load();
+
+  /// Run the executables \a paths concurrently with --xml and cache their
+  /// descriptions.
+  /// \sa qSlicerCLIModuleFactoryHelper::cacheXmlDescription()
+  static void cacheXmlDescriptions(const QStringList& paths);
 protected:
   virtual qSlicerAbstractCoreModule* instanciator();
 private:
@@ -19,6 +19,10 @@
 ==============================================================================*/
 
 // Qt includes
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
 #include <QSettings>
 
 // QtCLI includes
@@ -66,3 +70,87 @@ bool qSlicerCLIModuleFactoryHelper::isInstalled(const QString& path)
   qSlicerCoreApplication * app = qSlicerCoreApplication::application();
   return qSlicerUtils::isPluginInstalled(path, app->slicerHome());
 }
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+QString hashOf(const QString& text)
+{
+  return QString(QCryptographicHash::hash(
+    text.toUtf8(), QCryptographicHash::Sha1).toHex());
+}
+
+//-----------------------------------------------------------------------------
+/// Cache files of \a path are named <hash of the path>_<hash of the size and
+/// modification time>.xml
+QString xmlDescriptionCacheFileName(const QString& path)
+{
+  QFileInfo fileInfo(path);
+  QString version = QString("%1 %2").arg(fileInfo.size()).arg(
+    fileInfo.lastModified().toTime_t());
+  return qSlicerCLIModuleFactoryHelper::xmlDescriptionCacheDirectory() + "/" +
+    hashOf(fileInfo.absoluteFilePath()) + "_" + hashOf(version) + ".xml";
+}
+
+}
+
+//-----------------------------------------------------------------------------
+QString qSlicerCLIModuleFactoryHelper::xmlDescriptionCacheDirectory()
+{
+  qSlicerCoreApplication * app = qSlicerCoreApplication::application();
+  QString settingsDirectory = app ?
+    QFileInfo(app->slicerRevisionUserSettingsFilePath()).absolutePath() :
+    QDir::tempPath();
+  return settingsDirectory + "/CLIModuleDescriptions";
+}
+
+//-----------------------------------------------------------------------------
+bool qSlicerCLIModuleFactoryHelper::hasCachedXmlDescription(const QString& path)
+{
+  return QFile::exists(xmlDescriptionCacheFileName(path));
+}
+
+//-----------------------------------------------------------------------------
+QString qSlicerCLIModuleFactoryHelper::cachedXmlDescription(const QString& path)
+{
+  QFile cacheFile(xmlDescriptionCacheFileName(path));
+  if (!cacheFile.open(QIODevice::ReadOnly))
+    {
+    return QString();
+    }
+  return QString::fromUtf8(cacheFile.readAll());
+}
+
+//-----------------------------------------------------------------------------
+bool qSlicerCLIModuleFactoryHelper::cacheXmlDescription(const QString& path,
+                                                        const QString& xmlDescription)
+{
+  QDir cacheDirectory(xmlDescriptionCacheDirectory());
+  if (!cacheDirectory.exists() && !QDir().mkpath(cacheDirectory.absolutePath()))
+    {
+    return false;
+    }
+  QString cacheFileName = xmlDescriptionCacheFileName(path);
+  QString pathHash = QFileInfo(cacheFileName).fileName().section('_', 0, 0);
+  foreach(const QString& oldFileName,
+          cacheDirectory.entryList(QStringList() << pathHash + "_*.xml", QDir::Files))
+    {
+    cacheDirectory.remove(oldFileName);
+    }
+  // Write aside first so a partial file is never read.
+  QFile cacheFile(cacheFileName + ".part");
+  if (!cacheFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+    return false;
+    }
+  QByteArray data = xmlDescription.toUtf8();
+  bool written = cacheFile.write(data) == data.size();
+  cacheFile.close();
+  if (!written || !cacheFile.rename(cacheFileName))
+    {
+    cacheFile.remove();
+    return false;
+    }
+  return true;
+}
@@ -37,6 +37,21 @@ public:
   /// Convenient method returning True if the given CLI path corresponds to an installed module
   static bool isInstalled(const QString& path);
 
+  /// Directory of the cached XML descriptions, next to the revision
+  /// specific user settings so they persist between sessions.
+  static QString xmlDescriptionCacheDirectory();
+
+  /// Return the XML description of the CLI \a path cached by
+  /// cacheXmlDescription(), or an empty string if none was cached since the
+  /// file last changed. A description is identified by the path, the size
+  /// and the modification time of the file.
+  static QString cachedXmlDescription(const QString& path);
+  static bool hasCachedXmlDescription(const QString& path);
+
+  /// Save \a xmlDescription as the description of the CLI \a path. The
+  /// descriptions of previous versions of the file are removed.
+  static bool cacheXmlDescription(const QString& path, const QString& xmlDescription);
+
 private:
   /// Not implemented
   qSlicerCLIModuleFactoryHelper(){}
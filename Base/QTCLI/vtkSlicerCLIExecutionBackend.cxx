@@ -0,0 +1,71 @@
+/*=auto=========================================================================
+
+ Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) 
+ All Rights Reserved.
+
+ See COPYRIGHT.txt
+ or http://www.slicer.org/copyright/copyright.txt for details.
+
+ Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// SlicerQTCLI includes
+#include "vtkSlicerCLIExecutionBackend.h"
+
+// VTK includes
+#include <vtkObjectFactory.h>
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkSlicerCLIExecutionBackend);
+
+//----------------------------------------------------------------------------
+vtkSlicerCLIExecutionBackend::vtkSlicerCLIExecutionBackend()
+{
+}
+
+//----------------------------------------------------------------------------
+vtkSlicerCLIExecutionBackend::~vtkSlicerCLIExecutionBackend()
+{
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCLIExecutionBackend::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "Local: " << (this->IsLocal() ? "true" : "false") << "\n";
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerCLIExecutionBackend::IsLocal()const
+{
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerCLIExecutionBackend
+::SendInputFiles(const std::vector<std::string>& vtkNotUsed(files))const
+{
+  return true;
+}
+
+//----------------------------------------------------------------------------
+std::vector<std::string> vtkSlicerCLIExecutionBackend
+::GetCommandLine(const std::vector<std::string>& commandLine,
+                 const std::vector<std::string>& vtkNotUsed(files))const
+{
+  return commandLine;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerCLIExecutionBackend
+::RetrieveOutputFiles(const std::vector<std::string>& vtkNotUsed(files))const
+{
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCLIExecutionBackend
+::RemoveFiles(const std::vector<std::string>& vtkNotUsed(files))const
+{
+}
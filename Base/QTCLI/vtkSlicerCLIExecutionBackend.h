@@ -0,0 +1,76 @@
+/*=auto=========================================================================
+
+ Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) 
+ All Rights Reserved.
+
+ See COPYRIGHT.txt
+ or http://www.slicer.org/copyright/copyright.txt for details.
+
+ Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#ifndef __vtkSlicerCLIExecutionBackend_h
+#define __vtkSlicerCLIExecutionBackend_h
+
+// VTK includes
+#include <vtkObject.h>
+
+// STL includes
+#include <string>
+#include <vector>
+
+#include "qSlicerBaseQTCLIExport.h"
+
+/// \brief Runs the executable command line modules.
+///
+/// vtkSlicerCLIModuleLogic launches the command returned by GetCommandLine()
+/// and parses its standard output for progress. The files it writes for the
+/// module are given to SendInputFiles() before the launch and the files it
+/// reads back to RetrieveOutputFiles() after a successful run.
+/// vtkSlicerCLIExecutionBackend runs the modules on this computer, where
+/// they can read and write the files directly. Subclasses can run them
+/// elsewhere (\sa vtkSlicerCLIRemoteExecutionBackend).
+/// The methods are called by the processing threads of the CLI logics, for
+/// several modules at the same time: they must not modify the backend.
+class Q_SLICER_BASE_QTCLI_EXPORT vtkSlicerCLIExecutionBackend : public vtkObject
+{
+public:
+  static vtkSlicerCLIExecutionBackend *New();
+  vtkTypeMacro(vtkSlicerCLIExecutionBackend, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  /// Return true if the modules run on this computer. Only local modules
+  /// can exchange volumes through shared memory and be kept alive between
+  /// runs.
+  virtual bool IsLocal()const;
+
+  /// Make the \a files written for a module available to it.
+  /// Return false if the module can't be run.
+  virtual bool SendInputFiles(const std::vector<std::string>& files)const;
+
+  /// Return the command to launch to run \a commandLine, in which \a files
+  /// are the input and output files of the module.
+  virtual std::vector<std::string> GetCommandLine(
+    const std::vector<std::string>& commandLine,
+    const std::vector<std::string>& files)const;
+
+  /// Bring back the output \a files written by a module that exited
+  /// without errors. Return false if one of them can't be retrieved.
+  virtual bool RetrieveOutputFiles(const std::vector<std::string>& files)const;
+
+  /// Called when the run is done, successful or not, with the input and
+  /// output files of the module. The local copies are removed by the CLI
+  /// logic.
+  virtual void RemoveFiles(const std::vector<std::string>& files)const;
+
+protected:
+  vtkSlicerCLIExecutionBackend();
+  virtual ~vtkSlicerCLIExecutionBackend();
+
+private:
+  vtkSlicerCLIExecutionBackend(const vtkSlicerCLIExecutionBackend&); // Not implemented
+  void operator=(const vtkSlicerCLIExecutionBackend&); // Not implemented
+};
+
+#endif
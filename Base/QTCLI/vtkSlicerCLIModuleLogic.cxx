@@ -10,6 +10,7 @@
 
 =========================================================================auto=*/
 
+#include "vtkSlicerCLIExecutionBackend.h"
 #include "vtkSlicerCLIModuleLogic.h"
 
 #include "vtkSlicerTask.h"
@@ -25,21 +26,30 @@
 #include <vtkMRMLFiducialListNode.h>
 #include <vtkMRMLModelHierarchyNode.h>
 #include <vtkMRMLROIListNode.h>
+#include <vtkMRMLSharedMemoryImage.h>
+#include <vtkMRMLVolumeNode.h>
 #include <vtkMRMLStorageNode.h>
 #include <vtkMRMLTransformNode.h>
 
 // VTK includes
 #include <vtkIntArray.h>
 #include <vtkNew.h>
+#include <vtkSmartPointer.h>
 #include <vtkStringArray.h>
 
+// ITK includes
+#include <itkMutexLock.h>
+
 // ITKSYS includes
+#include <itksys/Directory.hxx>
 #include <itksys/Process.h>
 #include <itksys/SystemTools.hxx>
 #include <itksys/RegularExpression.hxx>
 
 // QT includes
+#include <QCryptographicHash>
 #include <QDebug>
+#include <QFile>
 
 #if defined(__APPLE__) && (MAC_OS_X_VERSION_MAX_ALLOWED >= 1030)
 // needed to hack around itksys to override defaults used by Mac OS X
@@ -49,11 +59,15 @@
 #include <algorithm>
 #include <cassert>
 #include <ctime>
+#include <map>
 #include <set>
 
 #ifdef _WIN32
+#include <windows.h>
 #else
 #include <sys/types.h>
+#include <fcntl.h>
+#include <signal.h>
 #include <unistd.h>
 #endif
 
@@ -73,6 +87,174 @@ struct DigitsToCharacters
 
 typedef std::pair<vtkSlicerCLIModuleLogic *, vtkMRMLCommandLineModuleNode *> LogicNodePair;
 
+//----------------------------------------------------------------------------
+/// Executable module started in server mode (see
+/// SEMCommandLineLibraryWrapper.cxx.in): it stays alive between runs and
+/// runs the module once for each parameter set written on its standard
+/// input. After each run it prints "<server-return>value</server-return>"
+/// on its standard output.
+struct CLIWorkerProcess
+{
+  CLIWorkerProcess()
+    : Process(0)
+    {
+#ifdef _WIN32
+    this->Input = INVALID_HANDLE_VALUE;
+#else
+    this->Input = -1;
+#endif
+    }
+  ~CLIWorkerProcess()
+    {
+    this->Terminate();
+    }
+
+  /// Return false if \a arguments can't be sent: the protocol is line
+  /// based.
+  static bool CanSend(const std::vector<std::string>& arguments)
+    {
+    for (std::vector<std::string>::const_iterator it = arguments.begin();
+         it != arguments.end(); ++it)
+      {
+      if (it->find_first_of("\r\n") != std::string::npos)
+        {
+        return false;
+        }
+      }
+    return true;
+    }
+
+  /// Start \a command with the --server flag and wait for the executable
+  /// to be ready. Return false if it doesn't support the server mode.
+  bool Start(const std::vector<std::string>& command)
+    {
+    std::vector<const char*> commandArgs;
+    for (std::vector<std::string>::const_iterator it = command.begin();
+         it != command.end(); ++it)
+      {
+      commandArgs.push_back(it->c_str());
+      }
+    commandArgs.push_back("--server");
+    commandArgs.push_back(0);
+
+    itksysProcess_Pipe_Handle input[2];
+#ifdef _WIN32
+    if (!CreatePipe(&input[0], &input[1], 0, 0))
+      {
+      return false;
+      }
+#else
+    if (pipe(input) != 0)
+      {
+      return false;
+      }
+    // Don't leak the pipe into the other processes launched concurrently.
+    fcntl(input[0], F_SETFD, FD_CLOEXEC);
+    fcntl(input[1], F_SETFD, FD_CLOEXEC);
+    // A worker that dies must not kill the application when a parameter
+    // set is written to it.
+    signal(SIGPIPE, SIG_IGN);
+#endif
+    this->Process = itksysProcess_New();
+    itksysProcess_SetCommand(this->Process, &commandArgs[0]);
+    itksysProcess_SetOption(this->Process, itksysProcess_Option_Detach, 0);
+    itksysProcess_SetOption(this->Process, itksysProcess_Option_HideWindow, 1);
+    itksysProcess_SetPipeNative(this->Process, itksysProcess_Pipe_STDIN, input);
+    itksysProcess_Execute(this->Process);
+    // the child has its own copy of the read end
+#ifdef _WIN32
+    CloseHandle(input[0]);
+#else
+    close(input[0]);
+#endif
+    this->Input = input[1];
+
+    std::string output;
+    char* data = 0;
+    int length = 0;
+    double timeout = 30.;
+    int pipe = itksysProcess_Pipe_Timeout;
+    while (output.find("<server-ready/>") == std::string::npos &&
+           (pipe = itksysProcess_WaitForData(this->Process, &data, &length,
+                                             &timeout)) != 0 &&
+           pipe != itksysProcess_Pipe_Timeout)
+      {
+      if (pipe == itksysProcess_Pipe_STDOUT)
+        {
+        output.append(data, length);
+        }
+      }
+    if (output.find("<server-ready/>") == std::string::npos)
+      {
+      this->Terminate();
+      return false;
+      }
+    return true;
+    }
+
+  /// Write the parameter set of a run: the number of arguments then one
+  /// argument per line.
+  bool Send(const std::vector<std::string>& arguments)
+    {
+    std::ostringstream message;
+    message << arguments.size() << "\n";
+    for (std::vector<std::string>::const_iterator it = arguments.begin();
+         it != arguments.end(); ++it)
+      {
+      message << *it << "\n";
+      }
+    std::string buffer = message.str();
+    std::string::size_type written = 0;
+    while (written < buffer.size())
+      {
+#ifdef _WIN32
+      DWORD count = 0;
+      if (!WriteFile(this->Input, buffer.c_str() + written,
+                     static_cast<DWORD>(buffer.size() - written), &count, 0))
+        {
+        return false;
+        }
+#else
+      ssize_t count = write(this->Input, buffer.c_str() + written,
+                            buffer.size() - written);
+      if (count <= 0)
+        {
+        return false;
+        }
+#endif
+      written += count;
+      }
+    return true;
+    }
+
+  void Terminate()
+    {
+#ifdef _WIN32
+    if (this->Input != INVALID_HANDLE_VALUE)
+      {
+      CloseHandle(this->Input);
+      this->Input = INVALID_HANDLE_VALUE;
+      }
+#else
+    if (this->Input != -1)
+      {
+      close(this->Input);
+      this->Input = -1;
+      }
+#endif
+    if (this->Process)
+      {
+      itksysProcess_Kill(this->Process);
+      itksysProcess_WaitForExit(this->Process, 0);
+      itksysProcess_Delete(this->Process);
+      this->Process = 0;
+      }
+    }
+
+  itksysProcess* Process;
+  itksysProcess_Pipe_Handle Input;
+};
+
 
 //----------------------------------------------------------------------------
 class vtkSlicerCLIModuleLogic::vtkInternal
@@ -83,6 +265,8 @@ public:
 
   int RedirectModuleStreams;
 
+  int UseSharedMemory;
+
   std::string TemporaryDirectory;
 
   typedef std::vector<std::pair<int, vtkMRMLCommandLineModuleNode*> > RequestType;
@@ -109,6 +293,7 @@ public:
 
   void SetLastRequest(vtkMRMLCommandLineModuleNode* node, int requestUID)
   {
+    LastRequestsLock.Lock();
     RequestType::iterator it = std::find_if(
       this->LastRequests.begin(), this->LastRequests.end(), FindRequest(node));
     if (it == this->LastRequests.end())
@@ -120,19 +305,535 @@ public:
       assert( it->first < requestUID );
       it->first = requestUID;
       }
+    LastRequestsLock.Unlock();
   }
   int GetLastRequest(vtkMRMLCommandLineModuleNode* node)
   {
+    LastRequestsLock.Lock();
     RequestType::iterator it = std::find_if(
       this->LastRequests.begin(), this->LastRequests.end(), FindRequest(node));
-    return (it != this->LastRequests.end())? it->first : 0;
+    int requestUID = (it != this->LastRequests.end())? it->first : 0;
+    LastRequestsLock.Unlock();
+    return requestUID;
   }
 
   /// List of read data/scene requests of the CLI nodes
   /// being executed with their.
   RequestType LastRequests;
+  /// CLIs of the logic may run concurrently in several processing threads.
+  itk::SimpleMutexLock LastRequestsLock;
+
+  /// Tasks scheduled by Apply() and not started yet, used to cancel them.
+  /// Only accessed in the main thread.
+  typedef std::map<vtkMRMLCommandLineModuleNode*,
+                   vtkSmartPointer<vtkSlicerTask> > ScheduledTaskMap;
+  ScheduledTaskMap ScheduledTasks;
+
+  /// Files and segments shared by the items of a batch, removed when all
+  /// the items are done.
+  struct BatchType
+    {
+    BatchType() : NumberOfRunningItems(0) {}
+    int NumberOfRunningItems;
+    std::set<std::string> FilesToDelete;
+    std::vector<vtkSmartPointer<vtkMRMLSharedMemoryImage> > SharedMemoryImages;
+    };
+  typedef std::map<int, BatchType> BatchMap;
+  BatchMap Batches;
+  int LastBatchID;
+  /// Running item nodes and the ID of their batch.
+  typedef std::map<vtkMRMLCommandLineModuleNode*, int> BatchItemMap;
+  BatchItemMap BatchItems;
+  /// Last item removed from the scene. It is kept alive until the next one
+  /// is done as it is removed while invoking its ModifiedEvent.
+  vtkSmartPointer<vtkMRMLCommandLineModuleNode> RemovedBatchItem;
+
+  /// Connection of an output parameter to the input parameter of the next
+  /// node of a pipeline.
+  struct PipelineConnectionType
+    {
+    vtkMRMLCommandLineModuleNode* Node;
+    std::string OutputName;
+    vtkSlicerCLIModuleLogic* NextLogic;
+    vtkMRMLCommandLineModuleNode* NextNode;
+    std::string NextInputName;
+    };
+  typedef std::vector<PipelineConnectionType> PipelineConnectionList;
+  PipelineConnectionList PipelineConnections;
+  /// Parameter value to restore when a pipeline is done.
+  struct PipelineParameterType
+    {
+    vtkSmartPointer<vtkMRMLCommandLineModuleNode> Node;
+    std::string Name;
+    std::string Value;
+    };
+  struct PipelineType
+    {
+    PipelineType() : FirstNode(0), UpdateDisplay(true) {}
+    vtkMRMLCommandLineModuleNode* FirstNode;
+    bool UpdateDisplay;
+    /// Nodes not applied yet and the number of connections to them from
+    /// nodes not completed yet.
+    std::map<vtkMRMLCommandLineModuleNode*, int> WaitingNodes;
+    std::set<vtkMRMLCommandLineModuleNode*> RunningNodes;
+    /// Intermediate results (file names or IDs of hidden nodes) and the
+    /// nodes that have not written or read them yet.
+    std::map<std::string, std::set<vtkMRMLCommandLineModuleNode*> > Intermediates;
+    std::vector<PipelineParameterType> SavedParameters;
+    };
+  typedef std::map<int, PipelineType> PipelineMap;
+  PipelineMap Pipelines;
+  int LastPipelineID;
+  /// Waiting and running nodes and the ID of their pipeline.
+  typedef std::map<vtkMRMLCommandLineModuleNode*, int> PipelineNodeMap;
+  PipelineNodeMap PipelineNodes;
+
+  /// Return true if \a to is connected to \a from, directly or not.
+  bool IsPipelineConnected(vtkMRMLCommandLineModuleNode* from,
+                           vtkMRMLCommandLineModuleNode* to) const
+  {
+    std::vector<vtkMRMLCommandLineModuleNode*> nodes(1, from);
+    std::set<vtkMRMLCommandLineModuleNode*> visited;
+    for (size_t i = 0; i < nodes.size(); ++i)
+      {
+      if (nodes[i] == to)
+        {
+        return true;
+        }
+      PipelineConnectionList::const_iterator cit;
+      for (cit = this->PipelineConnections.begin();
+           cit != this->PipelineConnections.end(); ++cit)
+        {
+        if (cit->Node == nodes[i] && visited.insert(cit->NextNode).second)
+          {
+          nodes.push_back(cit->NextNode);
+          }
+        }
+      }
+    return false;
+  }
+
+  /// Find the parameter \a name of \a description.
+  static bool FindParameter(const ModuleDescription& description,
+                            const std::string& name, ModuleParameter& parameter)
+  {
+    std::vector<ModuleParameterGroup>::const_iterator pgit;
+    for (pgit = description.GetParameterGroups().begin();
+         pgit != description.GetParameterGroups().end(); ++pgit)
+      {
+      std::vector<ModuleParameter>::const_iterator pit;
+      for (pit = (*pgit).GetParameters().begin();
+           pit != (*pgit).GetParameters().end(); ++pit)
+        {
+        if ((*pit).GetName() == name)
+          {
+          parameter = *pit;
+          return true;
+          }
+        }
+      }
+    return false;
+  }
+
+  /// Class of the hidden node that passes the intermediate volume of
+  /// \a parameter in memory, empty if it must be passed through a file.
+  static std::string GetIntermediateNodeClassName(const ModuleParameter& parameter)
+  {
+    if (parameter.GetTag() != "image")
+      {
+      return std::string();
+      }
+    if (parameter.GetType() == "scalar" || parameter.GetType() == "label" ||
+        parameter.GetType().empty())
+      {
+      return "vtkMRMLScalarVolumeNode";
+      }
+    if (parameter.GetType() == "vector")
+      {
+      return "vtkMRMLVectorVolumeNode";
+      }
+    if (parameter.GetType() == "tensor")
+      {
+      return "vtkMRMLDiffusionTensorVolumeNode";
+      }
+    if (parameter.GetType() == "diffusion-weighted")
+      {
+      return "vtkMRMLDiffusionWeightedVolumeNode";
+      }
+    return std::string();
+  }
+
+  /// Remove a temporary file or shared memory segment. Return true if it
+  /// doesn't exist anymore.
+  static bool RemoveTemporaryFile(const std::string& fileName)
+  {
+    return vtkMRMLSharedMemoryImage::IsSharedMemoryFileName(fileName.c_str()) ?
+      vtkMRMLSharedMemoryImage::Remove(fileName.c_str()) :
+      (!itksys::SystemTools::FileExists(fileName.c_str()) ||
+       itksys::SystemTools::RemoveFile(fileName.c_str()));
+  }
+
+  /// Return true if the value of an image, geometry, transform, table or
+  /// measurement parameter is a file name (or a "slicer:"/"slicershm:"
+  /// reference) instead of a node ID. Node IDs don't contain path
+  /// separators, dots or colons.
+  static bool IsFileName(const std::string& value)
+  {
+    return value.find_first_of("/\\.:") != std::string::npos;
+  }
+
+  /// Idle worker processes indexed by their command line and thread count.
+  int UseWorkerProcesses;
+  typedef std::multimap<std::string, CLIWorkerProcess*> WorkerProcessMap;
+  WorkerProcessMap IdleWorkerProcesses;
+  /// Commands that failed to start in server mode.
+  std::set<std::string> NonServerCommands;
+  itk::SimpleMutexLock WorkerProcessesLock;
+
+  CLIWorkerProcess* TakeIdleWorkerProcess(const std::string& key)
+  {
+    CLIWorkerProcess* worker = 0;
+    this->WorkerProcessesLock.Lock();
+    WorkerProcessMap::iterator it = this->IdleWorkerProcesses.find(key);
+    if (it != this->IdleWorkerProcesses.end())
+      {
+      worker = it->second;
+      this->IdleWorkerProcesses.erase(it);
+      }
+    this->WorkerProcessesLock.Unlock();
+    return worker;
+  }
+  void ReleaseWorkerProcess(const std::string& key, CLIWorkerProcess* worker)
+  {
+    this->WorkerProcessesLock.Lock();
+    if (this->UseWorkerProcesses)
+      {
+      this->IdleWorkerProcesses.insert(std::make_pair(key, worker));
+      worker = 0;
+      }
+    this->WorkerProcessesLock.Unlock();
+    delete worker;
+  }
+  bool IsServerCommand(const std::string& key)
+  {
+    this->WorkerProcessesLock.Lock();
+    bool server = this->NonServerCommands.find(key) == this->NonServerCommands.end();
+    this->WorkerProcessesLock.Unlock();
+    return server;
+  }
+  void SetNonServerCommand(const std::string& key)
+  {
+    this->WorkerProcessesLock.Lock();
+    this->NonServerCommands.insert(key);
+    this->WorkerProcessesLock.Unlock();
+  }
+  void TerminateIdleWorkerProcesses()
+  {
+    this->WorkerProcessesLock.Lock();
+    WorkerProcessMap idleWorkers;
+    idleWorkers.swap(this->IdleWorkerProcesses);
+    this->WorkerProcessesLock.Unlock();
+    for (WorkerProcessMap::iterator it = idleWorkers.begin();
+         it != idleWorkers.end(); ++it)
+      {
+      delete it->second;
+      }
+  }
+
+  /// Parse the content of a <filter-intermediate-result> tag.
+  static bool ParseIntermediateResult(const std::string& result,
+                                      std::string& output, std::string& file)
+  {
+    std::string::size_type outputStart = result.find("<output>");
+    std::string::size_type outputEnd = result.find("</output>");
+    std::string::size_type fileStart = result.find("<file>");
+    std::string::size_type fileEnd = result.find("</file>");
+    if (outputStart == std::string::npos || outputEnd == std::string::npos ||
+        fileStart == std::string::npos || fileEnd == std::string::npos ||
+        outputEnd < outputStart + 8 || fileEnd < fileStart + 6)
+      {
+      return false;
+      }
+    output = result.substr(outputStart + 8, outputEnd - outputStart - 8);
+    file = result.substr(fileStart + 6, fileEnd - fileStart - 6);
+    return !output.empty() && !file.empty();
+  }
+
+  double IntermediateResultInterval;
+  vtkSmartPointer<vtkSlicerCLIExecutionBackend> ExecutionBackend;
+
+  /// Result cache settings
+  int UseResultCache;
+  std::string ResultCacheDirectory;
+  int ResultCacheLimit;
+  /// Serializes the accesses to the cache directory
+  itk::SimpleMutexLock ResultCacheLock;
+  /// Files written by a module indexed by their name in a cache entry.
+  typedef std::map<std::string, std::string> OutputFileMap;
+
+  std::string GetResultCacheDirectory() const
+  {
+    return !this->ResultCacheDirectory.empty() ? this->ResultCacheDirectory :
+      this->TemporaryDirectory + "/CLIResultCache";
+  }
+
+  /// Content digest of the file or shared memory segment \a fileName.
+  /// Return an empty string if it can't be read.
+  static std::string GetDigest(const std::string& fileName)
+  {
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    if (vtkMRMLSharedMemoryImage::IsSharedMemoryFileName(fileName.c_str()))
+      {
+      vtkNew<vtkMRMLSharedMemoryImage> segment;
+      if (!segment->Open(fileName.c_str()))
+        {
+        return std::string();
+        }
+      const vtkMRMLSharedMemoryImage::HeaderType* header = segment->GetHeader();
+      hash.addData(reinterpret_cast<const char*>(&header->ScalarType),
+                   sizeof(header->ScalarType));
+      hash.addData(reinterpret_cast<const char*>(&header->NumberOfComponents),
+                   sizeof(header->NumberOfComponents));
+      hash.addData(reinterpret_cast<const char*>(header->Dimensions),
+                   sizeof(header->Dimensions));
+      hash.addData(reinterpret_cast<const char*>(header->IJKToRAS),
+                   sizeof(header->IJKToRAS));
+      const char* data = static_cast<const char*>(segment->GetData());
+      const vtkTypeUInt64 chunkSize = 1 << 20;
+      for (vtkTypeUInt64 offset = 0; offset < header->DataSize; offset += chunkSize)
+        {
+        hash.addData(data + offset, static_cast<int>(
+          std::min(chunkSize, header->DataSize - offset)));
+        }
+      }
+    else
+      {
+      QFile file(QString::fromLocal8Bit(fileName.c_str()));
+      if (!file.open(QIODevice::ReadOnly))
+        {
+        return std::string();
+        }
+      while (!file.atEnd())
+        {
+        hash.addData(file.read(1 << 20));
+        }
+      }
+    return std::string(hash.result().toHex().constData());
+  }
+
+  /// Return the key of the cache entry of a run of an executable module or
+  /// an empty string if the results of the run can't be cached: the key
+  /// is a digest of the command line where the input files are replaced by
+  /// the digest of their content. The files written by the module and read
+  /// back into the scene are added to \a outputs.
+  static std::string GetResultCacheKey(
+    const ModuleDescription& description,
+    const std::vector<std::string>& commandLine,
+    const std::map<std::string, std::string>& nodesToWrite,
+    const std::map<std::string, std::string>& nodesToReload,
+    const std::string& cliNodeID,
+    OutputFileMap& outputs)
+  {
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    std::map<std::string, std::string> fileTokens;
+    std::vector<ModuleParameterGroup>::const_iterator pgit;
+    for (pgit = description.GetParameterGroups().begin();
+         pgit != description.GetParameterGroups().end(); ++pgit)
+      {
+      std::vector<ModuleParameter>::const_iterator pit;
+      for (pit = (*pgit).GetParameters().begin();
+           pit != (*pgit).GetParameters().end(); ++pit)
+        {
+        const std::string& tag = (*pit).GetTag();
+        const std::string& value = (*pit).GetDefault();
+        bool nodeTag = (tag == "image" || tag == "geometry"
+          || tag == "transform" || tag == "table" || tag == "measurement");
+        if ((*pit).GetChannel() == "output")
+          {
+          // files written by the module elsewhere can't be restored
+          if ((tag == "file" || tag == "directory") && !value.empty())
+            {
+            return std::string();
+            }
+          std::map<std::string, std::string>::const_iterator rit =
+            nodeTag ? nodesToReload.find(value) : nodesToReload.end();
+          if (rit == nodesToReload.end())
+            {
+            if (nodeTag && IsFileName(value))
+              {
+              return std::string();
+              }
+            continue;
+            }
+          if (vtkMRMLSharedMemoryImage::IsSharedMemoryFileName(rit->second.c_str()))
+            {
+            return std::string();
+            }
+          outputs[(*pit).GetName()] = rit->second;
+          }
+        else if (tag == "file" && itksys::SystemTools::FileExists(value.c_str(), true))
+          {
+          std::ostringstream fileStamp;
+          fileStamp << value << ":" << itksys::SystemTools::ModifiedTime(value.c_str())
+                    << ":" << itksys::SystemTools::FileLength(value.c_str());
+          hash.addData(fileStamp.str().c_str(), static_cast<int>(fileStamp.str().size() + 1));
+          }
+        }
+      }
+    std::map<std::string, std::string>::const_iterator rit =
+      nodesToReload.find(cliNodeID);
+    if (rit != nodesToReload.end())
+      {
+      // parameter names can't start with a dot
+      outputs[".returnparameters"] = rit->second;
+      }
+    for (OutputFileMap::const_iterator oit = outputs.begin();
+         oit != outputs.end(); ++oit)
+      {
+      fileTokens[oit->second] = "output:" + oit->first;
+      }
+    for (rit = nodesToWrite.begin(); rit != nodesToWrite.end(); ++rit)
+      {
+      std::string digest = GetDigest(rit->second);
+      if (digest.empty())
+        {
+        return std::string();
+        }
+      fileTokens[rit->second] = "input:" + digest;
+      }
+
+    // a rebuilt module must not reuse the results of the previous build
+    std::ostringstream moduleStamp;
+    moduleStamp << description.GetTitle() << ":" << description.GetVersion()
+                << ":" << itksys::SystemTools::ModifiedTime(description.GetTarget().c_str());
+    hash.addData(moduleStamp.str().c_str(), static_cast<int>(moduleStamp.str().size() + 1));
+    for (std::vector<std::string>::const_iterator ait = commandLine.begin();
+         ait != commandLine.end(); ++ait)
+      {
+      std::map<std::string, std::string>::const_iterator tit = fileTokens.find(*ait);
+      const std::string& token = (tit != fileTokens.end()) ? tit->second : *ait;
+      hash.addData(token.c_str(), static_cast<int>(token.size() + 1));
+      }
+    return std::string(hash.result().toHex().constData());
+  }
+
+  /// Copy the files of the cache entry \a key to \a outputs.
+  bool RetrieveResults(const std::string& key, const OutputFileMap& outputs)
+  {
+    std::string entry = this->GetResultCacheDirectory() + "/" + key;
+    this->ResultCacheLock.Lock();
+    bool found = itksys::SystemTools::FileIsDirectory(entry.c_str());
+    for (OutputFileMap::const_iterator it = outputs.begin();
+         found && it != outputs.end(); ++it)
+      {
+      std::string cachedFile = entry + "/" + it->first;
+      found = itksys::SystemTools::FileExists(cachedFile.c_str(), true) &&
+        itksys::SystemTools::CopyFileAlways(cachedFile.c_str(), it->second.c_str());
+      }
+    if (found)
+      {
+      // least recently used entries are removed first
+      itksys::SystemTools::Touch((entry + "/access").c_str(), true);
+      }
+    this->ResultCacheLock.Unlock();
+    return found;
+  }
+
+  /// Copy \a outputs into the cache entry \a key and remove the least
+  /// recently used entries if the cache exceeds its limit.
+  bool StoreResults(const std::string& key, const OutputFileMap& outputs)
+  {
+    std::string entry = this->GetResultCacheDirectory() + "/" + key;
+    this->ResultCacheLock.Lock();
+    if (itksys::SystemTools::FileIsDirectory(entry.c_str()))
+      {
+      itksys::SystemTools::RemoveADirectory(entry.c_str());
+      }
+    bool stored = itksys::SystemTools::MakeDirectory(entry.c_str());
+    for (OutputFileMap::const_iterator it = outputs.begin();
+         stored && it != outputs.end(); ++it)
+      {
+      stored = itksys::SystemTools::CopyFileAlways(
+        it->second.c_str(), (entry + "/" + it->first).c_str());
+      }
+    if (stored)
+      {
+      itksys::SystemTools::Touch((entry + "/access").c_str(), true);
+      this->CheckResultCacheSize();
+      }
+    else
+      {
+      itksys::SystemTools::RemoveADirectory(entry.c_str());
+      }
+    this->ResultCacheLock.Unlock();
+    return stored;
+  }
+
+  /// Remove the least recently used entries until the cache is smaller
+  /// than ResultCacheLimit (in MB, 0 for no limit). Called with
+  /// ResultCacheLock locked.
+  void CheckResultCacheSize()
+  {
+    if (this->ResultCacheLimit <= 0)
+      {
+      return;
+      }
+    std::string cacheDirectory = this->GetResultCacheDirectory();
+    itksys::Directory directory;
+    if (!directory.Load(cacheDirectory.c_str()))
+      {
+      return;
+      }
+    typedef std::multimap<long int, std::pair<std::string, double> > EntryMap;
+    EntryMap entries;
+    double cacheSize = 0.;
+    for (unsigned long i = 0; i < directory.GetNumberOfFiles(); ++i)
+      {
+      std::string name = directory.GetFile(i);
+      std::string entry = cacheDirectory + "/" + name;
+      itksys::Directory entryDirectory;
+      if (name == "." || name == ".." || !entryDirectory.Load(entry.c_str()))
+        {
+        continue;
+        }
+      double entrySize = 0.;
+      for (unsigned long j = 0; j < entryDirectory.GetNumberOfFiles(); ++j)
+        {
+        entrySize += itksys::SystemTools::FileLength(
+          (entry + "/" + entryDirectory.GetFile(j)).c_str());
+        }
+      entries.insert(std::make_pair(
+        itksys::SystemTools::ModifiedTime((entry + "/access").c_str()),
+        std::make_pair(entry, entrySize)));
+      cacheSize += entrySize;
+      }
+    const double limit = this->ResultCacheLimit * 1024. * 1024.;
+    for (EntryMap::iterator it = entries.begin();
+         cacheSize > limit && it != entries.end(); ++it)
+      {
+      itksys::SystemTools::RemoveADirectory(it->second.first.c_str());
+      cacheSize -= it->second.second;
+      }
+  }
+
+  /// Number of threads a run of \a node uses.
+  static int GetNumberOfThreads(vtkMRMLCommandLineModuleNode* node,
+                                vtkSlicerApplicationLogic* appLogic)
+  {
+    return node->GetNumberOfThreads() > 0 ? node->GetNumberOfThreads() :
+      appLogic->GetDefaultNumberOfThreadsPerTask();
+  }
 };
 
+namespace
+{
+// Protects the environment variables set for the executables being
+// launched, and the standard streams redirected for the shared object
+// modules, from the CLIs run concurrently in other processing threads.
+itk::SimpleMutexLock ProcessLaunchLock;
+itk::SimpleMutexLock StreamsRedirectionLock;
+}
+
 //----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkSlicerCLIModuleLogic);
 
@@ -143,11 +844,21 @@ vtkSlicerCLIModuleLogic::vtkSlicerCLIModuleLogic()
 
   this->Internal->DeleteTemporaryFiles = 1;
   this->Internal->RedirectModuleStreams = 1;
+  this->Internal->UseSharedMemory = 0;
+  this->Internal->LastBatchID = 0;
+  this->Internal->LastPipelineID = 0;
+  this->Internal->UseWorkerProcesses = 0;
+  this->Internal->UseResultCache = 0;
+  this->Internal->ResultCacheLimit = 1000;
+  this->Internal->IntermediateResultInterval = 2.;
+  this->Internal->ExecutionBackend =
+    vtkSmartPointer<vtkSlicerCLIExecutionBackend>::New();
 }
 
 //----------------------------------------------------------------------------
 vtkSlicerCLIModuleLogic::~vtkSlicerCLIModuleLogic()
 {
+  this->Internal->TerminateIdleWorkerProcesses();
   delete this->Internal;
 }
 
@@ -247,31 +958,212 @@ int vtkSlicerCLIModuleLogic::GetRedirectModuleStreams() const
 }
 
 //----------------------------------------------------------------------------
-std::string
-vtkSlicerCLIModuleLogic
-::ConstructTemporarySceneFileName(vtkMRMLScene *scene)
+void vtkSlicerCLIModuleLogic::UseSharedMemoryOn()
 {
-  std::string fname;
-  std::ostringstream fnameString;
-  std::string pid;
-  std::ostringstream pidString;
-
-  // Part of the filename will include an encoding of the scene
-  // pointer for uniqueness
-  char tname[256];
-      
-  sprintf(tname, "%p", scene);
-      
-  fname = tname;
+  this->SetUseSharedMemory(static_cast<int>(1));
+}
 
-  // To avoid confusing the Archetype readers, convert any
-  // numbers in the filename to characters [0-9]->[A-J]
-  std::transform(fname.begin(), fname.end(),
-                 fname.begin(), DigitsToCharacters());
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::UseSharedMemoryOff()
+{
+  this->SetUseSharedMemory(static_cast<int>(0));
+}
 
-  // Encode process id into a string.  To avoid confusing the
-  // Archetype reader, convert the numbers in pid to characters [0-9]->[A-J]
-#ifdef _WIN32
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::SetUseSharedMemory(int value)
+{
+  vtkDebugMacro(<< this->GetClassName() << " (" << this << "): setting UseSharedMemory to " << value);
+  if (this->Internal->UseSharedMemory != value)
+    {
+    this->Internal->UseSharedMemory = value;
+    this->Modified();
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerCLIModuleLogic::GetUseSharedMemory() const
+{
+  return this->Internal->UseSharedMemory;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::UseWorkerProcessesOn()
+{
+  this->SetUseWorkerProcesses(static_cast<int>(1));
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::UseWorkerProcessesOff()
+{
+  this->SetUseWorkerProcesses(static_cast<int>(0));
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::SetUseWorkerProcesses(int value)
+{
+  vtkDebugMacro(<< this->GetClassName() << " (" << this << "): setting UseWorkerProcesses to " << value);
+  if (this->Internal->UseWorkerProcesses != value)
+    {
+    this->Internal->WorkerProcessesLock.Lock();
+    this->Internal->UseWorkerProcesses = value;
+    this->Internal->WorkerProcessesLock.Unlock();
+    if (!value)
+      {
+      this->Internal->TerminateIdleWorkerProcesses();
+      }
+    this->Modified();
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerCLIModuleLogic::GetUseWorkerProcesses() const
+{
+  return this->Internal->UseWorkerProcesses;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::TerminateWorkerProcesses()
+{
+  this->Internal->TerminateIdleWorkerProcesses();
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::UseResultCacheOn()
+{
+  this->SetUseResultCache(static_cast<int>(1));
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::UseResultCacheOff()
+{
+  this->SetUseResultCache(static_cast<int>(0));
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::SetUseResultCache(int value)
+{
+  vtkDebugMacro(<< this->GetClassName() << " (" << this << "): setting UseResultCache to " << value);
+  if (this->Internal->UseResultCache != value)
+    {
+    this->Internal->UseResultCache = value;
+    this->Modified();
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerCLIModuleLogic::GetUseResultCache() const
+{
+  return this->Internal->UseResultCache;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::SetResultCacheDirectory(const char* directory)
+{
+  this->Internal->ResultCacheLock.Lock();
+  this->Internal->ResultCacheDirectory = directory ? directory : "";
+  this->Internal->ResultCacheLock.Unlock();
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+std::string vtkSlicerCLIModuleLogic::GetResultCacheDirectory() const
+{
+  return this->Internal->GetResultCacheDirectory();
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::SetResultCacheLimit(int megabytes)
+{
+  if (this->Internal->ResultCacheLimit != megabytes)
+    {
+    this->Internal->ResultCacheLock.Lock();
+    this->Internal->ResultCacheLimit = megabytes;
+    this->Internal->CheckResultCacheSize();
+    this->Internal->ResultCacheLock.Unlock();
+    this->Modified();
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerCLIModuleLogic::GetResultCacheLimit() const
+{
+  return this->Internal->ResultCacheLimit;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::ClearResultCache()
+{
+  this->Internal->ResultCacheLock.Lock();
+  std::string cacheDirectory = this->Internal->GetResultCacheDirectory();
+  if (itksys::SystemTools::FileIsDirectory(cacheDirectory.c_str()) &&
+      !itksys::SystemTools::RemoveADirectory(cacheDirectory.c_str()))
+    {
+    vtkWarningMacro( << "Unable to clear the result cache " << cacheDirectory );
+    }
+  this->Internal->ResultCacheLock.Unlock();
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::SetIntermediateResultInterval(double seconds)
+{
+  vtkDebugMacro(<< this->GetClassName() << " (" << this << "): setting IntermediateResultInterval to " << seconds);
+  if (this->Internal->IntermediateResultInterval != seconds)
+    {
+    this->Internal->IntermediateResultInterval = seconds;
+    this->Modified();
+    }
+}
+
+//----------------------------------------------------------------------------
+double vtkSlicerCLIModuleLogic::GetIntermediateResultInterval() const
+{
+  return this->Internal->IntermediateResultInterval;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::SetExecutionBackend(vtkSlicerCLIExecutionBackend* backend)
+{
+  if (backend && this->Internal->ExecutionBackend == backend)
+    {
+    return;
+    }
+  this->Internal->ExecutionBackend = backend ? backend :
+    vtkSmartPointer<vtkSlicerCLIExecutionBackend>::New().GetPointer();
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+vtkSlicerCLIExecutionBackend* vtkSlicerCLIModuleLogic::GetExecutionBackend() const
+{
+  return this->Internal->ExecutionBackend;
+}
+
+//----------------------------------------------------------------------------
+std::string
+vtkSlicerCLIModuleLogic
+::ConstructTemporarySceneFileName(vtkMRMLScene *scene)
+{
+  std::string fname;
+  std::ostringstream fnameString;
+  std::string pid;
+  std::ostringstream pidString;
+
+  // Part of the filename will include an encoding of the scene
+  // pointer for uniqueness
+  char tname[256];
+      
+  sprintf(tname, "%p", scene);
+      
+  fname = tname;
+
+  // To avoid confusing the Archetype readers, convert any
+  // numbers in the filename to characters [0-9]->[A-J]
+  std::transform(fname.begin(), fname.end(),
+                 fname.begin(), DigitsToCharacters());
+
+  // Encode process id into a string.  To avoid confusing the
+  // Archetype reader, convert the numbers in pid to characters [0-9]->[A-J]
+#ifdef _WIN32
   pidString << GetCurrentProcessId();
 #else
   pidString << getpid();
@@ -293,7 +1185,9 @@ vtkSlicerCLIModuleLogic
                              const std::string& type,
                              const std::string& name,
                              const std::vector<std::string>& extensions,
-                             CommandLineModuleType commandType)
+                             CommandLineModuleType commandType,
+                             const std::string& channel,
+                             const std::string& executionID)
 {
   std::string fname = name;
   std::string pid;
@@ -319,10 +1213,13 @@ vtkSlicerCLIModuleLogic
   // encoded to the same filename every time within that running
   // instance of Slicer).  This last point is an optimization to
   // minimize the number of times a file is written when running a
-  // module.  However, if we change the execution model such that more
-  // than one module can run at the same time within the same Slicer
-  // process, then this encoding will need to be changed to be unique
-  // per module execution.
+  // module.  As several modules can run at the same time within the
+  // same Slicer process, the filename is also made unique to the
+  // module execution with \a executionID (the ID of the CLI node).
+  //
+  // 4. If UseSharedMemory is set, volumes of executables are encoded as
+  // slicershm:<pid>_<node id>, the name of a shared memory segment
+  // (see vtkMRMLSharedMemoryImage).
   //
 
   
@@ -334,6 +1231,10 @@ vtkSlicerCLIModuleLogic
   pidString << getpid();
 #endif
   pid = pidString.str();
+  if (!executionID.empty())
+    {
+    pid += "_" + executionID;
+    }
   std::transform(pid.begin(), pid.end(), pid.begin(), DigitsToCharacters());
 
   // Because Python is responsible for looking up the MRML Object,
@@ -358,6 +1259,24 @@ vtkSlicerCLIModuleLogic
       {
       // If running an executable 
 
+      if (this->Internal->UseSharedMemory && commandType == CommandLineModule
+          && this->Internal->ExecutionBackend->IsLocal()
+          && extensions.size() == 0
+          && (type == "scalar" || type == "label" || type == "vector")
+#ifdef _WIN32
+          // The segments created by the executable are destroyed when it
+          // exits.
+          && channel == "input"
+#endif
+          )
+        {
+        std::string segment = name;
+        std::transform(segment.begin(), segment.end(),
+                       segment.begin(), DigitsToCharacters());
+        return vtkMRMLSharedMemoryImage::GetSharedMemoryFileName(
+          pid + "_" + segment);
+        }
+
       // Use default fname construction, tack on extension
       std::string ext = ".nrrd";
       if (extensions.size() != 0)
@@ -437,87 +1356,751 @@ vtkSlicerCLIModuleLogic
       }
     fname = fname + ext;
     }
-  
-    
-  return fname;
+  
+    
+  return fname;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::ApplyAndWait ( vtkMRMLCommandLineModuleNode* node, bool updateDisplay )
+{
+  // Just execute and wait.
+  node->Register(this);
+  node->SetAttribute("UpdateDisplay", updateDisplay ? "true" : "false");
+
+  // Observe application logic to know when the CLI is completed and the
+  // associated data loaded. The observation will be removed in the callback.
+  vtkEventBroker::GetInstance()->AddObservation(
+    this->GetApplicationLogic(), vtkSlicerApplicationLogic::RequestProcessedEvent,
+    this, this->GetMRMLLogicsCallbackCommand());
+
+  vtkSlicerCLIModuleLogic::ApplyTask ( node );
+
+  while (this->GetApplicationLogic()->GetReadDataQueueSize())
+    {
+    this->GetApplicationLogic()->ProcessReadData();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::SetTemporaryDirectory(const char *tempdir)
+{
+  this->Internal->TemporaryDirectory = tempdir;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::Apply ( vtkMRMLCommandLineModuleNode* node, bool updateDisplay )
+{
+  bool ret;
+
+  if ( node->GetModuleDescription().GetType() == "PythonModule" )
+    {
+    this->ApplyAndWait ( node );
+    return;
+    }
+
+
+  vtkSlicerTask* task = vtkSlicerTask::New();
+  task->SetTypeToProcessing();
+  task->SetNumberOfThreads(
+    vtkInternal::GetNumberOfThreads(node, this->GetApplicationLogic()));
+  task->SetRequiredMemory(node->GetRequiredMemory());
+  task->SetPriority(node->GetPriority());
+
+  // Pass the current node as client data to the task.  This allows
+  // the user to switch to another parameter set after the task is
+  // scheduled but before it starts to run. And when the scheduled
+  // task does run, it will operate on the correct node.
+  task->SetTaskFunction(this, (vtkSlicerTask::TaskFunctionPointer)
+                        &vtkSlicerCLIModuleLogic::ApplyTask,
+                        node);
+  
+  // Client data on the task is just a regular pointer, up the
+  // reference count on the node, we'll decrease the reference count
+  // once the task actually runs
+  node->Register(this);
+  node->SetAttribute("UpdateDisplay", updateDisplay ? "true" : "false");
+
+  // Observe application logic to know when the CLI is completed and the
+  // associated data loaded. The observation will be removed in the callback.
+  vtkEventBroker::GetInstance()->AddObservation(
+    this->GetApplicationLogic(), vtkSlicerApplicationLogic::RequestProcessedEvent,
+    this, this->GetMRMLLogicsCallbackCommand());
+
+  // Schedule the task
+  ret = this->GetApplicationLogic()->ScheduleTask( task );
+
+  if (!ret)
+    {
+    vtkWarningMacro( << "Could not schedule task" );
+    }
+  else
+    {
+    this->Internal->ScheduledTasks[node] = task;
+    node->SetStatus(vtkMRMLCommandLineModuleNode::Scheduled);
+    }
+  
+  task->Delete();
+
+}
+
+//-----------------------------------------------------------------------------
+int vtkSlicerCLIModuleLogic
+::ApplyBatch(vtkMRMLCommandLineModuleNode* node,
+             const std::vector<BatchItemType>& items,
+             vtkCollection* itemNodes)
+{
+  if (!node || !this->GetMRMLScene())
+    {
+    vtkErrorMacro("ApplyBatch: no CLI node or no scene");
+    return 0;
+    }
+  int batchID = ++this->Internal->LastBatchID;
+  vtkInternal::BatchType& batch = this->Internal->Batches[batchID];
+  std::ostringstream executionID;
+  executionID << "batch" << batchID;
+
+  // Write once the input nodes that are common to all the items. Shared
+  // object modules read the volumes from memory and don't need it.
+  BatchItemType sharedInputs;
+  const ModuleDescription& description = node->GetModuleDescription();
+  if (description.GetType() == "CommandLineModule")
+    {
+    std::vector<ModuleParameterGroup>::const_iterator pgit;
+    for (pgit = description.GetParameterGroups().begin();
+         pgit != description.GetParameterGroups().end(); ++pgit)
+      {
+      std::vector<ModuleParameter>::const_iterator pit;
+      for (pit = (*pgit).GetParameters().begin();
+           pit != (*pgit).GetParameters().end(); ++pit)
+        {
+        if ((*pit).GetChannel() != "input" || (*pit).GetHidden() == "true" ||
+            ((*pit).GetTag() != "image" && (*pit).GetTag() != "geometry"
+             && (*pit).GetTag() != "transform" && (*pit).GetTag() != "table"
+             && (*pit).GetTag() != "measurement"))
+          {
+          continue;
+          }
+        bool overridden = false;
+        std::vector<BatchItemType>::const_iterator iit;
+        for (iit = items.begin(); iit != items.end() && !overridden; ++iit)
+          {
+          overridden = iit->find((*pit).GetName()) != iit->end();
+          }
+        std::string id = (*pit).GetDefault();
+        vtkMRMLStorableNode* storableNode = vtkMRMLStorableNode::SafeDownCast(
+          this->GetMRMLScene()->GetNodeByID(id.c_str()));
+        if (overridden || !storableNode)
+          {
+          continue;
+          }
+        std::string fname =
+          this->ConstructTemporaryFileName((*pit).GetTag(), (*pit).GetType(),
+                                           id, (*pit).GetFileExtensions(),
+                                           CommandLineModule,
+                                           (*pit).GetChannel(),
+                                           executionID.str());
+        // transforms sent through a mini-scene are left to each item
+        if (itksys::SystemTools::GetFilenameLastExtension(fname) == ".mrml")
+          {
+          continue;
+          }
+        bool written = false;
+        if (vtkMRMLSharedMemoryImage::IsSharedMemoryFileName(fname.c_str()))
+          {
+          vtkSmartPointer<vtkMRMLSharedMemoryImage> segment =
+            vtkSmartPointer<vtkMRMLSharedMemoryImage>::New();
+          written = segment->WriteVolume(
+            fname.c_str(), vtkMRMLVolumeNode::SafeDownCast(storableNode));
+          batch.SharedMemoryImages.push_back(segment);
+          }
+        else
+          {
+          vtkSmartPointer<vtkMRMLStorageNode> storageNode;
+          storageNode.TakeReference(storableNode->CreateDefaultStorageNode());
+          if (storageNode)
+            {
+            storageNode->ConfigureForDataExchange();
+            storageNode->SetScene(this->GetMRMLScene());
+            storageNode->SetFileName(fname.c_str());
+            written = storageNode->WriteData(storableNode) != 0;
+            }
+          }
+        batch.FilesToDelete.insert(fname);
+        if (!written)
+          {
+          vtkErrorMacro("ApplyBatch: ERROR writing file " << fname);
+          continue;
+          }
+        sharedInputs[(*pit).GetName()] = fname;
+        }
+      }
+    }
+
+  int scheduledItems = 0;
+  for (size_t i = 0; i < items.size(); ++i)
+    {
+    vtkSmartPointer<vtkMRMLCommandLineModuleNode> itemNode;
+    itemNode.TakeReference(vtkMRMLCommandLineModuleNode::SafeDownCast(
+      node->CreateNodeInstance()));
+    itemNode->Copy(node);
+    itemNode->SetStatus(vtkMRMLCommandLineModuleNode::Idle, false);
+    itemNode->SetNumberOfThreads(node->GetNumberOfThreads());
+    itemNode->SetRequiredMemory(node->GetRequiredMemory());
+    itemNode->SetPriority(node->GetPriority());
+    itemNode->SetHideFromEditors(1);
+    std::ostringstream name;
+    name << (node->GetName() ? node->GetName() : "CLI") << "_batch"
+         << batchID << "_" << i;
+    itemNode->SetName(name.str().c_str());
+
+    BatchItemType::const_iterator pit;
+    for (pit = sharedInputs.begin(); pit != sharedInputs.end(); ++pit)
+      {
+      itemNode->SetParameterAsString(pit->first.c_str(), pit->second);
+      }
+    for (pit = items[i].begin(); pit != items[i].end(); ++pit)
+      {
+      if (!itemNode->SetParameterAsString(pit->first.c_str(), pit->second))
+        {
+        vtkWarningMacro("ApplyBatch: item " << i << " sets the unknown "
+                        << "parameter \"" << pit->first << "\"");
+        }
+      }
+
+    this->GetMRMLScene()->AddNode(itemNode);
+    this->Apply(itemNode, false);
+    if (itemNode->GetStatus() == vtkMRMLCommandLineModuleNode::Idle)
+      {
+      vtkErrorMacro("ApplyBatch: item " << i << " could not be scheduled");
+      this->GetMRMLScene()->RemoveNode(itemNode);
+      continue;
+      }
+    this->Internal->BatchItems[itemNode] = batchID;
+    ++batch.NumberOfRunningItems;
+    ++scheduledItems;
+    if (itemNodes)
+      {
+      itemNodes->AddItem(itemNode);
+      }
+    if (!itemNode->IsBusy())
+      {
+      // Python modules are run synchronously
+      this->OnBatchItemDone(itemNode);
+      }
+    }
+  if (scheduledItems == 0)
+    {
+    this->RemoveBatch(batchID);
+    }
+  return scheduledItems;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::OnBatchItemDone(vtkMRMLCommandLineModuleNode* itemNode)
+{
+  vtkInternal::BatchItemMap::iterator itemIt =
+    this->Internal->BatchItems.find(itemNode);
+  if (itemIt == this->Internal->BatchItems.end())
+    {
+    return;
+    }
+  int batchID = itemIt->second;
+  this->Internal->BatchItems.erase(itemIt);
+  this->Internal->ScheduledTasks.erase(itemNode);
+
+  this->InvokeEvent(vtkSlicerCLIModuleLogic::BatchItemCompletedEvent, itemNode);
+
+  // The node may be removed while it invokes its ModifiedEvent, it must
+  // outlive the event.
+  this->Internal->RemovedBatchItem = itemNode;
+  if (itemNode->GetScene())
+    {
+    itemNode->GetScene()->RemoveNode(itemNode);
+    }
+
+  vtkInternal::BatchMap::iterator batchIt =
+    this->Internal->Batches.find(batchID);
+  if (batchIt != this->Internal->Batches.end() &&
+      --batchIt->second.NumberOfRunningItems == 0)
+    {
+    this->RemoveBatch(batchID);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::RemoveBatch(int batchID)
+{
+  vtkInternal::BatchMap::iterator batchIt =
+    this->Internal->Batches.find(batchID);
+  if (batchIt == this->Internal->Batches.end())
+    {
+    return;
+    }
+  if (this->GetDeleteTemporaryFiles())
+    {
+    std::set<std::string>::const_iterator fit;
+    for (fit = batchIt->second.FilesToDelete.begin();
+         fit != batchIt->second.FilesToDelete.end(); ++fit)
+      {
+      if (!vtkInternal::RemoveTemporaryFile(*fit))
+        {
+        vtkWarningMacro( << "Unable to delete temporary file " << *fit );
+        }
+      }
+    }
+  this->Internal->Batches.erase(batchIt);
+}
+
+//-----------------------------------------------------------------------------
+bool vtkSlicerCLIModuleLogic
+::ConnectPipeline(vtkMRMLCommandLineModuleNode* node, const char* outputName,
+                  vtkSlicerCLIModuleLogic* nextLogic,
+                  vtkMRMLCommandLineModuleNode* nextNode,
+                  const char* nextInputName)
+{
+  if (!node || !nextNode || !outputName || !nextInputName)
+    {
+    vtkErrorMacro("ConnectPipeline: no CLI node or no parameter");
+    return false;
+    }
+  ModuleParameter output;
+  ModuleParameter input;
+  if (!vtkInternal::FindParameter(node->GetModuleDescription(), outputName, output) ||
+      output.GetChannel() != "output" ||
+      !vtkInternal::FindParameter(nextNode->GetModuleDescription(), nextInputName, input) ||
+      input.GetChannel() != "input" ||
+      output.GetTag() != input.GetTag())
+    {
+    vtkErrorMacro("ConnectPipeline: can't connect the output \"" << outputName
+                  << "\" to the input \"" << nextInputName << "\"");
+    return false;
+    }
+  if (this->Internal->IsPipelineConnected(nextNode, node))
+    {
+    vtkErrorMacro("ConnectPipeline: connecting " << nextNode->GetID()
+                  << " after " << node->GetID() << " would make a cycle");
+    return false;
+    }
+
+  // An input reads a single output.
+  vtkInternal::PipelineConnectionList::iterator cit;
+  for (cit = this->Internal->PipelineConnections.begin();
+       cit != this->Internal->PipelineConnections.end(); ++cit)
+    {
+    if (cit->NextNode == nextNode && cit->NextInputName == nextInputName)
+      {
+      this->Internal->PipelineConnections.erase(cit);
+      break;
+      }
+    }
+  vtkInternal::PipelineConnectionType connection;
+  connection.Node = node;
+  connection.OutputName = outputName;
+  connection.NextLogic = nextLogic ? nextLogic : this;
+  connection.NextNode = nextNode;
+  connection.NextInputName = nextInputName;
+  this->Internal->PipelineConnections.push_back(connection);
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::DisconnectPipeline(vtkMRMLCommandLineModuleNode* node)
+{
+  vtkInternal::PipelineConnectionList::iterator cit =
+    this->Internal->PipelineConnections.begin();
+  while (cit != this->Internal->PipelineConnections.end())
+    {
+    if (cit->Node == node || cit->NextNode == node)
+      {
+      cit = this->Internal->PipelineConnections.erase(cit);
+      }
+    else
+      {
+      ++cit;
+      }
+    }
+}
+
+//-----------------------------------------------------------------------------
+bool vtkSlicerCLIModuleLogic
+::ApplyPipeline(vtkMRMLCommandLineModuleNode* node, bool updateDisplay)
+{
+  if (!node || !this->GetMRMLScene())
+    {
+    vtkErrorMacro("ApplyPipeline: no CLI node or no scene");
+    return false;
+    }
+
+  // Collect the nodes of the pipeline
+  std::map<vtkMRMLCommandLineModuleNode*, int> waitingNodes;
+  std::vector<vtkMRMLCommandLineModuleNode*> nodes(1, node);
+  std::vector<const vtkInternal::PipelineConnectionType*> connections;
+  for (size_t i = 0; i < nodes.size(); ++i)
+    {
+    if (this->Internal->PipelineNodes.find(nodes[i]) !=
+          this->Internal->PipelineNodes.end() || nodes[i]->IsBusy())
+      {
+      vtkErrorMacro("ApplyPipeline: " << nodes[i]->GetID()
+                    << " is already running");
+      return false;
+      }
+    vtkInternal::PipelineConnectionList::const_iterator cit;
+    for (cit = this->Internal->PipelineConnections.begin();
+         cit != this->Internal->PipelineConnections.end(); ++cit)
+      {
+      if (cit->Node != nodes[i])
+        {
+        continue;
+        }
+      if (waitingNodes.find(cit->NextNode) == waitingNodes.end())
+        {
+        nodes.push_back(cit->NextNode);
+        }
+      ++waitingNodes[cit->NextNode];
+      connections.push_back(&(*cit));
+      }
+    }
+
+  int pipelineID = ++this->Internal->LastPipelineID;
+  vtkInternal::PipelineType& pipeline = this->Internal->Pipelines[pipelineID];
+  pipeline.FirstNode = node;
+  pipeline.UpdateDisplay = updateDisplay;
+  pipeline.WaitingNodes = waitingNodes;
+  pipeline.WaitingNodes[node] = 0;
+  for (size_t i = 0; i < nodes.size(); ++i)
+    {
+    this->Internal->PipelineNodes[nodes[i]] = pipelineID;
+    }
+  std::ostringstream executionID;
+  executionID << "pipeline" << pipelineID;
+
+  // Set the connected inputs to the outputs, the outputs that are not set
+  // are replaced by intermediate results.
+  std::map<std::pair<vtkMRMLCommandLineModuleNode*, std::string>, std::string> outputs;
+  for (size_t i = 0; i < connections.size(); ++i)
+    {
+    const vtkInternal::PipelineConnectionType& connection = *connections[i];
+    std::pair<vtkMRMLCommandLineModuleNode*, std::string> output(
+      connection.Node, connection.OutputName);
+    if (outputs.find(output) == outputs.end())
+      {
+      std::string value =
+        connection.Node->GetParameterAsString(connection.OutputName.c_str());
+      if (value.empty())
+        {
+        ModuleParameter parameter;
+        vtkInternal::FindParameter(connection.Node->GetModuleDescription(),
+                                   connection.OutputName, parameter);
+        // Shared object modules read and write the volumes of the scene
+        // directly.
+        bool inMemory =
+          connection.Node->GetModuleType() == "SharedObjectModule";
+        for (size_t j = 0; j < connections.size(); ++j)
+          {
+          inMemory = inMemory &&
+            (connections[j]->Node != connection.Node ||
+             connections[j]->OutputName != connection.OutputName ||
+             connections[j]->NextNode->GetModuleType() == "SharedObjectModule");
+          }
+        std::string className =
+          vtkInternal::GetIntermediateNodeClassName(parameter);
+        vtkMRMLNode* intermediateNode = (inMemory && !className.empty()) ?
+          this->GetMRMLScene()->CreateNodeByClass(className.c_str()) : 0;
+        if (intermediateNode)
+          {
+          std::string name = std::string(node->GetName() ? node->GetName() : "CLI")
+            + "_" + executionID.str() + "_" + connection.OutputName;
+          intermediateNode->SetName(name.c_str());
+          intermediateNode->SetHideFromEditors(1);
+          if (parameter.GetType() == "label")
+            {
+            intermediateNode->SetAttribute("LabelMap", "1");
+            }
+          this->GetMRMLScene()->AddNode(intermediateNode);
+          value = intermediateNode->GetID();
+          intermediateNode->Delete();
+          }
+        else
+          {
+          // Give an extension so the result is never passed through a
+          // mini-scene or shared memory.
+          std::vector<std::string> extensions = parameter.GetFileExtensions();
+          if (extensions.empty())
+            {
+            extensions.push_back(
+              parameter.GetTag() == "image" ? ".nrrd" :
+              parameter.GetTag() == "geometry" ? ".vtp" :
+              parameter.GetTag() == "transform" ? ".tfm" :
+              parameter.GetTag() == "table" ? ".ctbl" : ".csv");
+            }
+          value = this->ConstructTemporaryFileName(
+            parameter.GetTag(), parameter.GetType(),
+            std::string(connection.Node->GetID()) + "_" + connection.OutputName,
+            extensions, CommandLineModule, "output", executionID.str());
+          }
+        vtkInternal::PipelineParameterType saved;
+        saved.Node = connection.Node;
+        saved.Name = connection.OutputName;
+        pipeline.SavedParameters.push_back(saved);
+        connection.Node->SetParameterAsString(connection.OutputName.c_str(), value);
+        pipeline.Intermediates[value].insert(connection.Node);
+        }
+      outputs[output] = value;
+      }
+    const std::string& value = outputs[output];
+    std::map<std::string, std::set<vtkMRMLCommandLineModuleNode*> >::iterator
+      iit = pipeline.Intermediates.find(value);
+    if (iit != pipeline.Intermediates.end())
+      {
+      iit->second.insert(connection.NextNode);
+      }
+    vtkInternal::PipelineParameterType saved;
+    saved.Node = connection.NextNode;
+    saved.Name = connection.NextInputName;
+    saved.Value =
+      connection.NextNode->GetParameterAsString(connection.NextInputName.c_str());
+    pipeline.SavedParameters.push_back(saved);
+    connection.NextNode->SetParameterAsString(
+      connection.NextInputName.c_str(), value);
+    }
+
+  this->ApplyPipelineNode(pipelineID, node);
+  return node->GetStatus() != vtkMRMLCommandLineModuleNode::Idle;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic
+::ApplyPipelineNode(int pipelineID, vtkMRMLCommandLineModuleNode* node)
+{
+  vtkInternal::PipelineMap::iterator pit =
+    this->Internal->Pipelines.find(pipelineID);
+  if (pit == this->Internal->Pipelines.end())
+    {
+    return;
+    }
+  pit->second.WaitingNodes.erase(node);
+
+  vtkSlicerCLIModuleLogic* logic = this;
+  bool lastNode = true;
+  vtkInternal::PipelineConnectionList::const_iterator cit;
+  for (cit = this->Internal->PipelineConnections.begin();
+       cit != this->Internal->PipelineConnections.end(); ++cit)
+    {
+    if (cit->NextNode == node)
+      {
+      logic = cit->NextLogic;
+      }
+    lastNode = lastNode && cit->Node != node;
+    }
+  logic->Apply(node, pit->second.UpdateDisplay && lastNode);
+
+  pit = this->Internal->Pipelines.find(pipelineID);
+  if (pit == this->Internal->Pipelines.end())
+    {
+    return;
+    }
+  if (node->GetStatus() == vtkMRMLCommandLineModuleNode::Idle)
+    {
+    vtkErrorMacro("ApplyPipeline: " << node->GetID() << " could not be scheduled");
+    this->FinishPipelineNode(pipelineID, node, false);
+    return;
+    }
+  pit->second.RunningNodes.insert(node);
+  if (!node->IsBusy())
+    {
+    // Python modules are run synchronously
+    this->OnPipelineNodeDone(node);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::OnPipelineNodeDone(vtkMRMLCommandLineModuleNode* node)
+{
+  vtkInternal::PipelineNodeMap::iterator nit =
+    this->Internal->PipelineNodes.find(node);
+  if (nit == this->Internal->PipelineNodes.end())
+    {
+    return;
+    }
+  int pipelineID = nit->second;
+  vtkInternal::PipelineMap::iterator pit =
+    this->Internal->Pipelines.find(pipelineID);
+  // Waiting nodes are not running yet
+  if (pit == this->Internal->Pipelines.end() ||
+      pit->second.RunningNodes.erase(node) == 0)
+    {
+    return;
+    }
+  this->FinishPipelineNode(pipelineID, node,
+    node->GetStatus() == vtkMRMLCommandLineModuleNode::Completed);
+}
+
+//-----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic
+::FinishPipelineNode(int pipelineID, vtkMRMLCommandLineModuleNode* node,
+                     bool completed)
+{
+  this->Internal->PipelineNodes.erase(node);
+  vtkInternal::PipelineMap::iterator pit =
+    this->Internal->Pipelines.find(pipelineID);
+  if (pit == this->Internal->Pipelines.end())
+    {
+    return;
+    }
+
+  // The node doesn't write or read its intermediate results anymore.
+  std::map<std::string, std::set<vtkMRMLCommandLineModuleNode*> >::iterator iit;
+  for (iit = pit->second.Intermediates.begin();
+       iit != pit->second.Intermediates.end(); ++iit)
+    {
+    iit->second.erase(node);
+    }
+
+  // The nodes stay waiting until they are applied so the pipeline is not
+  // finished while applying them.
+  std::vector<vtkMRMLCommandLineModuleNode*> nextNodes;
+  std::vector<vtkMRMLCommandLineModuleNode*> skippedNodes;
+  vtkInternal::PipelineConnectionList::const_iterator cit;
+  for (cit = this->Internal->PipelineConnections.begin();
+       cit != this->Internal->PipelineConnections.end(); ++cit)
+    {
+    std::map<vtkMRMLCommandLineModuleNode*, int>::iterator wit =
+      pit->second.WaitingNodes.find(cit->NextNode);
+    if (cit->Node != node || wit == pit->second.WaitingNodes.end())
+      {
+      continue;
+      }
+    if (!completed)
+      {
+      skippedNodes.push_back(cit->NextNode);
+      }
+    else if (--wit->second == 0)
+      {
+      nextNodes.push_back(cit->NextNode);
+      }
+    }
+  for (size_t i = 0; i < skippedNodes.size(); ++i)
+    {
+    this->SkipPipelineNode(pipelineID, skippedNodes[i]);
+    }
+  this->RemovePipelineIntermediates(pipelineID);
+  for (size_t i = 0; i < nextNodes.size(); ++i)
+    {
+    this->ApplyPipelineNode(pipelineID, nextNodes[i]);
+    }
+
+  pit = this->Internal->Pipelines.find(pipelineID);
+  if (pit != this->Internal->Pipelines.end() &&
+      pit->second.RunningNodes.empty() && pit->second.WaitingNodes.empty())
+    {
+    this->RemovePipeline(pipelineID);
+    }
 }
 
 //-----------------------------------------------------------------------------
-void vtkSlicerCLIModuleLogic::ApplyAndWait ( vtkMRMLCommandLineModuleNode* node, bool updateDisplay )
+void vtkSlicerCLIModuleLogic
+::SkipPipelineNode(int pipelineID, vtkMRMLCommandLineModuleNode* node)
 {
-  // Just execute and wait.
-  node->Register(this);
-  node->SetAttribute("UpdateDisplay", updateDisplay ? "true" : "false");
-
-  // Observe application logic to know when the CLI is completed and the
-  // associated data loaded. The observation will be removed in the callback.
-  vtkEventBroker::GetInstance()->AddObservation(
-    this->GetApplicationLogic(), vtkSlicerApplicationLogic::RequestProcessedEvent,
-    this, this->GetMRMLLogicsCallbackCommand());
-
-  vtkSlicerCLIModuleLogic::ApplyTask ( node );
-
-  while (this->GetApplicationLogic()->GetReadDataQueueSize())
+  vtkInternal::PipelineMap::iterator pit =
+    this->Internal->Pipelines.find(pipelineID);
+  if (pit == this->Internal->Pipelines.end() ||
+      pit->second.WaitingNodes.erase(node) == 0)
     {
-    this->GetApplicationLogic()->ProcessReadData();
+    return;
+    }
+  vtkWarningMacro("ApplyPipeline: " << node->GetID() << " is not run, "
+                  "a node before it failed");
+  this->Internal->PipelineNodes.erase(node);
+  std::map<std::string, std::set<vtkMRMLCommandLineModuleNode*> >::iterator iit;
+  for (iit = pit->second.Intermediates.begin();
+       iit != pit->second.Intermediates.end(); ++iit)
+    {
+    iit->second.erase(node);
+    }
+  vtkInternal::PipelineConnectionList::const_iterator cit;
+  for (cit = this->Internal->PipelineConnections.begin();
+       cit != this->Internal->PipelineConnections.end(); ++cit)
+    {
+    if (cit->Node == node)
+      {
+      this->SkipPipelineNode(pipelineID, cit->NextNode);
+      }
     }
 }
 
 //-----------------------------------------------------------------------------
-void vtkSlicerCLIModuleLogic::SetTemporaryDirectory(const char *tempdir)
+void vtkSlicerCLIModuleLogic::RemovePipelineIntermediates(int pipelineID, bool all)
 {
-  this->Internal->TemporaryDirectory = tempdir;
+  vtkInternal::PipelineMap::iterator pit =
+    this->Internal->Pipelines.find(pipelineID);
+  if (pit == this->Internal->Pipelines.end())
+    {
+    return;
+    }
+  std::map<std::string, std::set<vtkMRMLCommandLineModuleNode*> >::iterator iit =
+    pit->second.Intermediates.begin();
+  while (iit != pit->second.Intermediates.end())
+    {
+    if (!all && !iit->second.empty())
+      {
+      ++iit;
+      continue;
+      }
+    if (!vtkInternal::IsFileName(iit->first))
+      {
+      vtkMRMLNode* intermediateNode = this->GetMRMLScene() ?
+        this->GetMRMLScene()->GetNodeByID(iit->first) : 0;
+      if (intermediateNode)
+        {
+        this->GetMRMLScene()->RemoveNode(intermediateNode);
+        }
+      }
+    else if (this->GetDeleteTemporaryFiles() &&
+             !vtkInternal::RemoveTemporaryFile(iit->first))
+      {
+      vtkWarningMacro( << "Unable to delete temporary file " << iit->first );
+      }
+    pit->second.Intermediates.erase(iit++);
+    }
 }
 
 //-----------------------------------------------------------------------------
-void vtkSlicerCLIModuleLogic::Apply ( vtkMRMLCommandLineModuleNode* node, bool updateDisplay )
+void vtkSlicerCLIModuleLogic::RemovePipeline(int pipelineID)
 {
-  bool ret;
-
-  if ( node->GetModuleDescription().GetType() == "PythonModule" )
+  this->RemovePipelineIntermediates(pipelineID, true);
+  vtkInternal::PipelineMap::iterator pit =
+    this->Internal->Pipelines.find(pipelineID);
+  if (pit == this->Internal->Pipelines.end())
     {
-    this->ApplyAndWait ( node );
     return;
     }
-
-
-  vtkSlicerTask* task = vtkSlicerTask::New();
-  task->SetTypeToProcessing();
-
-  // Pass the current node as client data to the task.  This allows
-  // the user to switch to another parameter set after the task is
-  // scheduled but before it starts to run. And when the scheduled
-  // task does run, it will operate on the correct node.
-  task->SetTaskFunction(this, (vtkSlicerTask::TaskFunctionPointer)
-                        &vtkSlicerCLIModuleLogic::ApplyTask,
-                        node);
-  
-  // Client data on the task is just a regular pointer, up the
-  // reference count on the node, we'll decrease the reference count
-  // once the task actually runs
-  node->Register(this);
-  node->SetAttribute("UpdateDisplay", updateDisplay ? "true" : "false");
-
-  // Observe application logic to know when the CLI is completed and the
-  // associated data loaded. The observation will be removed in the callback.
-  vtkEventBroker::GetInstance()->AddObservation(
-    this->GetApplicationLogic(), vtkSlicerApplicationLogic::RequestProcessedEvent,
-    this, this->GetMRMLLogicsCallbackCommand());
-
-  // Schedule the task
-  ret = this->GetApplicationLogic()->ScheduleTask( task );
-
-  if (!ret)
+  vtkSmartPointer<vtkMRMLCommandLineModuleNode> firstNode = pit->second.FirstNode;
+  std::vector<vtkInternal::PipelineParameterType> savedParameters =
+    pit->second.SavedParameters;
+  this->Internal->Pipelines.erase(pit);
+  vtkInternal::PipelineNodeMap::iterator nit =
+    this->Internal->PipelineNodes.begin();
+  while (nit != this->Internal->PipelineNodes.end())
     {
-    vtkWarningMacro( << "Could not schedule task" );
+    if (nit->second == pipelineID)
+      {
+      this->Internal->PipelineNodes.erase(nit++);
+      }
+    else
+      {
+      ++nit;
+      }
     }
-  else
+
+  // Restore in the reverse order of the changes
+  std::vector<vtkInternal::PipelineParameterType>::reverse_iterator sit;
+  for (sit = savedParameters.rbegin(); sit != savedParameters.rend(); ++sit)
     {
-    node->SetStatus(vtkMRMLCommandLineModuleNode::Scheduled);
+    sit->Node->SetParameterAsString(sit->Name.c_str(), sit->Value);
     }
-  
-  task->Delete();
-
+  this->InvokeEvent(vtkSlicerCLIModuleLogic::PipelineCompletedEvent,
+                    firstNode.GetPointer());
 }
 
 //-----------------------------------------------------------------------------
@@ -722,7 +2305,9 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
                                              (*pit).GetType(),
                                              id,
                                              (*pit).GetFileExtensions(),
-                                             commandType);
+                                             commandType,
+                                             (*pit).GetChannel(),
+                                             node0->GetID());
 
         filesToDelete.insert(fname);
 
@@ -749,6 +2334,10 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
   MemoryTransferPossible.insert("vtkMRMLDiffusionTensorVolumeNode");
 
   MRMLIDToFileNameMap::const_iterator id2fn0;
+
+  // Shared memory segments of the input volumes. On Windows, a segment
+  // only lives while it is opened: they are kept until the module is done.
+  std::vector<vtkSmartPointer<vtkMRMLSharedMemoryImage> > sharedMemoryImages;
     
   for (id2fn0 = nodesToWrite.begin();
        id2fn0 != nodesToWrite.end();
@@ -847,6 +2436,21 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
         }
       }
 
+    // volumes passed through shared memory are not written in a file
+    if (out && vtkMRMLSharedMemoryImage::IsSharedMemoryFileName(
+          (*id2fn0).second.c_str()))
+      {
+      vtkSmartPointer<vtkMRMLSharedMemoryImage> segment =
+        vtkSmartPointer<vtkMRMLSharedMemoryImage>::New();
+      if (!segment->WriteVolume((*id2fn0).second.c_str(),
+                                vtkMRMLVolumeNode::SafeDownCast(nd)))
+        {
+        vtkErrorMacro("ERROR writing shared memory " << (*id2fn0).second);
+        }
+      sharedMemoryImages.push_back(segment);
+      out = 0;
+      }
+
     // if the file is to be written, then write it
     if (out)
       {
@@ -943,6 +2547,9 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
     commandLineAsString.push_back(node0->GetModuleDescription().GetLocation());
     }
   commandLineAsString.push_back( node0->GetModuleDescription().GetTarget() );
+  // Arguments that start the module, the parameters come after.
+  const std::vector<std::string>::size_type commandPrefixSize =
+    commandLineAsString.size();
 
 
   // Add a command line flag for the process information structure
@@ -981,7 +2588,7 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
       }
 
     std::string returnFile = this->Internal->TemporaryDirectory + "/" + pidString.str()
-      + "_" + code.str() + ".params";
+      + "_" + node0->GetID() + "_" + code.str() + ".params";
 
     commandLineAsString.push_back( returnFile );
 
@@ -1108,8 +2715,15 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
             fname = minisceneFilename + "#" + (*mit).second;
             }
 
+          // the value is not a node but a file given by the caller
+          if (fname.size() == 0 && vtkInternal::IsFileName((*pit).GetDefault())
+              && !this->GetMRMLScene()->GetNodeByID((*pit).GetDefault().c_str()))
+            {
+            fname = (*pit).GetDefault();
+            }
+
           // Only put out the flag if the node in nodesToWrite/Reload
-          // or in the mini-scene
+          // or in the mini-scene or if it is a file
           if (fname.size() > 0)
             {
             commandLineAsString.push_back(prefix + flag);
@@ -1368,6 +2982,13 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
         fname = minisceneFilename + "#" + (*mit).second;
         }      
 
+      // the value is not a node but a file given by the caller
+      if (fname.size() == 0 && vtkInternal::IsFileName((*iit).second.GetDefault())
+          && !this->GetMRMLScene()->GetNodeByID((*iit).second.GetDefault().c_str()))
+        {
+        fname = (*iit).second.GetDefault();
+        }
+
       if (fname.size() > 0)
         {
         commandLineAsString.push_back( fname );
@@ -1409,13 +3030,61 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
   qDebug() << information0.str().c_str();
   
 
+  // Look for the results of a previous run with the same input data and
+  // parameters.
+  std::string resultCacheKey;
+  vtkInternal::OutputFileMap cachedOutputs;
+  bool resultCacheHit = false;
+  if (this->Internal->UseResultCache && commandType == CommandLineModule &&
+      miniscene->GetNumberOfNodes() == 0)
+    {
+    resultCacheKey = vtkInternal::GetResultCacheKey(
+      node0->GetModuleDescription(), commandLineAsString,
+      nodesToWrite, nodesToReload, node0->GetID(), cachedOutputs);
+    resultCacheHit = !resultCacheKey.empty() &&
+      this->Internal->RetrieveResults(resultCacheKey, cachedOutputs);
+    }
+
+  // A remote backend runs the executable on another computer: the files
+  // written for the module are sent there first.
+  vtkSmartPointer<vtkSlicerCLIExecutionBackend> backend =
+    this->Internal->ExecutionBackend;
+  const bool remoteRun = commandType == CommandLineModule && !backend->IsLocal();
+  std::vector<std::string> backendInputFiles;
+  std::vector<std::string> backendOutputFiles;
+  for (id2fn0 = nodesToWrite.begin(); id2fn0 != nodesToWrite.end(); ++id2fn0)
+    {
+    backendInputFiles.push_back((*id2fn0).second);
+    }
+  for (id2fn0 = nodesToReload.begin(); id2fn0 != nodesToReload.end(); ++id2fn0)
+    {
+    backendOutputFiles.push_back((*id2fn0).second);
+    }
+  std::vector<std::string> backendFiles(backendInputFiles);
+  backendFiles.insert(backendFiles.end(),
+                      backendOutputFiles.begin(), backendOutputFiles.end());
+
   // run the filter
   //
   //
   node0->GetModuleDescription().GetProcessInformation()->Initialize();
   node0->SetStatus(vtkMRMLCommandLineModuleNode::Running, false);
   this->GetApplicationLogic()->RequestModified( node0 );
-  if (commandType == CommandLineModule)
+  if (resultCacheHit)
+    {
+    // vtkSlicerApplication::GetInstance()->InformationMessage
+    qDebug() << node0->GetModuleDescription().GetTitle().c_str()
+             << "results found in the result cache";
+    }
+  else if (remoteRun && !backend->SendInputFiles(backendInputFiles))
+    {
+    vtkErrorMacro( << node0->GetModuleDescription().GetTitle()
+                   << " inputs could not be sent to the execution backend" );
+    node0->SetStatus(vtkMRMLCommandLineModuleNode::CompletedWithErrors, false);
+    this->GetApplicationLogic()->RequestModified( node0 );
+    backend->RemoveFiles(backendFiles);
+    }
+  else if (commandType == CommandLineModule)
     {
     // Run as a command line module
     //
@@ -1428,39 +3097,135 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
     // statically linked to the executable.
     // Historically, there was an nvidia driver bug that causes the module
     // to fail on exit with undefined symbol.
-     std::string saveITKAutoLoadPath;
-     itksys::SystemTools::GetEnv("ITK_AUTOLOAD_PATH", saveITKAutoLoadPath);
-     std::string emptyString("ITK_AUTOLOAD_PATH=");
-     int putSuccess =
-       itksys::SystemTools::PutEnv(const_cast <char *> (emptyString.c_str()));
-     if (!putSuccess)
-       {
-       vtkErrorMacro( "Unable to reset ITK_AUTOLOAD_PATH.");
-       }
-    //
-    // now run the process
-    //
-    itksysProcess *process = itksysProcess_New();
-    
-    // setup the command
-    itksysProcess_SetCommand(process, command);
-    itksysProcess_SetOption(process,
-                            itksysProcess_Option_Detach, 0);
-    itksysProcess_SetOption(process,
-                            itksysProcess_Option_HideWindow, 1);
-    // itksysProcess_SetTimeout(process, 5.0); // 5 seconds
-    
-    // execute the command
-    itksysProcess_Execute(process);
-
-    // restore the load path
-    std::string putEnvString = ("ITK_AUTOLOAD_PATH=");
-    putEnvString = putEnvString + saveITKAutoLoadPath;
-    putSuccess =
-      itksys::SystemTools::PutEnv(const_cast <char *> (putEnvString.c_str()));
-    if (!putSuccess)
+    // The environment is shared with the modules launched concurrently by
+    // the other processing threads, it is modified under a lock.
+    // With UseWorkerProcesses, the run is dispatched to an idle worker
+    // process of the module started with the same environment, if any.
+    std::vector<std::string> workerCommand(commandLineAsString.begin(),
+      commandLineAsString.begin() + commandPrefixSize);
+    std::vector<std::string> workerArguments(
+      commandLineAsString.begin() + commandPrefixSize, commandLineAsString.end());
+    std::ostringstream workerKeyStream;
+    for (std::vector<std::string>::const_iterator wit = workerCommand.begin();
+         wit != workerCommand.end(); ++wit)
+      {
+      workerKeyStream << *wit << "\n";
+      }
+    workerKeyStream
+      << vtkInternal::GetNumberOfThreads(node0, this->GetApplicationLogic());
+    const std::string workerKey = workerKeyStream.str();
+    bool useWorker = this->Internal->UseWorkerProcesses && !remoteRun &&
+      CLIWorkerProcess::CanSend(workerArguments) &&
+      this->Internal->IsServerCommand(workerKey);
+    CLIWorkerProcess* worker = 0;
+    if (useWorker)
       {
-      vtkErrorMacro( "Unable to restore ITK_AUTOLOAD_PATH. ");
+      worker = this->Internal->TakeIdleWorkerProcess(workerKey);
+      if (worker && !worker->Send(workerArguments))
+        {
+        delete worker;
+        worker = 0;
+        }
+      }
+    itksysProcess *process = worker ? worker->Process : 0;
+    if (!worker)
+      {
+      ProcessLaunchLock.Lock();
+      std::string saveITKAutoLoadPath;
+      itksys::SystemTools::GetEnv("ITK_AUTOLOAD_PATH", saveITKAutoLoadPath);
+      std::string emptyString("ITK_AUTOLOAD_PATH=");
+      int putSuccess =
+        itksys::SystemTools::PutEnv(const_cast <char *> (emptyString.c_str()));
+      if (!putSuccess)
+        {
+        vtkErrorMacro( "Unable to reset ITK_AUTOLOAD_PATH.");
+        }
+      // Restrict the ITK filters of the module to its share of the cores.
+      std::string saveITKNumberOfThreads;
+      bool hasITKNumberOfThreads = itksys::SystemTools::GetEnv(
+        "ITK_GLOBAL_DEFAULT_NUMBER_OF_THREADS", saveITKNumberOfThreads);
+      std::ostringstream numberOfThreadsString;
+      numberOfThreadsString << "ITK_GLOBAL_DEFAULT_NUMBER_OF_THREADS="
+        << vtkInternal::GetNumberOfThreads(node0, this->GetApplicationLogic());
+      std::string numberOfThreadsEnvString = numberOfThreadsString.str();
+      putSuccess = itksys::SystemTools::PutEnv(
+        const_cast <char *> (numberOfThreadsEnvString.c_str()));
+      if (!putSuccess)
+        {
+        vtkErrorMacro( "Unable to set ITK_GLOBAL_DEFAULT_NUMBER_OF_THREADS.");
+        }
+      if (useWorker)
+        {
+        worker = new CLIWorkerProcess;
+        if (!worker->Start(workerCommand) || !worker->Send(workerArguments))
+          {
+          vtkWarningMacro( << node0->GetModuleDescription().GetTitle()
+                          << " can't be run in a worker process" );
+          this->Internal->SetNonServerCommand(workerKey);
+          delete worker;
+          worker = 0;
+          }
+        else
+          {
+          process = worker->Process;
+          }
+        }
+      //
+      // now run the process
+      //
+      if (!worker)
+        {
+        process = itksysProcess_New();
+
+        // setup the command
+        std::vector<std::string> backendCommandLine;
+        std::vector<const char*> backendCommand;
+        if (remoteRun)
+          {
+          backendCommandLine =
+            backend->GetCommandLine(commandLineAsString, backendFiles);
+          for (std::vector<std::string>::size_type i = 0;
+               i < backendCommandLine.size(); ++i)
+            {
+            backendCommand.push_back(backendCommandLine[i].c_str());
+            }
+          backendCommand.push_back(0);
+          itksysProcess_SetCommand(process, &backendCommand[0]);
+          }
+        else
+          {
+          itksysProcess_SetCommand(process, command);
+          }
+        itksysProcess_SetOption(process,
+                                itksysProcess_Option_Detach, 0);
+        itksysProcess_SetOption(process,
+                                itksysProcess_Option_HideWindow, 1);
+        // itksysProcess_SetTimeout(process, 5.0); // 5 seconds
+
+        // execute the command
+        itksysProcess_Execute(process);
+        }
+
+      // restore the load path
+      std::string putEnvString = ("ITK_AUTOLOAD_PATH=");
+      putEnvString = putEnvString + saveITKAutoLoadPath;
+      putSuccess =
+        itksys::SystemTools::PutEnv(const_cast <char *> (putEnvString.c_str()));
+      if (!putSuccess)
+        {
+        vtkErrorMacro( "Unable to restore ITK_AUTOLOAD_PATH. ");
+        }
+      std::string restoreNumberOfThreadsString =
+        "ITK_GLOBAL_DEFAULT_NUMBER_OF_THREADS=" + saveITKNumberOfThreads;
+      putSuccess = hasITKNumberOfThreads ?
+        itksys::SystemTools::PutEnv(
+          const_cast <char *> (restoreNumberOfThreadsString.c_str())) :
+        itksys::SystemTools::UnPutEnv("ITK_GLOBAL_DEFAULT_NUMBER_OF_THREADS");
+      if (!putSuccess)
+        {
+        vtkErrorMacro( "Unable to restore ITK_GLOBAL_DEFAULT_NUMBER_OF_THREADS. ");
+        }
+      ProcessLaunchLock.Unlock();
       }
 
     // Wait for the command to finish
@@ -1473,6 +3238,13 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
     std::string stderrbuffer;
     std::string::size_type tagend;
     std::string::size_type tagstart;
+    bool workerReturned = false;
+    int workerReturnValue = 0;
+    // most recent intermediate result of each output node not loaded yet
+    std::map<std::string, std::string> intermediateResults;
+    std::map<std::string, std::string>::iterator intermediateIt;
+    std::string::size_type intermediateSearchStart = 0;
+    double lastIntermediateResultTime = 0.;
     while ((pipe = itksysProcess_WaitForData(process ,&tbuffer,
                                              &length, &timeout)) != 0)
       {
@@ -1561,14 +3333,110 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
             {
             this->GetApplicationLogic()->RequestModified( node0 );
             }
+
+          // search for the intermediate results published since the last
+          // time, a result replaces the one of the same output not loaded yet
+          while ((tagstart = stdoutbuffer.find("<filter-intermediate-result>",
+                                               intermediateSearchStart))
+                 != std::string::npos &&
+                 (tagend = stdoutbuffer.find("</filter-intermediate-result>",
+                                             tagstart)) != std::string::npos)
+            {
+            intermediateSearchStart = tagend + 29;
+            std::string output;
+            std::string file;
+            if (!vtkInternal::ParseIntermediateResult(
+                  stdoutbuffer.substr(tagstart + 28, tagend - tagstart - 28),
+                  output, file))
+              {
+              continue;
+              }
+            std::string outputNodeID;
+            for (id2fn0 = nodesToReload.begin();
+                 id2fn0 != nodesToReload.end(); ++id2fn0)
+              {
+              if ((*id2fn0).second == output)
+                {
+                outputNodeID = (*id2fn0).first;
+                break;
+                }
+              }
+            if (outputNodeID.empty() ||
+                this->Internal->IntermediateResultInterval < 0.)
+              {
+              if (this->GetDeleteTemporaryFiles())
+                {
+                itksys::SystemTools::RemoveFile(file.c_str());
+                }
+              continue;
+              }
+            std::string& pendingFile = intermediateResults[outputNodeID];
+            if (!pendingFile.empty() && this->GetDeleteTemporaryFiles())
+              {
+              itksys::SystemTools::RemoveFile(pendingFile.c_str());
+              }
+            pendingFile = file;
+            }
           }
         else if (pipe == itksysProcess_Pipe_STDERR)
           {
           stderrbuffer = stderrbuffer.append(tbuffer, length);
           }
         }
+
+      // Load the intermediate results in the main thread. They are not the
+      // last requests of the node: the outputs are still reloaded when the
+      // module completes.
+      if (!intermediateResults.empty() &&
+          itksys::SystemTools::GetTime() - lastIntermediateResultTime >=
+            this->Internal->IntermediateResultInterval)
+        {
+        bool displayData = this->IsCommandLineModuleNodeUpdatingDisplay(node0);
+        for (intermediateIt = intermediateResults.begin();
+             intermediateIt != intermediateResults.end(); ++intermediateIt)
+          {
+          this->GetApplicationLogic()->RequestReadData(
+            intermediateIt->first.c_str(), intermediateIt->second.c_str(),
+            displayData, this->GetDeleteTemporaryFiles());
+          }
+        intermediateResults.clear();
+        lastIntermediateResultTime = itksys::SystemTools::GetTime();
+        }
+
+      // A worker process stays alive and reports the end of the run
+      tagend = worker ? stdoutbuffer.rfind("</server-return>") : std::string::npos;
+      if (tagend != std::string::npos)
+        {
+        tagstart = stdoutbuffer.rfind("<server-return>", tagend);
+        if (tagstart != std::string::npos)
+          {
+          workerReturnValue = atoi(stdoutbuffer.c_str() + tagstart + 15);
+          workerReturned = true;
+          // the module has flushed its standard error before returning
+          double drainTimeout = 0.;
+          while ((pipe = itksysProcess_WaitForData(process, &tbuffer,
+                                                   &length, &drainTimeout))
+                 == itksysProcess_Pipe_STDERR)
+            {
+            stderrbuffer = stderrbuffer.append(tbuffer, length);
+            }
+          break;
+          }
+        }
+      }
+    if (!workerReturned)
+      {
+      itksysProcess_WaitForExit(process, 0);
+      }
+    // the outputs replace the intermediate results not loaded yet
+    for (intermediateIt = intermediateResults.begin();
+         intermediateIt != intermediateResults.end(); ++intermediateIt)
+      {
+      if (this->GetDeleteTemporaryFiles())
+        {
+        itksys::SystemTools::RemoveFile(intermediateIt->second.c_str());
+        }
       }
-    itksysProcess_WaitForExit(process, 0);
 
 
     // remove the embedded XML from the stdout stream
@@ -1605,6 +3473,13 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
                          filterCommentRegExp.end()
                          - filterCommentRegExp.start());
       }
+    itksys::RegularExpression filterIntermediateResultRegExp("<filter-intermediate-result><output>[^<]*</output><file>[^<]*</file></filter-intermediate-result>[ \t\n\r]*");
+    while (filterIntermediateResultRegExp.find(stdoutbuffer))
+      {
+      stdoutbuffer.erase(filterIntermediateResultRegExp.start(),
+                         filterIntermediateResultRegExp.end()
+                         - filterIntermediateResultRegExp.start());
+      }
     itksys::RegularExpression filterTimeRegExp("<filter-time>[^<]*</filter-time>[ \t\n\r]*");
     while (filterTimeRegExp.find(stdoutbuffer))
       {
@@ -1626,6 +3501,13 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
                          filterEndRegExp.end()
                          - filterEndRegExp.start());
       }
+    itksys::RegularExpression serverReturnRegExp("[ \t\n\r]*<server-return>[^<]*</server-return>[ \t\n\r]*");
+    while (serverReturnRegExp.find(stdoutbuffer))
+      {
+      stdoutbuffer.erase(serverReturnRegExp.start(),
+                         serverReturnRegExp.end()
+                         - serverReturnRegExp.start());
+      }
     
     
     if (stdoutbuffer.size() > 0)
@@ -1648,6 +3530,24 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
       node0->SetStatus(vtkMRMLCommandLineModuleNode::Cancelled, false);
       this->GetApplicationLogic()->RequestModified(node0);
       }
+    else if (workerReturned)
+      {
+      std::stringstream information;
+      information << node0->GetModuleDescription().GetTitle();
+      if (workerReturnValue == 0)
+        {
+        information << " completed without errors" << std::endl;
+        // vtkSlicerApplication::GetInstance()->InformationMessage
+        qDebug() << information.str().c_str();
+        }
+      else
+        {
+        information << " completed with errors" << std::endl;
+        vtkErrorMacro( << information.str().c_str() );
+        node0->SetStatus(vtkMRMLCommandLineModuleNode::CompletedWithErrors, false);
+        this->GetApplicationLogic()->RequestModified( node0 );
+        }
+      }
     else
       {
       int result = itksysProcess_GetState(process);
@@ -1727,8 +3627,35 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
         node0->SetStatus(vtkMRMLCommandLineModuleNode::CompletedWithErrors, false);
         this->GetApplicationLogic()->RequestModified( node0 );
         }
+      }
+
+    // bring back the outputs of a remote run
+    if (remoteRun &&
+        node0->GetStatus() == vtkMRMLCommandLineModuleNode::Running &&
+        !backend->RetrieveOutputFiles(backendOutputFiles))
+      {
+      vtkErrorMacro( << node0->GetModuleDescription().GetTitle()
+                     << " outputs could not be retrieved from the execution backend" );
+      node0->SetStatus(vtkMRMLCommandLineModuleNode::CompletedWithErrors, false);
+      this->GetApplicationLogic()->RequestModified( node0 );
+      }
 
-      // clean up
+    // clean up
+    if (remoteRun)
+      {
+      backend->RemoveFiles(backendFiles);
+      }
+    if (worker && workerReturned)
+      {
+      this->Internal->ReleaseWorkerProcess(workerKey, worker);
+      }
+    else if (worker)
+      {
+      // the worker was killed or exited
+      delete worker;
+      }
+    else
+      {
       itksysProcess_Delete(process);
       }
     }
@@ -1738,6 +3665,14 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
     //
     //
     
+    // The standard streams are shared with the modules run concurrently by
+    // the other processing threads: only one module can redirect them at a
+    // time.
+    const bool redirectStreams = this->Internal->RedirectModuleStreams != 0;
+    if (redirectStreams)
+      {
+      StreamsRedirectionLock.Lock();
+      }
     std::ostringstream coutstringstream;
     std::ostringstream cerrstringstream;
     std::streambuf* origcoutrdbuf = std::cout.rdbuf();
@@ -1745,7 +3680,7 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
     int returnValue = 0;
     try
       {
-      if (this->Internal->RedirectModuleStreams)
+      if (redirectStreams)
         {
         // redirect the streams
         std::cout.rdbuf( coutstringstream.rdbuf() );
@@ -1774,7 +3709,7 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
         vtkErrorMacro( << (tmp + cerrstringstream.str()).c_str() );
         }
 
-      if (this->Internal->RedirectModuleStreams)
+      if (redirectStreams)
         {
         // reset the streams
         std::cout.rdbuf( origcoutrdbuf );
@@ -1832,6 +3767,10 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
       std::cout.rdbuf( origcoutrdbuf );
       std::cerr.rdbuf( origcerrrdbuf );
       }
+    if (redirectStreams)
+      {
+      StreamsRedirectionLock.Unlock();
+      }
     }
   else if ( commandType == PythonModule )
     {
@@ -1931,6 +3870,14 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
   //
   if (node0->GetStatus() == vtkMRMLCommandLineModuleNode::Completing)
     {
+    if (!resultCacheKey.empty() && !resultCacheHit &&
+        !this->Internal->StoreResults(resultCacheKey, cachedOutputs))
+      {
+      vtkWarningMacro( << "Unable to store the results of "
+                       << node0->GetModuleDescription().GetTitle()
+                       << " in the result cache" );
+      }
+
     // reload nodes
     for (id2fn0 = nodesToReload.begin(); id2fn0 != nodesToReload.end(); ++id2fn0)
       {
@@ -2074,7 +4021,14 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
     std::set<std::string>::iterator fit;
     for (fit = filesToDelete.begin(); fit != filesToDelete.end(); ++fit)
       {
-      if (itksys::SystemTools::FileExists((*fit).c_str()))
+      if (vtkMRMLSharedMemoryImage::IsSharedMemoryFileName((*fit).c_str()))
+        {
+        if (!vtkMRMLSharedMemoryImage::Remove((*fit).c_str()))
+          {
+          vtkWarningMacro( << "Unable to remove shared memory " << *fit );
+          }
+        }
+      else if (itksys::SystemTools::FileExists((*fit).c_str()))
         {
         removed = itksys::SystemTools::RemoveFile((*fit).c_str());
         if (!removed)
@@ -2246,22 +4200,48 @@ void vtkSlicerCLIModuleLogic::ProcessMRMLLogicsEvents(vtkObject* caller,
       event == vtkSlicerApplicationLogic::RequestProcessedEvent)
     {
     unsigned long uid = reinterpret_cast<unsigned long>(callData);
+    vtkMRMLCommandLineModuleNode* node = 0;
+    bool noMoreRequests = false;
+    this->Internal->LastRequestsLock.Lock();
     vtkInternal::RequestType::iterator it =
       std::find_if(this->Internal->LastRequests.begin(),
       this->Internal->LastRequests.end(), vtkInternal::FindRequest(uid));
     if (it != this->Internal->LastRequests.end())
       {
-      vtkMRMLCommandLineModuleNode* node = it->second;
+      node = it->second;
+      this->Internal->LastRequests.erase(it);
+      noMoreRequests = this->Internal->LastRequests.empty();
+      }
+    this->Internal->LastRequestsLock.Unlock();
+    if (node)
+      {
       // If the status is not Completing, then there should be no request made
       // on the application logic.
       assert(node->GetStatus() == vtkMRMLCommandLineModuleNode::Completing);
       node->SetStatus(vtkMRMLCommandLineModuleNode::Completed);
-      this->Internal->LastRequests.erase(it);
-      // we are not interested in any request anymore because the cli node is
-      // Completed.
-      vtkEventBroker::GetInstance()->RemoveObservations(
-        this->GetApplicationLogic(), vtkSlicerApplicationLogic::RequestProcessedEvent,
-        this, this->GetMRMLLogicsCallbackCommand());
+      // we are not interested in any request anymore if all the cli nodes
+      // are Completed.
+      if (noMoreRequests && this->GetMRMLScene())
+        {
+        std::vector<vtkMRMLNode*> cliNodes;
+        this->GetMRMLScene()->GetNodesByClass(
+          "vtkMRMLCommandLineModuleNode", cliNodes);
+        for (std::vector<vtkMRMLNode*>::iterator cliIt = cliNodes.begin();
+             noMoreRequests && cliIt != cliNodes.end(); ++cliIt)
+          {
+          vtkMRMLCommandLineModuleNode* cliNode =
+            vtkMRMLCommandLineModuleNode::SafeDownCast(*cliIt);
+          noMoreRequests = !cliNode->IsBusy() ||
+            cliNode->GetModuleTitle() !=
+              this->Internal->DefaultModuleDescription.GetTitle();
+          }
+        }
+      if (noMoreRequests)
+        {
+        vtkEventBroker::GetInstance()->RemoveObservations(
+          this->GetApplicationLogic(), vtkSlicerApplicationLogic::RequestProcessedEvent,
+          this, this->GetMRMLLogicsCallbackCommand());
+        }
       }
     }
 }
@@ -2283,7 +4263,26 @@ void vtkSlicerCLIModuleLogic
     switch(event)
       {
       case vtkCommand::ModifiedEvent:
+        {
+        vtkInternal::ScheduledTaskMap::iterator it =
+          this->Internal->ScheduledTasks.find(cliNode);
+        if (it == this->Internal->ScheduledTasks.end())
+          {
+          break;
+          }
+        // A CLI cancelled before being started doesn't need to wait for the
+        // processing resources of the application logic.
+        if (cliNode->GetStatus() == vtkMRMLCommandLineModuleNode::Cancelling)
+          {
+          this->GetApplicationLogic()->CancelTask(it->second);
+          this->Internal->ScheduledTasks.erase(it);
+          }
+        else if (cliNode->GetStatus() != vtkMRMLCommandLineModuleNode::Scheduled)
+          {
+          this->Internal->ScheduledTasks.erase(it);
+          }
         break;
+        }
       case vtkMRMLCommandLineModuleNode::AutoRunEvent:
         {
         unsigned long requestTime = reinterpret_cast<unsigned long>(callData);
@@ -2327,6 +4326,12 @@ void vtkSlicerCLIModuleLogic
         break;
       }
     }
+  // Batch items and pipeline nodes can be run by any CLI logic.
+  if (cliNode && event == vtkCommand::ModifiedEvent && !cliNode->IsBusy())
+    {
+    this->OnBatchItemDone(cliNode);
+    this->OnPipelineNodeDone(cliNode);
+    }
   this->Superclass::ProcessMRMLNodesEvents(caller, event, callData);
 }
 
@@ -21,11 +21,19 @@
 class ModuleDescription;
 class ModuleParameter;
 
+// SlicerQTCLI includes
+class vtkSlicerCLIExecutionBackend;
+
 // MRML include
 #include "vtkMRMLScene.h"
 
+// VTK includes
+class vtkCollection;
+
 // STL includes
+#include <map>
 #include <string>
+#include <vector>
 
 #include "qSlicerBaseQTCLIExport.h"
 
@@ -45,6 +53,19 @@ public:
   vtkTypeMacro(vtkSlicerCLIModuleLogic,vtkSlicerModuleLogic);
   void PrintSelf(ostream& os, vtkIndent indent);
 
+  enum Events
+    {
+    /// Event fired when an item of a batch is done (completed, completed
+    /// with errors or cancelled). The CLI node of the item is passed as
+    /// callData, it is removed from the scene right after.
+    /// \sa ApplyBatch()
+    BatchItemCompletedEvent = vtkCommand::UserEvent + 1,
+    /// Event fired when all the nodes of a pipeline are done or skipped.
+    /// The first CLI node of the pipeline is passed as callData.
+    /// \sa ApplyPipeline()
+    PipelineCompletedEvent
+    };
+
   /// The default module description is used when creating new nodes.
   /// \sa CreateNode()
   void SetDefaultModuleDescription(const ModuleDescription& moduleDescription);
@@ -80,6 +101,83 @@ public:
   void SetRedirectModuleStreams(int value);
   int GetRedirectModuleStreams() const;
 
+  /// Pass the scalar, label and vector volumes of executable modules
+  /// through named shared memory ("slicershm:" file names read and written
+  /// by itkSharedMemoryImageIO.h) instead of temporary nrrd files.
+  /// Large volumes are then not written and read on disk. Only the
+  /// parameters that don't request specific file extensions are concerned.
+  /// On Windows, a segment doesn't outlive the process that created it so
+  /// only input volumes are passed through shared memory.
+  /// Off by default: the module must read its images with ITK through
+  /// itk::GetImageType() (itkPluginUtilities.h).
+  /// \sa vtkMRMLSharedMemoryImage
+  virtual void UseSharedMemoryOn();
+  virtual void UseSharedMemoryOff();
+  void SetUseSharedMemory(int value);
+  int GetUseSharedMemory() const;
+
+  /// Keep the executable modules alive between runs: a run is dispatched
+  /// to an idle worker process of the module started in server mode
+  /// (--server flag of SEMCommandLineLibraryWrapper.cxx.in), which saves
+  /// the process startup, the ITK factory registration and the loading of
+  /// the plugin libraries. A new worker is started when none is idle. The
+  /// modules that fail to start in server mode are run as usual.
+  /// Off by default: a worker doesn't reset the global state of the module
+  /// between runs.
+  /// \sa TerminateWorkerProcesses()
+  virtual void UseWorkerProcessesOn();
+  virtual void UseWorkerProcessesOff();
+  void SetUseWorkerProcesses(int value);
+  int GetUseWorkerProcesses() const;
+
+  /// Terminate the idle worker processes. The running ones are terminated
+  /// when their run is done if UseWorkerProcesses is off.
+  void TerminateWorkerProcesses();
+
+  /// Reuse the outputs of a previous run of an executable module with the
+  /// same parameters and the same input data instead of running it again.
+  /// Inputs are identified by a digest of their content, so a reloaded scene
+  /// or an undone change still hits the cache. The outputs are stored in
+  /// ResultCacheDirectory after each successful run.
+  /// Runs that write files outside the scene or exchange nodes through a
+  /// mini-scene or shared memory outputs are not cached.
+  /// Off by default.
+  /// \sa SetResultCacheDirectory(), SetResultCacheLimit(), ClearResultCache()
+  virtual void UseResultCacheOn();
+  virtual void UseResultCacheOff();
+  void SetUseResultCache(int value);
+  int GetUseResultCache() const;
+
+  /// Directory of the result cache, <temporary directory>/CLIResultCache
+  /// by default.
+  void SetResultCacheDirectory(const char* directory);
+  std::string GetResultCacheDirectory() const;
+
+  /// Size limit in MB of the result cache, the least recently used results
+  /// are removed first. 0 for no limit. 1000 by default.
+  void SetResultCacheLimit(int megabytes);
+  int GetResultCacheLimit() const;
+
+  /// Remove all the results from the result cache.
+  void ClearResultCache();
+
+  /// Minimum time in seconds between two loads of the intermediate results
+  /// an executable module publishes while it runs (see
+  /// itk::PublishIntermediateResult() in itkPluginUtilities.h). Only the most
+  /// recent result of each output is loaded, the others are discarded.
+  /// 0 loads every result, a negative value discards all of them.
+  /// 2 seconds by default.
+  void SetIntermediateResultInterval(double seconds);
+  double GetIntermediateResultInterval() const;
+
+  /// Backend that runs the executable modules, they run on this computer
+  /// by default. Setting a null backend restores the default one.
+  /// Shared memory and worker processes are used only with a local
+  /// backend.
+  /// \sa vtkSlicerCLIRemoteExecutionBackend
+  void SetExecutionBackend(vtkSlicerCLIExecutionBackend* backend);
+  vtkSlicerCLIExecutionBackend* GetExecutionBackend() const;
+
   /// Schedules the command line module to run.
   /// The CLI is scheduled to be run in a separate thread. This methods
   /// is non blocking and returns immediately.
@@ -96,6 +194,63 @@ public:
   /// in the node selectors.
   void ApplyAndWait ( vtkMRMLCommandLineModuleNode* node, bool updateDisplay = true);
 
+  /// Parameter values of a batch item, indexed by parameter name.
+  typedef std::map<std::string, std::string> BatchItemType;
+
+  /// Schedules the CLI of \a node to run once for each item of \a items.
+  /// Each item is run with a hidden copy of \a node added to the scene,
+  /// whose parameters are overridden with the values of the item. The image,
+  /// geometry, transform, table and measurement parameters can be given a
+  /// file name instead of a node ID: the CLI then reads or writes the file
+  /// directly and outputs are not loaded into the scene.
+  /// The input nodes that are the same for all the items of an executable
+  /// CLI are written only once for the whole batch. The items are run
+  /// concurrently by the processing threads of the application logic
+  /// with the thread, memory and priority settings of \a node.
+  /// BatchItemCompletedEvent is fired when an item is done, its CLI node is
+  /// then removed from the scene.
+  /// The CLI nodes of the scheduled items are added to \a itemNodes if not
+  /// null. Return the number of scheduled items.
+  /// \sa Apply(), vtkSlicerApplicationLogic::SetNumberOfProcessingThreads()
+  int ApplyBatch(vtkMRMLCommandLineModuleNode* node,
+                 const std::vector<BatchItemType>& items,
+                 vtkCollection* itemNodes = 0);
+
+  /// Connect the output parameter \a outputName of \a node to the input
+  /// parameter \a nextInputName of \a nextNode. In a pipeline, \a nextNode
+  /// is applied by \a nextLogic, the logic of its module (this logic if
+  /// null), once \a node is completed. An input can be connected to a single
+  /// output, an output to several inputs. Both parameters must have the same
+  /// tag and the nodes must be in the scene of the logics.
+  /// Return false if the parameters can't be connected or if the connection
+  /// would make a cycle.
+  /// \sa DisconnectPipeline(), ApplyPipeline()
+  bool ConnectPipeline(vtkMRMLCommandLineModuleNode* node,
+                       const char* outputName,
+                       vtkSlicerCLIModuleLogic* nextLogic,
+                       vtkMRMLCommandLineModuleNode* nextNode,
+                       const char* nextInputName);
+  /// Remove the connections from and to \a node.
+  void DisconnectPipeline(vtkMRMLCommandLineModuleNode* node);
+
+  /// Schedules \a node to run and then, in order, the nodes connected to it
+  /// directly or not. A node is applied once all the nodes of the pipeline
+  /// connected to it are completed. It is skipped, as well as the nodes
+  /// after it, if one of them completes with errors or is cancelled.
+  /// The connected output parameters that are not set are intermediate
+  /// results that are not added to the scene: a volume output of a shared
+  /// object module read only by shared object modules is passed in memory
+  /// through a hidden node, the other ones through a temporary file. An
+  /// intermediate result is removed as soon as all the nodes reading it are
+  /// done. The parameters of the nodes are restored when the pipeline is
+  /// done and PipelineCompletedEvent is fired.
+  /// Only the nodes without connected outputs update the display.
+  /// Return false if a node of the pipeline is already in a running
+  /// pipeline or if \a node could not be scheduled.
+  /// \sa ConnectPipeline(), Apply()
+  bool ApplyPipeline(vtkMRMLCommandLineModuleNode* node,
+                     bool updateDisplay = true);
+
   /// Set/Get the directory to use for temporary files
   void SetTemporaryDirectory(const char *tempdir);
 
@@ -119,7 +274,9 @@ protected:
                                          const std::string& type,
                                          const std::string& name,
                                      const std::vector<std::string>& extensions,
-                                     CommandLineModuleType commandType);
+                                     CommandLineModuleType commandType,
+                                     const std::string& channel = std::string(),
+                                     const std::string& executionID = std::string());
   std::string ConstructTemporarySceneFileName(vtkMRMLScene *scene);
   std::string FindHiddenNodeID(const ModuleDescription& d,
                                const ModuleParameter& p);
@@ -138,6 +295,26 @@ protected:
   /// Call apply because the node requests it.
   void AutoRun(vtkMRMLCommandLineModuleNode* cliNode);
 
+  /// Fire BatchItemCompletedEvent for \a itemNode, remove it from the scene
+  /// and remove the shared files of its batch if it was the last item.
+  void OnBatchItemDone(vtkMRMLCommandLineModuleNode* itemNode);
+  /// Remove the files shared by the items of the batch \a batchID.
+  void RemoveBatch(int batchID);
+
+  /// Apply the nodes of the pipeline waiting for \a node if it is
+  /// completed, skip them otherwise.
+  void OnPipelineNodeDone(vtkMRMLCommandLineModuleNode* node);
+  void ApplyPipelineNode(int pipelineID, vtkMRMLCommandLineModuleNode* node);
+  void FinishPipelineNode(int pipelineID, vtkMRMLCommandLineModuleNode* node,
+                          bool completed);
+  void SkipPipelineNode(int pipelineID, vtkMRMLCommandLineModuleNode* node);
+  /// Remove the intermediate results of the pipeline \a pipelineID that are
+  /// not read by any node anymore (all of them if \a all is true).
+  void RemovePipelineIntermediates(int pipelineID, bool all = false);
+  /// Restore the parameters of the nodes of the pipeline \a pipelineID and
+  /// fire PipelineCompletedEvent.
+  void RemovePipeline(int pipelineID);
+
 private:
   vtkSlicerCLIModuleLogic();
   virtual ~vtkSlicerCLIModuleLogic();
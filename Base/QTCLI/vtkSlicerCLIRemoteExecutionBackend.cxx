@@ -0,0 +1,272 @@
+/*=auto=========================================================================
+
+ Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) 
+ All Rights Reserved.
+
+ See COPYRIGHT.txt
+ or http://www.slicer.org/copyright/copyright.txt for details.
+
+ Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// SlicerQTCLI includes
+#include "vtkSlicerCLIRemoteExecutionBackend.h"
+
+// VTK includes
+#include <vtkObjectFactory.h>
+
+// ITKSys includes
+#include <itksys/Process.h>
+#include <itksys/SystemTools.hxx>
+
+// STD includes
+#include <cstring>
+#include <sstream>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+/// Quote \a argument for a POSIX shell.
+std::string QuoteForShell(const std::string& argument)
+{
+  std::string quoted("'");
+  for (std::string::size_type i = 0; i < argument.size(); ++i)
+    {
+    if (argument[i] == '\'')
+      {
+      quoted += "'\\''";
+      }
+    else
+      {
+      quoted += argument[i];
+      }
+    }
+  return quoted + "'";
+}
+
+}
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkSlicerCLIRemoteExecutionBackend);
+
+//----------------------------------------------------------------------------
+vtkSlicerCLIRemoteExecutionBackend::vtkSlicerCLIRemoteExecutionBackend()
+{
+  this->Host = 0;
+  this->RemoteTemporaryDirectory = 0;
+  this->RemoteModulesDirectory = 0;
+  this->JobCommand = 0;
+  this->SSHCommand = 0;
+  this->CopyCommand = 0;
+  this->Compression = 1;
+  this->SetRemoteTemporaryDirectory("/tmp");
+  this->SetSSHCommand("ssh");
+  this->SetCopyCommand("scp");
+}
+
+//----------------------------------------------------------------------------
+vtkSlicerCLIRemoteExecutionBackend::~vtkSlicerCLIRemoteExecutionBackend()
+{
+  this->SetHost(0);
+  this->SetRemoteTemporaryDirectory(0);
+  this->SetRemoteModulesDirectory(0);
+  this->SetJobCommand(0);
+  this->SetSSHCommand(0);
+  this->SetCopyCommand(0);
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCLIRemoteExecutionBackend::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "Host: " << (this->Host ? this->Host : "(none)") << "\n";
+  os << indent << "RemoteTemporaryDirectory: "
+     << (this->RemoteTemporaryDirectory ? this->RemoteTemporaryDirectory : "(none)") << "\n";
+  os << indent << "RemoteModulesDirectory: "
+     << (this->RemoteModulesDirectory ? this->RemoteModulesDirectory : "(none)") << "\n";
+  os << indent << "JobCommand: " << (this->JobCommand ? this->JobCommand : "(none)") << "\n";
+  os << indent << "SSHCommand: " << (this->SSHCommand ? this->SSHCommand : "(none)") << "\n";
+  os << indent << "CopyCommand: " << (this->CopyCommand ? this->CopyCommand : "(none)") << "\n";
+  os << indent << "Compression: " << this->Compression << "\n";
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerCLIRemoteExecutionBackend::IsLocal()const
+{
+  return false;
+}
+
+//----------------------------------------------------------------------------
+std::string vtkSlicerCLIRemoteExecutionBackend
+::GetRemoteFileName(const std::string& fileName)const
+{
+  std::string directory(this->RemoteTemporaryDirectory ?
+                        this->RemoteTemporaryDirectory : "");
+  return directory + "/" + itksys::SystemTools::GetFilenameName(fileName);
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerCLIRemoteExecutionBackend
+::SendInputFiles(const std::vector<std::string>& files)const
+{
+  if (!this->Host || !this->RemoteTemporaryDirectory ||
+      !this->SSHCommand || !this->CopyCommand)
+    {
+    vtkErrorMacro("SendInputFiles: no remote host or no remote directory");
+    return false;
+    }
+  std::string directory = QuoteForShell(this->RemoteTemporaryDirectory);
+  if (!this->RunCommandLine(this->GetSSHCommandLine("mkdir -p " + directory)))
+    {
+    return false;
+    }
+  if (files.empty())
+    {
+    return true;
+    }
+  std::vector<std::string> copyCommandLine;
+  copyCommandLine.push_back(this->CopyCommand);
+  copyCommandLine.push_back("-q");
+  copyCommandLine.push_back("-B");
+  if (this->Compression)
+    {
+    copyCommandLine.push_back("-C");
+    }
+  copyCommandLine.insert(copyCommandLine.end(), files.begin(), files.end());
+  copyCommandLine.push_back(std::string(this->Host) + ":" + directory + "/");
+  return this->RunCommandLine(copyCommandLine);
+}
+
+//----------------------------------------------------------------------------
+std::vector<std::string> vtkSlicerCLIRemoteExecutionBackend
+::GetCommandLine(const std::vector<std::string>& commandLine,
+                 const std::vector<std::string>& files)const
+{
+  std::ostringstream command;
+  command << "cd " << QuoteForShell(this->RemoteTemporaryDirectory ?
+                                    this->RemoteTemporaryDirectory : ".")
+          << " &&";
+  if (this->JobCommand && strlen(this->JobCommand) > 0)
+    {
+    command << " " << this->JobCommand;
+    }
+  for (std::vector<std::string>::size_type i = 0; i < commandLine.size(); ++i)
+    {
+    std::string argument = commandLine[i];
+    if (i == 0 && this->RemoteModulesDirectory &&
+        strlen(this->RemoteModulesDirectory) > 0)
+      {
+      argument = std::string(this->RemoteModulesDirectory) + "/" +
+        itksys::SystemTools::GetFilenameName(argument);
+      }
+    for (std::vector<std::string>::const_iterator fit = files.begin();
+         fit != files.end(); ++fit)
+      {
+      itksys::SystemTools::ReplaceString(argument, fit->c_str(),
+                                         this->GetRemoteFileName(*fit).c_str());
+      }
+    command << " " << QuoteForShell(argument);
+    }
+  return this->GetSSHCommandLine(command.str());
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerCLIRemoteExecutionBackend
+::RetrieveOutputFiles(const std::vector<std::string>& files)const
+{
+  bool success = true;
+  for (std::vector<std::string>::const_iterator fit = files.begin();
+       fit != files.end(); ++fit)
+    {
+    std::vector<std::string> copyCommandLine;
+    copyCommandLine.push_back(this->CopyCommand ? this->CopyCommand : "scp");
+    copyCommandLine.push_back("-q");
+    copyCommandLine.push_back("-B");
+    if (this->Compression)
+      {
+      copyCommandLine.push_back("-C");
+      }
+    copyCommandLine.push_back(std::string(this->Host ? this->Host : "") + ":" +
+                              QuoteForShell(this->GetRemoteFileName(*fit)));
+    copyCommandLine.push_back(*fit);
+    success = this->RunCommandLine(copyCommandLine) && success;
+    }
+  return success;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCLIRemoteExecutionBackend
+::RemoveFiles(const std::vector<std::string>& files)const
+{
+  if (files.empty() || !this->Host)
+    {
+    return;
+    }
+  std::string command("rm -f");
+  for (std::vector<std::string>::const_iterator fit = files.begin();
+       fit != files.end(); ++fit)
+    {
+    command += " " + QuoteForShell(this->GetRemoteFileName(*fit));
+    }
+  this->RunCommandLine(this->GetSSHCommandLine(command));
+}
+
+//----------------------------------------------------------------------------
+std::vector<std::string> vtkSlicerCLIRemoteExecutionBackend
+::GetSSHCommandLine(const std::string& command)const
+{
+  std::vector<std::string> commandLine;
+  commandLine.push_back(this->SSHCommand ? this->SSHCommand : "ssh");
+  // never wait for a password
+  commandLine.push_back("-o");
+  commandLine.push_back("BatchMode=yes");
+  if (this->Compression)
+    {
+    commandLine.push_back("-C");
+    }
+  commandLine.push_back(this->Host ? this->Host : "");
+  commandLine.push_back(command);
+  return commandLine;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerCLIRemoteExecutionBackend
+::RunCommandLine(const std::vector<std::string>& commandLine)const
+{
+  std::vector<const char*> command;
+  for (std::vector<std::string>::const_iterator it = commandLine.begin();
+       it != commandLine.end(); ++it)
+    {
+    command.push_back(it->c_str());
+    }
+  command.push_back(0);
+
+  itksysProcess* process = itksysProcess_New();
+  itksysProcess_SetCommand(process, &command[0]);
+  itksysProcess_SetOption(process, itksysProcess_Option_HideWindow, 1);
+  itksysProcess_Execute(process);
+  std::string errors;
+  char* data = 0;
+  int length = 0;
+  int pipe;
+  while ((pipe = itksysProcess_WaitForData(process, &data, &length, 0)) != 0)
+    {
+    if (pipe == itksysProcess_Pipe_STDERR)
+      {
+      errors.append(data, length);
+      }
+    }
+  itksysProcess_WaitForExit(process, 0);
+  bool success = itksysProcess_GetState(process) == itksysProcess_State_Exited &&
+    itksysProcess_GetExitValue(process) == 0;
+  itksysProcess_Delete(process);
+  if (!success)
+    {
+    vtkErrorMacro(<< "RunCommandLine: " << commandLine[0] << " "
+                  << (commandLine.size() > 1 ? commandLine.back() : std::string())
+                  << " failed: " << errors);
+    }
+  return success;
+}
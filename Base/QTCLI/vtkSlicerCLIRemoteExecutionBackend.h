@@ -0,0 +1,106 @@
+/*=auto=========================================================================
+
+ Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) 
+ All Rights Reserved.
+
+ See COPYRIGHT.txt
+ or http://www.slicer.org/copyright/copyright.txt for details.
+
+ Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#ifndef __vtkSlicerCLIRemoteExecutionBackend_h
+#define __vtkSlicerCLIRemoteExecutionBackend_h
+
+// SlicerQTCLI includes
+#include "vtkSlicerCLIExecutionBackend.h"
+
+/// \brief Runs the executable command line modules on a remote host.
+///
+/// The files of a module are copied with scp into RemoteTemporaryDirectory
+/// on Host, the module is run with ssh and its output files are copied
+/// back. The standard output of the module is forwarded by ssh, so the
+/// progress is reported as for a local run. The transfers are compressed
+/// if Compression is on.
+/// The module is run with the same executable path unless
+/// RemoteModulesDirectory is set. With a job queue, JobCommand is the
+/// command that runs the module on a compute node and forwards its output
+/// (e.g. "srun --exclusive"). The remote command is run by the shell of the
+/// remote user.
+/// ssh must not ask for a password: a key or an agent must be set up.
+/// Cancelling a module kills the local ssh client; the remote module is
+/// stopped by the hangup only if its job command forwards it.
+class Q_SLICER_BASE_QTCLI_EXPORT vtkSlicerCLIRemoteExecutionBackend
+  : public vtkSlicerCLIExecutionBackend
+{
+public:
+  static vtkSlicerCLIRemoteExecutionBackend *New();
+  vtkTypeMacro(vtkSlicerCLIRemoteExecutionBackend, vtkSlicerCLIExecutionBackend);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  /// Remote host, "host" or "user@host".
+  vtkSetStringMacro(Host);
+  vtkGetStringMacro(Host);
+
+  /// Directory for the files of the modules on the remote host, it is
+  /// created if needed. "/tmp" by default.
+  vtkSetStringMacro(RemoteTemporaryDirectory);
+  vtkGetStringMacro(RemoteTemporaryDirectory);
+
+  /// Directory of the module executables on the remote host. If not set,
+  /// the local executable path is used.
+  vtkSetStringMacro(RemoteModulesDirectory);
+  vtkGetStringMacro(RemoteModulesDirectory);
+
+  /// Command prefixed to the module command line on the remote host, none
+  /// by default.
+  vtkSetStringMacro(JobCommand);
+  vtkGetStringMacro(JobCommand);
+
+  /// Executables of the ssh and scp clients, "ssh" and "scp" by default.
+  vtkSetStringMacro(SSHCommand);
+  vtkGetStringMacro(SSHCommand);
+  vtkSetStringMacro(CopyCommand);
+  vtkGetStringMacro(CopyCommand);
+
+  /// Compress the transfers, on by default.
+  vtkSetMacro(Compression, int);
+  vtkGetMacro(Compression, int);
+  vtkBooleanMacro(Compression, int);
+
+  virtual bool IsLocal()const;
+  virtual bool SendInputFiles(const std::vector<std::string>& files)const;
+  virtual std::vector<std::string> GetCommandLine(
+    const std::vector<std::string>& commandLine,
+    const std::vector<std::string>& files)const;
+  virtual bool RetrieveOutputFiles(const std::vector<std::string>& files)const;
+  virtual void RemoveFiles(const std::vector<std::string>& files)const;
+
+  /// Path of the local \a fileName on the remote host.
+  std::string GetRemoteFileName(const std::string& fileName)const;
+
+protected:
+  vtkSlicerCLIRemoteExecutionBackend();
+  virtual ~vtkSlicerCLIRemoteExecutionBackend();
+
+  /// Command line of the ssh client to run \a command on Host.
+  std::vector<std::string> GetSSHCommandLine(const std::string& command)const;
+  /// Run \a commandLine and wait for it. Return true if it exits without
+  /// errors.
+  bool RunCommandLine(const std::vector<std::string>& commandLine)const;
+
+  char* Host;
+  char* RemoteTemporaryDirectory;
+  char* RemoteModulesDirectory;
+  char* JobCommand;
+  char* SSHCommand;
+  char* CopyCommand;
+  int Compression;
+
+private:
+  vtkSlicerCLIRemoteExecutionBackend(const vtkSlicerCLIRemoteExecutionBackend&); // Not implemented
+  void operator=(const vtkSlicerCLIRemoteExecutionBackend&); // Not implemented
+};
+
+#endif
@@ -397,6 +397,7 @@ void qSlicerExtensionsManagerModelTester::testDefaults()
   QCOMPARE(model.extensionDescriptionFile(""), QString(""));
   QCOMPARE(model.newExtensionEnabledByDefault(), true);
   QCOMPARE(model.slicerVersion(), QString(Slicer_VERSION));
+  QCOMPARE(model.metadataCacheLifetime(), 300);
 
   ExtensionMetadataType metadata = model.extensionMetadata("");
   QCOMPARE(metadata.count(), 0);
@@ -850,6 +851,9 @@ void qSlicerExtensionsManagerModelTester::testUninstallExtension()
       QVERIFY(model.isExtensionInstalled(extensionName));
       }
 
+    // The parsed description files are cached in the extensions settings
+    QCOMPARE(QSettings().value("Extensions/DescriptionCache").toMap().count(), 2);
+
     foreach(const QString& extensionName, QStringList()
             << "LoadableExtensionTemplate"
             << "SuperBuildLoadableExtensionTemplate")
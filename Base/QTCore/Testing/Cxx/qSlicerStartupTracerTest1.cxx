@@ -0,0 +1,93 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Copyright (c) Kitware Inc.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  This file was originally developed by Jean-Christophe Fillion-Robin, Kitware Inc.
+  and was partially funded by NIH grant 3P41RR013218-12S1
+
+==============================================================================*/
+
+// Qt includes
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+// SlicerQt includes
+#include "qSlicerStartupTracer.h"
+
+// STD includes
+#include <cstdlib>
+#include <iostream>
+
+int qSlicerStartupTracerTest1(int, char * [] )
+{
+  qSlicerStartupTracer* tracer = qSlicerStartupTracer::instance();
+  if (!tracer || tracer != qSlicerStartupTracer::instance() || !tracer->isEnabled())
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with instance()" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Disabled tracer doesn't record
+  tracer->setEnabled(false);
+  tracer->beginEvent("Discarded");
+  tracer->endEvent();
+  tracer->setEnabled(true);
+
+  tracer->beginEvent("Startup");
+  {
+    qSlicerStartupTracer::Scope scope("Register \"modules\"", "modules");
+  }
+  // Left opened, closed by writeTrace()
+  tracer->beginEvent("Show main window", "ui");
+
+  QString traceFile =
+    QFileInfo(QDir::tempPath(), "qSlicerStartupTracerTest1.json").absoluteFilePath();
+  if (!tracer->writeTrace(traceFile) || tracer->isEnabled())
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with writeTrace()" << std::endl;
+    return EXIT_FAILURE;
+    }
+  // Nothing to write once disabled
+  if (tracer->writeTrace(traceFile))
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with writeTrace()" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  QFile file(traceFile);
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+    std::cerr << "Line " << __LINE__ << " - Failed to read " << qPrintable(traceFile) << std::endl;
+    return EXIT_FAILURE;
+    }
+  QString trace = file.readAll();
+  file.close();
+  QFile::remove(traceFile);
+
+  if (!trace.contains("\"traceEvents\"") ||
+      !trace.contains("\"name\": \"Startup\", \"cat\": \"startup\"") ||
+      !trace.contains("\"name\": \"Register \\\"modules\\\"\", \"cat\": \"modules\"") ||
+      !trace.contains("\"name\": \"Show main window\", \"cat\": \"ui\"") ||
+      trace.contains("Discarded") ||
+      trace.contains("\"dur\": -1") ||
+      trace.count("\"ph\": \"X\"") != 3)
+    {
+    std::cerr << "Line " << __LINE__ << " - Problem with the trace:\n"
+              << qPrintable(trace) << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
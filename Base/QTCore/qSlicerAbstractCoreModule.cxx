@@ -24,6 +24,7 @@
 // SlicerQt includes
 #include "qSlicerAbstractCoreModule.h"
 #include "qSlicerAbstractModuleRepresentation.h"
+#include "qSlicerStartupTracer.h"
 
 // SlicerLogic includes
 #include "vtkSlicerModuleLogic.h"
@@ -217,6 +218,7 @@ qSlicerAbstractModuleRepresentation* qSlicerAbstractCoreModule::widgetRepresenta
   // If required, create widgetRepresentation
   if (!d->WidgetRepresentation)
     {
+    qSlicerStartupTracer::Scope traceScope(this->name(), "widget");
     d->WidgetRepresentation = this->createWidgetRepresentation();
     if (d->WidgetRepresentation == 0)
       {
@@ -20,10 +20,13 @@
 
 // Qt includes
 #include <QDir>
+#include <QtConcurrentMap>
+#include <QTime>
 
 // SlicerQt includes
 #include "qSlicerAbstractModuleFactoryManager.h"
 #include "qSlicerAbstractCoreModule.h"
+#include "qSlicerStartupTracer.h"
 
 // STD includes
 #include <typeinfo>
@@ -45,6 +48,10 @@ public:
     qSlicerFileBasedModuleFactory;
   QVector<qSlicerFileBasedModuleFactory*> fileBasedFactories()const;
   QVector<qSlicerModuleFactory*> notFileBasedFactories()const;
+  /// Return the first of the \a factories that can read \a file, 0 if none.
+  /// Only reads the file attributes and can be called from any thread.
+  qSlicerFileBasedModuleFactory* fileBasedFactory(
+    const QFileInfo& file, const QVector<qSlicerFileBasedModuleFactory*>& factories)const;
 
   QStringList SearchPaths;
   QStringList ExplicitModules;
@@ -53,10 +60,36 @@ public:
   QMap<qSlicerModuleFactory*, int> Factories;
   QMap<QString, qSlicerModuleFactory*> RegisteredModules;
   QMap<QString, QStringList> ModuleDependees;
+  /// Time in ms spent by the factories to instantiate each module
+  QMap<QString, int> InstantiationTimes;
 
   bool Verbose;
 };
 
+namespace
+{
+//-----------------------------------------------------------------------------
+struct qSlicerFileBasedModuleFactoryFinder
+{
+  typedef qSlicerAbstractModuleFactoryManager::qSlicerFileBasedModuleFactory*
+    result_type;
+
+  qSlicerFileBasedModuleFactoryFinder(
+    const qSlicerAbstractModuleFactoryManagerPrivate* manager,
+    const QVector<qSlicerAbstractModuleFactoryManager::qSlicerFileBasedModuleFactory*>& factories)
+    : Manager(manager), Factories(factories)
+  {
+  }
+  result_type operator()(const QFileInfo& file)const
+  {
+    return this->Manager->fileBasedFactory(file, this->Factories);
+  }
+
+  const qSlicerAbstractModuleFactoryManagerPrivate* Manager;
+  QVector<qSlicerAbstractModuleFactoryManager::qSlicerFileBasedModuleFactory*> Factories;
+};
+}
+
 //-----------------------------------------------------------------------------
 // qSlicerAbstractModuleFactoryManagerPrivate methods
 qSlicerAbstractModuleFactoryManagerPrivate::qSlicerAbstractModuleFactoryManagerPrivate(qSlicerAbstractModuleFactoryManager& object)
@@ -113,6 +146,30 @@ qSlicerAbstractModuleFactoryManagerPrivate
   return factories;
 }
 
+//-----------------------------------------------------------------------------
+qSlicerAbstractModuleFactoryManagerPrivate::qSlicerFileBasedModuleFactory*
+qSlicerAbstractModuleFactoryManagerPrivate::fileBasedFactory(
+  const QFileInfo& file, const QVector<qSlicerFileBasedModuleFactory*>& factories)const
+{
+  foreach(qSlicerFileBasedModuleFactory* factory, factories)
+    {
+    if (this->Verbose)
+      {
+      qDebug() << " checking file: " << file.absoluteFilePath() << " as a " << typeid(*factory).name();
+      }
+    if (!factory->isValidFile(file))
+      {
+      continue;
+      }
+    if (this->Verbose)
+      {
+      qDebug() << " recognized file: " << file.absoluteFilePath() << " as a " << typeid(*factory).name();
+      }
+    return factory;
+    }
+  return 0;
+}
+
 //-----------------------------------------------------------------------------
 // qSlicerAbstractModuleFactoryManager methods
 
@@ -261,38 +318,35 @@ void qSlicerAbstractModuleFactoryManager::registerModules()
 //-----------------------------------------------------------------------------
 void qSlicerAbstractModuleFactoryManager::registerModules(const QString& path)
 {
+  Q_D(qSlicerAbstractModuleFactoryManager);
+  qSlicerStartupTracer::Scope traceScope(path, "registration");
   QDir directory(path);
   /// \tbd recursive search ?
-  foreach (const QFileInfo& file,
-           directory.entryInfoList(QDir::Files))
+  QList<QFileInfo> files = directory.entryInfoList(QDir::Files);
+  // The factories of the files are searched concurrently, the modules are
+  // then registered in the directory order on the calling thread.
+  QList<qSlicerFileBasedModuleFactory*> fileFactories =
+    QtConcurrent::blockingMapped<QList<qSlicerFileBasedModuleFactory*> >(
+      files, qSlicerFileBasedModuleFactoryFinder(d, d->fileBasedFactories()));
+  for (int i = 0; i < files.count(); ++i)
     {
-    this->registerModule(file);
+    this->registerModule(files[i], fileFactories[i]);
     }
 }
 
 //-----------------------------------------------------------------------------
 void qSlicerAbstractModuleFactoryManager::registerModule(const QFileInfo& file)
+{
+  Q_D(qSlicerAbstractModuleFactoryManager);
+  this->registerModule(file, d->fileBasedFactory(file, d->fileBasedFactories()));
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerAbstractModuleFactoryManager::registerModule(
+  const QFileInfo& file, qSlicerFileBasedModuleFactory* moduleFactory)
 {
   Q_D(qSlicerAbstractModuleFactoryManager);
 
-  qSlicerFileBasedModuleFactory* moduleFactory = 0;
-  foreach(qSlicerFileBasedModuleFactory* factory, d->fileBasedFactories())
-    {
-    if (d->Verbose)
-      {
-      qDebug() << " checking file: " << file.absoluteFilePath() << " as a " << typeid(*factory).name();
-      }
-    if (!factory->isValidFile(file))
-      {
-      continue;
-      }
-    if (d->Verbose)
-      {
-      qDebug() << " recognized file: " << file.absoluteFilePath() << " as a " << typeid(*factory).name();
-      }
-    moduleFactory = factory;
-    break;
-    }
   // File not supported by any factory
   if (moduleFactory == 0)
     {
@@ -366,9 +420,19 @@ qSlicerAbstractCoreModule* qSlicerAbstractModuleFactoryManager
   Q_D(qSlicerAbstractModuleFactoryManager);
   Q_ASSERT(d->RegisteredModules.contains(moduleName));
   qSlicerModuleFactory* factory = d->RegisteredModules[moduleName];
+  QTime instantiationTime;
+  instantiationTime.start();
+  qSlicerStartupTracer::instance()->beginEvent(moduleName, "instantiation");
   qSlicerAbstractCoreModule* module = factory->instantiate(moduleName);
+  qSlicerStartupTracer::instance()->endEvent();
   if (module)
     {
+    d->InstantiationTimes[moduleName] = instantiationTime.elapsed();
+    if (d->Verbose)
+      {
+      qDebug() << "Instantiated" << moduleName << "in"
+               << d->InstantiationTimes[moduleName] << "ms";
+      }
     module->setName(moduleName);
     foreach(const QString& dependency, module->dependencies())
       {
@@ -433,6 +497,7 @@ void qSlicerAbstractModuleFactoryManager::uninstantiateModule(const QString& mod
   Q_ASSERT(d->RegisteredModules.contains(moduleName));
   emit moduleAboutToBeUninstantiated(moduleName);
   d->RegisteredModules[moduleName]->uninstantiate(moduleName);
+  d->InstantiationTimes.remove(moduleName);
   emit moduleUninstantiated(moduleName);
 }
 
@@ -460,6 +525,13 @@ bool qSlicerAbstractModuleFactoryManager::isInstantiated(const QString& moduleNa
   return instantiated;
 }
 
+//-----------------------------------------------------------------------------
+int qSlicerAbstractModuleFactoryManager::moduleInstantiationTime(const QString& moduleName)const
+{
+  Q_D(const qSlicerAbstractModuleFactoryManager);
+  return d->InstantiationTimes.value(moduleName, -1);
+}
+
 //-----------------------------------------------------------------------------
 void qSlicerAbstractModuleFactoryManager::setVerboseModuleDiscovery(bool verbose)
 {
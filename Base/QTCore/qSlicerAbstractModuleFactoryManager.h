@@ -143,6 +143,8 @@ public:
 
   /// Scan the paths in \a searchPaths and for each file, attempt to register
   /// using one of the registered factories.
+  /// The files of a path are checked by the factories on worker threads, the
+  /// modules are then registered in order on the calling thread.
   void registerModules();
 
   /// Convenient method returning the list of all registered module names
@@ -166,6 +168,11 @@ public:
   /// Uninstantiate all instantiated modules
   void uninstantiateModules();
 
+  /// Return the time in ms it took to instantiate the module \a name,
+  /// -1 if the module is not instantiated.
+  /// \sa instantiateModules()
+  Q_INVOKABLE int moduleInstantiationTime(const QString& name)const;
+
   /// Enable/Disable verbose output during module discovery process
   void setVerboseModuleDiscovery(bool value);
 
@@ -210,6 +217,9 @@ protected:
 
   void registerModules(const QString& directoryPath);
   void registerModule(const QFileInfo& file);
+  /// Register the module of \a file with \a factory, 0 if the file
+  /// isn't supported by any factory.
+  void registerModule(const QFileInfo& file, qSlicerFileBasedModuleFactory* factory);
 
   /// Instantiate a module given its \a name
   qSlicerAbstractCoreModule* instantiateModule(const QString& name);
@@ -71,6 +71,7 @@
 #include "qSlicerLoadableModuleFactory.h"
 #include "qSlicerModuleFactoryManager.h"
 #include "qSlicerModuleManager.h"
+#include "qSlicerStartupTracer.h"
 #include "qSlicerUtils.h"
 
 // SlicerLogic includes
@@ -85,6 +86,7 @@
 
 // MRML includes
 #include <vtkCacheManager.h>
+#include <vtkEventBroker.h>
 #include <vtkMRMLCrosshairNode.h>
 #ifdef Slicer_BUILD_CLI_SUPPORT
 # include <vtkMRMLCommandLineModuleNode.h>
@@ -186,6 +188,15 @@ void qSlicerCoreApplicationPrivate::init()
 
   this->parseArguments();
 
+  // The trace is written in handleCommandLineArguments(), once the event loop
+  // is started.
+  if (!this->CoreCommandOptions ||
+      this->CoreCommandOptions->startupTraceFile().isEmpty())
+    {
+    qSlicerStartupTracer::instance()->setEnabled(false);
+    }
+  qSlicerStartupTracer::instance()->beginEvent("Application startup");
+
   this->SlicerHome = this->discoverSlicerHomeDirectory();
   this->setEnvironmentVariable("SLICER_HOME", this->SlicerHome);
 
@@ -213,6 +224,7 @@ void qSlicerCoreApplicationPrivate::init()
   this->ErrorLogModel->registerMsgHandler(new ctkVTKErrorLogMessageHandler);
   this->ErrorLogModel->setAllMsgHandlerEnabled(true);
 
+  qSlicerStartupTracer::instance()->beginEvent("Application logic");
   // Create the application Logic object,
   this->AppLogic = vtkSmartPointer<vtkSlicerApplicationLogic>::New();
   q->qvtkConnect(this->AppLogic, vtkCommand::ModifiedEvent,
@@ -256,6 +268,7 @@ void qSlicerCoreApplicationPrivate::init()
   // Create MRML scene
   vtkNew<vtkMRMLScene> scene;
   q->setMRMLScene(scene.GetPointer());
+  qSlicerStartupTracer::instance()->endEvent();
 
   // Instantiate moduleManager
   this->ModuleManager = QSharedPointer<qSlicerModuleManager>(new qSlicerModuleManager);
@@ -271,6 +284,7 @@ void qSlicerCoreApplicationPrivate::init()
     {
     if (q->corePythonManager())
       {
+      qSlicerStartupTracer::Scope traceScope("Python initialization", "python");
       q->corePythonManager()->mainContext(); // Initialize python
       q->corePythonManager()->setSystemExitExceptionHandlerEnabled(true);
       q->connect(q->corePythonManager(), SIGNAL(systemExitExceptionRaised(int)),
@@ -286,6 +300,7 @@ void qSlicerCoreApplicationPrivate::init()
 
 #ifdef Slicer_BUILD_EXTENSIONMANAGER_SUPPORT
 
+  qSlicerStartupTracer::instance()->beginEvent("Extensions manager");
   qSlicerExtensionsManagerModel * model = new qSlicerExtensionsManagerModel(q);
   model->setExtensionsSettingsFilePath(q->slicerRevisionUserSettingsFilePath());
   model->setSlicerRequirements(q->repositoryRevision(), q->os(), q->arch());
@@ -307,6 +322,7 @@ void qSlicerCoreApplicationPrivate::init()
     {
     qDebug() << "Successfully uninstalled extension" << extensionName;
     }
+  qSlicerStartupTracer::instance()->endEvent();
 
 #endif
 
@@ -660,6 +676,13 @@ qSlicerCoreApplication::qSlicerCoreApplication(
 //-----------------------------------------------------------------------------
 qSlicerCoreApplication::~qSlicerCoreApplication()
 {
+  Q_D(qSlicerCoreApplication);
+  if (d->CoreCommandOptions &&
+      !d->CoreCommandOptions->eventBrokerProfileFile().isEmpty())
+    {
+    vtkEventBroker::GetInstance()->WriteProfile(
+      d->CoreCommandOptions->eventBrokerProfileFile().toLatin1());
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -800,6 +823,11 @@ void qSlicerCoreApplication::handlePreApplicationCommandLineArguments()
     this->setAttribute(AA_EnableTesting);
     }
 
+  if (!options->eventBrokerProfileFile().isEmpty())
+    {
+    vtkEventBroker::GetInstance()->ProfilingOn();
+    }
+
 #ifdef Slicer_USE_PYTHONQT
   if (options->isPythonDisabled())
     {
@@ -813,6 +841,14 @@ void qSlicerCoreApplication::handleCommandLineArguments()
 {
   qSlicerCoreCommandOptions* options = this->coreCommandOptions();
 
+  // The main window, if any, has been rendered by now.
+  if (!options->startupTraceFile().isEmpty() &&
+      qSlicerStartupTracer::instance()->isEnabled() &&
+      !qSlicerStartupTracer::instance()->writeTrace(options->startupTraceFile()))
+    {
+    qWarning() << "Failed to write the startup trace into" << options->startupTraceFile();
+    }
+
   QStringList unparsedArguments = options->unparsedArguments();
   if (unparsedArguments.length() > 0)
     {
@@ -923,6 +959,7 @@ QSettings* qSlicerCoreApplication::userSettings()const
   // If required, instantiate Settings
   if(!mutable_d->UserSettings)
     {
+    qSlicerStartupTracer::Scope traceScope("Settings load", "settings");
     mutable_d->UserSettings = mutable_d->instantiateSettings(
           this->coreCommandOptions()->isTestingEnabled() ||
           this->coreCommandOptions()->settingsDisabled());
@@ -247,6 +247,20 @@ bool qSlicerCoreCommandOptions::disableMessageHandlers() const
   return d->ParsedArgs.value("disable-message-handlers").toBool();
 }
 
+//-----------------------------------------------------------------------------
+QString qSlicerCoreCommandOptions::eventBrokerProfileFile() const
+{
+  Q_D(const qSlicerCoreCommandOptions);
+  return d->ParsedArgs.value("event-broker-profile").toString();
+}
+
+//-----------------------------------------------------------------------------
+QString qSlicerCoreCommandOptions::startupTraceFile() const
+{
+  Q_D(const qSlicerCoreCommandOptions);
+  return d->ParsedArgs.value("startup-trace").toString();
+}
+
 //-----------------------------------------------------------------------------
 bool qSlicerCoreCommandOptions::settingsDisabled() const
 {
@@ -343,6 +357,14 @@ void qSlicerCoreCommandOptions::addArguments()
 
   this->addArgument("disable-message-handlers", "", QVariant::Bool,
                     "Start application disabling the 'terminal' message handlers.");
+
+  this->addArgument("event-broker-profile", "", QVariant::String,
+                    "Profile the MRML event observers and write the profile into the given "
+                    "file (CSV if the extension is .csv, JSON otherwise) when exiting.");
+
+  this->addArgument("startup-trace", "", QVariant::String,
+                    "Record the timings of the startup phases and of each module and write "
+                    "them into the given file as a Chrome trace (chrome://tracing).");
 }
 
 //-----------------------------------------------------------------------------
@@ -48,6 +48,8 @@ class Q_SLICER_BASE_QTCORE_EXPORT qSlicerCoreCommandOptions : public ctkCommandL
   Q_PROPERTY(bool displayTemporaryPathAndExit READ displayTemporaryPathAndExit)
   Q_PROPERTY(bool verboseModuleDiscovery READ verboseModuleDiscovery)
   Q_PROPERTY(bool disableMessageHandlers READ disableMessageHandlers)
+  Q_PROPERTY(QString eventBrokerProfileFile READ eventBrokerProfileFile)
+  Q_PROPERTY(QString startupTraceFile READ startupTraceFile)
   Q_PROPERTY(bool testingEnabled READ isTestingEnabled)
 #ifdef Slicer_USE_PYTHONQT
   Q_PROPERTY(bool pythonDisabled READ isPythonDisabled)
@@ -121,6 +123,17 @@ public:
   /// Return True if slicer shouldn't catch messages printed to the terminal.
   bool disableMessageHandlers()const;
 
+  /// Return the file the event broker profile is written into when the
+  /// application exits. Profiling is disabled if empty.
+  /// \sa vtkEventBroker::WriteProfile()
+  QString eventBrokerProfileFile()const;
+
+  /// Return the file the timings of the startup phases and modules are
+  /// written into once the application is started, in the Chrome trace
+  /// event format. Tracing is disabled if empty.
+  /// \sa qSlicerStartupTracer
+  QString startupTraceFile()const;
+
   /// Return True if slicer settings are ignored
   bool settingsDisabled() const;
 
@@ -20,6 +20,14 @@
 
 // Qt includes
 #include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFuture>
+#include <QPair>
+#include <QThread>
+#include <QTimer>
+#include <QtConcurrentRun>
 
 // SlicerQt includes
 #include "qSlicerCoreApplication.h"
@@ -28,13 +36,19 @@
 #include "qSlicerFileWriter.h"
 
 // MRML includes
+#include <vtkMRMLModelStorageNode.h>
 #include <vtkMRMLNode.h>
 #include <vtkMRMLScene.h>
 #include <vtkMRMLStorableNode.h>
+#include <vtkMRMLStorageNode.h>
 
 // VTK includes
 #include <vtkCollection.h>
 #include <vtkSmartPointer.h>
+#include <vtkWeakPointer.h>
+
+// STD includes
+#include <cstring>
 
 //-----------------------------------------------------------------------------
 class qSlicerCoreIOManagerPrivate
@@ -47,20 +61,227 @@ public:
   qSlicerFileReader* reader(const QString& fileName)const;
   QList<qSlicerFileReader*> readers(const QString& fileName)const;
 
+  /// Start reading ahead the files that follow the file being loaded
+  void startReadAhead();
+  /// Stop and wait for the read ahead of the files
+  void stopReadAhead();
+  void startAsyncBatch();
+  void endAsyncBatch();
+  void resetAsyncLoad();
+
   QSettings*        ExtensionFileType;
   QList<qSlicerFileReader*> Readers;
   QList<qSlicerFileWriter*> Writers;
   QMap<qSlicerIO::IOFileType, QStringList> FileTypes;
+
+  bool AsyncLoading;
+  QList<qSlicerIO::IOProperties> AsyncFiles;
+  vtkWeakPointer<vtkCollection> AsyncLoadedNodes;
+  int AsyncFileIndex;
+  bool AsyncSuccess;
+  bool AsyncCancelled;
+  int AsyncBatchSize;
+  int AsyncBatchFileCount;
+  /// Scene the current batch process state has been started on, if any
+  vtkWeakPointer<vtkMRMLScene> AsyncBatchScene;
+  /// Index of the last file whose read ahead has been started
+  int ReadAheadIndex;
+  QList<QFuture<void> > ReadAheads;
+  QAtomicInt ReadAheadCancelled;
+
+  QStringList ThreadSafeStorageNodeClassNames;
 };
 
+namespace
+{
+//-----------------------------------------------------------------------------
+/// Read the file to have it in the file system cache when the reader opens it.
+void readAhead(const QString& fileName, QAtomicInt* cancelled)
+{
+  QFile file(fileName);
+  if (!file.open(QIODevice::ReadOnly))
+    {
+    return;
+    }
+  const qint64 chunkSize = 1024 * 1024;
+  while (!file.atEnd() && !int(*cancelled))
+    {
+    if (file.read(chunkSize).isEmpty())
+      {
+      break;
+      }
+    }
+}
+
+//-----------------------------------------------------------------------------
+/// Read the model ahead of its storage node.
+/// \sa vtkMRMLModelStorageNode::PreloadFile()
+void preloadModel(const QString& fileName, QAtomicInt* cancelled)
+{
+  if (int(*cancelled))
+    {
+    return;
+    }
+  vtkMRMLModelStorageNode::PreloadFile(fileName.toLatin1());
+}
+
+//-----------------------------------------------------------------------------
+bool writeData(vtkMRMLStorageNode* storageNode, vtkMRMLStorableNode* node)
+{
+  return storageNode->WriteData(node) != 0;
+}
+
+//-----------------------------------------------------------------------------
+/// Return true if the data of \a node in \a fileName is up to date with the
+/// saving \a parameters.
+bool isDataUpToDate(vtkMRMLStorableNode* node, const QString& fileName,
+                    const qSlicerIO::IOProperties& parameters)
+{
+  vtkMRMLStorageNode* storageNode = node ? node->GetStorageNode() : 0;
+  if (!storageNode || !storageNode->GetFileName() ||
+      node->GetModifiedSinceRead())
+    {
+    return false;
+    }
+  // Remote data and data being transferred are always saved
+  if ((storageNode->GetURI() && strlen(storageNode->GetURI()) > 0) ||
+      (storageNode->GetReadState() != vtkMRMLStorageNode::Idle &&
+       storageNode->GetReadState() != vtkMRMLStorageNode::TransferDone) ||
+      (storageNode->GetWriteState() != vtkMRMLStorageNode::Idle &&
+       storageNode->GetWriteState() != vtkMRMLStorageNode::TransferDone))
+    {
+    return false;
+    }
+  QFileInfo fileInfo(fileName);
+  if (!fileInfo.exists() || QFileInfo(QString::fromStdString(
+        storageNode->GetFullNameFromFileName())) != fileInfo)
+    {
+    return false;
+    }
+  if (storageNode->GetWriteFileFormat() && parameters.contains("fileFormat") &&
+      parameters["fileFormat"].toString() != storageNode->GetWriteFileFormat())
+    {
+    return false;
+    }
+  if (parameters.contains("useCompression") &&
+      parameters["useCompression"].toInt() != storageNode->GetUseCompression())
+    {
+    return false;
+    }
+  return true;
+}
+}
+
 //-----------------------------------------------------------------------------
 qSlicerCoreIOManagerPrivate::qSlicerCoreIOManagerPrivate()
 {
+  this->AsyncLoading = false;
+  this->AsyncFileIndex = 0;
+  this->AsyncSuccess = true;
+  this->AsyncCancelled = false;
+  this->AsyncBatchSize = 8;
+  this->AsyncBatchFileCount = 0;
+  this->ReadAheadIndex = -1;
+  this->ThreadSafeStorageNodeClassNames
+    << "vtkMRMLNRRDStorageNode"
+    << "vtkMRMLModelStorageNode"
+    << "vtkMRMLFiberBundleStorageNode";
 }
 
 //-----------------------------------------------------------------------------
 qSlicerCoreIOManagerPrivate::~qSlicerCoreIOManagerPrivate()
 {
+  this->stopReadAhead();
+  this->endAsyncBatch();
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCoreIOManagerPrivate::startReadAhead()
+{
+  // Forget the finished read aheads
+  for (int i = this->ReadAheads.count() - 1; i >= 0; --i)
+    {
+    if (this->ReadAheads[i].isFinished())
+      {
+      this->ReadAheads.removeAt(i);
+      }
+    }
+  int maximumReadAheads = qMax(1, QThread::idealThreadCount());
+  this->ReadAheadIndex = qMax(this->ReadAheadIndex, this->AsyncFileIndex);
+  while (this->ReadAheads.count() < maximumReadAheads &&
+         this->ReadAheadIndex + 1 < this->AsyncFiles.count())
+    {
+    ++this->ReadAheadIndex;
+    const qSlicerIO::IOProperties& fileProperties =
+      this->AsyncFiles[this->ReadAheadIndex];
+    QString fileName = fileProperties.value("fileName").toString();
+    // Directories (e.g. DICOM) and file lists are left to the readers
+    if (fileName.isEmpty() || !QFileInfo(fileName).isFile())
+      {
+      continue;
+      }
+    // Models are entirely read in the worker threads, the storage nodes
+    // then just take their polydata.
+    if (fileProperties.value("fileType").toString() == QString("ModelFile"))
+      {
+      this->ReadAheads << QtConcurrent::run(
+        preloadModel, fileName, &this->ReadAheadCancelled);
+      }
+    else
+      {
+      this->ReadAheads << QtConcurrent::run(
+        readAhead, fileName, &this->ReadAheadCancelled);
+      }
+    }
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCoreIOManagerPrivate::stopReadAhead()
+{
+  this->ReadAheadCancelled = 1;
+  foreach(QFuture<void> readAhead, this->ReadAheads)
+    {
+    readAhead.waitForFinished();
+    }
+  this->ReadAheads.clear();
+  this->ReadAheadCancelled = 0;
+  this->ReadAheadIndex = -1;
+  // The models preloaded for files that were not loaded (e.g. cancel)
+  vtkMRMLModelStorageNode::ReleasePreloadedFiles();
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCoreIOManagerPrivate::startAsyncBatch()
+{
+  if (this->AsyncBatchScene || !this->currentScene())
+    {
+    return;
+    }
+  this->AsyncBatchScene = this->currentScene();
+  this->AsyncBatchScene->StartState(vtkMRMLScene::BatchProcessState);
+  this->AsyncBatchFileCount = 0;
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCoreIOManagerPrivate::endAsyncBatch()
+{
+  if (!this->AsyncBatchScene)
+    {
+    return;
+    }
+  vtkMRMLScene* scene = this->AsyncBatchScene;
+  this->AsyncBatchScene = 0;
+  scene->EndState(vtkMRMLScene::BatchProcessState);
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCoreIOManagerPrivate::resetAsyncLoad()
+{
+  this->stopReadAhead();
+  this->endAsyncBatch();
+  this->AsyncLoading = false;
+  this->AsyncFiles.clear();
+  this->AsyncLoadedNodes = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -369,6 +590,101 @@ loadNodes(const QList<qSlicerIO::IOProperties>& files,
   return res;
 }
 
+//-----------------------------------------------------------------------------
+bool qSlicerCoreIOManager::loadNodesAsync(const QList<qSlicerIO::IOProperties>& files,
+                                          vtkCollection* loadedNodes)
+{
+  Q_D(qSlicerCoreIOManager);
+  if (d->AsyncLoading || files.isEmpty())
+    {
+    return false;
+    }
+  d->AsyncLoading = true;
+  d->AsyncFiles = files;
+  d->AsyncLoadedNodes = loadedNodes;
+  d->AsyncFileIndex = 0;
+  d->AsyncSuccess = true;
+  d->AsyncCancelled = false;
+  d->startReadAhead();
+  QTimer::singleShot(0, this, SLOT(loadNextAsyncFile()));
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCoreIOManager::loadNextAsyncFile()
+{
+  Q_D(qSlicerCoreIOManager);
+  if (!d->AsyncLoading)
+    {
+    return;
+    }
+  if (d->AsyncCancelled || d->AsyncFileIndex >= d->AsyncFiles.count())
+    {
+    bool success = d->AsyncSuccess && !d->AsyncCancelled;
+    d->resetAsyncLoad();
+    emit asyncLoadFinished(success);
+    return;
+    }
+
+  qSlicerIO::IOProperties fileProperties = d->AsyncFiles[d->AsyncFileIndex];
+  qSlicerIO::IOFileType fileType =
+    static_cast<qSlicerIO::IOFileType>(fileProperties["fileType"].toString());
+  // Scenes are imported within their own scene state
+  if (fileType == QString("SceneFile"))
+    {
+    d->endAsyncBatch();
+    }
+  else
+    {
+    d->startAsyncBatch();
+    }
+  d->startReadAhead();
+
+  // Bypass the reimplementations that would block the event loop (e.g.
+  // modal progress dialog), the progress is reported by asyncLoadProgress().
+  d->AsyncSuccess = this->qSlicerCoreIOManager::loadNodes(
+    fileType, fileProperties, d->AsyncLoadedNodes) && d->AsyncSuccess;
+  ++d->AsyncFileIndex;
+  if (d->AsyncBatchScene && ++d->AsyncBatchFileCount >= d->AsyncBatchSize)
+    {
+    d->endAsyncBatch();
+    }
+
+  emit asyncLoadProgress(d->AsyncFileIndex, d->AsyncFiles.count());
+  QTimer::singleShot(0, this, SLOT(loadNextAsyncFile()));
+}
+
+//-----------------------------------------------------------------------------
+bool qSlicerCoreIOManager::isLoadingAsync()const
+{
+  Q_D(const qSlicerCoreIOManager);
+  return d->AsyncLoading;
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCoreIOManager::cancelAsyncLoad()
+{
+  Q_D(qSlicerCoreIOManager);
+  if (d->AsyncLoading)
+    {
+    d->AsyncCancelled = true;
+    }
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCoreIOManager::setAsyncLoadBatchSize(int batchSize)
+{
+  Q_D(qSlicerCoreIOManager);
+  d->AsyncBatchSize = qMax(1, batchSize);
+}
+
+//-----------------------------------------------------------------------------
+int qSlicerCoreIOManager::asyncLoadBatchSize()const
+{
+  Q_D(const qSlicerCoreIOManager);
+  return d->AsyncBatchSize;
+}
+
 //-----------------------------------------------------------------------------
 vtkMRMLNode* qSlicerCoreIOManager::loadNodesAndGetFirst(
   qSlicerIO::IOFileType fileType,
@@ -422,6 +738,107 @@ bool qSlicerCoreIOManager::saveNodes(qSlicerIO::IOFileType fileType,
   return true;
 }
 
+//-----------------------------------------------------------------------------
+bool qSlicerCoreIOManager::saveNodes(const QList<qSlicerIO::IOProperties>& files,
+                                     QList<qSlicerIO::IOProperties>* failedFiles)
+{
+  Q_D(qSlicerCoreIOManager);
+
+  typedef QPair<vtkMRMLStorableNode*, int> WrittenNode;
+  QList<WrittenNode> backgroundNodes;
+  QList<QFuture<bool> > backgroundWrites;
+  QList<int> failedIndexes;
+  // Modified events of the nodes written in the worker threads are postponed
+  // until their data is written, observers are then notified in the main thread.
+  QList<int> wasModifyingNodes;
+  QList<int> wasModifyingStorageNodes;
+
+  for (int i = 0; i < files.count(); ++i)
+    {
+    const qSlicerIO::IOProperties& fileProperties = files[i];
+    qSlicerIO::IOFileType fileType =
+      static_cast<qSlicerIO::IOFileType>(fileProperties["fileType"].toString());
+    QString fileName = fileProperties["fileName"].toString();
+    vtkMRMLStorableNode* node = vtkMRMLStorableNode::SafeDownCast(
+      d->currentScene()->GetNodeByID(
+        fileProperties.value("nodeID").toString().toLatin1()));
+    if (isDataUpToDate(node, fileName, fileProperties))
+      {
+      continue;
+      }
+
+    vtkMRMLStorableNode* preparedNode = 0;
+    foreach (qSlicerFileWriter* writer, this->writers(fileType))
+      {
+      writer->setMRMLScene(d->currentScene());
+      preparedNode = writer->prepareWrite(fileProperties);
+      if (preparedNode)
+        {
+        break;
+        }
+      }
+    if (!preparedNode)
+      {
+      // The writers write the node themselves
+      if (!this->saveNodes(fileType, fileProperties))
+        {
+        failedIndexes << i;
+        }
+      continue;
+      }
+
+    vtkMRMLStorageNode* storageNode = preparedNode->GetStorageNode();
+    if (d->ThreadSafeStorageNodeClassNames.contains(storageNode->GetClassName()))
+      {
+      wasModifyingNodes << preparedNode->StartModify();
+      wasModifyingStorageNodes << storageNode->StartModify();
+      backgroundNodes << WrittenNode(preparedNode, i);
+      backgroundWrites << QtConcurrent::run(writeData, storageNode, preparedNode);
+      }
+    else if (!writeData(storageNode, preparedNode))
+      {
+      failedIndexes << i;
+      }
+    }
+
+  for (int i = 0; i < backgroundWrites.count(); ++i)
+    {
+    // Don't process events meanwhile: the views would render the data being
+    // written.
+    if (!backgroundWrites[i].result())
+      {
+      failedIndexes << backgroundNodes[i].second;
+      }
+    vtkMRMLStorableNode* node = backgroundNodes[i].first;
+    node->GetStorageNode()->EndModify(wasModifyingStorageNodes[i]);
+    node->EndModify(wasModifyingNodes[i]);
+    }
+
+  qSort(failedIndexes);
+  if (failedFiles)
+    {
+    foreach(int failedIndex, failedIndexes)
+      {
+      *failedFiles << files[failedIndex];
+      }
+    }
+  return failedIndexes.isEmpty();
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerCoreIOManager::setThreadSafeStorageNodeClassNames(const QStringList& classNames)
+{
+  Q_D(qSlicerCoreIOManager);
+  d->ThreadSafeStorageNodeClassNames = classNames;
+}
+
+//-----------------------------------------------------------------------------
+QStringList qSlicerCoreIOManager::threadSafeStorageNodeClassNames()const
+{
+  Q_D(const qSlicerCoreIOManager);
+  return d->ThreadSafeStorageNodeClassNames;
+}
+
 //-----------------------------------------------------------------------------
 const QList<qSlicerFileReader*>& qSlicerCoreIOManager::readers()const
 {
@@ -95,6 +95,30 @@ public:
   virtual bool loadNodes(const QList<qSlicerIO::IOProperties>& files,
                          vtkCollection* loadedNodes = 0);
 
+  /// Load the \a files without blocking the event loop: one file is loaded
+  /// by the readers each time the event loop is entered, while the next files
+  /// are read ahead on worker threads to warm up the file system cache.
+  /// The files are added to the scene in batches of asyncLoadBatchSize files
+  /// (scene files excepted) within a vtkMRMLScene::BatchProcessState.
+  /// asyncLoadProgress() is emitted after each file and asyncLoadFinished()
+  /// once all the files are loaded or the load is cancelled.
+  /// The loaded nodes are added into \a loadedNodes if any, the collection
+  /// must outlive the load.
+  /// Return false if an asynchronous load is already running or if there is
+  /// no file to load.
+  /// \sa cancelAsyncLoad(), isLoadingAsync(), loadNodes()
+  virtual bool loadNodesAsync(const QList<qSlicerIO::IOProperties>& files,
+                              vtkCollection* loadedNodes = 0);
+
+  /// Return true if an asynchronous load is running.
+  /// \sa loadNodesAsync()
+  bool isLoadingAsync()const;
+
+  /// Number of files added to the scene within the same batch process state
+  /// by loadNodesAsync(). 8 by default.
+  void setAsyncLoadBatchSize(int batchSize);
+  int asyncLoadBatchSize()const;
+
   /// Load a list of node corresponding to \a fileType and return the first loaded node.
   /// This function is provided for convenience and is equivalent to call loadNodes
   /// with a vtkCollection parameter and retrieve the first element.
@@ -125,16 +149,51 @@ public:
                              const qSlicerIO::IOProperties& parameters);
 #endif
 
+  /// Save a bunch of nodes. The "fileType" attribute should be in the
+  /// parameter map of each node to save.
+  /// A node is not saved again if its data hasn't been modified since it was
+  /// read from or written into the same file.
+  /// The data of the nodes whose storage node class is in
+  /// threadSafeStorageNodeClassNames() is written concurrently in worker
+  /// threads while the other nodes are written in the main thread.
+  /// The entries that failed to be saved are appended to \a failedFiles if
+  /// any.
+  /// Return true if all the nodes are saved, false otherwise.
+  bool saveNodes(const QList<qSlicerIO::IOProperties>& files,
+                 QList<qSlicerIO::IOProperties>* failedFiles = 0);
+
+  /// Class names of the storage nodes whose WriteData() can run in a worker
+  /// thread. Storage node subclasses must be listed explicitly.
+  /// vtkMRMLNRRDStorageNode, vtkMRMLModelStorageNode and
+  /// vtkMRMLFiberBundleStorageNode by default.
+  void setThreadSafeStorageNodeClassNames(const QStringList& classNames);
+  QStringList threadSafeStorageNodeClassNames()const;
+
   /// Register the reader/writer \a io
   /// Note also that the IOManager takes ownership of \a io
   void registerIO(qSlicerIO* io);
 
+public slots:
+  /// Stop the running asynchronous load after the file being loaded.
+  /// asyncLoadFinished() is emitted with success set to false.
+  /// \sa loadNodesAsync()
+  void cancelAsyncLoad();
+
 signals:
+  /// Emitted by loadNodesAsync() each time a file is loaded.
+  void asyncLoadProgress(int loadedFiles, int totalFiles);
+
+  /// Emitted when the asynchronous load is done, \a success is false if a
+  /// file failed to be loaded or if the load has been cancelled.
+  void asyncLoadFinished(bool success);
 
   /// This signal is emitted each time a file is loaded using loadNodes()
   /// \sa loadNodes(const qSlicerIO::IOFileType&, const qSlicerIO::IOProperties&, vtkCollection*)
   void newFileLoaded(const qSlicerIO::IOProperties& parametersWithFileType);
 
+protected slots:
+  void loadNextAsyncFile();
+
 protected:
 
   /// Returns the list of registered readers
@@ -19,6 +19,7 @@
 ==============================================================================*/
 
 // Qt includes
+#include <QDateTime>
 #include <QDebug>
 #include <QDir>
 #include <QNetworkAccessManager>
@@ -180,6 +181,10 @@ public:
 
   QString SlicerVersion;
 
+  /// Time of the retrieval and metadata of each extension id
+  QHash<QString, QPair<QDateTime, ExtensionMetadataType> > MetadataCache;
+  int MetadataCacheLifetime;
+
   QStandardItemModelWithRole Model;
 };
 
@@ -199,6 +204,7 @@ void qSlicerExtensionsManagerModelPrivate::init()
   qRegisterMetaType<ExtensionMetadataType>("ExtensionMetadataType");
 
   this->NewExtensionEnabledByDefault = true;
+  this->MetadataCacheLifetime = 300;
 
   this->initializeColumnIdToNameMap(Self::NameColumn, "extensionname");
   this->initializeColumnIdToNameMap(Self::ScmColumn, "scm");
@@ -916,6 +922,17 @@ qSlicerExtensionsManagerModel::ExtensionMetadataType qSlicerExtensionsManagerMod
     return ExtensionMetadataType();
     }
 
+  if (d->MetadataCache.contains(extensionId))
+    {
+    const QPair<QDateTime, ExtensionMetadataType>& cached = d->MetadataCache[extensionId];
+    if (cached.first.secsTo(QDateTime::currentDateTime()) < d->MetadataCacheLifetime)
+      {
+      d->debug(QString("Reusing extension metadata [ extensionId: %1]").arg(extensionId));
+      return cached.second;
+      }
+    d->MetadataCache.remove(extensionId);
+    }
+
   qMidasAPI::ParametersType parameters;
   parameters["extension_id"] = extensionId;
 
@@ -943,9 +960,35 @@ qSlicerExtensionsManagerModel::ExtensionMetadataType qSlicerExtensionsManagerMod
           this->serverToExtensionDescriptionKey().value(key, key), result.value(key));
     }
 
+  if (d->MetadataCacheLifetime > 0)
+    {
+    d->MetadataCache.insert(extensionId, qMakePair(QDateTime::currentDateTime(), updatedExtensionMetadata));
+    }
+
   return updatedExtensionMetadata;
 }
 
+// --------------------------------------------------------------------------
+CTK_GET_CPP(qSlicerExtensionsManagerModel, int, metadataCacheLifetime, MetadataCacheLifetime)
+
+// --------------------------------------------------------------------------
+void qSlicerExtensionsManagerModel::setMetadataCacheLifetime(int seconds)
+{
+  Q_D(qSlicerExtensionsManagerModel);
+  d->MetadataCacheLifetime = qMax(seconds, 0);
+  if (d->MetadataCacheLifetime == 0)
+    {
+    d->MetadataCache.clear();
+    }
+}
+
+// --------------------------------------------------------------------------
+void qSlicerExtensionsManagerModel::clearMetadataCache()
+{
+  Q_D(qSlicerExtensionsManagerModel);
+  d->MetadataCache.clear();
+}
+
 // --------------------------------------------------------------------------
 void qSlicerExtensionsManagerModel::downloadAndInstallExtension(const QString& extensionId)
 {
@@ -1185,12 +1228,45 @@ void qSlicerExtensionsManagerModel::updateModel()
 
   d->Model.clear();
 
+  // The description files are parsed again only if they changed since they
+  // were cached in the extensions settings.
+  QSettings settings(this->extensionsSettingsFilePath(), QSettings::IniFormat);
+  QVariantMap descriptionCache = settings.value("Extensions/DescriptionCache").toMap();
+  QVariantMap updatedDescriptionCache;
+
   foreach(const QFileInfo& fileInfo, d->extensionDescriptionFileInfos(extensionDescriptionPath))
     {
-    ExtensionMetadataType metadata = Self::parseExtensionDescriptionFile(fileInfo.absoluteFilePath());
+    QString file = fileInfo.absoluteFilePath();
+    QVariantMap entry = descriptionCache.value(file).toMap();
+    ExtensionMetadataType metadata;
+    // A file modified in the second it was cached may have changed unnoticed
+    // on file systems with a coarse modification time.
+    if (!entry.isEmpty()
+        && entry.value("size").toLongLong() == fileInfo.size()
+        && entry.value("lastModified").toDateTime() == fileInfo.lastModified()
+        && fileInfo.lastModified().addSecs(1) < entry.value("cachedAt").toDateTime())
+      {
+      metadata = entry.value("metadata").toMap();
+      }
+    else
+      {
+      metadata = Self::parseExtensionDescriptionFile(file);
+      entry.clear();
+      entry.insert("size", fileInfo.size());
+      entry.insert("lastModified", fileInfo.lastModified());
+      entry.insert("cachedAt", QDateTime::currentDateTime());
+      entry.insert("metadata", metadata);
+      }
+    updatedDescriptionCache.insert(file, entry);
     d->addExtensionModelRow(metadata);
     }
 
+  if (!this->extensionsSettingsFilePath().isEmpty()
+      && updatedDescriptionCache != descriptionCache)
+    {
+    settings.setValue("Extensions/DescriptionCache", updatedDescriptionCache);
+    }
+
   emit this->modelUpdated();
 }
 
@@ -54,6 +54,11 @@ class Q_SLICER_BASE_QTCORE_EXPORT qSlicerExtensionsManagerModel : public QObject
   Q_PROPERTY(QString slicerOs READ slicerOs WRITE setSlicerOs)
   Q_PROPERTY(QString slicerArch READ slicerArch WRITE setSlicerArch)
   Q_PROPERTY(QString slicerVersion READ slicerVersion WRITE setSlicerVersion)
+
+  /// Number of seconds the metadata retrieved from the server are reused by
+  /// retrieveExtensionMetadata(), 300 by default. 0 disables the cache.
+  /// \sa clearMetadataCache()
+  Q_PROPERTY(int metadataCacheLifetime READ metadataCacheLifetime WRITE setMetadataCacheLifetime)
 public:
   /// Superclass typedef
   typedef QObject Superclass;
@@ -154,6 +159,13 @@ public:
   /// \sa setServerUrl
   Q_INVOKABLE ExtensionMetadataType retrieveExtensionMetadata(const QString& extensionId);
 
+  int metadataCacheLifetime()const;
+  void setMetadataCacheLifetime(int seconds);
+
+  /// \brief Forget the metadata retrieved from the server
+  /// \sa retrieveExtensionMetadata, metadataCacheLifetime
+  Q_INVOKABLE void clearMetadataCache();
+
   /// \sa downloadExtension, isExtensionScheduledForUninstall, extensionScheduledForUninstall
   Q_INVOKABLE bool installExtension(const QString& extensionName,
                                     const ExtensionMetadataType &extensionMetadata,
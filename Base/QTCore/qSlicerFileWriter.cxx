@@ -56,6 +56,13 @@ bool qSlicerFileWriter::write(const qSlicerIO::IOProperties& properties)
   return false;
 }
 
+//----------------------------------------------------------------------------
+vtkMRMLStorableNode* qSlicerFileWriter::prepareWrite(const qSlicerIO::IOProperties& properties)
+{
+  Q_UNUSED(properties);
+  return 0;
+}
+
 //----------------------------------------------------------------------------
 void qSlicerFileWriter::setWrittenNodes(const QStringList& nodes)
 {
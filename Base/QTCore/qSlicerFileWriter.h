@@ -25,6 +25,7 @@
 #include "qSlicerIO.h"
 class qSlicerFileWriterPrivate;
 
+class vtkMRMLStorableNode;
 class vtkObject;
 
 class Q_SLICER_BASE_QTCORE_EXPORT qSlicerFileWriter
@@ -53,6 +54,13 @@ public:
   /// ...
   virtual bool write(const qSlicerIO::IOProperties& properties);
 
+  /// Set up the storage node of the node identified by nodeID as write()
+  /// does, without writing any data. Return the node, its data can then be
+  /// written with vtkMRMLStorageNode::WriteData(), e.g. in a worker thread.
+  /// Return 0 if the writer can't write that way, write() must be used.
+  /// 0 by default.
+  virtual vtkMRMLStorableNode* prepareWrite(const qSlicerIO::IOProperties& properties);
+
   QStringList writtenNodes()const;
 
 protected:
@@ -18,9 +18,13 @@
 
 ==============================================================================*/
 
+// Qt includes
+#include <QTime>
+
 // SlicerQt includes
 #include "qSlicerModuleFactoryManager.h"
 #include "qSlicerAbstractCoreModule.h"
+#include "qSlicerStartupTracer.h"
 
 // STD includes
 #include <algorithm>
@@ -35,6 +39,8 @@ public:
   qSlicerModuleFactoryManagerPrivate(qSlicerModuleFactoryManager& object);
 
   QStringList LoadedModules;
+  /// Time in ms spent to load each module, excluding its dependencies
+  QMap<QString, int> LoadTimes;
   vtkSlicerApplicationLogic* AppLogic;
   vtkMRMLScene* MRMLScene;
 };
@@ -128,6 +134,9 @@ bool qSlicerModuleFactoryManager::loadModule(const QString& name, const QString&
     return false;
     }
 
+  // The dependencies are traced as children of the module
+  qSlicerStartupTracer::Scope traceScope(name, "load");
+
   // Load the modules the module depends on.
   // There is no cycle check, so be careful
   foreach(const QString& dependency, instance->dependencies())
@@ -142,6 +151,9 @@ bool qSlicerModuleFactoryManager::loadModule(const QString& name, const QString&
       }
     }
 
+  QTime loadTime;
+  loadTime.start();
+
   // Update internal Map
   d->LoadedModules << name;
 
@@ -166,9 +178,22 @@ bool qSlicerModuleFactoryManager::loadModule(const QString& name, const QString&
   // Handle post-load initialization
   emit this->moduleLoaded(name);
 
+  d->LoadTimes[name] = loadTime.elapsed();
+  if (this->Superclass::isVerbose())
+    {
+    qDebug() << "Loaded module" << name << "in" << d->LoadTimes[name] << "ms";
+    }
+
   return true;
 }
 
+//---------------------------------------------------------------------------
+int qSlicerModuleFactoryManager::moduleLoadTime(const QString& name)const
+{
+  Q_D(const qSlicerModuleFactoryManager);
+  return d->LoadTimes.value(name, -1);
+}
+
 //---------------------------------------------------------------------------
 bool qSlicerModuleFactoryManager::isLoaded(const QString& name)const
 {
@@ -221,6 +246,7 @@ void qSlicerModuleFactoryManager::unloadModule(const QString& name)
     }
   emit this->moduleAboutToBeUnloaded(name);
   d->LoadedModules.removeOne(name);
+  d->LoadTimes.remove(name);
   this->uninstantiateModule(name);
   emit this->moduleUnloaded(name);
 }
@@ -67,6 +67,12 @@ public:
   /// Return true if module \a name has been loaded, false otherwise
   Q_INVOKABLE bool isLoaded(const QString& name)const;
 
+  /// Return the time in ms it took to load the module \a name, not counting
+  /// the load of its dependencies. -1 if the module is not loaded.
+  /// The module widget isn't created at load time but when it is first shown.
+  /// \sa moduleInstantiationTime()
+  Q_INVOKABLE int moduleLoadTime(const QString& name)const;
+
   /// Return the loaded module identified by \a name, 0 if no module
   /// has been loaded yet, even if the module has been instantiated.
   Q_INVOKABLE qSlicerAbstractCoreModule* loadedModule(const QString& name)const;
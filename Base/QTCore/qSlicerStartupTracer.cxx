@@ -0,0 +1,224 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Copyright (c) Kitware Inc.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  This file was originally developed by Jean-Christophe Fillion-Robin, Kitware Inc.
+  and was partially funded by NIH grant 3P41RR013218-12S1
+
+==============================================================================*/
+
+// Qt includes
+#include <QCoreApplication>
+#include <QFile>
+#include <QList>
+#include <QTextStream>
+#include <QThread>
+
+// SlicerQt includes
+#include "qSlicerStartupTracer.h"
+
+// VTK includes
+#include <vtkTimerLog.h>
+
+//-----------------------------------------------------------------------------
+class qSlicerStartupTracerPrivate
+{
+public:
+  qSlicerStartupTracerPrivate();
+
+  /// Time in microseconds since the tracer creation
+  qint64 now()const;
+  bool isTracedThread()const;
+
+  struct Event
+    {
+    QString Name;
+    QString Category;
+    qint64 Start;
+    qint64 Duration;
+    int Depth;
+    };
+
+  bool Enabled;
+  double Origin;
+  QThread* Thread;
+  QList<Event> Events;
+  /// Indexes in Events of the opened events
+  QList<int> OpenedEvents;
+};
+
+namespace
+{
+//-----------------------------------------------------------------------------
+QString escapeJSON(QString value)
+{
+  value.replace('\\', "\\\\");
+  value.replace('"', "\\\"");
+  value.replace('\n', "\\n");
+  value.replace('\t', "\\t");
+  return value;
+}
+}
+
+//-----------------------------------------------------------------------------
+// qSlicerStartupTracerPrivate methods
+
+//-----------------------------------------------------------------------------
+qSlicerStartupTracerPrivate::qSlicerStartupTracerPrivate()
+{
+  this->Enabled = true;
+  this->Origin = vtkTimerLog::GetUniversalTime();
+  this->Thread = QThread::currentThread();
+}
+
+//-----------------------------------------------------------------------------
+qint64 qSlicerStartupTracerPrivate::now()const
+{
+  return static_cast<qint64>(
+    (vtkTimerLog::GetUniversalTime() - this->Origin) * 1e6);
+}
+
+//-----------------------------------------------------------------------------
+bool qSlicerStartupTracerPrivate::isTracedThread()const
+{
+  return QThread::currentThread() == this->Thread;
+}
+
+//-----------------------------------------------------------------------------
+// qSlicerStartupTracer methods
+
+//-----------------------------------------------------------------------------
+qSlicerStartupTracer::qSlicerStartupTracer()
+  : d_ptr(new qSlicerStartupTracerPrivate)
+{
+}
+
+//-----------------------------------------------------------------------------
+qSlicerStartupTracer::~qSlicerStartupTracer()
+{
+}
+
+//-----------------------------------------------------------------------------
+qSlicerStartupTracer* qSlicerStartupTracer::instance()
+{
+  static qSlicerStartupTracer tracer;
+  return &tracer;
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerStartupTracer::setEnabled(bool enable)
+{
+  Q_D(qSlicerStartupTracer);
+  d->Enabled = enable;
+  if (!enable)
+    {
+    d->Events.clear();
+    d->OpenedEvents.clear();
+    }
+}
+
+//-----------------------------------------------------------------------------
+bool qSlicerStartupTracer::isEnabled()const
+{
+  Q_D(const qSlicerStartupTracer);
+  return d->Enabled;
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerStartupTracer::beginEvent(const QString& name, const QString& category)
+{
+  Q_D(qSlicerStartupTracer);
+  if (!d->Enabled || !d->isTracedThread())
+    {
+    return;
+    }
+  qSlicerStartupTracerPrivate::Event event;
+  event.Name = name;
+  event.Category = category.isEmpty() ? QString("startup") : category;
+  event.Start = d->now();
+  event.Duration = -1;
+  event.Depth = d->OpenedEvents.count();
+  d->OpenedEvents << d->Events.count();
+  d->Events << event;
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerStartupTracer::endEvent()
+{
+  Q_D(qSlicerStartupTracer);
+  if (!d->Enabled || !d->isTracedThread() || d->OpenedEvents.isEmpty())
+    {
+    return;
+    }
+  qSlicerStartupTracerPrivate::Event& event = d->Events[d->OpenedEvents.takeLast()];
+  event.Duration = d->now() - event.Start;
+}
+
+//-----------------------------------------------------------------------------
+bool qSlicerStartupTracer::writeTrace(const QString& fileName)
+{
+  Q_D(qSlicerStartupTracer);
+  if (!d->Enabled)
+    {
+    return false;
+    }
+  while (!d->OpenedEvents.isEmpty())
+    {
+    this->endEvent();
+    }
+
+  QFile file(fileName);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+    this->setEnabled(false);
+    return false;
+    }
+  QTextStream out(&file);
+  qint64 pid = QCoreApplication::instance() ?
+    QCoreApplication::applicationPid() : 0;
+  out << "{\n  \"displayTimeUnit\": \"ms\",\n  \"traceEvents\": [";
+  for (int i = 0; i < d->Events.count(); ++i)
+    {
+    const qSlicerStartupTracerPrivate::Event& event = d->Events[i];
+    out << (i ? ",\n" : "\n")
+        << "    {\"name\": \"" << escapeJSON(event.Name) << "\""
+        << ", \"cat\": \"" << escapeJSON(event.Category) << "\""
+        << ", \"ph\": \"X\""
+        << ", \"ts\": " << event.Start
+        << ", \"dur\": " << event.Duration
+        << ", \"pid\": " << pid
+        << ", \"tid\": 0"
+        << ", \"args\": {\"depth\": " << event.Depth << "}}";
+    }
+  out << "\n  ]\n}\n";
+  file.close();
+
+  this->setEnabled(false);
+  return file.error() == QFile::NoError;
+}
+
+//-----------------------------------------------------------------------------
+// qSlicerStartupTracer::Scope methods
+
+//-----------------------------------------------------------------------------
+qSlicerStartupTracer::Scope::Scope(const QString& name, const QString& category)
+{
+  qSlicerStartupTracer::instance()->beginEvent(name, category);
+}
+
+//-----------------------------------------------------------------------------
+qSlicerStartupTracer::Scope::~Scope()
+{
+  qSlicerStartupTracer::instance()->endEvent();
+}
@@ -0,0 +1,89 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Copyright (c) Kitware Inc.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  This file was originally developed by Jean-Christophe Fillion-Robin, Kitware Inc.
+  and was partially funded by NIH grant 3P41RR013218-12S1
+
+==============================================================================*/
+
+#ifndef __qSlicerStartupTracer_h
+#define __qSlicerStartupTracer_h
+
+// Qt includes
+#include <QScopedPointer>
+#include <QString>
+
+#include "qSlicerBaseQTCoreExport.h"
+
+class qSlicerStartupTracerPrivate;
+
+/// \brief Record nested timings of the application startup phases.
+///
+/// The events are recorded on the thread that first accessed the tracer,
+/// events of other threads are ignored. Nested events appear as children of
+/// the enclosing event. The trace is written in the Chrome trace event format
+/// and can be opened with chrome://tracing.
+///
+/// Usage:
+/// \code
+/// {
+/// qSlicerStartupTracer::Scope scope("Register modules", "modules");
+/// ...
+/// }
+/// qSlicerStartupTracer::instance()->writeTrace("startup.json");
+/// \endcode
+///
+/// Events are recorded until the tracer is disabled or the trace written.
+/// \sa qSlicerCoreCommandOptions::startupTraceFile()
+class Q_SLICER_BASE_QTCORE_EXPORT qSlicerStartupTracer
+{
+public:
+  /// Return the tracer of the application, created on first access.
+  static qSlicerStartupTracer* instance();
+
+  /// Enabled by default. Disabling the tracer discards the recorded events.
+  void setEnabled(bool enable);
+  bool isEnabled()const;
+
+  /// Start an event, it is closed by the next call to endEvent().
+  void beginEvent(const QString& name, const QString& category = QString());
+  /// Close the last started event.
+  void endEvent();
+
+  /// Close the events still opened, write the recorded events into
+  /// \a fileName and disable the tracer.
+  /// Return false if the file can't be written.
+  bool writeTrace(const QString& fileName);
+
+  /// Record an event for the lifetime of the scope.
+  class Q_SLICER_BASE_QTCORE_EXPORT Scope
+  {
+  public:
+    Scope(const QString& name, const QString& category = QString());
+    ~Scope();
+  };
+
+protected:
+  qSlicerStartupTracer();
+  ~qSlicerStartupTracer();
+
+  QScopedPointer<qSlicerStartupTracerPrivate> d_ptr;
+
+private:
+  Q_DECLARE_PRIVATE(qSlicerStartupTracer);
+  Q_DISABLE_COPY(qSlicerStartupTracer);
+};
+
+#endif
@@ -2,6 +2,7 @@
 #include <QDebug>
 #include <QDragEnterEvent>
 #include <QDropEvent>
+#include <QEventLoop>
 #include <QFileDialog>
 #include <QInputDialog>
 #include <QMetaProperty>
@@ -60,6 +61,8 @@ public:
 
   QSharedPointer<ctkScreenshotDialog> ScreenshotDialog;
   QProgressDialog*                    ProgressDialog;
+  QStringList                         AsyncLoadFileNames;
+  bool                                AsyncLoadSuccess;
 };
 
 //-----------------------------------------------------------------------------
@@ -70,6 +73,7 @@ qSlicerIOManagerPrivate::qSlicerIOManagerPrivate(qSlicerIOManager& object)
   :q_ptr(&object)
 {
   this->ProgressDialog = 0;
+  this->AsyncLoadSuccess = false;
 }
 
 //-----------------------------------------------------------------------------
@@ -425,19 +429,55 @@ bool qSlicerIOManager::loadNodes(const QList<qSlicerIO::IOProperties>& files,
 
   bool needStop = d->startProgressDialog(files.count());
   bool res = true;
-  foreach(qSlicerIO::IOProperties fileProperties, files)
+  if (this->isLoadingAsync() || files.isEmpty())
     {
-    res = this->loadNodes(
-      static_cast<qSlicerIO::IOFileType>(fileProperties["fileType"].toString()),
-      fileProperties,
-      loadedNodes) && res;
+    foreach(qSlicerIO::IOProperties fileProperties, files)
+      {
+      res = this->loadNodes(
+        static_cast<qSlicerIO::IOFileType>(fileProperties["fileType"].toString()),
+        fileProperties,
+        loadedNodes) && res;
 
-    this->updateProgressDialog();
-    if (d->ProgressDialog->wasCanceled())
+      this->updateProgressDialog();
+      if (d->ProgressDialog->wasCanceled())
+        {
+        res = false;
+        break;
+        }
+      }
+    }
+  else
+    {
+    // The event loop keeps running between the files: the progress dialog
+    // stays responsive while the next files are read ahead.
+    d->AsyncLoadFileNames.clear();
+    foreach(const qSlicerIO::IOProperties& fileProperties, files)
       {
-      res = false;
-      break;
+      d->AsyncLoadFileNames << fileProperties.value("fileName").toString();
+      }
+    d->ProgressDialog->setLabelText(
+      "Loading file " + d->AsyncLoadFileNames[0] + " ...");
+    d->AsyncLoadSuccess = false;
+
+    QEventLoop eventLoop;
+    this->connect(this, SIGNAL(asyncLoadProgress(int,int)),
+                  SLOT(onAsyncLoadProgress(int,int)));
+    this->connect(this, SIGNAL(asyncLoadFinished(bool)),
+                  SLOT(onAsyncLoadFinished(bool)));
+    eventLoop.connect(this, SIGNAL(asyncLoadFinished(bool)), SLOT(quit()));
+    this->connect(d->ProgressDialog, SIGNAL(canceled()),
+                  SLOT(cancelAsyncLoad()));
+    if (this->loadNodesAsync(files, loadedNodes))
+      {
+      eventLoop.exec();
       }
+    this->disconnect(d->ProgressDialog, SIGNAL(canceled()),
+                     this, SLOT(cancelAsyncLoad()));
+    this->disconnect(this, SIGNAL(asyncLoadProgress(int,int)),
+                     this, SLOT(onAsyncLoadProgress(int,int)));
+    this->disconnect(this, SIGNAL(asyncLoadFinished(bool)),
+                     this, SLOT(onAsyncLoadFinished(bool)));
+    res = d->AsyncLoadSuccess;
     }
 
   if (needStop)
@@ -448,6 +488,30 @@ bool qSlicerIOManager::loadNodes(const QList<qSlicerIO::IOProperties>& files,
   return res;
 }
 
+//-----------------------------------------------------------------------------
+void qSlicerIOManager::onAsyncLoadProgress(int loadedFiles, int totalFiles)
+{
+  Q_D(qSlicerIOManager);
+  if (!d->ProgressDialog)
+    {
+    return;
+    }
+  if (loadedFiles < totalFiles && loadedFiles < d->AsyncLoadFileNames.count())
+    {
+    d->ProgressDialog->setLabelText(
+      "Loading file " + d->AsyncLoadFileNames[loadedFiles] + " ...");
+    }
+  d->ProgressDialog->setValue(
+    qMin(loadedFiles, d->ProgressDialog->maximum() - 1));
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerIOManager::onAsyncLoadFinished(bool success)
+{
+  Q_D(qSlicerIOManager);
+  d->AsyncLoadSuccess = success;
+}
+
 //-----------------------------------------------------------------------------
 void qSlicerIOManager::updateProgressDialog()
 {
@@ -66,7 +66,8 @@ public:
                                      vtkCollection* loadedNodes = 0);
   /// If you have a list of nodes to load, it's best to use this function
   /// in order to have a unique progress dialog instead of multiple ones.
-  /// It internally calls loadNodes() for each file.
+  /// The files are loaded with loadNodesAsync(), the function returns once
+  /// they are all loaded or when the progress dialog is cancelled.
   virtual bool loadNodes(const QList<qSlicerIO::IOProperties>& files,
                          vtkCollection* loadedNodes = 0);
 
@@ -103,6 +104,8 @@ public slots:
 
 protected slots:
   void updateProgressDialog();
+  void onAsyncLoadProgress(int loadedFiles, int totalFiles);
+  void onAsyncLoadFinished(bool success);
 
 protected:
   friend class qSlicerFileDialog;
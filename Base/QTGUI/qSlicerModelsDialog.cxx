@@ -19,7 +19,9 @@
 ==============================================================================*/
 
 /// Qt includes
+#include <QDir>
 #include <QFileDialog>
+#include <QFileInfo>
 
 /// SlicerQt includes
 #include "qSlicerApplication.h"
@@ -83,7 +85,12 @@ void qSlicerModelsDialogPrivate::openAddModelDirectoryDialog()
     }
 
   QStringList filters = qSlicerFileDialog::nameFilters(q->fileType());
-  this->SelectedFiles = QDir(modelDirectory).entryList(filters);
+  this->SelectedFiles.clear();
+  foreach(const QFileInfo& fileInfo,
+          QDir(modelDirectory).entryInfoList(filters, QDir::Files))
+    {
+    this->SelectedFiles << fileInfo.absoluteFilePath();
+    }
   this->accept();
 }
 
@@ -132,20 +139,25 @@ bool qSlicerModelsDialog::exec(const qSlicerIO::IOProperties& readerProperties)
     {
     return res;
     }
-  QStringList files = d->SelectedFiles;
-  foreach(QString file, files)
+  QList<qSlicerIO::IOProperties> files;
+  foreach(QString file, d->SelectedFiles)
     {
     qSlicerIO::IOProperties properties = readerProperties;
     properties["fileName"] = file;
-    vtkNew<vtkCollection> loadedNodes;
-    res = qSlicerCoreApplication::application()->coreIOManager()
-      ->loadNodes(this->fileType(),
-                  properties, loadedNodes.GetPointer()) || res;
-    for (int i = 0; i < loadedNodes->GetNumberOfItems(); ++i)
-      {
-      d->LoadedNodeIDs << vtkMRMLNode::SafeDownCast(loadedNodes->GetItemAsObject(i))
-        ->GetID();
-      }
+    properties["fileType"] = this->fileType();
+    files << properties;
+    }
+  // The files are loaded together so that the next models are read in
+  // parallel while the current one is added into the scene.
+  vtkNew<vtkCollection> loadedNodes;
+  qSlicerCoreApplication::application()->coreIOManager()
+    ->loadNodes(files, loadedNodes.GetPointer());
+  // Succeed if any model is loaded
+  res = loadedNodes->GetNumberOfItems() > 0;
+  for (int i = 0; i < loadedNodes->GetNumberOfItems(); ++i)
+    {
+    d->LoadedNodeIDs << vtkMRMLNode::SafeDownCast(loadedNodes->GetItemAsObject(i))
+      ->GetID();
     }
   return res;
 }
@@ -123,13 +123,31 @@ bool qSlicerNodeWriter::write(const qSlicerIO::IOProperties& properties)
 {
   this->setWrittenNodes(QStringList());
 
+  vtkMRMLStorableNode* node = this->prepareWrite(properties);
+  if (node == 0)
+    {
+    return false;
+    }
+  bool res = node->GetStorageNode()->WriteData(node);
+
+  if (res)
+    {
+    this->setWrittenNodes(QStringList() << node->GetID());
+    }
+
+  return res;
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLStorableNode* qSlicerNodeWriter::prepareWrite(const qSlicerIO::IOProperties& properties)
+{
   Q_ASSERT(!properties["nodeID"].toString().isEmpty());
 
   vtkMRMLStorableNode* node = vtkMRMLStorableNode::SafeDownCast(
     this->getNodeByID(properties["nodeID"].toString().toLatin1().data()));
   if (!this->canWriteObject(node))
     {
-    return false;
+    return 0;
     }
   vtkMRMLStorageNode* snode = node ? node->GetStorageNode() : 0;
   if (snode == 0 && node != 0)
@@ -145,7 +163,7 @@ bool qSlicerNodeWriter::write(const qSlicerIO::IOProperties& properties)
   if (snode == 0)
     {
     qDebug() << "No storage node for node" << properties["nodeID"].toString();
-    return false;
+    return 0;
     }
 
   Q_ASSERT(!properties["fileName"].toString().isEmpty());
@@ -160,14 +178,7 @@ bool qSlicerNodeWriter::write(const qSlicerIO::IOProperties& properties)
     {
     snode->SetUseCompression(properties["useCompression"].toInt());
     }
-  bool res = snode->WriteData(node);
-
-  if (res)
-    {
-    this->setWrittenNodes(QStringList() << node->GetID());
-    }
-
-  return res;
+  return node;
 }
 
 //-----------------------------------------------------------------------------
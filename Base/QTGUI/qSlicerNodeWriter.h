@@ -26,6 +26,7 @@
 #include "qSlicerFileWriter.h"
 class qSlicerNodeWriterPrivate;
 class vtkMRMLNode;
+class vtkMRMLStorableNode;
 
 /// Utility class that is ready to use for most of the nodes.
 class Q_SLICER_BASE_QTGUI_EXPORT qSlicerNodeWriter
@@ -64,6 +65,10 @@ public:
   /// Create a storage node if the storable node doesn't have any.
   virtual bool write(const qSlicerIO::IOProperties& properties);
 
+  /// Create and set up the storage node as write() does, without writing
+  /// the data.
+  virtual vtkMRMLStorableNode* prepareWrite(const qSlicerIO::IOProperties& properties);
+
   virtual vtkMRMLNode* getNodeByID(const char *id)const;
 
   /// Return a qSlicerIONodeWriterOptionsWidget
@@ -684,8 +684,13 @@ bool qSlicerSaveDataDialogPrivate::save()
 //-----------------------------------------------------------------------------
 bool qSlicerSaveDataDialogPrivate::saveNodes()
 {
+  qSlicerCoreIOManager* coreIOManager =
+    qSlicerCoreApplication::application()->coreIOManager();
+  Q_ASSERT(coreIOManager);
+
   QMessageBox::StandardButton forceOverwrite = QMessageBox::Ignore;
   QList<qSlicerIO::IOProperties> files;
+  QList<int> rows;
   const int sceneRow = this->findSceneRow();
   for (int row = 0; row < this->FileWidget->rowCount(); ++row)
     {
@@ -697,7 +702,6 @@ bool qSlicerSaveDataDialogPrivate::saveNodes()
 
     QTableWidgetItem* selectItem = this->FileWidget->item(row, SelectColumn);
     QTableWidgetItem* nodeNameItem = this->FileWidget->item(row, NodeNameColumn);
-    QTableWidgetItem* nodeStatusItem = this->FileWidget->item(row, NodeStatusColumn);
 
     Q_ASSERT(selectItem);
     Q_ASSERT(nodeNameItem);
@@ -754,9 +758,6 @@ bool qSlicerSaveDataDialogPrivate::saveNodes()
       }
 
     // save the node
-    qSlicerCoreIOManager* coreIOManager =
-      qSlicerCoreApplication::application()->coreIOManager();
-    Q_ASSERT(coreIOManager);
     qSlicerIO::IOFileType fileType = coreIOManager->fileWriterFileType(node);
     qSlicerIO::IOProperties savingParameters;
     if (options)
@@ -765,18 +766,29 @@ bool qSlicerSaveDataDialogPrivate::saveNodes()
       // \todo fileName is wrong as it contains an obsolete directory
       savingParameters = options->properties();
       }
+    savingParameters["fileType"] = fileType;
     savingParameters["nodeID"] = QString(node->GetID());
     savingParameters["fileName"] = file.absoluteFilePath();
     savingParameters["fileFormat"] = format;
-    bool res = coreIOManager->saveNodes(fileType, savingParameters);
+    files << savingParameters;
+    rows << row;
+    }
+
+  // The nodes are saved all at once: the data of the nodes with thread safe
+  // writers is written concurrently, nodes with unchanged data are skipped.
+  QList<qSlicerIO::IOProperties> failedFiles;
+  coreIOManager->saveNodes(files, &failedFiles);
 
+  for (int i = 0; i < files.count(); ++i)
+    {
     // node has failed to be written
-    if (!res)
+    if (failedFiles.contains(files[i]))
       {
       QMessageBox::StandardButton answer =
         QMessageBox::question(this, tr("Saving node..."),
                               tr("Cannot write data file: %1.\n"
-                                 "Do you want to continue saving?").arg(file.absoluteFilePath()),
+                                 "Do you want to continue saving?").arg(
+                                files[i]["fileName"].toString()),
                               QMessageBox::Yes | QMessageBox::No, QMessageBox::Yes);
       if (answer == QMessageBox::No)
         {
@@ -785,8 +797,8 @@ bool qSlicerSaveDataDialogPrivate::saveNodes()
       }
 
     // clean up node after saving
-    nodeNameItem->setCheckState(Qt::Unchecked);
-    nodeStatusItem->setText("Not Modified");
+    this->FileWidget->item(rows[i], NodeNameColumn)->setCheckState(Qt::Unchecked);
+    this->FileWidget->item(rows[i], NodeStatusColumn)->setText("Not Modified");
     }
   return true;
 }
@@ -67,6 +67,8 @@ public:
   PyObject*  PythonAPIMethods[1];
   PyObject * PythonSelf;
   QString    PythonSource;
+  bool       PythonSourceDeferred;
+  bool       HasFileDialog;
 };
 
 //-----------------------------------------------------------------------------
@@ -85,6 +87,8 @@ const char* qSlicerScriptedLoadableModulePrivate::APIMethodNames[1] =
 qSlicerScriptedLoadableModulePrivate::qSlicerScriptedLoadableModulePrivate()
 {
   this->PythonSelf = 0;
+  this->PythonSourceDeferred = false;
+  this->HasFileDialog = false;
   this->Hidden = false;
   this->Index = -1;
   for (int i = 0; i < Self::APIMethodCount; ++i)
@@ -214,7 +218,10 @@ bool qSlicerScriptedLoadableModule::setPythonSource(const QString& newPythonSour
     }
 
   d->PythonSource = newPythonSource;
+  d->PythonSourceDeferred = false;
   d->PythonSelf = self;
+  d->HasFileDialog = PyDict_GetItemString(
+    global_dict, QString(moduleName + "FileDialog").toLatin1()) != 0;
 
   QString instanceName = moduleName + QString("Instance");
 
@@ -239,10 +246,38 @@ bool qSlicerScriptedLoadableModule::setPythonSource(const QString& newPythonSour
   return true;
 }
 
+//-----------------------------------------------------------------------------
+void qSlicerScriptedLoadableModule::setDeferredPythonSource(const QString& newPythonSource)
+{
+  Q_D(qSlicerScriptedLoadableModule);
+  Q_ASSERT(!d->PythonSelf);
+  d->PythonSource = newPythonSource;
+  d->PythonSourceDeferred = true;
+}
+
+//-----------------------------------------------------------------------------
+bool qSlicerScriptedLoadableModule::isPythonSourceDeferred()const
+{
+  Q_D(const qSlicerScriptedLoadableModule);
+  return d->PythonSourceDeferred;
+}
+
+//-----------------------------------------------------------------------------
+bool qSlicerScriptedLoadableModule::requiresPythonAtLoad()const
+{
+  Q_D(const qSlicerScriptedLoadableModule);
+  return d->PythonAPIMethods[Pimpl::SetupMethod] != 0 || d->HasFileDialog;
+}
+
 //-----------------------------------------------------------------------------
 void qSlicerScriptedLoadableModule::setup()
 {
   Q_D(qSlicerScriptedLoadableModule);
+  if (d->PythonSourceDeferred)
+    {
+    // Nothing to setup, see requiresPythonAtLoad()
+    return;
+    }
   this->registerFileDialog();
   PyObject * method = d->PythonAPIMethods[Pimpl::SetupMethod];
   if (!method)
@@ -273,6 +308,12 @@ qSlicerAbstractModuleRepresentation* qSlicerScriptedLoadableModule::createWidget
 {
   Q_D(qSlicerScriptedLoadableModule);
 
+  // The module is shown for the first time, execute its python source.
+  if (d->PythonSourceDeferred && !this->setPythonSource(d->PythonSource))
+    {
+    return 0;
+    }
+
   QScopedPointer<qSlicerScriptedLoadableModuleWidget> widget(new qSlicerScriptedLoadableModuleWidget);
   bool ret = widget->setPythonSource(d->PythonSource);
   if (!ret)
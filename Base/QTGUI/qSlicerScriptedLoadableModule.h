@@ -56,6 +56,22 @@ public:
   QString pythonSource()const;
   bool setPythonSource(const QString& newPythonSource);
 
+  /// Set the python source without executing it. The source is executed
+  /// when the widget representation is first created.
+  /// The properties (title, categories...) are expected to be set from a cache.
+  /// Must only be used for modules that don't require python at load time.
+  /// \sa requiresPythonAtLoad(), isPythonSourceDeferred()
+  void setDeferredPythonSource(const QString& newPythonSource);
+
+  /// Return true if the python source has been set with
+  /// setDeferredPythonSource() and is not executed yet.
+  bool isPythonSourceDeferred()const;
+
+  /// Return true if the python class has a setup() method or if the python
+  /// source defines a file dialog. Such modules can't defer their source.
+  /// Only meaningful after setPythonSource().
+  bool requiresPythonAtLoad()const;
+
   virtual QString title()const ;
   void setTitle(const QString& newTitle);
 
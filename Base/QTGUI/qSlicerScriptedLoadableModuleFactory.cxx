@@ -19,6 +19,10 @@
 ==============================================================================*/
 
 // Qt includes
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
 #include <QSettings>
 
 // For:
@@ -37,6 +41,98 @@
 // For:
 //  - Slicer_QTSCRIPTEDMODULES_LIB_DIR
 
+namespace
+{
+
+//-----------------------------------------------------------------------------
+QString hashOf(const QString& text)
+{
+  return QString(QCryptographicHash::hash(
+    text.toUtf8(), QCryptographicHash::Sha1).toHex());
+}
+
+//-----------------------------------------------------------------------------
+QString metadataCacheDirectory()
+{
+  qSlicerCoreApplication * app = qSlicerCoreApplication::application();
+  QString settingsDirectory = app ?
+    QFileInfo(app->slicerRevisionUserSettingsFilePath()).absolutePath() :
+    QDir::tempPath();
+  return settingsDirectory + "/ScriptedModuleMetadata";
+}
+
+//-----------------------------------------------------------------------------
+/// Cache files of \a path are named <hash of the path>_<hash of the size and
+/// modification time>.ini
+QString metadataCacheFileName(const QString& path)
+{
+  QFileInfo fileInfo(path);
+  QString version = QString("%1 %2").arg(fileInfo.size()).arg(
+    fileInfo.lastModified().toTime_t());
+  return metadataCacheDirectory() + "/" +
+    hashOf(fileInfo.absoluteFilePath()) + "_" + hashOf(version) + ".ini";
+}
+
+//-----------------------------------------------------------------------------
+/// Properties of the module set by its python class
+QStringList cachedProperties()
+{
+  return QStringList() << "title" << "categories" << "contributors"
+    << "helpText" << "acknowledgementText" << "extensions" << "icon"
+    << "hidden" << "dependencies" << "index";
+}
+
+//-----------------------------------------------------------------------------
+/// Set the properties of \a module from the cache of its python source.
+/// Return false if the source isn't cached, has changed since or requires
+/// python when the module is loaded.
+bool restoreCachedMetadata(qSlicerScriptedLoadableModule* module, const QString& path)
+{
+  QString cacheFileName = metadataCacheFileName(path);
+  if (!QFile::exists(cacheFileName))
+    {
+    return false;
+    }
+  QSettings cache(cacheFileName, QSettings::IniFormat);
+  if (cache.value("requiresPythonAtLoad", true).toBool())
+    {
+    return false;
+    }
+  foreach(const QString& property, cachedProperties())
+    {
+    if (cache.contains(property))
+      {
+      module->setProperty(property.toLatin1(), cache.value(property));
+      }
+    }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void cacheMetadata(qSlicerScriptedLoadableModule* module, const QString& path)
+{
+  QDir cacheDirectory(metadataCacheDirectory());
+  if (!cacheDirectory.exists() && !QDir().mkpath(cacheDirectory.absolutePath()))
+    {
+    return;
+    }
+  QString cacheFileName = metadataCacheFileName(path);
+  QString pathHash = QFileInfo(cacheFileName).fileName().section('_', 0, 0);
+  foreach(const QString& oldFileName,
+          cacheDirectory.entryList(QStringList() << pathHash + "_*.ini", QDir::Files))
+    {
+    cacheDirectory.remove(oldFileName);
+    }
+  QSettings cache(cacheFileName, QSettings::IniFormat);
+  cache.setValue("requiresPythonAtLoad", module->requiresPythonAtLoad());
+  foreach(const QString& property, cachedProperties())
+    {
+    cache.setValue(property, module->property(property.toLatin1()));
+    }
+}
+
+}
+
 //----------------------------------------------------------------------------
 // ctkFactoryScriptedItem methods
 
@@ -73,6 +169,14 @@ qSlicerAbstractCoreModule* ctkFactoryScriptedItem::instanciator()
       qSlicerCorePythonManager * pythonManager = qSlicerCoreApplication::application()->corePythonManager();
       pythonManager->appendPythonPaths(QStringList() << modulePathWithoutIntDir.absolutePath());
       }
+
+    // The python source of modules that only need python for their widget
+    // is executed when the module is first shown.
+    if (restoreCachedMetadata(module.data(), this->path()))
+      {
+      module->setDeferredPythonSource(this->path());
+      return module.take();
+      }
     }
 #endif
 
@@ -81,6 +185,7 @@ qSlicerAbstractCoreModule* ctkFactoryScriptedItem::instanciator()
     {
     return 0;
     }
+  cacheMetadata(module.data(), this->path());
 
   return module.take();
 }
@@ -57,3 +57,37 @@ macro(SLICER_ADD_PYTHON_UNITTEST)
     )
   set_property(TEST py_${MY_TESTNAME_PREFIX}${test_name} PROPERTY RUN_SERIAL TRUE)
 endmacro()
+
+macro(SLICER_ADD_PYTHON_PERFORMANCE_TEST)
+  set(options)
+  set(oneValueArgs TESTNAME_PREFIX SCRIPT THRESHOLD BASELINE_BUILD)
+  set(multiValueArgs SLICER_ARGS)
+  cmake_parse_arguments(MY "${options}" "${oneValueArgs}" "${multiValueArgs}" ${ARGN})
+  get_filename_component(test_name ${MY_SCRIPT} NAME_WE)
+  get_filename_component(_script_source_dir ${MY_SCRIPT} PATH)
+  if("${_script_source_dir}" STREQUAL "")
+    set(_script_source_dir ${CMAKE_CURRENT_SOURCE_DIR})
+  endif()
+  if("${MY_THRESHOLD}" STREQUAL "")
+    set(MY_THRESHOLD 0.1)
+  endif()
+  set(_baseline_build "None")
+  if(NOT "${MY_BASELINE_BUILD}" STREQUAL "")
+    set(_baseline_build "'${MY_BASELINE_BUILD}'")
+  endif()
+  # The results of each build are appended to the history, the baseline is
+  # the previous build unless BASELINE_BUILD is given.
+  set(_history_file ${Slicer_BINARY_DIR}/Testing/Performance/${test_name}.json)
+  file(MAKE_DIRECTORY ${Slicer_BINARY_DIR}/Testing/Performance)
+  ExternalData_add_test(${Slicer_ExternalData_DATA_MANAGEMENT_TARGET}
+    NAME py_perf_${MY_TESTNAME_PREFIX}${test_name}
+    COMMAND ${Slicer_LAUNCHER_EXECUTABLE}
+    --no-splash
+    --testing
+    --ignore-slicerrc ${Slicer_ADDITIONAL_LAUNCHER_SETTINGS}
+    --python-code "import slicer.testing\\; slicer.testing.runPerformanceTest(['${CMAKE_CURRENT_BINARY_DIR}', '${_script_source_dir}'], '${test_name}', '${_history_file}', ${_baseline_build}, ${MY_THRESHOLD})"
+    ${MY_SLICER_ARGS}
+    )
+  set_property(TEST py_perf_${MY_TESTNAME_PREFIX}${test_name} PROPERTY RUN_SERIAL TRUE)
+  set_property(TEST py_perf_${MY_TESTNAME_PREFIX}${test_name} PROPERTY LABELS Performance)
+endmacro()
@@ -0,0 +1,14 @@
+#include "itkBrickIOPlugin.h"
+#include "itkBrickImageIOFactory.h"
+
+/**
+ * Routine that is called when the shared library is loaded by
+ * itk::ObjectFactoryBase::LoadDynamicFactories().
+ *
+ * itkLoad() is C (not C++) function.
+ */
+itk::ObjectFactoryBase * itkLoad()
+{
+  static itk::BrickImageIOFactory::Pointer f = itk::BrickImageIOFactory::New();
+  return f;
+}
@@ -0,0 +1,26 @@
+#ifndef __itkBrickIOPlugin_h
+#define __itkBrickIOPlugin_h
+
+#include "itkObjectFactoryBase.h"
+
+#ifdef WIN32
+#ifdef BrickIOPlugin_EXPORTS
+#define BrickIOPlugin_EXPORT __declspec(dllexport)
+#else
+#define BrickIOPlugin_EXPORT __declspec(dllimport)
+#endif
+#else
+#define BrickIOPlugin_EXPORT
+#endif
+
+/**
+ * Routine that is called when the shared library is loaded by
+ * itk::ObjectFactoryBase::LoadDynamicFactories().
+ *
+ * itkLoad() is C (not C++) function.
+ */
+extern "C" {
+BrickIOPlugin_EXPORT itk::ObjectFactoryBase * itkLoad();
+
+}
+#endif
@@ -0,0 +1,31 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+///  itkBrickIOWin32Header - manage Windows system differences
+///
+/// The itkBrickIOWin32Header captures some system differences between Unix
+/// and Windows operating systems.
+
+#ifndef __itkBrickIOWin32Header_h
+#define __itkBrickIOWin32Header_h
+
+#include <itkBrickImageIOConfigure.h>
+
+#if defined(WIN32) && !defined(BrickIO_STATIC)
+#if defined(BrickIO_EXPORTS)
+#define BrickImageIO_EXPORT __declspec( dllexport )
+#else
+#define BrickImageIO_EXPORT __declspec( dllimport )
+#endif
+#else
+#define BrickImageIO_EXPORT
+#endif
+
+#endif
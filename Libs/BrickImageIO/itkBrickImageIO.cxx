@@ -0,0 +1,690 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#include "itkBrickImageIO.h"
+
+// ITK includes
+#include "itkByteSwapper.h"
+#include "itkMultiThreader.h"
+#include <itk_zlib.h>
+#include <itksys/SystemTools.hxx>
+
+// STD includes
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+const char BrickVolumeMagic[] = "BRICKVOLUME0001";
+const char BrickVolumeExtension[] = ".bvol";
+
+//----------------------------------------------------------------------------
+/// Swap the bytes of \a numberOfComponents components between the system and
+/// the little endian byte order.
+void SwapBytes(void* buffer, size_t numberOfComponents,
+               itk::ImageIOBase::IOComponentType componentType)
+{
+  switch (componentType)
+    {
+    case itk::ImageIOBase::SHORT:
+    case itk::ImageIOBase::USHORT:
+      itk::ByteSwapper<unsigned short>::SwapRangeFromSystemToLittleEndian(
+        static_cast<unsigned short*>(buffer), numberOfComponents);
+      break;
+    case itk::ImageIOBase::INT:
+    case itk::ImageIOBase::UINT:
+      itk::ByteSwapper<unsigned int>::SwapRangeFromSystemToLittleEndian(
+        static_cast<unsigned int*>(buffer), numberOfComponents);
+      break;
+    case itk::ImageIOBase::LONG:
+    case itk::ImageIOBase::ULONG:
+      itk::ByteSwapper<unsigned long>::SwapRangeFromSystemToLittleEndian(
+        static_cast<unsigned long*>(buffer), numberOfComponents);
+      break;
+    case itk::ImageIOBase::FLOAT:
+      itk::ByteSwapper<float>::SwapRangeFromSystemToLittleEndian(
+        static_cast<float*>(buffer), numberOfComponents);
+      break;
+    case itk::ImageIOBase::DOUBLE:
+      itk::ByteSwapper<double>::SwapRangeFromSystemToLittleEndian(
+        static_cast<double*>(buffer), numberOfComponents);
+      break;
+    default:
+      break;
+    }
+}
+
+//----------------------------------------------------------------------------
+void WriteOffset(std::ostream& stream, std::streamoff offset)
+{
+  for (int i = 0; i < 8; ++i)
+    {
+    stream.put(static_cast<char>((offset >> (8 * i)) & 0xff));
+    }
+}
+
+//----------------------------------------------------------------------------
+std::streamoff ReadOffset(std::istream& stream)
+{
+  unsigned char bytes[8];
+  stream.read(reinterpret_cast<char*>(bytes), 8);
+  std::streamoff offset = 0;
+  for (int i = 7; i >= 0; --i)
+    {
+    offset = (offset << 8) | bytes[i];
+    }
+  return offset;
+}
+
+//----------------------------------------------------------------------------
+/// Geometry of the bricks of an image of up to 3 dimensions.
+struct BrickGridType
+{
+  BrickGridType(const size_t dimensions[3], size_t brickSize)
+  {
+    this->BrickSize = brickSize;
+    for (int i = 0; i < 3; ++i)
+      {
+      this->Dimensions[i] = dimensions[i];
+      this->NumberOfBricks[i] = (dimensions[i] + brickSize - 1) / brickSize;
+      }
+  }
+  size_t GetNumberOfBricks()const
+  {
+    return this->NumberOfBricks[0] * this->NumberOfBricks[1] *
+      this->NumberOfBricks[2];
+  }
+  /// Compute the first pixel and the number of pixels of a brick.
+  void GetBrickExtent(size_t brickIndex, size_t start[3], size_t size[3])const
+  {
+    size_t brick[3];
+    brick[0] = brickIndex % this->NumberOfBricks[0];
+    brick[1] = (brickIndex / this->NumberOfBricks[0]) % this->NumberOfBricks[1];
+    brick[2] = brickIndex / (this->NumberOfBricks[0] * this->NumberOfBricks[1]);
+    for (int i = 0; i < 3; ++i)
+      {
+      start[i] = brick[i] * this->BrickSize;
+      size[i] = std::min(this->BrickSize, this->Dimensions[i] - start[i]);
+      }
+  }
+  size_t Dimensions[3];
+  size_t NumberOfBricks[3];
+  size_t BrickSize;
+};
+
+//----------------------------------------------------------------------------
+/// Copy the pixels of the box \a size starting at \a sourceStart in the
+/// \a source buffer of dimensions \a sourceDimensions to \a destinationStart
+/// in \a destination of dimensions \a destinationDimensions.
+void CopyBox(const char* source, const size_t sourceDimensions[3],
+             const size_t sourceStart[3],
+             char* destination, const size_t destinationDimensions[3],
+             const size_t destinationStart[3],
+             const size_t size[3], size_t pixelSize)
+{
+  const size_t rowSize = size[0] * pixelSize;
+  for (size_t z = 0; z < size[2]; ++z)
+    {
+    for (size_t y = 0; y < size[1]; ++y)
+      {
+      const size_t sourceOffset = sourceStart[0] + sourceDimensions[0] *
+        (sourceStart[1] + y + sourceDimensions[1] * (sourceStart[2] + z));
+      const size_t destinationOffset = destinationStart[0] +
+        destinationDimensions[0] * (destinationStart[1] + y +
+        destinationDimensions[1] * (destinationStart[2] + z));
+      memcpy(destination + destinationOffset * pixelSize,
+             source + sourceOffset * pixelSize, rowSize);
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+struct BrickCompressionType
+{
+  BrickCompressionType(const size_t dimensions[3], size_t brickSize)
+    : Grid(dimensions, brickSize) {}
+  const char* Buffer;
+  size_t PixelSize;
+  size_t ComponentSize;
+  itk::ImageIOBase::IOComponentType ComponentType;
+  int Level;
+  BrickGridType Grid;
+  std::vector<std::vector<char> > Bricks;
+  std::vector<char> Compressed;
+};
+
+//----------------------------------------------------------------------------
+ITK_THREAD_RETURN_TYPE BrickCompressionCallback(void* arg)
+{
+  itk::MultiThreader::ThreadInfoStruct* info =
+    static_cast<itk::MultiThreader::ThreadInfoStruct*>(arg);
+  BrickCompressionType* compression =
+    static_cast<BrickCompressionType*>(info->UserData);
+  std::vector<char> brick;
+  for (size_t i = info->ThreadID; i < compression->Bricks.size();
+       i += info->NumberOfThreads)
+    {
+    size_t start[3];
+    size_t size[3];
+    compression->Grid.GetBrickExtent(i, start, size);
+    const size_t brickLength = size[0] * size[1] * size[2] *
+      compression->PixelSize;
+    brick.resize(brickLength);
+    const size_t origin[3] = {0, 0, 0};
+    CopyBox(compression->Buffer, compression->Grid.Dimensions, start,
+            &brick[0], size, origin, size, compression->PixelSize);
+    SwapBytes(&brick[0], brickLength / compression->ComponentSize,
+              compression->ComponentType);
+
+    std::vector<char>& compressed = compression->Bricks[i];
+    uLongf compressedLength = compressBound(static_cast<uLong>(brickLength));
+    compressed.resize(compressedLength);
+    compression->Compressed[i] =
+      (compress2(reinterpret_cast<Bytef*>(&compressed[0]), &compressedLength,
+                 reinterpret_cast<const Bytef*>(&brick[0]),
+                 static_cast<uLong>(brickLength),
+                 compression->Level) == Z_OK);
+    compressed.resize(compressedLength);
+    }
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+} // end of anonymous namespace
+
+namespace itk
+{
+
+//----------------------------------------------------------------------------
+BrickImageIO::BrickImageIO()
+{
+  this->m_BrickSize = 32;
+  this->m_CompressionLevel = Z_DEFAULT_COMPRESSION;
+  this->m_CacheSize = 64 * 1024 * 1024;
+  this->m_DataOffset = 0;
+  this->m_CacheUsedSize = 0;
+  this->m_NumberOfBricks[0] = this->m_NumberOfBricks[1] =
+    this->m_NumberOfBricks[2] = 0;
+  this->AddSupportedReadExtension(BrickVolumeExtension);
+  this->AddSupportedWriteExtension(BrickVolumeExtension);
+}
+
+//----------------------------------------------------------------------------
+BrickImageIO::~BrickImageIO()
+{
+}
+
+//----------------------------------------------------------------------------
+void BrickImageIO::PrintSelf(std::ostream& os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "BrickSize: " << this->m_BrickSize << std::endl;
+  os << indent << "CompressionLevel: " << this->m_CompressionLevel << std::endl;
+  os << indent << "CacheSize: " << this->m_CacheSize << std::endl;
+}
+
+//----------------------------------------------------------------------------
+bool BrickImageIO::CanReadFile(const char* fileNameToRead)
+{
+  if (!fileNameToRead ||
+      itksys::SystemTools::GetFilenameLastExtension(fileNameToRead) !=
+      BrickVolumeExtension)
+    {
+    return false;
+    }
+  std::ifstream file(fileNameToRead, std::ios::in | std::ios::binary);
+  std::string magic;
+  std::getline(file, magic);
+  return file.good() && magic == BrickVolumeMagic;
+}
+
+//----------------------------------------------------------------------------
+bool BrickImageIO::CanWriteFile(const char* fileNameToWrite)
+{
+  return fileNameToWrite &&
+    itksys::SystemTools::GetFilenameLastExtension(fileNameToWrite) ==
+    BrickVolumeExtension;
+}
+
+//----------------------------------------------------------------------------
+void BrickImageIO::ClearBricks()
+{
+  this->m_BrickOffsets.clear();
+  this->m_BrickFileName.clear();
+  this->m_Cache.clear();
+  this->m_CacheIndex.clear();
+  this->m_CacheUsedSize = 0;
+}
+
+//----------------------------------------------------------------------------
+void BrickImageIO::ReadImageInformation()
+{
+  this->ClearBricks();
+
+  std::ifstream file(this->m_FileName.c_str(), std::ios::in | std::ios::binary);
+  std::string line;
+  std::getline(file, line);
+  if (!file.good() || line != BrickVolumeMagic)
+    {
+    itkExceptionMacro(<< "Can't read brick volume file: " << this->m_FileName);
+    }
+
+  unsigned int dimension = 0;
+  size_t numberOfBricks = 0;
+  unsigned int componentSize = 0;
+  std::string componentType;
+  std::string pixelType;
+  std::string encoding;
+  while (std::getline(file, line) && !line.empty())
+    {
+    std::string::size_type separator = line.find(": ");
+    if (separator == std::string::npos)
+      {
+      itkExceptionMacro(<< "Malformed header line \"" << line << "\" in "
+                        << this->m_FileName);
+      }
+    std::string key = line.substr(0, separator);
+    std::istringstream value(line.substr(separator + 2));
+    if (key == "dimension")
+      {
+      value >> dimension;
+      if (dimension < 1 || dimension > 3)
+        {
+        itkExceptionMacro(<< "Unsupported dimension " << dimension
+                          << " in " << this->m_FileName);
+        }
+      this->SetNumberOfDimensions(dimension);
+      }
+    else if (key == "sizes" || key == "spacings" || key == "origin")
+      {
+      for (unsigned int i = 0; i < dimension; ++i)
+        {
+        double v = 0.;
+        value >> v;
+        if (key == "sizes")
+          {
+          this->SetDimensions(i, static_cast<unsigned long>(v));
+          }
+        else if (key == "spacings")
+          {
+          this->SetSpacing(i, v);
+          }
+        else
+          {
+          this->SetOrigin(i, v);
+          }
+        }
+      }
+    else if (key.compare(0, 10, "direction ") == 0)
+      {
+      unsigned int axis = atoi(key.substr(10).c_str());
+      std::vector<double> direction(dimension, 0.);
+      for (unsigned int i = 0; i < dimension; ++i)
+        {
+        value >> direction[i];
+        }
+      if (axis < dimension)
+        {
+        this->SetDirection(axis, direction);
+        }
+      }
+    else if (key == "component type")
+      {
+      value >> componentType;
+      }
+    else if (key == "component size")
+      {
+      value >> componentSize;
+      }
+    else if (key == "pixel type")
+      {
+      value >> pixelType;
+      }
+    else if (key == "components")
+      {
+      unsigned int components = 1;
+      value >> components;
+      this->SetNumberOfComponents(components);
+      }
+    else if (key == "brick size")
+      {
+      value >> this->m_BrickSize;
+      }
+    else if (key == "bricks")
+      {
+      value >> numberOfBricks;
+      }
+    else if (key == "encoding")
+      {
+      value >> encoding;
+      }
+    if (value.fail())
+      {
+      itkExceptionMacro(<< "Malformed header line \"" << line << "\" in "
+                        << this->m_FileName);
+      }
+    }
+
+  this->SetComponentType(UNKNOWNCOMPONENTTYPE);
+  for (int type = UCHAR; type <= DOUBLE; ++type)
+    {
+    if (this->GetComponentTypeAsString(static_cast<IOComponentType>(type)) ==
+        componentType)
+      {
+      this->SetComponentType(static_cast<IOComponentType>(type));
+      }
+    }
+  this->SetPixelType(UNKNOWNPIXELTYPE);
+  for (int type = SCALAR; type <= MATRIX; ++type)
+    {
+    if (this->GetPixelTypeAsString(static_cast<IOPixelType>(type)) == pixelType)
+      {
+      this->SetPixelType(static_cast<IOPixelType>(type));
+      }
+    }
+  if (this->GetComponentType() == UNKNOWNCOMPONENTTYPE ||
+      this->GetPixelType() == UNKNOWNPIXELTYPE ||
+      componentSize != this->GetComponentSize())
+    {
+    itkExceptionMacro(<< "Unsupported pixel type " << pixelType << " of "
+                      << componentType << " (" << componentSize
+                      << " bytes) in " << this->m_FileName);
+    }
+  if (encoding != "zlib" || this->m_BrickSize == 0)
+    {
+    itkExceptionMacro(<< "Unsupported encoding " << encoding << " in "
+                      << this->m_FileName);
+    }
+
+  size_t dimensions[3] = {1, 1, 1};
+  for (unsigned int i = 0; i < dimension; ++i)
+    {
+    dimensions[i] = this->GetDimensions(i);
+    }
+  BrickGridType grid(dimensions, this->m_BrickSize);
+  if (numberOfBricks != grid.GetNumberOfBricks())
+    {
+    itkExceptionMacro(<< "Wrong number of bricks in " << this->m_FileName);
+    }
+  for (int i = 0; i < 3; ++i)
+    {
+    this->m_NumberOfBricks[i] = grid.NumberOfBricks[i];
+    }
+
+  this->m_BrickOffsets.resize(numberOfBricks + 1);
+  for (size_t i = 0; i <= numberOfBricks; ++i)
+    {
+    this->m_BrickOffsets[i] = ReadOffset(file);
+    }
+  this->m_DataOffset = file.tellg();
+  if (!file.good())
+    {
+    this->ClearBricks();
+    itkExceptionMacro(<< "Can't read the brick index of " << this->m_FileName);
+    }
+  this->m_BrickFileName = this->m_FileName;
+}
+
+//----------------------------------------------------------------------------
+const char* BrickImageIO::GetBrick(std::ifstream& file, size_t brickIndex)
+{
+  std::map<size_t, CacheType::iterator>::iterator cached =
+    this->m_CacheIndex.find(brickIndex);
+  if (cached != this->m_CacheIndex.end())
+    {
+    // Move the brick at the front of the cache
+    this->m_Cache.splice(this->m_Cache.begin(), this->m_Cache, cached->second);
+    return &this->m_Cache.front().second[0];
+    }
+
+  size_t dimensions[3] = {1, 1, 1};
+  for (unsigned int i = 0; i < this->GetNumberOfDimensions(); ++i)
+    {
+    dimensions[i] = this->GetDimensions(i);
+    }
+  BrickGridType grid(dimensions, this->m_BrickSize);
+  size_t start[3];
+  size_t size[3];
+  grid.GetBrickExtent(brickIndex, start, size);
+  const size_t numberOfComponents = size[0] * size[1] * size[2] *
+    this->GetNumberOfComponents();
+  uLongf brickLength = static_cast<uLongf>(
+    numberOfComponents * this->GetComponentSize());
+
+  const std::streamoff compressedLength =
+    this->m_BrickOffsets[brickIndex + 1] - this->m_BrickOffsets[brickIndex];
+  std::vector<char> compressed(static_cast<size_t>(compressedLength));
+  file.seekg(this->m_DataOffset + this->m_BrickOffsets[brickIndex]);
+  file.read(&compressed[0], compressedLength);
+  if (!file.good())
+    {
+    itkExceptionMacro(<< "Can't read brick " << brickIndex << " of "
+                      << this->m_FileName);
+    }
+
+  this->m_Cache.push_front(std::make_pair(brickIndex, std::vector<char>()));
+  std::vector<char>& brick = this->m_Cache.front().second;
+  brick.resize(brickLength);
+  const uLongf expectedLength = brickLength;
+  if (uncompress(reinterpret_cast<Bytef*>(&brick[0]), &brickLength,
+                 reinterpret_cast<const Bytef*>(&compressed[0]),
+                 static_cast<uLong>(compressedLength)) != Z_OK ||
+      brickLength != expectedLength)
+    {
+    this->m_Cache.pop_front();
+    itkExceptionMacro(<< "Can't decompress brick " << brickIndex << " of "
+                      << this->m_FileName);
+    }
+  SwapBytes(&brick[0], numberOfComponents, this->GetComponentType());
+  this->m_CacheIndex[brickIndex] = this->m_Cache.begin();
+  this->m_CacheUsedSize += brickLength;
+
+  // Evict the least recently used bricks, but the requested one
+  while (this->m_CacheUsedSize > this->m_CacheSize && this->m_Cache.size() > 1)
+    {
+    this->m_CacheUsedSize -= this->m_Cache.back().second.size();
+    this->m_CacheIndex.erase(this->m_Cache.back().first);
+    this->m_Cache.pop_back();
+    }
+  return &brick[0];
+}
+
+//----------------------------------------------------------------------------
+void BrickImageIO::Read(void* buffer)
+{
+  if (this->m_BrickFileName != this->m_FileName)
+    {
+    this->ReadImageInformation();
+    }
+  std::ifstream file(this->m_FileName.c_str(), std::ios::in | std::ios::binary);
+  if (!file.good())
+    {
+    itkExceptionMacro(<< "Can't find/open file: " << this->m_FileName);
+    }
+
+  const ImageIORegion& ioRegion = this->GetIORegion();
+  size_t regionStart[3] = {0, 0, 0};
+  size_t regionSize[3] = {1, 1, 1};
+  for (unsigned int i = 0;
+       i < std::min<size_t>(3, ioRegion.GetIndex().size()); ++i)
+    {
+    regionStart[i] = ioRegion.GetIndex()[i];
+    regionSize[i] = ioRegion.GetSize()[i];
+    }
+  for (int i = 0; i < 3; ++i)
+    {
+    if (regionSize[i] == 0)
+      {
+      return;
+      }
+    }
+  const size_t pixelSize =
+    this->GetComponentSize() * this->GetNumberOfComponents();
+  size_t dimensions[3] = {1, 1, 1};
+  for (unsigned int i = 0; i < this->GetNumberOfDimensions(); ++i)
+    {
+    dimensions[i] = this->GetDimensions(i);
+    }
+  BrickGridType grid(dimensions, this->m_BrickSize);
+
+  size_t firstBrick[3];
+  size_t lastBrick[3];
+  for (int i = 0; i < 3; ++i)
+    {
+    firstBrick[i] = regionStart[i] / this->m_BrickSize;
+    lastBrick[i] = (regionStart[i] + regionSize[i] - 1) / this->m_BrickSize;
+    }
+  for (size_t bz = firstBrick[2]; bz <= lastBrick[2]; ++bz)
+    {
+    for (size_t by = firstBrick[1]; by <= lastBrick[1]; ++by)
+      {
+      for (size_t bx = firstBrick[0]; bx <= lastBrick[0]; ++bx)
+        {
+        const size_t brickIndex = bx + grid.NumberOfBricks[0] *
+          (by + grid.NumberOfBricks[1] * bz);
+        size_t brickStart[3];
+        size_t brickSize[3];
+        grid.GetBrickExtent(brickIndex, brickStart, brickSize);
+        // Intersection of the brick and the region
+        size_t sourceStart[3];
+        size_t destinationStart[3];
+        size_t size[3];
+        for (int i = 0; i < 3; ++i)
+          {
+          const size_t start = std::max(brickStart[i], regionStart[i]);
+          const size_t end = std::min(brickStart[i] + brickSize[i],
+                                      regionStart[i] + regionSize[i]);
+          sourceStart[i] = start - brickStart[i];
+          destinationStart[i] = start - regionStart[i];
+          size[i] = end - start;
+          }
+        const char* brick = this->GetBrick(file, brickIndex);
+        CopyBox(brick, brickSize, sourceStart,
+                static_cast<char*>(buffer), regionSize, destinationStart,
+                size, pixelSize);
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void BrickImageIO::Write(const void* buffer)
+{
+  const unsigned int dimension = this->GetNumberOfDimensions();
+  if (dimension < 1 || dimension > 3)
+    {
+    itkExceptionMacro(<< "BrickImageIO supports images of 1 to 3 dimensions");
+    }
+  if (this->m_BrickSize == 0)
+    {
+    itkExceptionMacro(<< "Invalid brick size");
+    }
+  // The written file replaces the one the bricks were read from.
+  this->ClearBricks();
+
+  size_t dimensions[3] = {1, 1, 1};
+  for (unsigned int i = 0; i < dimension; ++i)
+    {
+    dimensions[i] = this->GetDimensions(i);
+    }
+  BrickCompressionType compression(dimensions, this->m_BrickSize);
+  compression.Buffer = static_cast<const char*>(buffer);
+  compression.PixelSize =
+    this->GetComponentSize() * this->GetNumberOfComponents();
+  compression.ComponentSize = this->GetComponentSize();
+  compression.ComponentType = this->GetComponentType();
+  compression.Level = this->m_CompressionLevel;
+  compression.Bricks.resize(compression.Grid.GetNumberOfBricks());
+  compression.Compressed.resize(compression.Grid.GetNumberOfBricks(), 0);
+
+  MultiThreader::Pointer threader = MultiThreader::New();
+  threader->SetNumberOfThreads(static_cast<int>(std::min<size_t>(
+    threader->GetNumberOfThreads(),
+    std::max<size_t>(1, compression.Bricks.size()))));
+  threader->SetSingleMethod(BrickCompressionCallback, &compression);
+  threader->SingleMethodExecute();
+  for (size_t i = 0; i < compression.Bricks.size(); ++i)
+    {
+    if (!compression.Compressed[i])
+      {
+      itkExceptionMacro(<< "Can't compress brick " << i << " of "
+                        << this->m_FileName);
+      }
+    }
+
+  std::ofstream file(this->m_FileName.c_str(),
+                     std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!file.good())
+    {
+    itkExceptionMacro(<< "Can't open file for writing: " << this->m_FileName);
+    }
+  file.precision(17);
+  file << BrickVolumeMagic << "\n";
+  file << "dimension: " << dimension << "\n";
+  file << "sizes:";
+  for (unsigned int i = 0; i < dimension; ++i)
+    {
+    file << " " << this->GetDimensions(i);
+    }
+  file << "\nspacings:";
+  for (unsigned int i = 0; i < dimension; ++i)
+    {
+    file << " " << this->GetSpacing(i);
+    }
+  file << "\norigin:";
+  for (unsigned int i = 0; i < dimension; ++i)
+    {
+    file << " " << this->GetOrigin(i);
+    }
+  file << "\n";
+  for (unsigned int i = 0; i < dimension; ++i)
+    {
+    std::vector<double> direction = this->GetDirection(i);
+    file << "direction " << i << ":";
+    for (unsigned int j = 0; j < dimension; ++j)
+      {
+      file << " " << (j < direction.size() ? direction[j] : 0.);
+      }
+    file << "\n";
+    }
+  file << "component type: "
+       << this->GetComponentTypeAsString(this->GetComponentType()) << "\n";
+  file << "component size: " << this->GetComponentSize() << "\n";
+  file << "pixel type: "
+       << this->GetPixelTypeAsString(this->GetPixelType()) << "\n";
+  file << "components: " << this->GetNumberOfComponents() << "\n";
+  file << "brick size: " << this->m_BrickSize << "\n";
+  file << "bricks: " << compression.Bricks.size() << "\n";
+  file << "encoding: zlib\n";
+  file << "\n";
+
+  std::streamoff offset = 0;
+  for (size_t i = 0; i < compression.Bricks.size(); ++i)
+    {
+    WriteOffset(file, offset);
+    offset += compression.Bricks[i].size();
+    }
+  WriteOffset(file, offset);
+  for (size_t i = 0; i < compression.Bricks.size(); ++i)
+    {
+    file.write(&compression.Bricks[i][0], compression.Bricks[i].size());
+    }
+  file.close();
+  if (file.fail())
+    {
+    itkExceptionMacro(<< "Can't write file: " << this->m_FileName);
+    }
+}
+
+} // end namespace itk
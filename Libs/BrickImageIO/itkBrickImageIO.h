@@ -0,0 +1,139 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#ifndef __itkBrickImageIO_h
+#define __itkBrickImageIO_h
+
+#include "itkBrickIOWin32Header.h"
+
+// ITK includes
+#include "itkImageIOBase.h"
+
+// STD includes
+#include <fstream>
+#include <list>
+#include <map>
+#include <vector>
+
+namespace itk
+{
+
+/// \brief ImageIO for volumes stored as independently compressed bricks.
+///
+/// A brick volume file (.bvol) starts with a text header made of
+/// "key: value" lines ended by an empty line. It is followed by the index
+/// of the bricks (offset and size of each brick, 64 bits little endian
+/// integers) and then by the bricks. A brick is a BrickSize^3 block of the
+/// image (smaller on the borders) whose pixels are stored little endian and
+/// compressed with zlib.
+///
+/// Only the bricks intersecting the requested region are read and
+/// decompressed (see CanStreamRead()). The last decompressed bricks are kept
+/// in a least recently used cache of CacheSize bytes so that the bricks
+/// shared by consecutive streamed regions are decompressed once.
+class BrickImageIO_EXPORT BrickImageIO : public ImageIOBase
+{
+public:
+  typedef BrickImageIO       Self;
+  typedef ImageIOBase        Superclass;
+  typedef SmartPointer<Self> Pointer;
+
+  /** Method for creation through the object factory **/
+  itkNewMacro(Self);
+  /** RTTI (and related methods) **/
+  itkTypeMacro(BrickImageIO, Superclass);
+
+  /** Number of pixels along each axis of a brick when writing. Default 32. */
+  itkSetMacro(BrickSize, unsigned int);
+  itkGetConstMacro(BrickSize, unsigned int);
+
+  /** zlib compression level of the bricks when writing, -1 (default) for
+   * the zlib default level. */
+  itkSetMacro(CompressionLevel, int);
+  itkGetConstMacro(CompressionLevel, int);
+
+  /** Maximum number of bytes of decompressed bricks kept between reads.
+   * Default is 64MB. */
+  itkSetMacro(CacheSize, unsigned long);
+  itkGetConstMacro(CacheSize, unsigned long);
+
+  /** Images of 1 to 3 dimensions are supported. */
+  virtual bool SupportsDimension(unsigned long dimension)
+  {
+    return dimension >= 1 && dimension <= 3;
+  }
+
+  /**--------------- Read the data----------------- **/
+  virtual bool CanReadFile(const char* fileNameToRead);
+
+  /** Any region can be read without reading the whole file. */
+  virtual bool CanStreamRead()
+  {
+    return true;
+  }
+
+  /* Set the spacing and dimension information for the set file name */
+  virtual void ReadImageInformation();
+
+  /* Read the IORegion from the disk into provided memory buffer */
+  virtual void Read(void* buffer);
+
+  /**---------------Write the data------------------**/
+  virtual bool CanWriteFile(const char* fileNameToWrite);
+
+  /* Nothing to do, the header is written with the data */
+  virtual void WriteImageInformation() {}
+
+  /* Write the whole image to the disk from the provided memory buffer */
+  virtual void Write(const void* buffer);
+
+protected:
+  BrickImageIO();
+  ~BrickImageIO();
+  void PrintSelf(std::ostream& os, Indent indent) const;
+
+  /// Reset the index and the cache of the bricks.
+  void ClearBricks();
+
+  /// Return the decompressed pixels of the brick \a brickIndex.
+  /// The returned buffer is valid until the next call.
+  const char* GetBrick(std::ifstream& file, size_t brickIndex);
+
+  /// Number of pixels along each axis of the bricks of the file or of the
+  /// bricks to write.
+  unsigned int m_BrickSize;
+  int m_CompressionLevel;
+  unsigned long m_CacheSize;
+
+  /// Number of bricks along each axis (always 3)
+  size_t m_NumberOfBricks[3];
+  /// Position in the file of the first brick
+  std::streamoff m_DataOffset;
+  /// Offsets of the bricks relative to m_DataOffset, followed by the end
+  /// of the last brick
+  std::vector<std::streamoff> m_BrickOffsets;
+  /// File the index and the cache were read from
+  std::string m_BrickFileName;
+
+  typedef std::list<std::pair<size_t, std::vector<char> > > CacheType;
+  /// Decompressed bricks, most recently used first
+  CacheType m_Cache;
+  std::map<size_t, CacheType::iterator> m_CacheIndex;
+  unsigned long m_CacheUsedSize;
+
+private:
+  BrickImageIO(const Self &); /// purposely not implemented
+  void operator=(const Self &); /// purposely not implemented
+};
+
+} // end namespace itk
+
+#endif // __itkBrickImageIO_h
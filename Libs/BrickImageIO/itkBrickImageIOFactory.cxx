@@ -0,0 +1,34 @@
+
+#include "itkBrickImageIOFactory.h"
+#include "itkBrickImageIO.h"
+#include "itkVersion.h"
+
+namespace itk
+{
+
+BrickImageIOFactory::BrickImageIOFactory()
+{
+  this->RegisterOverride("itkImageIOBase",
+                         "itkBrickImageIO",
+                         "Brick Image IO",
+                         1,
+                         CreateObjectFunction<BrickImageIO>::New() );
+}
+
+BrickImageIOFactory::~BrickImageIOFactory()
+{
+}
+
+const char *
+BrickImageIOFactory::GetITKSourceVersion(void) const
+{
+  return ITK_SOURCE_VERSION;
+}
+
+const char *
+BrickImageIOFactory::GetDescription() const
+{
+  return "Brick ImageIO Factory, allows the streamed loading of brick volumes (.bvol) into Insight";
+}
+
+} // end namespace itk
@@ -0,0 +1,51 @@
+
+#ifndef H_ITK_BRICK_IMAGE_IO_FACTORY_H
+#define H_ITK_BRICK_IMAGE_IO_FACTORY_H
+
+#include "itkObjectFactoryBase.h"
+#include "itkImageIOBase.h"
+
+#include "itkBrickIOWin32Header.h"
+
+namespace itk
+{
+
+class BrickImageIO_EXPORT BrickImageIOFactory : public ObjectFactoryBase
+{
+public:
+  /** Standard class typedefs **/
+  typedef BrickImageIOFactory        Self;
+  typedef ObjectFactoryBase        Superclass;
+  typedef SmartPointer<Self>       Pointer;
+  typedef SmartPointer<const Self> ConstPointer;
+
+  /** Class methods used to interface with the registered factories **/
+  virtual const char * GetITKSourceVersion(void) const;
+
+  virtual const char * GetDescription(void)  const;
+
+  /** Method for class instantiation **/
+  itkFactorylessNewMacro(Self);
+
+  /** RTTI (and related methods) **/
+  itkTypeMacro(BrickImageIOFactory, ObjectFactoryBase);
+
+  /** Register one factory of this type **/
+  static void RegisterOneFactory(void)
+  {
+    BrickImageIOFactory::Pointer brickFactory = BrickImageIOFactory::New();
+    ObjectFactoryBase::RegisterFactory(brickFactory.GetPointer() );
+  }
+
+protected:
+  BrickImageIOFactory();
+  ~BrickImageIOFactory();
+private:
+  BrickImageIOFactory(const Self &); /// purposely not implemented
+  void operator=(const Self &);    /// purposely not implemented
+
+}; /// end class BrickImageIOFactory
+
+} /// end namespace itk
+
+#endif /// H_ITK_BRICK_IMAGE_IO_FACTORY_H
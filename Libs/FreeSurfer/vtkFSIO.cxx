@@ -18,6 +18,10 @@
 // VTK includes
 #include <vtkByteSwap.h>
 
+// STD includes
+#include <algorithm>
+#include <vector>
+
 //------------------------------------------------------------------------------
 int vtkFSIO::ReadShort (FILE* iFile, short& oShort) {
 
@@ -157,6 +161,73 @@ int vtkFSIO::ReadFloatZ (gzFile iFile, float& oFloat) {
   return result;
 }
 
+//------------------------------------------------------------------------------
+int vtkFSIO::ReadShortArray (FILE* iFile, short* oArray, int n) {
+
+  if (n <= 0) {
+    return 0;
+  }
+  // Read all the shorts, then swap them in place.
+  int result = static_cast<int>(fread (oArray, sizeof(short), n, iFile));
+  vtkByteSwap::Swap2BERange (oArray, result);
+
+  return result;
+}
+
+//------------------------------------------------------------------------------
+int vtkFSIO::ReadIntArray (FILE* iFile, int* oArray, int n) {
+
+  if (n <= 0) {
+    return 0;
+  }
+  // Read all the ints, then swap them in place.
+  int result = static_cast<int>(fread (oArray, sizeof(int), n, iFile));
+  vtkByteSwap::Swap4BERange (oArray, result);
+
+  return result;
+}
+
+//------------------------------------------------------------------------------
+int vtkFSIO::ReadInt3Array (FILE* iFile, int* oArray, int n) {
+
+  if (n <= 0) {
+    return 0;
+  }
+  // Read the three byte ints by chunks and assemble them, they are big
+  // endian whatever the platform is.
+  const int chunkSize = 65536;
+  std::vector<unsigned char> buffer (3 * std::min(n, chunkSize));
+  int result = 0;
+  while (result < n) {
+    int count = std::min(n - result, chunkSize);
+    int read = static_cast<int>(fread (&buffer[0], 3, count, iFile));
+    const unsigned char* bytes = &buffer[0];
+    int* values = oArray + result;
+    for (int i = 0; i < read; ++i, bytes += 3) {
+      values[i] = (bytes[0] << 16) | (bytes[1] << 8) | bytes[2];
+    }
+    result += read;
+    if (read != count) {
+      break;
+    }
+  }
+
+  return result;
+}
+
+//------------------------------------------------------------------------------
+int vtkFSIO::ReadFloatArray (FILE* iFile, float* oArray, int n) {
+
+  if (n <= 0) {
+    return 0;
+  }
+  // Read all the floats, then swap them in place.
+  int result = static_cast<int>(fread (oArray, sizeof(float), n, iFile));
+  vtkByteSwap::Swap4BERange (oArray, result);
+
+  return result;
+}
+
 //------------------------------------------------------------------------------
 // Utility methods for writing test files
 
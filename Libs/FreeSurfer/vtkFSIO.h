@@ -37,6 +37,14 @@ namespace vtkFSIO {
   int VTK_FreeSurfer_EXPORT ReadInt2 (FILE* iFile, int& oInt);
   int VTK_FreeSurfer_EXPORT ReadFloat (FILE* iFile, float& oFloat);
 
+  /// Read \a n values with a single fread, swap them if we need to and
+  /// return the number of values read. These are much faster than
+  /// reading whole blocks of vertices or faces one value at a time.
+  int VTK_FreeSurfer_EXPORT ReadShortArray (FILE* iFile, short* oArray, int n);
+  int VTK_FreeSurfer_EXPORT ReadIntArray (FILE* iFile, int* oArray, int n);
+  int VTK_FreeSurfer_EXPORT ReadInt3Array (FILE* iFile, int* oArray, int n);
+  int VTK_FreeSurfer_EXPORT ReadFloatArray (FILE* iFile, float* oArray, int n);
+
   int VTK_FreeSurfer_EXPORT ReadShortZ (gzFile iFile, short& oShort);
   int VTK_FreeSurfer_EXPORT ReadIntZ (gzFile iFile, int& oInt);
   int VTK_FreeSurfer_EXPORT ReadInt3Z (gzFile iFile, int& oInt);
@@ -21,6 +21,10 @@
 #include <vtkLookupTable.h>
 #include <vtkObjectFactory.h>
 
+// STD includes
+#include <map>
+#include <vector>
+
 //-------------------------------------------------------------------------
 vtkStandardNewMacro(vtkFSSurfaceAnnotationReader);
 
@@ -149,45 +153,29 @@ int vtkFSSurfaceAnnotationReader::ReadFSAnnotation()
   // table stuff.
   totalSteps = numLabels*2;
 
-  for (labelIndex = 0; labelIndex < numLabels; labelIndex ++ )
+  // The file holds a (vertex index, rgb) pair per label, read them all
+  // at once and set the appropriate values in the rgb array.
+  std::vector<int> labelPairs (2 * static_cast<size_t>(numLabels));
+  read = vtkFSIO::ReadIntArray (annotFile, &labelPairs[0], 2 * numLabels);
+  if (read != 2 * numLabels)
   {
-      if (feof (annotFile) )
-      {
-          vtkErrorMacro (<< "\nReadFSAnnotation: unexpected EOF after\n "
-                         << numLabels << " values read.");
-          fclose (annotFile);
-          free (rgbs);
-          free (labels);
-          return vtkFSSurfaceAnnotationReader::FS_ERROR_PARSING_ANNOTATION;
-      }
+      vtkErrorMacro (<< "\nReadFSAnnotation: unexpected EOF after\n "
+                     << read / 2 << " values read.");
+      fclose (annotFile);
+      free (rgbs);
+      free (labels);
+      return vtkFSSurfaceAnnotationReader::FS_ERROR_PARSING_ANNOTATION;
+  }
 
-      // Read a vertex index and an rgb value. Set the appropriate
-      // value in the rgb array.
-      read = vtkFSIO::ReadInt (annotFile, vertexIndex);
-      if (read != 1)
-      {
-          vtkErrorMacro (<< "\nReadFSAnnotation: error reading vertex index at\n"
-                         << labelIndex);
-          fclose (annotFile);
-          free (rgbs);
-          free (labels);
-          return vtkFSSurfaceAnnotationReader::FS_ERROR_PARSING_ANNOTATION;
-      }
-      read = vtkFSIO::ReadInt (annotFile, rgb);
-      if (read != 1)
-      {
-          vtkErrorMacro (<< "\nReadFSAnnotation: error reading rgb value at\n"
-                         << labelIndex);
-          fclose (annotFile);
-          free (rgbs);
-          free (labels);
-          return vtkFSSurfaceAnnotationReader::FS_ERROR_PARSING_ANNOTATION;
-      }
+  for (labelIndex = 0; labelIndex < numLabels; labelIndex ++ )
+  {
+      vertexIndex = labelPairs[2 * labelIndex];
+      rgb = labelPairs[2 * labelIndex + 1];
       if (labelIndex < 100)
       {
           vtkDebugMacro(<< "ReadFSAnnotation: Read vertex # " << vertexIndex << " rgb = " << rgb << endl);
       }
-      if (vertexIndex >= numLabels)
+      if (vertexIndex < 0 || vertexIndex >= numLabels)
         {
         vtkErrorMacro("ReadFSAnnotation: Read vertex # " << vertexIndex << " is out of bounds! Not in 0 to " << numLabels << " -1, rgb = " << rgb << endl);
         }
@@ -195,12 +183,9 @@ int vtkFSSurfaceAnnotationReader::ReadFSAnnotation()
         {
         rgbs[vertexIndex] = rgb;
         }
-    thisStep++;
-    if (thisStep % 1000 == 0)
-    {
-        this->UpdateProgress(1.0*thisStep/totalSteps);
-    }
   }
+  thisStep += numLabels;
+  this->UpdateProgress(1.0*thisStep/totalSteps);
 
 
   // Are we using an embedded or an external color table?
@@ -250,51 +235,47 @@ int vtkFSSurfaceAnnotationReader::ReadFSAnnotation()
   // indices for each vertex.
   vtkDebugMacro( << "ReadFSAnnotation: Now match up rgb values with table entries to find the label indices for each vertex, numLabels = " << numLabels << ", numColorTableEntries = " << numColorTableEntries << endl);
 
+  // Index the table entries by rgb value so that each label is matched
+  // without scanning the whole table. The first entry with a given
+  // color wins.
+  std::map<int, int> colorTableIndices;
+  for (colorTableEntryIndex = 0;
+       colorTableEntryIndex < numColorTableEntries;
+       colorTableEntryIndex++)
+  {
+      if (colorTableRGBs[colorTableEntryIndex] == NULL)
+      {
+          // let's fail silently for now, the colour table may have an
+          // index where the colour hasn't been initialised
+          vtkDebugMacro(<<"ReadFSAnnotation ERROR: null entry at " << colorTableEntryIndex << " of the color table\n");
+          continue;
+      }
+      r = colorTableRGBs[colorTableEntryIndex][0];
+      g = colorTableRGBs[colorTableEntryIndex][1];
+      b = colorTableRGBs[colorTableEntryIndex][2];
+      if (r < 0 || r > 255 || g < 0 || g > 255 || b < 0 || b > 255)
+      {
+          // can't match any annotation value
+          continue;
+      }
+      colorTableIndices.insert (
+        std::make_pair (r + (g << 8) + (b << 16), colorTableEntryIndex));
+  }
+
   unassignedEntry = false;
   for (labelIndex = 0; labelIndex < numLabels; labelIndex++)
   {
     if (labelIndex % 1000 == 0) {
       vtkDebugMacro( << "ReadFSAnnotation: rgbs[" << labelIndex << "] = " << rgbs[labelIndex] << " (numLabels = " << numLabels << ")" << endl);
     }
-      // Expand the rgb value into separate values.
-      r = rgbs[labelIndex] & 0xff;
-      g = (rgbs[labelIndex] >> 8) & 0xff;
-      b = (rgbs[labelIndex] >> 16) & 0xff;
-/*
-if (labelIndex % 1000 == 0) {
-    cerr << "\t r " << r;
-    cerr <<  " g " << g;
-    cerr << " b " << b << endl;
-}
-*/
-      // Look for this rgb value in the table.
-      found = false;
-      for (colorTableEntryIndex = 0;
-           (found == false) && (colorTableEntryIndex < numColorTableEntries);
-           colorTableEntryIndex++)
+      // Look for this rgb value in the table, the annotation stores r,
+      // g and b in its lower three bytes.
+      std::map<int, int>::const_iterator entry =
+        colorTableIndices.find (rgbs[labelIndex] & 0xffffff);
+      found = (entry != colorTableIndices.end());
+      if (found)
       {
-          if (colorTableRGBs[colorTableEntryIndex] != NULL &&
-              r == colorTableRGBs[colorTableEntryIndex][0] &&
-              g == colorTableRGBs[colorTableEntryIndex][1] &&
-              b == colorTableRGBs[colorTableEntryIndex][2])
-          {
-              labels[labelIndex] = colorTableEntryIndex;
-              found = true;
-              continue;
-          }
-          else
-          {
-              if ( colorTableRGBs[colorTableEntryIndex] == NULL)
-              {
-                  // let's fail silently for now, as the scan through the
-                  // colour table may encounter an index where the colour
-                  // hasn't been initialised
-                  vtkDebugMacro(<<"ReadFSAnnotation ERROR: null entry at " << colorTableEntryIndex << " of the color table (label index " << labelIndex << ")\n");
-                  //fclose (annotFile);
-                  //return vtkFSSurfaceAnnotationReader::FS_ERROR_PARSING_ANNOTATION;
-              }
-          }
-
+          labels[labelIndex] = entry->second;
       }
       thisStep++;
       if (thisStep % 1000 == 0)
@@ -302,7 +283,7 @@ if (labelIndex % 1000 == 0) {
           this->UpdateProgress(1.0*thisStep/totalSteps);
       }
 
-      // Didn't find an entry so just set it to -1.
+      // Didn't find an entry so just set it to 0.
       if (!found)
       {
           vtkDebugMacro(<< "ReadFSAnnotation: Not found, returning a 0 in labels[" << labelIndex << "]\n");
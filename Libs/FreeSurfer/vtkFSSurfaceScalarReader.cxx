@@ -17,10 +17,12 @@
 #include "vtkFSSurfaceScalarReader.h"
 
 // VTK includes
-#include <vtkByteSwap.h>
 #include <vtkFloatArray.h>
 #include <vtkObjectFactory.h>
 
+// STD includes
+#include <vector>
+
 //-------------------------------------------------------------------------
 vtkStandardNewMacro(vtkFSSurfaceScalarReader);
 
@@ -56,9 +58,6 @@ int vtkFSSurfaceScalarReader::ReadFSScalars()
   int numFaces = 0;
   int numValuesPerPoint = 0;
   int vIndex;
-  int ivalue;
-  float fvalue;
-  float *FSscalars;
   vtkFloatArray *output = this->Scalars;
 
   if (output == NULL)
@@ -92,37 +91,22 @@ int vtkFSSurfaceScalarReader::ReadFSScalars()
   vtkFSIO::ReadInt3 (scalarFile, magicNumber);
   if (this->FS_NEW_SCALAR_MAGIC_NUMBER == magicNumber)
     {
-    size_t retval;
-    retval = fread (&numValues, sizeof(int), 1, scalarFile);
-    if (retval == 1)
-      {
-      vtkByteSwap::Swap4BE (&numValues);
-      }
-    else
+    if (vtkFSIO::ReadIntArray (scalarFile, &numValues, 1) != 1)
       {
       vtkErrorMacro("Error reading number of values from file " << this->FileName);
       }
-    retval = fread (&numFaces, sizeof(int), 1, scalarFile);
-    if (retval == 1)
-      {
-      vtkByteSwap::Swap4BE (&numFaces);
-      }
-    else
+    if (vtkFSIO::ReadIntArray (scalarFile, &numFaces, 1) != 1)
       {
       vtkErrorMacro("Error reading number of faces from file " << this->FileName);
       }
-    retval = fread (&numValuesPerPoint, sizeof(int), 1, scalarFile);
-    if (retval == 1)
-      {
-      vtkByteSwap::Swap4BE (&numValuesPerPoint);
-      }
-    else
+    if (vtkFSIO::ReadIntArray (scalarFile, &numValuesPerPoint, 1) != 1)
       {
       vtkErrorMacro("Error reading number of values per point, should be 1, in filename " << this->FileName);
       }
 
     if (numValuesPerPoint != 1) {
       vtkErrorMacro (<< "vtkFSSurfaceScalarReader.cxx Execute: Number of values per point is not 1, can't process file.");
+      fclose (scalarFile);
       return 0;
     }
 
@@ -132,46 +116,25 @@ int vtkFSSurfaceScalarReader::ReadFSScalars()
 
   if (numValues <= 0) {
     vtkErrorMacro (<< "vtkFSSurfaceScalarReader.cxx Execute: Number of vertices is 0 or negative, can't process file.");
-      return 0;
+    fclose (scalarFile);
+    return 0;
   }
 
-  // Make our float array.
-  FSscalars = (float*) calloc (numValues, sizeof(float));
-
-  // For each value, if it's a new style file read a float, otherwise
-  // read a two byte int and divide it by 100. Add this value to the
-  // array.
-  for (vIndex = 0; vIndex < numValues; vIndex ++ ) {
-
-    if (feof(scalarFile)) {
-      vtkErrorMacro (<< "vtkFSSurfaceScalarReader.cxx Execute: Unexpected EOF after " << vIndex << " values read.");
-      return 0;
-    }
-
-    if (this->FS_NEW_SCALAR_MAGIC_NUMBER == magicNumber) {
-      size_t retval = fread (&fvalue, sizeof(float), 1, scalarFile);
-      if (retval == 1)
-        {
-        vtkByteSwap::Swap4BE (&fvalue);
-        }
-      else
-        {
-        vtkErrorMacro("Error reading fvalue from file " << this->FileName);
-        }
-
-    } else {
-      vtkFSIO::ReadInt2 (scalarFile, ivalue);
-      fvalue = ivalue / 100.0;
-    }
-
-    FSscalars[vIndex] = fvalue;
-
-    if (numValues < 10000 ||
-        (vIndex % 100) == 0)
-    {
-        this->UpdateProgress(1.0*vIndex/numValues);
+  // Read the values directly in the output array. If it's a new style
+  // file they are floats, otherwise two byte ints that are divided by
+  // 100.
+  output->SetNumberOfComponents (1);
+  output->SetNumberOfValues (numValues);
+  float* FSscalars = output->GetPointer (0);
+  int numValuesRead = 0;
+  if (this->FS_NEW_SCALAR_MAGIC_NUMBER == magicNumber) {
+    numValuesRead = vtkFSIO::ReadFloatArray (scalarFile, FSscalars, numValues);
+  } else {
+    std::vector<short> ivalues (numValues);
+    numValuesRead = vtkFSIO::ReadShortArray (scalarFile, &ivalues[0], numValues);
+    for (vIndex = 0; vIndex < numValuesRead; vIndex ++ ) {
+      FSscalars[vIndex] = ivalues[vIndex] / 100.0;
     }
-
   }
 
   this->SetProgressText("");
@@ -180,8 +143,11 @@ int vtkFSSurfaceScalarReader::ReadFSScalars()
   // Close the file.
   fclose (scalarFile);
 
-  // Set the array in our output.
-  output->SetArray (FSscalars, numValues, 0);
+  if (numValuesRead != numValues) {
+    vtkErrorMacro (<< "vtkFSSurfaceScalarReader.cxx Execute: Unexpected EOF after " << numValuesRead << " values read.");
+    output->Initialize();
+    return 0;
+  }
 
   return 1;
 }
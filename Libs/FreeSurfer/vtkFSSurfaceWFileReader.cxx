@@ -17,9 +17,15 @@
 #include "vtkFSSurfaceWFileReader.h"
 
 // VTK includes
+#include <vtkByteSwap.h>
 #include <vtkFloatArray.h>
 #include <vtkObjectFactory.h>
 
+// STD includes
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
 //-------------------------------------------------------------------------
 vtkStandardNewMacro(vtkFSSurfaceWFileReader);
 
@@ -99,6 +105,7 @@ int vtkFSSurfaceWFileReader::ReadWFile()
   if (numValues < 0)
     {
     vtkErrorMacro (<< "vtkFSSurfaceWFileReader.cxx Execute: Number of vertices is 0 or negative, can't process file.");
+    fclose (wFile);
     return this->FS_ERROR_W_NUM_VALUES;
     }
 
@@ -112,37 +119,39 @@ int vtkFSSurfaceWFileReader::ReadWFile()
 
   vtkDebugMacro(<<"vtkFSSurfaceWFileReader: numValues = " << numValues << ", numVertices = " << this->NumberOfVertices);
 
-  // Make our float array.
-  // scalars = (float*) calloc (numValues, sizeof(float));
-  // make the array big enough to hold all vertices, calloc inits all values
-  // to zero as a default
-  FSscalars = (float*) calloc (this->NumberOfVertices, sizeof(float));
-  if (FSscalars == NULL)
+  // Make the output array big enough to hold all vertices, with all
+  // values initialized to zero as a default.
+  output->SetNumberOfComponents (1);
+  output->SetNumberOfValues (this->NumberOfVertices);
+  FSscalars = output->GetPointer (0);
+  if (FSscalars == NULL && this->NumberOfVertices > 0)
     {
     vtkErrorMacro(<<"vtkFSSurfaceWFileReader: error allocating " << this->NumberOfVertices << " floats!");
+    fclose (wFile);
     return this->FS_ERROR_W_ALLOC;
     }
+  std::fill (FSscalars, FSscalars + this->NumberOfVertices, 0.f);
+
+  // Read all the records of the wfile at once: a 3 byte int index and
+  // a float value, both big endian. The wfile is weird in that there
+  // is an index/value pair for every value. I guess this means that
+  // the wfile could have fewer values than the number of vertices in
+  // the surface, but I've never seen this happen in practice.
+  // Additionally, these are usually written with indices from
+  // 0->nvertices, so this index value isn't even really needed.
+  const int recordSize = 7;
+  std::vector<unsigned char> records (static_cast<size_t>(numValues) * recordSize);
+  int numRecordsRead = numValues > 0 ?
+    static_cast<int>(fread (&records[0], recordSize, numValues, wFile)) : 0;
+
+  // Close the file.
+  fclose (wFile);
 
   // For each value in the wfile...
-  for (vIndex = 0; vIndex < numValues; vIndex ++ )
+  const unsigned char* record = numValues > 0 ? &records[0] : NULL;
+  for (vIndex = 0; vIndex < numRecordsRead; vIndex ++, record += recordSize)
     {
-
-    // Check for eof.
-    if (feof(wFile))
-      {
-      vtkErrorMacro (<< "vtkFSSurfaceWFileReader.cxx Execute: Unexpected EOF after " << vIndex << " values read. Tried to read " << numValues);
-      return this->FS_ERROR_W_EOF;
-      }
-
-    // Read the 3 byte int index and float value. The wfile is weird
-    // in that there is an index/value pair for every value. I guess
-    // this means that the wfile could have fewer values than the
-    // number of vertices in the surface, but I've never seen this
-    // happen in practice. Additionally, these are usually written
-    // with indices from 0->nvertices, so this index value isn't even
-    // really needed.
-    vtkFSIO::ReadInt3 (wFile, vIndexFromFile);
-    vtkFSIO::ReadFloat (wFile, fvalue);
+    vIndexFromFile = (record[0] << 16) | (record[1] << 8) | record[2];
 
     // Make sure the index is in bounds. If not, print a warning and
     // try to do the next value. If this happens, there is probably a
@@ -158,24 +167,19 @@ int vtkFSSurfaceWFileReader::ReadWFile()
 
     // Set the value in the scalars array based on the index we read
     // in, not the index in our for loop.
+    memcpy (&fvalue, record + 3, sizeof(float));
+    vtkByteSwap::Swap4BE (&fvalue);
     FSscalars[vIndexFromFile] = fvalue;
-
-    if (numValues < 10000 ||
-        (vIndex % 100) == 0)
-      {
-      this->UpdateProgress(1.0*vIndex/numValues);
-      }
     }
 
   this->SetProgressText("");
   this->UpdateProgress(0.0);
 
-  // Close the file.
-  fclose (wFile);
-
-  // Set the array in our output.
-  //output->SetArray (FSscalars, numValues, 0);
-  output->SetArray(FSscalars, this->NumberOfVertices, 0);
+  if (numRecordsRead != numValues)
+    {
+    vtkErrorMacro (<< "vtkFSSurfaceWFileReader.cxx Execute: Unexpected EOF after " << numRecordsRead << " values read. Tried to read " << numValues);
+    return this->FS_ERROR_W_EOF;
+    }
 
   return this->FS_ERROR_W_NONE;
 }
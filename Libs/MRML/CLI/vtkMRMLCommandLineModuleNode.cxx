@@ -28,6 +28,7 @@ Version:   $Revision: 1.2 $
 #include <vtkSmartPointer.h>
 
 // STD includes
+#include <algorithm>
 #include <sstream>
 
 
@@ -53,6 +54,11 @@ public:
   /// Delay in msecs to wait before the module is auto run.
   unsigned int AutoRunDelay;
 
+  /// Resources the module needs to be run.
+  int NumberOfThreads;
+  unsigned int RequiredMemory;
+  int Priority;
+
   /// Last time the module was started.
   vtkTimeStamp LastRunTime;
   /// Last time a parameter was modified.
@@ -86,6 +92,9 @@ vtkMRMLCommandLineModuleNode::vtkMRMLCommandLineModuleNode()
     vtkMRMLCommandLineModuleNode::AutoRunOnChangedParameter
     | vtkMRMLCommandLineModuleNode::AutoRunCancelsRunningProcess;
   this->Internal->AutoRunDelay = 1000;
+  this->Internal->NumberOfThreads = 0;
+  this->Internal->RequiredMemory = 0;
+  this->Internal->Priority = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -276,6 +285,9 @@ void vtkMRMLCommandLineModuleNode::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Status: " << this->GetStatusString() << "\n";
   os << indent << "AutoRun:" << this->GetAutoRun() << "\n";
   os << indent << "AutoRunMode:" << this->GetAutoRunMode() << "\n";
+  os << indent << "NumberOfThreads:" << this->GetNumberOfThreads() << "\n";
+  os << indent << "RequiredMemory:" << this->GetRequiredMemory() << "\n";
+  os << indent << "Priority:" << this->GetPriority() << "\n";
 }
 
 //----------------------------------------------------------------------------
@@ -593,6 +605,58 @@ unsigned int vtkMRMLCommandLineModuleNode::GetAutoRunDelay() const
   return this->Internal->AutoRunDelay;
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLCommandLineModuleNode::SetNumberOfThreads(int numberOfThreads)
+{
+  numberOfThreads = std::max(0, numberOfThreads);
+  if (this->Internal->NumberOfThreads == numberOfThreads)
+    {
+    return;
+    }
+  this->Internal->NumberOfThreads = numberOfThreads;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLCommandLineModuleNode::GetNumberOfThreads() const
+{
+  return this->Internal->NumberOfThreads;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLCommandLineModuleNode::SetRequiredMemory(unsigned int memoryInMB)
+{
+  if (this->Internal->RequiredMemory == memoryInMB)
+    {
+    return;
+    }
+  this->Internal->RequiredMemory = memoryInMB;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+unsigned int vtkMRMLCommandLineModuleNode::GetRequiredMemory() const
+{
+  return this->Internal->RequiredMemory;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLCommandLineModuleNode::SetPriority(int priority)
+{
+  if (this->Internal->Priority == priority)
+    {
+    return;
+    }
+  this->Internal->Priority = priority;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLCommandLineModuleNode::GetPriority() const
+{
+  return this->Internal->Priority;
+}
+
 //----------------------------------------------------------------------------
 unsigned long vtkMRMLCommandLineModuleNode::GetLastRunTime() const
 {
@@ -186,6 +186,26 @@ public:
   /// \sa SetAutoRunDelay(), GetAutoRun(), GetAutoRunMode()
   unsigned int GetAutoRunDelay()const;
 
+  /// Set the number of cores the module uses when it is run by the CLI
+  /// logic. The run is not started until as many cores are available and
+  /// executable modules get it in ITK_GLOBAL_DEFAULT_NUMBER_OF_THREADS.
+  /// 0 by default: the share of vtkSlicerApplicationLogic::
+  /// GetDefaultNumberOfThreadsPerTask().
+  /// \sa GetNumberOfThreads(), SetRequiredMemory(), SetPriority()
+  void SetNumberOfThreads(int numberOfThreads);
+  int GetNumberOfThreads()const;
+
+  /// Set the memory in MB the module needs. The run is not started until
+  /// as much memory is available. 0 by default.
+  /// \sa vtkSlicerApplicationLogic::SetProcessingMemoryLimit()
+  void SetRequiredMemory(unsigned int memoryInMB);
+  unsigned int GetRequiredMemory()const;
+
+  /// Set the priority of the runs of the module: scheduled runs with a
+  /// higher priority are started first. 0 by default.
+  void SetPriority(int priority);
+  int GetPriority()const;
+
   /// Return the last time the module was ran.
   /// \sa GetParameterMTime(), GetInputMTime(), GetMTime()
   unsigned long GetLastRunTime()const;
@@ -0,0 +1,126 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#include "vtkCacheManager.h"
+
+#include "vtkMRMLCoreTestingMacros.h"
+
+// VTKsys includes
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <fstream>
+
+//---------------------------------------------------------------------------
+void writeTestFile(const std::string& fileName, const char* content)
+{
+  std::ofstream file(fileName.c_str(), std::ios::binary);
+  for (int i = 0; i < 10000; ++i)
+    {
+    file << content;
+    }
+}
+
+//---------------------------------------------------------------------------
+int vtkCacheManagerTest1(int argc, char * argv[] )
+{
+  vtkSmartPointer< vtkCacheManager > cacheManager = vtkSmartPointer< vtkCacheManager >::New();
+
+  EXERCISE_BASIC_OBJECT_METHODS( cacheManager );
+
+  TEST_SET_GET_BOOLEAN( cacheManager, EnableCacheEviction );
+
+  if (argc < 2)
+    {
+    std::cerr << "Usage: vtkCacheManagerTest1 temporary_directory" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::string cacheDirectory = std::string(argv[1]) + "/vtkCacheManagerTest1";
+  vtksys::SystemTools::RemoveADirectory(cacheDirectory.c_str());
+  cacheManager->SetRemoteCacheDirectory(cacheDirectory.c_str());
+  if (cacheManager->GetCurrentCacheSize() != 0.)
+    {
+    std::cerr << "Line " << __LINE__
+              << " - The new cache is not empty" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Identical files are counted once
+  std::string file1 = cacheDirectory + "/file1.nrrd";
+  std::string file2 = cacheDirectory + "/file2.nrrd";
+  std::string file3 = cacheDirectory + "/file3.vtk";
+  writeTestFile(file1, "0123456789");
+  writeTestFile(file2, "0123456789");
+  writeTestFile(file3, "abcdefghij");
+  cacheManager->AddCachedFile("http://host/file1.nrrd", file1.c_str());
+  cacheManager->AddCachedFile("http://host/file2.nrrd", file2.c_str());
+  cacheManager->AddCachedFile("http://host/file3.vtk", file3.c_str());
+  float size = cacheManager->GetCurrentCacheSize();
+  if (size < 0.199 || size > 0.201 ||
+      cacheManager->GetCachedFiles().size() != 3)
+    {
+    std::cerr << "Line " << __LINE__
+              << " - Problem with AddCachedFile(), the cache size is "
+              << size << " MB" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const char* found = cacheManager->FindCachedFile("file2.nrrd", cacheDirectory.c_str());
+  bool foundFile2 = found != NULL &&
+    vtksys::SystemTools::GetFilenameName(found) == "file2.nrrd";
+  delete [] found;
+  found = cacheManager->FindCachedFile("file4.nrrd", cacheDirectory.c_str());
+  if (!foundFile2 || found != NULL)
+    {
+    std::cerr << "Line " << __LINE__
+              << " - Problem with FindCachedFile()" << std::endl;
+    delete [] found;
+    return EXIT_FAILURE;
+    }
+
+  // The index is read by a new cache manager
+  cacheManager->SaveCacheIndex();
+  vtkSmartPointer< vtkCacheManager > cacheManager2 = vtkSmartPointer< vtkCacheManager >::New();
+  cacheManager2->SetRemoteCacheDirectory(cacheDirectory.c_str());
+  if (cacheManager2->GetFileFromURIMap("http://host/file3.vtk") == NULL ||
+      cacheManager2->GetCurrentCacheSize() != size)
+    {
+    std::cerr << "Line " << __LINE__
+              << " - The cache index was not restored" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The least recently used content is evicted first
+  cacheManager2->TouchCachedFile(file1.c_str());
+  cacheManager2->TouchCachedFile(file2.c_str());
+  vtksys::SystemTools::Delay(1100);
+  cacheManager2->TouchCachedFile(file3.c_str());
+  if (cacheManager2->EvictCachedFiles(0.15) != 2 ||
+      vtksys::SystemTools::FileExists(file1.c_str()) ||
+      !vtksys::SystemTools::FileExists(file3.c_str()))
+    {
+    std::cerr << "Line " << __LINE__
+              << " - Problem with EvictCachedFiles()" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (!cacheManager2->ClearCache() || !cacheManager2->ClearCacheCheck() ||
+      cacheManager2->GetCurrentCacheSize() != 0.)
+    {
+    std::cerr << "Line " << __LINE__
+              << " - Problem with ClearCache()" << std::endl;
+    return EXIT_FAILURE;
+    }
+  vtksys::SystemTools::RemoveADirectory(cacheDirectory.c_str());
+
+  return EXIT_SUCCESS;
+}
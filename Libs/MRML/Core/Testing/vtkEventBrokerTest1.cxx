@@ -0,0 +1,139 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2010 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkEventBroker.h"
+#include "vtkObservation.h"
+
+// VTK includes
+#include <vtkCallbackCommand.h>
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
+
+// STD includes
+#include <iostream>
+#include <vector>
+
+namespace
+{
+std::vector<vtkObject*> InvokedObservers;
+
+//---------------------------------------------------------------------------
+void EventBrokerTestCallback(vtkObject* vtkNotUsed(caller),
+                             unsigned long vtkNotUsed(eid),
+                             void *clientData, void *vtkNotUsed(callData))
+{
+  InvokedObservers.push_back(reinterpret_cast<vtkObject*>(clientData));
+}
+
+}
+
+//---------------------------------------------------------------------------
+int vtkEventBrokerTest1(int , char * [] )
+{
+  vtkSmartPointer<vtkEventBroker> broker = vtkSmartPointer<vtkEventBroker>::New();
+
+  vtkNew<vtkObject> subject;
+  vtkNew<vtkObject> logicObserver;
+  vtkNew<vtkObject> renderObserver;
+
+  vtkNew<vtkCallbackCommand> logicCallback;
+  logicCallback->SetCallback(EventBrokerTestCallback);
+  logicCallback->SetClientData(logicObserver.GetPointer());
+  vtkNew<vtkCallbackCommand> renderCallback;
+  renderCallback->SetCallback(EventBrokerTestCallback);
+  renderCallback->SetClientData(renderObserver.GetPointer());
+
+  broker->AddObservation(subject.GetPointer(), vtkCommand::ModifiedEvent,
+                         logicObserver.GetPointer(), logicCallback.GetPointer());
+  broker->AddObservation(subject.GetPointer(), vtkCommand::ModifiedEvent,
+                         renderObserver.GetPointer(), renderCallback.GetPointer(),
+                         10.);
+
+  broker->SetEventModeToAsynchronous();
+
+  // An event storm is coalesced into one queued observation per observer
+  for (int i = 0; i < 100; ++i)
+    {
+    subject->Modified();
+    }
+  if (broker->GetNumberOfQueuedObservations() != 2 ||
+      !InvokedObservers.empty())
+    {
+    std::cerr << __LINE__ << " QueueObservation failed: "
+              << broker->GetNumberOfQueuedObservations() << " queued"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The priority lane is processed first
+  if (broker->GetNthQueuedObservation(0)->GetObserver() !=
+      renderObserver.GetPointer())
+    {
+    std::cerr << __LINE__ << " Priority lane failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  int left = broker->ProcessEventQueue(1000.);
+  if (left != 0 ||
+      InvokedObservers.size() != 2 ||
+      InvokedObservers[0] != renderObserver.GetPointer() ||
+      InvokedObservers[1] != logicObserver.GetPointer())
+    {
+    std::cerr << __LINE__ << " ProcessEventQueue failed: "
+              << InvokedObservers.size() << " invocations" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Removing an observation removes it from the queue
+  InvokedObservers.clear();
+  subject->Modified();
+  broker->RemoveObservations(subject.GetPointer(), renderObserver.GetPointer());
+  if (broker->GetNumberOfQueuedObservations() != 1)
+    {
+    std::cerr << __LINE__ << " RemoveObservations failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  broker->SetEventModeToSynchronous();
+  if (broker->GetNumberOfQueuedObservations() != 0 ||
+      InvokedObservers.size() != 1)
+    {
+    std::cerr << __LINE__ << " SetEventModeToSynchronous failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Profiling
+  broker->ProfilingOn();
+  subject->Modified();
+  subject->Modified();
+  broker->RecordHandlerProfile(subject->GetClassName(), vtkCommand::ModifiedEvent,
+                               "vtkMRMLTestLogic", "OnMRMLNodeModified", 0.001);
+  broker->ProfilingOff();
+  double profileElapsedTime = broker->GetProfileElapsedTime();
+  if (profileElapsedTime < 0. ||
+      broker->GetProfileElapsedTime() != profileElapsedTime)
+    {
+    std::cerr << __LINE__ << " GetProfileElapsedTime failed: "
+              << profileElapsedTime << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (broker->WriteProfile("vtkEventBrokerTest1Profile.csv") != 0 ||
+      broker->WriteProfile("vtkEventBrokerTest1Profile.json") != 0)
+    {
+    std::cerr << __LINE__ << " WriteProfile failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  broker->ResetProfile();
+
+  broker->RemoveObservations(subject.GetPointer(), logicObserver.GetPointer());
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,96 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#include "vtkImageLabelStatistics.h"
+
+#include "vtkMRMLCoreTestingMacros.h"
+
+// VTK includes
+#include <vtkImageData.h>
+
+// STD includes
+#include <cmath>
+
+//---------------------------------------------------------------------------
+int vtkImageLabelStatisticsTest1(int , char * [] )
+{
+  vtkSmartPointer< vtkImageLabelStatistics > statistics = vtkSmartPointer< vtkImageLabelStatistics >::New();
+
+  EXERCISE_BASIC_OBJECT_METHODS( statistics );
+
+  // label 0 on the left half of the rows, label 3 or 7 on the right half
+  vtkSmartPointer<vtkImageData> labelMap = vtkSmartPointer<vtkImageData>::New();
+  labelMap->SetDimensions(10, 9, 4);
+  labelMap->SetSpacing(1., 2., 0.5);
+  labelMap->SetScalarTypeToShort();
+  labelMap->SetNumberOfScalarComponents(1);
+  labelMap->AllocateScalars();
+  vtkSmartPointer<vtkImageData> grayscale = vtkSmartPointer<vtkImageData>::New();
+  grayscale->SetDimensions(10, 9, 4);
+  grayscale->SetScalarTypeToFloat();
+  grayscale->SetNumberOfScalarComponents(1);
+  grayscale->AllocateScalars();
+  short* labels = static_cast<short*>(labelMap->GetScalarPointer());
+  float* values = static_cast<float*>(grayscale->GetScalarPointer());
+  for (int i = 0; i < 360; ++i)
+    {
+    labels[i] = (i % 10 < 5) ? 0 : ((i / 90) % 2 ? 7 : 3);
+    values[i] = static_cast<float>(i % 10);
+    }
+
+  for (int threads = 1; threads <= 4; ++threads)
+    {
+    statistics->SetNumberOfThreads(threads);
+    if (statistics->Compute(labelMap, grayscale) != 3 ||
+        statistics->GetLabel(0) != 0 ||
+        statistics->GetLabel(1) != 3 ||
+        statistics->GetLabel(2) != 7)
+      {
+      std::cerr << "Line " << __LINE__
+                << " - Problem with Compute() using " << threads << " threads: "
+                << statistics->GetNumberOfLabels() << " labels" << std::endl;
+      return EXIT_FAILURE;
+      }
+    // mean of 0..4 is 2, sample variance of 45 times 0..4 is 2*180/179
+    if (statistics->GetCount(0) != 180 ||
+        statistics->GetVolume(0) != 180. ||
+        statistics->GetMin(0) != 0. ||
+        statistics->GetMax(0) != 4. ||
+        statistics->GetMean(0) != 2. ||
+        fabs(statistics->GetStandardDeviation(0) - sqrt(360. / 179.)) > 1e-9 ||
+        statistics->GetCount(1) != 90 ||
+        statistics->GetMin(1) != 5. ||
+        statistics->GetMax(1) != 9. ||
+        statistics->GetMean(1) != 7. ||
+        statistics->GetCount(2) != 90)
+      {
+      std::cerr << "Line " << __LINE__
+                << " - Wrong statistics using " << threads << " threads"
+                << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  vtkSmartPointer<vtkImageData> smallImage = vtkSmartPointer<vtkImageData>::New();
+  smallImage->SetDimensions(2, 2, 2);
+  smallImage->AllocateScalars();
+  std::cout << "Expect an error about the dimensions" << std::endl;
+  if (statistics->Compute(labelMap, smallImage) != -1 ||
+      statistics->GetNumberOfLabels() != 0)
+    {
+    std::cerr << "Line " << __LINE__
+              << " - Compute() accepted images of different dimensions" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,95 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#include "vtkImageMapToDirectColors.h"
+#include "vtkMRMLProceduralColorNode.h"
+
+#include "vtkMRMLCoreTestingMacros.h"
+
+// VTK includes
+#include <vtkColorTransferFunction.h>
+#include <vtkImageData.h>
+#include <vtkImageMapToColors.h>
+
+// STD includes
+#include <cstring>
+
+//---------------------------------------------------------------------------
+int vtkImageMapToDirectColorsTest1(int , char * [] )
+{
+  vtkSmartPointer< vtkImageMapToDirectColors > directColors = vtkSmartPointer< vtkImageMapToDirectColors >::New();
+
+  EXERCISE_BASIC_OBJECT_METHODS( directColors );
+
+  vtkSmartPointer<vtkMRMLProceduralColorNode> colorNode =
+    vtkSmartPointer<vtkMRMLProceduralColorNode>::New();
+  vtkColorTransferFunction* function = colorNode->GetColorTransferFunction();
+  function->AddRGBPoint(-1000., 0., 0., 1.);
+  function->AddRGBPoint(0., 1., 1., 1.);
+  function->AddRGBPoint(1000., 1., 0., 0.);
+
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(50, 40, 3);
+  image->SetScalarTypeToShort();
+  image->SetNumberOfScalarComponents(1);
+  image->AllocateScalars();
+  short* values = static_cast<short*>(image->GetScalarPointer());
+  for (int i = 0; i < 6000; ++i)
+    {
+    values[i] = static_cast<short>((i * 37) % 3000 - 1500);
+    }
+
+  vtkSmartPointer<vtkImageMapToColors> colors =
+    vtkSmartPointer<vtkImageMapToColors>::New();
+  colors->SetInput(image);
+  colors->SetLookupTable(colorNode->GetScalarsToColors());
+  colors->SetOutputFormatToRGBA();
+  colors->Update();
+
+  directColors->SetInput(image);
+  directColors->SetLookupTable(colorNode->GetScalarsToColors());
+  directColors->SetColorNode(colorNode);
+  directColors->SetOutputFormatToRGBA();
+  directColors->Update();
+
+  if (directColors->GetColorNode() != colorNode.GetPointer() ||
+      std::memcmp(directColors->GetOutput()->GetScalarPointer(),
+                  colors->GetOutput()->GetScalarPointer(), 6000 * 4) != 0)
+    {
+    std::cerr << "Line " << __LINE__
+              << " - Direct colors differ from vtkImageMapToColors" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // the direct lookup table is shared and rebuilt when the function changes
+  vtkUnsignedCharArray* table = colorNode->GetDirectLookupTable(VTK_SHORT);
+  if (table == 0 || table != colorNode->GetDirectLookupTable(VTK_SHORT) ||
+      colorNode->GetDirectLookupTable(VTK_FLOAT) != 0)
+    {
+    std::cerr << "Line " << __LINE__
+              << " - Problem with GetDirectLookupTable()" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  function->AddRGBPoint(0., 0., 1., 0.);
+  colors->Update();
+  directColors->Update();
+  if (std::memcmp(directColors->GetOutput()->GetScalarPointer(),
+                  colors->GetOutput()->GetScalarPointer(), 6000 * 4) != 0)
+    {
+    std::cerr << "Line " << __LINE__
+              << " - Direct colors not updated with the color function" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
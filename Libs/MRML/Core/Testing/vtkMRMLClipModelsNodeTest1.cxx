@@ -22,6 +22,9 @@ int vtkMRMLClipModelsNodeTest1(int , char * [] )
   EXERCISE_BASIC_OBJECT_METHODS( node1 );
 
   EXERCISE_BASIC_MRML_METHODS(vtkMRMLClipModelsNode, node1);
+
+  TEST_SET_GET_INT(node1, ClipMethod, vtkMRMLClipModelsNode::ClipFragments);
+  TEST_SET_GET_INT(node1, ClipMethod, vtkMRMLClipModelsNode::ClipGeometry);
   
   return EXIT_SUCCESS;
 }
@@ -12,8 +12,92 @@
 
 #include "vtkMRMLDiffusionTensorVolumeNode.h"
 
+#include <vtkDataArray.h>
+#include <vtkFloatArray.h>
+#include <vtkImageData.h>
+#include <vtkPointData.h>
 #include <vtkPolyData.h>
 
+#include <cmath>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+bool TestEigenSystems(bool quantize)
+{
+  // Diagonal tensors whose largest eigenvalue moves along the axes
+  vtkSmartPointer<vtkImageData> imageData = vtkSmartPointer<vtkImageData>::New();
+  imageData->SetDimensions(3, 2, 1);
+  vtkSmartPointer<vtkFloatArray> tensors = vtkSmartPointer<vtkFloatArray>::New();
+  tensors->SetNumberOfComponents(9);
+  tensors->SetNumberOfTuples(6);
+  for (vtkIdType id = 0; id < 6; ++id)
+    {
+    double tensor[9] = {0., 0., 0., 0., 0., 0., 0., 0., 0.};
+    for (int i = 0; i < 3; ++i)
+      {
+      tensor[4 * i] = (i == id % 3) ? 3. + id : 1. + 0.1 * i;
+      }
+    tensors->SetTuple(id, tensor);
+    }
+  imageData->GetPointData()->SetTensors(tensors);
+
+  vtkSmartPointer<vtkMRMLDiffusionTensorVolumeNode> node =
+    vtkSmartPointer<vtkMRMLDiffusionTensorVolumeNode>::New();
+  node->SetQuantizeEigenvectors(quantize);
+  double w[3], v[3];
+  if (node->GetEigenvalues() != 0 || node->GetEigenSystem(0, w, v))
+    {
+    std::cerr << "Eigen-systems without image data" << std::endl;
+    return false;
+    }
+  node->SetAndObserveImageData(imageData);
+
+  vtkFloatArray* eigenvalues = node->GetEigenvalues();
+  vtkDataArray* eigenvectors = node->GetPrincipalEigenvectors();
+  if (!eigenvalues || eigenvalues->GetNumberOfTuples() != 6 ||
+      !eigenvectors || eigenvectors->GetNumberOfTuples() != 6 ||
+      eigenvectors->IsA("vtkSignedCharArray") != quantize)
+    {
+    std::cerr << "Wrong eigen-system arrays, quantize: " << quantize << std::endl;
+    return false;
+    }
+  for (int pass = 0; pass < 2; ++pass)
+    {
+    for (vtkIdType id = 0; id < 6; ++id)
+      {
+      double largest = 3. + id + (pass ? 10. : 0.);
+      if (!node->GetEigenSystem(id, w, v) ||
+          fabs(w[0] - largest) > 1e-5 || w[1] < w[2] ||
+          fabs(fabs(v[id % 3]) - 1.) > 1e-2)
+        {
+        std::cerr << "Wrong eigen-system of voxel " << id
+                  << " quantize: " << quantize << " pass: " << pass
+                  << " eigenvalues: " << w[0] << " " << w[1] << " " << w[2]
+                  << " eigenvector: " << v[0] << " " << v[1] << " " << v[2]
+                  << std::endl;
+        return false;
+        }
+      }
+    // Modified tensors are solved again at the next request
+    for (vtkIdType id = 0; id < 6; ++id)
+      {
+      int component = 4 * (id % 3);
+      tensors->SetComponent(id, component, tensors->GetComponent(id, component) + 10.);
+      }
+    tensors->Modified();
+    }
+  if (node->GetEigenvalues() != eigenvalues)
+    {
+    std::cerr << "The eigen-system arrays are not reused" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
 
 #include "vtkMRMLCoreTestingMacros.h"
 
@@ -24,6 +108,11 @@ int vtkMRMLDiffusionTensorVolumeNodeTest1(int , char * [] )
   EXERCISE_BASIC_OBJECT_METHODS( node1 );
 
   EXERCISE_BASIC_DISPLAYABLE_MRML_METHODS(vtkMRMLDiffusionTensorVolumeNode, node1);
+
+  if (!TestEigenSystems(false) || !TestEigenSystems(true))
+    {
+    return EXIT_FAILURE;
+    }
   
   return EXIT_SUCCESS;
 }
@@ -12,6 +12,9 @@
 
 #include "vtkMRMLDoubleArrayNode.h"
 
+// VTK includes
+#include <vtkDoubleArray.h>
+#include <vtkNew.h>
 
 #include "vtkMRMLCoreTestingMacros.h"
 
@@ -22,6 +25,62 @@ int vtkMRMLDoubleArrayNodeTest1(int , char * [] )
   EXERCISE_BASIC_OBJECT_METHODS( node1 );
 
   EXERCISE_BASIC_MRML_METHODS(vtkMRMLDoubleArrayNode, node1);
-  
+
+  // Bulk set and get
+  const int size = 1000;
+  vtkNew<vtkDoubleArray> x;
+  vtkNew<vtkDoubleArray> y;
+  for (int i = 0; i < size; ++i)
+    {
+    x->InsertNextValue(i);
+    y->InsertNextValue(i % 10 == 5 ? 100. : i % 10);
+    }
+  node1->SetXYValues(x.GetPointer(), y.GetPointer());
+  double xValue, yValue, yerrValue;
+  if (node1->GetSize() != static_cast<unsigned int>(size) ||
+      !node1->GetXYValue(15, &xValue, &yValue, &yerrValue) ||
+      xValue != 15. || yValue != 100. || yerrValue != 0.)
+    {
+    std::cerr << "SetXYValues failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  vtkNew<vtkDoubleArray> y2;
+  vtkNew<vtkDoubleArray> yerr2;
+  node1->GetXYValues(x.GetPointer(), y2.GetPointer(), yerr2.GetPointer());
+  if (y2->GetNumberOfTuples() != size || y2->GetValue(15) != 100. ||
+      yerr2->GetValue(15) != 0.)
+    {
+    std::cerr << "GetXYValues failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Decimation
+  vtkNew<vtkDoubleArray> decimated;
+  node1->GetMinMaxDecimatedValues(100, decimated.GetPointer());
+  if (decimated->GetNumberOfTuples() != 200 ||
+      decimated->GetComponent(0, 0) != 0. ||
+      decimated->GetComponent(1, 1) != 100.)
+    {
+    std::cerr << "GetMinMaxDecimatedValues failed: "
+              << decimated->GetNumberOfTuples() << std::endl;
+    return EXIT_FAILURE;
+    }
+  node1->GetLTTBDecimatedValues(50, decimated.GetPointer());
+  if (decimated->GetNumberOfTuples() != 50 ||
+      decimated->GetComponent(0, 0) != 0. ||
+      decimated->GetComponent(49, 0) != size - 1)
+    {
+    std::cerr << "GetLTTBDecimatedValues failed: "
+              << decimated->GetNumberOfTuples() << std::endl;
+    return EXIT_FAILURE;
+    }
+  node1->GetLTTBDecimatedValues(2 * size, decimated.GetPointer());
+  if (decimated->GetNumberOfTuples() != size)
+    {
+    std::cerr << "GetLTTBDecimatedValues failed to keep all the points"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
   return EXIT_SUCCESS;
 }
@@ -11,10 +11,117 @@
 =========================================================================auto=*/
 
 #include "vtkMRMLFiducialListNode.h"
-
+#include "vtkMRMLScene.h"
 
 #include "vtkMRMLCoreTestingMacros.h"
 
+// VTK includes
+#include <vtkPoints.h>
+#include <vtkStringArray.h>
+#include <vtkUnsignedCharArray.h>
+
+// STD includes
+#include <string>
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+bool bulkAccess()
+{
+  vtkSmartPointer<vtkMRMLScene> scene = vtkSmartPointer<vtkMRMLScene>::New();
+  vtkSmartPointer<vtkMRMLFiducialListNode> list = vtkSmartPointer<vtkMRMLFiducialListNode>::New();
+  list->SetName("L");
+  scene->AddNode(list);
+
+  const int numPoints = 1000;
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  vtkSmartPointer<vtkUnsignedCharArray> selected = vtkSmartPointer<vtkUnsignedCharArray>::New();
+  for (int i = 0; i < numPoints; ++i)
+    {
+    points->InsertNextPoint(i, 2 * i, 3 * i);
+    selected->InsertNextValue(i % 2);
+    }
+  if (list->AddFiducialWithXYZ(-1., -1., -1., 0) != 0 ||
+      list->AddFiducials(points, NULL, selected) != 1 ||
+      list->GetNumberOfFiducials() != numPoints + 1)
+    {
+    std::cerr << "Line " << __LINE__ << ": AddFiducials failed, "
+              << list->GetNumberOfFiducials() << " fiducials" << std::endl;
+    return false;
+    }
+  float *xyz = list->GetNthFiducialXYZ(11);
+  if (xyz[0] != 10. || xyz[1] != 20. || xyz[2] != 30. ||
+      list->GetNthFiducialSelected(11) != 0 ||
+      list->GetNthFiducialSelected(12) != 1 ||
+      list->GetNthFiducialVisibility(12) != 1 ||
+      std::string(list->GetNthFiducialLabelText(12)) != list->GetNthFiducialID(12) ||
+      list->GetFiducialIndex(list->GetNthFiducialID(12)) != 12)
+    {
+    std::cerr << "Line " << __LINE__ << ": wrong fiducial 11 or 12" << std::endl;
+    return false;
+    }
+
+  // round trip through the bulk getters and setters
+  vtkSmartPointer<vtkPoints> listPoints = vtkSmartPointer<vtkPoints>::New();
+  list->GetFiducialsXYZ(listPoints);
+  listPoints->SetPoint(0, 5., 6., 7.);
+  vtkSmartPointer<vtkUnsignedCharArray> visibility = vtkSmartPointer<vtkUnsignedCharArray>::New();
+  list->GetFiducialsVisibility(visibility);
+  visibility->SetValue(numPoints, 0);
+  if (listPoints->GetNumberOfPoints() != numPoints + 1 ||
+      list->SetFiducialsXYZ(listPoints) != 0 ||
+      list->SetFiducialsVisibility(visibility) != 0 ||
+      list->GetNthFiducialXYZ(0)[2] != 7. ||
+      list->GetNthFiducialVisibility(numPoints) != 0)
+    {
+    std::cerr << "Line " << __LINE__ << ": bulk set failed" << std::endl;
+    return false;
+    }
+
+  // the per points methods keep the attributes together
+  std::string id = list->GetNthFiducialID(1);
+  if (list->MoveFiducialUp(1) != 0 ||
+      list->GetNthFiducialID(0) != id ||
+      list->GetNthFiducialXYZ(0)[0] != 0. ||
+      list->GetNthFiducialXYZ(1)[2] != 7.)
+    {
+    std::cerr << "Line " << __LINE__ << ": MoveFiducialUp failed" << std::endl;
+    return false;
+    }
+  list->RemoveFiducial(0);
+  if (list->GetNumberOfFiducials() != numPoints ||
+      list->GetFiducialIndex(id) != -1 ||
+      list->GetNthFiducialXYZ(0)[2] != 7. ||
+      list->GetNthFiducialXYZ(1)[1] != 2.)
+    {
+    std::cerr << "Line " << __LINE__ << ": RemoveFiducial failed" << std::endl;
+    return false;
+    }
+
+  vtkSmartPointer<vtkMRMLFiducialListNode> copy = vtkSmartPointer<vtkMRMLFiducialListNode>::New();
+  copy->Copy(list);
+  vtkSmartPointer<vtkStringArray> labels = vtkSmartPointer<vtkStringArray>::New();
+  copy->GetFiducialsLabelText(labels);
+  if (copy->GetNumberOfFiducials() != numPoints ||
+      labels->GetValue(10) != list->GetNthFiducialLabelText(10) ||
+      std::string(copy->GetNthFiducialID(10)) != list->GetNthFiducialID(10))
+    {
+    std::cerr << "Line " << __LINE__ << ": Copy failed" << std::endl;
+    return false;
+    }
+
+  list->RemoveAllFiducials();
+  if (list->GetNumberOfFiducials() != 0)
+    {
+    std::cerr << "Line " << __LINE__ << ": RemoveAllFiducials failed" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+}
+
 int vtkMRMLFiducialListNodeTest1(int , char * [] )
 {
   vtkSmartPointer< vtkMRMLFiducialListNode > node1 = vtkSmartPointer< vtkMRMLFiducialListNode >::New();
@@ -27,5 +134,10 @@ int vtkMRMLFiducialListNodeTest1(int , char * [] )
 
   EXERCISE_BASIC_STORABLE_MRML_METHODS(vtkMRMLFiducialListNode, node1);
 
+  if (!bulkAccess())
+    {
+    return EXIT_FAILURE;
+    }
+
   return EXIT_SUCCESS;
 }
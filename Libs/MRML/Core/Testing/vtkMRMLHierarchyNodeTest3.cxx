@@ -252,6 +252,45 @@ int vtkMRMLHierarchyNodeTest3(int , char * [] )
       }
     }
 
+  // reparent a model hierarchy to the top level, it goes last
+  vtkMRMLHierarchyNode *movedNode = hnode2->GetNthChildNode(0);
+  movedNode->SetParentNodeID(hnode1->GetID());
+  immediateChildren = hnode1->GetChildrenNodes();
+  immediateChildren2 = hnode2->GetChildrenNodes();
+  if (immediateChildren.size() != 2 ||
+      immediateChildren[1] != movedNode ||
+      immediateChildren2.size() != numModels - 1)
+    {
+    std::cerr << "Error reparenting a hierarchy node, top level has "
+              << immediateChildren.size() << " children, second level has "
+              << immediateChildren2.size() << std::endl;
+    PrintNames(immediateChildren);
+    return EXIT_FAILURE;
+    }
+
+  // removing a child from the scene removes it from its parent
+  scene->RemoveNode(movedNode);
+  if (hnode1->GetNumberOfChildrenNodes() != 1)
+    {
+    std::cerr << "Error removing a hierarchy node, top level still has "
+              << hnode1->GetNumberOfChildrenNodes() << " children" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // a new child goes last
+  vtkSmartPointer<vtkMRMLModelHierarchyNode> newNode =
+    vtkSmartPointer<vtkMRMLModelHierarchyNode>::New();
+  newNode->SetParentNodeID(hnode2->GetID());
+  scene->AddNode(newNode);
+  if (hnode2->GetNumberOfChildrenNodes() != (int)numModels ||
+      hnode2->GetNthChildNode(numModels - 1) != newNode.GetPointer())
+    {
+    std::cerr << "Error adding a hierarchy node, second level has "
+              << hnode2->GetNumberOfChildrenNodes() << " children" << std::endl;
+    PrintNames(hnode2->GetChildrenNodes());
+    return EXIT_FAILURE;
+    }
+
   return EXIT_SUCCESS;
 }
 
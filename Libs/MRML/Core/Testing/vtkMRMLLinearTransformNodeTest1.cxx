@@ -13,9 +13,87 @@
 // MRML includes
 #include "vtkMRMLCoreTestingMacros.h"
 #include "vtkMRMLLinearTransformNode.h"
+#include "vtkMRMLScene.h"
 
 // VTK includes
 #include <vtkGeneralTransform.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+
+namespace
+{
+
+//---------------------------------------------------------------------------
+bool CheckTranslationToWorld(vtkMRMLLinearTransformNode* node, double expected)
+{
+  vtkNew<vtkMatrix4x4> toWorld;
+  if (!node->GetMatrixTransformToWorld(toWorld.GetPointer()) ||
+      toWorld->GetElement(0, 3) != expected)
+    {
+    std::cerr << "GetMatrixTransformToWorld failed: translation is "
+              << toWorld->GetElement(0, 3) << " instead of " << expected
+              << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+// The transforms to world are cached, make sure the cache follows the
+// modifications of the hierarchy.
+bool TestTransformToWorldCache()
+{
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLLinearTransformNode> root;
+  vtkNew<vtkMRMLLinearTransformNode> middle;
+  vtkNew<vtkMRMLLinearTransformNode> leaf;
+  scene->AddNode(root.GetPointer());
+  scene->AddNode(middle.GetPointer());
+  scene->AddNode(leaf.GetPointer());
+  middle->SetAndObserveTransformNodeID(root->GetID());
+  leaf->SetAndObserveTransformNodeID(middle->GetID());
+
+  root->GetMatrixTransformToParent()->SetElement(0, 3, 1.);
+  middle->GetMatrixTransformToParent()->SetElement(0, 3, 10.);
+  leaf->GetMatrixTransformToParent()->SetElement(0, 3, 100.);
+  if (!CheckTranslationToWorld(leaf.GetPointer(), 111.) ||
+      !CheckTranslationToWorld(leaf.GetPointer(), 111.))
+    {
+    return false;
+    }
+
+  // modify an ancestor
+  root->GetMatrixTransformToParent()->SetElement(0, 3, 2.);
+  if (!CheckTranslationToWorld(leaf.GetPointer(), 112.))
+    {
+    return false;
+    }
+
+  // replace the matrix of an ancestor
+  vtkNew<vtkMatrix4x4> matrix;
+  matrix->SetElement(0, 3, 20.);
+  middle->SetAndObserveMatrixTransformToParent(matrix.GetPointer());
+  if (!CheckTranslationToWorld(leaf.GetPointer(), 122.))
+    {
+    return false;
+    }
+
+  // change the hierarchy
+  leaf->SetAndObserveTransformNodeID(root->GetID());
+  if (!CheckTranslationToWorld(leaf.GetPointer(), 102.) ||
+      !CheckTranslationToWorld(middle.GetPointer(), 22.))
+    {
+    return false;
+    }
+  scene->RemoveNode(root.GetPointer());
+  if (!CheckTranslationToWorld(leaf.GetPointer(), 100.))
+    {
+    return false;
+    }
+  return true;
+}
+
+} // end of anonymous namespace
 
 //---------------------------------------------------------------------------
 int vtkMRMLLinearTransformNodeTest1(int , char * [] )
@@ -26,5 +104,10 @@ int vtkMRMLLinearTransformNodeTest1(int , char * [] )
 
   EXERCISE_BASIC_TRANSFORM_MRML_METHODS(vtkMRMLLinearTransformNode, node1);
 
+  if (!TestTransformToWorldCache())
+    {
+    return EXIT_FAILURE;
+    }
+
   return EXIT_SUCCESS;
 }
@@ -16,11 +16,13 @@
 
 // VTK includes
 #include <vtkDataSetAttributes.h>
+#include <vtkPointData.h>
 #include <vtkPolyData.h>
 
 //---------------------------------------------------------------------------
 int ExerciseBasicMethods();
 bool TestActiveScalars();
+bool TestCopyOnWrite();
 
 //---------------------------------------------------------------------------
 int vtkMRMLModelNodeTest1(int , char * [] )
@@ -37,6 +39,11 @@ int vtkMRMLModelNodeTest1(int , char * [] )
     std::cerr << __LINE__ << ": TestActiveScalars() failed" << std::endl;
     return EXIT_FAILURE;
     }
+  if (!TestCopyOnWrite())
+    {
+    std::cerr << __LINE__ << ": TestCopyOnWrite() failed" << std::endl;
+    return EXIT_FAILURE;
+    }
   return EXIT_SUCCESS;
 }
 
@@ -74,3 +81,44 @@ bool TestActiveScalars()
 
   return true;
 }
+
+//---------------------------------------------------------------------------
+bool TestCopyOnWrite()
+{
+  vtkSmartPointer< vtkMRMLModelNode > node1 = vtkSmartPointer< vtkMRMLModelNode >::New();
+  vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+  node1->SetAndObservePolyData(polyData);
+
+  vtkSmartPointer< vtkMRMLModelNode > node2 = vtkSmartPointer< vtkMRMLModelNode >::New();
+  node2->Copy(node1);
+  if (node2->GetPolyData() != polyData ||
+      !node1->GetPolyDataShared() || !node2->GetPolyDataShared())
+    {
+    std::cerr << __LINE__ << ": Copy() should share the polydata" << std::endl;
+    return false;
+    }
+
+  // adding scalars to the copy must not modify the copied node
+  vtkSmartPointer<vtkIntArray> testingArray = vtkSmartPointer <vtkIntArray>::New();
+  testingArray->SetName("testingArray");
+  node2->AddPointScalars(testingArray);
+  if (node2->GetPolyData() == polyData ||
+      node2->GetPolyDataShared() ||
+      polyData->GetPointData()->HasArray("testingArray") ||
+      !node2->GetPolyData()->GetPointData()->HasArray("testingArray"))
+    {
+    std::cerr << __LINE__ << ": AddPointScalars() should detach the polydata"
+              << std::endl;
+    return false;
+    }
+
+  // the copied node still flags its polydata as shared
+  vtkPolyData* writablePolyData = node1->GetPolyDataForWrite();
+  if (writablePolyData == polyData || node1->GetPolyDataShared() ||
+      node1->GetPolyDataForWrite() != writablePolyData)
+    {
+    std::cerr << __LINE__ << ": GetPolyDataForWrite() failed" << std::endl;
+    return false;
+    }
+  return true;
+}
@@ -187,6 +187,13 @@ bool TestAddReferenceNodeID()
     return false;
     }
 
+  /// Querying a role doesn't add it
+  if (referencingNode->GetInternalReferencedNodes().count(role1) != 0)
+    {
+    std::cout << __LINE__ << ": GetNumberOfNodeReferences failed" << std::endl;
+    return false;
+    }
+
   /// Add empty referenced node with a role
   returnNode = referencingNode->AddAndObserveNodeReferenceID(role1.c_str(), 0);
   if (referencingNode->GetNumberOfNodeReferences(role1.c_str()) != 0 ||
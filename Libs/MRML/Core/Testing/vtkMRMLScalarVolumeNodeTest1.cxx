@@ -11,11 +11,89 @@
 =========================================================================auto=*/
 
 #include "vtkMRMLScalarVolumeNode.h"
+#include <vtkImageData.h>
 #include <vtkPolyData.h>
 
 
 #include "vtkMRMLCoreTestingMacros.h"
 
+//---------------------------------------------------------------------------
+bool TestImageStatistics()
+{
+  vtkSmartPointer< vtkMRMLScalarVolumeNode > node = vtkSmartPointer< vtkMRMLScalarVolumeNode >::New();
+  double range[2] = {0., 0.};
+  if (node->GetImageScalarRange(range) || node->GetImageHistogram() != 0)
+    {
+    std::cerr << "Line " << __LINE__
+              << " - Statistics without image data" << std::endl;
+    return false;
+    }
+
+  // values from -10 to 89, each value 10 times
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(10, 10, 10);
+  image->SetScalarTypeToShort();
+  image->SetNumberOfScalarComponents(1);
+  image->AllocateScalars();
+  short* values = static_cast<short*>(image->GetScalarPointer());
+  for (int i = 0; i < 1000; ++i)
+    {
+    values[i] = static_cast<short>(i % 100 - 10);
+    }
+  node->SetAndObserveImageData(image);
+
+  double percentile = 0.;
+  vtkImageData* histogram = node->GetImageHistogram();
+  if (!node->GetImageScalarRange(range) ||
+      range[0] != -10. || range[1] != 89. ||
+      histogram == 0 ||
+      static_cast<int*>(histogram->GetScalarPointer())[32768 - 10] != 10 ||
+      static_cast<int*>(histogram->GetScalarPointer())[32768 + 90] != 0 ||
+      !node->GetImageScalarPercentile(0.5, percentile) || percentile != 39.)
+    {
+    std::cerr << "Line " << __LINE__
+              << " - Problem with the statistics: range " << range[0] << " "
+              << range[1] << " median " << percentile << std::endl;
+    return false;
+    }
+
+  // the statistics are recomputed when the image data is modified
+  values[0] = 200;
+  image->Modified();
+  if (!node->GetImageScalarRange(range) || range[1] != 200. ||
+      node->GetImageHistogram() != histogram ||
+      static_cast<int*>(histogram->GetScalarPointer())[32768 + 200] != 1)
+    {
+    std::cerr << "Line " << __LINE__
+              << " - Statistics not updated: range " << range[0] << " "
+              << range[1] << std::endl;
+    return false;
+    }
+
+  // no histogram for floating point images
+  vtkSmartPointer<vtkImageData> floatImage = vtkSmartPointer<vtkImageData>::New();
+  floatImage->SetDimensions(4, 4, 1);
+  floatImage->SetScalarTypeToFloat();
+  floatImage->SetNumberOfScalarComponents(1);
+  floatImage->AllocateScalars();
+  float* floatValues = static_cast<float*>(floatImage->GetScalarPointer());
+  for (int i = 0; i < 16; ++i)
+    {
+    floatValues[i] = 0.5f * i;
+    }
+  node->SetAndObserveImageData(floatImage);
+  if (!node->GetImageScalarRange(range) || range[0] != 0. || range[1] != 7.5 ||
+      node->GetImageHistogram() != 0 ||
+      node->GetImageScalarPercentile(0.5, percentile))
+    {
+    std::cerr << "Line " << __LINE__
+              << " - Problem with the float statistics" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//---------------------------------------------------------------------------
 int vtkMRMLScalarVolumeNodeTest1(int , char * [] )
 {
   vtkSmartPointer< vtkMRMLScalarVolumeNode > node1 = vtkSmartPointer< vtkMRMLScalarVolumeNode >::New();
@@ -24,5 +102,10 @@ int vtkMRMLScalarVolumeNodeTest1(int , char * [] )
 
   EXERCISE_BASIC_DISPLAYABLE_MRML_METHODS(vtkMRMLScalarVolumeNode, node1);
 
+  if (!TestImageStatistics())
+    {
+    return EXIT_FAILURE;
+    }
+
   return EXIT_SUCCESS;
 }
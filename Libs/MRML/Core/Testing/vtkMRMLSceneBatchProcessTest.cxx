@@ -29,6 +29,7 @@
 
 // STD includes
 #include <iostream>
+#include <vector>
 
 //---------------------------------------------------------------------------
 int vtkMRMLSceneBatchProcessTest(
@@ -434,5 +435,37 @@ int vtkMRMLSceneBatchProcessTest(
     }
   callback->CalledEvents.clear();
 
+  //---------------------------------------------------------------------------
+  // AddNodes
+  //---------------------------------------------------------------------------
+  // Fires:
+  // 1) StartBatchProcessEvent
+  // 2) NodesAddedEvent
+  // 3) EndBatchProcessEvent
+  vtkNew<vtkMRMLModelNode> modelNode2;
+  vtkNew<vtkMRMLModelNode> modelNode3;
+  std::vector<vtkMRMLNode*> nodesToAdd;
+  nodesToAdd.push_back(modelNode2.GetPointer());
+  nodesToAdd.push_back(modelNode3.GetPointer());
+  int numberOfAddedNodes = scene->AddNodes(nodesToAdd);
+
+  if (numberOfAddedNodes != 2 ||
+      scene->IsBatchProcessing() != false ||
+      scene->GetNodeByID(modelNode3->GetID()) != modelNode3.GetPointer() ||
+      callback->CalledEvents.size() != 3 ||
+      callback->CalledEvents[vtkMRMLScene::StartBatchProcessEvent] != 1 ||
+      callback->CalledEvents[vtkMRMLScene::NodesAddedEvent] != 1 ||
+      callback->CalledEvents[vtkMRMLScene::EndBatchProcessEvent] != 1)
+    {
+    std::cerr << "Wrong fired events: "
+              << callback->CalledEvents.size() << " event(s) fired." << std::endl
+              << callback->CalledEvents[vtkMRMLScene::StartBatchProcessEvent] << " "
+              << callback->CalledEvents[vtkMRMLScene::NodesAddedEvent] << " "
+              << callback->CalledEvents[vtkMRMLScene::EndBatchProcessEvent]
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+  callback->CalledEvents.clear();
+
   return EXIT_SUCCESS;
 }
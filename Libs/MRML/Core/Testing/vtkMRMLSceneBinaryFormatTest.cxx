@@ -0,0 +1,92 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkMRMLModelDisplayNode.h"
+#include "vtkMRMLModelNode.h"
+#include "vtkMRMLParser.h"
+#include "vtkMRMLScene.h"
+
+// VTK includes
+#include <vtkNew.h>
+
+// STD includes
+#include <iostream>
+
+//---------------------------------------------------------------------------
+int vtkMRMLSceneBinaryFormatTest(
+  int vtkNotUsed(argc), char * vtkNotUsed(argv) [] )
+{
+  vtkNew<vtkMRMLScene> scene;
+
+  vtkNew<vtkMRMLModelDisplayNode> displayNode;
+  displayNode->SetColor(0.5, 0.25, 1.0);
+  scene->AddNode(displayNode.GetPointer());
+
+  vtkNew<vtkMRMLModelNode> modelNode;
+  modelNode->SetName("Model & more");
+  modelNode->SetDescription("first line");
+  modelNode->SetAndObserveDisplayNodeID(displayNode->GetID());
+  scene->AddNode(modelNode.GetPointer());
+
+  scene->SetSaveToXMLString(1);
+  scene->SetSaveToBinaryFormat(1);
+  scene->Commit();
+  const std::string& binaryScene = scene->GetSceneXMLString();
+  if (!vtkMRMLParser::IsBinaryScene(binaryScene.c_str(), binaryScene.size()))
+    {
+    std::cerr << __LINE__ << " Commit failed to write a binary scene" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  vtkNew<vtkMRMLScene> scene2;
+  scene2->SetLoadFromXMLString(1);
+  scene2->SetSceneXMLString(binaryScene);
+  scene2->Import();
+
+  vtkMRMLModelNode* modelNode2 = vtkMRMLModelNode::SafeDownCast(
+    scene2->GetNodeByID(modelNode->GetID()));
+  if (!modelNode2 ||
+      strcmp(modelNode2->GetName(), "Model & more") != 0 ||
+      strcmp(modelNode2->GetDescription(), "first line") != 0)
+    {
+    std::cerr << __LINE__ << " ParseBinary failed to restore the model node"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+  vtkMRMLModelDisplayNode* displayNode2 = vtkMRMLModelDisplayNode::SafeDownCast(
+    modelNode2->GetDisplayNode());
+  if (!displayNode2 ||
+      displayNode2->GetColor()[0] != 0.5 ||
+      displayNode2->GetColor()[1] != 0.25 ||
+      displayNode2->GetColor()[2] != 1.0)
+    {
+    std::cerr << __LINE__ << " ParseBinary failed to restore the display node"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // A truncated buffer must be rejected
+  vtkNew<vtkMRMLParser> parser;
+  parser->SetMRMLScene(scene2.GetPointer());
+  if (parser->ParseBinary(binaryScene.c_str(), 12) != 0)
+    {
+    std::cerr << __LINE__ << " ParseBinary accepted a truncated buffer"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,152 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkMRMLModelDisplayNode.h"
+#include "vtkMRMLModelNode.h"
+#include "vtkMRMLModelStorageNode.h"
+#include "vtkMRMLScene.h"
+#include "vtkMRMLSelectionNode.h"
+
+// VTK includes
+#include <vtkCallbackCommand.h>
+#include <vtkNew.h>
+
+// STD includes
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+//---------------------------------------------------------------------------
+void RecordRemovedNode(vtkObject* caller, unsigned long eventId,
+                       void* clientData, void* callData)
+{
+  vtkMRMLScene* scene = vtkMRMLScene::SafeDownCast(caller);
+  vtkMRMLNode* node = reinterpret_cast<vtkMRMLNode*>(callData);
+  std::vector<vtkMRMLNode*>* removedNodes =
+    reinterpret_cast<std::vector<vtkMRMLNode*>*>(clientData);
+  if (eventId != vtkMRMLScene::NodeRemovedEvent || !scene->IsClosing())
+    {
+    return;
+    }
+  // The nodes are detached from the scene before being removed
+  if (scene->GetNodeByID(node->GetID()) != 0 || node->GetScene() != 0)
+    {
+    return;
+    }
+  removedNodes->push_back(node);
+}
+
+//---------------------------------------------------------------------------
+int indexOf(const std::vector<vtkMRMLNode*>& nodes, vtkMRMLNode* node)
+{
+  std::vector<vtkMRMLNode*>::const_iterator it =
+    std::find(nodes.begin(), nodes.end(), node);
+  return it != nodes.end() ? static_cast<int>(it - nodes.begin()) : -1;
+}
+}
+
+//---------------------------------------------------------------------------
+int vtkMRMLSceneClearTest(
+  int vtkNotUsed(argc), char * vtkNotUsed(argv) [] )
+{
+  vtkNew<vtkMRMLScene> scene;
+
+  // The referenced nodes are added before the nodes that reference them
+  vtkNew<vtkMRMLModelDisplayNode> display;
+  scene->AddNode(display.GetPointer());
+  vtkNew<vtkMRMLModelStorageNode> storage;
+  scene->AddNode(storage.GetPointer());
+  vtkNew<vtkMRMLModelNode> model;
+  scene->AddNode(model.GetPointer());
+  model->SetAndObserveDisplayNodeID(display->GetID());
+  model->SetAndObserveStorageNodeID(storage->GetID());
+  vtkNew<vtkMRMLModelNode> model2;
+  scene->AddNode(model2.GetPointer());
+
+  vtkNew<vtkMRMLSelectionNode> selection;
+  selection->SetSingletonTag("Singleton");
+  scene->AddNode(selection.GetPointer());
+
+  // Populate the caches
+  if (scene->GetNumberOfNodesByClass("vtkMRMLModelNode") != 2 ||
+      scene->GetNodeByID(model->GetID()) != model.GetPointer())
+    {
+    std::cerr << __LINE__ << " Failed to populate the scene" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::vector<vtkMRMLNode*> removedNodes;
+  vtkNew<vtkCallbackCommand> callback;
+  callback->SetCallback(RecordRemovedNode);
+  callback->SetClientData(&removedNodes);
+  scene->AddObserver(vtkMRMLScene::NodeRemovedEvent, callback.GetPointer());
+
+  // Keep the singletons
+  scene->Clear(0);
+
+  if (removedNodes.size() != 4 ||
+      indexOf(removedNodes, model.GetPointer()) == -1 ||
+      indexOf(removedNodes, model.GetPointer()) >
+        indexOf(removedNodes, display.GetPointer()) ||
+      indexOf(removedNodes, model.GetPointer()) >
+        indexOf(removedNodes, storage.GetPointer()) ||
+      indexOf(removedNodes, model2.GetPointer()) == -1)
+    {
+    std::cerr << __LINE__ << " Clear(0) failed to remove the nodes in the"
+              << " dependency order: " << removedNodes.size() << " node(s)"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (scene->GetNumberOfNodes() != 1 ||
+      scene->GetNumberOfNodesByClass("vtkMRMLModelNode") != 0 ||
+      scene->GetNodeByID(model->GetID()) != 0 ||
+      scene->GetNodeByID(selection->GetID()) != selection.GetPointer())
+    {
+    std::cerr << __LINE__ << " Clear(0) failed to keep the singletons only"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The scene is usable after being cleared
+  vtkNew<vtkMRMLModelNode> model3;
+  scene->AddNode(model3.GetPointer());
+  if (scene->GetNumberOfNodes() != 2 ||
+      scene->GetNumberOfNodesByClass("vtkMRMLModelNode") != 1 ||
+      scene->GetNodeByID(model3->GetID()) != model3.GetPointer())
+    {
+    std::cerr << __LINE__ << " Failed to add a node after Clear(0)"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  removedNodes.clear();
+  scene->Clear(1);
+
+  if (removedNodes.size() != 2 ||
+      scene->GetNumberOfNodes() != 0 ||
+      scene->GetNodeByID(selection->GetID()) != 0 ||
+      selection->GetScene() != 0)
+    {
+    std::cerr << __LINE__ << " Clear(1) failed to remove all the nodes: "
+              << removedNodes.size() << " node(s)" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
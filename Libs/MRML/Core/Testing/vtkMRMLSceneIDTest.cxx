@@ -189,5 +189,32 @@ int vtkMRMLSceneIDTest(
     return EXIT_FAILURE;
     }
 
+  //---------------------------------------------------------------------------
+  // GenerateUniqueName after renaming and removing nodes
+  //---------------------------------------------------------------------------
+  // Renaming a node of the scene must be taken into account.
+  node->SetName("Node Name_6");
+  nodeName = scene->GenerateUniqueName(baseName);
+  if (nodeName != std::string("Node Name_7"))
+    {
+    std::cerr << "GenerateUniqueName failed: " << nodeName << std::endl;
+    return EXIT_FAILURE;
+    }
+  nodeName = scene->GenerateUniqueName(std::string("Node Name_4"));
+  if (nodeName != std::string("Node Name_4_2"))
+    {
+    std::cerr << "GenerateUniqueName failed: " << nodeName << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The name of a removed node is available again.
+  scene->RemoveNode(node.GetPointer());
+  nodeName = scene->GenerateUniqueName(std::string("Node Name_6"));
+  if (nodeName != std::string("Node Name_6"))
+    {
+    std::cerr << "GenerateUniqueName failed: " << nodeName << std::endl;
+    return EXIT_FAILURE;
+    }
+
   return EXIT_SUCCESS;
 }
@@ -23,9 +23,12 @@
 #include "vtkMRMLModelNode.h"
 #include "vtkMRMLScene.h"
 
-// STD includes
+// VTK includes
 #include <vtkNew.h>
 
+// STD includes
+#include <algorithm>
+
 //---------------------------------------------------------------------------
 int vtkMRMLSceneImportIDConflictTest(int vtkNotUsed(argc), char * vtkNotUsed(argv) [])
 {
@@ -100,5 +103,21 @@ int vtkMRMLSceneImportIDConflictTest(int vtkNotUsed(argc), char * vtkNotUsed(arg
     return EXIT_FAILURE;
     }
 
+  // the reverse reference graph follows the remapped IDs
+  vtkMRMLScene::ReferenceGraphType graph;
+  scene->GetReferenceGraph(graph);
+  std::vector<vtkMRMLNode*>& referencingNodes = graph["vtkMRMLModelDisplayNode3"];
+  std::vector<std::string> roles;
+  modelNode2->GetNodeReferenceRoles("vtkMRMLModelDisplayNode3", roles);
+  if (std::find(referencingNodes.begin(), referencingNodes.end(),
+                modelNode2) == referencingNodes.end() ||
+      roles.size() != 1 || roles[0] != "display")
+    {
+    std::cerr << "Failed to build the reference graph: "
+              << referencingNodes.size() << " referencing nodes, "
+              << roles.size() << " roles" << std::endl;
+    return EXIT_FAILURE;
+    }
+
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,98 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkMRMLScalarVolumeNode.h"
+#include "vtkMRMLScene.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkNew.h>
+
+// STD includes
+#include <iostream>
+
+//---------------------------------------------------------------------------
+int vtkMRMLSceneMemorySizeTest(
+  int vtkNotUsed(argc), char * vtkNotUsed(argv) [] )
+{
+  vtkNew<vtkMRMLScene> scene;
+
+  vtkNew<vtkImageData> imageData;
+  imageData->SetDimensions(64, 64, 64);
+  imageData->SetScalarTypeToShort();
+  imageData->AllocateScalars();
+  unsigned long imageSize = imageData->GetActualMemorySize();
+
+  vtkNew<vtkMRMLScalarVolumeNode> volumeNode;
+  volumeNode->SetAndObserveImageData(imageData.GetPointer());
+  scene->AddNode(volumeNode.GetPointer());
+
+  if (scene->GetNodeOwnedMemorySize(volumeNode.GetPointer()) != imageSize ||
+      scene->GetNodeSharedMemorySize(volumeNode.GetPointer()) != 0 ||
+      scene->GetNodesMemorySize() != imageSize)
+    {
+    std::cerr << __LINE__ << " GetNodeOwnedMemorySize failed: "
+              << scene->GetNodeOwnedMemorySize(volumeNode.GetPointer())
+              << " instead of " << imageSize << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // A copy shares the image data, it is counted once
+  vtkNew<vtkMRMLScalarVolumeNode> copyNode;
+  copyNode->Copy(volumeNode.GetPointer());
+  scene->AddNode(copyNode.GetPointer());
+
+  if (scene->GetNodeOwnedMemorySize(volumeNode.GetPointer()) != 0 ||
+      scene->GetNodeSharedMemorySize(volumeNode.GetPointer()) != imageSize ||
+      scene->GetNodesMemorySize() != imageSize)
+    {
+    std::cerr << __LINE__ << " GetNodeSharedMemorySize failed: "
+              << scene->GetNodeSharedMemorySize(volumeNode.GetPointer())
+              << " instead of " << imageSize << std::endl;
+    return EXIT_FAILURE;
+    }
+  scene->RemoveNode(copyNode.GetPointer());
+
+  // The saved state shares the image data until the node replaces it
+  scene->SetUndoOn();
+  scene->SaveStateForUndo(volumeNode.GetPointer());
+  if (scene->GetUndoStackDataMemorySize() != 0)
+    {
+    std::cerr << __LINE__ << " GetUndoStackDataMemorySize failed: "
+              << scene->GetUndoStackDataMemorySize() << std::endl;
+    return EXIT_FAILURE;
+    }
+  vtkNew<vtkImageData> newImageData;
+  newImageData->DeepCopy(imageData.GetPointer());
+  volumeNode->SetAndObserveImageData(newImageData.GetPointer());
+  if (scene->GetUndoStackDataMemorySize() != imageSize ||
+      scene->GetNodesMemorySize() != imageSize)
+    {
+    std::cerr << __LINE__ << " GetUndoStackDataMemorySize failed: "
+              << scene->GetUndoStackDataMemorySize()
+              << " instead of " << imageSize << std::endl;
+    return EXIT_FAILURE;
+    }
+  scene->ClearUndoStack();
+  if (scene->GetUndoStackDataMemorySize() != 0)
+    {
+    std::cerr << __LINE__ << " ClearUndoStack failed: "
+              << scene->GetUndoStackDataMemorySize() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
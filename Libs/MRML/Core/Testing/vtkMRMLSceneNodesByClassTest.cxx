@@ -0,0 +1,98 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkMRMLModelDisplayNode.h"
+#include "vtkMRMLModelNode.h"
+#include "vtkMRMLScalarVolumeNode.h"
+#include "vtkMRMLScene.h"
+
+// VTK includes
+#include <vtkCollection.h>
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
+
+// STD includes
+#include <iostream>
+#include <vector>
+
+//---------------------------------------------------------------------------
+int vtkMRMLSceneNodesByClassTest(
+  int vtkNotUsed(argc), char * vtkNotUsed(argv) [] )
+{
+  vtkNew<vtkMRMLScene> scene;
+
+  vtkNew<vtkMRMLModelNode> model1;
+  scene->AddNode(model1.GetPointer());
+  vtkNew<vtkMRMLScalarVolumeNode> volume;
+  scene->AddNode(volume.GetPointer());
+
+  // Query before adding more nodes to populate the cache
+  if (scene->GetNumberOfNodesByClass("vtkMRMLModelNode") != 1 ||
+      scene->GetNumberOfNodesByClass("vtkMRMLDisplayableNode") != 2 ||
+      scene->GetNumberOfNodesByClass("vtkMRMLModelDisplayNode") != 0)
+    {
+    std::cerr << __LINE__ << " GetNumberOfNodesByClass failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The cache must be kept up to date with AddNode
+  vtkNew<vtkMRMLModelDisplayNode> display;
+  scene->AddNode(display.GetPointer());
+  vtkNew<vtkMRMLModelNode> model2;
+  scene->AddNode(model2.GetPointer());
+
+  std::vector<vtkMRMLNode*> displayableNodes;
+  scene->GetNodesByClass("vtkMRMLDisplayableNode", displayableNodes);
+  if (displayableNodes.size() != 3 ||
+      displayableNodes[0] != model1.GetPointer() ||
+      displayableNodes[1] != volume.GetPointer() ||
+      displayableNodes[2] != model2.GetPointer())
+    {
+    std::cerr << __LINE__ << " GetNodesByClass failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (scene->GetNthNodeByClass(1, "vtkMRMLModelNode") != model2.GetPointer() ||
+      scene->GetNthNodeByClass(2, "vtkMRMLModelNode") != 0 ||
+      scene->GetNthNodeByClass(0, "vtkMRMLModelDisplayNode") != display.GetPointer())
+    {
+    std::cerr << __LINE__ << " GetNthNodeByClass failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // ... and RemoveNode
+  scene->RemoveNode(model1.GetPointer());
+  vtkSmartPointer<vtkCollection> models;
+  models.TakeReference(scene->GetNodesByClass("vtkMRMLModelNode"));
+  if (models->GetNumberOfItems() != 1 ||
+      models->GetItemAsObject(0) != model2.GetPointer() ||
+      scene->GetNthNodeByClass(0, "vtkMRMLDisplayableNode") != volume.GetPointer())
+    {
+    std::cerr << __LINE__ << " GetNodesByClass failed after RemoveNode"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  scene->Clear(1);
+  if (scene->GetNumberOfNodesByClass("vtkMRMLNode") != 0)
+    {
+    std::cerr << __LINE__ << " GetNumberOfNodesByClass failed after Clear"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,121 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkMRMLModelNode.h"
+#include "vtkMRMLScene.h"
+
+// VTK includes
+#include <vtkNew.h>
+
+// STD includes
+#include <iostream>
+
+//---------------------------------------------------------------------------
+int vtkMRMLSceneUndoTest(
+  int vtkNotUsed(argc), char * vtkNotUsed(argv) [] )
+{
+  vtkNew<vtkMRMLScene> scene;
+  scene->SetUndoOn();
+
+  vtkNew<vtkMRMLModelNode> modelNode;
+  modelNode->SetName("First");
+  scene->AddNode(modelNode.GetPointer());
+
+  // Modify a node
+  scene->SaveStateForUndo(modelNode.GetPointer());
+  modelNode->SetName("Second");
+  // Save it again: the state of the unmodified node is shared
+  scene->SaveStateForUndo(modelNode.GetPointer());
+  scene->SaveStateForUndo(modelNode.GetPointer());
+  modelNode->SetName("Third");
+
+  if (scene->GetNumberOfUndoLevels() != 3)
+    {
+    std::cerr << __LINE__ << " SaveStateForUndo failed: "
+              << scene->GetNumberOfUndoLevels() << " levels" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  scene->Undo();
+  if (strcmp(modelNode->GetName(), "Second") != 0 ||
+      scene->GetNumberOfRedoLevels() != 1)
+    {
+    std::cerr << __LINE__ << " Undo failed: " << modelNode->GetName()
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+  scene->Undo();
+  scene->Undo();
+  if (strcmp(modelNode->GetName(), "First") != 0)
+    {
+    std::cerr << __LINE__ << " Undo failed: " << modelNode->GetName()
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+  scene->Redo();
+  scene->Redo();
+  scene->Redo();
+  if (strcmp(modelNode->GetName(), "Third") != 0 ||
+      scene->GetNumberOfUndoLevels() != 3)
+    {
+    std::cerr << __LINE__ << " Redo failed: " << modelNode->GetName()
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Removed nodes are restored
+  scene->SaveStateForUndo();
+  scene->RemoveNode(modelNode.GetPointer());
+  scene->Undo();
+  if (scene->GetNodeByID(modelNode->GetID()) != modelNode.GetPointer())
+    {
+    std::cerr << __LINE__ << " Undo failed to restore removed node"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Limit the number of levels
+  scene->ClearUndoStack();
+  scene->SetUndoStackSize(2);
+  for (int i = 0; i < 5; ++i)
+    {
+    scene->SaveStateForUndo(modelNode.GetPointer());
+    }
+  if (scene->GetNumberOfUndoLevels() != 2)
+    {
+    std::cerr << __LINE__ << " UndoStackSize failed: "
+              << scene->GetNumberOfUndoLevels() << " levels" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Limit the memory
+  scene->SetUndoStackSize(0);
+  scene->SetUndoStackMemoryBudget(1);
+  for (int i = 0; i < 5; ++i)
+    {
+    modelNode->SetName(i % 2 ? "Odd" : "Even");
+    scene->SaveStateForUndo(modelNode.GetPointer());
+    }
+  if (scene->GetNumberOfUndoLevels() != 1 ||
+      scene->GetUndoStackMemorySize() == 0)
+    {
+    std::cerr << __LINE__ << " UndoStackMemoryBudget failed: "
+              << scene->GetNumberOfUndoLevels() << " levels" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -41,6 +41,7 @@ bool storeTwice();
 bool storeAndRestoreTwice();
 bool storeTwiceAndRemoveVolume();
 bool references();
+bool shareUnchangedNodes();
 bool storePerformance();
 
 } // end of anonymous namespace
@@ -84,6 +85,11 @@ int vtkMRMLSceneViewNodeStoreSceneTest(int vtkNotUsed(argc),
     std::cerr << "references call not successful." << std::endl;
     return EXIT_FAILURE;
     }
+  if (!shareUnchangedNodes())
+    {
+    std::cerr << "shareUnchangedNodes call not successful." << std::endl;
+    return EXIT_FAILURE;
+    }
   if (!storePerformance())
     {
     std::cerr << "updateNodeIDs call not successful." << std::endl;
@@ -343,6 +349,90 @@ bool references()
   return true;
 }
 
+//---------------------------------------------------------------------------
+bool shareUnchangedNodes()
+{
+  vtkNew<vtkMRMLScene> scene;
+  populateScene(scene.GetPointer());
+  vtkMRMLScalarVolumeDisplayNode* displayNode =
+    vtkMRMLScalarVolumeDisplayNode::SafeDownCast(
+      scene->GetNodeByID("vtkMRMLScalarVolumeDisplayNode1"));
+  displayNode->SetAutoWindowLevel(0);
+  displayNode->SetWindowLevel(100., 50.);
+
+  vtkSmartPointer<vtkMRMLSceneViewNode> firstSceneView =
+    vtkSmartPointer<vtkMRMLSceneViewNode>::New();
+  scene->AddNode(firstSceneView);
+  firstSceneView->StoreScene();
+
+  vtkNew<vtkMRMLSceneViewNode> secondSceneView;
+  scene->AddNode(secondSceneView.GetPointer());
+  secondSceneView->StoreScene();
+
+  // The unchanged display node is shared, the volume node is always copied.
+  vtkMRMLNode* sharedDisplayNode =
+    firstSceneView->GetNodes()->GetNodeByID("vtkMRMLScalarVolumeDisplayNode1");
+  if (sharedDisplayNode == 0 ||
+      secondSceneView->GetNodes()->GetNodeByID("vtkMRMLScalarVolumeDisplayNode1")
+        != sharedDisplayNode ||
+      secondSceneView->GetNodes()->GetNodeByID("vtkMRMLScalarVolumeNode1") ==
+        firstSceneView->GetNodes()->GetNodeByID("vtkMRMLScalarVolumeNode1") ||
+      secondSceneView->GetNodes()->GetNumberOfNodes() != 2)
+    {
+    std::cout << __LINE__ << ": vtkMRMLSceneViewNode::StoreScene() failed"
+              << std::endl;
+    return false;
+    }
+
+  // A modified node is copied.
+  displayNode->SetWindowLevel(200., 50.);
+  vtkNew<vtkMRMLSceneViewNode> thirdSceneView;
+  scene->AddNode(thirdSceneView.GetPointer());
+  thirdSceneView->StoreScene();
+  vtkMRMLScalarVolumeDisplayNode* thirdDisplayNode =
+    vtkMRMLScalarVolumeDisplayNode::SafeDownCast(
+      thirdSceneView->GetNodes()->GetNodeByID("vtkMRMLScalarVolumeDisplayNode1"));
+  if (thirdDisplayNode == 0 ||
+      thirdDisplayNode == sharedDisplayNode ||
+      thirdDisplayNode->GetWindow() != 200.)
+    {
+    std::cout << __LINE__ << ": vtkMRMLSceneViewNode::StoreScene() failed"
+              << std::endl;
+    return false;
+    }
+
+  // Restoring a shared node restores its stored state.
+  secondSceneView->RestoreScene();
+  secondSceneView->RestoreScene();
+  if (displayNode->GetWindow() != 100.)
+    {
+    std::cout << __LINE__ << ": vtkMRMLSceneViewNode::RestoreScene() failed"
+              << std::endl;
+    return false;
+    }
+
+  // The shared node outlives the scene view that copied it.
+  scene->RemoveNode(firstSceneView);
+  firstSceneView = 0;
+  sharedDisplayNode =
+    secondSceneView->GetNodes()->GetNodeByID("vtkMRMLScalarVolumeDisplayNode1");
+  if (sharedDisplayNode == 0 || sharedDisplayNode->GetScene() == 0)
+    {
+    std::cout << __LINE__ << ": vtkMRMLSceneViewNode::StoreScene() failed"
+              << std::endl;
+    return false;
+    }
+  displayNode->SetWindowLevel(300., 50.);
+  secondSceneView->RestoreScene();
+  if (displayNode->GetWindow() != 100.)
+    {
+    std::cout << __LINE__ << ": vtkMRMLSceneViewNode::RestoreScene() failed"
+              << std::endl;
+    return false;
+    }
+  return true;
+}
+
 //---------------------------------------------------------------------------
 bool storePerformance()
 {
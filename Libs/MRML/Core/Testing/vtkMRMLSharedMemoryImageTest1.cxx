@@ -0,0 +1,135 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLScalarVolumeNode.h"
+#include "vtkMRMLSharedMemoryImage.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+
+// STD includes
+#include <sstream>
+
+//----------------------------------------------------------------------------
+int vtkMRMLSharedMemoryImageTest1(int , char * [] )
+{
+  vtkNew<vtkMRMLSharedMemoryImage> segment;
+  EXERCISE_BASIC_OBJECT_METHODS(segment.GetPointer());
+
+  std::stringstream name;
+  name << "vtkMRMLSharedMemoryImageTest1_" << segment.GetPointer();
+  std::string fileName =
+    vtkMRMLSharedMemoryImage::GetSharedMemoryFileName(name.str());
+  if (!vtkMRMLSharedMemoryImage::IsSharedMemoryFileName(fileName.c_str()) ||
+      vtkMRMLSharedMemoryImage::IsSharedMemoryFileName("/tmp/volume.nrrd") ||
+      vtkMRMLSharedMemoryImage::IsSharedMemoryFileName(0))
+    {
+    std::cerr << "Line " << __LINE__
+              << " - Problem with IsSharedMemoryFileName()" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (segment->Open(fileName.c_str()) || segment->IsOpen())
+    {
+    std::cerr << "Line " << __LINE__
+              << " - Open() should fail on a missing segment" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  vtkNew<vtkImageData> image;
+  image->SetDimensions(5, 4, 3);
+  image->SetScalarTypeToShort();
+  image->SetNumberOfScalarComponents(1);
+  image->AllocateScalars();
+  short* voxels = static_cast<short*>(image->GetScalarPointer());
+  for (int i = 0; i < 5 * 4 * 3; ++i)
+    {
+    voxels[i] = static_cast<short>(i - 30);
+    }
+
+  vtkNew<vtkMRMLScalarVolumeNode> volumeNode;
+  volumeNode->SetAndObserveImageData(image.GetPointer());
+  volumeNode->SetSpacing(0.5, 1., 2.);
+  volumeNode->SetOrigin(-10., 20., 30.);
+
+  if (!segment->WriteVolume(fileName.c_str(), volumeNode.GetPointer()) ||
+      !segment->IsOpen() ||
+      segment->GetHeader()->Dimensions[2] != 3 ||
+      segment->GetHeader()->DataSize != 5 * 4 * 3 * sizeof(short))
+    {
+    std::cerr << "Line " << __LINE__
+              << " - Problem with WriteVolume()" << std::endl;
+    vtkMRMLSharedMemoryImage::Remove(fileName.c_str());
+    return EXIT_FAILURE;
+    }
+
+  // Read from another object, as another process would.
+  vtkNew<vtkMRMLSharedMemoryImage> reader;
+  vtkNew<vtkMRMLScalarVolumeNode> readVolumeNode;
+  bool read = reader->ReadVolume(fileName.c_str(), readVolumeNode.GetPointer());
+  segment->Close();
+  if (!vtkMRMLSharedMemoryImage::Remove(fileName.c_str()))
+    {
+    std::cerr << "Line " << __LINE__
+              << " - Problem with Remove()" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (!read || reader->IsOpen() || !readVolumeNode->GetImageData())
+    {
+    std::cerr << "Line " << __LINE__
+              << " - Problem with ReadVolume()" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  vtkImageData* readImage = readVolumeNode->GetImageData();
+  int dimensions[3];
+  readImage->GetDimensions(dimensions);
+  short* readVoxels = static_cast<short*>(readImage->GetScalarPointer());
+  if (dimensions[0] != 5 || dimensions[1] != 4 || dimensions[2] != 3 ||
+      readImage->GetScalarType() != VTK_SHORT ||
+      readImage->GetNumberOfScalarComponents() != 1 ||
+      readVoxels[0] != -30 || readVoxels[59] != 29)
+    {
+    std::cerr << "Line " << __LINE__
+              << " - Voxels differ after ReadVolume()" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  vtkNew<vtkMatrix4x4> ijkToRAS;
+  vtkNew<vtkMatrix4x4> readIJKToRAS;
+  volumeNode->GetIJKToRASMatrix(ijkToRAS.GetPointer());
+  readVolumeNode->GetIJKToRASMatrix(readIJKToRAS.GetPointer());
+  for (int i = 0; i < 4; ++i)
+    {
+    for (int j = 0; j < 4; ++j)
+      {
+      if (ijkToRAS->GetElement(i, j) != readIJKToRAS->GetElement(i, j))
+        {
+        std::cerr << "Line " << __LINE__
+                  << " - IJKToRAS differs after ReadVolume()" << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  // The segment doesn't exist anymore.
+  if (reader->Open(fileName.c_str()))
+    {
+    std::cerr << "Line " << __LINE__
+              << " - Segment still exists after Remove()" << std::endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
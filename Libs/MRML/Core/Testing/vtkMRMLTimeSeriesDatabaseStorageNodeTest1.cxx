@@ -0,0 +1,52 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) 
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#include "vtkMRMLScalarVolumeNode.h"
+#include "vtkMRMLTimeSeriesDatabaseStorageNode.h"
+#include "vtkURIHandler.h"
+#include <vtkStringArray.h>
+
+
+#include "vtkMRMLCoreTestingMacros.h"
+
+int vtkMRMLTimeSeriesDatabaseStorageNodeTest1(int , char * [] )
+{
+  vtkSmartPointer< vtkMRMLTimeSeriesDatabaseStorageNode > node1 = vtkSmartPointer< vtkMRMLTimeSeriesDatabaseStorageNode >::New();
+
+  EXERCISE_BASIC_OBJECT_METHODS( node1 );
+
+  EXERCISE_BASIC_STORAGE_MRML_METHODS(vtkMRMLTimeSeriesDatabaseStorageNode, node1);
+
+  TEST_SET_GET_INT_RANGE(node1, CurrentImage, 0, 10);
+  TEST_SET_GET_INT_RANGE(node1, PrefetchTimePoints, 0, 4);
+  TEST_SET_GET_DOUBLE_RANGE(node1, CacheSizeInMiB, 1., 1024.);
+
+  vtkSmartPointer<vtkMRMLScalarVolumeNode> volumeNode = vtkSmartPointer<vtkMRMLScalarVolumeNode>::New();
+  if (!node1->CanReadInReferenceNode(volumeNode) ||
+      node1->CanWriteFromReferenceNode(volumeNode))
+    {
+    std::cerr << "Line " << __LINE__
+              << " - Only reading in scalar volumes is supported" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // No database to connect to
+  node1->SetFileName("nonexistent.tsd");
+  if (node1->GetNumberOfImages() != 0)
+    {
+    std::cerr << "Line " << __LINE__
+              << " - Problem with GetNumberOfImages()" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -19,6 +19,7 @@
 // VTK includes
 #include <vtkMatrix4x4.h>
 #include <vtkNew.h>
+#include <vtkPoints.h>
 
 //---------------------------------------------------------------------------
 class vtkMRMLTransformableNodeTestHelper1 : public vtkMRMLTransformableNode
@@ -41,6 +42,7 @@ public:
 
 //---------------------------------------------------------------------------
 bool TestSetAndObserveTransformNodeID();
+bool TestTransformPoints();
 
 //---------------------------------------------------------------------------
 int vtkMRMLTransformableNodeTest1(int , char * [] )
@@ -53,6 +55,7 @@ int vtkMRMLTransformableNodeTest1(int , char * [] )
 
   bool res = true;
   res = TestSetAndObserveTransformNodeID() && res;
+  res = TestTransformPoints() && res;
   return res ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
@@ -87,3 +90,52 @@ bool TestSetAndObserveTransformNodeID()
     }
   return true;
 }
+
+//---------------------------------------------------------------------------
+bool TestTransformPoints()
+{
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLTransformableNodeTestHelper1> transformable;
+  scene->AddNode(transformable.GetPointer());
+
+  vtkNew<vtkMRMLLinearTransformNode> transform;
+  scene->AddNode(transform.GetPointer());
+  vtkNew<vtkMatrix4x4> matrix;
+  matrix->SetElement(0,0, 2.);
+  matrix->SetElement(1,3, 1.);
+  transform->SetAndObserveMatrixTransformToParent(matrix.GetPointer());
+  transformable->SetAndObserveTransformNodeID(transform->GetID());
+
+  double points[6] = {1., 0., 0., 0., 2., 3.};
+  transformable->TransformPointsToWorld(points, 2);
+  if (points[0] != 2. || points[1] != 1. || points[2] != 0. ||
+      points[3] != 0. || points[4] != 3. || points[5] != 3.)
+    {
+    std::cout << __LINE__ << "TransformPointsToWorld failed"
+              << std::endl;
+    return false;
+    }
+  transformable->TransformPointsFromWorld(points, 2);
+  if (points[0] != 1. || points[1] != 0. || points[2] != 0. ||
+      points[3] != 0. || points[4] != 2. || points[5] != 3.)
+    {
+    std::cout << __LINE__ << "TransformPointsFromWorld failed"
+              << std::endl;
+    return false;
+    }
+
+  // float points are converted
+  vtkNew<vtkPoints> floatPoints;
+  floatPoints->SetDataTypeToFloat();
+  floatPoints->InsertNextPoint(1., 0., 0.);
+  transformable->TransformPointsToWorld(floatPoints.GetPointer());
+  double point[3];
+  floatPoints->GetPoint(0, point);
+  if (point[0] != 2. || point[1] != 1. || point[2] != 0.)
+    {
+    std::cout << __LINE__ << "TransformPointsToWorld failed"
+              << std::endl;
+    return false;
+    }
+  return true;
+}
@@ -0,0 +1,37 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) 
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#include "vtkMRMLVolumeBrickStorageNode.h"
+#include "vtkURIHandler.h"
+#include <vtkStringArray.h>
+
+
+#include "vtkMRMLCoreTestingMacros.h"
+
+int vtkMRMLVolumeBrickStorageNodeTest1(int , char * [] )
+{
+  vtkSmartPointer< vtkMRMLVolumeBrickStorageNode > node1 = vtkSmartPointer< vtkMRMLVolumeBrickStorageNode >::New();
+
+  EXERCISE_BASIC_OBJECT_METHODS( node1 );
+
+  EXERCISE_BASIC_STORAGE_MRML_METHODS(vtkMRMLVolumeBrickStorageNode, node1);
+
+  if (std::string(node1->GetDefaultWriteFileExtension()) != "bvol" ||
+      node1->GetSupportedWriteFileTypes()->GetNumberOfValues() != 1)
+    {
+    std::cerr << "Line " << __LINE__
+              << " - Problem with the supported write file types" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
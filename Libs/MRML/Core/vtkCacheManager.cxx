@@ -8,13 +8,207 @@
 #include <vtksys/SystemTools.hxx>
 
 #include <vtkCallbackCommand.h>
+#include <vtkCriticalSection.h>
 #include <vtkObjectFactory.h>
 
+// STD includes
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
 vtkStandardNewMacro ( vtkCacheManager );
 vtkCxxRevisionMacro ( vtkCacheManager, "$Revision: 1.0 $" );
 
 #define MB 1000000.0
 
+//----------------------------------------------------------------------------
+class vtkCacheManager::vtkInternal
+{
+public:
+  struct FileInfo
+    {
+    FileInfo() : Size(0.), ModifiedTime(0), AccessTime(0) {}
+    /// in bytes
+    double Size;
+    long ModifiedTime;
+    long AccessTime;
+    /// size and hash of the content, empty if it has not been computed
+    std::string Hash;
+    };
+  typedef std::map<std::string, FileInfo> FileMap;
+
+  vtkInternal() : Size(0.) {}
+
+  void Insert(const std::string& path, const FileInfo& info);
+  void Remove(const std::string& path);
+  void Clear();
+
+  /// Cached files by full path
+  FileMap Files;
+  /// Full paths of the cached files by file name
+  std::multimap<std::string, std::string> Names;
+  /// Number of cached files sharing a content
+  std::map<std::string, int> Contents;
+  /// A cached file for each content
+  std::map<std::string, std::string> ContentFiles;
+  /// Size in bytes of the cache, shared contents are counted once.
+  double Size;
+  /// Downloads register their files from the networking threads.
+  vtkSimpleCriticalSection Lock;
+};
+
+//----------------------------------------------------------------------------
+void vtkCacheManager::vtkInternal::Insert(const std::string& path, const FileInfo& info)
+{
+  this->Remove(path);
+  this->Files[path] = info;
+  this->Names.insert(std::make_pair(
+    vtksys::SystemTools::GetFilenameName(path), path));
+  if (info.Hash.empty())
+    {
+    this->Size += info.Size;
+    }
+  else if (++this->Contents[info.Hash] == 1)
+    {
+    this->Size += info.Size;
+    this->ContentFiles[info.Hash] = path;
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkCacheManager::vtkInternal::Remove(const std::string& path)
+{
+  FileMap::iterator it = this->Files.find(path);
+  if (it == this->Files.end())
+    {
+    return;
+    }
+  typedef std::multimap<std::string, std::string>::iterator NameIterator;
+  std::pair<NameIterator, NameIterator> names =
+    this->Names.equal_range(vtksys::SystemTools::GetFilenameName(path));
+  for (NameIterator name = names.first; name != names.second; ++name)
+    {
+    if (name->second == path)
+      {
+      this->Names.erase(name);
+      break;
+      }
+    }
+  const FileInfo info = it->second;
+  this->Files.erase(it);
+  if (info.Hash.empty())
+    {
+    this->Size -= info.Size;
+    }
+  else if (--this->Contents[info.Hash] == 0)
+    {
+    this->Size -= info.Size;
+    this->Contents.erase(info.Hash);
+    this->ContentFiles.erase(info.Hash);
+    }
+  else if (this->ContentFiles[info.Hash] == path)
+    {
+    // another file shares the content
+    for (FileMap::iterator other = this->Files.begin();
+         other != this->Files.end(); ++other)
+      {
+      if (other->second.Hash == info.Hash)
+        {
+        this->ContentFiles[info.Hash] = other->first;
+        break;
+        }
+      }
+    }
+  this->Size = std::max(this->Size, 0.);
+}
+
+//----------------------------------------------------------------------------
+void vtkCacheManager::vtkInternal::Clear()
+{
+  this->Files.clear();
+  this->Names.clear();
+  this->Contents.clear();
+  this->ContentFiles.clear();
+  this->Size = 0.;
+}
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+const char* CACHE_INDEX_FILE_NAME = ".SlicerCacheIndex";
+
+//----------------------------------------------------------------------------
+std::string normalizedPath(const std::string& path)
+{
+  return vtksys::SystemTools::CollapseFullPath(path.c_str());
+}
+
+//----------------------------------------------------------------------------
+/// Size and 64 bits FNV-1a hash of the content of the file, empty if the
+/// file can't be read.
+std::string computeContentHash(const char* filename)
+{
+  FILE* file = fopen(filename, "rb");
+  if (file == NULL)
+    {
+    return std::string();
+    }
+  vtkTypeUInt64 hash = 14695981039346656037ULL;
+  vtkTypeUInt64 size = 0;
+  std::vector<unsigned char> buffer(65536);
+  size_t read = 0;
+  while ((read = fread(&buffer[0], 1, buffer.size(), file)) > 0)
+    {
+    for (size_t i = 0; i < read; ++i)
+      {
+      hash = (hash ^ buffer[i]) * 1099511628211ULL;
+      }
+    size += read;
+    }
+  fclose(file);
+  std::ostringstream key;
+  key << size << "-" << std::hex << hash;
+  return key.str();
+}
+
+//----------------------------------------------------------------------------
+/// Append the full paths of the files under dirname, except the index.
+void listCachedFiles(const std::string& dirname, std::vector<std::string>& files)
+{
+  vtksys::Directory dir;
+  if (!dir.Load(dirname.c_str()))
+    {
+    return;
+    }
+  for (unsigned long fileNum = 0; fileNum < dir.GetNumberOfFiles(); ++fileNum)
+    {
+    const char* name = dir.GetFile(fileNum);
+    if (!strcmp(name, ".") || !strcmp(name, "..") ||
+        !strcmp(name, CACHE_INDEX_FILE_NAME))
+      {
+      continue;
+      }
+    std::string fullName = dirname + "/" + name;
+    if (vtksys::SystemTools::FileIsDirectory(fullName.c_str()))
+      {
+      listCachedFiles(fullName, files);
+      }
+    else
+      {
+      files.push_back(fullName);
+      }
+    }
+}
+
+}
+
 //----------------------------------------------------------------------------
 vtkCacheManager::vtkCacheManager()
 {
@@ -26,16 +220,21 @@ vtkCacheManager::vtkCacheManager()
   this->RemoteCacheFreeBufferSize = 10;
   this->CurrentCacheSize = 0;
   this->EnableForceRedownload = 0;
+  this->EnableCacheEviction = 0;
   this->InsufficientFreeBufferNotificationFlag = 0;
   // this->EnableRemoteCacheOverwriting = 1;
   this->uriMap.clear();
+  this->Internal = new vtkInternal;
 }
 
 
 //----------------------------------------------------------------------------
 vtkCacheManager::~vtkCacheManager()
 {
-   
+  // keep the access times
+  this->SaveCacheIndex();
+  delete this->Internal;
+
   this->MRMLScene = NULL;
   this->uriMap.clear();
   if (this->CallbackCommand)
@@ -57,14 +256,17 @@ const char* vtkCacheManager::GetFileFromURIMap (const char *uri )
 {
   std::string uriString (uri);
 
-    //--- URI is first, local name is second
-    std::map<std::string, std::string>::iterator iter = this->uriMap.find(uriString);
-    if (iter != this->uriMap.end() )
-      {
-      return iter->second.c_str();
-      }
+  //--- URI is first, local name is second
+  const char *file = NULL;
+  this->Internal->Lock.Lock();
+  std::map<std::string, std::string>::iterator iter = this->uriMap.find(uriString);
+  if (iter != this->uriMap.end() )
+    {
+    file = iter->second.c_str();
+    }
+  this->Internal->Lock.Unlock();
 
-  return NULL;
+  return file;
 }
 
 
@@ -80,24 +282,17 @@ void vtkCacheManager::MapFileToURI ( const char *uri, const char *fname )
   std::string remote(uri);
   std::string local(fname);
 
-  std::map <std::string, std::string>::iterator iter;
   //--- see if it's already here and update if so.
-
-    //--- URI is first, local name is second
-  int added = 0;
-  for (iter = this->uriMap.begin();
-       iter != this->uriMap.end();
-       iter++)
+  //--- URI is first, local name is second
+  this->Internal->Lock.Lock();
+  bool added = this->uriMap.insert (std::make_pair (remote, local )).second;
+  if ( !added )
     {
-    if (iter->first == remote )
-      {
-      iter->second = local;
-      added = 1;
-      }
+    this->uriMap[remote] = local;
     }
-  if ( !added )
+  this->Internal->Lock.Unlock();
+  if ( added )
     {
-    this->uriMap.insert (std::make_pair (remote, local ));
     this->Modified();
     }
 }
@@ -255,6 +450,7 @@ void vtkCacheManager::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "RemoteCacheFreeBufferSize: " << this->GetRemoteCacheFreeBufferSize() << "\n";
   //os << indent << "EnableRemoteCacheOverwriting: " << this->GetEnableRemoteCacheOverwriting() << "\n";
   os << indent << "EnableForceRedownload: " << this->GetEnableForceRedownload() << "\n";
+  os << indent << "EnableCacheEviction: " << this->GetEnableCacheEviction() << "\n";
 }
 
 
@@ -270,7 +466,10 @@ std::vector< std::string > vtkCacheManager::GetAllCachedFiles ( )
 //----------------------------------------------------------------------------
 std::vector< std::string > vtkCacheManager::GetCachedFiles ( ) const
 {
-  return this->CachedFileList;
+  this->Internal->Lock.Lock();
+  std::vector< std::string > files = this->CachedFileList;
+  this->Internal->Lock.Unlock();
+  return files;
 }
 
 //----------------------------------------------------------------------------
@@ -308,7 +507,8 @@ int vtkCacheManager::GetCachedFileList ( const char *dirname )
               return (0);
               }
             }
-          else
+          else if ( strcmp ( dir.GetFile(static_cast<unsigned long>(fileNum)),
+                             CACHE_INDEX_FILE_NAME ) )
             {
             this->CachedFileList.push_back ( dir.GetFile(static_cast<unsigned long>(fileNum) ));
             }
@@ -492,6 +692,8 @@ const char* vtkCacheManager::GetFilenameFromURI ( const char *uri )
   vtksys::SystemTools::SplitPath( this->GetRemoteCacheDirectory(), pathComponents);
   pathComponents.push_back ( newFileName );
   fileName = vtksys::SystemTools::JoinPath ( pathComponents );
+  //--- the cached file is used, keep it from being evicted
+  this->TouchCachedFile ( fileName.c_str() );
   
   const char *inStr = fileName.c_str();
   char *returnString = NULL;
@@ -509,20 +711,287 @@ const char* vtkCacheManager::GetFilenameFromURI ( const char *uri )
 //----------------------------------------------------------------------------
 void vtkCacheManager::UpdateCacheInformation ( )
 {
-  //--- now recompute cache size
-  // this->CurrentCacheSize = ?;
+  //--- rescan the cache, recompute its size
+  //--- and refresh list of cached files.
+  this->LoadCacheIndex();
+  this->Modified();
+}
 
-  //--- recompute free buffer size
-  // this->RemoteCacheFreeBufferSize = ?;
+//----------------------------------------------------------------------------
+std::string vtkCacheManager::GetCacheIndexFileName ( )
+{
+  return this->RemoteCacheDirectory + "/" + CACHE_INDEX_FILE_NAME;
+}
 
-  //--- and refresh list of cached files.
+//----------------------------------------------------------------------------
+void vtkCacheManager::LoadCacheIndex ( )
+{
+  //--- read the previous index: the hashes and access times of the
+  //--- files that didn't change are kept.
+  vtkInternal::FileMap previousFiles;
+  std::map<std::string, std::string> previousURIs;
+  std::ifstream index ( this->GetCacheIndexFileName().c_str() );
+  std::string line;
+  while ( std::getline ( index, line ) )
+    {
+    std::vector<std::string> fields;
+    std::string::size_type start = 0;
+    std::string::size_type tab;
+    while ( (tab = line.find ( '\t', start )) != std::string::npos )
+      {
+      fields.push_back ( line.substr ( start, tab - start ) );
+      start = tab + 1;
+      }
+    fields.push_back ( line.substr ( start ) );
+    if ( fields.size() == 6 && fields[0] == "F" )
+      {
+      vtkInternal::FileInfo info;
+      std::istringstream ss ( fields[1] + " " + fields[2] + " " + fields[3] );
+      ss >> info.Size >> info.ModifiedTime >> info.AccessTime;
+      info.Hash = fields[4];
+      previousFiles[this->RemoteCacheDirectory + "/" + fields[5]] = info;
+      }
+    else if ( fields.size() == 3 && fields[0] == "U" )
+      {
+      previousURIs[fields[1]] = this->RemoteCacheDirectory + "/" + fields[2];
+      }
+    }
+  index.close();
+
+  std::vector<std::string> files;
+  if ( !this->RemoteCacheDirectory.empty() )
+    {
+    listCachedFiles ( this->RemoteCacheDirectory, files );
+    }
+
+  this->Internal->Lock.Lock();
+  this->Internal->Clear();
+  for ( size_t i = 0; i < files.size(); ++i )
+    {
+    vtkInternal::FileInfo info;
+    info.Size = static_cast<double>(
+      vtksys::SystemTools::FileLength ( files[i].c_str() ) );
+    info.ModifiedTime = vtksys::SystemTools::ModifiedTime ( files[i].c_str() );
+    info.AccessTime = info.ModifiedTime;
+    vtkInternal::FileMap::const_iterator previous = previousFiles.find ( files[i] );
+    if ( previous != previousFiles.end() &&
+         previous->second.Size == info.Size &&
+         previous->second.ModifiedTime == info.ModifiedTime )
+      {
+      info = previous->second;
+      }
+    this->Internal->Insert ( normalizedPath ( files[i] ), info );
+    }
+  for ( std::map<std::string, std::string>::const_iterator it = previousURIs.begin();
+        it != previousURIs.end(); ++it )
+    {
+    std::string file = normalizedPath ( it->second );
+    if ( this->Internal->Files.count ( file ) )
+      {
+      this->uriMap[it->first] = file;
+      }
+    }
+  this->Internal->Lock.Unlock();
+
+  this->UpdateCachedFileList();
+  this->SaveCacheIndex();
+}
+
+//----------------------------------------------------------------------------
+void vtkCacheManager::SaveCacheIndex ( )
+{
+  if ( this->RemoteCacheDirectory.empty() ||
+       !vtksys::SystemTools::FileIsDirectory ( this->RemoteCacheDirectory.c_str() ) )
+    {
+    return;
+    }
+  std::string indexFileName = this->GetCacheIndexFileName();
+  std::string cacheDirectory = normalizedPath ( this->RemoteCacheDirectory ) + "/";
+
+  this->Internal->Lock.Lock();
+  if ( this->Internal->Files.empty() )
+    {
+    this->Internal->Lock.Unlock();
+    //--- an empty cache directory stays empty (see ClearCacheCheck)
+    vtksys::SystemTools::RemoveFile ( indexFileName.c_str() );
+    return;
+    }
+  //--- paths are saved relative to the cache directory
+  std::ostringstream index;
+  for ( vtkInternal::FileMap::const_iterator it = this->Internal->Files.begin();
+        it != this->Internal->Files.end(); ++it )
+    {
+    if ( it->first.compare ( 0, cacheDirectory.size(), cacheDirectory ) != 0 )
+      {
+      continue;
+      }
+    index << "F\t" << std::fixed << it->second.Size << "\t"
+          << it->second.ModifiedTime << "\t" << it->second.AccessTime << "\t"
+          << it->second.Hash << "\t" << it->first.substr ( cacheDirectory.size() )
+          << "\n";
+    }
+  for ( std::map<std::string, std::string>::const_iterator it = this->uriMap.begin();
+        it != this->uriMap.end(); ++it )
+    {
+    if ( this->Internal->Files.count ( it->second ) &&
+         it->second.compare ( 0, cacheDirectory.size(), cacheDirectory ) == 0 )
+      {
+      index << "U\t" << it->first << "\t"
+            << it->second.substr ( cacheDirectory.size() ) << "\n";
+      }
+    }
+  this->Internal->Lock.Unlock();
+
+  //--- write a temporary file first so that the index is never truncated
+  std::string temporaryFileName = indexFileName + ".tmp";
+  std::ofstream file ( temporaryFileName.c_str() );
+  file << index.str();
+  file.close();
+  if ( !file.fail() )
+    {
+    vtksys::SystemTools::RemoveFile ( indexFileName.c_str() );
+    rename ( temporaryFileName.c_str(), indexFileName.c_str() );
+    }
+  else
+    {
+    vtksys::SystemTools::RemoveFile ( temporaryFileName.c_str() );
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkCacheManager::UpdateCachedFileList ( )
+{
+  this->Internal->Lock.Lock();
   this->CachedFileList.clear();
-  this->GetCachedFileList ( this->GetRemoteCacheDirectory() );
-  this->Modified();
+  for ( vtkInternal::FileMap::const_iterator it = this->Internal->Files.begin();
+        it != this->Internal->Files.end(); ++it )
+    {
+    this->CachedFileList.push_back (
+      vtksys::SystemTools::GetFilenameName ( it->first ) );
+    }
+  this->Internal->Lock.Unlock();
+}
+
+//----------------------------------------------------------------------------
+void vtkCacheManager::AddCachedFile ( const char *uri, const char *filename )
+{
+  if ( filename == NULL || !vtksys::SystemTools::FileExists ( filename ) ||
+       vtksys::SystemTools::FileIsDirectory ( filename ) )
+    {
+    vtkDebugMacro ( "AddCachedFile: no file to add." );
+    return;
+    }
+  std::string path = normalizedPath ( filename );
+
+  vtkInternal::FileInfo info;
+  info.Hash = computeContentHash ( path.c_str() );
+  info.Size = static_cast<double>(
+    vtksys::SystemTools::FileLength ( path.c_str() ) );
+
+  //--- store identical contents once
+  this->Internal->Lock.Lock();
+  std::string sameContent;
+  std::map<std::string, std::string>::const_iterator content =
+    this->Internal->ContentFiles.find ( info.Hash );
+  if ( !info.Hash.empty() && content != this->Internal->ContentFiles.end() &&
+       content->second != path )
+    {
+    sameContent = content->second;
+    }
+  this->Internal->Lock.Unlock();
+#ifndef _WIN32
+  if ( !sameContent.empty() &&
+       !vtksys::SystemTools::FilesDiffer ( sameContent.c_str(), path.c_str() ) )
+    {
+    std::string link = path + ".link";
+    vtksys::SystemTools::RemoveFile ( link.c_str() );
+    if ( ::link ( sameContent.c_str(), link.c_str() ) == 0 &&
+         rename ( link.c_str(), path.c_str() ) == 0 )
+      {
+      vtkDebugMacro ( "AddCachedFile: " << path << " shares the content of " << sameContent );
+      }
+    else
+      {
+      vtksys::SystemTools::RemoveFile ( link.c_str() );
+      }
+    }
+#endif
+  info.ModifiedTime = vtksys::SystemTools::ModifiedTime ( path.c_str() );
+  info.AccessTime = static_cast<long>( time ( NULL ) );
+
+  this->Internal->Lock.Lock();
+  this->Internal->Insert ( path, info );
+  if ( uri != NULL )
+    {
+    this->uriMap[uri] = path;
+    }
+  this->Internal->Lock.Unlock();
+
+  this->UpdateCachedFileList();
+  this->SaveCacheIndex();
 }
 
+//----------------------------------------------------------------------------
+void vtkCacheManager::TouchCachedFile ( const char *filename )
+{
+  if ( filename == NULL )
+    {
+    return;
+    }
+  std::string path = normalizedPath ( filename );
+  this->Internal->Lock.Lock();
+  vtkInternal::FileMap::iterator it = this->Internal->Files.find ( path );
+  if ( it != this->Internal->Files.end() )
+    {
+    it->second.AccessTime = static_cast<long>( time ( NULL ) );
+    }
+  this->Internal->Lock.Unlock();
+}
 
+//----------------------------------------------------------------------------
+int vtkCacheManager::EvictCachedFiles ( float sizeInMB )
+{
+  //--- least recently used first
+  std::vector< std::pair<long, std::string> > files;
+  this->Internal->Lock.Lock();
+  for ( vtkInternal::FileMap::const_iterator it = this->Internal->Files.begin();
+        it != this->Internal->Files.end(); ++it )
+    {
+    files.push_back ( std::make_pair ( it->second.AccessTime, it->first ) );
+    }
+  this->Internal->Lock.Unlock();
+  std::sort ( files.begin(), files.end() );
 
+  int removed = 0;
+  for ( size_t i = 0; i < files.size(); ++i )
+    {
+    this->Internal->Lock.Lock();
+    bool fits = ( this->Internal->Size / MB <= sizeInMB );
+    this->Internal->Lock.Unlock();
+    if ( fits )
+      {
+      break;
+      }
+    this->MarkNodesBeforeDeletingDataFromCache ( files[i].second.c_str() );
+    if ( !vtksys::SystemTools::RemoveFile ( files[i].second.c_str() ) )
+      {
+      vtkWarningMacro ( "EvictCachedFiles: unable to remove cached file " << files[i].second << " from disk." );
+      continue;
+      }
+    this->Internal->Lock.Lock();
+    this->Internal->Remove ( files[i].second );
+    this->Internal->Lock.Unlock();
+    ++removed;
+    }
+  if ( removed > 0 )
+    {
+    vtkDebugMacro ( "EvictCachedFiles: removed " << removed << " files" );
+    this->UpdateCachedFileList();
+    this->SaveCacheIndex();
+    this->InvokeEvent ( vtkCacheManager::CacheDeleteEvent );
+    }
+  return removed;
+}
 
 //----------------------------------------------------------------------------
 void vtkCacheManager::DeleteFromCachedFileList ( const char * target )
@@ -581,7 +1050,25 @@ void vtkCacheManager::DeleteFromCache( const char *target )
         }
       else
         {
-        this->UpdateCacheInformation ( );
+        //--- forget all the files of the directory
+        std::string prefix = normalizedPath ( str ) + "/";
+        this->Internal->Lock.Lock();
+        std::vector<std::string> removedFiles;
+        for ( vtkInternal::FileMap::const_iterator it = this->Internal->Files.begin();
+              it != this->Internal->Files.end(); ++it )
+          {
+          if ( it->first.compare ( 0, prefix.size(), prefix ) == 0 )
+            {
+            removedFiles.push_back ( it->first );
+            }
+          }
+        for ( size_t i = 0; i < removedFiles.size(); ++i )
+          {
+          this->Internal->Remove ( removedFiles[i] );
+          }
+        this->Internal->Lock.Unlock();
+        this->UpdateCachedFileList ( );
+        this->SaveCacheIndex ( );
         this->InvokeEvent ( vtkCacheManager::CacheDeleteEvent );
         }
       }
@@ -593,7 +1080,11 @@ void vtkCacheManager::DeleteFromCache( const char *target )
         }
       else
         {
-        this->UpdateCacheInformation ( );
+        this->Internal->Lock.Lock();
+        this->Internal->Remove ( normalizedPath ( str ) );
+        this->Internal->Lock.Unlock();
+        this->UpdateCachedFileList ( );
+        this->SaveCacheIndex ( );
         this->InvokeEvent ( vtkCacheManager::CacheDeleteEvent );
         }
       }
@@ -663,6 +1154,7 @@ float vtkCacheManager::GetCurrentCacheSize ()
     {
     return (0.0);
     }
+  //--- the size is kept up to date by the index
   float size = this->ComputeCacheSize ( this->RemoteCacheDirectory.c_str(), 0 );
   this->SetCurrentCacheSize ( size );
   return ( this->CurrentCacheSize );
@@ -677,6 +1169,10 @@ void vtkCacheManager::MarkNode ( std::string str )
   //--- If such a node exists, mark it as modified since read,
   //--- so that a user will be prompted to save the
   //--- data elsewhere (since it'll be deleted from cache.)
+  if ( this->MRMLScene == NULL )
+    {
+    return;
+    }
   int nnodes = this->MRMLScene->GetNumberOfNodesByClass ( "vtkMRMLStorableNode" );
   vtkMRMLStorableNode *node;
   std::string uri;
@@ -769,10 +1265,24 @@ void vtkCacheManager::MarkNodesBeforeDeletingDataFromCache (const char *target )
 float vtkCacheManager::ComputeCacheSize( const char *dirName, unsigned long sz )
 {
 
-  //--- Traverses cache directory and computes the combined size
+  //--- The size of the cache directory is given by its index,
+  //--- files with the same content are counted once.
+  if ( dirName != NULL && this->RemoteCacheDirectory == dirName )
+    {
+    if ( !vtksys::SystemTools::FileIsDirectory ( dirName ) )
+      {
+      return (-1);
+      }
+    this->Internal->Lock.Lock();
+    double size = this->Internal->Size;
+    this->Internal->Lock.Unlock();
+    this->CurrentCacheSize = static_cast<float>( (size + sz) / MB );
+    return (this->CurrentCacheSize);
+    }
+
+  //--- Traverses other directories and computes the combined size
   //--- of all files. I guess this is a reasonable guess to the cache size,
   //--- subdirectory size notwithstanding.
-  //--- TODO: is there a more accurate way to assess?
 
   unsigned long cachesize = sz;
   std::string testFile;
@@ -833,6 +1343,13 @@ void vtkCacheManager::CacheSizeCheck()
   
   //--- Compute size of the current cache
   this->ComputeCacheSize(this->RemoteCacheDirectory.c_str(), 0);
+  //--- Make room for the free buffer if allowed to.
+  if ( this->EnableCacheEviction &&
+       this->CurrentCacheSize > (float) (this->RemoteCacheLimit) )
+    {
+    this->EvictCachedFiles ( (float) (this->RemoteCacheLimit - this->RemoteCacheFreeBufferSize) );
+    this->ComputeCacheSize(this->RemoteCacheDirectory.c_str(), 0);
+    }
   //--- Invoke an event if cache size is exceeded.
   if ( this->CurrentCacheSize > (float) (this->RemoteCacheLimit) )
     {
@@ -908,6 +1425,48 @@ const char* vtkCacheManager::FindCachedFile ( const char * target, const char *d
     return ( NULL );
     }   
 
+  //--- Files of the cache directory are looked up in its index,
+  //--- by full path or by name.
+  if ( this->RemoteCacheDirectory == dirname )
+    {
+    std::string targetString = target;
+    std::string found;
+    this->Internal->Lock.Lock();
+    std::multimap<std::string, std::string>::const_iterator name =
+      this->Internal->Names.find ( targetString );
+    if ( name != this->Internal->Names.end() )
+      {
+      found = name->second;
+      }
+    else if ( this->Internal->Files.count ( normalizedPath ( targetString ) ) )
+      {
+      found = normalizedPath ( targetString );
+      }
+    this->Internal->Lock.Unlock();
+    //--- directories are not indexed
+    if ( found.empty() )
+      {
+      std::string subdir = std::string ( dirname ) + "/" + targetString;
+      if ( vtksys::SystemTools::FileIsDirectory ( subdir.c_str() ) )
+        {
+        found = subdir;
+        }
+      else if ( targetString.compare ( 0, strlen ( dirname ), dirname ) == 0 &&
+                vtksys::SystemTools::FileIsDirectory ( target ) )
+        {
+        found = targetString;
+        }
+      }
+    if ( found.empty() )
+      {
+      return ( NULL );
+      }
+    n = found.size() + 1;
+    returnString = new char[n];
+    memcpy ( returnString, found.c_str(), n );
+    return returnString;
+    }
+
   if ( vtksys::SystemTools::FileIsDirectory ( dirname ) )
     {
     vtkDebugMacro("FindCachedFile: dirname is a directory: " << dirname);
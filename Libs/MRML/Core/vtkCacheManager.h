@@ -42,8 +42,32 @@ class VTK_MRML_EXPORT vtkCacheManager : public vtkObject
   const char *GetRemoteCacheDirectory ();
 
   /// 
-  /// Called when a file is loaded or removed from the cache.
+  /// Rescan the cache directory and update the index of the cached files.
+  /// The index is kept up to date by AddCachedFile() and DeleteFromCache(),
+  /// call it only when files are added or removed by other means.
   void UpdateCacheInformation ( );
+
+  /// 
+  /// Record that \a filename in the cache was downloaded from \a uri.
+  /// The file is hashed, and if a cached file with the same content
+  /// already exists, \a filename becomes a hard link to it so that the
+  /// content is stored once. Can be called from any thread.
+  void AddCachedFile ( const char *uri, const char *filename );
+
+  /// 
+  /// Update the access time of a cached file, used to evict the least
+  /// recently used files first.
+  void TouchCachedFile ( const char *filename );
+
+  /// 
+  /// Remove the least recently used files from the cache until its size
+  /// is at most \a sizeInMB. Returns the number of removed files.
+  int EvictCachedFiles ( float sizeInMB );
+
+  /// 
+  /// Write the index of the cached files into the cache directory. It is
+  /// done automatically when files are added or removed.
+  void SaveCacheIndex ( );
   /// 
   /// Removes a target from the list of locally cached files and directories
   void DeleteFromCachedFileList ( const char * target );
@@ -124,6 +148,13 @@ class VTK_MRML_EXPORT vtkCacheManager : public vtkObject
   vtkSetMacro ( RemoteCacheFreeBufferSize, int );
   vtkGetMacro ( EnableForceRedownload, int );
   vtkSetMacro ( EnableForceRedownload, int );
+  /// 
+  /// If set, CacheSizeCheck() evicts the least recently used files
+  /// instead of only invoking CacheLimitExceededEvent when the cache is
+  /// full. Off by default.
+  vtkGetMacro ( EnableCacheEviction, int );
+  vtkSetMacro ( EnableCacheEviction, int );
+  vtkBooleanMacro ( EnableCacheEviction, int );
   //vtkGetMacro ( EnableRemoteCacheOverwriting, int );
   //vtkSetMacro ( EnableRemoteCacheOverwriting, int );
   void SetMRMLScene ( vtkMRMLScene *scene )
@@ -160,6 +191,7 @@ class VTK_MRML_EXPORT vtkCacheManager : public vtkObject
   float CurrentCacheSize;
   int RemoteCacheFreeBufferSize;
   int EnableForceRedownload;
+  int EnableCacheEviction;
   //int EnableRemoteCacheOverwriting;
   vtkMRMLScene *MRMLScene;
 
@@ -172,6 +204,17 @@ class VTK_MRML_EXPORT vtkCacheManager : public vtkObject
   /// with every download, remove from cache, and clearcache call.
   std::vector< std::string > CachedFileList;
 
+  /// Index of the cached files: size, content hash and access time of
+  /// each file, total size of the cache.
+  class vtkInternal;
+  vtkInternal* Internal;
+  /// Name of the index file in the cache directory.
+  std::string GetCacheIndexFileName();
+  /// Load the index and reconcile it with the files in the cache directory.
+  void LoadCacheIndex();
+  /// Rebuild CachedFileList from the index.
+  void UpdateCachedFileList();
+
  protected:
   vtkCacheManager();
   virtual ~vtkCacheManager();
@@ -28,6 +28,7 @@ ITKImageFileFormat FileFormatTable[] =
   {"BMPImageIO", "Uncompressed pixel data in binary with text header", "BMP", ".bmp"},
   {"BMPImageIO", "Uncompressed pixel data in binary with text header", "BMP", ".BMP"},
   {"BioRadImageIO", "Binary header followed by pixel data in binary", "BioRad", ".pic"},
+  {"BrickImageIO", "Independently compressed bricks of pixel data", "Brick Volume", ".bvol"},
  // {"DICOMImageIO2", "Deprecated", "DICOM", "---"},
 
 
@@ -22,8 +22,64 @@
 #include <vtkObjectFactory.h>
 #include <vtkTimerLog.h>
 
+// STD includes
+#include <algorithm>
+#include <set>
+
 vtkCxxSetObjectMacro(vtkEventBroker, TimerLog, vtkTimerLog);
 
+//----------------------------------------------------------------------------
+namespace
+{
+//----------------------------------------------------------------------------
+void RemoveObservationsFromQueue(std::deque< vtkObservation *>& queue,
+                                 const std::set< vtkObservation *>& observations)
+{
+  std::deque< vtkObservation *> newEventQueue;
+  std::deque< vtkObservation *>::iterator queueIter;
+  for(queueIter=queue.begin(); queueIter != queue.end(); queueIter++)
+    {
+    // foreach of the broker's observations see if it is in the list of items to be removed
+    if ( observations.find(*queueIter) == observations.end() )
+      {
+      newEventQueue.push_back( *queueIter );
+      }
+    }
+  queue = newEventQueue;
+}
+
+//----------------------------------------------------------------------------
+template <class MapType>
+void RemoveObservationsFromMap(MapType& map, typename MapType::key_type key,
+                               const std::set< vtkObservation *>& observations)
+{
+  typename MapType::iterator it = map.find(key);
+  if (it == map.end())
+    {
+    return;
+    }
+  std::vector< vtkObservation *> newObservations;
+  newObservations.reserve(it->second.size());
+  std::vector< vtkObservation *>::iterator obsIter;
+  for(obsIter=it->second.begin(); obsIter != it->second.end(); obsIter++)
+    {
+    if (observations.find(*obsIter) == observations.end())
+      {
+      newObservations.push_back(*obsIter);
+      }
+    }
+  if (newObservations.empty())
+    {
+    // don't keep entries of deleted objects around
+    map.erase(it);
+    }
+  else
+    {
+    it->second.swap(newObservations);
+    }
+}
+}
+
 //----------------------------------------------------------------------------
 // The IO manager singleton.
 // This MUST be default initialized to zero by the compiler and is
@@ -97,6 +153,9 @@ vtkEventBroker::vtkEventBroker()
   this->EventNestingLevel = 0;
   this->TimerLog = vtkTimerLog::New();
   this->CompressCallData = 0;
+  this->Profiling = 0;
+  this->ProfileStartTime = 0.;
+  this->ProfileElapsedTime = 0.;
   this->LogFileName = NULL;
   this->ScriptHandler = NULL;
   this->ScriptHandlerClientData = NULL;
@@ -291,75 +350,44 @@ void vtkEventBroker::RemoveObservations (std::vector< vtkObservation *>observati
   // - detach from subject (and observer)
   // - delete the observation
 
-  // for each of the pass observations
-  // - loop through the list of observers associated with the subject and make
-  //   a new vector that doesn't include the passed observation
-  // then do the same for the observer (if there is one)
-  ObservationVector newObservations;
-  ObservationVector::iterator obsIter, nextObsIter, inObsIter;
-
-  for(inObsIter=observations.begin(); inObsIter != observations.end(); inObsIter++)
+  // The lists of each subject and observer are filtered only once, no
+  // matter how many of their observations are removed.
+  if (observations.empty())
     {
-    vtkObservation *inObs = (*inObsIter);
-    KeyType subjectKey = reinterpret_cast<KeyType>((*inObsIter)->GetSubject());
-    ObservationVector& subjectObservations = this->SubjectMap[subjectKey];
-    newObservations.clear();
-    newObservations.reserve(subjectObservations.size());
-    for(obsIter=subjectObservations.begin(); obsIter != subjectObservations.end(); obsIter++)
-      {
-      vtkObservation *obs = (*obsIter);
-      if (inObs != obs)
-        {
-        newObservations.push_back(obs);
-        }
-      }
-    subjectObservations = newObservations;
+    return;
+    }
+  ObservationSet removeSet(observations.begin(), observations.end());
+  std::set< KeyType > subjectKeys;
+  std::set< KeyType > observerKeys;
+  bool inEventQueue = false;
+  ObservationSet::iterator setIter;
+  for(setIter=removeSet.begin(); setIter != removeSet.end(); setIter++)
+    {
+    subjectKeys.insert(reinterpret_cast<KeyType>((*setIter)->GetSubject()));
+    observerKeys.insert(reinterpret_cast<KeyType>((*setIter)->GetObserver()));
+    inEventQueue = inEventQueue || (*setIter)->GetInEventQueue();
     }
 
-  for(inObsIter=observations.begin(); inObsIter != observations.end(); inObsIter++)
+  std::set< KeyType >::iterator keyIter;
+  for(keyIter=subjectKeys.begin(); keyIter != subjectKeys.end(); keyIter++)
     {
-    vtkObservation *inObs = (*inObsIter);
-    newObservations.clear();
-    KeyType observerKey = reinterpret_cast<KeyType>(inObs->GetObserver());
-    ObservationVector& observerObservations = this->ObserverMap[observerKey];
-    newObservations.reserve(observerObservations.size());
-    for(obsIter=observerObservations.begin(); obsIter != observerObservations.end(); obsIter++)
-      {
-      vtkObservation *obs = (*obsIter);
-      if (obs != inObs)
-        {
-        newObservations.push_back(obs);
-        }
-      }
-    observerObservations = newObservations;
+    RemoveObservationsFromMap(this->SubjectMap, *keyIter, removeSet);
+    }
+  for(keyIter=observerKeys.begin(); keyIter != observerKeys.end(); keyIter++)
+    {
+    RemoveObservationsFromMap(this->ObserverMap, *keyIter, removeSet);
     }
 
   // remove from event queue
-  std::deque< vtkObservation *> newEventQueue;
-  std::deque< vtkObservation *>::iterator queueIter; 
-  for(queueIter=this->EventQueue.begin(); queueIter != this->EventQueue.end(); queueIter++)  
-    { 
-    // foreach of the broker's observations see if it is in the list of items to be removed
-    std::vector< vtkObservation *>::iterator searchIter;
-    bool inRemoveList = false;
-    for(searchIter=observations.begin(); searchIter != observations.end(); searchIter++)  
-      {
-      if (*queueIter == *searchIter)
-        {
-        inRemoveList = true;
-        break;
-        }
-      }
-    if ( !inRemoveList )
-      {
-      newEventQueue.push_back( *queueIter );
-      }
+  if (inEventQueue)
+    {
+    RemoveObservationsFromQueue(this->EventQueue, removeSet);
+    RemoveObservationsFromQueue(this->PriorityEventQueue, removeSet);
     }
-  this->EventQueue = newEventQueue;
 
   // detach and delete each of the observations
-  std::vector< vtkObservation *>::iterator removeIter;
-  for(removeIter=observations.begin(); removeIter != observations.end(); removeIter++)  
+  ObservationSet::iterator removeIter;
+  for(removeIter=removeSet.begin(); removeIter != removeSet.end(); removeIter++)
     {
 
     (*removeIter)->SetInEventQueue( 0 );
@@ -404,9 +432,12 @@ std::vector< vtkObservation *> vtkEventBroker
 {
   // find matching observations to remove
   KeyType observerKey = reinterpret_cast<KeyType>(observer);
-  std::vector< vtkObservation *> observationList = this->ObserverMap[observerKey];
-
-  return( observationList );
+  ObjectToObservationVectorMap::iterator it = this->ObserverMap.find(observerKey);
+  if (it == this->ObserverMap.end())
+    {
+    return ObservationVector();
+    }
+  return( it->second );
 }
 
 //----------------------------------------------------------------------------
@@ -422,16 +453,34 @@ std::vector< vtkObservation *> vtkEventBroker::GetObservations (
     return observationList;
     }
   // find matching observations to remove
+  // - search the shortest of the subject and observer lists
   KeyType subjectKey = reinterpret_cast<KeyType>(subject);
-  std::vector< vtkObservation *>& subjectList = this->SubjectMap[subjectKey];
-  observationList.reserve(subjectList.size()); // speed-up to avoid push_back realloc
+  ObjectToObservationVectorMap::iterator subjectIt = this->SubjectMap.find(subjectKey);
+  if (subjectIt == this->SubjectMap.end())
+    {
+    return observationList;
+    }
+  ObservationVector* searchList = &subjectIt->second;
+  if (observer != 0)
+    {
+    KeyType observerKey = reinterpret_cast<KeyType>(observer);
+    ObjectToObservationVectorMap::iterator observerIt = this->ObserverMap.find(observerKey);
+    if (observerIt == this->ObserverMap.end())
+      {
+      return observationList;
+      }
+    if (observerIt->second.size() < searchList->size())
+      {
+      searchList = &observerIt->second;
+      }
+    }
 
-  for(std::vector< vtkObservation *>::iterator obsIter = subjectList.begin();
-      obsIter != subjectList.end();
+  for(std::vector< vtkObservation *>::iterator obsIter = searchList->begin();
+      obsIter != searchList->end();
       ++obsIter)
     {
     if ( ((*obsIter)->GetObserver() == observer || observer == 0) &&
-         //((*obsIter)->GetSubject() == subject || subject == 0) &&
+         (*obsIter)->GetSubject() == subject &&
          ((*obsIter)->GetEvent() == event || event == 0) && 
          ((*obsIter)->GetCallbackCommand() == notify || notify == 0))
       {
@@ -447,8 +496,13 @@ std::vector< vtkObservation *> vtkEventBroker::GetObservationsForSubjectByTag (v
   // find matching observations to remove
   // - all tags match 0
   KeyType subjectKey = reinterpret_cast<KeyType>(subject);
-  std::vector< vtkObservation *>& subjectList = this->SubjectMap[subjectKey];
   std::vector< vtkObservation *> observationList;
+  ObjectToObservationVectorMap::iterator it = this->SubjectMap.find(subjectKey);
+  if (it == this->SubjectMap.end())
+    {
+    return observationList;
+    }
+  std::vector< vtkObservation *>& subjectList = it->second;
   observationList.reserve(subjectList.size());
   for (std::vector< vtkObservation *>::iterator obsIter = subjectList.begin();
        obsIter != subjectList.end(); obsIter++)
@@ -601,6 +655,256 @@ int vtkEventBroker::GenerateGraphFile ( const char *graphFile )
   return 0;
 }
 
+//----------------------------------------------------------------------------
+bool vtkEventBroker::ProfileKey::operator<(const ProfileKey& other) const
+{
+  if (this->SubjectClassName != other.SubjectClassName)
+    {
+    return this->SubjectClassName < other.SubjectClassName;
+    }
+  if (this->Event != other.Event)
+    {
+    return this->Event < other.Event;
+    }
+  if (this->ObserverClassName != other.ObserverClassName)
+    {
+    return this->ObserverClassName < other.ObserverClassName;
+    }
+  if (this->Callback != other.Callback)
+    {
+    return this->Callback < other.Callback;
+    }
+  return this->HandlerName < other.HandlerName;
+}
+
+//----------------------------------------------------------------------------
+vtkEventBroker::ProfileEntry::ProfileEntry()
+  : Count(0)
+  , NestedCount(0)
+  , ReentrantCount(0)
+  , TotalElapsedTime(0.)
+  , MaxElapsedTime(0.)
+{
+  for (int i = 0; i < vtkEventBroker::NumberOfProfileHistogramBins; ++i)
+    {
+    this->Histogram[i] = 0;
+    }
+}
+
+//----------------------------------------------------------------------------
+double vtkEventBroker::GetProfileHistogramBinUpperBound(int bin)
+{
+  // 10us, 100us, 1ms, 10ms, 100ms, 1s, +inf
+  static const double bounds[vtkEventBroker::NumberOfProfileHistogramBins] =
+    {1e-5, 1e-4, 1e-3, 1e-2, 1e-1, 1., VTK_DOUBLE_MAX};
+  if (bin < 0 || bin >= vtkEventBroker::NumberOfProfileHistogramBins)
+    {
+    return 0.;
+    }
+  return bounds[bin];
+}
+
+//----------------------------------------------------------------------------
+void vtkEventBroker::RecordProfile(vtkObservation *observation,
+                                   unsigned long eid, double elapsedTime,
+                                   bool nested, bool reentrant)
+{
+  ProfileKey key;
+  key.SubjectClassName = observation->GetSubject() ?
+    observation->GetSubject()->GetClassName() : "";
+  key.Event = eid;
+  if (observation->GetScript())
+    {
+    key.ObserverClassName = std::string("script: ") + observation->GetScript();
+    key.Callback = 0;
+    }
+  else
+    {
+    key.ObserverClassName = observation->GetObserver() ?
+      observation->GetObserver()->GetClassName() : "";
+    key.Callback = observation->GetCallbackCommand() ?
+      reinterpret_cast<void*>(observation->GetCallbackCommand()->Callback) : 0;
+    }
+  this->RecordProfile(key, elapsedTime, nested, reentrant);
+}
+
+//----------------------------------------------------------------------------
+void vtkEventBroker::RecordHandlerProfile(const char* subjectClassName,
+                                          unsigned long eid,
+                                          const char* observerClassName,
+                                          const char* handlerName,
+                                          double elapsedTime)
+{
+  if (!this->Profiling)
+    {
+    return;
+    }
+  ProfileKey key;
+  key.SubjectClassName = subjectClassName ? subjectClassName : "";
+  key.Event = eid;
+  key.ObserverClassName = observerClassName ? observerClassName : "";
+  key.Callback = 0;
+  key.HandlerName = handlerName ? handlerName : "";
+  // The handler runs within the observation that dispatched the event
+  this->RecordProfile(key, elapsedTime, this->EventNestingLevel > 1, false);
+}
+
+//----------------------------------------------------------------------------
+void vtkEventBroker::RecordProfile(const ProfileKey& key, double elapsedTime,
+                                   bool nested, bool reentrant)
+{
+  ProfileEntry& entry = this->Profile[key];
+  ++entry.Count;
+  entry.NestedCount += nested ? 1 : 0;
+  entry.ReentrantCount += reentrant ? 1 : 0;
+  entry.TotalElapsedTime += elapsedTime;
+  entry.MaxElapsedTime = std::max(entry.MaxElapsedTime, elapsedTime);
+  int bin = 0;
+  while (bin < vtkEventBroker::NumberOfProfileHistogramBins - 1 &&
+         elapsedTime >= vtkEventBroker::GetProfileHistogramBinUpperBound(bin))
+    {
+    ++bin;
+    }
+  ++entry.Histogram[bin];
+}
+
+//----------------------------------------------------------------------------
+void vtkEventBroker::SetProfiling(int profiling)
+{
+  if (this->Profiling == profiling)
+    {
+    return;
+    }
+  double now = this->TimerLog->GetUniversalTime();
+  if (profiling)
+    {
+    this->ProfileStartTime = now;
+    }
+  else
+    {
+    this->ProfileElapsedTime += now - this->ProfileStartTime;
+    }
+  this->Profiling = profiling;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkEventBroker::ResetProfile()
+{
+  this->Profile.clear();
+  this->ProfileElapsedTime = 0.;
+  this->ProfileStartTime = this->TimerLog->GetUniversalTime();
+}
+
+//----------------------------------------------------------------------------
+double vtkEventBroker::GetProfileElapsedTime()
+{
+  double elapsedTime = this->ProfileElapsedTime;
+  if (this->Profiling)
+    {
+    elapsedTime += this->TimerLog->GetUniversalTime() - this->ProfileStartTime;
+    }
+  return elapsedTime;
+}
+
+//----------------------------------------------------------------------------
+int vtkEventBroker::WriteProfile ( const char *fileName )
+{
+  if ( fileName == NULL )
+    {
+    vtkErrorMacro( "WriteProfile: no file name" );
+    return 1;
+    }
+  std::ofstream file;
+  file.open( fileName, std::ios::out );
+  if ( file.fail() )
+    {
+    vtkErrorMacro( "could not write to " << fileName );
+    return 1;
+    }
+
+  std::string name(fileName);
+  bool csv = name.size() >= 4 && name.compare(name.size() - 4, 4, ".csv") == 0;
+
+  if (csv)
+    {
+    file << "subject,event,event_name,observer,callback,handler,count,nested,reentrant,"
+         << "total_seconds,max_seconds";
+    for (int i = 0; i < vtkEventBroker::NumberOfProfileHistogramBins; ++i)
+      {
+      file << ",bin" << i;
+      }
+    file << "\n";
+    }
+  else
+    {
+    file << "{\n  \"profile_seconds\": " << this->GetProfileElapsedTime()
+         << ",\n  \"histogram_upper_bounds\": [";
+    for (int i = 0; i < vtkEventBroker::NumberOfProfileHistogramBins - 1; ++i)
+      {
+      file << (i ? ", " : "") << vtkEventBroker::GetProfileHistogramBinUpperBound(i);
+      }
+    file << "],\n  \"observations\": [";
+    }
+
+  std::map< ProfileKey, ProfileEntry >::const_iterator it;
+  for (it = this->Profile.begin(); it != this->Profile.end(); ++it)
+    {
+    const ProfileKey& key = it->first;
+    const ProfileEntry& entry = it->second;
+    const char* eventString = vtkCommand::GetStringFromEventId( key.Event );
+    std::string observerClassName = key.ObserverClassName;
+    std::string::size_type quote;
+    while ((quote = observerClassName.find_first_of("\"\\,\n")) != std::string::npos)
+      {
+      observerClassName[quote] = ' ';
+      }
+    if (csv)
+      {
+      file << key.SubjectClassName << ","
+           << key.Event << "," << eventString << ","
+           << observerClassName << ","
+           << key.Callback << ","
+           << key.HandlerName << ","
+           << entry.Count << "," << entry.NestedCount << ","
+           << entry.ReentrantCount << ","
+           << entry.TotalElapsedTime << "," << entry.MaxElapsedTime;
+      for (int i = 0; i < vtkEventBroker::NumberOfProfileHistogramBins; ++i)
+        {
+        file << "," << entry.Histogram[i];
+        }
+      file << "\n";
+      }
+    else
+      {
+      file << (it == this->Profile.begin() ? "\n" : ",\n")
+           << "    {\"subject\": \"" << key.SubjectClassName << "\""
+           << ", \"event\": " << key.Event
+           << ", \"event_name\": \"" << eventString << "\""
+           << ", \"observer\": \"" << observerClassName << "\""
+           << ", \"callback\": \"" << key.Callback << "\""
+           << ", \"handler\": \"" << key.HandlerName << "\""
+           << ", \"count\": " << entry.Count
+           << ", \"nested\": " << entry.NestedCount
+           << ", \"reentrant\": " << entry.ReentrantCount
+           << ", \"total_seconds\": " << entry.TotalElapsedTime
+           << ", \"max_seconds\": " << entry.MaxElapsedTime
+           << ", \"histogram\": [";
+      for (int i = 0; i < vtkEventBroker::NumberOfProfileHistogramBins; ++i)
+        {
+        file << (i ? ", " : "") << entry.Histogram[i];
+        }
+      file << "]}";
+      }
+    }
+  if (!csv)
+    {
+    file << "\n  ]\n}\n";
+    }
+  file.close();
+  return 0;
+}
+
 //----------------------------------------------------------------------------
 void vtkEventBroker::OpenLogFile ()
 {
@@ -737,8 +1041,14 @@ void vtkEventBroker::ProcessEvent ( vtkObservation *observation, vtkObject *call
     {
     // iterate list of observations for the deleted object (caller) as subject
     std::vector< vtkObservation *>::iterator obsIter; 
+    // (copy the list, observations can be removed while being invoked)
     KeyType subjectKey = reinterpret_cast<KeyType>(caller);
-    std::vector< vtkObservation *>& subjectList = this->SubjectMap[subjectKey];
+    std::vector< vtkObservation *> subjectList;
+    ObjectToObservationVectorMap::iterator subjectIt = this->SubjectMap.find(subjectKey);
+    if (subjectIt != this->SubjectMap.end())
+      {
+      subjectList = subjectIt->second;
+      }
     for(obsIter=subjectList.begin(); obsIter != subjectList.end(); obsIter++)
       {
       if ( (*obsIter)->GetEvent() == vtkCommand::DeleteEvent )
@@ -807,15 +1117,23 @@ void vtkEventBroker::QueueObservation ( vtkObservation *observation,
 
   if ( !observation->GetInEventQueue() )
     {
-    this->EventQueue.push_back( observation );
+    this->GetEventQueue(observation).push_back( observation );
     observation->SetInEventQueue(1);
     }
 }
 
+//----------------------------------------------------------------------------
+std::deque< vtkObservation * >& vtkEventBroker::GetEventQueue(vtkObservation* observation)
+{
+  return observation->GetPriority() > 0.f ?
+    this->PriorityEventQueue : this->EventQueue;
+}
+
 //----------------------------------------------------------------------------
 int vtkEventBroker::GetNumberOfQueuedObservations ()
 {
-  return static_cast<int>( this->EventQueue.size() );
+  return static_cast<int>( this->PriorityEventQueue.size() +
+                           this->EventQueue.size() );
 }
 
 //----------------------------------------------------------------------------
@@ -825,14 +1143,21 @@ vtkObservation *vtkEventBroker::GetNthQueuedObservation ( int n )
     {
     return NULL;
     }
-  return (this->EventQueue[n]);
+  int priorityQueueSize = static_cast<int>(this->PriorityEventQueue.size());
+  if ( n < priorityQueueSize )
+    {
+    return (this->PriorityEventQueue[n]);
+    }
+  return (this->EventQueue[n - priorityQueueSize]);
 }
 
 //----------------------------------------------------------------------------
 vtkObservation *vtkEventBroker::DequeueObservation ()
 {
-  vtkObservation *observation = this->EventQueue.front();
-  this->EventQueue.pop_front();
+  std::deque< vtkObservation * >& queue =
+    this->PriorityEventQueue.empty() ? this->EventQueue : this->PriorityEventQueue;
+  vtkObservation *observation = queue.front();
+  queue.pop_front();
   observation->SetInEventQueue(0);
   return( observation );
 }
@@ -848,6 +1173,15 @@ void vtkEventBroker::InvokeObservation ( vtkObservation *observation,
   // Register so observation won't be deleted while callback is running
   observation->Register(this);
 
+  bool reentrant = false;
+  if (this->Profiling)
+    {
+    reentrant = std::find(this->InvokedObservations.begin(),
+                          this->InvokedObservations.end(),
+                          observation) != this->InvokedObservations.end();
+    this->InvokedObservations.push_back(observation);
+    }
+
   // Invoke the observation
   // - run script is available, otherwise run callback command
   //  -- pass back the client data to the script handler (for
@@ -874,6 +1208,13 @@ void vtkEventBroker::InvokeObservation ( vtkObservation *observation,
   observation->SetLastElapsedTime (elapsedTime);
   this->LogEvent (observation);
 
+  if (this->Profiling && !this->InvokedObservations.empty())
+    {
+    this->InvokedObservations.pop_back();
+    this->RecordProfile(observation, eid, elapsedTime,
+                        this->EventNestingLevel > 1, reentrant);
+    }
+
   // clear reference to observation (may cause delete)
   observation->Delete();
   this->EventNestingLevel--;
@@ -881,6 +1222,12 @@ void vtkEventBroker::InvokeObservation ( vtkObservation *observation,
 
 //----------------------------------------------------------------------------
 void vtkEventBroker::ProcessEventQueue ()
+{
+  this->ProcessEventQueue(0.);
+}
+
+//----------------------------------------------------------------------------
+int vtkEventBroker::ProcessEventQueue (double maxMilliseconds)
 {
   //
   // for each observation on the event queue, 
@@ -889,10 +1236,20 @@ void vtkEventBroker::ProcessEventQueue ()
   //   gets deleted during handling of the event
   // - if the observation is no longer in the queue, stop processing events
   // - unregister before after dequeing in case the observation should go away
+  // - stop when the time budget is exhausted, the remaining observations
+  //   are processed at the next call
   //
+  double startTime = this->TimerLog->GetUniversalTime();
   while ( this->GetNumberOfQueuedObservations() > 0 )
     {
-    vtkObservation *observation = this->EventQueue.front();
+    if ( maxMilliseconds > 0. &&
+         (this->TimerLog->GetUniversalTime() - startTime) * 1000. > maxMilliseconds )
+      {
+      break;
+      }
+    std::deque< vtkObservation * >& queue =
+      this->PriorityEventQueue.empty() ? this->EventQueue : this->PriorityEventQueue;
+    vtkObservation *observation = queue.front();
     observation->Register( this );
     int finished = 0;
     while ( !finished )
@@ -908,9 +1265,23 @@ void vtkEventBroker::ProcessEventQueue ()
         break;
         }
       }
-    this->DequeueObservation();
+    // the observation may have been removed from the queue while being
+    // invoked, make sure to not dequeue another observation
+    if ( observation->GetInEventQueue() )
+      {
+      std::deque< vtkObservation * >& observationQueue =
+        this->GetEventQueue(observation);
+      std::deque< vtkObservation * >::iterator it =
+        std::find(observationQueue.begin(), observationQueue.end(), observation);
+      if (it != observationQueue.end())
+        {
+        observationQueue.erase(it);
+        }
+      observation->SetInEventQueue(0);
+      }
     observation->Delete();
     }
+  return this->GetNumberOfQueuedObservations();
 }
 
 //----------------------------------------------------------------------------
@@ -922,6 +1293,7 @@ void vtkEventBroker::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "NumberOfQueueObservations: " << this->GetNumberOfQueuedObservations() << "\n";
   os << indent << "EventMode: " << this->GetEventModeAsString() << "\n";
   os << indent << "EventLogging: " << this->EventLogging << "\n";
+  os << indent << "Profiling: " << this->Profiling << "\n";
   os << indent << "EventNestingLevel: " << this->EventNestingLevel << "\n";
   os << indent << "LogFileName: " <<
     (this->LogFileName ? this->LogFileName : "(none)") << "\n";
@@ -25,9 +25,10 @@ class vtkTimerLog;
 // STD includes
 #include <deque>
 #include <vector>
-//#include <set>
+#include <set>
 #include <map>
 #include <fstream>
+#include <string>
 
 class vtkCollection;
 class vtkCallbackCommand;
@@ -164,6 +165,52 @@ public:
   /// Write out the current list of observations in graphviz format (.dot)
   int GenerateGraphFile ( const char *graphFile );
 
+  /// Profiling
+  ///
+  /// When profiling is on, each invocation is recorded per (subject class,
+  /// event, observer class, callback): number of invocations, total and
+  /// maximum elapsed time, a latency histogram and the number of nested
+  /// (cascading) and re-entrant invocations. An invocation is re-entrant if
+  /// the same observation is invoked again while it is already being
+  /// invoked.
+  /// Observers can also record the handlers they dispatch the events to
+  /// with RecordHandlerProfile().
+  /// Off by default.
+  vtkBooleanMacro (Profiling, int);
+  virtual void SetProfiling(int profiling);
+  vtkGetMacro (Profiling, int);
+
+  /// Clear the recorded profile.
+  void ResetProfile();
+
+  /// Time in seconds during which profiling has been on since the last
+  /// ResetProfile(). It gives the share of the profiled time spent in each
+  /// observation.
+  double GetProfileElapsedTime();
+
+  /// Record an invocation of the handler \a handlerName of an observer of
+  /// class \a observerClassName (e.g. OnMRMLSceneNodeAdded of a logic) for
+  /// the event \a eid of a subject of class \a subjectClassName.
+  /// The handler entries are written along with the observations, they
+  /// break down the time of the observation that dispatched the event.
+  /// Do nothing if profiling is off.
+  void RecordHandlerProfile(const char* subjectClassName, unsigned long eid,
+                            const char* observerClassName,
+                            const char* handlerName, double elapsedTime);
+
+  /// Write the recorded profile into \a fileName, in CSV format if the file
+  /// extension is ".csv", in JSON format otherwise.
+  /// Return 0 on success, 1 on failure (same as GenerateGraphFile()).
+  int WriteProfile ( const char *fileName );
+
+  /// Upper bounds in seconds of the latency histogram bins, the last bin
+  /// has no upper bound.
+  enum
+    {
+    NumberOfProfileHistogramBins = 7
+    };
+  static double GetProfileHistogramBinUpperBound(int bin);
+
 
   /// Event Queue processing modes
   /// 
@@ -204,6 +251,12 @@ public:
   /// the callData field of the event back)
   /// TODO: if the callData is needed, we will need another class/struct to 
   /// go into the event queue that saves them
+  /// - an observation is queued only once: events triggered for an
+  /// observation already in the queue are merged into its call data list
+  /// (see CompressCallData)
+  /// - the queue has two lanes: observations with a priority strictly
+  /// greater than 0 (typically render requests) are queued in the priority
+  /// lane and are always processed before the other observations.
   void QueueObservation (vtkObservation *observation, unsigned long eid,
                          void *callData);
   int GetNumberOfQueuedObservations (); 
@@ -212,6 +265,12 @@ public:
   void InvokeObservation (vtkObservation *observation, unsigned long eid,
                           void *callData);
   void ProcessEventQueue (); 
+  /// Process the queued observations until the queue is empty or
+  /// \a maxMilliseconds have elapsed (0 means no time limit). Observations
+  /// that have not been processed stay in the queue, it is meant to be
+  /// called repeatedly (e.g. from an application idle timer).
+  /// Return the number of observations left in the queue.
+  int ProcessEventQueue (double maxMilliseconds);
 
   /// 
   /// two modes - 
@@ -260,6 +319,7 @@ protected:
   typedef char *KeyType;
   typedef std::vector< vtkObservation * > ObservationVector;
   typedef std::map< KeyType, ObservationVector > ObjectToObservationVectorMap;
+  typedef std::set< vtkObservation * > ObservationSet;
 
   /// maps to manage quick lookup by object
   ObjectToObservationVectorMap SubjectMap;
@@ -267,6 +327,12 @@ protected:
 
   /// The event queue of triggered but not-yet-invoked observations
   std::deque< vtkObservation * > EventQueue;
+  /// The priority lane of the event queue (observations with a positive
+  /// priority), processed before EventQueue.
+  std::deque< vtkObservation * > PriorityEventQueue;
+
+  /// Return the lane of the event queue the observation goes into.
+  std::deque< vtkObservation * >& GetEventQueue(vtkObservation* observation);
   
   void (*ScriptHandler) (const char* script, void* clientData);
   void *ScriptHandlerClientData;
@@ -279,6 +345,38 @@ protected:
   int EventMode;
   int CompressCallData;
 
+  int Profiling;
+  double ProfileStartTime;
+  double ProfileElapsedTime;
+  /// Profile of the invocations, see SetProfiling()
+  struct ProfileKey
+  {
+    std::string SubjectClassName;
+    unsigned long Event;
+    std::string ObserverClassName;
+    void* Callback;
+    /// Empty for observations, see RecordHandlerProfile()
+    std::string HandlerName;
+    bool operator<(const ProfileKey& other) const;
+  };
+  struct ProfileEntry
+  {
+    ProfileEntry();
+    unsigned long Count;
+    unsigned long NestedCount;
+    unsigned long ReentrantCount;
+    double TotalElapsedTime;
+    double MaxElapsedTime;
+    unsigned long Histogram[NumberOfProfileHistogramBins];
+  };
+  std::map< ProfileKey, ProfileEntry > Profile;
+  /// Observations being invoked, used to detect re-entrant invocations
+  std::vector< vtkObservation * > InvokedObservations;
+  void RecordProfile(vtkObservation *observation, unsigned long eid,
+                     double elapsedTime, bool nested, bool reentrant);
+  void RecordProfile(const ProfileKey& key, double elapsedTime,
+                     bool nested, bool reentrant);
+
   std::ofstream LogFile;
 private:
   /// DetachObservations is a fast (but dangerous) method to delete all the
@@ -14,6 +14,10 @@
 #include "vtkImageAccumulateDiscrete.h"
 #include "vtkObjectFactory.h"
 #include "vtkImageData.h"
+#include "vtkMultiThreader.h"
+
+// STD includes
+#include <vector>
 
 
 //----------------------------------------------------------------------------
@@ -59,142 +63,202 @@ void vtkImageAccumulateDiscrete::ComputeInputUpdateExtent(int inExt[6],
   memcpy(inExt, wholeExtent, 6*sizeof(int));
 }
 
+//----------------------------------------------------------------------------
+// The rows of the input are shared out between the threads, each one
+// counts its rows in its own histogram and the histograms are summed at
+// the end.
+struct vtkImageAccumulateDiscreteThreadStruct
+{
+  vtkImageAccumulateDiscrete *Filter;
+  vtkImageData *InData;
+  int Offset;
+  std::vector<std::vector<int> > Histograms;
+  bool UnsupportedScalarType;
+};
+
 //----------------------------------------------------------------------------
 // This templated function executes the filter for any type of data.
 template <class T>
 static void vtkImageAccumulateDiscreteExecute(vtkImageAccumulateDiscrete *self,
-                      vtkImageData *inData, T *inPtr,
-                      vtkImageData *outData, int *outPtr)
+                      vtkImageData *inData, T *inPtr, int offset,
+                      int *outPtr, int threadId, int numberOfThreads)
 {
   int min0, max0, min1, max1, min2, max2;
-  int idx0, idx1, idx2;
+  int idx0;
   vtkIdType inInc0, inInc1, inInc2;
-  T *inPtr0, *inPtr1, *inPtr2;
-  vtkFloatingPointType *origin;
-  int offset;
-  int outExt[6];
+  T *inPtr0;
   unsigned long count = 0;
   unsigned long target;
 
-  // Zero count in every bin
-  outData->GetExtent(min0, max0, min1, max1, min2, max2);
-  memset((void *)outPtr, 0,
-     (max0-min0+1)*(max1-min1+1)*(max2-min2+1)*sizeof(int));
-
   // Get information to march through data
   inData->GetExtent(min0, max0, min1, max1, min2, max2);
   inData->GetIncrements(inInc0, inInc1, inInc2);
-  outData->GetExtent(outExt);
-  origin = outData->GetOrigin();
-  offset = (int)(-origin[0]);
+
+  // Rows of this thread
+  vtkIdType rowsPerSlice = max1 - min1 + 1;
+  vtkIdType numberOfRows = (max2 - min2 + 1) * rowsPerSlice;
+  vtkIdType beginRow = numberOfRows * threadId / numberOfThreads;
+  vtkIdType endRow = numberOfRows * (threadId + 1) / numberOfThreads;
 
   // Ignore all components other than first one.
   // NOTE: GetIncrements takes the number of components into account
 
-  target = (unsigned long)((max2 - min2 + 1)*(max1 - min1 +1)/50.0);
+  target = (unsigned long)((endRow - beginRow)/50.0);
   target++;
 
-  inPtr2 = inPtr;
-  for (idx2 = min2; idx2 <= max2; ++idx2)
+  for (vtkIdType row = beginRow; !self->AbortExecute && row < endRow; ++row)
     {
-    inPtr1 = inPtr2;
-    for (idx1 = min1; !self->AbortExecute && idx1 <= max1; ++idx1)
+    if (threadId == 0)
       {
       if (!(count%target))
         {
         self->UpdateProgress(count/(50.0*target));
         }
       count++;
-      inPtr0  = inPtr1;
-      for (idx0 = min0; idx0 <= max0; ++idx0)
+      }
+    inPtr0 = inPtr + (row / rowsPerSlice) * inInc2 + (row % rowsPerSlice) * inInc1;
+    for (idx0 = min0; idx0 <= max0; ++idx0)
+      {
+      int a = (int)(*inPtr0) + offset;
+      if ( a < MAX_ACCUMULATION_BIN && a > 0 )
         {
-        int a = (int)(*inPtr0) + offset;
-        if ( a < MAX_ACCUMULATION_BIN && a > 0 )
-          {
-          outPtr[a]++;
-          }
-        inPtr0 += inInc0;
+        outPtr[a]++;
         }
-      inPtr1 += inInc1;
+      inPtr0 += inInc0;
       }
-    inPtr2 += inInc2;
     }
 }
 
-
 //----------------------------------------------------------------------------
-// This method is passed a input and output Data, and executes the filter
-// algorithm to fill the output from the input.
-// It just executes a switch statement to call the correct function for
-// the Datas data types.
-void vtkImageAccumulateDiscrete::ExecuteData(vtkDataObject *)
+static VTK_THREAD_RETURN_TYPE vtkImageAccumulateDiscreteThreadedExecute(void *arg)
 {
-  vtkImageData *inData = this->GetInput();
-  vtkImageData *outData = this->GetOutput();
-  outData->SetExtent(this->GetOutput()->GetWholeExtent());
-  outData->AllocateScalars();
-
-  void *inPtr;
-  int *outPtr;
-
-  inPtr  = inData->GetScalarPointer();
-  outPtr = (int *)outData->GetScalarPointer();
-
-  // this filter expects that output is type int.
-  if (outData->GetScalarType() != VTK_INT)
-  {
-    vtkErrorMacro(<< "Execute: out ScalarType " << outData->GetScalarType()
-          << " must be int\n");
-    return;
-  }
-  
-  int type = inData->GetScalarType();
+  vtkMultiThreader::ThreadInfo *info =
+    static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  vtkImageAccumulateDiscreteThreadStruct *str =
+    static_cast<vtkImageAccumulateDiscreteThreadStruct*>(info->UserData);
+  vtkImageAccumulateDiscrete *self = str->Filter;
+  vtkImageData *inData = str->InData;
+  void *inPtr = inData->GetScalarPointer();
+  int *outPtr = &str->Histograms[info->ThreadID][0];
+  int threadId = info->ThreadID;
+  int numberOfThreads = info->NumberOfThreads;
 
-  switch (type)
+  switch (inData->GetScalarType())
   {
     case VTK_CHAR:
-      vtkImageAccumulateDiscreteExecute(this, 
-              inData, (char *)(inPtr), outData, outPtr);
+      vtkImageAccumulateDiscreteExecute(self, inData, (char *)(inPtr),
+              str->Offset, outPtr, threadId, numberOfThreads);
       break;
     case VTK_UNSIGNED_CHAR:
-      vtkImageAccumulateDiscreteExecute(this, 
-              inData, (unsigned char *)(inPtr), outData, outPtr);
+      vtkImageAccumulateDiscreteExecute(self, inData, (unsigned char *)(inPtr),
+              str->Offset, outPtr, threadId, numberOfThreads);
       break;
     case VTK_SHORT:
-      vtkImageAccumulateDiscreteExecute(this, 
-              inData, (short *)(inPtr), outData, outPtr);
+      vtkImageAccumulateDiscreteExecute(self, inData, (short *)(inPtr),
+              str->Offset, outPtr, threadId, numberOfThreads);
       break;
     case VTK_UNSIGNED_SHORT:
-      vtkImageAccumulateDiscreteExecute(this, 
-              inData, (unsigned short *)(inPtr), outData, outPtr);
+      vtkImageAccumulateDiscreteExecute(self, inData, (unsigned short *)(inPtr),
+              str->Offset, outPtr, threadId, numberOfThreads);
       break;
     case VTK_INT:
-      vtkImageAccumulateDiscreteExecute(this, 
-              inData, (int *)(inPtr), outData, outPtr);
+      vtkImageAccumulateDiscreteExecute(self, inData, (int *)(inPtr),
+              str->Offset, outPtr, threadId, numberOfThreads);
       break;
     case VTK_UNSIGNED_INT:
-      vtkImageAccumulateDiscreteExecute(this, 
-              inData, (unsigned int *)(inPtr), outData, outPtr);
+      vtkImageAccumulateDiscreteExecute(self, inData, (unsigned int *)(inPtr),
+              str->Offset, outPtr, threadId, numberOfThreads);
       break;
     case VTK_LONG:
-      vtkImageAccumulateDiscreteExecute(this, 
-              inData, (long *)(inPtr), outData, outPtr);
+      vtkImageAccumulateDiscreteExecute(self, inData, (long *)(inPtr),
+              str->Offset, outPtr, threadId, numberOfThreads);
       break;
     case VTK_UNSIGNED_LONG:
-      vtkImageAccumulateDiscreteExecute(this, 
-              inData, (unsigned long *)(inPtr), outData, outPtr);
+      vtkImageAccumulateDiscreteExecute(self, inData, (unsigned long *)(inPtr),
+              str->Offset, outPtr, threadId, numberOfThreads);
       break;
     case VTK_FLOAT:
-      vtkImageAccumulateDiscreteExecute(this, 
-              inData, (float *)(inPtr), outData, outPtr);
+      vtkImageAccumulateDiscreteExecute(self, inData, (float *)(inPtr),
+              str->Offset, outPtr, threadId, numberOfThreads);
       break;
     case VTK_DOUBLE:
-      vtkImageAccumulateDiscreteExecute(this, 
-              inData, (double *)(inPtr), outData, outPtr);
+      vtkImageAccumulateDiscreteExecute(self, inData, (double *)(inPtr),
+              str->Offset, outPtr, threadId, numberOfThreads);
       break;
     default:
-      vtkErrorMacro(<< "Execute: Unsupported ScalarType");
-      return;
+      str->UnsupportedScalarType = true;
+      break;
+  }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+// This method is passed a input and output Data, and counts the input
+// values in threads, each thread filling its own histogram.
+void vtkImageAccumulateDiscrete::ExecuteData(vtkDataObject *)
+{
+  vtkImageData *inData = this->GetInput();
+  vtkImageData *outData = this->GetOutput();
+  outData->SetExtent(this->GetOutput()->GetWholeExtent());
+  outData->AllocateScalars();
+
+  int *outPtr;
+
+  outPtr = (int *)outData->GetScalarPointer();
+
+  // this filter expects that output is type int.
+  if (outData->GetScalarType() != VTK_INT)
+  {
+    vtkErrorMacro(<< "Execute: out ScalarType " << outData->GetScalarType()
+          << " must be int\n");
+    return;
+  }
+
+  // Zero count in every bin
+  int outExt[6];
+  outData->GetExtent(outExt);
+  vtkIdType numberOfBins = (outExt[1]-outExt[0]+1)*(outExt[3]-outExt[2]+1)*
+    (outExt[5]-outExt[4]+1);
+  memset((void *)outPtr, 0, numberOfBins*sizeof(int));
+
+  int inExt[6];
+  inData->GetExtent(inExt);
+  vtkIdType numberOfRows = (inExt[3]-inExt[2]+1)*(inExt[5]-inExt[4]+1);
+  if (inExt[1] < inExt[0] || numberOfRows <= 0)
+    {
+    return;
+    }
+  int numberOfThreads = this->NumberOfThreads;
+  if (numberOfThreads > numberOfRows)
+    {
+    numberOfThreads = static_cast<int>(numberOfRows);
+    }
+
+  vtkImageAccumulateDiscreteThreadStruct str;
+  str.Filter = this;
+  str.InData = inData;
+  str.Offset = (int)(-outData->GetOrigin()[0]);
+  str.Histograms.resize(numberOfThreads, std::vector<int>(numberOfBins, 0));
+  str.UnsupportedScalarType = false;
+
+  this->Threader->SetNumberOfThreads(numberOfThreads);
+  this->Threader->SetSingleMethod(vtkImageAccumulateDiscreteThreadedExecute, &str);
+  this->Threader->SingleMethodExecute();
+
+  if (str.UnsupportedScalarType)
+    {
+    vtkErrorMacro(<< "Execute: Unsupported ScalarType");
+    return;
+    }
+
+  // The threader may run less threads, their histograms stay empty
+  for (int t = 0; t < numberOfThreads; ++t)
+    {
+    const int *histogram = &str.Histograms[t][0];
+    for (vtkIdType bin = 0; bin < numberOfBins; ++bin)
+      {
+      outPtr[bin] += histogram[bin];
+      }
     }
 }
 
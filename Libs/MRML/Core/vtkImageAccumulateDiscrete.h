@@ -27,6 +27,7 @@
 /// discrete bins.  It then counts the number of pixels associated
 /// with each bin.  The output is this "scatter plot".
 /// The input can be any type, but the output is always int.
+/// The input rows are counted in threads, in one histogram per thread.
 class VTK_MRML_EXPORT vtkImageAccumulateDiscrete : public vtkImageToImageFilter
 {
 public:
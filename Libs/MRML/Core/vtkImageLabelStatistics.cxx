@@ -0,0 +1,337 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#include "vtkImageLabelStatistics.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkMultiThreader.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <vector>
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkImageLabelStatistics);
+
+//----------------------------------------------------------------------------
+namespace
+{
+struct LabelAccumulator
+{
+  LabelAccumulator()
+    : Count(0), Min(VTK_DOUBLE_MAX), Max(VTK_DOUBLE_MIN), Sum(0.), SumOfSquares(0.)
+  {}
+  void Add(double value)
+  {
+    ++this->Count;
+    this->Min = std::min(this->Min, value);
+    this->Max = std::max(this->Max, value);
+    this->Sum += value;
+    this->SumOfSquares += value * value;
+  }
+  void Add(const LabelAccumulator& other)
+  {
+    this->Count += other.Count;
+    this->Min = std::min(this->Min, other.Min);
+    this->Max = std::max(this->Max, other.Max);
+    this->Sum += other.Sum;
+    this->SumOfSquares += other.SumOfSquares;
+  }
+  vtkIdType Count;
+  double Min;
+  double Max;
+  double Sum;
+  double SumOfSquares;
+};
+typedef std::map<vtkIdType, LabelAccumulator> LabelAccumulatorMap;
+}
+
+//----------------------------------------------------------------------------
+class vtkImageLabelStatistics::vtkInternal
+{
+public:
+  /// One map per thread, so that the threads never share an accumulator
+  std::vector<LabelAccumulatorMap> ThreadAccumulators;
+  std::vector<vtkIdType> Labels;
+  std::vector<LabelAccumulator> Accumulators;
+};
+
+//----------------------------------------------------------------------------
+static VTK_THREAD_RETURN_TYPE vtkImageLabelStatistics_ThreadedCompute( void *arg )
+{
+  vtkMultiThreader::ThreadInfo *info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  vtkImageLabelStatistics *self = static_cast<vtkImageLabelStatistics *>(info->UserData);
+  self->ThreadedCompute(info->ThreadID, info->NumberOfThreads);
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+// Accumulate the voxels [begin, end) of the images, the labels of
+// consecutive voxels are most often the same so the last accumulator is kept.
+template <class TL, class TG>
+static void vtkImageLabelStatisticsAccumulate(const TL* labelPtr, int labelStep,
+                                              const TG* grayPtr, int grayStep,
+                                              vtkIdType begin, vtkIdType end,
+                                              LabelAccumulatorMap& accumulators)
+{
+  if (begin >= end)
+    {
+    return;
+    }
+  labelPtr += begin * labelStep;
+  grayPtr += begin * grayStep;
+  vtkIdType currentLabel = static_cast<vtkIdType>(*labelPtr);
+  LabelAccumulator* current = &accumulators[currentLabel];
+  for (vtkIdType i = begin; i < end; ++i)
+    {
+    vtkIdType label = static_cast<vtkIdType>(*labelPtr);
+    if (label != currentLabel)
+      {
+      currentLabel = label;
+      current = &accumulators[currentLabel];
+      }
+    current->Add(static_cast<double>(*grayPtr));
+    labelPtr += labelStep;
+    grayPtr += grayStep;
+    }
+}
+
+//----------------------------------------------------------------------------
+template <class TL>
+static void vtkImageLabelStatisticsAccumulate(const TL* labelPtr, int labelStep,
+                                              vtkImageData* grayscale,
+                                              vtkIdType begin, vtkIdType end,
+                                              LabelAccumulatorMap& accumulators)
+{
+  void* grayPtr = grayscale->GetScalarPointer();
+  int grayStep = grayscale->GetNumberOfScalarComponents();
+  switch (grayscale->GetScalarType())
+    {
+    vtkTemplateMacro(
+      vtkImageLabelStatisticsAccumulate(labelPtr, labelStep,
+                                        static_cast<VTK_TT*>(grayPtr), grayStep,
+                                        begin, end, accumulators));
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkImageLabelStatistics::vtkImageLabelStatistics()
+{
+  this->MultiThreader = vtkMultiThreader::New();
+  this->NumberOfThreads = this->MultiThreader->GetNumberOfThreads();
+  this->VoxelVolume = 1.;
+  this->LabelMap = NULL;
+  this->Grayscale = NULL;
+  this->Internal = new vtkInternal;
+}
+
+//----------------------------------------------------------------------------
+vtkImageLabelStatistics::~vtkImageLabelStatistics()
+{
+  this->MultiThreader->Delete();
+  delete this->Internal;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageLabelStatistics::Compute(vtkImageData* labelMap, vtkImageData* grayscale)
+{
+  this->Internal->Labels.clear();
+  this->Internal->Accumulators.clear();
+  if (!labelMap || !grayscale ||
+      !labelMap->GetPointData()->GetScalars() ||
+      !grayscale->GetPointData()->GetScalars())
+    {
+    vtkErrorMacro("Compute: no image scalars to measure");
+    return -1;
+    }
+  int labelDims[3];
+  int grayDims[3];
+  labelMap->GetDimensions(labelDims);
+  grayscale->GetDimensions(grayDims);
+  if (labelDims[0] != grayDims[0] ||
+      labelDims[1] != grayDims[1] ||
+      labelDims[2] != grayDims[2])
+    {
+    vtkErrorMacro("Compute: the label map and the grayscale image have different dimensions");
+    return -1;
+    }
+  double* spacing = labelMap->GetSpacing();
+  this->VoxelVolume = spacing[0] * spacing[1] * spacing[2];
+
+  // the slabs are ranges of rows, so that 2D images are split too
+  vtkIdType numberOfRows = static_cast<vtkIdType>(labelDims[1]) * labelDims[2];
+  int numberOfThreads = static_cast<int>(
+    std::min(static_cast<vtkIdType>(this->NumberOfThreads), numberOfRows));
+  if (numberOfThreads < 1 || labelDims[0] < 1)
+    {
+    return 0;
+    }
+  this->LabelMap = labelMap;
+  this->Grayscale = grayscale;
+  this->Internal->ThreadAccumulators.clear();
+  this->Internal->ThreadAccumulators.resize(numberOfThreads);
+  if (numberOfThreads > 1)
+    {
+    this->MultiThreader->SetNumberOfThreads(numberOfThreads);
+    this->MultiThreader->SetSingleMethod(vtkImageLabelStatistics_ThreadedCompute, this);
+    this->MultiThreader->SingleMethodExecute();
+    }
+  else
+    {
+    this->ThreadedCompute(0, 1);
+    }
+  this->LabelMap = NULL;
+  this->Grayscale = NULL;
+
+  // merge the accumulators of the threads
+  LabelAccumulatorMap accumulators;
+  for (int thread = 0; thread < numberOfThreads; ++thread)
+    {
+    LabelAccumulatorMap& threadAccumulators =
+      this->Internal->ThreadAccumulators[thread];
+    for (LabelAccumulatorMap::const_iterator it = threadAccumulators.begin();
+         it != threadAccumulators.end(); ++it)
+      {
+      accumulators[it->first].Add(it->second);
+      }
+    }
+  std::vector<LabelAccumulatorMap>().swap(this->Internal->ThreadAccumulators);
+
+  for (LabelAccumulatorMap::const_iterator it = accumulators.begin();
+       it != accumulators.end(); ++it)
+    {
+    this->Internal->Labels.push_back(it->first);
+    this->Internal->Accumulators.push_back(it->second);
+    }
+  return this->GetNumberOfLabels();
+}
+
+//----------------------------------------------------------------------------
+void vtkImageLabelStatistics::ThreadedCompute(int threadId, int numberOfThreads)
+{
+  int dims[3];
+  this->LabelMap->GetDimensions(dims);
+  vtkIdType numberOfRows = static_cast<vtkIdType>(dims[1]) * dims[2];
+  vtkIdType begin = numberOfRows * threadId / numberOfThreads * dims[0];
+  vtkIdType end = numberOfRows * (threadId + 1) / numberOfThreads * dims[0];
+
+  void* labelPtr = this->LabelMap->GetScalarPointer();
+  int labelStep = this->LabelMap->GetNumberOfScalarComponents();
+  LabelAccumulatorMap& accumulators =
+    this->Internal->ThreadAccumulators[threadId];
+  switch (this->LabelMap->GetScalarType())
+    {
+    vtkTemplateMacro(
+      vtkImageLabelStatisticsAccumulate(static_cast<VTK_TT*>(labelPtr), labelStep,
+                                        this->Grayscale, begin, end, accumulators));
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkImageLabelStatistics::GetNumberOfLabels()
+{
+  return static_cast<int>(this->Internal->Labels.size());
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkImageLabelStatistics::GetLabel(int index)
+{
+  if (index < 0 || index >= this->GetNumberOfLabels())
+    {
+    vtkErrorMacro("GetLabel: index " << index << " out of range");
+    return 0;
+    }
+  return this->Internal->Labels[index];
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkImageLabelStatistics::GetCount(int index)
+{
+  if (index < 0 || index >= this->GetNumberOfLabels())
+    {
+    vtkErrorMacro("GetCount: index " << index << " out of range");
+    return 0;
+    }
+  return this->Internal->Accumulators[index].Count;
+}
+
+//----------------------------------------------------------------------------
+double vtkImageLabelStatistics::GetVolume(int index)
+{
+  return this->GetCount(index) * this->VoxelVolume;
+}
+
+//----------------------------------------------------------------------------
+double vtkImageLabelStatistics::GetMin(int index)
+{
+  if (index < 0 || index >= this->GetNumberOfLabels())
+    {
+    vtkErrorMacro("GetMin: index " << index << " out of range");
+    return 0.;
+    }
+  return this->Internal->Accumulators[index].Min;
+}
+
+//----------------------------------------------------------------------------
+double vtkImageLabelStatistics::GetMax(int index)
+{
+  if (index < 0 || index >= this->GetNumberOfLabels())
+    {
+    vtkErrorMacro("GetMax: index " << index << " out of range");
+    return 0.;
+    }
+  return this->Internal->Accumulators[index].Max;
+}
+
+//----------------------------------------------------------------------------
+double vtkImageLabelStatistics::GetMean(int index)
+{
+  if (index < 0 || index >= this->GetNumberOfLabels())
+    {
+    vtkErrorMacro("GetMean: index " << index << " out of range");
+    return 0.;
+    }
+  const LabelAccumulator& accumulator = this->Internal->Accumulators[index];
+  return accumulator.Sum / accumulator.Count;
+}
+
+//----------------------------------------------------------------------------
+double vtkImageLabelStatistics::GetStandardDeviation(int index)
+{
+  if (index < 0 || index >= this->GetNumberOfLabels())
+    {
+    vtkErrorMacro("GetStandardDeviation: index " << index << " out of range");
+    return 0.;
+    }
+  const LabelAccumulator& accumulator = this->Internal->Accumulators[index];
+  if (accumulator.Count < 2)
+    {
+    return 0.;
+    }
+  double count = static_cast<double>(accumulator.Count);
+  double mean = accumulator.Sum / count;
+  double variance = (accumulator.SumOfSquares - count * mean * mean) / (count - 1.);
+  return variance > 0. ? sqrt(variance) : 0.;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageLabelStatistics::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << "\n";
+  os << indent << "NumberOfLabels: " << this->GetNumberOfLabels() << "\n";
+}
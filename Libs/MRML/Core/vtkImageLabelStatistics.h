@@ -0,0 +1,89 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#ifndef __vtkImageLabelStatistics_h
+#define __vtkImageLabelStatistics_h
+
+// MRML includes
+#include "vtkMRML.h"
+
+// VTK includes
+#include <vtkObject.h>
+
+class vtkImageData;
+class vtkMultiThreader;
+
+/// \brief Statistics of a grayscale image for every label of a label map.
+///
+/// The count, volume, min, max, mean and standard deviation of the
+/// grayscale voxels of all the labels are computed in one pass over the
+/// images. The rows of the images are split between threads that have
+/// their own accumulators, merged once all the threads are done.
+/// Only the first component of the images is used.
+class VTK_MRML_EXPORT vtkImageLabelStatistics : public vtkObject
+{
+public:
+  static vtkImageLabelStatistics *New();
+  vtkTypeMacro(vtkImageLabelStatistics,vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  ///
+  /// Maximum number of threads used to compute the statistics
+  vtkSetClampMacro(NumberOfThreads, int, 1, VTK_MAX_THREADS);
+  vtkGetMacro(NumberOfThreads, int);
+
+  ///
+  /// Compute the statistics of grayscale for each label of labelMap.
+  /// The images must have the same dimensions.
+  /// Return the number of labels found or -1 on error.
+  int Compute(vtkImageData* labelMap, vtkImageData* grayscale);
+
+  ///
+  /// Labels found by the last Compute(), in increasing order
+  int GetNumberOfLabels();
+  vtkIdType GetLabel(int index);
+
+  ///
+  /// Statistics of the label at index, between 0 and GetNumberOfLabels()-1.
+  /// The volume is in cubic units of the spacing of the label map and the
+  /// standard deviation is the one of a sample like vtkImageAccumulate.
+  vtkIdType GetCount(int index);
+  double GetVolume(int index);
+  double GetMin(int index);
+  double GetMax(int index);
+  double GetMean(int index);
+  double GetStandardDeviation(int index);
+
+  ///
+  /// Accumulate the slab of rows of a thread, called by Compute()
+  void ThreadedCompute(int threadId, int numberOfThreads);
+
+protected:
+  vtkImageLabelStatistics();
+  ~vtkImageLabelStatistics();
+
+  int NumberOfThreads;
+  vtkMultiThreader* MultiThreader;
+  double VoxelVolume;
+
+  /// State of the current Compute()
+  vtkImageData* LabelMap;
+  vtkImageData* Grayscale;
+
+  class vtkInternal;
+  vtkInternal* Internal;
+
+private:
+  vtkImageLabelStatistics(const vtkImageLabelStatistics&);  /// Not implemented.
+  void operator=(const vtkImageLabelStatistics&);  /// Not implemented.
+};
+
+#endif
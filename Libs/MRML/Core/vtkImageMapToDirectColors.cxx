@@ -0,0 +1,169 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkImageMapToDirectColors.h"
+#include "vtkMRMLColorNode.h"
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkScalarsToColors.h>
+#include <vtkUnsignedCharArray.h>
+
+// STD includes
+#include <cstring>
+#include <limits>
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkImageMapToDirectColors);
+
+//----------------------------------------------------------------------------
+// Copy the RGBA color of each voxel from the table of all the values of T
+template <class T>
+static void vtkImageMapToDirectColorsExecute(vtkImageData* inData, const T* inPtr,
+                                             vtkImageData* outData, unsigned char* outPtr,
+                                             int outExt[6], const unsigned char* table)
+{
+  vtkIdType inIncX, inIncY, inIncZ;
+  vtkIdType outIncX, outIncY, outIncZ;
+  inData->GetContinuousIncrements(outExt, inIncX, inIncY, inIncZ);
+  outData->GetContinuousIncrements(outExt, outIncX, outIncY, outIncZ);
+  int rowLength = outExt[1] - outExt[0] + 1;
+
+  // the table starts at the smallest value of T
+  const unsigned char* colors =
+    table - 4 * static_cast<int>(std::numeric_limits<T>::min());
+  for (int z = outExt[4]; z <= outExt[5]; ++z)
+    {
+    for (int y = outExt[2]; y <= outExt[3]; ++y)
+      {
+      for (int x = 0; x < rowLength; ++x)
+        {
+        memcpy(outPtr, colors + 4 * static_cast<int>(*inPtr), 4);
+        ++inPtr;
+        outPtr += 4;
+        }
+      inPtr += inIncY;
+      outPtr += outIncY;
+      }
+    inPtr += inIncZ;
+    outPtr += outIncZ;
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkImageMapToDirectColors::vtkImageMapToDirectColors()
+{
+  this->DirectLookupTable = NULL;
+}
+
+//----------------------------------------------------------------------------
+vtkImageMapToDirectColors::~vtkImageMapToDirectColors()
+{
+}
+
+//----------------------------------------------------------------------------
+void vtkImageMapToDirectColors::SetColorNode(vtkMRMLColorNode* colorNode)
+{
+  if (this->ColorNode == colorNode)
+    {
+    return;
+    }
+  this->ColorNode = colorNode;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLColorNode* vtkImageMapToDirectColors::GetColorNode()
+{
+  return this->ColorNode;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageMapToDirectColors::RequestData(vtkInformation *request,
+                                           vtkInformationVector **inputVector,
+                                           vtkInformationVector *outputVector)
+{
+  this->DirectLookupTable = NULL;
+  vtkImageData* input = vtkImageData::SafeDownCast(
+    inputVector[0]->GetInformationObject(0)->Get(vtkDataObject::DATA_OBJECT()));
+  vtkDataArray* inScalars = input ? input->GetPointData()->GetScalars() : NULL;
+  // The table is looked up before the threads start, it is shared by
+  // them and computed if needed.
+  if (this->ColorNode && this->LookupTable &&
+      this->ColorNode->GetScalarsToColors() == this->LookupTable &&
+      inScalars && inScalars->GetNumberOfComponents() == 1 &&
+      this->ActiveComponent == 0 &&
+      this->OutputFormat == VTK_RGBA && !this->PassAlphaToOutput)
+    {
+    this->DirectLookupTable =
+      this->ColorNode->GetDirectLookupTable(inScalars->GetDataType());
+    }
+  int res = this->Superclass::RequestData(request, inputVector, outputVector);
+  this->DirectLookupTable = NULL;
+  return res;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageMapToDirectColors::ThreadedRequestData(vtkInformation *request,
+                                                    vtkInformationVector **inputVector,
+                                                    vtkInformationVector *outputVector,
+                                                    vtkImageData ***inData,
+                                                    vtkImageData **outData,
+                                                    int outExt[6], int id)
+{
+  vtkDataArray* inScalars = inData[0][0]->GetPointData()->GetScalars();
+  if (this->DirectLookupTable == NULL || inScalars == NULL)
+    {
+    this->Superclass::ThreadedRequestData(request, inputVector, outputVector,
+                                          inData, outData, outExt, id);
+    return;
+    }
+  void* inPtr = inData[0][0]->GetScalarPointerForExtent(outExt);
+  unsigned char* outPtr =
+    static_cast<unsigned char*>(outData[0]->GetScalarPointerForExtent(outExt));
+  const unsigned char* table = this->DirectLookupTable->GetPointer(0);
+  switch (inScalars->GetDataType())
+    {
+    case VTK_UNSIGNED_CHAR:
+      vtkImageMapToDirectColorsExecute(inData[0][0], static_cast<unsigned char*>(inPtr),
+                                       outData[0], outPtr, outExt, table);
+      break;
+    case VTK_SIGNED_CHAR:
+      vtkImageMapToDirectColorsExecute(inData[0][0], static_cast<signed char*>(inPtr),
+                                       outData[0], outPtr, outExt, table);
+      break;
+    case VTK_UNSIGNED_SHORT:
+      vtkImageMapToDirectColorsExecute(inData[0][0], static_cast<unsigned short*>(inPtr),
+                                       outData[0], outPtr, outExt, table);
+      break;
+    case VTK_SHORT:
+      vtkImageMapToDirectColorsExecute(inData[0][0], static_cast<short*>(inPtr),
+                                       outData[0], outPtr, outExt, table);
+      break;
+    default:
+      this->Superclass::ThreadedRequestData(request, inputVector, outputVector,
+                                            inData, outData, outExt, id);
+      break;
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkImageMapToDirectColors::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+  os << indent << "ColorNode: " << this->ColorNode.GetPointer() << "\n";
+}
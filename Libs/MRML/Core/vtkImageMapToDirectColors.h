@@ -0,0 +1,70 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#ifndef __vtkImageMapToDirectColors_h
+#define __vtkImageMapToDirectColors_h
+
+// MRML includes
+#include "vtkMRML.h"
+class vtkMRMLColorNode;
+
+// VTK includes
+#include <vtkImageMapToColors.h>
+#include <vtkWeakPointer.h>
+class vtkUnsignedCharArray;
+
+/// \brief vtkImageMapToColors that maps 8 and 16-bit images by direct index.
+///
+/// The one component unsigned char, signed char, unsigned short and short
+/// images mapped to RGBA copy the color of each voxel from the direct lookup
+/// table of the color node, that holds the colors of all the values of the
+/// type and is shared by all the display nodes. The other images, or if the
+/// lookup table is not the one of the color node, are mapped by
+/// vtkImageMapToColors.
+/// \sa vtkMRMLColorNode::GetDirectLookupTable()
+class VTK_MRML_EXPORT vtkImageMapToDirectColors : public vtkImageMapToColors
+{
+public:
+  static vtkImageMapToDirectColors *New();
+  vtkTypeMacro(vtkImageMapToDirectColors,vtkImageMapToColors);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  ///
+  /// Color node whose GetScalarsToColors() is the LookupTable, not
+  /// reference counted.
+  void SetColorNode(vtkMRMLColorNode* colorNode);
+  vtkMRMLColorNode* GetColorNode();
+
+protected:
+  vtkImageMapToDirectColors();
+  ~vtkImageMapToDirectColors();
+
+  virtual int RequestData(vtkInformation *request,
+                          vtkInformationVector **inputVector,
+                          vtkInformationVector *outputVector);
+
+  virtual void ThreadedRequestData(vtkInformation *request,
+                                   vtkInformationVector **inputVector,
+                                   vtkInformationVector *outputVector,
+                                   vtkImageData ***inData, vtkImageData **outData,
+                                   int extent[6], int id);
+
+  vtkWeakPointer<vtkMRMLColorNode> ColorNode;
+  /// Direct lookup table of the input during the execution, NULL if the
+  /// input is mapped by vtkImageMapToColors.
+  vtkUnsignedCharArray* DirectLookupTable;
+
+private:
+  vtkImageMapToDirectColors(const vtkImageMapToDirectColors&);  // Not implemented.
+  void operator=(const vtkImageMapToDirectColors&);  // Not implemented.
+};
+
+#endif
@@ -30,6 +30,7 @@ vtkMRMLClipModelsNode::vtkMRMLClipModelsNode()
   this->SetSingletonTag("vtkMRMLClipModelsNode");
   this->HideFromEditors = true;
   this->ClipType = 0;
+  this->ClipMethod = vtkMRMLClipModelsNode::ClipGeometry;
   this->RedSliceClipState = 0;
   this->YellowSliceClipState = 0;
   this->GreenSliceClipState = 0;
@@ -54,6 +55,7 @@ void vtkMRMLClipModelsNode::WriteXML(ostream& of, int nIndent)
   of << indent << " redSliceClipState=\"" << this->RedSliceClipState << "\"";
   of << indent << " yellowSliceClipState=\"" << this->YellowSliceClipState << "\"";
   of << indent << " greenSliceClipState=\"" << this->GreenSliceClipState << "\"";
+  of << indent << " clipMethod=\"" << this->ClipMethod << "\"";
 
 }
 
@@ -94,6 +96,12 @@ void vtkMRMLClipModelsNode::ReadXMLAttributes(const char** atts)
       ss << attValue;
       ss >> ClipType;
       }
+    else if (!strcmp(attName, "clipMethod")) 
+      {
+      std::stringstream ss;
+      ss << attValue;
+      ss >> ClipMethod;
+      }
     } 
     this->EndModify(disabledModify);
 
@@ -111,6 +119,7 @@ void vtkMRMLClipModelsNode::Copy(vtkMRMLNode *anode)
   vtkMRMLClipModelsNode *node = (vtkMRMLClipModelsNode *) anode;
 
   this->SetClipType(node->ClipType);
+  this->SetClipMethod(node->ClipMethod);
   this->SetYellowSliceClipState(node->YellowSliceClipState);
   this->SetGreenSliceClipState(node->GreenSliceClipState);
   this->SetRedSliceClipState(node->RedSliceClipState);
@@ -125,6 +134,7 @@ void vtkMRMLClipModelsNode::PrintSelf(ostream& os, vtkIndent indent)
   Superclass::PrintSelf(os,indent);
 
   os << indent << "ClipType:        " << this->ClipType << "\n";
+  os << indent << "ClipMethod:      " << this->ClipMethod << "\n";
   os << indent << "YellowSliceClipState: " << this->YellowSliceClipState << "\n";
   os << indent << "GreenSliceClipState:  " << this->GreenSliceClipState << "\n";
   os << indent << "RedSliceClipState:    " << this->RedSliceClipState << "\n";
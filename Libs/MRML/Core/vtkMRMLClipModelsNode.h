@@ -22,7 +22,7 @@
 /// The vtkMRMLClipModelsNode MRML node stores
 /// the direction of clipping for each of the three clipping planes.
 /// It also stores the type of combined clipping operation as either an
-/// intersection or union.
+/// intersection or union, and how the models are clipped.
 class VTK_MRML_EXPORT vtkMRMLClipModelsNode : public vtkMRMLNode
 {
 public:
@@ -89,6 +89,20 @@ public:
       ClipPositiveSpace = 1,
       ClipNegativeSpace = 2,
     };
+
+  /// 
+  /// Indicates how the models are clipped: the clipped polydata is
+  /// computed (ClipGeometry, default), or the fragments outside are
+  /// discarded by a shader that gets the planes as uniforms and no
+  /// geometry is computed when the slices move (ClipFragments).
+  vtkGetMacro(ClipMethod, int);
+  vtkSetClampMacro(ClipMethod, int, ClipGeometry, ClipFragments);
+
+  enum
+    {
+      ClipGeometry = 0,
+      ClipFragments = 1
+    };
   
 protected:
   vtkMRMLClipModelsNode();
@@ -97,6 +111,7 @@ protected:
   void operator=(const vtkMRMLClipModelsNode&);
 
   int ClipType;
+  int ClipMethod;
 
   int RedSliceClipState;
   int YellowSliceClipState;
@@ -21,11 +21,13 @@ Version:   $Revision: 1.0 $
 #include <vtkLookupTable.h>
 #include <vtkObjectFactory.h>
 #include <vtkSmartPointer.h>
+#include <vtkUnsignedCharArray.h>
 
 // STD includes
 #include <cassert>
 #include <sstream>
 #include <algorithm>
+#include <limits>
 
 //------------------------------------------------------------------------------
 vtkMRMLNodeNewMacro(vtkMRMLColorNode);
@@ -43,6 +45,12 @@ vtkMRMLColorNode::vtkMRMLColorNode()
   this->SetNoName("(none)");
 
   this->NamesInitialised = 0;
+
+  for (int i = 0; i < 4; ++i)
+    {
+    this->DirectLookupTables[i] = NULL;
+    this->DirectLookupTablesSources[i] = NULL;
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -59,6 +67,14 @@ vtkMRMLColorNode::~vtkMRMLColorNode()
     delete [] this->NoName;
     this->NoName = NULL;
     }
+
+  for (int i = 0; i < 4; ++i)
+    {
+    if (this->DirectLookupTables[i])
+      {
+      this->DirectLookupTables[i]->Delete();
+      }
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -142,6 +158,74 @@ vtkScalarsToColors * vtkMRMLColorNode::GetScalarsToColors()
   return this->GetLookupTable();
 }
 
+//----------------------------------------------------------------------------
+template <class T>
+static void vtkMRMLColorNodeMapAllValues(vtkScalarsToColors* scalarsToColors,
+                                         vtkUnsignedCharArray* table, int scalarType)
+{
+  const int numberOfValues = 1 << (8 * sizeof(T));
+  std::vector<T> values(numberOfValues);
+  for (int i = 0; i < numberOfValues; ++i)
+    {
+    values[i] = static_cast<T>(std::numeric_limits<T>::min() + i);
+    }
+  table->SetNumberOfTuples(numberOfValues);
+  scalarsToColors->MapScalarsThroughTable2(&values[0], table->GetPointer(0),
+                                           scalarType, numberOfValues, 1, VTK_RGBA);
+}
+
+//----------------------------------------------------------------------------
+vtkUnsignedCharArray* vtkMRMLColorNode::GetDirectLookupTable(int scalarType)
+{
+  int typeIndex = -1;
+  switch (scalarType)
+    {
+    case VTK_UNSIGNED_CHAR: typeIndex = 0; break;
+    case VTK_SIGNED_CHAR: typeIndex = 1; break;
+    case VTK_UNSIGNED_SHORT: typeIndex = 2; break;
+    case VTK_SHORT: typeIndex = 3; break;
+    default:
+      return NULL;
+    }
+  vtkScalarsToColors* scalarsToColors = this->GetScalarsToColors();
+  if (scalarsToColors == NULL)
+    {
+    return NULL;
+    }
+  vtkUnsignedCharArray*& table = this->DirectLookupTables[typeIndex];
+  if (table &&
+      this->DirectLookupTablesSources[typeIndex] == scalarsToColors &&
+      scalarsToColors->GetMTime() < this->DirectLookupTablesTimes[typeIndex].GetMTime())
+    {
+    return table;
+    }
+  if (table == NULL)
+    {
+    table = vtkUnsignedCharArray::New();
+    table->SetNumberOfComponents(4);
+    }
+  // same as vtkImageMapToColors
+  scalarsToColors->Build();
+  switch (scalarType)
+    {
+    case VTK_UNSIGNED_CHAR:
+      vtkMRMLColorNodeMapAllValues<unsigned char>(scalarsToColors, table, scalarType);
+      break;
+    case VTK_SIGNED_CHAR:
+      vtkMRMLColorNodeMapAllValues<signed char>(scalarsToColors, table, scalarType);
+      break;
+    case VTK_UNSIGNED_SHORT:
+      vtkMRMLColorNodeMapAllValues<unsigned short>(scalarsToColors, table, scalarType);
+      break;
+    case VTK_SHORT:
+      vtkMRMLColorNodeMapAllValues<short>(scalarsToColors, table, scalarType);
+      break;
+    }
+  this->DirectLookupTablesSources[typeIndex] = scalarsToColors;
+  this->DirectLookupTablesTimes[typeIndex].Modified();
+  return table;
+}
+
 //----------------------------------------------------------------------------
 // Copy the node's attributes to this object.
 // Does NOT copy: ID, FilePrefix, Name, ID
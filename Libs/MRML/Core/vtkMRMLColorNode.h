@@ -21,6 +21,7 @@
 // VTK includes
 class vtkLookupTable;
 class vtkScalarsToColors;
+class vtkUnsignedCharArray;
 
 // Std includes
 #include <string>
@@ -109,7 +110,7 @@ public:
 
   /// 
   /// Get the 0th based nth name of this colour
-  const char *GetColorName(int ind);
+  virtual const char *GetColorName(int ind);
 
   /// Get the 0'th based \a colorIndex'th name of this color, replacing all
   /// file name sensitive color name characters with safer character(s).
@@ -162,6 +163,17 @@ public:
   /// the method if you want it to return something else in subclasses
   virtual vtkScalarsToColors* GetScalarsToColors();
 
+  /// RGBA colors of all the values of an 8 or 16-bit integer scalar type
+  /// (VTK_UNSIGNED_CHAR, VTK_SIGNED_CHAR, VTK_UNSIGNED_SHORT or VTK_SHORT),
+  /// from the smallest value of the type to the largest, as mapped by
+  /// GetScalarsToColors(). The table is computed at the first request after
+  /// GetScalarsToColors() is modified, and is shared by all the display
+  /// nodes: the images of these types are mapped by a direct index in the
+  /// table instead of going through the lookup table for each voxel.
+  /// Return NULL for the other scalar types or if there is no lookup table.
+  /// \sa vtkImageMapToDirectColors
+  vtkUnsignedCharArray* GetDirectLookupTable(int scalarType);
+
   /// get/set the string used for an unnamed colour
   /// "(none)" by default.
   /// \sa SetColorName
@@ -215,6 +227,13 @@ protected:
   /// 
   /// Have the colour names been set? Used to do lazy copy of the Names array.
   int NamesInitialised;
+
+  /// Direct lookup tables of the unsigned char, signed char, unsigned short
+  /// and short scalars, the scalars to colors they are computed from (only
+  /// compared) and when.
+  vtkUnsignedCharArray* DirectLookupTables[4];
+  vtkScalarsToColors* DirectLookupTablesSources[4];
+  vtkTimeStamp DirectLookupTablesTimes[4];
 };
 
 #endif
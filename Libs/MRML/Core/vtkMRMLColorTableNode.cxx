@@ -34,6 +34,7 @@ vtkMRMLColorTableNode::vtkMRMLColorTableNode()
   this->SetName("");
   this->SetDescription("Color Table");
   this->LookupTable = NULL;
+  this->LazyTypePending = false;
   this->LastAddedColor = -1;
 }
 
@@ -49,6 +50,9 @@ vtkMRMLColorTableNode::~vtkMRMLColorTableNode()
 //----------------------------------------------------------------------------
 void vtkMRMLColorTableNode::WriteXML(ostream& of, int nIndent)
 {
+  // Lazy types are built before being written
+  this->BuildLazyType();
+
   // Write all attributes not equal to their FullRainbows
   
   Superclass::WriteXML(of, nIndent);
@@ -174,7 +178,7 @@ void vtkMRMLColorTableNode::Copy(vtkMRMLNode *anode)
 
   Superclass::Copy(anode);
   vtkMRMLColorTableNode *node = (vtkMRMLColorTableNode *) anode;
-  if (node->LookupTable)
+  if (node->GetLookupTable())
     {
     this->SetLookupTable(node->LookupTable);
     }
@@ -604,6 +608,8 @@ void vtkMRMLColorTableNode::ProcessMRMLEvents ( vtkObject *caller,
 //---------------------------------------------------------------------------
 void vtkMRMLColorTableNode::SetType(int type)
 {
+  // Setting a type discards the lazy type
+  this->LazyTypePending = false;
   if (this->GetLookupTable() != NULL &&
       this->Type == type)
     {
@@ -1251,6 +1257,67 @@ void vtkMRMLColorTableNode::SetType(int type)
     this->InvokeEvent(vtkMRMLColorTableNode::TypeModifiedEvent);
 }
 
+//---------------------------------------------------------------------------
+void vtkMRMLColorTableNode::SetLazyType(int type)
+{
+  if (type == this->File && this->LookupTable == NULL)
+    {
+    // create the (empty) table the storage node will fill
+    this->SetType(type);
+    }
+  this->Type = type;
+  this->LazyTypePending = true;
+}
+
+//---------------------------------------------------------------------------
+bool vtkMRMLColorTableNode::GetLazyTypePending()const
+{
+  return this->LazyTypePending;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLColorTableNode::BuildLazyType()
+{
+  if (!this->LazyTypePending)
+    {
+    return;
+    }
+  this->LazyTypePending = false;
+
+  // Invoke at most one modified event for the whole table
+  int disabledModify = this->StartModify();
+  if (this->Type == this->File)
+    {
+    if (this->GetStorageNode() == NULL ||
+        this->GetStorageNode()->ReadData(this) == 0)
+      {
+      vtkErrorMacro("BuildLazyType: Unable to read color file "
+                    << (this->GetStorageNode() &&
+                        this->GetStorageNode()->GetFileName() ?
+                        this->GetStorageNode()->GetFileName() : ""));
+      }
+    }
+  else
+    {
+    this->SetType(this->Type);
+    }
+  this->EndModify(disabledModify);
+}
+
+//---------------------------------------------------------------------------
+vtkLookupTable* vtkMRMLColorTableNode::GetLookupTable()
+{
+  this->BuildLazyType();
+  return this->LookupTable;
+}
+
+//---------------------------------------------------------------------------
+const char *vtkMRMLColorTableNode::GetColorName(int ind)
+{
+  this->BuildLazyType();
+  return this->Superclass::GetColorName(ind);
+}
+
 //---------------------------------------------------------------------------
 void vtkMRMLColorTableNode::SetNumberOfColors(int n)
 {
@@ -1432,6 +1499,7 @@ void vtkMRMLColorTableNode::Reset()
 //---------------------------------------------------------------------------
 int vtkMRMLColorTableNode::GetColorIndexByName(const char *name)
 {
+  this->BuildLazyType();
   if (this->GetNamesInitialised() && name != NULL)
     {
     std::string strName = name;
@@ -52,12 +52,25 @@ public:
   /// Get node XML tag name (like Volume, Model)
   virtual const char* GetNodeTagName() {return "ColorTable";};
 
-  vtkGetObjectMacro(LookupTable, vtkLookupTable);
+  /// Return the lookup table, built first if the type was set with
+  /// SetLazyType().
+  virtual vtkLookupTable* GetLookupTable();
   virtual void SetLookupTable(vtkLookupTable* newLookupTable);
 
   /// 
   /// Get/Set for Type
   void SetType(int type);
+
+  /// Set the type without building the colors of the table: they are built
+  /// (or read by the storage node for the File type) the first time the
+  /// lookup table, a color or a color name is asked for. It saves the cost
+  /// of the tables that are never used, e.g. the default color nodes.
+  /// \sa GetLazyTypePending(), SetType()
+  void SetLazyType(int type);
+
+  /// Return true if the colors of the type set by SetLazyType() are not
+  /// built yet.
+  bool GetLazyTypePending()const;
   vtkGetMacro(Type,int);
   void SetTypeToFullRainbow();
   void SetTypeToGrey();
@@ -214,6 +227,9 @@ public:
   /// Return true if the color exists, false otherwise
   virtual bool GetColor(int entry, double* color);
 
+  /// Reimplemented to build the colors of a lazy type first.
+  virtual const char *GetColorName(int ind);
+
   /// 
   /// clear out the names list
   void ClearNames();
@@ -237,10 +253,16 @@ protected:
   vtkMRMLColorTableNode(const vtkMRMLColorTableNode&);
   void operator=(const vtkMRMLColorTableNode&);
 
+  /// Build the colors of the type set by SetLazyType() if not done yet.
+  void BuildLazyType();
+
   ///  
   /// The look up table, constructed according to the Type
   vtkLookupTable *LookupTable;
 
+  /// True until the colors of the type set by SetLazyType() are built.
+  bool LazyTypePending;
+
 };
 
 #endif
@@ -587,6 +587,7 @@
     const char *f0 = node->GetNthFileName(0);       \
     std::cout << "Filename 0 = " << (f0 == NULL ? "NULL" : f0) << std::endl; \
     TEST_SET_GET_BOOLEAN(node, UseCompression);         \
+    TEST_SET_GET_INT_RANGE(node, CompressionLevel, -1, 9); \
     TEST_SET_GET_STRING(node, URI);                     \
     vtkURIHandler *handler = vtkURIHandler::New();      \
     node->SetURIHandler(NULL);                          \
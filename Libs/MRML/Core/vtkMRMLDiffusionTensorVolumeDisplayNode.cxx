@@ -13,6 +13,7 @@ Version:   $Revision: 1.2 $
 =========================================================================auto=*/
 
 // MRML includes
+#include "vtkImageMapToDirectColors.h"
 #include "vtkMRMLDiffusionTensorVolumeDisplayNode.h"
 #include "vtkMRMLDiffusionTensorVolumeSliceDisplayNode.h"
 #include "vtkMRMLScene.h"
@@ -46,6 +47,10 @@ vtkMRMLDiffusionTensorVolumeDisplayNode::vtkMRMLDiffusionTensorVolumeDisplayNode
  this->ScalarInvariant = vtkMRMLDiffusionTensorDisplayPropertiesNode::ColorOrientation;
  this->DTIMathematics = vtkDiffusionTensorMathematics::New();
  this->DTIMathematicsAlpha = vtkDiffusionTensorMathematics::New();
+ // the input is a slice, keep its eigen systems so that changing the
+ // scalar invariant doesn't solve them again
+ this->DTIMathematics->CacheEigenSystemsOn();
+ this->DTIMathematicsAlpha->CacheEigenSystemsOn();
  this->Threshold->SetInputConnection( this->DTIMathematics->GetOutputPort());
  this->MapToWindowLevelColors->SetInputConnection( this->DTIMathematics->GetOutputPort());
 
@@ -18,8 +18,30 @@ Version:   $Revision: 1.14 $
 #include "vtkMRMLDiffusionTensorVolumeNode.h"
 #include "vtkMRMLNRRDStorageNode.h"
 
+// Teem includes
+#include <vtkDiffusionTensorMathematics.h>
+
 // VTK includes
+#include <vtkFloatArray.h>
+#include <vtkImageData.h>
+#include <vtkMultiThreader.h>
 #include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkSignedCharArray.h>
+#include <vtkSmartPointer.h>
+
+// STD includes
+#include <cmath>
+
+//------------------------------------------------------------------------------
+static VTK_THREAD_RETURN_TYPE vtkMRMLDiffusionTensorVolumeNode_ThreadedCompute(void *arg)
+{
+  vtkMultiThreader::ThreadInfo *info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  vtkMRMLDiffusionTensorVolumeNode *self =
+    static_cast<vtkMRMLDiffusionTensorVolumeNode*>(info->UserData);
+  self->ThreadedComputeEigenSystems(info->ThreadID, info->NumberOfThreads);
+  return VTK_THREAD_RETURN_VALUE;
+}
 
 //------------------------------------------------------------------------------
 vtkMRMLNodeNewMacro(vtkMRMLDiffusionTensorVolumeNode);
@@ -28,6 +50,10 @@ vtkMRMLNodeNewMacro(vtkMRMLDiffusionTensorVolumeNode);
 vtkMRMLDiffusionTensorVolumeNode::vtkMRMLDiffusionTensorVolumeNode()
 {
   this->Order = 2; //Second order Tensor
+  this->QuantizeEigenvectors = 0;
+  this->Eigenvalues = NULL;
+  this->PrincipalEigenvectors = NULL;
+  this->EigenSystemsTensors = NULL;
 }
 
 //----------------------------------------------------------------------------
@@ -46,12 +72,21 @@ void vtkMRMLDiffusionTensorVolumeNode::SetAndObserveDisplayNodeID(const char *di
 //----------------------------------------------------------------------------
 vtkMRMLDiffusionTensorVolumeNode::~vtkMRMLDiffusionTensorVolumeNode()
 {
+  if (this->Eigenvalues)
+    {
+    this->Eigenvalues->Delete();
+    }
+  if (this->PrincipalEigenvectors)
+    {
+    this->PrincipalEigenvectors->Delete();
+    }
 }
 
 //----------------------------------------------------------------------------
 void vtkMRMLDiffusionTensorVolumeNode::PrintSelf(ostream& os, vtkIndent indent)
 {
   Superclass::PrintSelf(os,indent);
+  os << indent << "QuantizeEigenvectors: " << this->QuantizeEigenvectors << "\n";
 }
 
 //----------------------------------------------------------------------------
@@ -66,3 +101,150 @@ vtkMRMLStorageNode* vtkMRMLDiffusionTensorVolumeNode::CreateDefaultStorageNode()
 {
   return vtkMRMLNRRDStorageNode::New();
 }
+
+//----------------------------------------------------------------------------
+void vtkMRMLDiffusionTensorVolumeNode::SetQuantizeEigenvectors(int quantize)
+{
+  if (this->QuantizeEigenvectors == quantize)
+    {
+    return;
+    }
+  this->QuantizeEigenvectors = quantize;
+  // The eigenvectors are stored in the new type at the next request
+  this->EigenSystemsTensors = NULL;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+vtkFloatArray* vtkMRMLDiffusionTensorVolumeNode::GetEigenvalues()
+{
+  return this->UpdateEigenSystems() ? this->Eigenvalues : NULL;
+}
+
+//----------------------------------------------------------------------------
+vtkDataArray* vtkMRMLDiffusionTensorVolumeNode::GetPrincipalEigenvectors()
+{
+  return this->UpdateEigenSystems() ? this->PrincipalEigenvectors : NULL;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLDiffusionTensorVolumeNode
+::GetEigenSystem(vtkIdType id, double eigenvalues[3], double principalEigenvector[3])
+{
+  if (!this->UpdateEigenSystems() ||
+      id < 0 || id >= this->Eigenvalues->GetNumberOfTuples())
+    {
+    return false;
+    }
+  this->Eigenvalues->GetTuple(id, eigenvalues);
+  this->PrincipalEigenvectors->GetTuple(id, principalEigenvector);
+  if (this->QuantizeEigenvectors)
+    {
+    for (int i = 0; i < 3; ++i)
+      {
+      principalEigenvector[i] /= VTK_SIGNED_CHAR_MAX;
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLDiffusionTensorVolumeNode::UpdateEigenSystems()
+{
+  vtkImageData* imageData = this->GetImageData();
+  vtkDataArray* tensors = imageData ?
+    imageData->GetPointData()->GetTensors() : NULL;
+  if (tensors == NULL || tensors->GetNumberOfComponents() != 9)
+    {
+    return false;
+    }
+  if (tensors == this->EigenSystemsTensors &&
+      tensors->GetMTime() < this->EigenSystemsTime.GetMTime() &&
+      this->Eigenvalues->GetNumberOfTuples() == tensors->GetNumberOfTuples())
+    {
+    return true;
+    }
+
+  if (this->Eigenvalues == NULL)
+    {
+    this->Eigenvalues = vtkFloatArray::New();
+    this->Eigenvalues->SetName("Eigenvalues");
+    this->Eigenvalues->SetNumberOfComponents(3);
+    }
+  if (this->PrincipalEigenvectors &&
+      this->PrincipalEigenvectors->IsA("vtkSignedCharArray") != this->QuantizeEigenvectors)
+    {
+    this->PrincipalEigenvectors->Delete();
+    this->PrincipalEigenvectors = NULL;
+    }
+  if (this->PrincipalEigenvectors == NULL)
+    {
+    if (this->QuantizeEigenvectors)
+      {
+      this->PrincipalEigenvectors = vtkSignedCharArray::New();
+      }
+    else
+      {
+      this->PrincipalEigenvectors = vtkFloatArray::New();
+      }
+    this->PrincipalEigenvectors->SetName("PrincipalEigenvectors");
+    this->PrincipalEigenvectors->SetNumberOfComponents(3);
+    }
+  this->Eigenvalues->SetNumberOfTuples(tensors->GetNumberOfTuples());
+  this->PrincipalEigenvectors->SetNumberOfTuples(tensors->GetNumberOfTuples());
+
+  this->EigenSystemsTensors = tensors;
+  vtkSmartPointer<vtkMultiThreader> threader = vtkSmartPointer<vtkMultiThreader>::New();
+  threader->SetSingleMethod(vtkMRMLDiffusionTensorVolumeNode_ThreadedCompute, this);
+  threader->SingleMethodExecute();
+  this->EigenSystemsTime.Modified();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLDiffusionTensorVolumeNode::ThreadedComputeEigenSystems(int threadId, int numberOfThreads)
+{
+  vtkDataArray* tensors = this->EigenSystemsTensors;
+  vtkIdType numberOfTensors = tensors->GetNumberOfTuples();
+  vtkIdType begin = numberOfTensors * threadId / numberOfThreads;
+  vtkIdType end = numberOfTensors * (threadId + 1) / numberOfThreads;
+
+  float* eigenvalues = this->Eigenvalues->GetPointer(0);
+  float* eigenvectors = this->QuantizeEigenvectors ? NULL :
+    vtkFloatArray::SafeDownCast(this->PrincipalEigenvectors)->GetPointer(0);
+  signed char* quantizedEigenvectors = !this->QuantizeEigenvectors ? NULL :
+    vtkSignedCharArray::SafeDownCast(this->PrincipalEigenvectors)->GetPointer(0);
+
+  double tensor[9];
+  double m0[3], m1[3], m2[3];
+  double v0[3], v1[3], v2[3];
+  double *m[3] = {m0, m1, m2};
+  double *v[3] = {v0, v1, v2};
+  double w[3];
+  for (vtkIdType id = begin; id < end; ++id)
+    {
+    tensors->GetTuple(id, tensor);
+    for (int j = 0; j < 3; ++j)
+      {
+      for (int i = 0; i < 3; ++i)
+        {
+        // transpose
+        m[i][j] = tensor[3 * j + i];
+        }
+      }
+    vtkDiffusionTensorMathematics::TeemEigenSolver(m, w, v);
+    for (int i = 0; i < 3; ++i)
+      {
+      eigenvalues[3 * id + i] = static_cast<float>(w[i]);
+      if (eigenvectors)
+        {
+        eigenvectors[3 * id + i] = static_cast<float>(v[i][0]);
+        }
+      else
+        {
+        quantizedEigenvectors[3 * id + i] = static_cast<signed char>(
+          floor(v[i][0] * VTK_SIGNED_CHAR_MAX + 0.5));
+        }
+      }
+    }
+}
@@ -18,6 +18,8 @@
 #include "vtkMRMLDiffusionImageVolumeNode.h"
 
 class vtkMRMLDiffusionTensorVolumeDisplayNode;
+class vtkDataArray;
+class vtkFloatArray;
 
 /// \brief MRML node for representing diffusion weighted MRI volume.
 ///
@@ -49,10 +51,51 @@ class VTK_MRML_EXPORT vtkMRMLDiffusionTensorVolumeNode : public vtkMRMLDiffusion
   /// Create default storage node or NULL if does not have one
   virtual vtkMRMLStorageNode* CreateDefaultStorageNode();
 
+  /// Eigenvalues of the tensors of the image data, sorted in decreasing
+  /// order, one 3-component tuple per voxel.
+  /// The eigen-systems are computed by threads at the first request after
+  /// the tensors are modified and are shared by all the callers.
+  /// NULL if the image data has no tensors.
+  /// \sa GetPrincipalEigenvectors(), GetEigenSystem()
+  vtkFloatArray* GetEigenvalues();
+
+  /// Eigenvectors of the largest eigenvalues, one 3-component tuple per
+  /// voxel. With QuantizeEigenvectors, the array is a vtkSignedCharArray of
+  /// the components scaled by 127.
+  /// \sa GetEigenvalues(), GetEigenSystem()
+  vtkDataArray* GetPrincipalEigenvectors();
+
+  /// Sorted eigenvalues and unit principal eigenvector of the voxel id.
+  /// Return false if the image data has no tensors or id is out of range.
+  bool GetEigenSystem(vtkIdType id, double eigenvalues[3], double principalEigenvector[3]);
+
+  /// Store the principal eigenvectors in signed chars instead of floats,
+  /// which divides their memory by 4 for an angular error below 1 degree.
+  /// Off by default.
+  void SetQuantizeEigenvectors(int quantize);
+  vtkGetMacro(QuantizeEigenvectors, int);
+  vtkBooleanMacro(QuantizeEigenvectors, int);
+
+  /// Compute the eigen-systems of the voxels of a thread, called by
+  /// GetEigenvalues() and GetPrincipalEigenvectors().
+  void ThreadedComputeEigenSystems(int threadId, int numberOfThreads);
+
 protected:
   vtkMRMLDiffusionTensorVolumeNode();
   ~vtkMRMLDiffusionTensorVolumeNode();
 
+  /// Recompute the eigen-systems if the tensors changed since they were
+  /// computed, return false if there is no tensors.
+  bool UpdateEigenSystems();
+
+  int QuantizeEigenvectors;
+
+  vtkFloatArray* Eigenvalues;
+  vtkDataArray* PrincipalEigenvectors;
+  /// Tensors the eigen-systems are computed from, only compared.
+  vtkDataArray* EigenSystemsTensors;
+  vtkTimeStamp EigenSystemsTime;
+
   vtkMRMLDiffusionTensorVolumeNode(const vtkMRMLDiffusionTensorVolumeNode&);
   void operator=(const vtkMRMLDiffusionTensorVolumeNode&);
 
@@ -33,6 +33,7 @@ vtkMRMLNodeNewMacro(vtkMRMLDiffusionWeightedVolumeDisplayNode);
 vtkMRMLDiffusionWeightedVolumeDisplayNode::vtkMRMLDiffusionWeightedVolumeDisplayNode()
 {
   this->DiffusionComponent = 0;
+  this->InputDiffusionComponentOnly = 0;
   this->ExtractComponent = vtkImageExtractComponents::New();
   this->Threshold->SetInputConnection( this->ExtractComponent->GetOutputPort());
   this->MapToWindowLevelColors->SetInputConnection(
@@ -102,6 +103,8 @@ void vtkMRMLDiffusionWeightedVolumeDisplayNode::PrintSelf(ostream& os, vtkIndent
   Superclass::PrintSelf(os,indent);
 
   os << indent << "Diffusion Component:   " << this->DiffusionComponent << "\n";
+  os << indent << "Input Diffusion Component Only:   "
+     << this->InputDiffusionComponentOnly << "\n";
 
 }
 
@@ -133,6 +136,7 @@ vtkImageData* vtkMRMLDiffusionWeightedVolumeDisplayNode::GetScalarImageData()
 //----------------------------------------------------------------------------
 void vtkMRMLDiffusionWeightedVolumeDisplayNode::UpdateImageDataPipeline()
 {
-  this->ExtractComponent->SetComponents(this->GetDiffusionComponent());
+  this->ExtractComponent->SetComponents(
+    this->InputDiffusionComponentOnly ? 0 : this->GetDiffusionComponent());
   this->Superclass::UpdateImageDataPipeline();
 }
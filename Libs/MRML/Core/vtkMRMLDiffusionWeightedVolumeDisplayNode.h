@@ -74,6 +74,14 @@ class VTK_MRML_EXPORT vtkMRMLDiffusionWeightedVolumeDisplayNode : public vtkMRML
   /// Set/Get interpolate reformated slices
   vtkGetMacro(DiffusionComponent, int);
   vtkSetMacro(DiffusionComponent, int);
+
+  ///
+  /// Set to 1 if the input image data only contains the DiffusionComponent,
+  /// e.g. when the slice logic reslices that component only (default 0).
+  /// The component is then not extracted again. Not saved nor copied.
+  vtkGetMacro(InputDiffusionComponentOnly, int);
+  vtkSetMacro(InputDiffusionComponentOnly, int);
+  vtkBooleanMacro(InputDiffusionComponentOnly, int);
  
 protected:
   vtkMRMLDiffusionWeightedVolumeDisplayNode();
@@ -88,6 +96,7 @@ protected:
   virtual vtkImageData* GetScalarImageData();
 
   int DiffusionComponent;
+  int InputDiffusionComponentOnly;
 
   vtkImageExtractComponents *ExtractComponent;
 
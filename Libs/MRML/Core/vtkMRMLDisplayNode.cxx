@@ -568,6 +568,16 @@ void vtkMRMLDisplayNode::Copy(vtkMRMLNode *anode)
   this->EndModify(disabledModify);
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLDisplayNode::GetDataObjects(vtkCollection* dataObjects)
+{
+  this->Superclass::GetDataObjects(dataObjects);
+  if (this->TextureImageData)
+    {
+    dataObjects->AddItem(this->TextureImageData);
+    }
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLDisplayNode::PrintSelf(ostream& os, vtkIndent indent)
 {
@@ -56,6 +56,9 @@ public:
   /// Copy the node's attributes to this object.
   virtual void Copy(vtkMRMLNode *node);
 
+  /// Add the texture image data
+  virtual void GetDataObjects(vtkCollection* dataObjects);
+
   /// Propagate ModifiedEvent generated by the texture image data or the color
   /// node.
   /// \sa TextureImageData, ColorNode
@@ -21,6 +21,8 @@ Version:   $Revision: 1.2 $
 #include <vtkObjectFactory.h>
 
 // STD includes
+#include <algorithm>
+#include <cmath>
 #include <sstream>
 
 //------------------------------------------------------------------------------
@@ -567,6 +569,228 @@ void vtkMRMLDoubleArrayNode::GetYRange(double* range, int fIncludeError)
 
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLDoubleArrayNode::SetXYValues(vtkDoubleArray* x, vtkDoubleArray* y, vtkDoubleArray* yerr)
+{
+  if (!x || !y)
+    {
+    vtkErrorMacro("SetXYValues: X and Y arrays are required");
+    return;
+    }
+  vtkIdType n = x->GetNumberOfTuples();
+  if (x->GetNumberOfComponents() != 1 || y->GetNumberOfComponents() != 1 ||
+      y->GetNumberOfTuples() != n ||
+      (yerr && (yerr->GetNumberOfComponents() != 1 ||
+                yerr->GetNumberOfTuples() != n)))
+    {
+    vtkErrorMacro("SetXYValues: arrays must have 1 component and the same "
+                  "number of tuples");
+    return;
+    }
+  this->SetXYValues(n, x->GetPointer(0), y->GetPointer(0),
+                    yerr ? yerr->GetPointer(0) : 0);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLDoubleArrayNode::SetXYValues(vtkIdType n, const double* x, const double* y, const double* yerr)
+{
+  this->Array->SetNumberOfComponents(3);
+  this->Array->SetNumberOfTuples(n);
+  double* values = this->Array->GetPointer(0);
+  for (vtkIdType i = 0; i < n; ++i, values += 3)
+    {
+    values[0] = x[i];
+    values[1] = y[i];
+    values[2] = yerr ? yerr[i] : 0.0;
+    }
+  this->Array->Modified();
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLDoubleArrayNode::GetXYValues(vtkDoubleArray* x, vtkDoubleArray* y, vtkDoubleArray* yerr)
+{
+  if (!x || !y)
+    {
+    vtkErrorMacro("GetXYValues: X and Y arrays are required");
+    return;
+    }
+  vtkIdType n = this->Array->GetNumberOfTuples();
+  x->SetNumberOfComponents(1);
+  x->SetNumberOfTuples(n);
+  y->SetNumberOfComponents(1);
+  y->SetNumberOfTuples(n);
+  if (yerr)
+    {
+    yerr->SetNumberOfComponents(1);
+    yerr->SetNumberOfTuples(n);
+    }
+  this->GetXYValues(x->GetPointer(0), y->GetPointer(0),
+                    yerr ? yerr->GetPointer(0) : 0);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLDoubleArrayNode::GetXYValues(double* x, double* y, double* yerr)
+{
+  vtkIdType n = this->Array->GetNumberOfTuples();
+  int nComp = this->Array->GetNumberOfComponents();
+  if (nComp < 2)
+    {
+    return;
+    }
+  const double* values = this->Array->GetPointer(0);
+  for (vtkIdType i = 0; i < n; ++i, values += nComp)
+    {
+    x[i] = values[0];
+    y[i] = values[1];
+    if (yerr)
+      {
+      yerr[i] = nComp > 2 ? values[2] : 0.0;
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+namespace
+{
+void InsertDecimatedValue(vtkDoubleArray* decimated, const double* values,
+                          int nComp, vtkIdType index)
+{
+  const double* value = values + index * nComp;
+  double xy[3];
+  xy[0] = value[0];
+  xy[1] = value[1];
+  xy[2] = nComp > 2 ? value[2] : 0.0;
+  decimated->InsertNextTuple(xy);
+}
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLDoubleArrayNode::GetMinMaxDecimatedValues(int numberOfBins, vtkDoubleArray* decimated)
+{
+  if (!decimated)
+    {
+    return;
+    }
+  vtkIdType n = this->Array->GetNumberOfTuples();
+  int nComp = this->Array->GetNumberOfComponents();
+  decimated->Initialize();
+  decimated->SetNumberOfComponents(3);
+  if (nComp < 2)
+    {
+    return;
+    }
+  const double* values = this->Array->GetPointer(0);
+  if (numberOfBins < 1 || n <= 2 * static_cast<vtkIdType>(numberOfBins))
+    {
+    decimated->Allocate(n * 3);
+    for (vtkIdType i = 0; i < n; ++i)
+      {
+      InsertDecimatedValue(decimated, values, nComp, i);
+      }
+    return;
+    }
+
+  decimated->Allocate(2 * numberOfBins * 3);
+  for (int bin = 0; bin < numberOfBins; ++bin)
+    {
+    vtkIdType begin = n * bin / numberOfBins;
+    vtkIdType end = n * (bin + 1) / numberOfBins;
+    vtkIdType minIndex = begin;
+    vtkIdType maxIndex = begin;
+    for (vtkIdType i = begin + 1; i < end; ++i)
+      {
+      double y = values[i * nComp + 1];
+      if (y < values[minIndex * nComp + 1])
+        {
+        minIndex = i;
+        }
+      else if (y > values[maxIndex * nComp + 1])
+        {
+        maxIndex = i;
+        }
+      }
+    InsertDecimatedValue(decimated, values, nComp, std::min(minIndex, maxIndex));
+    if (minIndex != maxIndex)
+      {
+      InsertDecimatedValue(decimated, values, nComp, std::max(minIndex, maxIndex));
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLDoubleArrayNode::GetLTTBDecimatedValues(int numberOfPoints, vtkDoubleArray* decimated)
+{
+  if (!decimated)
+    {
+    return;
+    }
+  vtkIdType n = this->Array->GetNumberOfTuples();
+  int nComp = this->Array->GetNumberOfComponents();
+  decimated->Initialize();
+  decimated->SetNumberOfComponents(3);
+  if (nComp < 2)
+    {
+    return;
+    }
+  const double* values = this->Array->GetPointer(0);
+  if (numberOfPoints < 3 || n <= static_cast<vtkIdType>(numberOfPoints))
+    {
+    decimated->Allocate(n * 3);
+    for (vtkIdType i = 0; i < n; ++i)
+      {
+      InsertDecimatedValue(decimated, values, nComp, i);
+      }
+    return;
+    }
+
+  decimated->Allocate(numberOfPoints * 3);
+  // The first and last points are kept, the others are split into
+  // numberOfPoints - 2 buckets.
+  double bucketSize = static_cast<double>(n - 2) / (numberOfPoints - 2);
+  vtkIdType selected = 0;
+  InsertDecimatedValue(decimated, values, nComp, selected);
+  for (int bucket = 0; bucket < numberOfPoints - 2; ++bucket)
+    {
+    // Average of the next bucket, the last point for the last bucket
+    vtkIdType nextBegin = static_cast<vtkIdType>((bucket + 1) * bucketSize) + 1;
+    vtkIdType nextEnd = std::min(
+      static_cast<vtkIdType>((bucket + 2) * bucketSize) + 1, n);
+    double averageX = 0.;
+    double averageY = 0.;
+    for (vtkIdType i = nextBegin; i < nextEnd; ++i)
+      {
+      averageX += values[i * nComp];
+      averageY += values[i * nComp + 1];
+      }
+    averageX /= nextEnd - nextBegin;
+    averageY /= nextEnd - nextBegin;
+
+    // Point of the bucket that forms the largest triangle with the previously
+    // selected point and the average of the next bucket
+    vtkIdType begin = static_cast<vtkIdType>(bucket * bucketSize) + 1;
+    vtkIdType end = nextBegin;
+    double selectedX = values[selected * nComp];
+    double selectedY = values[selected * nComp + 1];
+    double maxArea = -1.;
+    vtkIdType maxAreaIndex = begin;
+    for (vtkIdType i = begin; i < end; ++i)
+      {
+      double area = fabs((selectedX - averageX) * (values[i * nComp + 1] - selectedY) -
+                         (selectedX - values[i * nComp]) * (averageY - selectedY));
+      if (area > maxArea)
+        {
+        maxArea = area;
+        maxAreaIndex = i;
+        }
+      }
+    selected = maxAreaIndex;
+    InsertDecimatedValue(decimated, values, nComp, selected);
+    }
+  InsertDecimatedValue(decimated, values, nComp, n - 1);
+}
+
+//----------------------------------------------------------------------------
 void vtkMRMLDoubleArrayNode::SetLabels(const LabelsVectorType &labels)
 {
    this->Labels = labels;
@@ -144,6 +144,43 @@ public:
   /// if fIncludeError=1 is specified, the range takes account of errors.
   void GetYRange(double* range, int fIncludeError=1);
 
+  ///
+  /// Replace all the values at once by the tuples of the 1 component arrays
+  /// 'x', 'y' and 'yerr', that must have the same number of tuples.
+  /// If 'yerr' is NULL, the errors are set to 0.
+  /// Modified is invoked once.
+  void SetXYValues(vtkDoubleArray* x, vtkDoubleArray* y, vtkDoubleArray* yerr = 0);
+
+  ///
+  /// Replace all the values at once by the 'n' first values of 'x',
+  /// 'y' and 'yerr'. If 'yerr' is NULL, the errors are set to 0.
+  void SetXYValues(vtkIdType n, const double* x, const double* y, const double* yerr = 0);
+
+  ///
+  /// Copy all the X, Y and, if 'yerr' is not NULL, error values into the
+  /// 1 component arrays 'x', 'y' and 'yerr', that are resized.
+  void GetXYValues(vtkDoubleArray* x, vtkDoubleArray* y, vtkDoubleArray* yerr = 0);
+
+  ///
+  /// Copy all the values into buffers of GetSize() values.
+  void GetXYValues(double* x, double* y, double* yerr = 0);
+
+  ///
+  /// Decimate the values for display: the data points are split into
+  /// 'numberOfBins' runs of consecutive points and the points of minimum and
+  /// maximum Y of each run are kept, in their original order. The (x, y, yerr)
+  /// tuples are stored in 'decimated'. All the points are kept if there are
+  /// less than 2 * numberOfBins.
+  void GetMinMaxDecimatedValues(int numberOfBins, vtkDoubleArray* decimated);
+
+  ///
+  /// Decimate the values to 'numberOfPoints' points with the Largest Triangle
+  /// Three Buckets algorithm, that keeps the visual shape of the curve.
+  /// The first and last points are always kept. The (x, y, yerr) tuples are
+  /// stored in 'decimated'. All the points are kept if there are less than
+  /// numberOfPoints or if numberOfPoints is lower than 3.
+  void GetLTTBDecimatedValues(int numberOfPoints, vtkDoubleArray* decimated);
+
   // Description:
   //Set labels
   //void SetLabel(std::vector< std::string > labels);
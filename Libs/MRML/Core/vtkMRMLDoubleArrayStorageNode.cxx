@@ -18,9 +18,18 @@ Version:   $Revision: 1.6 $
 #include "vtkMRMLScene.h"
 
 // VTK includes
+#include <vtkByteSwap.h>
+#include <vtkDoubleArray.h>
+#include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkStringArray.h>
 
+// VTKsys includes
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <sstream>
+
 //------------------------------------------------------------------------------
 vtkMRMLNodeNewMacro(vtkMRMLDoubleArrayStorageNode);
 
@@ -68,6 +77,11 @@ int vtkMRMLDoubleArrayStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     return 0;
     }
 
+  if (this->IsBinaryFileName(fullName))
+    {
+    return this->ReadBinaryData(fullName, doubleArrayNode);
+    }
+
   // open the file for reading input
   fstream fstr;
   fstr.open(fullName.c_str(), fstream::in);
@@ -87,8 +101,10 @@ int vtkMRMLDoubleArrayStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
 
   int numColumns = 3;
   std::vector<std::string> labels;
-  // save the valid lines in a vector, parse them once know the max id
-  std::vector<std::string>lines;
+  // the values are added to the node at once
+  std::vector<double> xValues;
+  std::vector<double> yValues;
+  std::vector<double> yerrValues;
   bool firstLine = true;
 
   while (fstr.good())
@@ -176,18 +192,15 @@ int vtkMRMLDoubleArrayStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
             }
           columnNumber++;
           } // end while over columns
-        int   fidIndex;
         if (firstLine)
           {
           doubleArrayNode->vtkMRMLDoubleArrayNode::SetLabels(labels);
           }
         else
           {
-          fidIndex = doubleArrayNode->vtkMRMLDoubleArrayNode::AddXYValue(x, y, yerr);
-          if (fidIndex == 0)
-            {
-            vtkErrorMacro("Error adding a measurement to the list");
-            }
+          xValues.push_back(x);
+          yValues.push_back(y);
+          yerrValues.push_back(yerr);
           }
         firstLine = false;
 
@@ -196,10 +209,97 @@ int vtkMRMLDoubleArrayStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     }
   fstr.close();
 
+  // The values are appended to the ones already in the node
+  if (!xValues.empty())
+    {
+    vtkIdType previousSize = doubleArrayNode->GetSize();
+    vtkIdType size = previousSize + static_cast<vtkIdType>(xValues.size());
+    xValues.insert(xValues.begin(), previousSize, 0.);
+    yValues.insert(yValues.begin(), previousSize, 0.);
+    yerrValues.insert(yerrValues.begin(), previousSize, 0.);
+    if (previousSize > 0)
+      {
+      doubleArrayNode->GetXYValues(&xValues[0], &yValues[0], &yerrValues[0]);
+      }
+    doubleArrayNode->SetXYValues(size, &xValues[0], &yValues[0], &yerrValues[0]);
+    }
+
   // If it's the first line, that means there was no point in the file.
   return firstLine ? 0 : 1;
 }
 
+//----------------------------------------------------------------------------
+bool vtkMRMLDoubleArrayStorageNode::IsBinaryFileName(const std::string& fileName)
+{
+  return vtksys::SystemTools::LowerCase(
+    vtksys::SystemTools::GetFilenameLastExtension(fileName)) == ".mbin";
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLDoubleArrayStorageNode::ReadBinaryData(const std::string& fullName,
+                                                  vtkMRMLDoubleArrayNode* doubleArrayNode)
+{
+  fstream fstr;
+  fstr.open(fullName.c_str(), fstream::in | fstream::binary);
+  if (!fstr.is_open() || !fstr.good())
+    {
+    vtkErrorMacro("ERROR opening measurement file \"" << this->FileName << "\"");
+    return 0;
+    }
+
+  // The header lines end with the number of tuples
+  std::vector<std::string> labels;
+  vtkIdType numberOfTuples = -1;
+  std::string line;
+  while (numberOfTuples < 0 && std::getline(fstr, line))
+    {
+    if (line.compare(0, 11, "# labels = ") == 0)
+      {
+      std::stringstream ss(line.substr(11));
+      std::string label;
+      while (std::getline(ss, label, ','))
+        {
+        labels.push_back(label);
+        }
+      }
+    else if (line.compare(0, 11, "# tuples = ") == 0)
+      {
+      numberOfTuples = atol(line.c_str() + 11);
+      }
+    else if (line.empty() || line[0] != '#')
+      {
+      break;
+      }
+    }
+  if (numberOfTuples < 0)
+    {
+    vtkErrorMacro("ReadData: no number of tuples in measurement file \""
+                  << this->FileName << "\"");
+    return 0;
+    }
+
+  vtkNew<vtkDoubleArray> values;
+  values->SetNumberOfComponents(3);
+  values->SetNumberOfTuples(numberOfTuples);
+  if (numberOfTuples > 0)
+    {
+    fstr.read(reinterpret_cast<char*>(values->GetPointer(0)),
+              numberOfTuples * 3 * sizeof(double));
+    if (!fstr)
+      {
+      vtkErrorMacro("ReadData: measurement file \"" << this->FileName
+                    << "\" is truncated");
+      return 0;
+      }
+    vtkByteSwap::SwapLERange(values->GetPointer(0), numberOfTuples * 3);
+    }
+  fstr.close();
+
+  doubleArrayNode->SetLabels(labels);
+  doubleArrayNode->SetArray(values.GetPointer());
+  return 1;
+}
+
 //----------------------------------------------------------------------------
 int vtkMRMLDoubleArrayStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
 {
@@ -226,6 +326,11 @@ int vtkMRMLDoubleArrayStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
       return 0;
       }
 
+    if (this->IsBinaryFileName(fullName))
+      {
+      return this->WriteBinaryData(fullName, doubleArrayNode);
+      }
+
     // open the file for writing
     fstream of;
 
@@ -276,11 +381,69 @@ int vtkMRMLDoubleArrayStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
   return 1;
 }
 
+//----------------------------------------------------------------------------
+int vtkMRMLDoubleArrayStorageNode::WriteBinaryData(const std::string& fullName,
+                                                   vtkMRMLDoubleArrayNode* doubleArrayNode)
+{
+  fstream of;
+  of.open(fullName.c_str(), fstream::out | fstream::binary);
+  if (!of.is_open())
+    {
+    vtkErrorMacro("WriteData: unable to open file " << fullName.c_str() << " for writing");
+    return 0;
+    }
+
+  // The header is text, the values follow as little endian doubles
+  of << "# measurement binary file " << this->GetFileName() << "\n";
+  of << "# columns = x,y,yerr" << "\n";
+  const std::vector< std::string >& labels = doubleArrayNode->GetLabels();
+  if (labels.size())
+    {
+    of << "# labels = ";
+    for (unsigned int l = 0; l < labels.size(); l++)
+      {
+      of << (l ? "," : "") << labels[l];
+      }
+    of << "\n";
+    }
+  vtkIdType numberOfTuples = doubleArrayNode->GetSize();
+  of << "# tuples = " << numberOfTuples << "\n";
+
+  if (numberOfTuples > 0)
+    {
+    vtkDoubleArray* array = doubleArrayNode->GetArray();
+    const double* values = array->GetPointer(0);
+    std::vector<double> interleavedValues;
+    if (array->GetNumberOfComponents() != 3)
+      {
+      std::vector<double> x(numberOfTuples), y(numberOfTuples), yerr(numberOfTuples);
+      doubleArrayNode->GetXYValues(&x[0], &y[0], &yerr[0]);
+      interleavedValues.resize(numberOfTuples * 3);
+      for (vtkIdType i = 0; i < numberOfTuples; ++i)
+        {
+        interleavedValues[i * 3] = x[i];
+        interleavedValues[i * 3 + 1] = y[i];
+        interleavedValues[i * 3 + 2] = yerr[i];
+        }
+      values = &interleavedValues[0];
+      }
+    vtkByteSwap::SwapWriteLERange(values, numberOfTuples * 3, &of);
+    }
+  of.close();
+  if (of.fail())
+    {
+    vtkErrorMacro("WriteData: unable to write file " << fullName.c_str());
+    return 0;
+    }
+  return 1;
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLDoubleArrayStorageNode::InitializeSupportedReadFileTypes()
 {
   this->SupportedReadFileTypes->InsertNextValue("Measurement CSV (.mcsv)");
   this->SupportedReadFileTypes->InsertNextValue("Text (.txt)");
+  this->SupportedReadFileTypes->InsertNextValue("Measurement binary (.mbin)");
 }
 
 //----------------------------------------------------------------------------
@@ -288,6 +451,7 @@ void vtkMRMLDoubleArrayStorageNode::InitializeSupportedWriteFileTypes()
 {
   this->SupportedWriteFileTypes->InsertNextValue("Measurement CSV (.mcsv)");
   this->SupportedWriteFileTypes->InsertNextValue("Text (.txt)");
+  this->SupportedWriteFileTypes->InsertNextValue("Measurement binary (.mbin)");
 }
 
 //----------------------------------------------------------------------------
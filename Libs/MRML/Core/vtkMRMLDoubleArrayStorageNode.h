@@ -16,11 +16,14 @@
 #define __vtkMRMLDoubleArrayStorageNode_h
 
 #include "vtkMRMLStorageNode.h"
+class vtkMRMLDoubleArrayNode;
 
 /// \brief MRML node for representing a volume storage
 ///
 /// vtkMRMLDoubleArrayStorageNode nodes describe the fiducial storage
 /// node that allows to read/write point data from/to file.
+/// Files with the .mbin extension store the values as binary little endian
+/// doubles after a text header, the other files are comma separated text.
 class VTK_MRML_EXPORT vtkMRMLDoubleArrayStorageNode : public vtkMRMLStorageNode
 {
 public:
@@ -59,6 +62,13 @@ protected:
   /// Write data from a  referenced node
   virtual int WriteDataInternal(vtkMRMLNode *refNode);
 
+  /// Return true if the file is stored in the binary format
+  static bool IsBinaryFileName(const std::string& fileName);
+
+  /// Read and write the binary format
+  int ReadBinaryData(const std::string& fullName, vtkMRMLDoubleArrayNode* doubleArrayNode);
+  int WriteBinaryData(const std::string& fullName, vtkMRMLDoubleArrayNode* doubleArrayNode);
+
 };
 
 #endif
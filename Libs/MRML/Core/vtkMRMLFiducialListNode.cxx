@@ -21,13 +21,16 @@ Version:   $Revision: 1.3 $
 
 // VTK includes
 #include <vtkAbstractTransform.h>
-#include <vtkCollection.h>
+#include <vtkDataArray.h>
 #include <vtkMath.h>
 #include <vtkMatrix4x4.h>
 #include <vtkObjectFactory.h>
+#include <vtkPoints.h>
 #include <vtkSmartPointer.h>
+#include <vtkStringArray.h>
 
 // STD includes
+#include <algorithm>
 #include <sstream>
 
 //------------------------------------------------------------------------------
@@ -36,7 +39,6 @@ vtkMRMLNodeNewMacro(vtkMRMLFiducialListNode);
 //----------------------------------------------------------------------------
 vtkMRMLFiducialListNode::vtkMRMLFiducialListNode()
 {
-  this->FiducialList = vtkCollection::New();
   this->SymbolScale = 5.0;
   this->TextScale = 4.5;
   this->Visibility = 1;
@@ -64,12 +66,6 @@ vtkMRMLFiducialListNode::vtkMRMLFiducialListNode()
 //----------------------------------------------------------------------------
 vtkMRMLFiducialListNode::~vtkMRMLFiducialListNode()
 {
-  if (this->FiducialList)
-    {    
-    this->FiducialList->RemoveAllItems();        
-    this->FiducialList->Delete();
-    this->FiducialList = NULL;
-    }
   if (this->Name)
     {
     delete [] this->Name;
@@ -117,14 +113,21 @@ void vtkMRMLFiducialListNode::WriteXML(ostream& of, int nIndent)
  
   if (this->GetNumberOfFiducials() > 0)
     {
+    // same format as vtkMRMLFiducial::WriteXML, the parsing of the string
+    // is dependent on the order here
     of << " fiducials=\"";
     for (int idx = 0; idx < this->GetNumberOfFiducials(); idx++)
       {
-      if (this->GetNthFiducial(idx) != NULL)
-        {
-        of << "\n";
-        this->GetNthFiducial(idx)->WriteXML(of, nIndent);
-        }
+      const float *xyz = &this->FiducialXYZ[3 * idx];
+      const float *wxyz = &this->FiducialOrientationWXYZ[4 * idx];
+      of << "\n";
+      of << "id " << this->FiducialIDs[idx];
+      of << " labeltext " << this->FiducialLabelTexts[idx];
+      of << " xyz " << xyz[0] << " " << xyz[1] << " " << xyz[2];
+      of << " orientationwxyz " << wxyz[0] << " " << wxyz[1] << " " <<
+                                   wxyz[2] << " " << wxyz[3];
+      of << " selected " << this->FiducialSelected[idx];
+      of << " visibility " << this->FiducialVisibility[idx];
       }
     of << "\"";
     }
@@ -292,23 +295,25 @@ void vtkMRMLFiducialListNode::ReadXMLAttributes(const char** atts)
           // now parse the string into tokens by the newline
           labelTextPtr = strtok(fiducials, "\n");
           vtkDebugMacro( "\nGetting tokens from the list, to make new points.\n");
+          // the points keep their ids, they are appended to the arrays
+          // without generating new ones
+          vtkSmartPointer<vtkMRMLFiducial> newPoint = vtkSmartPointer<vtkMRMLFiducial>::New();
           while (labelTextPtr != NULL)
           {
               vtkDebugMacro( "got a token, adding a fiducial for: " << labelTextPtr << endl);
-              // now make a new point
-              int pointIndex = this->AddFiducial();
+              newPoint->SetID("");
+              newPoint->SetLabelText("");
+              newPoint->SetXYZ(0.0, 0.0, 0.0);
+              newPoint->SetOrientationWXYZ(0.0, 0.0, 0.0, 1.0);
+              newPoint->SetSelected(false);
+              newPoint->SetVisibility(true);
+              newPoint->ReadXMLString(labelTextPtr);
+              float *xyz = newPoint->GetXYZ();
+              int pointIndex = this->AppendFiducial(newPoint->GetID(), newPoint->GetLabelText(),
+                xyz[0], xyz[1], xyz[2], newPoint->GetSelected(), newPoint->GetVisibility());
+              std::copy(newPoint->GetOrientationWXYZ(), newPoint->GetOrientationWXYZ() + 4,
+                        this->FiducialOrientationWXYZ.begin() + 4 * pointIndex);
               vtkDebugMacro( "new point index = " << pointIndex << endl);
-              vtkMRMLFiducial *newPoint = this->GetNthFiducial(pointIndex);
-
-              if (newPoint != NULL)
-              {
-                  // now pass it the stuff to parse out and set itself from
-                  vtkDebugMacro( "ReadXMLAttributes: passing the text pointer for point index " << pointIndex <<  " to the new point: " << labelTextPtr << endl);
-                  newPoint->ReadXMLString(labelTextPtr);
-              } else {
-                  vtkErrorMacro ("ERROR making a new MRML fiducial!\n");
-              }
-              newPoint = NULL;
               labelTextPtr = strtok(NULL, "\n");
           }          
       }
@@ -349,48 +354,22 @@ void vtkMRMLFiducialListNode::Copy(vtkMRMLNode *anode)
   // Copy all fiducials
 
   // Try to see if nothing changed
-  bool modified = true;
-
-  int numPoints = node->GetNumberOfFiducials();
-  if (numPoints == this->GetNumberOfFiducials())
-    {
-    
-    for (int f=0; f < numPoints ; f++)
-      {
-      vtkMRMLFiducial *fid = vtkMRMLFiducial::SafeDownCast(node->FiducialList->vtkCollection::GetItemAsObject(f));
-      vtkMRMLFiducial *fidThis = vtkMRMLFiducial::SafeDownCast(this->FiducialList->vtkCollection::GetItemAsObject(f));
-      unsigned long mtime = fidThis->GetMTime();
-      fidThis->Copy(fid);
-      // Copy doesn't copy the ID, so check to see if the fiducial node in the
-      // list to copy has a different id
-      if (fidThis->GetMTime() > mtime || 
-          (fid->GetID() && fidThis->GetID() && strcmp(fid->GetID(), fidThis->GetID())) )
-        {
-        modified = true;
-        break;
-        }
-
-      modified = false;
-      }
-    }
+  bool modified = (this->FiducialXYZ != node->FiducialXYZ ||
+                   this->FiducialOrientationWXYZ != node->FiducialOrientationWXYZ ||
+                   this->FiducialSelected != node->FiducialSelected ||
+                   this->FiducialVisibility != node->FiducialVisibility ||
+                   this->FiducialLabelTexts != node->FiducialLabelTexts ||
+                   this->FiducialIDs != node->FiducialIDs);
   if (modified)
     {
     this->RemoveAllFiducials();
-    for (int f=0; f < numPoints ; f++)
-      {
-      // as remove them from the end of the list, the size of the list
-      // will shrink as the iterator f reduces
-      vtkMRMLFiducial *fid = vtkMRMLFiducial::SafeDownCast(node->FiducialList->vtkCollection::GetItemAsObject(f));
-      // can't just use AddFiducial, as it sets and increments a unique id
-//      vtkMRMLFiducial *fidThis = vtkMRMLFiducial::New();
-      vtkSmartPointer<vtkMRMLFiducial> fidThis = vtkSmartPointer<vtkMRMLFiducial>::New();
-      fidThis->Copy(fid);
-      // manual copy of id
-      fidThis->SetID(fid->GetID());
-      this->FiducialList->vtkCollection::AddItem(fidThis);
-//      fidThis->Delete();
-//     fidThis = NULL;
-      }
+    // can't just use AddFiducial, as it sets and increments a unique id
+    this->FiducialXYZ = node->FiducialXYZ;
+    this->FiducialOrientationWXYZ = node->FiducialOrientationWXYZ;
+    this->FiducialSelected = node->FiducialSelected;
+    this->FiducialVisibility = node->FiducialVisibility;
+    this->FiducialLabelTexts = node->FiducialLabelTexts;
+    this->FiducialIDs = node->FiducialIDs;
     // turn on modified events
     this->Modified();
     vtkDebugMacro("Copy: throwing a fid modified event w/NULL id");
@@ -639,10 +618,16 @@ void vtkMRMLFiducialListNode::PrintSelf(ostream& os, vtkIndent indent)
       for (idx = 0; idx < this->GetNumberOfFiducials(); idx++)
       {
           os << indent << " Point " << idx << ":\n";
-          if (this->GetNthFiducial(idx) != NULL)
-          {
-              this->GetNthFiducial(idx)->PrintSelf(os,indent.GetNextIndent());
-          }
+          vtkIndent pointIndent = indent.GetNextIndent();
+          const float *xyz = &this->FiducialXYZ[3 * idx];
+          const float *wxyz = &this->FiducialOrientationWXYZ[4 * idx];
+          os << pointIndent << "ID: " << this->FiducialIDs[idx] << "\n";
+          os << pointIndent << "LabelText: " << this->FiducialLabelTexts[idx] << "\n";
+          os << pointIndent << "XYZ: (" << xyz[0] << ", " << xyz[1] << ", " << xyz[2] << ") \n";
+          os << pointIndent << "OrientationWXYZ: (" << wxyz[0] << ", " << wxyz[1] << ", "
+             << wxyz[2] << ", " << wxyz[3] << ")" << "\n";
+          os << pointIndent << "Selected: " << this->FiducialSelected[idx] << "\n";
+          os << pointIndent << "Visibility: " << this->FiducialVisibility[idx] << "\n";
       }
   }
   else
@@ -676,60 +661,99 @@ void vtkMRMLFiducialListNode::UpdateScene(vtkMRMLScene *scene)
 //----------------------------------------------------------------------------
 int vtkMRMLFiducialListNode::GetNumberOfFiducials()
 {
-    return this->FiducialList->vtkCollection::GetNumberOfItems();
+  return static_cast<int>(this->FiducialIDs.size());
 }
 
 //-----------------------------------------------------------
-vtkMRMLFiducial* vtkMRMLFiducialListNode::GetNthFiducial(int n)
+bool vtkMRMLFiducialListNode::IsFiducialIndexValid(int n)
 {
-    vtkDebugMacro("GetNthFiducial: getting item by index number: " << n);
-    if (this->FiducialList == NULL)
-    {
-        vtkErrorMacro ("GetNthFiducial: ERROR: fiducial list is null\n");
-        return NULL;
-    }
-  if(n < 0 || n >= this->FiducialList->GetNumberOfItems()) 
+  if (n < 0 || n >= this->GetNumberOfFiducials())
     {
-        vtkErrorMacro ("vtkMRMLFiducialListNode::GetNthFiducial: index out of bounds, " << n << " is less than zero or more than the number of items: " << this->FiducialList->GetNumberOfItems() << endl);
-        return NULL;
+    vtkErrorMacro("Unable to get fiducial number " << n << ", index out of bounds, the number of fiducials is " << this->GetNumberOfFiducials());
+    return false;
     }
-  else 
+  return true;
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLFiducialListNode::AppendFiducial(const std::string& id, const std::string& labelText,
+                                            float x, float y, float z, bool selected, bool visibility)
+{
+  this->FiducialXYZ.push_back(x);
+  this->FiducialXYZ.push_back(y);
+  this->FiducialXYZ.push_back(z);
+  this->FiducialOrientationWXYZ.push_back(0.0);
+  this->FiducialOrientationWXYZ.push_back(0.0);
+  this->FiducialOrientationWXYZ.push_back(0.0);
+  this->FiducialOrientationWXYZ.push_back(1.0);
+  this->FiducialSelected.push_back(selected);
+  this->FiducialVisibility.push_back(visibility);
+  this->FiducialLabelTexts.push_back(labelText);
+  this->FiducialIDs.push_back(id);
+  return this->GetNumberOfFiducials() - 1;
+}
+
+//----------------------------------------------------------------------------
+std::string vtkMRMLFiducialListNode::GenerateFiducialID(const std::string& baseName)
+{
+  std::string nameString = baseName;
+  if (nameString.empty())
     {
-    return (vtkMRMLFiducial*)this->FiducialList->GetItemAsObject(n);
+    // give the point a unique name based on the list name
+    std::stringstream ss;
+    ss << this->GetName();
+    ss << "-P";
+    ss >> nameString;
     }
+  return this->GetScene()->GenerateUniqueName(nameString);
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLFiducialListNode::SwapFiducials(int i, int j)
+{
+  std::swap_ranges(this->FiducialXYZ.begin() + 3 * i,
+                   this->FiducialXYZ.begin() + 3 * i + 3,
+                   this->FiducialXYZ.begin() + 3 * j);
+  std::swap_ranges(this->FiducialOrientationWXYZ.begin() + 4 * i,
+                   this->FiducialOrientationWXYZ.begin() + 4 * i + 4,
+                   this->FiducialOrientationWXYZ.begin() + 4 * j);
+  bool flag = this->FiducialSelected[i];
+  this->FiducialSelected[i] = this->FiducialSelected[j];
+  this->FiducialSelected[j] = flag;
+  flag = this->FiducialVisibility[i];
+  this->FiducialVisibility[i] = this->FiducialVisibility[j];
+  this->FiducialVisibility[j] = flag;
+  this->FiducialLabelTexts[i].swap(this->FiducialLabelTexts[j]);
+  this->FiducialIDs[i].swap(this->FiducialIDs[j]);
+}
 
 //----------------------------------------------------------------------------
 int vtkMRMLFiducialListNode::SetNthFiducialXYZ(int n, float x, float y, float z)
 {
-  vtkMRMLFiducial *node = this->GetNthFiducial(n);
-  if (node == NULL)
+  if (!this->IsFiducialIndexValid(n))
     {
-    vtkErrorMacro("Unable to get fiducial number " << n);
     return 1;
     }
 
-  float *oldXYZ = node->GetXYZ();
+  float *oldXYZ = &this->FiducialXYZ[3 * n];
   // only set and call modified if it's different
-  if (oldXYZ == NULL ||
-      (oldXYZ != NULL &&
-       ((fabs(oldXYZ[0] - x) > 0.001) ||
-        (fabs(oldXYZ[1] - y) > 0.001) ||
-        (fabs(oldXYZ[2] - z) > 0.001))))
+  if ((fabs(oldXYZ[0] - x) > 0.001) ||
+      (fabs(oldXYZ[1] - y) > 0.001) ||
+      (fabs(oldXYZ[2] - z) > 0.001))
     {
-    node->SetXYZ(x,y,z);
+    oldXYZ[0] = x;
+    oldXYZ[1] = y;
+    oldXYZ[2] = z;
     
     // the list contents have been modified
     if (!this->GetDisableModifiedEvent())
       {
-      std::string pointIDStr = node->GetID();
+      std::string pointIDStr = this->FiducialIDs[n];
       this->InvokeEvent(vtkMRMLFiducialListNode::FiducialModifiedEvent, (void*)&pointIDStr);
       }
     this->StorableModifiedTime.Modified();
     this->Modified();
     }
-    node = NULL;
     return 0;
 }
 
@@ -763,17 +787,11 @@ int vtkMRMLFiducialListNode::SetNthFiducialXYZWorld(int n, float x, float y, flo
 //----------------------------------------------------------------------------
 float * vtkMRMLFiducialListNode::GetNthFiducialXYZ(int n)
 {
-    vtkMRMLFiducial *node = this->GetNthFiducial(n);
-    if (node != NULL)
-      {
-      float * xyz = node->GetXYZ();
-      node = NULL;
-      return xyz;
-      }
-    else
-      {
-      return NULL;
-      }
+  if (!this->IsFiducialIndexValid(n))
+    {
+    return NULL;
+    }
+  return &this->FiducialXYZ[3 * n];
 }
 
 //----------------------------------------------------------------------------
@@ -812,20 +830,21 @@ int vtkMRMLFiducialListNode::GetNthFiducialXYZWorld(int n, double *worldxyz)
 //----------------------------------------------------------------------------
 int vtkMRMLFiducialListNode::SetNthFiducialOrientation(int n, float w, float x, float y, float z)
 {
-    vtkMRMLFiducial *node = this->GetNthFiducial(n);
-    if (node == NULL)
+  if (!this->IsFiducialIndexValid(n))
     {
-        vtkErrorMacro("Unable to get fiducial number " << n);
-        return 1;
+    return 1;
+    }
+  float *wxyz = &this->FiducialOrientationWXYZ[4 * n];
+  wxyz[0] = w;
+  wxyz[1] = x;
+  wxyz[2] = y;
+  wxyz[3] = z;
+  if (!this->GetDisableModifiedEvent())
+    {
+    // the list contents have been modified
+    std::string pointIDStr = this->FiducialIDs[n];
+    this->InvokeEvent(vtkMRMLFiducialListNode::FiducialModifiedEvent, (void*)&pointIDStr);
     }
-    node->SetOrientationWXYZ(w, x, y, z);
-    if (!this->GetDisableModifiedEvent())
-      {
-      // the list contents have been modified
-      std::string pointIDStr = node->GetID();
-      this->InvokeEvent(vtkMRMLFiducialListNode::FiducialModifiedEvent, (void*)&pointIDStr);
-      }
-  node = NULL;
   this->StorableModifiedTime.Modified();
   this->Modified();
   return 0;
@@ -834,36 +853,27 @@ int vtkMRMLFiducialListNode::SetNthFiducialOrientation(int n, float w, float x,
 //----------------------------------------------------------------------------
 float * vtkMRMLFiducialListNode::GetNthFiducialOrientation(int n)    
 {
-    vtkMRMLFiducial *node = this->GetNthFiducial(n);
-    if (node != NULL)
-      {
-      float *wxyz = node->GetOrientationWXYZ();
-      node = NULL;
-      return wxyz;
-      }
-    else
-      {
-      return NULL;
-      }
+  if (!this->IsFiducialIndexValid(n))
+    {
+    return NULL;
+    }
+  return &this->FiducialOrientationWXYZ[4 * n];
 }
 
 //----------------------------------------------------------------------------
 int vtkMRMLFiducialListNode::SetNthFiducialLabelText(int n, const char *text)
 {
-    vtkMRMLFiducial *node = this->GetNthFiducial(n);
-    if (node == NULL)
+  if (!this->IsFiducialIndexValid(n))
     {
-        vtkErrorMacro("Unable to get fiducial number " << n);
-        return 1;
+    return 1;
+    }
+  this->FiducialLabelTexts[n] = (text ? text : "");
+  if (!this->GetDisableModifiedEvent())
+    {
+    // the list contents have been modified
+    std::string pointIDStr = this->FiducialIDs[n];
+    this->InvokeEvent(vtkMRMLFiducialListNode::FiducialModifiedEvent, (void*)&pointIDStr);
     }
-    node->SetLabelText(text);
-    if (!this->GetDisableModifiedEvent())
-      {
-      // the list contents have been modified
-      std::string pointIDStr = node->GetID();
-      this->InvokeEvent(vtkMRMLFiducialListNode::FiducialModifiedEvent, (void*)&pointIDStr);
-      }
-  node = NULL;
   this->StorableModifiedTime.Modified();
   this->Modified();
   return 0;
@@ -872,36 +882,26 @@ int vtkMRMLFiducialListNode::SetNthFiducialLabelText(int n, const char *text)
 //----------------------------------------------------------------------------
 const char *vtkMRMLFiducialListNode::GetNthFiducialLabelText(int n)
 {
-    vtkMRMLFiducial *node = this->GetNthFiducial(n);
-    if (node != NULL)
-      {
-      const char *txt = node->GetLabelText();
-      node = NULL;
-      return txt;
-      }
-    else
-      {
-      return "(none)";
-      }
+  if (!this->IsFiducialIndexValid(n))
+    {
+    return "(none)";
+    }
+  return this->FiducialLabelTexts[n].c_str();
 }
 
 //----------------------------------------------------------------------------
 int vtkMRMLFiducialListNode::SetNthFiducialSelected(int n, int flag)
 {
-    vtkMRMLFiducial *node = this->GetNthFiducial(n);
-    if (node == NULL)
+  if (this->SetNthFiducialSelectedNoModified(n, flag))
     {
-        vtkErrorMacro("Unable to get fiducial number " << n);
-        return 1;
+    return 1;
+    }
+  if (!this->GetDisableModifiedEvent())
+    {
+    // the list contents have been modified
+    std::string pointIDStr = this->FiducialIDs[n];
+    this->InvokeEvent(vtkMRMLFiducialListNode::FiducialModifiedEvent, (void*)&pointIDStr);
     }
-    node->SetSelected((flag == 0 ? false : true));
-    if (!this->GetDisableModifiedEvent())
-      {
-      // the list contents have been modified
-      std::string pointIDStr = node->GetID();
-      this->InvokeEvent(vtkMRMLFiducialListNode::FiducialModifiedEvent, (void*)&pointIDStr);
-      }
-  node = NULL;
   this->StorableModifiedTime.Modified();
   this->Modified();
   return 0;
@@ -910,165 +910,252 @@ int vtkMRMLFiducialListNode::SetNthFiducialSelected(int n, int flag)
 //----------------------------------------------------------------------------
 int vtkMRMLFiducialListNode::SetNthFiducialSelectedNoModified(int n, int flag)
 {
-    vtkMRMLFiducial *node = this->GetNthFiducial(n);
-    if (node == NULL)
+  if (!this->IsFiducialIndexValid(n))
     {
-        vtkErrorMacro("Unable to get fiducial number " << n);
-        return 1;
+    return 1;
     }
-    node->SetSelected((flag == 0 ? false : true));
-    node = NULL;
-    return 0;
+  this->FiducialSelected[n] = (flag != 0);
+  return 0;
 }
 
 //----------------------------------------------------------------------------
 int vtkMRMLFiducialListNode::GetNthFiducialSelected(int n)
 {
-    vtkMRMLFiducial *node = this->GetNthFiducial(n);
-    if (node != NULL)
-      {
-      int selected = node->GetSelected();
-      node = NULL;
-      return (selected ? 1 : 0);
-      }
-    else
-      {
-      return 0;
-      }
+  if (!this->IsFiducialIndexValid(n))
+    {
+    return 0;
+    }
+  return (this->FiducialSelected[n] ? 1 : 0);
 }
 
 //----------------------------------------------------------------------------
 int vtkMRMLFiducialListNode::SetAllFiducialsSelected(int flag)
 {
-
-  int numPoints = this->GetNumberOfFiducials();
-  int retVal = 0;
-  for (int f = 0; f < numPoints; f++)
+  this->FiducialSelected.assign(this->FiducialSelected.size(), flag != 0);
+  if (!this->GetDisableModifiedEvent())
     {
-    retVal += this->SetNthFiducialSelectedNoModified(f, flag);
+    // now call modified
+    vtkDebugMacro("SetAllFidsSelected: throwing a fid modified event w/null");
+    this->InvokeEvent(vtkMRMLFiducialListNode::FiducialModifiedEvent, NULL);
     }
-   if (!this->GetDisableModifiedEvent())
-     {
-     // now call modified
-     vtkDebugMacro("SetAllFidsSelected: throwing a fid modified event w/null");
-     this->InvokeEvent(vtkMRMLFiducialListNode::FiducialModifiedEvent, NULL);
-     }
   this->StorableModifiedTime.Modified();
   this->Modified();
-  return (retVal == 0 ? 0 : 1);
+  return 0;
 }
 
 //----------------------------------------------------------------------------
 int vtkMRMLFiducialListNode::SetNthFiducialVisibility(int n, int flag)
 {
-    vtkMRMLFiducial *node = this->GetNthFiducial(n);
-    if (node == NULL)
-      {
-      vtkErrorMacro("Unable to get fiducial number " << n);
-      return 1;
-      }
-    node->SetVisibility((flag == 0 ? false : true));
-    if (!this->GetDisableModifiedEvent())
-      {
-      // the list contents have been modified
-      std::string pointIDStr = node->GetID();
-      this->InvokeEvent(vtkMRMLFiducialListNode::FiducialModifiedEvent, (void*)&pointIDStr);
-      }
+  if (this->SetNthFiducialVisibilityNoModified(n, flag))
+    {
+    return 1;
+    }
+  if (!this->GetDisableModifiedEvent())
+    {
+    // the list contents have been modified
+    std::string pointIDStr = this->FiducialIDs[n];
+    this->InvokeEvent(vtkMRMLFiducialListNode::FiducialModifiedEvent, (void*)&pointIDStr);
+    }
   this->StorableModifiedTime.Modified();
   this->Modified();
-  node = NULL;
   return 0;
 }
 
 //----------------------------------------------------------------------------
 int vtkMRMLFiducialListNode::SetNthFiducialVisibilityNoModified(int n, int flag)
 {
-    vtkMRMLFiducial *node = this->GetNthFiducial(n);
-    if (node == NULL)
+  if (!this->IsFiducialIndexValid(n))
     {
-        vtkErrorMacro("Unable to get fiducial number " << n);
-        return 1;
+    return 1;
     }
-    node->SetVisibility((flag == 0 ? false : true));
-    node = NULL;
-    return 0;
+  this->FiducialVisibility[n] = (flag != 0);
+  return 0;
 }
 
 //----------------------------------------------------------------------------
 int vtkMRMLFiducialListNode::GetNthFiducialVisibility(int n)
 {
-    vtkMRMLFiducial *node = this->GetNthFiducial(n);
-    if (node != NULL)
-      {
-      int visible = node->GetVisibility();
-      node = NULL;
-      return (visible ? 1 : 0);
-      }
-    else
-      {
-      return 0;
-      }
+  if (!this->IsFiducialIndexValid(n))
+    {
+    return 0;
+    }
+  return (this->FiducialVisibility[n] ? 1 : 0);
 }
 
+//----------------------------------------------------------------------------
+int vtkMRMLFiducialListNode::SetAllFiducialsVisibility(int flag)
+{
+  this->FiducialVisibility.assign(this->FiducialVisibility.size(), flag != 0);
+  if (!this->GetDisableModifiedEvent())
+    {
+    // now call modified
+    vtkDebugMacro("SetAllFidsVisib: throwing fid mod event with null");
+    this->InvokeEvent(vtkMRMLFiducialListNode::FiducialModifiedEvent, NULL);
+    }
+  this->StorableModifiedTime.Modified();
+  this->Modified();
+  return 0;
+}
 
+//----------------------------------------------------------------------------
+int vtkMRMLFiducialListNode::SetNthFiducialID(int n, const char *id)
+{
+  if (!this->IsFiducialIndexValid(n))
+    {
+    return 1;
+    }
+  this->FiducialIDs[n] = (id ? id : "");
+  if (!this->GetDisableModifiedEvent())
+    {
+    // the list contents have been modified
+    std::string pointIDStr = this->FiducialIDs[n];
+    this->InvokeEvent(vtkMRMLFiducialListNode::FiducialModifiedEvent, (void*)&pointIDStr);
+    }
+  this->StorableModifiedTime.Modified();
+  return 0;
+}
 
 //----------------------------------------------------------------------------
-int vtkMRMLFiducialListNode::SetAllFiducialsVisibility(int flag)
+const char *vtkMRMLFiducialListNode::GetNthFiducialID(int n)
 {
+  if (!this->IsFiducialIndexValid(n))
+    {
+    return "(none)";
+    }
+  return this->FiducialIDs[n].c_str();
+}
 
+//----------------------------------------------------------------------------
+void vtkMRMLFiducialListNode::GetFiducialsXYZ(vtkPoints *points)
+{
+  if (!points)
+    {
+    return;
+    }
+  int numPoints = this->GetNumberOfFiducials();
+  points->SetNumberOfPoints(numPoints);
+  for (int n = 0; n < numPoints; n++)
+    {
+    const float *xyz = &this->FiducialXYZ[3 * n];
+    points->SetPoint(n, xyz[0], xyz[1], xyz[2]);
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLFiducialListNode::SetFiducialsXYZ(vtkPoints *points)
+{
+  if (!points || points->GetNumberOfPoints() != this->GetNumberOfFiducials())
+    {
+    vtkErrorMacro("SetFiducialsXYZ: expected " << this->GetNumberOfFiducials() << " points");
+    return 1;
+    }
   int numPoints = this->GetNumberOfFiducials();
-  int retVal = 0;
-  for (int f = 0; f < numPoints; f++)
+  double xyz[3];
+  for (int n = 0; n < numPoints; n++)
     {
-    retVal += this->SetNthFiducialVisibilityNoModified(f, flag);
+    points->GetPoint(n, xyz);
+    this->FiducialXYZ[3 * n] = xyz[0];
+    this->FiducialXYZ[3 * n + 1] = xyz[1];
+    this->FiducialXYZ[3 * n + 2] = xyz[2];
     }
   if (!this->GetDisableModifiedEvent())
     {
-    // now call modified
-    vtkDebugMacro("SetAllFidsVisib: throwing fid mod event with null");
     this->InvokeEvent(vtkMRMLFiducialListNode::FiducialModifiedEvent, NULL);
     }
   this->StorableModifiedTime.Modified();
   this->Modified();
-  return (retVal == 0 ? 0 : 1);
+  return 0;
 }
 
 //----------------------------------------------------------------------------
-int vtkMRMLFiducialListNode::SetNthFiducialID(int n, const char *id)
+void vtkMRMLFiducialListNode::GetFiducialsLabelText(vtkStringArray *labels)
 {
-    vtkMRMLFiducial *node = this->GetNthFiducial(n);
-    if (node == NULL)
+  if (!labels)
     {
-        vtkErrorMacro("Unable to get fiducial number " << n);
-        return 1;
+    return;
+    }
+  int numPoints = this->GetNumberOfFiducials();
+  labels->SetNumberOfValues(numPoints);
+  for (int n = 0; n < numPoints; n++)
+    {
+    labels->SetValue(n, this->FiducialLabelTexts[n]);
     }
-    node->SetID(id);
-    if (!this->GetDisableModifiedEvent())
-      {
-      // the list contents have been modified
-      std::string pointIDStr = node->GetID();
-      this->InvokeEvent(vtkMRMLFiducialListNode::FiducialModifiedEvent, (void*)&pointIDStr);
-      }
-    this->StorableModifiedTime.Modified();
-    node = NULL;
-    return 0;
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLFiducialListNode::GetFiducialsSelected(vtkDataArray *selected)
+{
+  if (!selected)
+    {
+    return;
+    }
+  int numPoints = this->GetNumberOfFiducials();
+  selected->SetNumberOfComponents(1);
+  selected->SetNumberOfTuples(numPoints);
+  for (int n = 0; n < numPoints; n++)
+    {
+    selected->SetTuple1(n, this->FiducialSelected[n] ? 1 : 0);
+    }
+}
 
 //----------------------------------------------------------------------------
-const char *vtkMRMLFiducialListNode::GetNthFiducialID(int n)
+int vtkMRMLFiducialListNode::SetFiducialsSelected(vtkDataArray *selected)
 {
-    vtkMRMLFiducial *node = this->GetNthFiducial(n);
-    if (node != NULL)
-      {
-      const char *id = node->GetID();
-      node = NULL;
-      return id;
-      }
-    else
-      {
-      return "(none)";
-      }
+  if (!selected || selected->GetNumberOfTuples() != this->GetNumberOfFiducials())
+    {
+    vtkErrorMacro("SetFiducialsSelected: expected " << this->GetNumberOfFiducials() << " values");
+    return 1;
+    }
+  int numPoints = this->GetNumberOfFiducials();
+  for (int n = 0; n < numPoints; n++)
+    {
+    this->FiducialSelected[n] = (selected->GetComponent(n, 0) != 0);
+    }
+  if (!this->GetDisableModifiedEvent())
+    {
+    this->InvokeEvent(vtkMRMLFiducialListNode::FiducialModifiedEvent, NULL);
+    }
+  this->StorableModifiedTime.Modified();
+  this->Modified();
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLFiducialListNode::GetFiducialsVisibility(vtkDataArray *visibility)
+{
+  if (!visibility)
+    {
+    return;
+    }
+  int numPoints = this->GetNumberOfFiducials();
+  visibility->SetNumberOfComponents(1);
+  visibility->SetNumberOfTuples(numPoints);
+  for (int n = 0; n < numPoints; n++)
+    {
+    visibility->SetTuple1(n, this->FiducialVisibility[n] ? 1 : 0);
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLFiducialListNode::SetFiducialsVisibility(vtkDataArray *visibility)
+{
+  if (!visibility || visibility->GetNumberOfTuples() != this->GetNumberOfFiducials())
+    {
+    vtkErrorMacro("SetFiducialsVisibility: expected " << this->GetNumberOfFiducials() << " values");
+    return 1;
+    }
+  int numPoints = this->GetNumberOfFiducials();
+  for (int n = 0; n < numPoints; n++)
+    {
+    this->FiducialVisibility[n] = (visibility->GetComponent(n, 0) != 0);
+    }
+  if (!this->GetDisableModifiedEvent())
+    {
+    this->InvokeEvent(vtkMRMLFiducialListNode::FiducialModifiedEvent, NULL);
+    }
+  this->StorableModifiedTime.Modified();
+  this->Modified();
+  return 0;
 }
 
 //----------------------------------------------------------------------------
@@ -1080,36 +1167,11 @@ int vtkMRMLFiducialListNode::AddFiducial()
     return (-1);
     }
 
-  // create a vtkMRMLFiducial and return the fiducial number for later
-  // access
-//  vtkMRMLFiducial * fiducial = vtkMRMLFiducial::New();
-  vtkSmartPointer<vtkMRMLFiducial> fiducial = vtkSmartPointer<vtkMRMLFiducial>::New();
-
-  // give the point a unique name based on the list name
-  std::stringstream ss;
-  ss << this->GetName();
-  ss << "-P";
-  std::string nameString;
-  ss >> nameString;
-  fiducial->SetID(this->GetScene()->GetUniqueNameByString(nameString.c_str()));
- 
-  
-  // add it to the collection
-  this->FiducialList->vtkCollection::AddItem(fiducial);
+  std::string id = this->GenerateFiducialID("");
+  int itemIndex = this->AppendFiducial(id, "", 0.0, 0.0, 0.0, false, true);
   // set the label text now that the fid is in the list so it can be based on
   // the previous fid's number
-  this->SetFiducialLabelTextFromID(fiducial);
-
-  int itemIndex = this->FiducialList->vtkCollection::IsItemPresent(fiducial);
-  // decrement the index, because GetNthFiducial needs a 0 based array
-  // index, IsItemPresent returns a 1 based array index
-  itemIndex--;
-
-  // then delete it, the collection has registered it and will keep track of
-  // it
-  // with smart pointer, will go out of scope 
-//  fiducial->Delete();
-//  fiducial = NULL;
+  this->FiducialLabelTexts[itemIndex] = this->GetFiducialLabelTextFromID(id, itemIndex);
 
   if (!this->GetDisableModifiedEvent())
     {
@@ -1135,39 +1197,10 @@ int vtkMRMLFiducialListNode::AddFiducialWithXYZ(float x, float y, float z, int s
     return (-1);
     }
 
-  // create a vtkMRMLFiducial and return the fiducial number for later
-  // access
-//  vtkMRMLFiducial * fiducial = vtkMRMLFiducial::New();
-  vtkSmartPointer<vtkMRMLFiducial> fiducial = vtkSmartPointer<vtkMRMLFiducial>::New();
-
-  // give the point a unique name based on the list name
-  std::stringstream ss;
-  ss << this->GetName();
-  ss << "-P";
-  std::string nameString;
-  ss >> nameString;
-  fiducial->SetID(this->GetScene()->GetUniqueNameByString(nameString.c_str()));
- 
-  
-  fiducial->SetXYZ(x,y,z);
-
-  fiducial->SetSelected((selected == 0 ? false : true));
-
-  fiducial->SetVisibility(true);
-  
-  // add it to the collection
-  this->FiducialList->vtkCollection::AddItem(fiducial);
-  // set the label text based on any previous item in the collection
-  this->SetFiducialLabelTextFromID(fiducial);
-  int itemIndex = this->IsFiducialPresent(fiducial);
-  // decrement the index, because GetNthFiducial needs a 0 based array
-  // index, IsFiducialPresent returns a 1 based array index
-  itemIndex--;
-
-  // then delete it, the collection has registered it and will keep track of
-  // it
-//  fiducial->Delete();
-//  fiducial = NULL;
+  std::string id = this->GenerateFiducialID("");
+  int itemIndex = this->AppendFiducial(id, "", x, y, z, selected != 0, true);
+  // set the label text based on any previous item in the list
+  this->FiducialLabelTexts[itemIndex] = this->GetFiducialLabelTextFromID(id, itemIndex);
 
   if (!this->GetDisableModifiedEvent())
     {
@@ -1194,31 +1227,9 @@ int vtkMRMLFiducialListNode::AddFiducialWithLabelXYZSelectedVisibility(const cha
     return (-1);
     }
 
-  // create a vtkMRMLFiducial and return the fiducial number for later
-  // access
-//  vtkMRMLFiducial * fiducial = vtkMRMLFiducial::New();
-  vtkSmartPointer<vtkMRMLFiducial> fiducial = vtkSmartPointer<vtkMRMLFiducial>::New();
-
-  fiducial->SetLabelText(label);
-  fiducial->SetID(this->GetScene()->GetUniqueNameByString(label));
-
-  fiducial->SetXYZ(x,y,z);
-
-  fiducial->SetSelected((selected == 0 ? false : true));
-
-  fiducial->SetVisibility((visibility == 0 ? false : true));
-  
-  // add it to the collection
-  this->FiducialList->vtkCollection::AddItem(fiducial);
-  int itemIndex = this->IsFiducialPresent(fiducial);
-  // decrement the index, because GetNthFiducial needs a 0 based array
-  // index, IsFiducialPresent returns a 1 based array index
-  itemIndex--;
-
-  // then delete it, the collection has registered it and will keep track of
-  // it
-//  fiducial->Delete();
-//  fiducial = NULL;
+  std::string labelText = (label ? label : "");
+  int itemIndex = this->AppendFiducial(this->GenerateFiducialID(labelText), labelText,
+                                       x, y, z, selected != 0, visibility != 0);
 
   if (!this->GetDisableModifiedEvent())
     {
@@ -1236,68 +1247,137 @@ int vtkMRMLFiducialListNode::AddFiducialWithLabelXYZSelectedVisibility(const cha
 }
 
 //----------------------------------------------------------------------------
-void vtkMRMLFiducialListNode::RemoveFiducial(vtkMRMLFiducial *o)
+int vtkMRMLFiducialListNode::AddFiducials(vtkPoints *points, vtkStringArray *labels,
+                                          vtkDataArray *selected, vtkDataArray *visibility)
 {
-  // char *pointID = NULL;
-  std::string pointIDStr;
-    if (o != NULL)
+  if ( !this->Scene ) 
+    {
+    vtkErrorMacro ( << "Attempt to add Fiducials, but no scene set yet");
+    return (-1);
+    }
+  if (!points)
+    {
+    vtkErrorMacro("AddFiducials: no points");
+    return -1;
+    }
+  vtkIdType numPoints = points->GetNumberOfPoints();
+  if ((labels && labels->GetNumberOfValues() != numPoints) ||
+      (selected && selected->GetNumberOfTuples() != numPoints) ||
+      (visibility && visibility->GetNumberOfTuples() != numPoints))
+    {
+    vtkErrorMacro("AddFiducials: expected " << numPoints << " labels, selected and visibility values");
+    return -1;
+    }
+
+  int firstIndex = this->GetNumberOfFiducials();
+  size_t newSize = firstIndex + numPoints;
+  this->FiducialXYZ.reserve(3 * newSize);
+  this->FiducialOrientationWXYZ.reserve(4 * newSize);
+  this->FiducialSelected.reserve(newSize);
+  this->FiducialVisibility.reserve(newSize);
+  this->FiducialLabelTexts.reserve(newSize);
+  this->FiducialIDs.reserve(newSize);
+
+  double xyz[3];
+  for (vtkIdType p = 0; p < numPoints; p++)
+    {
+    points->GetPoint(p, xyz);
+    std::string labelText = (labels ? labels->GetValue(p) : std::string(""));
+    std::string id = this->GenerateFiducialID(labelText);
+    int itemIndex = this->AppendFiducial(id, labelText, xyz[0], xyz[1], xyz[2],
+      (selected ? selected->GetComponent(p, 0) != 0 : false),
+      (visibility ? visibility->GetComponent(p, 0) != 0 : true));
+    if (!labels)
       {
-      vtkDebugMacro("RemoveFiducial: list " << this->GetID() << ", removing fiducial id " << o->GetID() << ", label = " << o->GetLabelText());
-      pointIDStr = o->GetID();
+      this->FiducialLabelTexts[itemIndex] = this->GetFiducialLabelTextFromID(id, itemIndex);
       }
-    this->FiducialList->vtkCollection::RemoveItem(o);
+    }
+
+  if (numPoints > 0)
+    {
     if (!this->GetDisableModifiedEvent())
       {
-      // let interested observers know that a fiducial was removed
-      this->InvokeEvent(vtkMRMLScene::NodeRemovedEvent, (void*)&pointIDStr);
+      vtkDebugMacro("AddFiducials: throwing node added event for " << numPoints << " fiducials");
+      this->InvokeEvent(vtkMRMLScene::NodeAddedEvent, this);
       }
-  this->Modified();
+    this->StorableModifiedTime.Modified();
+    this->Modified();
+    }
+  return firstIndex;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLFiducialListNode::RemoveFiducial(vtkMRMLFiducial *o)
+{
+  int index = -1;
+  if (o != NULL && o->GetID() != NULL)
+    {
+    vtkDebugMacro("RemoveFiducial: list " << this->GetID() << ", removing fiducial id " << o->GetID() << ", label = " << o->GetLabelText());
+    index = this->GetFiducialIndex(o->GetID());
+    }
+  if (index == -1)
+    {
+    return;
+    }
+  this->RemoveFiducial(index);
 }
 
 //----------------------------------------------------------------------------
 void vtkMRMLFiducialListNode::RemoveFiducial(int i)
 {
-  vtkMRMLFiducial *node = this->GetNthFiducial(i);
-  std::string pointIDStr = node->GetID();
-  this->FiducialList->vtkCollection::RemoveItem(i);
+  if (!this->IsFiducialIndexValid(i))
+    {
+    return;
+    }
+  std::string pointIDStr = this->FiducialIDs[i];
+  this->FiducialXYZ.erase(this->FiducialXYZ.begin() + 3 * i,
+                          this->FiducialXYZ.begin() + 3 * i + 3);
+  this->FiducialOrientationWXYZ.erase(this->FiducialOrientationWXYZ.begin() + 4 * i,
+                                      this->FiducialOrientationWXYZ.begin() + 4 * i + 4);
+  this->FiducialSelected.erase(this->FiducialSelected.begin() + i);
+  this->FiducialVisibility.erase(this->FiducialVisibility.begin() + i);
+  this->FiducialLabelTexts.erase(this->FiducialLabelTexts.begin() + i);
+  this->FiducialIDs.erase(this->FiducialIDs.begin() + i);
   if (!this->GetDisableModifiedEvent())
     {
     this->InvokeEvent(vtkMRMLScene::NodeRemovedEvent, (void*)&pointIDStr);
     }
-  node = NULL;
   this->Modified();
 }
 
 //----------------------------------------------------------------------------
 void vtkMRMLFiducialListNode::RemoveAllFiducials()
 {
-    int numPoints = this->GetNumberOfFiducials();
-    for (int f = numPoints - 1; f >= 0; f--)
+  for (int f = this->GetNumberOfFiducials() - 1; f >= 0; f--)
+    {
+    // as remove them from the end of the list, the size of the list
+    // will shrink as the iterator f reduces
+    std::string pointIDStr = this->FiducialIDs[f];
+    this->FiducialXYZ.resize(3 * f);
+    this->FiducialOrientationWXYZ.resize(4 * f);
+    this->FiducialSelected.resize(f);
+    this->FiducialVisibility.resize(f);
+    this->FiducialLabelTexts.resize(f);
+    this->FiducialIDs.resize(f);
+    if (!this->GetDisableModifiedEvent())
       {
-      // as remove them from the end of the list, the size of the list
-      // will shrink as the iterator f reduces
-      vtkMRMLFiducial *fid = vtkMRMLFiducial::SafeDownCast(this->FiducialList->vtkCollection::GetItemAsObject(f));
-      std::string pointIDStr = fid->GetID();
-      this->FiducialList->vtkCollection::RemoveItem(f);
-      if (!this->GetDisableModifiedEvent())
-        {
-        // need to throw a node removed event since the fiducial list widget is
-        // watching for them for each point
-        this->InvokeEvent(vtkMRMLScene::NodeRemovedEvent, (void*)&pointIDStr);
-        }
-      if (fid != NULL)
-        {
-        //fid->Delete();
-        fid = NULL;
-        }
+      // need to throw a node removed event since the fiducial list widget is
+      // watching for them for each point
+      this->InvokeEvent(vtkMRMLScene::NodeRemovedEvent, (void*)&pointIDStr);
       }
+    }
   this->Modified();
 }
 
 //----------------------------------------------------------------------------
 int vtkMRMLFiducialListNode::IsFiducialPresent(vtkMRMLFiducial *o)
 {
-    return this->FiducialList->vtkCollection::IsItemPresent(o);
+  if (o == NULL || o->GetID() == NULL)
+    {
+    return 0;
+    }
+  // a 1 based index, as vtkCollection::IsItemPresent
+  return this->GetFiducialIndex(o->GetID()) + 1;
 }
 
 //-----------------------------------------------------------
@@ -1671,17 +1751,20 @@ void vtkMRMLFiducialListNode::ApplyTransformMatrix(vtkMatrix4x4* transformMatrix
 //  vtkMatrix4x4* newOrientationMatrix = vtkMatrix4x4::New();
   vtkSmartPointer<vtkMatrix4x4> orientationMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
   vtkSmartPointer<vtkMatrix4x4> newOrientationMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+  // converts the transformed orientation matrices back to wxyz
+  vtkSmartPointer<vtkMRMLFiducial> orientationFiducial = vtkSmartPointer<vtkMRMLFiducial>::New();
   for (int n=0; n<numPoints; n++)
     {
-    vtkMRMLFiducial *node = this->GetNthFiducial(n);
+    float *xyz = &this->FiducialXYZ[3 * n];
+    float *wxyz = &this->FiducialOrientationWXYZ[4 * n];
 
-    node->GetXYZ(xyzIn);
+    std::copy(xyz, xyz + 3, xyzIn);
     xyzOut[0] = matrix[0][0]*xyzIn[0] + matrix[0][1]*xyzIn[1] + matrix[0][2]*xyzIn[2] + matrix[0][3];
     xyzOut[1] = matrix[1][0]*xyzIn[0] + matrix[1][1]*xyzIn[1] + matrix[1][2]*xyzIn[2] + matrix[1][3];
     xyzOut[2] = matrix[2][0]*xyzIn[0] + matrix[2][1]*xyzIn[1] + matrix[2][2]*xyzIn[2] + matrix[2][3];
-    node->SetXYZ(xyzOut);
+    std::copy(xyzOut, xyzOut + 3, xyz);
 
-    node->GetOrientationWXYZ(orientationIn);
+    std::copy(wxyz, wxyz + 4, orientationIn);
     quaternionIn[0] = cos(0.5*orientationIn[0]);
     double f = sin(0.5*orientationIn[0])/sqrt(orientationIn[1]*orientationIn[1]+orientationIn[2]*orientationIn[2]+orientationIn[3]*orientationIn[3]);
     quaternionIn[1] = f * orientationIn[1];
@@ -1696,7 +1779,8 @@ void vtkMRMLFiducialListNode::ApplyTransformMatrix(vtkMatrix4x4* transformMatrix
       orientationMatrix->Element[i][2] = orientationMatrix3x3[i][2];
       }
     vtkMatrix4x4::Multiply4x4(orientationMatrix,transformMatrix,newOrientationMatrix);
-    node->SetOrientationWXYZFromMatrix4x4(newOrientationMatrix);
+    orientationFiducial->SetOrientationWXYZFromMatrix4x4(newOrientationMatrix);
+    orientationFiducial->GetOrientationWXYZ(wxyz);
     }
 
 //  orientationMatrix->Delete();
@@ -1715,12 +1799,13 @@ void vtkMRMLFiducialListNode::ApplyTransform(vtkAbstractTransform* transform)
   float orientationOut[4], orientationNormalOut[3];
   for (int n=0; n<numPoints; n++)
     {
-    vtkMRMLFiducial *node = this->GetNthFiducial(n);
-    node->GetXYZ(xyzIn);
+    float *xyz = &this->FiducialXYZ[3 * n];
+    float *wxyz = &this->FiducialOrientationWXYZ[4 * n];
+    std::copy(xyz, xyz + 3, xyzIn);
     transform->TransformPoint(xyzIn,xyzOut);
-    node->SetXYZ(xyzOut);
+    std::copy(xyzOut, xyzOut + 3, xyz);
 
-    node->GetOrientationWXYZ(orientationIn);
+    std::copy(wxyz, wxyz + 4, orientationIn);
     orientationNormalIn[0] = orientationIn[1];
     orientationNormalIn[1] = orientationIn[2];
     orientationNormalIn[2] = orientationIn[3];
@@ -1729,7 +1814,7 @@ void vtkMRMLFiducialListNode::ApplyTransform(vtkAbstractTransform* transform)
     orientationOut[1] = orientationNormalOut[0];
     orientationOut[2] = orientationNormalOut[1];
     orientationOut[3] = orientationNormalOut[2];
-    node->SetOrientationWXYZ(orientationOut);
+    std::copy(orientationOut, orientationOut + 4, wxyz);
     }
   this->StorableModifiedTime.Modified();
   this->Modified();
@@ -1762,8 +1847,7 @@ int vtkMRMLFiducialListNode::GetFiducialIndex(std::string fiducialID)
   int numPoints = this->GetNumberOfFiducials();
   for (int n=0; n<numPoints; n++)
     {
-    const char *thisID = this->GetNthFiducialID(n);
-    if (fiducialID.compare(thisID) == 0)
+    if (this->FiducialIDs[n] == fiducialID)
       {
       return n;
       }
@@ -1788,28 +1872,9 @@ int vtkMRMLFiducialListNode::MoveFiducialUp(int fidIndex)
     return newIndex;
     }
 
-  // get this fiducial and the one above
-  vtkMRMLFiducial *thisFid = this->GetNthFiducial(fidIndex);
-  vtkMRMLFiducial *fidAbove = this->GetNthFiducial(fidIndex - 1);
-  if (thisFid == NULL || fidAbove == NULL)
-    {
-    vtkErrorMacro("MoveFiducialUp: Failed to get both fiducial " << fidIndex << " and " << fidIndex-1);
-    return newIndex;
-    }
   newIndex = fidIndex - 1;
-  // make a copy to avoid memory corruption
-//  vtkMRMLFiducial *copyFidAbove = vtkMRMLFiducial::New();
-  vtkSmartPointer<vtkMRMLFiducial> copyFidAbove = vtkSmartPointer<vtkMRMLFiducial>::New();
-  copyFidAbove->Copy(fidAbove);
-  // id isn't copied
-  copyFidAbove->SetID(fidAbove->GetID());
-  // now replace the one above with this one
-  this->FiducialList->ReplaceItem(newIndex, thisFid);
-  // and replace this one withthe one that was above
-  this->FiducialList->ReplaceItem(fidIndex, copyFidAbove);
-
-  // it's held onto by the collection now
-//  copyFidAbove->Delete();
+  // swap this one with the one above
+  this->SwapFiducials(newIndex, fidIndex);
 
   this->Modified();
   
@@ -1840,30 +1905,9 @@ int vtkMRMLFiducialListNode::MoveFiducialDown(int fidIndex)
     return newIndex;
     }
 
-  // get this fiducial and the one below it
-  vtkMRMLFiducial *thisFid = this->GetNthFiducial(fidIndex);
-  vtkMRMLFiducial *fidBelow = this->GetNthFiducial(fidIndex + 1);
-  
-  if (thisFid == NULL || fidBelow == NULL)
-    {
-    vtkErrorMacro("MoveFiducialUp: Failed to get both fiducial " << fidIndex << " and " << fidIndex+1);
-    return newIndex;
-    }
-  // make copy to avoid memory corruption
-//  vtkMRMLFiducial *copyFidBelow = vtkMRMLFiducial::New();
-  vtkSmartPointer<vtkMRMLFiducial> copyFidBelow = vtkSmartPointer<vtkMRMLFiducial>::New();
-  copyFidBelow->Copy(fidBelow);
-  // the id isn't copied
-  copyFidBelow->SetID(fidBelow->GetID());
-  
   newIndex = fidIndex + 1;
-  // now replace the one below with this one
-  this->FiducialList->ReplaceItem(newIndex, thisFid);
-  // and replace this one with the one that was below it
-  this->FiducialList->ReplaceItem(fidIndex, copyFidBelow);
-
-  // it's held onto by the collection now
-//  copyFidBelow->Delete(); 
+  // swap this one with the one below it
+  this->SwapFiducials(fidIndex, newIndex);
   
   //this->Modified();
   // let any interested parties know that two fiducials have swapped indices
@@ -1946,39 +1990,40 @@ void vtkMRMLFiducialListNode::SetFiducialLabelTextFromID(vtkMRMLFiducial *fid)
     return;
     }
   std::string id = fid->GetID();
- 
+  std::string labelText = this->GetFiducialLabelTextFromID(id, this->GetFiducialIndex(id));
+  fid->SetLabelText(labelText.c_str());
+}
+
+//---------------------------------------------------------------------------
+std::string vtkMRMLFiducialListNode::GetFiducialLabelTextFromID(const std::string& id, int itemIndex)
+{
   if (this->NumberingScheme == vtkMRMLFiducialListNode::UseID)
     {
-    fid->SetLabelText(fid->GetID());
+    return id;
     }
-  else
-    {
-    int itemIndex = this->GetFiducialIndex(id);
-    size_t pos = id.find_last_not_of("0123456789");
-    std::string strippedID = id.substr(0, pos+1);
-    std::stringstream ss;
-    ss << strippedID;
+  size_t pos = id.find_last_not_of("0123456789");
+  std::string strippedID = id.substr(0, pos+1);
+  std::stringstream ss;
+  ss << strippedID;
 
-    if (this->NumberingScheme == vtkMRMLFiducialListNode::UseIndex)
-      {
-      // use the fid's index
-      ss << itemIndex;
-      }
-    else if (this->NumberingScheme == vtkMRMLFiducialListNode::UsePrevious)
+  if (this->NumberingScheme == vtkMRMLFiducialListNode::UseIndex)
+    {
+    // use the fid's index
+    ss << itemIndex;
+    }
+  else if (this->NumberingScheme == vtkMRMLFiducialListNode::UsePrevious)
+    {
+    // use the number from the previous fiducial
+    int lastNumber = 0;
+    if (itemIndex > 0)
       {
-      // use the number from the previous fiducial
-      int lastNumber = 0;
-      if (itemIndex > 0)
-        {
-        std::string previousLabel = this->GetNthFiducialLabelText(itemIndex - 1);
-        size_t prevpos = previousLabel.find_last_not_of("0123456789");
-        std::string suffixPreviousLabel = previousLabel.substr(prevpos+1, std::string::npos);
-        lastNumber = atoi(suffixPreviousLabel.c_str());
-        lastNumber++;
-        }
-      ss << lastNumber;
+      const std::string& previousLabel = this->FiducialLabelTexts[itemIndex - 1];
+      size_t prevpos = previousLabel.find_last_not_of("0123456789");
+      std::string suffixPreviousLabel = previousLabel.substr(prevpos+1, std::string::npos);
+      lastNumber = atoi(suffixPreviousLabel.c_str());
+      lastNumber++;
       }
-    std::string labelText = ss.str();
-    fid->SetLabelText(labelText.c_str());
+    ss << lastNumber;
     }
+  return ss.str();
 }
@@ -21,11 +21,14 @@ class vtkMRMLFiducial;
 class vtkMRMLFiducialListStorageNode;
 
 // VTK includes
+class vtkDataArray;
 class vtkMatrix4x4;
-class vtkCollection;
+class vtkPoints;
+class vtkStringArray;
 
 // STD includes
 #include <string>
+#include <vector>
 
 ///
 /// a structure used when invoking an event to let others know that two
@@ -43,6 +46,10 @@ typedef struct
 ///
 /// Fiducial list nodes describe a list of points in 3d space.  They indicate
 /// how to render it (color, opacity, etc).
+///
+/// The points are stored as one array per attribute, so that lists of many
+/// points can be accessed in bulk (GetFiducialsXYZ, AddFiducials, ...) and
+/// accessing a point by index is constant time.
 class VTK_MRML_EXPORT vtkMRMLFiducialListNode : public vtkMRMLStorableNode
 {
 public:
@@ -140,7 +147,8 @@ public:
   int SetAllFiducialsVisibility(int flag);
   
   /// Get the elements of the fiducial points
-  /// Return a three element float holding the position
+  /// Return a three element float holding the position. The pointer is
+  /// invalidated when fiducials are added to or removed from the list.
   float *GetNthFiducialXYZ(int n);
 
   /// Return a three element double giving the world position (any parent
@@ -158,6 +166,18 @@ public:
   int GetNthFiducialVisibility(int n);
   /// get the id of the nth fiducial
   const char *GetNthFiducialID(int n);
+
+  /// Bulk access to the fiducial points. The getters resize the arrays to
+  /// the number of fiducials. The setters take one tuple per fiducial,
+  /// invoke a single FiducialModifiedEvent with a NULL id and return 0 on
+  /// success.
+  void GetFiducialsXYZ(vtkPoints *points);
+  int SetFiducialsXYZ(vtkPoints *points);
+  void GetFiducialsLabelText(vtkStringArray *labels);
+  void GetFiducialsSelected(vtkDataArray *selected);
+  int SetFiducialsSelected(vtkDataArray *selected);
+  void GetFiducialsVisibility(vtkDataArray *visibility);
+  int SetFiducialsVisibility(vtkDataArray *visibility);
   
   /// Add a fiducial point to the list with default values
   int AddFiducial( );
@@ -166,6 +186,13 @@ public:
   int AddFiducialWithXYZ(float x, float y, float z, int selected);
   /// Add a fiducial point to the list with a label, x,y,z, selected flag, visibility
   int AddFiducialWithLabelXYZSelectedVisibility(const char *label, float x, float y, float z, int selected, int visibility);
+  /// Add fiducial points to the list in bulk, invoking a single
+  /// NodeAddedEvent. The labels, selected and visibility arrays are optional:
+  /// without labels the points are labelled from their ids as in
+  /// AddFiducial, by default they are unselected and visible.
+  /// Returns the index of the first added point, -1 on failure.
+  int AddFiducials(vtkPoints *points, vtkStringArray *labels = NULL,
+                   vtkDataArray *selected = NULL, vtkDataArray *visibility = NULL);
 
   /// remove the passed in fiducial from the list
   void RemoveFiducial(vtkMRMLFiducial *o);
@@ -308,9 +335,24 @@ protected:
   vtkMRMLFiducialListNode(const vtkMRMLFiducialListNode&);
   void operator=(const vtkMRMLFiducialListNode&);
 
-  /// disallow access to the fiducial points by outside classes, have them use
-  /// SetNthFiducial
-  vtkMRMLFiducial* GetNthFiducial(int n);
+  /// Returns true if n is the index of a fiducial, reports an error otherwise
+  bool IsFiducialIndexValid(int n);
+
+  /// Append a point to the fiducial arrays, without invoking any event.
+  /// Returns the index of the new point.
+  int AppendFiducial(const std::string& id, const std::string& labelText,
+                     float x, float y, float z, bool selected, bool visibility);
+
+  /// Generate a unique id for a new fiducial from baseName, or from the list
+  /// name if baseName is empty. Requires a scene.
+  std::string GenerateFiducialID(const std::string& baseName);
+
+  /// Generate the label text of the fiducial with the given id and index,
+  /// following the NumberingScheme (see SetFiducialLabelTextFromID)
+  std::string GetFiducialLabelTextFromID(const std::string& id, int index);
+
+  /// Swap the points at indices i and j in the fiducial arrays
+  void SwapFiducials(int i, int j);
   
   double SymbolScale;
   double TextScale;
@@ -318,8 +360,15 @@ protected:
   double Color[3];
   double SelectedColor[3];
 
-  /// The collection of fiducial points that make up this list
-  vtkCollection *FiducialList;
+  /// The fiducial points that make up this list, one array per attribute
+  /// with 3 (x, y, z) and 4 (w, x, y, z) values per point for the positions
+  /// and the orientations
+  std::vector<float> FiducialXYZ;
+  std::vector<float> FiducialOrientationWXYZ;
+  std::vector<bool> FiducialSelected;
+  std::vector<bool> FiducialVisibility;
+  std::vector<std::string> FiducialLabelTexts;
+  std::vector<std::string> FiducialIDs;
 
   /// Numbers relating to the display of the fiducials
   double Opacity;
@@ -17,7 +17,10 @@ Version:   $Revision: 1.6 $
 #include "vtkMRMLScene.h"
 
 #include "vtkObjectFactory.h"
+#include "vtkPoints.h"
+#include "vtkSmartPointer.h"
 #include "vtkStringArray.h"
+#include "vtkUnsignedCharArray.h"
 
 //------------------------------------------------------------------------------
 vtkMRMLNodeNewMacro(vtkMRMLFiducialListStorageNode);
@@ -93,8 +96,11 @@ int vtkMRMLFiducialListStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     int selColumn = 4;
     int visColumn = 5;
     int numColumns = 6;
-    // save the valid lines in a vector, parse them once know the max id
-    std::vector<std::string>lines;
+    // collect the points, they are added to the list at once
+    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+    vtkSmartPointer<vtkStringArray> labels = vtkSmartPointer<vtkStringArray>::New();
+    vtkSmartPointer<vtkUnsignedCharArray> selected = vtkSmartPointer<vtkUnsignedCharArray>::New();
+    vtkSmartPointer<vtkUnsignedCharArray> visibility = vtkSmartPointer<vtkUnsignedCharArray>::New();
     while (fstr.good())
       {
       fstr.getline(line, 1024);
@@ -364,14 +370,18 @@ int vtkMRMLFiducialListStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
               }
               columnNumber++;
             } // end while over columns          
-          int fidIndex = fiducialListNode->AddFiducialWithLabelXYZSelectedVisibility(label.c_str(), x, y, z, sel, vis);
-          if (fidIndex == -1)
-            {
-            vtkErrorMacro("Error adding fiducial to list, label = " << label.c_str());
-            }
+          points->InsertNextPoint(x, y, z);
+          labels->InsertNextValue(label);
+          selected->InsertNextValue(sel != 0);
+          visibility->InsertNextValue(vis != 0);
           } // point line
         }
       }
+    if (points->GetNumberOfPoints() > 0 &&
+        fiducialListNode->AddFiducials(points, labels, selected, visibility) == -1)
+      {
+      vtkErrorMacro("Error adding " << points->GetNumberOfPoints() << " fiducials to list");
+      }
 //    fiducialListNode->SetDisableModifiedEvent(modFlag);
 //    fiducialListNode->InvokeEvent(vtkMRMLScene::NodeAddedEvent, fiducialListNode);//vtkMRMLFiducialListNode::DisplayModifiedEvent);
     fstr.close();
@@ -486,18 +496,22 @@ int vtkMRMLFiducialListStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
 
   // if change the ones being included, make sure to update the parsing in ReadData
   of << "# columns = label,x,y,z,sel,vis" << endl;
-  for (int i = 0; i < fiducialListNode->GetNumberOfFiducials(); i++)
+  // for now, skip orientation
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  vtkSmartPointer<vtkStringArray> labels = vtkSmartPointer<vtkStringArray>::New();
+  vtkSmartPointer<vtkUnsignedCharArray> selected = vtkSmartPointer<vtkUnsignedCharArray>::New();
+  vtkSmartPointer<vtkUnsignedCharArray> visibility = vtkSmartPointer<vtkUnsignedCharArray>::New();
+  fiducialListNode->GetFiducialsXYZ(points);
+  fiducialListNode->GetFiducialsLabelText(labels);
+  fiducialListNode->GetFiducialsSelected(selected);
+  fiducialListNode->GetFiducialsVisibility(visibility);
+  for (vtkIdType i = 0; i < points->GetNumberOfPoints(); i++)
     {
-    float *xyz = fiducialListNode->GetNthFiducialXYZ(i);
-    // for now, skip orientation
-    //float *xyzw = fiducialListNode->GetNthFiducialOrientation(i);
-    const char *label = fiducialListNode->GetNthFiducialLabelText(i);
-    int sel = fiducialListNode->GetNthFiducialSelected(i);
-    int vis = fiducialListNode->GetNthFiducialVisibility(i);
-    of << label;
+    double *xyz = points->GetPoint(i);
+    of << labels->GetValue(i);
     of << "," << xyz[0] << "," << xyz[1] << "," << xyz[2];
-    of << "," << sel << "," << vis;
-    of << endl;   
+    of << "," << static_cast<int>(selected->GetValue(i)) << "," << static_cast<int>(visibility->GetValue(i));
+    of << "\n";
     }
   of.close();
 
@@ -53,6 +53,8 @@ vtkMRMLNodeNewMacro(vtkMRMLFreeSurferModelOverlayStorageNode);
 //----------------------------------------------------------------------------
 vtkMRMLFreeSurferModelOverlayStorageNode::vtkMRMLFreeSurferModelOverlayStorageNode()
 {
+  this->DeferRead = 0;
+  this->OverlayLoaded = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -64,10 +66,165 @@ vtkMRMLFreeSurferModelOverlayStorageNode::~vtkMRMLFreeSurferModelOverlayStorageN
 void vtkMRMLFreeSurferModelOverlayStorageNode::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os,indent);
+  os << indent << "DeferRead: " << this->DeferRead << "\n";
+  os << indent << "OverlayLoaded: " << this->OverlayLoaded << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLFreeSurferModelOverlayStorageNode::WriteXML(ostream& of, int indent)
+{
+  Superclass::WriteXML(of, indent);
+
+  of << " deferRead=\"" << this->DeferRead << "\"";
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLFreeSurferModelOverlayStorageNode::ReadXMLAttributes(const char** atts)
+{
+  int disabledModify = this->StartModify();
+
+  Superclass::ReadXMLAttributes(atts);
+  const char* attName;
+  const char* attValue;
+  while (*atts != NULL)
+    {
+    attName = *(atts++);
+    attValue = *(atts++);
+    if (!strcmp(attName, "deferRead"))
+      {
+      this->SetDeferRead(atoi(attValue));
+      }
+    }
+
+  this->EndModify(disabledModify);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLFreeSurferModelOverlayStorageNode::Copy(vtkMRMLNode *anode)
+{
+  this->Superclass::Copy(anode);
+
+  vtkMRMLFreeSurferModelOverlayStorageNode *node =
+    vtkMRMLFreeSurferModelOverlayStorageNode::SafeDownCast(anode);
+  if (node)
+    {
+    this->SetDeferRead(node->GetDeferRead());
+    }
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLFreeSurferModelOverlayStorageNode::IsReadDeferred()
+{
+  if (!this->DeferRead)
+    {
+    return false;
+    }
+  std::string extension = itksys::SystemTools::GetFilenameLastExtension(
+    this->GetFullNameFromFileName());
+  return extension == std::string(".thickness") ||
+    extension == std::string(".curv") ||
+    extension == std::string(".avg_curv") ||
+    extension == std::string(".sulc") ||
+    extension == std::string(".area") ||
+    extension == std::string(".w") ||
+    extension == std::string(".mgz") ||
+    extension == std::string(".mgh");
+}
+
+//----------------------------------------------------------------------------
+std::string vtkMRMLFreeSurferModelOverlayStorageNode::GetScalarName()
+{
+  // Same names as ReadOverlay(): the w and label overlays are named after
+  // their file, the other overlays after their directory and file.
+  std::string name = this->GetFullNameFromFileName();
+  std::string extension = itksys::SystemTools::GetFilenameLastExtension(name);
+  std::string::size_type ptr = name.find_last_of(std::string("/"));
+  if (ptr == std::string::npos)
+    {
+    return name;
+    }
+  if (extension != std::string(".w") && extension != std::string(".label") &&
+      ptr > 0)
+    {
+    std::string::size_type dirptr = name.find_last_of(std::string("/"), ptr - 1);
+    if (dirptr != std::string::npos)
+      {
+      return name.substr(dirptr + 1);
+      }
+    }
+  return name.substr(ptr + 1);
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLFreeSurferModelOverlayStorageNode::LoadOverlay(vtkMRMLModelNode* modelNode)
+{
+  if (this->OverlayLoaded)
+    {
+    return 1;
+    }
+  // Set first: reading the overlay activates its scalars, which would
+  // load it again.
+  this->OverlayLoaded = 1;
+  // Loading a deferred overlay is not a modification of the model
+  bool wasModified = modelNode && modelNode->GetModifiedSinceRead();
+  int res = this->ReadOverlay(modelNode);
+  if (!res)
+    {
+    this->OverlayLoaded = 0;
+    }
+  else if (!wasModified)
+    {
+    this->StoredTimeModified();
+    }
+  return res;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLFreeSurferModelOverlayStorageNode::UnloadOverlay(vtkMRMLModelNode* modelNode)
+{
+  if (!this->OverlayLoaded || !this->IsReadDeferred() ||
+      !modelNode || !modelNode->GetPolyData())
+    {
+    return;
+    }
+  vtkDebugMacro("UnloadOverlay: releasing " << this->GetScalarName());
+  bool wasModified = modelNode->GetModifiedSinceRead();
+  modelNode->RemoveScalars(this->GetScalarName().c_str());
+  this->OverlayLoaded = 0;
+  if (!wasModified)
+    {
+    this->StoredTimeModified();
+    }
 }
 
 //----------------------------------------------------------------------------
 int vtkMRMLFreeSurferModelOverlayStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
+{
+  vtkMRMLModelNode *modelNode = vtkMRMLModelNode::SafeDownCast(refNode);
+  if (modelNode && this->IsReadDeferred())
+    {
+    // Only read the overlay that is displayed
+    vtkMRMLModelDisplayNode *displayNode = modelNode->GetModelDisplayNode();
+    const char* activeScalarName =
+      displayNode ? displayNode->GetActiveScalarName() : 0;
+    if (activeScalarName && strlen(activeScalarName) > 0 &&
+        this->GetScalarName() != activeScalarName)
+      {
+      vtkDebugMacro("ReadData: deferring the reading of "
+                    << this->GetScalarName());
+      this->UnloadOverlay(modelNode);
+      return 1;
+      }
+    }
+  // Set first: reading the overlay activates its scalars
+  this->OverlayLoaded = 1;
+  int res = this->ReadOverlay(refNode);
+  this->OverlayLoaded = res ? 1 : 0;
+  return res;
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLFreeSurferModelOverlayStorageNode::ReadOverlay(vtkMRMLNode *refNode)
 {
   vtkMRMLModelNode *modelNode = vtkMRMLModelNode::SafeDownCast(refNode);
 
@@ -17,6 +17,8 @@
 
 #include "vtkMRMLModelStorageNode.h"
 
+class vtkMRMLModelNode;
+
 /// \brief MRML node for model storage on disk.
 ///
 /// Storage nodes has methods to read/write vtkPolyData to/from disk.
@@ -30,6 +32,15 @@ public:
 
   virtual vtkMRMLNode* CreateNodeInstance();
 
+  /// Read node attributes from XML file
+  virtual void ReadXMLAttributes( const char** atts);
+
+  /// Write this node's information to a MRML file in XML format.
+  virtual void WriteXML(ostream& of, int indent);
+
+  /// Copy the node's attributes to this object
+  virtual void Copy(vtkMRMLNode *node);
+
   /// 
   /// Copy data from a  referenced node's filename to new location.
   /// NOTE: use this instead of Write Data in the Remote IO Pipeline
@@ -43,6 +54,37 @@ public:
   /// Return true if reference node can be written from
   virtual bool CanWriteFromReferenceNode(vtkMRMLNode *refNode);
 
+  /// Defer the reading of scalar overlays (thickness, curv, sulc, area, w,
+  /// mgz and mgh files) until they are displayed: ReadData() only reads the
+  /// overlay if it is the active scalar of the model display node or if
+  /// the display node has no active scalar yet. The model node reads the
+  /// overlay when its scalar name becomes active, and releases its array
+  /// when another scalar becomes active. Annotations and labels are always
+  /// read. Off by default.
+  /// \sa GetScalarName(), LoadOverlay(), UnloadOverlay()
+  vtkGetMacro(DeferRead, int);
+  vtkSetMacro(DeferRead, int);
+  vtkBooleanMacro(DeferRead, int);
+
+  /// Return true if the overlay is deferred (DeferRead is on and the file
+  /// is a scalar overlay).
+  bool IsReadDeferred();
+
+  /// Name of the point scalars the overlay is read into, computed from the
+  /// file name.
+  std::string GetScalarName();
+
+  /// 1 if the overlay array is in the model polydata
+  vtkGetMacro(OverlayLoaded, int);
+
+  /// Read the overlay into the model if it is not loaded yet.
+  /// Return 0 on error.
+  int LoadOverlay(vtkMRMLModelNode* modelNode);
+
+  /// Remove the array of a deferred overlay from the model. It is read
+  /// again by LoadOverlay().
+  void UnloadOverlay(vtkMRMLModelNode* modelNode);
+
 protected:
   vtkMRMLFreeSurferModelOverlayStorageNode();
   ~vtkMRMLFreeSurferModelOverlayStorageNode();
@@ -65,8 +107,14 @@ protected:
   /// NOTE: Subclasses should implement this method
   virtual int WriteDataInternal(vtkMRMLNode *refNode);
 
+  /// Read the overlay file into the model node
+  int ReadOverlay(vtkMRMLNode *refNode);
+
   std::string GetColorNodeIDFromExtension(const std::string& extension);
   std::string GetColorNodeIDFromType(int type);
+
+  int DeferRead;
+  int OverlayLoaded;
 };
 
 #endif
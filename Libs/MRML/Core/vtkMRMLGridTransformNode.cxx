@@ -12,12 +12,18 @@ Version:   $Revision: 1.14 $
 
 =========================================================================auto=*/
 
+#include <algorithm>
 #include <sstream>
+#include <vector>
 
 #include "vtkObjectFactory.h"
 
+#include "vtkDataArray.h"
 #include "vtkGridTransform.h"
 #include "vtkImageData.h"
+#include "vtkMath.h"
+#include "vtkPointData.h"
+#include "vtkTypeTraits.h"
 
 #include "vtkMRMLGridTransformNode.h"
 
@@ -229,6 +235,161 @@ void vtkMRMLGridTransformNode::Copy(vtkMRMLNode *anode)
   Superclass::Copy(anode);
 }
 
+//----------------------------------------------------------------------------
+namespace
+{
+template <class T>
+void QuantizeDisplacementsTemplate(const double* values, vtkIdType count,
+                                   T* output, double scale, double shift,
+                                   bool round)
+{
+  const double min = vtkTypeTraits<T>::Min();
+  const double max = vtkTypeTraits<T>::Max();
+  for (vtkIdType i = 0; i < count; ++i)
+    {
+    double value = (values[i] - shift) / scale;
+    if (round)
+      {
+      value = vtkMath::Floor(value + 0.5);
+      value = value < min ? min : (value > max ? max : value);
+      }
+    output[i] = static_cast<T>(value);
+    }
+}
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLGridTransformNode::GetDisplacementQuantization(
+  int scalarType, const double range[2], double& scale, double& shift)
+{
+  scale = 1.;
+  shift = 0.;
+  if (scalarType != VTK_SHORT)
+    {
+    return;
+    }
+  // Symmetric type range so that the shift is representable
+  const double halfTypeRange = VTK_SHORT_MAX;
+  shift = (range[0] + range[1]) / 2.;
+  double halfRange = (range[1] - range[0]) / 2.;
+  scale = halfRange > 0. ? halfRange / halfTypeRange : 1.;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLGridTransformNode::QuantizeDisplacements(
+  const double* values, vtkIdType count, int scalarType, void* output,
+  double scale, double shift)
+{
+  switch (scalarType)
+    {
+    case VTK_DOUBLE:
+      QuantizeDisplacementsTemplate(values, count,
+        static_cast<double*>(output), scale, shift, false);
+      break;
+    case VTK_FLOAT:
+      QuantizeDisplacementsTemplate(values, count,
+        static_cast<float*>(output), scale, shift, false);
+      break;
+    case VTK_SHORT:
+      QuantizeDisplacementsTemplate(values, count,
+        static_cast<short*>(output), scale, shift, true);
+      break;
+    default:
+      vtkGenericWarningMacro("QuantizeDisplacements: unsupported scalar type "
+                             << scalarType);
+      break;
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLGridTransformNode::GetDisplacementGridScalarType()
+{
+  vtkGridTransform* grid =
+    vtkGridTransform::SafeDownCast(this->WarpTransformToParent);
+  vtkImageData* image = grid ? grid->GetDisplacementGrid() : 0;
+  if (!image || !image->GetPointData()->GetScalars())
+    {
+    return VTK_DOUBLE;
+    }
+  return image->GetScalarType();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLGridTransformNode::SetDisplacementGridScalarType(int scalarType)
+{
+  if (scalarType != VTK_DOUBLE && scalarType != VTK_FLOAT &&
+      scalarType != VTK_SHORT)
+    {
+    vtkErrorMacro("SetDisplacementGridScalarType: unsupported scalar type "
+                  << scalarType);
+    return;
+    }
+  vtkGridTransform* grid =
+    vtkGridTransform::SafeDownCast(this->WarpTransformToParent);
+  vtkImageData* image = grid ? grid->GetDisplacementGrid() : 0;
+  vtkDataArray* displacements =
+    image ? image->GetPointData()->GetScalars() : 0;
+  if (!displacements || image->GetScalarType() == scalarType)
+    {
+    return;
+    }
+
+  const double oldScale = grid->GetDisplacementScale();
+  const double oldShift = grid->GetDisplacementShift();
+  const vtkIdType count = displacements->GetNumberOfTuples() *
+    displacements->GetNumberOfComponents();
+
+  // The displacement range of each component, in the transform units
+  double range[2] = {VTK_DOUBLE_MAX, VTK_DOUBLE_MIN};
+  for (int c = 0; c < displacements->GetNumberOfComponents(); ++c)
+    {
+    double* componentRange = displacements->GetRange(c);
+    for (int i = 0; i < 2; ++i)
+      {
+      double value = componentRange[i] * oldScale + oldShift;
+      range[0] = std::min(range[0], value);
+      range[1] = std::max(range[1], value);
+      }
+    }
+  double scale = 1.;
+  double shift = 0.;
+  vtkMRMLGridTransformNode::GetDisplacementQuantization(
+    scalarType, range, scale, shift);
+
+  vtkSmartPointer<vtkImageData> newImage = vtkSmartPointer<vtkImageData>::New();
+  newImage->SetOrigin(image->GetOrigin());
+  newImage->SetSpacing(image->GetSpacing());
+  newImage->SetDimensions(image->GetDimensions());
+  newImage->SetNumberOfScalarComponents(image->GetNumberOfScalarComponents());
+  newImage->SetScalarType(scalarType);
+  newImage->AllocateScalars();
+
+  // Quantize by blocks to bound the temporary memory
+  const vtkIdType blockSize = 3 * 4096;
+  std::vector<double> values(blockSize);
+  char* output = static_cast<char*>(newImage->GetScalarPointer());
+  const int outputSize = newImage->GetScalarSize();
+  for (vtkIdType start = 0; start < count; start += blockSize)
+    {
+    vtkIdType blockCount = std::min(blockSize, count - start);
+    for (vtkIdType i = 0; i < blockCount; ++i)
+      {
+      values[i] = displacements->GetComponent(
+        (start + i) / 3, (start + i) % 3) * oldScale + oldShift;
+      }
+    vtkMRMLGridTransformNode::QuantizeDisplacements(
+      &values[0], blockCount, scalarType, output + start * outputSize,
+      scale, shift);
+    }
+
+  int disabledModify = this->StartModify();
+  grid->SetDisplacementGrid(newImage);
+  grid->SetDisplacementScale(scale);
+  grid->SetDisplacementShift(shift);
+  this->Modified();
+  this->EndModify(disabledModify);
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLGridTransformNode::PrintSelf(ostream& os, vtkIndent indent)
 {
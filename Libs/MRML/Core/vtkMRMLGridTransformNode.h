@@ -46,6 +46,29 @@ public:
   /// Get node XML tag name (like Volume, Model)
   virtual const char* GetNodeTagName() {return "GridTransform";};
 
+  /// Store the displacement grid with components of \a scalarType:
+  /// VTK_DOUBLE, VTK_FLOAT or VTK_SHORT. A VTK_SHORT grid quantizes the
+  /// displacements over their range: the displacement scale and shift of
+  /// the vtkGridTransform dequantize them on the fly when the transform is
+  /// evaluated. A short grid takes a quarter of the memory of a double
+  /// grid, with a precision of 1/65534th of the displacement range.
+  void SetDisplacementGridScalarType(int scalarType);
+
+  /// Scalar type of the displacement grid, VTK_DOUBLE if there is no grid.
+  int GetDisplacementGridScalarType();
+
+  /// Compute the displacement \a scale and \a shift that map the
+  /// displacement \a range onto the range of \a scalarType. They are 1 and
+  /// 0 for floating point types.
+  static void GetDisplacementQuantization(int scalarType, const double range[2],
+                                          double& scale, double& shift);
+
+  /// Store \a count displacement \a values into \a output, an array of
+  /// \a scalarType, as (value - shift) / scale.
+  static void QuantizeDisplacements(const double* values, vtkIdType count,
+                                    int scalarType, void* output,
+                                    double scale, double shift);
+
 protected:
   vtkMRMLGridTransformNode();
   ~vtkMRMLGridTransformNode();
@@ -32,6 +32,7 @@ typedef std::map<std::string, std::vector< vtkMRMLHierarchyNode *> > HierarchyCh
 
 std::map< vtkMRMLScene*, HierarchyChildrenNodesType> vtkMRMLHierarchyNode::SceneHierarchyChildrenNodes = std::map< vtkMRMLScene*, HierarchyChildrenNodesType>();
 std::map< vtkMRMLScene*, unsigned long> vtkMRMLHierarchyNode::SceneHierarchyChildrenNodesMTime = std::map< vtkMRMLScene*, unsigned long>();
+std::map< vtkMRMLScene*, std::vector< vtkMRMLHierarchyNode *> > vtkMRMLHierarchyNode::ScenePendingHierarchyChildrenNodes = std::map< vtkMRMLScene*, std::vector< vtkMRMLHierarchyNode *> >();
 
 double vtkMRMLHierarchyNode::MaximumSortingValue = 0;
 
@@ -70,6 +71,7 @@ vtkMRMLHierarchyNode::vtkMRMLHierarchyNode()
 //----------------------------------------------------------------------------
 vtkMRMLHierarchyNode::~vtkMRMLHierarchyNode()
 {
+  this->RemoveFromChildrenMap();
   if (this->ParentNodeIDReference) 
     {
     delete [] this->ParentNodeIDReference;
@@ -121,6 +123,7 @@ void vtkMRMLHierarchyNode::UpdateReferenceID(const char *oldID, const char *newI
 void vtkMRMLHierarchyNode::ReadXMLAttributes(const char** atts)
 {
   int disabledModify = this->StartModify();
+  this->RemoveFromChildrenMap();
 
   Superclass::ReadXMLAttributes(atts);
 
@@ -161,6 +164,7 @@ void vtkMRMLHierarchyNode::ReadXMLAttributes(const char** atts)
       }
   }
 
+  this->AddToChildrenMap();
   this->EndModify(disabledModify);
 
 }
@@ -171,6 +175,7 @@ void vtkMRMLHierarchyNode::ReadXMLAttributes(const char** atts)
 void vtkMRMLHierarchyNode::Copy(vtkMRMLNode *anode)
 {
   int disabledModify = this->StartModify();
+  this->RemoveFromChildrenMap();
 
   Superclass::Copy(anode);
   vtkMRMLHierarchyNode *node = (vtkMRMLHierarchyNode *) anode;
@@ -179,6 +184,7 @@ void vtkMRMLHierarchyNode::Copy(vtkMRMLNode *anode)
   this->SetAssociatedNodeIDReference(node->AssociatedNodeIDReference);
   this->SortingValue = node->SortingValue;
   this->SetAllowMultipleChildren(node->AllowMultipleChildren);
+  this->AddToChildrenMap();
 
   this->EndModify(disabledModify);
   this->InvokeHierarchyModifiedEvent();
@@ -217,6 +223,18 @@ void vtkMRMLHierarchyNode::SetSceneReferences()
   this->Scene->AddReferencedNodeID(this->AssociatedNodeIDReference, this);
 }
 
+//-----------------------------------------------------------
+void vtkMRMLHierarchyNode::SetScene(vtkMRMLScene* scene)
+{
+  if (this->Scene == scene)
+    {
+    return;
+    }
+  this->RemoveFromChildrenMap();
+  this->Superclass::SetScene(scene);
+  this->AddToChildrenMap();
+}
+
 //-----------------------------------------------------------
 void vtkMRMLHierarchyNode::UpdateScene(vtkMRMLScene *scene)
 {
@@ -267,10 +285,12 @@ void vtkMRMLHierarchyNode::SetParentNodeID(const char* ref)
 
   int disableModify = this->StartModify();
 
+  // the node goes last among the children of its new parent
+  this->RemoveFromChildrenMap();
   this->SetParentNodeIDReference(ref);
   this->SetSortingValue(++MaximumSortingValue);
+  this->AddToChildrenMap();
 
-  this->HierarchyIsModified(this->GetScene());
   if (this->GetScene())
     {
     this->GetScene()->AddReferencedNodeID(ref, this);
@@ -353,14 +373,8 @@ std::vector< vtkMRMLHierarchyNode *> vtkMRMLHierarchyNode::GetChildrenNodes()
     {
     return childrenNodes;
     }
-  for (unsigned int i=0; i<iter->second.size(); i++)
-    {
-    childrenNodes.push_back(iter->second[i]);
-    }
-
-  // Sort the vector using predicate and std::sort
-  std::sort(childrenNodes.begin(), childrenNodes.end(), vtkMRMLHierarchyNodeSortPredicate);
-
+  // the index is kept sorted by SortingValue
+  childrenNodes = iter->second;
   return childrenNodes;
 }
 
@@ -502,6 +516,7 @@ void vtkMRMLHierarchyNode::UpdateChildrenMap()
     {
     this->SceneHierarchyChildrenNodes.clear();
     this->SceneHierarchyChildrenNodesMTime.clear();
+    this->ScenePendingHierarchyChildrenNodes.clear();
     return;
     }
 
@@ -519,19 +534,13 @@ void vtkMRMLHierarchyNode::UpdateChildrenMap()
         SceneHierarchyChildrenNodesMTime.find(this->GetScene());
 
   std::map<std::string, std::vector< vtkMRMLHierarchyNode *> >::iterator iter;
-  if (this->GetScene() == 0)
-    {
-    for (iter  = siter->second.begin();
-         iter != siter->second.end();
-         iter++)
-      {
-      iter->second.clear();
-      }
-    siter->second.clear();
-    }
 
-    
-  if (this->GetScene()->GetSceneModifiedTime() > titer->second)
+  // The index is built once, AddToChildrenMap() and RemoveFromChildrenMap()
+  // keep it up to date afterwards. It is rebuilt if it has been invalidated
+  // with HierarchyIsModified() or if the scene modified time went backward
+  // (i.e. a new scene got the address of a deleted one).
+  if (titer->second == 0 ||
+      this->GetScene()->GetSceneModifiedTime() < titer->second)
   {
     for (iter  = siter->second.begin();
          iter != siter->second.end();
@@ -540,6 +549,7 @@ void vtkMRMLHierarchyNode::UpdateChildrenMap()
       iter->second.clear();
       }
     siter->second.clear();
+    ScenePendingHierarchyChildrenNodes.erase(this->GetScene());
     
     std::vector<vtkMRMLNode *> nodes;
     int nnodes = this->GetScene()->GetNodesByClass("vtkMRMLHierarchyNode", nodes);
@@ -551,32 +561,140 @@ void vtkMRMLHierarchyNode::UpdateChildrenMap()
       vtkMRMLHierarchyNode *node =  vtkMRMLHierarchyNode::SafeDownCast(nodes[i]);
       if (node)
         {
-        vtkMRMLHierarchyNode *pnode = vtkMRMLHierarchyNode::SafeDownCast(node->GetParentNode());
-        if (pnode)
+        if (node->GetSortingValue() > maxSortingValue)
+          {
+          maxSortingValue = node->GetSortingValue();
+          }
+        // children are filed under the ID of their parent, even if the parent
+        // is not (yet) in the scene
+        if (node->GetParentNodeID())
           {
-          if (pnode->GetSortingValue() > maxSortingValue)
-            {
-            maxSortingValue = pnode->GetSortingValue();
-            }
-          iter = siter->second.find(std::string(pnode->GetID()));
-          if (iter == siter->second.end())
-            {
-            std::vector< vtkMRMLHierarchyNode *> children;
-            children.push_back(node);
-            siter->second[std::string(pnode->GetID())] = children;
-            }
-          else
-            {
-            iter->second.push_back(node);
-            }
+          siter->second[std::string(node->GetParentNodeID())].push_back(node);
           }
         }
       }
-    titer->second = this->GetScene()->GetSceneModifiedTime();
+    for (iter  = siter->second.begin();
+         iter != siter->second.end();
+         iter++)
+      {
+      std::stable_sort(iter->second.begin(), iter->second.end(),
+                       vtkMRMLHierarchyNodeSortPredicate);
+      }
+    // never 0, it would mean the index must be rebuilt
+    titer->second = std::max(this->GetScene()->GetSceneModifiedTime(), 1ul);
     this->MaximumSortingValue = maxSortingValue;
   }
+
+  std::map< vtkMRMLScene*, std::vector< vtkMRMLHierarchyNode *> >::iterator piter =
+    ScenePendingHierarchyChildrenNodes.find(this->GetScene());
+  if (piter != ScenePendingHierarchyChildrenNodes.end())
+    {
+    std::vector< vtkMRMLHierarchyNode *> pendingNodes;
+    pendingNodes.swap(piter->second);
+    ScenePendingHierarchyChildrenNodes.erase(piter);
+    for (unsigned int i = 0; i < pendingNodes.size(); ++i)
+      {
+      // copies that are not in the scene are dropped
+      vtkMRMLHierarchyNode *node = pendingNodes[i];
+      if (node->GetID() &&
+          this->GetScene()->GetNodeByID(node->GetID()) == node)
+        {
+        node->AddToChildrenMap();
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLHierarchyNode::AddToChildrenMap()
+{
+  if (this->Scene == NULL)
+    {
+    return;
+    }
+  std::map< vtkMRMLScene*, unsigned long>::iterator titer =
+    SceneHierarchyChildrenNodesMTime.find(this->Scene);
+  if (titer == SceneHierarchyChildrenNodesMTime.end() || titer->second == 0)
+    {
+    // the index will be built on the next request
+    return;
+    }
+  if (this->GetID() == NULL ||
+      this->Scene->GetNodeByID(this->GetID()) != this)
+    {
+    std::vector< vtkMRMLHierarchyNode *>& pendingNodes =
+      ScenePendingHierarchyChildrenNodes[this->Scene];
+    if (std::find(pendingNodes.begin(), pendingNodes.end(), this) == pendingNodes.end())
+      {
+      pendingNodes.push_back(this);
+      }
+    return;
+    }
+  if (this->SortingValue > MaximumSortingValue)
+    {
+    MaximumSortingValue = this->SortingValue;
+    }
+  if (this->ParentNodeIDReference == NULL)
+    {
+    return;
+    }
+  std::vector< vtkMRMLHierarchyNode *>& children =
+    SceneHierarchyChildrenNodes[this->Scene][std::string(this->ParentNodeIDReference)];
+  std::vector< vtkMRMLHierarchyNode *>::iterator it =
+    std::find(children.begin(), children.end(), this);
+  if (it != children.end())
+    {
+    children.erase(it);
+    }
+  children.insert(std::upper_bound(children.begin(), children.end(), this,
+                                   vtkMRMLHierarchyNodeSortPredicate), this);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLHierarchyNode::RemoveFromChildrenMap()
+{
+  if (this->Scene == NULL)
+    {
+    return;
+    }
+  // the scene may already be deleted, only use it as a key
+  std::map< vtkMRMLScene*, std::vector< vtkMRMLHierarchyNode *> >::iterator piter =
+    ScenePendingHierarchyChildrenNodes.find(this->Scene);
+  if (piter != ScenePendingHierarchyChildrenNodes.end())
+    {
+    piter->second.erase(
+      std::remove(piter->second.begin(), piter->second.end(), this),
+      piter->second.end());
+    }
+  if (this->ParentNodeIDReference == NULL)
+    {
+    return;
+    }
+  std::map< vtkMRMLScene*, HierarchyChildrenNodesType>::iterator siter =
+    SceneHierarchyChildrenNodes.find(this->Scene);
+  if (siter == SceneHierarchyChildrenNodes.end())
+    {
+    return;
+    }
+  HierarchyChildrenNodesType::iterator iter =
+    siter->second.find(std::string(this->ParentNodeIDReference));
+  if (iter == siter->second.end())
+    {
+    return;
+    }
+  std::vector< vtkMRMLHierarchyNode *>::iterator it =
+    std::find(iter->second.begin(), iter->second.end(), this);
+  if (it != iter->second.end())
+    {
+    iter->second.erase(it);
+    }
+  if (iter->second.empty())
+    {
+    siter->second.erase(iter);
+    }
 }
 
+//----------------------------------------------------------------------------
 void vtkMRMLHierarchyNode::HierarchyIsModified(vtkMRMLScene *scene)
 {
   if (scene == NULL)
@@ -769,7 +887,9 @@ void vtkMRMLHierarchyNode::SetSortingValue(double value)
   vtkDebugMacro(<< this->GetClassName() << " (" << this << "): setting SortingValue to " << value);
   if (this->SortingValue != value) 
     { 
+    this->RemoveFromChildrenMap();
     this->SortingValue = value; 
+    this->AddToChildrenMap();
     this->Modified(); 
 
     this->InvokeHierarchyModifiedEvent();
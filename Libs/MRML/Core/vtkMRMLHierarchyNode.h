@@ -53,6 +53,10 @@ public:
   /// Set the reference node to current scene.
   virtual void SetSceneReferences();
 
+  /// Reimplemented to file the node under its parent in the children index
+  /// of the new scene and to take it out of the index of the old one.
+  virtual void SetScene(vtkMRMLScene* scene);
+
   /// 
   /// Updates this node if it depends on other nodes 
   /// when the node is deleted in the scene
@@ -192,8 +196,16 @@ protected:
 
   typedef std::map<std::string, std::vector< vtkMRMLHierarchyNode *> > HierarchyChildrenNodesType;
 
+  /// Children of each parent node ID, sorted by SortingValue. The index of a
+  /// scene is built once and then kept up to date as the nodes are added,
+  /// removed, reparented or reordered.
   static std::map< vtkMRMLScene*, HierarchyChildrenNodesType> SceneHierarchyChildrenNodes;
+  /// Scene modified time when the index was built, 0 if it must be rebuilt.
   static std::map< vtkMRMLScene*, unsigned long> SceneHierarchyChildrenNodesMTime;
+  /// Nodes that have the scene set but can't be found in it yet (i.e. while
+  /// being added). They are filed in the index on the next request, unless
+  /// they are copies that never make it into the scene (e.g. undo stack).
+  static std::map< vtkMRMLScene*, std::vector< vtkMRMLHierarchyNode *> > ScenePendingHierarchyChildrenNodes;
   
   ////////////////////////////
   /// 
@@ -213,6 +225,13 @@ protected:
 
   void UpdateChildrenMap();
 
+  /// Insert/remove the node among the children of its parent in the index of
+  /// its scene. No-op if the index of the scene has not been built yet.
+  /// Inserting a node that is already in the index moves it at its sorted
+  /// location.
+  void AddToChildrenMap();
+  void RemoveFromChildrenMap();
+
   /// is this a node that's only supposed to have one child?
   int AllowMultipleChildren;
 
@@ -12,13 +12,13 @@ Version:   $Revision: 1.2 $
 
 =========================================================================auto=*/
 
+#include "vtkImageMapToDirectColors.h"
 #include "vtkMRMLLabelMapVolumeDisplayNode.h"
 #include "vtkMRMLProceduralColorNode.h"
 #include "vtkMRMLScene.h"
 
 // VTK includes
 #include <vtkImageData.h>
-#include <vtkImageMapToColors.h>
 #include <vtkLookupTable.h>
 #include <vtkObjectFactory.h>
 
@@ -31,7 +31,7 @@ vtkMRMLNodeNewMacro(vtkMRMLLabelMapVolumeDisplayNode);
 //----------------------------------------------------------------------------
 vtkMRMLLabelMapVolumeDisplayNode::vtkMRMLLabelMapVolumeDisplayNode()
 {
-  this->MapToColors = vtkImageMapToColors::New();
+  this->MapToColors = vtkImageMapToDirectColors::New();
   this->MapToColors->SetOutputFormatToRGBA();
 }
 
@@ -113,6 +113,7 @@ void vtkMRMLLabelMapVolumeDisplayNode::UpdateImageDataPipeline()
       }
     }
   this->MapToColors->SetLookupTable(lookupTable);
+  this->MapToColors->SetColorNode(this->GetColorNode());
   // if there is no point, the mapping will fail (not sure)
   assert(!lookupTable || !vtkLookupTable::SafeDownCast(lookupTable) ||
          vtkLookupTable::SafeDownCast(lookupTable)->GetNumberOfTableValues());
@@ -17,7 +17,7 @@
 
 #include "vtkMRMLVolumeDisplayNode.h"
 
-class vtkImageMapToColors;
+class vtkImageMapToDirectColors;
 
 /// \brief MRML node for representing a volume display attributes.
 ///
@@ -61,7 +61,7 @@ protected:
   vtkMRMLLabelMapVolumeDisplayNode(const vtkMRMLLabelMapVolumeDisplayNode&);
   void operator=(const vtkMRMLLabelMapVolumeDisplayNode&);
 
-  vtkImageMapToColors *MapToColors;
+  vtkImageMapToDirectColors *MapToColors;
 
 };
 
@@ -4,6 +4,7 @@
 // VTK includes
 #include <vtkObjectFactory.h>
 #include <vtkSmartPointer.h>
+#include <vtkXMLDataElement.h>
 #include <vtkXMLDataParser.h>
 
 // MRML includes
@@ -281,7 +282,28 @@ void vtkMRMLLayoutNode::SetAndParseCurrentLayoutDescription(const char* descript
     {
     this->LayoutRootElement->Delete();
     }
-  this->LayoutRootElement = this->ParseLayout(description);
+  std::string descriptionString(description ? description : "");
+  std::map<std::string, vtkSmartPointer<vtkXMLDataElement> >::iterator it =
+    this->ParsedLayouts.find(descriptionString);
+  if (it != this->ParsedLayouts.end())
+    {
+    this->LayoutRootElement = it->second;
+    this->LayoutRootElement->Register(0);
+    }
+  else
+    {
+    this->LayoutRootElement = this->ParseLayout(description);
+    if (this->LayoutRootElement)
+      {
+      // The compare layouts are generated for each number of views, don't
+      // let them accumulate.
+      if (this->ParsedLayouts.size() >= 32)
+        {
+        this->ParsedLayouts.clear();
+        }
+      this->ParsedLayouts[descriptionString] = this->LayoutRootElement;
+      }
+    }
   this->SetCurrentLayoutDescription(description);
 }
 
@@ -4,6 +4,9 @@
 // MRML includes
 #include "vtkMRMLNode.h"
 
+// VTK includes
+#include <vtkSmartPointer.h>
+
 class vtkXMLDataElement;
 
 /// \brief Node that describes the view layout of the application.
@@ -134,7 +137,9 @@ public:
   // correspond while a view is being switched.
   vtkGetStringMacro(CurrentLayoutDescription);
 
-  // Get the XML data model of the CurrentViewDescription
+  // Get the XML data model of the CurrentViewDescription.
+  // It is shared by all the layouts with the same description and must not
+  // be modified.
   vtkGetObjectMacro(LayoutRootElement, vtkXMLDataElement);
 
   // You are responsible to delete the returned dataElement.
@@ -169,6 +174,10 @@ protected:
   std::map<int, std::string> Layouts;
   char*                      CurrentLayoutDescription;
   vtkXMLDataElement*         LayoutRootElement;
+
+  // The descriptions parsed by SetAndParseCurrentLayoutDescription(), so
+  // that switching back to a layout doesn't parse its description again.
+  std::map<std::string, vtkSmartPointer<vtkXMLDataElement> > ParsedLayouts;
 };
 
 #endif
@@ -171,7 +171,10 @@ vtkGeneralTransform* vtkMRMLLinearTransformNode::GetTransformToParent()
 //----------------------------------------------------------------------------
 int  vtkMRMLLinearTransformNode::GetMatrixTransformToWorld(vtkMatrix4x4* transformToWorld)
 {
-  if (this->IsTransformToWorldLinear() != 1) 
+  // the concatenated matrices are cached until a transform of the
+  // hierarchy is modified
+  this->UpdateTransformToWorldCache();
+  if (this->TransformToWorldLinearCache != 1) 
     {
     transformToWorld->Identity();
     return 0;
@@ -179,19 +182,38 @@ int  vtkMRMLLinearTransformNode::GetMatrixTransformToWorld(vtkMatrix4x4* transfo
 
   vtkMatrix4x4 *xform = vtkMatrix4x4::New();
   xform->DeepCopy(transformToWorld);
-  vtkMatrix4x4::Multiply4x4(this->MatrixTransformToParent, xform, transformToWorld);
+  vtkMatrix4x4::Multiply4x4(this->MatrixTransformToWorldCache, xform, transformToWorld);
   xform->Delete();
 
-  vtkMRMLTransformNode *parent = this->GetParentTransformNode();
-  if (parent != NULL) 
+  // TODO: what does this return code mean?
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+unsigned long vtkMRMLLinearTransformNode::GetTransformToParentMTime()
+{
+  // TransformToParent is rebuilt by GetTransformToParent(), only the
+  // matrix makes the transform
+  unsigned long mtime = this->GetMTime();
+  if (this->MatrixTransformToParent &&
+      this->MatrixTransformToParent->GetMTime() > mtime)
     {
-    vtkMRMLLinearTransformNode *lparent = dynamic_cast < vtkMRMLLinearTransformNode* > (parent);
-    if (lparent) 
-      {
-      return (lparent->GetMatrixTransformToWorld(transformToWorld));
-      }
+    mtime = this->MatrixTransformToParent->GetMTime();
+    }
+  return mtime;
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLLinearTransformNode::GetMatrixTransformToParentInternal(vtkMatrix4x4* matrix)
+{
+  if (this->MatrixTransformToParent)
+    {
+    matrix->DeepCopy(this->MatrixTransformToParent);
+    }
+  else
+    {
+    matrix->Identity();
     }
-  // TODO: what does this return code mean?
   return 1;
 }
 
@@ -287,6 +309,8 @@ void vtkMRMLLinearTransformNode::SetAndObserveMatrixTransformToParent(vtkMatrix4
     return;
     }
   vtkSetAndObserveMRMLObjectMacro(this->MatrixTransformToParent, matrix);
+  // the new matrix may be older than the cache
+  this->InvalidateTransformToWorldCache();
   this->Modified();
   this->InvokeEvent(vtkMRMLTransformableNode::TransformModifiedEvent, NULL);
 }
@@ -101,6 +101,10 @@ protected:
   vtkMRMLLinearTransformNode(const vtkMRMLLinearTransformNode&);
   void operator=(const vtkMRMLLinearTransformNode&);
 
+  /// Reimplemented from vtkMRMLTransformNode
+  virtual unsigned long GetTransformToParentMTime();
+  virtual int GetMatrixTransformToParentInternal(vtkMatrix4x4* matrix);
+
   vtkMatrix4x4* MatrixTransformToParent;
 };
 
@@ -14,6 +14,7 @@ Version:   $Revision: 1.3 $
 
 // MRML includes
 #include "vtkEventBroker.h"
+#include "vtkMRMLFreeSurferModelOverlayStorageNode.h"
 #include "vtkMRMLFreeSurferProceduralColorNode.h"
 #include "vtkMRMLModelNode.h"
 #include "vtkMRMLModelDisplayNode.h"
@@ -27,10 +28,12 @@ Version:   $Revision: 1.3 $
 #include <vtkCallbackCommand.h>
 #include <vtkCellData.h>
 #include <vtkColorTransferFunction.h>
+#include <vtkCollection.h>
 #include <vtkFloatArray.h>
 #include <vtkMatrix4x4.h>
 #include <vtkObjectFactory.h>
 #include <vtkPointData.h>
+#include <vtkPolyData.h>
 #include <vtkSmartPointer.h>
 #include <vtkTransformPolyDataFilter.h>
 #include <vtkTrivialProducer.h>
@@ -46,6 +49,7 @@ vtkMRMLNodeNewMacro(vtkMRMLModelNode);
 vtkMRMLModelNode::vtkMRMLModelNode()
 {
   this->PolyData = NULL;
+  this->PolyDataShared = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -66,10 +70,24 @@ void vtkMRMLModelNode::Copy(vtkMRMLNode *anode)
     // of restoring from SceneViews, where the nodes will not 
     // have bulk data.
     this->SetAndObservePolyData(modelNode->GetPolyData());
+    // the polydata is not duplicated, it is shared until one of the
+    // nodes modifies it through GetPolyDataForWrite().
+    this->PolyDataShared = 1;
+    modelNode->PolyDataShared = 1;
     }
   this->EndModify(disabledModify);
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLModelNode::GetDataObjects(vtkCollection* dataObjects)
+{
+  this->Superclass::GetDataObjects(dataObjects);
+  if (this->PolyData)
+    {
+    dataObjects->AddItem(this->PolyData);
+    }
+}
+
 //---------------------------------------------------------------------------
 void vtkMRMLModelNode::ProcessMRMLEvents ( vtkObject *caller,
                                            unsigned long event,
@@ -82,9 +100,47 @@ void vtkMRMLModelNode::ProcessMRMLEvents ( vtkObject *caller,
     {
     this->InvokeEvent(vtkMRMLModelNode::PolyDataModifiedEvent, NULL);
     }
+  if (caller != 0 &&
+      caller == this->GetModelDisplayNode() &&
+      event == vtkCommand::ModifiedEvent)
+    {
+    // The active scalar may have changed
+    this->UpdateDeferredOverlays();
+    }
   this->Superclass::ProcessMRMLEvents(caller, event, callData);
 }
 
+//---------------------------------------------------------------------------
+void vtkMRMLModelNode::UpdateDeferredOverlays()
+{
+  vtkMRMLModelDisplayNode* displayNode = this->GetModelDisplayNode();
+  if (!displayNode || !this->PolyData)
+    {
+    return;
+    }
+  const char* activeScalarName = displayNode->GetActiveScalarName();
+  for (int i = 0; i < this->GetNumberOfStorageNodes(); ++i)
+    {
+    vtkMRMLFreeSurferModelOverlayStorageNode* overlayNode =
+      vtkMRMLFreeSurferModelOverlayStorageNode::SafeDownCast(
+        this->GetNthStorageNode(i));
+    if (!overlayNode || !overlayNode->IsReadDeferred())
+      {
+      continue;
+      }
+    bool active = activeScalarName &&
+      overlayNode->GetScalarName() == activeScalarName;
+    if (active && !overlayNode->GetOverlayLoaded())
+      {
+      overlayNode->LoadOverlay(this);
+      }
+    else if (!active && overlayNode->GetOverlayLoaded())
+      {
+      overlayNode->UnloadOverlay(this);
+      }
+    }
+}
+
 //----------------------------------------------------------------------------
 vtkMRMLModelDisplayNode* vtkMRMLModelNode::GetModelDisplayNode()
 {
@@ -118,6 +174,7 @@ void vtkMRMLModelNode::SetAndObservePolyData(vtkPolyData *polyData)
   vtkPolyData* oldPolyData = this->PolyData;
 
   this->PolyData = polyData;
+  this->PolyDataShared = 0;
 
   if (this->PolyData != NULL)
     {
@@ -139,6 +196,34 @@ void vtkMRMLModelNode::SetAndObservePolyData(vtkPolyData *polyData)
   this->InvokeEvent( vtkMRMLModelNode::PolyDataModifiedEvent , this);
 }
 
+//---------------------------------------------------------------------------
+vtkPolyData* vtkMRMLModelNode::GetPolyDataForWrite()
+{
+  this->DetachPolyData(true);
+  return this->PolyData;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLModelNode::DetachPolyData(bool deepCopy)
+{
+  if (this->PolyData == NULL || !this->PolyDataShared)
+    {
+    return;
+    }
+  vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+  if (deepCopy)
+    {
+    polyData->DeepCopy(this->PolyData);
+    }
+  else
+    {
+    // the point and cell data containers are duplicated, the arrays
+    // and the geometry are still shared.
+    polyData->ShallowCopy(this->PolyData);
+    }
+  this->SetAndObservePolyData(polyData);
+}
+
 //---------------------------------------------------------------------------
 void vtkMRMLModelNode::AddPointScalars(vtkDataArray *array)
 {
@@ -164,6 +249,7 @@ void vtkMRMLModelNode::AddScalars(vtkDataArray *array, int location)
                   << (this->GetName() ? this->GetName() : "no_name"));
     return;
     }
+  this->DetachPolyData(false);
   vtkDataSetAttributes* data =
     (location == vtkAssignAttribute::POINT_DATA ?
      vtkDataSetAttributes::SafeDownCast(this->PolyData->GetPointData()) :
@@ -195,6 +281,7 @@ void vtkMRMLModelNode::RemoveScalars(const char *scalarName)
                   << (this->GetName() ? this->GetName() : "no_name"));
     return;
     }
+  this->DetachPolyData(false);
   // try removing the array from the points first
   if (this->PolyData->GetPointData())
     {
@@ -497,8 +584,10 @@ void vtkMRMLModelNode::ApplyTransform(vtkAbstractTransform* transform)
 
   bool isInPipeline = !vtkTrivialProducer::SafeDownCast(
     this->GetPolyData()->GetProducerPort()->GetProducer());
+  // a polydata shared with a copy of the node must not be overwritten
+  bool newPolyData = isInPipeline || this->PolyDataShared;
   vtkSmartPointer<vtkPolyData> polyData;
-  if (isInPipeline)
+  if (newPolyData)
     {
     polyData = vtkSmartPointer<vtkPolyData>::New();
     }
@@ -507,7 +596,7 @@ void vtkMRMLModelNode::ApplyTransform(vtkAbstractTransform* transform)
     polyData = this->GetPolyData();
     }
   polyData->DeepCopy(transformFilter->GetOutput());
-  if (isInPipeline)
+  if (newPolyData)
     {
     this->SetAndObservePolyData(polyData);
     }
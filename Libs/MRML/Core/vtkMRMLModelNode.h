@@ -54,6 +54,9 @@ public:
   /// Copy the node's attributes to this object
   virtual void Copy(vtkMRMLNode *node);
 
+  /// Add the polydata
+  virtual void GetDataObjects(vtkCollection* dataObjects);
+
   /// alternative method to propagate events generated in Display nodes
   virtual void ProcessMRMLEvents ( vtkObject * /*caller*/,
                                    unsigned long /*event*/,
@@ -66,6 +69,16 @@ public:
   vtkGetObjectMacro(PolyData, vtkPolyData);
   virtual void SetAndObservePolyData(vtkPolyData *PolyData);
 
+  /// Copy() doesn't duplicate the polydata, the copy and the copied node
+  /// share it (copy-on-write). PolyDataShared is set on both nodes until
+  /// a new polydata is set.
+  /// Code that modifies the polydata in place must call
+  /// GetPolyDataForWrite() instead of GetPolyData(): if the polydata is
+  /// shared, it is first replaced by a private deep copy.
+  /// \sa GetPolyData(), Copy()
+  vtkGetMacro(PolyDataShared, int);
+  vtkPolyData* GetPolyDataForWrite();
+
   /// PolyDataModifiedEvent is fired when PolyData is changed.
   /// While it is possible for the subclasses to fire PolyDataModifiedEvent
   /// without modifying the polydata, it is not recommended to do so as it
@@ -198,8 +211,18 @@ protected:
   /// Can be reimplemented if you want to set a different polydata
   virtual void SetPolyDataToDisplayNode(vtkMRMLModelDisplayNode* modelDisplayNode);
 
+  /// Read the deferred scalar overlay that is the active scalar of the
+  /// display node and release the other deferred overlays.
+  /// \sa vtkMRMLFreeSurferModelOverlayStorageNode::SetDeferRead()
+  void UpdateDeferredOverlays();
+
+  /// Replace a shared polydata by a copy owned by this node. A shallow
+  /// copy is enough when only the point/cell data arrays are modified.
+  void DetachPolyData(bool deepCopy);
+
   /// Data
   vtkPolyData *PolyData;
+  int PolyDataShared;
 };
 
 #endif
@@ -20,11 +20,13 @@
 // VTK includes
 #include "vtkBYUReader.h"
 #include "vtkCellArray.h"
+#include "vtkCriticalSection.h"
 #include "vtkDataSetSurfaceFilter.h"
 #include "vtkOBJReader.h"
 #include "vtkObjectFactory.h"
 #include "vtkPLYReader.h"
 #include "vtkPLYWriter.h"
+#include "vtkPolyData.h"
 #include "vtkPolyDataReader.h"
 #include "vtkSTLReader.h"
 #include "vtkSTLWriter.h"
@@ -37,6 +39,9 @@
 #include "vtkXMLPolyDataWriter.h"
 #include "vtksys/SystemTools.hxx"
 
+// STD includes
+#include <map>
+
 // ITK includes
 #include "itkDefaultDynamicMeshTraits.h"
 #include "itkSpatialObjectReader.h"
@@ -65,6 +70,40 @@ typedef itk::MeshSpatialObject<floatMesh> MeshSpatialObjectType;
 typedef itk::SpatialObjectReader<3,vtkFloatingPointType,MeshTrait> MeshReaderType;
 typedef itk::SpatialObjectWriter<3,vtkFloatingPointType,MeshTrait> MeshWriterType;
 
+namespace
+{
+// Polydata read by vtkMRMLModelStorageNode::PreloadFile(), until a storage
+// node reads their file
+struct PreloadedPolyDataType
+{
+  vtkSmartPointer<vtkPolyData> PolyData;
+  long                         ModifiedTime;
+};
+std::map<std::string, PreloadedPolyDataType> PreloadedPolyDatas;
+vtkSimpleCriticalSection PreloadedPolyDataLock;
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> TakePreloadedPolyData(const std::string& fileName)
+{
+  vtkSmartPointer<vtkPolyData> polyData;
+  std::string fullName = vtksys::SystemTools::CollapseFullPath(fileName.c_str());
+  PreloadedPolyDataLock.Lock();
+  std::map<std::string, PreloadedPolyDataType>::iterator it =
+    PreloadedPolyDatas.find(fullName);
+  if (it != PreloadedPolyDatas.end())
+    {
+    // Ignore the preloaded polydata if the file changed since
+    if (it->second.ModifiedTime ==
+        vtksys::SystemTools::ModifiedTime(fullName.c_str()))
+      {
+      polyData = it->second.PolyData;
+      }
+    PreloadedPolyDatas.erase(it);
+    }
+  PreloadedPolyDataLock.Unlock();
+  return polyData;
+}
+}
 
 
 // Initialize static member that controls resampling --
@@ -114,18 +153,51 @@ int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     vtkErrorMacro("ReadDataInternal: model file '" << fullName.c_str() << "' not found.");
     return 0;
     }
-      
-  // compute file prefix
-  std::string name(fullName);
-  std::string::size_type loc = name.find_last_of(".");
+
+  vtkSmartPointer<vtkPolyData> polyData = TakePreloadedPolyData(fullName);
+  int result = 1;
+  if (!polyData)
+    {
+    polyData = vtkSmartPointer<vtkPolyData>::New();
+    result = this->ReadPolyData(fullName, polyData);
+    }
+  else
+    {
+    vtkDebugMacro("ReadDataInternal: " << fullName.c_str() << " was preloaded");
+    }
+  if (result)
+    {
+    modelNode->SetAndObservePolyData(polyData);
+    }
+
+  if (modelNode->GetPolyData() != NULL)
+    {
+    // is there an active scalar array?
+    if (modelNode->GetDisplayNode())
+      {
+      double *scalarRange =  modelNode->GetPolyData()->GetScalarRange();
+      if (scalarRange)
+        {
+        vtkDebugMacro("ReadDataInternal: setting scalar range " << scalarRange[0] << ", " << scalarRange[1]);
+        modelNode->GetDisplayNode()->SetScalarRange(scalarRange);
+        }
+      }
+    //modelNode->GetPolyData()->Modified();
+    }
+  return result;
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLModelStorageNode::ReadPolyData(const std::string& fullName,
+                                          vtkPolyData* polyData)
+{
+  std::string::size_type loc = fullName.find_last_of(".");
   if( loc == std::string::npos )
     {
-    vtkErrorMacro("ReadDataInternal: no file extension specified: " << name.c_str());
+    vtkErrorMacro("ReadPolyData: no file extension specified: " << fullName.c_str());
     return 0;
     }
-  std::string extension = name.substr(loc);
-
-  vtkDebugMacro("ReadDataInternal: extension = " << extension.c_str());
+  std::string extension = fullName.substr(loc);
 
   int result = 1;
   try
@@ -135,7 +207,7 @@ int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
       vtkSmartPointer<vtkBYUReader> reader = vtkSmartPointer<vtkBYUReader>::New();
       reader->SetGeometryFileName(fullName.c_str());
       reader->Update();
-      modelNode->SetAndObservePolyData(reader->GetOutput());
+      polyData->ShallowCopy(reader->GetOutput());
       }
     else if (extension == std::string(".vtk"))
       {
@@ -172,7 +244,7 @@ int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
         }
       else
         {
-        modelNode->SetAndObservePolyData(output);
+        polyData->ShallowCopy(output);
         }
       }
     else if (extension == std::string(".vtp"))
@@ -180,28 +252,28 @@ int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
       vtkSmartPointer<vtkXMLPolyDataReader> reader = vtkSmartPointer<vtkXMLPolyDataReader>::New();
       reader->SetFileName(fullName.c_str());
       reader->Update();
-      modelNode->SetAndObservePolyData(reader->GetOutput());
+      polyData->ShallowCopy(reader->GetOutput());
       }
     else if (extension == std::string(".stl"))
       {
       vtkSmartPointer<vtkSTLReader> reader = vtkSmartPointer<vtkSTLReader>::New();
       reader->SetFileName(fullName.c_str());
-      modelNode->SetAndObservePolyData(reader->GetOutput());
       reader->Update();
+      polyData->ShallowCopy(reader->GetOutput());
       }
     else if (extension == std::string(".ply"))
       {
       vtkSmartPointer<vtkPLYReader> reader = vtkSmartPointer<vtkPLYReader>::New();
       reader->SetFileName(fullName.c_str());
-      modelNode->SetAndObservePolyData(reader->GetOutput());
       reader->Update();
+      polyData->ShallowCopy(reader->GetOutput());
       }
     else if (extension == std::string(".obj"))
       {
       vtkSmartPointer<vtkOBJReader> reader = vtkSmartPointer<vtkOBJReader>::New();
       reader->SetFileName(fullName.c_str());
-      modelNode->SetAndObservePolyData(reader->GetOutput());
       reader->Update();
+      polyData->ShallowCopy(reader->GetOutput());
       }
     else if (extension == std::string(".meta"))  // model in meta format
       {
@@ -262,11 +334,11 @@ int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
 
       vtkMesh->SetPolys ( cells );
 
-      modelNode->SetAndObservePolyData( vtkMesh );
+      polyData->ShallowCopy( vtkMesh );
       }
     else
       {
-      vtkDebugMacro("Cannot read model file '" << name.c_str() << "' (extension = " << extension.c_str() << ")");
+      vtkDebugMacro("Cannot read model file '" << fullName.c_str() << "' (extension = " << extension.c_str() << ")");
       return 0;
       }
     }
@@ -275,21 +347,42 @@ int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     result = 0;
     }
 
-  if (modelNode->GetPolyData() != NULL)
+  return result;
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLModelStorageNode::PreloadFile(const char* fileName)
+{
+  if (!fileName ||
+      !vtksys::SystemTools::FileExists(fileName, true))
     {
-    // is there an active scalar array?
-    if (modelNode->GetDisplayNode())
-      {
-      double *scalarRange =  modelNode->GetPolyData()->GetScalarRange();
-      if (scalarRange)
-        {
-        vtkDebugMacro("ReadDataInternal: setting scalar range " << scalarRange[0] << ", " << scalarRange[1]);
-        modelNode->GetDisplayNode()->SetScalarRange(scalarRange);
-        }
-      }
-    //modelNode->GetPolyData()->Modified();
+    return 0;
     }
-  return result;
+  std::string fullName = vtksys::SystemTools::CollapseFullPath(fileName);
+  long modifiedTime = vtksys::SystemTools::ModifiedTime(fullName.c_str());
+
+  vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+  vtkSmartPointer<vtkMRMLModelStorageNode> reader =
+    vtkSmartPointer<vtkMRMLModelStorageNode>::New();
+  if (!reader->ReadPolyData(fullName, polyData))
+    {
+    return 0;
+    }
+
+  PreloadedPolyDataLock.Lock();
+  PreloadedPolyDataType& preloaded = PreloadedPolyDatas[fullName];
+  preloaded.PolyData = polyData;
+  preloaded.ModifiedTime = modifiedTime;
+  PreloadedPolyDataLock.Unlock();
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLModelStorageNode::ReleasePreloadedFiles()
+{
+  PreloadedPolyDataLock.Lock();
+  PreloadedPolyDatas.clear();
+  PreloadedPolyDataLock.Unlock();
 }
 
 //----------------------------------------------------------------------------
@@ -311,7 +404,9 @@ int vtkMRMLModelStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
     {
     vtkSmartPointer<vtkPolyDataWriter> writer = vtkSmartPointer<vtkPolyDataWriter>::New();
     writer->SetFileName(fullName.c_str());
-    writer->SetFileType(this->GetUseCompression() ? VTK_BINARY : VTK_ASCII );
+    // The legacy format has no compression, binary is always smaller and
+    // faster to read and write than ASCII
+    writer->SetFileType(VTK_BINARY);
     writer->SetInput( modelNode->GetPolyData() );
     try
       {
@@ -328,8 +423,12 @@ int vtkMRMLModelStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
     writer->SetFileName(fullName.c_str());
     writer->SetCompressorType(
       this->GetUseCompression() ? vtkXMLWriter::ZLIB : vtkXMLWriter::NONE);
-    writer->SetDataMode(
-      this->GetUseCompression() ? vtkXMLWriter::Appended : vtkXMLWriter::Ascii);
+    // Raw appended data: no ASCII formatting nor base64 encoding to do when
+    // writing and to parse when reading
+    writer->SetDataModeToAppended();
+    writer->EncodeAppendedDataOff();
+    // Compress by large blocks: less block headers and a better ratio
+    writer->SetBlockSize(1024 * 1024);
     writer->SetInput( modelNode->GetPolyData() );
     try
       {
@@ -17,6 +17,8 @@
 
 #include "vtkMRMLStorageNode.h"
 
+class vtkPolyData;
+
 /// \brief MRML node for model storage on disk.
 ///
 /// Storage nodes has methods to read/write vtkPolyData to/from disk.
@@ -39,6 +41,18 @@ public:
   /// Return true if the reference node can be read in
   virtual bool CanReadInReferenceNode(vtkMRMLNode *refNode);
 
+  /// Read the polydata of \a fileName before a storage node reads it, for
+  /// example from a worker thread while other files are being loaded.
+  /// The next ReadData() of the file then takes the preloaded polydata
+  /// instead of reading the file again. Thread safe.
+  /// Return 0 if the file can't be read.
+  /// \sa ReleasePreloadedFiles()
+  static int PreloadFile(const char* fileName);
+
+  /// Forget the preloaded polydata that no storage node has read.
+  /// \sa PreloadFile()
+  static void ReleasePreloadedFiles();
+
 protected:
   vtkMRMLModelStorageNode();
   ~vtkMRMLModelStorageNode();
@@ -54,6 +68,9 @@ protected:
   /// Read data and set it in the referenced node
   virtual int ReadDataInternal(vtkMRMLNode *refNode);
 
+  /// Read the file \a fullName into \a polyData. Doesn't modify any node.
+  int ReadPolyData(const std::string& fullName, vtkPolyData* polyData);
+
   /// Write data from a  referenced node
   virtual int WriteDataInternal(vtkMRMLNode *refNode);
 
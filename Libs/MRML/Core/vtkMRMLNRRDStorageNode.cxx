@@ -35,6 +35,7 @@ vtkMRMLNodeNewMacro(vtkMRMLNRRDStorageNode);
 vtkMRMLNRRDStorageNode::vtkMRMLNRRDStorageNode()
 {
   this->CenterImage = 0;
+  this->UseMemoryMapping = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -90,6 +91,7 @@ void vtkMRMLNRRDStorageNode::Copy(vtkMRMLNode *anode)
   vtkMRMLNRRDStorageNode *node = (vtkMRMLNRRDStorageNode *) anode;
 
   this->SetCenterImage(node->CenterImage);
+  this->SetUseMemoryMapping(node->UseMemoryMapping);
 
   this->EndModify(disabledModify);
 
@@ -100,6 +102,7 @@ void vtkMRMLNRRDStorageNode::PrintSelf(ostream& os, vtkIndent indent)
 {  
   vtkMRMLStorageNode::PrintSelf(os,indent);
   os << indent << "CenterImage:   " << this->CenterImage << "\n";
+  os << indent << "UseMemoryMapping:   " << this->UseMemoryMapping << "\n";
 }
 
 //----------------------------------------------------------------------------
@@ -157,6 +160,7 @@ int vtkMRMLNRRDStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     {
     reader->SetUseNativeOriginOn();
     }
+  reader->SetUseMemoryMapping(this->UseMemoryMapping);
 
   if (volNode->GetImageData()) 
     {
@@ -360,11 +364,16 @@ int vtkMRMLNRRDStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
     vtkErrorMacro("WriteData: File name not specified");
     return 0;
     }
+  // The data mapped from the file must be in memory before the file is
+  // overwritten
+  vtkNRRDReader::UnmapFile(volNode->GetImageData(), fullName.c_str());
+
   // Use here the NRRD Writer
   vtkSmartPointer<vtkNRRDWriter>writer = vtkSmartPointer<vtkNRRDWriter>::New();
   writer->SetFileName(fullName.c_str());
   writer->SetInput(volNode->GetImageData() );
   writer->SetUseCompression(this->GetUseCompression());
+  writer->SetCompressionLevel(this->GetCompressionLevel());
 
   // set volume attributes
   writer->SetIJKToRASMatrix(ijkToRas);
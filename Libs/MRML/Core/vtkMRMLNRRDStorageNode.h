@@ -53,6 +53,14 @@ class VTK_MRML_EXPORT vtkMRMLNRRDStorageNode : public vtkMRMLStorageNode
   vtkGetMacro(CenterImage, int);
   vtkSetMacro(CenterImage, int);
 
+  ///
+  /// Map uncompressed files in memory instead of reading them.
+  /// The mapped data is copied in memory before the file is overwritten.
+  /// \sa vtkNRRDReader::SetUseMemoryMapping()
+  vtkGetMacro(UseMemoryMapping, int);
+  vtkSetMacro(UseMemoryMapping, int);
+  vtkBooleanMacro(UseMemoryMapping, int);
+
   /// 
   /// Access the nrrd header fields to create a diffusion gradient table
   int ParseDiffusionInformation(vtkNRRDReader *reader,vtkDoubleArray *grad,vtkDoubleArray *bvalues);
@@ -89,6 +97,7 @@ protected:
   virtual int WriteDataInternal(vtkMRMLNode *refNode);
 
   int CenterImage;
+  int UseMemoryMapping;
 
 };
 
@@ -269,7 +269,6 @@ void vtkMRMLNode::PrintSelf(ostream& os, vtkIndent indent)
 
   //print node references
   NodeReferencesType::iterator it;
-  std::map< std::string, std::string>::iterator itName;
   for (it = this->NodeReferences.begin(); it != this->NodeReferences.end(); it++)
     {
     std::string referenceRole = it->first;
@@ -309,23 +308,26 @@ void vtkMRMLNode::ReadXMLAttributes(const char** atts)
     attValue = *(atts++);
 
     // read node refereences
-    std::map< std::string, std::string>::iterator it;
+    // the roles are collected first as adding references may add roles
+    std::vector<std::string> referenceRoles;
+    NodeReferenceMRMLAttributeNamesType::iterator it;
     for (it = this->NodeReferenceMRMLAttributeNames.begin(); it != this->NodeReferenceMRMLAttributeNames.end(); it++)
       {
-      std::string referenceRole = it->first;
-      std::string referenceMRMLAttributeName = it->second;
-
-      if (!strcmp(attName, referenceMRMLAttributeName.c_str() ) )
+      if (it->second == attName)
+        {
+        referenceRoles.push_back(it->first);
+        }
+      }
+    for (unsigned int r = 0; r < referenceRoles.size(); r++)
+      {
+      std::stringstream ss(attValue);
+      while (!ss.eof())
         {
-        std::stringstream ss(attValue);
-        while (!ss.eof())
+        std::string id;
+        ss >> id;
+        if (!id.empty())
           {
-          std::string id;
-          ss >> id;
-          if (!id.empty())
-            {
-            this->AddNodeReferenceID(referenceRole.c_str(), id.c_str());
-            }
+          this->AddNodeReferenceID(referenceRoles[r].c_str(), id.c_str());
           }
         }
       }
@@ -431,7 +433,6 @@ void vtkMRMLNode::WriteXML(ostream& of, int nIndent)
 
   //write node references
   NodeReferencesType::iterator it;
-  std::map< std::string, std::string>::iterator itName;
   for (it = this->NodeReferences.begin(); it != this->NodeReferences.end(); it++)
     {
     std::string referenceRole = it->first;
@@ -468,20 +469,18 @@ void vtkMRMLNode::ProcessMRMLEvents (vtkObject *caller,
                                      void *vtkNotUsed(callData) )
 {
 
-  NodeReferencesType::iterator it;
-  for (it=this->NodeReferences.begin(); it!=this->NodeReferences.end(); it++)
+  // the observers may change the references
+  std::vector<std::string> referenceRoles = this->GetNodeReferenceRoleNames();
+  for (unsigned int r = 0; r < referenceRoles.size(); r++)
     {
-    if (it->first.c_str())
+    const char* referenceRole = referenceRoles[r].c_str();
+    for (int i=0; i<this->GetNumberOfNodeReferences(referenceRole); i++)
       {
-      std::vector< vtkMRMLNodeReference *> references = this->NodeReferences[it->first];
-      for (unsigned int i=0; i<references.size(); i++)
+      vtkMRMLNode *node = this->GetNthNodeReference(referenceRole, i);
+      if (node != NULL && node == vtkMRMLNode::SafeDownCast(caller) &&
+        event ==  vtkCommand::ModifiedEvent)
         {
-        vtkMRMLNode *node = this->GetNthNodeReference(it->first.c_str(), i);
-        if (node != NULL && node == vtkMRMLNode::SafeDownCast(caller) &&
-          event ==  vtkCommand::ModifiedEvent)
-          {
-          this->InvokeEvent(vtkMRMLNode::ReferencedNodeModifiedEvent, node);
-          }
+        this->InvokeEvent(vtkMRMLNode::ReferencedNodeModifiedEvent, node);
         }
       }
     }
@@ -514,8 +513,8 @@ void vtkMRMLNode::AddNodeReferenceRole(const char *referenceRole, const char *mr
 {
   if (referenceRole)
     {
-    this->NodeReferences[std::string(referenceRole)] = std::vector< vtkMRMLNodeReference *>();
-    this->NodeReferenceMRMLAttributeNames[std::string(referenceRole)] = mrmlAttributeName ? 
+    this->NodeReferences[referenceRole] = std::vector< vtkMRMLNodeReference *>();
+    this->NodeReferenceMRMLAttributeNames[referenceRole] = mrmlAttributeName ?
       std::string(mrmlAttributeName) : std::string(referenceRole);
     }
 }
@@ -541,14 +540,15 @@ void vtkMRMLNode::UpdateReferenceID(const char *oldID, const char *newID)
 {
   int wasModifying = this->StartModify();
 
-  NodeReferencesType::iterator it;
-  for (it = this->NodeReferences.begin(); it != this->NodeReferences.end(); it++)
+  std::vector<std::string> referenceRoles = this->GetNodeReferenceRoleNames();
+  for (unsigned int r = 0; r < referenceRoles.size(); r++)
     {
-    for (unsigned int i=0; i<it->second.size(); i++)
+    const char* referenceRole = referenceRoles[r].c_str();
+    for (int i=0; i<this->GetNumberOfNodeReferences(referenceRole); i++)
       {
-      if (std::string(oldID) == std::string( (it->second[i]->GetReferencedNodeID()) ) )
+      if (std::string(oldID) == std::string(this->GetNthNodeReferenceID(referenceRole, i)))
         {
-        this->SetAndObserveNthNodeReferenceID(it->second[i]->GetReferenceRole(), i, newID);
+        this->SetAndObserveNthNodeReferenceID(referenceRole, i, newID);
         }
       }
     }
@@ -569,11 +569,11 @@ void vtkMRMLNode::SetAttribute(const char* name, const char* value)
     }
   if (value != 0)
     {
-    this->Attributes[std::string(name)] = std::string(value);
+    this->Attributes[name] = std::string(value);
     }
   else
     {
-    this->Attributes.erase(std::string(name));
+    this->Attributes.erase(name);
     }
   this->Modified();
 }
@@ -593,7 +593,7 @@ const char* vtkMRMLNode::GetAttribute(const char* name)
     return NULL;
     }
   AttributesType::const_iterator iter =
-    this->Attributes.find(std::string(name));
+    this->Attributes.find(name);
   if (iter == Attributes.end()) 
     {
     return NULL;
@@ -678,6 +678,34 @@ void vtkMRMLNode::SetID (const char* _arg)
   this->Modified();
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLNode::SetName(const char* _arg)
+{
+  // Mostly copied from vtkSetStringMacro() in vtkSetGet.cxx
+  vtkDebugMacro(<< this->GetClassName() << " (" << this << "): setting Name to " << (_arg?_arg:"(null)") );
+  if ( this->Name == NULL && _arg == NULL) { return;}
+  if ( this->Name && _arg && (!strcmp(this->Name,_arg))) { return;}
+  char* oldName = this->Name;
+  if (_arg)
+    {
+    size_t n = strlen(_arg) + 1;
+    char *cp1 =  new char[n];
+    const char *cp2 = (_arg);
+    this->Name = cp1;
+    do { *cp1++ = *cp2++; } while ( --n );
+    }
+   else
+    {
+    this->Name = NULL;
+    }
+  if (this->Scene)
+    {
+    this->Scene->NodeNameChanged(this, oldName);
+    }
+  if (oldName) { delete [] oldName; }
+  this->Modified();
+}
+
 //----------------------------------------------------------------------------
 const char * vtkMRMLNode::URLEncodeString(const char *inString)
 {
@@ -761,16 +789,18 @@ const char * vtkMRMLNode::URLDecodeString(const char *inString)
 //-----------------------------------------------------------
 void vtkMRMLNode::UpdateReferences()
 {
-  NodeReferencesType::iterator it;
-  for (it = this->NodeReferences.begin(); it != this->NodeReferences.end(); it++)
+  std::vector<std::string> referenceRoles = this->GetNodeReferenceRoleNames();
+  for (unsigned int r = 0; r < referenceRoles.size(); r++)
     {
-    for (unsigned int i=0; i<it->second.size();)
+    const char* referenceRole = referenceRoles[r].c_str();
+    for (int i=0; i<this->GetNumberOfNodeReferences(referenceRole);)
       {
-      if (it->second[i]->GetReferencedNodeID() &&
-          std::string(it->second[i]->GetReferencedNodeID()) != "" &&
-          this->Scene->GetNodeByID(it->second[i]->GetReferencedNodeID()) == NULL)
+      const char* referencedNodeID = this->GetNthNodeReferenceID(referenceRole, i);
+      if (referencedNodeID &&
+          std::string(referencedNodeID) != "" &&
+          this->Scene->GetNodeByID(referencedNodeID) == NULL)
         {
-        this->RemoveNthNodeReferenceID(it->second[i]->GetReferenceRole(), i);
+        this->RemoveNthNodeReferenceID(referenceRole, i);
         }
       else
         {
@@ -785,13 +815,10 @@ void vtkMRMLNode::RemoveAllNodeReferenceIDs(const char* referenceRole)
 {
   if (!referenceRole)
     {
-    NodeReferencesType::iterator it;
-    for (it=this->NodeReferences.begin(); it!=this->NodeReferences.end(); it++)
+    std::vector<std::string> referenceRoles = this->GetNodeReferenceRoleNames();
+    for (unsigned int r = 0; r < referenceRoles.size(); r++)
       {
-      if (it->first.c_str())
-        {
-        this->RemoveAllNodeReferenceIDs(it->first.c_str());
-        }
+      this->RemoveAllNodeReferenceIDs(referenceRoles[r].c_str());
       }
     return;
     }
@@ -810,7 +837,12 @@ void vtkMRMLNode::GetNodeReferences(const char* referenceRole, std::vector<vtkMR
   if (referenceRole)
     {
     this->UpdateNodeReferences(referenceRole);
-    std::vector< vtkMRMLNodeReference *> &references = this->NodeReferences[std::string(referenceRole)];
+    NodeReferencesType::iterator it = this->NodeReferences.find(referenceRole);
+    if (it == this->NodeReferences.end())
+      {
+      return;
+      }
+    std::vector< vtkMRMLNodeReference *> &references = it->second;
     for (unsigned int i=0; i<references.size(); i++)
       {
         nodes.push_back(references[i]->ReferencedNode);
@@ -825,15 +857,15 @@ const char * vtkMRMLNode::GetNthNodeReferenceID(const char* referenceRole, int n
     {
     return NULL;
     }
-  
-  std::vector< vtkMRMLNodeReference *> &references = this->NodeReferences[std::string(referenceRole)];
 
-  if (n >= static_cast<int>(references.size()) )
+  NodeReferencesType::iterator it = this->NodeReferences.find(referenceRole);
+  if (it == this->NodeReferences.end() ||
+      n >= static_cast<int>(it->second.size()) )
     {
     return NULL;
     }
 
-  return references[n]->GetReferencedNodeID();
+  return it->second[n]->GetReferencedNodeID();
 }
 
 //----------------------------------------------------------------------------
@@ -844,24 +876,24 @@ vtkMRMLNode* vtkMRMLNode::GetNthNodeReference(const char* referenceRole, int n)
     {
     return NULL;
     }
-  
-  std::vector< vtkMRMLNodeReference *> &references = this->NodeReferences[std::string(referenceRole)];
 
-  if (n >= static_cast<int>(references.size()) )
+  NodeReferencesType::iterator it = this->NodeReferences.find(referenceRole);
+  if (it == this->NodeReferences.end() ||
+      n >= static_cast<int>(it->second.size()) )
     {
     return NULL;
     }
 
-  vtkMRMLNode* node = references[n]->ReferencedNode;
+  vtkMRMLNodeReference* reference = it->second[n];
+  vtkMRMLNode* node = reference->ReferencedNode;
   // Maybe the node was not yet in the scene when the node ID was set.
   // Check to see if it's now there.
   // Similarly, if the scene is 0, clear the node if not already null.
   if ((!node || node->GetScene() != this->GetScene()) ||
       (node && this->GetScene() == 0))
     {
-    this->UpdateNthNodeReference(referenceRole, n);
-    std::vector< vtkMRMLNodeReference *> &references = this->NodeReferences[std::string(referenceRole)];
-    node = references[n]->ReferencedNode;
+    this->UpdateNthNodeReference(reference, n);
+    node = reference->ReferencedNode;
     }
   return node;
 }
@@ -869,13 +901,10 @@ vtkMRMLNode* vtkMRMLNode::GetNthNodeReference(const char* referenceRole, int n)
 //-----------------------------------------------------------
 void vtkMRMLNode::UpdateNodeReferences()
 {
-  NodeReferencesType::iterator it;
-  for (it=this->NodeReferences.begin(); it!=this->NodeReferences.end(); it++)
+  std::vector<std::string> referenceRoles = this->GetNodeReferenceRoleNames();
+  for (unsigned int r = 0; r < referenceRoles.size(); r++)
     {
-    if (it->first.c_str())
-      {
-      this->UpdateNodeReferences(it->first.c_str());
-      }
+    this->UpdateNodeReferences(referenceRoles[r].c_str());
     }
   return;
 }
@@ -890,8 +919,7 @@ void vtkMRMLNode::UpdateNodeReferences(const char* referenceRole)
 
   int wasModifying = this->StartModify();
 
-  std::vector< vtkMRMLNodeReference *> &references = this->NodeReferences[std::string(referenceRole)];
-  for (unsigned int i=0; i<references.size(); i++)
+  for (int i=0; i<this->GetNumberOfNodeReferences(referenceRole); i++)
     {
     this->UpdateNthNodeReference(referenceRole, i);
     }
@@ -924,11 +952,15 @@ void vtkMRMLNode::UpdateNthNodeReference(const char* referenceRole, int n)
     return;
     }
 
-  std::vector< vtkMRMLNodeReference *> &references = this->NodeReferences[std::string(referenceRole)];
+  NodeReferencesType::iterator it = this->NodeReferences.find(referenceRole);
+  if (it == this->NodeReferences.end())
+    {
+    return;
+    }
 
-  assert( references.size() > (unsigned int)(n));
+  assert( it->second.size() > (unsigned int)(n));
 
-  this->UpdateNthNodeReference(references[n], n);
+  this->UpdateNthNodeReference(it->second[n], n);
 }
 
 
@@ -940,7 +972,11 @@ void vtkMRMLNode::UpdateNthNodeReference(const char* referenceRole, int n)
   std::vector< vtkMRMLNodeReference *> referencedNodes;
   if (referenceRole)
     {
-    referencedNodes = this->NodeReferences[std::string(referenceRole)];
+    NodeReferencesType::iterator it = this->NodeReferences.find(referenceRole);
+    if (it != this->NodeReferences.end())
+      {
+      referencedNodes = it->second;
+      }
     }
   else
     {
@@ -968,7 +1004,7 @@ void vtkMRMLNode::UpdateNthNodeReference(const char* referenceRole, int n)
     referencedNode->SetReferenceRole(referenceRole);
     referencedNodes.push_back(referencedNode);
     n = referencedNodes.size() - 1;
-    this->NodeReferences[std::string(referenceRole)] = referencedNodes;
+    this->NodeReferences[referenceRole] = referencedNodes;
     }
 
   std::vector< vtkMRMLNodeReference *>::iterator referencedNodesIt = 
@@ -1007,7 +1043,7 @@ void vtkMRMLNode::UpdateNthNodeReference(const char* referenceRole, int n)
     this->OnNodeReferenceRemoved(*referencedNodesIt);
     referencedNode->UnRegister(this);
     referencedNodes.erase(referencedNodesIt);
-    this->NodeReferences[std::string(referenceRole)] = referencedNodes;
+    this->NodeReferences[referenceRole] = referencedNodes;
     }
   else
     {
@@ -1050,7 +1086,11 @@ void vtkMRMLNode::UpdateNthNodeReference(const char* referenceRole, int n)
   std::vector< vtkMRMLNodeReference *> referencedNodes;
   if (referenceRole)
     {
-    referencedNodes = this->NodeReferences[std::string(referenceRole)];
+    NodeReferencesType::iterator it = this->NodeReferences.find(referenceRole);
+    if (it != this->NodeReferences.end())
+      {
+      referencedNodes = it->second;
+      }
     }
   else
     {
@@ -1083,7 +1123,7 @@ void vtkMRMLNode::UpdateNthNodeReference(const char* referenceRole, int n)
     }
     referencedNodes.push_back(reference);
     n = referencedNodes.size() - 1;
-    this->NodeReferences[std::string(referenceRole)] = referencedNodes;
+    this->NodeReferences[referenceRole] = referencedNodes;
 
     }
 
@@ -1121,7 +1161,7 @@ void vtkMRMLNode::UpdateNthNodeReference(const char* referenceRole, int n)
     this->SetAndObserveNthNodeReference(referenceRole, n, 0, (*referencedNodesIt)->Events);
     vtkMRMLNodeReference *tmp = (*referencedNodesIt);
     referencedNodes.erase(referencedNodesIt);
-    this->NodeReferences[std::string(referenceRole)] = referencedNodes;
+    this->NodeReferences[referenceRole] = referencedNodes;
     tmp->Delete();
     }
   else
@@ -1166,31 +1206,33 @@ void vtkMRMLNode::UpdateNthNodeReference(const char* referenceRole, int n)
  //----------------------------------------------------------------------------
 void vtkMRMLNode::SetAndObserveNthNodeReference(const char* referenceRole, int n, vtkMRMLNode *referencedNode, vtkIntArray *events)
 {
-  std::vector< vtkMRMLNodeReference *> &references = this->NodeReferences[std::string(referenceRole)];
-    
-  
-  vtkMRMLNode *oldReferencedNode = references[n]->ReferencedNode;
+  NodeReferencesType::iterator it = this->NodeReferences.find(referenceRole);
+  assert(it != this->NodeReferences.end());
+  // the reference outlives the callbacks, the vector holding it may not
+  vtkMRMLNodeReference *reference = it->second[n];
+
+  vtkMRMLNode *oldReferencedNode = reference->ReferencedNode;
 
   if (events)
     {
-    vtkSetAndObserveMRMLObjectEventsMacro(references[n]->ReferencedNode, referencedNode, events);
+    vtkSetAndObserveMRMLObjectEventsMacro(reference->ReferencedNode, referencedNode, events);
     }
   else
     {
-    vtkSetAndObserveMRMLObjectMacro(references[n]->ReferencedNode, referencedNode);
+    vtkSetAndObserveMRMLObjectMacro(reference->ReferencedNode, referencedNode);
     }
 
   if (oldReferencedNode != 0 && referencedNode == 0)
     {
-    this->OnNodeReferenceRemoved(references[n]);
+    this->OnNodeReferenceRemoved(reference);
     }
   else if (oldReferencedNode == 0 && referencedNode != 0)
     {
-    this->OnNodeReferenceAdded(references[n]);
+    this->OnNodeReferenceAdded(reference);
     }
   else if (oldReferencedNode != referencedNode)
     {
-    this->OnNodeReferenceModified(references[n]);
+    this->OnNodeReferenceModified(reference);
     }
 }
 
@@ -1203,7 +1245,12 @@ bool vtkMRMLNode::HasNodeReferenceID(const char* referenceRole, const char* Node
     return false;
     }
 
-  std::vector< vtkMRMLNodeReference *> &references = this->NodeReferences[std::string(referenceRole)];
+  NodeReferencesType::iterator roleIt = this->NodeReferences.find(referenceRole);
+  if (roleIt == this->NodeReferences.end())
+    {
+    return false;
+    }
+  std::vector< vtkMRMLNodeReference *> &references = roleIt->second;
   std::vector< vtkMRMLNodeReference *>::iterator it;
   std::string sID(NodeReferenceID);
   for (it=references.begin(); it!=references.end(); it++)
@@ -1216,6 +1263,44 @@ bool vtkMRMLNode::HasNodeReferenceID(const char* referenceRole, const char* Node
   return false;
 }
 
+//----------------------------------------------------------------------------
+std::vector<std::string> vtkMRMLNode::GetNodeReferenceRoleNames()const
+{
+  std::vector<std::string> roles;
+  roles.reserve(this->NodeReferences.size());
+  NodeReferencesType::const_iterator it;
+  for (it = this->NodeReferences.begin(); it != this->NodeReferences.end(); it++)
+    {
+    roles.push_back(it->first);
+    }
+  return roles;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLNode::GetNodeReferenceRoles(const char* referencedNodeID,
+                                        std::vector<std::string> &roles)
+{
+  roles.clear();
+  if (referencedNodeID == 0)
+    {
+    return;
+    }
+  NodeReferencesType::iterator it;
+  for (it = this->NodeReferences.begin(); it != this->NodeReferences.end(); it++)
+    {
+    std::vector< vtkMRMLNodeReference *>::iterator it1;
+    for (it1 = it->second.begin(); it1 != it->second.end(); it1++)
+      {
+      const char* id = (*it1)->GetReferencedNodeID();
+      if (id && !strcmp(id, referencedNodeID))
+        {
+        roles.push_back(it->first);
+        break;
+        }
+      }
+    }
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLNode::RemoveAllReferencedNodes()
 {
@@ -1291,7 +1376,11 @@ int vtkMRMLNode::GetNumberOfNodeReferences(const char* referenceRole)
   int n=0;
   if (referenceRole)
     {
-    n = static_cast<int>(this->NodeReferences[std::string(referenceRole)].size());
+    NodeReferencesType::iterator it = this->NodeReferences.find(referenceRole);
+    if (it != this->NodeReferences.end())
+      {
+      n = static_cast<int>(it->second.size());
+      }
     }
   return n;
 }
@@ -17,6 +17,7 @@
 
 // MRML includes
 #include "vtkMRML.h"
+#include "vtkMRMLStringMap.h"
 #include "vtkObserverManager.h"
 #include "vtkIdTypeArray.h"
 #include "vtkIntArray.h"
@@ -27,6 +28,7 @@ class vtkMRMLScene;
 // VTK includes
 #include <vtkObject.h>
 class vtkCallbackCommand;
+class vtkCollection;
 
 // STD includes
 #include <string>
@@ -169,6 +171,13 @@ public:
     this->UpdateNodeReferences();
   };
 
+  ///
+  /// Add to dataObjects the bulk data (image data, polydata...) held by the
+  /// node. It is used to account the memory used by the scene.
+  /// Subclasses holding bulk data must reimplement it and call the superclass.
+  /// \sa vtkMRMLScene::GetNodeOwnedMemorySize()
+  virtual void GetDataObjects(vtkCollection* vtkNotUsed(dataObjects)){};
+
   /// 
   /// Write this node's information to a MRML file in XML format.
   /// NOTE: Subclasses should implement this method
@@ -245,7 +254,8 @@ public:
 
   /// 
   /// Get value of a name value pair attribute
-  /// or NULL if the name does not exists
+  /// or NULL if the name does not exists.
+  /// The returned string is valid until the attributes of the node change.
   const char* GetAttribute(const char* name);
 
   /// 
@@ -289,7 +299,10 @@ public:
   
   /// 
   /// Name of this node, to be set by the user
-  vtkSetStringMacro(Name);
+  /// The scene of the node is told about the new name so that it can keep
+  /// its name counts up to date.
+  /// \sa vtkMRMLScene::GenerateUniqueName
+  virtual void SetName(const char* name);
   vtkGetStringMacro(Name);
   
   
@@ -543,6 +556,14 @@ public:
   /// \sa GetNthNodeReference
   void GetNodeReferences(const char* referenceRole, std::vector<vtkMRMLNode*> &nodes);
 
+  ///
+  /// Return the reference roles through which this node references the
+  /// node with ID \a referencedNodeID. References that are not managed
+  /// with reference roles (e.g. custom attributes handled in
+  /// UpdateReferenceID()) are not listed.
+  /// \sa vtkMRMLScene::GetReferenceGraph()
+  void GetNodeReferenceRoles(const char* referencedNodeID, std::vector<std::string> &roles);
+
   /// HierarchyModifiedEvent is generated when the hierarchy node with which
   /// this node is associated changes
   enum
@@ -605,10 +626,11 @@ protected:
   /// NodeReferences maps stores vector of refererences for each referenceRole, 
   /// the referenceRole can be any unique string, for example "display", "transform" etc.
   /// use AddNodeReferenceType() to add new reference types to a node
-  typedef std::map< std::string, std::vector< vtkMRMLNodeReference *> > NodeReferencesType;
+  typedef vtkMRMLStringMap< std::vector< vtkMRMLNodeReference *> > NodeReferencesType;
   NodeReferencesType NodeReferences;
 
-  std::map< std::string, std::string> NodeReferenceMRMLAttributeNames;
+  typedef vtkMRMLStringMap< std::string > NodeReferenceMRMLAttributeNamesType;
+  NodeReferenceMRMLAttributeNamesType NodeReferenceMRMLAttributeNames;
 
 protected:
   
@@ -647,7 +669,7 @@ protected:
 
   vtkMRMLScene *Scene;
 
-  typedef std::map< std::string, std::string > AttributesType;
+  typedef vtkMRMLStringMap< std::string > AttributesType;
   AttributesType Attributes;
 
   vtkObserverManager *MRMLObserverManager;
@@ -674,6 +696,10 @@ protected:
 
   void SetAndObserveNthNodeReference(const char* referenceRole, int n, vtkMRMLNode *referencedNode, vtkIntArray *events=0);
 
+  /// Return the reference roles of the node. The roles are copied so that
+  /// the references may be modified while iterating over them.
+  std::vector<std::string> GetNodeReferenceRoleNames()const;
+
   /// Delete all internal references
   void DeleteAllReferences(bool callOnNodeReferenceRemoved=true);
 
@@ -24,7 +24,243 @@ Version:   $Revision: 1.8 $
 #include <vtkStdString.h>
 
 // STD includes
+#include <cstring>
+#include <fstream>
+#include <map>
 #include <sstream>
+#include <vector>
+
+namespace
+{
+
+const char BinarySceneMagic[8] = {'M','R','M','L','B','I','N','\0'};
+
+//------------------------------------------------------------------------------
+void WriteUInt32(std::ostream& os, unsigned int value)
+{
+  char bytes[4];
+  bytes[0] = static_cast<char>(value & 0xff);
+  bytes[1] = static_cast<char>((value >> 8) & 0xff);
+  bytes[2] = static_cast<char>((value >> 16) & 0xff);
+  bytes[3] = static_cast<char>((value >> 24) & 0xff);
+  os.write(bytes, 4);
+}
+
+//------------------------------------------------------------------------------
+bool ReadUInt32(const char*& it, const char* end, unsigned int& value)
+{
+  if (end - it < 4)
+    {
+    return false;
+    }
+  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(it);
+  value = static_cast<unsigned int>(bytes[0]) |
+    (static_cast<unsigned int>(bytes[1]) << 8) |
+    (static_cast<unsigned int>(bytes[2]) << 16) |
+    (static_cast<unsigned int>(bytes[3]) << 24);
+  it += 4;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool ReadString(const char*& it, const char* end, std::string& value)
+{
+  unsigned int length = 0;
+  if (!ReadUInt32(it, end, length) ||
+      static_cast<unsigned long>(end - it) < length)
+    {
+    return false;
+    }
+  value.assign(it, length);
+  it += length;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+/// Write the element records, tag and attribute names are interned in a
+/// string table that is written before the records.
+class BinarySceneRecords
+{
+public:
+  unsigned int Intern(const std::string& str)
+  {
+    std::map<std::string, unsigned int>::const_iterator it = this->Indexes.find(str);
+    if (it != this->Indexes.end())
+      {
+      return it->second;
+      }
+    unsigned int index = static_cast<unsigned int>(this->Strings.size());
+    this->Strings.push_back(str);
+    this->Indexes[str] = index;
+    return index;
+  }
+
+  void StartElement(const char* tagName,
+                    const std::vector<std::pair<std::string, std::string> >& atts)
+  {
+    this->Records.put('S');
+    WriteUInt32(this->Records, this->Intern(tagName));
+    WriteUInt32(this->Records, static_cast<unsigned int>(atts.size()));
+    std::vector<std::pair<std::string, std::string> >::const_iterator it;
+    for (it = atts.begin(); it != atts.end(); ++it)
+      {
+      WriteUInt32(this->Records, this->Intern(it->first));
+      WriteUInt32(this->Records, static_cast<unsigned int>(it->second.size()));
+      this->Records.write(it->second.c_str(), it->second.size());
+      }
+  }
+
+  void EndElement(const char* tagName)
+  {
+    this->Records.put('E');
+    WriteUInt32(this->Records, this->Intern(tagName));
+  }
+
+  void Write(std::ostream& os)
+  {
+    os.write(BinarySceneMagic, sizeof(BinarySceneMagic));
+    WriteUInt32(os, vtkMRMLParser::BinarySceneFormatVersion);
+    WriteUInt32(os, static_cast<unsigned int>(this->Strings.size()));
+    std::vector<std::string>::const_iterator it;
+    for (it = this->Strings.begin(); it != this->Strings.end(); ++it)
+      {
+      WriteUInt32(os, static_cast<unsigned int>(it->size()));
+      os.write(it->c_str(), it->size());
+      }
+    std::string records = this->Records.str();
+    os.write(records.c_str(), records.size());
+  }
+
+protected:
+  std::vector<std::string> Strings;
+  std::map<std::string, unsigned int> Indexes;
+  std::stringstream Records;
+};
+
+//------------------------------------------------------------------------------
+std::string DecodeXMLEntities(const std::string& value)
+{
+  if (value.find('&') == std::string::npos)
+    {
+    return value;
+    }
+  std::string decoded;
+  decoded.reserve(value.size());
+  for (std::string::size_type i = 0; i < value.size(); ++i)
+    {
+    if (value[i] == '&')
+      {
+      static const char* entities[5][2] = {
+        {"&amp;", "&"}, {"&lt;", "<"}, {"&gt;", ">"},
+        {"&quot;", "\""}, {"&apos;", "'"}};
+      bool found = false;
+      for (int e = 0; e < 5 && !found; ++e)
+        {
+        std::string entity(entities[e][0]);
+        if (value.compare(i, entity.size(), entity) == 0)
+          {
+          decoded += entities[e][1];
+          i += entity.size() - 1;
+          found = true;
+          }
+        }
+      if (found)
+        {
+        continue;
+        }
+      }
+    decoded += value[i];
+    }
+  return decoded;
+}
+
+//------------------------------------------------------------------------------
+/// Split the ' name="value"' pairs written by vtkMRMLNode::WriteXML().
+void SplitXMLAttributes(const std::string& xml,
+                        std::vector<std::pair<std::string, std::string> >& atts)
+{
+  std::string::size_type pos = 0;
+  while (true)
+    {
+    std::string::size_type nameStart = xml.find_first_not_of(" \t\r\n", pos);
+    if (nameStart == std::string::npos)
+      {
+      break;
+      }
+    std::string::size_type equal = xml.find('=', nameStart);
+    if (equal == std::string::npos)
+      {
+      break;
+      }
+    std::string::size_type valueStart = xml.find('"', equal);
+    if (valueStart == std::string::npos)
+      {
+      break;
+      }
+    std::string::size_type valueEnd = xml.find('"', valueStart + 1);
+    if (valueEnd == std::string::npos)
+      {
+      break;
+      }
+    std::string name = xml.substr(nameStart, equal - nameStart);
+    std::string::size_type nameEnd = name.find_last_not_of(" \t\r\n");
+    name.erase(nameEnd == std::string::npos ? 0 : nameEnd + 1);
+    atts.push_back(std::make_pair(name, DecodeXMLEntities(
+      xml.substr(valueStart + 1, valueEnd - valueStart - 1))));
+    pos = valueEnd + 1;
+    }
+}
+
+//------------------------------------------------------------------------------
+/// Convert the XML body of a node (e.g. the nodes of a scene view) into
+/// binary element records.
+class vtkMRMLParserBodyConverter : public vtkXMLParser
+{
+public:
+  static vtkMRMLParserBodyConverter *New();
+  vtkTypeMacro(vtkMRMLParserBodyConverter,vtkXMLParser);
+
+  BinarySceneRecords* Records;
+  int Depth;
+
+protected:
+  vtkMRMLParserBodyConverter() : Records(NULL), Depth(0) {};
+  ~vtkMRMLParserBodyConverter() {};
+
+  virtual void StartElement(const char* name, const char** atts)
+  {
+    // skip the wrapping element
+    if (this->Depth++ == 0)
+      {
+      return;
+      }
+    std::vector<std::pair<std::string, std::string> > attributes;
+    while (*atts != NULL)
+      {
+      const char* attName = *(atts++);
+      const char* attValue = *(atts++);
+      attributes.push_back(std::make_pair(std::string(attName), std::string(attValue)));
+      }
+    this->Records->StartElement(name, attributes);
+  }
+
+  virtual void EndElement(const char* name)
+  {
+    if (--this->Depth == 0)
+      {
+      return;
+      }
+    this->Records->EndElement(name);
+  }
+
+private:
+  vtkMRMLParserBodyConverter(const vtkMRMLParserBodyConverter&);
+  void operator=(const vtkMRMLParserBodyConverter&);
+};
+
+vtkStandardNewMacro(vtkMRMLParserBodyConverter);
+
+} // end of anonymous namespace
 
 //------------------------------------------------------------------------------
 vtkStandardNewMacro(vtkMRMLParser);
@@ -178,3 +414,203 @@ void vtkMRMLParser::EndElement (const char *name)
 
   this->NodeStack.pop();
 }
+
+//-----------------------------------------------------------------------------
+bool vtkMRMLParser::IsBinaryScene(const char* buffer, size_t length)
+{
+  return buffer != NULL && length >= sizeof(BinarySceneMagic) &&
+    memcmp(buffer, BinarySceneMagic, sizeof(BinarySceneMagic)) == 0;
+}
+
+//-----------------------------------------------------------------------------
+bool vtkMRMLParser::IsBinarySceneFile(const char* fileName)
+{
+  if (fileName == NULL)
+    {
+    return false;
+    }
+  std::ifstream ifs(fileName, std::ios::in | std::ios::binary);
+  char header[sizeof(BinarySceneMagic)];
+  if (!ifs.read(header, sizeof(header)))
+    {
+    return false;
+    }
+  return vtkMRMLParser::IsBinaryScene(header, sizeof(header));
+}
+
+//-----------------------------------------------------------------------------
+int vtkMRMLParser::ParseBinaryFile()
+{
+  if (this->GetFileName() == NULL)
+    {
+    vtkErrorMacro("ParseBinaryFile: FileName is not set");
+    return 0;
+    }
+  std::ifstream ifs(this->GetFileName(), std::ios::in | std::ios::binary);
+  if (ifs.fail())
+    {
+    vtkErrorMacro("ParseBinaryFile: Could not open file " << this->GetFileName());
+    return 0;
+    }
+  std::stringstream buffer;
+  buffer << ifs.rdbuf();
+  std::string contents = buffer.str();
+  return this->ParseBinary(contents.c_str(), contents.size());
+}
+
+//-----------------------------------------------------------------------------
+int vtkMRMLParser::ParseBinary(const char* buffer, size_t length)
+{
+  if (!vtkMRMLParser::IsBinaryScene(buffer, length))
+    {
+    vtkErrorMacro("ParseBinary: not a binary scene");
+    return 0;
+    }
+  const char* it = buffer + sizeof(BinarySceneMagic);
+  const char* end = buffer + length;
+
+  unsigned int version = 0;
+  if (!ReadUInt32(it, end, version) ||
+      version > vtkMRMLParser::BinarySceneFormatVersion)
+    {
+    vtkErrorMacro("ParseBinary: unsupported binary scene version " << version);
+    return 0;
+    }
+
+  unsigned int numberOfStrings = 0;
+  if (!ReadUInt32(it, end, numberOfStrings))
+    {
+    vtkErrorMacro("ParseBinary: truncated string table");
+    return 0;
+    }
+  std::vector<std::string> strings(numberOfStrings);
+  for (unsigned int i = 0; i < numberOfStrings; ++i)
+    {
+    if (!ReadString(it, end, strings[i]))
+      {
+      vtkErrorMacro("ParseBinary: truncated string table");
+      return 0;
+      }
+    }
+
+  std::vector<std::string> values;
+  std::vector<const char*> atts;
+  while (it < end)
+    {
+    char kind = *(it++);
+    unsigned int tagIndex = 0;
+    if (!ReadUInt32(it, end, tagIndex) || tagIndex >= strings.size())
+      {
+      vtkErrorMacro("ParseBinary: invalid element record");
+      return 0;
+      }
+    if (kind == 'E')
+      {
+      this->EndElement(strings[tagIndex].c_str());
+      continue;
+      }
+    if (kind != 'S')
+      {
+      vtkErrorMacro("ParseBinary: invalid element record");
+      return 0;
+      }
+    unsigned int numberOfAttributes = 0;
+    if (!ReadUInt32(it, end, numberOfAttributes))
+      {
+      vtkErrorMacro("ParseBinary: invalid element record");
+      return 0;
+      }
+    values.resize(numberOfAttributes);
+    atts.clear();
+    for (unsigned int i = 0; i < numberOfAttributes; ++i)
+      {
+      unsigned int nameIndex = 0;
+      if (!ReadUInt32(it, end, nameIndex) || nameIndex >= strings.size() ||
+          !ReadString(it, end, values[i]))
+        {
+        vtkErrorMacro("ParseBinary: invalid attribute record");
+        return 0;
+        }
+      atts.push_back(strings[nameIndex].c_str());
+      atts.push_back(values[i].c_str());
+      }
+    atts.push_back(NULL);
+    this->StartElement(strings[tagIndex].c_str(), &atts[0]);
+    }
+  return 1;
+}
+
+//-----------------------------------------------------------------------------
+int vtkMRMLParser::WriteBinaryScene(vtkMRMLScene* scene, ostream& os)
+{
+  if (scene == NULL)
+    {
+    return 0;
+    }
+  BinarySceneRecords records;
+
+  std::vector<std::pair<std::string, std::string> > atts;
+  if (scene->GetVersion())
+    {
+    atts.push_back(std::make_pair(std::string("version"),
+                                  std::string(scene->GetVersion())));
+    }
+  if (scene->GetUserTagTable() != NULL)
+    {
+    std::stringstream ss;
+    int numc = scene->GetUserTagTable()->GetNumberOfTags();
+    for (int i=0; i < numc; i++ )
+      {
+      const char* kwd = scene->GetUserTagTable()->GetTagAttribute(i);
+      const char* val = scene->GetUserTagTable()->GetTagValue(i);
+      if (kwd != NULL && val != NULL)
+        {
+        ss << kwd << "=" << val;
+        if ( i < (numc-1) )
+          {
+          ss << " ";
+          }
+        }
+      }
+    atts.push_back(std::make_pair(std::string("userTags"), ss.str()));
+    }
+  records.StartElement("MRML", atts);
+
+  vtkMRMLNode *node;
+  vtkCollectionSimpleIterator it;
+  for (scene->GetNodes()->InitTraversal(it);
+       (node = (vtkMRMLNode*)scene->GetNodes()->GetNextItemAsObject(it)) ;)
+    {
+    if (!node->GetSaveWithScene())
+      {
+      continue;
+      }
+    std::stringstream xml;
+    node->WriteXML(xml, 0);
+    atts.clear();
+    SplitXMLAttributes(xml.str(), atts);
+    records.StartElement(node->GetNodeTagName(), atts);
+
+    std::stringstream body;
+    node->WriteNodeBodyXML(body, 0);
+    std::string bodyXML = body.str();
+    if (bodyXML.find('<') != std::string::npos)
+      {
+      vtkMRMLParserBodyConverter* converter = vtkMRMLParserBodyConverter::New();
+      converter->Records = &records;
+      bodyXML = "<Body>" + bodyXML + "</Body>";
+      int res = converter->Parse(bodyXML.c_str(),
+                                 static_cast<unsigned int>(bodyXML.size()));
+      converter->Delete();
+      if (!res)
+        {
+        return 0;
+        }
+      }
+    records.EndElement(node->GetNodeTagName());
+    }
+  records.EndElement("MRML");
+
+  records.Write(os);
+  return os.good() ? 1 : 0;
+}
@@ -26,8 +26,21 @@ class vtkCollection;
 
 // STD includes
 #include <stack>
+#include <string>
 
 /// \brief Parse XML scene file.
+///
+/// The parser also supports a compact binary scene format (see
+/// ParseBinary() and WriteBinaryScene()) that is faster to read than XML:
+///  - header: "MRMLBIN" magic string (8 bytes with the null terminator)
+///    followed by the format version (uint32)
+///  - string table: number of strings (uint32) followed by the
+///    length-prefixed interned tag and attribute names
+///  - elements: one record per start ('S') or end ('E') element. A start
+///    record contains the tag name index (uint32), the number of attributes
+///    (uint32) and for each attribute, the attribute name index (uint32) and
+///    the length-prefixed (uint32) attribute value.
+///  All integers are little-endian.
 class VTK_MRML_EXPORT vtkMRMLParser : public vtkXMLParser
 {
 public:
@@ -39,6 +52,33 @@ public:
 
   vtkCollection* GetNodeCollection() {return this->NodeCollection;};
   void SetNodeCollection(vtkCollection* scene) {this->NodeCollection = scene;};
+
+  /// Version of the binary scene format written by WriteBinaryScene()
+  enum
+    {
+    BinarySceneFormatVersion = 1
+    };
+
+  /// Return true if \a buffer starts with the binary scene header.
+  static bool IsBinaryScene(const char* buffer, size_t length);
+
+  /// Return true if the file \a fileName starts with the binary scene header.
+  static bool IsBinarySceneFile(const char* fileName);
+
+  /// Parse a binary scene from a buffer.
+  /// Return 1 on success, 0 on failure.
+  /// \sa WriteBinaryScene(), IsBinaryScene()
+  int ParseBinary(const char* buffer, size_t length);
+
+  /// Parse a binary scene from the file FileName.
+  /// Return 1 on success, 0 on failure.
+  int ParseBinaryFile();
+
+  /// Write the nodes of \a scene that are saved with the scene into \a os
+  /// using the binary scene format.
+  /// Return 1 on success, 0 on failure.
+  /// \sa vtkMRMLScene::Commit(), ParseBinary()
+  static int WriteBinaryScene(vtkMRMLScene* scene, ostream& os);
   
 protected:
   vtkMRMLParser() : MRMLScene(NULL),NodeCollection(NULL){};
@@ -14,10 +14,11 @@ Version:   $Revision: 1.2 $
 
 // MRML includes
 #include "vtkEventBroker.h"
+#include "vtkImageMapToDirectColors.h"
 #include "vtkMRMLScalarVolumeDisplayNode.h"
 #include "vtkMRMLScene.h"
 #include "vtkMRMLProceduralColorNode.h"
-#include "vtkMRMLVolumeNode.h"
+#include "vtkMRMLScalarVolumeNode.h"
 
 // VTK includes
 #include <vtkCallbackCommand.h>
@@ -58,7 +59,7 @@ vtkMRMLScalarVolumeDisplayNode::vtkMRMLScalarVolumeDisplayNode()
   // create and set visulaization pipeline
   this->ResliceAlphaCast = vtkImageCast::New();
   this->AlphaLogic = vtkImageLogic::New();
-  this->MapToColors = vtkImageMapToColors::New();
+  this->MapToColors = vtkImageMapToDirectColors::New();
   this->Threshold = vtkImageThreshold::New();
   this->AppendComponents = vtkImageAppendComponents::New();
 
@@ -551,6 +552,13 @@ void vtkMRMLScalarVolumeDisplayNode::UpdateLookupTable(vtkMRMLColorNode* newColo
       }
     }
   this->MapToColors->SetLookupTable(lookupTable);
+  this->MapToColors->SetColorNode(newColorNode);
+}
+
+//---------------------------------------------------------------------------
+vtkScalarsToColors* vtkMRMLScalarVolumeDisplayNode::GetLookupTable()
+{
+  return this->MapToColors->GetLookupTable();
 }
 
 //---------------------------------------------------------------------------
@@ -666,8 +674,15 @@ void vtkMRMLScalarVolumeDisplayNode::GetDisplayScalarRange(double range[2])
     vtkDebugMacro( << "No valid image data, returning default values [0, 255]");
     return;
     }
-  imageData->Update();
-  imageData->GetScalarRange(range);
+  // the range of the volume image data is cached by the volume node
+  vtkMRMLScalarVolumeNode* volumeNode =
+    vtkMRMLScalarVolumeNode::SafeDownCast(this->GetVolumeNode());
+  if (!volumeNode || volumeNode->GetImageData() != imageData ||
+      !volumeNode->GetImageScalarRange(range))
+    {
+    imageData->Update();
+    imageData->GetScalarRange(range);
+    }
   if (imageData->GetNumberOfScalarComponents() >=3 &&
       fabs(range[0]) < 0.000001 && fabs(range[1]) < 0.000001) 
     {
@@ -725,13 +740,25 @@ void vtkMRMLScalarVolumeDisplayNode::CalculateAutoLevels()
       {
       this->Bimodal = vtkImageBimodalAnalysis::New();
       }
-    if (this->Accumulate == NULL)
+    // the histogram of the volume image data is cached by the volume node
+    vtkMRMLScalarVolumeNode* volumeNode =
+      vtkMRMLScalarVolumeNode::SafeDownCast(this->GetVolumeNode());
+    vtkImageData* histogram =
+      (volumeNode && volumeNode->GetImageData() == imageDataScalar) ?
+      volumeNode->GetImageHistogram() : NULL;
+    if (histogram)
       {
-      this->Accumulate = vtkImageAccumulateDiscrete::New();
+      this->Bimodal->SetInput(histogram);
+      }
+    else
+      {
+      if (this->Accumulate == NULL)
+        {
+        this->Accumulate = vtkImageAccumulateDiscrete::New();
+        }
+      this->Accumulate->SetInput(imageDataScalar);
+      this->Bimodal->SetInput(this->Accumulate->GetOutput());
       }
-
-    this->Accumulate->SetInput(imageDataScalar);
-    this->Bimodal->SetInput(this->Accumulate->GetOutput());
     this->Bimodal->Update();
     // Workaround for image data where all accumulate samples fall
     // within the same histogram bin
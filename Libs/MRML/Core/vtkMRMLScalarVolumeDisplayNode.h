@@ -25,10 +25,11 @@ class vtkImageBimodalAnalysis;
 class vtkImageCast;
 class vtkImageData;
 class vtkImageLogic;
-class vtkImageMapToColors;
+class vtkImageMapToDirectColors;
 class vtkImageMapToWindowLevelColors;
 class vtkImageThreshold;
 class vtkImageExtractComponents;
+class vtkScalarsToColors;
 class vtkImageMathematics;
 
 // STD includes
@@ -180,6 +181,11 @@ class VTK_MRML_EXPORT vtkMRMLScalarVolumeDisplayNode : public vtkMRMLVolumeDispl
   /// Volume node and returns its image data scalar range.
   virtual void GetDisplayScalarRange(double range[2]);
 
+  ///
+  /// Lookup table applied to the window/level output, it comes from the
+  /// color node (lookup table or color transfer function). 0 if none.
+  vtkScalarsToColors* GetLookupTable();
+
 protected:
   vtkMRMLScalarVolumeDisplayNode();
   virtual ~vtkMRMLScalarVolumeDisplayNode();
@@ -221,7 +227,7 @@ protected:
 
   vtkImageCast *ResliceAlphaCast;
   vtkImageLogic *AlphaLogic;
-  vtkImageMapToColors *MapToColors;
+  vtkImageMapToDirectColors *MapToColors;
   vtkImageThreshold *Threshold;
   vtkImageAppendComponents *AppendComponents;
   vtkImageMapToWindowLevelColors *MapToWindowLevelColors;
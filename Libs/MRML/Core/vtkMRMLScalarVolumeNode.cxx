@@ -19,15 +19,68 @@ Version:   $Revision: 1.14 $
 
 // VTK includes
 #include <vtkDataArray.h>
+#include <vtkMultiThreader.h>
 #include <vtkObjectFactory.h>
 #include <vtkImageData.h>
 #include <vtkPointData.h>
-
-// for calculating auto win/level
-#include <vtkImageAccumulateDiscrete.h>
-#include <vtkImageBimodalAnalysis.h>
+#include <vtkSmartPointer.h>
 
 // STD includes
+#include <algorithm>
+
+// Same bins as vtkImageAccumulateDiscrete
+static const int vtkMRMLScalarVolumeNodeHistogramOrigin = -32768;
+static const int vtkMRMLScalarVolumeNodeHistogramSize = 65536;
+
+//------------------------------------------------------------------------------
+static VTK_THREAD_RETURN_TYPE vtkMRMLScalarVolumeNode_ThreadedCompute(void *arg)
+{
+  vtkMultiThreader::ThreadInfo *info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  vtkMRMLScalarVolumeNode *self =
+    static_cast<vtkMRMLScalarVolumeNode*>(info->UserData);
+  self->ThreadedComputeImageStatistics(info->ThreadID, info->NumberOfThreads);
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//------------------------------------------------------------------------------
+template <class T>
+static void vtkMRMLScalarVolumeNodeComputeStatistics(T* scalars,
+                                                     int numberOfComponents,
+                                                     vtkIdType begin, vtkIdType end,
+                                                     double range[2],
+                                                     int* histogram)
+{
+  if (begin >= end)
+    {
+    return;
+    }
+  T* scalar = scalars + begin * numberOfComponents;
+  T* endScalar = scalars + end * numberOfComponents;
+  T min = *scalar;
+  T max = *scalar;
+  for (; scalar != endScalar; scalar += numberOfComponents)
+    {
+    T value = *scalar;
+    if (value < min)
+      {
+      min = value;
+      }
+    if (value > max)
+      {
+      max = value;
+      }
+    if (histogram)
+      {
+      double bin = static_cast<double>(value) - vtkMRMLScalarVolumeNodeHistogramOrigin;
+      if (bin >= 0. && bin < vtkMRMLScalarVolumeNodeHistogramSize)
+        {
+        ++histogram[static_cast<int>(bin)];
+        }
+      }
+    }
+  range[0] = static_cast<double>(min);
+  range[1] = static_cast<double>(max);
+}
 
 //----------------------------------------------------------------------------
 vtkMRMLNodeNewMacro(vtkMRMLScalarVolumeNode);
@@ -35,24 +88,21 @@ vtkMRMLNodeNewMacro(vtkMRMLScalarVolumeNode);
 //----------------------------------------------------------------------------
 vtkMRMLScalarVolumeNode::vtkMRMLScalarVolumeNode()
 {
-  this->Bimodal = vtkImageBimodalAnalysis::New();
-  this->Accumulate = vtkImageAccumulateDiscrete::New();
   this->CalculatingAutoLevels = 0;
+  this->ImageScalarRange[0] = 0.;
+  this->ImageScalarRange[1] = 0.;
+  this->ImageHistogram = NULL;
+  this->ImageStatisticsImageData = NULL;
   this->SetAttribute("LabelMap", "0"); // not label by default; avoid set method in constructor
 }
 
 //----------------------------------------------------------------------------
 vtkMRMLScalarVolumeNode::~vtkMRMLScalarVolumeNode()
 {
-  if (this->Bimodal)
+  if (this->ImageHistogram)
     {
-    this->Bimodal->Delete();
-    this->Bimodal = NULL;
-    }
-  if (this->Accumulate)
-    {
-    this->Accumulate->Delete();
-    this->Accumulate = NULL;
+    this->ImageHistogram->Delete();
+    this->ImageHistogram = NULL;
     }
 }
 
@@ -233,3 +283,168 @@ vtkMRMLStorageNode* vtkMRMLScalarVolumeNode::CreateDefaultStorageNode()
   return vtkMRMLVolumeArchetypeStorageNode::New();
 }
 
+//----------------------------------------------------------------------------
+bool vtkMRMLScalarVolumeNode::GetImageScalarRange(double range[2])
+{
+  if (!this->UpdateImageStatistics())
+    {
+    return false;
+    }
+  range[0] = this->ImageScalarRange[0];
+  range[1] = this->ImageScalarRange[1];
+  return true;
+}
+
+//----------------------------------------------------------------------------
+vtkImageData* vtkMRMLScalarVolumeNode::GetImageHistogram()
+{
+  if (!this->UpdateImageStatistics())
+    {
+    return NULL;
+    }
+  return this->ImageHistogram;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLScalarVolumeNode::GetImageScalarPercentile(double fraction, double& value)
+{
+  vtkImageData* histogram = this->GetImageHistogram();
+  if (histogram == NULL)
+    {
+    return false;
+    }
+  const int* counts = static_cast<int*>(histogram->GetScalarPointer());
+  double total = 0.;
+  for (int bin = 0; bin < vtkMRMLScalarVolumeNodeHistogramSize; ++bin)
+    {
+    total += counts[bin];
+    }
+  if (total == 0.)
+    {
+    return false;
+    }
+  double target = fraction * total;
+  double sum = 0.;
+  int bin = 0;
+  for (; bin < vtkMRMLScalarVolumeNodeHistogramSize - 1; ++bin)
+    {
+    sum += counts[bin];
+    if (counts[bin] && sum >= target)
+      {
+      break;
+      }
+    }
+  value = bin + vtkMRMLScalarVolumeNodeHistogramOrigin;
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLScalarVolumeNode::UpdateImageStatistics()
+{
+  vtkImageData* imageData = this->GetImageData();
+  if (imageData == NULL)
+    {
+    return false;
+    }
+  imageData->Update();
+  vtkDataArray* scalars = imageData->GetPointData()->GetScalars();
+  if (scalars == NULL || scalars->GetNumberOfTuples() == 0)
+    {
+    return false;
+    }
+  if (imageData == this->ImageStatisticsImageData &&
+      imageData->GetMTime() < this->ImageStatisticsTime.GetMTime())
+    {
+    return true;
+    }
+
+  bool integer = scalars->GetDataType() != VTK_FLOAT &&
+                 scalars->GetDataType() != VTK_DOUBLE;
+  if (integer && this->ImageHistogram == NULL)
+    {
+    this->ImageHistogram = vtkImageData::New();
+    this->ImageHistogram->SetWholeExtent(0, vtkMRMLScalarVolumeNodeHistogramSize - 1, 0, 0, 0, 0);
+    this->ImageHistogram->SetExtent(0, vtkMRMLScalarVolumeNodeHistogramSize - 1, 0, 0, 0, 0);
+    this->ImageHistogram->SetOrigin(vtkMRMLScalarVolumeNodeHistogramOrigin, 0., 0.);
+    this->ImageHistogram->SetSpacing(1., 1., 1.);
+    this->ImageHistogram->SetScalarTypeToInt();
+    this->ImageHistogram->SetNumberOfScalarComponents(1);
+    this->ImageHistogram->AllocateScalars();
+    }
+  else if (!integer && this->ImageHistogram)
+    {
+    this->ImageHistogram->Delete();
+    this->ImageHistogram = NULL;
+    }
+
+  vtkSmartPointer<vtkMultiThreader> threader = vtkSmartPointer<vtkMultiThreader>::New();
+  int numberOfThreads = threader->GetNumberOfThreads();
+  this->ThreadImageScalarRanges.assign(2 * numberOfThreads, 0.);
+  for (int i = 0; i < numberOfThreads; ++i)
+    {
+    this->ThreadImageScalarRanges[2 * i] = VTK_DOUBLE_MAX;
+    this->ThreadImageScalarRanges[2 * i + 1] = -VTK_DOUBLE_MAX;
+    }
+  if (integer)
+    {
+    this->ThreadImageHistograms.assign(
+      numberOfThreads * vtkMRMLScalarVolumeNodeHistogramSize, 0);
+    }
+
+  this->ImageStatisticsImageData = imageData;
+  threader->SetSingleMethod(vtkMRMLScalarVolumeNode_ThreadedCompute, this);
+  threader->SingleMethodExecute();
+
+  this->ImageScalarRange[0] = VTK_DOUBLE_MAX;
+  this->ImageScalarRange[1] = -VTK_DOUBLE_MAX;
+  for (int i = 0; i < numberOfThreads; ++i)
+    {
+    this->ImageScalarRange[0] = std::min(this->ImageScalarRange[0],
+                                         this->ThreadImageScalarRanges[2 * i]);
+    this->ImageScalarRange[1] = std::max(this->ImageScalarRange[1],
+                                         this->ThreadImageScalarRanges[2 * i + 1]);
+    }
+  if (integer)
+    {
+    int* histogram = static_cast<int*>(this->ImageHistogram->GetScalarPointer());
+    std::copy(this->ThreadImageHistograms.begin(),
+              this->ThreadImageHistograms.begin() + vtkMRMLScalarVolumeNodeHistogramSize,
+              histogram);
+    for (int i = 1; i < numberOfThreads; ++i)
+      {
+      const int* threadHistogram =
+        &this->ThreadImageHistograms[i * vtkMRMLScalarVolumeNodeHistogramSize];
+      for (int bin = 0; bin < vtkMRMLScalarVolumeNodeHistogramSize; ++bin)
+        {
+        histogram[bin] += threadHistogram[bin];
+        }
+      }
+    this->ImageHistogram->Modified();
+    }
+  std::vector<int>().swap(this->ThreadImageHistograms);
+  this->ImageStatisticsTime.Modified();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLScalarVolumeNode::ThreadedComputeImageStatistics(int threadId, int numberOfThreads)
+{
+  vtkImageData* imageData = this->ImageStatisticsImageData;
+  vtkDataArray* scalars = imageData->GetPointData()->GetScalars();
+  vtkIdType numberOfTuples = scalars->GetNumberOfTuples();
+  vtkIdType begin = numberOfTuples * threadId / numberOfThreads;
+  vtkIdType end = numberOfTuples * (threadId + 1) / numberOfThreads;
+
+  double* range = &this->ThreadImageScalarRanges[2 * threadId];
+  int* histogram = this->ThreadImageHistograms.empty() ? NULL :
+    &this->ThreadImageHistograms[threadId * vtkMRMLScalarVolumeNodeHistogramSize];
+  switch (scalars->GetDataType())
+    {
+    vtkTemplateMacro(vtkMRMLScalarVolumeNodeComputeStatistics(
+      static_cast<VTK_TT*>(scalars->GetVoidPointer(0)),
+      scalars->GetNumberOfComponents(), begin, end, range, histogram));
+    default:
+      break;
+    }
+}
+
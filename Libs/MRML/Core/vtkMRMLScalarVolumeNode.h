@@ -22,8 +22,9 @@ class vtkMRMLVolumeArchetypeStorageNode;
 
 // VTK includes
 class vtkImageData;
-class vtkImageAccumulateDiscrete;
-class vtkImageBimodalAnalysis;
+
+// STD includes
+#include <vector>
 
 /// \brief MRML node for representing a volume (image stack).
 ///
@@ -98,16 +99,54 @@ class VTK_MRML_EXPORT vtkMRMLScalarVolumeNode : public vtkMRMLVolumeNode
   /// Create default storage node or NULL if does not have one
   virtual vtkMRMLStorageNode* CreateDefaultStorageNode();
 
+  ///
+  /// Range of the first scalar component of the image data.
+  /// The range and the histogram are computed together in one multithreaded
+  /// pass over the image data the first time one of them is requested, and
+  /// are cached until the image data is modified.
+  /// Returns false if the image data has no scalars.
+  /// \sa GetImageHistogram(), GetImageScalarPercentile()
+  bool GetImageScalarRange(double range[2]);
+
+  ///
+  /// Histogram of the first scalar component of an integer image data, one
+  /// bin per value from -32768 to 32767 in the format of the output of
+  /// vtkImageAccumulateDiscrete. Values outside of the bins are not counted.
+  /// Returns NULL if the image data is not integer.
+  /// \sa GetImageScalarRange(), GetImageScalarPercentile()
+  vtkImageData* GetImageHistogram();
+
+  ///
+  /// Smallest value such that the given fraction (between 0 and 1) of the
+  /// histogram counts is less or equal to it.
+  /// Returns false if there is no histogram.
+  /// \sa GetImageHistogram()
+  bool GetImageScalarPercentile(double fraction, double& value);
+
+  ///
+  /// Used internally by the threads that compute the range and the histogram
+  /// of the image data.
+  void ThreadedComputeImageStatistics(int threadId, int numberOfThreads);
+
 protected:
   vtkMRMLScalarVolumeNode();
   ~vtkMRMLScalarVolumeNode();
   vtkMRMLScalarVolumeNode(const vtkMRMLScalarVolumeNode&);
   void operator=(const vtkMRMLScalarVolumeNode&);
 
-  /// 
-  /// Used internally in CalculateScalarAutoLevels and CalculateStatisticsAutoLevels
-  vtkImageAccumulateDiscrete *Accumulate;
-  vtkImageBimodalAnalysis *Bimodal;
+  ///
+  /// Compute the range and the histogram if the image data has been
+  /// modified since they were last computed.
+  bool UpdateImageStatistics();
+
+  double ImageScalarRange[2];
+  vtkImageData* ImageHistogram;
+  /// Image data of the range and histogram, only compared.
+  vtkImageData* ImageStatisticsImageData;
+  vtkTimeStamp ImageStatisticsTime;
+  /// Range and histogram of each thread during the computation.
+  std::vector<double> ThreadImageScalarRanges;
+  std::vector<int> ThreadImageHistograms;
 
   int CalculatingAutoLevels;
 };
@@ -45,6 +45,7 @@ Version:   $Revision: 1.18 $
 #include "vtkMRMLSliceCompositeNode.h"
 #include "vtkMRMLSliceNode.h"
 #include "vtkMRMLSnapshotClipNode.h"
+#include "vtkMRMLTimeSeriesDatabaseStorageNode.h"
 #include "vtkMRMLTransformStorageNode.h"
 #include "vtkMRMLUnstructuredGridDisplayNode.h"
 #include "vtkMRMLUnstructuredGridNode.h"
@@ -52,6 +53,7 @@ Version:   $Revision: 1.18 $
 #include "vtkMRMLVectorVolumeDisplayNode.h"
 #include "vtkMRMLViewNode.h"
 #include "vtkMRMLVolumeArchetypeStorageNode.h"
+#include "vtkMRMLVolumeBrickStorageNode.h"
 #include "vtkURIHandler.h"
 #include "vtkMRMLLayoutNode.h"
 
@@ -71,6 +73,7 @@ Version:   $Revision: 1.18 $
 // VTK includes
 #include <vtkCallbackCommand.h>
 #include <vtkCollection.h>
+#include <vtkDataObject.h>
 #include <vtkDebugLeaks.h>
 #include <vtkErrorCode.h>
 #include <vtkObjectFactory.h>
@@ -83,6 +86,8 @@ Version:   $Revision: 1.18 $
 #include <algorithm>
 #include <cassert>
 #include <numeric>
+#include <set>
+#include <sstream>
 
 //#define MRMLSCENE_VERBOSE 1
 
@@ -91,10 +96,47 @@ vtkCxxSetObjectMacro(vtkMRMLScene, DataIOManager, vtkDataIOManager)
 vtkCxxSetObjectMacro(vtkMRMLScene, UserTagTable, vtkTagTable)
 vtkCxxSetObjectMacro(vtkMRMLScene, URIHandlerCollection, vtkCollection)
 
+//------------------------------------------------------------------------------
+/// A level of the undo or redo stack.
+/// Instead of copying the whole scene, a level only references the nodes
+/// that were in the scene when the level was created and journals the state
+/// of the nodes that have been saved (SaveStateForUndo()).
+class vtkMRMLScene::vtkUndoLevel
+{
+public:
+  vtkUndoLevel() : NodesMTime(0), Size(0) {}
+
+  /// Return the saved state of \a node if any, \a node otherwise.
+  vtkMRMLNode* GetSavedNode(vtkMRMLNode* node)const
+  {
+    NodeCopiesType::const_iterator it = this->NodeCopies.find(node);
+    return it != this->NodeCopies.end() ? it->second.GetPointer() : node;
+  }
+
+  /// Nodes of the scene when the level was created. The collection is shared
+  /// with the previous level if no node was added or removed in between.
+  vtkSmartPointer<vtkCollection> Nodes;
+  /// MTime of the scene node collection when the level was created.
+  unsigned long NodesMTime;
+
+  /// Saved states of the nodes, indexed by the node they are a copy of.
+  /// A copy is shared with the previous level if the node was not modified
+  /// in between. Bulk data is shared with the scene nodes (c.f. Copy()).
+  typedef std::map<vtkMRMLNode*, vtkSmartPointer<vtkMRMLNode> > NodeCopiesType;
+  NodeCopiesType NodeCopies;
+  /// MTime of the nodes when they were copied.
+  std::map<vtkMRMLNode*, unsigned long> NodeCopiesMTime;
+
+  /// Approximate memory (in bytes) used by the node copies owned by the level.
+  unsigned long Size;
+};
+
 //------------------------------------------------------------------------------
 vtkMRMLScene::vtkMRMLScene()
 {
   this->NodeIDsMTime = 0;
+  this->NodesByClassMTime = 0;
+  this->NodeNamesMTime = 0;
   this->SceneModifiedTime = 0;
 
   this->ClassNameList = NULL;
@@ -104,6 +146,7 @@ vtkMRMLScene::vtkMRMLScene()
 
   this->Nodes =  vtkCollection::New();
   this->UndoStackSize = 100;
+  this->UndoStackMemoryBudget = 0;
   this->UndoFlag = false;
   this->InUndo = false;
 
@@ -122,6 +165,8 @@ vtkMRMLScene::vtkMRMLScene()
 
   this->SaveToXMLString = 0;
 
+  this->SaveToBinaryFormat = 0;
+
   this->ReadDataOnLoad = 1;
 
   this->LastLoadedVersion = NULL;
@@ -209,6 +254,14 @@ vtkMRMLScene::vtkMRMLScene()
   this->RegisterNodeClass( astoren );
   astoren->Delete();
 
+  vtkMRMLVolumeBrickStorageNode *bstoren = vtkMRMLVolumeBrickStorageNode::New();
+  this->RegisterNodeClass( bstoren );
+  bstoren->Delete();
+
+  vtkMRMLTimeSeriesDatabaseStorageNode *tsdstoren = vtkMRMLTimeSeriesDatabaseStorageNode::New();
+  this->RegisterNodeClass( tsdstoren );
+  tsdstoren->Delete();
+
   vtkMRMLScalarVolumeDisplayNode *vdisn = vtkMRMLScalarVolumeDisplayNode::New();
   this->RegisterNodeClass( vdisn );
   vdisn->Delete();
@@ -449,24 +502,13 @@ void vtkMRMLScene::Clear(int removeSingletons)
   this->SetUndoOff();
   this->StartState(vtkMRMLScene::CloseState);
 
+  this->RemoveAllNodes(removeSingletons != 0);
   if (!removeSingletons)
     {
-    this->RemoveAllNodesExceptSingletons();
-    this->ClearReferencedNodeID();
     this->ResetNodes();
-    // See comment below
-    //    this->InvokeEvent(this->SceneClosedEvent, NULL);
-    }
-  else
-    {
-    //this->CurrentScene->RemoveAllItems();
-    while (this->GetNumberOfNodes() > 0)
-      {
-      this->RemoveNode(this->GetNthNode(0));
-      }
-    // See comment below
-    //  this->InvokeEvent(this->SceneClosedEvent, NULL);
     }
+  // See comment below
+  //    this->InvokeEvent(this->SceneClosedEvent, NULL);
 
   this->ClearReferencedNodeID();
 
@@ -501,37 +543,116 @@ void vtkMRMLScene::Clear(int removeSingletons)
 }
 
 //------------------------------------------------------------------------------
-void vtkMRMLScene::RemoveAllNodesExceptSingletons()
+void vtkMRMLScene::RemoveAllNodes(bool removeSingletons)
 {
+  std::vector< vtkSmartPointer<vtkMRMLNode> > removedNodes;
+  std::vector< vtkSmartPointer<vtkMRMLNode> > keptNodes;
+  std::map< std::string, size_t > removedNodeIndexes;
   vtkMRMLNode *node;
-  this->InitTraversal();
-  std::vector<vtkMRMLNode *> removeNodes;
-  std::vector< vtkSmartPointer<vtkMRMLNode> > referencingNodes;
-  node = this->GetNextNode();
-  while(node)
+  vtkCollectionSimpleIterator it;
+  for (this->Nodes->InitTraversal(it);
+       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
     {
-    if (node->GetSingletonTag() == NULL)
+    if (!removeSingletons && node->GetSingletonTag() != NULL)
       {
-      removeNodes.push_back(node);
+      keptNodes.push_back(node);
+      continue;
       }
-    else
+    if (node->GetID())
       {
-      referencingNodes.push_back(node);
+      removedNodeIndexes[std::string(node->GetID())] = removedNodes.size();
+      }
+    removedNodes.push_back(node);
+    }
+
+  // Removal order: a node is removed after all the nodes that reference it.
+  // The nodes of a reference cycle are removed in the scene order.
+  const size_t nnodes = removedNodes.size();
+  std::vector< std::vector<size_t> > referencedNodes(nnodes);
+  std::vector<int> referencingNodeCounts(nnodes, 0);
+  for (size_t i = 0; i < this->ReferencingNodes.size() &&
+                     i < this->ReferencedIDs.size(); ++i)
+    {
+    vtkMRMLNode* referencingNode = this->ReferencingNodes[i];
+    if (!referencingNode || !referencingNode->GetID())
+      {
+      continue;
+      }
+    std::map< std::string, size_t >::const_iterator referencingIt =
+      removedNodeIndexes.find(std::string(referencingNode->GetID()));
+    std::map< std::string, size_t >::const_iterator referencedIt =
+      removedNodeIndexes.find(this->ReferencedIDs[i]);
+    if (referencingIt == removedNodeIndexes.end() ||
+        referencedIt == removedNodeIndexes.end() ||
+        referencingIt->second == referencedIt->second ||
+        removedNodes[referencingIt->second] != referencingNode)
+      {
+      continue;
+      }
+    referencedNodes[referencingIt->second].push_back(referencedIt->second);
+    ++referencingNodeCounts[referencedIt->second];
+    }
+  std::vector<size_t> removalOrder;
+  removalOrder.reserve(nnodes);
+  std::vector<bool> ordered(nnodes, false);
+  for (size_t i = 0; i < nnodes; ++i)
+    {
+    if (referencingNodeCounts[i] == 0)
+      {
+      removalOrder.push_back(i);
+      ordered[i] = true;
+      }
+    }
+  for (size_t next = 0; next < removalOrder.size(); ++next)
+    {
+    const std::vector<size_t>& nodeReferencedNodes =
+      referencedNodes[removalOrder[next]];
+    for (size_t j = 0; j < nodeReferencedNodes.size(); ++j)
+      {
+      size_t referencedNode = nodeReferencedNodes[j];
+      if (--referencingNodeCounts[referencedNode] == 0 && !ordered[referencedNode])
+        {
+        removalOrder.push_back(referencedNode);
+        ordered[referencedNode] = true;
+        }
       }
-    node = this->GetNextNode();
     }
-  for(unsigned int i=0; i<removeNodes.size(); i++)
+  for (size_t i = 0; i < nnodes; ++i)
     {
-    //this->RemoveNode(removeNodes[i]);
-    node = removeNodes[i];
-    //node->Register(this);
-    //this->CurrentScene->vtkCollection::RemoveItem(node);
-    this->RemoveNode(node);
-    //this->InvokeEvent(this->NodeRemovedEvent,node);
-    //node->UnRegister(this);
+    if (!ordered[i])
+      {
+      removalOrder.push_back(i);
+      }
     }
 
-  this->ReferencingNodes = referencingNodes;
+  // Detach all the nodes at once: the caches are rebuilt once instead of
+  // being updated for each node and the references are not needed anymore.
+  this->Nodes->RemoveAllItems();
+  this->ClearNodeIDs();
+  for (size_t i = 0; i < keptNodes.size(); ++i)
+    {
+    this->Nodes->vtkCollection::AddItem(keptNodes[i]);
+    this->AddNodeID(keptNodes[i]);
+    }
+  this->NodesByClass.clear();
+  this->NodesByClassMTime = this->Nodes->GetMTime();
+  this->UpdateNodeNames();
+  this->ClearReferencedNodeID();
+
+  for (size_t i = 0; i < removalOrder.size(); ++i)
+    {
+    node = removedNodes[removalOrder[i]];
+    this->InvokeEvent(vtkMRMLScene::NodeAboutToBeRemovedEvent, node);
+    if (node->GetScene() == this)
+      {
+      node->SetScene(0);
+      }
+    this->InvokeEvent(vtkMRMLScene::NodeRemovedEvent, node);
+    // Release the nodes in the removal order too.
+    removedNodes[removalOrder[i]] = 0;
+    }
+
+  this->Modified();
 }
 
 //------------------------------------------------------------------------------
@@ -1031,13 +1152,28 @@ int vtkMRMLScene::LoadIntoScene(vtkCollection* nodeCollection)
   int result = 0;
   if (this->GetLoadFromXMLString())
     {
-    result = parser->Parse(this->GetSceneXMLString().c_str());
+    const std::string& sceneString = this->GetSceneXMLString();
+    if (vtkMRMLParser::IsBinaryScene(sceneString.c_str(), sceneString.size()))
+      {
+      result = parser->ParseBinary(sceneString.c_str(), sceneString.size());
+      }
+    else
+      {
+      result = parser->Parse(sceneString.c_str());
+      }
     }
   else
     {
     vtkDebugMacro("Parsing: " << this->URL.c_str());
     parser->SetFileName(URL.c_str());
-    result = parser->Parse();
+    if (vtkMRMLParser::IsBinarySceneFile(URL.c_str()))
+      {
+      result = parser->ParseBinaryFile();
+      }
+    else
+      {
+      result = parser->Parse();
+      }
    }
 
   parser->Delete();
@@ -1081,7 +1217,8 @@ int vtkMRMLScene::Commit(const char* url)
 #ifdef _WIN32
     ofs.open(url, std::ios::out | std::ios::binary);
 #else
-    ofs.open(url, std::ios::out);
+    ofs.open(url, this->GetSaveToBinaryFormat() ?
+      std::ios::out | std::ios::binary : std::ios::out);
 #endif
     if (ofs.fail())
       {
@@ -1095,6 +1232,28 @@ int vtkMRMLScene::Commit(const char* url)
       }
     }
 
+  if (this->GetSaveToBinaryFormat())
+    {
+    int res = vtkMRMLParser::WriteBinaryScene(this, *os);
+    if (this->GetSaveToXMLString())
+      {
+      this->SceneXMLString = oss.str();
+      }
+    else
+      {
+      ofs.close();
+      }
+    if (!res)
+      {
+      vtkErrorMacro("Commit: failed to write the binary scene");
+      this->SetErrorCode(1);
+      return 1;
+      }
+    this->SetErrorCode(0);
+    this->StoredTime.Modified();
+    return 1;
+    }
+
   int indent=0, deltaIndent;
 
 
@@ -1281,10 +1440,14 @@ vtkMRMLNode*  vtkMRMLScene::AddNodeNoNotify(vtkMRMLNode *n)
     n->SetName(this->GenerateUniqueName(n).c_str());
     }
   n->SetScene( this );
+  this->UpdateNodesByClass();
+  this->UpdateNodeNames();
   this->Nodes->vtkCollection::AddItem((vtkObject *)n);
 
   // cache the node so the whole scene cache stays up-todate
   this->AddNodeID(n);
+  this->AddNodeToNodesByClass(n);
+  this->AddNodeName(n->GetName());
 
   //n->OnNodeAddedToScene();
 
@@ -1351,6 +1514,70 @@ vtkMRMLNode*  vtkMRMLScene::AddNode(vtkMRMLNode *n)
 }
 
 
+//------------------------------------------------------------------------------
+int vtkMRMLScene::AddNodes(const std::vector<vtkMRMLNode*>& nodes)
+{
+  this->StartState(vtkMRMLScene::BatchProcessState);
+
+  vtkSmartPointer<vtkCollection> addedNodes =
+    vtkSmartPointer<vtkCollection>::New();
+  std::vector<vtkMRMLNode*>::const_iterator it;
+  for (it = nodes.begin(); it != nodes.end(); ++it)
+    {
+    vtkMRMLNode* n = *it;
+    if (!n)
+      {
+      vtkErrorMacro("AddNodes: unable to add a null node to the scene");
+      continue;
+      }
+    if (!n->GetAddToScene())
+      {
+      continue;
+      }
+#ifndef NDEBUG
+    if (this->IsNodePresent(n) != 0)
+      {
+      vtkErrorMacro("AddNodes: Node " << n->GetClassName()<< "/"
+                    << n->GetName() << "/" << n->GetID()
+                    << "[" << n << "]" << " already added");
+      }
+#endif
+    // If the node is a singleton already in the scene, the returned node is
+    // the existing singleton: n is not added but copied into it.
+    if (this->AddNodeNoNotify(n) == n)
+      {
+      addedNodes->AddItem(n);
+      }
+    }
+
+  int numberOfAddedNodes = addedNodes->GetNumberOfItems();
+  if (numberOfAddedNodes > 0)
+    {
+    this->InvokeEvent(this->NodesAddedEvent, addedNodes.GetPointer());
+    }
+  this->Modified();
+
+  this->EndState(vtkMRMLScene::BatchProcessState);
+  return numberOfAddedNodes;
+}
+
+//------------------------------------------------------------------------------
+int vtkMRMLScene::AddNodes(vtkCollection* nodes)
+{
+  std::vector<vtkMRMLNode*> nodesToAdd;
+  if (nodes)
+    {
+    vtkMRMLNode* node = 0;
+    vtkCollectionSimpleIterator it;
+    for (nodes->InitTraversal(it);
+         (node = vtkMRMLNode::SafeDownCast(nodes->GetNextItemAsObject(it))) ;)
+      {
+      nodesToAdd.push_back(node);
+      }
+    }
+  return this->AddNodes(nodesToAdd);
+}
+
 //------------------------------------------------------------------------------
 void vtkMRMLScene::NodeAdded(vtkMRMLNode *n)
 {
@@ -1414,9 +1641,13 @@ void vtkMRMLScene::RemoveNode(vtkMRMLNode *n)
     {
     n->SetScene(0);
     }
+  this->UpdateNodesByClass();
+  this->UpdateNodeNames();
   this->Nodes->vtkCollection::RemoveItem((vtkObject *)n);
 
   this->RemoveNodeID(n->GetID());
+  this->RemoveNodeFromNodesByClass(n);
+  this->RemoveNodeName(n->GetName());
 
   this->InvokeEvent(vtkMRMLScene::NodeRemovedEvent, n);
   n->UnRegister(this);
@@ -1628,18 +1859,7 @@ int vtkMRMLScene::GetNumberOfNodesByClass(const char *className)
     vtkErrorMacro("GetNumberOfNodesByClass: class name is null.");
     return 0;
     }
-  int num=0;
-  vtkMRMLNode *node;
-  vtkCollectionSimpleIterator it;
-  for (this->Nodes->InitTraversal(it);
-       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
-    {
-    if (node->IsA(className))
-      {
-      num++;
-      }
-    }
-  return num;
+  return static_cast<int>(this->GetNodesByClassCache(className).size());
 }
 
 //------------------------------------------------------------------------------
@@ -1650,16 +1870,9 @@ int vtkMRMLScene::GetNodesByClass(const char *className, std::vector<vtkMRMLNode
     vtkErrorMacro("GetNodesByClass: class name is null.");
     return 0;
     }
-  vtkMRMLNode *node;
-  vtkCollectionSimpleIterator it;
-  for (this->Nodes->InitTraversal(it);
-       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
-    {
-    if (node->IsA(className))
-      {
-      nodes.push_back(node);
-      }
-    }
+  const std::vector<vtkMRMLNode*>& classNodes =
+    this->GetNodesByClassCache(className);
+  nodes.insert(nodes.end(), classNodes.begin(), classNodes.end());
   return static_cast<int>(nodes.size());
 }
 
@@ -1672,15 +1885,12 @@ vtkCollection* vtkMRMLScene::GetNodesByClass(const char *className)
     return 0;
     }
   vtkCollection* nodes = vtkCollection::New();
-  vtkMRMLNode *node;
-  vtkCollectionSimpleIterator it;
-  for (this->Nodes->InitTraversal(it);
-       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
+  const std::vector<vtkMRMLNode*>& classNodes =
+    this->GetNodesByClassCache(className);
+  std::vector<vtkMRMLNode*>::const_iterator it;
+  for (it = classNodes.begin(); it != classNodes.end(); ++it)
     {
-    if (node->IsA(className))
-      {
-      nodes->AddItem(node);
-      }
+    nodes->AddItem(*it);
     }
   return nodes;
 }
@@ -1797,22 +2007,13 @@ vtkMRMLNode* vtkMRMLScene::GetNthNodeByClass(int n, const char *className)
     return NULL;
     }
 
-  int num=0;
-  vtkMRMLNode *node;
-  vtkCollectionSimpleIterator it;
-  for (this->Nodes->InitTraversal(it);
-       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
+  const std::vector<vtkMRMLNode*>& classNodes =
+    this->GetNodesByClassCache(className);
+  if (n >= static_cast<int>(classNodes.size()))
     {
-    if (node->IsA(className))
-      {
-      if (num == n)
-        {
-        return node;
-        }
-      num++;
-      }
+    return NULL;
     }
-  return NULL;
+  return classNodes[n];
 }
 
 //------------------------------------------------------------------------------
@@ -2030,6 +2231,7 @@ vtkMRMLNode* vtkMRMLScene::InsertAfterNode(vtkMRMLNode *item, vtkMRMLNode *n)
   int itemIndex = 0;
   // find the index of the item to insert after
   itemIndex = this->IsNodePresent(item);
+  this->UpdateNodeNames();
   if (itemIndex == 0)
     {
     // it wasn't found, just add
@@ -2044,6 +2246,10 @@ vtkMRMLNode* vtkMRMLScene::InsertAfterNode(vtkMRMLNode *item, vtkMRMLNode *n)
     }
   // cache the node so the whole scene cache stays up-todate
   this->AddNodeID(n);
+  this->AddNodeName(n->GetName());
+  // the node is not necessarily at the end of the collection, the order of
+  // the NodesByClass lists can't be maintained, they will be recomputed.
+  this->NodesByClass.clear();
 
   n->SetDisableModifiedEvent(modifyStatus);
 
@@ -2110,6 +2316,7 @@ vtkMRMLNode* vtkMRMLScene::InsertBeforeNode(vtkMRMLNode *item, vtkMRMLNode *n)
   int itemIndex = 0;
   // find the index of the item to insert before
   itemIndex = this->IsNodePresent(item);
+  this->UpdateNodeNames();
   if (itemIndex == 0)
     {
     // it wasn't found, just add
@@ -2125,6 +2332,10 @@ vtkMRMLNode* vtkMRMLScene::InsertBeforeNode(vtkMRMLNode *item, vtkMRMLNode *n)
     }
   // cache the node so the whole scene cache stays up-todate
   this->AddNodeID(n);
+  this->AddNodeName(n->GetName());
+  // the node is not necessarily at the end of the collection, the order of
+  // the NodesByClass lists can't be maintained, they will be recomputed.
+  this->NodesByClass.clear();
 
   n->SetDisableModifiedEvent(modifyStatus);
 
@@ -2237,8 +2448,7 @@ int vtkMRMLScene::GetUniqueIDIndex(const std::string& baseID)
     std::string candidateID = this->BuildID(baseID, index);
     isUnique =
       (this->GetNodeByID(candidateID) == 0) &&
-      (std::find(this->ReservedIDs.begin(), this->ReservedIDs.end(), candidateID)
-         == this->ReservedIDs.end());
+      (this->ReservedIDs.find(candidateID) == this->ReservedIDs.end());
     }
   return index;
 }
@@ -2294,13 +2504,13 @@ int vtkMRMLScene::GetUniqueNameIndex(const std::string& baseName)
     }
   bool isUnique = false;
   int index = lastNameIndex;
-  // keep looping until you find a name that isn't yet in the scene
-  // TODO: this could be speeded up if it becomes a bottleneck
+  // keep looping until you find a name that isn't yet in the scene, the
+  // search starts after the last index given for baseName.
   for (; !isUnique; )
     {
     ++index;
     std::string candidateName = this->BuildName(baseName, index);
-    isUnique = (this->GetFirstNodeByName(candidateName.c_str()) == 0);
+    isUnique = !this->IsNodeNameUsed(candidateName);
     }
   return index;
 }
@@ -2325,7 +2535,7 @@ void vtkMRMLScene::AddReservedID(const char *id)
     {
     return;
     }
-  this->ReservedIDs.push_back(std::string(id));
+  this->ReservedIDs.insert(std::string(id));
 }
 
 //------------------------------------------------------------------------------
@@ -2363,6 +2573,7 @@ void vtkMRMLScene::SaveStateForUndo (vtkMRMLNode *node)
     {
     this->CopyNodeInUndoStack(node);
     }
+  this->TrimUndoStack();
 }
 
 //------------------------------------------------------------------------------
@@ -2394,6 +2605,7 @@ void vtkMRMLScene::SaveStateForUndo (std::vector<vtkMRMLNode *> nodes)
       this->CopyNodeInUndoStack(node);
       }
     }
+  this->TrimUndoStack();
 }
 
 //------------------------------------------------------------------------------
@@ -2433,6 +2645,7 @@ void vtkMRMLScene::SaveStateForUndo (vtkCollection* nodes)
       this->CopyNodeInUndoStack(node);
       }
     }
+  this->TrimUndoStack();
 }
 
 //------------------------------------------------------------------------------
@@ -2454,119 +2667,329 @@ void vtkMRMLScene::SaveStateForUndo ()
 }
 
 //------------------------------------------------------------------------------
-// Make a new collection that has pointers to all the nodes in the current scene
+// Make a new undo level that has pointers to all the nodes in the current scene
 void vtkMRMLScene::PushIntoUndoStack()
 {
   if (this->Nodes == NULL)
     {
     return;
     }
+  this->UndoStack.push_back(this->CreateUndoLevel(this->UndoStack));
+}
 
+//------------------------------------------------------------------------------
+// Make a new redo level that has pointers to the current scene nodes
+void vtkMRMLScene::PushIntoRedoStack()
+{
+  if (this->Nodes == NULL)
+    {
+    return;
+    }
+  this->RedoStack.push_back(this->CreateUndoLevel(this->RedoStack));
+}
 
-  vtkCollection* newScene = vtkCollection::New();
+//------------------------------------------------------------------------------
+vtkMRMLScene::vtkUndoLevel* vtkMRMLScene
+::CreateUndoLevel(const std::list<vtkUndoLevel*>& stack)
+{
+  vtkUndoLevel* level = new vtkUndoLevel;
+  level->NodesMTime = this->Nodes->GetMTime();
+  // If no node has been added or removed since the last level, the list of
+  // nodes is the same, share it.
+  if (!stack.empty() && stack.back()->NodesMTime == level->NodesMTime)
+    {
+    level->Nodes = stack.back()->Nodes;
+    return level;
+    }
+  level->Nodes = vtkSmartPointer<vtkCollection>::New();
+  vtkMRMLNode *node = 0;
+  vtkCollectionSimpleIterator it;
+  for (this->Nodes->InitTraversal(it);
+       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
+    {
+    if (!node->IsA("vtkMRMLSceneViewNode"))
+      {
+      level->Nodes->AddItem(node);
+      }
+    }
+  return level;
+}
 
-  vtkCollection* currentScene = this->Nodes;
+//------------------------------------------------------------------------------
+// Put a replacement node into the undoable copy of the scene so that the node
+// can be edited
+void vtkMRMLScene::CopyNodeInUndoStack(vtkMRMLNode *copyNode)
+{
+  if (!copyNode)
+    {
+    vtkErrorMacro("CopyNodeInUndoStack: node is null");
+    return;
+    }
+  this->CopyNodeInStack(this->UndoStack, copyNode, false);
+}
 
-  int nnodes = currentScene->GetNumberOfItems();
+//------------------------------------------------------------------------------
+// Put a replacement node into the redoable copy of the scene so that the node
+// can be replaced by the Undo version
+void vtkMRMLScene::CopyNodeInRedoStack(vtkMRMLNode *copyNode)
+{
+  if (!copyNode)
+    {
+    vtkErrorMacro("CopyNodeInRedoStack: node is null");
+    return;
+    }
+  this->CopyNodeInStack(this->RedoStack, copyNode, true);
+}
 
-  for (int n=0; n<nnodes; n++)
+//------------------------------------------------------------------------------
+void vtkMRMLScene::CopyNodeInStack(std::list<vtkUndoLevel*>& stack,
+                                   vtkMRMLNode *copyNode,
+                                   bool singleModifiedEvent)
+{
+  if (stack.empty())
     {
-    vtkMRMLNode *node  = dynamic_cast < vtkMRMLNode *>(currentScene->GetItemAsObject(n));
-    if (node && !node->IsA("vtkMRMLSceneViewNode"))
+    return;
+    }
+  vtkUndoLevel* level = stack.back();
+  unsigned long nodeMTime = copyNode->GetMTime();
+
+  // If the node has not been modified since it was saved in the previous
+  // level, the saved state is the same: share it instead of copying the node
+  // again.
+  if (stack.size() > 1)
+    {
+    std::list<vtkUndoLevel*>::reverse_iterator previousLevelIt = stack.rbegin();
+    ++previousLevelIt;
+    vtkUndoLevel* previousLevel = *previousLevelIt;
+    vtkUndoLevel::NodeCopiesType::const_iterator copyIt =
+      previousLevel->NodeCopies.find(copyNode);
+    if (copyIt != previousLevel->NodeCopies.end() &&
+        previousLevel->NodeCopiesMTime[copyNode] == nodeMTime)
       {
-      newScene->AddItem(node);
+      level->NodeCopies[copyNode] = copyIt->second;
+      level->NodeCopiesMTime[copyNode] = nodeMTime;
+      return;
       }
     }
 
-  //TODO check max stack size
-  this->UndoStack.push_back(newScene);
+  vtkSmartPointer<vtkMRMLNode> snode;
+  snode.TakeReference(copyNode->CreateNodeInstance());
+  if (snode.GetPointer() == NULL)
+    {
+    return;
+    }
+  if (singleModifiedEvent)
+    {
+    snode->CopyWithSceneWithSingleModifiedEvent(copyNode);
+    }
+  else
+    {
+    snode->CopyWithSceneWithoutModifiedEvent(copyNode);
+    }
+  level->NodeCopies[copyNode] = snode;
+  level->NodeCopiesMTime[copyNode] = nodeMTime;
+  // Bulk data (polydata, image data...) is shared between the copy and the
+  // node, only the node properties are accounted.
+  if (this->UndoStackMemoryBudget > 0)
+    {
+    std::stringstream ss;
+    snode->WriteXML(ss, 0);
+    level->Size += static_cast<unsigned long>(ss.str().size());
+    }
 }
 
 //------------------------------------------------------------------------------
-// Make a new collection that has pointers to the current scene nodes
-void vtkMRMLScene::PushIntoRedoStack()
+void vtkMRMLScene::TrimUndoStack()
 {
-  if (this->Nodes == NULL)
+  while (!this->UndoStack.empty() &&
+         ((this->UndoStackSize > 0 &&
+           static_cast<int>(this->UndoStack.size()) > this->UndoStackSize) ||
+          (this->UndoStackMemoryBudget > 0 && this->UndoStack.size() > 1 &&
+           this->GetUndoStackMemorySize() > this->UndoStackMemoryBudget)))
     {
-    return;
+    delete this->UndoStack.front();
+    this->UndoStack.pop_front();
     }
+}
 
-  vtkCollection* newScene = vtkCollection::New();
+//------------------------------------------------------------------------------
+unsigned long vtkMRMLScene::GetUndoStackMemorySize()
+{
+  unsigned long size = 0;
+  std::list< vtkUndoLevel* >::const_iterator iter;
+  for (iter = this->UndoStack.begin(); iter != this->UndoStack.end(); ++iter)
+    {
+    size += (*iter)->Size;
+    }
+  return size;
+}
 
-  vtkCollection* currentScene = this->Nodes;
+//------------------------------------------------------------------------------
+void vtkMRMLScene::GetDataObjectHolders(std::map<vtkDataObject*, int>& holders,
+                                        vtkMRMLNode* excludedNode,
+                                        bool includeSceneViews)
+{
+  vtkSmartPointer<vtkCollection> dataObjects =
+    vtkSmartPointer<vtkCollection>::New();
+  vtkMRMLNode* node = 0;
+  vtkCollectionSimpleIterator it;
+  for (this->Nodes->InitTraversal(it);
+       (node = vtkMRMLNode::SafeDownCast(this->Nodes->GetNextItemAsObject(it))) ;)
+    {
+    if (node == excludedNode ||
+        (!includeSceneViews && node->IsA("vtkMRMLSceneViewNode")))
+      {
+      continue;
+      }
+    dataObjects->RemoveAllItems();
+    node->GetDataObjects(dataObjects);
+    // a node holding the same data object twice is counted once
+    std::set<vtkDataObject*> nodeDataObjects;
+    for (int i = 0; i < dataObjects->GetNumberOfItems(); ++i)
+      {
+      vtkDataObject* dataObject =
+        vtkDataObject::SafeDownCast(dataObjects->GetItemAsObject(i));
+      if (dataObject && nodeDataObjects.insert(dataObject).second)
+        {
+        ++holders[dataObject];
+        }
+      }
+    }
+}
 
-  int nnodes = currentScene->GetNumberOfItems();
+//------------------------------------------------------------------------------
+unsigned long vtkMRMLScene::GetNodeMemorySize(vtkMRMLNode* node, bool shared)
+{
+  if (node == 0)
+    {
+    return 0;
+    }
+  std::map<vtkDataObject*, int> holders;
+  this->GetDataObjectHolders(holders, node, true);
 
-  for (int n=0; n<nnodes; n++)
+  vtkSmartPointer<vtkCollection> dataObjects =
+    vtkSmartPointer<vtkCollection>::New();
+  node->GetDataObjects(dataObjects);
+  vtkSmartPointer<vtkCollection> countedDataObjects =
+    vtkSmartPointer<vtkCollection>::New();
+  for (int i = 0; i < dataObjects->GetNumberOfItems(); ++i)
     {
-    vtkMRMLNode *node  = dynamic_cast < vtkMRMLNode *>(currentScene->GetItemAsObject(n));
-    if (node && !node->IsA("vtkMRMLSceneViewNode"))
+    vtkDataObject* dataObject =
+      vtkDataObject::SafeDownCast(dataObjects->GetItemAsObject(i));
+    if (dataObject && (holders.count(dataObject) != 0) == shared)
       {
-      newScene->AddItem(node);
+      countedDataObjects->AddItem(dataObject);
       }
     }
+  return vtkMRMLScene::GetDataObjectsMemorySize(countedDataObjects);
+}
 
-  //TODO check max stack size
-  this->RedoStack.push_back(newScene);
+//------------------------------------------------------------------------------
+unsigned long vtkMRMLScene::GetNodeOwnedMemorySize(vtkMRMLNode* node)
+{
+  return this->GetNodeMemorySize(node, false);
 }
 
 //------------------------------------------------------------------------------
-// Put a replacement node into the undoable copy of the scene so that the node
-// can be edited
-void vtkMRMLScene::CopyNodeInUndoStack(vtkMRMLNode *copyNode)
+unsigned long vtkMRMLScene::GetNodeSharedMemorySize(vtkMRMLNode* node)
 {
-  if (!copyNode)
-    {
-    vtkErrorMacro("CopyNodeInUndoStack: node is null");
-    return;
-    }
+  return this->GetNodeMemorySize(node, true);
+}
 
-  vtkMRMLNode *snode = copyNode->CreateNodeInstance();
-  if (snode != NULL)
+//------------------------------------------------------------------------------
+unsigned long vtkMRMLScene::GetNodesMemorySize()
+{
+  std::map<vtkDataObject*, int> holders;
+  this->GetDataObjectHolders(holders, 0, true);
+  unsigned long size = 0;
+  std::map<vtkDataObject*, int>::const_iterator it;
+  for (it = holders.begin(); it != holders.end(); ++it)
     {
-    snode->CopyWithSceneWithoutModifiedEvent(copyNode);
+    size += it->first->GetActualMemorySize();
     }
-  vtkCollection* undoScene = dynamic_cast < vtkCollection *>( this->UndoStack.back() );
-  int nnodes = undoScene->GetNumberOfItems();
-  for (int n=0; n<nnodes; n++)
+  return size;
+}
+
+//------------------------------------------------------------------------------
+unsigned long vtkMRMLScene::GetSceneViewsMemorySize()
+{
+  std::map<vtkDataObject*, int> allHolders;
+  this->GetDataObjectHolders(allHolders, 0, true);
+  std::map<vtkDataObject*, int> holders;
+  this->GetDataObjectHolders(holders, 0, false);
+  unsigned long size = 0;
+  std::map<vtkDataObject*, int>::const_iterator it;
+  for (it = allHolders.begin(); it != allHolders.end(); ++it)
     {
-    vtkMRMLNode *node  = dynamic_cast < vtkMRMLNode *>(undoScene->GetItemAsObject(n));
-    if (node == copyNode)
+    if (holders.count(it->first) == 0)
       {
-      undoScene->ReplaceItem (n, snode);
-      break;
+      size += it->first->GetActualMemorySize();
       }
     }
-  snode->Delete();
+  return size;
 }
 
 //------------------------------------------------------------------------------
-// Put a replacement node into the redoable copy of the scene so that the node
-// can be replaced by the Undo version
-void vtkMRMLScene::CopyNodeInRedoStack(vtkMRMLNode *copyNode)
+unsigned long vtkMRMLScene::GetUndoStackDataMemorySize()
 {
-  if (!copyNode)
+  std::map<vtkDataObject*, int> holders;
+  this->GetDataObjectHolders(holders, 0, true);
+
+  // the copies can be shared between levels and stacks
+  std::set<vtkMRMLNode*> nodeCopies;
+  std::list< vtkUndoLevel* > levels(this->UndoStack);
+  levels.insert(levels.end(), this->RedoStack.begin(), this->RedoStack.end());
+  std::list< vtkUndoLevel* >::const_iterator levelIt;
+  for (levelIt = levels.begin(); levelIt != levels.end(); ++levelIt)
     {
-    vtkErrorMacro("CopyNodeInRedoStack: node is null");
-    return;
+    vtkUndoLevel::NodeCopiesType::const_iterator copyIt;
+    for (copyIt = (*levelIt)->NodeCopies.begin();
+         copyIt != (*levelIt)->NodeCopies.end(); ++copyIt)
+      {
+      nodeCopies.insert(copyIt->second.GetPointer());
+      }
     }
-  vtkMRMLNode *snode = copyNode->CreateNodeInstance();
-  if (snode != NULL)
+
+  vtkSmartPointer<vtkCollection> dataObjects =
+    vtkSmartPointer<vtkCollection>::New();
+  std::set<vtkMRMLNode*>::const_iterator copyIt;
+  for (copyIt = nodeCopies.begin(); copyIt != nodeCopies.end(); ++copyIt)
     {
-    snode->CopyWithSceneWithSingleModifiedEvent(copyNode);
+    (*copyIt)->GetDataObjects(dataObjects);
     }
-  vtkCollection* undoScene = dynamic_cast < vtkCollection *>( this->RedoStack.back() );
-  int nnodes = undoScene->GetNumberOfItems();
-  for (int n=0; n<nnodes; n++)
+  vtkSmartPointer<vtkCollection> undoDataObjects =
+    vtkSmartPointer<vtkCollection>::New();
+  for (int i = 0; i < dataObjects->GetNumberOfItems(); ++i)
     {
-    vtkMRMLNode *node  = dynamic_cast < vtkMRMLNode *>(undoScene->GetItemAsObject(n));
-    if (node == copyNode)
+    vtkDataObject* dataObject =
+      vtkDataObject::SafeDownCast(dataObjects->GetItemAsObject(i));
+    if (dataObject && holders.count(dataObject) == 0)
       {
-      undoScene->ReplaceItem (n, snode);
-      break;
+      undoDataObjects->AddItem(dataObject);
       }
     }
-  snode->Delete();
+  return vtkMRMLScene::GetDataObjectsMemorySize(undoDataObjects);
+}
+
+//------------------------------------------------------------------------------
+unsigned long vtkMRMLScene::GetDataObjectsMemorySize(vtkCollection* dataObjects)
+{
+  if (dataObjects == 0)
+    {
+    return 0;
+    }
+  std::set<vtkDataObject*> countedDataObjects;
+  unsigned long size = 0;
+  for (int i = 0; i < dataObjects->GetNumberOfItems(); ++i)
+    {
+    vtkDataObject* dataObject =
+      vtkDataObject::SafeDownCast(dataObjects->GetItemAsObject(i));
+    if (dataObject && countedDataObjects.insert(dataObject).second)
+      {
+      size += dataObject->GetActualMemorySize();
+      }
+    }
+  return size;
 }
 
 //------------------------------------------------------------------------------
@@ -2610,22 +3033,18 @@ void vtkMRMLScene::Undo()
       }
     }
 
-  vtkCollection* undoScene = NULL;
+  vtkUndoLevel* undoLevel = this->UndoStack.back();
   std::vector<std::string> undoIDs;
   std::vector<vtkMRMLNode*> undoNodes;
 
-  if (!this->UndoStack.empty())
+  nnodes = undoLevel->Nodes->GetNumberOfItems();
+  for (n=0; n<nnodes; n++)
     {
-    undoScene = dynamic_cast < vtkCollection *>( this->UndoStack.back() );
-    nnodes = undoScene->GetNumberOfItems();
-    for (n=0; n<nnodes; n++)
+    vtkMRMLNode *node  = dynamic_cast < vtkMRMLNode *>(undoLevel->Nodes->GetItemAsObject(n));
+    if (node && !node->IsA("vtkMRMLSceneViewNode"))
       {
-      vtkMRMLNode *node  = dynamic_cast < vtkMRMLNode *>(undoScene->GetItemAsObject(n));
-      if (node && !node->IsA("vtkMRMLSceneViewNode"))
-        {
-        undoIDs.push_back(node->GetID());
-        undoNodes.push_back(node);
-        }
+      undoIDs.push_back(undoLevel->GetSavedNode(node)->GetID());
+      undoNodes.push_back(node);
       }
     }
 
@@ -2641,17 +3060,23 @@ void vtkMRMLScene::Undo()
     {
     curIterID = std::find(currentIDs.begin(), currentIDs.end(), *iterID);
     curIterNode = currentNodes.begin() + std::distance(currentIDs.begin(), curIterID);
+    vtkMRMLNode* savedNode = undoLevel->GetSavedNode(*iterNode);
     if ( curIterID == currentIDs.end() )
       {
-      // the node was deleted, add Node back to the curreent scene
+      // the node was deleted, restore its saved state and add it back to the
+      // current scene
+      if (savedNode != *iterNode)
+        {
+        (*iterNode)->CopyWithSceneWithSingleModifiedEvent(savedNode);
+        }
       addNodes.push_back(*iterNode);
       }
-    else if (*iterNode != *curIterNode)
+    else if (savedNode != *curIterNode)
       {
       // nodes differ, copy from undo to current scene
       // but before create a copy in redo stack from current
       this->CopyNodeInRedoStack(*curIterNode);
-      (*curIterNode)->CopyWithSceneWithSingleModifiedEvent(*iterNode);
+      (*curIterNode)->CopyWithSceneWithSingleModifiedEvent(savedNode);
       }
     }
 
@@ -2682,18 +3107,11 @@ void vtkMRMLScene::Undo()
       }
     }
 
-  if (undoScene)
-    {
-    undoScene->RemoveAllItems();
-    undoScene->Delete();
-    }
+  delete undoLevel;
+  this->UndoStack.pop_back();
 
   this->RemoveUnusedNodeReferences();
 
-  if (!this->UndoStack.empty())
-   {
-   UndoStack.pop_back();
-   }
   this->Modified();
 
   this->InUndo = false;
@@ -2736,19 +3154,14 @@ void vtkMRMLScene::Redo()
   //std::hash_map<std::string, vtkMRMLNode*> undoMap;
   std::map<std::string, vtkMRMLNode*> undoMap;
 
-  vtkCollection* undoScene = NULL;
-
-  if (!this->RedoStack.empty())
+  vtkUndoLevel* redoLevel = this->RedoStack.back();
+  nnodes = redoLevel->Nodes->GetNumberOfItems();
+  for (n=0; n<nnodes; n++)
     {
-    undoScene = dynamic_cast < vtkCollection *>( this->RedoStack.back() );;
-    nnodes = undoScene->GetNumberOfItems();
-    for (n=0; n<nnodes; n++)
+    vtkMRMLNode *node  = dynamic_cast < vtkMRMLNode *>(redoLevel->Nodes->GetItemAsObject(n));
+    if (node && !node->IsA("vtkMRMLSceneViewNode"))
       {
-      vtkMRMLNode *node  = dynamic_cast < vtkMRMLNode *>(undoScene->GetItemAsObject(n));
-      if (node && !node->IsA("vtkMRMLSceneViewNode"))
-        {
-        undoMap[node->GetID()] = node;
-        }
+      undoMap[redoLevel->GetSavedNode(node)->GetID()] = node;
       }
     }
 
@@ -2763,17 +3176,23 @@ void vtkMRMLScene::Redo()
   for(iter=undoMap.begin(); iter != undoMap.end(); iter++)
     {
     curIter = currentMap.find(iter->first);
+    vtkMRMLNode* savedNode = redoLevel->GetSavedNode(iter->second);
     if ( curIter == currentMap.end() )
       {
-      // the node was deleted, add Node back to the curreent scene
+      // the node was deleted, restore its saved state and add it back to the
+      // current scene
+      if (savedNode != iter->second)
+        {
+        iter->second->CopyWithSceneWithSingleModifiedEvent(savedNode);
+        }
       addNodes.push_back(iter->second);
       }
-    else if (iter->second != curIter->second)
+    else if (savedNode != curIter->second)
       {
       // nodes differ, copy from redo to current scene
       // but before create a copy in undo stack from current
       this->CopyNodeInUndoStack(curIter->second);
-      curIter->second->CopyWithSceneWithSingleModifiedEvent(iter->second);
+      curIter->second->CopyWithSceneWithSingleModifiedEvent(savedNode);
       }
     }
 
@@ -2797,13 +3216,10 @@ void vtkMRMLScene::Redo()
     this->RemoveNode(removeNodes[nn]);
     }
 
-  if (undoScene)
-    {
-    undoScene->RemoveAllItems();
-    undoScene->Delete();
-    }
+  delete redoLevel;
+  this->RedoStack.pop_back();
 
-  RedoStack.pop_back();
+  this->TrimUndoStack();
 
   this->Modified();
 }
@@ -2811,11 +3227,10 @@ void vtkMRMLScene::Redo()
 //------------------------------------------------------------------------------
 void vtkMRMLScene::ClearUndoStack()
 {
-  std::list< vtkCollection* >::iterator iter;
+  std::list< vtkUndoLevel* >::iterator iter;
   for(iter=this->UndoStack.begin(); iter != this->UndoStack.end(); iter++)
     {
-    (*iter)->RemoveAllItems();
-    (*iter)->Delete();
+    delete *iter;
     }
   this->UndoStack.clear();
 }
@@ -2823,11 +3238,10 @@ void vtkMRMLScene::ClearUndoStack()
 //------------------------------------------------------------------------------
 void vtkMRMLScene::ClearRedoStack()
 {
-  std::list< vtkCollection* >::iterator iter;
+  std::list< vtkUndoLevel* >::iterator iter;
   for(iter=this->RedoStack.begin(); iter != this->RedoStack.end(); iter++)
     {
-    (*iter)->RemoveAllItems();
-    (*iter)->Delete();
+    delete *iter;
     }
   this->RedoStack.clear();
 }
@@ -2911,32 +3325,55 @@ const char* vtkMRMLScene::GetChangedID(const char* id)
     }
 }
 
+//------------------------------------------------------------------------------
+void vtkMRMLScene::GetReferenceGraph(ReferenceGraphType& graph)
+{
+  graph.clear();
+  const size_t nrefs = this->ReferencedIDs.size();
+  for (size_t i=0; i<nrefs; ++i)
+    {
+    vtkMRMLNode* node = this->ReferencingNodes[i];
+    if (node == 0)
+      {
+      continue;
+      }
+    // AddReferencedNodeID() prevents duplicate (ID, node) entries
+    graph[this->ReferencedIDs[i]].push_back(node);
+    }
+}
+
 //------------------------------------------------------------------------------
 void vtkMRMLScene::UpdateNodeReferences()
 {
-  std::map< std::string, std::string>::const_iterator iterChanged;
-  //std::map< std::string, vtkMRMLNode*>::const_iterator iterNodes;
+  if (this->ReferencedIDChanges.empty())
+    {
+    return;
+    }
+  // Snapshot the graph before remapping: UpdateReferenceID() registers the
+  // new IDs, they must not be remapped again by a later change.
+  ReferenceGraphType graph;
+  this->GetReferenceGraph(graph);
+  // keep the referencing nodes alive while they are updated
+  std::vector< vtkSmartPointer<vtkMRMLNode> > referencingNodes = this->ReferencingNodes;
 
+  std::map< std::string, std::string>::const_iterator iterChanged;
   for (iterChanged = this->ReferencedIDChanges.begin(); iterChanged != this->ReferencedIDChanges.end(); iterChanged++)
     {
-    std::vector< std::string > referencedIDs = this->ReferencedIDs;
-    std::vector< vtkSmartPointer<vtkMRMLNode> > referencingNodes = this->ReferencingNodes;
-
-    size_t nupdates = referencedIDs.size();
-    for ( size_t i=0; i<nupdates; ++i)
+    ReferenceGraphType::const_iterator referencing = graph.find(iterChanged->first);
+    if (referencing == graph.end())
       {
-      if (iterChanged->first == referencedIDs[i])
+      continue;
+      }
+    std::vector< vtkMRMLNode* >::const_iterator nodeIt;
+    for (nodeIt = referencing->second.begin(); nodeIt != referencing->second.end(); ++nodeIt)
+      {
+      vtkMRMLNode *node = this->GetNodeByID((*nodeIt)->GetID());
+      if (node)
         {
-        vtkMRMLNode *node = this->GetNodeByID(referencingNodes[i]->GetID());
-        if (node)
-          {
-          node->UpdateReferenceID(iterChanged->first.c_str(), iterChanged->second.c_str());
-          }
+        node->UpdateReferenceID(iterChanged->first.c_str(), iterChanged->second.c_str());
         }
+      }
     }
-    this->ReferencedIDs = referencedIDs;
-    this->ReferencingNodes = referencingNodes;
-  }
 }
 
 //------------------------------------------------------------------------------
@@ -2947,30 +3384,41 @@ void vtkMRMLScene::UpdateNodeReferences(vtkCollection* checkNodes)
     vtkErrorMacro("UpdateNodeReferences: no nodes to check");
     return;
     }
-  std::map< std::string, std::string>::const_iterator iterChanged;
-  //std::map< std::string, vtkMRMLNode*>::const_iterator iterNodes;
+  if (this->ReferencedIDChanges.empty())
+    {
+    return;
+    }
+  std::set<vtkObject*> nodesToCheck;
+  vtkObject* checkNode;
+  vtkCollectionSimpleIterator it;
+  for (checkNodes->InitTraversal(it);
+       (checkNode = checkNodes->GetNextItemAsObject(it)) ;)
+    {
+    nodesToCheck.insert(checkNode);
+    }
 
+  ReferenceGraphType graph;
+  this->GetReferenceGraph(graph);
+  // keep the referencing nodes alive while they are updated
+  std::vector< vtkSmartPointer<vtkMRMLNode> > referencingNodes = this->ReferencingNodes;
+
+  std::map< std::string, std::string>::const_iterator iterChanged;
   for (iterChanged = this->ReferencedIDChanges.begin(); iterChanged != this->ReferencedIDChanges.end(); iterChanged++)
     {
-    std::vector< std::string > referencedIDs = this->ReferencedIDs;
-    std::vector< vtkSmartPointer<vtkMRMLNode> > referencingNodes = this->ReferencingNodes;
-    size_t nupdates = referencedIDs.size();
-
-    for (size_t i=0; i<nupdates; ++i)
+    ReferenceGraphType::const_iterator referencing = graph.find(iterChanged->first);
+    if (referencing == graph.end())
       {
-      if (iterChanged->first == referencedIDs[i])
+      continue;
+      }
+    std::vector< vtkMRMLNode* >::const_iterator nodeIt;
+    for (nodeIt = referencing->second.begin(); nodeIt != referencing->second.end(); ++nodeIt)
+      {
+      if (nodesToCheck.find(*nodeIt) != nodesToCheck.end())
         {
-          vtkMRMLNode *node = referencingNodes[i];
-        if (checkNodes->IsItemPresent(node))
-          {
-          node->UpdateReferenceID(iterChanged->first.c_str(), iterChanged->second.c_str());
-          }
+        (*nodeIt)->UpdateReferenceID(iterChanged->first.c_str(), iterChanged->second.c_str());
         }
       }
-    this->ReferencedIDs = referencedIDs;
-    this->ReferencingNodes = referencingNodes;
-  }
-
+    }
 }
 
 //------------------------------------------------------------------------------
@@ -3144,6 +3592,160 @@ void vtkMRMLScene::ClearNodeIDs()
   }
 }
 
+//------------------------------------------------------------------------------
+std::vector<vtkMRMLNode*>& vtkMRMLScene::GetNodesByClassCache(const char* className)
+{
+  assert(className);
+  this->UpdateNodesByClass();
+  std::map< std::string, std::vector<vtkMRMLNode*> >::iterator it =
+    this->NodesByClass.find(std::string(className));
+  if (it != this->NodesByClass.end())
+    {
+    return it->second;
+    }
+  // First time the class is queried, search the whole scene once.
+  std::vector<vtkMRMLNode*>& classNodes =
+    this->NodesByClass[std::string(className)];
+  vtkMRMLNode *node;
+  vtkCollectionSimpleIterator nodeIt;
+  for (this->Nodes->InitTraversal(nodeIt);
+       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(nodeIt)) ;)
+    {
+    if (node->IsA(className))
+      {
+      classNodes.push_back(node);
+      }
+    }
+  return classNodes;
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLScene::UpdateNodesByClass()
+{
+  if (this->Nodes && this->Nodes->GetMTime() > this->NodesByClassMTime)
+    {
+    this->NodesByClass.clear();
+    this->NodesByClassMTime = this->Nodes->GetMTime();
+    }
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLScene::AddNodeToNodesByClass(vtkMRMLNode *node)
+{
+  if (!this->Nodes || !node)
+    {
+    return;
+    }
+  std::map< std::string, std::vector<vtkMRMLNode*> >::iterator it;
+  for (it = this->NodesByClass.begin(); it != this->NodesByClass.end(); ++it)
+    {
+    if (node->IsA(it->first.c_str()))
+      {
+      it->second.push_back(node);
+      }
+    }
+  this->NodesByClassMTime = this->Nodes->GetMTime();
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLScene::RemoveNodeFromNodesByClass(vtkMRMLNode *node)
+{
+  if (!this->Nodes || !node)
+    {
+    return;
+    }
+  std::map< std::string, std::vector<vtkMRMLNode*> >::iterator it;
+  for (it = this->NodesByClass.begin(); it != this->NodesByClass.end(); ++it)
+    {
+    std::vector<vtkMRMLNode*>::iterator nodeIt =
+      std::find(it->second.begin(), it->second.end(), node);
+    if (nodeIt != it->second.end())
+      {
+      it->second.erase(nodeIt);
+      }
+    }
+  this->NodesByClassMTime = this->Nodes->GetMTime();
+}
+
+//------------------------------------------------------------------------------
+bool vtkMRMLScene::IsNodeNameUsed(const std::string& name)
+{
+  this->UpdateNodeNames();
+  if (this->NodeNamesMTime == 0 && this->Nodes)
+    {
+    // First time a name is queried, count the names of the whole scene once.
+    vtkMRMLNode *node;
+    vtkCollectionSimpleIterator it;
+    for (this->Nodes->InitTraversal(it);
+         (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
+      {
+      if (node->GetName())
+        {
+        ++this->NodeNames[std::string(node->GetName())];
+        }
+      }
+    this->NodeNamesMTime = this->Nodes->GetMTime();
+    }
+  return this->NodeNames.find(name) != this->NodeNames.end();
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLScene::UpdateNodeNames()
+{
+  if (this->Nodes && this->Nodes->GetMTime() > this->NodeNamesMTime)
+    {
+    this->NodeNames.clear();
+    this->NodeNamesMTime = 0;
+    }
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLScene::AddNodeName(const char* name)
+{
+  if (!this->Nodes || this->NodeNamesMTime == 0)
+    {
+    // the names are not counted yet
+    return;
+    }
+  if (name)
+    {
+    ++this->NodeNames[std::string(name)];
+    }
+  this->NodeNamesMTime = this->Nodes->GetMTime();
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLScene::RemoveNodeName(const char* name)
+{
+  if (!this->Nodes || this->NodeNamesMTime == 0)
+    {
+    // the names are not counted yet
+    return;
+    }
+  std::map<std::string, int>::iterator it =
+    name ? this->NodeNames.find(std::string(name)) : this->NodeNames.end();
+  if (it != this->NodeNames.end() && --it->second <= 0)
+    {
+    this->NodeNames.erase(it);
+    }
+  this->NodeNamesMTime = this->Nodes->GetMTime();
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLScene::NodeNameChanged(vtkMRMLNode* node, const char* oldName)
+{
+  this->UpdateNodeNames();
+  // Nodes that point to the scene without being in it (e.g. undo copies)
+  // are not counted.
+  if (this->NodeNamesMTime == 0 || node == 0 || node->GetID() == 0 ||
+      this->GetNodeByID(node->GetID()) != node)
+    {
+    return;
+    }
+  this->RemoveNodeName(oldName);
+  this->AddNodeName(node->GetName());
+}
+
 //------------------------------------------------------------------------------
 void vtkMRMLScene::AddURIHandler(vtkURIHandler *handler)
 {
@@ -3244,8 +3846,12 @@ void vtkMRMLScene
   // to get all references up-to-date
   // save the scene into a string
   // and restore it into a new scene
+  // use the binary format, it is faster to parse back
+  int saveToBinaryFormat = this->GetSaveToBinaryFormat();
   this->SetSaveToXMLString(1);
+  this->SetSaveToBinaryFormat(1);
   this->Commit();
+  this->SetSaveToBinaryFormat(saveToBinaryFormat);
   this->CopyRegisteredNodesToScene(newScene);
   newScene->SetSceneXMLString(this->GetSceneXMLString());
   newScene->SetLoadFromXMLString(1);
@@ -25,6 +25,7 @@ Version:   $Revision: 1.18 $
 // STD includes
 #include <list>
 #include <map>
+#include <set>
 #include <vector>
 #include <string>
 
@@ -34,6 +35,7 @@ class vtkTagTable;
 
 class vtkCallbackCommand;
 class vtkCollection;
+class vtkDataObject;
 class vtkGeneralTransform;
 class vtkURIHandler;
 class vtkMRMLNode;
@@ -53,6 +55,9 @@ class VTK_MRML_EXPORT vtkMRMLScene : public vtkObject
   /// so that it can call protected methods, for example UpdateNodeIDs()
   /// but that's the only class that is allowed to do so
   friend class vtkMRMLSceneViewNode;
+  /// make the vtkMRMLNode a friend so that SetName() can call
+  /// NodeNameChanged()
+  friend class vtkMRMLNode;
 
 public:
   static vtkMRMLScene *New();
@@ -90,7 +95,13 @@ public:
   /// Save scene into URL
   int Commit(const char* url=NULL);
 
-  /// Remove nodes and clear undo/redo stacks
+  /// Remove nodes and clear undo/redo stacks.
+  /// The nodes are removed at once within a single CloseState: they are
+  /// detached from the scene together, then NodeAboutToBeRemovedEvent and
+  /// NodeRemovedEvent are invoked for each of them, the referencing nodes
+  /// before the nodes they reference. The undo stack and the node references
+  /// are not updated per node but reset at the end.
+  /// \sa IsClosing()
   void Clear(int removeSingletons);
 
   /// Reset all nodes to their constructor's state
@@ -152,6 +163,20 @@ public:
   /// into the already existing singleton node. That node is then returned.
   vtkMRMLNode* AddNode(vtkMRMLNode *nodeToAdd);
 
+  /// Add a list of nodes to the scene in a single batch.
+  /// The scene is put in BatchProcessState while the nodes are added.
+  /// Contrary to AddNode(), no NodeAboutToBeAddedEvent or NodeAddedEvent
+  /// is fired, but a unique NodesAddedEvent with the vtkCollection of nodes
+  /// effectively added (singletons already in the scene are not part of it)
+  /// as call data. Observers that don't observe NodesAddedEvent are expected
+  /// to synchronize with the scene on EndBatchProcessEvent.
+  /// Returns the number of nodes added into the scene.
+  /// \sa AddNode(), NodesAddedEvent
+  int AddNodes(const std::vector<vtkMRMLNode*>& nodes);
+  /// Utility function for wrapping.
+  /// \sa AddNodes(const std::vector<vtkMRMLNode*>&)
+  int AddNodes(vtkCollection* nodes);
+
   /// Add a copy of a node to the scene.
   vtkMRMLNode* CopyNode(vtkMRMLNode *n);
 
@@ -270,6 +295,49 @@ public:
   /// returns number of redo steps in the history buffer
   int GetNumberOfRedoLevels() { return (int)this->RedoStack.size();};
 
+  /// Maximum number of undo levels kept in the history buffer. When the
+  /// limit is reached, the oldest levels are discarded. 0 means no limit.
+  /// 100 by default.
+  vtkSetMacro(UndoStackSize, int);
+  vtkGetMacro(UndoStackSize, int);
+
+  /// Approximate maximum memory (in bytes) the undo history buffer is allowed
+  /// to use. When exceeded, the oldest undo levels are discarded (the most
+  /// recent level is always kept). 0 (default) means no limit.
+  /// Only the saved node properties are accounted, bulk data (image data,
+  /// polydata...) is shared with the scene nodes.
+  /// \sa GetUndoStackMemorySize()
+  vtkSetMacro(UndoStackMemoryBudget, unsigned long);
+  vtkGetMacro(UndoStackMemoryBudget, unsigned long);
+
+  /// Approximate memory (in bytes) used by the undo history buffer.
+  /// It is only computed if an UndoStackMemoryBudget is set.
+  unsigned long GetUndoStackMemorySize();
+
+  /// Memory accounting of the bulk data (image data, polydata...) held by
+  /// the nodes, as listed by vtkMRMLNode::GetDataObjects(). A data object held
+  /// by several nodes is counted once. The sizes are in kibibytes, as
+  /// vtkDataObject::GetActualMemorySize().
+  /// Memory of the data held by \a node and by no other node of the scene.
+  /// For a scene view node, it is the memory used to store the scene view.
+  /// \sa GetNodeSharedMemorySize()
+  unsigned long GetNodeOwnedMemorySize(vtkMRMLNode* node);
+  /// Memory of the data held by \a node and by other nodes of the scene (e.g.
+  /// node copies or scene views that share the data of the node).
+  unsigned long GetNodeSharedMemorySize(vtkMRMLNode* node);
+  /// Memory of the data held by all the nodes of the scene.
+  unsigned long GetNodesMemorySize();
+  /// Memory of the data held by the scene view nodes and by no other node.
+  unsigned long GetSceneViewsMemorySize();
+  /// Memory of the data held by the node copies of the undo and redo stacks
+  /// that is not held anymore by the nodes of the scene, e.g. image data
+  /// replaced since the state was saved.
+  /// \sa GetUndoStackMemorySize()
+  unsigned long GetUndoStackDataMemorySize();
+  /// Utility function that sums the memory of the data objects of the
+  /// collection, each data object being counted once.
+  static unsigned long GetDataObjectsMemorySize(vtkCollection* dataObjects);
+
   /// Save current state in the undo buffer
   void SaveStateForUndo();
   /// Save current state of the node in the undo buffer
@@ -306,9 +374,14 @@ public:
 
   void RemoveReferencesToNode(vtkMRMLNode *node);
 
+  /// Remap the references of the nodes to the IDs that changed while
+  /// importing (see GetChangedID()). Only the nodes that reference a changed
+  /// ID are updated.
   void UpdateNodeReferences();
 
-  void UpdateNodeReferences(vtkCollection* chekNodes);
+  /// Same as UpdateNodeReferences() but restricted to the nodes in
+  /// \a checkNodes.
+  void UpdateNodeReferences(vtkCollection* checkNodes);
 
   void CopyNodeReferences(vtkMRMLScene *scene);
 
@@ -344,6 +417,17 @@ public:
   /// \sa AddReferencedNodeID(), GetReferencedNodes()
   void GetReferencedSubScene(vtkMRMLNode *node, vtkMRMLScene* newScene);
 
+  /// Reverse reference graph: map each referenced node ID to the nodes
+  /// referencing it (the nodes that called AddReferencedNodeID() for this ID).
+  /// A referencing node is listed once per ID.
+  /// \sa GetReferenceGraph(), vtkMRMLNode::GetNodeReferenceRoles()
+  typedef std::map< std::string, std::vector< vtkMRMLNode* > > ReferenceGraphType;
+
+  /// Build the reverse reference graph in a single pass over the scene
+  /// references. Use vtkMRMLNode::GetNodeReferenceRoles() to know through
+  /// which roles a referencing node references an ID.
+  void GetReferenceGraph(ReferenceGraphType& graph);
+
   /// Return the list of referencing nodes.
   /// Only used for debugging
   const std::vector< vtkSmartPointer<vtkMRMLNode> >& GetReferencingNodes();
@@ -372,6 +456,19 @@ public:
   vtkSetMacro(SaveToXMLString,int);
   vtkGetMacro(SaveToXMLString,int);
 
+  /// This property controls whether Commit() should save the scene using the
+  /// compact binary scene format instead of XML. Binary scenes are faster to
+  /// load, they are automatically detected by Import() and Connect().
+  /// False by default.
+  /// \sa Commit(), vtkMRMLParser::WriteBinaryScene()
+  vtkSetMacro(SaveToBinaryFormat,int);
+  vtkGetMacro(SaveToBinaryFormat,int);
+  vtkBooleanMacro(SaveToBinaryFormat,int);
+
+  /// If false, the storable nodes don't read their data when the scene is
+  /// imported, it is up to the caller to read it afterwards (e.g. in
+  /// parallel). True by default.
+  /// \sa vtkMRMLStorableNode::UpdateScene()
   vtkSetMacro(ReadDataOnLoad,int);
   vtkGetMacro(ReadDataOnLoad,int);
 
@@ -538,6 +635,9 @@ public:
     NodeAddedEvent,
     NodeAboutToBeRemovedEvent,
     NodeRemovedEvent,
+    /// Fired by AddNodes() once all the nodes are added. The call data is
+    /// the vtkCollection of added nodes.
+    NodesAddedEvent,
 
     NewSceneEvent = 66030,
     SceneEditedEvent,
@@ -609,6 +709,29 @@ protected:
   void CopyNodeInUndoStack(vtkMRMLNode *node);
   void CopyNodeInRedoStack(vtkMRMLNode *node);
 
+  class vtkUndoLevel;
+  /// Create a new undo/redo level referencing the current scene nodes.
+  /// The list of nodes is shared with the last level of \a stack if the
+  /// scene didn't change since.
+  vtkUndoLevel* CreateUndoLevel(const std::list<vtkUndoLevel*>& stack);
+  /// Save the state of \a node in the last level of \a stack.
+  void CopyNodeInStack(std::list<vtkUndoLevel*>& stack, vtkMRMLNode *node,
+                       bool singleModifiedEvent);
+  /// Discard the oldest undo levels exceeding UndoStackSize or
+  /// UndoStackMemoryBudget.
+  void TrimUndoStack();
+
+  /// Count for each data object held by the nodes of the scene the number of
+  /// nodes holding it. \a excludedNode and, if \a includeSceneViews is
+  /// false, the scene view nodes are not counted.
+  /// \sa vtkMRMLNode::GetDataObjects()
+  void GetDataObjectHolders(std::map<vtkDataObject*, int>& holders,
+                            vtkMRMLNode* excludedNode,
+                            bool includeSceneViews);
+  /// Sum the memory of the data objects of \a node that are (\a shared is
+  /// true) or are not (\a shared is false) held by other nodes.
+  unsigned long GetNodeMemorySize(vtkMRMLNode* node, bool shared);
+
   /// Add a node to the scene without invoking a NodeAddedEvent event
   /// Use with extreme caution as it might unsynchronize observer.
   vtkMRMLNode* AddNodeNoNotify(vtkMRMLNode *n);
@@ -647,6 +770,43 @@ protected:
   /// Clear NodeIDs map used to speedup GetByID() method
   void ClearNodeIDs();
 
+  /// Return the list of nodes of class \a className (IsA) in the scene,
+  /// in the same order as the Nodes collection.
+  /// The list is computed the first time a class is queried and then kept
+  /// up to date by AddNodeNoNotify() and RemoveNode(). It is used to speedup
+  /// GetNodesByClass(), GetNthNodeByClass() and GetNumberOfNodesByClass().
+  std::vector<vtkMRMLNode*>& GetNodesByClassCache(const char* className);
+
+  /// Syncronize NodesByClass map with the Nodes collection: the cache is
+  /// cleared if the collection has been modified without the scene knowing
+  /// it (e.g. direct calls to GetNodes()->AddItem()).
+  void UpdateNodesByClass();
+
+  /// Add node to the NodesByClass lists the node is a class of.
+  void AddNodeToNodesByClass(vtkMRMLNode *node);
+
+  /// Remove node from all the NodesByClass lists.
+  void RemoveNodeFromNodesByClass(vtkMRMLNode *node);
+
+  /// Return true if a node of the scene is named \a name.
+  /// The names are counted the first time a name is queried and then kept
+  /// up to date by AddNodeNoNotify(), RemoveNode() and NodeNameChanged().
+  /// It is used to speedup GetUniqueNameIndex().
+  bool IsNodeNameUsed(const std::string& name);
+
+  /// Clear the NodeNames counts if the Nodes collection has been modified
+  /// without the scene knowing it.
+  void UpdateNodeNames();
+
+  /// Count a node named \a name in the NodeNames counts.
+  void AddNodeName(const char* name);
+
+  /// Uncount a node named \a name from the NodeNames counts.
+  void RemoveNodeName(const char* name);
+
+  /// Called by vtkMRMLNode::SetName() when a node of the scene is renamed.
+  void NodeNameChanged(vtkMRMLNode* node, const char* oldName);
+
 
   vtkCollection*  Nodes;
   unsigned long   SceneModifiedTime;
@@ -660,11 +820,12 @@ protected:
   std::vector<unsigned long> States;
 
   int  UndoStackSize;
+  unsigned long UndoStackMemoryBudget;
   bool UndoFlag;
   bool InUndo;
 
-  std::list< vtkCollection* >  UndoStack;
-  std::list< vtkCollection* >  RedoStack;
+  std::list< vtkUndoLevel* >  UndoStack;
+  std::list< vtkUndoLevel* >  RedoStack;
 
 
   std::string                 URL;
@@ -672,7 +833,7 @@ protected:
 
   std::map<std::string, int> UniqueIDs;
   std::map<std::string, int> UniqueNames;
-  std::vector<std::string>   ReservedIDs;
+  std::set<std::string>      ReservedIDs;
   
   std::vector< vtkMRMLNode* > RegisteredNodeClasses;
   std::vector< std::string >  RegisteredNodeTags;
@@ -681,6 +842,11 @@ protected:
   std::vector< vtkSmartPointer<vtkMRMLNode> >         ReferencingNodes;
   std::map< std::string, std::string > ReferencedIDChanges;
   std::map< std::string, vtkSmartPointer<vtkMRMLNode> > NodeIDs;
+  /// Nodes of the scene indexed by the class names they have been queried
+  /// with. The nodes are already referenced by the Nodes collection.
+  std::map< std::string, std::vector<vtkMRMLNode*> > NodesByClass;
+  /// Number of nodes of the scene per name.
+  std::map< std::string, int > NodeNames;
 
   std::string ErrorMessage;
 
@@ -690,11 +856,18 @@ protected:
 
   int SaveToXMLString;
 
+  int SaveToBinaryFormat;
+
   int ReadDataOnLoad;
 
   unsigned long NodeIDsMTime;
+  unsigned long NodesByClassMTime;
+  /// 0 until the NodeNames are counted.
+  unsigned long NodeNamesMTime;
 
-  void RemoveAllNodesExceptSingletons();
+  /// Remove all the nodes, except the singletons if \a removeSingletons is
+  /// false, at once (see Clear()). The node references are cleared.
+  void RemoveAllNodes(bool removeSingletons);
 
   vtkSetStringMacro(ClassNameList);
   vtkGetStringMacro(ClassNameList);
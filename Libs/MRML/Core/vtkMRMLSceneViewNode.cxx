@@ -13,10 +13,15 @@ Version:   $Revision: 1.14 $
 =========================================================================auto=*/
 
 // MRML includes
+#include "vtkMRMLCameraNode.h"
+#include "vtkMRMLDisplayNode.h"
 #include "vtkMRMLHierarchyNode.h"
 #include "vtkMRMLScene.h"
 #include "vtkMRMLSceneViewNode.h"
 #include "vtkMRMLSceneViewStorageNode.h"
+#include "vtkMRMLSliceCompositeNode.h"
+#include "vtkMRMLSliceNode.h"
+#include "vtkMRMLViewNode.h"
 
 // VTKsys includes
 #include <vtksys/SystemTools.hxx>
@@ -28,6 +33,7 @@ Version:   $Revision: 1.14 $
 #include <vtkSmartPointer.h>
 
 // STD includes
+#include <algorithm>
 #include <cassert>
 #include <sstream>
 #include <stack>
@@ -35,6 +41,46 @@ Version:   $Revision: 1.14 $
 //----------------------------------------------------------------------------
 vtkMRMLNodeNewMacro(vtkMRMLSceneViewNode);
 
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Nodes whose whole state is written in their XML: the copies of two
+// scene views are interchangeable if their XML is the same.
+bool vtkMRMLSceneViewNodeIsSharable(vtkMRMLNode* node)
+{
+  return vtkMRMLDisplayNode::SafeDownCast(node) ||
+    vtkMRMLSliceNode::SafeDownCast(node) ||
+    vtkMRMLSliceCompositeNode::SafeDownCast(node) ||
+    vtkMRMLViewNode::SafeDownCast(node) ||
+    vtkMRMLCameraNode::SafeDownCast(node);
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLSceneViewNodeHaveSameState(vtkMRMLNode* node1, vtkMRMLNode* node2)
+{
+  if (!node1 || !node2 ||
+      strcmp(node1->GetClassName(), node2->GetClassName()) != 0)
+    {
+    return false;
+    }
+  // The texture is not written in the XML.
+  vtkMRMLDisplayNode* displayNode1 = vtkMRMLDisplayNode::SafeDownCast(node1);
+  vtkMRMLDisplayNode* displayNode2 = vtkMRMLDisplayNode::SafeDownCast(node2);
+  if (displayNode1 &&
+      displayNode1->GetTextureImageData() != displayNode2->GetTextureImageData())
+    {
+    return false;
+    }
+  std::stringstream ss1;
+  node1->WriteXML(ss1, 0);
+  std::stringstream ss2;
+  node2->WriteXML(ss2, 0);
+  return ss1.str() == ss2.str();
+}
+
+} // end of anonymous namespace
+
 //----------------------------------------------------------------------------
 vtkMRMLSceneViewNode::vtkMRMLSceneViewNode()
 {
@@ -261,6 +307,28 @@ void vtkMRMLSceneViewNode::Copy(vtkMRMLNode *anode)
     }
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLSceneViewNode::GetDataObjects(vtkCollection* dataObjects)
+{
+  this->Superclass::GetDataObjects(dataObjects);
+  if (this->ScreenShot)
+    {
+    dataObjects->AddItem(this->ScreenShot);
+    }
+  if (this->Nodes == NULL)
+    {
+    return;
+    }
+  vtkCollection* nodes = this->Nodes->GetNodes();
+  vtkMRMLNode* node = 0;
+  vtkCollectionSimpleIterator it;
+  for (nodes->InitTraversal(it);
+       (node = vtkMRMLNode::SafeDownCast(nodes->GetNextItemAsObject(it))) ;)
+    {
+    node->GetDataObjects(dataObjects);
+    }
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLSceneViewNode::PrintSelf(ostream& os, vtkIndent indent)
 {
@@ -344,14 +412,36 @@ void vtkMRMLSceneViewNode::StoreScene()
     return;
     }
 
-  if (this->Nodes == NULL)
+  // The scene view stored the most recently, maybe this one, is the base
+  // that unchanged nodes are shared with.
+  vtkMRMLSceneViewNode* baseSceneView = 0;
+  std::vector<vtkMRMLNode*> sceneViews;
+  this->Scene->GetNodesByClass("vtkMRMLSceneViewNode", sceneViews);
+  for (std::vector<vtkMRMLNode*>::iterator it = sceneViews.begin();
+       it != sceneViews.end(); ++it)
     {
-    this->Nodes = vtkMRMLScene::New();
+    vtkMRMLSceneViewNode* sceneView = vtkMRMLSceneViewNode::SafeDownCast(*it);
+    if (sceneView && sceneView->Nodes &&
+        sceneView->StoreTime.GetMTime() > 0 &&
+        (!baseSceneView ||
+         sceneView->StoreTime.GetMTime() > baseSceneView->StoreTime.GetMTime()))
+      {
+      baseSceneView = sceneView;
+      }
     }
-  else
+  // Keep the base nodes alive while they are shared, even if they are
+  // the previous nodes of this scene view.
+  vtkSmartPointer<vtkMRMLScene> baseNodes =
+    baseSceneView ? baseSceneView->Nodes : 0;
+
+  // The previous nodes may be shared with other scene views: clearing them
+  // would update the references of the shared nodes, release them instead.
+  if (this->Nodes)
     {
-    this->Nodes->Clear(1);
+    this->Nodes->Delete();
     }
+  this->Nodes = vtkMRMLScene::New();
+  std::vector<vtkSmartPointer<vtkMRMLScene> > sharedNodesScenes;
 
   if (this->GetScene())
     {
@@ -366,6 +456,22 @@ void vtkMRMLSceneViewNode::StoreScene()
     if (this->IncludeNodeInSceneView(node) &&
         node->GetSaveWithScene() )
       {
+      vtkMRMLNode* baseNode = (baseNodes && vtkMRMLSceneViewNodeIsSharable(node)) ?
+        baseNodes->GetNodeByID(node->GetID()) : 0;
+      if (baseNode && baseNode->GetScene() &&
+          vtkMRMLSceneViewNodeHaveSameState(baseNode, node))
+        {
+        // Share the copy, it stays in the scene that owns it.
+        this->Nodes->GetNodes()->vtkCollection::AddItem(baseNode);
+        this->Nodes->AddNodeID(baseNode);
+        if (std::find(sharedNodesScenes.begin(), sharedNodesScenes.end(),
+                      baseNode->GetScene()) == sharedNodesScenes.end())
+          {
+          sharedNodesScenes.push_back(baseNode->GetScene());
+          }
+        continue;
+        }
+
       vtkMRMLNode *newNode = node->CreateNodeInstance();
 
       newNode->SetScene(this->Nodes);
@@ -383,7 +489,9 @@ void vtkMRMLSceneViewNode::StoreScene()
       assert(newNode->GetScene() == this->Nodes);
       }
     }
+  this->SharedNodesScenes = sharedNodesScenes;
   this->Nodes->CopyNodeReferences(this->GetScene());
+  this->StoreTime.Modified();
 }
 
 //----------------------------------------------------------------------------
@@ -479,8 +587,13 @@ void vtkMRMLSceneViewNode::RestoreScene()
         if (snode)
           {
           snode->SetScene(this->Scene);
-          // to prevent copying of default info if not stored in sanpshot
-          snode->CopyWithSingleModifiedEvent(node);
+          // nodes already in the stored state are not modified
+          if (!vtkMRMLSceneViewNodeIsSharable(snode) ||
+              !vtkMRMLSceneViewNodeHaveSameState(snode, node))
+            {
+            // to prevent copying of default info if not stored in sanpshot
+            snode->CopyWithSingleModifiedEvent(node);
+            }
           // to prevent reading data on UpdateScene()
           snode->SetAddToSceneNoModify(0);
           }
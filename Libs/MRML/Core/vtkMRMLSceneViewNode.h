@@ -18,9 +18,13 @@
 #include "vtkMRMLStorableNode.h"
 
 // VTK includes
+#include <vtkSmartPointer.h>
 #include <vtkStdString.h>
 class vtkImageData;
 
+// STD includes
+#include <vector>
+
 class vtkMRMLStorageNode;
 class VTK_MRML_EXPORT vtkMRMLSceneViewNode : public vtkMRMLStorableNode
 {
@@ -47,6 +51,11 @@ class VTK_MRML_EXPORT vtkMRMLSceneViewNode : public vtkMRMLStorableNode
   /// Copy the node's attributes to this object
   virtual void Copy(vtkMRMLNode *node);
 
+  /// Add the screenshot and the bulk data of the stored nodes. The data of
+  /// the nodes left unchanged since the scene view was stored is shared with
+  /// the scene nodes.
+  virtual void GetDataObjects(vtkCollection* dataObjects);
+
   /// 
   /// Get node XML tag name (like Volume, Model)
 //  virtual const char* GetNodeTagName() {return "SceneSnapshot";};
@@ -65,12 +74,17 @@ class VTK_MRML_EXPORT vtkMRMLSceneViewNode : public vtkMRMLStorableNode
   /// when parsing XML file
   virtual void ProcessChildNode(vtkMRMLNode *node);
 
-  /// 
-  /// Store content of the scene
+  ///
+  /// Store content of the scene.
+  /// The display, slice, view and camera nodes that are unchanged since the
+  /// scene view stored the most recently are not copied again: the copies of
+  /// that scene view are shared.
   void StoreScene();
 
-  /// 
-  /// Restore content of the scene from the node
+  ///
+  /// Restore content of the scene from the node.
+  /// The display, slice, view and camera nodes of the scene that are already
+  /// in the stored state are left untouched.
   void RestoreScene();
 
   vtkGetObjectMacro ( Nodes, vtkMRMLScene );
@@ -128,6 +142,13 @@ protected:
   /// The type of the screenshot
   int ScreenShotType;
 
+  /// Scenes of the other scene views that own the node copies shared in
+  /// Nodes (see StoreScene()), kept alive as long as they are shared.
+  std::vector<vtkSmartPointer<vtkMRMLScene> > SharedNodesScenes;
+
+  /// Time of the last StoreScene()
+  vtkTimeStamp StoreTime;
+
 };
 
 #endif
@@ -498,7 +498,7 @@ void vtkMRMLSelectionNode::SetUnitNodeID(const char* quantity, const char* id)
   std::string referenceRole = "Unit/" + safeQuantity;
 
   unsigned long mTime = this->GetMTime();
-  std::map<std::string, std::string>::iterator nodeReferenceIterator =
+  NodeReferenceMRMLAttributeNamesType::iterator nodeReferenceIterator =
     this->NodeReferenceMRMLAttributeNames.find(safeQuantity);
   if (id &&
     nodeReferenceIterator == this->NodeReferenceMRMLAttributeNames.end())
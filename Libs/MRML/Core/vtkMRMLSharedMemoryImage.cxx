@@ -0,0 +1,411 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkMRMLSharedMemoryImage.h"
+#include "vtkMRMLVolumeNode.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
+#include <vtkObjectFactory.h>
+#include <vtkSmartPointer.h>
+
+// STD includes
+#include <cstring>
+
+#ifdef _WIN32
+# include <windows.h>
+#else
+# include <cerrno>
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+namespace
+{
+const char SharedMemoryScheme[] = "slicershm:";
+const char SharedMemoryMagic[8] = {'S', 'L', 'C', 'R', 'S', 'H', 'M', '\0'};
+
+//----------------------------------------------------------------------------
+// Name of the segment for the operating system, empty if fileName is not
+// a valid shared memory file name.
+std::string segmentName(const char* fileName)
+{
+  if (!vtkMRMLSharedMemoryImage::IsSharedMemoryFileName(fileName))
+    {
+    return std::string();
+    }
+  std::string name(fileName + strlen(SharedMemoryScheme));
+  if (name.empty() || name.find_first_of("/\\") != std::string::npos)
+    {
+    return std::string();
+    }
+#ifdef _WIN32
+  return std::string("Local\\") + name;
+#else
+  return std::string("/") + name;
+#endif
+}
+}
+
+//----------------------------------------------------------------------------
+class vtkMRMLSharedMemoryImage::vtkInternal
+{
+public:
+  vtkInternal();
+
+  bool Map(const std::string& name, size_t size, bool create);
+  void Unmap();
+
+  void* Memory;
+  size_t Size;
+#ifdef _WIN32
+  HANDLE Handle;
+#endif
+};
+
+//----------------------------------------------------------------------------
+vtkMRMLSharedMemoryImage::vtkInternal::vtkInternal()
+{
+  this->Memory = 0;
+  this->Size = 0;
+#ifdef _WIN32
+  this->Handle = 0;
+#endif
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLSharedMemoryImage::vtkInternal
+::Map(const std::string& name, size_t size, bool create)
+{
+#ifdef _WIN32
+  if (create)
+    {
+    unsigned long long size64 = size;
+    this->Handle = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL,
+      PAGE_READWRITE, static_cast<DWORD>(size64 >> 32),
+      static_cast<DWORD>(size64 & 0xffffffff), name.c_str());
+    }
+  else
+    {
+    this->Handle = OpenFileMappingA(FILE_MAP_READ, FALSE, name.c_str());
+    }
+  if (!this->Handle)
+    {
+    return false;
+    }
+  this->Memory = MapViewOfFile(this->Handle,
+    create ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ, 0, 0, size);
+  if (this->Memory && !create)
+    {
+    MEMORY_BASIC_INFORMATION info;
+    VirtualQuery(this->Memory, &info, sizeof(info));
+    size = info.RegionSize;
+    }
+#else
+  int fd = create ?
+    shm_open(name.c_str(), O_CREAT | O_TRUNC | O_RDWR, S_IRUSR | S_IWUSR) :
+    shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd == -1)
+    {
+    return false;
+    }
+  struct stat status;
+  if ((create && ftruncate(fd, size) == -1) ||
+      (!create && fstat(fd, &status) == -1))
+    {
+    close(fd);
+    return false;
+    }
+  if (!create)
+    {
+    size = status.st_size;
+    }
+  this->Memory = size == 0 ? MAP_FAILED :
+    mmap(0, size, create ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED,
+         fd, 0);
+  // The mapping stays valid after the descriptor is closed
+  close(fd);
+  if (this->Memory == MAP_FAILED)
+    {
+    this->Memory = 0;
+    }
+#endif
+  if (!this->Memory)
+    {
+    this->Unmap();
+    return false;
+    }
+  this->Size = size;
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLSharedMemoryImage::vtkInternal::Unmap()
+{
+#ifdef _WIN32
+  if (this->Memory)
+    {
+    UnmapViewOfFile(this->Memory);
+    }
+  if (this->Handle)
+    {
+    CloseHandle(this->Handle);
+    }
+  this->Handle = 0;
+#else
+  if (this->Memory)
+    {
+    munmap(this->Memory, this->Size);
+    }
+#endif
+  this->Memory = 0;
+  this->Size = 0;
+}
+
+//----------------------------------------------------------------------------
+vtkCxxRevisionMacro(vtkMRMLSharedMemoryImage, "$Revision: 1.0 $");
+vtkStandardNewMacro(vtkMRMLSharedMemoryImage);
+
+//----------------------------------------------------------------------------
+vtkMRMLSharedMemoryImage::vtkMRMLSharedMemoryImage()
+{
+  this->Internal = new vtkInternal;
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLSharedMemoryImage::~vtkMRMLSharedMemoryImage()
+{
+  this->Close();
+  delete this->Internal;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLSharedMemoryImage::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "Open: " << this->IsOpen() << "\n";
+  os << indent << "Size: " << this->Internal->Size << "\n";
+  const HeaderType* header = this->GetHeader();
+  if (header)
+    {
+    os << indent << "ScalarType: " << header->ScalarType << "\n";
+    os << indent << "NumberOfComponents: " << header->NumberOfComponents << "\n";
+    os << indent << "Dimensions: " << header->Dimensions[0] << " "
+       << header->Dimensions[1] << " " << header->Dimensions[2] << "\n";
+    }
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLSharedMemoryImage::IsSharedMemoryFileName(const char* fileName)
+{
+  return fileName &&
+    strncmp(fileName, SharedMemoryScheme, strlen(SharedMemoryScheme)) == 0;
+}
+
+//----------------------------------------------------------------------------
+std::string vtkMRMLSharedMemoryImage::GetSharedMemoryFileName(const std::string& name)
+{
+  return std::string(SharedMemoryScheme) + name;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLSharedMemoryImage::Create(const char* fileName, const HeaderType& header)
+{
+  this->Close();
+  std::string name = segmentName(fileName);
+  if (name.empty())
+    {
+    vtkErrorMacro(<< "Create: invalid shared memory name "
+                  << (fileName ? fileName : "(null)"));
+    return false;
+    }
+  if (!this->Internal->Map(name, sizeof(HeaderType) + header.DataSize, true))
+    {
+    vtkErrorMacro(<< "Create: failed to create shared memory " << fileName);
+    return false;
+    }
+  HeaderType* segmentHeader = static_cast<HeaderType*>(this->Internal->Memory);
+  *segmentHeader = header;
+  memcpy(segmentHeader->Magic, SharedMemoryMagic, sizeof(SharedMemoryMagic));
+  segmentHeader->Version = HeaderVersion;
+  segmentHeader->HeaderSize = sizeof(HeaderType);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLSharedMemoryImage::Open(const char* fileName)
+{
+  this->Close();
+  std::string name = segmentName(fileName);
+  if (name.empty() || !this->Internal->Map(name, 0, false))
+    {
+    return false;
+    }
+  const HeaderType* header = this->GetHeader();
+  if (this->Internal->Size < sizeof(HeaderType) ||
+      memcmp(header->Magic, SharedMemoryMagic, sizeof(SharedMemoryMagic)) != 0 ||
+      header->Version != HeaderVersion ||
+      header->HeaderSize < sizeof(HeaderType) ||
+      header->HeaderSize + header->DataSize > this->Internal->Size)
+    {
+    vtkErrorMacro(<< "Open: " << fileName << " is not a valid image segment");
+    this->Close();
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLSharedMemoryImage::Close()
+{
+  this->Internal->Unmap();
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLSharedMemoryImage::IsOpen()const
+{
+  return this->Internal->Memory != 0;
+}
+
+//----------------------------------------------------------------------------
+const vtkMRMLSharedMemoryImage::HeaderType* vtkMRMLSharedMemoryImage::GetHeader()const
+{
+  return static_cast<const HeaderType*>(this->Internal->Memory);
+}
+
+//----------------------------------------------------------------------------
+void* vtkMRMLSharedMemoryImage::GetData()const
+{
+  const HeaderType* header = this->GetHeader();
+  return header ?
+    static_cast<char*>(this->Internal->Memory) + header->HeaderSize : 0;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLSharedMemoryImage::WriteImage(const char* fileName,
+                                          vtkImageData* image,
+                                          vtkMatrix4x4* ijkToRAS)
+{
+  if (!image || !image->GetScalarPointer())
+    {
+    vtkErrorMacro(<< "WriteImage: no image to write in " << fileName);
+    return false;
+    }
+  HeaderType header;
+  memset(&header, 0, sizeof(header));
+  header.ScalarType = image->GetScalarType();
+  header.NumberOfComponents = image->GetNumberOfScalarComponents();
+  image->GetDimensions(header.Dimensions);
+  for (int i = 0; i < 4; ++i)
+    {
+    for (int j = 0; j < 4; ++j)
+      {
+      header.IJKToRAS[i * 4 + j] =
+        ijkToRAS ? ijkToRAS->GetElement(i, j) : (i == j ? 1. : 0.);
+      }
+    }
+  header.DataSize = static_cast<vtkTypeUInt64>(header.Dimensions[0]) *
+    header.Dimensions[1] * header.Dimensions[2] *
+    header.NumberOfComponents * image->GetScalarSize();
+  if (!this->Create(fileName, header))
+    {
+    return false;
+    }
+  memcpy(this->GetData(), image->GetScalarPointer(),
+         static_cast<size_t>(header.DataSize));
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLSharedMemoryImage::WriteVolume(const char* fileName,
+                                           vtkMRMLVolumeNode* volumeNode)
+{
+  if (!volumeNode)
+    {
+    return false;
+    }
+  vtkSmartPointer<vtkMatrix4x4> ijkToRAS = vtkSmartPointer<vtkMatrix4x4>::New();
+  volumeNode->GetIJKToRASMatrix(ijkToRAS);
+  return this->WriteImage(fileName, volumeNode->GetImageData(), ijkToRAS);
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLSharedMemoryImage::ReadImage(const char* fileName,
+                                         vtkImageData* image,
+                                         vtkMatrix4x4* ijkToRAS)
+{
+  if (!image || !this->Open(fileName))
+    {
+    return false;
+    }
+  const HeaderType* header = this->GetHeader();
+  image->SetDimensions(const_cast<int*>(header->Dimensions));
+  image->SetOrigin(0., 0., 0.);
+  image->SetSpacing(1., 1., 1.);
+  image->SetScalarType(header->ScalarType);
+  image->SetNumberOfScalarComponents(header->NumberOfComponents);
+  image->AllocateScalars();
+  vtkTypeUInt64 size = static_cast<vtkTypeUInt64>(header->Dimensions[0]) *
+    header->Dimensions[1] * header->Dimensions[2] *
+    header->NumberOfComponents * image->GetScalarSize();
+  if (size != header->DataSize)
+    {
+    vtkErrorMacro(<< "ReadImage: " << fileName << " has " << header->DataSize
+                  << " bytes of voxels, " << size << " expected");
+    this->Close();
+    return false;
+    }
+  memcpy(image->GetScalarPointer(), this->GetData(), static_cast<size_t>(size));
+  if (ijkToRAS)
+    {
+    ijkToRAS->DeepCopy(header->IJKToRAS);
+    }
+  this->Close();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLSharedMemoryImage::ReadVolume(const char* fileName,
+                                          vtkMRMLVolumeNode* volumeNode)
+{
+  if (!volumeNode)
+    {
+    return false;
+    }
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  vtkSmartPointer<vtkMatrix4x4> ijkToRAS = vtkSmartPointer<vtkMatrix4x4>::New();
+  if (!this->ReadImage(fileName, image, ijkToRAS))
+    {
+    return false;
+    }
+  volumeNode->SetIJKToRASMatrix(ijkToRAS);
+  volumeNode->SetAndObserveImageData(image);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLSharedMemoryImage::Remove(const char* fileName)
+{
+  std::string name = segmentName(fileName);
+  if (name.empty())
+    {
+    return false;
+    }
+#ifdef _WIN32
+  return true;
+#else
+  return shm_unlink(name.c_str()) == 0 || errno == ENOENT;
+#endif
+}
@@ -0,0 +1,131 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#ifndef __vtkMRMLSharedMemoryImage_h
+#define __vtkMRMLSharedMemoryImage_h
+
+// MRML includes
+#include "vtkMRML.h"
+class vtkMRMLVolumeNode;
+
+// VTK includes
+#include <vtkObject.h>
+class vtkImageData;
+class vtkMatrix4x4;
+
+// STD includes
+#include <string>
+
+/// \brief Volume exchanged between processes through a named shared memory
+/// segment.
+///
+/// The segment holds a small header (HeaderType) followed by the raw voxels
+/// of the image. A segment is referred to with a file name using the
+/// "slicershm:" scheme (e.g. "slicershm:ABCD_vtkMRMLScalarVolumeNodeB") so it
+/// can be given on a command line in place of a file. Executable command
+/// line modules read and write such "files" with the ImageIO of
+/// itkSharedMemoryImageIO.h, which must follow the same layout.
+///
+/// On POSIX systems a segment lives until Remove() is called, even after the
+/// process that created it exits. On Windows a segment is destroyed when the
+/// last process that opened it closes it: the creator must keep the object
+/// alive while the segment is in use.
+class VTK_MRML_EXPORT vtkMRMLSharedMemoryImage : public vtkObject
+{
+public:
+  static vtkMRMLSharedMemoryImage *New();
+  vtkTypeRevisionMacro(vtkMRMLSharedMemoryImage, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  enum
+    {
+    HeaderVersion = 1
+    };
+
+  /// Layout of the beginning of a segment. The voxels start HeaderSize bytes
+  /// after the beginning of the segment.
+  struct HeaderType
+    {
+    char Magic[8];
+    vtkTypeUInt32 Version;
+    vtkTypeUInt32 HeaderSize;
+    /// VTK scalar type of the voxels (VTK_SHORT, VTK_FLOAT...)
+    vtkTypeInt32 ScalarType;
+    vtkTypeInt32 NumberOfComponents;
+    vtkTypeInt32 Dimensions[3];
+    vtkTypeInt32 Padding;
+    /// Row major IJK to RAS matrix
+    double IJKToRAS[16];
+    /// Size of the voxel buffer in bytes
+    vtkTypeUInt64 DataSize;
+    };
+
+  /// Return true if \a fileName uses the "slicershm:" scheme.
+  static bool IsSharedMemoryFileName(const char* fileName);
+
+  /// Return "slicershm:" followed by \a name.
+  static std::string GetSharedMemoryFileName(const std::string& name);
+
+  /// Create the segment \a fileName large enough for the voxels described
+  /// by \a header and copy the header into it. Magic, Version and HeaderSize
+  /// are set by the method.
+  /// An already opened segment is closed first.
+  /// \sa GetData(), Close()
+  bool Create(const char* fileName, const HeaderType& header);
+
+  /// Map the existing segment \a fileName and check its header.
+  /// \sa GetHeader(), GetData(), Close()
+  bool Open(const char* fileName);
+
+  /// Unmap the segment. It is not removed.
+  /// \sa Remove()
+  void Close();
+
+  bool IsOpen()const;
+  /// Header of the opened segment, 0 if no segment is opened.
+  const HeaderType* GetHeader()const;
+  /// Voxels of the opened segment, 0 if no segment is opened.
+  void* GetData()const;
+
+  /// Create the segment \a fileName and copy \a image and \a ijkToRAS into
+  /// it. The segment is left opened.
+  bool WriteImage(const char* fileName, vtkImageData* image,
+                  vtkMatrix4x4* ijkToRAS);
+  /// Utility method that writes the image data and the IJKToRAS matrix of
+  /// \a volumeNode.
+  bool WriteVolume(const char* fileName, vtkMRMLVolumeNode* volumeNode);
+
+  /// Copy the voxels and the matrix of the segment \a fileName into
+  /// \a image and \a ijkToRAS. The segment is closed afterward.
+  bool ReadImage(const char* fileName, vtkImageData* image,
+                 vtkMatrix4x4* ijkToRAS);
+  /// Utility method that sets a new image data and the IJKToRAS matrix
+  /// of the segment \a fileName to \a volumeNode.
+  bool ReadVolume(const char* fileName, vtkMRMLVolumeNode* volumeNode);
+
+  /// Destroy the segment \a fileName. On Windows, the segment is destroyed
+  /// when it is closed by all the processes and this method does nothing.
+  /// Return true if the segment doesn't exist anymore.
+  static bool Remove(const char* fileName);
+
+protected:
+  vtkMRMLSharedMemoryImage();
+  virtual ~vtkMRMLSharedMemoryImage();
+
+  class vtkInternal;
+  vtkInternal* Internal;
+
+private:
+  vtkMRMLSharedMemoryImage(const vtkMRMLSharedMemoryImage&);  // Not implemented.
+  void operator=(const vtkMRMLSharedMemoryImage&);  // Not implemented.
+};
+
+#endif
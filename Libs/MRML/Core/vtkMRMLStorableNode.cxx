@@ -237,6 +237,13 @@ void vtkMRMLStorableNode::UpdateScene(vtkMRMLScene *scene)
     return;
     }
 
+  // the data is read later on by the caller (e.g. in parallel by the
+  // application logic)
+  if (scene && !scene->GetReadDataOnLoad())
+    {
+    return;
+    }
+
   int numStorageNodes = this->GetNumberOfNodeReferences(this->GetStorageNodeReferenceRole());
 
   vtkDebugMacro("UpdateScene: going through the storage node ids: " <<  numStorageNodes);
@@ -42,6 +42,7 @@ vtkMRMLStorageNode::vtkMRMLStorageNode()
   this->URI = NULL;
   this->URIHandler = NULL;
   this->UseCompression = 1;
+  this->CompressionLevel = -1;
   this->ReadState = this->Idle;
   this->WriteState = this->Idle;
   this->URIHandler = NULL;
@@ -176,6 +177,10 @@ void vtkMRMLStorageNode::WriteXML(ostream& of, int nIndent)
   std::stringstream ss;
   ss << this->UseCompression;
   of << indent << " useCompression=\"" << ss.str() << "\"";
+  if (this->CompressionLevel != -1)
+    {
+    of << indent << " compressionLevel=\"" << this->CompressionLevel << "\"";
+    }
 
   of << indent << " readState=\"" << this->ReadState <<  "\"";
   of << indent << " writeState=\"" << this->WriteState <<  "\"";
@@ -282,6 +287,12 @@ void vtkMRMLStorageNode::ReadXMLAttributes(const char** atts)
       ss << attValue;
       ss >> this->UseCompression;
       }
+    else if (!strcmp(attName, "compressionLevel"))
+      {
+      std::stringstream ss;
+      ss << attValue;
+      ss >> this->CompressionLevel;
+      }
     else if (!strcmp(attName, "readState"))
       {
       std::stringstream ss;
@@ -321,6 +332,7 @@ void vtkMRMLStorageNode::Copy(vtkMRMLNode *anode)
     this->AddURI(node->GetNthURI(i));
     }
   this->SetUseCompression(node->UseCompression);
+  this->SetCompressionLevel(node->CompressionLevel);
   this->SetReadState(node->ReadState);
   this->SetWriteState(node->WriteState);
 
@@ -346,6 +358,7 @@ void vtkMRMLStorageNode::PrintSelf(ostream& os, vtkIndent indent)
     os << indent << "URIListMember: " << this->GetNthURI(i) << "\n";
     }
   os << indent << "UseCompression:   " << this->UseCompression << "\n";
+  os << indent << "CompressionLevel: " << this->CompressionLevel << "\n";
   os << indent << "ReadState:  " << this->GetReadStateAsString() << "\n";
   os << indent << "WriteState: " << this->GetWriteStateAsString() << "\n";
   os << indent << "SupportedWriteFileTypes: \n";
@@ -1026,6 +1039,12 @@ void vtkMRMLStorageNode::InvalidateFile()
   this->StoredTime = vtkTimeStamp::New();
 }
 
+//------------------------------------------------------------------------------
+void vtkMRMLStorageNode::StoredTimeModified()
+{
+  this->StoredTime->Modified();
+}
+
 //------------------------------------------------------------------------------
 vtkTimeStamp vtkMRMLStorageNode::GetStoredTime()
 {
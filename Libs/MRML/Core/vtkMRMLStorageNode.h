@@ -84,6 +84,13 @@ public:
   vtkGetMacro(UseCompression, int);
   vtkSetMacro(UseCompression, int);
 
+  ///
+  /// Level of the compression on write, from 0 (none) to 9 (best).
+  /// -1 (default) uses the default level of the file format.
+  /// Only used by the writers supporting it (e.g. NRRD).
+  vtkGetMacro(CompressionLevel, int);
+  vtkSetMacro(CompressionLevel, int);
+
   /// 
   /// Location of the remote copy of this file.
   vtkSetStringMacro(URI);
@@ -247,6 +254,12 @@ public:
   /// Use with care, typically called by the cache manager.
   void InvalidateFile();
 
+  /// Inform that the file has just been read into the reference node
+  /// without going through ReadData(), e.g. when the reading has been
+  /// done on a detached copy of the reference node in another thread.
+  /// \sa ReadData(), GetStoredTime()
+  void StoredTimeModified();
+
   /// Return the last time stamp when a reference node has been
   /// read in or written from.
   vtkTimeStamp GetStoredTime();
@@ -303,6 +316,7 @@ protected:
   char *URI;
   vtkURIHandler *URIHandler;
   int UseCompression;
+  int CompressionLevel;
   int ReadState;
   int WriteState;
 
@@ -0,0 +1,40 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkMRMLStringMap.h"
+
+// VTK includes
+#include <vtkCriticalSection.h>
+
+// STD includes
+#include <set>
+
+namespace
+{
+vtkSimpleCriticalSection InternedStringsLock;
+// allocated on first use and never deleted, so that the strings outlive
+// any static node
+std::set<std::string>* InternedStrings = 0;
+}
+
+//----------------------------------------------------------------------------
+const std::string& vtkMRMLInternString(const char* str)
+{
+  InternedStringsLock.Lock();
+  if (!InternedStrings)
+    {
+    InternedStrings = new std::set<std::string>;
+    }
+  const std::string& internedString = *InternedStrings->insert(std::string(str ? str : "")).first;
+  InternedStringsLock.Unlock();
+  return internedString;
+}
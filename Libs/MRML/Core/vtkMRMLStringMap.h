@@ -0,0 +1,133 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#ifndef __vtkMRMLStringMap_h
+#define __vtkMRMLStringMap_h
+
+// MRML includes
+#include "vtkMRML.h"
+
+// STD includes
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// Return the copy of str held in a table shared by all the MRML nodes.
+/// Copying the returned string shares its storage with the table when the
+/// std::string implementation is copy-on-write. The table only grows, it is
+/// meant for the few distinct attribute names and reference roles.
+/// Thread safe.
+VTK_MRML_EXPORT const std::string& vtkMRMLInternString(const char* str);
+
+/// \brief Small map keyed by strings, stored as a vector sorted by key.
+///
+/// Used by vtkMRMLNode for its attributes and node references: a node has
+/// few of them, so a flat vector is smaller and faster to search than a
+/// std::map. The interface is the subset of std::map used by the nodes, the
+/// lookups also accept a const char* to not construct a std::string.
+/// The keys are interned with vtkMRMLInternString.
+///
+/// Unlike std::map, adding or erasing a key invalidates the iterators and
+/// the references to the values.
+template <class T>
+class vtkMRMLStringMap
+{
+public:
+  typedef std::string key_type;
+  typedef T mapped_type;
+  typedef std::pair<std::string, T> value_type;
+  typedef typename std::vector<value_type>::iterator iterator;
+  typedef typename std::vector<value_type>::const_iterator const_iterator;
+  typedef typename std::vector<value_type>::size_type size_type;
+
+  iterator begin() { return this->Items.begin(); }
+  iterator end() { return this->Items.end(); }
+  const_iterator begin()const { return this->Items.begin(); }
+  const_iterator end()const { return this->Items.end(); }
+  size_type size()const { return this->Items.size(); }
+  bool empty()const { return this->Items.empty(); }
+  void clear() { this->Items.clear(); }
+
+  iterator find(const char* key)
+    {
+    iterator it = this->LowerBound(key);
+    return (it != this->Items.end() && it->first == key) ? it : this->Items.end();
+    }
+  const_iterator find(const char* key)const
+    {
+    return const_cast<vtkMRMLStringMap*>(this)->find(key);
+    }
+  iterator find(const std::string& key) { return this->find(key.c_str()); }
+  const_iterator find(const std::string& key)const { return this->find(key.c_str()); }
+
+  size_type count(const char* key)const
+    {
+    return this->find(key) == this->end() ? 0 : 1;
+    }
+  size_type count(const std::string& key)const { return this->count(key.c_str()); }
+
+  /// Insert a default value if there is no item with that key yet
+  T& operator[](const char* key)
+    {
+    iterator it = this->LowerBound(key);
+    if (it == this->Items.end() || it->first != key)
+      {
+      it = this->Items.insert(it, value_type(vtkMRMLInternString(key), T()));
+      }
+    return it->second;
+    }
+  T& operator[](const std::string& key) { return (*this)[key.c_str()]; }
+
+  void erase(iterator it) { this->Items.erase(it); }
+  size_type erase(const char* key)
+    {
+    iterator it = this->find(key);
+    if (it == this->Items.end())
+      {
+      return 0;
+      }
+    this->Items.erase(it);
+    return 1;
+    }
+  size_type erase(const std::string& key) { return this->erase(key.c_str()); }
+
+  bool operator==(const vtkMRMLStringMap& other)const { return this->Items == other.Items; }
+  bool operator!=(const vtkMRMLStringMap& other)const { return this->Items != other.Items; }
+
+protected:
+  struct KeyLess
+    {
+    bool operator()(const value_type& item, const char* key)const
+      {
+      return strcmp(item.first.c_str(), key) < 0;
+      }
+    // for the debug checks of the standard libraries
+    bool operator()(const char* key, const value_type& item)const
+      {
+      return strcmp(key, item.first.c_str()) < 0;
+      }
+    bool operator()(const value_type& item1, const value_type& item2)const
+      {
+      return item1.first < item2.first;
+      }
+    };
+
+  iterator LowerBound(const char* key)
+    {
+    return std::lower_bound(this->Items.begin(), this->Items.end(), key, KeyLess());
+    }
+
+  std::vector<value_type> Items;
+};
+
+#endif
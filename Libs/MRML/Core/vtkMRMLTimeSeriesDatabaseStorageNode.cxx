@@ -0,0 +1,250 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkMRMLScalarVolumeNode.h"
+#include "vtkMRMLTimeSeriesDatabaseStorageNode.h"
+
+// vtkITK includes
+#include "vtkITKTimeSeriesDatabase.h"
+
+// VTK includes
+#include <vtkImageChangeInformation.h>
+#include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkStringArray.h>
+
+// STD includes
+#include <sstream>
+
+//----------------------------------------------------------------------------
+vtkMRMLNodeNewMacro(vtkMRMLTimeSeriesDatabaseStorageNode);
+
+//----------------------------------------------------------------------------
+vtkMRMLTimeSeriesDatabaseStorageNode::vtkMRMLTimeSeriesDatabaseStorageNode()
+{
+  this->CurrentImage = 0;
+  this->CacheSizeInMiB = 256.;
+  this->PrefetchTimePoints = 1;
+  this->Database = NULL;
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLTimeSeriesDatabaseStorageNode::~vtkMRMLTimeSeriesDatabaseStorageNode()
+{
+  if (this->Database)
+    {
+    this->Database->Disconnect();
+    this->Database->Delete();
+    this->Database = NULL;
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTimeSeriesDatabaseStorageNode::WriteXML(ostream& of, int nIndent)
+{
+  Superclass::WriteXML(of, nIndent);
+  vtkIndent indent(nIndent);
+
+  of << indent << " currentImage=\"" << this->CurrentImage << "\"";
+  of << indent << " cacheSizeInMiB=\"" << this->CacheSizeInMiB << "\"";
+  of << indent << " prefetchTimePoints=\"" << this->PrefetchTimePoints << "\"";
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTimeSeriesDatabaseStorageNode::ReadXMLAttributes(const char** atts)
+{
+  int disabledModify = this->StartModify();
+
+  Superclass::ReadXMLAttributes(atts);
+
+  const char* attName;
+  const char* attValue;
+  while (*atts != NULL)
+    {
+    attName = *(atts++);
+    attValue = *(atts++);
+    if (!strcmp(attName, "currentImage"))
+      {
+      std::stringstream ss;
+      ss << attValue;
+      ss >> this->CurrentImage;
+      }
+    else if (!strcmp(attName, "cacheSizeInMiB"))
+      {
+      std::stringstream ss;
+      ss << attValue;
+      ss >> this->CacheSizeInMiB;
+      }
+    else if (!strcmp(attName, "prefetchTimePoints"))
+      {
+      std::stringstream ss;
+      ss << attValue;
+      ss >> this->PrefetchTimePoints;
+      }
+    }
+
+  this->EndModify(disabledModify);
+}
+
+//----------------------------------------------------------------------------
+// Copy the node's attributes to this object.
+// Does NOT copy: ID, FilePrefix, Name, StorageID
+void vtkMRMLTimeSeriesDatabaseStorageNode::Copy(vtkMRMLNode *anode)
+{
+  int disabledModify = this->StartModify();
+
+  Superclass::Copy(anode);
+  vtkMRMLTimeSeriesDatabaseStorageNode *node =
+    vtkMRMLTimeSeriesDatabaseStorageNode::SafeDownCast(anode);
+  if (node)
+    {
+    this->SetCurrentImage(node->CurrentImage);
+    this->SetCacheSizeInMiB(node->CacheSizeInMiB);
+    this->SetPrefetchTimePoints(node->PrefetchTimePoints);
+    }
+
+  this->EndModify(disabledModify);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTimeSeriesDatabaseStorageNode::PrintSelf(ostream& os, vtkIndent indent)
+{
+  Superclass::PrintSelf(os,indent);
+  os << indent << "CurrentImage:   " << this->CurrentImage << "\n";
+  os << indent << "CacheSizeInMiB:   " << this->CacheSizeInMiB << "\n";
+  os << indent << "PrefetchTimePoints:   " << this->PrefetchTimePoints << "\n";
+  os << indent << "ConnectedFileName:   " << this->ConnectedFileName << "\n";
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLTimeSeriesDatabaseStorageNode::CanReadInReferenceNode(vtkMRMLNode *refNode)
+{
+  return refNode->IsA("vtkMRMLScalarVolumeNode") &&
+         !refNode->IsA("vtkMRMLTensorVolumeNode");
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLTimeSeriesDatabaseStorageNode::CanWriteFromReferenceNode(vtkMRMLNode *vtkNotUsed(refNode))
+{
+  return false;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTimeSeriesDatabaseStorageNode::InitializeSupportedReadFileTypes()
+{
+  this->SupportedReadFileTypes->InsertNextValue("Time Series Database (.tsd)");
+}
+
+//----------------------------------------------------------------------------
+const char* vtkMRMLTimeSeriesDatabaseStorageNode::GetDefaultWriteFileExtension()
+{
+  return "tsd";
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLTimeSeriesDatabaseStorageNode::ConnectDatabase()
+{
+  std::string fullName = this->GetFullNameFromFileName();
+  if (fullName.empty())
+    {
+    vtkErrorMacro("ConnectDatabase: File name not specified");
+    return false;
+    }
+  if (this->Database == NULL)
+    {
+    this->Database = vtkITKTimeSeriesDatabase::New();
+    }
+  // The cached blocks are kept as long as the file doesn't change
+  if (fullName != this->ConnectedFileName)
+    {
+    this->ConnectedFileName.clear();
+    if (!this->Database->Connect(fullName.c_str()))
+      {
+      return false;
+      }
+    this->ConnectedFileName = fullName;
+    }
+  if (this->Database->GetCacheSizeInMiB() != this->CacheSizeInMiB)
+    {
+    this->Database->SetCacheSizeInMiB(this->CacheSizeInMiB);
+    }
+  unsigned int prefetchTimePoints = static_cast<unsigned int>(
+    this->PrefetchTimePoints > 0 ? this->PrefetchTimePoints : 0);
+  if (this->Database->GetPrefetchTimePoints() != prefetchTimePoints)
+    {
+    this->Database->SetPrefetchTimePoints(prefetchTimePoints);
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLTimeSeriesDatabaseStorageNode::GetNumberOfImages()
+{
+  if (!this->ConnectDatabase())
+    {
+    return 0;
+    }
+  return this->Database->GetNumberOfVolumes();
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLTimeSeriesDatabaseStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
+{
+  vtkMRMLScalarVolumeNode* volNode = vtkMRMLScalarVolumeNode::SafeDownCast(refNode);
+  if (volNode == NULL)
+    {
+    vtkErrorMacro("ReadData: Reference node is expected to be a vtkMRMLScalarVolumeNode");
+    return 0;
+    }
+  if (!this->ConnectDatabase())
+    {
+    vtkErrorMacro("ReadData: Cannot open time series database: "
+                  << this->GetFullNameFromFileName());
+    return 0;
+    }
+  if (this->CurrentImage < 0 ||
+      this->CurrentImage >= this->Database->GetNumberOfVolumes())
+    {
+    vtkErrorMacro("ReadData: Image " << this->CurrentImage << " is not in [0, "
+                  << this->Database->GetNumberOfVolumes() << "[");
+    return 0;
+    }
+
+  this->Database->SetCurrentImage(this->CurrentImage);
+  vtkNew<vtkImageChangeInformation> ici;
+  ici->SetInput(this->Database->GetOutput());
+  ici->SetOutputSpacing( 1, 1, 1 );
+  ici->SetOutputOrigin( 0, 0, 0 );
+  try
+    {
+    ici->Update();
+    }
+  catch (...)
+    {
+    vtkErrorMacro("ReadData: Cannot read image " << this->CurrentImage
+                  << " of " << this->ConnectedFileName);
+    return 0;
+    }
+
+  // The database reuses its output for the next images
+  vtkNew<vtkImageData> image;
+  image->DeepCopy(ici->GetOutput());
+  volNode->SetAndObserveImageData(image.GetPointer());
+
+  vtkNew<vtkMatrix4x4> ijkToRAS;
+  this->Database->GetIJKToRASMatrix(ijkToRAS.GetPointer());
+  volNode->SetIJKToRASMatrix(ijkToRAS.GetPointer());
+
+  return 1;
+}
@@ -0,0 +1,112 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#ifndef __vtkMRMLTimeSeriesDatabaseStorageNode_h
+#define __vtkMRMLTimeSeriesDatabaseStorageNode_h
+
+#include "vtkMRMLStorageNode.h"
+
+class vtkITKTimeSeriesDatabase;
+
+// STD includes
+#include <string>
+
+/// \brief MRML node for reading the images of a time series database.
+///
+/// vtkMRMLTimeSeriesDatabaseStorageNode reads the image CurrentImage of a
+/// time series database (.tsd) created by
+/// vtkITKTimeSeriesDatabase::CreateFromFileArchetype() into a scalar volume
+/// node. The database stays connected between the reads: a cine loop sets
+/// CurrentImage and calls ReadData() for each frame. The blocks of the
+/// images are cached within CacheSizeInMiB and the PrefetchTimePoints next
+/// images are read in the background.
+/// Writing is not supported.
+class VTK_MRML_EXPORT vtkMRMLTimeSeriesDatabaseStorageNode
+  : public vtkMRMLStorageNode
+{
+public:
+  static vtkMRMLTimeSeriesDatabaseStorageNode *New();
+  vtkTypeMacro(vtkMRMLTimeSeriesDatabaseStorageNode,vtkMRMLStorageNode);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  virtual vtkMRMLNode* CreateNodeInstance();
+
+  ///
+  /// Read node attributes from XML file
+  virtual void ReadXMLAttributes( const char** atts);
+
+  ///
+  /// Write this node's information to a MRML file in XML format.
+  virtual void WriteXML(ostream& of, int indent);
+
+  ///
+  /// Copy the node's attributes to this object
+  virtual void Copy(vtkMRMLNode *node);
+
+  ///
+  /// Get node XML tag name (like Storage, Model)
+  virtual const char* GetNodeTagName()  {return "TimeSeriesDatabaseStorage";};
+
+  ///
+  /// Index of the image read by ReadData(), 0 by default.
+  vtkSetMacro(CurrentImage, int);
+  vtkGetMacro(CurrentImage, int);
+
+  ///
+  /// Memory used to cache the blocks of the database, 256 MiB by default.
+  vtkSetMacro(CacheSizeInMiB, double);
+  vtkGetMacro(CacheSizeInMiB, double);
+
+  ///
+  /// Number of images following CurrentImage read in the background after
+  /// ReadData(), 1 by default. 0 disables the prefetching.
+  vtkSetMacro(PrefetchTimePoints, int);
+  vtkGetMacro(PrefetchTimePoints, int);
+
+  ///
+  /// Number of images of the database, it is connected if needed.
+  /// Return 0 if the database can't be opened.
+  int GetNumberOfImages();
+
+  ///
+  /// Return a default file extension for writing
+  virtual const char* GetDefaultWriteFileExtension();
+
+  /// Return true if the node can be read in
+  virtual bool CanReadInReferenceNode(vtkMRMLNode *refNode);
+  /// The database is created from a series of volumes, it can't be written
+  /// from a node.
+  virtual bool CanWriteFromReferenceNode(vtkMRMLNode *refNode);
+
+protected:
+  vtkMRMLTimeSeriesDatabaseStorageNode();
+  ~vtkMRMLTimeSeriesDatabaseStorageNode();
+  vtkMRMLTimeSeriesDatabaseStorageNode(const vtkMRMLTimeSeriesDatabaseStorageNode&);
+  void operator=(const vtkMRMLTimeSeriesDatabaseStorageNode&);
+
+  /// Initialize all the supported read file types
+  virtual void InitializeSupportedReadFileTypes();
+
+  /// Read data and set it in the referenced node
+  virtual int ReadDataInternal(vtkMRMLNode *refNode);
+
+  /// Connect the database to the file of the node if it is not already.
+  bool ConnectDatabase();
+
+  int CurrentImage;
+  double CacheSizeInMiB;
+  int PrefetchTimePoints;
+
+  vtkITKTimeSeriesDatabase* Database;
+  std::string ConnectedFileName;
+};
+
+#endif
@@ -18,12 +18,17 @@ Version:   $Revision: 1.14 $
 
 // VTK includes
 #include <vtkGeneralTransform.h>
+#include <vtkMatrix4x4.h>
 
 //----------------------------------------------------------------------------
 vtkMRMLTransformNode::vtkMRMLTransformNode()
 {
   this->TransformToParent = vtkGeneralTransform::New();
   this->TransformToParent->Identity();
+
+  this->MatrixTransformToWorldCache = vtkMatrix4x4::New();
+  this->TransformToWorldLinearCache = 1;
+  this->TransformToWorldCacheParent = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -33,6 +38,7 @@ vtkMRMLTransformNode::~vtkMRMLTransformNode()
     {
     this->TransformToParent->Delete();
     }
+  this->MatrixTransformToWorldCache->Delete();
 }
 
 //----------------------------------------------------------------------------
@@ -62,24 +68,78 @@ void vtkMRMLTransformNode::PrintSelf(ostream& os, vtkIndent indent)
 }
 
 //----------------------------------------------------------------------------
-int  vtkMRMLTransformNode::IsTransformToWorldLinear()
+unsigned long vtkMRMLTransformNode::GetTransformToParentMTime()
 {
-  if (this->IsLinear() == 0) 
+  unsigned long mtime = this->GetMTime();
+  if (this->TransformToParent && this->TransformToParent->GetMTime() > mtime)
     {
-    return 0;
+    mtime = this->TransformToParent->GetMTime();
     }
-  else 
+  return mtime;
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLTransformNode::GetMatrixTransformToParentInternal(vtkMatrix4x4* matrix)
+{
+  matrix->Identity();
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTransformNode::UpdateTransformToWorldCache()
+{
+  vtkMRMLTransformNode *parent = this->GetParentTransformNode();
+  if (parent != NULL)
     {
-    vtkMRMLTransformNode *parent = this->GetParentTransformNode();
-    if (parent != NULL) 
+    parent->UpdateTransformToWorldCache();
+    }
+
+  unsigned long cacheTime = this->TransformToWorldCacheTime.GetMTime();
+  if (cacheTime != 0 &&
+      parent == this->TransformToWorldCacheParent &&
+      this->GetTransformToParentMTime() < cacheTime &&
+      (parent == NULL || parent->TransformToWorldCacheTime.GetMTime() < cacheTime))
+    {
+    // up to date
+    return;
+    }
+
+  this->TransformToWorldLinearCache = this->IsLinear() &&
+    (parent == NULL || parent->TransformToWorldLinearCache);
+  if (this->TransformToWorldLinearCache)
+    {
+    vtkMatrix4x4 *matrixToParent = vtkMatrix4x4::New();
+    this->GetMatrixTransformToParentInternal(matrixToParent);
+    if (parent != NULL)
       {
-      return parent->IsTransformToWorldLinear();
+      vtkMatrix4x4::Multiply4x4(parent->MatrixTransformToWorldCache, matrixToParent,
+                                this->MatrixTransformToWorldCache);
       }
-    else 
+    else
       {
-      return 1;
+      this->MatrixTransformToWorldCache->DeepCopy(matrixToParent);
       }
+    matrixToParent->Delete();
     }
+  else
+    {
+    this->MatrixTransformToWorldCache->Identity();
+    }
+  this->TransformToWorldCacheParent = parent;
+  this->TransformToWorldCacheTime.Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTransformNode::InvalidateTransformToWorldCache()
+{
+  this->TransformToWorldCacheTime = vtkTimeStamp();
+}
+
+//----------------------------------------------------------------------------
+int  vtkMRMLTransformNode::IsTransformToWorldLinear()
+{
+  this->UpdateTransformToWorldCache();
+  return this->TransformToWorldLinearCache;
 }
 
 //----------------------------------------------------------------------------
@@ -65,6 +65,7 @@ public:
 
   /// 
   /// 1 if all the transforms to the top are linear, 0 otherwise
+  /// The result is cached until a transform of the hierarchy is modified.
   int  IsTransformToWorldLinear() ;
 
   /// 
@@ -112,8 +113,39 @@ protected:
   vtkMRMLTransformNode(const vtkMRMLTransformNode&);
   void operator=(const vtkMRMLTransformNode&);
 
+  /// 
+  /// Time of the last modification of the transform to parent.
+  /// The transforms to world cached by the children are recomputed when
+  /// it is more recent than the cache.
+  virtual unsigned long GetTransformToParentMTime();
+
+  /// 
+  /// Copy the linear transform to parent into matrix.
+  /// Returns 0 and sets identity if the transform is not linear.
+  virtual int GetMatrixTransformToParentInternal(vtkMatrix4x4* matrix);
+
+  /// 
+  /// Recompute the cached transform to world if this node, one of its
+  /// ancestors or the hierarchy itself changed since it was computed.
+  /// Each node of the hierarchy is checked against its time stamp, the
+  /// matrices are only multiplied again from the first modified node.
+  void UpdateTransformToWorldCache();
+
+  /// 
+  /// Force the cached transform to world to be recomputed, for changes
+  /// that the time stamps do not reflect.
+  void InvalidateTransformToWorldCache();
+
   vtkGeneralTransform* TransformToParent;
 
+  /// Cache of the transform to world, see UpdateTransformToWorldCache()
+  /// The matrix is only valid for linear hierarchies.
+  vtkMatrix4x4*         MatrixTransformToWorldCache;
+  int                   TransformToWorldLinearCache;
+  /// Parent of the node when the cache was computed, only used for
+  /// comparison, never dereferenced.
+  vtkMRMLTransformNode* TransformToWorldCacheParent;
+  vtkTimeStamp          TransformToWorldCacheTime;
 };
 
 #endif
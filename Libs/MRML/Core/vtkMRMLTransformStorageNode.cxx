@@ -22,7 +22,9 @@ Version:   $Revision: 1.2 $
 
 #include "vtkGeneralTransform.h"
 #include "vtkGridTransform.h"
+#include "vtkDataArray.h"
 #include "vtkImageData.h"
+#include "vtkPointData.h"
 #include "vtkSmartPointer.h"
 #include "vtkStringArray.h"
 
@@ -36,6 +38,11 @@ Version:   $Revision: 1.2 $
 #include "itkTranslationTransform.h"
 #include "itkScaleTransform.h"
 
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 
 
 //----------------------------------------------------------------------------
@@ -44,6 +51,7 @@ vtkMRMLNodeNewMacro(vtkMRMLTransformStorageNode);
 //----------------------------------------------------------------------------
 vtkMRMLTransformStorageNode::vtkMRMLTransformStorageNode()
 {
+  this->DisplacementScalarType = VTK_DOUBLE;
 }
 
 //----------------------------------------------------------------------------
@@ -54,6 +62,53 @@ vtkMRMLTransformStorageNode::~vtkMRMLTransformStorageNode()
 void vtkMRMLTransformStorageNode::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os,indent);
+  os << indent << "DisplacementScalarType: "
+     << this->DisplacementScalarType << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTransformStorageNode::WriteXML(ostream& of, int nIndent)
+{
+  Superclass::WriteXML(of, nIndent);
+
+  of << " displacementScalarType=\"" << this->DisplacementScalarType << "\"";
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTransformStorageNode::ReadXMLAttributes(const char** atts)
+{
+  int disabledModify = this->StartModify();
+
+  Superclass::ReadXMLAttributes(atts);
+  const char* attName;
+  const char* attValue;
+  while (*atts != NULL)
+    {
+    attName = *(atts++);
+    attValue = *(atts++);
+    if (!strcmp(attName, "displacementScalarType"))
+      {
+      this->SetDisplacementScalarType(atoi(attValue));
+      }
+    }
+
+  this->EndModify(disabledModify);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLTransformStorageNode::Copy(vtkMRMLNode *anode)
+{
+  int disabledModify = this->StartModify();
+
+  Superclass::Copy(anode);
+  vtkMRMLTransformStorageNode *node =
+    vtkMRMLTransformStorageNode::SafeDownCast(anode);
+  if (node)
+    {
+    this->SetDisplacementScalarType(node->GetDisplacementScalarType());
+    }
+
+  this->EndModify(disabledModify);
 }
 
 //----------------------------------------------------------------------------
@@ -521,33 +576,73 @@ int vtkMRMLTransformStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
         result = 0;
         }
 
+      int scalarType = this->DisplacementScalarType;
+      if (scalarType != VTK_DOUBLE && scalarType != VTK_FLOAT &&
+          scalarType != VTK_SHORT)
+        {
+        vtkWarningMacro("Unsupported displacement scalar type "
+                        << scalarType << ", using double");
+        scalarType = VTK_DOUBLE;
+        }
+
+      // The quantization covers the range of all the components (the
+      // negation of the first two components doesn't change it)
+      double range[2] = { 0., 0. };
+      if (scalarType == VTK_SHORT)
+        {
+        const double* values = reinterpret_cast<const double*>(
+          gridImage->GetBufferPointer());
+        const size_t count = gridImage->GetPixelContainer()->Size();
+        range[0] = VTK_DOUBLE_MAX;
+        range[1] = -VTK_DOUBLE_MAX;
+        for (size_t n = 0; n < count; ++n)
+          {
+          double value = std::fabs(values[n]);
+          range[0] = std::min(range[0], -value);
+          range[1] = std::max(range[1], value);
+          }
+        }
+      double scale = 1.;
+      double shift = 0.;
+      vtkMRMLGridTransformNode::GetDisplacementQuantization(
+        scalarType, range, scale, shift);
+
       vtkgridimage->SetDimensions( Ni, Nj, Nk );
       vtkgridimage->SetNumberOfScalarComponents( Nc );
-      vtkgridimage->SetScalarTypeToDouble();
+      vtkgridimage->SetScalarType( scalarType );
       vtkgridimage->AllocateScalars();
 
-      // convert from LPS to RAS
-      double* dataPtr = reinterpret_cast<double*>(vtkgridimage->GetScalarPointer());
+      // convert from LPS to RAS, a row at a time
+      char* dataPtr = reinterpret_cast<char*>(vtkgridimage->GetScalarPointer());
+      const int rowSize = Ni * 3 * vtkgridimage->GetScalarSize();
+      std::vector<double> row(Ni * 3);
       GridImageType::IndexType ijk;
       for( int k = 0; k < (int)Nk; ++k )
         {
         ijk[2] = k;
-        for( int j = 0; j < (int)Nj; ++j )
+        for( int j = 0; j < (int)Nj; ++j, dataPtr += rowSize )
           {
           ijk[1] = Nj -j - 1;
-          for( int i = 0; i < (int)Ni; ++i, dataPtr += 3 )
+          double* rowPtr = &row[0];
+          for( int i = 0; i < (int)Ni; ++i, rowPtr += 3 )
             {
             ijk[0] = Ni -i - 1;
             GridImageType::PixelType pixel = gridImage->GetPixel( ijk );
             // negate the first two components
-            dataPtr[0] = -pixel[0];
-            dataPtr[1] = -pixel[1];
-            dataPtr[2] = pixel[2];
+            rowPtr[0] = -pixel[0];
+            rowPtr[1] = -pixel[1];
+            rowPtr[2] = pixel[2];
             }
+          vtkMRMLGridTransformNode::QuantizeDisplacements(
+            &row[0], Ni * 3, scalarType, dataPtr, scale, shift);
           }
         }
+      // Release the ITK image before the transform is used
+      gridImage = 0;
 
       vtkgrid->SetDisplacementGrid( vtkgridimage );
+      vtkgrid->SetDisplacementScale( scale );
+      vtkgrid->SetDisplacementShift( shift );
       vtkgridimage->Delete();
 
       // Set the matrix on the node
@@ -721,7 +816,11 @@ int vtkMRMLTransformStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
     gridImage->SetOrigin( origin );
     gridImage->Allocate();
     
-    double* dataPtr = reinterpret_cast<double*>(vtkgridimage->GetScalarPointer());
+    // The grid may be quantized, write the displacements in double
+    vtkDataArray* displacements = vtkgridimage->GetPointData()->GetScalars();
+    const double scale = vtkTrans->GetDisplacementScale();
+    const double shift = vtkTrans->GetDisplacementShift();
+    vtkIdType displacementId = 0;
     GridType::IndexType ijk;
     GridType::PixelType pixel(3);
     for( int k = 0; k < Nijk[2]; ++k )
@@ -730,13 +829,14 @@ int vtkMRMLTransformStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
       for( int j = 0; j < Nijk[1]; ++j )
         {
         ijk[1] = -j + Nijk[1] - 1;
-        for( int i = 0; i < Nijk[0]; ++i, dataPtr += 3 )
+        for( int i = 0; i < Nijk[0]; ++i, ++displacementId )
           {
           ijk[0] = -i + Nijk[0] - 1;
+          double* displacement = displacements->GetTuple3(displacementId);
           // negate the first two components
-          pixel[0] = -dataPtr[0];
-          pixel[1] = -dataPtr[1];
-          pixel[2] = dataPtr[2];
+          pixel[0] = -(displacement[0] * scale + shift);
+          pixel[1] = -(displacement[1] * scale + shift);
+          pixel[2] = displacement[2] * scale + shift;
           gridImage->SetPixel( ijk, pixel );
           }
         }
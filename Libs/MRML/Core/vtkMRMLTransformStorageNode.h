@@ -31,6 +31,18 @@ class VTK_MRML_EXPORT vtkMRMLTransformStorageNode : public vtkMRMLStorageNode
 
   virtual vtkMRMLNode* CreateNodeInstance();
 
+  ///
+  /// Read node attributes from XML file
+  virtual void ReadXMLAttributes( const char** atts);
+
+  ///
+  /// Write this node's information to a MRML file in XML format.
+  virtual void WriteXML(ostream& of, int indent);
+
+  ///
+  /// Copy the node's attributes to this object
+  virtual void Copy(vtkMRMLNode *node);
+
   /// 
   /// Get node XML tag name (like Storage, Transform)
   virtual const char* GetNodeTagName()  {return "TransformStorage";};
@@ -46,6 +58,14 @@ class VTK_MRML_EXPORT vtkMRMLTransformStorageNode : public vtkMRMLStorageNode
   /// Support only transform nodes
   virtual bool CanReadInReferenceNode(vtkMRMLNode* refNode);
 
+  /// Scalar type of the displacement grids read into grid transform
+  /// nodes: VTK_DOUBLE (default), VTK_FLOAT or VTK_SHORT. The displacements
+  /// are converted while they are read, no double grid is allocated.
+  /// Files are always written with double displacements.
+  /// \sa vtkMRMLGridTransformNode::SetDisplacementGridScalarType()
+  vtkSetMacro(DisplacementScalarType, int);
+  vtkGetMacro(DisplacementScalarType, int);
+
 protected:
   vtkMRMLTransformStorageNode();
   ~vtkMRMLTransformStorageNode();
@@ -58,6 +78,7 @@ protected:
   /// Write data from a referenced node
   virtual int WriteDataInternal(vtkMRMLNode *refNode);
 
+  int DisplacementScalarType;
 };
 
 #endif
@@ -18,9 +18,98 @@ Version:   $Revision: 1.14 $
 
 // VTK includes
 #include <vtkCommand.h>
+#include <vtkGeneralTransform.h>
 #include <vtkIntArray.h>
 #include <vtkMatrixToLinearTransform.h>
 #include <vtkMatrix4x4.h>
+#include <vtkMultiThreader.h>
+#include <vtkPoints.h>
+
+// STD includes
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Below this number of points, starting threads costs more than it saves
+const vtkIdType MinimumNumberOfPointsPerThread = 1024;
+
+//----------------------------------------------------------------------------
+void TransformPointsLinear(vtkMatrix4x4* matrix, double* points, vtkIdType numberOfPoints)
+{
+  const double* m = &matrix->Element[0][0];
+  double* end = points + 3 * numberOfPoints;
+  if (m[12] == 0. && m[13] == 0. && m[14] == 0. && m[15] == 1.)
+    {
+    // affine, no homogeneous coordinate
+    for (double* p = points; p != end; p += 3)
+      {
+      const double x = p[0], y = p[1], z = p[2];
+      p[0] = m[0] * x + m[1] * y + m[2]  * z + m[3];
+      p[1] = m[4] * x + m[5] * y + m[6]  * z + m[7];
+      p[2] = m[8] * x + m[9] * y + m[10] * z + m[11];
+      }
+    return;
+    }
+  for (double* p = points; p != end; p += 3)
+    {
+    const double x = p[0], y = p[1], z = p[2];
+    const double w = m[12] * x + m[13] * y + m[14] * z + m[15];
+    const double f = (w != 0.) ? 1. / w : 1.;
+    p[0] = (m[0] * x + m[1] * y + m[2]  * z + m[3])  * f;
+    p[1] = (m[4] * x + m[5] * y + m[6]  * z + m[7])  * f;
+    p[2] = (m[8] * x + m[9] * y + m[10] * z + m[11]) * f;
+    }
+}
+
+//----------------------------------------------------------------------------
+struct NonlinearTransformPointsJob
+{
+  vtkAbstractTransform* Transform;
+  double*               Points;
+  vtkIdType             NumberOfPoints;
+};
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE TransformPointsNonlinearThread(void *arg)
+{
+  vtkMultiThreader::ThreadInfo *info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  NonlinearTransformPointsJob* job = static_cast<NonlinearTransformPointsJob*>(info->UserData);
+  vtkIdType begin = job->NumberOfPoints * info->ThreadID / info->NumberOfThreads;
+  vtkIdType end = job->NumberOfPoints * (info->ThreadID + 1) / info->NumberOfThreads;
+  double out[3];
+  for (double* p = job->Points + 3 * begin; p != job->Points + 3 * end; p += 3)
+    {
+    // the transform is up to date, InternalTransformPoint is thread safe
+    job->Transform->InternalTransformPoint(p, out);
+    p[0] = out[0];
+    p[1] = out[1];
+    p[2] = out[2];
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+void TransformPointsNonlinear(vtkAbstractTransform* transform, double* points, vtkIdType numberOfPoints)
+{
+  transform->Update();
+  NonlinearTransformPointsJob job;
+  job.Transform = transform;
+  job.Points = points;
+  job.NumberOfPoints = numberOfPoints;
+
+  vtkMultiThreader* threader = vtkMultiThreader::New();
+  vtkIdType numberOfThreads = numberOfPoints / MinimumNumberOfPointsPerThread;
+  threader->SetNumberOfThreads(static_cast<int>(
+    std::min<vtkIdType>(std::max<vtkIdType>(numberOfThreads, 1), threader->GetNumberOfThreads())));
+  threader->SetSingleMethod(TransformPointsNonlinearThread, &job);
+  threader->SingleMethodExecute();
+  threader->Delete();
+}
+
+} // end of anonymous namespace
 
 
 //----------------------------------------------------------------------------
@@ -238,3 +327,91 @@ void vtkMRMLTransformableNode::TransformPointFromWorld(const double in[4], doubl
     vtkErrorMacro("TransformPointToWorld: not a linear transform");
     }
 }
+
+//-----------------------------------------------------------
+void vtkMRMLTransformableNode::TransformPointsToWorld(vtkPoints* points)
+{
+  this->TransformPoints(points, false);
+}
+
+//-----------------------------------------------------------
+void vtkMRMLTransformableNode::TransformPointsToWorld(double* points, vtkIdType numberOfPoints)
+{
+  this->TransformPoints(points, numberOfPoints, false);
+}
+
+//-----------------------------------------------------------
+void vtkMRMLTransformableNode::TransformPointsFromWorld(vtkPoints* points)
+{
+  this->TransformPoints(points, true);
+}
+
+//-----------------------------------------------------------
+void vtkMRMLTransformableNode::TransformPointsFromWorld(double* points, vtkIdType numberOfPoints)
+{
+  this->TransformPoints(points, numberOfPoints, true);
+}
+
+//-----------------------------------------------------------
+void vtkMRMLTransformableNode::TransformPoints(vtkPoints* points, bool fromWorld)
+{
+  if (points == NULL || points->GetNumberOfPoints() == 0 ||
+      this->GetParentTransformNode() == NULL)
+    {
+    return;
+    }
+  vtkIdType numberOfPoints = points->GetNumberOfPoints();
+  if (points->GetDataType() == VTK_DOUBLE)
+    {
+    this->TransformPoints(static_cast<double*>(points->GetVoidPointer(0)),
+                          numberOfPoints, fromWorld);
+    }
+  else
+    {
+    std::vector<double> buffer(3 * numberOfPoints);
+    for (vtkIdType i = 0; i < numberOfPoints; ++i)
+      {
+      points->GetPoint(i, &buffer[3 * i]);
+      }
+    this->TransformPoints(&buffer[0], numberOfPoints, fromWorld);
+    for (vtkIdType i = 0; i < numberOfPoints; ++i)
+      {
+      points->SetPoint(i, &buffer[3 * i]);
+      }
+    }
+  points->Modified();
+}
+
+//-----------------------------------------------------------
+void vtkMRMLTransformableNode::TransformPoints(double* points, vtkIdType numberOfPoints,
+                                               bool fromWorld)
+{
+  vtkMRMLTransformNode* tnode = this->GetParentTransformNode();
+  if (tnode == NULL || points == NULL || numberOfPoints <= 0)
+    {
+    return;
+    }
+  if (tnode->IsTransformToWorldLinear())
+    {
+    vtkMatrix4x4* transformToWorld = vtkMatrix4x4::New();
+    transformToWorld->Identity();
+    tnode->GetMatrixTransformToWorld(transformToWorld);
+    if (fromWorld)
+      {
+      transformToWorld->Invert();
+      }
+    TransformPointsLinear(transformToWorld, points, numberOfPoints);
+    transformToWorld->Delete();
+    }
+  else
+    {
+    vtkGeneralTransform* transformToWorld = vtkGeneralTransform::New();
+    tnode->GetTransformToWorld(transformToWorld);
+    if (fromWorld)
+      {
+      transformToWorld->Inverse();
+      }
+    TransformPointsNonlinear(transformToWorld, points, numberOfPoints);
+    transformToWorld->Delete();
+    }
+}
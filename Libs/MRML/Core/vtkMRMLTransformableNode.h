@@ -22,6 +22,7 @@ class vtkMRMLTransformNode;
 // VTK includes
 class vtkAbstractTransform;
 class vtkMatrix4x4;
+class vtkPoints;
 
 /// \brief MRML node for representing a node with a tranform.
 ///
@@ -89,6 +90,24 @@ public:
   /// \sa TransformPointToWorld, SetAndObserveTransformNodeID
   virtual void TransformPointFromWorld(const double in[4], double out[4]);
 
+  /// Apply the observed transform to the points, in place.
+  /// The transform to world is retrieved once for all the points, which
+  /// is much faster than calling TransformPointToWorld() for each of them.
+  /// Unlike TransformPointToWorld(), non linear transforms are supported,
+  /// they are evaluated in parallel on large sets of points.
+  /// \sa TransformPointsFromWorld, TransformPointToWorld
+  void TransformPointsToWorld(vtkPoints* points);
+  /// Apply the observed transform to numberOfPoints consecutive
+  /// (x, y, z) triplets, in place.
+  void TransformPointsToWorld(double* points, vtkIdType numberOfPoints);
+
+  /// Apply the invert of the observed transform to the points, in place.
+  /// \sa TransformPointsToWorld, TransformPointFromWorld
+  void TransformPointsFromWorld(vtkPoints* points);
+  /// Apply the invert of the observed transform to numberOfPoints
+  /// consecutive (x, y, z) triplets, in place.
+  void TransformPointsFromWorld(double* points, vtkIdType numberOfPoints);
+
   /// Get referenced transform node id
   const char *GetTransformNodeID();
 
@@ -108,6 +127,9 @@ protected:
   vtkSetStringMacro(TransformNodeReferenceRererenceMRMLAttributeName);
   vtkGetStringMacro(TransformNodeReferenceRererenceMRMLAttributeName);
 
+  void TransformPoints(vtkPoints* points, bool fromWorld);
+  void TransformPoints(double* points, vtkIdType numberOfPoints, bool fromWorld);
+
 private:
   char* TransformNodeIDInternal;
   vtkSetStringMacro(TransformNodeIDInternal);
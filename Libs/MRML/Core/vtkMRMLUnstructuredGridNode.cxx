@@ -20,6 +20,7 @@ Version:   $Revision: 1.3 $
 
 // VTK includes
 #include "vtkCallbackCommand.h"
+#include "vtkCollection.h"
 #include "vtkObjectFactory.h"
 #include "vtkTransformFilter.h"
 #include "vtkUnstructuredGrid.h"
@@ -69,6 +70,16 @@ void vtkMRMLUnstructuredGridNode::Copy(vtkMRMLNode *anode)
 
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLUnstructuredGridNode::GetDataObjects(vtkCollection* dataObjects)
+{
+  this->Superclass::GetDataObjects(dataObjects);
+  if (this->UnstructuredGrid)
+    {
+    dataObjects->AddItem(this->UnstructuredGrid);
+    }
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLUnstructuredGridNode::SetAndObserveUnstructuredGrid(vtkUnstructuredGrid *unstructuredGrid)
 {
@@ -42,6 +42,9 @@ public:
 
   /// Copy the node's attributes to this object
   virtual void Copy(vtkMRMLNode *node);
+
+  /// Add the unstructured grid
+  virtual void GetDataObjects(vtkCollection* dataObjects);
   
   /// 
   /// Get node XML tag name (like Volume, Model)
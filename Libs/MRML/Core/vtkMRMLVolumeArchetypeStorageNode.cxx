@@ -19,6 +19,7 @@ Version:   $Revision: 1.6 $
 #ifdef MRML_USE_vtkTeem
 #include "vtkMRMLVectorVolumeNode.h"
 #include "vtkMRMLDiffusionTensorVolumeNode.h"
+#include "vtkNRRDWriter.h"
 #endif
 #include "vtkMRMLVolumeArchetypeStorageNode.h"
 
@@ -546,37 +547,75 @@ int vtkMRMLVolumeArchetypeStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
     {
     vtkDebugMacro("WriteData: writing out file with archetype " << fullName);
     
-    vtkSmartPointer<vtkITKImageWriter> writer = vtkSmartPointer<vtkITKImageWriter>::New();
-    writer->SetFileName(fullName.c_str());
-  
-    writer->SetInput( volNode->GetImageData() );
-    writer->SetUseCompression(this->GetUseCompression());
-    if(this->WriteFileFormat)
-      {
-      writer->SetImageIOClassName(
-                                  this->GetScene()->GetDataIOManager()->GetFileFormatHelper()->
-                                  GetClassNameFromFormatString(this->WriteFileFormat));
-      }
-    
-    // set volume attributes
-    vtkSmartPointer<vtkMatrix4x4> mat = vtkSmartPointer<vtkMatrix4x4>::New();
-    volNode->GetRASToIJKMatrix(mat);
-    writer->SetRasToIJKMatrix(mat);
-    
-    try
-      {
-      writer->Write();
-      }
-    catch (...)
-      {
-      result = 0;
-      }
+    result = this->WriteImageDataFile(volNode, fullName.c_str());
     }
 
   return result;
 
 }
 
+//----------------------------------------------------------------------------
+int vtkMRMLVolumeArchetypeStorageNode::WriteImageDataFile(
+  vtkMRMLVolumeNode *volNode, const char *fileName)
+{
+  const char* imageIOClassName = 0;
+  if (this->WriteFileFormat &&
+      this->GetScene() &&
+      this->GetScene()->GetDataIOManager() &&
+      this->GetScene()->GetDataIOManager()->GetFileFormatHelper())
+    {
+    imageIOClassName = this->GetScene()->GetDataIOManager()->
+      GetFileFormatHelper()->GetClassNameFromFormatString(this->WriteFileFormat);
+    }
+
+#ifdef MRML_USE_vtkTeem
+  // The ITK writer compresses with a single thread.
+  std::string extension = vtksys::SystemTools::LowerCase(
+    vtksys::SystemTools::GetFilenameLastExtension(fileName));
+  if (this->GetUseCompression() && extension == ".nrrd" &&
+      (!imageIOClassName || !strcmp(imageIOClassName, "NrrdImageIO")) &&
+      volNode->GetImageData()->GetPointData()->GetScalars())
+    {
+    vtkNew<vtkMatrix4x4> ijkToRAS;
+    volNode->GetIJKToRASMatrix(ijkToRAS.GetPointer());
+
+    vtkNew<vtkNRRDWriter> writer;
+    writer->SetFileName(fileName);
+    writer->SetInput(volNode->GetImageData());
+    writer->SetUseCompression(1);
+    writer->SetCompressionLevel(this->GetCompressionLevel());
+    writer->SetIJKToRASMatrix(ijkToRAS.GetPointer());
+    writer->Write();
+    return writer->GetWriteError() ? 0 : 1;
+    }
+#endif
+
+  vtkSmartPointer<vtkITKImageWriter> writer = vtkSmartPointer<vtkITKImageWriter>::New();
+  writer->SetFileName(fileName);
+
+  writer->SetInput( volNode->GetImageData() );
+  writer->SetUseCompression(this->GetUseCompression());
+  if (imageIOClassName)
+    {
+    writer->SetImageIOClassName(imageIOClassName);
+    }
+
+  // set volume attributes
+  vtkSmartPointer<vtkMatrix4x4> mat = vtkSmartPointer<vtkMatrix4x4>::New();
+  volNode->GetRASToIJKMatrix(mat);
+  writer->SetRasToIJKMatrix(mat);
+
+  try
+    {
+    writer->Write();
+    }
+  catch (...)
+    {
+    return 0;
+    }
+  return 1;
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLVolumeArchetypeStorageNode::InitializeSupportedWriteFileTypes()
 {
@@ -679,37 +718,8 @@ std::string vtkMRMLVolumeArchetypeStorageNode::UpdateFileList(vtkMRMLNode *refNo
   std::string tempName = vtksys::SystemTools::JoinPath(pathComponents);
   vtkDebugMacro("UpdateFileList: new archetype file name = " << tempName.c_str());
 
-  // set up the writer and write
-  vtkSmartPointer<vtkITKImageWriter> writer = vtkSmartPointer<vtkITKImageWriter>::New();
-  writer->SetFileName(tempName.c_str());
-  
-  writer->SetInput( volNode->GetImageData() );
-  writer->SetUseCompression(this->GetUseCompression());
-  if(this->WriteFileFormat)
-    {
-    if (this->GetScene() &&
-        this->GetScene()->GetDataIOManager() &&
-        this->GetScene()->GetDataIOManager()->GetFileFormatHelper())
-      {
-      writer->SetImageIOClassName(this->GetScene()->GetDataIOManager()->GetFileFormatHelper()->
-                                  GetClassNameFromFormatString(this->WriteFileFormat));
-      }
-    }
-
-  // set volume attributes
-  vtkSmartPointer<vtkMatrix4x4> mat = vtkSmartPointer<vtkMatrix4x4>::New();
-  volNode->GetRASToIJKMatrix(mat);
-  writer->SetRasToIJKMatrix(mat);
-
-  try
-    {
-    writer->Write();
-    }
-    catch (...)
-    {
-    result = false;
-    }
-
+  // write
+  result = (this->WriteImageDataFile(volNode, tempName.c_str()) != 0);
   if (!result)
     {
     vtkErrorMacro("UpdateFileList: Failed to write '" << tempName.c_str()
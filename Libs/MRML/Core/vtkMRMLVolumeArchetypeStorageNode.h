@@ -19,6 +19,7 @@
 
 class vtkImageData;
 class vtkITKArchetypeImageSeriesReader;
+class vtkMRMLVolumeNode;
 
 /// \brief MRML node for representing a volume storage.
 ///
@@ -103,6 +104,12 @@ protected:
   /// Write data from a referenced node
   virtual int WriteDataInternal(vtkMRMLNode *refNode);
 
+  /// Write the image data of \a volNode into \a fileName.
+  /// Compressed NRRD files are written by vtkNRRDWriter that compresses the
+  /// data with multiple threads, other files by vtkITKImageWriter.
+  /// Return 1 on success, 0 otherwise.
+  int WriteImageDataFile(vtkMRMLVolumeNode *volNode, const char *fileName);
+
   int CenterImage;
   int SingleFile;
   int UseOrientationFromFile;
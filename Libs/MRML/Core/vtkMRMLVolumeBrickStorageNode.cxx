@@ -0,0 +1,46 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRML includes
+#include "vtkMRMLVolumeBrickStorageNode.h"
+
+// VTK includes
+#include <vtkObjectFactory.h>
+#include <vtkStringArray.h>
+
+//----------------------------------------------------------------------------
+vtkMRMLNodeNewMacro(vtkMRMLVolumeBrickStorageNode);
+
+//----------------------------------------------------------------------------
+vtkMRMLVolumeBrickStorageNode::vtkMRMLVolumeBrickStorageNode()
+{
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLVolumeBrickStorageNode::~vtkMRMLVolumeBrickStorageNode()
+{
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeBrickStorageNode::InitializeSupportedWriteFileTypes()
+{
+  // The bricks are always compressed, the other formats are written by
+  // vtkMRMLVolumeArchetypeStorageNode.
+  this->SupportedWriteFileTypes->Reset();
+  this->SupportedWriteFileTypes->SetNumberOfTuples(0);
+  this->SupportedWriteFileTypes->InsertNextValue("Brick Volume (.bvol)");
+}
+
+//----------------------------------------------------------------------------
+const char* vtkMRMLVolumeBrickStorageNode::GetDefaultWriteFileExtension()
+{
+  return "bvol";
+}
@@ -0,0 +1,51 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#ifndef __vtkMRMLVolumeBrickStorageNode_h
+#define __vtkMRMLVolumeBrickStorageNode_h
+
+#include "vtkMRMLVolumeArchetypeStorageNode.h"
+
+/// \brief MRML node for representing a volume stored as compressed bricks.
+///
+/// vtkMRMLVolumeBrickStorageNode reads and writes brick volume files (.bvol)
+/// with the ITK BrickImageIO (Libs/BrickImageIO) loaded as an ITK factory.
+/// The bricks of a brick volume are compressed independently: ITK pipelines
+/// (e.g. command line modules) can stream a region of the volume without
+/// reading the whole file.
+class VTK_MRML_EXPORT vtkMRMLVolumeBrickStorageNode
+  : public vtkMRMLVolumeArchetypeStorageNode
+{
+public:
+  static vtkMRMLVolumeBrickStorageNode *New();
+  vtkTypeMacro(vtkMRMLVolumeBrickStorageNode,vtkMRMLVolumeArchetypeStorageNode);
+
+  virtual vtkMRMLNode* CreateNodeInstance();
+
+  ///
+  /// Get node XML tag name (like Storage, Model)
+  virtual const char* GetNodeTagName()  {return "VolumeBrickStorage";};
+
+  ///
+  /// Return a default file extension for writing
+  virtual const char* GetDefaultWriteFileExtension();
+
+protected:
+  vtkMRMLVolumeBrickStorageNode();
+  ~vtkMRMLVolumeBrickStorageNode();
+  vtkMRMLVolumeBrickStorageNode(const vtkMRMLVolumeBrickStorageNode&);
+  void operator=(const vtkMRMLVolumeBrickStorageNode&);
+
+  /// Initialize all the supported write file types
+  virtual void InitializeSupportedWriteFileTypes();
+};
+
+#endif
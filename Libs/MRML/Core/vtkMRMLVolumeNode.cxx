@@ -20,6 +20,7 @@ Version:   $Revision: 1.14 $
 
 // VTK includes
 #include <vtkCallbackCommand.h>
+#include <vtkCollection.h>
 #include <vtkImageData.h>
 #include <vtkMatrix4x4.h>
 #include <vtkSmartPointer.h>
@@ -53,6 +54,7 @@ vtkMRMLVolumeNode::vtkMRMLVolumeNode()
     }
 
   this->ImageData = NULL;
+  this->ImageDataShared = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -182,6 +184,10 @@ void vtkMRMLVolumeNode::Copy(vtkMRMLNode *anode)
     // of restoring from SceneViews, where the nodes will not 
     // have bulk data.
     this->SetAndObserveImageData(node->ImageData);
+    // the image data is not duplicated, it is shared until one of the
+    // nodes modifies it through GetImageDataForWrite().
+    this->ImageDataShared = 1;
+    node->ImageDataShared = 1;
     }
 
   anode->SetDisableModifiedEvent(amode);
@@ -189,6 +195,16 @@ void vtkMRMLVolumeNode::Copy(vtkMRMLNode *anode)
   this->EndModify(disabledModify);
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeNode::GetDataObjects(vtkCollection* dataObjects)
+{
+  this->Superclass::GetDataObjects(dataObjects);
+  if (this->ImageData)
+    {
+    dataObjects->AddItem(this->ImageData);
+    }
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLVolumeNode::CopyOrientation(vtkMRMLVolumeNode *node)
 {
@@ -654,9 +670,23 @@ void vtkMRMLVolumeNode::SetAndObserveImageData(vtkImageData *imageData)
     }
 
   this->SetImageData(imageData);
+  this->ImageDataShared = 0;
   this->InvokeEvent(vtkMRMLVolumeNode::ImageDataModifiedEvent, NULL);
 }
 
+//----------------------------------------------------------------------------
+vtkImageData* vtkMRMLVolumeNode::GetImageDataForWrite()
+{
+  if (this->ImageData != NULL && this->ImageDataShared)
+    {
+    vtkSmartPointer<vtkImageData> imageData =
+      vtkSmartPointer<vtkImageData>::New();
+    imageData->DeepCopy(this->ImageData);
+    this->SetAndObserveImageData(imageData);
+    }
+  return this->ImageData;
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLVolumeNode::OnNodeReferenceAdded(vtkMRMLNodeReference *reference)
 {
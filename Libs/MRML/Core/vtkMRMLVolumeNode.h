@@ -59,6 +59,9 @@ public:
   /// Copy the node's attributes to this object
   void CopyOrientation(vtkMRMLVolumeNode *node);
 
+  /// Add the image data
+  virtual void GetDataObjects(vtkCollection* dataObjects);
+
 
   /// 
   /// Get node XML tag name (like Volume, Model)
@@ -146,6 +149,16 @@ public:
   /// taken into account.
   void SetAndObserveImageData(vtkImageData *ImageData);
 
+  /// Copy() doesn't duplicate the image data, the copy and the copied node
+  /// share it (copy-on-write). ImageDataShared is set on both nodes until
+  /// a new image data is set.
+  /// Code that modifies the voxels in place (e.g. editor effects) must
+  /// call GetImageDataForWrite() instead of GetImageData(): if the image
+  /// data is shared, it is first replaced by a private deep copy.
+  /// \sa GetImageData(), Copy()
+  vtkGetMacro(ImageDataShared, int);
+  vtkImageData* GetImageDataForWrite();
+
   /// 
   /// alternative method to propagate events generated in Display nodes
   virtual void ProcessMRMLEvents ( vtkObject * /*caller*/, 
@@ -195,6 +208,7 @@ protected:
   double Origin[3];
 
   vtkImageData               *ImageData;
+  int                        ImageDataShared;
 
   itk::MetaDataDictionary Dictionary;
 };
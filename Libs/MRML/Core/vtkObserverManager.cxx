@@ -24,6 +24,9 @@
 #include "vtkObservation.h"
 #include "vtkObserverManager.h"
 
+// STD includes
+#include <set>
+
 vtkCxxRevisionMacro(vtkObserverManager, "$Revision: 1.9.12.1 $");
 vtkStandardNewMacro(vtkObserverManager);
 
@@ -145,10 +148,30 @@ void vtkObserverManager::RemoveObjectEvents(vtkObject *nodePtr)
     if (it != this->ObserverTags.end()) 
       { 
       vtkUnsignedLongArray* objTags = it->second;
+      if (objTags->GetNumberOfTuples() == 0)
+        {
+        return;
+        }
+      // Remove all the observations in one call instead of one call per tag,
+      // each call has to go through the subject and observer lists.
+      std::set<unsigned long> tags;
       for (int i=0; i < objTags->GetNumberOfTuples(); i++)
         {
-        broker->RemoveObservationsForSubjectByTag( nodePtr, objTags->GetValue(i) );
+        tags.insert(objTags->GetValue(i));
+        }
+      std::vector< vtkObservation *> observations =
+        broker->GetObservationsForSubjectByTag( nodePtr, 0 );
+      std::vector< vtkObservation *> removedObservations;
+      removedObservations.reserve(observations.size());
+      for (std::vector< vtkObservation *>::iterator obsIt = observations.begin();
+           obsIt != observations.end(); ++obsIt)
+        {
+        if (tags.find((*obsIt)->GetEventTag()) != tags.end())
+          {
+          removedObservations.push_back(*obsIt);
+          }
         }
+      broker->RemoveObservations( removedObservations );
       objTags->Reset();
       }
     }
@@ -4,6 +4,7 @@
 
 // VTK includes
 #include <vtkObjectFactory.h>
+#include <vtkStringArray.h>
 
 vtkStandardNewMacro ( vtkURIHandler );
 vtkCxxRevisionMacro ( vtkURIHandler, "$Revision: 1.0 $" );
@@ -121,6 +122,24 @@ void vtkURIHandler::StageFileRead(const char * vtkNotUsed( source ),
 { 
 }
 
+//----------------------------------------------------------------------------
+void vtkURIHandler::StageFilesRead(vtkStringArray *sources,
+                                   vtkStringArray *destinations)
+{
+  if (sources == NULL || destinations == NULL ||
+      sources->GetNumberOfValues() != destinations->GetNumberOfValues())
+    {
+    vtkErrorMacro("StageFilesRead: sources and destinations don't match");
+    return;
+    }
+  for (vtkIdType i = 0; i < sources->GetNumberOfValues(); ++i)
+    {
+    this->StageFileRead(sources->GetValue(i).c_str(),
+                        destinations->GetValue(i).c_str());
+    this->InvokeEvent(vtkURIHandler::FileStagedEvent, &i);
+    }
+}
+
 //----------------------------------------------------------------------------
 void vtkURIHandler::StageFileWrite(const char * vtkNotUsed( source ),
                               const char * vtkNotUsed( username ),
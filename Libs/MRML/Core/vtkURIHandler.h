@@ -4,6 +4,7 @@
 // MRML includes
 #include "vtkMRML.h"
 class vtkPermissionPrompter;
+class vtkStringArray;
 
 // VTK includes
 #include <vtkObject.h>
@@ -40,6 +41,21 @@ public:
                               const char *hostname,
                               const char *sessionID );
 
+  /// 
+  /// Stage the nth source into the nth destination for all the sources.
+  /// Handlers that can transfer several files at the same time (see
+  /// vtkHTTPHandler) should reimplement it, the default implementation
+  /// calls StageFileRead() for each file.
+  /// FileStagedEvent is invoked with a pointer to the vtkIdType index of
+  /// each file as soon as it is staged, in the thread staging the files.
+  virtual void StageFilesRead(vtkStringArray *sources,
+                              vtkStringArray *destinations);
+
+  enum
+    {
+      FileStagedEvent = 19101
+    };
+
   /// need something that goes the other way too...
 
   /// 
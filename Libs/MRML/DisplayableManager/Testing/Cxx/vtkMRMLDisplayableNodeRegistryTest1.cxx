@@ -0,0 +1,119 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRMLDisplayableManager includes
+#include <vtkMRMLDisplayableNodeRegistry.h>
+
+// MRML includes
+#include <vtkMRMLModelDisplayNode.h>
+#include <vtkMRMLModelNode.h>
+#include <vtkMRMLScene.h>
+
+// VTK includes
+#include <vtkNew.h>
+
+// STD includes
+#include <iostream>
+#include <vector>
+
+namespace
+{
+//----------------------------------------------------------------------------
+int CountInView(vtkMRMLDisplayableNodeRegistry* registry, const char* viewNodeID)
+{
+  std::vector<vtkMRMLDisplayableNode*> nodes;
+  return registry->GetDisplayableNodesInView(viewNodeID, nodes);
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkMRMLDisplayableNodeRegistryTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  vtkMRMLScene* scene = vtkMRMLScene::New();
+
+  // A model added before the registry exists
+  vtkNew<vtkMRMLModelNode> model1;
+  scene->AddNode(model1.GetPointer());
+
+  vtkMRMLDisplayableNodeRegistry* registry =
+    vtkMRMLDisplayableNodeRegistry::GetSceneRegistry(scene);
+  if (!registry ||
+      registry != vtkMRMLDisplayableNodeRegistry::GetSceneRegistry(scene))
+    {
+    std::cerr << "There must be one registry per scene" << std::endl;
+    scene->Delete();
+    return EXIT_FAILURE;
+    }
+
+  std::vector<vtkMRMLDisplayableNode*> nodes;
+  if (registry->GetDisplayableNodes(nodes) != 1 ||
+      CountInView(registry, "vtkMRMLViewNode1") != 0)
+    {
+    std::cerr << "Wrong displayable nodes: " << nodes.size() << std::endl;
+    scene->Delete();
+    return EXIT_FAILURE;
+    }
+
+  // A display node restricted to the second view
+  vtkNew<vtkMRMLModelNode> model2;
+  scene->AddNode(model2.GetPointer());
+  vtkNew<vtkMRMLModelDisplayNode> display2;
+  scene->AddNode(display2.GetPointer());
+  model2->SetAndObserveDisplayNodeID(display2->GetID());
+  display2->AddViewNodeID("vtkMRMLViewNode2");
+
+  // A display node displayable in all the views
+  vtkNew<vtkMRMLModelDisplayNode> display1;
+  scene->AddNode(display1.GetPointer());
+  model1->SetAndObserveDisplayNodeID(display1->GetID());
+
+  if (CountInView(registry, "vtkMRMLViewNode1") != 1 ||
+      CountInView(registry, "vtkMRMLViewNode2") != 2)
+    {
+    std::cerr << "Wrong displayable nodes in views: "
+              << CountInView(registry, "vtkMRMLViewNode1") << " "
+              << CountInView(registry, "vtkMRMLViewNode2") << std::endl;
+    scene->Delete();
+    return EXIT_FAILURE;
+    }
+
+  // The cached views follow the display nodes
+  display2->RemoveAllViewNodeIDs();
+  display1->AddViewNodeID("vtkMRMLViewNode2");
+  if (CountInView(registry, "vtkMRMLViewNode1") != 1 ||
+      CountInView(registry, "vtkMRMLViewNode2") != 2)
+    {
+    std::cerr << "The views are not updated: "
+              << CountInView(registry, "vtkMRMLViewNode1") << " "
+              << CountInView(registry, "vtkMRMLViewNode2") << std::endl;
+    scene->Delete();
+    return EXIT_FAILURE;
+    }
+
+  scene->RemoveNode(model2.GetPointer());
+  nodes.clear();
+  if (registry->GetDisplayableNodes(nodes) != 1 ||
+      CountInView(registry, "vtkMRMLViewNode1") != 0 ||
+      CountInView(registry, "vtkMRMLViewNode2") != 1)
+    {
+    std::cerr << "The removed node is still registered" << std::endl;
+    scene->Delete();
+    return EXIT_FAILURE;
+    }
+
+  scene->Delete();
+  return EXIT_SUCCESS;
+}
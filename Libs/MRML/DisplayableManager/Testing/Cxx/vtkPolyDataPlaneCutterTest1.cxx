@@ -0,0 +1,136 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRMLDisplayableManager includes
+#include <vtkPolyDataPlaneCutter.h>
+
+// VTK includes
+#include <vtkCellArray.h>
+#include <vtkCutter.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkPlane.h>
+#include <vtkPolyData.h>
+#include <vtkSphereSource.h>
+
+// STD includes
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+//----------------------------------------------------------------------------
+double LinesLength(vtkPolyData* polyData)
+{
+  double length = 0.;
+  vtkCellArray* lines = polyData->GetLines();
+  vtkIdType npts = 0;
+  vtkIdType* pts = 0;
+  for (lines->InitTraversal(); lines->GetNextCell(npts, pts);)
+    {
+    for (vtkIdType i = 0; i + 1 < npts; ++i)
+      {
+      double p1[3];
+      double p2[3];
+      polyData->GetPoint(pts[i], p1);
+      polyData->GetPoint(pts[i + 1], p2);
+      length += sqrt(vtkMath::Distance2BetweenPoints(p1, p2));
+      }
+    }
+  return length;
+}
+
+//----------------------------------------------------------------------------
+bool CompareCutters(vtkCutter* cutter, vtkPolyDataPlaneCutter* planeCutter,
+                    vtkPlane* plane, double normal[3], double origin[3])
+{
+  plane->SetNormal(normal);
+  plane->SetOrigin(origin);
+  cutter->Update();
+  planeCutter->Update();
+  double expectedLength = LinesLength(cutter->GetOutput());
+  double length = LinesLength(planeCutter->GetOutput());
+  if (fabs(expectedLength - length) > 1e-4 * (1. + expectedLength) ||
+      cutter->GetOutput()->GetNumberOfLines() !=
+        planeCutter->GetOutput()->GetNumberOfLines())
+    {
+    std::cerr << "Plane (" << normal[0] << ", " << normal[1] << ", " << normal[2]
+              << ") at (" << origin[0] << ", " << origin[1] << ", " << origin[2]
+              << "): length " << length << " instead of " << expectedLength
+              << ", " << planeCutter->GetOutput()->GetNumberOfLines()
+              << " lines instead of " << cutter->GetOutput()->GetNumberOfLines()
+              << std::endl;
+    return false;
+    }
+  return true;
+}
+}
+
+//----------------------------------------------------------------------------
+int vtkPolyDataPlaneCutterTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetThetaResolution(120);
+  sphere->SetPhiResolution(80);
+  sphere->SetRadius(50.);
+  sphere->Update();
+  vtkNew<vtkPolyData> polyData;
+  polyData->DeepCopy(sphere->GetOutput());
+
+  vtkNew<vtkPlane> plane;
+  vtkNew<vtkCutter> cutter;
+  cutter->SetInput(polyData.GetPointer());
+  cutter->SetCutFunction(plane.GetPointer());
+  cutter->SetGenerateCutScalars(0);
+
+  vtkNew<vtkPolyDataPlaneCutter> planeCutter;
+  planeCutter->SetInput(polyData.GetPointer());
+  planeCutter->SetPlane(plane.GetPointer());
+
+  bool res = true;
+  for (int threads = 1; threads <= 4; threads *= 2)
+    {
+    planeCutter->SetNumberOfThreads(threads);
+    for (int i = -60; i <= 60; i += 7)
+      {
+      double axial[3] = {0., 0., 1.};
+      double oblique[3] = {0.3, -0.5, 0.81};
+      double origin[3] = {1., 2., static_cast<double>(i)};
+      vtkMath::Normalize(oblique);
+      res = CompareCutters(cutter.GetPointer(), planeCutter.GetPointer(),
+                           plane.GetPointer(), axial, origin) && res;
+      res = CompareCutters(cutter.GetPointer(), planeCutter.GetPointer(),
+                           plane.GetPointer(), oblique, origin) && res;
+      }
+    }
+
+  // the cells are binned again when the polydata is modified
+  double normal[3] = {1., 0., 0.};
+  double origin[3] = {70., 0., 0.};
+  res = CompareCutters(cutter.GetPointer(), planeCutter.GetPointer(),
+                       plane.GetPointer(), normal, origin) && res;
+  sphere->SetCenter(60., 0., 0.);
+  sphere->Update();
+  polyData->DeepCopy(sphere->GetOutput());
+  res = CompareCutters(cutter.GetPointer(), planeCutter.GetPointer(),
+                       plane.GetPointer(), normal, origin) && res;
+  if (planeCutter->GetOutput()->GetNumberOfLines() == 0)
+    {
+    std::cerr << "The modified polydata is not cut" << std::endl;
+    res = false;
+    }
+
+  return res ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -95,6 +95,18 @@ public:
   // Did crosshair property change?
   bool DidCrosshairPropertyChange();
 
+  // Set the crosshair position, at most once per PositionUpdateInterval.
+  // A negative lightBoxPane keeps the current pane.
+  void RequestCrosshairPosition(double ras[3], int lightBoxPane);
+  // Apply the pending position, if any
+  void FlushCrosshairPosition();
+  // Drop the pending position, if any
+  void CancelCrosshairPosition();
+  void StartPositionTimer();
+  void RemovePositionTimer();
+  static void OnPositionTimer(vtkObject* caller, unsigned long eid,
+                              void* clientData, void* callData);
+
   // PickStates
   enum
   {
@@ -122,6 +134,14 @@ public:
   vtkSmartPointer<vtkActor2D>                HighlightActor;
   vtkSmartPointer<vtkMRMLCrosshairNode>      CrosshairNodeCache;
   vtkWeakPointer<vtkRenderer>                LightBoxRenderer;
+
+  bool                                       PositionPending;
+  double                                     PendingRAS[3];
+  int                                        PendingLightBoxPane;
+  int                                        PositionTimerId;
+  vtkWeakPointer<vtkRenderWindowInteractor>  TimerInteractor;
+  vtkSmartPointer<vtkCallbackCommand>        TimerCallback;
+  unsigned long                              TimerObserverTag;
 };
 
 
@@ -141,11 +161,21 @@ vtkMRMLCrosshairDisplayableManager::vtkInternal
   this->HighlightActor = 0;
   this->LightBoxRenderer = 0;
   this->CrosshairNodeCache = vtkSmartPointer<vtkMRMLCrosshairNode>::New();
+  this->PositionPending = false;
+  this->PendingRAS[0] = this->PendingRAS[1] = this->PendingRAS[2] = 0.;
+  this->PendingLightBoxPane = -1;
+  this->PositionTimerId = 0;
+  this->TimerInteractor = 0;
+  this->TimerCallback = vtkSmartPointer<vtkCallbackCommand>::New();
+  this->TimerCallback->SetCallback(vtkInternal::OnPositionTimer);
+  this->TimerCallback->SetClientData(this);
+  this->TimerObserverTag = 0;
 }
 
 //---------------------------------------------------------------------------
 vtkMRMLCrosshairDisplayableManager::vtkInternal::~vtkInternal()
 {
+  this->RemovePositionTimer();
   this->SetSliceCompositeNode(0);
   this->SetCrosshairNode(0);
   this->LightBoxRenderer = 0;
@@ -530,6 +560,112 @@ void vtkMRMLCrosshairDisplayableManager::vtkInternal::AddCrosshairLine(vtkPoints
   cellArray->InsertCellPoint(p2);
 }
 
+//---------------------------------------------------------------------------
+void vtkMRMLCrosshairDisplayableManager::vtkInternal
+::RequestCrosshairPosition(double ras[3], int lightBoxPane)
+{
+  this->PendingRAS[0] = ras[0];
+  this->PendingRAS[1] = ras[1];
+  this->PendingRAS[2] = ras[2];
+  this->PendingLightBoxPane = lightBoxPane;
+  this->PositionPending = true;
+  if (this->PositionTimerId != 0)
+    {
+    // Applied when the timer elapses
+    return;
+    }
+  this->FlushCrosshairPosition();
+  this->StartPositionTimer();
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLCrosshairDisplayableManager::vtkInternal::FlushCrosshairPosition()
+{
+  if (!this->PositionPending)
+    {
+    return;
+    }
+  this->PositionPending = false;
+  if (!this->CrosshairNode)
+    {
+    return;
+    }
+  // modifying the CrosshairRAS will trigger a render
+  if (this->PendingLightBoxPane >= 0)
+    {
+    this->CrosshairNode->SetCrosshairRAS(this->PendingRAS,
+                                         this->PendingLightBoxPane);
+    }
+  else
+    {
+    this->CrosshairNode->SetCrosshairRAS(this->PendingRAS);
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLCrosshairDisplayableManager::vtkInternal::CancelCrosshairPosition()
+{
+  this->PositionPending = false;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLCrosshairDisplayableManager::vtkInternal::StartPositionTimer()
+{
+  vtkRenderWindowInteractor* interactor = this->External->GetInteractor();
+  int interval = this->External->GetPositionUpdateInterval();
+  if (!interactor || interval <= 0)
+    {
+    return;
+    }
+  if (this->TimerInteractor.GetPointer() != interactor)
+    {
+    this->RemovePositionTimer();
+    // The timer id is only passed to the observers of the interactor, the
+    // displayable manager interactor callbacks don't receive it.
+    this->TimerObserverTag =
+      interactor->AddObserver(vtkCommand::TimerEvent, this->TimerCallback);
+    this->TimerInteractor = interactor;
+    }
+  // 0 if the interactor doesn't support timers, the positions are then
+  // applied on every move.
+  this->PositionTimerId = interactor->CreateOneShotTimer(interval);
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLCrosshairDisplayableManager::vtkInternal::RemovePositionTimer()
+{
+  if (this->TimerInteractor)
+    {
+    if (this->PositionTimerId != 0)
+      {
+      this->TimerInteractor->DestroyTimer(this->PositionTimerId);
+      }
+    this->TimerInteractor->RemoveObserver(this->TimerObserverTag);
+    }
+  this->TimerInteractor = 0;
+  this->TimerObserverTag = 0;
+  this->PositionTimerId = 0;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLCrosshairDisplayableManager::vtkInternal
+::OnPositionTimer(vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(eid),
+                  void* clientData, void* callData)
+{
+  vtkInternal* self = reinterpret_cast<vtkInternal*>(clientData);
+  int timerId = callData ? *reinterpret_cast<int*>(callData) : 0;
+  if (timerId == 0 || timerId != self->PositionTimerId)
+    {
+    return;
+    }
+  self->PositionTimerId = 0;
+  if (self->PositionPending)
+    {
+    self->FlushCrosshairPosition();
+    // Keep throttling while the mouse moves
+    self->StartPositionTimer();
+    }
+}
 
 //---------------------------------------------------------------------------
 // vtkMRMLCrosshairDisplayableManager methods
@@ -537,6 +673,7 @@ void vtkMRMLCrosshairDisplayableManager::vtkInternal::AddCrosshairLine(vtkPoints
 //---------------------------------------------------------------------------
 vtkMRMLCrosshairDisplayableManager::vtkMRMLCrosshairDisplayableManager()
 {
+  this->PositionUpdateInterval = 16;
   this->Internal = new vtkInternal(this);
 }
 
@@ -550,6 +687,8 @@ vtkMRMLCrosshairDisplayableManager::~vtkMRMLCrosshairDisplayableManager()
 void vtkMRMLCrosshairDisplayableManager::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "PositionUpdateInterval: "
+     << this->PositionUpdateInterval << "\n";
 }
 
 //---------------------------------------------------------------------------
@@ -690,7 +829,9 @@ void vtkMRMLCrosshairDisplayableManager::OnInteractorStyleEvent(int eventid)
           xyz[1] = renderer->GetSize()[1] / 2.0;
           xyz[2] = 0;
           this->ConvertXYZToRAS(xyz, ras);
-        
+
+          // A move coalesced before leaving the view must not override it
+          this->Internal->CancelCrosshairPosition();
           this->Internal->CrosshairNode->SetCrosshairRAS(ras[0], ras[1],ras[2]);
           }
         break;
@@ -699,6 +840,8 @@ void vtkMRMLCrosshairDisplayableManager::OnInteractorStyleEvent(int eventid)
         // Button release is only meaningful in navigation mode
         if (this->Internal->CrosshairNode->GetNavigation())
           {
+          // Drop the crosshair where the drag ended
+          this->Internal->FlushCrosshairPosition();
           this->Internal->PickState = vtkInternal::NoPick;
           this->Internal->ActionState = vtkInternal::NoAction;
           }
@@ -825,16 +968,14 @@ void vtkMRMLCrosshairDisplayableManager::OnInteractorEvent(int eventid)
               // Set the new position on the crosshair and a suggested
               // lightbox pane
               int id = (int) (xyz[2] + 0.5); // round to find the lightbox
-              this->Internal->CrosshairNode->SetCrosshairRAS(ras, id);
-              // modifying the CrosshairRAS will trigger a render
+              this->Internal->RequestCrosshairPosition(ras, id);
               break;
             }
           }
         else
           {
           // Cross-referencing mode. Set the new position on the crosshair
-          // modifying the CrosshairRAS will trigger a render
-          this->Internal->CrosshairNode->SetCrosshairRAS(ras);
+          this->Internal->RequestCrosshairPosition(ras, -1);
           }
         break;
       }
@@ -37,6 +37,16 @@ public:
                        vtkMRMLAbstractSliceViewDisplayableManager);
   void PrintSelf(ostream& os, vtkIndent indent);
 
+  /// Minimum interval in milliseconds between two crosshair position
+  /// updates driven by mouse moves. The first move updates the crosshair
+  /// right away, the moves received during the interval are coalesced and
+  /// only the last one is applied when it elapses, so that the crosshair
+  /// node (and all the views observing it) is modified at most once per
+  /// frame. 0 updates the crosshair on every move.
+  /// 16ms (one frame at 60Hz) by default.
+  vtkSetClampMacro(PositionUpdateInterval, int, 0, VTK_INT_MAX);
+  vtkGetMacro(PositionUpdateInterval, int);
+
 protected:
   vtkMRMLCrosshairDisplayableManager();
   virtual ~vtkMRMLCrosshairDisplayableManager();
@@ -71,6 +81,8 @@ private:
   virtual void UpdateFromMRMLScene();
   virtual void OnMRMLNodeModified(vtkMRMLNode* node);
 
+  int PositionUpdateInterval;
+
   class vtkInternal;
   vtkInternal * Internal;
 };
@@ -0,0 +1,340 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRMLDisplayableManager includes
+#include "vtkMRMLDisplayableNodeRegistry.h"
+
+// MRML includes
+#include <vtkMRMLDisplayableNode.h>
+#include <vtkMRMLDisplayNode.h>
+#include <vtkMRMLScene.h>
+
+// VTK includes
+#include <vtkCallbackCommand.h>
+#include <vtkObjectFactory.h>
+#include <vtkSmartPointer.h>
+
+// STD includes
+#include <algorithm>
+#include <map>
+#include <string>
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkMRMLDisplayableNodeRegistry);
+vtkCxxRevisionMacro(vtkMRMLDisplayableNodeRegistry, "$Revision$");
+
+namespace
+{
+//----------------------------------------------------------------------------
+typedef std::map<vtkMRMLScene*, vtkSmartPointer<vtkMRMLDisplayableNodeRegistry> >
+  SceneRegistriesType;
+
+//----------------------------------------------------------------------------
+SceneRegistriesType& SceneRegistries()
+{
+  static SceneRegistriesType registries;
+  return registries;
+}
+
+//----------------------------------------------------------------------------
+bool IsDisplayableInView(vtkMRMLDisplayableNode* node, const char* viewNodeID)
+{
+  for (int i = 0; i < node->GetNumberOfDisplayNodes(); ++i)
+    {
+    vtkMRMLDisplayNode* displayNode = node->GetNthDisplayNode(i);
+    if (displayNode && displayNode->IsDisplayableInView(viewNodeID))
+      {
+      return true;
+      }
+    }
+  return false;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+class vtkMRMLDisplayableNodeRegistry::vtkInternal
+{
+public:
+  vtkInternal();
+
+  vtkMRMLScene* Scene;
+
+  /// Displayable nodes in the order they were added to the scene
+  std::vector<vtkMRMLDisplayableNode*> DisplayableNodes;
+
+  /// Displayable nodes of each view that has been queried
+  typedef std::map<std::string, std::vector<vtkMRMLDisplayableNode*> > ViewNodesType;
+  ViewNodesType ViewNodes;
+};
+
+//----------------------------------------------------------------------------
+vtkMRMLDisplayableNodeRegistry::vtkInternal::vtkInternal()
+{
+  this->Scene = 0;
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLDisplayableNodeRegistry::vtkMRMLDisplayableNodeRegistry()
+{
+  this->Internal = new vtkInternal;
+  this->CallbackCommand = vtkCallbackCommand::New();
+  this->CallbackCommand->SetClientData(this);
+  this->CallbackCommand->SetCallback(vtkMRMLDisplayableNodeRegistry::ProcessEvents);
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLDisplayableNodeRegistry::~vtkMRMLDisplayableNodeRegistry()
+{
+  this->SetMRMLScene(0);
+  this->CallbackCommand->Delete();
+  delete this->Internal;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLDisplayableNodeRegistry::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "Scene: " << this->Internal->Scene << "\n";
+  os << indent << "DisplayableNodes: "
+     << this->Internal->DisplayableNodes.size() << "\n";
+  os << indent << "Views: " << this->Internal->ViewNodes.size() << "\n";
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLDisplayableNodeRegistry* vtkMRMLDisplayableNodeRegistry
+::GetSceneRegistry(vtkMRMLScene* scene)
+{
+  if (!scene)
+    {
+    return 0;
+    }
+  SceneRegistriesType::iterator it = SceneRegistries().find(scene);
+  if (it != SceneRegistries().end())
+    {
+    return it->second;
+    }
+  vtkSmartPointer<vtkMRMLDisplayableNodeRegistry> registry =
+    vtkSmartPointer<vtkMRMLDisplayableNodeRegistry>::New();
+  registry->SetMRMLScene(scene);
+  SceneRegistries()[scene] = registry;
+  return registry;
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLScene* vtkMRMLDisplayableNodeRegistry::GetMRMLScene()const
+{
+  return this->Internal->Scene;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLDisplayableNodeRegistry::SetMRMLScene(vtkMRMLScene* scene)
+{
+  if (scene == this->Internal->Scene)
+    {
+    return;
+    }
+  if (this->Internal->Scene)
+    {
+    this->Internal->Scene->RemoveObserver(this->CallbackCommand);
+    }
+  this->Internal->Scene = scene;
+  if (scene)
+    {
+    scene->AddObserver(vtkMRMLScene::NodeAddedEvent, this->CallbackCommand);
+    scene->AddObserver(vtkMRMLScene::NodeRemovedEvent, this->CallbackCommand);
+    scene->AddObserver(vtkMRMLScene::EndCloseEvent, this->CallbackCommand);
+    scene->AddObserver(vtkCommand::DeleteEvent, this->CallbackCommand);
+    }
+  this->UpdateFromMRMLScene();
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLDisplayableNodeRegistry
+::GetDisplayableNodes(std::vector<vtkMRMLDisplayableNode*>& nodes)
+{
+  nodes.insert(nodes.end(), this->Internal->DisplayableNodes.begin(),
+               this->Internal->DisplayableNodes.end());
+  return static_cast<int>(nodes.size());
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLDisplayableNodeRegistry
+::GetDisplayableNodesInView(const char* viewNodeID,
+                            std::vector<vtkMRMLDisplayableNode*>& nodes)
+{
+  std::string viewID(viewNodeID ? viewNodeID : "");
+  vtkInternal::ViewNodesType::iterator it = this->Internal->ViewNodes.find(viewID);
+  if (it == this->Internal->ViewNodes.end())
+    {
+    // First query for the view, the following ones are answered from the
+    // nodes kept up to date by the events.
+    std::vector<vtkMRMLDisplayableNode*> viewNodes;
+    std::vector<vtkMRMLDisplayableNode*>::const_iterator nodeIt;
+    for (nodeIt = this->Internal->DisplayableNodes.begin();
+         nodeIt != this->Internal->DisplayableNodes.end(); ++nodeIt)
+      {
+      if (IsDisplayableInView(*nodeIt, viewID.c_str()))
+        {
+        viewNodes.push_back(*nodeIt);
+        }
+      }
+    it = this->Internal->ViewNodes.insert(
+      vtkInternal::ViewNodesType::value_type(viewID, viewNodes)).first;
+    }
+  nodes.insert(nodes.end(), it->second.begin(), it->second.end());
+  return static_cast<int>(nodes.size());
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLDisplayableNodeRegistry::AddDisplayableNode(vtkMRMLDisplayableNode* node)
+{
+  if (std::find(this->Internal->DisplayableNodes.begin(),
+                this->Internal->DisplayableNodes.end(), node) !=
+      this->Internal->DisplayableNodes.end())
+    {
+    return;
+    }
+  this->Internal->DisplayableNodes.push_back(node);
+  node->AddObserver(vtkMRMLDisplayableNode::DisplayModifiedEvent, this->CallbackCommand);
+  vtkInternal::ViewNodesType::iterator it;
+  for (it = this->Internal->ViewNodes.begin(); it != this->Internal->ViewNodes.end(); ++it)
+    {
+    if (IsDisplayableInView(node, it->first.c_str()))
+      {
+      it->second.push_back(node);
+      }
+    }
+  this->InvokeEvent(DisplayableNodeAddedEvent, node);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLDisplayableNodeRegistry::RemoveDisplayableNode(vtkMRMLDisplayableNode* node)
+{
+  std::vector<vtkMRMLDisplayableNode*>::iterator nodeIt =
+    std::find(this->Internal->DisplayableNodes.begin(),
+              this->Internal->DisplayableNodes.end(), node);
+  if (nodeIt == this->Internal->DisplayableNodes.end())
+    {
+    return;
+    }
+  this->Internal->DisplayableNodes.erase(nodeIt);
+  node->RemoveObserver(this->CallbackCommand);
+  vtkInternal::ViewNodesType::iterator it;
+  for (it = this->Internal->ViewNodes.begin(); it != this->Internal->ViewNodes.end(); ++it)
+    {
+    it->second.erase(std::remove(it->second.begin(), it->second.end(), node),
+                     it->second.end());
+    }
+  this->InvokeEvent(DisplayableNodeRemovedEvent, node);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLDisplayableNodeRegistry::UpdateFromMRMLScene()
+{
+  std::vector<vtkMRMLDisplayableNode*>::const_iterator nodeIt;
+  for (nodeIt = this->Internal->DisplayableNodes.begin();
+       nodeIt != this->Internal->DisplayableNodes.end(); ++nodeIt)
+    {
+    (*nodeIt)->RemoveObserver(this->CallbackCommand);
+    }
+  this->Internal->DisplayableNodes.clear();
+  this->Internal->ViewNodes.clear();
+  if (!this->Internal->Scene)
+    {
+    return;
+    }
+  std::vector<vtkMRMLNode*> nodes;
+  this->Internal->Scene->GetNodesByClass("vtkMRMLDisplayableNode", nodes);
+  std::vector<vtkMRMLNode*>::const_iterator it;
+  for (it = nodes.begin(); it != nodes.end(); ++it)
+    {
+    vtkMRMLDisplayableNode* node = vtkMRMLDisplayableNode::SafeDownCast(*it);
+    this->Internal->DisplayableNodes.push_back(node);
+    node->AddObserver(vtkMRMLDisplayableNode::DisplayModifiedEvent, this->CallbackCommand);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLDisplayableNodeRegistry::ProcessEvents(vtkObject* caller,
+                                                   unsigned long event,
+                                                   void* clientData,
+                                                   void* callData)
+{
+  vtkMRMLDisplayableNodeRegistry* self =
+    reinterpret_cast<vtkMRMLDisplayableNodeRegistry*>(clientData);
+  vtkMRMLScene* scene = vtkMRMLScene::SafeDownCast(caller);
+  if (scene && event == vtkCommand::DeleteEvent)
+    {
+    // Keep the registry alive while it is released
+    vtkSmartPointer<vtkMRMLDisplayableNodeRegistry> registry = self;
+    self->SetMRMLScene(0);
+    SceneRegistries().erase(scene);
+    return;
+    }
+  if (scene && event == vtkMRMLScene::EndCloseEvent)
+    {
+    self->UpdateFromMRMLScene();
+    return;
+    }
+  if (scene)
+    {
+    vtkObject* object = reinterpret_cast<vtkObject*>(callData);
+    if (event == vtkMRMLScene::NodeRemovedEvent &&
+        vtkMRMLDisplayNode::SafeDownCast(object))
+      {
+      // Removing a display node reference doesn't invoke
+      // DisplayModifiedEvent, the views are recomputed when queried.
+      self->Internal->ViewNodes.clear();
+      return;
+      }
+    vtkMRMLDisplayableNode* node = vtkMRMLDisplayableNode::SafeDownCast(object);
+    if (!node)
+      {
+      return;
+      }
+    if (event == vtkMRMLScene::NodeAddedEvent)
+      {
+      self->AddDisplayableNode(node);
+      }
+    else if (event == vtkMRMLScene::NodeRemovedEvent)
+      {
+      self->RemoveDisplayableNode(node);
+      }
+    return;
+    }
+  vtkMRMLDisplayableNode* node = vtkMRMLDisplayableNode::SafeDownCast(caller);
+  if (node && event == vtkMRMLDisplayableNode::DisplayModifiedEvent)
+    {
+    // Only the views the node enters or leaves are updated
+    vtkInternal::ViewNodesType::iterator it;
+    for (it = self->Internal->ViewNodes.begin(); it != self->Internal->ViewNodes.end(); ++it)
+      {
+      std::vector<vtkMRMLDisplayableNode*>::iterator nodeIt =
+        std::find(it->second.begin(), it->second.end(), node);
+      bool inView = IsDisplayableInView(node, it->first.c_str());
+      if (inView && nodeIt == it->second.end())
+        {
+        it->second.push_back(node);
+        }
+      else if (!inView && nodeIt != it->second.end())
+        {
+        it->second.erase(nodeIt);
+        }
+      }
+    self->InvokeEvent(DisplayableNodeDisplayModifiedEvent, node);
+    }
+}
@@ -0,0 +1,98 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkMRMLDisplayableNodeRegistry_h
+#define __vtkMRMLDisplayableNodeRegistry_h
+
+// MRMLDisplayableManager includes
+#include "vtkMRMLDisplayableManagerWin32Header.h"
+
+// VTK includes
+#include <vtkObject.h>
+
+// STD includes
+#include <vector>
+
+class vtkCallbackCommand;
+class vtkMRMLDisplayableNode;
+class vtkMRMLScene;
+
+/// \brief Displayable nodes of a scene, shared by the displayable managers.
+///
+/// The registry observes the scene and the display of its displayable nodes
+/// once for all the views, and keeps for each view the displayable nodes
+/// that have a display node displayable in that view. The displayable
+/// managers query it instead of visiting all the displayable nodes of the
+/// scene, and may observe its events instead of observing each node.
+/// Use GetSceneRegistry() to get the registry of a scene.
+class VTK_MRML_DISPLAYABLEMANAGER_EXPORT vtkMRMLDisplayableNodeRegistry
+  : public vtkObject
+{
+public:
+  static vtkMRMLDisplayableNodeRegistry *New();
+  vtkTypeRevisionMacro(vtkMRMLDisplayableNodeRegistry, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  /// Registry of \a scene, created the first time it is requested and
+  /// released when the scene is deleted.
+  static vtkMRMLDisplayableNodeRegistry* GetSceneRegistry(vtkMRMLScene* scene);
+
+  /// Scene to track the displayable nodes of
+  void SetMRMLScene(vtkMRMLScene* scene);
+  vtkMRMLScene* GetMRMLScene()const;
+
+  /// Events invoked with the displayable node as call data
+  enum
+    {
+    DisplayableNodeAddedEvent = 19200,
+    DisplayableNodeRemovedEvent,
+    /// A display node of the displayable node has been added, removed or
+    /// modified
+    DisplayableNodeDisplayModifiedEvent
+    };
+
+  /// Append the displayable nodes of the scene to \a nodes, in the order
+  /// they were added to the scene. Return the size of \a nodes.
+  int GetDisplayableNodes(std::vector<vtkMRMLDisplayableNode*>& nodes);
+
+  /// Append the displayable nodes that have at least one display node
+  /// displayable in the view \a viewNodeID to \a nodes.
+  /// Return the size of \a nodes.
+  /// \sa vtkMRMLDisplayNode::IsDisplayableInView()
+  int GetDisplayableNodesInView(const char* viewNodeID,
+                                std::vector<vtkMRMLDisplayableNode*>& nodes);
+
+protected:
+  vtkMRMLDisplayableNodeRegistry();
+  virtual ~vtkMRMLDisplayableNodeRegistry();
+
+  static void ProcessEvents(vtkObject* caller, unsigned long event,
+                            void* clientData, void* callData);
+
+  void AddDisplayableNode(vtkMRMLDisplayableNode* node);
+  void RemoveDisplayableNode(vtkMRMLDisplayableNode* node);
+  void UpdateFromMRMLScene();
+
+  vtkCallbackCommand* CallbackCommand;
+
+  class vtkInternal;
+  vtkInternal* Internal;
+
+private:
+  vtkMRMLDisplayableNodeRegistry(const vtkMRMLDisplayableNodeRegistry&); // Not implemented
+  void operator=(const vtkMRMLDisplayableNodeRegistry&);                  // Not implemented
+};
+
+#endif
@@ -16,6 +16,7 @@
 
 // MRMLDisplayableManager includes
 #include "vtkMRMLModelDisplayableManager.h"
+#include "vtkMRMLDisplayableNodeRegistry.h"
 #include "vtkThreeDViewInteractorStyle.h"
 #include "vtkMRMLApplicationLogic.h"
 
@@ -35,23 +36,44 @@
 #include "vtkMRMLInteractionNode.h"
 
 // VTK includes
+#include <vtkAlgorithmOutput.h>
 #include <vtkAssignAttribute.h>
+#include <vtkCallbackCommand.h>
 #include <vtkCellArray.h>
 #include <vtkClipPolyData.h>
 #include <vtkColorTransferFunction.h>
+#include <vtkCriticalSection.h>
 #include <vtkDataSetAttributes.h>
+#include <vtkDecimatePro.h>
 #include <vtkImageActor.h>
 #include <vtkImageData.h>
 #include <vtkImplicitBoolean.h>
+#include <vtkLODActor.h>
 #include <vtkLookupTable.h>
+#include <vtkMapperCollection.h>
+#include <vtkMath.h>
 #include <vtkMatrix4x4.h>
+#include <vtkMultiThreader.h>
+#include <vtkNew.h>
+#include <vtkOpenGLProperty.h>
+#include <vtkOpenGLRenderWindow.h>
 #include <vtkPlane.h>
+#include <vtkPointData.h>
 #include <vtkPolyDataMapper.h>
+#include <vtkPolyDataNormals.h>
 #include <vtkProperty.h>
+#include <vtkRenderer.h>
 #include <vtkRenderWindowInteractor.h>
+#include <vtkShader2.h>
+#include <vtkShader2Collection.h>
+#include <vtkShaderProgram2.h>
 #include <vtkSmartPointer.h>
+#include <vtkTriangleFilter.h>
+#include <vtkUniformVariables.h>
+#include <vtkWeakPointer.h>
 
 // for picking
+#include <vtkCellLocator.h>
 #include <vtkCellPicker.h>
 #include <vtkPointPicker.h>
 #include <vtkPropPicker.h>
@@ -59,12 +81,83 @@
 #include <vtkWorldPointPicker.h>
 
 // STD includes
+#include <algorithm>
 #include <cassert>
+#include <list>
+#include <sstream>
 
 //---------------------------------------------------------------------------
 vtkStandardNewMacro (vtkMRMLModelDisplayableManager );
 vtkCxxRevisionMacro ( vtkMRMLModelDisplayableManager, "$Revision: 13525 $");
 
+//---------------------------------------------------------------------------
+namespace
+{
+// vtkOpenGLProperty links the shaders of a prop program with main()
+// functions that call propFuncVS() and propFuncFS().
+// The fragments on the negative side of the clip function are discarded:
+// the planes are (normal, -normal.origin) in the coordinates of the model,
+// combined with min() for an union and max() for an intersection as
+// vtkImplicitBoolean does. The fragments left are lit on both sides.
+const char* ClipVertexShader =
+  "varying vec3 ClipPosition;\n"
+  "varying vec3 EyeNormal;\n"
+  "void propFuncVS()\n"
+  "{\n"
+  "  ClipPosition = gl_Vertex.xyz / gl_Vertex.w;\n"
+  "  EyeNormal = gl_NormalMatrix * gl_Normal;\n"
+  "  gl_FrontColor = gl_Color;\n"
+  "  gl_Position = ftransform();\n"
+  "}\n";
+
+const char* ClipFragmentShader =
+  "uniform int NumberOfClipPlanes;\n"
+  "uniform int ClipUnion;\n"
+  "uniform vec4 ClipPlane0;\n"
+  "uniform vec4 ClipPlane1;\n"
+  "uniform vec4 ClipPlane2;\n"
+  "uniform float Ambient;\n"
+  "uniform float Diffuse;\n"
+  "varying vec3 ClipPosition;\n"
+  "varying vec3 EyeNormal;\n"
+  "float combine(float f, vec4 plane)\n"
+  "{\n"
+  "  float g = dot(plane.xyz, ClipPosition) + plane.w;\n"
+  "  return (ClipUnion == 1) ? min(f, g) : max(f, g);\n"
+  "}\n"
+  "void propFuncFS()\n"
+  "{\n"
+  "  float f = dot(ClipPlane0.xyz, ClipPosition) + ClipPlane0.w;\n"
+  "  if (NumberOfClipPlanes > 1)\n"
+  "    {\n"
+  "    f = combine(f, ClipPlane1);\n"
+  "    }\n"
+  "  if (NumberOfClipPlanes > 2)\n"
+  "    {\n"
+  "    f = combine(f, ClipPlane2);\n"
+  "    }\n"
+  "  if (f < 0.)\n"
+  "    {\n"
+  "    discard;\n"
+  "    }\n"
+  "  vec3 normal = normalize(EyeNormal);\n"
+  "  if (!gl_FrontFacing)\n"
+  "    {\n"
+  "    normal = -normal;\n"
+  "    }\n"
+  "  vec3 light = normalize(gl_LightSource[0].position.xyz);\n"
+  "  float diffuse = max(dot(normal, light), 0.);\n"
+  "  float specular = 0.;\n"
+  "  float highlight = dot(normal, normalize(light + vec3(0., 0., 1.)));\n"
+  "  if (highlight > 0.)\n"
+  "    {\n"
+  "    specular = pow(highlight, max(gl_FrontMaterial.shininess, 1.));\n"
+  "    }\n"
+  "  gl_FragColor = vec4(gl_Color.rgb * (Ambient + Diffuse * diffuse) +\n"
+  "                      gl_FrontMaterial.specular.rgb * specular, gl_Color.a);\n"
+  "}\n";
+}
+
 //---------------------------------------------------------------------------
 class vtkMRMLModelDisplayableManager::vtkInternal
 {
@@ -74,6 +167,19 @@ public:
 
   void CreateClipSlices();
 
+  /// What DisplayedClipState records
+  enum
+    {
+    NotClipped = 0,
+    ClippedGeometry = 1,
+    ClippedFragments = 2
+    };
+  /// How an actor whose display node has the clipping flag is clipped
+  int GetClipState(int clipping) const;
+
+  /// Make the clip program of the context
+  vtkShaderProgram2* NewClipProgram(vtkOpenGLRenderWindow* context);
+
   /// Reset all the pick vars
   void ResetPick();
 
@@ -98,7 +204,30 @@ public:
   int                     RedSliceClipState;
   int                     YellowSliceClipState;
   int                     GreenSliceClipState;
+  int                     ClipMethod;
   bool                    ClippingOn;
+  /// Set by UpdateClipSlicesFromMRML() when a plane that clips has moved
+  bool                    ClipPlanesModified;
+
+  /// Clip function of a display node of a model under a linear transform,
+  /// its planes are in the coordinates of the model and are moved in place
+  struct TransformedClipPlanes
+    {
+    std::string                         DisplayableNodeID;
+    /// ClipType and the red, green and yellow clip states of the functions
+    int                                 ClipStates[4];
+    vtkSmartPointer<vtkImplicitBoolean> SlicePlanes;
+    vtkSmartPointer<vtkPlane>           RedSlicePlane;
+    vtkSmartPointer<vtkPlane>           GreenSlicePlane;
+    vtkSmartPointer<vtkPlane>           YellowSlicePlane;
+    };
+  std::map<std::string, TransformedClipPlanes> TransformedClippers;
+
+  /// Clip program of the actors clipped by shader, one per display node for
+  /// their uniforms
+  std::map<std::string, vtkSmartPointer<vtkShaderProgram2> > ClipPrograms;
+  /// -1 if not checked yet
+  int ClipShadersSupported;
 
   bool                         ModelHierarchiesPresent;
   bool                         UpdateHierachyRequested;
@@ -108,11 +237,66 @@ public:
   vtkSmartPointer<vtkCellPicker>       CellPicker;
   vtkSmartPointer<vtkPointPicker>      PointPicker;
 
+  /// Cell locator of the polydata mapped by a displayed actor, given to the
+  /// cell picker so that picks don't visit all the cells.
+  struct PickLocator
+    {
+    vtkSmartPointer<vtkCellLocator> Locator;
+    unsigned long                   PolyDataMTime;
+    };
+  std::map<std::string, PickLocator> PickLocators;
+  void RemovePickLocator(const std::string& displayNodeID);
+
   /// Information about a pick event
   std::string  PickedNodeID;
   double       PickedRAS[3];
   vtkIdType    PickedCellID;
   vtkIdType    PickedPointID;
+
+  /// Levels of detail of a polydata to decimate
+  struct LODJob
+    {
+    std::string                                DisplayNodeID;
+    unsigned long                              Generation;
+    vtkSmartPointer<vtkPolyData>               PolyData;
+    std::vector<vtkSmartPointer<vtkPolyData> > Levels;
+    };
+  /// What the levels of detail of an actor are made from
+  struct LODState
+    {
+    vtkMapper*    Mapper;
+    vtkPolyData*  PolyData;
+    unsigned long PolyDataMTime;
+    unsigned long Generation;
+    };
+
+  /// Queue the decimation of a copy of polyData for the display node and
+  /// start the thread if it is not running.
+  void QueueLODJob(const std::string& displayNodeID, unsigned long generation,
+                   vtkPolyData* polyData);
+  /// Drop the queued jobs and the results, wait for the thread to finish.
+  void StopLODThread();
+  /// Decimate the levels of the job, called by the thread
+  void MakeLODs(LODJob& job);
+  static VTK_THREAD_RETURN_TYPE LODThread(void* arg);
+
+  std::map<std::string, LODState> LODStates;
+  unsigned long                   LODGeneration;
+
+  vtkSmartPointer<vtkMultiThreader> LODThreader;
+  int                               LODThreadID;
+  /// Set by the thread when it leaves
+  bool                              LODThreadRunning;
+  volatile int                      AbortLOD;
+  /// Guards the jobs, the results and LODThreadRunning. The jobs are moved
+  /// between the lists by splicing so that the reference counts of their
+  /// polydata are only changed by one thread at a time.
+  vtkSimpleCriticalSection          LODLock;
+  std::list<LODJob>                 LODJobs;
+  std::list<LODJob>                 LODResults;
+
+  vtkSmartPointer<vtkCallbackCommand> RenderStartCallbackCommand;
+  vtkWeakPointer<vtkRenderer>         ObservedRenderer;
 };
 
 //---------------------------------------------------------------------------
@@ -128,6 +312,7 @@ vtkMRMLModelDisplayableManager::vtkInternal::vtkInternal()
 
   this->ModelHierarchiesPresent = false;
   this->UpdateHierachyRequested = false;
+  this->ClipShadersSupported = -1;
 
   // Instantiate and initialize Pickers
   this->WorldPointPicker = vtkSmartPointer<vtkWorldPointPicker>::New();
@@ -136,12 +321,19 @@ vtkMRMLModelDisplayableManager::vtkInternal::vtkInternal()
   this->CellPicker->SetTolerance(0.00001);
   this->PointPicker = vtkSmartPointer<vtkPointPicker>::New();
   this->ResetPick();
+
+  this->LODGeneration = 0;
+  this->LODThreader = vtkSmartPointer<vtkMultiThreader>::New();
+  this->LODThreadID = -1;
+  this->LODThreadRunning = false;
+  this->AbortLOD = 0;
+  this->RenderStartCallbackCommand = vtkSmartPointer<vtkCallbackCommand>::New();
 }
 
 //---------------------------------------------------------------------------
 vtkMRMLModelDisplayableManager::vtkInternal::~vtkInternal()
 {
-
+  this->StopLODThread();
 }
 
 //---------------------------------------------------------------------------
@@ -159,8 +351,42 @@ void vtkMRMLModelDisplayableManager::vtkInternal::CreateClipSlices()
   this->RedSliceClipState = vtkMRMLClipModelsNode::ClipOff;
   this->YellowSliceClipState = vtkMRMLClipModelsNode::ClipOff;
   this->GreenSliceClipState = vtkMRMLClipModelsNode::ClipOff;
+  this->ClipMethod = vtkMRMLClipModelsNode::ClipGeometry;
 
   this->ClippingOn = false;
+  this->ClipPlanesModified = false;
+}
+
+//---------------------------------------------------------------------------
+int vtkMRMLModelDisplayableManager::vtkInternal::GetClipState(int clipping) const
+{
+  if (!this->ClippingOn || !clipping)
+    {
+    return NotClipped;
+    }
+  // the geometry is clipped when the shaders turned out not to be supported
+  return (this->ClipMethod == vtkMRMLClipModelsNode::ClipFragments &&
+          this->ClipShadersSupported != 0) ? ClippedFragments : ClippedGeometry;
+}
+
+//---------------------------------------------------------------------------
+vtkShaderProgram2* vtkMRMLModelDisplayableManager::vtkInternal
+::NewClipProgram(vtkOpenGLRenderWindow* context)
+{
+  vtkShaderProgram2* program = vtkShaderProgram2::New();
+  program->SetContext(context);
+
+  const char* sources[2] = {ClipVertexShader, ClipFragmentShader};
+  const int types[2] = {VTK_SHADER_TYPE_VERTEX, VTK_SHADER_TYPE_FRAGMENT};
+  for (int i = 0; i < 2; ++i)
+    {
+    vtkNew<vtkShader2> shader;
+    shader->SetType(types[i]);
+    shader->SetSourceCode(sources[i]);
+    shader->SetContext(context);
+    program->GetShaders()->AddItem(shader.GetPointer());
+    }
+  return program;
 }
 
 //---------------------------------------------------------------------------
@@ -175,6 +401,152 @@ void vtkMRMLModelDisplayableManager::vtkInternal::ResetPick()
   this->PickedPointID = -1;
 }
 
+//---------------------------------------------------------------------------
+void vtkMRMLModelDisplayableManager::vtkInternal
+::RemovePickLocator(const std::string& displayNodeID)
+{
+  std::map<std::string, PickLocator>::iterator it =
+    this->PickLocators.find(displayNodeID);
+  if (it == this->PickLocators.end())
+    {
+    return;
+    }
+  this->CellPicker->RemoveLocator(it->second.Locator);
+  this->PickLocators.erase(it);
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLModelDisplayableManager::vtkInternal
+::QueueLODJob(const std::string& displayNodeID, unsigned long generation,
+              vtkPolyData* polyData)
+{
+  // the thread works on a copy, the model can change in the meantime
+  vtkPolyData* copy = vtkPolyData::New();
+  copy->DeepCopy(polyData);
+
+  this->LODLock.Lock();
+  std::list<LODJob>::iterator it = this->LODJobs.begin();
+  while (it != this->LODJobs.end())
+    {
+    if (it->DisplayNodeID == displayNodeID)
+      {
+      it = this->LODJobs.erase(it);
+      }
+    else
+      {
+      ++it;
+      }
+    }
+  this->LODJobs.push_back(LODJob());
+  this->LODJobs.back().DisplayNodeID = displayNodeID;
+  this->LODJobs.back().Generation = generation;
+  this->LODJobs.back().PolyData = copy;
+  copy->Delete();
+  bool start = !this->LODThreadRunning;
+  this->LODThreadRunning = true;
+  this->LODLock.Unlock();
+
+  if (start)
+    {
+    if (this->LODThreadID != -1)
+      {
+      // the thread has left, release it
+      this->LODThreader->TerminateThread(this->LODThreadID);
+      }
+    this->LODThreadID = this->LODThreader->SpawnThread(
+      vtkInternal::LODThread, this);
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLModelDisplayableManager::vtkInternal::StopLODThread()
+{
+  this->LODLock.Lock();
+  this->AbortLOD = 1;
+  this->LODJobs.clear();
+  this->LODLock.Unlock();
+  if (this->LODThreadID != -1)
+    {
+    this->LODThreader->TerminateThread(this->LODThreadID);
+    this->LODThreadID = -1;
+    }
+  this->LODResults.clear();
+  this->LODThreadRunning = false;
+  this->AbortLOD = 0;
+}
+
+//---------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkMRMLModelDisplayableManager::vtkInternal
+::LODThread(void* arg)
+{
+  vtkInternal* self = static_cast<vtkInternal*>(
+    static_cast<vtkMultiThreader::ThreadInfo*>(arg)->UserData);
+  while (true)
+    {
+    std::list<LODJob> job;
+    self->LODLock.Lock();
+    if (self->AbortLOD || self->LODJobs.empty())
+      {
+      self->LODThreadRunning = false;
+      self->LODLock.Unlock();
+      break;
+      }
+    job.splice(job.begin(), self->LODJobs, self->LODJobs.begin());
+    self->LODLock.Unlock();
+
+    self->MakeLODs(job.front());
+
+    self->LODLock.Lock();
+    if (!self->AbortLOD && job.front().Levels.size() == 3)
+      {
+      self->LODResults.splice(self->LODResults.end(), job);
+      }
+    job.clear();
+    self->LODLock.Unlock();
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLModelDisplayableManager::vtkInternal::MakeLODs(LODJob& job)
+{
+  vtkNew<vtkTriangleFilter> triangles;
+  triangles->SetInput(job.PolyData);
+  triangles->PassVertsOff();
+  triangles->PassLinesOff();
+  triangles->Update();
+  vtkSmartPointer<vtkPolyData> level = vtkSmartPointer<vtkPolyData>::New();
+  level->ShallowCopy(triangles->GetOutput());
+  bool hasNormals = job.PolyData->GetPointData()->GetNormals() != 0;
+
+  // 50%, 10% and 2% of the triangles, each level decimated from the
+  // previous one
+  const double reductions[3] = {0.5, 0.8, 0.8};
+  for (int i = 0; i < 3 && !this->AbortLOD; ++i)
+    {
+    vtkNew<vtkDecimatePro> decimate;
+    decimate->SetInput(level);
+    decimate->SetTargetReduction(reductions[i]);
+    decimate->PreserveTopologyOff();
+    decimate->Update();
+    level = vtkSmartPointer<vtkPolyData>::New();
+    level->ShallowCopy(decimate->GetOutput());
+
+    vtkSmartPointer<vtkPolyData> renderedLevel = level;
+    if (hasNormals)
+      {
+      // the normals of the kept points don't fit the bigger triangles
+      vtkNew<vtkPolyDataNormals> normals;
+      normals->SetInput(level);
+      normals->SplittingOff();
+      normals->Update();
+      renderedLevel = vtkSmartPointer<vtkPolyData>::New();
+      renderedLevel->ShallowCopy(normals->GetOutput());
+      }
+    job.Levels.push_back(renderedLevel);
+    }
+}
+
 
 //---------------------------------------------------------------------------
 // vtkMRMLModelDisplayableManager methods
@@ -185,6 +557,11 @@ vtkMRMLModelDisplayableManager::vtkMRMLModelDisplayableManager()
   this->Internal = new vtkInternal();
 
   this->Internal->CreateClipSlices();
+
+  this->LODCellThreshold = 100000;
+  this->Internal->RenderStartCallbackCommand->SetClientData(this);
+  this->Internal->RenderStartCallbackCommand->SetCallback(
+    vtkMRMLModelDisplayableManager::RenderStartCallback);
 }
 
 //---------------------------------------------------------------------------
@@ -198,6 +575,11 @@ vtkMRMLModelDisplayableManager::~vtkMRMLModelDisplayableManager()
   // release the DisplayedModelActors
   this->Internal->DisplayedActors.clear();
 
+  if (this->Internal->ObservedRenderer)
+    {
+    this->Internal->ObservedRenderer->RemoveObserver(
+      this->Internal->RenderStartCallbackCommand);
+    }
   delete this->Internal;
 }
 
@@ -212,6 +594,7 @@ void vtkMRMLModelDisplayableManager::PrintSelf ( ostream& os, vtkIndent indent )
   os << indent << "RedSliceClipState = " << this->Internal->RedSliceClipState << "\n";
   os << indent << "YellowSliceClipState = " << this->Internal->YellowSliceClipState << "\n";
   os << indent << "GreenSliceClipState = " << this->Internal->GreenSliceClipState << "\n";
+  os << indent << "ClipMethod = " << this->Internal->ClipMethod << "\n";
   os << indent << "ClippingOn = " << (this->Internal->ClippingOn ? "true" : "false") << "\n";
 
   os << indent << "ModelHierarchiesPresent = " << this->Internal->ModelHierarchiesPresent << "\n";
@@ -221,11 +604,27 @@ void vtkMRMLModelDisplayableManager::PrintSelf ( ostream& os, vtkIndent indent )
       << this->Internal->PickedRAS[1] << ", "<< this->Internal->PickedRAS[2] << ")\n";
   os << indent << "PickedCellID = " << this->Internal->PickedCellID << "\n";
   os << indent << "PickedPointID = " << this->Internal->PickedPointID << "\n";
+
+  os << indent << "LODCellThreshold = " << this->LODCellThreshold << "\n";
 }
 
 //---------------------------------------------------------------------------
 void vtkMRMLModelDisplayableManager::AdditionalInitializeStep()
 {
+  // the levels of detail decimated in the background are picked up before
+  // each render
+  if (this->Internal->ObservedRenderer)
+    {
+    this->Internal->ObservedRenderer->RemoveObserver(
+      this->Internal->RenderStartCallbackCommand);
+    }
+  this->Internal->ObservedRenderer = this->GetRenderer();
+  if (this->Internal->ObservedRenderer)
+    {
+    this->Internal->ObservedRenderer->AddObserver(vtkCommand::StartEvent,
+      this->Internal->RenderStartCallbackCommand);
+    }
+
   vtkRenderWindowInteractor * interactor = this->GetInteractor();
   if (interactor)
     {
@@ -347,6 +746,12 @@ int vtkMRMLModelDisplayableManager::UpdateClipSlicesFromMRML()
       }
     }
 
+  if (this->Internal->ClipModelsNode->GetClipMethod() != this->Internal->ClipMethod)
+    {
+    modifiedState = 1;
+    this->Internal->ClipMethod = this->Internal->ClipModelsNode->GetClipMethod();
+    }
+
   if (this->Internal->ClipModelsNode->GetRedSliceClipState() != this->Internal->RedSliceClipState)
     {
     if (this->Internal->RedSliceClipState == vtkMRMLClipModelsNode::ClipOff)
@@ -402,22 +807,56 @@ int vtkMRMLModelDisplayableManager::UpdateClipSlicesFromMRML()
     }
 
   // set slice plane normals and origins
-  vtkMatrix4x4 *sliceMatrix = 0;
-  int planeDirection = 1;
+  this->Internal->ClipPlanesModified = this->SetClipPlanesFromSlices(
+    0, this->Internal->RedSlicePlane, this->Internal->GreenSlicePlane,
+    this->Internal->YellowSlicePlane);
 
-  sliceMatrix = this->Internal->RedSliceNode->GetSliceToRAS();
-  planeDirection = (this->Internal->RedSliceClipState == vtkMRMLClipModelsNode::ClipNegativeSpace) ? -1 : 1;
-  this->SetClipPlaneFromMatrix(sliceMatrix, planeDirection, this->Internal->RedSlicePlane);
-
-  sliceMatrix = this->Internal->GreenSliceNode->GetSliceToRAS();
-  planeDirection = (this->Internal->GreenSliceClipState == vtkMRMLClipModelsNode::ClipNegativeSpace) ? -1 : 1;
-  this->SetClipPlaneFromMatrix(sliceMatrix, planeDirection, this->Internal->GreenSlicePlane);
+  return modifiedState;
+}
 
-  sliceMatrix = this->Internal->YellowSliceNode->GetSliceToRAS();
-  planeDirection = (this->Internal->YellowSliceClipState == vtkMRMLClipModelsNode::ClipNegativeSpace) ? -1 : 1;
-  this->SetClipPlaneFromMatrix(sliceMatrix, planeDirection, this->Internal->YellowSlicePlane);
+//---------------------------------------------------------------------------
+bool vtkMRMLModelDisplayableManager::SetClipPlanesFromSlices(vtkMatrix4x4* worldToModel,
+                                                             vtkPlane* redSlicePlane,
+                                                             vtkPlane* greenSlicePlane,
+                                                             vtkPlane* yellowSlicePlane)
+{
+  vtkMRMLSliceNode* sliceNodes[3] = {this->Internal->RedSliceNode,
+                                     this->Internal->GreenSliceNode,
+                                     this->Internal->YellowSliceNode};
+  int clipStates[3] = {this->Internal->RedSliceClipState,
+                       this->Internal->GreenSliceClipState,
+                       this->Internal->YellowSliceClipState};
+  vtkPlane* planes[3] = {redSlicePlane, greenSlicePlane, yellowSlicePlane};
 
-  return modifiedState;
+  bool modified = false;
+  vtkNew<vtkMatrix4x4> sliceMatrix;
+  for (int i = 0; i < 3; ++i)
+    {
+    if (!sliceNodes[i])
+      {
+      continue;
+      }
+    if (worldToModel)
+      {
+      vtkMatrix4x4::Multiply4x4(worldToModel, sliceNodes[i]->GetSliceToRAS(),
+                                sliceMatrix.GetPointer());
+      }
+    else
+      {
+      sliceMatrix->DeepCopy(sliceNodes[i]->GetSliceToRAS());
+      }
+    int planeDirection =
+      (clipStates[i] == vtkMRMLClipModelsNode::ClipNegativeSpace) ? -1 : 1;
+    // vtkPlane doesn't modify itself when set to the same values
+    unsigned long mtime = planes[i]->GetMTime();
+    this->SetClipPlaneFromMatrix(sliceMatrix.GetPointer(), planeDirection, planes[i]);
+    if (clipStates[i] != vtkMRMLClipModelsNode::ClipOff &&
+        planes[i]->GetMTime() != mtime)
+      {
+      modified = true;
+      }
+    }
+  return modified;
 }
 
 //---------------------------------------------------------------------------
@@ -499,10 +938,16 @@ void vtkMRMLModelDisplayableManager::ProcessMRMLNodesEvents(vtkObject *caller,
     bool requestRender = true;
     if (event == vtkCommand::ModifiedEvent)
       {
-      if (this->UpdateClipSlicesFromMRML() || this->Internal->ClippingOn)
+      if (this->UpdateClipSlicesFromMRML())
         {
         this->SetUpdateFromMRMLRequested(1);
         }
+      else if (this->Internal->ClippingOn && this->Internal->ClipPlanesModified)
+        {
+        // the clippers are kept, only their planes move. The clip shaders
+        // get their planes at the beginning of the render.
+        this->UpdateTransformedClippers();
+        }
       else
         {
         requestRender = vtkMRMLSliceNode::SafeDownCast(caller)->GetSliceVisible() == 1;
@@ -538,6 +983,7 @@ void vtkMRMLModelDisplayableManager::OnMRMLSceneStartClose()
 {
   this->RemoveHierarchyObservers(0);
   this->RemoveModelObservers(0);
+  this->Internal->StopLODThread();
 }
 
 //---------------------------------------------------------------------------
@@ -753,18 +1199,17 @@ void vtkMRMLModelDisplayableManager::UpdateFromMRML()
 void vtkMRMLModelDisplayableManager::UpdateModelsFromMRML()
 {
   vtkMRMLScene *scene = this->GetMRMLScene();
-  vtkMRMLNode *node = 0;
   std::vector<vtkMRMLDisplayableNode *> slices;
 
   // find volume slices
   bool clearDisplayedModels = scene ? false : true;
 
-  std::vector<vtkMRMLNode *> dnodes;
-  int nnodes = scene ? scene->GetNodesByClass("vtkMRMLDisplayableNode", dnodes) : 0;
+  std::vector<vtkMRMLDisplayableNode *> dnodes;
+  int nnodes = scene ? vtkMRMLDisplayableNodeRegistry::GetSceneRegistry(scene)
+    ->GetDisplayableNodes(dnodes) : 0;
   for (int n=0; n<nnodes; n++)
     {
-    node = dnodes[n];
-    vtkMRMLDisplayableNode *model = vtkMRMLDisplayableNode::SafeDownCast(node);
+    vtkMRMLDisplayableNode *model = dnodes[n];
     // render slices last so that transparent objects are rendered in front of them
     if (!strcmp(model->GetName(), "Red Volume Slice") ||
         !strcmp(model->GetName(), "Green Volume Slice") ||
@@ -791,6 +1236,8 @@ void vtkMRMLModelDisplayableManager::UpdateModelsFromMRML()
     this->Internal->DisplayedActors.clear();
     this->Internal->DisplayedNodes.clear();
     this->Internal->DisplayedClipState.clear();
+    this->Internal->TransformedClippers.clear();
+    this->Internal->ClipPrograms.clear();
     this->Internal->DisplayedVisibility.clear();
     this->UpdateModelHierarchies();
     }
@@ -812,7 +1259,7 @@ void vtkMRMLModelDisplayableManager::UpdateModelsFromMRML()
   //int nmodels = scene->GetNumberOfNodesByClass("vtkMRMLDisplayableNode");
   for (int n=0; n<nnodes; n++)
     {
-    vtkMRMLDisplayableNode *model = vtkMRMLDisplayableNode::SafeDownCast(dnodes[n]);
+    vtkMRMLDisplayableNode *model = dnodes[n];
     // render slices last so that transparent objects are rendered in fron of them
     if (model)
       {
@@ -902,6 +1349,12 @@ void vtkMRMLModelDisplayableManager
           }
 #endif
         }
+      if (!prop && this->LODCellThreshold > 0 &&
+          polyData->GetNumberOfCells() >= this->LODCellThreshold)
+        {
+        // decimated while interacting
+        prop = vtkLODActor::New();
+        }
       if (!prop)
         {
         prop = vtkActor::New();
@@ -910,26 +1363,49 @@ void vtkMRMLModelDisplayableManager
     else
       {
       prop = (*ait).second;
+      vtkActor *actor = vtkActor::SafeDownCast(prop);
+      int clipState = (actor && modelDisplayNode) ?
+        this->Internal->GetClipState(clipping) : vtkInternal::NotClipped;
       std::map<std::string, int>::iterator cit = this->Internal->DisplayedClipState.find(modelDisplayNode->GetID());
-      if (modelDisplayNode && cit != this->Internal->DisplayedClipState.end() && cit->second == clipping )
+      if (modelDisplayNode && cit != this->Internal->DisplayedClipState.end() && cit->second == clipState )
         {
         this->Internal->DisplayedVisibility[modelDisplayNode->GetID()] = visibility;
         // make sure that we are looking at the current polydata (most of the code in here
         // assumes a display node will never change what polydata it wants to view and hence
         // caches information to skip steps if the display node has already rendered. but we
         // can have rendered a display node but not rendered its current polydata.
-        vtkActor *actor = vtkActor::SafeDownCast(prop);
+        bool upToDate = true;
         if (actor)
           {
           vtkPolyDataMapper *mapper = vtkPolyDataMapper::SafeDownCast(actor->GetMapper());
-          if (mapper && mapper->GetInput() != polyData && !(this->Internal->ClippingOn && clipping))
+          if (clipState == vtkInternal::ClippedGeometry)
+            {
+            // the clipper is kept, the clipped model could be transformed
+            vtkClipPolyData* clipper = (mapper && mapper->GetNumberOfInputConnections(0)) ?
+              vtkClipPolyData::SafeDownCast(mapper->GetInputConnection(0, 0)->GetProducer()) : 0;
+            if (clipper)
+              {
+              vtkImplicitFunction* clipFunction =
+                this->UpdateTransformedClipPlanes(displayableNode, modelDisplayNode->GetID());
+              clipper->SetClipFunction(clipFunction ?
+                clipFunction : this->Internal->SlicePlanes.GetPointer());
+              if (clipper->GetInput() != polyData)
+                {
+                clipper->SetInput(polyData);
+                }
+              }
+            upToDate = (clipper != 0);
+            }
+          else if (mapper && mapper->GetInput() != polyData)
             {
             mapper->SetInput(polyData);
             }
+          if (upToDate)
+            {
+            this->UpdateModelLOD(displayNode, actor, polyData);
+            }
           }
-        vtkMRMLTransformNode* tnode = displayableNode->GetParentTransformNode();
-        // clipped model could be transformed
-        if (clipping == 0 || tnode == 0 || !tnode->IsLinear())
+        if (upToDate)
           {
           continue;
           }
@@ -938,11 +1414,13 @@ void vtkMRMLModelDisplayableManager
 
     vtkClipPolyData *clipper = 0;
     vtkActor * actor = vtkActor::SafeDownCast(prop);
+    int clipState = (actor && modelDisplayNode) ?
+      this->Internal->GetClipState(clipping) : vtkInternal::NotClipped;
     if(actor)
       {
-      if (this->Internal->ClippingOn && modelDisplayNode != 0 && clipping)
+      if (clipState == vtkInternal::ClippedGeometry)
         {
-        clipper = this->CreateTransformedClipper(displayableNode);
+        clipper = this->CreateTransformedClipper(displayableNode, modelDisplayNode->GetID());
         }
 
       vtkPolyDataMapper *mapper = vtkPolyDataMapper::New();
@@ -960,6 +1438,7 @@ void vtkMRMLModelDisplayableManager
 
       actor->SetMapper(mapper);
       mapper->Delete();
+      this->UpdateModelLOD(displayNode, actor, polyData);
       }
 
     if (hasPolyData && ait == this->Internal->DisplayedActors.end())
@@ -977,15 +1456,11 @@ void vtkMRMLModelDisplayableManager
         this->Internal->DisplayedVisibility[modelDisplayNode->GetID()] = 1;
         }
 
+      this->Internal->DisplayedClipState[modelDisplayNode->GetID()] = clipState;
       if (clipper)
         {
-        this->Internal->DisplayedClipState[modelDisplayNode->GetID()] = 1;
         clipper->Delete();
         }
-      else
-        {
-        this->Internal->DisplayedClipState[modelDisplayNode->GetID()] = 0;
-        }
       prop->Delete();
       }
     else if (!hasPolyData)
@@ -994,19 +1469,130 @@ void vtkMRMLModelDisplayableManager
       }
     else
       {
+      this->Internal->DisplayedClipState[modelDisplayNode->GetID()] = clipState;
       if (clipper)
         {
-        this->Internal->DisplayedClipState[modelDisplayNode->GetID()] = 1;
         clipper->Delete();
         }
-      else
-        {
-        this->Internal->DisplayedClipState[modelDisplayNode->GetID()] = 0;
-        }
       }
     }
 }
 
+//---------------------------------------------------------------------------
+void vtkMRMLModelDisplayableManager::UpdateModelLOD(vtkMRMLDisplayNode* displayNode,
+                                                    vtkActor* actor,
+                                                    vtkPolyData* polyData)
+{
+  vtkLODActor* lodActor = vtkLODActor::SafeDownCast(actor);
+  if (!lodActor || !displayNode || !displayNode->GetID())
+    {
+    return;
+    }
+  vtkPolyDataMapper* mapper = vtkPolyDataMapper::SafeDownCast(actor->GetMapper());
+  std::map<std::string, vtkInternal::LODState>::iterator it =
+    this->Internal->LODStates.find(displayNode->GetID());
+  if (it != this->Internal->LODStates.end() &&
+      it->second.Mapper == mapper &&
+      it->second.PolyData == polyData &&
+      it->second.PolyDataMTime == polyData->GetMTime())
+    {
+    return;
+    }
+  vtkInternal::LODState& state = this->Internal->LODStates[displayNode->GetID()];
+  state.Mapper = mapper;
+  state.PolyData = polyData;
+  state.PolyDataMTime = polyData->GetMTime();
+  // the results of the previous polydata are discarded
+  state.Generation = ++this->Internal->LODGeneration;
+
+  // The mapper is its own level until the decimated ones are ready, it keeps
+  // vtkLODActor from making its default point cloud levels.
+  lodActor->GetLODMappers()->RemoveAllItems();
+  lodActor->AddLODMapper(mapper);
+
+  // clipped models and polydata that vtkDecimatePro can't reduce (lines,
+  // vertices) are always drawn at full resolution
+  if (!mapper || mapper->GetInput() != polyData ||
+      this->LODCellThreshold <= 0 ||
+      polyData->GetNumberOfCells() < this->LODCellThreshold ||
+      polyData->GetNumberOfLines() > 0 || polyData->GetNumberOfVerts() > 0)
+    {
+    return;
+    }
+  this->Internal->QueueLODJob(displayNode->GetID(), state.Generation, polyData);
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLModelDisplayableManager::UpdateLODsFromThread()
+{
+  std::list<vtkInternal::LODJob> results;
+  this->Internal->LODLock.Lock();
+  results.swap(this->Internal->LODResults);
+  this->Internal->LODLock.Unlock();
+
+  std::list<vtkInternal::LODJob>::iterator it;
+  for (it = results.begin(); it != results.end(); ++it)
+    {
+    std::map<std::string, vtkInternal::LODState>::iterator stateIt =
+      this->Internal->LODStates.find(it->DisplayNodeID);
+    vtkLODActor* actor = vtkLODActor::SafeDownCast(
+      this->GetActorByID(it->DisplayNodeID.c_str()));
+    if (stateIt == this->Internal->LODStates.end() ||
+        stateIt->second.Generation != it->Generation ||
+        !actor || !actor->GetMapper())
+      {
+      // the model has changed since
+      continue;
+      }
+    actor->GetLODMappers()->RemoveAllItems();
+    for (size_t i = 0; i < it->Levels.size(); ++i)
+      {
+      vtkPolyDataMapper* mapper = vtkPolyDataMapper::New();
+      mapper->ShallowCopy(actor->GetMapper());
+      mapper->SetInput(it->Levels[i]);
+      actor->AddLODMapper(mapper);
+      mapper->Delete();
+      }
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLModelDisplayableManager::UpdateLODMappers(vtkActor* actor)
+{
+  vtkLODActor* lodActor = vtkLODActor::SafeDownCast(actor);
+  if (!lodActor || !lodActor->GetMapper())
+    {
+    return;
+    }
+  vtkMapperCollection* lodMappers = lodActor->GetLODMappers();
+  lodMappers->InitTraversal();
+  for (vtkMapper* lodMapper = lodMappers->GetNextItem(); lodMapper;
+       lodMapper = lodMappers->GetNextItem())
+    {
+    vtkPolyDataMapper* levelMapper = vtkPolyDataMapper::SafeDownCast(lodMapper);
+    if (!levelMapper || lodMapper == lodActor->GetMapper())
+      {
+      continue;
+      }
+    // ShallowCopy() also copies the input, keep the level alive
+    vtkSmartPointer<vtkPolyData> level = levelMapper->GetInput();
+    levelMapper->ShallowCopy(lodActor->GetMapper());
+    levelMapper->SetInput(level);
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLModelDisplayableManager::RenderStartCallback(vtkObject* vtkNotUsed(caller),
+                                                         unsigned long vtkNotUsed(event),
+                                                         void* clientData,
+                                                         void* vtkNotUsed(callData))
+{
+  vtkMRMLModelDisplayableManager* self =
+    reinterpret_cast<vtkMRMLModelDisplayableManager*>(clientData);
+  self->UpdateLODsFromThread();
+  self->UpdateClipShaders();
+}
+
 //---------------------------------------------------------------------------
 void vtkMRMLModelDisplayableManager::UpdateModel(vtkMRMLDisplayableNode *model)
 {
@@ -1166,7 +1752,12 @@ void vtkMRMLModelDisplayableManager::UpdateModelHierarchyDisplay(vtkMRMLDisplaya
 vtkMRMLDisplayNode*  vtkMRMLModelDisplayableManager::GetHierarchyDisplayNode(vtkMRMLDisplayableNode *model)
 {
   vtkMRMLDisplayNode* dnode = 0;
-  if (this->Internal->ModelHierarchiesPresent)
+  if (this->Internal->ModelHierarchiesPresent && this->GetModelHierarchyLogic())
+    {
+    // cached by the logic, the hierarchy is not walked for each model
+    dnode = this->GetModelHierarchyLogic()->GetHierarchyDisplayNode(model->GetID());
+    }
+  else if (this->Internal->ModelHierarchiesPresent)
     {
     vtkMRMLModelHierarchyNode* mhnode = 0;
     vtkMRMLModelHierarchyNode* phnode = 0;
@@ -1214,8 +1805,9 @@ void vtkMRMLModelDisplayableManager::RemoveModelProps()
         }
       else
         {
-        if ((clipIter->second && !this->Internal->ClippingOn) ||
-            (this->Internal->ClippingOn && clipIter->second != clipModel))
+        int clipState = vtkActor::SafeDownCast(iter->second) ?
+          this->Internal->GetClipState(clipModel) : vtkInternal::NotClipped;
+        if (clipIter->second != clipState)
           {
           this->GetRenderer()->RemoveViewProp(iter->second);
           removedIDs.push_back(iter->first);
@@ -1264,7 +1856,11 @@ void vtkMRMLModelDisplayableManager::RemoveDispalyedID(std::string &id)
   std::map<std::string, vtkMRMLDisplayNode *>::iterator modelIter;
   this->Internal->DisplayedActors.erase(id);
   this->Internal->DisplayedClipState.erase(id);
+  this->Internal->TransformedClippers.erase(id);
+  this->Internal->ClipPrograms.erase(id);
   this->Internal->DisplayedVisibility.erase(id);
+  this->Internal->LODStates.erase(id);
+  this->Internal->RemovePickLocator(id);
   modelIter = this->Internal->DisplayedNodes.find(id);
   if(modelIter != this->Internal->DisplayedNodes.end())
     {
@@ -1314,6 +1910,8 @@ void vtkMRMLModelDisplayableManager::RemoveModelObservers(int clearCache)
     this->Internal->DisplayedActors.clear();
     this->Internal->DisplayedNodes.clear();
     this->Internal->DisplayedClipState.clear();
+    this->Internal->TransformedClippers.clear();
+    this->Internal->ClipPrograms.clear();
     this->Internal->DisplayedVisibility.clear();
     }
 }
@@ -1505,6 +2103,7 @@ void vtkMRMLModelDisplayableManager::SetModelDisplayProperty(vtkMRMLDisplayableN
           {
           actor->SetTexture(0);
           }
+        this->UpdateLODMappers(actor);
         }
       else if (imageActor)
         {
@@ -1679,6 +2278,47 @@ double vtkMRMLModelDisplayableManager::GetPickTolerance()
   return this->Internal->CellPicker->GetTolerance();
 }
 
+//---------------------------------------------------------------------------
+void vtkMRMLModelDisplayableManager::UpdatePickLocators()
+{
+  // vtkCellPicker only intersects the cells of the props whose bounds are
+  // crossed by the pick ray, the locators make the cell intersection
+  // logarithmic
+  std::map<std::string, vtkProp3D *>::iterator it;
+  for (it = this->Internal->DisplayedActors.begin();
+       it != this->Internal->DisplayedActors.end(); ++it)
+    {
+    vtkActor* actor = vtkActor::SafeDownCast(it->second);
+    vtkPolyDataMapper* mapper = actor ?
+      vtkPolyDataMapper::SafeDownCast(actor->GetMapper()) : 0;
+    vtkPolyData* polyData = mapper ? mapper->GetInput() : 0;
+    if (!polyData || polyData->GetNumberOfCells() == 0)
+      {
+      this->Internal->RemovePickLocator(it->first);
+      continue;
+      }
+    std::map<std::string, vtkInternal::PickLocator>::iterator locatorIt =
+      this->Internal->PickLocators.find(it->first);
+    if (locatorIt != this->Internal->PickLocators.end() &&
+        locatorIt->second.Locator->GetDataSet() == polyData &&
+        locatorIt->second.PolyDataMTime == polyData->GetMTime())
+      {
+      continue;
+      }
+    if (locatorIt == this->Internal->PickLocators.end())
+      {
+      vtkInternal::PickLocator& pickLocator = this->Internal->PickLocators[it->first];
+      pickLocator.Locator = vtkSmartPointer<vtkCellLocator>::New();
+      this->Internal->CellPicker->AddLocator(pickLocator.Locator);
+      locatorIt = this->Internal->PickLocators.find(it->first);
+      }
+    // the polydata was replaced or modified since the last build
+    locatorIt->second.Locator->SetDataSet(polyData);
+    locatorIt->second.Locator->BuildLocator();
+    locatorIt->second.PolyDataMTime = polyData->GetMTime();
+    }
+}
+
 //---------------------------------------------------------------------------
 int vtkMRMLModelDisplayableManager::Pick(int x, int y)
 {
@@ -1702,6 +2342,8 @@ int vtkMRMLModelDisplayableManager::Pick(int x, int y)
   int *renSize = ren->GetSize();
   // resize the interactor?
 
+  this->UpdatePickLocators();
+
   // pass the event's display point to the world point picker
   double displayPoint[3];
   displayPoint[0] = x;
@@ -1878,88 +2520,254 @@ vtkMRMLModelHierarchyLogic* vtkMRMLModelDisplayableManager::GetModelHierarchyLog
 
 //---------------------------------------------------------------------------
 vtkClipPolyData* vtkMRMLModelDisplayableManager::CreateTransformedClipper(
-    vtkMRMLDisplayableNode *model)
+    vtkMRMLDisplayableNode *model, const char* displayNodeID)
 {
   vtkClipPolyData *clipper = vtkClipPolyData::New();
   clipper->SetValue( 0.0);
 
-  vtkMRMLTransformNode* tnode = model->GetParentTransformNode();
-  vtkSmartPointer<vtkMatrix4x4> transformToWorld = vtkSmartPointer<vtkMatrix4x4>::New();
-  transformToWorld->Identity();
-  if (tnode != 0 && tnode->IsLinear())
+  vtkImplicitBoolean* slicePlanes =
+    this->UpdateTransformedClipPlanes(model, displayNodeID);
+  clipper->SetClipFunction(slicePlanes ?
+    slicePlanes : this->Internal->SlicePlanes.GetPointer());
+  return clipper;
+}
+
+//---------------------------------------------------------------------------
+vtkImplicitBoolean* vtkMRMLModelDisplayableManager::UpdateTransformedClipPlanes(
+    vtkMRMLDisplayableNode *model, const char* displayNodeID)
+{
+  if (!displayNodeID)
     {
-    vtkMRMLLinearTransformNode *lnode = vtkMRMLLinearTransformNode::SafeDownCast(tnode);
-    lnode->GetMatrixTransformToWorld(transformToWorld);
+    return 0;
+    }
+  vtkMRMLTransformNode* tnode = model ? model->GetParentTransformNode() : 0;
+  vtkMRMLLinearTransformNode *lnode = (tnode != 0 && tnode->IsLinear()) ?
+    vtkMRMLLinearTransformNode::SafeDownCast(tnode) : 0;
+  if (!lnode)
+    {
+    this->Internal->TransformedClippers.erase(displayNodeID);
+    return 0;
+    }
 
-    vtkImplicitBoolean *slicePlanes =   vtkImplicitBoolean::New();
+  vtkInternal::TransformedClipPlanes& clipPlanes =
+    this->Internal->TransformedClippers[displayNodeID];
+  int clipStates[4] = {this->Internal->ClipType,
+                       this->Internal->RedSliceClipState,
+                       this->Internal->GreenSliceClipState,
+                       this->Internal->YellowSliceClipState};
+  if (!clipPlanes.SlicePlanes ||
+      !std::equal(clipStates, clipStates + 4, clipPlanes.ClipStates))
+    {
+    clipPlanes.DisplayableNodeID = model->GetID();
+    std::copy(clipStates, clipStates + 4, clipPlanes.ClipStates);
+    clipPlanes.SlicePlanes = vtkSmartPointer<vtkImplicitBoolean>::New();
     if (this->Internal->ClipType == vtkMRMLClipModelsNode::ClipIntersection)
       {
-      slicePlanes->SetOperationTypeToIntersection();
+      clipPlanes.SlicePlanes->SetOperationTypeToIntersection();
       }
     else if (this->Internal->ClipType == vtkMRMLClipModelsNode::ClipUnion)
       {
-      slicePlanes->SetOperationTypeToUnion();
+      clipPlanes.SlicePlanes->SetOperationTypeToUnion();
       }
-
-    vtkPlane *redSlicePlane = vtkPlane::New();
-    vtkPlane *greenSlicePlane = vtkPlane::New();
-    vtkPlane *yellowSlicePlane = vtkPlane::New();
-
-
+    clipPlanes.RedSlicePlane = vtkSmartPointer<vtkPlane>::New();
+    clipPlanes.GreenSlicePlane = vtkSmartPointer<vtkPlane>::New();
+    clipPlanes.YellowSlicePlane = vtkSmartPointer<vtkPlane>::New();
     if (this->Internal->RedSliceClipState != vtkMRMLClipModelsNode::ClipOff)
       {
-      slicePlanes->AddFunction(redSlicePlane);
+      clipPlanes.SlicePlanes->AddFunction(clipPlanes.RedSlicePlane);
       }
-
     if (this->Internal->GreenSliceClipState != vtkMRMLClipModelsNode::ClipOff)
       {
-      slicePlanes->AddFunction(greenSlicePlane);
+      clipPlanes.SlicePlanes->AddFunction(clipPlanes.GreenSlicePlane);
       }
-
     if (this->Internal->YellowSliceClipState != vtkMRMLClipModelsNode::ClipOff)
       {
-      slicePlanes->AddFunction(yellowSlicePlane);
+      clipPlanes.SlicePlanes->AddFunction(clipPlanes.YellowSlicePlane);
       }
+    }
 
-    vtkMatrix4x4 *sliceMatrix = 0;
-    vtkSmartPointer<vtkMatrix4x4> mat = vtkSmartPointer<vtkMatrix4x4>::New();
-    int planeDirection = 1;
-    transformToWorld->Invert();
-
-    sliceMatrix = this->Internal->RedSliceNode->GetSliceToRAS();
-    mat->Identity();
-    vtkMatrix4x4::Multiply4x4(transformToWorld, sliceMatrix, mat);
-    planeDirection = (this->Internal->RedSliceClipState == vtkMRMLClipModelsNode::ClipNegativeSpace) ? -1 : 1;
-    this->SetClipPlaneFromMatrix(mat, planeDirection, redSlicePlane);
-
-    sliceMatrix = this->Internal->GreenSliceNode->GetSliceToRAS();
-    mat->Identity();
-    vtkMatrix4x4::Multiply4x4(transformToWorld, sliceMatrix, mat);
-    planeDirection = (this->Internal->GreenSliceClipState == vtkMRMLClipModelsNode::ClipNegativeSpace) ? -1 : 1;
-    this->SetClipPlaneFromMatrix(mat, planeDirection, greenSlicePlane);
+  vtkNew<vtkMatrix4x4> worldToModel;
+  lnode->GetMatrixTransformToWorld(worldToModel.GetPointer());
+  worldToModel->Invert();
+  this->SetClipPlanesFromSlices(worldToModel.GetPointer(),
+                                clipPlanes.RedSlicePlane,
+                                clipPlanes.GreenSlicePlane,
+                                clipPlanes.YellowSlicePlane);
+  return clipPlanes.SlicePlanes;
+}
 
-    sliceMatrix = this->Internal->YellowSliceNode->GetSliceToRAS();
-    mat->Identity();
-    vtkMatrix4x4::Multiply4x4(transformToWorld, sliceMatrix, mat);
-    planeDirection = (this->Internal->YellowSliceClipState == vtkMRMLClipModelsNode::ClipNegativeSpace) ? -1 : 1;
-    this->SetClipPlaneFromMatrix(mat, planeDirection, yellowSlicePlane);
+//---------------------------------------------------------------------------
+void vtkMRMLModelDisplayableManager::UpdateTransformedClippers()
+{
+  // the clippers of the models that are not transformed share the planes
+  // of Internal->SlicePlanes, already moved
+  std::map<std::string, vtkInternal::TransformedClipPlanes>::iterator it;
+  for (it = this->Internal->TransformedClippers.begin();
+       it != this->Internal->TransformedClippers.end(); ++it)
+    {
+    std::map<std::string, vtkMRMLDisplayableNode *>::iterator nodeIt =
+      this->Internal->DisplayableNodes.find(it->second.DisplayableNodeID);
+    vtkMRMLLinearTransformNode *lnode = nodeIt != this->Internal->DisplayableNodes.end() ?
+      vtkMRMLLinearTransformNode::SafeDownCast(nodeIt->second->GetParentTransformNode()) : 0;
+    if (!lnode)
+      {
+      // a transform change updates the clippers from MRML
+      continue;
+      }
+    vtkNew<vtkMatrix4x4> worldToModel;
+    lnode->GetMatrixTransformToWorld(worldToModel.GetPointer());
+    worldToModel->Invert();
+    this->SetClipPlanesFromSlices(worldToModel.GetPointer(),
+                                  it->second.RedSlicePlane,
+                                  it->second.GreenSlicePlane,
+                                  it->second.YellowSlicePlane);
+    }
+}
 
-    clipper->SetClipFunction(slicePlanes);
+//---------------------------------------------------------------------------
+void vtkMRMLModelDisplayableManager::UpdateClipShaders()
+{
+  // restore the actors that are not clipped by shader anymore
+  std::map<std::string, vtkSmartPointer<vtkShaderProgram2> >::iterator programIt =
+    this->Internal->ClipPrograms.begin();
+  while (programIt != this->Internal->ClipPrograms.end())
+    {
+    std::map<std::string, int>::iterator clipIt =
+      this->Internal->DisplayedClipState.find(programIt->first);
+    if (clipIt != this->Internal->DisplayedClipState.end() &&
+        clipIt->second == vtkInternal::ClippedFragments)
+      {
+      ++programIt;
+      continue;
+      }
+    vtkActor* actor = vtkActor::SafeDownCast(this->GetActorByID(programIt->first.c_str()));
+    vtkOpenGLProperty* property = actor ?
+      vtkOpenGLProperty::SafeDownCast(actor->GetProperty()) : 0;
+    if (property && property->GetPropProgram() == programIt->second)
+      {
+      property->SetPropProgram(0);
+      }
+    this->Internal->ClipPrograms.erase(programIt++);
+    }
 
-    slicePlanes->Delete();
-    redSlicePlane->Delete();
-    greenSlicePlane->Delete();
-    yellowSlicePlane->Delete();
+  vtkOpenGLRenderWindow* context = vtkOpenGLRenderWindow::SafeDownCast(
+    this->GetRenderer() ? this->GetRenderer()->GetRenderWindow() : 0);
+  if (!context || !this->Internal->ClippingOn ||
+      this->Internal->ClipMethod != vtkMRMLClipModelsNode::ClipFragments ||
+      this->Internal->ClipShadersSupported == 0)
+    {
+    return;
+    }
 
+  // planes (normal, -normal.origin) of the active slices, in world coordinates
+  vtkPlane* slicePlanes[3] = {this->Internal->RedSlicePlane,
+                              this->Internal->GreenSlicePlane,
+                              this->Internal->YellowSlicePlane};
+  int clipStates[3] = {this->Internal->RedSliceClipState,
+                       this->Internal->GreenSliceClipState,
+                       this->Internal->YellowSliceClipState};
+  double worldPlanes[3][4];
+  int numberOfPlanes = 0;
+  for (int i = 0; i < 3; ++i)
+    {
+    if (clipStates[i] == vtkMRMLClipModelsNode::ClipOff)
+      {
+      continue;
+      }
+    double* normal = slicePlanes[i]->GetNormal();
+    double* origin = slicePlanes[i]->GetOrigin();
+    for (int j = 0; j < 3; ++j)
+      {
+      worldPlanes[numberOfPlanes][j] = normal[j];
+      }
+    worldPlanes[numberOfPlanes][3] = -vtkMath::Dot(normal, origin);
+    ++numberOfPlanes;
     }
-  else
+  int clipUnion = (this->Internal->ClipType == vtkMRMLClipModelsNode::ClipUnion);
+
+  std::map<std::string, int>::iterator clipIt;
+  for (clipIt = this->Internal->DisplayedClipState.begin();
+       clipIt != this->Internal->DisplayedClipState.end(); ++clipIt)
     {
-    clipper->SetClipFunction(this->Internal->SlicePlanes);
+    if (clipIt->second != vtkInternal::ClippedFragments)
+      {
+      continue;
+      }
+    if (this->Internal->ClipShadersSupported == -1)
+      {
+      this->Internal->ClipShadersSupported = vtkShaderProgram2::IsSupported(context);
+      if (!this->Internal->ClipShadersSupported)
+        {
+        vtkWarningMacro(<< "UpdateClipShaders: shaders are not supported, "
+                        << "the models are clipped by vtkClipPolyData");
+        // the actors are clipped again at the next render
+        this->SetUpdateFromMRMLRequested(1);
+        this->RequestRender();
+        return;
+        }
+      }
+    vtkActor* actor = vtkActor::SafeDownCast(this->GetActorByID(clipIt->first.c_str()));
+    vtkOpenGLProperty* property = actor ?
+      vtkOpenGLProperty::SafeDownCast(actor->GetProperty()) : 0;
+    if (!property)
+      {
+      continue;
+      }
+    programIt = this->Internal->ClipPrograms.find(clipIt->first);
+    if (programIt == this->Internal->ClipPrograms.end())
+      {
+      if (property->GetPropProgram())
+        {
+        // another displayable manager draws the actor
+        continue;
+        }
+      vtkShaderProgram2* program = this->Internal->NewClipProgram(context);
+      programIt = this->Internal->ClipPrograms.insert(
+        std::make_pair(clipIt->first, vtkSmartPointer<vtkShaderProgram2>(program))).first;
+      program->Delete();
+      }
+    vtkShaderProgram2* program = programIt->second;
+    if (property->GetPropProgram() && property->GetPropProgram() != program)
+      {
+      continue;
+      }
+
+    // a plane p of the world is the plane M^T p in the coordinates of the
+    // model, M being the matrix of the actor
+    vtkMatrix4x4* modelToWorld = actor->GetMatrix();
+    vtkUniformVariables* uniforms = program->GetUniformVariables();
+    for (int i = 0; i < 3; ++i)
+      {
+      float plane[4] = {0.f, 0.f, 0.f, 1.f};
+      if (i < numberOfPlanes)
+        {
+        for (int j = 0; j < 4; ++j)
+          {
+          double value = 0.;
+          for (int k = 0; k < 4; ++k)
+            {
+            value += modelToWorld->GetElement(k, j) * worldPlanes[i][k];
+            }
+          plane[j] = static_cast<float>(value);
+          }
+        }
+      std::stringstream name;
+      name << "ClipPlane" << i;
+      uniforms->SetUniformf(name.str().c_str(), 4, plane);
+      }
+    float ambient = static_cast<float>(property->GetAmbient());
+    float diffuse = static_cast<float>(property->GetDiffuse());
+    uniforms->SetUniformi("NumberOfClipPlanes", 1, &numberOfPlanes);
+    uniforms->SetUniformi("ClipUnion", 1, &clipUnion);
+    uniforms->SetUniformf("Ambient", 1, &ambient);
+    uniforms->SetUniformf("Diffuse", 1, &diffuse);
+    if (property->GetPropProgram() != program)
+      {
+      property->SetPropProgram(program);
+      }
     }
-  return clipper;
 }
 
-
 //---------------------------------------------------------------------------
 void vtkMRMLModelDisplayableManager::OnInteractorStyleEvent(int eventid)
 {
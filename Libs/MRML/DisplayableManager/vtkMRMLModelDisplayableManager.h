@@ -58,6 +58,15 @@ class vtkWorldPointPicker;
 /// Note that the display nodes must be of type vtkMRMLModelDisplayNode
 /// (to have an output polydata) but the displayable nodes don't necessarily
 /// have to be of type vtkMRMLModelNode.
+///
+/// The models are clipped by the slices of the vtkMRMLClipModelsNode either
+/// with vtkClipPolyData or, with the ClipFragments method, by a fragment
+/// shader that gets the planes as uniforms before each render. A slice that
+/// moves without moving an active clip plane doesn't touch the models, and
+/// moving a plane only updates the clip functions in place.
+/// In shader mode the actors that already have a prop program (given by
+/// another displayable manager) are not clipped, and the picks are not
+/// clipped either.
 class VTK_MRML_DISPLAYABLEMANAGER_EXPORT vtkMRMLModelDisplayableManager
   : public vtkMRMLAbstractThreeDViewDisplayableManager
 {
@@ -97,6 +106,8 @@ public:
   
   /// Convert an x/y location to a mrml node, 3d RAS point, point id, cell id,
   /// as appropriate depending what's found under the xy.
+  /// The cells of the models are searched with cell locators that are
+  /// built at the first pick and again when their polydata changes.
   int Pick(int x, int y);
 
   /// Get/Set tolerance for Pick() method.
@@ -134,6 +145,15 @@ public:
   bool IsModelDisplayable(vtkMRMLDisplayableNode* node)const;
   /// Return true if the display node is a model
   bool IsModelDisplayable(vtkMRMLDisplayNode* node)const;
+
+  /// Number of cells from which a model is drawn with decimated levels of
+  /// detail (50%, 10% and 2% of its triangles) while the view is interacted
+  /// with. The levels are computed by a background thread, the full
+  /// resolution model is drawn until they are ready and when the view is
+  /// still. 0 disables the levels of detail, 100000 by default.
+  /// It applies to the models displayed after it is set.
+  vtkSetMacro(LODCellThreshold, vtkIdType);
+  vtkGetMacro(LODCellThreshold, vtkIdType);
 protected:
 
   vtkMRMLModelDisplayableManager();
@@ -173,6 +193,23 @@ protected:
   void UpdateModifiedModel(vtkMRMLDisplayableNode *model);
 
   void SetModelDisplayProperty(vtkMRMLDisplayableNode *model);
+
+  /// Decimate again the levels of detail of the actor if it now maps
+  /// another polydata or if the polydata was modified.
+  void UpdateModelLOD(vtkMRMLDisplayNode* displayNode, vtkActor* actor,
+                      vtkPolyData* polyData);
+  /// Give the levels of detail decimated by the background thread to their
+  /// actors. Called before each render of the view.
+  void UpdateLODsFromThread();
+  /// Copy the display properties of the mapper of the actor into the
+  /// mappers of its levels of detail.
+  void UpdateLODMappers(vtkActor* actor);
+  /// Build the cell locators of the displayed models that are new or whose
+  /// polydata has changed since the last pick.
+  void UpdatePickLocators();
+
+  static void RenderStartCallback(vtkObject* caller, unsigned long event,
+                                  void* clientData, void* callData);
   int GetDisplayedModelsVisibility(vtkMRMLDisplayNode *model);
 
   const char* GetActiveScalarName(vtkMRMLDisplayNode* displayNode,
@@ -180,9 +217,26 @@ protected:
   bool IsCellScalarsActive(vtkMRMLDisplayNode* displayNode,
                            vtkMRMLModelNode* model = 0);
 
-  /// Returns not null if modified
+  /// Returns not null if the clip type, method or states were modified.
+  /// Internally records whether an active clip plane has moved.
   int UpdateClipSlicesFromMRML();
-  vtkClipPolyData* CreateTransformedClipper(vtkMRMLDisplayableNode *model);
+  vtkClipPolyData* CreateTransformedClipper(vtkMRMLDisplayableNode *model,
+                                            const char* displayNodeID);
+  /// Set the clip planes from the slice nodes, in the coordinates of the
+  /// model if worldToModel is given. Return true if a plane that clips has
+  /// moved.
+  bool SetClipPlanesFromSlices(vtkMatrix4x4* worldToModel, vtkPlane* redSlicePlane,
+                               vtkPlane* greenSlicePlane, vtkPlane* yellowSlicePlane);
+  /// Return the clip function of a display node of a model under a linear
+  /// transform, with its planes in the coordinates of the model, 0 if the
+  /// model is not transformed.
+  vtkImplicitBoolean* UpdateTransformedClipPlanes(vtkMRMLDisplayableNode *model,
+                                                  const char* displayNodeID);
+  /// Move the planes of the transformed clipped models to the slices
+  void UpdateTransformedClippers();
+  /// Give the clip shader and its planes to the actors clipped by shader,
+  /// restore the others. Called before each render of the view.
+  void UpdateClipShaders();
 
   void AddHierarchyObservers();
   void RemoveHierarchyObservers(int clearCache);
@@ -195,7 +249,9 @@ protected:
   vtkMRMLDisplayNode*  GetHierarchyDisplayNode(vtkMRMLDisplayableNode *model);
   
   void RemoveDispalyedID(std::string &id);
-  
+
+  vtkIdType LODCellThreshold;
+
 private:
   
   vtkMRMLModelDisplayableManager(const vtkMRMLModelDisplayableManager&); // Not implemented
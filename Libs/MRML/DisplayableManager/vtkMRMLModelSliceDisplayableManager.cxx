@@ -17,6 +17,8 @@
 
 // MRMLDisplayableManager includes
 #include "vtkMRMLModelSliceDisplayableManager.h"
+#include "vtkMRMLDisplayableNodeRegistry.h"
+#include "vtkPolyDataPlaneCutter.h"
 
 // MRML includes
 #include <vtkMRMLColorNode.h>
@@ -43,11 +45,6 @@
 #include <vtkTransform.h>
 #include <vtkTransformPolyDataFilter.h>
 #include <vtkWeakPointer.h>
-#include <vtkPointLocator.h>
-
-
-// VTK includes: customization
-#include <vtkCutter.h>
 
 // STD includes
 #include <algorithm>
@@ -69,7 +66,7 @@ public:
     vtkSmartPointer<vtkTransform> TransformToSlice;
     vtkSmartPointer<vtkTransformPolyDataFilter> Transformer;
     vtkSmartPointer<vtkPlane> Plane;
-    vtkSmartPointer<vtkCutter> Cutter;
+    vtkSmartPointer<vtkPolyDataPlaneCutter> Cutter;
     vtkSmartPointer<vtkProp> Actor;
     };
 
@@ -270,7 +267,7 @@ void vtkMRMLModelSliceDisplayableManager::vtkInternal
   // Create pipeline
   Pipeline* pipeline = new Pipeline();
   pipeline->Actor = actor.GetPointer();
-  pipeline->Cutter = vtkSmartPointer<vtkCutter>::New();
+  pipeline->Cutter = vtkSmartPointer<vtkPolyDataPlaneCutter>::New();
   pipeline->TransformToSlice = vtkSmartPointer<vtkTransform>::New();
   pipeline->NodeToWorld = vtkSmartPointer<vtkMatrix4x4>::New();
   pipeline->Transformer = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
@@ -279,8 +276,7 @@ void vtkMRMLModelSliceDisplayableManager::vtkInternal
   // Set up pipeline
   pipeline->Transformer->SetTransform(pipeline->TransformToSlice);
   pipeline->Transformer->SetInputConnection(pipeline->Cutter->GetOutputPort());
-  pipeline->Cutter->SetCutFunction(pipeline->Plane);
-  pipeline->Cutter->SetGenerateCutScalars(0);
+  pipeline->Cutter->SetPlane(pipeline->Plane);
   pipeline->Actor->SetVisibility(0);
 
   // Add actor to Renderer and local cache
@@ -339,11 +335,10 @@ void vtkMRMLModelSliceDisplayableManager::vtkInternal
       {
       return;
       }
+    // the cutter keeps the cells of the polydata binned until it is
+    // modified, so that moving the slice only cuts the cells close to it
     pipeline->Cutter->SetInput(polyData);
 
-    // need this to update bounds of the locator, to avoid crash in the cutter 
-    polyData->Modified();
-
     // Update transform matrices
 
     vtkSmartPointer<vtkMatrix4x4> tempMat1 = vtkSmartPointer<vtkMatrix4x4>::New();
@@ -366,17 +361,6 @@ void vtkMRMLModelSliceDisplayableManager::vtkInternal
     pipeline->TransformToSlice->SetMatrix(tempMat2);
 
     pipeline->Plane->Modified(); 
-    
-    // optimization for slice to slice intersections which are 1 quad polydatas
-    // no need for 50^3 default locator divisons
-    if (polyData->GetPoints() != NULL && polyData->GetNumberOfPoints() <= 4)
-    {
-      vtkSmartPointer<vtkPointLocator> locator = vtkSmartPointer<vtkPointLocator>::New();
-      double *bounds = polyData->GetBounds();
-      locator->SetDivisions(2,2,2);
-      locator->InitPointInsertion(polyData->GetPoints(), bounds);
-      pipeline->Cutter->SetLocator(locator);
-    }
 
     // Update pipeline actor
     vtkActor2D* actor = vtkActor2D::SafeDownCast(pipeline->Actor);
@@ -671,11 +655,12 @@ void vtkMRMLModelSliceDisplayableManager::UpdateFromMRML()
   this->Internal->ClearDisplayableNodes();
 
   vtkMRMLDisplayableNode* mNode = NULL;
-  std::vector<vtkMRMLNode *> mNodes;
-  int nnodes = scene ? scene->GetNodesByClass("vtkMRMLDisplayableNode", mNodes) : 0;
+  std::vector<vtkMRMLDisplayableNode *> mNodes;
+  int nnodes = vtkMRMLDisplayableNodeRegistry::GetSceneRegistry(scene)
+    ->GetDisplayableNodes(mNodes);
   for (int i=0; i<nnodes; i++)
     {
-    mNode  = vtkMRMLDisplayableNode::SafeDownCast(mNodes[i]);
+    mNode  = mNodes[i];
     if (mNode && this->Internal->UseDisplayableNode(mNode))
       {
       this->AddDisplayableNode(mNode);
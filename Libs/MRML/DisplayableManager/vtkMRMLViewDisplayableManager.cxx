@@ -22,6 +22,7 @@
 #include "vtkMRMLViewDisplayableManager.h"
 #include "vtkMRMLCameraDisplayableManager.h"
 #include "vtkMRMLDisplayableManagerGroup.h"
+#include "vtkMRMLDisplayableNodeRegistry.h"
 
 // MRML includes
 #include <vtkMRMLScene.h>
@@ -167,34 +168,19 @@ void vtkMRMLViewDisplayableManager::vtkInternal::UpdateRASBounds(double bounds[6
     return;
     }
 
-  std::vector<vtkMRMLNode *> nodes;
-  int nnodes = scene->GetNodesByClass("vtkMRMLDisplayableNode", nodes);
+  // Only the nodes displayable in the view are visited
+  std::vector<vtkMRMLDisplayableNode *> nodes;
+  int nnodes = vtkMRMLDisplayableNodeRegistry::GetSceneRegistry(scene)
+    ->GetDisplayableNodesInView(this->External->GetMRMLViewNode()->GetID(), nodes);
   for (int n=0; n < nnodes; n++)
     {
-    vtkMRMLDisplayableNode* displayableNode =
-      vtkMRMLDisplayableNode::SafeDownCast(nodes[n]);
-    if (!displayableNode ||
-        strcmp(displayableNode->GetName(), "Red Volume Slice") == 0 ||
+    vtkMRMLDisplayableNode* displayableNode = nodes[n];
+    if (strcmp(displayableNode->GetName(), "Red Volume Slice") == 0 ||
         strcmp(displayableNode->GetName(), "Green Volume Slice") == 0 ||
         strcmp(displayableNode->GetName(), "Yellow Volume Slice") == 0 )
       {
       continue;
       }
-    bool isDisplayableNodeVisibleInView = false;
-    for (int i = 0; i < displayableNode->GetNumberOfDisplayNodes(); ++i)
-      {
-      vtkMRMLDisplayNode* displayNode = displayableNode->GetNthDisplayNode(i);
-      if (displayNode && displayNode->IsDisplayableInView(
-                           this->External->GetMRMLViewNode()->GetID()))
-        {
-        isDisplayableNodeVisibleInView = true;
-        break;
-        }
-      }
-    if (!isDisplayableNodeVisibleInView)
-      {
-      continue;
-      }
     double nodeBounds[6];
     displayableNode->GetRASBounds(nodeBounds);
     if (vtkMath::AreBoundsInitialized(nodeBounds))
@@ -0,0 +1,602 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRMLDisplayableManager includes
+#include "vtkPolyDataPlaneCutter.h"
+
+// VTK includes
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkMath.h>
+#include <vtkMultiThreader.h>
+#include <vtkObjectFactory.h>
+#include <vtkPlane.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+#include <vtkWeakPointer.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <utility>
+#include <vector>
+
+//----------------------------------------------------------------------------
+vtkCxxRevisionMacro(vtkPolyDataPlaneCutter, "$Revision$");
+vtkStandardNewMacro(vtkPolyDataPlaneCutter);
+
+//----------------------------------------------------------------------------
+namespace
+{
+typedef std::pair<vtkIdType, vtkIdType> EdgeType;
+
+/// Average number of cells in a bin of the grid
+const int CellsPerBin = 16;
+/// Below this number of candidate cells per thread, less threads are used
+const vtkIdType CellsPerThread = 1024;
+
+//----------------------------------------------------------------------------
+/// The polygons and the triangles of the strips of a polydata, sorted by
+/// the bin of a regular grid that contains their center, with the bounds
+/// of the cells of each bin.
+struct CellGrid
+{
+  CellGrid() : MTime(0) {}
+  void Build(vtkPolyData* polyData);
+
+  vtkWeakPointer<vtkPolyData> PolyData;
+  unsigned long MTime;
+  /// Points of the cells, the points of the cell i are
+  /// CellPoints[CellOffsets[i]] to CellPoints[CellOffsets[i+1]-1]
+  std::vector<vtkIdType> CellOffsets;
+  std::vector<vtkIdType> CellPoints;
+  /// Id in the polydata of the cell i, to copy the cell data
+  std::vector<vtkIdType> CellIds;
+  /// The cells of the bin b are BinOffsets[b] to BinOffsets[b+1]-1
+  std::vector<vtkIdType> BinOffsets;
+  /// Bounds of the cells of the bin b are BinBounds[6*b] to BinBounds[6*b+5]
+  std::vector<double> BinBounds;
+};
+
+//----------------------------------------------------------------------------
+void CellGrid::Build(vtkPolyData* polyData)
+{
+  this->PolyData = polyData;
+  this->MTime = polyData->GetMTime();
+  std::vector<vtkIdType>().swap(this->CellOffsets);
+  std::vector<vtkIdType>().swap(this->CellPoints);
+  std::vector<vtkIdType>().swap(this->CellIds);
+  std::vector<vtkIdType>(1, 0).swap(this->BinOffsets);
+  std::vector<double>().swap(this->BinBounds);
+
+  vtkPoints* points = polyData->GetPoints();
+  if (!points || points->GetNumberOfPoints() == 0)
+    {
+    return;
+    }
+
+  // flatten the polygons and the strips
+  std::vector<vtkIdType> offsets(1, 0);
+  std::vector<vtkIdType> cellPoints;
+  std::vector<vtkIdType> cellIds;
+  vtkIdType cellId = polyData->GetNumberOfVerts() + polyData->GetNumberOfLines();
+  vtkIdType npts = 0;
+  vtkIdType* pts = 0;
+  vtkCellArray* polys = polyData->GetPolys();
+  for (polys->InitTraversal(); polys->GetNextCell(npts, pts); ++cellId)
+    {
+    if (npts < 3)
+      {
+      continue;
+      }
+    cellPoints.insert(cellPoints.end(), pts, pts + npts);
+    offsets.push_back(static_cast<vtkIdType>(cellPoints.size()));
+    cellIds.push_back(cellId);
+    }
+  vtkCellArray* strips = polyData->GetStrips();
+  for (strips->InitTraversal(); strips->GetNextCell(npts, pts); ++cellId)
+    {
+    for (vtkIdType i = 0; i + 2 < npts; ++i)
+      {
+      cellPoints.insert(cellPoints.end(), pts + i, pts + i + 3);
+      offsets.push_back(static_cast<vtkIdType>(cellPoints.size()));
+      cellIds.push_back(cellId);
+      }
+    }
+  vtkIdType numberOfCells = static_cast<vtkIdType>(cellIds.size());
+  if (numberOfCells == 0)
+    {
+    return;
+    }
+
+  // a grid over the bounds of the points with about CellsPerBin cells
+  // per bin, the bins are as cubic as the axes of the bounds that are
+  // not flat allow
+  double bounds[6];
+  points->GetBounds(bounds);
+  double extents[3];
+  double measure = 1.;
+  int numberOfAxes = 0;
+  for (int i = 0; i < 3; ++i)
+    {
+    extents[i] = bounds[2*i+1] - bounds[2*i];
+    if (extents[i] > 0.)
+      {
+      measure *= extents[i];
+      ++numberOfAxes;
+      }
+    }
+  double numberOfBins = std::max(1., static_cast<double>(numberOfCells) / CellsPerBin);
+  double binsPerLength = (numberOfAxes > 0) ?
+    pow(numberOfBins / measure, 1. / numberOfAxes) : 0.;
+  int dims[3];
+  for (int i = 0; i < 3; ++i)
+    {
+    dims[i] = static_cast<int>(std::min(1024., std::max(1., extents[i] * binsPerLength)));
+    }
+  vtkIdType totalBins = static_cast<vtkIdType>(dims[0]) * dims[1] * dims[2];
+
+  // bin of the center of each cell
+  std::vector<vtkIdType> cellBins(numberOfCells);
+  std::vector<vtkIdType> binCounts(totalBins + 1, 0);
+  for (vtkIdType cell = 0; cell < numberOfCells; ++cell)
+    {
+    double center[3] = {0., 0., 0.};
+    for (vtkIdType p = offsets[cell]; p < offsets[cell+1]; ++p)
+      {
+      double x[3];
+      points->GetPoint(cellPoints[p], x);
+      center[0] += x[0];
+      center[1] += x[1];
+      center[2] += x[2];
+      }
+    double count = static_cast<double>(offsets[cell+1] - offsets[cell]);
+    vtkIdType bin = 0;
+    for (int i = 2; i >= 0; --i)
+      {
+      int index = 0;
+      if (extents[i] > 0.)
+        {
+        double position = (center[i] / count - bounds[2*i]) / extents[i] * dims[i];
+        index = std::max(0, std::min(dims[i] - 1, static_cast<int>(position)));
+        }
+      bin = bin * dims[i] + index;
+      }
+    cellBins[cell] = bin;
+    ++binCounts[bin + 1];
+    }
+  for (vtkIdType bin = 0; bin < totalBins; ++bin)
+    {
+    binCounts[bin + 1] += binCounts[bin];
+    }
+
+  // sort the cells by bin and compute the bounds of the bins
+  this->BinOffsets = binCounts;
+  this->BinBounds.resize(6 * totalBins);
+  for (vtkIdType bin = 0; bin < totalBins; ++bin)
+    {
+    for (int i = 0; i < 3; ++i)
+      {
+      this->BinBounds[6*bin + 2*i] = VTK_DOUBLE_MAX;
+      this->BinBounds[6*bin + 2*i + 1] = -VTK_DOUBLE_MAX;
+      }
+    }
+  std::vector<vtkIdType> order(numberOfCells);
+  for (vtkIdType cell = 0; cell < numberOfCells; ++cell)
+    {
+    order[binCounts[cellBins[cell]]++] = cell;
+    }
+  this->CellOffsets.reserve(numberOfCells + 1);
+  this->CellOffsets.push_back(0);
+  this->CellPoints.reserve(cellPoints.size());
+  this->CellIds.reserve(numberOfCells);
+  for (vtkIdType i = 0; i < numberOfCells; ++i)
+    {
+    vtkIdType cell = order[i];
+    double* binBounds = &this->BinBounds[6 * cellBins[cell]];
+    for (vtkIdType p = offsets[cell]; p < offsets[cell+1]; ++p)
+      {
+      double x[3];
+      points->GetPoint(cellPoints[p], x);
+      for (int j = 0; j < 3; ++j)
+        {
+        binBounds[2*j] = std::min(binBounds[2*j], x[j]);
+        binBounds[2*j+1] = std::max(binBounds[2*j+1], x[j]);
+        }
+      this->CellPoints.push_back(cellPoints[p]);
+      }
+    this->CellOffsets.push_back(static_cast<vtkIdType>(this->CellPoints.size()));
+    this->CellIds.push_back(cellIds[cell]);
+    }
+}
+
+//----------------------------------------------------------------------------
+/// Grids of the polydata being cut, shared by all the cutters.
+/// Only used from RequestData(), out of the threads.
+class CellGridRegistry
+{
+public:
+  ~CellGridRegistry()
+  {
+    for (GridMapType::iterator it = this->Grids.begin(); it != this->Grids.end(); ++it)
+      {
+      delete it->second;
+      }
+  }
+  /// Up to date grid of polyData
+  const CellGrid* GetGrid(vtkPolyData* polyData)
+  {
+    // forget the grids of the deleted polydata
+    for (GridMapType::iterator it = this->Grids.begin(); it != this->Grids.end();)
+      {
+      if (it->second->PolyData.GetPointer() == 0)
+        {
+        delete it->second;
+        this->Grids.erase(it++);
+        }
+      else
+        {
+        ++it;
+        }
+      }
+    CellGrid*& grid = this->Grids[polyData];
+    if (!grid)
+      {
+      grid = new CellGrid;
+      }
+    if (grid->PolyData.GetPointer() != polyData ||
+        grid->MTime != polyData->GetMTime())
+      {
+      grid->Build(polyData);
+      }
+    return grid;
+  }
+protected:
+  typedef std::map<vtkPolyData*, CellGrid*> GridMapType;
+  GridMapType Grids;
+};
+
+//----------------------------------------------------------------------------
+CellGridRegistry& GetCellGridRegistry()
+{
+  static CellGridRegistry registry;
+  return registry;
+}
+
+//----------------------------------------------------------------------------
+/// Segments found by a thread: the edges of their two points and the
+/// cell they come from
+struct ThreadSegments
+{
+  std::vector<EdgeType> Edges;
+  std::vector<vtkIdType> Cells;
+};
+
+}
+
+//----------------------------------------------------------------------------
+class vtkPolyDataPlaneCutter::vtkInternal
+{
+public:
+  /// State of the current RequestData()
+  const CellGrid* Grid;
+  vtkPoints* Points;
+  double Normal[3];
+  double Offset;
+  std::vector<vtkIdType> CandidateBins;
+  std::vector<ThreadSegments> Segments;
+
+  double Distance(vtkIdType pointId) const
+  {
+    double x[3];
+    this->Points->GetPoint(pointId, x);
+    return this->Normal[0] * x[0] + this->Normal[1] * x[1] +
+      this->Normal[2] * x[2] - this->Offset;
+  }
+};
+
+//----------------------------------------------------------------------------
+static VTK_THREAD_RETURN_TYPE vtkPolyDataPlaneCutter_ThreadedCut( void *arg )
+{
+  vtkMultiThreader::ThreadInfo *info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  vtkPolyDataPlaneCutter *self = static_cast<vtkPolyDataPlaneCutter *>(info->UserData);
+  self->ThreadedCut(info->ThreadID, info->NumberOfThreads);
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+vtkPolyDataPlaneCutter::vtkPolyDataPlaneCutter()
+{
+  this->Plane = 0;
+  this->MultiThreader = vtkMultiThreader::New();
+  this->NumberOfThreads = this->MultiThreader->GetNumberOfThreads();
+  this->Internal = new vtkInternal;
+  this->Internal->Grid = 0;
+  this->Internal->Points = 0;
+}
+
+//----------------------------------------------------------------------------
+vtkPolyDataPlaneCutter::~vtkPolyDataPlaneCutter()
+{
+  this->SetPlane(0);
+  this->MultiThreader->Delete();
+  delete this->Internal;
+}
+
+//----------------------------------------------------------------------------
+vtkCxxSetObjectMacro(vtkPolyDataPlaneCutter, Plane, vtkPlane);
+
+//----------------------------------------------------------------------------
+unsigned long vtkPolyDataPlaneCutter::GetMTime()
+{
+  unsigned long mTime = this->Superclass::GetMTime();
+  if (this->Plane)
+    {
+    mTime = std::max(mTime, this->Plane->GetMTime());
+    }
+  return mTime;
+}
+
+//----------------------------------------------------------------------------
+int vtkPolyDataPlaneCutter::RequestData(vtkInformation* vtkNotUsed(request),
+                                        vtkInformationVector** inputVector,
+                                        vtkInformationVector* outputVector)
+{
+  vtkPolyData* input = vtkPolyData::GetData(inputVector[0]);
+  vtkPolyData* output = vtkPolyData::GetData(outputVector);
+  if (!input || !output)
+    {
+    return 0;
+    }
+  if (!this->Plane)
+    {
+    vtkErrorMacro(<< "RequestData: no plane to cut with");
+    return 0;
+    }
+  if (!input->GetPoints())
+    {
+    return 1;
+    }
+
+  vtkInternal* internal = this->Internal;
+  internal->Grid = GetCellGridRegistry().GetGrid(input);
+  internal->Points = input->GetPoints();
+  this->Plane->GetNormal(internal->Normal);
+  internal->Offset = vtkMath::Dot(internal->Normal, this->Plane->GetOrigin());
+
+  // the bins which cells bounds straddle the plane
+  const CellGrid* grid = internal->Grid;
+  vtkIdType numberOfBins = static_cast<vtkIdType>(grid->BinOffsets.size()) - 1;
+  vtkIdType numberOfCandidateCells = 0;
+  internal->CandidateBins.clear();
+  for (vtkIdType bin = 0; bin < numberOfBins; ++bin)
+    {
+    if (grid->BinOffsets[bin] == grid->BinOffsets[bin + 1])
+      {
+      continue;
+      }
+    const double* bounds = &grid->BinBounds[6 * bin];
+    double distance = -internal->Offset;
+    double radius = 0.;
+    for (int i = 0; i < 3; ++i)
+      {
+      distance += internal->Normal[i] * 0.5 * (bounds[2*i] + bounds[2*i+1]);
+      radius += fabs(internal->Normal[i]) * 0.5 * (bounds[2*i+1] - bounds[2*i]);
+      }
+    // keep the bins that touch the plane despite the rounding errors
+    double tolerance = 1e-9 * (fabs(distance) + radius) + VTK_DBL_EPSILON;
+    if (distance - radius > tolerance || distance + radius < -tolerance)
+      {
+      continue;
+      }
+    internal->CandidateBins.push_back(bin);
+    numberOfCandidateCells += grid->BinOffsets[bin + 1] - grid->BinOffsets[bin];
+    }
+
+  int numberOfThreads = static_cast<int>(std::min(
+    static_cast<vtkIdType>(this->NumberOfThreads),
+    numberOfCandidateCells / CellsPerThread + 1));
+  internal->Segments.clear();
+  internal->Segments.resize(numberOfThreads);
+  if (numberOfThreads > 1)
+    {
+    this->MultiThreader->SetNumberOfThreads(numberOfThreads);
+    this->MultiThreader->SetSingleMethod(vtkPolyDataPlaneCutter_ThreadedCut, this);
+    this->MultiThreader->SingleMethodExecute();
+    }
+  else
+    {
+    this->ThreadedCut(0, 1);
+    }
+
+  // one output point per cut edge
+  std::vector<EdgeType> edges;
+  vtkIdType numberOfSegments = 0;
+  for (int thread = 0; thread < numberOfThreads; ++thread)
+    {
+    const std::vector<EdgeType>& threadEdges = internal->Segments[thread].Edges;
+    edges.insert(edges.end(), threadEdges.begin(), threadEdges.end());
+    numberOfSegments += static_cast<vtkIdType>(internal->Segments[thread].Cells.size());
+    }
+  std::sort(edges.begin(), edges.end());
+  edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+  vtkPointData* inPD = input->GetPointData();
+  vtkPointData* outPD = output->GetPointData();
+  vtkCellData* inCD = input->GetCellData();
+  vtkCellData* outCD = output->GetCellData();
+  vtkIdType numberOfPoints = static_cast<vtkIdType>(edges.size());
+  vtkSmartPointer<vtkPoints> newPoints = vtkSmartPointer<vtkPoints>::New();
+  newPoints->SetDataType(input->GetPoints()->GetDataType());
+  newPoints->SetNumberOfPoints(numberOfPoints);
+  outPD->InterpolateAllocate(inPD, numberOfPoints);
+  for (vtkIdType i = 0; i < numberOfPoints; ++i)
+    {
+    vtkIdType p1 = edges[i].first;
+    vtkIdType p2 = edges[i].second;
+    double d1 = internal->Distance(p1);
+    double d2 = internal->Distance(p2);
+    double t = d1 / (d1 - d2);
+    double x1[3];
+    double x2[3];
+    internal->Points->GetPoint(p1, x1);
+    internal->Points->GetPoint(p2, x2);
+    newPoints->SetPoint(i, x1[0] + t * (x2[0] - x1[0]),
+                           x1[1] + t * (x2[1] - x1[1]),
+                           x1[2] + t * (x2[2] - x1[2]));
+    outPD->InterpolateEdge(inPD, i, p1, p2, t);
+    }
+
+  vtkSmartPointer<vtkCellArray> newLines = vtkSmartPointer<vtkCellArray>::New();
+  newLines->Allocate(3 * numberOfSegments);
+  outCD->CopyAllocate(inCD, numberOfSegments);
+  for (int thread = 0; thread < numberOfThreads; ++thread)
+    {
+    const ThreadSegments& segments = internal->Segments[thread];
+    for (size_t segment = 0; segment < segments.Cells.size(); ++segment)
+      {
+      vtkIdType line[2];
+      for (int end = 0; end < 2; ++end)
+        {
+        line[end] = static_cast<vtkIdType>(
+          std::lower_bound(edges.begin(), edges.end(),
+                           segments.Edges[2 * segment + end]) - edges.begin());
+        }
+      vtkIdType lineId = newLines->InsertNextCell(2, line);
+      outCD->CopyData(inCD, segments.Cells[segment], lineId);
+      }
+    }
+
+  output->SetPoints(newPoints);
+  output->SetLines(newLines);
+  output->Squeeze();
+
+  std::vector<ThreadSegments>().swap(internal->Segments);
+  internal->Grid = 0;
+  internal->Points = 0;
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+// Cut the cells of a share of the candidate bins: the edges which points
+// are on both sides of the plane are cut, a point on the plane is on the
+// positive side. The cut edges of a cell are paired along the line of
+// the cut so that concave polygons give several segments.
+void vtkPolyDataPlaneCutter::ThreadedCut(int threadId, int numberOfThreads)
+{
+  const vtkInternal* internal = this->Internal;
+  const CellGrid* grid = internal->Grid;
+  ThreadSegments& segments = this->Internal->Segments[threadId];
+  vtkIdType numberOfBins = static_cast<vtkIdType>(internal->CandidateBins.size());
+  vtkIdType firstBin = numberOfBins * threadId / numberOfThreads;
+  vtkIdType lastBin = numberOfBins * (threadId + 1) / numberOfThreads;
+
+  std::vector<double> distances;
+  std::vector<EdgeType> cutEdges;
+  std::vector<std::pair<double, EdgeType> > sortedEdges;
+  for (vtkIdType i = firstBin; i < lastBin; ++i)
+    {
+    vtkIdType bin = internal->CandidateBins[i];
+    for (vtkIdType cell = grid->BinOffsets[bin]; cell < grid->BinOffsets[bin + 1]; ++cell)
+      {
+      const vtkIdType* pts = &grid->CellPoints[grid->CellOffsets[cell]];
+      vtkIdType npts = grid->CellOffsets[cell + 1] - grid->CellOffsets[cell];
+      distances.resize(npts);
+      bool positive = false;
+      bool negative = false;
+      for (vtkIdType p = 0; p < npts; ++p)
+        {
+        distances[p] = internal->Distance(pts[p]);
+        (distances[p] >= 0. ? positive : negative) = true;
+        }
+      if (!positive || !negative)
+        {
+        continue;
+        }
+      cutEdges.clear();
+      for (vtkIdType p = 0; p < npts; ++p)
+        {
+        vtkIdType q = (p + 1 == npts) ? 0 : p + 1;
+        if ((distances[p] >= 0.) != (distances[q] >= 0.))
+          {
+          cutEdges.push_back(pts[p] < pts[q] ?
+                             EdgeType(pts[p], pts[q]) : EdgeType(pts[q], pts[p]));
+          }
+        }
+      if (cutEdges.size() > 2)
+        {
+        // order the cut points along the line of the cut
+        sortedEdges.clear();
+        double first[3] = {0., 0., 0.};
+        double direction[3] = {0., 0., 0.};
+        for (size_t e = 0; e < cutEdges.size(); ++e)
+          {
+          double x1[3];
+          double x2[3];
+          internal->Points->GetPoint(cutEdges[e].first, x1);
+          internal->Points->GetPoint(cutEdges[e].second, x2);
+          double d1 = internal->Distance(cutEdges[e].first);
+          double t = d1 / (d1 - internal->Distance(cutEdges[e].second));
+          double x[3];
+          for (int j = 0; j < 3; ++j)
+            {
+            x[j] = x1[j] + t * (x2[j] - x1[j]);
+            }
+          if (e == 0)
+            {
+            std::copy(x, x + 3, first);
+            }
+          else if (e == 1)
+            {
+            for (int j = 0; j < 3; ++j)
+              {
+              direction[j] = x[j] - first[j];
+              }
+            }
+          sortedEdges.push_back(std::make_pair(
+            (x[0] - first[0]) * direction[0] + (x[1] - first[1]) * direction[1] +
+            (x[2] - first[2]) * direction[2], cutEdges[e]));
+          }
+        // the first point was projected before the direction was known
+        sortedEdges[0].first = 0.;
+        std::sort(sortedEdges.begin(), sortedEdges.end());
+        for (size_t e = 0; e < cutEdges.size(); ++e)
+          {
+          cutEdges[e] = sortedEdges[e].second;
+          }
+        }
+      for (size_t e = 0; e + 1 < cutEdges.size(); e += 2)
+        {
+        segments.Edges.push_back(cutEdges[e]);
+        segments.Edges.push_back(cutEdges[e + 1]);
+        segments.Cells.push_back(grid->CellIds[cell]);
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkPolyDataPlaneCutter::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+
+  os << indent << "Plane: " << this->Plane << "\n";
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << "\n";
+}
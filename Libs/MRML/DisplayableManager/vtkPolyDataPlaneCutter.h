@@ -0,0 +1,85 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkPolyDataPlaneCutter_h
+#define __vtkPolyDataPlaneCutter_h
+
+// MRMLDisplayableManager includes
+#include "vtkMRMLDisplayableManagerWin32Header.h"
+
+// VTK includes
+#include <vtkPolyDataAlgorithm.h>
+
+class vtkMultiThreader;
+class vtkPlane;
+
+/// \brief Cut the polygons of a polydata by a plane into line segments.
+///
+/// It produces the same segments as vtkCutter with a plane but only
+/// visits the cells that may straddle the plane: the cells of the input
+/// are binned by their center in a grid, and the bins whose cells
+/// bounds don't straddle the plane are skipped. The grid is built once
+/// per input and MTime, and shared by all the cutters of the same input,
+/// for example the slice views that cut the same model. The candidate
+/// bins are cut by threads.
+/// Only the polygons and the triangle strips of the input are cut, the
+/// point data is interpolated and the points of an edge are merged.
+class VTK_MRML_DISPLAYABLEMANAGER_EXPORT vtkPolyDataPlaneCutter
+  : public vtkPolyDataAlgorithm
+{
+public:
+  static vtkPolyDataPlaneCutter *New();
+  vtkTypeRevisionMacro(vtkPolyDataPlaneCutter,vtkPolyDataAlgorithm);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  ///
+  /// Plane to cut the input with
+  virtual void SetPlane(vtkPlane* plane);
+  vtkGetObjectMacro(Plane, vtkPlane);
+
+  ///
+  /// Maximum number of threads used to cut the cells
+  vtkSetClampMacro(NumberOfThreads, int, 1, VTK_MAX_THREADS);
+  vtkGetMacro(NumberOfThreads, int);
+
+  ///
+  /// Take the plane into account
+  virtual unsigned long GetMTime();
+
+  ///
+  /// Cut the share of the candidate cells of a thread, called by RequestData()
+  void ThreadedCut(int threadId, int numberOfThreads);
+
+protected:
+  vtkPolyDataPlaneCutter();
+  ~vtkPolyDataPlaneCutter();
+
+  virtual int RequestData(vtkInformation* request,
+                          vtkInformationVector** inputVector,
+                          vtkInformationVector* outputVector);
+
+  vtkPlane* Plane;
+  int NumberOfThreads;
+  vtkMultiThreader* MultiThreader;
+
+  class vtkInternal;
+  vtkInternal* Internal;
+
+private:
+  vtkPolyDataPlaneCutter(const vtkPolyDataPlaneCutter&);  /// Not implemented.
+  void operator=(const vtkPolyDataPlaneCutter&);  /// Not implemented.
+};
+
+#endif
@@ -25,6 +25,67 @@ Version:   $Revision: 1.18 $
 #include <vtkMatrix4x4.h>
 #include <vtkPointData.h>
 
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+
+// Byte strides along x, y, z and the components of an image of
+// dimensions[3] voxels of numberOfComponents components whose components
+// are interleaved (VTK scalars, ITK vector pixels).
+void ComputeInterleavedStrides(const size_t dimensions[3],
+                               size_t numberOfComponents,
+                               size_t componentSize,
+                               size_t strides[4])
+{
+  strides[3] = componentSize;
+  strides[0] = numberOfComponents * componentSize;
+  strides[1] = dimensions[0] * strides[0];
+  strides[2] = dimensions[1] * strides[1];
+}
+
+// Copy size[0] x size[1] x size[2] voxels of size[3] components between
+// two buffers described by their byte strides along x, y, z and the
+// components. Rows are copied at once when their components are
+// contiguous in both buffers.
+void CopyComponents(const char* source, const size_t sourceStrides[4],
+                    char* destination, const size_t destinationStrides[4],
+                    const size_t size[4], size_t componentSize)
+{
+  const size_t pixelSize = size[3] * componentSize;
+  const bool contiguousRows =
+    sourceStrides[3] == componentSize && sourceStrides[0] == pixelSize &&
+    destinationStrides[3] == componentSize &&
+    destinationStrides[0] == pixelSize;
+  for (size_t z = 0; z < size[2]; ++z)
+    {
+    for (size_t y = 0; y < size[1]; ++y)
+      {
+      const char* sourceRow =
+        source + z * sourceStrides[2] + y * sourceStrides[1];
+      char* destinationRow =
+        destination + z * destinationStrides[2] + y * destinationStrides[1];
+      if (contiguousRows)
+        {
+        memcpy(destinationRow, sourceRow, size[0] * pixelSize);
+        continue;
+        }
+      for (size_t x = 0; x < size[0]; ++x)
+        {
+        for (size_t c = 0; c < size[3]; ++c)
+          {
+          memcpy(destinationRow + x * destinationStrides[0]
+                   + c * destinationStrides[3],
+                 sourceRow + x * sourceStrides[0] + c * sourceStrides[3],
+                 componentSize);
+          }
+        }
+      }
+    }
+}
+
+}
 
 namespace itk {
 
@@ -345,22 +406,58 @@ MRMLIDImageIO
   vtkMRMLVolumeNode *node;
 
   node = this->FileNameToVolumeNodePtr( m_FileName.c_str() );
-  if (node)
+  if (node && node->GetImageData())
     {
-    // buffer is preallocated, memcpy the data
+    // buffer is preallocated for the IORegion, copy the voxels of the
+    // region only
+    vtkImageData *img = node->GetImageData();
+    vtkDataArray *array;
     if (vtkMRMLDiffusionImageVolumeNode::SafeDownCast(node) == 0)
       {
       // Scalar, Diffusion Weighted, or Vector image
-      memcpy(buffer, node->GetImageData()->GetScalarPointer(), 
-             this->GetImageSizeInBytes());
+      array = img->GetPointData()->GetScalars();
       }
     else
       {
       // Tensor image
-      memcpy(buffer, 
-             node->GetImageData()->GetPointData()->GetTensors()->GetVoidPointer(0), 
-             this->GetImageSizeInBytes());
+      array = img->GetPointData()->GetTensors();
       }
+    if (array == 0)
+      {
+      itkExceptionMacro("MRML Node does not contain image data.");
+      }
+
+    const ImageIORegion &ioRegion = this->GetIORegion();
+    size_t dimensions[3];
+    size_t regionStart[3] = {0, 0, 0};
+    size_t regionSize[4] = {1, 1, 1, 1};
+    for (unsigned int i = 0; i < 3; ++i)
+      {
+      dimensions[i] = img->GetDimensions()[i];
+      regionSize[i] = dimensions[i];
+      }
+    for (unsigned int i = 0;
+         i < std::min<size_t>(3, ioRegion.GetIndex().size()); ++i)
+      {
+      regionStart[i] = ioRegion.GetIndex()[i];
+      regionSize[i] = ioRegion.GetSize()[i];
+      }
+    regionSize[3] = array->GetNumberOfComponents();
+
+    const size_t componentSize = array->GetDataTypeSize();
+    size_t sourceStrides[4];
+    ComputeInterleavedStrides(dimensions, regionSize[3], componentSize,
+                              sourceStrides);
+    size_t destinationStrides[4];
+    ComputeInterleavedStrides(regionSize, regionSize[3], componentSize,
+                              destinationStrides);
+    const char *source = static_cast<const char*>(array->GetVoidPointer(0))
+      + regionStart[0] * sourceStrides[0]
+      + regionStart[1] * sourceStrides[1]
+      + regionStart[2] * sourceStrides[2];
+    CopyComponents(source, sourceStrides,
+                   static_cast<char*>(buffer), destinationStrides,
+                   regionSize, componentSize);
     }
 }
 
@@ -472,8 +569,9 @@ MRMLIDImageIO
 
   // Fill in dimensions
   // VTK is only 3D, only copy the first 3 dimensions, fill in with
-  // reasonable defaults for the rest
-  if (this->GetNumberOfDimensions() > 3)
+  // reasonable defaults for the rest. The 4th dimension is stored in
+  // the scalar components.
+  if (this->GetNumberOfDimensions() > 4)
     {
     itkWarningMacro("Dimension of image is too high for VTK (Dimension = "
                     << this->GetNumberOfDimensions() << ")" );
@@ -527,7 +625,14 @@ MRMLIDImageIO
   if (vtkMRMLDiffusionTensorVolumeNode::SafeDownCast(node) == 0)
     {
     // Scalar, Diffusion Weighted, or Vector image
-    img->SetNumberOfScalarComponents(this->GetNumberOfComponents());
+    if (this->GetNumberOfDimensions() == 4)
+      {
+      img->SetNumberOfScalarComponents(this->GetDimensions(3));
+      }
+    else
+      {
+      img->SetNumberOfScalarComponents(this->GetNumberOfComponents());
+      }
     }
   else
     {
@@ -584,80 +689,179 @@ MRMLIDImageIO
   node = this->FileNameToVolumeNodePtr( m_FileName.c_str() );
   if (node)
     {
-    // Don't send Modified events
-    //
-    node->DisableModifiedEventOn();
-    
-    // Need to create a VTK ImageData to hang off the node if there is
-    // not one already there
-    //
-    vtkImageData *img = 0;
-    img = node->GetImageData();
-    if (!img)
+    const unsigned int dimension = this->GetNumberOfDimensions();
+    const bool isTensor =
+      (vtkMRMLDiffusionTensorVolumeNode::SafeDownCast(node) != 0);
+    if (dimension == 4 && (this->GetNumberOfComponents() != 1 || isTensor))
       {
-      img = vtkImageData::New();
-      node->SetAndObserveImageData(img);
-      img->Delete();
+      itkExceptionMacro("Only 4D images of scalar pixels can be written "
+                        "to a MRML node.");
       }
 
-    // Disconnect the observers from the image
+    // Region to write, the 4th dimension is the components of VTK
     //
     //
-    img->Register(NULL);  // keep a handle
-    node->SetAndObserveImageData(NULL);
+    const ImageIORegion &ioRegion = this->GetIORegion();
+    size_t dimensions[4] = {1, 1, 1, 1};
+    size_t regionStart[4] = {0, 0, 0, 0};
+    size_t regionSize[4] = {1, 1, 1, 1};
+    for (unsigned int i = 0; i < dimension && i < 4; ++i)
+      {
+      dimensions[i] = this->GetDimensions(i);
+      regionSize[i] = dimensions[i];
+      }
+    for (unsigned int i = 0;
+         i < std::min<size_t>(4, ioRegion.GetIndex().size()); ++i)
+      {
+      regionStart[i] = ioRegion.GetIndex()[i];
+      regionSize[i] = ioRegion.GetSize()[i];
+      }
+    bool firstRegion = true;
+    bool lastRegion = true;
+    for (unsigned int i = 0; i < 4; ++i)
+      {
+      firstRegion = firstRegion && (regionStart[i] == 0);
+      lastRegion = lastRegion &&
+        (regionStart[i] + regionSize[i] == dimensions[i]);
+      }
+    // Components of a voxel in VTK: 9 for tensors (6 in ITK)
+    const size_t numberOfComponents = isTensor ? 9 :
+      (dimension == 4 ? dimensions[3] : this->GetNumberOfComponents());
 
-    // Configure the information on the node/image data
-    //
+    vtkImageData *img = node->GetImageData();
+    if (!firstRegion)
+      {
+      // The image data was allocated when the first region was written
+      vtkDataArray *array = img ? (isTensor ?
+        img->GetPointData()->GetTensors() :
+        img->GetPointData()->GetScalars()) : 0;
+      if (array == 0 ||
+          static_cast<size_t>(img->GetDimensions()[0]) != dimensions[0] ||
+          static_cast<size_t>(img->GetDimensions()[1]) != dimensions[1] ||
+          static_cast<size_t>(img->GetDimensions()[2]) != dimensions[2] ||
+          static_cast<size_t>(array->GetNumberOfComponents())
+            != numberOfComponents)
+        {
+        itkExceptionMacro("The region " << ioRegion << " can't be written "
+                          "before the region starting at the image origin.");
+        }
+      }
+
+    // Don't send Modified events
     //
-    this->WriteImageInformation(node, img);
+    node->DisableModifiedEventOn();
+
+    if (firstRegion)
+      {
+      // The voxels are copied straight from the ITK buffer into the image
+      // data of the node, no file is involved. The current image data is
+      // reused (and its memory with it) unless something else than the
+      // node holds it, e.g. a display pipeline: a new image data is then
+      // filled so that the image being displayed is never reallocated or
+      // partially written.
+      //
+      if (img)
+        {
+        // Disconnect the observers from the image
+        //
+        //
+        img->Register(NULL);  // keep a handle
+        node->SetAndObserveImageData(NULL);
+        if (img->GetReferenceCount() > 1)
+          {
+          img->UnRegister(NULL);
+          img = 0;
+          }
+        }
+      if (!img)
+        {
+        img = vtkImageData::New();
+        }
+
+      // Configure the information on the node/image data
+      //
+      //
+      this->WriteImageInformation(node, img);
+
+      // Allocate the data
+      //
+      //
+      if (!isTensor)
+        {
+        // Everything but tensor images are passed in the scalars
+        img->AllocateScalars();
+        }
+      else
+        {
+        // Allocate tensor image (number of components set in
+        // WriteInformation())
+        img->GetPointData()->GetTensors()->SetNumberOfTuples(
+          dimensions[0] * dimensions[1] * dimensions[2]);
+        }
+      }
 
-    // Allocate the data, copy the data 
+    // Copy the region
     //
     //
-    if (vtkMRMLDiffusionTensorVolumeNode::SafeDownCast(node) == 0)
+    vtkDataArray *array = isTensor ?
+      img->GetPointData()->GetTensors() : img->GetPointData()->GetScalars();
+    const size_t componentSize = this->GetComponentSize();
+    size_t destinationStrides[4];
+    ComputeInterleavedStrides(dimensions, numberOfComponents, componentSize,
+                              destinationStrides);
+    char *destination = static_cast<char*>(array->GetVoidPointer(0))
+      + regionStart[0] * destinationStrides[0]
+      + regionStart[1] * destinationStrides[1]
+      + regionStart[2] * destinationStrides[2];
+    size_t sourceStrides[4];
+    size_t size[4] = {regionSize[0], regionSize[1], regionSize[2], 1};
+    if (dimension == 4)
       {
-      // Everything but tensor images are passed in the scalars
-      img->AllocateScalars();
-
-      memcpy(img->GetScalarPointer(), buffer,
-             img->GetPointData()->GetScalars()->GetNumberOfComponents() *
-             img->GetPointData()->GetScalars()->GetNumberOfTuples() *
-             img->GetPointData()->GetScalars()->GetDataTypeSize()
-        );
+      // The voxels along the 4th dimension become the components
+      size_t volumeSize[3] = {regionSize[0], regionSize[1], regionSize[2]};
+      ComputeInterleavedStrides(volumeSize, 1, componentSize, sourceStrides);
+      sourceStrides[3] = regionSize[2] * sourceStrides[2];
+      destination += regionStart[3] * destinationStrides[3];
+      size[3] = regionSize[3];
+      }
+    else
+      {
+      ComputeInterleavedStrides(regionSize, this->GetNumberOfComponents(),
+                                componentSize, sourceStrides);
+      size[3] = this->GetNumberOfComponents();
+      }
+    if (!isTensor)
+      {
+      CopyComponents(static_cast<const char*>(buffer), sourceStrides,
+                     destination, destinationStrides, size, componentSize);
       }
     else
       {
-      // Tensor image
-      unsigned long imagesizeinpixels = this->GetImageSizeInPixels();
-
-      // Allocate tensor image (number of components set in WriteInformation())
-      img->GetPointData()->GetTensors()->SetNumberOfTuples(imagesizeinpixels);
-
       // Tensors comming from ITK will be 6 components.  Need to
       // convert to 9 components for VTK
-      void *mptr = img->GetPointData()->GetTensors()->GetVoidPointer(0);
-      const void *bptr = buffer;
-
-      short csize =img->GetPointData()->GetTensors()->GetDataTypeSize();
-      for (unsigned long i=0; i < imagesizeinpixels; ++i)
+      static const size_t tensorComponents[9] = {0, 1, 2, 1, 3, 4, 2, 4, 5};
+      size[3] = 1;
+      for (size_t c = 0; c < 9; ++c)
         {
-        memcpy((char*)mptr, (char*)bptr, csize);
-        memcpy((char*)mptr+csize, (char*)bptr+csize, csize);
-        memcpy((char*)mptr+2*csize, (char*)bptr+2*csize, csize);
-        memcpy((char*)mptr+3*csize, (char*)bptr+1*csize, csize);
-        memcpy((char*)mptr+4*csize, (char*)bptr+3*csize, csize);
-        memcpy((char*)mptr+5*csize, (char*)bptr+4*csize, csize);
-        memcpy((char*)mptr+6*csize, (char*)bptr+2*csize, csize);
-        memcpy((char*)mptr+7*csize, (char*)bptr+4*csize, csize);
-        memcpy((char*)mptr+8*csize, (char*)bptr+5*csize, csize);
-        mptr = (char*)mptr + 9*csize;
-        bptr = (char*)bptr + 6*csize;
+        CopyComponents(static_cast<const char*>(buffer)
+                         + tensorComponents[c] * componentSize,
+                       sourceStrides,
+                       destination + c * componentSize, destinationStrides,
+                       size, componentSize);
         }
       }
 
-    // Connect the observers to the image
-    node->SetAndObserveImageData( img );
-    img->UnRegister(NULL); // release the handle
+    if (firstRegion)
+      {
+      // Connect the observers to the image
+      node->SetAndObserveImageData( img );
+      img->UnRegister(NULL); // release the handle
+      }
+    else if (lastRegion)
+      {
+      // The image is complete
+      img->Modified();
+      }
 
     // Enable Modified events
     //
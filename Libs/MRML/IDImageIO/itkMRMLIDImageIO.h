@@ -50,6 +50,14 @@ namespace itk
  *     slicer:<scene id>#<node id>                  - local slicer
  *     slicer://<hostname>/<scene id>#<node id>     - remote slicer
  *
+ * Reading and writing can be streamed: only the IORegion is copied
+ * from/to the image data of the node, so that a StreamingImageFilter
+ * can process a volume by slabs without an extra copy of the whole
+ * image. Multi-component volumes are read and written with their
+ * components. A 4D scalar image is written as a multi-component
+ * volume whose components are the voxels along the 4th dimension
+ * (e.g. the gradients of a DWI).
+ *
  * This code was written on the Massachusettes Turnpike with extreme
  * glare on the LCD.
  */
@@ -78,7 +86,14 @@ public:
   /** Set the spacing and dimension information for the set filename. */
   virtual void ReadImageInformation();
   
-  /** Reads the data from disk into the memory buffer provided. */
+  /** Any region of the node image data can be read. */
+  virtual bool CanStreamRead()
+  {
+    return true;
+  }
+
+  /** Reads the IORegion of the node image data into the memory buffer
+   * provided. */
   virtual void Read(void* buffer);
 
   /*-------- This part of the interfaces deals with writing data. ----- */
@@ -91,8 +106,23 @@ public:
    * Assumes SetFileName has been called with a valid file name. */
   virtual void WriteImageInformation();
 
-  /** Writes the data to disk from the memory buffer provided. Make sure
-   * that the IORegion has been set properly. */
+  /** The image can be written region by region. */
+  virtual bool CanStreamWrite()
+  {
+    return true;
+  }
+
+  /** Images of 1 to 4 dimensions are supported, the 4th dimension is
+   * written as the scalar components of the node image data. */
+  virtual bool SupportsDimension(unsigned long dimension)
+  {
+    return dimension >= 1 && dimension <= 4;
+  }
+
+  /** Writes the IORegion of the image to the node from the memory buffer
+   * provided. Make sure that the IORegion has been set properly. The
+   * image data of the node is (re)allocated when the region starts at
+   * the origin of the image, the later regions are copied into it. */
   virtual void Write(const void* buffer);
 
 protected:
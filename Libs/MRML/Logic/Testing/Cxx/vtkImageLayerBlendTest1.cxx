@@ -0,0 +1,107 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRMLLogic includes
+#include "vtkImageLayerBlend.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkSmartPointer.h>
+
+// STD includes
+#include <cstring>
+
+#include "vtkMRMLCoreTestingMacros.h"
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkImageData> createLayer(const unsigned char pixels[8])
+{
+  vtkSmartPointer<vtkImageData> layer = vtkSmartPointer<vtkImageData>::New();
+  layer->SetDimensions(2, 1, 1);
+  layer->SetScalarTypeToUnsignedChar();
+  layer->SetNumberOfScalarComponents(4);
+  layer->AllocateScalars();
+  memcpy(layer->GetScalarPointer(), pixels, 8);
+  return layer;
+}
+
+//----------------------------------------------------------------------------
+bool checkOutput(vtkImageLayerBlend* blend, const unsigned char expected[8])
+{
+  blend->Update();
+  unsigned char* output =
+    static_cast<unsigned char*>(blend->GetOutput()->GetScalarPointer());
+  for (int i = 0; i < 8; ++i)
+    {
+    if (output[i] != expected[i])
+      {
+      std::cerr << "Compositing " << blend->GetCompositing()
+                << ": component " << i << " is " << static_cast<int>(output[i])
+                << " instead of " << static_cast<int>(expected[i]) << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+}
+
+//----------------------------------------------------------------------------
+int vtkImageLayerBlendTest1(int , char * [] )
+{
+  vtkSmartPointer<vtkImageLayerBlend> blend =
+    vtkSmartPointer<vtkImageLayerBlend>::New();
+  EXERCISE_BASIC_OBJECT_METHODS(blend);
+
+  const unsigned char background[8] = {100, 100, 100, 255, 10, 20, 30, 255};
+  const unsigned char foreground[8] = {200, 0, 0, 255, 250, 250, 250, 0};
+  blend->SetInput(0, createLayer(background));
+  blend->SetOpacity(0, 1.);
+  blend->SetInput(1, createLayer(foreground));
+  blend->SetOpacity(1, 0.5);
+
+  // transparent foreground pixels don't contribute
+  const unsigned char alpha[8] = {150, 50, 50, 255, 10, 20, 30, 255};
+  if (!checkOutput(blend, alpha))
+    {
+    return EXIT_FAILURE;
+    }
+
+  blend->SetCompositingToAdd();
+  const unsigned char add[8] = {255, 100, 100, 255, 255, 255, 255, 255};
+  if (!checkOutput(blend, add))
+    {
+    return EXIT_FAILURE;
+    }
+
+  blend->SetCompositingToSubtract();
+  const unsigned char subtract[8] = {100, 0, 0, 255, 240, 230, 220, 255};
+  if (!checkOutput(blend, subtract))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // the third layer is always alpha blended
+  const unsigned char label[8] = {0, 0, 0, 0, 0, 0, 0, 255};
+  blend->SetInput(2, createLayer(label));
+  blend->SetOpacity(2, 1.);
+  const unsigned char subtractLabel[8] = {100, 0, 0, 255, 0, 0, 0, 255};
+  if (!checkOutput(blend, subtractLabel))
+    {
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
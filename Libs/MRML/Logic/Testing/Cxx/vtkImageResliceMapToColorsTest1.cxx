@@ -0,0 +1,302 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRMLLogic includes
+#include "vtkImageResliceMapToColors.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkLookupTable.h>
+#include <vtkPointData.h>
+#include <vtkSmartPointer.h>
+#include <vtkTransform.h>
+
+#include "vtkMRMLCoreTestingMacros.h"
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+unsigned char windowLevel(double value, double window, double level)
+{
+  double lower = level - window / 2.;
+  if (value <= lower)
+    {
+    return 0;
+    }
+  if (value >= lower + window)
+    {
+    return 255;
+    }
+  return static_cast<unsigned char>((value - lower) * 255. / window);
+}
+
+//----------------------------------------------------------------------------
+bool checkPixel(vtkImageData* output, int i, int j,
+                const unsigned char expected[4])
+{
+  unsigned char* pixel =
+    static_cast<unsigned char*>(output->GetScalarPointer(i, j, 0));
+  for (int c = 0; c < 4; ++c)
+    {
+    if (pixel[c] != expected[c])
+      {
+      std::cerr << "Pixel (" << i << ", " << j << ") component " << c
+                << ": expected " << static_cast<int>(expected[c])
+                << " got " << static_cast<int>(pixel[c]) << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+}
+
+//----------------------------------------------------------------------------
+int vtkImageResliceMapToColorsTest1(int , char * [] )
+{
+  vtkSmartPointer<vtkImageResliceMapToColors> reslice =
+    vtkSmartPointer<vtkImageResliceMapToColors>::New();
+  EXERCISE_BASIC_OBJECT_METHODS(reslice);
+
+  // 10x10x3 short image, value(i,j,k) = 20 * (i + 10 * j) - 1000 + k
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(10, 10, 3);
+  image->SetScalarTypeToShort();
+  image->SetNumberOfScalarComponents(1);
+  image->AllocateScalars();
+  short* ptr = static_cast<short*>(image->GetScalarPointer());
+  for (int k = 0; k < 3; ++k)
+    {
+    for (int j = 0; j < 10; ++j)
+      {
+      for (int i = 0; i < 10; ++i)
+        {
+        *ptr++ = static_cast<short>(20 * (i + 10 * j) - 1000 + k);
+        }
+      }
+    }
+
+  vtkSmartPointer<vtkLookupTable> lut = vtkSmartPointer<vtkLookupTable>::New();
+  lut->SetTableRange(0, 255);
+  lut->SetNumberOfTableValues(256);
+  lut->SetHueRange(0., 0.66);
+  lut->Build();
+
+  // Slice k = 1, shifted by 2 voxels along X to have pixels outside
+  vtkSmartPointer<vtkTransform> xyToIJK = vtkSmartPointer<vtkTransform>::New();
+  xyToIJK->Translate(-2., 0., 1.);
+
+  const double window = 1000.;
+  const double level = 0.;
+  reslice->SetInput(image);
+  reslice->SetResliceTransform(xyToIJK);
+  reslice->SetLookupTable(lut);
+  reslice->SetWindow(window);
+  reslice->SetLevel(level);
+  reslice->SetOutputExtent(0, 11, 0, 9, 0, 0);
+  reslice->Update();
+
+  vtkImageData* output = reslice->GetOutput();
+  if (output->GetScalarType() != VTK_UNSIGNED_CHAR ||
+      output->GetNumberOfScalarComponents() != 4)
+    {
+    std::cerr << "Output is not RGBA unsigned char" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  for (int j = 0; j < 10; ++j)
+    {
+    for (int i = 0; i < 12; ++i)
+      {
+      unsigned char expected[4] = {0, 0, 0, 0};
+      double value = i < 2 ? 0. : 20 * (i - 2 + 10 * j) - 1000 + 1;
+      unsigned char* color = lut->MapValue(windowLevel(value, window, level));
+      expected[0] = color[0];
+      expected[1] = color[1];
+      expected[2] = color[2];
+      expected[3] = i < 2 ? 0 : 255;
+      if (!checkPixel(output, i, j, expected))
+        {
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  // Voxels out of the threshold are transparent
+  reslice->SetApplyThreshold(1);
+  reslice->SetLowerThreshold(-500.);
+  reslice->SetUpperThreshold(500.);
+  reslice->Update();
+  unsigned char* color = lut->MapValue(windowLevel(-999., window, level));
+  unsigned char expected[4] = {color[0], color[1], color[2], 0};
+  if (!checkPixel(output, 2, 0, expected))
+    {
+    return EXIT_FAILURE;
+    }
+  color = lut->MapValue(windowLevel(1., window, level));
+  expected[0] = color[0];
+  expected[1] = color[1];
+  expected[2] = color[2];
+  expected[3] = 255;
+  if (!checkPixel(output, 2, 5, expected))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // Linear interpolation halfway between 2 voxels along X
+  reslice->SetApplyThreshold(0);
+  reslice->SetInterpolationModeToLinear();
+  xyToIJK->Identity();
+  xyToIJK->Translate(0.5, 0., 1.);
+  reslice->Update();
+  color = lut->MapValue(windowLevel(-989., window, level));
+  expected[0] = color[0];
+  expected[1] = color[1];
+  expected[2] = color[2];
+  expected[3] = 255;
+  if (!checkPixel(output, 0, 0, expected))
+    {
+    return EXIT_FAILURE;
+    }
+  // the last column has no neighbor
+  unsigned char* lastPixel =
+    static_cast<unsigned char*>(output->GetScalarPointer(9, 0, 0));
+  if (lastPixel[3] != 0)
+    {
+    std::cerr << "Pixel (9, 0) should be transparent" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Low resolution preview: 2x2 blocks share the value of their first pixel
+  reslice->SetInterpolationModeToNearestNeighbor();
+  reslice->SetSampleStep(2);
+  xyToIJK->Identity();
+  xyToIJK->Translate(0., 0., 1.);
+  reslice->Update();
+  color = lut->MapValue(windowLevel(20 * (2 + 10 * 2) - 1000 + 1, window, level));
+  expected[0] = color[0];
+  expected[1] = color[1];
+  expected[2] = color[2];
+  expected[3] = 255;
+  if (!checkPixel(output, 2, 2, expected) ||
+      !checkPixel(output, 3, 2, expected) ||
+      !checkPixel(output, 2, 3, expected) ||
+      !checkPixel(output, 3, 3, expected))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // Cache: coming back to a slice doesn't recompute it, the neighbor slices
+  // are precomputed.
+  reslice->SetSampleStep(1);
+  reslice->SetCacheMemoryLimit(1024);
+  reslice->PrefetchOn();
+  reslice->Update();
+  xyToIJK->Identity();
+  xyToIJK->Translate(0., 0., 2.);
+  reslice->Update();
+  // slices k = 1 and k = 2, neighbors k = 0 and k = 3
+  if (reslice->GetNumberOfCachedSlices() != 4)
+    {
+    std::cerr << "Wrong number of cached slices: "
+              << reslice->GetNumberOfCachedSlices() << std::endl;
+    return EXIT_FAILURE;
+    }
+  xyToIJK->Identity();
+  xyToIJK->Translate(0., 0., 1.);
+  reslice->Update();
+  if (reslice->GetNumberOfCachedSlices() != 4)
+    {
+    std::cerr << "Slice k = 1 should be cached" << std::endl;
+    return EXIT_FAILURE;
+    }
+  color = lut->MapValue(windowLevel(20 * (3 + 10 * 4) - 1000 + 1, window, level));
+  expected[0] = color[0];
+  expected[1] = color[1];
+  expected[2] = color[2];
+  expected[3] = 255;
+  if (!checkPixel(output, 3, 4, expected))
+    {
+    return EXIT_FAILURE;
+    }
+  // a new lookup table invalidates the cached slices
+  lut->SetHueRange(0.5, 0.66);
+  lut->Build();
+  reslice->Update();
+  color = lut->MapValue(windowLevel(20 * (3 + 10 * 4) - 1000 + 1, window, level));
+  expected[0] = color[0];
+  expected[1] = color[1];
+  expected[2] = color[2];
+  if (!checkPixel(output, 3, 4, expected))
+    {
+    return EXIT_FAILURE;
+    }
+  // A filter computing the same slice reuses the output of the first one
+  reslice->ShareOutputOn();
+  reslice->Update();
+  vtkSmartPointer<vtkImageResliceMapToColors> linkedReslice =
+    vtkSmartPointer<vtkImageResliceMapToColors>::New();
+  linkedReslice->ShareOutputOn();
+  linkedReslice->SetInput(image);
+  linkedReslice->SetResliceTransform(xyToIJK);
+  linkedReslice->SetLookupTable(lut);
+  linkedReslice->SetWindow(window);
+  linkedReslice->SetLevel(level);
+  linkedReslice->SetOutputExtent(0, 11, 0, 9, 0, 0);
+  linkedReslice->Update();
+  if (!linkedReslice->GetOutputShared() ||
+      linkedReslice->GetOutput()->GetPointData()->GetScalars() !=
+      output->GetPointData()->GetScalars())
+    {
+    std::cerr << "The output of the linked filter should be shared" << std::endl;
+    return EXIT_FAILURE;
+    }
+  // different display parameters
+  linkedReslice->SetWindow(window / 2.);
+  linkedReslice->Update();
+  if (linkedReslice->GetOutputShared())
+    {
+    std::cerr << "The output should not be shared" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Lightbox: scrolling by one tile only computes the new tile
+  reslice->ShareOutputOff();
+  reslice->PrefetchOff();
+  reslice->SetCacheMemoryLimit(0);
+  reslice->SetOutputExtent(0, 9, 0, 9, 0, 1);
+  xyToIJK->Identity();
+  reslice->Update();
+  xyToIJK->Translate(0., 0., 1.);
+  reslice->Update();
+  for (int k = 0; k < 2; ++k)
+    {
+    color = lut->MapValue(windowLevel(20 * (3 + 10 * 4) - 1000 + k + 1, window, level));
+    unsigned char* pixel =
+      static_cast<unsigned char*>(output->GetScalarPointer(3, 4, k));
+    if (pixel[0] != color[0] || pixel[1] != color[1] || pixel[2] != color[2])
+      {
+      std::cerr << "Wrong lightbox tile " << k << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  reslice->ClearCache();
+  if (reslice->GetNumberOfCachedSlices() != 0)
+    {
+    std::cerr << "The cache should be empty" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,176 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRMLLogic includes
+#include "vtkImageResliceMask.h"
+
+// VTK includes
+#include <vtkGridTransform.h>
+#include <vtkImageData.h>
+#include <vtkSmartPointer.h>
+
+// STD includes
+#include <cmath>
+
+#include "vtkMRMLCoreTestingMacros.h"
+
+//----------------------------------------------------------------------------
+int vtkImageResliceMaskTest1(int , char * [] )
+{
+  vtkSmartPointer<vtkImageResliceMask> reslice =
+    vtkSmartPointer<vtkImageResliceMask>::New();
+  EXERCISE_BASIC_OBJECT_METHODS(reslice);
+
+  // 64x64x4 float image, value(i,j,k) = i + j
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(64, 64, 4);
+  image->SetScalarTypeToFloat();
+  image->SetNumberOfScalarComponents(1);
+  image->AllocateScalars();
+  float* ptr = static_cast<float*>(image->GetScalarPointer());
+  for (int k = 0; k < 4; ++k)
+    {
+    for (int j = 0; j < 64; ++j)
+      {
+      for (int i = 0; i < 64; ++i)
+        {
+        *ptr++ = static_cast<float>(i + j);
+        }
+      }
+    }
+
+  // Smooth displacement field of a few voxels
+  vtkSmartPointer<vtkImageData> displacements =
+    vtkSmartPointer<vtkImageData>::New();
+  displacements->SetDimensions(9, 9, 2);
+  displacements->SetSpacing(8., 8., 4.);
+  displacements->SetScalarTypeToDouble();
+  displacements->SetNumberOfScalarComponents(3);
+  displacements->AllocateScalars();
+  double* displacement = static_cast<double*>(displacements->GetScalarPointer());
+  for (int k = 0; k < 2; ++k)
+    {
+    for (int j = 0; j < 9; ++j)
+      {
+      for (int i = 0; i < 9; ++i, displacement += 3)
+        {
+        displacement[0] = 3. * sin(j / 3.);
+        displacement[1] = 2. * cos(i / 4.);
+        displacement[2] = 0.;
+        }
+      }
+    }
+  vtkSmartPointer<vtkGridTransform> transform =
+    vtkSmartPointer<vtkGridTransform>::New();
+  transform->SetDisplacementGrid(displacements);
+  transform->SetInterpolationModeToCubic();
+
+  reslice->SetInput(image);
+  reslice->SetResliceTransform(transform);
+  reslice->SetInterpolationModeToLinear();
+  reslice->SetOutputOrigin(0., 0., 1.);
+  reslice->SetOutputSpacing(1., 1., 1.);
+  reslice->SetOutputExtent(0, 63, 0, 63, 0, 0);
+  reslice->Update();
+
+  vtkSmartPointer<vtkImageData> exact = vtkSmartPointer<vtkImageData>::New();
+  exact->DeepCopy(reslice->GetOutput());
+
+  // The displacement grid approximation stays within the error bound. The
+  // intensity changes by 1 per voxel, the interpolation of the input adds
+  // some error. The borders where the samples may fall out of the input are
+  // not compared.
+  const double errorBound = 0.1;
+  reslice->SetTransformGridErrorBound(errorBound);
+  reslice->Update();
+  vtkImageData* output = reslice->GetOutput();
+  for (int j = 4; j < 60; ++j)
+    {
+    for (int i = 4; i < 60; ++i)
+      {
+      float* exactPixel = static_cast<float*>(exact->GetScalarPointer(i, j, 0));
+      float* pixel = static_cast<float*>(output->GetScalarPointer(i, j, 0));
+      if (fabs(*exactPixel - *pixel) > 2. * errorBound)
+        {
+        std::cerr << "Pixel (" << i << ", " << j << "): " << *pixel
+                  << " instead of " << *exactPixel << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  // A single component of an interleaved image is resliced, the output has
+  // one component: value(i,j,k,c) = 100 * c + i + j
+  vtkSmartPointer<vtkImageData> gradients = vtkSmartPointer<vtkImageData>::New();
+  gradients->SetDimensions(16, 16, 2);
+  gradients->SetScalarTypeToFloat();
+  gradients->SetNumberOfScalarComponents(3);
+  gradients->AllocateScalars();
+  ptr = static_cast<float*>(gradients->GetScalarPointer());
+  for (int k = 0; k < 2; ++k)
+    {
+    for (int j = 0; j < 16; ++j)
+      {
+      for (int i = 0; i < 16; ++i)
+        {
+        for (int c = 0; c < 3; ++c)
+          {
+          *ptr++ = static_cast<float>(100 * c + i + j);
+          }
+        }
+      }
+    }
+  vtkSmartPointer<vtkImageResliceMask> componentReslice =
+    vtkSmartPointer<vtkImageResliceMask>::New();
+  componentReslice->SetInput(gradients);
+  componentReslice->SetInterpolationModeToLinear();
+  componentReslice->SetOutputSpacing(1., 1., 1.);
+  componentReslice->SetOutputExtent(0, 14, 0, 14, 0, 0);
+  // Identity (permutation) and oblique (half voxel shift) samplings
+  for (int shift = 0; shift < 2; ++shift)
+    {
+    componentReslice->SetOutputOrigin(0.5 * shift, 0.5 * shift, 0.);
+    componentReslice->SetScalarComponent(2);
+    componentReslice->Update();
+    output = componentReslice->GetOutput();
+    if (output->GetNumberOfScalarComponents() != 1)
+      {
+      std::cerr << "vtkImageResliceMask::SetScalarComponent failed: "
+                << output->GetNumberOfScalarComponents()
+                << " components" << std::endl;
+      return EXIT_FAILURE;
+      }
+    for (int j = 0; j < 15; ++j)
+      {
+      for (int i = 0; i < 15; ++i)
+        {
+        float pixel = *static_cast<float*>(output->GetScalarPointer(i, j, 0));
+        float expected = 200.f + i + j + static_cast<float>(shift);
+        if (fabs(pixel - expected) > 1e-3)
+          {
+          std::cerr << "Component pixel (" << i << ", " << j << "): " << pixel
+                    << " instead of " << expected << std::endl;
+          return EXIT_FAILURE;
+          }
+        }
+      }
+    }
+  componentReslice->SetScalarComponent(-1);
+  componentReslice->Update();
+  if (componentReslice->GetOutput()->GetNumberOfScalarComponents() != 3)
+    {
+    std::cerr << "vtkImageResliceMask::SetScalarComponent(-1) failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -42,6 +42,7 @@ namespace
 bool TestPerformance();
 bool TestNodeIDs();
 bool TestDefaults();
+bool TestLazyNodes();
 bool TestCopy();
 }
 
@@ -52,6 +53,7 @@ int vtkMRMLColorLogicTest1(int vtkNotUsed(argc), char * vtkNotUsed(argv)[] )
   res = TestPerformance() && res;
   res = TestNodeIDs() && res;
   res = TestDefaults() && res;
+  res = TestLazyNodes() && res;
   res = TestCopy() && res;
   return res ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -187,6 +189,51 @@ bool TestDefaults()
   return true;
 }
 
+//----------------------------------------------------------------------------
+bool TestLazyNodes()
+{
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLColorLogic> colorLogic;
+  colorLogic->SetMRMLScene(scene.GetPointer());
+
+  vtkMRMLColorTableNode* greyNode = vtkMRMLColorTableNode::SafeDownCast(
+    scene->GetNodeByID(colorLogic->GetDefaultVolumeColorNodeID()));
+  if (!greyNode || !greyNode->GetLazyTypePending() ||
+      greyNode->GetType() != vtkMRMLColorTableNode::Grey)
+    {
+    std::cout << "The default color table nodes must be built when used"
+              << std::endl;
+    return false;
+    }
+  // The table is built on first use
+  if (greyNode->GetLookupTable() == 0 ||
+      greyNode->GetLazyTypePending() ||
+      greyNode->GetNumberOfColors() != 256)
+    {
+    std::cout << "Failed to build the lazy table of "
+              << greyNode->GetID() << std::endl;
+    return false;
+    }
+
+  vtkMRMLColorTableNode* labelsNode = vtkMRMLColorTableNode::SafeDownCast(
+    scene->GetNodeByID(
+      vtkMRMLColorLogic::GetColorTableNodeID(vtkMRMLColorTableNode::Labels)));
+  if (!labelsNode || !labelsNode->GetLazyTypePending())
+    {
+    std::cout << "The labels color node must be built when used" << std::endl;
+    return false;
+    }
+  // Asking for a color name builds the table (names included)
+  if (strcmp(labelsNode->GetColorName(0), "Black") != 0 ||
+      labelsNode->GetLazyTypePending())
+    {
+    std::cout << "Failed to build the lazy table of " << labelsNode->GetID()
+              << ": " << labelsNode->GetColorName(0) << std::endl;
+    return false;
+    }
+  return true;
+}
+
 //----------------------------------------------------------------------------
 bool TestCopy()
 {
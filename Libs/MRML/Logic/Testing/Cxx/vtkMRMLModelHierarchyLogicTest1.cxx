@@ -94,7 +94,46 @@ int vtkMRMLModelHierarchyLogicTest1(int , char * [] )
     std::cerr << "Getting hierarchy children nodes failed on " << hnode->GetID() << ", returned size of " << nodeList.size() << " instead of " << hNumChildrenNodes << ", as the hierarchy node reports" << std::endl;
     return EXIT_FAILURE;
     }
-  
+
+  // the hierarchy display node of collapsed hierarchies
+  vtkSmartPointer<vtkMRMLModelHierarchyNode> parentHNode = vtkSmartPointer<vtkMRMLModelHierarchyNode>::New();
+  scene->AddNode(parentHNode);
+  vtkSmartPointer<vtkMRMLModelDisplayNode> parentDNode = vtkSmartPointer<vtkMRMLModelDisplayNode>::New();
+  scene->AddNode(parentDNode);
+  parentHNode->SetAndObserveDisplayNodeID(parentDNode->GetID());
+  mhnode->SetParentNodeID(parentHNode->GetID());
+
+  if (modelHierarchyLogic->GetHierarchyDisplayNode(modelNode->GetID()) != 0)
+    {
+    std::cerr << "Expanded hierarchies should not have a hierarchy display node" << std::endl;
+    return EXIT_FAILURE;
+    }
+  mhnode->SetExpanded(0);
+  if (modelHierarchyLogic->GetHierarchyDisplayNode(modelNode->GetID()) != mdnode.GetPointer())
+    {
+    std::cerr << "Collapsing the model hierarchy failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  // the top most collapsed hierarchy wins
+  parentHNode->SetExpanded(0);
+  std::map<std::string, vtkMRMLDisplayNode*> displayNodes;
+  int numDisplayNodes = modelHierarchyLogic->GetHierarchyDisplayNodes(displayNodes);
+  if (numDisplayNodes != 1 ||
+      displayNodes[modelNode->GetID()] != parentDNode.GetPointer() ||
+      modelHierarchyLogic->GetHierarchyDisplayNode(modelNode->GetID()) != parentDNode.GetPointer())
+    {
+    std::cerr << "Collapsing the parent hierarchy failed, " << numDisplayNodes
+              << " hierarchy display nodes" << std::endl;
+    return EXIT_FAILURE;
+    }
+  mhnode->SetExpanded(1);
+  parentHNode->SetExpanded(1);
+  if (modelHierarchyLogic->GetHierarchyDisplayNodes(displayNodes) != 0)
+    {
+    std::cerr << "Expanding the hierarchies failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
   modelHierarchyLogic->Delete();
 
   return EXIT_SUCCESS;
@@ -0,0 +1,133 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRMLLogic includes
+#include "vtkMRMLSliceLayerLogic.h"
+
+// MRML includes
+#include <vtkMRMLScalarVolumeNode.h>
+#include <vtkMRMLScene.h>
+#include <vtkMRMLSliceNode.h>
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkSmartPointer.h>
+#include <vtkTransform.h>
+
+// STD includes
+#include <sstream>
+#include <string>
+
+#include "vtkMRMLCoreTestingMacros.h"
+
+int vtkMRMLSliceLayerLogicProbeTest(int , char * [] )
+{
+  vtkSmartPointer<vtkMRMLScene> scene = vtkSmartPointer<vtkMRMLScene>::New();
+
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(10, 10, 10);
+  image->SetScalarTypeToShort();
+  image->SetNumberOfScalarComponents(1);
+  image->AllocateScalars();
+  short* values = static_cast<short*>(image->GetScalarPointer());
+  for (int i = 0; i < 1000; ++i)
+    {
+    values[i] = static_cast<short>(i);
+    }
+  vtkSmartPointer<vtkMRMLScalarVolumeNode> volumeNode =
+    vtkSmartPointer<vtkMRMLScalarVolumeNode>::New();
+  volumeNode->SetAndObserveImageData(image);
+  scene->AddNode(volumeNode);
+
+  vtkSmartPointer<vtkMRMLSliceNode> sliceNode = vtkSmartPointer<vtkMRMLSliceNode>::New();
+  sliceNode->SetLayoutName("Red");
+  sliceNode->SetOrientationToAxial();
+  sliceNode->SetDimensions(20, 20, 1);
+  sliceNode->SetFieldOfView(20, 20, 1);
+  scene->AddNode(sliceNode);
+
+  vtkSmartPointer<vtkMRMLSliceLayerLogic> layerLogic =
+    vtkSmartPointer<vtkMRMLSliceLayerLogic>::New();
+  layerLogic->SetMRMLScene(scene);
+  layerLogic->SetSliceNode(sliceNode);
+  layerLogic->SetVolumeNode(volumeNode);
+  layerLogic->UpdateTransforms();
+
+  // find a position of the slice view mapping inside of the volume
+  double xyz[3] = {0., 0., 0.};
+  double ijk[3] = {0., 0., 0.};
+  bool found = false;
+  for (int y = 0; y < 20 && !found; ++y)
+    {
+    for (int x = 0; x < 20 && !found; ++x)
+      {
+      xyz[0] = x;
+      xyz[1] = y;
+      layerLogic->GetXYToIJKTransform()->TransformPoint(xyz, ijk);
+      found = ijk[0] > 0.5 && ijk[0] < 8.5 &&
+              ijk[1] > 0.5 && ijk[1] < 8.5 &&
+              ijk[2] > 0.5 && ijk[2] < 8.5;
+      }
+    }
+  if (!found)
+    {
+    std::cerr << "Line " << __LINE__ << " - No position inside of the volume" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (!layerLogic->Probe(xyz))
+    {
+    std::cerr << "Line " << __LINE__ << " - Probe() failed: "
+              << layerLogic->GetProbeString() << std::endl;
+    return EXIT_FAILURE;
+    }
+  int* probeIJK = layerLogic->GetProbeIJK();
+  int value = probeIJK[0] + 10 * probeIJK[1] + 100 * probeIJK[2];
+  vtkDataArray* probeValues = layerLogic->GetProbeValues();
+  std::stringstream expected;
+  expected << value;
+  if (probeValues == 0 ||
+      probeValues->GetDataType() != VTK_SHORT ||
+      probeValues->GetNumberOfTuples() != 1 ||
+      probeValues->GetComponent(0, 0) != value ||
+      expected.str() != layerLogic->GetProbeString())
+    {
+    std::cerr << "Line " << __LINE__ << " - Wrong probed value: "
+              << layerLogic->GetProbeString() << " instead of " << value << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // label maps are described by their label name
+  volumeNode->LabelMapOn();
+  layerLogic->Probe(xyz);
+  expected.str("");
+  expected << "Unknown (" << value << ")";
+  if (expected.str() != layerLogic->GetProbeString())
+    {
+    std::cerr << "Line " << __LINE__ << " - Wrong label: "
+              << layerLogic->GetProbeString() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  double outside[3] = {-1000., -1000., 0.};
+  if (layerLogic->Probe(outside) ||
+      std::string("Out of Frame") != layerLogic->GetProbeString() ||
+      layerLogic->GetProbeValues()->GetNumberOfTuples() != 0)
+    {
+    std::cerr << "Line " << __LINE__ << " - Probe() outside of the volume: "
+              << layerLogic->GetProbeString() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
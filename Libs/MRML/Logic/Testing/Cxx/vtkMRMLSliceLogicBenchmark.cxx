@@ -0,0 +1,603 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+/// Slice rendering benchmark.
+///
+/// Builds a scene with generated volumes, drives the slice offset of one or
+/// more vtkMRMLSliceLogic and updates their output image, as a slice view
+/// does when scrolling. The per-frame latency (p50, p95, p99...) and the
+/// number of heap allocations per frame are written as JSON on the standard
+/// output (or in the --output file), e.g.:
+///
+///   vtkMRMLSliceLogicBenchmark --size 256x256x128 --type short --layers 3
+///     --interpolation linear --layout conventional --frames 200
+///
+/// Run with --help for the list of options. A frame is the update of all the
+/// slice views of the layout for a new slice offset.
+
+// MRMLLogic includes
+#include <vtkMRMLSliceLayerLogic.h>
+#include <vtkMRMLSliceLogic.h>
+
+// MRML includes
+#include <vtkMRMLColorTableNode.h>
+#include <vtkMRMLLabelMapVolumeDisplayNode.h>
+#include <vtkMRMLScalarVolumeDisplayNode.h>
+#include <vtkMRMLScalarVolumeNode.h>
+#include <vtkMRMLScene.h>
+#include <vtkMRMLSliceCompositeNode.h>
+#include <vtkMRMLSliceNode.h>
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkMultiThreader.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------------
+// Allocation counters. With glibc, malloc is interposed so that the VTK
+// arrays (allocated with malloc) and operator new are both counted.
+// Elsewhere only operator new is counted. The counters are not atomic,
+// allocations made concurrently by the reslice threads may be missed.
+namespace
+{
+volatile unsigned long AllocationCount = 0;
+volatile unsigned long AllocatedBytes = 0;
+}
+
+#if defined(__GLIBC__)
+extern "C"
+{
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+
+void* malloc(size_t size)
+{
+  ++AllocationCount;
+  AllocatedBytes += size;
+  return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size)
+{
+  ++AllocationCount;
+  AllocatedBytes += count * size;
+  return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size)
+{
+  ++AllocationCount;
+  AllocatedBytes += size;
+  return __libc_realloc(ptr, size);
+}
+}
+#define ALLOCATION_COUNTER "malloc"
+#else
+void* operator new(size_t size) throw(std::bad_alloc)
+{
+  ++AllocationCount;
+  AllocatedBytes += size;
+  void* ptr = malloc(size ? size : 1);
+  if (ptr == 0)
+    {
+    throw std::bad_alloc();
+    }
+  return ptr;
+}
+
+void* operator new[](size_t size) throw(std::bad_alloc)
+{
+  return operator new(size);
+}
+
+void operator delete(void* ptr) throw()
+{
+  free(ptr);
+}
+
+void operator delete[](void* ptr) throw()
+{
+  free(ptr);
+}
+#define ALLOCATION_COUNTER "operator new"
+#endif
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+struct BenchmarkParameters
+{
+  BenchmarkParameters()
+    {
+    this->Dimensions[0] = this->Dimensions[1] = 256;
+    this->Dimensions[2] = 128;
+    this->ScalarType = VTK_SHORT;
+    this->Layers = 1;
+    this->Interpolation = "linear";
+    this->Layout = "single";
+    this->Views = 2;
+    this->ViewSize[0] = this->ViewSize[1] = 512;
+    this->Frames = 200;
+    this->Warmup = 10;
+    this->Threads = 0;
+    }
+  int Dimensions[3];
+  int ScalarType;
+  int Layers;
+  std::string Interpolation;
+  std::string Layout;
+  int Views;
+  int ViewSize[2];
+  int Frames;
+  int Warmup;
+  int Threads;
+  std::string Output;
+};
+
+//----------------------------------------------------------------------------
+void printUsage(const char* program)
+{
+  std::cout
+    << "Usage: " << program << " [options]\n"
+    << "  --size IxJxK             volume dimensions (default: 256x256x128)\n"
+    << "  --type T                 uchar, short, int, float or double"
+    << " (default: short)\n"
+    << "  --layers N               1: background, 2: + foreground,"
+    << " 3: + label (default: 1)\n"
+    << "  --interpolation M        nearest, linear or cubic (default: linear)\n"
+    << "  --layout L               single, conventional (axial, sagittal,"
+    << " coronal), compare (--views axial views) or lightbox (3x3)"
+    << " (default: single)\n"
+    << "  --views N                number of views of the compare layout"
+    << " (default: 2)\n"
+    << "  --view-size WxH          size of the slice views (default: 512x512)\n"
+    << "  --frames N               number of measured frames (default: 200)\n"
+    << "  --warmup N               number of frames not measured (default: 10)\n"
+    << "  --threads N              maximum number of threads (default: all)\n"
+    << "  --output file.json       write the results in a file\n";
+}
+
+//----------------------------------------------------------------------------
+bool parseSize(const char* text, int count, int* values)
+{
+  std::string size(text);
+  std::replace(size.begin(), size.end(), 'x', ' ');
+  std::istringstream stream(size);
+  for (int i = 0; i < count; ++i)
+    {
+    if (!(stream >> values[i]) || values[i] < 1)
+      {
+      return false;
+      }
+    }
+  return stream.eof();
+}
+
+//----------------------------------------------------------------------------
+bool parseArguments(int argc, char* argv[], BenchmarkParameters& parameters)
+{
+  for (int i = 1; i < argc; ++i)
+    {
+    std::string option(argv[i]);
+    if (option == "--help" || option == "-h")
+      {
+      return false;
+      }
+    if (i + 1 >= argc)
+      {
+      std::cerr << "Missing value for " << option << std::endl;
+      return false;
+      }
+    const char* value = argv[++i];
+    bool valid = true;
+    if (option == "--size")
+      {
+      valid = parseSize(value, 3, parameters.Dimensions);
+      }
+    else if (option == "--type")
+      {
+      std::string type(value);
+      parameters.ScalarType =
+        type == "uchar" ? VTK_UNSIGNED_CHAR :
+        type == "short" ? VTK_SHORT :
+        type == "int" ? VTK_INT :
+        type == "float" ? VTK_FLOAT :
+        type == "double" ? VTK_DOUBLE : -1;
+      valid = parameters.ScalarType != -1;
+      }
+    else if (option == "--layers")
+      {
+      parameters.Layers = atoi(value);
+      valid = parameters.Layers >= 1 && parameters.Layers <= 3;
+      }
+    else if (option == "--interpolation")
+      {
+      parameters.Interpolation = value;
+      valid = parameters.Interpolation == "nearest" ||
+        parameters.Interpolation == "linear" ||
+        parameters.Interpolation == "cubic";
+      }
+    else if (option == "--layout")
+      {
+      parameters.Layout = value;
+      valid = parameters.Layout == "single" ||
+        parameters.Layout == "conventional" ||
+        parameters.Layout == "compare" ||
+        parameters.Layout == "lightbox";
+      }
+    else if (option == "--views")
+      {
+      parameters.Views = atoi(value);
+      valid = parameters.Views >= 1;
+      }
+    else if (option == "--view-size")
+      {
+      valid = parseSize(value, 2, parameters.ViewSize);
+      }
+    else if (option == "--frames")
+      {
+      parameters.Frames = atoi(value);
+      valid = parameters.Frames >= 1;
+      }
+    else if (option == "--warmup")
+      {
+      parameters.Warmup = atoi(value);
+      valid = parameters.Warmup >= 0;
+      }
+    else if (option == "--threads")
+      {
+      parameters.Threads = atoi(value);
+      valid = parameters.Threads >= 1;
+      }
+    else if (option == "--output")
+      {
+      parameters.Output = value;
+      }
+    else
+      {
+      std::cerr << "Unknown option " << option << std::endl;
+      return false;
+      }
+    if (!valid)
+      {
+      std::cerr << "Invalid value for " << option << ": " << value << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// Smooth pattern with some structure in all the directions
+template <class T>
+void fillImage(T* ptr, const int dims[3], double amplitude, int labels)
+{
+  for (int k = 0; k < dims[2]; ++k)
+    {
+    for (int j = 0; j < dims[1]; ++j)
+      {
+      for (int i = 0; i < dims[0]; ++i)
+        {
+        if (labels)
+          {
+          *ptr++ = static_cast<T>(((i / 16 + j / 16 + k / 16) % labels));
+          continue;
+          }
+        const double value = sin(i * 0.05) + cos(j * 0.07) + sin(k * 0.11);
+        *ptr++ = static_cast<T>(amplitude * (value + 3.) / 6.);
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLScalarVolumeNode* addVolume(vtkMRMLScene* scene, const char* name,
+                                   const BenchmarkParameters& parameters,
+                                   bool labelMap)
+{
+  vtkSmartPointer<vtkImageData> imageData = vtkSmartPointer<vtkImageData>::New();
+  imageData->SetDimensions(parameters.Dimensions);
+  imageData->SetScalarType(labelMap ? VTK_UNSIGNED_CHAR : parameters.ScalarType);
+  imageData->SetNumberOfScalarComponents(1);
+  imageData->AllocateScalars();
+  const double amplitude =
+    imageData->GetScalarType() == VTK_UNSIGNED_CHAR ? 255. : 1000.;
+  switch (imageData->GetScalarType())
+    {
+    vtkTemplateMacro(fillImage(static_cast<VTK_TT*>(imageData->GetScalarPointer()),
+                               parameters.Dimensions, amplitude,
+                               labelMap ? 6 : 0));
+    }
+
+  vtkSmartPointer<vtkMRMLColorTableNode> colorNode =
+    vtkSmartPointer<vtkMRMLColorTableNode>::New();
+  if (labelMap)
+    {
+    colorNode->SetTypeToLabels();
+    }
+  else
+    {
+    colorNode->SetTypeToGrey();
+    }
+  scene->AddNode(colorNode);
+
+  vtkSmartPointer<vtkMRMLScalarVolumeDisplayNode> displayNode;
+  if (labelMap)
+    {
+    displayNode = vtkSmartPointer<vtkMRMLLabelMapVolumeDisplayNode>::New();
+    }
+  else
+    {
+    displayNode = vtkSmartPointer<vtkMRMLScalarVolumeDisplayNode>::New();
+    displayNode->SetAutoWindowLevel(0);
+    displayNode->SetWindowLevel(amplitude, amplitude / 2.);
+    displayNode->SetInterpolate(parameters.Interpolation != "nearest");
+    }
+  displayNode->SetAndObserveColorNodeID(colorNode->GetID());
+  scene->AddNode(displayNode);
+
+  vtkSmartPointer<vtkMRMLScalarVolumeNode> volumeNode =
+    vtkSmartPointer<vtkMRMLScalarVolumeNode>::New();
+  volumeNode->SetName(name);
+  volumeNode->SetLabelMap(labelMap ? 1 : 0);
+  // centered on the RAS origin
+  volumeNode->SetOrigin(-parameters.Dimensions[0] / 2.,
+                        -parameters.Dimensions[1] / 2.,
+                        -parameters.Dimensions[2] / 2.);
+  volumeNode->SetAndObserveImageData(imageData);
+  volumeNode->SetAndObserveDisplayNodeID(displayNode->GetID());
+  scene->AddNode(volumeNode);
+  return volumeNode;
+}
+
+//----------------------------------------------------------------------------
+// Nearest rank percentile of sorted values
+double percentile(const std::vector<double>& sortedValues, double p)
+{
+  size_t rank = static_cast<size_t>(ceil(p * sortedValues.size()));
+  rank = std::max(rank, static_cast<size_t>(1));
+  return sortedValues[std::min(rank, sortedValues.size()) - 1];
+}
+
+//----------------------------------------------------------------------------
+std::string scalarTypeName(int scalarType)
+{
+  switch (scalarType)
+    {
+    case VTK_UNSIGNED_CHAR: return "uchar";
+    case VTK_SHORT: return "short";
+    case VTK_INT: return "int";
+    case VTK_FLOAT: return "float";
+    case VTK_DOUBLE: return "double";
+    }
+  return "unknown";
+}
+
+}
+
+//----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+  BenchmarkParameters parameters;
+  if (!parseArguments(argc, argv, parameters))
+    {
+    printUsage(argv[0]);
+    return EXIT_FAILURE;
+    }
+  if (parameters.Threads > 0)
+    {
+    vtkMultiThreader::SetGlobalMaximumNumberOfThreads(parameters.Threads);
+    }
+
+  vtkSmartPointer<vtkMRMLScene> scene = vtkSmartPointer<vtkMRMLScene>::New();
+  vtkMRMLScalarVolumeNode* volumes[3] = {0, 0, 0};
+  volumes[0] = addVolume(scene, "background", parameters, false);
+  if (parameters.Layers >= 2)
+    {
+    volumes[1] = addVolume(scene, "foreground", parameters, false);
+    }
+  if (parameters.Layers >= 3)
+    {
+    volumes[2] = addVolume(scene, "label", parameters, true);
+    }
+
+  // One slice logic per view of the layout
+  const char* names[] = {"Red", "Yellow", "Green"};
+  const char* orientations[] = {"Axial", "Sagittal", "Coronal"};
+  int views = 1;
+  if (parameters.Layout == "conventional")
+    {
+    views = 3;
+    }
+  else if (parameters.Layout == "compare")
+    {
+    views = parameters.Views;
+    }
+  std::vector<vtkSmartPointer<vtkMRMLSliceLogic> > sliceLogics;
+  std::vector<double> offsetRanges;
+  for (int view = 0; view < views; ++view)
+    {
+    vtkSmartPointer<vtkMRMLSliceLogic> sliceLogic =
+      vtkSmartPointer<vtkMRMLSliceLogic>::New();
+    std::ostringstream name;
+    if (parameters.Layout == "compare")
+      {
+      name << "Compare" << view + 1;
+      }
+    else
+      {
+      name << names[view];
+      }
+    sliceLogic->SetName(name.str().c_str());
+    sliceLogic->SetMRMLScene(scene);
+    for (int layer = 0; layer < 3; ++layer)
+      {
+      vtkSmartPointer<vtkMRMLSliceLayerLogic> layerLogic =
+        vtkSmartPointer<vtkMRMLSliceLayerLogic>::New();
+      layerLogic->SetCubicRefinement(parameters.Interpolation == "cubic");
+      if (layer == 0)
+        {
+        sliceLogic->SetBackgroundLayer(layerLogic);
+        }
+      else if (layer == 1)
+        {
+        sliceLogic->SetForegroundLayer(layerLogic);
+        }
+      else
+        {
+        sliceLogic->SetLabelLayer(layerLogic);
+        }
+      }
+    vtkMRMLSliceNode* sliceNode = sliceLogic->GetSliceNode();
+    sliceNode->SetOrientation(
+      orientations[parameters.Layout == "conventional" ? view : 0]);
+    if (parameters.Layout == "lightbox")
+      {
+      sliceNode->SetLayoutGrid(3, 3);
+      }
+    vtkMRMLSliceCompositeNode* compositeNode = sliceLogic->GetSliceCompositeNode();
+    compositeNode->SetBackgroundVolumeID(volumes[0]->GetID());
+    if (volumes[1])
+      {
+      compositeNode->SetForegroundVolumeID(volumes[1]->GetID());
+      }
+    if (volumes[2])
+      {
+      compositeNode->SetLabelVolumeID(volumes[2]->GetID());
+      }
+    sliceLogic->ResizeSliceNode(parameters.ViewSize[0], parameters.ViewSize[1]);
+    sliceLogic->FitSliceToAll(parameters.ViewSize[0], parameters.ViewSize[1]);
+    double bounds[6];
+    sliceLogic->GetLowestVolumeSliceBounds(bounds);
+    offsetRanges.push_back(bounds[4]);
+    offsetRanges.push_back(bounds[5]);
+    sliceLogics.push_back(sliceLogic);
+    }
+
+  // Scroll back and forth through the volume
+  const int totalFrames = parameters.Warmup + parameters.Frames;
+  std::vector<double> latencies;
+  std::vector<double> allocations;
+  std::vector<double> allocatedBytes;
+  vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+  const int sweep = 50;
+  for (int frame = 0; frame < totalFrames; ++frame)
+    {
+    int step = frame % (2 * sweep);
+    step = step < sweep ? step : 2 * sweep - step;
+    const double t = (step + 0.5) / sweep;
+
+    const unsigned long allocationCount = AllocationCount;
+    const unsigned long bytes = AllocatedBytes;
+    timer->StartTimer();
+    for (int view = 0; view < views; ++view)
+      {
+      vtkMRMLSliceLogic* sliceLogic = sliceLogics[view];
+      const double offset = offsetRanges[2 * view] +
+        t * (offsetRanges[2 * view + 1] - offsetRanges[2 * view]);
+      sliceLogic->SetSliceOffset(offset);
+      vtkImageData* image = sliceLogic->GetImageData();
+      if (image == 0)
+        {
+        std::cerr << "No image for the view " << sliceLogic->GetName() << std::endl;
+        return EXIT_FAILURE;
+        }
+      image->Update();
+      }
+    timer->StopTimer();
+    if (frame < parameters.Warmup)
+      {
+      continue;
+      }
+    latencies.push_back(timer->GetElapsedTime() * 1000.);
+    allocations.push_back(static_cast<double>(AllocationCount - allocationCount));
+    allocatedBytes.push_back(static_cast<double>(AllocatedBytes - bytes));
+    }
+
+  std::vector<double> sortedLatencies(latencies);
+  std::sort(sortedLatencies.begin(), sortedLatencies.end());
+  double meanLatency = 0.;
+  double meanAllocations = 0.;
+  double meanBytes = 0.;
+  double maxAllocations = 0.;
+  for (size_t i = 0; i < latencies.size(); ++i)
+    {
+    meanLatency += latencies[i];
+    meanAllocations += allocations[i];
+    meanBytes += allocatedBytes[i];
+    maxAllocations = std::max(maxAllocations, allocations[i]);
+    }
+  meanLatency /= latencies.size();
+  meanAllocations /= latencies.size();
+  meanBytes /= latencies.size();
+
+  std::ostringstream json;
+  json << "{\n"
+       << "  \"benchmark\": \"vtkMRMLSliceLogicBenchmark\",\n"
+       << "  \"dimensions\": [" << parameters.Dimensions[0] << ", "
+       << parameters.Dimensions[1] << ", " << parameters.Dimensions[2] << "],\n"
+       << "  \"scalarType\": \"" << scalarTypeName(parameters.ScalarType) << "\",\n"
+       << "  \"layers\": " << parameters.Layers << ",\n"
+       << "  \"interpolation\": \"" << parameters.Interpolation << "\",\n"
+       << "  \"layout\": \"" << parameters.Layout << "\",\n"
+       << "  \"views\": " << views << ",\n"
+       << "  \"viewSize\": [" << parameters.ViewSize[0] << ", "
+       << parameters.ViewSize[1] << "],\n"
+       << "  \"threads\": " << vtkMultiThreader::GetGlobalDefaultNumberOfThreads() << ",\n"
+       << "  \"frames\": " << parameters.Frames << ",\n"
+       << "  \"latencyMs\": {\n"
+       << "    \"min\": " << sortedLatencies.front() << ",\n"
+       << "    \"mean\": " << meanLatency << ",\n"
+       << "    \"p50\": " << percentile(sortedLatencies, 0.50) << ",\n"
+       << "    \"p95\": " << percentile(sortedLatencies, 0.95) << ",\n"
+       << "    \"p99\": " << percentile(sortedLatencies, 0.99) << ",\n"
+       << "    \"max\": " << sortedLatencies.back() << "\n"
+       << "  },\n"
+       << "  \"allocationsPerFrame\": {\n"
+       << "    \"counter\": \"" << ALLOCATION_COUNTER << "\",\n"
+       << "    \"mean\": " << meanAllocations << ",\n"
+       << "    \"max\": " << maxAllocations << ",\n"
+       << "    \"meanBytes\": " << meanBytes << "\n"
+       << "  }\n"
+       << "}\n";
+
+  if (parameters.Output.empty())
+    {
+    std::cout << json.str();
+    }
+  else
+    {
+    std::ofstream output(parameters.Output.c_str());
+    if (!output)
+      {
+      std::cerr << "Can't write " << parameters.Output << std::endl;
+      return EXIT_FAILURE;
+      }
+    output << json.str();
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -19,6 +19,7 @@
 #include <archive_entry.h>
 
 // STD includes
+#include <cstdio>
 #include <cstring>
 #include <iostream>
 
@@ -214,6 +215,45 @@ long copy_data(struct archive *ar, struct archive *aw)
   return r;
 }
 
+// --------------------------------------------------------------------------
+// Size of the blocks read from the files and the archives.
+const size_t BLOCK_SIZE = 1024 * 1024;
+
+// --------------------------------------------------------------------------
+// Return true if the content of the file is already compressed, such files
+// are stored in a zip file instead of being deflated again. Volumes saved
+// as compressed .nrrd files are deflated in parallel by their writer.
+bool is_compressed_file(const char* fileName)
+{
+  std::string extension = vtksys::SystemTools::LowerCase(
+    vtksys::SystemTools::GetFilenameLastExtension(fileName));
+  if (extension == ".gz" || extension == ".bz2" || extension == ".zip" ||
+      extension == ".mgz" || extension == ".png" || extension == ".jpg" ||
+      extension == ".jpeg" || extension == ".mrb")
+    {
+    return true;
+    }
+  if (extension != ".nrrd")
+    {
+    return false;
+    }
+  // the encoding of the data is given by the header
+  FILE* fd = fopen(fileName, "rb");
+  if (!fd)
+    {
+    return false;
+    }
+  char header[4096];
+  size_t len = fread(header, sizeof(char), sizeof(header) - 1, fd);
+  fclose(fd);
+  header[len] = '\0';
+  std::string headerString(header, len);
+  std::string::size_type end = headerString.find("\n\n");
+  headerString = headerString.substr(0, end);
+  return headerString.find("\nencoding: gz") != std::string::npos ||
+         headerString.find("\nencoding: bz") != std::string::npos;
+}
+
 } // end of anonymous namespace
 
 //-----------------------------------------------------------------------------
@@ -309,7 +349,7 @@ bool extract_tar(const char* outFileName, bool verbose, bool extract, std::vecto
 //-----------------------------------------------------------------------------
 // creates a zip file with the full contents of the directory (recurses)
 // zip entries will include relative path of including tail of directoryToZip
-bool zip(const char* zipFileName, const char* directoryToZip)
+bool zip(const char* zipFileName, const char* directoryToZip, bool removeZippedFiles)
 {
 
   //
@@ -318,7 +358,9 @@ bool zip(const char* zipFileName, const char* directoryToZip)
   // - check arguments
   // - get a list of files using vtksys Glob
   // - create the archive
-  // -- go file-by-file and add chunks of data to the archive
+  // -- go file-by-file and add chunks of data to the archive,
+  //    already compressed files are stored as is
+  // -- remove the file once added if requested
   // - close up and return success
   //
 
@@ -351,8 +393,9 @@ bool zip(const char* zipFileName, const char* directoryToZip)
   // now zip it up using LibArchive
   struct archive *zipArchive;
   struct archive_entry *entry, *dirEntry;
-  char buff[BUFSIZ];
+  std::vector<char> buff(BLOCK_SIZE);
   size_t len;
+  bool success = true;
   // have to read the contents of the files to add them to the archive
   FILE *fd;
 
@@ -400,6 +443,9 @@ bool zip(const char* zipFileName, const char* directoryToZip)
               fileName);
     vtkArchiveTools::Message("Zip: adding rel:", relFileName.c_str());
     archive_entry_set_pathname(entry, relFileName.c_str());
+    // the compression is chosen for each entry
+    archive_write_set_format_option(zipArchive, "zip", "compression",
+      is_compressed_file(fileName) ? "store" : compression_type.c_str());
     // size is required, for now use the vtksys call though it uses struct stat 
     // and may not be portable
     unsigned long fileLength = vtksys::SystemTools::FileLength(fileName);
@@ -414,19 +460,31 @@ bool zip(const char* zipFileName, const char* directoryToZip)
     fd = fopen(fileName, "rb");
     if (!fd)
       {
-      vtkArchiveTools::Error("Zip: cannot open:", (*sit).c_str());
+      vtkArchiveTools::Error("Zip: cannot open:", fileName);
+      success = false;
       }
     else
       {
-      len = fread(buff, sizeof(char), sizeof(buff), fd);
+      len = fread(&buff[0], sizeof(char), buff.size(), fd);
       while ( len > 0 )
         {
-        archive_write_data(zipArchive, buff, len);
-        len = fread(buff, sizeof(char), sizeof(buff), fd);
+        if (archive_write_data(zipArchive, &buff[0], len) < 0)
+          {
+          vtkArchiveTools::Error("Zip: cannot write:", archive_error_string(zipArchive));
+          success = false;
+          break;
+          }
+        len = fread(&buff[0], sizeof(char), buff.size(), fd);
         }
       fclose(fd);
       }
     archive_entry_free(entry);
+
+    // the scratch space is released as the archive grows
+    if (success && removeZippedFiles)
+      {
+      vtksys::SystemTools::RemoveFile(fileName);
+      }
     }
 
   archive_write_close(zipArchive);
@@ -436,7 +494,7 @@ bool zip(const char* zipFileName, const char* directoryToZip)
     vtkArchiveTools::Error("Zip:", "error on close!");
     return false;
     }
-  return true;
+  return success;
 }
 
 //-----------------------------------------------------------------------------
@@ -446,12 +504,11 @@ bool unzip(const char* zipFileName, const char* destinationDirectory)
   //
   // Unziping the archive
   // - check that files and directories exist
-  // - cd to destination
   // - create an extracter from the file
   // - create a writer to disk
-  // - read all headers and data into disk
+  // - read all headers and data into disk, the entries are
+  //   written relative to the destination directory
   // - close up the archives
-  // - cd back to original directory
   //
 
   if ( !zipFileName || !destinationDirectory )
@@ -472,13 +529,9 @@ bool unzip(const char* zipFileName, const char* destinationDirectory)
     return false;
     }
 
-  std::string cwd = vtksys::SystemTools::GetCurrentWorkingDirectory(true);
-
-  if ( vtksys::SystemTools::ChangeDirectory(destinationDirectory) )
-    {
-    vtkArchiveTools::Error("Unzip:", "could not change to destination directory");
-    return false;
-    }
+  // the current directory is not changed: it is shared by all the threads
+  std::string destination =
+    vtksys::SystemTools::CollapseFullPath(destinationDirectory) + "/";
 
   struct archive *zipArchive;
   struct archive *diskDestination;
@@ -489,16 +542,22 @@ bool unzip(const char* zipFileName, const char* destinationDirectory)
   // we will typically have zip files, but support all archive types (why not?)
   archive_read_support_filter_all(zipArchive);
   archive_read_support_format_all(zipArchive);
-  // Note: the 10240 is just a suggested block size
-  result = archive_read_open_filename(zipArchive, zipFileName, 10240);
+  // Note: the block size is just a suggestion, large blocks
+  // mean fewer reads of big bundles
+  result = archive_read_open_filename(zipArchive, zipFileName, BLOCK_SIZE);
   if (result != ARCHIVE_OK)
     {
     vtkArchiveTools::Error("Unzip:", "Cannot open archive file");
+    archive_read_free(zipArchive);
     return false;
     }
 
   diskDestination = archive_write_disk_new();
   archive_write_disk_set_standard_lookup(diskDestination);
+  // entries can't be written outside of the destination directory
+  archive_write_disk_set_options(diskDestination,
+    ARCHIVE_EXTRACT_TIME | ARCHIVE_EXTRACT_SECURE_NODOTDOT |
+    ARCHIVE_EXTRACT_SECURE_SYMLINKS);
 
   for (;;)
     {
@@ -516,6 +575,18 @@ bool unzip(const char* zipFileName, const char* destinationDirectory)
         break;
         }
       }
+    std::string pathName = archive_entry_pathname(entry);
+    if (vtksys::SystemTools::FileIsFullPath(pathName.c_str()))
+      {
+      vtkArchiveTools::Error("Unzip: skipping absolute path", pathName.c_str());
+      continue;
+      }
+    archive_entry_copy_pathname(entry, (destination + pathName).c_str());
+    if (archive_entry_hardlink(entry))
+      {
+      std::string linkName = destination + archive_entry_hardlink(entry);
+      archive_entry_copy_hardlink(entry, linkName.c_str());
+      }
     result = archive_write_header(diskDestination, entry);
     if (result != ARCHIVE_OK)
       {
@@ -583,12 +654,5 @@ bool unzip(const char* zipFileName, const char* destinationDirectory)
     return false;
     }
 
-
-  if ( vtksys::SystemTools::ChangeDirectory(cwd.c_str()) )
-    {
-    vtkArchiveTools::Error("Unzip:", "could not change back to working directory");
-    return false;
-    }
-
   return (result == ARCHIVE_OK);
 }
@@ -33,9 +33,12 @@ VTK_MRML_LOGIC_EXPORT bool extract_tar(const char* outFileName, bool verbose, bo
 
 // creates a zip file with the full contents of the directory (recurses)
 // zip entries will include relative path of including tail of directoryToZip
-VTK_MRML_LOGIC_EXPORT bool zip(const char* zipFileName, const char* directoryToZip);
+// already compressed files (.nrrd with gzip encoding, .gz, .png...) are stored
+// if removeZippedFiles is true, each file is removed once it is in the zip file
+VTK_MRML_LOGIC_EXPORT bool zip(const char* zipFileName, const char* directoryToZip,
+                               bool removeZippedFiles = false);
 
-// unzips zip file into specified directory
+// unzips zip file into specified directory, the current directory is unchanged
 // (internally this supports many formats of archive, not just zip)
 VTK_MRML_LOGIC_EXPORT bool unzip(const char* zipFileName, const char *destinationDirectory);
 #ifdef __cplusplus
@@ -17,6 +17,10 @@
 #include "vtkObjectFactory.h"
 #include "vtkImageData.h"
 
+// STD includes
+#include <cstring>
+#include <vector>
+
 
 //------------------------------------------------------------------------------
 vtkCxxRevisionMacro(vtkImageLabelOutline, "$Revision$");
@@ -29,8 +33,10 @@ vtkImageLabelOutline::vtkImageLabelOutline()
 {
   this->Outline = 1;
   this->Background = 0;
+  this->Thickness = 0;
   this->HandleBoundaries = 1;
   this->SetNeighborTo8();
+  this->SetThickness(1);
 }
 
 
@@ -40,73 +46,104 @@ vtkImageLabelOutline::~vtkImageLabelOutline()
 
 }
 //----------------------------------------------------------------------------
+void vtkImageLabelOutline::SetThickness(int thickness)
+{
+  thickness = (thickness < 1 ? 1 : (thickness > 32 ? 32 : thickness));
+  if (this->Thickness == thickness)
+    {
+    return;
+    }
+  this->Thickness = thickness;
+  // The outline is computed in each slice: square neighborhood in the slice
+  const int size = 2 * thickness + 1;
+  this->SetKernelSize(size, size, 1);
+  memset(this->Mask, 1, size * size);
+  this->Mask[thickness * size + thickness] = 0;
+  this->Modified();
+}
 
+//----------------------------------------------------------------------------
+// Description:
+// Set uniform[x - outMin0] to 1 if the pixels of the input row within
+// thickness of x (clipped to [inMin0, inMax0]) all have the same value.
+template <class T>
+static void vtkImageLabelOutlineUniformRow(const T *inRow, vtkIdType inInc0,
+                                           int inMin0, int inMax0,
+                                           int outMin0, int outMax0,
+                                           int thickness,
+                                           std::vector<int>& runStarts,
+                                           std::vector<int>& runEnds,
+                                           unsigned char *uniform)
+{
+  // start and end of the run of identical pixels that contains each pixel
+  const int count = inMax0 - inMin0 + 1;
+  const T *pixel = inRow;
+  runStarts[0] = inMin0;
+  for (int i = 1; i < count; ++i, pixel += inInc0)
+    {
+    runStarts[i] = (pixel[inInc0] == *pixel) ? runStarts[i - 1] : inMin0 + i;
+    }
+  runEnds[count - 1] = inMax0;
+  for (int i = count - 2; i >= 0; --i, pixel -= inInc0)
+    {
+    runEnds[i] = (pixel[-inInc0] == *pixel) ? runEnds[i + 1] : inMin0 + i;
+    }
+  for (int x = outMin0; x <= outMax0; ++x)
+    {
+    const int left = (x - thickness > inMin0) ? x - thickness : inMin0;
+    const int right = (x + thickness < inMax0) ? x + thickness : inMax0;
+    *uniform++ = (runStarts[x - inMin0] <= left && runEnds[x - inMin0] >= right);
+    }
+}
 
+//----------------------------------------------------------------------------
 // Description:
 // This templated function executes the filter for any type of data.
+// A labeled pixel is kept if any pixel of the same slice within thickness
+// (square neighborhood, clipped to the image) has a different value.
+// The rows are streamed: the horizontal uniformity of each input row is
+// computed once and kept in a ring buffer of 2*thickness+1 rows, a pixel
+// is then interior if it is uniform and equal in the rows of its window.
 template <class T>
 static void vtkImageLabelOutlineExecute(vtkImageLabelOutline *self,
-                     vtkImageData *inData, T *inPtr,
+                     vtkImageData *inData, T *vtkNotUsed(inPtr),
                      vtkImageData *outData,
                      int outExt[6], int id)
 {
-  // For looping though output (and input) pixels.
-  int outMin0, outMax0, outMin1, outMax1, outMin2, outMax2;
-  int outIdx0, outIdx1, outIdx2;
-  vtkIdType inInc0, inInc1, inInc2;
-  vtkIdType outInc0, outInc1, outInc2;
-  T *inPtr0, *inPtr1, *inPtr2;
-  T *outPtr0, *outPtr1, *outPtr2;
-  // For looping through hood pixels
-  int hoodMin0, hoodMax0, hoodMin1, hoodMax1, hoodMin2, hoodMax2;
-  int hoodIdx0, hoodIdx1, hoodIdx2;
-  T *hoodPtr0, *hoodPtr1, *hoodPtr2;
-  // For looping through the mask.
-  unsigned char *maskPtr, *maskPtr0, *maskPtr1, *maskPtr2;
-  vtkIdType maskInc0, maskInc1, maskInc2;
-  // The extent of the whole input image
-  int inImageMin0, inImageMin1, inImageMin2;
-  int inImageMax0, inImageMax1, inImageMax2;
-  // Other
-  T backgnd = (T)(self->GetBackground());
-  T pix;
-  T *outPtr = (T*)outData->GetScalarPointerForExtent(outExt);
-  unsigned long count = 0;
-  unsigned long target;
+  const int thickness = self->GetThickness();
+  const T backgnd = (T)(self->GetBackground());
 
-  // Get information to march through data
-  
+  // The neighbors outside of the input (i.e. outside the whole extent) are
+  // ignored.
+  int inExt[6];
+  inData->GetExtent(inExt);
+  const int inMin0 = (outExt[0] - thickness > inExt[0]) ? outExt[0] - thickness : inExt[0];
+  const int inMax0 = (outExt[1] + thickness < inExt[1]) ? outExt[1] + thickness : inExt[1];
+  const int inMin1 = (outExt[2] - thickness > inExt[2]) ? outExt[2] - thickness : inExt[2];
+  const int inMax1 = (outExt[3] + thickness < inExt[3]) ? outExt[3] + thickness : inExt[3];
+
+  vtkIdType inInc0, inInc1, inInc2;
   inData->GetIncrements(inInc0, inInc1, inInc2);
-  self->GetInput()->GetWholeExtent(inImageMin0, inImageMax0, inImageMin1,
-    inImageMax1, inImageMin2, inImageMax2);  
+  vtkIdType outInc0, outInc1, outInc2;
   outData->GetIncrements(outInc0, outInc1, outInc2);
-  outMin0 = outExt[0];   outMax0 = outExt[1];
-  outMin1 = outExt[2];   outMax1 = outExt[3];
-  outMin2 = outExt[4];   outMax2 = outExt[5];
-
-  // Neighborhood around current voxel
-  self->GetRelativeHoodExtent(hoodMin0, hoodMax0, hoodMin1,
-    hoodMax1, hoodMin2, hoodMax2);
 
-  // Set up mask info
-  maskPtr = (unsigned char *)(self->GetMaskPointer());
-  self->GetMaskIncrements(maskInc0, maskInc1, maskInc2);
+  const int width = outExt[1] - outExt[0] + 1;
+  const int ringSize = 2 * thickness + 1;
+  // first row of the ring buffer, keeps the ring index positive
+  const int ringOrigin = outExt[2] - thickness;
+  std::vector<unsigned char> uniform(ringSize * width);
+  std::vector<int> runStarts(inMax0 - inMin0 + 1);
+  std::vector<int> runEnds(inMax0 - inMin0 + 1);
 
-  // in and out should be marching through corresponding pixels.
-  inPtr = (T *)(inData->GetScalarPointer(outMin0, outMin1, outMin2));
-
-  target = (unsigned long)((outMax2-outMin2+1)*(outMax1-outMin1+1)/50.0);
+  unsigned long count = 0;
+  unsigned long target =
+    (unsigned long)((outExt[5]-outExt[4]+1)*(outExt[3]-outExt[2]+1)/50.0);
   target++;
 
-  // loop through pixels of output
-  outPtr2 = outPtr;
-  inPtr2 = inPtr;
-  for (outIdx2 = outMin2; outIdx2 <= outMax2; outIdx2++)
+  for (int z = outExt[4]; z <= outExt[5]; ++z)
     {
-    outPtr1 = outPtr2;
-    inPtr1 = inPtr2;
-    for (outIdx1 = outMin1;
-      !self->AbortExecute && outIdx1 <= outMax1; outIdx1++)
+    int nextRow = inMin1;
+    for (int y = outExt[2]; !self->AbortExecute && y <= outExt[3]; ++y)
       {
       if (!id)
         {
@@ -116,67 +153,40 @@ static void vtkImageLabelOutlineExecute(vtkImageLabelOutline *self,
           }
         count++;
         }
-      outPtr0 = outPtr1;
-      inPtr0 = inPtr1;
-      for (outIdx0 = outMin0; outIdx0 <= outMax0; outIdx0++)
+      const int firstRow = (y - thickness > inMin1) ? y - thickness : inMin1;
+      const int lastRow = (y + thickness < inMax1) ? y + thickness : inMax1;
+      for (; nextRow <= lastRow; ++nextRow)
         {
-        pix = *inPtr0;
-        // Default output equal to backgnd
-        *outPtr0 = backgnd;
+        vtkImageLabelOutlineUniformRow(
+          (T *)inData->GetScalarPointer(inMin0, nextRow, z), inInc0,
+          inMin0, inMax0, outExt[0], outExt[1], thickness,
+          runStarts, runEnds,
+          &uniform[((nextRow - ringOrigin) % ringSize) * width]);
+        }
 
-        if (pix != backgnd)
+      const T *inRow = (T *)inData->GetScalarPointer(outExt[0], y, z);
+      T *outRow = (T *)outData->GetScalarPointer(outExt[0], y, z);
+      for (int x = 0; x < width; ++x, inRow += inInc0, outRow += outInc0)
+        {
+        const T pix = *inRow;
+        *outRow = backgnd;
+        if (pix == backgnd)
+          {
+          continue;
+          }
+        const T *neighbor = inRow + (firstRow - y) * inInc1;
+        for (int row = firstRow; row <= lastRow; ++row, neighbor += inInc1)
           {
-          // Loop through neighborhood pixels (kernel radius=1)
-          // Note: input pointer marches out of bounds.
-          //hoodPtr2 = inPtr0 - inInc0 - inInc1 - inInc2;
-          hoodPtr2 = inPtr0 + inInc0*hoodMin0 + inInc1*hoodMin1
-            + inInc2*hoodMin2;
-          maskPtr2 = maskPtr;
-          for (hoodIdx2 = hoodMin2; hoodIdx2 <= hoodMax2; ++hoodIdx2)
+          if (*neighbor != pix ||
+              !uniform[((row - ringOrigin) % ringSize) * width + x])
             {
-            hoodPtr1 = hoodPtr2;
-            maskPtr1 = maskPtr2;
-            for (hoodIdx1 = hoodMin1; hoodIdx1 <= hoodMax1;    ++hoodIdx1)
-              {
-              hoodPtr0 = hoodPtr1;
-              maskPtr0 = maskPtr1;
-              for (hoodIdx0 = hoodMin0; hoodIdx0 <= hoodMax0; ++hoodIdx0)
-                {
-                if (*maskPtr0)
-                  {
-                  // handle boundaries
-                  if (outIdx0 + hoodIdx0 >= inImageMin0 &&
-                    outIdx0 + hoodIdx0 <= inImageMax0 &&
-                    outIdx1 + hoodIdx1 >= inImageMin1 &&
-                    outIdx1 + hoodIdx1 <= inImageMax1 &&
-                    outIdx2 + hoodIdx2 >= inImageMin2 &&
-                    outIdx2 + hoodIdx2 <= inImageMax2)
-                    {
-                    // If the neighbor not identical, use this pixel
-                    // (set the output to foreground)
-                    if (*hoodPtr0 != pix)
-                      *outPtr0 = pix;
-                    }
-                  }
-                hoodPtr0 += inInc0;
-                maskPtr0 += maskInc0;
-                }//for0
-              hoodPtr1 += inInc1;
-              maskPtr1 += maskInc1;
-              }//for1
-            hoodPtr2 += inInc2;
-            maskPtr2 += maskInc2;
-            }//for2
-          }//if
-        inPtr0 += inInc0;
-        outPtr0 += outInc0;
-        }//for0
-      inPtr1 += inInc1;
-      outPtr1 += outInc1;
-      }//for1
-    inPtr2 += inInc2;
-    outPtr2 += outInc2;
-    }//for2
+            *outRow = pix;
+            break;
+            }
+          }
+        }
+      }
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -256,6 +266,7 @@ void vtkImageLabelOutline::PrintSelf(ostream& os, vtkIndent indent)
 
     os << indent << "Outline: " << this->Outline << "\n";
     os << indent << "Background: " << this->Background<< "\n";
+    os << indent << "Thickness: " << this->Thickness << "\n";
 
     if (this->GetInput() != NULL)
       {
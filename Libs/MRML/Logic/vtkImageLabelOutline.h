@@ -25,6 +25,10 @@ class vtkImageData;
 ///
 /// Used  in slicer for the Label layer to outline the segmented
 /// structures (instead of showing them filled-in).
+/// A labeled pixel is part of the outline if a pixel of the same slice
+/// within Thickness pixels has a different label. Each slice (XY plane) of
+/// the input is outlined independently, the rows are processed in a single
+/// streaming pass threaded over the output extent.
 class VTK_MRML_LOGIC_EXPORT vtkImageLabelOutline : public vtkImageNeighborhoodFilter
 {
 public:
@@ -42,12 +46,18 @@ public:
   vtkSetMacro(Outline, int);
   vtkGetMacro(Outline, int);
 
+  /// 
+  /// Thickness in pixels of the outline, between 1 and 32 (default: 1).
+  void SetThickness(int thickness);
+  vtkGetMacro(Thickness, int);
+
 protected:
   vtkImageLabelOutline();
   ~vtkImageLabelOutline();
 
   float Background;
   int Outline;
+  int Thickness;
 
   void ThreadedExecute(vtkImageData *inData, vtkImageData *outData,
   int extent[6], int id);
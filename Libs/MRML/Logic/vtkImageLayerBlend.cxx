@@ -0,0 +1,232 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRMLLogic includes
+#include "vtkImageLayerBlend.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkObjectFactory.h>
+
+// STD includes
+#include <cstring>
+#include <vector>
+
+vtkCxxRevisionMacro(vtkImageLayerBlend, "$Revision$");
+vtkStandardNewMacro(vtkImageLayerBlend);
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Exact rounded division by 255 of a value in [0, 255*255]
+inline unsigned int vtkImageLayerBlendDiv255(unsigned int value)
+{
+  value += 128;
+  return (value + (value >> 8)) >> 8;
+}
+
+//----------------------------------------------------------------------------
+// Blend count RGBA pixels of layer over output, weight is opacity * alpha
+void vtkImageLayerBlendRow(const unsigned char* layer, unsigned char* output,
+                           unsigned int opacity, int count)
+{
+  for (int i = 0; i < count; ++i, layer += 4, output += 4)
+    {
+    const unsigned int weight = vtkImageLayerBlendDiv255(opacity * layer[3]);
+    if (weight == 0)
+      {
+      continue;
+      }
+    if (weight == 255)
+      {
+      output[0] = layer[0];
+      output[1] = layer[1];
+      output[2] = layer[2];
+      continue;
+      }
+    const unsigned int remainder = 255 - weight;
+    output[0] = static_cast<unsigned char>(
+      vtkImageLayerBlendDiv255(layer[0] * weight + output[0] * remainder));
+    output[1] = static_cast<unsigned char>(
+      vtkImageLayerBlendDiv255(layer[1] * weight + output[1] * remainder));
+    output[2] = static_cast<unsigned char>(
+      vtkImageLayerBlendDiv255(layer[2] * weight + output[2] * remainder));
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkImageLayerBlendAddRow(const unsigned char* layer0,
+                              const unsigned char* layer1,
+                              unsigned char* output, int count)
+{
+  for (int i = 0; i < 4 * count; ++i)
+    {
+    const int value = layer1[i] + layer0[i];
+    output[i] = static_cast<unsigned char>(value > 255 ? 255 : value);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkImageLayerBlendSubtractRow(const unsigned char* layer0,
+                                   const unsigned char* layer1,
+                                   unsigned char* output, int count)
+{
+  for (int i = 0; i < count; ++i, layer0 += 4, layer1 += 4, output += 4)
+    {
+    for (int c = 0; c < 3; ++c)
+      {
+      const int value = layer1[c] - layer0[c];
+      output[c] = static_cast<unsigned char>(value < 0 ? 0 : value);
+      }
+    // keep the pixel visible if it is visible in any of the layers
+    output[3] = layer1[3] > layer0[3] ? layer1[3] : layer0[3];
+    }
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+vtkImageLayerBlend::vtkImageLayerBlend()
+{
+  this->Compositing = vtkImageLayerBlend::Alpha;
+}
+
+//----------------------------------------------------------------------------
+vtkImageLayerBlend::~vtkImageLayerBlend()
+{
+}
+
+//----------------------------------------------------------------------------
+void vtkImageLayerBlend::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+
+  os << indent << "Compositing: " << this->Compositing << "\n";
+}
+
+//----------------------------------------------------------------------------
+bool vtkImageLayerBlend::CanBlendLayers(vtkImageData** layers,
+                                        int numberOfLayers,
+                                        vtkImageData* output, int ext[6])
+{
+  if (this->GetBlendMode() != VTK_IMAGE_BLEND_MODE_NORMAL ||
+      this->GetStencil() != 0 ||
+      output->GetScalarType() != VTK_UNSIGNED_CHAR ||
+      output->GetNumberOfScalarComponents() != 4)
+    {
+    return false;
+    }
+  for (int i = 0; i < numberOfLayers; ++i)
+    {
+    vtkImageData* layer = layers[i];
+    if (layer == 0)
+      {
+      continue;
+      }
+    if (layer->GetScalarType() != VTK_UNSIGNED_CHAR ||
+        layer->GetNumberOfScalarComponents() != 4)
+      {
+      return false;
+      }
+    int* layerExt = layer->GetExtent();
+    if (layerExt[0] > ext[0] || layerExt[1] < ext[1] ||
+        layerExt[2] > ext[2] || layerExt[3] < ext[3] ||
+        layerExt[4] > ext[4] || layerExt[5] < ext[5])
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageLayerBlend::ThreadedRequestData(vtkInformation *request,
+                                             vtkInformationVector **inputVector,
+                                             vtkInformationVector *outputVector,
+                                             vtkImageData ***inData,
+                                             vtkImageData **outData,
+                                             int outExt[6], int id)
+{
+  const int numberOfInputs = this->GetNumberOfInputConnections(0);
+  if (!this->CanBlendLayers(inData[0], numberOfInputs, outData[0], outExt))
+    {
+    this->Superclass::ThreadedRequestData(request, inputVector, outputVector,
+                                          inData, outData, outExt, id);
+    return;
+    }
+
+  // Collect the non empty layers and their 8 bit opacity
+  std::vector<vtkImageData*> layers;
+  std::vector<unsigned int> opacities;
+  for (int i = 0; i < numberOfInputs; ++i)
+    {
+    if (inData[0][i] == 0)
+      {
+      continue;
+      }
+    double opacity = this->GetOpacity(i);
+    opacity = opacity < 0. ? 0. : (opacity > 1. ? 1. : opacity);
+    layers.push_back(inData[0][i]);
+    opacities.push_back(static_cast<unsigned int>(opacity * 255. + 0.5));
+    }
+  if (layers.empty())
+    {
+    return;
+    }
+  const int numberOfLayers = static_cast<int>(layers.size());
+  int firstBlendedLayer = 1;
+  if (this->Compositing != vtkImageLayerBlend::Alpha && numberOfLayers >= 2)
+    {
+    firstBlendedLayer = 2;
+    }
+
+  const int rowLength = outExt[1] - outExt[0] + 1;
+  const size_t rowSize = 4 * rowLength;
+  vtkImageData* output = outData[0];
+  for (int z = outExt[4]; z <= outExt[5]; ++z)
+    {
+    for (int y = outExt[2]; y <= outExt[3]; ++y)
+      {
+      unsigned char* outRow = static_cast<unsigned char*>(
+        output->GetScalarPointer(outExt[0], y, z));
+      const unsigned char* firstRow = static_cast<unsigned char*>(
+        layers[0]->GetScalarPointer(outExt[0], y, z));
+      if (firstBlendedLayer == 2)
+        {
+        const unsigned char* secondRow = static_cast<unsigned char*>(
+          layers[1]->GetScalarPointer(outExt[0], y, z));
+        if (this->Compositing == vtkImageLayerBlend::Add)
+          {
+          vtkImageLayerBlendAddRow(firstRow, secondRow, outRow, rowLength);
+          }
+        else
+          {
+          vtkImageLayerBlendSubtractRow(firstRow, secondRow, outRow, rowLength);
+          }
+        }
+      else if (firstRow != outRow)
+        {
+        memcpy(outRow, firstRow, rowSize);
+        }
+      for (int i = firstBlendedLayer; i < numberOfLayers; ++i)
+        {
+        if (opacities[i] == 0)
+          {
+          continue;
+          }
+        vtkImageLayerBlendRow(static_cast<unsigned char*>(
+                                layers[i]->GetScalarPointer(outExt[0], y, z)),
+                              outRow, opacities[i], rowLength);
+        }
+      }
+    }
+}
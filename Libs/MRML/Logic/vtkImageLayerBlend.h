@@ -0,0 +1,82 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#ifndef __vtkImageLayerBlend_h
+#define __vtkImageLayerBlend_h
+
+#include "vtkMRMLLogicWin32Header.h"
+
+// VTK includes
+#include <vtkImageBlend.h>
+
+/// \brief Composite any number of RGBA layers with 8 bit fixed point math.
+///
+/// vtkImageLayerBlend is a drop-in replacement of vtkImageBlend for the
+/// slice views: the layers are the connections of the input port
+/// (SetInput(idx, image)) and each layer has an opacity (SetOpacity()).
+/// The first layer is copied to the output and the next ones are
+/// blended over it with a weight of opacity * alpha. As in vtkImageBlend,
+/// the output alpha is the alpha of the first layer.
+/// When all the layers are 4 components unsigned char images covering the
+/// output extent (the output of the slice layers), the blending is done
+/// with integer arithmetic, row by row, for all the layers at once. Layers
+/// with another scalar type or number of components, a stencil or the
+/// compound blend mode fall back to vtkImageBlend.
+///
+/// The Add and Subtract compositing modes combine the first two layers
+/// (layer1 + layer0 or layer1 - layer0, saturated) before blending the other
+/// layers. The opacity of the second layer is then ignored. The compositing
+/// modes are only supported by the fixed point path.
+/// \sa vtkImageBlend, vtkMRMLSliceCompositeNode
+class VTK_MRML_LOGIC_EXPORT vtkImageLayerBlend : public vtkImageBlend
+{
+public:
+  static vtkImageLayerBlend *New();
+  vtkTypeRevisionMacro(vtkImageLayerBlend, vtkImageBlend);
+  virtual void PrintSelf(ostream& os, vtkIndent indent);
+
+  enum
+    {
+    Alpha = 0,
+    Add,
+    Subtract
+    };
+
+  /// How the first two layers are combined (default: Alpha).
+  vtkSetClampMacro(Compositing, int, Alpha, Subtract);
+  vtkGetMacro(Compositing, int);
+  void SetCompositingToAlpha() {this->SetCompositing(Alpha);};
+  void SetCompositingToAdd() {this->SetCompositing(Add);};
+  void SetCompositingToSubtract() {this->SetCompositing(Subtract);};
+
+protected:
+  vtkImageLayerBlend();
+  ~vtkImageLayerBlend();
+
+  virtual void ThreadedRequestData(vtkInformation *request,
+                                   vtkInformationVector **inputVector,
+                                   vtkInformationVector *outputVector,
+                                   vtkImageData ***inData,
+                                   vtkImageData **outData,
+                                   int ext[6], int id);
+
+  /// Return true if the layers can be blended with the fixed point path
+  bool CanBlendLayers(vtkImageData** layers, int numberOfLayers,
+                      vtkImageData* output, int ext[6]);
+
+  int Compositing;
+
+private:
+  vtkImageLayerBlend(const vtkImageLayerBlend&);  /// Not implemented.
+  void operator=(const vtkImageLayerBlend&);  /// Not implemented.
+};
+
+#endif
@@ -0,0 +1,1247 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// MRMLLogic includes
+#include "vtkImageResliceMapToColors.h"
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkHomogeneousTransform.h>
+#include <vtkImageData.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkMatrix4x4.h>
+#include <vtkMultiThreader.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkScalarsToColors.h>
+#include <vtkSmartPointer.h>
+#include <vtkStreamingDemandDrivenPipeline.h>
+#include <vtkTypeTraits.h>
+
+// STD includes
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <list>
+
+// turn off 64-bit ints when templating over all types
+# undef VTK_USE_INT64
+# define VTK_USE_INT64 0
+# undef VTK_USE_UINT64
+# define VTK_USE_UINT64 0
+
+vtkCxxRevisionMacro(vtkImageResliceMapToColors, "$Revision$");
+vtkStandardNewMacro(vtkImageResliceMapToColors);
+vtkCxxSetObjectMacro(vtkImageResliceMapToColors, ResliceTransform, vtkAbstractTransform);
+vtkCxxSetObjectMacro(vtkImageResliceMapToColors, LookupTable, vtkScalarsToColors);
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Same rounding as vtkResliceRound() in vtkImageResliceMask
+inline int vtkResliceMapToColorsRound(double x)
+{
+  return static_cast<int>(floor(x + 0.5));
+}
+
+//----------------------------------------------------------------------------
+// Same conversion as vtkResliceClamp(): integer types are clamped and
+// rounded, floating point types are copied.
+template <class T>
+inline void vtkResliceMapToColorsClamp(double val, T& clamp)
+{
+  if (val < static_cast<double>(vtkTypeTraits<T>::Min()))
+    {
+    val = static_cast<double>(vtkTypeTraits<T>::Min());
+    }
+  if (val > static_cast<double>(vtkTypeTraits<T>::Max()))
+    {
+    val = static_cast<double>(vtkTypeTraits<T>::Max());
+    }
+  clamp = static_cast<T>(floor(val + 0.5));
+}
+inline void vtkResliceMapToColorsClamp(double val, float& clamp)
+{
+  clamp = static_cast<float>(val);
+}
+inline void vtkResliceMapToColorsClamp(double val, double& clamp)
+{
+  clamp = val;
+}
+
+//----------------------------------------------------------------------------
+// Luminance mapping of vtkImageMapToWindowLevelColors (no lookup table).
+template <class T>
+class vtkWindowLevelMapping
+{
+public:
+  void Initialize(double window, double level)
+  {
+    const double range[2] = {static_cast<double>(vtkTypeTraits<T>::Min()),
+                             static_cast<double>(vtkTypeTraits<T>::Max())};
+    double lower = level - fabs(window) / 2.0;
+    double upper = lower + fabs(window);
+    double adjustedLower = lower < range[0] ? range[0] :
+                           (lower > range[1] ? range[1] : lower);
+    double adjustedUpper = upper < range[0] ? range[0] :
+                           (upper > range[1] ? range[1] : upper);
+    this->Lower = static_cast<T>(adjustedLower);
+    this->Upper = static_cast<T>(adjustedUpper);
+    this->Shift = window / 2.0 - level;
+    this->Scale = window != 0. ? 255.0 / window : 0.;
+    if (window == 0.)
+      {
+      this->LowerValue = 0;
+      this->UpperValue = 255;
+      return;
+      }
+    double lowerValue = 255.0 * (adjustedLower - lower) / window;
+    double upperValue = 255.0 * (adjustedUpper - lower) / window;
+    if (window < 0)
+      {
+      lowerValue += 255.0;
+      upperValue += 255.0;
+      }
+    this->LowerValue = ToUnsignedChar(lowerValue);
+    this->UpperValue = ToUnsignedChar(upperValue);
+  }
+
+  inline unsigned char Map(T value) const
+  {
+    if (value <= this->Lower)
+      {
+      return this->LowerValue;
+      }
+    if (value >= this->Upper)
+      {
+      return this->UpperValue;
+      }
+    return static_cast<unsigned char>((value + this->Shift) * this->Scale);
+  }
+
+private:
+  static unsigned char ToUnsignedChar(double value)
+  {
+    return value > 255. ? 255 :
+      (value < 0. ? 0 : static_cast<unsigned char>(value));
+  }
+
+  T Lower;
+  T Upper;
+  unsigned char LowerValue;
+  unsigned char UpperValue;
+  double Shift;
+  double Scale;
+};
+
+//----------------------------------------------------------------------------
+// Everything needed to map a voxel value to RGBA.
+template <class T>
+class vtkResliceColorMapping
+{
+public:
+  vtkResliceColorMapping(double window, double level,
+                         int applyThreshold, double lower, double upper,
+                         const unsigned char* colorTable,
+                         const unsigned char* valueTable)
+  {
+    this->WindowLevel.Initialize(window, level);
+    this->ApplyThreshold = applyThreshold;
+    // vtkImageThreshold compares in the input scalar type
+    this->LowerThreshold = ToScalarType(lower);
+    this->UpperThreshold = ToScalarType(upper);
+    this->ColorTable = colorTable;
+    this->ValueTable = valueTable;
+  }
+
+  /// Map without the value table (used to build it)
+  inline void MapValue(T value, unsigned char* rgba) const
+  {
+    const unsigned char* color = this->ColorTable + 4 * this->WindowLevel.Map(value);
+    rgba[0] = color[0];
+    rgba[1] = color[1];
+    rgba[2] = color[2];
+    bool inThreshold = !this->ApplyThreshold ||
+      (this->LowerThreshold <= value && value <= this->UpperThreshold);
+    rgba[3] = (color[3] != 0 && inThreshold) ? 255 : 0;
+  }
+
+  inline void Map(T value, unsigned char* rgba) const
+  {
+    if (this->ValueTable)
+      {
+      const unsigned char* color = this->ValueTable +
+        4 * (static_cast<vtkIdType>(value) -
+             static_cast<vtkIdType>(vtkTypeTraits<T>::Min()));
+      rgba[0] = color[0];
+      rgba[1] = color[1];
+      rgba[2] = color[2];
+      rgba[3] = color[3];
+      return;
+      }
+    this->MapValue(value, rgba);
+  }
+
+private:
+  /// Clamp to the scalar type range and cast, as vtkImageThreshold does.
+  static T ToScalarType(double value)
+  {
+    if (value < static_cast<double>(vtkTypeTraits<T>::Min()))
+      {
+      return vtkTypeTraits<T>::Min();
+      }
+    if (value > static_cast<double>(vtkTypeTraits<T>::Max()))
+      {
+      return vtkTypeTraits<T>::Max();
+      }
+    return static_cast<T>(value);
+  }
+
+  vtkWindowLevelMapping<T> WindowLevel;
+  int ApplyThreshold;
+  T LowerThreshold;
+  T UpperThreshold;
+  const unsigned char* ColorTable;
+  const unsigned char* ValueTable;
+};
+
+//----------------------------------------------------------------------------
+template <class T>
+bool vtkResliceMapToColorsHasValueTable(T*)
+{
+  return vtkTypeTraits<T>::Max() <= 65535 &&
+    static_cast<double>(vtkTypeTraits<T>::Min()) >= -32768. &&
+    static_cast<T>(0.5) == 0;
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+void vtkResliceMapToColorsBuildValueTable(T*, const vtkResliceColorMapping<T>& mapping,
+                                          std::vector<unsigned char>& valueTable)
+{
+  if (!vtkResliceMapToColorsHasValueTable(static_cast<T*>(0)))
+    {
+    valueTable.clear();
+    return;
+    }
+  const int min = static_cast<int>(vtkTypeTraits<T>::Min());
+  const int max = static_cast<int>(vtkTypeTraits<T>::Max());
+  valueTable.resize(4 * (max - min + 1));
+  unsigned char* rgba = &valueTable[0];
+  for (int value = min; value <= max; ++value, rgba += 4)
+    {
+    mapping.MapValue(static_cast<T>(value), rgba);
+    }
+}
+
+//----------------------------------------------------------------------------
+// Everything needed to compute a slice, it doesn't reference the filter so
+// it can be used by the prefetch thread.
+struct vtkResliceMapToColorsSlice
+{
+  /// Output index to input continuous index
+  double Matrix[4][4];
+  int InterpolationMode;
+  int SampleStep;
+  /// Whole output extent, the sample blocks are aligned on it
+  int OutputExtent[6];
+  int InputExtent[6];
+  vtkIdType InputIncrements[3];
+  double Window;
+  double Level;
+  int ApplyThreshold;
+  double LowerThreshold;
+  double UpperThreshold;
+  const unsigned char* ColorTable;
+  const unsigned char* ValueTable;
+  const unsigned char* OutsideColor;
+};
+
+//----------------------------------------------------------------------------
+template <class T>
+void vtkImageResliceMapToColorsExecute(const vtkResliceMapToColorsSlice& slice,
+                                       const T* inPtr,
+                                       unsigned char* outPtr, int outExt[6],
+                                       vtkIdType outIncY, vtkIdType outIncZ,
+                                       vtkAlgorithm* progress,
+                                       const volatile int* abort)
+{
+  const int* inExt = slice.InputExtent;
+  const vtkIdType* inInc = slice.InputIncrements;
+  const int inExtX = inExt[1] - inExt[0] + 1;
+  const int inExtY = inExt[3] - inExt[2] + 1;
+  const int inExtZ = inExt[5] - inExt[4] + 1;
+
+  const double (*matrix)[4] = slice.Matrix;
+  const bool perspective = (matrix[3][0] != 0. || matrix[3][1] != 0. ||
+                            matrix[3][2] != 0. || matrix[3][3] != 1.);
+  const bool linear = (slice.InterpolationMode == VTK_RESLICE_LINEAR);
+  const vtkResliceColorMapping<T> mapping(slice.Window, slice.Level,
+    slice.ApplyThreshold, slice.LowerThreshold, slice.UpperThreshold,
+    slice.ColorTable, slice.ValueTable);
+  const unsigned char* outsideColor = slice.OutsideColor;
+  // Blocks of sampleStep x sampleStep pixels share the value of their first
+  // pixel. The blocks are aligned on the whole extent so all the threads
+  // agree on them.
+  const int sampleStep = slice.SampleStep;
+  const int* wholeExt = slice.OutputExtent;
+  const size_t rowSize = 4 * (outExt[1] - outExt[0] + 1);
+
+  // for the progress meter
+  unsigned long count = 0;
+  unsigned long target = static_cast<unsigned long>(
+    (outExt[5]-outExt[4]+1)*(outExt[3]-outExt[2]+1)/50.0);
+  target++;
+
+  for (int idZ = outExt[4]; idZ <= outExt[5] && !*abort; ++idZ)
+    {
+    const unsigned char* previousRow = 0;
+    for (int idY = outExt[2]; idY <= outExt[3] && !*abort; ++idY)
+      {
+      if (progress)
+        {
+        if (!(count%target))
+          {
+          progress->UpdateProgress(count/(50.0*target));
+          }
+        count++;
+        }
+      if (previousRow && (idY - wholeExt[2]) % sampleStep != 0)
+        {
+        memcpy(outPtr, previousRow, rowSize);
+        outPtr += rowSize + outIncY;
+        continue;
+        }
+      previousRow = outPtr;
+      // input index of the first voxel of the row and the increment per
+      // output voxel along the row
+      double rowStart[4];
+      for (int i = 0; i < 4; ++i)
+        {
+        rowStart[i] = matrix[i][0] * outExt[0] + matrix[i][1] * idY +
+                      matrix[i][2] * idZ + matrix[i][3];
+        }
+      for (int idX = outExt[0]; idX <= outExt[1]; ++idX, outPtr += 4)
+        {
+        if (sampleStep > 1 && idX != outExt[0] &&
+            (idX - wholeExt[0]) % sampleStep != 0)
+          {
+          memcpy(outPtr, outPtr - 4, 4);
+          continue;
+          }
+        const double step = idX - outExt[0];
+        double point[3];
+        point[0] = rowStart[0] + matrix[0][0] * step;
+        point[1] = rowStart[1] + matrix[1][0] * step;
+        point[2] = rowStart[2] + matrix[2][0] * step;
+        if (perspective)
+          {
+          double w = 1. / (rowStart[3] + matrix[3][0] * step);
+          point[0] *= w;
+          point[1] *= w;
+          point[2] *= w;
+          }
+        if (!linear)
+          {
+          int inIdX = vtkResliceMapToColorsRound(point[0]) - inExt[0];
+          int inIdY = vtkResliceMapToColorsRound(point[1]) - inExt[2];
+          int inIdZ = vtkResliceMapToColorsRound(point[2]) - inExt[4];
+          if (inIdX < 0 || inIdX >= inExtX ||
+              inIdY < 0 || inIdY >= inExtY ||
+              inIdZ < 0 || inIdZ >= inExtZ)
+            {
+            memcpy(outPtr, outsideColor, 4);
+            continue;
+            }
+          mapping.Map(inPtr[inIdX*inInc[0] + inIdY*inInc[1] + inIdZ*inInc[2]],
+                      outPtr);
+          continue;
+          }
+        // trilinear interpolation, same bounds as vtkTrilinearInterpolation
+        double floorX = floor(point[0]);
+        double floorY = floor(point[1]);
+        double floorZ = floor(point[2]);
+        double fx = point[0] - floorX;
+        double fy = point[1] - floorY;
+        double fz = point[2] - floorZ;
+        int inIdX0 = static_cast<int>(floorX) - inExt[0];
+        int inIdY0 = static_cast<int>(floorY) - inExt[2];
+        int inIdZ0 = static_cast<int>(floorZ) - inExt[4];
+        int inIdX1 = inIdX0 + (fx != 0);
+        int inIdY1 = inIdY0 + (fy != 0);
+        int inIdZ1 = inIdZ0 + (fz != 0);
+        if (inIdX0 < 0 || inIdX1 >= inExtX ||
+            inIdY0 < 0 || inIdY1 >= inExtY ||
+            inIdZ0 < 0 || inIdZ1 >= inExtZ)
+          {
+          memcpy(outPtr, outsideColor, 4);
+          continue;
+          }
+        const vtkIdType x0 = inIdX0*inInc[0];
+        const vtkIdType x1 = inIdX1*inInc[0];
+        const vtkIdType y0 = inIdY0*inInc[1];
+        const vtkIdType y1 = inIdY1*inInc[1];
+        const vtkIdType z0 = inIdZ0*inInc[2];
+        const vtkIdType z1 = inIdZ1*inInc[2];
+        const double rx = 1. - fx;
+        const double ry = 1. - fy;
+        const double rz = 1. - fz;
+        double value =
+          rz * (ry * (rx * inPtr[x0+y0+z0] + fx * inPtr[x1+y0+z0]) +
+                fy * (rx * inPtr[x0+y1+z0] + fx * inPtr[x1+y1+z0]));
+        if (fz != 0)
+          {
+          value +=
+            fz * (ry * (rx * inPtr[x0+y0+z1] + fx * inPtr[x1+y0+z1]) +
+                  fy * (rx * inPtr[x0+y1+z1] + fx * inPtr[x1+y1+z1]));
+          }
+        T resliced;
+        vtkResliceMapToColorsClamp(value, resliced);
+        mapping.Map(resliced, outPtr);
+        }
+      outPtr += outIncY;
+      }
+    outPtr += outIncZ;
+    }
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+void vtkImageResliceMapToColorsBuildTables(T*, double window, double level,
+                                           int applyThreshold,
+                                           double lower, double upper,
+                                           const unsigned char* colorTable,
+                                           std::vector<unsigned char>& valueTable,
+                                           unsigned char outsideColor[4])
+{
+  vtkResliceColorMapping<T> mapping(window, level, applyThreshold, lower, upper,
+                                    colorTable, 0);
+  vtkResliceMapToColorsBuildValueTable(static_cast<T*>(0), mapping, valueTable);
+  // vtkImageResliceMask fills the outside with 0 and masks it out
+  mapping.MapValue(static_cast<T>(0), outsideColor);
+  outsideColor[3] = 0;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+class vtkImageResliceMapToColors::vtkInternal
+{
+public:
+  vtkInternal();
+  ~vtkInternal();
+
+  /// A computed slice and what it depends on
+  struct CacheEntry
+  {
+    double Matrix[4][4];
+    int Extent[6];
+    int InterpolationMode;
+    vtkImageData* Input;
+    unsigned long InputTime;
+    unsigned long TablesTime;
+    std::vector<unsigned char> Pixels;
+  };
+  typedef std::list<CacheEntry> CacheType;
+
+  /// Initialize the key of entry from the current slice
+  void InitializeKey(CacheEntry& entry, vtkImageData* input,
+                     unsigned long tablesTime);
+  /// Return the cached entry with the same key, 0 if none.
+  /// If markUsed is true, the entry becomes the most recently used.
+  CacheEntry* Find(const CacheEntry& key, bool markUsed = true);
+  /// Add an entry as the most recently used, then remove the least recently
+  /// used entries until the cache fits in maxSize bytes.
+  void Insert(CacheEntry& entry, size_t maxSize);
+  void Clear();
+
+  static bool SameKey(const CacheEntry& first, const CacheEntry& second);
+  static VTK_THREAD_RETURN_TYPE PrefetchThread(void* arg);
+
+  /// Parameters of the slice being computed
+  vtkResliceMapToColorsSlice Slice;
+
+  /// Most recently used first
+  CacheType Cache;
+  size_t CacheSize;
+
+  vtkMultiThreader* Threader;
+  int PrefetchThreadID;
+  volatile int AbortPrefetch;
+  /// Slices computed by the prefetch thread, moved to the cache when it is
+  /// done.
+  CacheType PrefetchJobs;
+  /// Slice parameters shared by the jobs
+  vtkResliceMapToColorsSlice PrefetchSlice;
+  int PrefetchScalarType;
+  /// keep the input voxels alive while the thread reads them
+  vtkSmartPointer<vtkDataArray> PrefetchScalars;
+
+  /// Key of the last computed output (without pixels) and its scalars, to
+  /// be shared with the other filters. Output is 0 if there is none.
+  CacheEntry Output;
+  int OutputSampleStep;
+  /// Kept alive to reuse its slices when the output is shifted
+  vtkSmartPointer<vtkDataArray> OutputScalars;
+};
+
+namespace
+{
+// All the vtkImageResliceMapToColors instances
+std::list<vtkImageResliceMapToColors*>& vtkImageResliceMapToColorsInstances()
+{
+  static std::list<vtkImageResliceMapToColors*> instances;
+  return instances;
+}
+}
+
+//----------------------------------------------------------------------------
+vtkImageResliceMapToColors::vtkInternal::vtkInternal()
+{
+  this->CacheSize = 0;
+  this->Threader = vtkMultiThreader::New();
+  this->PrefetchThreadID = -1;
+  this->AbortPrefetch = 0;
+  this->PrefetchScalarType = VTK_VOID;
+  this->OutputSampleStep = 1;
+}
+
+//----------------------------------------------------------------------------
+vtkImageResliceMapToColors::vtkInternal::~vtkInternal()
+{
+  this->Threader->Delete();
+}
+
+//----------------------------------------------------------------------------
+void vtkImageResliceMapToColors::vtkInternal::InitializeKey(
+  CacheEntry& entry, vtkImageData* input, unsigned long tablesTime)
+{
+  memcpy(entry.Matrix, this->Slice.Matrix, sizeof(entry.Matrix));
+  memcpy(entry.Extent, this->Slice.OutputExtent, sizeof(entry.Extent));
+  entry.InterpolationMode = this->Slice.InterpolationMode;
+  entry.Input = input;
+  entry.InputTime = input->GetMTime();
+  entry.TablesTime = tablesTime;
+}
+
+//----------------------------------------------------------------------------
+bool vtkImageResliceMapToColors::vtkInternal::SameKey(const CacheEntry& first,
+                                                      const CacheEntry& second)
+{
+  if (first.Input != second.Input ||
+      first.InputTime != second.InputTime ||
+      first.TablesTime != second.TablesTime ||
+      first.InterpolationMode != second.InterpolationMode ||
+      memcmp(first.Extent, second.Extent, sizeof(first.Extent)) != 0)
+    {
+    return false;
+    }
+  // The slice logic recomputes the matrix at each offset change, allow for
+  // rounding errors (the matrix maps to voxel indices).
+  const double tolerance = 1e-6;
+  for (int i = 0; i < 4; ++i)
+    {
+    for (int j = 0; j < 4; ++j)
+      {
+      if (fabs(first.Matrix[i][j] - second.Matrix[i][j]) > tolerance)
+        {
+        return false;
+        }
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+vtkImageResliceMapToColors::vtkInternal::CacheEntry*
+vtkImageResliceMapToColors::vtkInternal::Find(const CacheEntry& key,
+                                               bool markUsed)
+{
+  for (CacheType::iterator it = this->Cache.begin(); it != this->Cache.end(); ++it)
+    {
+    if (!SameKey(*it, key))
+      {
+      continue;
+      }
+    if (markUsed)
+      {
+      this->Cache.splice(this->Cache.begin(), this->Cache, it);
+      return &this->Cache.front();
+      }
+    return &*it;
+    }
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageResliceMapToColors::vtkInternal::Insert(CacheEntry& entry,
+                                                     size_t maxSize)
+{
+  if (entry.Pixels.size() > maxSize)
+    {
+    return;
+    }
+  this->Cache.push_front(CacheEntry());
+  CacheEntry& newEntry = this->Cache.front();
+  memcpy(newEntry.Matrix, entry.Matrix, sizeof(entry.Matrix));
+  memcpy(newEntry.Extent, entry.Extent, sizeof(entry.Extent));
+  newEntry.InterpolationMode = entry.InterpolationMode;
+  newEntry.Input = entry.Input;
+  newEntry.InputTime = entry.InputTime;
+  newEntry.TablesTime = entry.TablesTime;
+  newEntry.Pixels.swap(entry.Pixels);
+  this->CacheSize += newEntry.Pixels.size();
+  while (this->CacheSize > maxSize)
+    {
+    this->CacheSize -= this->Cache.back().Pixels.size();
+    this->Cache.pop_back();
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkImageResliceMapToColors::vtkInternal::Clear()
+{
+  this->Cache.clear();
+  this->CacheSize = 0;
+}
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkImageResliceMapToColors::vtkInternal
+::PrefetchThread(void* arg)
+{
+  vtkInternal* self = static_cast<vtkInternal*>(
+    static_cast<vtkMultiThreader::ThreadInfo*>(arg)->UserData);
+  void* inPtr = self->PrefetchScalars->GetVoidPointer(0);
+  for (CacheType::iterator it = self->PrefetchJobs.begin();
+       it != self->PrefetchJobs.end() && !self->AbortPrefetch; ++it)
+    {
+    vtkResliceMapToColorsSlice slice = self->PrefetchSlice;
+    memcpy(slice.Matrix, it->Matrix, sizeof(slice.Matrix));
+    int* extent = it->Extent;
+    it->Pixels.resize(4 * (extent[1] - extent[0] + 1) *
+                      (extent[3] - extent[2] + 1) * (extent[5] - extent[4] + 1));
+    switch (self->PrefetchScalarType)
+      {
+      vtkTemplateMacro(
+        vtkImageResliceMapToColorsExecute(slice, static_cast<VTK_TT*>(inPtr),
+          &it->Pixels[0], extent, 0, 0, 0, &self->AbortPrefetch));
+      default:
+        break;
+      }
+    if (self->AbortPrefetch)
+      {
+      // incomplete slice
+      it->Pixels.clear();
+      }
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+vtkImageResliceMapToColors::vtkImageResliceMapToColors()
+{
+  this->ResliceTransform = 0;
+  this->LookupTable = 0;
+  this->InterpolationMode = VTK_RESLICE_NEAREST;
+  this->Window = 256.;
+  this->Level = 128.;
+  this->ApplyThreshold = 0;
+  this->LowerThreshold = VTK_SHORT_MIN;
+  this->UpperThreshold = VTK_SHORT_MAX;
+  for (int i = 0; i < 3; ++i)
+    {
+    this->OutputOrigin[i] = 0.;
+    this->OutputSpacing[i] = 1.;
+    }
+  this->OutputExtent[0] = 0;
+  this->OutputExtent[1] = 255;
+  this->OutputExtent[2] = 0;
+  this->OutputExtent[3] = 255;
+  this->OutputExtent[4] = 0;
+  this->OutputExtent[5] = 0;
+  for (int i = 0; i < 4; ++i)
+    {
+    for (int j = 0; j < 4; ++j)
+      {
+      this->IndexMatrix[i][j] = (i == j ? 1. : 0.);
+      }
+    this->OutsideColor[i] = 0;
+    }
+  this->TablesScalarType = -1;
+  this->TablesLookupTable = 0;
+  this->TablesLookupTableTime = 0;
+  for (int i = 0; i < 5; ++i)
+    {
+    this->TablesParameters[i] = 0.;
+    }
+  this->SampleStep = 1;
+  this->CacheMemoryLimit = 0;
+  this->Prefetch = 0;
+  this->ShareOutput = 0;
+  this->OutputShared = 0;
+  this->Internal = new vtkInternal;
+  vtkImageResliceMapToColorsInstances().push_back(this);
+}
+
+//----------------------------------------------------------------------------
+vtkImageResliceMapToColors::~vtkImageResliceMapToColors()
+{
+  this->StopPrefetch();
+  vtkImageResliceMapToColorsInstances().remove(this);
+  delete this->Internal;
+  this->SetResliceTransform(0);
+  this->SetLookupTable(0);
+}
+
+//----------------------------------------------------------------------------
+void vtkImageResliceMapToColors::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+
+  os << indent << "ResliceTransform: " << this->ResliceTransform << "\n";
+  os << indent << "LookupTable: " << this->LookupTable << "\n";
+  os << indent << "InterpolationMode: " << this->InterpolationMode << "\n";
+  os << indent << "Window: " << this->Window << "\n";
+  os << indent << "Level: " << this->Level << "\n";
+  os << indent << "ApplyThreshold: " << this->ApplyThreshold << "\n";
+  os << indent << "LowerThreshold: " << this->LowerThreshold << "\n";
+  os << indent << "UpperThreshold: " << this->UpperThreshold << "\n";
+  os << indent << "SampleStep: " << this->SampleStep << "\n";
+  os << indent << "CacheMemoryLimit: " << this->CacheMemoryLimit << "\n";
+  os << indent << "Prefetch: " << this->Prefetch << "\n";
+  os << indent << "ShareOutput: " << this->ShareOutput << "\n";
+  os << indent << "OutputShared: " << this->OutputShared << "\n";
+  os << indent << "NumberOfCachedSlices: " << this->Internal->Cache.size() << "\n";
+  os << indent << "OutputOrigin: " << this->OutputOrigin[0] << " "
+     << this->OutputOrigin[1] << " " << this->OutputOrigin[2] << "\n";
+  os << indent << "OutputSpacing: " << this->OutputSpacing[0] << " "
+     << this->OutputSpacing[1] << " " << this->OutputSpacing[2] << "\n";
+  os << indent << "OutputExtent: " << this->OutputExtent[0] << " "
+     << this->OutputExtent[1] << " " << this->OutputExtent[2] << " "
+     << this->OutputExtent[3] << " " << this->OutputExtent[4] << " "
+     << this->OutputExtent[5] << "\n";
+}
+
+//----------------------------------------------------------------------------
+unsigned long int vtkImageResliceMapToColors::GetMTime()
+{
+  unsigned long mTime = this->Superclass::GetMTime();
+  unsigned long time;
+  if (this->ResliceTransform != 0)
+    {
+    time = this->ResliceTransform->GetMTime();
+    mTime = (time > mTime ? time : mTime);
+    vtkHomogeneousTransform* homogeneous =
+      vtkHomogeneousTransform::SafeDownCast(this->ResliceTransform);
+    if (homogeneous)
+      { // this is for people who directly modify the transform matrix
+      time = homogeneous->GetMatrix()->GetMTime();
+      mTime = (time > mTime ? time : mTime);
+      }
+    }
+  if (this->LookupTable != 0)
+    {
+    time = this->LookupTable->GetMTime();
+    mTime = (time > mTime ? time : mTime);
+    }
+  return mTime;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageResliceMapToColors::FillInputPortInformation(
+  int vtkNotUsed(port), vtkInformation *info)
+{
+  info->Set(vtkAlgorithm::INPUT_REQUIRED_DATA_TYPE(), "vtkImageData");
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageResliceMapToColors::RequestInformation(
+  vtkInformation *vtkNotUsed(request),
+  vtkInformationVector **vtkNotUsed(inputVector),
+  vtkInformationVector *outputVector)
+{
+  vtkInformation *outInfo = outputVector->GetInformationObject(0);
+  outInfo->Set(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(),
+               this->OutputExtent, 6);
+  outInfo->Set(vtkDataObject::SPACING(), this->OutputSpacing, 3);
+  outInfo->Set(vtkDataObject::ORIGIN(), this->OutputOrigin, 3);
+  vtkDataObject::SetPointDataActiveScalarInfo(outInfo, VTK_UNSIGNED_CHAR, 4);
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageResliceMapToColors::RequestUpdateExtent(
+  vtkInformation *vtkNotUsed(request),
+  vtkInformationVector **inputVector,
+  vtkInformationVector *vtkNotUsed(outputVector))
+{
+  // as vtkImageLinearReslice, request the full extent
+  int inExt[6];
+  vtkInformation *inInfo = inputVector[0]->GetInformationObject(0);
+  inInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), inExt);
+  inInfo->Set(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), inExt, 6);
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageResliceMapToColors::RequestData(vtkInformation *request,
+                                            vtkInformationVector **inputVector,
+                                            vtkInformationVector *outputVector)
+{
+  vtkImageData* input = vtkImageData::SafeDownCast(
+    inputVector[0]->GetInformationObject(0)->Get(vtkDataObject::DATA_OBJECT()));
+  if (input == 0 || input->GetPointData()->GetScalars() == 0)
+    {
+    vtkErrorMacro("RequestData: no input scalars");
+    return 0;
+    }
+  // The prefetch thread uses the tables
+  this->StopPrefetch();
+
+  // Output index -> output coordinates -> input coordinates -> input index
+  vtkMatrix4x4* indexMatrix = vtkMatrix4x4::New();
+  for (int i = 0; i < 3; ++i)
+    {
+    indexMatrix->SetElement(i, i, this->OutputSpacing[i]);
+    indexMatrix->SetElement(i, 3, this->OutputOrigin[i]);
+    }
+  if (this->ResliceTransform)
+    {
+    vtkHomogeneousTransform* homogeneous =
+      vtkHomogeneousTransform::SafeDownCast(this->ResliceTransform);
+    if (homogeneous == 0)
+      {
+      vtkErrorMacro("RequestData: only linear transforms are supported");
+      indexMatrix->Delete();
+      return 0;
+      }
+    homogeneous->Update();
+    vtkMatrix4x4::Multiply4x4(homogeneous->GetMatrix(), indexMatrix, indexMatrix);
+    }
+  double inOrigin[3];
+  double inSpacing[3];
+  input->GetOrigin(inOrigin);
+  input->GetSpacing(inSpacing);
+  vtkMatrix4x4* inputToIndex = vtkMatrix4x4::New();
+  for (int i = 0; i < 3; ++i)
+    {
+    inputToIndex->SetElement(i, i, 1. / inSpacing[i]);
+    inputToIndex->SetElement(i, 3, -inOrigin[i] / inSpacing[i]);
+    }
+  vtkMatrix4x4::Multiply4x4(inputToIndex, indexMatrix, indexMatrix);
+  for (int i = 0; i < 4; ++i)
+    {
+    for (int j = 0; j < 4; ++j)
+      {
+      this->IndexMatrix[i][j] = indexMatrix->GetElement(i, j);
+      }
+    }
+  inputToIndex->Delete();
+  indexMatrix->Delete();
+
+  // The tables are shared by all the threads, build them beforehand.
+  this->UpdateTables(input);
+
+  vtkResliceMapToColorsSlice& slice = this->Internal->Slice;
+  memcpy(slice.Matrix, this->IndexMatrix, sizeof(slice.Matrix));
+  slice.InterpolationMode = this->InterpolationMode;
+  slice.SampleStep = this->SampleStep;
+  memcpy(slice.OutputExtent, this->OutputExtent, sizeof(slice.OutputExtent));
+  input->GetExtent(slice.InputExtent);
+  input->GetIncrements(slice.InputIncrements);
+  slice.Window = this->Window;
+  slice.Level = this->Level;
+  slice.ApplyThreshold = this->ApplyThreshold;
+  slice.LowerThreshold = this->LowerThreshold;
+  slice.UpperThreshold = this->UpperThreshold;
+  slice.ColorTable = this->ColorTable.empty() ? 0 : &this->ColorTable[0];
+  slice.ValueTable = this->ValueTable.empty() ? 0 : &this->ValueTable[0];
+  slice.OutsideColor = this->OutsideColor;
+
+  vtkInformation* outInfo = outputVector->GetInformationObject(0);
+  vtkImageData* output = vtkImageData::SafeDownCast(
+    outInfo->Get(vtkDataObject::DATA_OBJECT()));
+  int updateExtent[6];
+  outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), updateExtent);
+  const bool wholeExtent =
+    memcmp(updateExtent, this->OutputExtent, sizeof(updateExtent)) == 0;
+  vtkInternal::CacheEntry key;
+  this->Internal->InitializeKey(key, input, this->TablesBuildTime.GetMTime());
+
+  if (this->ShareOutput && wholeExtent && this->ShareOutputOfPeer(input, output))
+    {
+    this->OutputShared = 1;
+    }
+  else
+    {
+    this->OutputShared = 0;
+    // Only full resolution slices of the whole extent are cached
+    bool cached = this->CacheMemoryLimit > 0 && this->SampleStep == 1 &&
+      wholeExtent;
+    vtkInternal::CacheEntry* entry = cached ? this->Internal->Find(key) : 0;
+    if (entry)
+      {
+      output->SetExtent(updateExtent);
+      output->SetScalarTypeToUnsignedChar();
+      output->SetNumberOfScalarComponents(4);
+      output->AllocateScalars();
+      memcpy(output->GetScalarPointer(), &entry->Pixels[0], entry->Pixels.size());
+      }
+    else if (!wholeExtent || !this->ReuseShiftedOutput(input, output))
+      {
+      this->Internal->OutputScalars = 0;
+      int res = this->Superclass::RequestData(request, inputVector, outputVector);
+      if (!res || this->AbortExecute)
+        {
+        return res;
+        }
+      }
+    if (this->AbortExecute)
+      {
+      this->Internal->OutputScalars = 0;
+      return 1;
+      }
+    if (cached && !entry)
+      {
+      const unsigned char* pixels =
+        static_cast<unsigned char*>(output->GetScalarPointer());
+      key.Pixels.assign(pixels, pixels + 4 * output->GetNumberOfPoints());
+      this->Internal->Insert(key,
+        static_cast<size_t>(this->CacheMemoryLimit) * 1024);
+      }
+    if (cached && this->Prefetch)
+      {
+      this->StartPrefetch(input);
+      }
+    }
+
+  // Remember the output to share it or reuse it when shifted
+  this->Internal->OutputScalars = 0;
+  if (wholeExtent)
+    {
+    this->Internal->InitializeKey(this->Internal->Output, input,
+                                  this->TablesBuildTime.GetMTime());
+    this->Internal->OutputSampleStep = this->SampleStep;
+    this->Internal->OutputScalars = output->GetPointData()->GetScalars();
+    }
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+bool vtkImageResliceMapToColors::ReuseShiftedOutput(vtkImageData* input,
+                                                    vtkImageData* output)
+{
+  // Lightbox: the output has one slice per tile
+  const int* extent = this->OutputExtent;
+  const int numberOfSlices = extent[5] - extent[4] + 1;
+  vtkInternal::CacheEntry& previous = this->Internal->Output;
+  vtkDataArray* previousScalars = this->Internal->OutputScalars;
+  if (numberOfSlices < 2 || previousScalars == 0 ||
+      previous.Input != input ||
+      previous.InputTime != input->GetMTime() ||
+      previous.TablesTime != this->TablesBuildTime.GetMTime() ||
+      previous.InterpolationMode != this->InterpolationMode ||
+      this->Internal->OutputSampleStep != this->SampleStep ||
+      memcmp(previous.Extent, extent, sizeof(previous.Extent)) != 0 ||
+      previousScalars->GetNumberOfTuples() !=
+        static_cast<vtkIdType>(extent[1] - extent[0] + 1) *
+        (extent[3] - extent[2] + 1) * numberOfSlices)
+    {
+    return false;
+    }
+  // The slices are shifted if only the translation changed, by an integer
+  // number of slices.
+  const double (*matrix)[4] = this->IndexMatrix;
+  const double tolerance = 1e-6;
+  double shift = 0.;
+  double maxComponent = 0.;
+  for (int i = 0; i < 3; ++i)
+    {
+    if (fabs(matrix[i][2]) > maxComponent)
+      {
+      maxComponent = fabs(matrix[i][2]);
+      shift = (matrix[i][3] - previous.Matrix[i][3]) / matrix[i][2];
+      }
+    }
+  const int slices = static_cast<int>(floor(shift + 0.5));
+  if (maxComponent == 0. || slices == 0 || abs(slices) >= numberOfSlices)
+    {
+    return false;
+    }
+  for (int i = 0; i < 4; ++i)
+    {
+    for (int j = 0; j < 4; ++j)
+      {
+      double expected = previous.Matrix[i][j] + (j == 3 ? slices * matrix[i][2] : 0.);
+      if (fabs(matrix[i][j] - expected) > tolerance)
+        {
+        return false;
+        }
+      }
+    }
+
+  output->SetExtent(const_cast<int*>(extent));
+  output->SetScalarTypeToUnsignedChar();
+  output->SetNumberOfScalarComponents(4);
+  output->AllocateScalars();
+  const size_t sliceSize = 4 * static_cast<size_t>(extent[1] - extent[0] + 1) *
+    (extent[3] - extent[2] + 1);
+  const unsigned char* previousPixels =
+    static_cast<unsigned char*>(previousScalars->GetVoidPointer(0));
+  unsigned char* pixels = static_cast<unsigned char*>(output->GetScalarPointer());
+  void* inPtr = input->GetScalarPointer();
+  for (int k = 0; k < numberOfSlices && !this->AbortExecute; ++k)
+    {
+    // output slice k is the previous slice k + slices
+    const int previousSlice = k + slices;
+    if (previousSlice >= 0 && previousSlice < numberOfSlices)
+      {
+      memcpy(pixels + k * sliceSize, previousPixels + previousSlice * sliceSize,
+             sliceSize);
+      continue;
+      }
+    // Newly visible slice, small enough to not be worth threading
+    int sliceExtent[6] = {extent[0], extent[1], extent[2], extent[3],
+                          extent[4] + k, extent[4] + k};
+    unsigned char* outPtr = pixels + k * sliceSize;
+    switch (input->GetScalarType())
+      {
+      vtkTemplateMacro(
+        vtkImageResliceMapToColorsExecute(this->Internal->Slice,
+          static_cast<VTK_TT*>(inPtr), outPtr, sliceExtent, 0, 0,
+          0, &this->AbortExecute));
+      default:
+        vtkErrorMacro("ReuseShiftedOutput: Unknown ScalarType");
+        return false;
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkImageResliceMapToColors::ShareOutputOfPeer(vtkImageData* input,
+                                                   vtkImageData* output)
+{
+  vtkInternal::CacheEntry key;
+  this->Internal->InitializeKey(key, input, this->TablesBuildTime.GetMTime());
+  std::list<vtkImageResliceMapToColors*>& instances =
+    vtkImageResliceMapToColorsInstances();
+  for (std::list<vtkImageResliceMapToColors*>::iterator it = instances.begin();
+       it != instances.end(); ++it)
+    {
+    vtkImageResliceMapToColors* peer = *it;
+    if (peer == this || !peer->ShareOutput ||
+        peer->Internal->OutputScalars.GetPointer() == 0 ||
+        peer->Internal->OutputSampleStep != this->SampleStep ||
+        peer->TablesScalarType != this->TablesScalarType ||
+        peer->TablesLookupTable != this->TablesLookupTable ||
+        peer->TablesLookupTableTime != this->TablesLookupTableTime ||
+        memcmp(peer->TablesParameters, this->TablesParameters,
+               sizeof(this->TablesParameters)) != 0)
+      {
+      continue;
+      }
+    // The tables are the same, their build time is not
+    key.TablesTime = peer->Internal->Output.TablesTime;
+    if (!vtkInternal::SameKey(peer->Internal->Output, key))
+      {
+      continue;
+      }
+    // Make sure the peer output still contains the slice
+    vtkDataArray* scalars = peer->GetOutput()->GetPointData()->GetScalars();
+    if (scalars != peer->Internal->OutputScalars.GetPointer())
+      {
+      continue;
+      }
+    output->SetExtent(key.Extent);
+    output->GetPointData()->SetScalars(scalars);
+    return true;
+    }
+  return false;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageResliceMapToColors::StartPrefetch(vtkImageData* input)
+{
+  // Scrolling a lightbox reuses the slices of the previous output instead
+  if (this->OutputExtent[5] > this->OutputExtent[4])
+    {
+    return;
+    }
+  // Neighbor slices: one output voxel away along Z, it is the slice spacing
+  // for the slice views.
+  this->Internal->PrefetchJobs.clear();
+  for (int direction = -1; direction <= 1; direction += 2)
+    {
+    vtkInternal::CacheEntry job;
+    this->Internal->InitializeKey(job, input, this->TablesBuildTime.GetMTime());
+    for (int i = 0; i < 4; ++i)
+      {
+      job.Matrix[i][3] += direction * job.Matrix[i][2];
+      }
+    if (this->Internal->Find(job, false) == 0)
+      {
+      this->Internal->PrefetchJobs.push_back(job);
+      }
+    }
+  if (this->Internal->PrefetchJobs.empty())
+    {
+    return;
+    }
+  this->Internal->PrefetchSlice = this->Internal->Slice;
+  this->Internal->PrefetchScalarType = input->GetScalarType();
+  this->Internal->PrefetchScalars = input->GetPointData()->GetScalars();
+  this->Internal->AbortPrefetch = 0;
+  this->Internal->PrefetchThreadID = this->Internal->Threader->SpawnThread(
+    vtkInternal::PrefetchThread, this->Internal);
+}
+
+//----------------------------------------------------------------------------
+void vtkImageResliceMapToColors::StopPrefetch()
+{
+  if (this->Internal->PrefetchThreadID == -1)
+    {
+    return;
+    }
+  this->Internal->AbortPrefetch = 1;
+  this->Internal->Threader->TerminateThread(this->Internal->PrefetchThreadID);
+  this->Internal->PrefetchThreadID = -1;
+  this->Internal->PrefetchScalars = 0;
+  vtkInternal::CacheType::iterator it;
+  for (it = this->Internal->PrefetchJobs.begin();
+       it != this->Internal->PrefetchJobs.end(); ++it)
+    {
+    if (!it->Pixels.empty())
+      {
+      this->Internal->Insert(*it, static_cast<size_t>(this->CacheMemoryLimit) * 1024);
+      }
+    }
+  this->Internal->PrefetchJobs.clear();
+}
+
+//----------------------------------------------------------------------------
+void vtkImageResliceMapToColors::ClearCache()
+{
+  this->StopPrefetch();
+  this->Internal->Clear();
+}
+
+//----------------------------------------------------------------------------
+int vtkImageResliceMapToColors::GetNumberOfCachedSlices()
+{
+  this->StopPrefetch();
+  return static_cast<int>(this->Internal->Cache.size());
+}
+
+//----------------------------------------------------------------------------
+void vtkImageResliceMapToColors::UpdateTables(vtkImageData* input)
+{
+  // Compare the parameters instead of the MTime: the transform, the sample
+  // step or the cache settings don't impact the tables, and rebuilding them
+  // would invalidate the cached slices.
+  const double parameters[5] = {this->Window, this->Level,
+    static_cast<double>(this->ApplyThreshold),
+    this->LowerThreshold, this->UpperThreshold};
+  const unsigned long lookupTableTime =
+    this->LookupTable ? this->LookupTable->GetMTime() : 0;
+  if (!this->ColorTable.empty() &&
+      this->TablesScalarType == input->GetScalarType() &&
+      this->TablesLookupTable == this->LookupTable &&
+      this->TablesLookupTableTime == lookupTableTime &&
+      memcmp(this->TablesParameters, parameters, sizeof(parameters)) == 0)
+    {
+    return;
+    }
+
+  this->ColorTable.resize(256 * 4);
+  unsigned char values[256];
+  for (int i = 0; i < 256; ++i)
+    {
+    values[i] = static_cast<unsigned char>(i);
+    }
+  if (this->LookupTable)
+    {
+    this->LookupTable->Build();
+    this->LookupTable->MapScalarsThroughTable2(
+      values, &this->ColorTable[0], VTK_UNSIGNED_CHAR, 256, 1, VTK_RGBA);
+    }
+  else
+    {
+    for (int i = 0; i < 256; ++i)
+      {
+      this->ColorTable[4*i] = this->ColorTable[4*i+1] =
+        this->ColorTable[4*i+2] = values[i];
+      this->ColorTable[4*i+3] = 255;
+      }
+    }
+
+  switch (input->GetScalarType())
+    {
+    vtkTemplateMacro(
+      vtkImageResliceMapToColorsBuildTables(static_cast<VTK_TT*>(0),
+        this->Window, this->Level, this->ApplyThreshold,
+        this->LowerThreshold, this->UpperThreshold,
+        &this->ColorTable[0], this->ValueTable, this->OutsideColor));
+    default:
+      vtkErrorMacro("UpdateTables: Unknown ScalarType");
+      return;
+    }
+  this->TablesScalarType = input->GetScalarType();
+  this->TablesLookupTable = this->LookupTable;
+  // Build() may have modified the lookup table
+  this->TablesLookupTableTime =
+    this->LookupTable ? this->LookupTable->GetMTime() : 0;
+  memcpy(this->TablesParameters, parameters, sizeof(parameters));
+  this->TablesBuildTime.Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkImageResliceMapToColors::ThreadedRequestData(
+  vtkInformation *vtkNotUsed(request),
+  vtkInformationVector **vtkNotUsed(inputVector),
+  vtkInformationVector *vtkNotUsed(outputVector),
+  vtkImageData ***inData,
+  vtkImageData **outData,
+  int outExt[6], int id)
+{
+  vtkImageData* input = inData[0][0];
+  if (input->GetNumberOfScalarComponents() != 1)
+    {
+    vtkErrorMacro("Execute: only single component images are supported, "
+                  << input->GetNumberOfScalarComponents() << " components");
+    return;
+    }
+  if (outData[0]->GetScalarType() != VTK_UNSIGNED_CHAR ||
+      outData[0]->GetNumberOfScalarComponents() != 4)
+    {
+    vtkErrorMacro("Execute: output must be RGBA unsigned char");
+    return;
+    }
+  unsigned char* outPtr = static_cast<unsigned char*>(
+    outData[0]->GetScalarPointerForExtent(outExt));
+  vtkIdType outIncX, outIncY, outIncZ;
+  outData[0]->GetContinuousIncrements(outExt, outIncX, outIncY, outIncZ);
+  void* inPtr = input->GetScalarPointer();
+
+  switch (input->GetScalarType())
+    {
+    vtkTemplateMacro(
+      vtkImageResliceMapToColorsExecute(this->Internal->Slice,
+        static_cast<VTK_TT*>(inPtr), outPtr, outExt, outIncY, outIncZ,
+        id == 0 ? this : 0, &this->AbortExecute));
+    default:
+      vtkErrorMacro("Execute: Unknown ScalarType");
+      return;
+    }
+}
@@ -0,0 +1,220 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#ifndef __vtkImageResliceMapToColors_h
+#define __vtkImageResliceMapToColors_h
+
+#include "vtkMRMLLogicWin32Header.h"
+
+// VTK includes
+#include <vtkImageReslice.h> // for VTK_RESLICE_NEAREST, LINEAR
+#include <vtkThreadedImageAlgorithm.h>
+#include <vtkTimeStamp.h>
+class vtkAbstractTransform;
+class vtkImageData;
+class vtkScalarsToColors;
+
+// STD includes
+#include <vector>
+
+/// \brief Reslice a scalar volume and map it to RGBA in a single pass.
+///
+/// vtkImageResliceMapToColors fuses the slice layer pipeline of a scalar
+/// volume: vtkImageResliceMask (nearest or linear), the window/level
+/// mapping of vtkImageMapToWindowLevelColors, the threshold and the lookup
+/// table of vtkMRMLScalarVolumeDisplayNode. No intermediate image is
+/// allocated, each output pixel is sampled, mapped and written once.
+/// The output is a 4 components unsigned char image. The alpha channel is
+/// 255 if the pixel is inside the volume, passes the threshold and has a
+/// non transparent color in the lookup table, 0 otherwise (same as the
+/// AlphaLogic output of vtkMRMLScalarVolumeDisplayNode).
+/// For 8 and 16 bit scalars, the mapping is precomputed into a table
+/// indexed by the voxel value, the table is only rebuilt when the display
+/// parameters or the lookup table change.
+/// The execution is threaded over the output rows and can be interrupted
+/// with AbortExecuteOn().
+/// Computed slices can be kept in a LRU cache (CacheMemoryLimit) keyed by
+/// the slice geometry, the input and its MTime and the display parameters:
+/// going back to a slice already seen is a copy. With Prefetch on, the
+/// neighbor slices (one output voxel away along Z) are computed in a
+/// background thread after each update. The thread reads the input voxels
+/// until the next update: call ClearCache() before modifying them in place.
+/// When a multi-slice output (lightbox) is shifted by whole slices, only the
+/// slices that were not in the previous output are computed.
+/// Only single component inputs and linear (homogeneous) reslice
+/// transforms are supported.
+/// \sa vtkImageResliceMask, vtkMRMLScalarVolumeDisplayNode
+class VTK_MRML_LOGIC_EXPORT vtkImageResliceMapToColors : public vtkThreadedImageAlgorithm
+{
+public:
+  static vtkImageResliceMapToColors *New();
+  vtkTypeRevisionMacro(vtkImageResliceMapToColors, vtkThreadedImageAlgorithm);
+  virtual void PrintSelf(ostream& os, vtkIndent indent);
+
+  /// Transform from the output coordinates to the input coordinates.
+  /// It must be a vtkHomogeneousTransform.
+  virtual void SetResliceTransform(vtkAbstractTransform*);
+  vtkGetObjectMacro(ResliceTransform, vtkAbstractTransform);
+
+  /// Lookup table used to map the window/level output (0-255) to colors.
+  virtual void SetLookupTable(vtkScalarsToColors*);
+  vtkGetObjectMacro(LookupTable, vtkScalarsToColors);
+
+  /// Set interpolation mode (default: nearest neighbor). Only nearest and
+  /// linear interpolations are supported.
+  vtkSetClampMacro(InterpolationMode, int, VTK_RESLICE_NEAREST, VTK_RESLICE_LINEAR);
+  vtkGetMacro(InterpolationMode, int);
+  void SetInterpolationModeToNearestNeighbor() {
+    this->SetInterpolationMode(VTK_RESLICE_NEAREST); };
+  void SetInterpolationModeToLinear() {
+    this->SetInterpolationMode(VTK_RESLICE_LINEAR); };
+
+  /// Window and level of the scalar mapping (default: 256/128).
+  vtkSetMacro(Window, double);
+  vtkGetMacro(Window, double);
+  vtkSetMacro(Level, double);
+  vtkGetMacro(Level, double);
+
+  /// Voxels outside [LowerThreshold, UpperThreshold] are transparent if
+  /// ApplyThreshold is on (default: off).
+  vtkSetMacro(ApplyThreshold, int);
+  vtkGetMacro(ApplyThreshold, int);
+  vtkBooleanMacro(ApplyThreshold, int);
+  vtkSetMacro(LowerThreshold, double);
+  vtkGetMacro(LowerThreshold, double);
+  vtkSetMacro(UpperThreshold, double);
+  vtkGetMacro(UpperThreshold, double);
+
+  /// Compute one sample every SampleStep pixels along X and Y and replicate
+  /// it over the block (default: 1, every pixel is sampled). It gives a fast
+  /// low resolution preview of the slice while the output keeps its size.
+  vtkSetClampMacro(SampleStep, int, 1, 16);
+  vtkGetMacro(SampleStep, int);
+
+  /// Maximum size in kilobytes of the cached slices (default: 0, no cache).
+  /// Only full resolution (SampleStep 1) slices are cached.
+  vtkSetMacro(CacheMemoryLimit, unsigned long);
+  vtkGetMacro(CacheMemoryLimit, unsigned long);
+
+  /// Compute the neighbor slices in a background thread after each update
+  /// so that scrolling the slice offset hits the cache (default: off).
+  /// Requires CacheMemoryLimit > 0.
+  vtkSetMacro(Prefetch, int);
+  vtkGetMacro(Prefetch, int);
+  vtkBooleanMacro(Prefetch, int);
+
+  /// Reuse the output of another vtkImageResliceMapToColors with
+  /// ShareOutput on if it computed the same slice of the same input with the
+  /// same display parameters (default: off). The output scalars are then
+  /// shared, not copied. The filters sharing their output must be updated
+  /// from the same thread and the output must not be modified in place.
+  vtkSetMacro(ShareOutput, int);
+  vtkGetMacro(ShareOutput, int);
+  vtkBooleanMacro(ShareOutput, int);
+
+  /// Return 1 if the last execution reused the output of another filter.
+  vtkGetMacro(OutputShared, int);
+
+  /// Remove all the cached slices.
+  void ClearCache();
+  /// Number of cached slices, it waits for the prefetch thread to be done.
+  int GetNumberOfCachedSlices();
+
+  /// Origin, spacing and extent of the output (default: 0, 1 and 0-255
+  /// in XY, 0 in Z).
+  vtkSetVector3Macro(OutputOrigin, double);
+  vtkGetVector3Macro(OutputOrigin, double);
+  vtkSetVector3Macro(OutputSpacing, double);
+  vtkGetVector3Macro(OutputSpacing, double);
+  vtkSetVector6Macro(OutputExtent, int);
+  vtkGetVector6Macro(OutputExtent, int);
+
+  /// Take into account the transform, its matrix and the lookup table.
+  unsigned long int GetMTime();
+
+protected:
+  vtkImageResliceMapToColors();
+  ~vtkImageResliceMapToColors();
+
+  virtual int RequestInformation(vtkInformation *, vtkInformationVector **,
+                                 vtkInformationVector *);
+  virtual int RequestUpdateExtent(vtkInformation *, vtkInformationVector **,
+                                  vtkInformationVector *);
+  virtual int RequestData(vtkInformation *, vtkInformationVector **,
+                          vtkInformationVector *);
+  virtual void ThreadedRequestData(vtkInformation *request,
+                                   vtkInformationVector **inputVector,
+                                   vtkInformationVector *outputVector,
+                                   vtkImageData ***inData,
+                                   vtkImageData **outData, int ext[6], int id);
+  virtual int FillInputPortInformation(int port, vtkInformation *info);
+
+  /// Build ColorTable and ValueTable for the input scalar type if the
+  /// display parameters changed since the last build.
+  void UpdateTables(vtkImageData* input);
+
+  /// Compute the neighbor slices of the current slice in a background thread.
+  void StartPrefetch(vtkImageData* input);
+  /// Interrupt and wait for the prefetch thread, the slices computed so far
+  /// are added to the cache.
+  void StopPrefetch();
+
+  /// Reference the output of another filter that computed the current slice
+  /// of input, return false if there is none.
+  bool ShareOutputOfPeer(vtkImageData* input, vtkImageData* output);
+
+  /// If the output has several slices (lightbox) and the current slices are
+  /// the previous ones shifted by a number of slices, copy the slices still
+  /// visible and only compute the new ones. Return false if not applicable.
+  bool ReuseShiftedOutput(vtkImageData* input, vtkImageData* output);
+
+  class vtkInternal;
+  vtkInternal* Internal;
+
+  vtkAbstractTransform* ResliceTransform;
+  vtkScalarsToColors* LookupTable;
+  int InterpolationMode;
+  double Window;
+  double Level;
+  int ApplyThreshold;
+  double LowerThreshold;
+  double UpperThreshold;
+  double OutputOrigin[3];
+  double OutputSpacing[3];
+  int OutputExtent[6];
+  int SampleStep;
+  unsigned long CacheMemoryLimit;
+  int Prefetch;
+  int ShareOutput;
+  int OutputShared;
+
+  /// Output index to input continuous index, computed in RequestData().
+  double IndexMatrix[4][4];
+  /// RGBA of each window/level output value
+  std::vector<unsigned char> ColorTable;
+  /// RGBA (with threshold alpha) of each voxel value for 8/16 bit scalars,
+  /// empty for the other scalar types.
+  std::vector<unsigned char> ValueTable;
+  /// RGB of the voxels outside the input (mapped background value 0)
+  unsigned char OutsideColor[4];
+  vtkTimeStamp TablesBuildTime;
+  int TablesScalarType;
+  /// Display parameters and lookup table used to build the tables
+  double TablesParameters[5];
+  vtkScalarsToColors* TablesLookupTable;
+  unsigned long TablesLookupTableTime;
+
+private:
+  vtkImageResliceMapToColors(const vtkImageResliceMapToColors&);  /// Not implemented.
+  void operator=(const vtkImageResliceMapToColors&);  /// Not implemented.
+};
+
+#endif
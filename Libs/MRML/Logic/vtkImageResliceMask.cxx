@@ -15,11 +15,13 @@
 #include "vtkImageResliceMask.h"
 
 #include <vtkDataSetAttributes.h>
+#include "vtkDataArray.h"
 #include "vtkImageData.h"
 #include "vtkImageStencilData.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkObjectFactory.h"
+#include "vtkPointData.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkTransform.h"
 #include "vtkSmartPointer.h"
@@ -31,7 +33,11 @@
 # undef VTK_USE_UINT64
 # define VTK_USE_UINT64 0
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
+#include <list>
+#include <vector>
 
 vtkCxxRevisionMacro(vtkImageResliceMask, "$Revision$");
 vtkStandardNewMacro(vtkImageResliceMask);
@@ -39,6 +45,80 @@ vtkCxxSetObjectMacro(vtkImageResliceMask, InformationInput, vtkImageData);
 vtkCxxSetObjectMacro(vtkImageResliceMask,ResliceAxes,vtkMatrix4x4);
 vtkCxxSetObjectMacro(vtkImageResliceMask,ResliceTransform,vtkAbstractTransform);
 
+//----------------------------------------------------------------------------
+class vtkImageResliceMask::vtkInternal
+{
+public:
+  vtkInternal();
+  bool operator==(const vtkInternal& other)const;
+
+  /// Request
+  vtkImageData* Input;
+  unsigned long InputTime;
+  double IndexMatrix[16];
+  int Extent[6];
+  int ScalarType;
+  int NumberOfComponents;
+  int ScalarComponent;
+  int InterpolationMode;
+  int Wrap;
+  int Mirror;
+  int Border;
+  int Optimization;
+  double BackgroundColor[4];
+
+  /// Result, the output arrays may have been reallocated since the
+  /// execution, compare them with the current output arrays before use.
+  vtkDataArray* Scalars;
+  vtkDataArray* MaskScalars;
+};
+
+namespace
+{
+// All the vtkImageResliceMask instances
+std::list<vtkImageResliceMask*>& vtkImageResliceMaskInstances()
+{
+  static std::list<vtkImageResliceMask*> instances;
+  return instances;
+}
+
+//----------------------------------------------------------------------------
+// Return the input component resliced by the filter, -1 for all of them
+int vtkResliceScalarComponent(int scalarComponent, int numberOfComponents)
+{
+  if (scalarComponent < 0 || numberOfComponents <= 1)
+    {
+    return -1;
+    }
+  return std::min(scalarComponent, numberOfComponents - 1);
+}
+}
+
+//----------------------------------------------------------------------------
+vtkImageResliceMask::vtkInternal::vtkInternal()
+{
+  memset(this, 0, sizeof(vtkInternal));
+}
+
+//----------------------------------------------------------------------------
+bool vtkImageResliceMask::vtkInternal::operator==(const vtkInternal& other)const
+{
+  return this->Input == other.Input &&
+    this->InputTime == other.InputTime &&
+    memcmp(this->IndexMatrix, other.IndexMatrix, sizeof(this->IndexMatrix)) == 0 &&
+    memcmp(this->Extent, other.Extent, sizeof(this->Extent)) == 0 &&
+    this->ScalarType == other.ScalarType &&
+    this->NumberOfComponents == other.NumberOfComponents &&
+    this->ScalarComponent == other.ScalarComponent &&
+    this->InterpolationMode == other.InterpolationMode &&
+    this->Wrap == other.Wrap &&
+    this->Mirror == other.Mirror &&
+    this->Border == other.Border &&
+    this->Optimization == other.Optimization &&
+    memcmp(this->BackgroundColor, other.BackgroundColor,
+           sizeof(this->BackgroundColor)) == 0;
+}
+
 //--------------------------------------------------------------------------
 // The 'floor' function on x86 and mips is many times slower than these
 // and is used a lot in this code, optimize for different CPU architectures
@@ -151,6 +231,14 @@ vtkImageResliceMask::vtkImageResliceMask()
   // set to zero when we completely missed the input extent
   this->HitInputExtent = 1;
 
+  this->ShareOutput = 0;
+  this->OutputShared = 0;
+  this->TransformGridErrorBound = 0.;
+  this->TransformGridSpacing = 32;
+  this->ScalarComponent = -1;
+  this->Internal = new vtkInternal;
+  vtkImageResliceMaskInstances().push_back(this);
+
   // There is an optional second input.
   this->SetNumberOfInputPorts(2);
   this->SetNumberOfOutputPorts(2);
@@ -163,6 +251,8 @@ vtkImageResliceMask::vtkImageResliceMask()
 //----------------------------------------------------------------------------
 vtkImageResliceMask::~vtkImageResliceMask()
 {
+  vtkImageResliceMaskInstances().remove(this);
+  delete this->Internal;
   this->SetResliceTransform(NULL);
   this->SetResliceAxes(NULL);
   if (this->IndexMatrix)
@@ -238,6 +328,12 @@ void vtkImageResliceMask::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "BackgroundColor: " <<
     this->BackgroundColor[0] << " " << this->BackgroundColor[1] << " " <<
     this->BackgroundColor[2] << " " << this->BackgroundColor[3] << "\n";
+  os << indent << "ShareOutput: " << (this->ShareOutput ? "On\n":"Off\n");
+  os << indent << "OutputShared: " << this->OutputShared << "\n";
+  os << indent << "TransformGridErrorBound: "
+     << this->TransformGridErrorBound << "\n";
+  os << indent << "TransformGridSpacing: " << this->TransformGridSpacing << "\n";
+  os << indent << "ScalarComponent: " << this->ScalarComponent << "\n";
   os << indent << "BackgroundLevel: " << this->BackgroundColor[0] << "\n";
   os << indent << "Stencil: " << this->GetStencil() << "\n";
 }
@@ -878,6 +974,10 @@ int vtkImageResliceMask::RequestInformation(
       }
     scalarType = inScalarInfo->Get(vtkDataObject::FIELD_ARRAY_TYPE());
     }
+  if (vtkResliceScalarComponent(this->ScalarComponent, numComponents) >= 0)
+    {
+    numComponents = 1;
+    }
   vtkDataObject::SetPointDataActiveScalarInfo(outInfo, scalarType, numComponents);
 
   outInfo2->Set(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(),outWholeExt,6);
@@ -2075,7 +2175,8 @@ void vtkImageResliceMaskExecute(vtkImageResliceMask *self,
   inData->GetIncrements(inInc);
   outData->GetContinuousIncrements(outExt, outIncX, outIncY, outIncZ);
   scalarSize = outData->GetScalarSize();
-  numscalars = inData->GetNumberOfScalarComponents();
+  // a single component is read when ScalarComponent is set
+  numscalars = outData->GetNumberOfScalarComponents();
 
   // allocate a voxel to copy into the background (out-of-bounds) regions
   vtkAllocBackgroundPixel(self, &background, numscalars);
@@ -2170,6 +2271,387 @@ void vtkResliceApplyTransform(vtkAbstractTransform *newtrans,
   inPoint[2] *= inInvSpacing[2];
 }
 
+//----------------------------------------------------------------------------
+// Row kernels: for single component images sampled along a straight row
+// (no perspective, no non-linear transform), the portion of the row where
+// all the samples fall inside the input is located first. It is then
+// interpolated without bounds checks, wrap or border handling, the rest of
+// the row goes through the generic per-sample functions. The samples are
+// computed exactly as in vtkOptimizedExecute() so the output and the
+// background mask are unchanged.
+
+// Return 1 if the sample 'idX' of the row is inside the input for the
+// interpolation mode, with the same test as the interpolation functions.
+template <class F>
+inline int vtkResliceRowSampleIsInside(const F point0[3], const F xAxis[3],
+                                       int idX, const int inExt[6],
+                                       int interpolationMode)
+{
+  for (int i = 0; i < 3; ++i)
+    {
+    F point = point0[i] + idX*xAxis[i];
+    const int inExtI = inExt[2*i+1] - inExt[2*i] + 1;
+    if (interpolationMode == VTK_RESLICE_NEAREST)
+      {
+      int inId = vtkResliceRound(point) - inExt[2*i];
+      if (inId < 0 || inId >= inExtI)
+        {
+        return 0;
+        }
+      }
+    else
+      {
+      F f;
+      int inId0 = vtkResliceFloor(point, f) - inExt[2*i];
+      int inId1 = inId0 + (f != 0);
+      if (inId0 < 0 || inId1 >= inExtI)
+        {
+        return 0;
+        }
+      }
+    }
+  return 1;
+}
+
+// Find the samples [r1, r2] of [idXmin, idXmax] that are inside the input.
+// The sample positions are monotonic along the row, so checking the
+// extremities of the range is enough. Return 0 if the range is empty.
+template <class F>
+int vtkResliceRowInsideRange(const F point0[3], const F xAxis[3],
+                             int idXmin, int idXmax, const int inExt[6],
+                             int interpolationMode, int &r1, int &r2)
+{
+  double lower = idXmin;
+  double upper = idXmax;
+  for (int i = 0; i < 3; ++i)
+    {
+    // voxel coordinates allowed for the axis, the rounding errors are
+    // fixed by the exact test below
+    double low = inExt[2*i];
+    double high = inExt[2*i+1];
+    if (interpolationMode == VTK_RESLICE_NEAREST)
+      {
+      low -= 0.5;
+      high += 0.5;
+      }
+    if (xAxis[i] == 0)
+      {
+      if (point0[i] < low || point0[i] > high)
+        {
+        return 0;
+        }
+      continue;
+      }
+    double t0 = (low - point0[i])/xAxis[i];
+    double t1 = (high - point0[i])/xAxis[i];
+    if (t0 > t1)
+      {
+      double tmp = t0;
+      t0 = t1;
+      t1 = tmp;
+      }
+    lower = (t0 > lower ? t0 : lower);
+    upper = (t1 < upper ? t1 : upper);
+    }
+  if (lower > upper)
+    {
+    return 0;
+    }
+  r1 = static_cast<int>(ceil(lower));
+  r2 = static_cast<int>(floor(upper));
+  while (r1 <= r2 &&
+         !vtkResliceRowSampleIsInside(point0, xAxis, r1, inExt, interpolationMode))
+    {
+    r1++;
+    }
+  while (r2 >= r1 &&
+         !vtkResliceRowSampleIsInside(point0, xAxis, r2, inExt, interpolationMode))
+    {
+    r2--;
+    }
+  return (r1 <= r2);
+}
+
+// Nearest neighbor interpolation of the samples [r1, r2] of the row, all
+// inside the input.
+template <class F, class T>
+void vtkResliceNearestRow(T *&outPtr, const T *inPtr, const int inExt[6],
+                          const vtkIdType inInc[3], const F point0[3],
+                          const F xAxis[3], int r1, int r2,
+                          unsigned char *&backgroundMaskPtr)
+{
+  T *out = outPtr;
+  for (int idX = r1; idX <= r2; idX++)
+    {
+    const int inIdX = vtkResliceRound(point0[0] + idX*xAxis[0]) - inExt[0];
+    const int inIdY = vtkResliceRound(point0[1] + idX*xAxis[1]) - inExt[2];
+    const int inIdZ = vtkResliceRound(point0[2] + idX*xAxis[2]) - inExt[4];
+    *out++ = inPtr[inIdX*inInc[0] + inIdY*inInc[1] + inIdZ*inInc[2]];
+    }
+  memset(backgroundMaskPtr, 255, r2 - r1 + 1);
+  outPtr = out;
+  backgroundMaskPtr += (r2 - r1 + 1);
+}
+
+// Trilinear interpolation of the samples [r1, r2] of the row, all inside
+// the input. The arithmetic is the one of vtkTrilinearInterpolation().
+template <class F, class T>
+void vtkResliceTrilinearRow(T *&outPtr, const T *inPtr, const int inExt[6],
+                            const vtkIdType inInc[3], const F point0[3],
+                            const F xAxis[3], int r1, int r2,
+                            unsigned char *&backgroundMaskPtr)
+{
+  T *out = outPtr;
+  for (int idX = r1; idX <= r2; idX++)
+    {
+    F fx, fy, fz;
+    const int inIdX0 = vtkResliceFloor(point0[0] + idX*xAxis[0], fx) - inExt[0];
+    const int inIdY0 = vtkResliceFloor(point0[1] + idX*xAxis[1], fy) - inExt[2];
+    const int inIdZ0 = vtkResliceFloor(point0[2] + idX*xAxis[2], fz) - inExt[4];
+    const int inIdX1 = inIdX0 + (fx != 0);
+    const int inIdY1 = inIdY0 + (fy != 0);
+    const int inIdZ1 = inIdZ0 + (fz != 0);
+
+    const vtkIdType factY0 = inIdY0*inInc[1];
+    const vtkIdType factY1 = inIdY1*inInc[1];
+    const vtkIdType factZ0 = inIdZ0*inInc[2];
+    const vtkIdType factZ1 = inIdZ1*inInc[2];
+    const vtkIdType i00 = factY0 + factZ0;
+    const vtkIdType i01 = factY0 + factZ1;
+    const vtkIdType i10 = factY1 + factZ0;
+    const vtkIdType i11 = factY1 + factZ1;
+
+    const F rx = 1 - fx;
+    const F ry = 1 - fy;
+    const F rz = 1 - fz;
+    const F ryrz = ry*rz;
+    const F fyrz = fy*rz;
+    const F ryfz = ry*fz;
+    const F fyfz = fy*fz;
+
+    const T *inPtr0 = inPtr + inIdX0*inInc[0];
+    const T *inPtr1 = inPtr + inIdX1*inInc[0];
+    F result = (rx*(ryrz*inPtr0[i00] + ryfz*inPtr0[i01] +
+                    fyrz*inPtr0[i10] + fyfz*inPtr0[i11]) +
+                fx*(ryrz*inPtr1[i00] + ryfz*inPtr1[i01] +
+                    fyrz*inPtr1[i10] + fyfz*inPtr1[i11]));
+    vtkResliceRound(result, *out++);
+    }
+  memset(backgroundMaskPtr, 255, r2 - r1 + 1);
+  outPtr = out;
+  backgroundMaskPtr += (r2 - r1 + 1);
+}
+
+// Interpolate the samples [r1, r2] of the row with the row kernel of the
+// interpolation mode.
+template <class F>
+void vtkResliceRow(void *&outPtr, const void *inPtr, int scalarType,
+                   const int inExt[6], const vtkIdType inInc[3],
+                   const F point0[3], const F xAxis[3], int r1, int r2,
+                   int interpolationMode, void *&backgroundMaskPtr)
+{
+  unsigned char *&maskPtr = reinterpret_cast<unsigned char *&>(backgroundMaskPtr);
+  if (interpolationMode == VTK_RESLICE_NEAREST)
+    {
+    switch (scalarType)
+      {
+      vtkTemplateAliasMacro(vtkResliceNearestRow(
+        reinterpret_cast<VTK_TT *&>(outPtr), static_cast<const VTK_TT *>(inPtr),
+        inExt, inInc, point0, xAxis, r1, r2, maskPtr));
+      }
+    }
+  else
+    {
+    switch (scalarType)
+      {
+      vtkTemplateAliasMacro(vtkResliceTrilinearRow(
+        reinterpret_cast<VTK_TT *&>(outPtr), static_cast<const VTK_TT *>(inPtr),
+        inExt, inInc, point0, xAxis, r1, r2, maskPtr));
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Displacement grid: a non-linear ResliceTransform is evaluated at the nodes
+// of a regular grid of the output slice, the displacements (in input voxels)
+// between the transformed point and the point given by the matrix only are
+// bilinearly interpolated for the other pixels.
+template <class F>
+struct vtkResliceTransformGrid
+{
+  vtkResliceTransformGrid() : Spacing(0) {}
+
+  int Spacing; // in output pixels, 0 when the transform is evaluated exactly
+  int Origin[2];
+  int Last[2];
+  int Size[2];
+  std::vector<F> Displacements; // 3 per node, X first
+};
+
+// Point of the output pixel (idX, idY) given by the matrix only, computed as
+// in vtkOptimizedExecute().
+template <class F>
+inline void vtkResliceMatrixPoint(const F inPoint0[4], const F xAxis[4],
+                                  const F yAxis[4], int perspective,
+                                  int idX, int idY, F point[3])
+{
+  F inPoint1[4];
+  inPoint1[0] = inPoint0[0] + idY*yAxis[0];
+  inPoint1[1] = inPoint0[1] + idY*yAxis[1];
+  inPoint1[2] = inPoint0[2] + idY*yAxis[2];
+  inPoint1[3] = inPoint0[3] + idY*yAxis[3];
+  point[0] = inPoint1[0] + idX*xAxis[0];
+  point[1] = inPoint1[1] + idX*xAxis[1];
+  point[2] = inPoint1[2] + idX*xAxis[2];
+  if (perspective)
+    {
+    F f = 1/(inPoint1[3] + idX*xAxis[3]);
+    point[0] *= f;
+    point[1] *= f;
+    point[2] *= f;
+    }
+}
+
+// Exact displacement of the output pixel (idX, idY)
+template <class F>
+inline void vtkResliceExactDisplacement(vtkAbstractTransform *newtrans,
+                                        const F inPoint0[4], const F xAxis[4],
+                                        const F yAxis[4], int perspective,
+                                        F inOrigin[3], F inInvSpacing[3],
+                                        int idX, int idY, F displacement[3])
+{
+  F point[3];
+  vtkResliceMatrixPoint(inPoint0, xAxis, yAxis, perspective, idX, idY, point);
+  F transformed[3] = {point[0], point[1], point[2]};
+  vtkResliceApplyTransform(newtrans, transformed, inOrigin, inInvSpacing);
+  for (int c = 0; c < 3; ++c)
+    {
+    displacement[c] = transformed[c] - (point[c] - inOrigin[c])*inInvSpacing[c];
+    }
+}
+
+// Index of the cell containing the pixel and the position in the cell
+template <class F>
+inline void vtkResliceGridCell(const vtkResliceTransformGrid<F> &grid,
+                               int axis, int id, int &node0, int &node1, F &t)
+{
+  if (grid.Size[axis] == 1)
+    {
+    node0 = node1 = 0;
+    t = 0;
+    return;
+    }
+  node0 = (id - grid.Origin[axis]) / grid.Spacing;
+  if (node0 > grid.Size[axis] - 2)
+    {
+    node0 = grid.Size[axis] - 2;
+    }
+  node1 = node0 + 1;
+  const int start = grid.Origin[axis] + node0*grid.Spacing;
+  int end = start + grid.Spacing;
+  if (end > grid.Last[axis])
+    {
+    end = grid.Last[axis];
+    }
+  t = F(id - start) / F(end - start);
+}
+
+// Bilinear interpolation of the displacement of the output pixel (idX, idY)
+template <class F>
+inline void vtkResliceInterpolateDisplacement(
+  const vtkResliceTransformGrid<F> &grid, int idX, int idY, F displacement[3])
+{
+  int i0, i1, j0, j1;
+  F tx, ty;
+  vtkResliceGridCell(grid, 0, idX, i0, i1, tx);
+  vtkResliceGridCell(grid, 1, idY, j0, j1, ty);
+  const F *d00 = &grid.Displacements[3*(j0*grid.Size[0] + i0)];
+  const F *d10 = &grid.Displacements[3*(j0*grid.Size[0] + i1)];
+  const F *d01 = &grid.Displacements[3*(j1*grid.Size[0] + i0)];
+  const F *d11 = &grid.Displacements[3*(j1*grid.Size[0] + i1)];
+  for (int c = 0; c < 3; ++c)
+    {
+    const F d0 = d00[c] + tx*(d10[c] - d00[c]);
+    const F d1 = d01[c] + tx*(d11[c] - d01[c]);
+    displacement[c] = d0 + ty*(d1 - d0);
+    }
+}
+
+// Sample the transform on the grid of the XY extent of a slice. The grid
+// spacing starts at 'spacing' pixels and is halved until the error at the
+// center of all the cells is below errorBound. If the grid can't be coarser
+// than 1 pixel, grid.Spacing is set to 0: the transform must be evaluated
+// for all the pixels.
+template <class F>
+void vtkResliceBuildTransformGrid(vtkResliceTransformGrid<F> &grid,
+                                  vtkAbstractTransform *newtrans,
+                                  const F inPoint0[4], const F xAxis[4],
+                                  const F yAxis[4], int perspective,
+                                  F inOrigin[3], F inInvSpacing[3],
+                                  const int outExt[6], int spacing,
+                                  double errorBound)
+{
+  grid.Origin[0] = outExt[0];
+  grid.Origin[1] = outExt[2];
+  grid.Last[0] = outExt[1];
+  grid.Last[1] = outExt[3];
+  const F errorBound2 = F(errorBound*errorBound);
+  for (; spacing >= 2; spacing /= 2)
+    {
+    grid.Spacing = spacing;
+    for (int axis = 0; axis < 2; ++axis)
+      {
+      grid.Size[axis] =
+        (grid.Last[axis] - grid.Origin[axis] + spacing - 1) / spacing + 1;
+      }
+    grid.Displacements.resize(3*grid.Size[0]*grid.Size[1]);
+    F *displacement = &grid.Displacements[0];
+    for (int j = 0; j < grid.Size[1]; ++j)
+      {
+      const int idY = std::min(grid.Origin[1] + j*spacing, grid.Last[1]);
+      for (int i = 0; i < grid.Size[0]; ++i, displacement += 3)
+        {
+        const int idX = std::min(grid.Origin[0] + i*spacing, grid.Last[0]);
+        vtkResliceExactDisplacement(newtrans, inPoint0, xAxis, yAxis,
+                                    perspective, inOrigin, inInvSpacing,
+                                    idX, idY, displacement);
+        }
+      }
+    // measure the error at the center of the cells
+    bool accurate = true;
+    for (int j = 0; accurate && j < grid.Size[1]; ++j)
+      {
+      const int y0 = std::min(grid.Origin[1] + j*spacing, grid.Last[1]);
+      const int y1 = std::min(y0 + spacing, grid.Last[1]);
+      for (int i = 0; accurate && i < grid.Size[0]; ++i)
+        {
+        const int x0 = std::min(grid.Origin[0] + i*spacing, grid.Last[0]);
+        const int x1 = std::min(x0 + spacing, grid.Last[0]);
+        const int idX = (x0 + x1) / 2;
+        const int idY = (y0 + y1) / 2;
+        if ((idX == x0 || idX == x1) && (idY == y0 || idY == y1))
+          {
+          continue; // the center is a node
+          }
+        F exact[3], interpolated[3];
+        vtkResliceExactDisplacement(newtrans, inPoint0, xAxis, yAxis,
+                                    perspective, inOrigin, inInvSpacing,
+                                    idX, idY, exact);
+        vtkResliceInterpolateDisplacement(grid, idX, idY, interpolated);
+        const F dx = exact[0] - interpolated[0];
+        const F dy = exact[1] - interpolated[1];
+        const F dz = exact[2] - interpolated[2];
+        accurate = (dx*dx + dy*dy + dz*dz <= errorBound2);
+        }
+      }
+    if (accurate)
+      {
+      return;
+      }
+    }
+  grid.Spacing = 0;
+}
+
 // The vtkOptimizedExecute() is like vtkImageResliceMaskExecute, except that
 // it provides a few optimizations:
 // 1) the ResliceAxes and ResliceTransform are joined to create a 
@@ -2252,7 +2734,8 @@ void vtkOptimizedExecute(vtkImageResliceMask *self,
   inData->GetIncrements(inInc);
   outData->GetContinuousIncrements(outExt, outIncX, outIncY, outIncZ);
   scalarSize = outData->GetScalarSize();
-  numscalars = inData->GetNumberOfScalarComponents();
+  // a single component is read when ScalarComponent is set
+  numscalars = outData->GetNumberOfScalarComponents();
   
   // break matrix into a set of axes plus an origin
   // (this allows us to calculate the transform Incrementally)
@@ -2285,6 +2768,17 @@ void vtkOptimizedExecute(vtkImageResliceMask *self,
   // get the stencil
   vtkImageStencilData *stencil = self->GetStencil();
 
+  // Use the row kernels for the portion of the rows inside the input
+  const int interpolationMode = self->GetInterpolationMode();
+  const int useRowKernels = (numscalars == 1 && !wrap && !newtrans &&
+    !perspective && (interpolationMode == VTK_RESLICE_NEAREST ||
+                     interpolationMode == VTK_RESLICE_LINEAR));
+  const int scalarType = inData->GetScalarType();
+
+  // Approximate the non-linear transform with a displacement grid
+  const double gridErrorBound = self->GetTransformGridErrorBound();
+  vtkResliceTransformGrid<F> grid;
+
   // Loop through output pixels
   for (idZ = outExt[4]; idZ <= outExt[5]; idZ++)
     {
@@ -2293,6 +2787,14 @@ void vtkOptimizedExecute(vtkImageResliceMask *self,
     inPoint0[2] = origin[2] + idZ*zAxis[2]; 
     inPoint0[3] = origin[3] + idZ*zAxis[3]; 
     
+    if (newtrans && gridErrorBound > 0)
+      {
+      vtkResliceBuildTransformGrid(grid, newtrans, inPoint0, xAxis, yAxis,
+                                   perspective, inOrigin, inInvSpacing,
+                                   outExt, self->GetTransformGridSpacing(),
+                                   gridErrorBound);
+      }
+
     for (idY = outExt[2]; idY <= outExt[3]; idY++)
       {
       inPoint1[0] = inPoint0[0] + idY*yAxis[0]; // incremental transform
@@ -2315,60 +2817,96 @@ void vtkOptimizedExecute(vtkImageResliceMask *self,
                                      outPtr, background, numscalars, 
                                      setpixels, iter, BackgroundMaskPtr, false))
         {
-        if (!optimizeNearest)
+        int r1 = idXmax + 1;
+        int r2 = idXmax;
+        if (useRowKernels &&
+            !vtkResliceRowInsideRange(inPoint1, xAxis, idXmin, idXmax, inExt,
+                                      interpolationMode, r1, r2))
+          {
+          r1 = idXmax + 1;
+          r2 = idXmax;
+          }
+        // [idXmin, r1 - 1] generic, [r1, r2] row kernel, [r2 + 1, idXmax]
+        // generic
+        for (int span = 0; span < 2; ++span)
           {
-          for (idX = idXmin; idX <= idXmax; idX++)
+          if (span == 1)
             {
-            inPoint[0] = inPoint1[0] + idX*xAxis[0];
-            inPoint[1] = inPoint1[1] + idX*xAxis[1];
-            inPoint[2] = inPoint1[2] + idX*xAxis[2];
-            if (perspective)
-              { // only do perspective if necessary
-              inPoint[3] = inPoint1[3] + idX*xAxis[3];
-              f = 1/inPoint[3];
-              inPoint[0] *= f;
-              inPoint[1] *= f;
-              inPoint[2] *= f;
+            if (r1 <= r2)
+              {
+              vtkResliceRow(outPtr, inPtr, scalarType, inExt, inInc,
+                            inPoint1, xAxis, r1, r2, interpolationMode,
+                            BackgroundMaskPtr);
               }
-            if (newtrans)
-              { // apply the AbstractTransform if there is one
-              vtkResliceApplyTransform(newtrans, inPoint, inOrigin,
-                                       inInvSpacing);
+            idXmin = r2 + 1;
+            }
+          int idXend = (span == 0 ? r1 - 1 : idXmax);
+          if (!optimizeNearest)
+            {
+            for (idX = idXmin; idX <= idXend; idX++)
+              {
+              inPoint[0] = inPoint1[0] + idX*xAxis[0];
+              inPoint[1] = inPoint1[1] + idX*xAxis[1];
+              inPoint[2] = inPoint1[2] + idX*xAxis[2];
+              if (perspective)
+                { // only do perspective if necessary
+                inPoint[3] = inPoint1[3] + idX*xAxis[3];
+                f = 1/inPoint[3];
+                inPoint[0] *= f;
+                inPoint[1] *= f;
+                inPoint[2] *= f;
+                }
+              if (newtrans && grid.Spacing)
+                { // interpolate the displacement of the AbstractTransform
+                F displacement[3];
+                vtkResliceInterpolateDisplacement(grid, idX, idY,
+                                                  displacement);
+                for (i = 0; i < 3; i++)
+                  {
+                  inPoint[i] = (inPoint[i] - inOrigin[i])*inInvSpacing[i] +
+                    displacement[i];
+                  }
+                }
+              else if (newtrans)
+                { // apply the AbstractTransform if there is one
+                vtkResliceApplyTransform(newtrans, inPoint, inOrigin,
+                                         inInvSpacing);
+                }
+              // call the interpolation function
+              interpolate(outPtr, inPtr, inExt, inInc, numscalars,
+                          inPoint, mode, background, BackgroundMaskPtr, true);
               }
-            // call the interpolation function
-            interpolate(outPtr, inPtr, inExt, inInc, numscalars,
-                        inPoint, mode, background, BackgroundMaskPtr, true);
             }
-          }
-        else // optimize for nearest-neighbor interpolation
-          {
-          int inExtX = inExt[1] - inExt[0] + 1;
-          int inExtY = inExt[3] - inExt[2] + 1;
-          int inExtZ = inExt[5] - inExt[4] + 1;
-
-          for (int iidX = idXmin; iidX <= idXmax; iidX++)
+          else // optimize for nearest-neighbor interpolation
             {
-            void *inPtrTmp = background;
+            int inExtX = inExt[1] - inExt[0] + 1;
+            int inExtY = inExt[3] - inExt[2] + 1;
+            int inExtZ = inExt[5] - inExt[4] + 1;
 
-            inPoint[0] = inPoint1[0] + iidX*xAxis[0];
-            inPoint[1] = inPoint1[1] + iidX*xAxis[1];
-            inPoint[2] = inPoint1[2] + iidX*xAxis[2];
-
-            int inIdX = vtkResliceRound(inPoint[0]) - inExt[0];
-            int inIdY = vtkResliceRound(inPoint[1]) - inExt[2];
-            int inIdZ = vtkResliceRound(inPoint[2]) - inExt[4];
-
-            if (inIdX >= 0 && inIdX < inExtX &&
-                inIdY >= 0 && inIdY < inExtY &&
-                inIdZ >= 0 && inIdZ < inExtZ)
+            for (int iidX = idXmin; iidX <= idXend; iidX++)
               {
-              inPtrTmp = (void *)((char *)inPtr + \
-                                  (inIdX*inInc[0] + 
-                                   inIdY*inInc[1] +
-                                   inIdZ*inInc[2])*scalarSize);
+              void *inPtrTmp = background;
+
+              inPoint[0] = inPoint1[0] + iidX*xAxis[0];
+              inPoint[1] = inPoint1[1] + iidX*xAxis[1];
+              inPoint[2] = inPoint1[2] + iidX*xAxis[2];
+
+              int inIdX = vtkResliceRound(inPoint[0]) - inExt[0];
+              int inIdY = vtkResliceRound(inPoint[1]) - inExt[2];
+              int inIdZ = vtkResliceRound(inPoint[2]) - inExt[4];
+
+              if (inIdX >= 0 && inIdX < inExtX &&
+                  inIdY >= 0 && inIdY < inExtY &&
+                  inIdZ >= 0 && inIdZ < inExtZ)
+                {
+                inPtrTmp = (void *)((char *)inPtr + \
+                                    (inIdX*inInc[0] + 
+                                     inIdY*inInc[1] +
+                                     inIdZ*inInc[2])*scalarSize);
+                }
+
+              setpixels(outPtr, inPtrTmp, numscalars, 1, BackgroundMaskPtr, true);
               }
-
-            setpixels(outPtr, inPtrTmp, numscalars, 1, BackgroundMaskPtr, true);
             }
           }
         }
@@ -3047,7 +3585,8 @@ void vtkReslicePermuteExecute(vtkImageResliceMask *self,
   inData->GetIncrements(inInc);
   outData->GetContinuousIncrements(outExt, outInc[0], outInc[1], outInc[2]);
   scalarSize = outData->GetScalarSize();
-  numscalars = inData->GetNumberOfScalarComponents();
+  // a single component is read when ScalarComponent is set
+  numscalars = outData->GetNumberOfScalarComponents();
 
   for (i = 0; i < 3; i++)
     {
@@ -3350,6 +3889,120 @@ vtkMatrix4x4 *vtkImageResliceMask::GetIndexMatrix(vtkInformation *inInfo,
   return this->IndexMatrix;
 }
 
+//----------------------------------------------------------------------------
+bool vtkImageResliceMask::GetSharedOutputKey(vtkInformationVector **inputVector,
+                                             vtkInformationVector *outputVector,
+                                             vtkInternal& key)
+{
+  if (this->OptimizedTransform != NULL || this->IndexMatrix == NULL ||
+      this->GetNumberOfInputConnections(1) > 0)
+    {
+    return false;
+    }
+  vtkInformation *inInfo = inputVector[0]->GetInformationObject(0);
+  vtkInformation *outInfo = outputVector->GetInformationObject(0);
+  vtkInformation *maskInfo = outputVector->GetInformationObject(1);
+  int maskExtent[6];
+  outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), key.Extent);
+  maskInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), maskExtent);
+  if (memcmp(key.Extent, maskExtent, sizeof(maskExtent)) != 0)
+    {
+    return false;
+    }
+  key.Input = vtkImageData::SafeDownCast(
+    inInfo->Get(vtkDataObject::DATA_OBJECT()));
+  if (key.Input == NULL)
+    {
+    return false;
+    }
+  key.InputTime = key.Input->GetMTime();
+  for (int i = 0; i < 4; ++i)
+    {
+    for (int j = 0; j < 4; ++j)
+      {
+      key.IndexMatrix[4*i + j] = this->IndexMatrix->GetElement(i, j);
+      }
+    }
+  key.ScalarType = key.Input->GetScalarType();
+  key.NumberOfComponents = key.Input->GetNumberOfScalarComponents();
+  key.ScalarComponent =
+    vtkResliceScalarComponent(this->ScalarComponent, key.NumberOfComponents);
+  key.InterpolationMode = this->InterpolationMode;
+  key.Wrap = this->Wrap;
+  key.Mirror = this->Mirror;
+  key.Border = this->Border;
+  key.Optimization = this->Optimization;
+  std::copy(this->BackgroundColor, this->BackgroundColor + 4,
+            key.BackgroundColor);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkImageResliceMask::ShareOutputOfPeer(const vtkInternal& key,
+                                            vtkInformationVector *outputVector)
+{
+  std::list<vtkImageResliceMask*>& instances = vtkImageResliceMaskInstances();
+  for (std::list<vtkImageResliceMask*>::iterator it = instances.begin();
+       it != instances.end(); ++it)
+    {
+    vtkImageResliceMask* peer = *it;
+    if (peer == this || !peer->ShareOutput || !(*peer->Internal == key))
+      {
+      continue;
+      }
+    // Make sure the peer outputs still contain the slice
+    vtkDataArray* scalars = peer->GetOutput(0)->GetPointData()->GetScalars();
+    vtkDataArray* maskScalars = peer->GetOutput(1)->GetPointData()->GetScalars();
+    if (scalars == NULL || scalars != peer->Internal->Scalars ||
+        maskScalars == NULL || maskScalars != peer->Internal->MaskScalars)
+      {
+      continue;
+      }
+    vtkImageData *output = vtkImageData::SafeDownCast(
+      outputVector->GetInformationObject(0)->Get(vtkDataObject::DATA_OBJECT()));
+    vtkImageData *mask = vtkImageData::SafeDownCast(
+      outputVector->GetInformationObject(1)->Get(vtkDataObject::DATA_OBJECT()));
+    output->SetExtent(const_cast<int*>(key.Extent));
+    output->GetPointData()->SetScalars(scalars);
+    mask->SetExtent(const_cast<int*>(key.Extent));
+    mask->GetPointData()->SetScalars(maskScalars);
+    return true;
+    }
+  return false;
+}
+
+//----------------------------------------------------------------------------
+int vtkImageResliceMask::RequestData(vtkInformation *request,
+                                     vtkInformationVector **inputVector,
+                                     vtkInformationVector *outputVector)
+{
+  this->OutputShared = 0;
+  vtkInternal key;
+  bool shareable = this->ShareOutput &&
+    this->GetSharedOutputKey(inputVector, outputVector, key);
+  if (shareable && this->ShareOutputOfPeer(key, outputVector))
+    {
+    // Another filter may share it in turn
+    *this->Internal = key;
+    this->Internal->Scalars = this->GetOutput(0)->GetPointData()->GetScalars();
+    this->Internal->MaskScalars = this->GetOutput(1)->GetPointData()->GetScalars();
+    this->OutputShared = 1;
+    return 1;
+    }
+
+  int res = this->Superclass::RequestData(request, inputVector, outputVector);
+
+  // Forget the previous output, it has been overwritten
+  *this->Internal = vtkInternal();
+  if (shareable && res && !this->AbortExecute)
+    {
+    *this->Internal = key;
+    this->Internal->Scalars = this->GetOutput(0)->GetPointData()->GetScalars();
+    this->Internal->MaskScalars = this->GetOutput(1)->GetPointData()->GetScalars();
+    }
+  return res;
+}
+
 //----------------------------------------------------------------------------
 // This method is passed a input and output region, and executes the filter
 // algorithm to fill the output from the input.
@@ -3421,6 +4074,15 @@ void vtkImageResliceMask::ThreadedRequestData(
   
   // Now that we know that we need the input, get the input pointer
   void *inPtr = inData[0][0]->GetScalarPointerForExtent(inExt);
+  // Point to the resliced component, the increments of the input keep
+  // stepping over all the interleaved components
+  int scalarComponent = vtkResliceScalarComponent(
+    this->ScalarComponent, inData[0][0]->GetNumberOfScalarComponents());
+  if (scalarComponent >= 0)
+    {
+    inPtr = static_cast<char*>(inPtr) +
+      scalarComponent * inData[0][0]->GetScalarSize();
+    }
 
   if (this->Optimization)
     {
@@ -63,6 +63,10 @@ class vtkMatrix4x4;
 ///
 /// This filter is very inefficient if the output X dimension is 1.
 ///
+/// With ShareOutput on, filters computing the same slice of the same input
+/// (e.g. linked slice views of the same volume) share their output: the
+/// filter executed first reslices, the others reference its output arrays.
+///
 /// \sa vtkAbstractTransform
 /// \sa vtkMatrix4x4
 class VTK_MRML_LOGIC_EXPORT vtkImageResliceMask : public vtkThreadedImageAlgorithm
@@ -293,6 +297,41 @@ public:
   vtkImageStencilData *GetStencil();
 
   vtkImageData *GetBackgroundMask();
+
+  /// Reuse the output of another vtkImageResliceMask with ShareOutput on if
+  /// it computed the same extent of the same input with the same geometry
+  /// and sampling (default: off). The output arrays are then shared, not
+  /// copied. The filters sharing their output must be updated from the same
+  /// thread and the output must not be modified in place.
+  vtkSetMacro(ShareOutput, int);
+  vtkGetMacro(ShareOutput, int);
+  vtkBooleanMacro(ShareOutput, int);
+
+  /// Return 1 if the last execution reused the output of another filter.
+  vtkGetMacro(OutputShared, int);
+
+  /// Maximum error, in input voxels, allowed when approximating a non-linear
+  /// ResliceTransform (default: 0, the transform is evaluated at every
+  /// output pixel). When positive, the transform is sampled on a grid of
+  /// each output slice and the displacements are bilinearly interpolated
+  /// in between. The grid is refined until the error measured at the
+  /// center of the grid cells is below the bound.
+  vtkSetClampMacro(TransformGridErrorBound, double, 0., VTK_DOUBLE_MAX);
+  vtkGetMacro(TransformGridErrorBound, double);
+
+  /// Spacing, in output pixels, of the coarsest transform grid
+  /// (default: 32).
+  vtkSetClampMacro(TransformGridSpacing, int, 2, 1024);
+  vtkGetMacro(TransformGridSpacing, int);
+
+  /// Component of the input scalars to reslice (default: -1, all the
+  /// components). The component is read in place from the interleaved input
+  /// scalars and the output has a single component, no copy of the input
+  /// component is made. Components past the last input component are
+  /// clamped to the last one.
+  vtkSetClampMacro(ScalarComponent, int, -1, VTK_INT_MAX);
+  vtkGetMacro(ScalarComponent, int);
+
 protected:
   vtkImageResliceMask();
   ~vtkImageResliceMask();
@@ -315,6 +354,11 @@ protected:
   int TransformInputSampling;
   int AutoCropOutput;
   int HitInputExtent;
+  int ShareOutput;
+  int OutputShared;
+  double TransformGridErrorBound;
+  int TransformGridSpacing;
+  int ScalarComponent;
 
   vtkMatrix4x4 *IndexMatrix;
   vtkAbstractTransform *OptimizedTransform;
@@ -331,8 +375,24 @@ protected:
                                    vtkInformationVector *outputVector,
                                    vtkImageData ***inData,
                                    vtkImageData **outData, int ext[6], int id);
+  virtual int RequestData(vtkInformation *, vtkInformationVector **,
+                          vtkInformationVector *);
   virtual int FillInputPortInformation(int port, vtkInformation *info);
 
+  /// Description of the last computed output, used to share it.
+  class vtkInternal;
+  vtkInternal* Internal;
+
+  /// Initialize key with the current request, return false if the request
+  /// can't be shared (non linear transform, stencil...).
+  bool GetSharedOutputKey(vtkInformationVector **inputVector,
+                          vtkInformationVector *outputVector,
+                          vtkInternal& key);
+  /// Reference the outputs of a filter that computed key, return false if
+  /// there is none.
+  bool ShareOutputOfPeer(const vtkInternal& key,
+                         vtkInformationVector *outputVector);
+
   vtkMatrix4x4 *GetIndexMatrix(vtkInformation *inInfo,
                                vtkInformation *outInfo);
   vtkAbstractTransform *GetOptimizedTransform() { 
@@ -17,11 +17,16 @@
 //#include "vtkMRMLApplicationLogic.h"
 
 // MRML includes
+#include "vtkEventBroker.h"
 #include "vtkMRMLNode.h"
 
 // VTK includes
 #include <vtkCallbackCommand.h>
+#include <vtkCollection.h>
+#include <vtkFloatArray.h>
+#include <vtkIntArray.h>
 #include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
 
 // STD includes
 #include <cassert>
@@ -30,6 +35,47 @@
 vtkStandardNewMacro(vtkMRMLAbstractLogic);
 vtkCxxRevisionMacro(vtkMRMLAbstractLogic, "$Revision: 13525 $");
 
+//----------------------------------------------------------------------------
+namespace
+{
+// Record the time spent by a logic in an event handler (OnMRMLSceneNodeAdded,
+// OnMRMLNodeModified...) into the event broker profile. It only costs a
+// flag check when profiling is off.
+class vtkMRMLLogicHandlerProfiler
+{
+public:
+  vtkMRMLLogicHandlerProfiler(vtkMRMLAbstractLogic* logic, vtkObject* subject,
+                              unsigned long event, const char* handlerName)
+    : Logic(logic), Subject(subject), Event(event), HandlerName(handlerName)
+    , StartTime(0.)
+  {
+    this->Profiling = vtkEventBroker::GetInstance()->GetProfiling() != 0;
+    if (this->Profiling)
+      {
+      this->StartTime = vtkTimerLog::GetUniversalTime();
+      }
+  }
+  ~vtkMRMLLogicHandlerProfiler()
+  {
+    if (!this->Profiling)
+      {
+      return;
+      }
+    vtkEventBroker::GetInstance()->RecordHandlerProfile(
+      this->Subject ? this->Subject->GetClassName() : 0, this->Event,
+      this->Logic->GetClassName(), this->HandlerName,
+      vtkTimerLog::GetUniversalTime() - this->StartTime);
+  }
+private:
+  vtkMRMLAbstractLogic* Logic;
+  vtkObject*            Subject;
+  unsigned long         Event;
+  const char*           HandlerName;
+  bool                  Profiling;
+  double                StartTime;
+};
+}
+
 //----------------------------------------------------------------------------
 class vtkMRMLAbstractLogic::vtkInternal
 {
@@ -352,8 +398,42 @@ void vtkMRMLAbstractLogic::SetAndObserveMRMLSceneEventsInternal(vtkMRMLScene *ne
                                                                 vtkFloatArray *priorities
 )
 {
+  // Nodes added with vtkMRMLScene::AddNodes() are notified with a unique
+  // NodesAddedEvent, observe it as well to call OnMRMLSceneNodeAdded()
+  // on each of the added nodes.
+  vtkSmartPointer<vtkIntArray> sceneEvents = events;
+  vtkSmartPointer<vtkFloatArray> scenePriorities = priorities;
+  if (events)
+    {
+    int nodeAddedIndex = -1;
+    bool observeNodesAdded = false;
+    for (int i = 0; i < events->GetNumberOfTuples(); ++i)
+      {
+      if (events->GetValue(i) == vtkMRMLScene::NodeAddedEvent)
+        {
+        nodeAddedIndex = i;
+        }
+      if (events->GetValue(i) == vtkMRMLScene::NodesAddedEvent)
+        {
+        observeNodesAdded = true;
+        }
+      }
+    if (nodeAddedIndex != -1 && !observeNodesAdded)
+      {
+      sceneEvents = vtkSmartPointer<vtkIntArray>::New();
+      sceneEvents->DeepCopy(events);
+      sceneEvents->InsertNextValue(vtkMRMLScene::NodesAddedEvent);
+      if (priorities && nodeAddedIndex < priorities->GetNumberOfTuples())
+        {
+        scenePriorities = vtkSmartPointer<vtkFloatArray>::New();
+        scenePriorities->DeepCopy(priorities);
+        scenePriorities->InsertNextValue(priorities->GetValue(nodeAddedIndex));
+        }
+      }
+    }
   this->GetMRMLSceneObserverManager()->SetAndObserveObjectEvents(
-    vtkObjectPointer(&this->Internal->MRMLScene), newScene, events, priorities);
+    vtkObjectPointer(&this->Internal->MRMLScene), newScene,
+    sceneEvents, scenePriorities);
 }
 
 //----------------------------------------------------------------------------
@@ -433,50 +513,93 @@ void vtkMRMLAbstractLogic
 {
   assert(!caller || vtkMRMLScene::SafeDownCast(caller));
   assert(caller == this->GetMRMLScene());
-#ifndef _NDEBUG
-  (void)caller;
-#endif
 
   vtkMRMLNode * node = 0;
 
   switch(event)
     {
     case vtkMRMLScene::StartBatchProcessEvent:
+      {
+      vtkMRMLLogicHandlerProfiler profiler(this, caller, event, "OnMRMLSceneStartBatchProcess");
       this->OnMRMLSceneStartBatchProcess();
+      }
       break;
     case vtkMRMLScene::EndBatchProcessEvent:
+      {
+      vtkMRMLLogicHandlerProfiler profiler(this, caller, event, "OnMRMLSceneEndBatchProcess");
       this->OnMRMLSceneEndBatchProcess();
+      }
       break;
     case vtkMRMLScene::StartCloseEvent:
+      {
+      vtkMRMLLogicHandlerProfiler profiler(this, caller, event, "OnMRMLSceneStartClose");
       this->OnMRMLSceneStartClose();
+      }
       break;
     case vtkMRMLScene::EndCloseEvent:
+      {
+      vtkMRMLLogicHandlerProfiler profiler(this, caller, event, "OnMRMLSceneEndClose");
       this->OnMRMLSceneEndClose();
+      }
       break;
     case vtkMRMLScene::StartImportEvent:
+      {
+      vtkMRMLLogicHandlerProfiler profiler(this, caller, event, "OnMRMLSceneStartImport");
       this->OnMRMLSceneStartImport();
+      }
       break;
     case vtkMRMLScene::EndImportEvent:
+      {
+      vtkMRMLLogicHandlerProfiler profiler(this, caller, event, "OnMRMLSceneEndImport");
       this->OnMRMLSceneEndImport();
+      }
       break;
     case vtkMRMLScene::StartRestoreEvent:
+      {
+      vtkMRMLLogicHandlerProfiler profiler(this, caller, event, "OnMRMLSceneStartRestore");
       this->OnMRMLSceneStartRestore();
+      }
       break;
     case vtkMRMLScene::EndRestoreEvent:
+      {
+      vtkMRMLLogicHandlerProfiler profiler(this, caller, event, "OnMRMLSceneEndRestore");
       this->OnMRMLSceneEndRestore();
+      }
       break;
     case vtkMRMLScene::NewSceneEvent:
+      {
+      vtkMRMLLogicHandlerProfiler profiler(this, caller, event, "OnMRMLSceneNew");
       this->OnMRMLSceneNew();
+      }
       break;
     case vtkMRMLScene::NodeAddedEvent:
+      {
       node = reinterpret_cast<vtkMRMLNode*>(callData);
       assert(node);
+      vtkMRMLLogicHandlerProfiler profiler(this, caller, event, "OnMRMLSceneNodeAdded");
       this->OnMRMLSceneNodeAdded(node);
+      }
+      break;
+    case vtkMRMLScene::NodesAddedEvent:
+      {
+      vtkCollection* nodes = reinterpret_cast<vtkCollection*>(callData);
+      assert(nodes);
+      vtkCollectionSimpleIterator it;
+      for (nodes->InitTraversal(it);
+           (node = vtkMRMLNode::SafeDownCast(nodes->GetNextItemAsObject(it))) ;)
+        {
+        vtkMRMLLogicHandlerProfiler profiler(this, caller, event, "OnMRMLSceneNodeAdded");
+        this->OnMRMLSceneNodeAdded(node);
+        }
+      }
       break;
     case vtkMRMLScene::NodeRemovedEvent:
+      {
       node = reinterpret_cast<vtkMRMLNode*>(callData);
       assert(node);
+      vtkMRMLLogicHandlerProfiler profiler(this, caller, event, "OnMRMLSceneNodeRemoved");
       this->OnMRMLSceneNodeRemoved(node);
+      }
       break;
     default:
       break;
@@ -514,7 +637,10 @@ void vtkMRMLAbstractLogic
   switch(event)
     {
     case vtkCommand::ModifiedEvent:
+      {
+      vtkMRMLLogicHandlerProfiler profiler(this, caller, event, "OnMRMLNodeModified");
       this->OnMRMLNodeModified(node);
+      }
       break;
     default:
       break;
@@ -175,6 +175,9 @@ protected:
 
   /// Receives all the events fired by the scene.
   /// By default, it calls OnMRMLScene*Event based on the event passed.
+  /// When vtkEventBroker profiling is on, the time spent in each
+  /// OnMRMLScene*Event is recorded into the broker profile, per logic class
+  /// and per event.
   virtual void ProcessMRMLSceneEvents(vtkObject* caller,
                                       unsigned long event,
                                       void * callData);
@@ -184,7 +187,8 @@ protected:
   /// GetMRMLNodesCallbackCommand() or use the utility macros
   /// vtkSet[AndObserve]MRMLNode[Event]Macro
   /// ProcessMRMLNodesEvents calls OnMRMLNodeModified when event is
-  /// vtkCommand::ModifiedEvent.
+  /// vtkCommand::ModifiedEvent. As for ProcessMRMLSceneEvents, the time
+  /// spent in OnMRMLNodeModified is profiled by vtkEventBroker.
   /// \sa ProcessMRMLSceneEvents, ProcessMRMLLogicsEvents,
   /// OnMRMLNodeModified(), vtkSetAndObserveMRMLNodeMacro,
   /// vtkSetAndObserveMRMLNodeMacro, vtkSetAndObserveMRMLNodeEventMacro
@@ -304,6 +308,7 @@ protected:
   virtual void OnMRMLSceneNew(){}
   /// If vtkMRMLScene::NodeAddedEvent has been set to be observed in
   ///  SetMRMLSceneInternal, it is called when the scene fires the event
+  /// It is also called for each node of a vtkMRMLScene::NodesAddedEvent.
   /// \sa ProcessMRMLSceneEvents, SetMRMLSceneInternal
   /// \sa OnMRMLSceneNodeRemoved, vtkMRMLScene::NodeAboutToBeAdded
   virtual void OnMRMLSceneNodeAdded(vtkMRMLNode* /*node*/){}
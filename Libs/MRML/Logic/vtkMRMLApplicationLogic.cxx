@@ -332,10 +332,11 @@ void vtkMRMLApplicationLogic::FitSliceToAll()
 }
 
 //----------------------------------------------------------------------------
-bool vtkMRMLApplicationLogic::Zip(const char *zipFileName, const char *directoryToZip)
+bool vtkMRMLApplicationLogic::Zip(const char *zipFileName, const char *directoryToZip,
+                                  bool removeZippedFiles)
 {
   // call function in vtkArchive
-  return zip(zipFileName, directoryToZip);
+  return zip(zipFileName, directoryToZip, removeZippedFiles);
 }
 
 //----------------------------------------------------------------------------
@@ -77,8 +77,11 @@ public:
   void FitSliceToAll();
 
   /// zip the directory into a zip file
+  /// If removeZippedFiles is true, the files are removed from the directory
+  /// as they are added to the zip file.
   /// Returns success or failure.
-  bool Zip(const char *zipFileName, const char *directoryToZip);
+  bool Zip(const char *zipFileName, const char *directoryToZip,
+           bool removeZippedFiles = false);
 
   /// unzip the zip file to the current working directory
   /// Returns success or failure.
@@ -451,7 +451,8 @@ vtkMRMLColorNode* vtkMRMLColorLogic::LoadColorFile(const char *fileName, const c
 vtkMRMLColorTableNode* vtkMRMLColorLogic::CreateLabelsNode()
 {
   vtkMRMLColorTableNode *labelsNode = vtkMRMLColorTableNode::New();
-  labelsNode->SetTypeToLabels();
+  // the table is built when first used
+  labelsNode->SetLazyType(vtkMRMLColorTableNode::Labels);
   labelsNode->SetAttribute("Category", "Discrete");
   labelsNode->SaveWithSceneOff();
   labelsNode->SetName(labelsNode->GetTypeAsString());
@@ -463,7 +464,8 @@ vtkMRMLColorTableNode* vtkMRMLColorLogic::CreateLabelsNode()
 vtkMRMLColorTableNode* vtkMRMLColorLogic::CreateDefaultTableNode(int type)
 {
   vtkMRMLColorTableNode *node = vtkMRMLColorTableNode::New();
-  node->SetType(type);
+  // the table is built when first used
+  node->SetLazyType(type);
   const char* typeName = node->GetTypeAsString();
   if (strstr(typeName, "Tint") != NULL)
     {
@@ -509,7 +511,8 @@ vtkMRMLProceduralColorNode* vtkMRMLColorLogic::CreateRandomNode()
     }
   func->BuildFunctionFromTable(VTK_INT_MIN, VTK_INT_MAX, dimension, table);
   func->Build();
-  procNode->SetNamesFromColors();
+  // the names are set from the colors when first asked for
+  procNode->NamesInitialisedOff();
 
   return procNode;
 }
@@ -552,7 +555,7 @@ vtkMRMLColorTableNode* vtkMRMLColorLogic::CreateFreeSurferFileNode(const char* f
     return 0;
     }
 
-  vtkMRMLColorTableNode* node = this->CreateFileNode(fileName);
+  vtkMRMLColorTableNode* node = this->CreateFileNode(fileName, true);
   
   if (!node)
     {
@@ -615,7 +618,7 @@ vtkMRMLdGEMRICProceduralColorNode* vtkMRMLColorLogic::CreatedGEMRICColorNode(int
 //---------------------------------------------------------------------------------
 vtkMRMLColorTableNode* vtkMRMLColorLogic::CreateDefaultFileNode(const std::string& colorFileName)
 {
-  vtkMRMLColorTableNode* ctnode = this->CreateFileNode(colorFileName.c_str());
+  vtkMRMLColorTableNode* ctnode = this->CreateFileNode(colorFileName.c_str(), true);
   
   if (!ctnode)
     {
@@ -640,7 +643,7 @@ vtkMRMLColorTableNode* vtkMRMLColorLogic::CreateDefaultFileNode(const std::strin
 //---------------------------------------------------------------------------------
 vtkMRMLColorTableNode* vtkMRMLColorLogic::CreateUserFileNode(const std::string& colorFileName)
 {
-  vtkMRMLColorTableNode * ctnode = this->CreateFileNode(colorFileName.c_str());
+  vtkMRMLColorTableNode * ctnode = this->CreateFileNode(colorFileName.c_str(), true);
   if (ctnode == 0)
     {
     return 0;
@@ -665,7 +668,7 @@ std::vector<std::string> vtkMRMLColorLogic::FindUserColorFiles()
 }
 
 //--------------------------------------------------------------------------------
-vtkMRMLColorTableNode* vtkMRMLColorLogic::CreateFileNode(const char* fileName)
+vtkMRMLColorTableNode* vtkMRMLColorLogic::CreateFileNode(const char* fileName, bool lazy)
 {
   vtkMRMLColorTableNode * ctnode =  vtkMRMLColorTableNode::New();
   ctnode->SetTypeToFile();
@@ -690,7 +693,12 @@ vtkMRMLColorTableNode* vtkMRMLColorLogic::CreateFileNode(const char* fileName)
   
   vtkDebugMacro("AddDefaultColorFiles: About to read user file " << fileName);
 
-  if (ctnode->GetStorageNode()->ReadData(ctnode) == 0)
+  if (lazy && vtksys::SystemTools::FileExists(fileName, true))
+    {
+    // the file is read when the table is first used
+    ctnode->SetLazyType(vtkMRMLColorTableNode::File);
+    }
+  else if (lazy || ctnode->GetStorageNode()->ReadData(ctnode) == 0)
     {
       vtkErrorMacro("Unable to read freesurfer colour file " << (ctnode->GetFileName() ? ctnode->GetFileName() : ""));
       
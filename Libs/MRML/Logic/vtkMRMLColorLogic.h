@@ -45,6 +45,8 @@ public:
 
   /// Add a series of color nodes, setting the types to the defaults, so that
   /// they're accessible to the rest of Slicer
+  /// The color tables and the color files of the nodes are built and read
+  /// the first time they are used (see vtkMRMLColorTableNode::SetLazyType()).
   /// Each node is a singleton and is not included in a saved scene. The color
   /// node singleton tags are the same as the node IDs:
   /// vtkMRMLColorTableNodeGrey, vtkMRMLPETProceduralColorNodeHeat, etc.
@@ -133,7 +135,9 @@ protected:
   vtkMRMLdGEMRICProceduralColorNode* CreatedGEMRICColorNode(int type);
   vtkMRMLColorTableNode* CreateDefaultFileNode(const std::string& colorname);
   vtkMRMLColorTableNode* CreateUserFileNode(const std::string& colorname);
-  vtkMRMLColorTableNode* CreateFileNode(const char* fileName);
+  /// Create a color table node for the color file \a fileName. If \a lazy
+  /// is true, the file is read the first time the table is used.
+  vtkMRMLColorTableNode* CreateFileNode(const char* fileName, bool lazy = false);
   
   void AddLabelsNode();
   void AddDefaultTableNode(int i);
@@ -23,6 +23,9 @@
 // VTK includes
 #include <vtkNew.h>
 
+// STD includes
+#include <algorithm>
+
 vtkCxxRevisionMacro(vtkMRMLModelHierarchyLogic, "$Revision: 12142 $");
 vtkStandardNewMacro(vtkMRMLModelHierarchyLogic);
 
@@ -31,6 +34,7 @@ vtkMRMLModelHierarchyLogic::vtkMRMLModelHierarchyLogic()
 {
   this->ModelHierarchyNodesMTime = 0;
   this->HierarchyChildrenNodesMTime = 0;
+  this->HierarchyDisplayNodesMTime = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -42,13 +46,61 @@ vtkMRMLModelHierarchyLogic::~vtkMRMLModelHierarchyLogic()
 void vtkMRMLModelHierarchyLogic::SetMRMLSceneInternal(vtkMRMLScene* newScene)
 {
   vtkNew<vtkIntArray> sceneEvents;
+  sceneEvents->InsertNextValue(vtkMRMLScene::NodeAddedEvent);
   sceneEvents->InsertNextValue(vtkMRMLScene::NodeRemovedEvent);
+  sceneEvents->InsertNextValue(vtkMRMLScene::EndBatchProcessEvent);
   this->SetAndObserveMRMLSceneEventsInternal(newScene, sceneEvents.GetPointer());
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLModelHierarchyLogic::UpdateFromMRMLScene()
+{
+  this->HierarchyDisplayNodesMTime = 0;
+  if (this->GetMRMLScene() == 0)
+    {
+    return;
+    }
+  std::vector<vtkMRMLNode *> nodes;
+  int nnodes = this->GetMRMLScene()->GetNodesByClass("vtkMRMLDisplayableHierarchyNode", nodes);
+  for (int i=0; i<nnodes; i++)
+    {
+    if (!vtkIsObservedMRMLNodeEventMacro(nodes[i], vtkCommand::ModifiedEvent))
+      {
+      vtkObserveMRMLNodeMacro(nodes[i]);
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLModelHierarchyLogic::OnMRMLSceneNodeAdded(vtkMRMLNode* node)
+{
+  if (!vtkMRMLDisplayableHierarchyNode::SafeDownCast(node) ||
+      this->GetMRMLScene()->IsBatchProcessing())
+    {
+    return;
+    }
+  if (!vtkIsObservedMRMLNodeEventMacro(node, vtkCommand::ModifiedEvent))
+    {
+    vtkObserveMRMLNodeMacro(node);
+    }
+  this->HierarchyDisplayNodesMTime = 0;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLModelHierarchyLogic::OnMRMLNodeModified(vtkMRMLNode* vtkNotUsed(node))
+{
+  this->HierarchyDisplayNodesMTime = 0;
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLModelHierarchyLogic::OnMRMLSceneNodeRemoved(vtkMRMLNode* node)
 {
+  if (vtkMRMLDisplayableHierarchyNode::SafeDownCast(node))
+    {
+    vtkUnObserveMRMLNodeMacro(node);
+    this->HierarchyDisplayNodesMTime = 0;
+    return;
+    }
   vtkMRMLModelNode* modelNode = vtkMRMLModelNode::SafeDownCast(node);
   if (!modelNode || this->GetMRMLScene()->IsBatchProcessing())
     {
@@ -223,6 +275,101 @@ void vtkMRMLModelHierarchyLogic::UpdateHierarchyChildrenMap()
 }
 
 
+//---------------------------------------------------------------------------
+vtkMRMLDisplayNode* vtkMRMLModelHierarchyLogic::GetHierarchyDisplayNode(const char *modelNodeID)
+{
+  if (modelNodeID == 0)
+    {
+    return 0;
+    }
+  this->UpdateHierarchyDisplayNodesMap();
+
+  std::map<std::string, vtkMRMLDisplayNode *>::iterator iter =
+    this->HierarchyDisplayNodes.find(modelNodeID);
+  return iter != this->HierarchyDisplayNodes.end() ? iter->second : 0;
+}
+
+//---------------------------------------------------------------------------
+int vtkMRMLModelHierarchyLogic::GetHierarchyDisplayNodes(
+  std::map<std::string, vtkMRMLDisplayNode*>& displayNodes)
+{
+  this->UpdateHierarchyDisplayNodesMap();
+  displayNodes = this->HierarchyDisplayNodes;
+  return static_cast<int>(displayNodes.size());
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLModelHierarchyLogic::UpdateHierarchyDisplayNodesMap()
+{
+  if (this->GetMRMLScene() == 0)
+    {
+    this->HierarchyDisplayNodes.clear();
+    return;
+    }
+  if (this->HierarchyDisplayNodesMTime != 0 &&
+      this->GetMRMLScene()->GetSceneModifiedTime() <= this->HierarchyDisplayNodesMTime)
+    {
+    return;
+    }
+  this->HierarchyDisplayNodes.clear();
+
+  std::vector<vtkMRMLNode *> nodes;
+  int nnodes = this->GetMRMLScene()->GetNodesByClass("vtkMRMLDisplayableHierarchyNode", nodes);
+
+  // Top most collapsed node of each hierarchy node (NULL if none), each
+  // chain is walked once.
+  std::map<vtkMRMLDisplayableHierarchyNode*, vtkMRMLDisplayableHierarchyNode*> collapsedParents;
+  std::vector<vtkMRMLDisplayableHierarchyNode*> chain;
+  for (int i=0; i<nnodes; i++)
+    {
+    vtkMRMLDisplayableHierarchyNode *hnode =
+      vtkMRMLDisplayableHierarchyNode::SafeDownCast(nodes[i]);
+    chain.clear();
+    vtkMRMLDisplayableHierarchyNode *collapsedParent = 0;
+    while (hnode)
+      {
+      std::map<vtkMRMLDisplayableHierarchyNode*, vtkMRMLDisplayableHierarchyNode*>::iterator
+        cit = collapsedParents.find(hnode);
+      if (cit != collapsedParents.end())
+        {
+        collapsedParent = cit->second;
+        break;
+        }
+      chain.push_back(hnode);
+      hnode = vtkMRMLDisplayableHierarchyNode::SafeDownCast(hnode->GetParentNode());
+      }
+    // walk the chain back from the top
+    for (int c = static_cast<int>(chain.size()) - 1; c >= 0; --c)
+      {
+      if (collapsedParent == 0 && !chain[c]->GetExpanded())
+        {
+        collapsedParent = chain[c];
+        }
+      collapsedParents[chain[c]] = collapsedParent;
+      }
+    }
+
+  for (int i=0; i<nnodes; i++)
+    {
+    vtkMRMLModelHierarchyNode *mhnode = vtkMRMLModelHierarchyNode::SafeDownCast(nodes[i]);
+    vtkMRMLModelNode *mnode = mhnode ? mhnode->GetModelNode() : 0;
+    if (!mnode)
+      {
+      continue;
+      }
+    vtkMRMLModelHierarchyNode *collapsedParent =
+      vtkMRMLModelHierarchyNode::SafeDownCast(collapsedParents[mhnode]);
+    vtkMRMLDisplayNode *dnode = collapsedParent ? collapsedParent->GetDisplayNode() : 0;
+    if (dnode)
+      {
+      this->HierarchyDisplayNodes[std::string(mnode->GetID())] = dnode;
+      }
+    }
+  // never 0, it would mean the map must be updated
+  this->HierarchyDisplayNodesMTime =
+    std::max(this->GetMRMLScene()->GetSceneModifiedTime(), 1ul);
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLModelHierarchyLogic::SetChildrenVisibility(vtkMRMLDisplayableHierarchyNode *displayableHierarchyNode,
                                                       int visibility)
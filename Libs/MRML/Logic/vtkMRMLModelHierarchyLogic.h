@@ -21,6 +21,7 @@
 //#include <vtkMRMLModelNode.h>
 class vtkMRMLModelHierarchyNode;
 class vtkMRMLDisplayableHierarchyNode;
+class vtkMRMLDisplayNode;
 //#include <vtkMRMLModelHierarchyNode.h>
 
 // STD includes
@@ -62,12 +63,27 @@ public:
   /// std::vector< vtkMRMLModelHierarchyNode > children = logic->GetHierarchyChildrenNodes(parent);
   vtkMRMLModelHierarchyNodeList GetHierarchyChildrenNodes(vtkMRMLModelHierarchyNode *parentNode);
 
+  ///
+  /// Given model id return the display node of the top most collapsed
+  /// hierarchy node above the model (the model hierarchy node included),
+  /// or NULL if none of them is collapsed.
+  /// The display nodes of all the models are cached, the cache is updated
+  /// when nodes are added/removed or when a hierarchy node is modified.
+  vtkMRMLDisplayNode* GetHierarchyDisplayNode(const char *modelNodeID);
+
+  ///
+  /// Bulk version of GetHierarchyDisplayNode(): fill the map with the
+  /// hierarchy display node of each model ID that has one.
+  /// Return the number of models in the map.
+  int GetHierarchyDisplayNodes(std::map<std::string, vtkMRMLDisplayNode*>& displayNodes);
+
   /// 
   /// Call this to update the cache when hierarchy is modified. 
   void HierarchyIsModified()
     {
     ModelHierarchyNodesMTime = 0;
     HierarchyChildrenNodesMTime = 0;
+    HierarchyDisplayNodesMTime = 0;
     }
 
   ///
@@ -83,9 +99,19 @@ protected:
   /// Reimplemented to observe the scene
   virtual void SetMRMLSceneInternal(vtkMRMLScene* newScene);
 
+  /// Observe the hierarchy nodes of the scene
+  virtual void UpdateFromMRMLScene();
+
+  /// Observe the added hierarchy nodes
+  virtual void OnMRMLSceneNodeAdded(vtkMRMLNode* addedNode);
+
   /// Delete the hierarchy node when a model is removed from the scene
   virtual void OnMRMLSceneNodeRemoved(vtkMRMLNode* removedNode);
 
+  /// Invalidate the hierarchy display nodes when a hierarchy node is
+  /// modified (expanded/collapsed, reparented, new display node...)
+  virtual void OnMRMLNodeModified(vtkMRMLNode* node);
+
   /// 
   /// Create model to hierarchy map, 
   /// return number of model hierarchy nodes
@@ -93,12 +119,18 @@ protected:
   
   void UpdateHierarchyChildrenMap();
 
+  void UpdateHierarchyDisplayNodesMap();
+
   std::map<std::string, vtkMRMLModelHierarchyNode *> ModelHierarchyNodes;
   typedef std::map<std::string, std::vector< vtkMRMLModelHierarchyNode *> > HierarchyChildrenNodesType;
   HierarchyChildrenNodesType HierarchyChildrenNodes;
   
+  /// Model ID to the display node of its top most collapsed hierarchy node
+  std::map<std::string, vtkMRMLDisplayNode *> HierarchyDisplayNodes;
+
   unsigned long ModelHierarchyNodesMTime;
   unsigned long HierarchyChildrenNodesMTime;
+  unsigned long HierarchyDisplayNodesMTime;
 
 };
 
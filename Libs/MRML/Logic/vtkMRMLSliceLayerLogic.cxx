@@ -24,15 +24,22 @@
 #include "vtkMRMLDiffusionTensorVolumeSliceDisplayNode.h"
 
 // VTK includes
+#include <vtkAlgorithm.h>
 #include <vtkAssignAttribute.h>
+#include <vtkCollection.h>
 #include <vtkDiffusionTensorMathematics.h>
+#include <vtkExecutive.h>
 #include <vtkFloatArray.h>
+#include <vtkGeneralTransform.h>
 #include <vtkImageData.h>
 #include <vtkImageLinearReslice.h>
+#include <vtkImageResliceMapToColors.h>
 #include <vtkImageResliceMask.h>
 #include <vtkImageReslice.h>
 #include <vtkInformation.h>
+#include <vtkInformationExecutivePortKey.h>
 #include <vtkInformationVector.h>
+#include <vtkMath.h>
 #include <vtkNew.h>
 #include <vtkPointData.h>
 #include <vtkSmartPointer.h>
@@ -41,6 +48,9 @@
 //
 #include "vtkImageLabelOutline.h"
 
+// STD includes
+#include <sstream>
+
 //----------------------------------------------------------------------------
 vtkCxxRevisionMacro(vtkMRMLSliceLayerLogic, "$Revision$");
 vtkStandardNewMacro(vtkMRMLSliceLayerLogic);
@@ -65,6 +75,38 @@ bool AreMatricesEqual(const vtkMatrix4x4* first, const vtkMatrix4x4* second)
          first->GetElement(3,3) == second->GetElement(3,3);
 }
 
+//----------------------------------------------------------------------------
+// The executive resets AbortExecute at the beginning of each execution, only
+// set it if the filter is running (progress not complete) to not modify idle
+// filters.
+void AbortIfExecuting(vtkAlgorithm* algorithm)
+{
+  if (algorithm->GetProgress() < 1.)
+    {
+    algorithm->AbortExecuteOn();
+    }
+}
+
+//----------------------------------------------------------------------------
+// Shortest decimal writing of the value, as the python data probe did
+static std::string vtkMRMLSliceLayerLogicFormatValue(double value)
+{
+  std::ostringstream ss;
+  ss.setf(std::ios::fixed);
+  ss.precision(6);
+  ss << value;
+  std::string str = ss.str();
+  if (str.find('.') != std::string::npos)
+    {
+    str.erase(str.find_last_not_of('0') + 1);
+    if (str[str.size() - 1] == '.')
+      {
+      str.erase(str.size() - 1);
+      }
+    }
+  return str;
+}
+
 //----------------------------------------------------------------------------
 vtkMRMLSliceLayerLogic::vtkMRMLSliceLayerLogic()
 {
@@ -76,8 +118,14 @@ vtkMRMLSliceLayerLogic::vtkMRMLSliceLayerLogic()
    
   this->XYToIJKTransform = vtkTransform::New();
   this->UVWToIJKTransform = vtkTransform::New();
+  this->XYToIJKNonlinearTransform = vtkGeneralTransform::New();
+  this->UVWToIJKNonlinearTransform = vtkGeneralTransform::New();
 
   this->IsLabelLayer = 0;
+  this->UseFusedPipeline = 1;
+  this->Interacting = 0;
+  this->InteractionSampleStep = 2;
+  this->CubicRefinement = 0;
 
   this->AssignAttributeTensorsToScalars= vtkAssignAttribute::New();
   this->AssignAttributeScalarsToTensors= vtkAssignAttribute::New();
@@ -91,6 +139,7 @@ vtkMRMLSliceLayerLogic::vtkMRMLSliceLayerLogic()
   this->ResliceUVW = vtkImageResliceMask::New();
   this->LabelOutline = vtkImageLabelOutline::New();
   this->LabelOutlineUVW = vtkImageLabelOutline::New();
+  this->FusedReslice = vtkImageResliceMapToColors::New();
 
   //
   // Set parameters that won't change based on input
@@ -109,11 +158,31 @@ vtkMRMLSliceLayerLogic::vtkMRMLSliceLayerLogic()
   this->ResliceUVW->SetOutputSpacing( 1, 1, 1 );
   this->ResliceUVW->SetOutputDimensionality( 3 );
   
-  // Only the transform matrix can change, not the transform itself
+  // Only the transform matrix can change, not the transform itself, unless
+  // the volume is under a non-linear transform (see UpdateTransforms())
   this->Reslice->SetResliceTransform( this->XYToIJKTransform ); 
   this->ResliceUVW->SetResliceTransform( this->UVWToIJKTransform ); 
+  this->FusedReslice->SetResliceTransform( this->XYToIJKTransform );
+  // Keep the recently viewed slices (64MB) and compute the neighbor slices
+  // between renders so that scrolling through the volume is a copy.
+  this->FusedReslice->SetCacheMemoryLimit( 64 * 1024 );
+  this->FusedReslice->PrefetchOn();
+  // Linked views (compare, 3 over 3 layouts) reslicing the same volume with
+  // the same geometry share the resliced images.
+  this->Reslice->ShareOutputOn();
+  this->ResliceUVW->ShareOutputOn();
+  this->FusedReslice->ShareOutputOn();
+  // Non-linear transforms (grid, B-spline) are sampled on a grid of the
+  // slice instead of being evaluated (and inverted) for every pixel.
+  this->Reslice->SetTransformGridErrorBound(0.1);
+  this->ResliceUVW->SetTransformGridErrorBound(0.1);
 
   this->UpdatingTransforms = 0;
+
+  this->ProbeIJK[0] = this->ProbeIJK[1] = this->ProbeIJK[2] = 0;
+  this->ProbeValues = 0;
+  this->ProbeTensorImage = 0;
+  this->ProbeTensorMathematics = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -136,14 +205,27 @@ vtkMRMLSliceLayerLogic::~vtkMRMLSliceLayerLogic()
   this->SetVolumeNode(0);
   this->XYToIJKTransform->Delete();
   this->UVWToIJKTransform->Delete();
+  this->XYToIJKNonlinearTransform->Delete();
+  this->UVWToIJKNonlinearTransform->Delete();
+  if (this->ProbeValues)
+    {
+    this->ProbeValues->Delete();
+    }
+  if (this->ProbeTensorMathematics)
+    {
+    this->ProbeTensorMathematics->Delete();
+    this->ProbeTensorImage->Delete();
+    }
 
   this->Reslice->SetInput( 0 );
   this->ResliceUVW->SetInput( 0 );
   this->LabelOutline->SetInput( 0 );
   this->LabelOutlineUVW->SetInput( 0 );
+  this->FusedReslice->SetInput( 0 );
 
   this->Reslice->Delete();
   this->ResliceUVW->Delete();
+  this->FusedReslice->Delete();
 
   this->LabelOutline->Delete();
   this->LabelOutlineUVW->Delete();
@@ -419,6 +501,11 @@ void vtkMRMLSliceLayerLogic::UpdateVolumeDisplayNode()
     vtkMRMLScalarVolumeDisplayNode::SafeDownCast(this->VolumeDisplayNode)->SetAutoWindowLevel(0);
     vtkMRMLScalarVolumeDisplayNode::SafeDownCast(this->VolumeDisplayNode)->SetAutoThreshold(0);
     }
+  if (vtkMRMLDiffusionWeightedVolumeDisplayNode::SafeDownCast(this->VolumeDisplayNode))
+    {
+    // The reslice only outputs the diffusion component
+    vtkMRMLDiffusionWeightedVolumeDisplayNode::SafeDownCast(this->VolumeDisplayNode)->SetInputDiffusionComponentOnly(1);
+    }
   this->VolumeDisplayNode->SetDisableModifiedEvent(wasDisabling);
 
   int wasDisablingUVW = this->VolumeDisplayNodeUVW->GetDisableModifiedEvent();
@@ -432,6 +519,10 @@ void vtkMRMLSliceLayerLogic::UpdateVolumeDisplayNode()
     vtkMRMLScalarVolumeDisplayNode::SafeDownCast(this->VolumeDisplayNodeUVW)->SetAutoWindowLevel(0);
     vtkMRMLScalarVolumeDisplayNode::SafeDownCast(this->VolumeDisplayNodeUVW)->SetAutoThreshold(0);
     }
+  if (vtkMRMLDiffusionWeightedVolumeDisplayNode::SafeDownCast(this->VolumeDisplayNodeUVW))
+    {
+    vtkMRMLDiffusionWeightedVolumeDisplayNode::SafeDownCast(this->VolumeDisplayNodeUVW)->SetInputDiffusionComponentOnly(1);
+    }
   this->VolumeDisplayNodeUVW->SetDisableModifiedEvent(wasDisablingUVW);
 
 }
@@ -440,8 +531,6 @@ void vtkMRMLSliceLayerLogic::UpdateVolumeDisplayNode()
 //----------------------------------------------------------------------------
 void vtkMRMLSliceLayerLogic::UpdateTransforms()
 {
-  static bool reportedNonlinearTransformSupport = false;
-  
   if (this->UpdatingTransforms) 
     {
     return;
@@ -477,19 +566,36 @@ void vtkMRMLSliceLayerLogic::UpdateTransforms()
     this->SliceNode->GetUVWDimensions(dimensionsUVW);
     }
 
+  bool nonlinear = false;
   if (this->VolumeNode && this->VolumeNode->GetImageData())
     {
+    vtkSmartPointer<vtkMatrix4x4> rasToIJK = vtkSmartPointer<vtkMatrix4x4>::New();
+    this->VolumeNode->GetRASToIJKMatrix(rasToIJK);
+
     // Apply the transform, if it exists
     vtkMRMLTransformNode *transformNode = this->VolumeNode->GetParentTransformNode();
     if ( transformNode != 0 )
       {
       if ( !transformNode->IsTransformToWorldLinear() )
         {
-        if (!reportedNonlinearTransformSupport)
-          {
-          vtkErrorMacro ("Nonlinear transforms are not yet supported in slice viewers.");
-          reportedNonlinearTransformSupport = true;
-          }
+        // XY -> RAS -> (non-linear) -> RAS of the volume -> IJK
+        nonlinear = true;
+        vtkSmartPointer<vtkGeneralTransform> worldToVolume =
+          vtkSmartPointer<vtkGeneralTransform>::New();
+        transformNode->GetTransformToWorld(worldToVolume);
+        worldToVolume->Inverse();
+
+        this->XYToIJKNonlinearTransform->Identity();
+        this->XYToIJKNonlinearTransform->PostMultiply();
+        this->XYToIJKNonlinearTransform->Concatenate(xyToIJK);
+        this->XYToIJKNonlinearTransform->Concatenate(worldToVolume);
+        this->XYToIJKNonlinearTransform->Concatenate(rasToIJK);
+
+        this->UVWToIJKNonlinearTransform->Identity();
+        this->UVWToIJKNonlinearTransform->PostMultiply();
+        this->UVWToIJKNonlinearTransform->Concatenate(uvwToIJK);
+        this->UVWToIJKNonlinearTransform->Concatenate(worldToVolume);
+        this->UVWToIJKNonlinearTransform->Concatenate(rasToIJK);
         }
       else
         {
@@ -501,8 +607,6 @@ void vtkMRMLSliceLayerLogic::UpdateTransforms()
         }
       }
 
-    vtkSmartPointer<vtkMatrix4x4> rasToIJK = vtkSmartPointer<vtkMatrix4x4>::New();
-    this->VolumeNode->GetRASToIJKMatrix(rasToIJK);
     vtkMatrix4x4::Multiply4x4(rasToIJK, xyToIJK, xyToIJK); 
     vtkMatrix4x4::Multiply4x4(rasToIJK, uvwToIJK, uvwToIJK); 
   }
@@ -523,6 +627,20 @@ void vtkMRMLSliceLayerLogic::UpdateTransforms()
     this->UVWToIJKTransform->SetMatrix( uvwToIJK );
     }
 
+  // The non-linear transforms are rebuilt, their matrices can't be compared
+  if (nonlinear)
+    {
+    transformModified = true;
+    transformModifiedUVW = true;
+    this->Reslice->SetResliceTransform( this->XYToIJKNonlinearTransform );
+    this->ResliceUVW->SetResliceTransform( this->UVWToIJKNonlinearTransform );
+    }
+  else
+    {
+    this->Reslice->SetResliceTransform( this->XYToIJKTransform );
+    this->ResliceUVW->SetResliceTransform( this->UVWToIJKTransform );
+    }
+
   this->Reslice->SetOutputExtent( 0, dimensions[0]-1,
                                   0, dimensions[1]-1,
                                   0, dimensions[2]-1);
@@ -531,6 +649,10 @@ void vtkMRMLSliceLayerLogic::UpdateTransforms()
                                      0, dimensionsUVW[1]-1,
                                      0, dimensionsUVW[2]-1);
 
+  this->FusedReslice->SetOutputExtent( 0, dimensions[0]-1,
+                                       0, dimensions[1]-1,
+                                       0, dimensions[2]-1);
+
   this->UpdatingTransforms = 0; 
 
   if (transformModified || transformModifiedUVW)
@@ -539,6 +661,179 @@ void vtkMRMLSliceLayerLogic::UpdateTransforms()
     }
 }
 
+//----------------------------------------------------------------------------
+bool vtkMRMLSliceLayerLogic::Probe(double xyz[3])
+{
+  this->ProbeIJK[0] = this->ProbeIJK[1] = this->ProbeIJK[2] = 0;
+  this->ProbeLabelName.clear();
+  this->ProbeString.clear();
+  if (this->ProbeValues)
+    {
+    this->ProbeValues->Reset();
+    }
+  if (!this->VolumeNode)
+    {
+    return false;
+    }
+  vtkImageData* imageData = this->VolumeNode->GetImageData();
+  if (!imageData)
+    {
+    this->ProbeString = "No Image";
+    return false;
+    }
+
+  double ijk[3];
+  this->Reslice->GetResliceTransform()->TransformPoint(xyz, ijk);
+  int extent[6];
+  imageData->GetExtent(extent);
+  bool inside = true;
+  for (int i = 0; i < 3; ++i)
+    {
+    this->ProbeIJK[i] = vtkMath::IsNan(ijk[i]) ? 0 : vtkMath::Round(ijk[i]);
+    inside = inside &&
+      this->ProbeIJK[i] >= extent[2 * i] && this->ProbeIJK[i] <= extent[2 * i + 1];
+    }
+  if (!inside)
+    {
+    this->ProbeString = "Out of Frame";
+    return false;
+    }
+
+  vtkMRMLScalarVolumeNode* scalarVolumeNode =
+    vtkMRMLScalarVolumeNode::SafeDownCast(this->VolumeNode);
+  vtkMRMLDiffusionTensorVolumeNode* tensorVolumeNode =
+    vtkMRMLDiffusionTensorVolumeNode::SafeDownCast(this->VolumeNode);
+  bool labelMap = scalarVolumeNode && scalarVolumeNode->GetLabelMap();
+  vtkDataArray* values = (tensorVolumeNode && !labelMap) ?
+    imageData->GetPointData()->GetTensors() : imageData->GetPointData()->GetScalars();
+  if (!values)
+    {
+    this->ProbeString = (tensorVolumeNode && !labelMap) ? "No Tensor Data" : "No Scalars";
+    return false;
+    }
+  vtkIdType pointId = imageData->ComputePointId(this->ProbeIJK);
+  if (this->ProbeValues && this->ProbeValues->GetDataType() != values->GetDataType())
+    {
+    this->ProbeValues->Delete();
+    this->ProbeValues = 0;
+    }
+  if (!this->ProbeValues)
+    {
+    this->ProbeValues = vtkDataArray::CreateDataArray(values->GetDataType());
+    }
+  this->ProbeValues->SetNumberOfComponents(values->GetNumberOfComponents());
+  this->ProbeValues->SetNumberOfTuples(1);
+  this->ProbeValues->SetTuple(0, pointId, values);
+
+  std::ostringstream ss;
+  if (labelMap)
+    {
+    int label = static_cast<int>(values->GetComponent(pointId, 0));
+    vtkMRMLDisplayNode* displayNode = this->VolumeNode->GetDisplayNode();
+    vtkMRMLColorNode* colorNode = displayNode ? displayNode->GetColorNode() : 0;
+    const char* labelName = colorNode ? colorNode->GetColorName(label) : 0;
+    this->ProbeLabelName = labelName ? labelName : "Unknown";
+    ss << this->ProbeLabelName << " (" << label << ")";
+    }
+  else if (tensorVolumeNode)
+    {
+    if (!this->ProbeTensorMathematics)
+      {
+      this->ProbeTensorImage = vtkImageData::New();
+      this->ProbeTensorImage->SetExtent(0, 0, 0, 0, 0, 0);
+      this->ProbeTensorImage->AllocateScalars();
+      vtkNew<vtkFloatArray> tensor;
+      tensor->SetNumberOfComponents(9);
+      tensor->SetNumberOfTuples(1);
+      this->ProbeTensorImage->GetPointData()->SetTensors(tensor.GetPointer());
+      this->ProbeTensorMathematics = vtkDiffusionTensorMathematics::New();
+      this->ProbeTensorMathematics->SetInput(this->ProbeTensorImage);
+      }
+    double tensor[9];
+    values->GetTuple(pointId, tensor);
+    this->ProbeTensorImage->GetPointData()->GetTensors()->SetTuple(0, tensor);
+    this->ProbeTensorImage->GetPointData()->GetTensors()->Modified();
+    this->ProbeTensorImage->Modified();
+
+    vtkMRMLDiffusionTensorVolumeDisplayNode* displayNode =
+      vtkMRMLDiffusionTensorVolumeDisplayNode::SafeDownCast(
+        this->VolumeNode->GetDisplayNode());
+    int invariant = displayNode ? displayNode->GetScalarInvariant() :
+      vtkMRMLDiffusionTensorDisplayPropertiesNode::FractionalAnisotropy;
+    this->ProbeTensorMathematics->SetOperation(invariant);
+    this->ProbeTensorMathematics->Update();
+    ss << vtkMRMLDiffusionTensorDisplayPropertiesNode::GetScalarEnumAsString(invariant);
+    vtkImageData* output = this->ProbeTensorMathematics->GetOutput();
+    if (output && output->GetNumberOfScalarComponents() > 0)
+      {
+      ss << " " << vtkMRMLSliceLayerLogicFormatValue(
+        output->GetScalarComponentAsDouble(0, 0, 0, 0));
+      }
+    }
+  else if (values->GetNumberOfComponents() > 3)
+    {
+    ss << values->GetNumberOfComponents() << " components";
+    }
+  else
+    {
+    for (int c = 0; c < values->GetNumberOfComponents(); ++c)
+      {
+      ss << (c ? ", " : "") << vtkMRMLSliceLayerLogicFormatValue(
+        values->GetComponent(pointId, c));
+      }
+    }
+  this->ProbeString = ss.str();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+const char* vtkMRMLSliceLayerLogic::GetProbeLabelName()
+{
+  return this->ProbeLabelName.c_str();
+}
+
+//----------------------------------------------------------------------------
+const char* vtkMRMLSliceLayerLogic::GetProbeString()
+{
+  return this->ProbeString.c_str();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLSliceLayerLogic::SetLabelOutlineThickness(int thickness)
+{
+  if (this->LabelOutline->GetThickness() == thickness)
+    {
+    return;
+    }
+  this->LabelOutline->SetThickness(thickness);
+  this->LabelOutlineUVW->SetThickness(thickness);
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLSliceLayerLogic::GetLabelOutlineThickness()
+{
+  return this->LabelOutline->GetThickness();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLSliceLayerLogic::SetNonlinearTransformErrorBound(double errorBound)
+{
+  if (this->Reslice->GetTransformGridErrorBound() == errorBound)
+    {
+    return;
+    }
+  this->Reslice->SetTransformGridErrorBound(errorBound);
+  this->ResliceUVW->SetTransformGridErrorBound(errorBound);
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+double vtkMRMLSliceLayerLogic::GetNonlinearTransformErrorBound()
+{
+  return this->Reslice->GetTransformGridErrorBound();
+}
+
 //----------------------------------------------------------------------------
 vtkImageData* vtkMRMLSliceLayerLogic::GetImageData()
 {
@@ -546,9 +841,142 @@ vtkImageData* vtkMRMLSliceLayerLogic::GetImageData()
     {
     return NULL;
     }
+  if (this->CanUseFusedPipeline())
+    {
+    return this->FusedReslice->GetOutput();
+    }
   return this->GetVolumeDisplayNode()->GetImageData();
 }
 
+//----------------------------------------------------------------------------
+namespace
+{
+// Add dataObject and the data upstream if it is produced by a filter
+void AddProducedDataObjects(vtkDataObject* dataObject, vtkCollection* dataObjects)
+{
+  if (dataObject == 0 || dataObjects->IsItemPresent(dataObject))
+    {
+    return;
+    }
+  vtkInformation* pipelineInformation = dataObject->GetPipelineInformation();
+  vtkExecutive* producer = pipelineInformation ?
+    vtkExecutive::PRODUCER()->GetExecutive(pipelineInformation) : 0;
+  vtkAlgorithm* algorithm = producer ? producer->GetAlgorithm() : 0;
+  if (algorithm == 0 || algorithm->IsA("vtkTrivialProducer"))
+    {
+    return;
+    }
+  dataObjects->AddItem(dataObject);
+  for (int port = 0; port < algorithm->GetNumberOfInputPorts(); ++port)
+    {
+    for (int i = 0; i < algorithm->GetNumberOfInputConnections(port); ++i)
+      {
+      AddProducedDataObjects(algorithm->GetInputDataObject(port, i), dataObjects);
+      }
+    }
+}
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLSliceLayerLogic::AddPipelineDataObjects(vtkAlgorithm* filter,
+                                                    vtkCollection* dataObjects)
+{
+  // Requesting the output of a filter without input would report an error
+  if (filter == 0 ||
+      (filter->GetNumberOfInputPorts() > 0 &&
+       filter->GetNumberOfInputConnections(0) == 0))
+    {
+    return;
+    }
+  AddProducedDataObjects(filter->GetOutputDataObject(0), dataObjects);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLSliceLayerLogic::GetPipelineDataObjects(vtkCollection* dataObjects)
+{
+  // The display nodes process the output of the reslice filters.
+  if (this->VolumeDisplayNode && this->VolumeDisplayNode->GetInputImageData())
+    {
+    AddProducedDataObjects(
+      this->VolumeDisplayNode->GetOutputImageData(), dataObjects);
+    }
+  if (this->VolumeDisplayNodeUVW && this->VolumeDisplayNodeUVW->GetInputImageData())
+    {
+    AddProducedDataObjects(
+      this->VolumeDisplayNodeUVW->GetOutputImageData(), dataObjects);
+    }
+  vtkMRMLSliceLayerLogic::AddPipelineDataObjects(this->Reslice, dataObjects);
+  vtkMRMLSliceLayerLogic::AddPipelineDataObjects(this->ResliceUVW, dataObjects);
+  vtkMRMLSliceLayerLogic::AddPipelineDataObjects(this->FusedReslice, dataObjects);
+  vtkMRMLSliceLayerLogic::AddPipelineDataObjects(this->LabelOutline, dataObjects);
+  vtkMRMLSliceLayerLogic::AddPipelineDataObjects(this->LabelOutlineUVW, dataObjects);
+  vtkMRMLSliceLayerLogic::AddPipelineDataObjects(
+    this->AssignAttributeScalarsToTensors, dataObjects);
+  vtkMRMLSliceLayerLogic::AddPipelineDataObjects(
+    this->AssignAttributeScalarsToTensorsUVW, dataObjects);
+}
+
+//----------------------------------------------------------------------------
+unsigned long vtkMRMLSliceLayerLogic::GetPipelineMemorySize()
+{
+  vtkNew<vtkCollection> dataObjects;
+  this->GetPipelineDataObjects(dataObjects.GetPointer());
+  return vtkMRMLScene::GetDataObjectsMemorySize(dataObjects.GetPointer());
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLSliceLayerLogic::CanUseFusedPipeline()
+{
+  if (!this->UseFusedPipeline ||
+      this->VolumeNode == 0 || this->VolumeNode->GetImageData() == 0 ||
+      this->VolumeNode->IsA("vtkMRMLDiffusionTensorVolumeNode"))
+    {
+    return false;
+    }
+  // The fused filter only supports linear transforms
+  vtkMRMLTransformNode* transformNode = this->VolumeNode->GetParentTransformNode();
+  if (transformNode && !transformNode->IsTransformToWorldLinear())
+    {
+    return false;
+    }
+  // Subclasses (label map, vector, DWI...) have their own pipeline
+  vtkMRMLScalarVolumeDisplayNode* scalarVolumeDisplayNode =
+    vtkMRMLScalarVolumeDisplayNode::SafeDownCast(this->VolumeDisplayNode);
+  if (scalarVolumeDisplayNode == 0 ||
+      strcmp(scalarVolumeDisplayNode->GetClassName(),
+             "vtkMRMLScalarVolumeDisplayNode") != 0 ||
+      scalarVolumeDisplayNode->GetLookupTable() == 0)
+    {
+    return false;
+    }
+  if (this->CubicRefinement && !this->Interacting &&
+      scalarVolumeDisplayNode->GetInterpolate())
+    {
+    return false;
+    }
+  return this->VolumeNode->GetImageData()->GetNumberOfScalarComponents() == 1;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLSliceLayerLogic::SetInteracting(int interacting)
+{
+  if (this->Interacting == interacting)
+    {
+    return;
+    }
+  this->Interacting = interacting;
+  if (this->Interacting)
+    {
+    // Cancel the full quality reslice if it is running
+    AbortIfExecuting(this->FusedReslice);
+    AbortIfExecuting(this->Reslice);
+    }
+  int wasModifying = this->StartModify();
+  this->UpdateImageDisplay();
+  this->Modified();
+  this->EndModify(wasModifying);
+}
+
 //----------------------------------------------------------------------------
 vtkImageData* vtkMRMLSliceLayerLogic::GetImageDataUVW()
 {
@@ -578,6 +1006,7 @@ void vtkMRMLSliceLayerLogic::UpdateImageDisplay()
   unsigned long oldAssign = this->AssignAttributeTensorsToScalars->GetMTime();
   unsigned long oldLabel = this->LabelOutline->GetMTime();
   unsigned long oldLabelUVW = this->LabelOutlineUVW->GetMTime();
+  unsigned long oldFused = this->FusedReslice->GetMTime();
   
   if ( (this->VolumeNode->GetImageData() && labelMapVolumeDisplayNode) ||
        (scalarVolumeDisplayNode && scalarVolumeDisplayNode->GetInterpolate() == 0))
@@ -585,12 +1014,31 @@ void vtkMRMLSliceLayerLogic::UpdateImageDisplay()
     this->Reslice->SetInterpolationModeToNearestNeighbor();
     this->ResliceUVW->SetInterpolationModeToNearestNeighbor();
     }
+  else if (this->Interacting && !this->CanUseFusedPipeline())
+    {
+    // the fused pipeline is downsampled instead
+    this->Reslice->SetInterpolationModeToNearestNeighbor();
+    this->ResliceUVW->SetInterpolationModeToNearestNeighbor();
+    }
+  else if (this->CubicRefinement && !this->Interacting)
+    {
+    this->Reslice->SetInterpolationModeToCubic();
+    this->ResliceUVW->SetInterpolationModeToCubic();
+    }
   else
     {
     this->Reslice->SetInterpolationModeToLinear();
     this->ResliceUVW->SetInterpolationModeToLinear();
     }
 
+  // Only the displayed gradient of a DWI volume is resliced, it is read in
+  // place from the interleaved gradients
+  vtkMRMLDiffusionWeightedVolumeDisplayNode* dwiDisplayNode =
+    vtkMRMLDiffusionWeightedVolumeDisplayNode::SafeDownCast(volumeDisplayNode);
+  int scalarComponent = dwiDisplayNode ? dwiDisplayNode->GetDiffusionComponent() : -1;
+  this->Reslice->SetScalarComponent(scalarComponent);
+  this->ResliceUVW->SetScalarComponent(scalarComponent);
+
   // for tensors reassign scalar data
   if ( volumeNode && volumeNode->IsA("vtkMRMLDiffusionTensorVolumeNode") )
     {
@@ -762,11 +1210,32 @@ void vtkMRMLSliceLayerLogic::UpdateImageDisplay()
       }
     }
 
+  // The display node pipeline is still fed (it computes the auto window
+  // level and the auto threshold), but it is not executed if the fused
+  // filter is used.
+  if (this->CanUseFusedPipeline())
+    {
+    this->FusedReslice->SetInput( volumeNode->GetImageData() );
+    this->FusedReslice->SetInterpolationMode( this->Reslice->GetInterpolationMode() );
+    this->FusedReslice->SetSampleStep( this->Interacting ? this->InteractionSampleStep : 1 );
+    this->FusedReslice->SetWindow( scalarVolumeDisplayNode->GetWindow() );
+    this->FusedReslice->SetLevel( scalarVolumeDisplayNode->GetLevel() );
+    this->FusedReslice->SetApplyThreshold( scalarVolumeDisplayNode->GetApplyThreshold() );
+    this->FusedReslice->SetLowerThreshold( scalarVolumeDisplayNode->GetLowerThreshold() );
+    this->FusedReslice->SetUpperThreshold( scalarVolumeDisplayNode->GetUpperThreshold() );
+    this->FusedReslice->SetLookupTable( scalarVolumeDisplayNode->GetLookupTable() );
+    }
+  else
+    {
+    this->FusedReslice->SetInput( 0 );
+    }
+
   if ( oldReSliceMTime != this->Reslice->GetMTime() ||
        oldReSliceUVWMTime != this->ResliceUVW->GetMTime() ||
        oldAssign != this->AssignAttributeTensorsToScalars->GetMTime() ||
        oldLabel != this->LabelOutline->GetMTime() ||
        oldLabelUVW != this->LabelOutlineUVW->GetMTime() ||
+       oldFused != this->FusedReslice->GetMTime() ||
        (volumeNode != 0 && (volumeNode->GetMTime() > oldReSliceMTime)) ||
        (volumeDisplayNode != 0 && (volumeDisplayNode->GetMTime() > oldReSliceMTime)) ||
        (volumeDisplayNodeUVW != 0 && (volumeDisplayNodeUVW->GetMTime() > oldReSliceUVWMTime))
@@ -950,6 +1419,20 @@ void vtkMRMLSliceLayerLogic::PrintSelf(ostream& os, vtkIndent indent)
     os << indent << " (0)\n";
     }
 
+  os << indent << "UseFusedPipeline: " << this->GetUseFusedPipeline() << "\n";
+  os << indent << "Interacting: " << this->GetInteracting() << "\n";
+  os << indent << "InteractionSampleStep: " << this->GetInteractionSampleStep() << "\n";
+  os << indent << "CubicRefinement: " << this->GetCubicRefinement() << "\n";
+  os << indent << "FusedReslice:\n";
+  if (this->FusedReslice)
+    {
+    this->FusedReslice->PrintSelf(os, nextIndent);
+    }
+  else
+    {
+    os << indent << " (0)\n";
+    }
+
   os << indent << "IsLabelLayer: " << this->GetIsLabelLayer() << "\n";
   os << indent << "LabelOutline:\n";
   if (this->LabelOutline)
@@ -46,11 +46,18 @@
 #include "vtkImageLogic.h"
 #include "vtkImageExtractComponents.h"
 
+class vtkAlgorithm;
 class vtkAssignAttribute;
+class vtkCollection;
+class vtkDataArray;
+class vtkDiffusionTensorMathematics;
+class vtkGeneralTransform;
+class vtkImageResliceMapToColors;
 class vtkImageResliceMask;
 
 // STL includes
 //#include <cstdlib>
+#include <string>
 
 class vtkImageLabelOutline;
 class vtkTransform;
@@ -86,6 +93,44 @@ public:
   /// The image reslice or slice being used
   vtkGetObjectMacro (Reslice, vtkImageResliceMask);
 
+  ///
+  /// The filter that reslices and maps to colors scalar volumes in a single
+  /// pass, used instead of Reslice and the display node pipeline when
+  /// possible.
+  vtkGetObjectMacro (FusedReslice, vtkImageResliceMapToColors);
+
+  ///
+  /// Use vtkImageResliceMapToColors for the 2D slice of single component
+  /// scalar volumes (default). Label maps, vector and tensor volumes always
+  /// use the display node pipeline.
+  vtkGetMacro (UseFusedPipeline, int);
+  vtkSetMacro (UseFusedPipeline, int);
+  vtkBooleanMacro (UseFusedPipeline, int);
+
+  ///
+  /// Set while the slice node is being interacted with (see
+  /// vtkMRMLSliceLogic::StartSliceNodeInteraction). The layer is then
+  /// resliced every InteractionSampleStep pixels (scalar volumes) or with
+  /// nearest neighbor interpolation (other volumes), and in full quality
+  /// again when the interaction ends. Starting an interaction aborts the
+  /// reslice in progress, if any.
+  vtkGetMacro (Interacting, int);
+  void SetInteracting(int interacting);
+  vtkBooleanMacro (Interacting, int);
+
+  ///
+  /// Sample step used while interacting (default: 2)
+  vtkGetMacro (InteractionSampleStep, int);
+  vtkSetClampMacro (InteractionSampleStep, int, 1, 16);
+
+  ///
+  /// Use cubic interpolation instead of linear interpolation when not
+  /// interacting (default: off). Cubic interpolation is only supported by
+  /// the display node pipeline, the fused pipeline is not used then.
+  vtkGetMacro (CubicRefinement, int);
+  vtkSetMacro (CubicRefinement, int);
+  vtkBooleanMacro (CubicRefinement, int);
+
   /// 
   /// Select if this is a label layer or not (it currently determines if we use
   /// the label outline filter)
@@ -96,6 +141,20 @@ public:
   /// 
   /// The filter that turns the label map into an outline
   vtkGetObjectMacro (LabelOutline, vtkImageLabelOutline);
+
+  /// 
+  /// Thickness in pixels of the label outline of the 2D and UVW pipelines
+  /// (default: 1).
+  void SetLabelOutlineThickness(int thickness);
+  int GetLabelOutlineThickness();
+
+  /// 
+  /// Maximum error, in voxels, when reslicing a volume under a non-linear
+  /// transform (default: 0.1). The transform is sampled on a grid of each
+  /// slice and interpolated in between, 0 evaluates it for every pixel.
+  /// \sa vtkImageResliceMask::SetTransformGridErrorBound()
+  void SetNonlinearTransformErrorBound(double errorBound);
+  double GetNonlinearTransformErrorBound();
   
   /// 
   /// Get the output of the pipeline for this layer
@@ -105,6 +164,24 @@ public:
   /// Get the output of the texture UVW pipeline for this layer
   vtkImageData *GetImageDataUVW ();
 
+  ///
+  /// Add to dataObjects the intermediate data of the layer pipelines: the
+  /// outputs of the reslice, display node and label outline filters. The
+  /// volume image data is not added.
+  void GetPipelineDataObjects(vtkCollection* dataObjects);
+
+  ///
+  /// Memory (in kibibytes) of the intermediate data of the layer pipelines.
+  /// \sa GetPipelineDataObjects(), vtkMRMLScene::GetDataObjectsMemorySize()
+  unsigned long GetPipelineMemorySize();
+
+  ///
+  /// Add to dataObjects the output of \a filter, if it has an input, and the
+  /// outputs of the filters upstream. Data objects without producer or with
+  /// a trivial producer (e.g. the volume image data) are not added.
+  static void AddPipelineDataObjects(vtkAlgorithm* filter,
+                                     vtkCollection* dataObjects);
+
   void UpdateImageDisplay();
 
   /// 
@@ -122,8 +199,45 @@ public:
 
   /// 
   /// The current reslice transform XYToIJK
+  /// (linear part only if the volume is under a non-linear transform)
   vtkGetObjectMacro (XYToIJKTransform, vtkTransform);
 
+  /// 
+  /// The reslice transform XYToIJK when the volume is under a non-linear
+  /// transform
+  vtkGetObjectMacro (XYToIJKNonlinearTransform, vtkGeneralTransform);
+
+  ///
+  /// Probe the volume at the xyz position of the slice view (z is the
+  /// light box slice). The voxel is the nearest one to the position mapped
+  /// by the reslice transform, non-linear transforms included. Returns true
+  /// if the voxel is inside the image data.
+  /// The results are read with GetProbeIJK(), GetProbeValues(),
+  /// GetProbeLabelName() and GetProbeString().
+  /// \sa vtkMRMLSliceLogic::Probe()
+  bool Probe(double xyz[3]);
+
+  ///
+  /// Voxel of the last Probe()
+  vtkGetVector3Macro (ProbeIJK, int);
+
+  ///
+  /// Values of the voxel of the last Probe(), in the type of the image data:
+  /// the scalar components, or the tensor of tensor volumes.
+  /// Empty if the voxel is outside of the image data.
+  vtkGetObjectMacro (ProbeValues, vtkDataArray);
+
+  ///
+  /// Name of the label of the voxel of the last Probe() if the volume is a
+  /// label map, empty otherwise.
+  const char* GetProbeLabelName();
+
+  ///
+  /// Human readable description of the voxel of the last Probe(): the
+  /// label name and value of label maps, the scalar invariant of tensor
+  /// volumes or the components of the other volumes.
+  const char* GetProbeString();
+
 
 protected:
   vtkMRMLSliceLayerLogic();
@@ -153,6 +267,9 @@ protected:
   // Copy VolumeDisplayNodeObserved into VolumeDisplayNode
   void UpdateVolumeDisplayNode();
 
+  /// Return true if the 2D slice can be computed by FusedReslice
+  bool CanUseFusedPipeline();
+
   /// 
   /// the MRML Nodes that define this Logic's parameters
   vtkMRMLVolumeNode *VolumeNode;
@@ -165,6 +282,7 @@ protected:
   /// the VTK class instances that implement this Logic's operations
   vtkImageResliceMask *Reslice;
   vtkImageResliceMask *ResliceUVW;
+  vtkImageResliceMapToColors *FusedReslice;
   vtkImageLabelOutline *LabelOutline;
   vtkImageLabelOutline *LabelOutlineUVW;
 
@@ -172,13 +290,29 @@ protected:
   vtkAssignAttribute* AssignAttributeScalarsToTensors;
   vtkAssignAttribute* AssignAttributeScalarsToTensorsUVW;
 
-  /// TODO: make this a vtkAbstractTransform for non-linear
   vtkTransform *XYToIJKTransform;
   vtkTransform *UVWToIJKTransform;
+  /// Used instead of XYToIJKTransform and UVWToIJKTransform for volumes
+  /// under a non-linear transform
+  vtkGeneralTransform *XYToIJKNonlinearTransform;
+  vtkGeneralTransform *UVWToIJKNonlinearTransform;
 
   int IsLabelLayer;
+  int UseFusedPipeline;
+  int Interacting;
+  int InteractionSampleStep;
+  int CubicRefinement;
 
   int UpdatingTransforms;
+
+  int ProbeIJK[3];
+  vtkDataArray* ProbeValues;
+  std::string ProbeLabelName;
+  std::string ProbeString;
+  /// Single voxel image and filter computing the scalar invariant of the
+  /// probed tensors
+  vtkImageData* ProbeTensorImage;
+  vtkDiffusionTensorMathematics* ProbeTensorMathematics;
 };
 
 #endif
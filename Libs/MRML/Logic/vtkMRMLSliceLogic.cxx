@@ -13,6 +13,7 @@
 =========================================================================auto=*/
 
 // MRMLLogic includes
+#include "vtkImageLayerBlend.h"
 #include "vtkMRMLSliceLogic.h"
 #include "vtkMRMLSliceLayerLogic.h"
 
@@ -31,17 +32,15 @@
 // VTK includes
 #include <vtkCallbackCommand.h>
 #include <vtkCollection.h>
-#include <vtkImageBlend.h>
 #include <vtkImageResample.h>
-#include <vtkImageCast.h>
 #include <vtkImageData.h>
-#include <vtkImageMathematics.h>
 #include <vtkImageReslice.h>
 #include <vtkMath.h>
 #include <vtkNew.h>
 #include <vtkPlaneSource.h>
 #include <vtkPolyDataCollection.h>
 #include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
 #include <vtkTransform.h>
 
 // STD includes
@@ -78,8 +77,15 @@ vtkMRMLSliceLogic::vtkMRMLSliceLogic()
   this->SliceCompositeNode = 0;
   this->ForegroundOpacity = 0.5; // Start by blending fg/bg
   this->LabelOpacity = 1.0;
-  this->Blend = vtkImageBlend::New();
-  this->BlendUVW = vtkImageBlend::New();
+  this->InteractionLevelOfDetail = 1;
+  this->ReformatInteracting = false;
+  this->SliceNodeInteracting = false;
+  this->SliceModelTextureInteractionInterval = 100;
+  this->SliceModelTextureAvailable = false;
+  this->SliceModelTextureCopy = vtkImageData::New();
+  this->SliceModelTextureCopyTime = 0.;
+  this->Blend = vtkImageLayerBlend::New();
+  this->BlendUVW = vtkImageLayerBlend::New();
 
   this->ExtractModelTexture = vtkImageReslice::New();
   this->ExtractModelTexture->SetOutputDimensionality (2);
@@ -127,6 +133,11 @@ vtkMRMLSliceLogic::~vtkMRMLSliceLogic()
     this->ExtractModelTexture->Delete();
     this->ExtractModelTexture = 0;
     }
+  if (this->SliceModelTextureCopy)
+    {
+    this->SliceModelTextureCopy->Delete();
+    this->SliceModelTextureCopy = 0;
+    }
   if (this->ActiveSliceTransform)
     {
     this->ActiveSliceTransform->Delete();
@@ -359,6 +370,12 @@ void vtkMRMLSliceLogic::UpdateFromMRMLScene()
 //----------------------------------------------------------------------------
 void vtkMRMLSliceLogic::OnMRMLSceneNodeAdded(vtkMRMLNode* node)
 {
+  if (node->IsA("vtkMRMLViewNode"))
+    {
+    // The slice model may now be shown in 3D
+    this->UpdateSliceModelTexture();
+    return;
+    }
   if (!(node->IsA("vtkMRMLSliceCompositeNode")
         || node->IsA("vtkMRMLSliceNode")
         || node->IsA("vtkMRMLVolumeNode")))
@@ -458,8 +475,12 @@ void vtkMRMLSliceLogic::OnMRMLNodeModified(vtkMRMLNode* node)
     return;
     }
 
-  /// set slice extents in the layes
-  this->SetSliceExtentsToSliceNode();
+  /// set slice extents in the layes, they are recomputed at the end of a
+  /// reformat interaction
+  if (!this->ReformatInteracting)
+    {
+    this->SetSliceExtentsToSliceNode();
+    }
 
   // Update from SliceNode
   if (node == this->SliceNode)
@@ -471,6 +492,7 @@ void vtkMRMLSliceLogic::OnMRMLNodeModified(vtkMRMLNode* node)
     if ( sliceDisplayNode)
       {
       sliceDisplayNode->SetVisibility( this->SliceNode->GetSliceVisible() );
+      this->UpdateSliceModelTexture();
       }
     }
   else if (node == this->SliceCompositeNode)
@@ -568,11 +590,24 @@ void vtkMRMLSliceLogic::ProcessMRMLLogicsEvents()
     textureToRAS->MultiplyPoint(inPt, outPt);
     points->SetPoint(3, outPt3);
 
-    this->UpdatePipeline();
+    // The layers and the blends don't change while the slice is rotated,
+    // only the reslice axes (updated by the layers) and the texture do.
+    if (!this->ReformatInteracting)
+      {
+      this->UpdatePipeline();
+      }
+    else
+      {
+      this->UpdateSliceModelTexture();
+      }
     points->Modified();
-    this->SliceModelNode->GetPolyData()->Modified();
+    // The model is updated from its points when it is shown again
+    if (this->IsSliceModelVisibleInThreeDViews())
+      {
+      this->SliceModelNode->GetPolyData()->Modified();
+      }
     vtkMRMLModelDisplayNode *modelDisplayNode = this->SliceModelNode->GetModelDisplayNode();
-    if ( modelDisplayNode )
+    if ( modelDisplayNode && !this->ReformatInteracting )
       {
       if (this->LabelLayer && this->LabelLayer->GetImageDataUVW())
         {
@@ -797,6 +832,30 @@ vtkImageData * vtkMRMLSliceLogic::GetImageData()
     }
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLSliceLogic::GetPipelineDataObjects(vtkCollection* dataObjects)
+{
+  vtkMRMLSliceLayerLogic* layers[3] =
+    {this->BackgroundLayer, this->ForegroundLayer, this->LabelLayer};
+  for (int i = 0; i < 3; ++i)
+    {
+    if (layers[i])
+      {
+      layers[i]->GetPipelineDataObjects(dataObjects);
+      }
+    }
+  vtkMRMLSliceLayerLogic::AddPipelineDataObjects(this->Blend, dataObjects);
+  vtkMRMLSliceLayerLogic::AddPipelineDataObjects(this->BlendUVW, dataObjects);
+}
+
+//----------------------------------------------------------------------------
+unsigned long vtkMRMLSliceLogic::GetPipelineMemorySize()
+{
+  vtkNew<vtkCollection> dataObjects;
+  this->GetPipelineDataObjects(dataObjects.GetPointer());
+  return vtkMRMLScene::GetDataObjectsMemorySize(dataObjects.GetPointer());
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLSliceLogic::UpdateImageData ()
 {
@@ -969,61 +1028,29 @@ void vtkMRMLSliceLogic::UpdatePipeline()
 
     if (!alphaBlending)
       {
-      vtkImageMathematics *tempMath = vtkImageMathematics::New();
-      if (sliceCompositing == vtkMRMLSliceCompositeNode::Add)
-        {
-        // add the foreground and background
-        tempMath->SetOperationToAdd();
-        }
-      else if (sliceCompositing == vtkMRMLSliceCompositeNode::Subtract)
-        {
-        // subtract the foreground and background
-        tempMath->SetOperationToSubtract();
-        }
-
-      tempMath->SetInput1( foregroundImage );
-      tempMath->SetInput2( backgroundImage );
-      tempMath->GetOutput()->SetScalarType(VTK_SHORT);
-
-      vtkImageCast *tempCast = vtkImageCast::New();
-      tempCast->SetInput( tempMath->GetOutput() );
-      tempCast->SetOutputScalarTypeToUnsignedChar();
-
-      this->Blend->SetInput( layerIndex, tempCast->GetOutput() );
+      // the blend filter combines the first 2 layers: foreground +/- background
+      int compositing = (sliceCompositing == vtkMRMLSliceCompositeNode::Add) ?
+        vtkImageLayerBlend::Add : vtkImageLayerBlend::Subtract;
+      this->Blend->SetCompositing(compositing);
+      this->Blend->SetInput( layerIndex, backgroundImage );
+      this->Blend->SetOpacity( layerIndex++, 1.0 );
+      this->Blend->SetInput( layerIndex, foregroundImage );
       this->Blend->SetOpacity( layerIndex++, 1.0 );
-
-      tempMath->Delete();  // Blend may still be holding a reference
-      tempCast->Delete();  // Blend may still be holding a reference
 
       // UVW pipeline
-      vtkImageMathematics *tempMathUVW = vtkImageMathematics::New();
-      if (sliceCompositing == vtkMRMLSliceCompositeNode::Add)
+      this->BlendUVW->SetCompositing(compositing);
+      if ( backgroundImageUVW && foregroundImageUVW )
         {
-        // add the foreground and background
-        tempMathUVW->SetOperationToAdd();
+        this->BlendUVW->SetInput( layerIndexUVW, backgroundImageUVW );
+        this->BlendUVW->SetOpacity( layerIndexUVW++, 1.0 );
+        this->BlendUVW->SetInput( layerIndexUVW, foregroundImageUVW );
+        this->BlendUVW->SetOpacity( layerIndexUVW++, 1.0 );
         }
-      else if (sliceCompositing == vtkMRMLSliceCompositeNode::Subtract)
-        {
-        // subtract the foreground and background
-        tempMathUVW->SetOperationToSubtract();
-        }
-
-      tempMathUVW->SetInput1( foregroundImageUVW );
-      tempMathUVW->SetInput2( backgroundImageUVW );
-      tempMathUVW->GetOutput()->SetScalarType(VTK_SHORT);
-
-      vtkImageCast *tempCastUVW = vtkImageCast::New();
-      tempCastUVW->SetInput( tempMathUVW->GetOutput() );
-      tempCastUVW->SetOutputScalarTypeToUnsignedChar();
-
-      this->BlendUVW->SetInput( layerIndexUVW, tempCastUVW->GetOutput() );
-      this->BlendUVW->SetOpacity( layerIndexUVW++, 1.0 );
-
-      tempMathUVW->Delete();  // Blend may still be holding a reference
-      tempCastUVW->Delete();  // Blend may still be holding a reference
       }
     else
       {
+      this->Blend->SetCompositingToAlpha();
+      this->BlendUVW->SetCompositingToAlpha();
       if (sliceCompositing ==  vtkMRMLSliceCompositeNode::Alpha)
         {
         if ( backgroundImage )
@@ -1113,19 +1140,12 @@ void vtkMRMLSliceLogic::UpdatePipeline()
         {
         displayNode->SetVisibility( this->SliceNode->GetSliceVisible() );
         }
-      if ( (this->SliceNode->GetSliceResolutionMode() != vtkMRMLSliceNode::SliceResolutionMatch2DView &&
-          !((backgroundImageUVW != 0) || (foregroundImageUVW != 0) || (labelImageUVW != 0) ) ) ||
-          (this->SliceNode->GetSliceResolutionMode() == vtkMRMLSliceNode::SliceResolutionMatch2DView &&
-          !((backgroundImage != 0) || (foregroundImage != 0) || (labelImage != 0) ) ))
-        {
-        displayNode->SetAndObserveTextureImageData(0);
-        }
-      else if (displayNode->GetTextureImageData() != this->ExtractModelTexture->GetOutput())
-        {
-        // upadte texture
-        //this->ExtractModelTexture->Update();
-        displayNode->SetAndObserveTextureImageData(this->ExtractModelTexture->GetOutput());
-        }
+      this->SliceModelTextureAvailable =
+        (this->SliceNode->GetSliceResolutionMode() != vtkMRMLSliceNode::SliceResolutionMatch2DView &&
+          ((backgroundImageUVW != 0) || (foregroundImageUVW != 0) || (labelImageUVW != 0) ) ) ||
+        (this->SliceNode->GetSliceResolutionMode() == vtkMRMLSliceNode::SliceResolutionMatch2DView &&
+          ((backgroundImage != 0) || (foregroundImage != 0) || (labelImage != 0) ) );
+      this->UpdateSliceModelTexture();
         if ( this->LabelLayer && this->LabelLayer->GetImageData())
           {
           modelDisplayNode->SetInterpolateTexture(0);
@@ -1137,7 +1157,8 @@ void vtkMRMLSliceLogic::UpdatePipeline()
        }
     if ( modified )
       {
-      if (this->SliceModelNode && this->SliceModelNode->GetPolyData())
+      if (this->SliceModelNode && this->SliceModelNode->GetPolyData() &&
+          this->IsSliceModelVisibleInThreeDViews())
         {
         this->SliceModelNode->GetPolyData()->Modified();
         }
@@ -1229,6 +1250,10 @@ void vtkMRMLSliceLogic::PrintSelf(ostream& os, vtkIndent indent)
 
   os << indent << "ForegroundOpacity: " << this->ForegroundOpacity << "\n";
   os << indent << "LabelOpacity: " << this->LabelOpacity << "\n";
+  os << indent << "InteractionLevelOfDetail: " << this->InteractionLevelOfDetail << "\n";
+  os << indent << "ReformatInteracting: " << this->ReformatInteracting << "\n";
+  os << indent << "SliceModelTextureInteractionInterval: "
+     << this->SliceModelTextureInteractionInterval << "\n";
 
   os << indent << "SLICE_MODEL_NODE_NAME_SUFFIX: " << this->SLICE_MODEL_NODE_NAME_SUFFIX << "\n";
 
@@ -1425,6 +1450,20 @@ vtkMRMLVolumeNode *vtkMRMLSliceLogic::GetLayerVolumeNode(int layer)
     scene->GetNodeByID( id )) : 0;
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLSliceLogic::Probe(double xyz[3])
+{
+  vtkMRMLSliceLayerLogic* layers[3] =
+    {this->BackgroundLayer, this->ForegroundLayer, this->LabelLayer};
+  for (int i = 0; i < 3; ++i)
+    {
+    if (layers[i])
+      {
+      layers[i]->Probe(xyz);
+      }
+    }
+}
+
 //----------------------------------------------------------------------------
 // Get the size of the volume, transformed to RAS space
 void vtkMRMLSliceLogic::GetVolumeRASBox(vtkMRMLVolumeNode *volumeNode, double rasDimensions[3], double rasCenter[3])
@@ -2034,6 +2073,15 @@ void vtkMRMLSliceLogic::StartSliceNodeInteraction(unsigned int parameters)
   // to this this outside the conditional on HotLinkedControl and LinkedControl
   sliceNode->SetInteractionFlags(parameters);
 
+  this->ReformatInteracting =
+    (parameters & vtkMRMLSliceNode::MultiplanarReformatFlag) != 0;
+  this->SliceNodeInteracting = true;
+
+  if (this->InteractionLevelOfDetail)
+    {
+    this->SetLayersInteracting(1);
+    }
+
   // If we have hot linked controls, then we want to broadcast changes
   if (compositeNode && 
       (compositeNode->GetHotLinkedControl() || parameters == vtkMRMLSliceNode::MultiplanarReformatFlag)
@@ -2150,6 +2198,21 @@ void vtkMRMLSliceLogic::EndSliceNodeInteraction()
   vtkMRMLSliceNode *sliceNode = this->GetSliceNode();
   vtkMRMLSliceCompositeNode *compositeNode = this->GetSliceCompositeNode();
 
+  // Back to full quality
+  this->SetLayersInteracting(0);
+
+  // The texture follows the slice again
+  this->SliceNodeInteracting = false;
+  this->UpdateSliceModelTexture();
+
+  // Validate what has been skipped during the reformat interaction
+  if (this->ReformatInteracting)
+    {
+    this->ReformatInteracting = false;
+    this->SetSliceExtentsToSliceNode();
+    this->ProcessMRMLLogicsEvents();
+    }
+
   // If we have linked controls, then we want to broadcast changes
   if (compositeNode && compositeNode->GetLinkedControl())
     {
@@ -2165,6 +2228,78 @@ void vtkMRMLSliceLogic::EndSliceNodeInteraction()
     }
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLSliceLogic::SetLayersInteracting(int interacting)
+{
+  vtkMRMLSliceLayerLogic* layers[3] =
+    {this->BackgroundLayer, this->ForegroundLayer, this->LabelLayer};
+  for (int i = 0; i < 3; ++i)
+    {
+    if (layers[i])
+      {
+      layers[i]->SetInteracting(interacting);
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLSliceLogic::IsSliceModelVisibleInThreeDViews()
+{
+  vtkMRMLDisplayNode* displayNode =
+    this->SliceModelNode ? this->SliceModelNode->GetModelDisplayNode() : 0;
+  if (!displayNode || !this->SliceNode || !this->SliceNode->GetSliceVisible() ||
+      !this->GetMRMLScene())
+    {
+    return false;
+    }
+  const int viewCount =
+    this->GetMRMLScene()->GetNumberOfNodesByClass("vtkMRMLViewNode");
+  for (int i = 0; i < viewCount; ++i)
+    {
+    vtkMRMLNode* viewNode =
+      this->GetMRMLScene()->GetNthNodeByClass(i, "vtkMRMLViewNode");
+    if (viewNode && displayNode->GetVisibility(viewNode->GetID()))
+      {
+      return true;
+      }
+    }
+  return false;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLSliceLogic::UpdateSliceModelTexture()
+{
+  vtkMRMLModelDisplayNode* displayNode =
+    this->SliceModelNode ? this->SliceModelNode->GetModelDisplayNode() : 0;
+  if (!displayNode)
+    {
+    return;
+    }
+  vtkImageData* texture = 0;
+  if (this->SliceModelTextureAvailable &&
+      this->IsSliceModelVisibleInThreeDViews())
+    {
+    texture = this->ExtractModelTexture->GetOutput();
+    if (this->SliceNodeInteracting)
+      {
+      double now = vtkTimerLog::GetUniversalTime();
+      if (displayNode->GetTextureImageData() != this->SliceModelTextureCopy ||
+          (now - this->SliceModelTextureCopyTime) * 1000. >=
+            this->SliceModelTextureInteractionInterval)
+        {
+        this->ExtractModelTexture->Update();
+        this->SliceModelTextureCopy->DeepCopy(this->ExtractModelTexture->GetOutput());
+        this->SliceModelTextureCopyTime = now;
+        }
+      texture = this->SliceModelTextureCopy;
+      }
+    }
+  if (displayNode->GetTextureImageData() != texture)
+    {
+    displayNode->SetAndObserveTextureImageData(texture);
+    }
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLSliceLogic::StartSliceOffsetInteraction()
 {
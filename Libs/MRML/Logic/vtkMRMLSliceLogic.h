@@ -31,7 +31,7 @@ class vtkMRMLSliceNode;
 class vtkMRMLVolumeNode;
 
 class vtkCollection;
-class vtkImageBlend;
+class vtkImageLayerBlend;
 class vtkTransform;
 class vtkImageData;
 class vtkImageReslice;
@@ -131,10 +131,11 @@ public:
   vtkGetObjectMacro(SliceModelTransformNode, vtkMRMLLinearTransformNode);
 
   /// 
-  /// The compositing filter
-  /// TODO: this will eventually be generalized to a per-layer compositing function
-  vtkGetObjectMacro(Blend, vtkImageBlend);
-  vtkGetObjectMacro(BlendUVW, vtkImageBlend);
+  /// The compositing filter, it blends the layers in the order
+  /// background, foreground, label (or foreground, background, label in
+  /// ReverseAlpha compositing)
+  vtkGetObjectMacro(Blend, vtkImageLayerBlend);
+  vtkGetObjectMacro(BlendUVW, vtkImageLayerBlend);
 
   /// 
   /// The offset to the correct slice for lightbox mode
@@ -158,6 +159,18 @@ public:
   /// -- returns NULL if none of the inputs exist
   vtkImageData *GetImageData();
 
+  ///
+  /// Add to dataObjects the intermediate data of the pipelines of the layers
+  /// and of the blend filters.
+  /// \sa vtkMRMLSliceLayerLogic::GetPipelineDataObjects()
+  void GetPipelineDataObjects(vtkCollection* dataObjects);
+
+  ///
+  /// Memory (in kibibytes) of the intermediate data of the slice pipelines.
+  /// The blended image used as texture by the slice model is also accounted
+  /// by the scene (vtkMRMLScene::GetNodeOwnedMemorySize()).
+  unsigned long GetPipelineMemorySize();
+
   /// 
   /// update the pipeline to reflect the current state of the nodes
   void UpdatePipeline();
@@ -186,6 +199,12 @@ public:
   /// (0=background, 1=foreground, 2=label)
   vtkMRMLVolumeNode *GetLayerVolumeNode(int layer);
 
+  ///
+  /// Probe the background, foreground and label layers at the xyz position
+  /// of the slice view, the results are read from each layer.
+  /// \sa vtkMRMLSliceLayerLogic::Probe()
+  void Probe(double xyz[3]);
+
   /// 
   /// Get the size of the volume, transformed to RAS space
   static void GetVolumeRASBox(vtkMRMLVolumeNode *volumeNode, double rasDimensions[3], double rasCenter[3]);
@@ -280,6 +299,11 @@ public:
   /// Indicate an interaction with the slice node is beginning. The
   /// parameters of the slice node being manipulated are passed as a
   /// bitmask. See vtkMRMLSliceNode::InteractionFlagType.
+  /// During a vtkMRMLSliceNode::MultiplanarReformatFlag interaction, only
+  /// the reslice axes of the layers and the slice model are updated when
+  /// the slice node is modified: the layers and the blends are not
+  /// validated again and the slice extents are not recomputed until
+  /// EndSliceNodeInteraction().
   void StartSliceNodeInteraction(unsigned int parameters);
 
   /// Indicate an interaction with the slice node has been completed
@@ -296,9 +320,31 @@ public:
   /// Indicate the slice offset value is starting to change
   void StartSliceOffsetInteraction();
 
+  ///
+  /// Reslice the layers in low resolution between StartSliceNodeInteraction()
+  /// and EndSliceNodeInteraction() (default: on).
+  /// \sa vtkMRMLSliceLayerLogic::SetInteracting
+  vtkGetMacro(InteractionLevelOfDetail, int);
+  vtkSetMacro(InteractionLevelOfDetail, int);
+  vtkBooleanMacro(InteractionLevelOfDetail, int);
+
   /// Indicate the slice offset value has completed its change
   void EndSliceOffsetInteraction();
 
+  ///
+  /// Minimum time in ms between two updates of the slice model texture
+  /// between StartSliceNodeInteraction() and EndSliceNodeInteraction()
+  /// (default: 100ms). The 3D views then show a copy of the slice that is
+  /// refreshed at that rate, the texture follows the slice again at the end
+  /// of the interaction.
+  vtkGetMacro(SliceModelTextureInteractionInterval, int);
+  vtkSetClampMacro(SliceModelTextureInteractionInterval, int, 0, VTK_INT_MAX);
+
+  ///
+  /// Return true if the slice model is visible in at least one 3D view.
+  /// The slice model is only textured when it is shown.
+  bool IsSliceModelVisibleInThreeDViews();
+
   /// 
   /// Set the current distance so that it corresponds to the closest center of 
   /// a voxel in IJK space (integer value)
@@ -370,6 +416,14 @@ protected:
   void UpdateSliceNodes();
   void SetupCrosshairNode();
 
+  /// Set the interacting state of all the layers
+  void SetLayersInteracting(int interacting);
+
+  /// Set the texture of the slice model: none if the slice model is not
+  /// shown in 3D, a copy of the slice during interactions, the slice
+  /// otherwise. The slice output is shared by all the 3D views.
+  void UpdateSliceModelTexture();
+
   virtual void OnMRMLNodeModified(vtkMRMLNode* node);
 
   bool                        AddingSliceModelNodes;
@@ -384,9 +438,20 @@ protected:
 
   double ForegroundOpacity;
   double LabelOpacity;
-
-  vtkImageBlend *   Blend;
-  vtkImageBlend *   BlendUVW;
+  int InteractionLevelOfDetail;
+  /// Set between the start and the end of a reformat interaction
+  bool ReformatInteracting;
+  /// Set between the start and the end of any slice node interaction
+  bool SliceNodeInteracting;
+  int SliceModelTextureInteractionInterval;
+  /// True if a layer has an image to texture the slice model with
+  bool SliceModelTextureAvailable;
+  /// Copy of the texture displayed during interactions
+  vtkImageData* SliceModelTextureCopy;
+  double SliceModelTextureCopyTime;
+
+  vtkImageLayerBlend *   Blend;
+  vtkImageLayerBlend *   BlendUVW;
   vtkImageReslice * ExtractModelTexture;
   vtkImageData *    ImageData;
   vtkTransform *    ActiveSliceTransform;
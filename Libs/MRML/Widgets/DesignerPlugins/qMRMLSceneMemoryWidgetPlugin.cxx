@@ -0,0 +1,62 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#include "qMRMLSceneMemoryWidgetPlugin.h"
+#include "qMRMLSceneMemoryWidget.h"
+
+//------------------------------------------------------------------------------
+qMRMLSceneMemoryWidgetPlugin::qMRMLSceneMemoryWidgetPlugin(QObject *_parent)
+  : QObject(_parent)
+{
+}
+
+//------------------------------------------------------------------------------
+QWidget *qMRMLSceneMemoryWidgetPlugin::createWidget(QWidget *_parent)
+{
+  qMRMLSceneMemoryWidget* _widget = new qMRMLSceneMemoryWidget(_parent);
+  return _widget;
+}
+
+//------------------------------------------------------------------------------
+QString qMRMLSceneMemoryWidgetPlugin::domXml() const
+{
+  return "<widget class=\"qMRMLSceneMemoryWidget\" \
+          name=\"MRMLSceneMemoryWidget\">\n"
+          "</widget>\n";
+}
+
+//------------------------------------------------------------------------------
+QIcon qMRMLSceneMemoryWidgetPlugin::icon() const
+{
+  return QIcon(":/Icons/combobox.png");
+}
+
+//------------------------------------------------------------------------------
+QString qMRMLSceneMemoryWidgetPlugin::includeFile() const
+{
+  return "qMRMLSceneMemoryWidget.h";
+}
+
+//------------------------------------------------------------------------------
+bool qMRMLSceneMemoryWidgetPlugin::isContainer() const
+{
+  return false;
+}
+
+//------------------------------------------------------------------------------
+QString qMRMLSceneMemoryWidgetPlugin::name() const
+{
+  return "qMRMLSceneMemoryWidget";
+}
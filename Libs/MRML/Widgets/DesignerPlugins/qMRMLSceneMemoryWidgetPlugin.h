@@ -0,0 +1,40 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __qMRMLSceneMemoryWidgetPlugin_h
+#define __qMRMLSceneMemoryWidgetPlugin_h
+
+#include "qMRMLWidgetsAbstractPlugin.h"
+
+class QMRML_WIDGETS_PLUGINS_EXPORT qMRMLSceneMemoryWidgetPlugin
+  : public QObject
+  , public qMRMLWidgetsAbstractPlugin
+{
+  Q_OBJECT
+
+public:
+  qMRMLSceneMemoryWidgetPlugin(QObject *_parent = 0);
+  
+  QWidget *createWidget(QWidget *_parent);
+  QString  domXml() const;
+  QIcon    icon() const;
+  QString  includeFile() const;
+  bool     isContainer() const;
+  QString  name() const;
+  
+};
+
+#endif
+
@@ -59,6 +59,7 @@
 #include "qMRMLWidgetPlugin.h"
 #include "qMRMLWindowLevelWidgetPlugin.h"
 #include "qMRMLSceneFactoryWidgetPlugin.h"
+#include "qMRMLSceneMemoryWidgetPlugin.h"
 
 // \class Group the plugins in one library
 class QMRML_WIDGETS_PLUGINS_EXPORT qMRMLWidgetsPlugin
@@ -95,6 +96,7 @@ public:
             << new qMRMLROIWidgetPlugin
             << new qMRMLScalarInvariantComboBoxPlugin
             << new qMRMLSceneFactoryWidgetPlugin
+            << new qMRMLSceneMemoryWidgetPlugin
             << new qMRMLSliceControllerWidgetPlugin
             << new qMRMLSliceInformationWidgetPlugin
             << new qMRMLSliceWidgetPlugin
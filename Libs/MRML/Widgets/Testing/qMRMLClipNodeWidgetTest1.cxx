@@ -158,6 +158,24 @@ int qMRMLClipNodeWidgetTest1(int argc, char * argv [] )
     return EXIT_FAILURE;
     }
 
+  // Clip method
+  clipNode->SetClipMethod(vtkMRMLClipModelsNode::ClipFragments);
+
+  if (clipNodeWidget.clipMethod() != vtkMRMLClipModelsNode::ClipFragments)
+    {
+    std::cerr << "vtkMRMLClipModelsNode::SetClipMethod() failed: " << clipNodeWidget.clipMethod() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  clipNodeWidget.setClipMethod(vtkMRMLClipModelsNode::ClipGeometry);
+
+  if (clipNode->GetClipMethod() != vtkMRMLClipModelsNode::ClipGeometry)
+    {
+    std::cerr << "qMRMLClipNodeWidget::setClipMethod() failed: "
+              << clipNode->GetClipMethod() << std::endl;
+    return EXIT_FAILURE;
+    }
+
   clipNodeWidget.show();
 
   if (argc < 2 || QString(argv[1]) != "-I" )
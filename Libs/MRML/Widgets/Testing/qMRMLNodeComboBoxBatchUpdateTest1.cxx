@@ -0,0 +1,115 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Copyright (c) Kitware Inc.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  This file was originally developed by Julien Finet, Kitware Inc.
+  and was partially funded by NIH grant 3P41RR013218-12S1
+
+==============================================================================*/
+
+// QT includes
+#include <QApplication>
+#include <QTimer>
+
+// qMRML includes
+#include "qMRMLNodeComboBox.h"
+#include "qMRMLSceneModel.h"
+
+// MRML includes
+#include <vtkMRMLColorTableNode.h>
+#include <vtkMRMLScene.h>
+
+// VTK includes
+#include <vtkNew.h>
+
+// STD includes
+
+int qMRMLNodeComboBoxBatchUpdateTest1( int argc, char * argv [] )
+{
+  QApplication app(argc, argv);
+
+  qMRMLNodeComboBox nodeSelector;
+  nodeSelector.setNodeTypes(QStringList("vtkMRMLColorTableNode"));
+  nodeSelector.setShowHidden(true);
+  nodeSelector.setNoneEnabled(true);
+  // The batch update must not impact the other comboboxes
+  nodeSelector.setSharedSceneModel(false);
+
+  qMRMLSceneModel* sceneModel =
+    qobject_cast<qMRMLSceneModel*>(nodeSelector.sortFilterProxyModel()->sourceModel());
+  sceneModel->setBatchUpdate(true);
+
+  vtkNew<vtkMRMLScene> scene;
+  nodeSelector.setMRMLScene(scene.GetPointer());
+
+  vtkNew<vtkMRMLColorTableNode> node;
+  scene->AddNode(node.GetPointer());
+  nodeSelector.setCurrentNode(node.GetPointer());
+  if (nodeSelector.nodeCount() != 1 ||
+      nodeSelector.currentNode() != node.GetPointer())
+    {
+    std::cerr << "qMRMLSceneModel::BatchUpdate failed when adding a node"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  scene->StartState(vtkMRMLScene::ImportState);
+  vtkNew<vtkMRMLColorTableNode> node2;
+  scene->AddNode(node2.GetPointer());
+  vtkNew<vtkMRMLColorTableNode> node3;
+  scene->AddNode(node3.GetPointer());
+
+  if (nodeSelector.nodeCount() != 1)
+    {
+    std::cerr << "qMRMLSceneModel::BatchUpdate failed when importing nodes"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  scene->EndState(vtkMRMLScene::ImportState);
+
+  if (nodeSelector.nodeCount() != 3 ||
+      sceneModel->itemFromNode(node3.GetPointer()) == 0)
+    {
+    std::cerr << "qMRMLSceneModel::BatchUpdate failed when updating the scene"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (nodeSelector.currentNode() != node.GetPointer())
+    {
+    std::cerr << "qMRMLNodeComboBox lost its current node on model reset"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  scene->StartState(vtkMRMLScene::BatchProcessState);
+  scene->RemoveNode(node2.GetPointer());
+  scene->EndState(vtkMRMLScene::BatchProcessState);
+  if (nodeSelector.nodeCount() != 2 ||
+      sceneModel->itemFromNode(node2.GetPointer()) != 0)
+    {
+    std::cerr << "qMRMLSceneModel::BatchUpdate failed when removing a node"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  nodeSelector.show();
+
+  if (argc < 2 || QString(argv[1]) != "-I")
+    {
+    QTimer::singleShot(200, &app, SLOT(quit()));
+    }
+
+  return app.exec();
+}
@@ -48,6 +48,8 @@ int qMRMLNodeComboBoxLazyUpdateTest1( int argc, char * argv [] )
   nodeSelector.setNodeTypes(QStringList("vtkMRMLColorTableNode"));
   nodeSelector.setShowHidden(true);
   nodeSelector.setNoneEnabled(true);
+  // The lazy update must not impact the other comboboxes
+  nodeSelector.setSharedSceneModel(false);
 
   qobject_cast<qMRMLSceneModel*>(nodeSelector.sortFilterProxyModel()->sourceModel())
     ->setLazyUpdate(true);
@@ -84,6 +86,7 @@ int qMRMLNodeComboBoxLazyUpdateTest1( int argc, char * argv [] )
   nodeSelector2.setNodeTypes(QStringList("vtkMRMLColorTableNode"));
   nodeSelector2.setShowHidden(true);
   nodeSelector2.setNoneEnabled(true);
+  nodeSelector2.setSharedSceneModel(false);
 
   qMRMLColorTableComboBox treeNodeSelector2;
 
@@ -0,0 +1,156 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// QT includes
+#include <QApplication>
+#include <QTimer>
+
+// qMRML includes
+#include "qMRMLNodeComboBox.h"
+#include "qMRMLSceneModel.h"
+
+// MRML includes
+#include <vtkMRMLScene.h>
+#include <vtkMRMLScalarVolumeNode.h>
+
+// VTK includes
+#include <vtkNew.h>
+
+// STD includes
+
+// test the scene model shared by the comboboxes of a scene
+int qMRMLNodeComboBoxTest8( int argc, char * argv [] )
+{
+  QApplication app(argc, argv);
+
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLScalarVolumeNode> volumeNode;
+  scene->AddNode(volumeNode.GetPointer());
+  vtkNew<vtkMRMLScalarVolumeNode> labelMapNode;
+  labelMapNode->SetAttribute("LabelMap", "1");
+  scene->AddNode(labelMapNode.GetPointer());
+
+  qMRMLNodeComboBox volumeSelector;
+  volumeSelector.setNodeTypes(QStringList("vtkMRMLScalarVolumeNode"));
+  volumeSelector.setNoneEnabled(true);
+  volumeSelector.setMRMLScene(scene.GetPointer());
+
+  qMRMLNodeComboBox labelMapSelector;
+  labelMapSelector.setNodeTypes(QStringList("vtkMRMLScalarVolumeNode"));
+  labelMapSelector.addAttribute("vtkMRMLScalarVolumeNode", "LabelMap", "1");
+  labelMapSelector.setAddEnabled(false);
+  labelMapSelector.setRemoveEnabled(false);
+  labelMapSelector.setMRMLScene(scene.GetPointer());
+
+  if (!volumeSelector.sharedSceneModel() ||
+      volumeSelector.sceneModel() != labelMapSelector.sceneModel())
+    {
+    std::cerr << "qMRMLNodeComboBox: the comboboxes of a scene don't share "
+              << "the scene model" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The filters and the extra items belong to each combobox (rows under the
+  // scene item):
+  // volumeSelector: None, volume, labelmap, separator, create, delete
+  // labelMapSelector: labelmap
+  if (volumeSelector.nodeCount() != 2 ||
+      labelMapSelector.nodeCount() != 1 ||
+      volumeSelector.model()->rowCount(volumeSelector.model()->index(0, 0)) != 6 ||
+      labelMapSelector.model()->rowCount(labelMapSelector.model()->index(0, 0)) != 1)
+    {
+    std::cerr << "qMRMLNodeComboBox: wrong filtering with a shared scene model: "
+              << volumeSelector.nodeCount() << " "
+              << labelMapSelector.nodeCount() << " "
+              << volumeSelector.model()->rowCount(volumeSelector.model()->index(0, 0)) << " "
+              << labelMapSelector.model()->rowCount(labelMapSelector.model()->index(0, 0)) << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  volumeSelector.setCurrentNode(labelMapNode.GetPointer());
+  if (volumeSelector.currentNode() != labelMapNode.GetPointer() ||
+      volumeSelector.nodeFromIndex(0) != volumeNode.GetPointer())
+    {
+    std::cerr << "qMRMLNodeComboBox: failed to select a node with a "
+              << "shared scene model" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Nodes added to the scene go into all the comboboxes
+  vtkNew<vtkMRMLScalarVolumeNode> labelMapNode2;
+  labelMapNode2->SetAttribute("LabelMap", "1");
+  scene->AddNode(labelMapNode2.GetPointer());
+  if (volumeSelector.nodeCount() != 3 ||
+      labelMapSelector.nodeCount() != 2 ||
+      volumeSelector.currentNode() != labelMapNode.GetPointer())
+    {
+    std::cerr << "qMRMLNodeComboBox: failed to add a node with a "
+              << "shared scene model" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // A combobox that doesn't share the scene model
+  labelMapSelector.setSharedSceneModel(false);
+  if (labelMapSelector.sharedSceneModel() ||
+      labelMapSelector.sceneModel() == volumeSelector.sceneModel() ||
+      labelMapSelector.mrmlScene() != scene.GetPointer() ||
+      labelMapSelector.nodeCount() != 2)
+    {
+    std::cerr << "qMRMLNodeComboBox::setSharedSceneModel(false) failed"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  scene->RemoveNode(volumeNode.GetPointer());
+  if (volumeSelector.nodeCount() != 2 ||
+      labelMapSelector.nodeCount() != 2 ||
+      volumeSelector.currentNode() != labelMapNode.GetPointer())
+    {
+    std::cerr << "qMRMLNodeComboBox: failed to remove a node with a "
+              << "shared scene model" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  labelMapSelector.setSharedSceneModel(true);
+  if (labelMapSelector.sceneModel() != volumeSelector.sceneModel() ||
+      labelMapSelector.nodeCount() != 2)
+    {
+    std::cerr << "qMRMLNodeComboBox::setSharedSceneModel(true) failed"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Another scene has its own scene model
+  vtkNew<vtkMRMLScene> scene2;
+  labelMapSelector.setMRMLScene(scene2.GetPointer());
+  if (labelMapSelector.sceneModel() == volumeSelector.sceneModel() ||
+      labelMapSelector.nodeCount() != 0 ||
+      volumeSelector.nodeCount() != 2)
+    {
+    std::cerr << "qMRMLNodeComboBox: failed to change the scene of a "
+              << "shared scene model" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  volumeSelector.show();
+  labelMapSelector.show();
+
+  if (argc < 2 || QString(argv[1]) != "-I")
+    {
+    QTimer::singleShot(200, &app, SLOT(quit()));
+    }
+
+  return app.exec();
+}
@@ -0,0 +1,121 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Copyright (c) Kitware Inc.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  This file was originally developed by Jean-Christophe Fillion-Robin, Kitware Inc.
+  and was partially funded by NIH grant 3P41RR013218-12S1
+
+==============================================================================*/
+
+// Qt includes
+#include <QApplication>
+#include <QTimer>
+
+// qMRML includes
+#include "qMRMLRenderScheduler.h"
+#include "qMRMLThreeDView.h"
+
+// STD includes
+#include <iostream>
+
+int qMRMLRenderSchedulerTest1(int argc, char * argv [] )
+{
+  QApplication app(argc, argv);
+
+  qMRMLRenderScheduler scheduler;
+  if (scheduler.maximumFrameRate() != 60.)
+    {
+    std::cerr << "Wrong default maximum frame rate: "
+              << scheduler.maximumFrameRate() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  qMRMLThreeDView view1;
+  qMRMLThreeDView view2;
+  view1.setRenderScheduler(&scheduler);
+  view2.setRenderScheduler(&scheduler);
+  if (scheduler.views().count() != 2 ||
+      view1.renderScheduler() != &scheduler)
+    {
+    std::cerr << "qMRMLThreeDView::setRenderScheduler failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  view1.show();
+  view2.show();
+  // Start from a clean state
+  scheduler.renderPendingViews();
+  scheduler.resetStatistics();
+
+  // Requests are coalesced until the next frame
+  scheduler.requestRender(&view1);
+  scheduler.requestRender(&view1);
+  scheduler.requestRender(&view1);
+  scheduler.requestRender(&view2);
+  if (!scheduler.isRenderPending(&view1) ||
+      !scheduler.isRenderPending(&view2) ||
+      scheduler.renderCount() != 0 ||
+      scheduler.skippedRenderCount() != 2 ||
+      scheduler.skippedRenderCount(&view1) != 2)
+    {
+    std::cerr << "qMRMLRenderScheduler::requestRender failed: "
+              << scheduler.renderCount() << " renders, "
+              << scheduler.skippedRenderCount() << " skipped" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  scheduler.renderPendingViews();
+  if (scheduler.isRenderPending(&view1) ||
+      scheduler.renderCount() != 2 ||
+      scheduler.renderCount(&view1) != 1 ||
+      scheduler.renderCount(&view2) != 1)
+    {
+    std::cerr << "qMRMLRenderScheduler::renderPendingViews failed: "
+              << scheduler.renderCount() << " renders" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  scheduler.resetStatistics();
+  if (scheduler.renderCount() != 0 || scheduler.skippedRenderCount() != 0)
+    {
+    std::cerr << "qMRMLRenderScheduler::resetStatistics failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The frame is rendered once the event loop is entered
+  scheduler.setInteractionView(&view2);
+  scheduler.requestRender(&view1);
+  scheduler.requestRender(&view2);
+  QTimer::singleShot(200, &app, SLOT(quit()));
+  app.exec();
+  if (scheduler.renderCount(&view1) < 1 || scheduler.renderCount(&view2) < 1 ||
+      scheduler.isRenderPending(&view1))
+    {
+    std::cerr << "The frame failed to be rendered: "
+              << scheduler.renderCount() << " renders" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  view1.setRenderScheduler(0);
+  if (scheduler.views().count() != 1)
+    {
+    std::cerr << "qMRMLThreeDView::setRenderScheduler(0) failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (argc < 2 || QString(argv[1]) != "-I" )
+    {
+    QTimer::singleShot(200, &app, SLOT(quit()));
+    }
+  return app.exec();
+}
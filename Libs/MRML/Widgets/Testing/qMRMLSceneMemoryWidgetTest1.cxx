@@ -0,0 +1,72 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// QT includes
+#include <QApplication>
+#include <QTimer>
+
+// qMRML includes
+#include "qMRMLSceneMemoryWidget.h"
+
+// MRML includes
+#include <vtkMRMLScalarVolumeNode.h>
+#include <vtkMRMLScene.h>
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkSmartPointer.h>
+
+// STD includes
+#include <iostream>
+
+int qMRMLSceneMemoryWidgetTest1(int argc, char * argv [] )
+{
+  QApplication app(argc, argv);
+
+  vtkSmartPointer<vtkMRMLScene> scene = vtkSmartPointer<vtkMRMLScene>::New();
+
+  vtkSmartPointer<vtkImageData> imageData = vtkSmartPointer<vtkImageData>::New();
+  imageData->SetDimensions(64, 64, 64);
+  imageData->SetScalarTypeToShort();
+  imageData->AllocateScalars();
+
+  vtkSmartPointer<vtkMRMLScalarVolumeNode> volumeNode =
+    vtkSmartPointer<vtkMRMLScalarVolumeNode>::New();
+  volumeNode->SetAndObserveImageData(imageData);
+  scene->AddNode(volumeNode);
+
+  qMRMLSceneMemoryWidget memoryWidget;
+  memoryWidget.setMRMLScene(scene);
+  if (memoryWidget.sliceLogics() != 0)
+    {
+    std::cerr << "qMRMLSceneMemoryWidget::sliceLogics() failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (qMRMLSceneMemoryWidget::sizeToString(512) != "512 KB" ||
+      qMRMLSceneMemoryWidget::sizeToString(1536) != "1.5 MB")
+    {
+    std::cerr << "qMRMLSceneMemoryWidget::sizeToString() failed: "
+              << qPrintable(qMRMLSceneMemoryWidget::sizeToString(1536))
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+  memoryWidget.show();
+
+  if (argc < 2 || QString(argv[1]) != "-I" )
+    {
+    QTimer::singleShot(200, &app, SLOT(quit()));
+    }
+  return app.exec();
+}
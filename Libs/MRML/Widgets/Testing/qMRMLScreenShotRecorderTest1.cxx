@@ -0,0 +1,104 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Copyright (c) Kitware Inc.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  This file was originally developed by Jean-Christophe Fillion-Robin, Kitware Inc.
+  and was partially funded by NIH grant 3P41RR013218-12S1
+==============================================================================*/
+
+// Qt includes
+#include <QApplication>
+#include <QDir>
+#include <QFile>
+#include <QImage>
+
+// qMRML includes
+#include "qMRMLScreenShotRecorder.h"
+#include "qMRMLThreeDView.h"
+
+// STD includes
+#include <iostream>
+
+int qMRMLScreenShotRecorderTest1(int argc, char * argv [] )
+{
+  QApplication app(argc, argv);
+
+  qMRMLScreenShotRecorder recorder;
+  recorder.setFilePattern(
+    QDir::temp().filePath("qMRMLScreenShotRecorderTest1_%1.png"));
+  recorder.setMaximumPendingFrames(2);
+  recorder.setScaleFactor(0.5);
+
+  QImage image(64, 32, QImage::Format_RGB32);
+  image.fill(0xff0000);
+  const int frames = 20;
+  for (int i = 0; i < frames; ++i)
+    {
+    recorder.addFrame(image);
+    if (recorder.pendingFrameCount() > 2)
+      {
+      std::cerr << "qMRMLScreenShotRecorder::addFrame failed: "
+                << recorder.pendingFrameCount() << " pending frames"
+                << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  if (recorder.frameCount() != frames)
+    {
+    std::cerr << "Wrong frame count: " << recorder.frameCount() << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (!recorder.finish() ||
+      recorder.pendingFrameCount() != 0 ||
+      recorder.frameCount() != 0)
+    {
+    std::cerr << "qMRMLScreenShotRecorder::finish failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  for (int i = 0; i < frames; ++i)
+    {
+    QString fileName = recorder.frameFileName(i);
+    QImage frame(fileName);
+    if (frame.size() != QSize(32, 16) || frame.pixel(0, 0) != image.pixel(0, 0))
+      {
+      std::cerr << "Frame " << i << " failed to be written: "
+                << qPrintable(fileName) << std::endl;
+      return EXIT_FAILURE;
+      }
+    QFile::remove(fileName);
+    }
+
+  // Frames read back from a view
+  qMRMLThreeDView view;
+  view.show();
+  recorder.setWidget(&view);
+  recorder.setScaleFactor(1.);
+  recorder.captureFrame();
+  recorder.captureFrame();
+  if (recorder.frameCount() != 2 || !recorder.finish())
+    {
+    std::cerr << "qMRMLScreenShotRecorder::captureFrame failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (!QFile::exists(recorder.frameFileName(1)))
+    {
+    std::cerr << "View frame failed to be written" << std::endl;
+    return EXIT_FAILURE;
+    }
+  QFile::remove(recorder.frameFileName(0));
+  QFile::remove(recorder.frameFileName(1));
+
+  return EXIT_SUCCESS;
+}
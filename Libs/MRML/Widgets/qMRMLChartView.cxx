@@ -91,6 +91,7 @@ qMRMLChartViewPrivate::qMRMLChartViewPrivate(qMRMLChartView& object)
   this->ColorLogic = 0;
   this->PinButton = 0;
   this->PopupWidget = 0;
+  this->DecimationColumns = 0;
 }
 
 //---------------------------------------------------------------------------
@@ -108,6 +109,10 @@ void qMRMLChartViewPrivate::init()
 
   // Expose the ChartView class to Javascript
   q->page()->mainFrame()->addToJavaScriptWindowObject(QString("qtobject"), this);
+  // and expose it again before the scripts of each new page run, as
+  // they fetch the chart data from it
+  QObject::connect(q->page()->mainFrame(), SIGNAL(javaScriptWindowObjectCleared()),
+                   this, SLOT(onJavaScriptWindowObjectCleared()));
 
   this->PopupWidget = new ctkPopupWidget;
   QHBoxLayout* popupLayout = new QHBoxLayout;
@@ -180,6 +185,64 @@ void qMRMLChartViewPrivate::onChartNodeChanged()
   this->MRMLChartNode = newChartNode;
 }
 
+// --------------------------------------------------------------------------
+void qMRMLChartViewPrivate::observeArrays(vtkMRMLChartNode* cn)
+{
+  foreach(vtkMRMLDoubleArrayNode* arrayNode, this->ObservedArrayNodes)
+    {
+    this->qvtkDisconnect(arrayNode, vtkCommand::ModifiedEvent,
+                         this, SLOT(onArrayModified(vtkObject*)));
+    }
+  this->ObservedArrayNodes.clear();
+
+  vtkStringArray *arrayIDs = cn ? cn->GetArrays() : 0;
+  for (int idx = 0; arrayIDs && idx < arrayIDs->GetNumberOfValues(); idx++)
+    {
+    vtkMRMLDoubleArrayNode *dn = vtkMRMLDoubleArrayNode::SafeDownCast(
+      this->MRMLScene->GetNodeByID(arrayIDs->GetValue(idx).c_str()));
+    if (!dn || this->ObservedArrayNodes.contains(dn))
+      {
+      continue;
+      }
+    this->qvtkConnect(dn, vtkCommand::ModifiedEvent,
+                      this, SLOT(onArrayModified(vtkObject*)));
+    this->ObservedArrayNodes << dn;
+    }
+}
+
+// --------------------------------------------------------------------------
+void qMRMLChartViewPrivate::onArrayModified(vtkObject* caller)
+{
+  Q_Q(qMRMLChartView);
+  vtkMRMLDoubleArrayNode* dn = vtkMRMLDoubleArrayNode::SafeDownCast(caller);
+  if (!dn || !dn->GetID() || !q->isEnabled())
+    {
+    return;
+    }
+
+  bool updated = false;
+  for (int series = 0; series < this->PlottedArrayIDs.size(); ++series)
+    {
+    if (this->PlottedArrayIDs[series] == dn->GetID())
+      {
+      q->page()->mainFrame()->evaluateJavaScript(
+        QString("try { updateSeries(%1); } catch(error) {}").arg(series));
+      updated = true;
+      }
+    }
+  if (!updated)
+    {
+    this->updateWidgetFromMRML();
+    }
+}
+
+// --------------------------------------------------------------------------
+void qMRMLChartViewPrivate::onJavaScriptWindowObjectCleared()
+{
+  Q_Q(qMRMLChartView);
+  q->page()->mainFrame()->addToJavaScriptWindowObject(QString("qtobject"), this);
+}
+
 // --------------------------------------------------------------------------
 void qMRMLChartViewPrivate::updateWidgetFromMRML()
 {
@@ -199,8 +262,13 @@ void qMRMLChartViewPrivate::updateWidgetFromMRML()
   // Get the ChartNode
   char *chartnodeid = this->MRMLChartViewNode->GetChartNodeID();
 
+  this->PlottedArrayIDs.clear();
+  this->SeriesPointIndices.clear();
+  this->DecimationColumns = 0;
+
   if (!chartnodeid)
     {
+    this->observeArrays(0);
     q->setHtml("");
     q->show();
     return;
@@ -208,6 +276,8 @@ void qMRMLChartViewPrivate::updateWidgetFromMRML()
 
   vtkMRMLChartNode* cn = vtkMRMLChartNode::SafeDownCast(this->MRMLScene->GetNodeByID(chartnodeid));
 
+  this->observeArrays(cn);
+
   if (!cn)
     {
     q->setHtml("");
@@ -228,6 +298,14 @@ void qMRMLChartViewPrivate::updateWidgetFromMRML()
   if (!type || (type && !strcmp(type, "Line")))
     {
     // line charts are the default
+    // Decimate the large series of quantitative axes to the width of
+    // the view (with some margin for later resizes), a line chart
+    // cannot show more than a few points per pixel column anyway.
+    const char *xAxisType = cn->GetProperty("default", "xAxisType");
+    if (!xAxisType || strcmp(xAxisType, "categorical"))
+      {
+      this->DecimationColumns = qMax(q->width(), 512);
+      }
     plotData << this->lineData(cn);
     plotXAxisTicks << this->lineXAxisTicks(cn);
     plotOptions << this->lineOptions(cn);
@@ -275,6 +353,18 @@ void qMRMLChartViewPrivate::updateWidgetFromMRML()
   plotResizeHook <<
     "$(window).resize( resizeSlot );";
 
+  // update slot - represented in javascript
+  // refetch the data of a series from Qt and replot
+  QStringList plotUpdateSeriesSlot;
+  if (!this->PlottedArrayIDs.isEmpty())
+    {
+    plotUpdateSeriesSlot <<
+      "window.updateSeries = function(seriesIndex) {"
+      "data[seriesIndex] = qtobject.seriesData(seriesIndex);"
+      "plot1.replot({data: data, resetAxes: true});"
+      "};";
+    }
+
   // data mouse over slot - represented in javascript
   QStringList plotDataMouseOverSlot;
   plotDataMouseOverSlot <<
@@ -327,6 +417,7 @@ void qMRMLChartViewPrivate::updateWidgetFromMRML()
   plot << plotResizeSlot;        // insert definition of the resizeSlot
   plot << plotInitialResize;     // insert an initial call to resizeSlot 
   plot << plotResizeHook;        // insert hook to call resizeSlot on page resize
+  plot << plotUpdateSeriesSlot;  // insert definition of the updateSeries slot
   plot << plotDataMouseOverSlot; // insert definition of the data mouse over slot
   plot << plotDataMouseOverHook; // insert the binding to the slot
   plot << plotDataPointClickedSlot; // insert definition of the data clicked slot
@@ -548,6 +639,130 @@ QString qMRMLChartViewPrivate::seriesDataString(vtkMRMLDoubleArrayNode *dn)
   return data.join("");
 }
 
+//---------------------------------------------------------------------------
+QVector<int> qMRMLChartViewPrivate::decimatedPointIndices(vtkMRMLDoubleArrayNode *dn, int columns)
+{
+  QVector<int> indices;
+  int size = dn ? static_cast<int>(dn->GetSize()) : 0;
+  if (size <= 0 || columns <= 0)
+    {
+    return indices;
+    }
+
+  double x, y;
+  double xRange[2];
+  dn->GetXYValue(0, &xRange[0], &y);
+  xRange[1] = xRange[0];
+  for (int j = 1; j < size; ++j)
+    {
+    dn->GetXYValue(j, &x, &y);
+    xRange[0] = qMin(xRange[0], x);
+    xRange[1] = qMax(xRange[1], x);
+    }
+  double scale = (xRange[1] > xRange[0]) ? columns / (xRange[1] - xRange[0]) : 0.;
+
+  // current run of points in the same pixel column
+  int runStart = 0;
+  int runColumn = 0;
+  int runMin = 0, runMax = 0;
+  double runMinY = 0., runMaxY = 0.;
+  for (int j = 0; j <= size; ++j)
+    {
+    int column = 0;
+    if (j < size)
+      {
+      dn->GetXYValue(j, &x, &y);
+      column = static_cast<int>((x - xRange[0]) * scale);
+      }
+    if (j > 0 && (j == size || column != runColumn))
+      {
+      // keep the extreme points of the run, in the order of the array
+      int run[4] = {runStart, runMin, runMax, j - 1};
+      std::sort(run, run + 4);
+      for (int k = 0; k < 4; ++k)
+        {
+        if (indices.isEmpty() || indices.last() != run[k])
+          {
+          indices << run[k];
+          }
+        }
+      }
+    if (j == size)
+      {
+      break;
+      }
+    if (j == 0 || column != runColumn)
+      {
+      runStart = runMin = runMax = j;
+      runColumn = column;
+      runMinY = runMaxY = y;
+      }
+    else if (y < runMinY)
+      {
+      runMin = j;
+      runMinY = y;
+      }
+    else if (y > runMaxY)
+      {
+      runMax = j;
+      runMaxY = y;
+      }
+    }
+  return indices;
+}
+
+//---------------------------------------------------------------------------
+QVariantList qMRMLChartViewPrivate::seriesData(int series)
+{
+  QVariantList data;
+  if (!this->MRMLScene || series < 0 || series >= this->PlottedArrayIDs.size())
+    {
+    return data;
+    }
+  QVector<int>& indices = this->SeriesPointIndices[series];
+  indices.clear();
+
+  vtkMRMLDoubleArrayNode *dn = vtkMRMLDoubleArrayNode::SafeDownCast(
+    this->MRMLScene->GetNodeByID(this->PlottedArrayIDs[series].toLatin1().constData()));
+  if (!dn)
+    {
+    return data;
+    }
+
+  int size = static_cast<int>(dn->GetSize());
+  // decimating only pays off when it removes most of the points
+  if (this->DecimationColumns > 0 && size > 4 * this->DecimationColumns)
+    {
+    indices = this->decimatedPointIndices(dn, this->DecimationColumns);
+    size = indices.size();
+    }
+
+  double x, y;
+  for (int j = 0; j < size; ++j)
+    {
+    dn->GetXYValue(indices.isEmpty() ? j : indices[j], &x, &y);
+    QVariantList point;
+    point << x << y;
+    data << QVariant(point);
+    }
+  return data;
+}
+
+//---------------------------------------------------------------------------
+int qMRMLChartViewPrivate::seriesPointIndex(int series, int pointidx)const
+{
+  if (series < 0 || series >= this->SeriesPointIndices.size())
+    {
+    return pointidx;
+    }
+  const QVector<int>& indices = this->SeriesPointIndices[series];
+  if (pointidx < 0 || pointidx >= indices.size())
+    {
+    return pointidx;
+    }
+  return indices[pointidx];
+}
+
 //---------------------------------------------------------------------------
 QString qMRMLChartViewPrivate::seriesLabelDataString(vtkMRMLDoubleArrayNode *dn, vtkMRMLColorNode *cn)
 {
@@ -631,8 +846,12 @@ QString qMRMLChartViewPrivate::lineData(vtkMRMLChartNode *cn)
         }
       else
         {
-        // convert the data array into a string of quantitative values
-        data << this->seriesDataString(dn);
+        // the quantitative values are not written in the page but
+        // fetched from seriesData() when the chart is created, which
+        // avoids formatting and parsing large arrays as text
+        data << "qtobject.seriesData(" << QString::number(this->PlottedArrayIDs.size()) << ")";
+        this->PlottedArrayIDs << dn->GetID();
+        this->SeriesPointIndices << QVector<int>();
         }
 
       if (idx < arrayIDs->GetNumberOfValues()-1)
@@ -659,10 +878,11 @@ QString qMRMLChartViewPrivate::lineXAxisTicks(vtkMRMLChartNode *cn)
     {
     // no axis ticks by default
     }
-  else if (!xAxisType || (xAxisType && !strcmp(xAxisType, "categorical")))
+  else if (xAxisType && !strcmp(xAxisType, "categorical"))
     {
     // without any other information, all we can do it use the x-data
-    // as categories
+    // as categories. Quantitative axes (no xAxisType) do not use the
+    // ticks, which would be as large as the first curve.
 
     // define the ticks from the first curve (could do better)
     vtkMRMLDoubleArrayNode *dn = vtkMRMLDoubleArrayNode::SafeDownCast(
@@ -1588,6 +1808,18 @@ void qMRMLChartViewPrivate::onDataMouseOver(int series, int pointidx, double x,
     return;
     }
 
+  // Series fetched through seriesData() may be decimated, report the
+  // index of the point in the array
+  if (!this->PlottedArrayIDs.isEmpty())
+    {
+    if (series >= 0 && series < this->PlottedArrayIDs.size())
+      {
+      emit q->dataMouseOver(this->PlottedArrayIDs[series].toLatin1().constData(),
+                 this->seriesPointIndex(series, pointidx), x, y);
+      }
+    return;
+    }
+
   // Get the array ids
   vtkStringArray *arrayIDs = cn->GetArrays();
 
@@ -1633,6 +1865,18 @@ void qMRMLChartViewPrivate::onDataPointClicked(int series, int pointidx, double
     return;
     }
 
+  // Series fetched through seriesData() may be decimated, report the
+  // index of the point in the array
+  if (!this->PlottedArrayIDs.isEmpty())
+    {
+    if (series >= 0 && series < this->PlottedArrayIDs.size())
+      {
+      emit q->dataPointClicked(this->PlottedArrayIDs[series].toLatin1().constData(),
+                 this->seriesPointIndex(series, pointidx), x, y);
+      }
+    return;
+    }
+
   // Get the array ids
   vtkStringArray *arrayIDs = cn->GetArrays();
 
@@ -2,6 +2,10 @@
 #define __qMRMLChartView_p_h
 
 // Qt includes
+#include <QList>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
 class QToolButton;
 
 // VTK includes
@@ -56,6 +60,19 @@ public slots:
   // slot when a data point is clicked
   void onDataPointClicked(int series, int pointidx, double x, double y);
 
+  // slot when an array plotted by the chart is modified. The series of
+  // the array is updated in place when the chart fetches its data
+  // through seriesData(), otherwise the whole chart is regenerated.
+  void onArrayModified(vtkObject* caller);
+
+  // slot when the page is reset, exposes this object to the Javascript
+  void onJavaScriptWindowObjectCleared();
+
+  // Called from the Javascript to get the [x, y] points of a series of
+  // a line or scatter chart. Large series of line charts are decimated
+  // to the points that are visible at the width of the view.
+  Q_INVOKABLE QVariantList seriesData(int series);
+
 
 protected:
 
@@ -76,6 +93,19 @@ protected:
   // for a series.
   QString seriesDataString(vtkMRMLDoubleArrayNode*);
 
+  // Indices of the points of a data array to plot over a given number
+  // of pixel columns. For each run of consecutive points falling in
+  // the same column, only the first, last, lowest and highest points
+  // are kept, which draws the same line as the full array.
+  QVector<int> decimatedPointIndices(vtkMRMLDoubleArrayNode*, int columns);
+
+  // Index in the data array of a point of a series plotted by the chart
+  int seriesPointIndex(int series, int pointidx)const;
+
+  // Observe the arrays of a chart node so that the chart follows
+  // their modifications
+  void observeArrays(vtkMRMLChartNode*);
+
   // Convert a data array into a string that can be passed as the data
   // for a series. This version will use values in the ArrayNode to
   // lookup names in a ColorNode.
@@ -169,6 +199,17 @@ protected:
   vtkMRMLChartNode*                  MRMLChartNode;
 
   vtkWeakPointer<vtkMRMLColorLogic>  ColorLogic;
+
+  QList<vtkWeakPointer<vtkMRMLDoubleArrayNode> > ObservedArrayNodes;
+
+  // IDs of the arrays whose series are fetched through seriesData(),
+  // empty when the chart data is written in the page
+  QStringList                        PlottedArrayIDs;
+  // Indices of the plotted points of the decimated series
+  QList<QVector<int> >               SeriesPointIndices;
+  // Number of pixel columns series are decimated to, 0 to plot all the
+  // points
+  int                                DecimationColumns;
   
   QToolButton*                       PinButton;
   ctkPopupWidget*                    PopupWidget;
@@ -101,6 +101,9 @@ void qMRMLClipNodeWidgetPrivate::init()
   QObject::connect(this->GreenNegativeRadioButton, SIGNAL(toggled(bool)),
                    q, SLOT(updateNodeGreenClipState()));
 
+  QObject::connect(this->ClipFragmentsCheckBox, SIGNAL(toggled(bool)),
+                   q, SLOT(updateNodeClipMethod()));
+
 
   q->setEnabled(this->MRMLClipNode.GetPointer() != 0);
 }
@@ -228,6 +231,26 @@ int qMRMLClipNodeWidget::greenSliceClipState()const
     vtkMRMLClipModelsNode::ClipOff;
 }
 
+//------------------------------------------------------------------------------
+void qMRMLClipNodeWidget::setClipMethod(int method)
+{
+  Q_D(qMRMLClipNodeWidget);
+  if (!d->MRMLClipNode.GetPointer())
+    {
+    return;
+    }
+  d->MRMLClipNode->SetClipMethod(method);
+}
+
+//------------------------------------------------------------------------------
+int qMRMLClipNodeWidget::clipMethod()const
+{
+  Q_D(const qMRMLClipNodeWidget);
+  return d->ClipFragmentsCheckBox->isChecked() ?
+    vtkMRMLClipModelsNode::ClipFragments :
+    vtkMRMLClipModelsNode::ClipGeometry;
+}
+
 //------------------------------------------------------------------------------
 void qMRMLClipNodeWidget::updateWidgetFromMRML()
 {
@@ -268,6 +291,9 @@ void qMRMLClipNodeWidget::updateWidgetFromMRML()
   d->GreenNegativeRadioButton->setChecked(
     d->MRMLClipNode->GetGreenSliceClipState() == vtkMRMLClipModelsNode::ClipNegativeSpace);
 
+  d->ClipFragmentsCheckBox->setChecked(
+    d->MRMLClipNode->GetClipMethod() == vtkMRMLClipModelsNode::ClipFragments);
+
   d->IsUpdatingWidgetFromMRML = oldUpdating;
 }
 
@@ -309,3 +335,14 @@ void qMRMLClipNodeWidget::updateNodeGreenClipState()
     }
   this->setGreenSliceClipState(this->greenSliceClipState());
 }
+
+//------------------------------------------------------------------------------
+void qMRMLClipNodeWidget::updateNodeClipMethod()
+{
+  Q_D(const qMRMLClipNodeWidget);
+  if (d->IsUpdatingWidgetFromMRML)
+    {
+    return;
+    }
+  this->setClipMethod(this->clipMethod());
+}
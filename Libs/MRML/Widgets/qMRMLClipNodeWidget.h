@@ -48,11 +48,13 @@ public:
   int redSliceClipState()const;
   int yellowSliceClipState()const;
   int greenSliceClipState()const;
+  int clipMethod()const;
 
   void setClipType(int);
   void setRedSliceClipState(int);
   void setYellowSliceClipState(int);
   void setGreenSliceClipState(int);
+  void setClipMethod(int);
 
 public slots:
   /// Set the clip node to represent
@@ -67,6 +69,7 @@ protected slots:
   void updateNodeRedClipState();
   void updateNodeYellowClipState();
   void updateNodeGreenClipState();
+  void updateNodeClipMethod();
 
 protected:
   QScopedPointer<qMRMLClipNodeWidgetPrivate> d_ptr;
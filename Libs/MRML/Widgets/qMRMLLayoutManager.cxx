@@ -21,9 +21,12 @@
 // Qt includes
 #include <QButtonGroup>
 #include <QDebug>
+#include <QLayout>
 
 // MRMLWidgets includes
 #include "qMRMLLayoutManager_p.h"
+#include <qMRMLRenderScheduler.h>
+#include <qMRMLSliceView.h>
 #include <qMRMLSliceWidget.h>
 #include <qMRMLSliceControllerWidget.h>
 #include <qMRMLChartView.h>
@@ -59,6 +62,7 @@ qMRMLLayoutManagerPrivate::qMRMLLayoutManagerPrivate(qMRMLLayoutManager& object)
   this->MRMLSliceLogics = vtkCollection::New();
   this->MRMLColorLogic = 0;
   this->SliceControllerButtonGroup = 0;
+  this->RenderScheduler = 0;
   //this->SavedCurrentViewArrangement = vtkMRMLLayoutNode::SlicerLayoutNone;
 }
 
@@ -80,6 +84,7 @@ void qMRMLLayoutManagerPrivate::init()
   Q_Q(qMRMLLayoutManager);
   this->SliceControllerButtonGroup = new QButtonGroup(q);
   this->SliceControllerButtonGroup->setExclusive(false);
+  this->RenderScheduler = new qMRMLRenderScheduler(q);
   q->setSpacing(1);
 }
 
@@ -254,8 +259,12 @@ QWidget* qMRMLLayoutManagerPrivate::createSliceWidget(vtkMRMLSliceNode* sliceNod
   // there is a unique slice widget per node
   Q_ASSERT(!this->sliceWidget(sliceNode));
 
-  qMRMLSliceWidget * sliceWidget = new qMRMLSliceWidget(q->viewport());
-  sliceWidget->sliceController()->setControllerButtonGroup(this->SliceControllerButtonGroup);
+  qMRMLSliceWidget * sliceWidget = this->takePooledSliceWidget(sliceNode);
+  if (!sliceWidget)
+    {
+    sliceWidget = new qMRMLSliceWidget(q->viewport());
+    sliceWidget->sliceController()->setControllerButtonGroup(this->SliceControllerButtonGroup);
+    }
   QString sliceLayoutName(sliceNode->GetLayoutName());
   QString sliceViewLabel(sliceNode->GetLayoutLabel());
   QColor sliceLayoutColor = QColor::fromRgbF(sliceNode->GetLayoutColor()[0],
@@ -268,6 +277,8 @@ QWidget* qMRMLLayoutManagerPrivate::createSliceWidget(vtkMRMLSliceNode* sliceNod
   sliceWidget->setMRMLScene(this->MRMLScene);
   sliceWidget->setMRMLSliceNode(sliceNode);
   sliceWidget->setSliceLogics(this->MRMLSliceLogics);
+  const_cast<qMRMLSliceView*>(sliceWidget->sliceView())
+    ->setRenderScheduler(this->RenderScheduler);
 
   this->SliceWidgetList.push_back(sliceWidget);
   this->MRMLSliceLogics->AddItem(sliceWidget->sliceLogic());
@@ -293,11 +304,16 @@ qMRMLThreeDWidget* qMRMLLayoutManagerPrivate::createThreeDWidget(vtkMRMLViewNode
   // There must be a unique ThreeDWidget per node
   Q_ASSERT(!this->threeDWidget(viewNode));
 
-  qMRMLThreeDWidget* threeDWidget = new qMRMLThreeDWidget(q->viewport());
+  qMRMLThreeDWidget* threeDWidget = this->takePooledThreeDWidget(viewNode);
+  if (!threeDWidget)
+    {
+    threeDWidget = new qMRMLThreeDWidget(q->viewport());
+    }
   threeDWidget->setObjectName(QString("ThreeDWidget%1").arg(viewNode->GetLayoutLabel()));
   threeDWidget->setViewLabel(viewNode->GetLayoutLabel());
   threeDWidget->setMRMLScene(this->MRMLScene);
   threeDWidget->setMRMLViewNode(viewNode);
+  threeDWidget->threeDView()->setRenderScheduler(this->RenderScheduler);
 
   this->ThreeDWidgetList.push_back(threeDWidget);
   //qDebug() << "qMRMLLayoutManagerPrivate::createThreeDWidget - Instantiated qMRMLThreeDWidget";
@@ -342,9 +358,12 @@ void qMRMLLayoutManagerPrivate::removeSliceView(vtkMRMLSliceNode* sliceNode)
   qMRMLSliceWidget * sliceWidgetToDelete = this->sliceWidget(sliceNode);
   Q_ASSERT(sliceWidgetToDelete);
 
-  // Remove slice widget
+  // Remove slice widget, it is kept for a slice node with the same name
   this->SliceWidgetList.removeAll(sliceWidgetToDelete);
-  delete sliceWidgetToDelete;
+  this->MRMLSliceLogics->RemoveItem(sliceWidgetToDelete->sliceLogic());
+  sliceWidgetToDelete->setMRMLSliceNode(0);
+  this->poolWidget(sliceWidgetToDelete);
+  this->SliceWidgetPool.append(sliceWidgetToDelete);
 }
 
 // --------------------------------------------------------------------------
@@ -353,12 +372,64 @@ void qMRMLLayoutManagerPrivate::removeThreeDWidget(vtkMRMLViewNode* viewNode)
   Q_ASSERT(viewNode);
   qMRMLThreeDWidget * threeDWidgetToDelete = this->threeDWidget(viewNode);
 
-  // Remove threeDView
+  // Remove threeDView, it is kept for a view node with the same label
   if (threeDWidgetToDelete)
     {
     this->ThreeDWidgetList.removeAll(threeDWidgetToDelete);
-    delete threeDWidgetToDelete;
+    threeDWidgetToDelete->setMRMLViewNode(0);
+    this->poolWidget(threeDWidgetToDelete);
+    this->ThreeDWidgetPool.append(threeDWidgetToDelete);
+    }
+}
+
+// --------------------------------------------------------------------------
+qMRMLSliceWidget* qMRMLLayoutManagerPrivate::takePooledSliceWidget(vtkMRMLSliceNode* sliceNode)
+{
+  foreach(qMRMLSliceWidget* sliceWidget, this->SliceWidgetPool)
+    {
+    if (sliceWidget->sliceViewName() == QString(sliceNode->GetLayoutName()))
+      {
+      this->SliceWidgetPool.removeOne(sliceWidget);
+      return sliceWidget;
+      }
     }
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+qMRMLThreeDWidget* qMRMLLayoutManagerPrivate::takePooledThreeDWidget(vtkMRMLViewNode* viewNode)
+{
+  foreach(qMRMLThreeDWidget* threeDWidget, this->ThreeDWidgetPool)
+    {
+    if (threeDWidget->viewLabel() == QString(viewNode->GetLayoutLabel()))
+      {
+      this->ThreeDWidgetPool.removeOne(threeDWidget);
+      return threeDWidget;
+      }
+    }
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+void qMRMLLayoutManagerPrivate::poolWidget(QWidget* widget)
+{
+  Q_Q(qMRMLLayoutManager);
+  QWidget* container = widget->parentWidget();
+  if (container && container->layout())
+    {
+    container->layout()->removeWidget(widget);
+    }
+  // setParent() hides the widget
+  widget->setParent(q->viewport());
+}
+
+// --------------------------------------------------------------------------
+void qMRMLLayoutManagerPrivate::clearWidgetPools()
+{
+  qDeleteAll(this->SliceWidgetPool);
+  this->SliceWidgetPool.clear();
+  qDeleteAll(this->ThreeDWidgetPool);
+  this->ThreeDWidgetPool.clear();
 }
 
 // --------------------------------------------------------------------------
@@ -630,12 +701,22 @@ void qMRMLLayoutManagerPrivate::updateLayoutInternal()
     return;
     }
 
-  // TBD: modify the dom doc manually, don't create a new one
-  QDomDocument newLayout;
-  newLayout.setContent(QString(
-    this->MRMLLayoutNode ?
-    this->MRMLLayoutNode->GetCurrentLayoutDescription() : ""));
-  q->setLayout(newLayout);
+  // The documents are shared with ctkLayoutManager, which only reads them.
+  QString description(this->MRMLLayoutNode ?
+    this->MRMLLayoutNode->GetCurrentLayoutDescription() : "");
+  if (!this->LayoutDocuments.contains(description))
+    {
+    // The compare layouts are generated for each number of views, don't
+    // let them accumulate.
+    if (this->LayoutDocuments.count() >= 32)
+      {
+      this->LayoutDocuments.clear();
+      }
+    QDomDocument newLayout;
+    newLayout.setContent(description);
+    this->LayoutDocuments.insert(description, newLayout);
+    }
+  q->setLayout(this->LayoutDocuments.value(description));
 
   emit q->layoutChanged(layout);
 }
@@ -850,6 +931,13 @@ vtkMRMLLayoutLogic* qMRMLLayoutManager::layoutLogic()const
   return d->MRMLLayoutLogic;
 }
 
+//------------------------------------------------------------------------------
+qMRMLRenderScheduler* qMRMLLayoutManager::renderScheduler()const
+{
+  Q_D(const qMRMLLayoutManager);
+  return d->RenderScheduler;
+}
+
 //------------------------------------------------------------------------------
 void qMRMLLayoutManager::setMRMLScene(vtkMRMLScene* scene)
 {
@@ -862,6 +950,8 @@ void qMRMLLayoutManager::setMRMLScene(vtkMRMLScene* scene)
   vtkMRMLScene* oldScene = d->MRMLScene;
   d->MRMLScene = scene;
   d->MRMLLayoutNode = 0;
+  // The pooled widgets still reference the old scene
+  d->clearWidgetPools();
 
   d->qvtkReconnect(oldScene, scene, vtkMRMLScene::EndBatchProcessEvent,
                    d, SLOT(updateWidgetsFromViewNodes()));
@@ -31,6 +31,7 @@
 #include "qMRMLWidgetsExport.h"
 
 class qMRMLChartWidget;
+class qMRMLRenderScheduler;
 class qMRMLThreeDWidget;
 class qMRMLSliceWidget;
 class qMRMLLayoutManagerPrivate;
@@ -104,6 +105,11 @@ public:
   Q_INVOKABLE vtkRenderer* activeChartRenderer()const;
 
   Q_INVOKABLE vtkMRMLLayoutLogic* layoutLogic()const;
+
+  /// Coalesce the render requests of the slice and 3D views into frames.
+  /// The maximum frame rate and the render statistics are set and read on
+  /// the scheduler.
+  Q_INVOKABLE qMRMLRenderScheduler* renderScheduler()const;
 public slots:
 
   /// Set the MRML \a scene that should be listened for events
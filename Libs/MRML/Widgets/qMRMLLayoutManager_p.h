@@ -22,6 +22,7 @@
 #define __qMRMLLayoutManager_p_h
 
 /// Qt includes
+#include <QDomDocument>
 #include <QHash>
 #include <QObject>
 
@@ -44,6 +45,7 @@ class QButtonGroup;
 class qMRMLSliceWidget;
 class qMRMLChartView;
 class qMRMLChartWidget;
+class qMRMLRenderScheduler;
 class qMRMLThreeDView;
 class qMRMLThreeDWidget;
 class vtkCollection;
@@ -87,6 +89,15 @@ public:
 
   /// Delete 3D Viewer associated with \a viewNode
   void removeThreeDWidget(vtkMRMLViewNode* viewNode);
+
+  /// Take the pooled widget of a removed view node with the same layout
+  /// name as \a sliceNode (label as \a viewNode), 0 if there is none.
+  qMRMLSliceWidget* takePooledSliceWidget(vtkMRMLSliceNode* sliceNode);
+  qMRMLThreeDWidget* takePooledThreeDWidget(vtkMRMLViewNode* viewNode);
+  /// Move \a widget out of the layout into its pool
+  void poolWidget(QWidget* widget);
+  /// Delete the pooled widgets
+  void clearWidgetPools();
   void removeChartWidget(vtkMRMLChartViewNode* viewNode);
 
   /// Enable/disable paint event associated with the TargetWidget
@@ -142,12 +153,22 @@ public:
   QGridLayout*            GridLayout;
   QWidget*                TargetWidget;
   QButtonGroup*           SliceControllerButtonGroup;
+  qMRMLRenderScheduler*   RenderScheduler;
   vtkCollection*          MRMLSliceLogics;
   vtkMRMLColorLogic*      MRMLColorLogic;
 
   QList<qMRMLThreeDWidget*>         ThreeDWidgetList;
   QList<qMRMLChartWidget*>          ChartWidgetList;
   QList<qMRMLSliceWidget*>          SliceWidgetList;
+
+  /// Widgets of the removed view nodes. They are reused with their render
+  /// window and displayable managers when a view node with the same layout
+  /// name is added back (e.g. scene view restore, compare views).
+  QList<qMRMLThreeDWidget*>         ThreeDWidgetPool;
+  QList<qMRMLSliceWidget*>          SliceWidgetPool;
+
+  /// Parsed layout descriptions
+  QHash<QString, QDomDocument>      LayoutDocuments;
 protected:
   void showWidget(QWidget* widget);
 };
@@ -21,6 +21,7 @@
 // Qt includes
 #include <QApplication>
 #include <QDebug>
+#include <QHash>
 #include <QHBoxLayout>
 #include <QInputDialog>
 #include <QKeyEvent>
@@ -40,6 +41,533 @@
 #include <vtkMRMLNode.h>
 #include <vtkMRMLScene.h>
 
+// --------------------------------------------------------------------------
+// qMRMLNodeComboBoxExtraItemsModel
+
+// --------------------------------------------------------------------------
+qMRMLNodeComboBoxExtraItemsModel::qMRMLNodeComboBoxExtraItemsModel(QObject* parentObject)
+  : Superclass(parentObject)
+{
+}
+
+// --------------------------------------------------------------------------
+void qMRMLNodeComboBoxExtraItemsModel::setSourceModel(QAbstractItemModel* newSourceModel)
+{
+  if (newSourceModel == this->sourceModel())
+    {
+    return;
+    }
+  this->beginResetModel();
+  if (this->sourceModel())
+    {
+    this->sourceModel()->disconnect(this);
+    }
+  this->Superclass::setSourceModel(newSourceModel);
+  if (newSourceModel)
+    {
+    this->connect(newSourceModel, SIGNAL(rowsAboutToBeInserted(QModelIndex,int,int)),
+                  this, SLOT(onSourceRowsAboutToBeInserted(QModelIndex,int,int)));
+    this->connect(newSourceModel, SIGNAL(rowsInserted(QModelIndex,int,int)),
+                  this, SLOT(onSourceRowsInserted(QModelIndex)));
+    this->connect(newSourceModel, SIGNAL(rowsAboutToBeRemoved(QModelIndex,int,int)),
+                  this, SLOT(onSourceRowsAboutToBeRemoved(QModelIndex,int,int)));
+    this->connect(newSourceModel, SIGNAL(rowsRemoved(QModelIndex,int,int)),
+                  this, SLOT(onSourceRowsRemoved(QModelIndex)));
+    this->connect(newSourceModel, SIGNAL(dataChanged(QModelIndex,QModelIndex)),
+                  this, SLOT(onSourceDataChanged(QModelIndex,QModelIndex)));
+    this->connect(newSourceModel, SIGNAL(headerDataChanged(Qt::Orientation,int,int)),
+                  this, SIGNAL(headerDataChanged(Qt::Orientation,int,int)));
+    this->connect(newSourceModel, SIGNAL(layoutAboutToBeChanged()),
+                  this, SLOT(onSourceLayoutAboutToBeChanged()));
+    this->connect(newSourceModel, SIGNAL(layoutChanged()),
+                  this, SLOT(onSourceLayoutChanged()));
+    // Moved rows are handled as a layout change
+    this->connect(newSourceModel, SIGNAL(rowsAboutToBeMoved(QModelIndex,int,int,QModelIndex,int)),
+                  this, SLOT(onSourceLayoutAboutToBeChanged()));
+    this->connect(newSourceModel, SIGNAL(rowsMoved(QModelIndex,int,int,QModelIndex,int)),
+                  this, SLOT(onSourceLayoutChanged()));
+    this->connect(newSourceModel, SIGNAL(modelAboutToBeReset()),
+                  this, SLOT(onSourceModelAboutToBeReset()));
+    this->connect(newSourceModel, SIGNAL(modelReset()),
+                  this, SLOT(onSourceModelReset()));
+    }
+  this->endResetModel();
+}
+
+// --------------------------------------------------------------------------
+void qMRMLNodeComboBoxExtraItemsModel::setPreItems(const QStringList& extraItems)
+{
+  this->setExtraItems(this->PreItems, 0, extraItems);
+}
+
+// --------------------------------------------------------------------------
+QStringList qMRMLNodeComboBoxExtraItemsModel::preItems()const
+{
+  return this->PreItems;
+}
+
+// --------------------------------------------------------------------------
+void qMRMLNodeComboBoxExtraItemsModel::setPostItems(const QStringList& extraItems)
+{
+  this->setExtraItems(this->PostItems,
+                      this->PreItems.count() + this->sourceNodeCount(), extraItems);
+}
+
+// --------------------------------------------------------------------------
+QStringList qMRMLNodeComboBoxExtraItemsModel::postItems()const
+{
+  return this->PostItems;
+}
+
+// --------------------------------------------------------------------------
+void qMRMLNodeComboBoxExtraItemsModel
+::setExtraItems(QStringList& items, int firstRow, const QStringList& newItems)
+{
+  if (items == newItems)
+    {
+    return;
+    }
+  // Without scene item, there is no row to insert/remove
+  QModelIndex sceneIndex = this->index(0, 0);
+  if (!sceneIndex.isValid())
+    {
+    items = newItems;
+    return;
+    }
+  // Remove then insert the rows, the same way qMRMLSceneModel does.
+  if (!items.isEmpty())
+    {
+    this->beginRemoveRows(sceneIndex, firstRow, firstRow + items.count() - 1);
+    items.clear();
+    this->endRemoveRows();
+    }
+  if (!newItems.isEmpty())
+    {
+    this->beginInsertRows(sceneIndex, firstRow, firstRow + newItems.count() - 1);
+    items = newItems;
+    this->endInsertRows();
+    }
+}
+
+// --------------------------------------------------------------------------
+QModelIndex qMRMLNodeComboBoxExtraItemsModel::sourceSceneIndex()const
+{
+  return this->sourceModel() ? this->sourceModel()->index(0, 0) : QModelIndex();
+}
+
+// --------------------------------------------------------------------------
+int qMRMLNodeComboBoxExtraItemsModel::sourceNodeCount()const
+{
+  QModelIndex sceneIndex = this->sourceSceneIndex();
+  return sceneIndex.isValid() ? this->sourceModel()->rowCount(sceneIndex) : 0;
+}
+
+// --------------------------------------------------------------------------
+int qMRMLNodeComboBoxExtraItemsModel::extraItemType(const QModelIndex& index)const
+{
+  if (!index.isValid() || index.internalId() == 0)
+    {
+    return -1;
+    }
+  if (index.row() < this->PreItems.count())
+    {
+    return 0;
+    }
+  if (index.row() >= this->PreItems.count() + this->sourceNodeCount())
+    {
+    return 1;
+    }
+  return -1;
+}
+
+// --------------------------------------------------------------------------
+QString qMRMLNodeComboBoxExtraItemsModel::extraItem(const QModelIndex& index)const
+{
+  switch (this->extraItemType(index))
+    {
+    case 0:
+      return this->PreItems.value(index.row());
+    case 1:
+      return this->PostItems.value(
+        index.row() - this->PreItems.count() - this->sourceNodeCount());
+    default:
+      break;
+    }
+  return QString();
+}
+
+// --------------------------------------------------------------------------
+QModelIndex qMRMLNodeComboBoxExtraItemsModel
+::index(int row, int column, const QModelIndex& parentIndex)const
+{
+  if (row < 0 || column < 0 ||
+      row >= this->rowCount(parentIndex) ||
+      column >= this->columnCount(parentIndex))
+    {
+    return QModelIndex();
+    }
+  // The internal id tells the top-level rows (0) from the children of the
+  // scene item (1).
+  return this->createIndex(row, column, quint32(parentIndex.isValid() ? 1 : 0));
+}
+
+// --------------------------------------------------------------------------
+QModelIndex qMRMLNodeComboBoxExtraItemsModel::parent(const QModelIndex& child)const
+{
+  if (!child.isValid() || child.internalId() == 0)
+    {
+    return QModelIndex();
+    }
+  return this->createIndex(0, 0, quint32(0));
+}
+
+// --------------------------------------------------------------------------
+int qMRMLNodeComboBoxExtraItemsModel::rowCount(const QModelIndex& parentIndex)const
+{
+  if (!this->sourceModel())
+    {
+    return 0;
+    }
+  if (!parentIndex.isValid())
+    {
+    return this->sourceModel()->rowCount();
+    }
+  if (parentIndex.internalId() == 0 &&
+      parentIndex.row() == 0 && parentIndex.column() == 0)
+    {
+    return this->PreItems.count() + this->sourceNodeCount() + this->PostItems.count();
+    }
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int qMRMLNodeComboBoxExtraItemsModel::columnCount(const QModelIndex& parentIndex)const
+{
+  Q_UNUSED(parentIndex);
+  // The scene item has no column when it has no child in the source model,
+  // use the top-level column count to keep the extra items.
+  return this->sourceModel() ? this->sourceModel()->columnCount() : 0;
+}
+
+// --------------------------------------------------------------------------
+bool qMRMLNodeComboBoxExtraItemsModel::hasChildren(const QModelIndex& parentIndex)const
+{
+  return this->rowCount(parentIndex) > 0;
+}
+
+// --------------------------------------------------------------------------
+QVariant qMRMLNodeComboBoxExtraItemsModel::data(const QModelIndex& index, int role)const
+{
+  int type = this->extraItemType(index);
+  if (type == -1)
+    {
+    if (role == qMRMLSceneModel::ExtraItemsRole &&
+        index.internalId() == 0 && index.row() == 0)
+      {
+      QMap<QString, QVariant> extraItems;
+      extraItems["preItem"] = this->PreItems;
+      extraItems["postItem"] = this->PostItems;
+      return extraItems;
+      }
+    return this->sourceModel() ?
+      this->sourceModel()->data(this->mapToSource(index), role) : QVariant();
+    }
+  if (index.column() != 0)
+    {
+    return QVariant();
+    }
+  QString text = this->extraItem(index);
+  switch (role)
+    {
+    case qMRMLSceneModel::UIDRole:
+      return QString(type == 0 ? "preItem" : "postItem");
+    case Qt::DisplayRole:
+    case Qt::EditRole:
+      return text != "separator" ? QVariant(text) : QVariant();
+    case Qt::AccessibleDescriptionRole:
+      return text == "separator" ? QVariant(text) : QVariant();
+    default:
+      break;
+    }
+  return QVariant();
+}
+
+// --------------------------------------------------------------------------
+bool qMRMLNodeComboBoxExtraItemsModel
+::setData(const QModelIndex& index, const QVariant& value, int role)
+{
+  if (this->extraItemType(index) != -1 || !this->sourceModel())
+    {
+    return false;
+    }
+  return this->sourceModel()->setData(this->mapToSource(index), value, role);
+}
+
+// --------------------------------------------------------------------------
+Qt::ItemFlags qMRMLNodeComboBoxExtraItemsModel::flags(const QModelIndex& index)const
+{
+  int type = this->extraItemType(index);
+  if (type == -1)
+    {
+    return this->sourceModel() ?
+      this->sourceModel()->flags(this->mapToSource(index)) : Qt::ItemFlags(0);
+    }
+  if (index.column() != 0)
+    {
+    return 0;
+    }
+  return type == 0 ?
+    Qt::ItemIsEnabled | Qt::ItemIsSelectable : Qt::ItemFlags(Qt::ItemIsEnabled);
+}
+
+// --------------------------------------------------------------------------
+QModelIndex qMRMLNodeComboBoxExtraItemsModel::mapToSource(const QModelIndex& proxyIndex)const
+{
+  if (!proxyIndex.isValid() || !this->sourceModel())
+    {
+    return QModelIndex();
+    }
+  if (proxyIndex.internalId() == 0)
+    {
+    return this->sourceModel()->index(proxyIndex.row(), proxyIndex.column());
+    }
+  int row = proxyIndex.row() - this->PreItems.count();
+  if (row < 0 || row >= this->sourceNodeCount())
+    {
+    return QModelIndex();
+    }
+  return this->sourceModel()->index(row, proxyIndex.column(), this->sourceSceneIndex());
+}
+
+// --------------------------------------------------------------------------
+QModelIndex qMRMLNodeComboBoxExtraItemsModel::mapFromSource(const QModelIndex& sourceIndex)const
+{
+  if (!sourceIndex.isValid())
+    {
+    return QModelIndex();
+    }
+  QModelIndex sourceParent = sourceIndex.parent();
+  if (!sourceParent.isValid())
+    {
+    return this->createIndex(sourceIndex.row(), sourceIndex.column(), quint32(0));
+    }
+  if (sourceParent != this->sourceSceneIndex())
+    {
+    return QModelIndex();
+    }
+  return this->createIndex(sourceIndex.row() + this->PreItems.count(),
+                           sourceIndex.column(), quint32(1));
+}
+
+// --------------------------------------------------------------------------
+void qMRMLNodeComboBoxExtraItemsModel
+::onSourceRowsAboutToBeInserted(const QModelIndex& sourceParent, int start, int end)
+{
+  if (!sourceParent.isValid())
+    {
+    // The scene item (and the extra items) can appear/move, reset.
+    this->beginResetModel();
+    }
+  else if (sourceParent == this->sourceSceneIndex())
+    {
+    this->beginInsertRows(this->mapFromSource(sourceParent),
+                          start + this->PreItems.count(),
+                          end + this->PreItems.count());
+    }
+}
+
+// --------------------------------------------------------------------------
+void qMRMLNodeComboBoxExtraItemsModel::onSourceRowsInserted(const QModelIndex& sourceParent)
+{
+  if (!sourceParent.isValid())
+    {
+    this->endResetModel();
+    }
+  else if (sourceParent == this->sourceSceneIndex())
+    {
+    this->endInsertRows();
+    }
+}
+
+// --------------------------------------------------------------------------
+void qMRMLNodeComboBoxExtraItemsModel
+::onSourceRowsAboutToBeRemoved(const QModelIndex& sourceParent, int start, int end)
+{
+  if (!sourceParent.isValid())
+    {
+    this->beginResetModel();
+    }
+  else if (sourceParent == this->sourceSceneIndex())
+    {
+    this->beginRemoveRows(this->mapFromSource(sourceParent),
+                          start + this->PreItems.count(),
+                          end + this->PreItems.count());
+    }
+}
+
+// --------------------------------------------------------------------------
+void qMRMLNodeComboBoxExtraItemsModel::onSourceRowsRemoved(const QModelIndex& sourceParent)
+{
+  if (!sourceParent.isValid())
+    {
+    this->endResetModel();
+    }
+  else if (sourceParent == this->sourceSceneIndex())
+    {
+    this->endRemoveRows();
+    }
+}
+
+// --------------------------------------------------------------------------
+void qMRMLNodeComboBoxExtraItemsModel
+::onSourceDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight)
+{
+  QModelIndex proxyTopLeft = this->mapFromSource(topLeft);
+  QModelIndex proxyBottomRight = this->mapFromSource(bottomRight);
+  if (proxyTopLeft.isValid() && proxyBottomRight.isValid())
+    {
+    emit dataChanged(proxyTopLeft, proxyBottomRight);
+    }
+}
+
+// --------------------------------------------------------------------------
+void qMRMLNodeComboBoxExtraItemsModel::onSourceLayoutAboutToBeChanged()
+{
+  emit layoutAboutToBeChanged();
+  this->LayoutChangeProxyIndexes.clear();
+  this->LayoutChangeSourceIndexes.clear();
+  this->LayoutChangeExtraItemRows.clear();
+  int nodeCount = this->sourceNodeCount();
+  foreach(const QModelIndex& proxyIndex, this->persistentIndexList())
+    {
+    this->LayoutChangeProxyIndexes << proxyIndex;
+    switch (this->extraItemType(proxyIndex))
+      {
+      case 0:
+        this->LayoutChangeSourceIndexes << QPersistentModelIndex();
+        this->LayoutChangeExtraItemRows << proxyIndex.row();
+        break;
+      case 1:
+        this->LayoutChangeSourceIndexes << QPersistentModelIndex();
+        this->LayoutChangeExtraItemRows << proxyIndex.row() - nodeCount;
+        break;
+      default:
+        this->LayoutChangeSourceIndexes << QPersistentModelIndex(this->mapToSource(proxyIndex));
+        this->LayoutChangeExtraItemRows << -1;
+        break;
+      }
+    }
+}
+
+// --------------------------------------------------------------------------
+void qMRMLNodeComboBoxExtraItemsModel::onSourceLayoutChanged()
+{
+  // The number of nodes can change (e.g. filter invalidated), the post items
+  // follow the nodes.
+  int nodeCount = this->sourceNodeCount();
+  QModelIndexList newIndexes;
+  for (int i = 0; i < this->LayoutChangeProxyIndexes.count(); ++i)
+    {
+    int extraItemRow = this->LayoutChangeExtraItemRows[i];
+    if (extraItemRow == -1)
+      {
+      newIndexes << this->mapFromSource(this->LayoutChangeSourceIndexes[i]);
+      continue;
+      }
+    if (extraItemRow >= this->PreItems.count())
+      {
+      extraItemRow += nodeCount;
+      }
+    newIndexes << this->index(extraItemRow,
+                              this->LayoutChangeProxyIndexes[i].column(),
+                              this->index(0, 0));
+    }
+  this->changePersistentIndexList(this->LayoutChangeProxyIndexes, newIndexes);
+  this->LayoutChangeProxyIndexes.clear();
+  this->LayoutChangeSourceIndexes.clear();
+  this->LayoutChangeExtraItemRows.clear();
+  emit layoutChanged();
+}
+
+// --------------------------------------------------------------------------
+void qMRMLNodeComboBoxExtraItemsModel::onSourceModelAboutToBeReset()
+{
+  this->beginResetModel();
+}
+
+// --------------------------------------------------------------------------
+void qMRMLNodeComboBoxExtraItemsModel::onSourceModelReset()
+{
+  this->endResetModel();
+}
+
+// --------------------------------------------------------------------------
+// Shared scene models
+
+namespace
+{
+// Scene models shared by the comboboxes, one per scene (0 included), and
+// the number of comboboxes using each of them.
+QHash<vtkMRMLScene*, qMRMLSceneModel*>& sharedSceneModels()
+{
+  static QHash<vtkMRMLScene*, qMRMLSceneModel*> sceneModels;
+  return sceneModels;
+}
+
+QHash<qMRMLSceneModel*, int>& sharedSceneModelReferenceCounts()
+{
+  static QHash<qMRMLSceneModel*, int> referenceCounts;
+  return referenceCounts;
+}
+}
+
+// --------------------------------------------------------------------------
+qMRMLSceneModel* qMRMLNodeComboBoxPrivate::acquireSharedSceneModel(vtkMRMLScene* scene)
+{
+  QHash<vtkMRMLScene*, qMRMLSceneModel*>& sceneModels = sharedSceneModels();
+  qMRMLSceneModel* sceneModel = sceneModels.value(scene, 0);
+  // When a scene is deleted, its model observes no scene anymore. Another
+  // scene can then be allocated at the same address.
+  if (sceneModel && sceneModel->mrmlScene() != scene)
+    {
+    sceneModels.remove(scene);
+    sceneModel = 0;
+    }
+  if (!sceneModel)
+    {
+    sceneModel = new qMRMLSceneModel;
+    sceneModel->setMRMLScene(scene);
+    sceneModels[scene] = sceneModel;
+    }
+  ++sharedSceneModelReferenceCounts()[sceneModel];
+  return sceneModel;
+}
+
+// --------------------------------------------------------------------------
+void qMRMLNodeComboBoxPrivate::releaseSharedSceneModel(qMRMLSceneModel* sceneModel)
+{
+  QHash<qMRMLSceneModel*, int>& referenceCounts = sharedSceneModelReferenceCounts();
+  Q_ASSERT(referenceCounts.contains(sceneModel));
+  if (--referenceCounts[sceneModel] > 0)
+    {
+    return;
+    }
+  referenceCounts.remove(sceneModel);
+  QHash<vtkMRMLScene*, qMRMLSceneModel*>& sceneModels = sharedSceneModels();
+  QList<vtkMRMLScene*> scenes = sceneModels.keys(sceneModel);
+  foreach(vtkMRMLScene* scene, scenes)
+    {
+    sceneModels.remove(scene);
+    }
+  // The model can be released from one of its own signals, stop observing
+  // the scene now and delete it later.
+  sceneModel->setMRMLScene(0);
+  sceneModel->deleteLater();
+}
+
+// --------------------------------------------------------------------------
+// qMRMLNodeComboBoxPrivate
+
 // --------------------------------------------------------------------------
 qMRMLNodeComboBoxPrivate::qMRMLNodeComboBoxPrivate(qMRMLNodeComboBox& object)
   : q_ptr(&object)
@@ -47,6 +575,9 @@ qMRMLNodeComboBoxPrivate::qMRMLNodeComboBoxPrivate(qMRMLNodeComboBox& object)
   this->ComboBox = 0;
   this->MRMLNodeFactory = 0;
   this->MRMLSceneModel = 0;
+  this->SortFilterModel = 0;
+  this->ExtraItemsModel = 0;
+  this->SharedSceneModel = false;
   this->NoneEnabled = false;
   this->AddEnabled = true;
   this->RemoveEnabled = true;
@@ -90,6 +621,12 @@ void qMRMLNodeComboBoxPrivate::init(QAbstractItemModel* model)
 
   this->MRMLNodeFactory = new qMRMLNodeFactory(q);
 
+  if (model == 0)
+    {
+    this->SharedSceneModel = true;
+    model = qMRMLNodeComboBoxPrivate::acquireSharedSceneModel(0);
+    }
+
   QAbstractItemModel* rootModel = model;
   while (qobject_cast<QAbstractProxyModel*>(rootModel) &&
          qobject_cast<QAbstractProxyModel*>(rootModel)->sourceModel())
@@ -98,13 +635,27 @@ void qMRMLNodeComboBoxPrivate::init(QAbstractItemModel* model)
     }
   this->MRMLSceneModel = qobject_cast<qMRMLSceneModel*>(rootModel);
   Q_ASSERT(this->MRMLSceneModel);
+
+  this->SortFilterModel = new qMRMLSortFilterProxyModel(q);
+  this->SortFilterModel->setSourceModel(model);
+  if (this->SharedSceneModel)
+    {
+    // The extra items of the combobox can't go into the shared scene model.
+    this->ExtraItemsModel = new qMRMLNodeComboBoxExtraItemsModel(q);
+    this->ExtraItemsModel->setSourceModel(this->SortFilterModel);
+    }
   // no need to reset the root model index here as the model is not yet set
   this->updateNoneItem(false);
   this->updateActionItems(false);
 
-  qMRMLSortFilterProxyModel* sortFilterModel = new qMRMLSortFilterProxyModel(q);
-  sortFilterModel->setSourceModel(model);
-  this->setModel(sortFilterModel);
+  if (this->ExtraItemsModel)
+    {
+    this->setModel(this->ExtraItemsModel);
+    }
+  else
+    {
+    this->setModel(this->SortFilterModel);
+    }
 
   // nodeTypeLabel() works only when the model is set.
   this->updateDefaultText();
@@ -130,6 +681,8 @@ void qMRMLNodeComboBoxPrivate::setModel(QAbstractItemModel* model)
              q, SLOT(emitNodesAboutToBeRemoved(QModelIndex,int,int)));
   q->connect(model, SIGNAL(rowsRemoved(QModelIndex,int,int)),
              q, SLOT(refreshIfCurrentNodeHidden()));
+  q->connect(model, SIGNAL(modelAboutToBeReset()), q, SLOT(saveCurrentNodeBeforeReset()));
+  q->connect(model, SIGNAL(modelReset()), q, SLOT(restoreCurrentNodeAfterReset()));
   q->connect(model, SIGNAL(modelReset()), q, SLOT(refreshIfCurrentNodeHidden()));
   q->connect(model, SIGNAL(layoutChanged()), q, SLOT(refreshIfCurrentNodeHidden()));
 }
@@ -214,7 +767,11 @@ void qMRMLNodeComboBoxPrivate::updateNoneItem(bool resetRootIndex)
   //QVariant currentNode =
   //  this->ComboBox->itemData(this->ComboBox->currentIndex(), qMRMLSceneModel::UIDRole);
   //qDebug() << "updateNoneItem: " << this->MRMLSceneModel->mrmlSceneItem();
-  if (this->MRMLSceneModel->mrmlSceneItem())
+  if (this->ExtraItemsModel)
+    {
+    this->ExtraItemsModel->setPreItems(noneItem);
+    }
+  else if (this->MRMLSceneModel->mrmlSceneItem())
     {
     this->MRMLSceneModel->setPreItems(noneItem, this->MRMLSceneModel->mrmlSceneItem());
     }
@@ -265,7 +822,14 @@ void qMRMLNodeComboBoxPrivate::updateActionItems(bool resetRootIndex)
       extraItems.append(QObject::tr("Delete current ")  + this->nodeTypeLabel());
       }
     }
-  this->MRMLSceneModel->setPostItems(extraItems, this->MRMLSceneModel->mrmlSceneItem());
+  if (this->ExtraItemsModel)
+    {
+    this->ExtraItemsModel->setPostItems(extraItems);
+    }
+  else
+    {
+    this->MRMLSceneModel->setPostItems(extraItems, this->MRMLSceneModel->mrmlSceneItem());
+    }
   QObject::connect(this->ComboBox->view(), SIGNAL(clicked(QModelIndex)),
                    q, SLOT(activateExtraItem(QModelIndex)),
                    Qt::UniqueConnection);
@@ -329,6 +893,29 @@ QString qMRMLNodeComboBoxPrivate::nodeTypeLabel()const
   return label;
 }
 
+// --------------------------------------------------------------------------
+void qMRMLNodeComboBoxPrivate::setSceneModel(qMRMLSceneModel* sceneModel, bool shared)
+{
+  Q_ASSERT(this->ExtraItemsModel);
+  qMRMLSceneModel* oldSceneModel = this->MRMLSceneModel;
+  bool oldShared = this->SharedSceneModel;
+  this->MRMLSceneModel = sceneModel;
+  this->SharedSceneModel = shared;
+  this->SortFilterModel->setSourceModel(sceneModel);
+  if (oldSceneModel == sceneModel)
+    {
+    return;
+    }
+  if (oldShared)
+    {
+    qMRMLNodeComboBoxPrivate::releaseSharedSceneModel(oldSceneModel);
+    }
+  else
+    {
+    delete oldSceneModel;
+    }
+}
+
 // --------------------------------------------------------------------------
 // qMRMLNodeComboBox
 
@@ -338,7 +925,7 @@ qMRMLNodeComboBox::qMRMLNodeComboBox(QWidget* parentWidget)
   , d_ptr(new qMRMLNodeComboBoxPrivate(*this))
 {
   Q_D(qMRMLNodeComboBox);
-  d->init(new qMRMLSceneModel(this));
+  d->init(0);
 }
 
 // --------------------------------------------------------------------------
@@ -362,6 +949,15 @@ qMRMLNodeComboBox::qMRMLNodeComboBox(qMRMLNodeComboBoxPrivate* pimpl, QWidget* p
 // --------------------------------------------------------------------------
 qMRMLNodeComboBox::~qMRMLNodeComboBox()
 {
+  Q_D(qMRMLNodeComboBox);
+  if (d->SharedSceneModel)
+    {
+    // The other comboboxes keep using the model, stop listening to it
+    // instead of resetting the source of the sort filter proxy model that is
+    // about to be deleted.
+    QObject::disconnect(d->MRMLSceneModel, 0, d->SortFilterModel, 0);
+    qMRMLNodeComboBoxPrivate::releaseSharedSceneModel(d->MRMLSceneModel);
+    }
 }
 
 // --------------------------------------------------------------------------
@@ -542,7 +1138,8 @@ vtkMRMLScene* qMRMLNodeComboBox::mrmlScene()const
 int qMRMLNodeComboBox::nodeCount()const
 {
   Q_D(const qMRMLNodeComboBox);
-  int extraItemsCount =
+  int extraItemsCount = d->ExtraItemsModel ?
+    d->ExtraItemsModel->preItems().count() + d->ExtraItemsModel->postItems().count() :
     d->MRMLSceneModel->preItems(d->MRMLSceneModel->mrmlSceneItem()).count()
     + d->MRMLSceneModel->postItems(d->MRMLSceneModel->mrmlSceneItem()).count();
   //qDebug() << d->MRMLSceneModel->invisibleRootItem() << d->MRMLSceneModel->mrmlSceneItem() << d->ComboBox->count() <<extraItemsCount;
@@ -584,7 +1181,14 @@ void qMRMLNodeComboBox::setMRMLScene(vtkMRMLScene* scene)
 
   // Update factory
   d->MRMLNodeFactory->setMRMLScene(scene);
-  d->MRMLSceneModel->setMRMLScene(scene);
+  if (d->SharedSceneModel)
+    {
+    d->setSceneModel(qMRMLNodeComboBoxPrivate::acquireSharedSceneModel(scene), true);
+    }
+  else
+    {
+    d->MRMLSceneModel->setMRMLScene(scene);
+    }
   d->updateDefaultText();
   d->updateNoneItem(false);
   d->updateActionItems(false);
@@ -841,8 +1445,9 @@ QList<vtkMRMLNode*> qMRMLNodeComboBox::nodes()const
 //--------------------------------------------------------------------------
 qMRMLSortFilterProxyModel* qMRMLNodeComboBox::sortFilterProxyModel()const
 {
-  Q_ASSERT(qobject_cast<qMRMLSortFilterProxyModel*>(this->model()));
-  return qobject_cast<qMRMLSortFilterProxyModel*>(this->model());
+  Q_D(const qMRMLNodeComboBox);
+  Q_ASSERT(d->SortFilterModel);
+  return d->SortFilterModel;
 }
 
 //--------------------------------------------------------------------------
@@ -866,6 +1471,45 @@ QAbstractItemModel* qMRMLNodeComboBox::rootModel()const
   return d->MRMLSceneModel;
 }
 
+//--------------------------------------------------------------------------
+bool qMRMLNodeComboBox::sharedSceneModel()const
+{
+  Q_D(const qMRMLNodeComboBox);
+  return d->SharedSceneModel;
+}
+
+//--------------------------------------------------------------------------
+void qMRMLNodeComboBox::setSharedSceneModel(bool shared)
+{
+  Q_D(qMRMLNodeComboBox);
+  if (!d->ExtraItemsModel)
+    {
+    qWarning() << "qMRMLNodeComboBox::setSharedSceneModel: only the "
+               << "comboboxes with the default scene model can share it";
+    return;
+    }
+  if (d->SharedSceneModel == shared)
+    {
+    return;
+    }
+  QString currentNodeID = this->currentNodeID();
+  vtkMRMLScene* scene = this->mrmlScene();
+  qMRMLSceneModel* sceneModel = 0;
+  if (shared)
+    {
+    sceneModel = qMRMLNodeComboBoxPrivate::acquireSharedSceneModel(scene);
+    }
+  else
+    {
+    sceneModel = new qMRMLSceneModel(this);
+    sceneModel->setMRMLScene(scene);
+    }
+  d->setSceneModel(sceneModel, shared);
+  // Changing the source model resets the model and the root model index.
+  d->ComboBox->setRootModelIndex(this->model()->index(0, 0));
+  this->setCurrentNodeID(currentNodeID);
+}
+
 //--------------------------------------------------------------------------
 qMRMLNodeFactory* qMRMLNodeComboBox::nodeFactory()const
 {
@@ -959,6 +1603,26 @@ void qMRMLNodeComboBox::refreshIfCurrentNodeHidden()
     }
 }
 
+//--------------------------------------------------------------------------
+void qMRMLNodeComboBox::saveCurrentNodeBeforeReset()
+{
+  Q_D(qMRMLNodeComboBox);
+  d->CurrentNodeIDBeforeReset = this->currentNodeID();
+}
+
+//--------------------------------------------------------------------------
+void qMRMLNodeComboBox::restoreCurrentNodeAfterReset()
+{
+  Q_D(qMRMLNodeComboBox);
+  // The reset invalidates the current index of the combobox
+  QString nodeID = d->CurrentNodeIDBeforeReset;
+  d->CurrentNodeIDBeforeReset.clear();
+  if (!nodeID.isEmpty() && this->currentNodeID() != nodeID)
+    {
+    this->setCurrentNodeID(nodeID);
+    }
+}
+
 //--------------------------------------------------------------------------
 QComboBox::SizeAdjustPolicy qMRMLNodeComboBox::sizeAdjustPolicy()const
 {
@@ -84,6 +84,17 @@ class QMRML_WIDGETS_EXPORT qMRMLNodeComboBox
 
   Q_PROPERTY(QComboBox::SizeAdjustPolicy sizeAdjustPolicy READ sizeAdjustPolicy WRITE setSizeAdjustPolicy)
 
+  /// This property controls whether the combobox uses the scene model shared
+  /// by all the comboboxes of its scene (the nodes are then indexed once per
+  /// scene, not once per combobox). The node types, attributes and extra items
+  /// ("None", "Create new node"...) still belong to each combobox.
+  /// Turn it off before customizing the scene model (e.g. lazy update, icons)
+  /// as it would impact all the comboboxes.
+  /// Only available to the comboboxes created with the default constructor.
+  /// true by default.
+  /// \sa sharedSceneModel(), setSharedSceneModel(), sceneModel()
+  Q_PROPERTY(bool sharedSceneModel READ sharedSceneModel WRITE setSharedSceneModel)
+
 public:
   typedef QWidget Superclass;
 
@@ -207,7 +218,9 @@ public:
   QList<vtkMRMLNode*> nodes()const;
 
   /// Internal model associated to the combobox.
-  /// It is usually not the scene model but the sort filter proxy model.
+  /// It is usually not the scene model but a proxy model (the sort filter
+  /// proxy model or, for a shared scene model, the proxy model that adds the
+  /// extra items on top of it).
   /// \sa sortFilterProxyModel(), sceneModel()
   QAbstractItemModel* model()const;
 
@@ -219,9 +232,13 @@ public:
   /// Retrieve the scene model internally used.
   /// The scene model is usually not used directly, but a sortFilterProxyModel
   /// is plugged in.
-  /// \sa sortFilterProxyModel()
+  /// \sa sortFilterProxyModel(), sharedSceneModel
   qMRMLSceneModel* sceneModel()const;
 
+  /// \sa sharedSceneModel
+  bool sharedSceneModel()const;
+  void setSharedSceneModel(bool shared);
+
   /// Return the node factory used to create nodes when "Add Node"
   /// is selected (property \a AddEnabled should be true).
   /// A typical use would be to connect the node factory signal
@@ -341,6 +358,9 @@ protected slots:
   void emitNodesAdded(const QModelIndex & parent, int start, int end);
   void emitNodesAboutToBeRemoved(const QModelIndex & parent, int start, int end);
   void refreshIfCurrentNodeHidden();
+  /// Keep the current node when the model is reset (e.g. batchUpdate)
+  void saveCurrentNodeBeforeReset();
+  void restoreCurrentNodeAfterReset();
 
 protected:
   QScopedPointer<qMRMLNodeComboBoxPrivate> d_ptr;
@@ -21,6 +21,10 @@
 #ifndef __qMRMLNodeComboBox_p_h
 #define __qMRMLNodeComboBox_p_h
 
+// Qt includes
+#include <QAbstractProxyModel>
+#include <QStringList>
+
 // CTK includes
 #include <ctkPimpl.h>
 
@@ -30,6 +34,76 @@ class QComboBox;
 class qMRMLNodeFactory;
 class qMRMLSceneModel;
 
+// -----------------------------------------------------------------------------
+/// \brief Proxy model that adds the "None" and action items of a combobox.
+/// The scene model shared by the comboboxes of a scene can't contain the
+/// extra items of each combobox. qMRMLNodeComboBoxExtraItemsModel adds them
+/// on top of the (filtered) scene model, as the children of the scene item
+/// (first top-level row) before (pre items) and after (post items) the nodes.
+/// The extra items have the same data and flags as the extra items of
+/// qMRMLSceneModel.
+/// Only the top-level rows and the children of the scene item are mapped.
+class qMRMLNodeComboBoxExtraItemsModel : public QAbstractProxyModel
+{
+  Q_OBJECT
+public:
+  typedef QAbstractProxyModel Superclass;
+  qMRMLNodeComboBoxExtraItemsModel(QObject* parent = 0);
+
+  virtual void setSourceModel(QAbstractItemModel* sourceModel);
+
+  void setPreItems(const QStringList& extraItems);
+  QStringList preItems()const;
+  void setPostItems(const QStringList& extraItems);
+  QStringList postItems()const;
+
+  virtual QModelIndex index(int row, int column,
+                            const QModelIndex& parent = QModelIndex())const;
+  virtual QModelIndex parent(const QModelIndex& child)const;
+  virtual int rowCount(const QModelIndex& parent = QModelIndex())const;
+  virtual int columnCount(const QModelIndex& parent = QModelIndex())const;
+  virtual bool hasChildren(const QModelIndex& parent = QModelIndex())const;
+  virtual QVariant data(const QModelIndex& index, int role = Qt::DisplayRole)const;
+  virtual bool setData(const QModelIndex& index, const QVariant& value,
+                       int role = Qt::EditRole);
+  virtual Qt::ItemFlags flags(const QModelIndex& index)const;
+
+  virtual QModelIndex mapToSource(const QModelIndex& proxyIndex)const;
+  virtual QModelIndex mapFromSource(const QModelIndex& sourceIndex)const;
+
+protected slots:
+  void onSourceRowsAboutToBeInserted(const QModelIndex& sourceParent, int start, int end);
+  void onSourceRowsInserted(const QModelIndex& sourceParent);
+  void onSourceRowsAboutToBeRemoved(const QModelIndex& sourceParent, int start, int end);
+  void onSourceRowsRemoved(const QModelIndex& sourceParent);
+  void onSourceDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight);
+  void onSourceLayoutAboutToBeChanged();
+  void onSourceLayoutChanged();
+  void onSourceModelAboutToBeReset();
+  void onSourceModelReset();
+
+protected:
+  /// Index of the scene item in the source model, invalid if there is none
+  QModelIndex sourceSceneIndex()const;
+  /// Number of nodes under the scene item of the source model
+  int sourceNodeCount()const;
+  /// Return -1 if \a index is not an extra item, 0 if it is a pre item,
+  /// 1 if it is a post item.
+  int extraItemType(const QModelIndex& index)const;
+  QString extraItem(const QModelIndex& index)const;
+  void setExtraItems(QStringList& items, int firstRow, const QStringList& newItems);
+
+  QStringList PreItems;
+  QStringList PostItems;
+
+  /// Persistent indexes saved by onSourceLayoutAboutToBeChanged()
+  QModelIndexList LayoutChangeProxyIndexes;
+  QList<QPersistentModelIndex> LayoutChangeSourceIndexes;
+  /// Row of the extra items (minus the number of nodes for the post items),
+  /// -1 for the nodes
+  QList<int> LayoutChangeExtraItemRows;
+};
+
 // -----------------------------------------------------------------------------
 class qMRMLNodeComboBoxPrivate
 {
@@ -40,6 +114,8 @@ protected:
 public:
   qMRMLNodeComboBoxPrivate(qMRMLNodeComboBox& object);
   virtual ~qMRMLNodeComboBoxPrivate();
+  /// If \a model is 0, the combobox uses the scene model shared by all
+  /// the comboboxes of its scene.
   virtual void init(QAbstractItemModel* model);
 
   vtkMRMLNode* mrmlNode(int row)const;
@@ -52,9 +128,24 @@ public:
   void updateDelegate(bool force = false);
   QString nodeTypeLabel()const;
 
+  /// Make \a sceneModel the source of the sort filter proxy model and
+  /// release or delete the previous scene model.
+  void setSceneModel(qMRMLSceneModel* sceneModel, bool shared);
+
+  /// Return the scene model shared by the comboboxes observing \a scene
+  /// and increment its reference count. The model is created if needed.
+  static qMRMLSceneModel* acquireSharedSceneModel(vtkMRMLScene* scene);
+  /// Decrement the reference count of \a sceneModel and delete it when no
+  /// combobox uses it anymore.
+  static void releaseSharedSceneModel(qMRMLSceneModel* sceneModel);
+
   QComboBox*        ComboBox;
   qMRMLNodeFactory* MRMLNodeFactory;
   qMRMLSceneModel*  MRMLSceneModel;
+  qMRMLSortFilterProxyModel* SortFilterModel;
+  /// Only used with the default constructor, 0 otherwise
+  qMRMLNodeComboBoxExtraItemsModel* ExtraItemsModel;
+  bool              SharedSceneModel;
   bool              NoneEnabled;
   bool              AddEnabled;
   bool              RemoveEnabled;
@@ -64,6 +155,7 @@ public:
   bool SelectNodeUponCreation;
   QString NoneDisplay;
   bool AutoDefaultText;
+  QString CurrentNodeIDBeforeReset;
 };
 
 #endif
@@ -0,0 +1,419 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Copyright (c) Kitware Inc.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  This file was originally developed by Julien Finet, Kitware Inc.
+  and was partially funded by NIH grant 3P41RR013218-12S1
+
+==============================================================================*/
+
+// Qt includes
+#include <QDebug>
+#include <QEvent>
+#include <QMap>
+#include <QTime>
+#include <QTimer>
+#include <QWidget>
+
+// qMRML includes
+#include "qMRMLRenderScheduler.h"
+
+//-----------------------------------------------------------------------------
+class qMRMLRenderSchedulerPrivate
+{
+  Q_DECLARE_PUBLIC(qMRMLRenderScheduler);
+protected:
+  qMRMLRenderScheduler* const q_ptr;
+public:
+  qMRMLRenderSchedulerPrivate(qMRMLRenderScheduler& object);
+
+  void init();
+  /// Start the frame timer if it isn't already started
+  void scheduleFrame();
+  /// Minimum time between 2 frames in ms
+  int frameInterval()const;
+  /// Return the scheduled view \a object is or belongs to, 0 if none
+  QWidget* view(QObject* object)const;
+  void render(QWidget* view);
+
+  double MaximumFrameRate;
+  QList<QWidget*> Views;
+  QList<QWidget*> PendingViews;
+  QWidget* InteractionView;
+  QTimer* FrameTimer;
+  QTime LastFrameTime;
+  /// True if views have been postponed by the last frame, they are then not
+  /// postponed again.
+  bool LastFramePostponed;
+
+  QMap<QWidget*, int> RenderCounts;
+  QMap<QWidget*, int> SkippedRenderCounts;
+  int RenderCount;
+  int SkippedRenderCount;
+  int FrameSkippedRenderCount;
+  int PostponedFrameCount;
+};
+
+//-----------------------------------------------------------------------------
+// qMRMLRenderSchedulerPrivate methods
+
+//-----------------------------------------------------------------------------
+qMRMLRenderSchedulerPrivate::qMRMLRenderSchedulerPrivate(qMRMLRenderScheduler& object)
+  : q_ptr(&object)
+{
+  this->MaximumFrameRate = 60.;
+  this->InteractionView = 0;
+  this->FrameTimer = 0;
+  this->LastFramePostponed = false;
+  this->RenderCount = 0;
+  this->SkippedRenderCount = 0;
+  this->FrameSkippedRenderCount = 0;
+  this->PostponedFrameCount = 0;
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLRenderSchedulerPrivate::init()
+{
+  Q_Q(qMRMLRenderScheduler);
+  this->FrameTimer = new QTimer(q);
+  this->FrameTimer->setSingleShot(true);
+  QObject::connect(this->FrameTimer, SIGNAL(timeout()),
+                   q, SLOT(onFrameTimeout()));
+}
+
+//-----------------------------------------------------------------------------
+int qMRMLRenderSchedulerPrivate::frameInterval()const
+{
+  return this->MaximumFrameRate > 0. ?
+    static_cast<int>(1000. / this->MaximumFrameRate) : 0;
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLRenderSchedulerPrivate::scheduleFrame()
+{
+  if (this->FrameTimer->isActive())
+    {
+    return;
+    }
+  int delay = 0;
+  if (this->LastFrameTime.isValid())
+    {
+    delay = qMax(0, this->frameInterval() - this->LastFrameTime.elapsed());
+    }
+  this->FrameTimer->start(delay);
+}
+
+//-----------------------------------------------------------------------------
+QWidget* qMRMLRenderSchedulerPrivate::view(QObject* object)const
+{
+  for (; object; object = object->parent())
+    {
+    QWidget* widget = qobject_cast<QWidget*>(object);
+    if (widget && this->Views.contains(widget))
+      {
+      return widget;
+      }
+    }
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLRenderSchedulerPrivate::render(QWidget* view)
+{
+  // Views don't render while their rendering is disabled (e.g. during scene
+  // batch processing)
+  QVariant renderEnabled = view->property("renderEnabled");
+  if (renderEnabled.isValid() && !renderEnabled.toBool())
+    {
+    return;
+    }
+  if (!QMetaObject::invokeMethod(view, "forceRender", Qt::DirectConnection))
+    {
+    qWarning() << "qMRMLRenderScheduler:" << view->objectName()
+               << "has no forceRender() slot";
+    return;
+    }
+  ++this->RenderCount;
+  ++this->RenderCounts[view];
+}
+
+//-----------------------------------------------------------------------------
+// qMRMLRenderScheduler methods
+
+//-----------------------------------------------------------------------------
+qMRMLRenderScheduler::qMRMLRenderScheduler(QObject* parentObject)
+  : Superclass(parentObject)
+  , d_ptr(new qMRMLRenderSchedulerPrivate(*this))
+{
+  Q_D(qMRMLRenderScheduler);
+  d->init();
+}
+
+//-----------------------------------------------------------------------------
+qMRMLRenderScheduler::~qMRMLRenderScheduler()
+{
+}
+
+//-----------------------------------------------------------------------------
+double qMRMLRenderScheduler::maximumFrameRate()const
+{
+  Q_D(const qMRMLRenderScheduler);
+  return d->MaximumFrameRate;
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLRenderScheduler::setMaximumFrameRate(double fps)
+{
+  Q_D(qMRMLRenderScheduler);
+  d->MaximumFrameRate = qMax(0., fps);
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLRenderScheduler::addView(QWidget* view)
+{
+  Q_D(qMRMLRenderScheduler);
+  if (!view || d->Views.contains(view))
+    {
+    return;
+    }
+  d->Views << view;
+  // The mouse events are received by the render window widget of the view
+  view->installEventFilter(this);
+  foreach(QWidget* child, view->findChildren<QWidget*>())
+    {
+    child->installEventFilter(this);
+    }
+  this->connect(view, SIGNAL(destroyed(QObject*)),
+                SLOT(onViewDestroyed(QObject*)));
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLRenderScheduler::removeView(QWidget* view)
+{
+  Q_D(qMRMLRenderScheduler);
+  if (!d->Views.contains(view))
+    {
+    return;
+    }
+  view->removeEventFilter(this);
+  foreach(QWidget* child, view->findChildren<QWidget*>())
+    {
+    child->removeEventFilter(this);
+    }
+  this->disconnect(view, SIGNAL(destroyed(QObject*)),
+                   this, SLOT(onViewDestroyed(QObject*)));
+  this->onViewDestroyed(view);
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLRenderScheduler::onViewDestroyed(QObject* object)
+{
+  Q_D(qMRMLRenderScheduler);
+  // Don't use qobject_cast, the widget is being destroyed.
+  QWidget* view = static_cast<QWidget*>(object);
+  d->Views.removeAll(view);
+  d->PendingViews.removeAll(view);
+  d->RenderCounts.remove(view);
+  d->SkippedRenderCounts.remove(view);
+  if (d->InteractionView == view)
+    {
+    d->InteractionView = 0;
+    }
+}
+
+//-----------------------------------------------------------------------------
+QList<QWidget*> qMRMLRenderScheduler::views()const
+{
+  Q_D(const qMRMLRenderScheduler);
+  return d->Views;
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLRenderScheduler::requestRender(QWidget* view)
+{
+  Q_D(qMRMLRenderScheduler);
+  if (!view)
+    {
+    return;
+    }
+  this->addView(view);
+  if (d->PendingViews.contains(view))
+    {
+    ++d->SkippedRenderCount;
+    ++d->SkippedRenderCounts[view];
+    ++d->FrameSkippedRenderCount;
+    return;
+    }
+  d->PendingViews << view;
+  d->scheduleFrame();
+}
+
+//-----------------------------------------------------------------------------
+bool qMRMLRenderScheduler::isRenderPending(QWidget* view)const
+{
+  Q_D(const qMRMLRenderScheduler);
+  return d->PendingViews.contains(view);
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLRenderScheduler::setInteractionView(QWidget* view)
+{
+  Q_D(qMRMLRenderScheduler);
+  if (view && !d->Views.contains(view))
+    {
+    this->addView(view);
+    }
+  d->InteractionView = view;
+}
+
+//-----------------------------------------------------------------------------
+QWidget* qMRMLRenderScheduler::interactionView()const
+{
+  Q_D(const qMRMLRenderScheduler);
+  return d->InteractionView;
+}
+
+//-----------------------------------------------------------------------------
+int qMRMLRenderScheduler::renderCount()const
+{
+  Q_D(const qMRMLRenderScheduler);
+  return d->RenderCount;
+}
+
+//-----------------------------------------------------------------------------
+int qMRMLRenderScheduler::renderCount(QWidget* view)const
+{
+  Q_D(const qMRMLRenderScheduler);
+  return d->RenderCounts.value(view, 0);
+}
+
+//-----------------------------------------------------------------------------
+int qMRMLRenderScheduler::skippedRenderCount()const
+{
+  Q_D(const qMRMLRenderScheduler);
+  return d->SkippedRenderCount;
+}
+
+//-----------------------------------------------------------------------------
+int qMRMLRenderScheduler::skippedRenderCount(QWidget* view)const
+{
+  Q_D(const qMRMLRenderScheduler);
+  return d->SkippedRenderCounts.value(view, 0);
+}
+
+//-----------------------------------------------------------------------------
+int qMRMLRenderScheduler::postponedFrameCount()const
+{
+  Q_D(const qMRMLRenderScheduler);
+  return d->PostponedFrameCount;
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLRenderScheduler::resetStatistics()
+{
+  Q_D(qMRMLRenderScheduler);
+  d->RenderCounts.clear();
+  d->SkippedRenderCounts.clear();
+  d->RenderCount = 0;
+  d->SkippedRenderCount = 0;
+  d->FrameSkippedRenderCount = 0;
+  d->PostponedFrameCount = 0;
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLRenderScheduler::renderPendingViews()
+{
+  Q_D(qMRMLRenderScheduler);
+  d->FrameTimer->stop();
+  d->LastFramePostponed = true; // don't postpone any view
+  this->onFrameTimeout();
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLRenderScheduler::onFrameTimeout()
+{
+  Q_D(qMRMLRenderScheduler);
+  d->LastFrameTime.start();
+
+  QList<QWidget*> views = d->PendingViews;
+  d->PendingViews.clear();
+  bool interacting = d->InteractionView && views.contains(d->InteractionView);
+  if (interacting)
+    {
+    views.removeAll(d->InteractionView);
+    views.prepend(d->InteractionView);
+    }
+
+  QTime frameTime;
+  frameTime.start();
+  bool postponed = false;
+  int renderedViews = 0;
+  for (int i = 0; i < views.count(); ++i)
+    {
+    // Keep the interaction view responsive: if its render took the frame
+    // budget, the other views are rendered in the next frame.
+    if (interacting && i > 0 && !d->LastFramePostponed &&
+        frameTime.elapsed() > d->frameInterval())
+      {
+      // Requests received while rendering come after the postponed views
+      QList<QWidget*> requestedViews = d->PendingViews;
+      d->PendingViews = views.mid(i);
+      foreach(QWidget* requestedView, requestedViews)
+        {
+        if (!d->PendingViews.contains(requestedView))
+          {
+          d->PendingViews << requestedView;
+          }
+        }
+      postponed = true;
+      ++d->PostponedFrameCount;
+      break;
+      }
+    d->render(views[i]);
+    ++renderedViews;
+    }
+  d->LastFramePostponed = postponed;
+
+  int skippedRenders = d->FrameSkippedRenderCount;
+  d->FrameSkippedRenderCount = 0;
+  emit frameRendered(renderedViews, skippedRenders);
+
+  if (!d->PendingViews.isEmpty())
+    {
+    d->scheduleFrame();
+    }
+}
+
+//-----------------------------------------------------------------------------
+bool qMRMLRenderScheduler::eventFilter(QObject* object, QEvent* event)
+{
+  Q_D(qMRMLRenderScheduler);
+  switch (event->type())
+    {
+    case QEvent::MouseButtonPress:
+    case QEvent::Wheel:
+    case QEvent::KeyPress:
+      {
+      QWidget* view = d->view(object);
+      if (view)
+        {
+        d->InteractionView = view;
+        }
+      break;
+      }
+    default:
+      break;
+    }
+  return this->Superclass::eventFilter(object, event);
+}
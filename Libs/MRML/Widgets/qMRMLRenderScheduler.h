@@ -0,0 +1,116 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Copyright (c) Kitware Inc.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  This file was originally developed by Julien Finet, Kitware Inc.
+  and was partially funded by NIH grant 3P41RR013218-12S1
+
+==============================================================================*/
+
+#ifndef __qMRMLRenderScheduler_h
+#define __qMRMLRenderScheduler_h
+
+// Qt includes
+#include <QObject>
+
+// CTK includes
+#include <ctkPimpl.h>
+
+#include "qMRMLWidgetsExport.h"
+
+class qMRMLRenderSchedulerPrivate;
+
+/// \brief Coalesce the render requests of views into frames.
+///
+/// The views request renders with requestRender() instead of rendering
+/// themselves. All the requests received before the next frame result in a
+/// single render per view. Frames are no more frequent than
+/// maximumFrameRate.
+/// The view the user interacts with (interactionView) is rendered first.
+/// If the frame then exceeds its time budget, the other views are rendered
+/// in the next frame.
+/// The views must have a forceRender() slot (e.g. ctkVTKSliceView or
+/// ctkVTKRenderView).
+/// \sa qMRMLLayoutManager::renderScheduler(), qMRMLSliceView::setRenderScheduler(),
+/// qMRMLThreeDView::setRenderScheduler()
+class QMRML_WIDGETS_EXPORT qMRMLRenderScheduler : public QObject
+{
+  Q_OBJECT
+  /// Maximum number of frames per second, 60 by default.
+  /// 0 means frames are rendered as soon as the event loop is entered.
+  Q_PROPERTY(double maximumFrameRate READ maximumFrameRate WRITE setMaximumFrameRate)
+  /// Total number of renders of the views.
+  Q_PROPERTY(int renderCount READ renderCount)
+  /// Total number of render requests that didn't result into a render:
+  /// requests received while a render of the view was already pending.
+  Q_PROPERTY(int skippedRenderCount READ skippedRenderCount)
+  /// Number of frames whose renders were split: views were postponed to
+  /// the next frame to keep the interaction view responsive.
+  Q_PROPERTY(int postponedFrameCount READ postponedFrameCount)
+public:
+  typedef QObject Superclass;
+  explicit qMRMLRenderScheduler(QObject* parent = 0);
+  virtual ~qMRMLRenderScheduler();
+
+  double maximumFrameRate()const;
+  void setMaximumFrameRate(double fps);
+
+  /// Add a view to schedule. The view becomes the interaction view when a
+  /// mouse button is pressed over it or a key pressed.
+  void addView(QWidget* view);
+  void removeView(QWidget* view);
+  QList<QWidget*> views()const;
+
+  /// Request a render of \a view in the next frame.
+  /// The view is added if it isn't already.
+  void requestRender(QWidget* view);
+  Q_INVOKABLE bool isRenderPending(QWidget* view)const;
+
+  /// The view under interaction is rendered first in each frame.
+  void setInteractionView(QWidget* view);
+  QWidget* interactionView()const;
+
+  int renderCount()const;
+  Q_INVOKABLE int renderCount(QWidget* view)const;
+  int skippedRenderCount()const;
+  Q_INVOKABLE int skippedRenderCount(QWidget* view)const;
+  int postponedFrameCount()const;
+
+public slots:
+  /// Render the views with a pending render right away.
+  void renderPendingViews();
+
+  /// Reset the render and skipped render counts.
+  void resetStatistics();
+
+signals:
+  /// Emitted after each frame with the number of views rendered in the frame
+  /// and the number of skipped renders during the frame.
+  void frameRendered(int renderedViews, int skippedRenders);
+
+protected slots:
+  void onFrameTimeout();
+  void onViewDestroyed(QObject* view);
+
+protected:
+  virtual bool eventFilter(QObject* object, QEvent* event);
+
+  QScopedPointer<qMRMLRenderSchedulerPrivate> d_ptr;
+
+private:
+  Q_DECLARE_PRIVATE(qMRMLRenderScheduler);
+  Q_DISABLE_COPY(qMRMLRenderScheduler);
+};
+
+#endif
@@ -0,0 +1,167 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Qt includes
+#include <QTreeWidgetItem>
+
+// qMRML includes
+#include "qMRMLSceneMemoryWidget.h"
+#include "ui_qMRMLSceneMemoryWidget.h"
+
+// MRMLLogic includes
+#include <vtkMRMLSliceLogic.h>
+
+// MRML includes
+#include <vtkMRMLNode.h>
+#include <vtkMRMLScene.h>
+
+// VTK includes
+#include <vtkCollection.h>
+#include <vtkSmartPointer.h>
+
+//------------------------------------------------------------------------------
+class qMRMLSceneMemoryWidgetPrivate: public Ui_qMRMLSceneMemoryWidget
+{
+  Q_DECLARE_PUBLIC(qMRMLSceneMemoryWidget);
+
+protected:
+  qMRMLSceneMemoryWidget* const q_ptr;
+
+public:
+  qMRMLSceneMemoryWidgetPrivate(qMRMLSceneMemoryWidget& object);
+  void init();
+
+  vtkSmartPointer<vtkCollection> SliceLogics;
+};
+
+//------------------------------------------------------------------------------
+qMRMLSceneMemoryWidgetPrivate::qMRMLSceneMemoryWidgetPrivate(qMRMLSceneMemoryWidget& object)
+  : q_ptr(&object)
+{
+}
+
+//------------------------------------------------------------------------------
+void qMRMLSceneMemoryWidgetPrivate::init()
+{
+  Q_Q(qMRMLSceneMemoryWidget);
+  this->setupUi(q);
+  QObject::connect(this->RefreshButton, SIGNAL(clicked()),
+                   q, SLOT(updateWidgetFromMRML()));
+  q->updateWidgetFromMRML();
+}
+
+//------------------------------------------------------------------------------
+qMRMLSceneMemoryWidget::qMRMLSceneMemoryWidget(QWidget *_parent)
+  : Superclass(_parent)
+  , d_ptr(new qMRMLSceneMemoryWidgetPrivate(*this))
+{
+  Q_D(qMRMLSceneMemoryWidget);
+  d->init();
+}
+
+//------------------------------------------------------------------------------
+qMRMLSceneMemoryWidget::~qMRMLSceneMemoryWidget()
+{
+}
+
+//------------------------------------------------------------------------------
+void qMRMLSceneMemoryWidget::setSliceLogics(vtkCollection* sliceLogics)
+{
+  Q_D(qMRMLSceneMemoryWidget);
+  d->SliceLogics = sliceLogics;
+  this->updateWidgetFromMRML();
+}
+
+//------------------------------------------------------------------------------
+vtkCollection* qMRMLSceneMemoryWidget::sliceLogics()const
+{
+  Q_D(const qMRMLSceneMemoryWidget);
+  return d->SliceLogics;
+}
+
+//------------------------------------------------------------------------------
+QString qMRMLSceneMemoryWidget::sizeToString(unsigned long kibibytes)
+{
+  if (kibibytes < 1024)
+    {
+    return tr("%1 KB").arg(kibibytes);
+    }
+  return tr("%1 MB").arg(kibibytes / 1024., 0, 'f', 1);
+}
+
+//------------------------------------------------------------------------------
+void qMRMLSceneMemoryWidget::setMRMLScene(vtkMRMLScene* scene)
+{
+  this->Superclass::setMRMLScene(scene);
+  this->updateWidgetFromMRML();
+}
+
+//------------------------------------------------------------------------------
+void qMRMLSceneMemoryWidget::updateWidgetFromMRML()
+{
+  Q_D(qMRMLSceneMemoryWidget);
+  d->NodesTreeWidget->clear();
+
+  vtkMRMLScene* scene = this->mrmlScene();
+  unsigned long nodesSize = 0;
+  unsigned long sceneViewsSize = 0;
+  unsigned long undoSize = 0;
+  if (scene)
+    {
+    // Only the nodes holding bulk data are listed
+    QList<QTreeWidgetItem*> items;
+    vtkCollection* nodes = scene->GetNodes();
+    vtkMRMLNode* node = 0;
+    vtkCollectionSimpleIterator it;
+    for (nodes->InitTraversal(it);
+         (node = vtkMRMLNode::SafeDownCast(nodes->GetNextItemAsObject(it))) ;)
+      {
+      unsigned long ownedSize = scene->GetNodeOwnedMemorySize(node);
+      unsigned long sharedSize = scene->GetNodeSharedMemorySize(node);
+      if (ownedSize == 0 && sharedSize == 0)
+        {
+        continue;
+        }
+      QStringList columns;
+      columns << QString(node->GetName()) << QString(node->GetClassName())
+              << sizeToString(ownedSize) << sizeToString(sharedSize);
+      items << new QTreeWidgetItem(columns);
+      }
+    d->NodesTreeWidget->addTopLevelItems(items);
+    nodesSize = scene->GetNodesMemorySize();
+    sceneViewsSize = scene->GetSceneViewsMemorySize();
+    undoSize = scene->GetUndoStackDataMemorySize() +
+      scene->GetUndoStackMemorySize() / 1024;
+    }
+
+  unsigned long slicePipelinesSize = 0;
+  if (d->SliceLogics)
+    {
+    for (int i = 0; i < d->SliceLogics->GetNumberOfItems(); ++i)
+      {
+      vtkMRMLSliceLogic* sliceLogic =
+        vtkMRMLSliceLogic::SafeDownCast(d->SliceLogics->GetItemAsObject(i));
+      if (sliceLogic)
+        {
+        slicePipelinesSize += sliceLogic->GetPipelineMemorySize();
+        }
+      }
+    }
+
+  d->NodesSizeLabel->setText(sizeToString(nodesSize));
+  d->SceneViewsSizeLabel->setText(sizeToString(sceneViewsSize));
+  d->UndoSizeLabel->setText(sizeToString(undoSize));
+  d->SlicePipelinesSizeLabel->setText(sizeToString(slicePipelinesSize));
+}
@@ -0,0 +1,62 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __qMRMLSceneMemoryWidget_h
+#define __qMRMLSceneMemoryWidget_h
+
+// qMRML includes
+#include "qMRMLWidget.h"
+#include "qMRMLWidgetsExport.h"
+
+class qMRMLSceneMemoryWidgetPrivate;
+class vtkCollection;
+
+/// Report the memory used by the bulk data (image data, polydata...) of the
+/// scene nodes, the scene views, the undo stack and the slice pipelines.
+/// The report is not updated automatically, call updateWidgetFromMRML().
+/// \sa vtkMRMLScene::GetNodeOwnedMemorySize(),
+/// vtkMRMLSliceLogic::GetPipelineMemorySize()
+class QMRML_WIDGETS_EXPORT qMRMLSceneMemoryWidget : public qMRMLWidget
+{
+  Q_OBJECT
+public:
+  typedef qMRMLWidget Superclass;
+
+  qMRMLSceneMemoryWidget(QWidget *parent=0);
+  virtual ~qMRMLSceneMemoryWidget();
+
+  /// Slice logics whose pipelines are accounted, none by default.
+  /// \sa vtkMRMLApplicationLogic::GetSliceLogics()
+  void setSliceLogics(vtkCollection* sliceLogics);
+  vtkCollection* sliceLogics()const;
+
+  /// Format a size in kibibytes, as returned by the accounting functions.
+  static QString sizeToString(unsigned long kibibytes);
+
+public slots:
+  virtual void setMRMLScene(vtkMRMLScene* scene);
+
+  /// Compute the memory usage again
+  void updateWidgetFromMRML();
+
+protected:
+  QScopedPointer<qMRMLSceneMemoryWidgetPrivate> d_ptr;
+
+private:
+  Q_DECLARE_PRIVATE(qMRMLSceneMemoryWidget);
+  Q_DISABLE_COPY(qMRMLSceneMemoryWidget);
+};
+
+#endif
@@ -44,6 +44,8 @@ qMRMLSceneModelPrivate::qMRMLSceneModelPrivate(qMRMLSceneModel& object)
 
   this->CallBack = vtkSmartPointer<vtkCallbackCommand>::New();
   this->LazyUpdate = false;
+  this->LazyChildren = false;
+  this->BatchUpdate = false;
   this->ListenNodeModifiedEvent = qMRMLSceneModel::NoNodes;
   this->PendingItemModified = -1; // -1 means not updating
 
@@ -82,33 +84,33 @@ void qMRMLSceneModelPrivate::init()
 
   QObject::connect(q, SIGNAL(itemChanged(QStandardItem*)),
                    q, SLOT(onItemChanged(QStandardItem*)));
+  QObject::connect(q, SIGNAL(rowsInserted(QModelIndex,int,int)),
+                   q, SLOT(onRowsInserted(QModelIndex,int,int)));
+  QObject::connect(q, SIGNAL(rowsAboutToBeRemoved(QModelIndex,int,int)),
+                   q, SLOT(onRowsAboutToBeRemoved(QModelIndex,int,int)));
+  QObject::connect(q, SIGNAL(columnsAboutToBeRemoved(QModelIndex,int,int)),
+                   q, SLOT(onColumnsAboutToBeRemoved(QModelIndex,int,int)));
+  QObject::connect(q, SIGNAL(modelAboutToBeReset()),
+                   q, SLOT(onModelAboutToBeReset()));
 
   q->setNameColumn(0);
   q->setListenNodeModifiedEvent(qMRMLSceneModel::OnlyVisibleNodes);
 }
 
 //------------------------------------------------------------------------------
-QModelIndexList qMRMLSceneModelPrivate::indexes(const QString& nodeID)const
+QModelIndexList qMRMLSceneModelPrivate::indexes(vtkMRMLNode* node)const
 {
   Q_Q(const qMRMLSceneModel);
-  QModelIndex scene = q->mrmlSceneIndex();
-  if (scene == QModelIndex())
-    {
-    return QModelIndexList();
-    }
-  // QAbstractItemModel::match doesn't browse through columns
-  // we need to do it manually
-  QModelIndexList nodeIndexes = q->match(
-    scene, qMRMLSceneModel::UIDRole, nodeID,
-    1, Qt::MatchExactly | Qt::MatchRecursive);
-  Q_ASSERT(nodeIndexes.size() <= 1); // we know for sure it won't be more than 1
-  if (nodeIndexes.size() == 0)
+  QModelIndexList nodeIndexes;
+  QModelIndex nodeIndex = q->indexFromNode(node);
+  if (!nodeIndex.isValid())
     {
     return nodeIndexes;
     }
+  nodeIndexes << nodeIndex;
   // Add the QModelIndexes from the other columns
-  const int row = nodeIndexes[0].row();
-  QModelIndex nodeParentIndex = nodeIndexes[0].parent();
+  const int row = nodeIndex.row();
+  QModelIndex nodeParentIndex = nodeIndex.parent();
   const int sceneColumnCount = q->columnCount(nodeParentIndex);
   for (int j = 1; j < sceneColumnCount; ++j)
     {
@@ -117,6 +119,67 @@ QModelIndexList qMRMLSceneModelPrivate::indexes(const QString& nodeID)const
   return nodeIndexes;
 }
 
+//------------------------------------------------------------------------------
+// Node of a node item, read from the item only: unlike mrmlNodeFromItem, it
+// doesn't depend on the scene, that may already be unset when the items are
+// removed.
+static vtkMRMLNode* indexedNode(QStandardItem* item)
+{
+  QVariant nodePointer = item->data(qMRMLSceneModel::PointerRole);
+  if (!nodePointer.isValid() || item->data(qMRMLSceneModel::UIDRole).toString() == "scene")
+    {
+    return 0;
+    }
+  return static_cast<vtkMRMLNode*>(reinterpret_cast<void *>(nodePointer.toLongLong()));
+}
+
+//------------------------------------------------------------------------------
+void qMRMLSceneModelPrivate::indexNodeItems(QStandardItem* parent, int first, int last)
+{
+  for (int row = first; row <= last; ++row)
+    {
+    QStandardItem* item = parent->child(row, 0);
+    if (!item)
+      {
+      continue;
+      }
+    vtkMRMLNode* node = indexedNode(item);
+    if (node)
+      {
+      this->NodeItems[node] = item;
+      }
+    // Reparented rows come with their children
+    if (item->rowCount())
+      {
+      this->indexNodeItems(item, 0, item->rowCount() - 1);
+      }
+    }
+}
+
+//------------------------------------------------------------------------------
+void qMRMLSceneModelPrivate::unindexNodeItems(QStandardItem* parent, int first, int last)
+{
+  for (int row = first; row <= last; ++row)
+    {
+    QStandardItem* item = parent->child(row, 0);
+    if (!item)
+      {
+      continue;
+      }
+    vtkMRMLNode* node = indexedNode(item);
+    // When dropped, the copy of a row is inserted before the original row
+    // is removed: only remove the node if it still points to this item.
+    if (node && this->NodeItems.value(node) == item)
+      {
+      this->NodeItems.remove(node);
+      }
+    if (item->rowCount())
+      {
+      this->unindexNodeItems(item, 0, item->rowCount() - 1);
+      }
+    }
+}
+
 //------------------------------------------------------------------------------
 void qMRMLSceneModelPrivate::listenNodeModifiedEvent()
 {
@@ -134,6 +197,49 @@ void qMRMLSceneModelPrivate::listenNodeModifiedEvent()
     }
 }
 
+//------------------------------------------------------------------------------
+bool qMRMLSceneModelPrivate::childrenFetched(vtkMRMLNode* parent)const
+{
+  Q_Q(const qMRMLSceneModel);
+  if (!this->LazyChildren || parent == 0)
+    {
+    return true;
+    }
+  QStandardItem* parentItem = q->itemFromNode(parent);
+  return parentItem &&
+    parentItem->data(qMRMLSceneModel::ChildrenFetchedRole).toBool();
+}
+
+//------------------------------------------------------------------------------
+bool qMRMLSceneModelPrivate::isUpdateDeferred()const
+{
+  // The scene is cleared as a whole, it is cheaper to rebuild the model
+  // once it is closed than to remove the nodes one by one.
+  return this->MRMLScene &&
+    (this->MRMLScene->IsClosing() ||
+     ((this->LazyUpdate || this->BatchUpdate) &&
+      this->MRMLScene->IsBatchProcessing()));
+}
+
+//------------------------------------------------------------------------------
+void qMRMLSceneModelPrivate::resetScene()
+{
+  Q_Q(qMRMLSceneModel);
+  q->beginResetModel();
+  // The rows signals are not emitted, the node items are indexed by
+  // insertNode() and reindexed once populated.
+  bool blocked = q->blockSignals(true);
+  q->updateScene();
+  q->blockSignals(blocked);
+  this->NodeItems.clear();
+  QStandardItem* root = q->invisibleRootItem();
+  if (root->rowCount())
+    {
+    this->indexNodeItems(root, 0, root->rowCount() - 1);
+    }
+  q->endResetModel();
+}
+
 //------------------------------------------------------------------------------
 void qMRMLSceneModelPrivate::insertExtraItem(int row, QStandardItem* parent,
                                              const QString& text,
@@ -349,6 +455,7 @@ void qMRMLSceneModel::setMRMLScene(vtkMRMLScene* scene)
     {
     scene->AddObserver(vtkMRMLScene::NodeAboutToBeAddedEvent, d->CallBack, -10.);
     scene->AddObserver(vtkMRMLScene::NodeAddedEvent, d->CallBack, 10.);
+    scene->AddObserver(vtkMRMLScene::NodesAddedEvent, d->CallBack, 10.);
     scene->AddObserver(vtkMRMLScene::NodeAboutToBeRemovedEvent, d->CallBack, -10.);
     scene->AddObserver(vtkMRMLScene::NodeRemovedEvent, d->CallBack, 10.);
     scene->AddObserver(vtkCommand::DeleteEvent, d->CallBack);
@@ -438,41 +545,31 @@ QStandardItem* qMRMLSceneModel::itemFromNode(vtkMRMLNode* node, int column)const
 //------------------------------------------------------------------------------
 QModelIndex qMRMLSceneModel::indexFromNode(vtkMRMLNode* node, int column)const
 {
-  if (node == 0)
-    {
-    return QModelIndex();
-    }
-  // QAbstractItemModel::match doesn't browse through columns
-  // we need to do it manually
-  QModelIndexList nodeIndexes = this->match(
-    this->mrmlSceneIndex(), qMRMLSceneModel::UIDRole, QString(node->GetID()),
-    1, Qt::MatchExactly | Qt::MatchRecursive);
-  Q_ASSERT(nodeIndexes.size() <= 1); // we know for sure it won't be more than 1
-  if (nodeIndexes.size() == 0)
+  Q_D(const qMRMLSceneModel);
+  QStandardItem* nodeItem = node ? d->NodeItems.value(node, 0) : 0;
+  if (nodeItem == 0)
     {
     // maybe the node hasn't been added to the scene yet...
     // (if it's called from populateScene/inserteNode)
     return QModelIndex();
     }
+  QModelIndex nodeIndex = nodeItem->index();
+  Q_ASSERT(nodeIndex.isValid());
   if (column == 0)
     {
-    // QAbstractItemModel::match only search through the first column
-    // (because scene is in the first column)
-    Q_ASSERT(nodeIndexes[0].isValid());
-    return nodeIndexes[0];
+    return nodeIndex;
     }
-  // Add the QModelIndexes from the other columns
-  const int row = nodeIndexes[0].row();
-  QModelIndex nodeParentIndex = nodeIndexes[0].parent();
+  // The other columns are siblings of the first one
+  QModelIndex nodeParentIndex = nodeIndex.parent();
   Q_ASSERT( column < this->columnCount(nodeParentIndex) );
-  return nodeParentIndex.child(row, column);
+  return nodeParentIndex.child(nodeIndex.row(), column);
 }
 
 //------------------------------------------------------------------------------
 QModelIndexList qMRMLSceneModel::indexes(vtkMRMLNode* node)const
 {
   Q_D(const qMRMLSceneModel);
-  return d->indexes(QString(node->GetID()));
+  return d->indexes(node);
 }
 
 //------------------------------------------------------------------------------
@@ -599,6 +696,99 @@ bool qMRMLSceneModel::lazyUpdate()const
   return d->LazyUpdate;
 }
 
+//------------------------------------------------------------------------------
+void qMRMLSceneModel::setBatchUpdate(bool batch)
+{
+  Q_D(qMRMLSceneModel);
+  d->BatchUpdate = batch;
+}
+
+//------------------------------------------------------------------------------
+bool qMRMLSceneModel::batchUpdate()const
+{
+  Q_D(const qMRMLSceneModel);
+  return d->BatchUpdate;
+}
+
+//------------------------------------------------------------------------------
+void qMRMLSceneModel::setLazyChildren(bool lazy)
+{
+  Q_D(qMRMLSceneModel);
+  if (d->LazyChildren == lazy)
+    {
+    return;
+    }
+  d->LazyChildren = lazy;
+  if (d->MRMLScene)
+    {
+    this->updateScene();
+    }
+}
+
+//------------------------------------------------------------------------------
+bool qMRMLSceneModel::lazyChildren()const
+{
+  Q_D(const qMRMLSceneModel);
+  return d->LazyChildren;
+}
+
+//------------------------------------------------------------------------------
+bool qMRMLSceneModel::hasChildren(const QModelIndex& parent)const
+{
+  if (this->canFetchMore(parent))
+    {
+    return true;
+    }
+  return this->Superclass::hasChildren(parent);
+}
+
+//------------------------------------------------------------------------------
+bool qMRMLSceneModel::canFetchMore(const QModelIndex& parent)const
+{
+  Q_D(const qMRMLSceneModel);
+  if (!d->LazyChildren || !parent.isValid())
+    {
+    return this->Superclass::canFetchMore(parent);
+    }
+  QStandardItem* item = this->itemFromIndex(parent.sibling(parent.row(), 0));
+  vtkMRMLNode* node = this->mrmlNodeFromItem(item);
+  return node && this->canBeAParent(node) &&
+    !item->data(qMRMLSceneModel::ChildrenFetchedRole).toBool();
+}
+
+//------------------------------------------------------------------------------
+void qMRMLSceneModel::fetchMore(const QModelIndex& parent)
+{
+  Q_D(qMRMLSceneModel);
+  if (!this->canFetchMore(parent))
+    {
+    this->Superclass::fetchMore(parent);
+    return;
+    }
+  QStandardItem* item = this->itemFromIndex(parent.sibling(parent.row(), 0));
+  vtkMRMLNode* parentNode = this->mrmlNodeFromItem(item);
+  bool blocked = this->blockSignals(true);
+  item->setData(true, qMRMLSceneModel::ChildrenFetchedRole);
+  this->blockSignals(blocked);
+
+  // Same as populateScene, restricted to the children of the node
+  vtkMRMLNode *node = 0;
+  vtkCollectionSimpleIterator it;
+  d->MisplacedNodes.clear();
+  for (d->MRMLScene->GetNodes()->InitTraversal(it);
+       (node = (vtkMRMLNode*)d->MRMLScene->GetNodes()->GetNextItemAsObject(it)) ;)
+    {
+    if (this->parentNode(node) == parentNode)
+      {
+      this->insertNode(node);
+      }
+    }
+  foreach(vtkMRMLNode* misplacedNode, d->MisplacedNodes)
+    {
+    this->onMRMLNodeModified(misplacedNode);
+    }
+}
+
 //------------------------------------------------------------------------------
 QMimeData* qMRMLSceneModel::mimeData(const QModelIndexList& indexes)const
 {
@@ -725,6 +915,11 @@ void qMRMLSceneModel::populateScene()
   for (d->MRMLScene->GetNodes()->InitTraversal(it);
        (node = (vtkMRMLNode*)d->MRMLScene->GetNodes()->GetNextItemAsObject(it)) ;)
     {
+    // The child nodes are added when their parent is expanded
+    if (d->LazyChildren && this->parentNode(node))
+      {
+      continue;
+      }
     this->insertNode(node);
     }
   foreach(vtkMRMLNode* misplacedNode, d->MisplacedNodes)
@@ -745,6 +940,12 @@ QStandardItem* qMRMLSceneModel::insertNode(vtkMRMLNode* node)
     return nodeItem;
     }
   vtkMRMLNode* parentNode = this->parentNode(node);
+  if (!d->childrenFetched(parentNode))
+    {
+    // The node item will be created when the children of its parent are
+    // fetched
+    return 0;
+    }
   QStandardItem* parentItem =
     parentNode ? this->itemFromNode(parentNode) : this->mrmlSceneItem();
   if (!parentItem)
@@ -788,6 +989,8 @@ QStandardItem* qMRMLSceneModel::insertNode(vtkMRMLNode* node, QStandardItem* par
     {
     this->insertRow(row,items);
     }
+  // Already done by onRowsInserted() unless the signals are blocked
+  d->NodeItems[node] = items[0];
   // TODO: don't listen to nodes that are hidden from editors ?
   if (d->ListenNodeModifiedEvent == AllNodes)
     {
@@ -833,6 +1036,14 @@ void qMRMLSceneModel::updateItemFromNode(QStandardItem* item, vtkMRMLNode* node,
       }
     // If the item has no parent, then it means it hasn't been put into the scene yet.
     // and it will do it automatically.
+    if (parentItem && !d->childrenFetched(this->parentNode(node)))
+      {
+      // Moved under a node that hasn't fetched its children yet: the item
+      // will be created again when they are.
+      d->unindexNodeItems(parentItem, item->row(), item->row());
+      parentItem->removeRow(item->row());
+      return;
+      }
     if (parentItem)
       {
       int newIndex = this->nodeIndex(node);
@@ -1057,6 +1268,18 @@ void qMRMLSceneModel::onMRMLSceneEvent(vtkObject* vtk_obj, unsigned long event,
       Q_ASSERT(node);
       sceneModel->onMRMLSceneNodeAdded(scene, node);
       break;
+    case vtkMRMLScene::NodesAddedEvent:
+      {
+      vtkCollection* nodes = reinterpret_cast<vtkCollection*>(call_data);
+      Q_ASSERT(nodes);
+      vtkCollectionSimpleIterator it;
+      for (nodes->InitTraversal(it);
+           (node = vtkMRMLNode::SafeDownCast(nodes->GetNextItemAsObject(it))) ;)
+        {
+        sceneModel->onMRMLSceneNodeAdded(scene, node);
+        }
+      }
+      break;
     case vtkMRMLScene::NodeAboutToBeRemovedEvent:
       Q_ASSERT(node);
       sceneModel->onMRMLSceneNodeAboutToBeRemoved(scene, node);
@@ -1110,7 +1333,7 @@ void qMRMLSceneModel::onMRMLSceneNodeAdded(vtkMRMLScene* scene, vtkMRMLNode* nod
   Q_ASSERT(scene == d->MRMLScene);
   Q_ASSERT(vtkMRMLNode::SafeDownCast(node));
 
-  if (d->LazyUpdate && d->MRMLScene->IsBatchProcessing())
+  if (d->isUpdateDeferred())
     {
     return;
     }
@@ -1125,7 +1348,7 @@ void qMRMLSceneModel::onMRMLSceneNodeAboutToBeRemoved(vtkMRMLScene* scene, vtkMR
   Q_UNUSED(scene);
   Q_ASSERT(scene == d->MRMLScene);
 
-  if (d->LazyUpdate && d->MRMLScene->IsBatchProcessing())
+  if (d->isUpdateDeferred())
     {
     return;
     }
@@ -1145,13 +1368,10 @@ void qMRMLSceneModel::onMRMLSceneNodeAboutToBeRemoved(vtkMRMLScene* scene, vtkMR
   // Remove all the observations on the node
   qvtkDisconnect(node, vtkCommand::NoEvent, this, 0);
 
-  // TODO: can be fasten by browsing the tree only once
-  QModelIndexList indexes = this->match(this->mrmlSceneIndex(), qMRMLSceneModel::UIDRole,
-                                        QString(node->GetID()), 1,
-                                        Qt::MatchExactly | Qt::MatchRecursive);
-  if (indexes.count())
+  QModelIndex index = this->indexFromNode(node);
+  if (index.isValid())
     {
-    QStandardItem* item = this->itemFromIndex(indexes[0].sibling(indexes[0].row(),0));
+    QStandardItem* item = this->itemFromIndex(index);
     // The children may be lost if not reparented, we ensure they got reparented.
     while (item->rowCount())
       {
@@ -1168,7 +1388,7 @@ void qMRMLSceneModel::onMRMLSceneNodeAboutToBeRemoved(vtkMRMLScene* scene, vtkMR
         d->Orphans.removeAll(orphans);
         }
       }
-    this->removeRow(indexes[0].row(), indexes[0].parent());
+    this->removeRow(index.row(), index.parent());
     }
 }
 
@@ -1178,7 +1398,7 @@ void qMRMLSceneModel::onMRMLSceneNodeRemoved(vtkMRMLScene* scene, vtkMRMLNode* n
   Q_D(qMRMLSceneModel);
   Q_UNUSED(scene);
   Q_UNUSED(node);
-  if (d->LazyUpdate && d->MRMLScene->IsBatchProcessing())
+  if (d->isUpdateDeferred())
     {
     return;
     }
@@ -1197,6 +1417,12 @@ void qMRMLSceneModel::onMRMLSceneNodeRemoved(vtkMRMLScene* scene, vtkMRMLNode* n
       continue;
       }
     vtkMRMLNode* node = this->mrmlNodeFromItem(orphan);
+    if (!d->childrenFetched(this->parentNode(node)))
+      {
+      // The new parent will create the item when fetching its children
+      qDeleteAll(orphans);
+      continue;
+      }
     int newIndex = this->nodeIndex(node);
     QStandardItem* newParentItem = this->itemFromNode(this->parentNode(node));
     if (newParentItem == 0)
@@ -1277,7 +1503,7 @@ void qMRMLSceneModel::updateNodeItems(vtkMRMLNode* node, const QString& nodeUID)
 {
   Q_D(qMRMLSceneModel);
 
-  if (d->LazyUpdate && d->MRMLScene->IsBatchProcessing())
+  if (d->isUpdateDeferred())
     {
     return;
     }
@@ -1287,7 +1513,9 @@ void qMRMLSceneModel::updateNodeItems(vtkMRMLNode* node, const QString& nodeUID)
   // still observing the node (in a subclass)
   Q_ASSERT(node && node->GetScene());
   //Q_ASSERT(node->GetScene()->IsNodePresent(node));
-  QModelIndexList nodeIndexes = d->indexes(nodeUID);
+  // The items are found from the node, nodeUID may be its old ID
+  Q_UNUSED(nodeUID);
+  QModelIndexList nodeIndexes = d->indexes(node);
   //qDebug() << "onMRMLNodeModified" << node->GetID() << nodeIndexes;
   Q_ASSERT(nodeIndexes.count());
   for (int i = 0; i < nodeIndexes.size(); ++i)
@@ -1305,6 +1533,11 @@ void qMRMLSceneModel::updateNodeItems(vtkMRMLNode* node, const QString& nodeUID)
     QStandardItem* oldParent = item->parent();
 
     this->updateItemFromNode(item, node, item->column());
+    // the item may have been removed if its new parent is not fetched
+    if (!d->NodeItems.contains(node))
+      {
+      break;
+      }
     // maybe the item has been reparented, then we need to rescan the
     // indexes again as may are wrong.
     if (item->row() != oldRow || item->parent() != oldParent)
@@ -1360,6 +1593,49 @@ void qMRMLSceneModel::onItemChanged(QStandardItem * item)
   this->updateNodeFromItem(mrmlNode, item);
 }
 
+//------------------------------------------------------------------------------
+void qMRMLSceneModel::onRowsInserted(const QModelIndex& parent, int first, int last)
+{
+  Q_D(qMRMLSceneModel);
+  QStandardItem* parentItem =
+    parent.isValid() ? this->itemFromIndex(parent) : this->invisibleRootItem();
+  d->indexNodeItems(parentItem, first, last);
+}
+
+//------------------------------------------------------------------------------
+void qMRMLSceneModel::onRowsAboutToBeRemoved(const QModelIndex& parent, int first, int last)
+{
+  Q_D(qMRMLSceneModel);
+  QStandardItem* parentItem =
+    parent.isValid() ? this->itemFromIndex(parent) : this->invisibleRootItem();
+  d->unindexNodeItems(parentItem, first, last);
+}
+
+//------------------------------------------------------------------------------
+void qMRMLSceneModel::onColumnsAboutToBeRemoved(const QModelIndex& parent, int first, int last)
+{
+  Q_D(qMRMLSceneModel);
+  Q_UNUSED(last);
+  // The nodes are indexed by their first column item
+  if (first != 0)
+    {
+    return;
+    }
+  QStandardItem* parentItem =
+    parent.isValid() ? this->itemFromIndex(parent) : this->invisibleRootItem();
+  if (parentItem->rowCount())
+    {
+    d->unindexNodeItems(parentItem, 0, parentItem->rowCount() - 1);
+    }
+}
+
+//------------------------------------------------------------------------------
+void qMRMLSceneModel::onModelAboutToBeReset()
+{
+  Q_D(qMRMLSceneModel);
+  d->NodeItems.clear();
+}
+
 //------------------------------------------------------------------------------
 void qMRMLSceneModel::delayedItemChanged()
 {
@@ -1389,7 +1665,8 @@ void qMRMLSceneModel::onMRMLSceneImported(vtkMRMLScene* scene)
 {
   Q_D(qMRMLSceneModel);
   Q_UNUSED(scene);
-  if (d->LazyUpdate)
+  // With BatchUpdate, the model is updated at the end of the batch process
+  if (d->LazyUpdate && !d->BatchUpdate)
     {
     this->updateScene();
     }
@@ -1409,7 +1686,10 @@ void qMRMLSceneModel::onMRMLSceneClosed(vtkMRMLScene* scene)
   Q_D(qMRMLSceneModel);
   Q_UNUSED(scene);
   //this->endResetModel();
-  if (d->LazyUpdate)
+  // The node removals are always deferred while closing (see
+  // isUpdateDeferred()). With BatchUpdate, the model is updated at the end of
+  // the batch process.
+  if (!d->BatchUpdate)
     {
     this->updateScene();
     }
@@ -1420,7 +1700,7 @@ void qMRMLSceneModel::onMRMLSceneStartBatchProcess(vtkMRMLScene* scene)
 {
   Q_D(qMRMLSceneModel);
   Q_UNUSED(scene);
-  if (d->LazyUpdate)
+  if (d->LazyUpdate || d->BatchUpdate)
     {
     emit sceneAboutToBeUpdated();
     }
@@ -1431,7 +1711,12 @@ void qMRMLSceneModel::onMRMLSceneEndBatchProcess(vtkMRMLScene* scene)
 {
   Q_D(qMRMLSceneModel);
   Q_UNUSED(scene);
-  if (d->LazyUpdate)
+  if (d->BatchUpdate)
+    {
+    d->resetScene();
+    emit sceneUpdated();
+    }
+  else if (d->LazyUpdate)
     {
     this->updateScene();
     emit sceneUpdated();
@@ -75,6 +75,24 @@ class QMRML_WIDGETS_EXPORT qMRMLSceneModel : public QStandardItemModel
   /// imported/restored.
   Q_PROPERTY (bool lazyUpdate READ lazyUpdate WRITE setLazyUpdate)
 
+  /// Control how the model synchronizes with the scene after a batch process
+  /// (import, close, restore...).
+  /// If BatchUpdate is true, the model ignores the added and removed nodes
+  /// while the scene is batch processing (as with LazyUpdate) and, at the end
+  /// of the batch process, repopulates itself within a unique model reset:
+  /// no rowsInserted()/rowsRemoved() signal is emitted for the nodes, the
+  /// views and proxy models are only updated once.
+  /// False by default.
+  Q_PROPERTY (bool batchUpdate READ batchUpdate WRITE setBatchUpdate)
+
+  /// Control whether the items of the child nodes are created on demand.
+  /// If LazyChildren is true, only the nodes at the scene level are
+  /// populated. The children of a node are added when they are fetched, e.g.
+  /// when a view expands the node. Until then, indexFromNode() and
+  /// itemFromNode() return no item for them.
+  /// False by default.
+  Q_PROPERTY (bool lazyChildren READ lazyChildren WRITE setLazyChildren)
+
   /// Control in which column vtkMRMLNode names are displayed (Qt::DisplayRole).
   /// A value of -1 hides it. First column (0) by default.
   /// If no property is set in a column, nothing is displayed.
@@ -116,6 +134,9 @@ public:
     /// Integer that contains the visibility property of a node.
     /// It is closely related to the item icon.
     VisibilityRole,
+    /// Boolean set on the node items whose children have been fetched
+    /// (only when lazyChildren is true).
+    ChildrenFetchedRole,
     /// Must stay the last enum in the list.
     LastRole
     };
@@ -152,6 +173,13 @@ public:
   bool lazyUpdate()const;
   void setLazyUpdate(bool lazy);
 
+  bool batchUpdate()const;
+  void setBatchUpdate(bool batch);
+
+  /// Resets the model when changed
+  bool lazyChildren()const;
+  void setLazyChildren(bool lazy);
+
   int nameColumn()const;
   void setNameColumn(int column);
 
@@ -187,6 +215,12 @@ public:
   virtual bool dropMimeData(const QMimeData *data, Qt::DropAction action,
                             int row, int column, const QModelIndex &parent);
 
+  /// Reimplemented to create the child node items on demand
+  /// \sa lazyChildren
+  virtual bool hasChildren(const QModelIndex& parent = QModelIndex())const;
+  virtual bool canFetchMore(const QModelIndex& parent)const;
+  virtual void fetchMore(const QModelIndex& parent);
+
   /// Returns the parent node of the scene, 0 otherwise (the parent is the
   /// scene).
   /// Must be reimplemented in derived classes. If reimplemented, you might
@@ -233,11 +267,17 @@ protected slots:
 
   void onMRMLSceneDeleted(vtkObject* scene);
 
-  void onMRMLNodeModified(vtkObject* node);
+  virtual void onMRMLNodeModified(vtkObject* node);
   /// The node has its ID changed. The scene model needs to update the UIDRole
   /// associated with the node in order to keep being in sync.
   void onMRMLNodeIDChanged(vtkObject* node, void* callData);
   void onItemChanged(QStandardItem * item);
+
+  /// Keep the node items index up to date
+  void onRowsInserted(const QModelIndex& parent, int first, int last);
+  void onRowsAboutToBeRemoved(const QModelIndex& parent, int first, int last);
+  void onColumnsAboutToBeRemoved(const QModelIndex& parent, int first, int last);
+  void onModelAboutToBeReset();
   void delayedItemChanged();
 
   /// Recompute the number of columns in the model.
@@ -24,6 +24,7 @@
 // Qt includes
 class QStandardItemModel;
 #include <QFlags>
+#include <QHash>
 
 // qMRML includes
 #include "qMRMLSceneModel.h"
@@ -48,7 +49,11 @@ public:
   virtual ~qMRMLSceneModelPrivate();
   void init();
 
-  QModelIndexList indexes(const QString& nodeID)const;
+  QModelIndexList indexes(vtkMRMLNode* node)const;
+  /// Add to (or remove from) NodeItems the nodes of the rows first to last
+  /// of parent and of their children.
+  void indexNodeItems(QStandardItem* parent, int first, int last);
+  void unindexNodeItems(QStandardItem* parent, int first, int last);
 
   QStringList extraItems(QStandardItem* parent, const QString& extraType)const;
   void insertExtraItem(int row, QStandardItem* parent,
@@ -57,11 +62,22 @@ public:
   void removeAllExtraItems(QStandardItem* parent, const QString extraType);
   bool isExtraItem(const QStandardItem* item)const;
   void listenNodeModifiedEvent();
+  /// True if the items of the children of parent exist (always true if
+  /// LazyChildren is false or parent is 0, i.e. the scene)
+  bool childrenFetched(vtkMRMLNode* parent)const;
+  /// True if the node added/removed events must be ignored because the
+  /// model is synchronized at the end of the scene batch process or, always,
+  /// when the scene is closed.
+  bool isUpdateDeferred()const;
+  /// Repopulate the model within a model reset
+  void resetScene();
   void reparentItems(QList<QStandardItem*>& children, int newIndex, QStandardItem* newParent);
 
   vtkSmartPointer<vtkCallbackCommand> CallBack;
   qMRMLSceneModel::NodeTypes ListenNodeModifiedEvent;
   bool LazyUpdate;
+  bool LazyChildren;
+  bool BatchUpdate;
   int PendingItemModified;
   
   int NameColumn;
@@ -82,6 +98,12 @@ public:
   // We keep a list of QStandardItem instead of vtkMRMLNode* because they are
   // likely to be unreachable when browsing the model
   QList<QList<QStandardItem*> > Orphans;
+  // Item of the first column of each node in the model. It is maintained
+  // from the rows inserted and removed, so that finding the item of a node
+  // doesn't browse the whole tree. Items are kept over QPersistentModelIndex
+  // as the latter are invalidated when the rows are reparented (taken and
+  // inserted again). The other columns are siblings of the first one.
+  QHash<vtkMRMLNode*, QStandardItem*> NodeItems;
 };
 
 #endif
@@ -273,6 +273,24 @@ void qMRMLScreenShotDialog::grabScreenShot()
 void qMRMLScreenShotDialog::grabScreenShot(int screenshotWindow)
 {
   Q_D(qMRMLScreenShotDialog);
+  QImage screenShot = ctk::grabVTKWidget(this->screenShotWidget(screenshotWindow));
+
+  // Rescale the image which gets saved
+  QImage rescaledScreenShot = screenShot.scaled(screenShot.size().width()
+      * d->scaleFactorSpinBox->value(), screenShot.size().height()
+      * d->scaleFactorSpinBox->value());
+
+  // convert the screenshot from QPixmap to vtkImageData and store it with this class
+  vtkNew<vtkImageData> newImageData;
+  qMRMLUtils::qImageToVtkImageData(rescaledScreenShot,
+                                   newImageData.GetPointer());
+  this->setImageData(newImageData.GetPointer());
+}
+
+//-----------------------------------------------------------------------------
+QWidget* qMRMLScreenShotDialog::screenShotWidget(int screenshotWindow)const
+{
+  Q_D(const qMRMLScreenShotDialog);
   QWidget* widget = 0;
   switch (screenshotWindow)
     {
@@ -293,23 +311,11 @@ void qMRMLScreenShotDialog::grabScreenShot(int screenshotWindow)
       widget = d->LayoutManager.data()->viewport();
       break;
     }
-
-  QImage screenShot = ctk::grabVTKWidget(widget);
-
-  // Rescale the image which gets saved
-  QImage rescaledScreenShot = screenShot.scaled(screenShot.size().width()
-      * d->scaleFactorSpinBox->value(), screenShot.size().height()
-      * d->scaleFactorSpinBox->value());
-
-  // convert the screenshot from QPixmap to vtkImageData and store it with this class
-  vtkNew<vtkImageData> newImageData;
-  qMRMLUtils::qImageToVtkImageData(rescaledScreenShot,
-                                   newImageData.GetPointer());
-  this->setImageData(newImageData.GetPointer());
+  return widget;
 }
 
 //-----------------------------------------------------------------------------
-QString qMRMLScreenShotDialog::enumToString(int type)
+QString qMRMLScreenShotDialog::enumToString(int type)const
 {
   int propIndex = this->metaObject()->indexOfProperty("widgetType");
   QMetaProperty widgetTypeProperty = this->metaObject()->property(propIndex);
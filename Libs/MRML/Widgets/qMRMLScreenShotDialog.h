@@ -88,12 +88,16 @@ public:
   /// a ThreeDView
   void grabScreenShot(int screenshotWindow);
 
+  /// Return the widget captured for \a screenshotWindow, a WidgetType.
+  /// \sa qMRMLScreenShotRecorder::setWidget()
+  QWidget* screenShotWidget(int screenshotWindow)const;
+
 protected slots:
 
   void grabScreenShot();
 
 private:
-  QString enumToString(int type);
+  QString enumToString(int type)const;
 
 protected:
   QScopedPointer<qMRMLScreenShotDialogPrivate> d_ptr;
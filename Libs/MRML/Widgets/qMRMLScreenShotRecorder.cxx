@@ -0,0 +1,256 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Copyright (c) Kitware Inc.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  This file was originally developed by Julien Finet, Kitware Inc.
+  and was partially funded by NIH grant 3P41RR013218-12S1
+
+==============================================================================*/
+
+// Qt includes
+#include <QDebug>
+#include <QFuture>
+#include <QImage>
+#include <QList>
+#include <QPointer>
+#include <QThreadPool>
+#include <QWidget>
+#include <QtConcurrentRun>
+
+// CTK includes
+#include <ctkVTKWidgetsUtils.h>
+
+// qMRML includes
+#include "qMRMLScreenShotRecorder.h"
+
+namespace
+{
+//-----------------------------------------------------------------------------
+bool writeFrame(QImage image, QString fileName, double scaleFactor, int quality)
+{
+  if (scaleFactor != 1.)
+    {
+    image = image.scaled(image.size().width() * scaleFactor,
+                         image.size().height() * scaleFactor);
+    }
+  return image.save(fileName, 0, quality);
+}
+}
+
+//-----------------------------------------------------------------------------
+class qMRMLScreenShotRecorderPrivate
+{
+  Q_DECLARE_PUBLIC(qMRMLScreenShotRecorder);
+protected:
+  qMRMLScreenShotRecorder* const q_ptr;
+public:
+  qMRMLScreenShotRecorderPrivate(qMRMLScreenShotRecorder& object);
+
+  /// Remove the written frames from the front of the queue and wait for
+  /// the oldest ones until at most \a maximum frames are pending.
+  void waitForPendingFrames(int maximum);
+
+  QPointer<QWidget> Widget;
+  QString FilePattern;
+  double ScaleFactor;
+  int Quality;
+  int MaximumPendingFrames;
+  int FrameCount;
+  bool Failed;
+  QList<QFuture<bool> > PendingFrames;
+};
+
+//-----------------------------------------------------------------------------
+// qMRMLScreenShotRecorderPrivate methods
+
+//-----------------------------------------------------------------------------
+qMRMLScreenShotRecorderPrivate::qMRMLScreenShotRecorderPrivate(qMRMLScreenShotRecorder& object)
+  : q_ptr(&object)
+{
+  this->ScaleFactor = 1.;
+  this->Quality = -1;
+  this->MaximumPendingFrames = 2 * QThreadPool::globalInstance()->maxThreadCount();
+  this->FrameCount = 0;
+  this->Failed = false;
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLScreenShotRecorderPrivate::waitForPendingFrames(int maximum)
+{
+  while (!this->PendingFrames.isEmpty() &&
+         (this->PendingFrames.count() > maximum ||
+          this->PendingFrames.first().isFinished()))
+    {
+    // result() waits for the frame to be written
+    if (!this->PendingFrames.takeFirst().result())
+      {
+      this->Failed = true;
+      }
+    }
+}
+
+//-----------------------------------------------------------------------------
+// qMRMLScreenShotRecorder methods
+
+//-----------------------------------------------------------------------------
+qMRMLScreenShotRecorder::qMRMLScreenShotRecorder(QObject* parentObject)
+  : Superclass(parentObject)
+  , d_ptr(new qMRMLScreenShotRecorderPrivate(*this))
+{
+}
+
+//-----------------------------------------------------------------------------
+qMRMLScreenShotRecorder::~qMRMLScreenShotRecorder()
+{
+  Q_D(qMRMLScreenShotRecorder);
+  d->waitForPendingFrames(0);
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLScreenShotRecorder::setWidget(QWidget* newWidget)
+{
+  Q_D(qMRMLScreenShotRecorder);
+  d->Widget = newWidget;
+}
+
+//-----------------------------------------------------------------------------
+QWidget* qMRMLScreenShotRecorder::widget()const
+{
+  Q_D(const qMRMLScreenShotRecorder);
+  return d->Widget;
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLScreenShotRecorder::setFilePattern(const QString& pattern)
+{
+  Q_D(qMRMLScreenShotRecorder);
+  d->FilePattern = pattern;
+}
+
+//-----------------------------------------------------------------------------
+QString qMRMLScreenShotRecorder::filePattern()const
+{
+  Q_D(const qMRMLScreenShotRecorder);
+  return d->FilePattern;
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLScreenShotRecorder::setScaleFactor(double scaleFactor)
+{
+  Q_D(qMRMLScreenShotRecorder);
+  d->ScaleFactor = scaleFactor;
+}
+
+//-----------------------------------------------------------------------------
+double qMRMLScreenShotRecorder::scaleFactor()const
+{
+  Q_D(const qMRMLScreenShotRecorder);
+  return d->ScaleFactor;
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLScreenShotRecorder::setQuality(int quality)
+{
+  Q_D(qMRMLScreenShotRecorder);
+  d->Quality = qBound(-1, quality, 100);
+}
+
+//-----------------------------------------------------------------------------
+int qMRMLScreenShotRecorder::quality()const
+{
+  Q_D(const qMRMLScreenShotRecorder);
+  return d->Quality;
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLScreenShotRecorder::setMaximumPendingFrames(int maximum)
+{
+  Q_D(qMRMLScreenShotRecorder);
+  d->MaximumPendingFrames = qMax(1, maximum);
+}
+
+//-----------------------------------------------------------------------------
+int qMRMLScreenShotRecorder::maximumPendingFrames()const
+{
+  Q_D(const qMRMLScreenShotRecorder);
+  return d->MaximumPendingFrames;
+}
+
+//-----------------------------------------------------------------------------
+int qMRMLScreenShotRecorder::frameCount()const
+{
+  Q_D(const qMRMLScreenShotRecorder);
+  return d->FrameCount;
+}
+
+//-----------------------------------------------------------------------------
+int qMRMLScreenShotRecorder::pendingFrameCount()const
+{
+  Q_D(const qMRMLScreenShotRecorder);
+  int pendingFrames = 0;
+  foreach(const QFuture<bool>& frame, d->PendingFrames)
+    {
+    pendingFrames += frame.isFinished() ? 0 : 1;
+    }
+  return pendingFrames;
+}
+
+//-----------------------------------------------------------------------------
+QString qMRMLScreenShotRecorder::frameFileName(int frame)const
+{
+  Q_D(const qMRMLScreenShotRecorder);
+  return d->FilePattern.arg(frame, 5, 10, QChar('0'));
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLScreenShotRecorder::captureFrame()
+{
+  Q_D(qMRMLScreenShotRecorder);
+  if (!d->Widget)
+    {
+    qWarning() << "qMRMLScreenShotRecorder::captureFrame: no widget to capture";
+    return;
+    }
+  this->addFrame(ctk::grabVTKWidget(d->Widget));
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLScreenShotRecorder::addFrame(const QImage& image)
+{
+  Q_D(qMRMLScreenShotRecorder);
+  if (d->FilePattern.isEmpty())
+    {
+    qWarning() << "qMRMLScreenShotRecorder::addFrame: no file pattern";
+    return;
+    }
+  // Make room in the queue, the images of the pending frames are kept in
+  // memory until they are written
+  d->waitForPendingFrames(d->MaximumPendingFrames - 1);
+  // QImage is implicitly shared, the worker thread doesn't copy the pixels
+  d->PendingFrames << QtConcurrent::run(writeFrame, image,
+                                        this->frameFileName(d->FrameCount),
+                                        d->ScaleFactor, d->Quality);
+  ++d->FrameCount;
+}
+
+//-----------------------------------------------------------------------------
+bool qMRMLScreenShotRecorder::finish()
+{
+  Q_D(qMRMLScreenShotRecorder);
+  d->waitForPendingFrames(0);
+  bool written = !d->Failed;
+  d->Failed = false;
+  d->FrameCount = 0;
+  return written;
+}
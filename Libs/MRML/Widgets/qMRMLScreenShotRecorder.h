@@ -0,0 +1,120 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  Copyright (c) Kitware Inc.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  This file was originally developed by Julien Finet, Kitware Inc.
+  and was partially funded by NIH grant 3P41RR013218-12S1
+
+==============================================================================*/
+
+#ifndef __qMRMLScreenShotRecorder_h
+#define __qMRMLScreenShotRecorder_h
+
+// Qt includes
+#include <QImage>
+#include <QObject>
+
+// CTK includes
+#include <ctkPimpl.h>
+
+#include "qMRMLWidgetsExport.h"
+
+class qMRMLScreenShotRecorderPrivate;
+
+/// \brief Record the frames of a view into an image sequence.
+///
+/// Each captureFrame() reads the view back in the main thread, the frame is
+/// then scaled and encoded in a worker thread of the global QThreadPool.
+/// At most maximumPendingFrames frames wait to be written: capturing
+/// blocks once the queue is full until the oldest frame is written.
+/// A movie of a slice sweep or a 3D rotation is recorded by capturing a
+/// frame after each render:
+/// \code
+/// recorder.setWidget(layoutManager->threeDWidget(0)->threeDView());
+/// recorder.setFilePattern("/tmp/rotation_%1.png");
+/// for (int i = 0; i < 360; ++i)
+///   {
+///   view->yaw(); // renders the view
+///   recorder.captureFrame();
+///   }
+/// bool written = recorder.finish();
+/// \endcode
+/// \sa qMRMLScreenShotDialog::screenShotWidget()
+class QMRML_WIDGETS_EXPORT qMRMLScreenShotRecorder : public QObject
+{
+  Q_OBJECT
+  /// File name of the frames, "%1" is replaced by the frame number padded
+  /// with zeros to 5 digits. The suffix sets the format (png, jpg...).
+  Q_PROPERTY(QString filePattern READ filePattern WRITE setFilePattern)
+  /// Scale applied to the frames before they are written, 1. by default.
+  Q_PROPERTY(double scaleFactor READ scaleFactor WRITE setScaleFactor)
+  /// Quality of the encoding, from 0 to 100, -1 (default) for the default
+  /// quality of the format. \sa QImage::save()
+  Q_PROPERTY(int quality READ quality WRITE setQuality)
+  /// Maximum number of frames waiting to be written, twice the number of
+  /// threads of the global thread pool by default.
+  Q_PROPERTY(int maximumPendingFrames READ maximumPendingFrames WRITE setMaximumPendingFrames)
+  /// Number of frames captured since the last finish().
+  Q_PROPERTY(int frameCount READ frameCount)
+public:
+  typedef QObject Superclass;
+  explicit qMRMLScreenShotRecorder(QObject* parent = 0);
+  /// Wait for the pending frames to be written
+  virtual ~qMRMLScreenShotRecorder();
+
+  /// View captured by captureFrame(), a VTK view or a widget that contains
+  /// VTK views such as the layout viewport.
+  void setWidget(QWidget* widget);
+  QWidget* widget()const;
+
+  void setFilePattern(const QString& pattern);
+  QString filePattern()const;
+
+  void setScaleFactor(double scaleFactor);
+  double scaleFactor()const;
+
+  void setQuality(int quality);
+  int quality()const;
+
+  void setMaximumPendingFrames(int maximum);
+  int maximumPendingFrames()const;
+
+  int frameCount()const;
+
+  /// Number of frames queued or being written
+  Q_INVOKABLE int pendingFrameCount()const;
+
+  /// File name of the frame \a frame
+  Q_INVOKABLE QString frameFileName(int frame)const;
+
+public slots:
+  /// Read the widget back and queue the frame.
+  void captureFrame();
+
+  /// Queue an image already read back.
+  void addFrame(const QImage& image);
+
+  /// Wait for all the frames to be written and restart the numbering.
+  /// Return false if any frame since the last finish() failed to be written.
+  bool finish();
+
+protected:
+  QScopedPointer<qMRMLScreenShotRecorderPrivate> d_ptr;
+
+private:
+  Q_DECLARE_PRIVATE(qMRMLScreenShotRecorder);
+  Q_DISABLE_COPY(qMRMLScreenShotRecorder);
+};
+
+#endif
@@ -173,8 +173,8 @@ void qMRMLSliceViewPrivate::initDisplayableManagers()
     = factory->InstantiateDisplayableManagers(
       q->lightBoxRendererManager()->GetRenderer(0));
   // Observe displayable manager group to catch RequestRender events
-  q->qvtkConnect(this->DisplayableManagerGroup, vtkCommand::UpdateEvent,
-                 q, SLOT(scheduleRender()));
+  this->qvtkConnect(this->DisplayableManagerGroup, vtkCommand::UpdateEvent,
+                    this, SLOT(requestRender()));
 
   // pass the lightbox manager proxy onto the display managers
   this->DisplayableManagerGroup->SetLightBoxRendererManagerProxy(this->LightBoxRendererManagerProxy);
@@ -234,6 +234,20 @@ void qMRMLSliceViewPrivate::updateWidgetFromMRML()
   q->lightBoxRendererManager()->SetHighlighted(0, 0, displayLightboxBorders);
 }
 
+// --------------------------------------------------------------------------
+void qMRMLSliceViewPrivate::requestRender()
+{
+  Q_Q(qMRMLSliceView);
+  if (this->RenderScheduler)
+    {
+    this->RenderScheduler->requestRender(q);
+    }
+  else
+    {
+    q->scheduleRender();
+    }
+}
+
 // --------------------------------------------------------------------------
 // qMRMLSliceView methods
 
@@ -294,6 +308,32 @@ void qMRMLSliceView::setMRMLSliceNode(vtkMRMLSliceNode* newSliceNode)
   this->setEnabled(newSliceNode != 0);
 }
 
+//---------------------------------------------------------------------------
+void qMRMLSliceView::setRenderScheduler(qMRMLRenderScheduler* scheduler)
+{
+  Q_D(qMRMLSliceView);
+  if (d->RenderScheduler == scheduler)
+    {
+    return;
+    }
+  if (d->RenderScheduler)
+    {
+    d->RenderScheduler->removeView(this);
+    }
+  d->RenderScheduler = scheduler;
+  if (scheduler)
+    {
+    scheduler->addView(this);
+    }
+}
+
+//---------------------------------------------------------------------------
+qMRMLRenderScheduler* qMRMLSliceView::renderScheduler()const
+{
+  Q_D(const qMRMLSliceView);
+  return d->RenderScheduler;
+}
+
 //---------------------------------------------------------------------------
 vtkMRMLSliceNode* qMRMLSliceView::mrmlSliceNode()const
 {
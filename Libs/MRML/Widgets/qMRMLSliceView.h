@@ -27,6 +27,7 @@
 // MRML includes
 #include "qMRMLWidgetsExport.h"
 
+class qMRMLRenderScheduler;
 class qMRMLSliceViewPrivate;
 class vtkMRMLScene;
 class vtkMRMLSliceNode;
@@ -65,6 +66,13 @@ public:
   /// Returns the interactor style of the view
   vtkSliceViewInteractorStyle* sliceViewInteractorStyle()const;
 
+  /// Render requests of the displayable managers are coalesced by
+  /// \a scheduler with the requests of the other views, 0 by default: the
+  /// view schedules its own renders.
+  /// \sa qMRMLRenderScheduler, qMRMLLayoutManager::renderScheduler()
+  void setRenderScheduler(qMRMLRenderScheduler* scheduler);
+  qMRMLRenderScheduler* renderScheduler()const;
+
   /// Convert device coordinates to XYZ coordinates. The x and y
   /// components of the return value are the positions within a
   /// LightBox pane and the z component of the return value (rounded
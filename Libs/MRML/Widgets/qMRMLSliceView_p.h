@@ -21,10 +21,14 @@
 #ifndef __qMRMLSliceView_p_h
 #define __qMRMLSliceView_p_h
 
+// Qt includes
+#include <QPointer>
+
 // CTK includes
 #include <ctkVTKObject.h>
 
 // qMRML includes
+#include "qMRMLRenderScheduler.h"
 #include "qMRMLSliceView.h"
 
 // MRML includes
@@ -63,10 +67,14 @@ public slots:
 
   void updateWidgetFromMRML();
 
+  /// Render through the render scheduler if any
+  void requestRender();
+
 protected:
   void initDisplayableManagers();
 
   vtkMRMLDisplayableManagerGroup*    DisplayableManagerGroup;
+  QPointer<qMRMLRenderScheduler>     RenderScheduler;
   vtkMRMLScene*                      MRMLScene;
   vtkMRMLSliceNode*                  MRMLSliceNode;
   QColor                             InactiveBoxColor;
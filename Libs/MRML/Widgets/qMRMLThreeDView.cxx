@@ -128,7 +128,7 @@ void qMRMLThreeDViewPrivate::initDisplayableManagers()
     = factory->InstantiateDisplayableManagers(q->renderer());
   // Observe displayable manager group to catch RequestRender events
   this->qvtkConnect(this->DisplayableManagerGroup, vtkCommand::UpdateEvent,
-                    q, SLOT(scheduleRender()));
+                    this, SLOT(requestRender()));
 }
 
 //---------------------------------------------------------------------------
@@ -214,6 +214,20 @@ void qMRMLThreeDViewPrivate::updateWidgetFromMRML()
   q->setFPSVisible(this->MRMLViewNode->GetFPSVisible() != 0);
 }
 
+// --------------------------------------------------------------------------
+void qMRMLThreeDViewPrivate::requestRender()
+{
+  Q_Q(qMRMLThreeDView);
+  if (this->RenderScheduler)
+    {
+    this->RenderScheduler->requestRender(q);
+    }
+  else
+    {
+    q->scheduleRender();
+    }
+}
+
 // --------------------------------------------------------------------------
 // qMRMLThreeDView methods
 
@@ -274,6 +288,32 @@ void qMRMLThreeDView::setMRMLViewNode(vtkMRMLViewNode* newViewNode)
   this->setEnabled(newViewNode != 0);
 }
 
+//---------------------------------------------------------------------------
+void qMRMLThreeDView::setRenderScheduler(qMRMLRenderScheduler* scheduler)
+{
+  Q_D(qMRMLThreeDView);
+  if (d->RenderScheduler == scheduler)
+    {
+    return;
+    }
+  if (d->RenderScheduler)
+    {
+    d->RenderScheduler->removeView(this);
+    }
+  d->RenderScheduler = scheduler;
+  if (scheduler)
+    {
+    scheduler->addView(this);
+    }
+}
+
+//---------------------------------------------------------------------------
+qMRMLRenderScheduler* qMRMLThreeDView::renderScheduler()const
+{
+  Q_D(const qMRMLThreeDView);
+  return d->RenderScheduler;
+}
+
 //---------------------------------------------------------------------------
 vtkMRMLViewNode* qMRMLThreeDView::mrmlViewNode()const
 {
@@ -27,6 +27,7 @@
 
 #include "qMRMLWidgetsExport.h"
 
+class qMRMLRenderScheduler;
 class qMRMLThreeDViewPrivate;
 class vtkMRMLScene;
 class vtkMRMLViewNode;
@@ -63,6 +64,13 @@ public:
   /// Returns the interactor style of the view
   //vtkInteractorObserver* interactorStyle()const;
 
+  /// Render requests of the displayable managers are coalesced by
+  /// \a scheduler with the requests of the other views, 0 by default: the
+  /// view schedules its own renders.
+  /// \sa qMRMLRenderScheduler, qMRMLLayoutManager::renderScheduler()
+  void setRenderScheduler(qMRMLRenderScheduler* scheduler);
+  qMRMLRenderScheduler* renderScheduler()const;
+
 public slots:
 
   /// Set the MRML \a scene that should be listened for events
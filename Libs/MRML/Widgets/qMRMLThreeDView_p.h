@@ -22,6 +22,7 @@
 #define __qMRMLThreeDView_p_h
 
 // Qt includes
+#include <QPointer>
 class QToolButton;
 
 // CTK includes
@@ -30,6 +31,7 @@ class QToolButton;
 class ctkPopupWidget;
 
 // qMRML includes
+#include "qMRMLRenderScheduler.h"
 #include "qMRMLThreeDView.h"
 
 class vtkMRMLDisplayableManagerGroup;
@@ -64,10 +66,14 @@ public slots:
 
   void updateWidgetFromMRML();
 
+  /// Render through the render scheduler if any
+  void requestRender();
+
 protected:
   void initDisplayableManagers();
 
   vtkMRMLDisplayableManagerGroup*    DisplayableManagerGroup;
+  QPointer<qMRMLRenderScheduler>     RenderScheduler;
   vtkMRMLScene*                      MRMLScene;
   vtkMRMLViewNode*                   MRMLViewNode;
   
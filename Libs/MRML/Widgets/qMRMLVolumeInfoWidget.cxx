@@ -320,7 +320,14 @@ void qMRMLVolumeInfoWidget::updateWidgetFromMRML()
     d->MinScalarDoubleSpinBox->setRange(typeRange[0], typeRange[1]);
     d->MaxScalarDoubleSpinBox->setRange(typeRange[0], typeRange[1]);
 
-    double* scalarRange = image->GetScalarRange();
+    // the range of scalar volumes is cached by the volume node
+    double scalarRange[2];
+    vtkMRMLScalarVolumeNode* scalarVolumeNode =
+      vtkMRMLScalarVolumeNode::SafeDownCast(d->VolumeNode);
+    if (!scalarVolumeNode || !scalarVolumeNode->GetImageScalarRange(scalarRange))
+      {
+      image->GetScalarRange(scalarRange);
+      }
     d->MinScalarDoubleSpinBox->setValue(scalarRange[0]);
     d->MaxScalarDoubleSpinBox->setValue(scalarRange[1]);
     }
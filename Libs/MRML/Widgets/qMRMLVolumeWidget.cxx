@@ -175,11 +175,7 @@ void qMRMLVolumeWidgetPrivate
     {
     dNode->GetDisplayScalarRange(range);
     }
-  else if (this->VolumeNode->GetImageData())
-    {
-    this->VolumeNode->GetImageData()->GetScalarRange(range);
-    }
-  else
+  else if (!this->VolumeNode->GetImageScalarRange(range))
     {
     range[0] = 0.;
     range[1] = 0.;
@@ -66,6 +66,14 @@ void vtkHIDHandler::PrintSelf(ostream& os, vtkIndent indent)
   Superclass::PrintSelf ( os, indent );
 }
 
+//----------------------------------------------------------------------------
+void vtkHIDHandler::StageFilesRead(vtkStringArray *sources,
+                                  vtkStringArray *destinations)
+{
+  // the transfers use the shared CurlHandle
+  this->vtkURIHandler::StageFilesRead(sources, destinations);
+}
+
 //----------------------------------------------------------------------------
 void vtkHIDHandler::StageFileRead(const char * source,
                                   const char *destination)
@@ -1,5 +1,42 @@
 #include "vtkHTTPHandler.h"
 #include <vtkPermissionPrompter.h>
+#include <vtkStringArray.h>
+
+// VTKsys includes
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+/// State of a file downloaded by vtkHTTPHandler::StageFilesRead().
+struct vtkHTTPDownload
+{
+  std::string Source;
+  std::string Destination;
+  std::string Host;
+  FILE* File;
+  int Retries;
+  bool Restart;
+};
+
+//----------------------------------------------------------------------------
+std::string hostFromURI(const std::string& uri)
+{
+  std::string::size_type start = uri.find("://");
+  start = (start == std::string::npos) ? 0 : start + 3;
+  std::string::size_type end = uri.find('/', start);
+  return uri.substr(start, end == std::string::npos ? end : end - start);
+}
+
+}
 
 //----------------------------------------------------------------------------
 vtkStandardNewMacro ( vtkHTTPHandler );
@@ -55,6 +92,11 @@ vtkHTTPHandler::vtkHTTPHandler()
 {
   this->CurlHandle = NULL;
   this->ForbidReuse = 0;
+  this->MaximumConnections = 8;
+  this->MaximumConnectionsPerHost = 4;
+  this->MaximumRetries = 3;
+  // curl_global_init is not thread safe, StageFilesRead doesn't call it.
+  curl_global_init(CURL_GLOBAL_ALL);
 }
 
 
@@ -69,6 +111,10 @@ vtkHTTPHandler::~vtkHTTPHandler()
 void vtkHTTPHandler::PrintSelf(ostream& os, vtkIndent indent)
 {
   Superclass::PrintSelf ( os, indent );
+  os << indent << "ForbidReuse: " << this->ForbidReuse << "\n";
+  os << indent << "MaximumConnections: " << this->MaximumConnections << "\n";
+  os << indent << "MaximumConnectionsPerHost: " << this->MaximumConnectionsPerHost << "\n";
+  os << indent << "MaximumRetries: " << this->MaximumRetries << "\n";
 }
 
 
@@ -139,56 +185,234 @@ void vtkHTTPHandler::StageFileRead(const char * source, const char * destination
     vtkErrorMacro("StageFileRead: source or dest is null!");
     return;
     }
-  /*
-  if (this->LocalFile)
+  vtkStringArray* sources = vtkStringArray::New();
+  sources->InsertNextValue(source);
+  vtkStringArray* destinations = vtkStringArray::New();
+  destinations->InsertNextValue(destination);
+  this->vtkHTTPHandler::StageFilesRead(sources, destinations);
+  sources->Delete();
+  destinations->Delete();
+}
+
+//----------------------------------------------------------------------------
+void vtkHTTPHandler::StageFilesRead(vtkStringArray *sources,
+                                    vtkStringArray *destinations)
+{
+  if (sources == NULL || destinations == NULL ||
+      sources->GetNumberOfValues() != destinations->GetNumberOfValues())
     {
-    this->LocalFile->close();
-    delete this->LocalFile;
-    this->LocalFile = NULL;
+    vtkErrorMacro("StageFilesRead: sources and destinations don't match");
+    return;
     }
-  this->LocalFile = new std::ofstream(destination, std::ios::binary);
-  */
-  this->InitTransfer( );
-
-
-  if ( this->ForbidReuse )
+  std::vector<vtkHTTPDownload> downloads(sources->GetNumberOfValues());
+  std::deque<size_t> pending;
+  for (size_t i = 0; i < downloads.size(); ++i)
     {
-    curl_easy_setopt(this->CurlHandle, CURLOPT_FORBID_REUSE, 1);
+    downloads[i].Source = sources->GetValue(i);
+    downloads[i].Destination = destinations->GetValue(i);
+    downloads[i].Host = hostFromURI(downloads[i].Source);
+    downloads[i].File = NULL;
+    downloads[i].Retries = 0;
+    downloads[i].Restart = true;
+    pending.push_back(i);
+    }
+  if (downloads.empty())
+    {
+    return;
     }
-  curl_easy_setopt(this->CurlHandle, CURLOPT_HTTPGET, 1);
-  curl_easy_setopt(this->CurlHandle, CURLOPT_URL, source);
-//  curl_easy_setopt(this->CurlHandle, CURLOPT_NOPROGRESS, false);
-  curl_easy_setopt(this->CurlHandle, CURLOPT_FOLLOWLOCATION, true);
-  // use the default curl write call back
-  curl_easy_setopt(this->CurlHandle, CURLOPT_WRITEFUNCTION, NULL); // write_callback);
-  this->LocalFile = fopen(destination, "wb");
-  // output goes into LocalFile, must be  FILE*
-  curl_easy_setopt(this->CurlHandle, CURLOPT_WRITEDATA, this->LocalFile);
-//  curl_easy_setopt(this->CurlHandle, CURLOPT_PROGRESSDATA, NULL);
-//  curl_easy_setopt(this->CurlHandle, CURLOPT_PROGRESSFUNCTION, ProgressCallback);
 
-  // quick timeout during connection phase if URL is not accessible (e.g. blocked by a firewall)
-  curl_easy_setopt(this->CurlHandle, CURLOPT_CONNECTTIMEOUT, 3); // in seconds (type long)
+  CURLM* multiHandle = curl_multi_init();
+  if (multiHandle == NULL)
+    {
+    vtkErrorMacro("StageFilesRead: unable to initialise");
+    return;
+    }
+  const int maximumConnections = std::max(this->MaximumConnections, 1);
+  const int maximumConnectionsPerHost =
+    std::max(this->MaximumConnectionsPerHost, 1);
+
+  // The easy handles are reused once their download is done so that the
+  // connections are kept alive for the next files of the same host.
+  std::vector<CURL*> easyHandles;
+  std::vector<CURL*> idleHandles;
+  std::map<CURL*, size_t> running;
+  std::map<std::string, int> hostConnections;
+  int errors = 0;
+
+  while (!pending.empty() || !running.empty())
+    {
+    // Start the pending downloads within the connection limits.
+    for (std::deque<size_t>::iterator it = pending.begin();
+         it != pending.end() &&
+           static_cast<int>(running.size()) < maximumConnections;)
+      {
+      vtkHTTPDownload& download = downloads[*it];
+      if (hostConnections[download.Host] >= maximumConnectionsPerHost)
+        {
+        ++it;
+        continue;
+        }
+      // A failed download resumes after the bytes already written.
+      // A restarted one replaces the file: it may share its content with
+      // other cached files.
+      if (download.Restart)
+        {
+        vtksys::SystemTools::RemoveFile(download.Destination.c_str());
+        }
+      download.File = fopen(download.Destination.c_str(),
+                            download.Restart ? "wb" : "ab");
+      if (download.File == NULL)
+        {
+        vtkErrorMacro("StageFilesRead: can't open " << download.Destination);
+        ++errors;
+        it = pending.erase(it);
+        continue;
+        }
+      fseek(download.File, 0, SEEK_END);
+      long offset = ftell(download.File);
+      CURL* easyHandle = NULL;
+      if (!idleHandles.empty())
+        {
+        easyHandle = idleHandles.back();
+        idleHandles.pop_back();
+        }
+      else
+        {
+        easyHandle = curl_easy_init();
+        if (easyHandle == NULL)
+          {
+          vtkErrorMacro("StageFilesRead: unable to initialise a transfer");
+          fclose(download.File);
+          download.File = NULL;
+          break;
+          }
+        easyHandles.push_back(easyHandle);
+        }
+      if ( this->ForbidReuse )
+        {
+        curl_easy_setopt(easyHandle, CURLOPT_FORBID_REUSE, 1);
+        }
+      curl_easy_setopt(easyHandle, CURLOPT_HTTPGET, 1);
+      curl_easy_setopt(easyHandle, CURLOPT_URL, download.Source.c_str());
+      curl_easy_setopt(easyHandle, CURLOPT_FOLLOWLOCATION, true);
+      // don't write error pages into the destination
+      curl_easy_setopt(easyHandle, CURLOPT_FAILONERROR, 1);
+      curl_easy_setopt(easyHandle, CURLOPT_WRITEFUNCTION, write_callback);
+      curl_easy_setopt(easyHandle, CURLOPT_WRITEDATA, download.File);
+      curl_easy_setopt(easyHandle, CURLOPT_RESUME_FROM_LARGE,
+                       static_cast<curl_off_t>(offset));
+      // quick timeout during connection phase if URL is not accessible (e.g. blocked by a firewall)
+      curl_easy_setopt(easyHandle, CURLOPT_CONNECTTIMEOUT, 3); // in seconds (type long)
+      curl_multi_add_handle(multiHandle, easyHandle);
+      running[easyHandle] = *it;
+      ++hostConnections[download.Host];
+      vtkDebugMacro("StageFilesRead: start downloading " << download.Source
+                    << " to " << download.Destination << " from byte " << offset);
+      it = pending.erase(it);
+      }
+    if (running.empty())
+      {
+      // nothing could be started
+      errors += static_cast<int>(pending.size());
+      break;
+      }
 
-  vtkDebugMacro("StageFileRead: about to do the curl download... source = " << source << ", dest = " << destination);
-  CURLcode retval = curl_easy_perform(this->CurlHandle);
+    // Transfer data until a download is done.
+    int stillRunning = 0;
+    while (curl_multi_perform(multiHandle, &stillRunning) ==
+           CURLM_CALL_MULTI_PERFORM)
+      {
+      }
+    if (stillRunning == static_cast<int>(running.size()))
+      {
+      fd_set readSet, writeSet, errorSet;
+      FD_ZERO(&readSet);
+      FD_ZERO(&writeSet);
+      FD_ZERO(&errorSet);
+      int maxFD = -1;
+      long timeout = -1;
+      curl_multi_timeout(multiHandle, &timeout);
+      if (timeout < 0 || timeout > 100)
+        {
+        timeout = 100;
+        }
+      struct timeval wait;
+      wait.tv_sec = 0;
+      wait.tv_usec = timeout * 1000;
+      curl_multi_fdset(multiHandle, &readSet, &writeSet, &errorSet, &maxFD);
+      if (maxFD >= 0)
+        {
+        select(maxFD + 1, &readSet, &writeSet, &errorSet, &wait);
+        }
+      else
+        {
+        // curl is waiting for something (e.g. a name resolution)
+        vtksys::SystemTools::Delay(timeout);
+        }
+      }
 
-  if (retval == CURLE_OK)
-    {
-    vtkDebugMacro("StageFileRead: successful return from curl");
+    // Handle the finished downloads.
+    int messages = 0;
+    CURLMsg* message = NULL;
+    while ((message = curl_multi_info_read(multiHandle, &messages)) != NULL)
+      {
+      if (message->msg != CURLMSG_DONE)
+        {
+        continue;
+        }
+      CURL* easyHandle = message->easy_handle;
+      CURLcode retval = message->data.result;
+      long responseCode = 0;
+      curl_easy_getinfo(easyHandle, CURLINFO_RESPONSE_CODE, &responseCode);
+      curl_multi_remove_handle(multiHandle, easyHandle);
+      idleHandles.push_back(easyHandle);
+
+      vtkHTTPDownload& download = downloads[running[easyHandle]];
+      running.erase(easyHandle);
+      --hostConnections[download.Host];
+      fclose(download.File);
+      download.File = NULL;
+
+      if (retval == CURLE_OK)
+        {
+        vtkDebugMacro("StageFilesRead: successful return from curl for " << download.Source);
+        vtkIdType index = static_cast<vtkIdType>(&download - &downloads[0]);
+        this->InvokeEvent(vtkURIHandler::FileStagedEvent, &index);
+        continue;
+        }
+      if (download.Retries < this->MaximumRetries)
+        {
+        // Resume unless the server doesn't support range requests or
+        // can't satisfy the range.
+        ++download.Retries;
+        download.Restart = (retval == CURLE_RANGE_ERROR) ||
+                           (responseCode == 416);
+        vtkDebugMacro("StageFilesRead: retrying " << download.Source
+                      << " after error: " << curl_easy_strerror(retval));
+        pending.push_back(static_cast<size_t>(&download - &downloads[0]));
+        continue;
+        }
+      ++errors;
+      const char *stringError = curl_easy_strerror(retval);
+      vtkErrorMacro("StageFilesRead: error running curl on " << download.Source
+                    << ": " << stringError);
+      }
     }
-  else if (retval == CURLE_BAD_FUNCTION_ARGUMENT)
+
+  for (std::map<CURL*, size_t>::iterator it = running.begin();
+       it != running.end(); ++it)
     {
-    vtkErrorMacro("StageFileRead: bad function argument to curl, did you init CurlHandle?");
+    curl_multi_remove_handle(multiHandle, it->first);
+    fclose(downloads[it->second].File);
     }
-  else if (retval == CURLE_OUT_OF_MEMORY)
+  for (size_t i = 0; i < easyHandles.size(); ++i)
     {
-    vtkErrorMacro("StageFileRead: curl ran out of memory!");
+    curl_easy_cleanup(easyHandles[i]);
     }
-  else
+  curl_multi_cleanup(multiHandle);
+
+  if (errors > 0)
     {
-    const char *stringError = curl_easy_strerror(retval);
-    vtkErrorMacro("StageFileRead: error running curl: " << stringError);
     //--- in case the permissions were not correct and that's
     //--- the reason the read command failed,
     //--- reset the 'remember check' in the permissions
@@ -198,17 +422,6 @@ void vtkHTTPHandler::StageFileRead(const char * source, const char * destination
       this->GetPermissionPrompter()->SetRemember ( 0 );
       }
     }
-  this->CloseTransfer();
-
-  /*
-  this->LocalFile->close();
-  delete this->LocalFile;
-  this->LocalFile = NULL;
-  */
-  if (this->LocalFile)
-    {
-    fclose(this->LocalFile);
-    }
 }
 
 
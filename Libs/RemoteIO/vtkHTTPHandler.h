@@ -15,6 +15,8 @@
 //--- derived from libMRML class
 #include "vtkURIHandler.h"
 
+class vtkStringArray;
+
 class VTK_RemoteIO_EXPORT vtkHTTPHandler : public vtkURIHandler 
 {
   public:
@@ -37,10 +39,36 @@ class VTK_RemoteIO_EXPORT vtkHTTPHandler : public vtkURIHandler
   vtkSetMacro(ForbidReuse, int);
   vtkGetMacro(ForbidReuse, int);
 
+  /// 
+  /// Maximum number of files downloaded at the same time by
+  /// StageFilesRead(), 8 by default.
+  vtkSetMacro(MaximumConnections, int);
+  vtkGetMacro(MaximumConnections, int);
+
+  /// 
+  /// Maximum number of connections opened to the same host by
+  /// StageFilesRead(), 4 by default. The connections are kept alive and
+  /// reused for the next files of the host unless ForbidReuse is set.
+  vtkSetMacro(MaximumConnectionsPerHost, int);
+  vtkGetMacro(MaximumConnectionsPerHost, int);
+
+  /// 
+  /// Number of times a failed download is retried, 3 by default. The
+  /// download resumes with a range request from the bytes already
+  /// written to the destination.
+  vtkSetMacro(MaximumRetries, int);
+  vtkGetMacro(MaximumRetries, int);
+
   /// 
   /// This function wraps curl functionality to download a specified URL to a specified dir
   void StageFileRead(const char * source, const char * destination);
   using vtkURIHandler::StageFileRead;
+  /// 
+  /// Download all the sources at the same time with a curl multi handle.
+  /// Unlike StageFileRead() in vtkURIHandler subclasses, it doesn't use
+  /// CurlHandle nor LocalFile and can be called from several threads.
+  virtual void StageFilesRead(vtkStringArray *sources,
+                              vtkStringArray *destinations);
   void StageFileWrite(const char * source, const char * destination);
   using vtkURIHandler::StageFileWrite;
   virtual void InitTransfer ( );
@@ -57,6 +85,9 @@ class VTK_RemoteIO_EXPORT vtkHTTPHandler : public vtkURIHandler
   void operator=(const vtkHTTPHandler&);
 
   int ForbidReuse;
+  int MaximumConnections;
+  int MaximumConnectionsPerHost;
+  int MaximumRetries;
 
 };
 
@@ -122,6 +122,14 @@ void vtkXNDHandler::PrintSelf(ostream& os, vtkIndent indent)
 //----------------------------------------------------------------------------
 
 //--- for downloading
+//----------------------------------------------------------------------------
+void vtkXNDHandler::StageFilesRead(vtkStringArray *sources,
+                                  vtkStringArray *destinations)
+{
+  // the transfers use the shared CurlHandle
+  this->vtkURIHandler::StageFilesRead(sources, destinations);
+}
+
 //----------------------------------------------------------------------------
 void vtkXNDHandler::StageFileRead(const char * source,
                                   const char *destination )
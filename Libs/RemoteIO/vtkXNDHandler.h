@@ -32,6 +32,10 @@ class VTK_RemoteIO_EXPORT vtkXNDHandler : public vtkHTTPHandler
   /// a specified destination file, from a specified host.
   virtual void StageFileRead(const char * source,
                              const char * destination);
+  /// 
+  /// Download the files one after the other with StageFileRead().
+  virtual void StageFilesRead(vtkStringArray *sources,
+                              vtkStringArray *destinations);
 
   using vtkURIHandler::StageFileRead;
 
@@ -0,0 +1,176 @@
+#include "itkThreadedImageHistogramCalculator.h"
+#include "itkNewOtsuThresholdImageCalculator.h"
+
+#include "itkImage.h"
+#include "itkImageRegionIterator.h"
+
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+
+typedef itk::Image<short, 3>         ShortImageType;
+typedef itk::Image<float, 3>         FloatImageType;
+typedef itk::Image<unsigned char, 3> MaskImageType;
+
+template <class TImage>
+typename TImage::Pointer CreateImage()
+{
+  typename TImage::Pointer image = TImage::New();
+  typename TImage::SizeType size;
+  size[0] = 37;
+  size[1] = 29;
+  size[2] = 11;
+  typename TImage::RegionType region;
+  region.SetSize(size);
+  image->SetRegions(region);
+  image->Allocate();
+  return image;
+}
+
+// Bimodal integer values, the same in all the images
+void FillImages(ShortImageType* shortImage, FloatImageType* floatImage, MaskImageType* mask)
+{
+  itk::ImageRegionIterator<ShortImageType> shortIt(shortImage, shortImage->GetBufferedRegion());
+  itk::ImageRegionIterator<FloatImageType> floatIt(floatImage, floatImage->GetBufferedRegion());
+  itk::ImageRegionIterator<MaskImageType> maskIt(mask, mask->GetBufferedRegion());
+  unsigned int seed = 12345;
+  for (; !shortIt.IsAtEnd(); ++shortIt, ++floatIt, ++maskIt)
+    {
+    seed = seed * 1103515245 + 12345;
+    int value = static_cast<int>((seed >> 16) % 200);
+    value += ((seed >> 8) & 1) ? 300 : -100;
+    shortIt.Set(static_cast<short>(value));
+    floatIt.Set(static_cast<float>(value));
+    maskIt.Set((seed >> 12) & 1);
+    }
+}
+
+template <class TImage>
+bool TestHistogram(TImage* image, MaskImageType* mask, int numberOfThreads,
+                   std::vector<unsigned long>& frequencies)
+{
+  typedef itk::ThreadedImageHistogramCalculator<TImage> CalculatorType;
+  typename CalculatorType::Pointer calculator = CalculatorType::New();
+  calculator->SetImage(image);
+  calculator->SetMaskImage(mask);
+  calculator->SetNumberOfThreads(numberOfThreads);
+  calculator->SetNumberOfHistogramBins(50);
+  calculator->Compute();
+
+  // Reference
+  double minimum = 0., maximum = 0., sum = 0.;
+  unsigned long count = 0;
+  itk::ImageRegionIterator<TImage> it(image, image->GetBufferedRegion());
+  itk::ImageRegionIterator<MaskImageType> maskIt(mask, mask->GetBufferedRegion());
+  for (; !it.IsAtEnd(); ++it, ++maskIt)
+    {
+    double value = static_cast<double>(it.Get());
+    if (!maskIt.Get())
+      {
+      continue;
+      }
+    minimum = (count == 0 || value < minimum) ? value : minimum;
+    maximum = (count == 0 || value > maximum) ? value : maximum;
+    sum += value;
+    ++count;
+    }
+  if (calculator->GetNumberOfPixels() != count ||
+      static_cast<double>(calculator->GetMinimum()) != minimum ||
+      static_cast<double>(calculator->GetMaximum()) != maximum ||
+      calculator->GetMean() - sum / count > 1e-9 ||
+      sum / count - calculator->GetMean() > 1e-9)
+    {
+    std::cerr << "Wrong statistics with " << numberOfThreads << " threads" << std::endl;
+    return false;
+    }
+
+  std::vector<unsigned long> expected(50, 0);
+  for (it.GoToBegin(), maskIt.GoToBegin(); !it.IsAtEnd(); ++it, ++maskIt)
+    {
+    if (maskIt.Get())
+      {
+      unsigned long bin = static_cast<unsigned long>(
+        (static_cast<double>(it.Get()) - minimum) * (50. / (maximum - minimum)));
+      ++expected[bin < 50 ? bin : 49];
+      }
+    }
+  if (calculator->GetFrequencies() != expected || calculator->GetTotalFrequency() != count)
+    {
+    std::cerr << "Wrong histogram with " << numberOfThreads << " threads" << std::endl;
+    return false;
+    }
+
+  double previous = minimum;
+  for (int i = 1; i < 10; ++i)
+    {
+    double quantile = calculator->Quantile(i / 10.);
+    if (quantile < previous || quantile > maximum)
+      {
+      std::cerr << "Wrong quantile " << i / 10. << ": " << quantile << std::endl;
+      return false;
+      }
+    previous = quantile;
+    }
+  frequencies = calculator->GetFrequencies();
+  return true;
+}
+
+template <class TImage>
+double OtsuThreshold(TImage* image, MaskImageType* mask, int numberOfThreads)
+{
+  typedef itk::NewOtsuThresholdImageCalculator<TImage> CalculatorType;
+  typename CalculatorType::Pointer calculator = CalculatorType::New();
+  calculator->SetImage(image);
+  calculator->SetMaskImage(mask);
+  calculator->SetNumberOfThreads(numberOfThreads);
+  calculator->Compute();
+  return static_cast<double>(calculator->GetThreshold());
+}
+
+} // end of anonymous namespace
+
+int main( int, char** )
+{
+  ShortImageType::Pointer shortImage = CreateImage<ShortImageType>();
+  FloatImageType::Pointer floatImage = CreateImage<FloatImageType>();
+  MaskImageType::Pointer mask = CreateImage<MaskImageType>();
+  FillImages(shortImage, floatImage, mask);
+  MaskImageType::Pointer fullMask = CreateImage<MaskImageType>();
+  fullMask->FillBuffer(1);
+
+  // The threads and the integer (short) and floating point paths give the
+  //   same histograms
+  std::vector<unsigned long> reference;
+  std::vector<unsigned long> frequencies;
+  if (!TestHistogram<ShortImageType>(shortImage, mask, 1, reference))
+    {
+    return EXIT_FAILURE;
+    }
+  for (int threads = 2; threads <= 8; threads *= 2)
+    {
+    if (!TestHistogram<ShortImageType>(shortImage, mask, threads, frequencies) ||
+        frequencies != reference ||
+        !TestHistogram<FloatImageType>(floatImage, mask, threads, frequencies) ||
+        frequencies != reference)
+      {
+      std::cerr << "Histograms differ with " << threads << " threads" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // Otsu threshold, between the two modes
+  double threshold = OtsuThreshold<ShortImageType>(shortImage, 0, 1);
+  if (threshold < 99 || threshold > 300 ||
+      OtsuThreshold<ShortImageType>(shortImage, 0, 4) != threshold ||
+      OtsuThreshold<ShortImageType>(shortImage, fullMask, 4) != threshold ||
+      OtsuThreshold<FloatImageType>(floatImage, 0, 4) - threshold > 1. ||
+      threshold - OtsuThreshold<FloatImageType>(floatImage, 0, 4) > 1.)
+    {
+    std::cerr << "Wrong Otsu threshold: " << threshold << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -5,6 +5,7 @@
 #include "itkImageToImageFilter.h"
 #include "itkSimpleDataObjectDecorator.h"
 #include "itkVectorContainer.h"
+#include "itkMultiThreader.h"
 //#include "itkCommand.h"
 
 //#include "itkGrowCutSegmentationUpdateFilter.h"
@@ -261,6 +262,24 @@ template<class TInputImage,
   itkGetConstMacro(SetMaxSaturationImage, bool);
   itkBooleanMacro(SetMaxSaturationImage);
 
+  /**Set/Get whether the filter propagates the labels from an active
+  * front instead of recomputing the segmentation. The label image
+  * (input 1) and the strength image (input 2) are then updated in place,
+  * so that the caller can keep them between runs, and only the cells
+  * next to a changed cell are visited by each iteration. The updates of
+  * an iteration are computed by several threads. Default is off.
+  **/
+  itkSetMacro(Incremental, bool);
+  itkGetConstMacro(Incremental, bool);
+  itkBooleanMacro(Incremental);
+
+  /**Set/Get the cells whose label or strength changed since the previous
+  * run, e.g. the newly added gestures. Only used in Incremental mode,
+  * when not set every labeled cell of the ROI is in the front.
+  **/
+  itkSetObjectMacro(ActiveFront, NodeContainer);
+  itkGetObjectMacro(ActiveFront, NodeContainer);
+
  protected:
   
   GrowCutSegmentationImageFilter();
@@ -290,6 +309,12 @@ template<class TInputImage,
 
   void GrowCutSlowROI( TOutputImage *);
 
+  void GenerateDataIncremental();
+
+  void ThreadedUpdateFront(unsigned int threadId, unsigned int numberOfThreads);
+
+  static ITK_THREAD_RETURN_TYPE UpdateFrontThreaderCallback(void *arg);
+
   
  private:
 
@@ -305,6 +330,15 @@ template<class TInputImage,
   void ComputeLabelVolumes(TOutputImage *outputImage, vcl_vector< unsigned > &volumes, vcl_vector< unsigned > &phyVolumes);
 
   void MaskSegmentedImageByWeight(float upperThresh);
+
+  typedef typename OutputImageType::OffsetType OutputOffsetType;
+  typedef typename OutputOffsetType::OffsetValueType OffsetValueType;
+
+  void AddNeighborsToFront(OffsetValueType cell,
+                           const OutputImageRegionType &roi,
+                           unsigned char stamp,
+                           vcl_vector< unsigned char > &stamps,
+                           vcl_vector< OffsetValueType > &front);
   
    
   WeightPixelType                            m_ConfThresh;
@@ -320,6 +354,7 @@ template<class TInputImage,
   bool                                       m_SetStateImage;
   bool                                       m_SetDistancesImage;
   bool                                       m_SetMaxSaturationImage;
+  bool                                       m_Incremental;
 
   unsigned int                               m_MaxIterations;
   unsigned int                               m_ObjectRadius;
@@ -331,6 +366,15 @@ template<class TInputImage,
   OutputIndexType                            m_roiStart;
   OutputIndexType                            m_roiEnd;
 
+  // State of an iteration of the Incremental mode: the cells to visit,
+  // their new label and strength, and the steps to their neighbors
+  NodeContainerPointer                       m_ActiveFront;
+  vcl_vector< OffsetValueType >              m_FrontCells;
+  vcl_vector< OutputPixelType >              m_FrontLabels;
+  vcl_vector< WeightPixelType >              m_FrontWeights;
+  vcl_vector< OutputOffsetType >             m_NeighborSteps;
+  vcl_vector< OffsetValueType >              m_NeighborOffsets;
+
 };
 
 } // namespace itk
@@ -18,6 +18,7 @@
 #include "itkLabelImageToShapeLabelMapFilter.h"
 
 #include "itkProgressReporter.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
 # include "itkIterationReporter.h"
 
 #include <vcl_map.h>
@@ -52,6 +53,8 @@ GrowCutSegmentationImageFilter<TInputImage, TOutputImage, TWeightPixelType>
 
   m_SetMaxSaturationImage = false;
 
+  m_Incremental = false;
+
   m_ConfThresh = 0.2;
   
   m_MaxIterations = 500;
@@ -68,6 +71,10 @@ GrowCutSegmentationImageFilter<TInputImage, TOutputImage, TWeightPixelType>
   m_UnknownLabel = static_cast<OutputPixelType>( NumericTraits<OutputPixelType>::ZeroValue() );
   
   m_Radius.Fill(1);   
+
+  // an empty ROI stands for the whole image in Incremental mode
+  m_roiStart.Fill(0);
+  m_roiEnd.Fill(-1);
 }
 
 
@@ -84,6 +91,7 @@ GrowCutSegmentationImageFilter<TInputImage, TOutputImage, TWeightPixelType>
   //   os << indent << "max enemies for attack T1 : " << m_T1<< std::endl;  
   // os << indent << "min enemies for submit T2 : " << m_T2<< std::endl;  
   os << indent << "starting seed strength :" <<m_SeedStrength<< std::endl;     
+  os << indent << "incremental : " << m_Incremental << std::endl;
   //os << indent << "use Algorithm Speed Slow : " << m_UseSlow<< std::endl; 
 } 
 
@@ -493,6 +501,12 @@ void
 GrowCutSegmentationImageFilter<TInputImage, TOutputImage, TWeightPixelType>
 ::GenerateData() 
 {
+  if(m_Incremental)
+    {
+    this->GenerateDataIncremental();
+    return;
+    }
+
   IterationReporter iterate(this, 0, 1);
 
   // if the filter is configured to run a single iteration, use the superclass 
@@ -1100,6 +1114,300 @@ GrowCutSegmentationImageFilter<TInputImage, TOutputImage, TWeightPixelType>
 
 
 
+template <class TInputImage, class TOutputImage, class TWeightPixelType>
+void 
+GrowCutSegmentationImageFilter<TInputImage, TOutputImage, TWeightPixelType>
+::GenerateDataIncremental()
+{
+  IterationReporter iterate(this, 0, 1);
+
+  typename InputImageType::Pointer inputImage = InputImageType::New();
+  inputImage->Graft( this->ProcessObject::GetInput(0));
+
+  // the label and strength images hold the state of the automaton and
+  // are updated in place
+  m_LabelImage = static_cast< OutputImageType *>(this->ProcessObject::GetInput(1));
+  m_WeightImage = WeightImageType::New();
+  m_WeightImage->Graft( this->ProcessObject::GetInput(2));
+
+  OutputImageRegionType region = m_LabelImage->GetBufferedRegion();
+  if(inputImage->GetBufferedRegion() != region || 
+     m_WeightImage->GetBufferedRegion() != region)
+    {
+    itkExceptionMacro(<< "The input, label and strength images must have the same buffered region");
+    }
+
+  // restrict the propagation to the ROI
+  OutputImageRegionType roi = region;
+  bool emptyROI = false;
+  OutputSizeType roiSize;
+  for (unsigned d = 0; d < ImageDimension; d++)
+    {
+    emptyROI = emptyROI || (m_roiEnd[d] < m_roiStart[d]);
+    roiSize[d] = emptyROI ? 0 : m_roiEnd[d] - m_roiStart[d] + 1;  
+    }
+  if(!emptyROI)
+    {
+    roi.SetIndex(m_roiStart);
+    roi.SetSize(roiSize);
+    if(!roi.Crop(region))
+      {
+      roi = region;
+      }
+    }
+
+  // steps to the cells of the neighborhood of radius 1
+  m_NeighborSteps.clear();
+  m_NeighborOffsets.clear();
+  unsigned int neighborhoodSize = 1;
+  for (unsigned d = 0; d < ImageDimension; d++)
+    {
+    neighborhoodSize *= 3;
+    }
+  OutputIndexType origin = region.GetIndex();
+  OffsetValueType originOffset = static_cast< OffsetValueType >(m_LabelImage->ComputeOffset(origin));
+  for (unsigned k = 0; k < neighborhoodSize; k++)
+    {
+    OutputOffsetType step;
+    bool center = true;
+    for (unsigned d = 0, n = k; d < ImageDimension; d++, n /= 3)
+      {
+      step[d] = static_cast< OffsetValueType >(n % 3) - 1;
+      center = center && (step[d] == 0);
+      }
+    if(center)
+      {
+      continue;
+      }
+    m_NeighborSteps.push_back(step);
+    m_NeighborOffsets.push_back(
+      static_cast< OffsetValueType >(m_LabelImage->ComputeOffset(origin + step)) - originOffset);
+    }
+
+  // the stamps tell which cells of the ROI are already in the next front
+  vcl_vector< unsigned char > stamps(roi.GetNumberOfPixels(), 0);
+  unsigned char stamp = 1;
+
+  m_FrontCells.clear();
+  if(m_ActiveFront)
+    {
+    for (typename NodeContainer::Iterator it = m_ActiveFront->Begin();
+         it != m_ActiveFront->End(); ++it)
+      {
+      if(region.IsInside(it.Value()))
+        {
+        this->AddNeighborsToFront(
+          static_cast< OffsetValueType >(m_LabelImage->ComputeOffset(it.Value())),
+          roi, stamp, stamps, m_FrontCells);
+        }
+      }
+    }
+  else
+    {
+    ImageRegionConstIteratorWithIndex< WeightImageType > weight( m_WeightImage, roi);
+    for(weight.GoToBegin(); !weight.IsAtEnd(); ++weight)
+      {
+      if(weight.Get() > 0)
+        {
+        this->AddNeighborsToFront(
+          static_cast< OffsetValueType >(m_WeightImage->ComputeOffset(weight.GetIndex())),
+          roi, stamp, stamps, m_FrontCells);
+        }
+      }
+    }
+
+  OutputPixelType *labels = m_LabelImage->GetBufferPointer();
+  WeightPixelType *weights = m_WeightImage->GetBufferPointer();
+
+  unsigned int iter = 0;
+  while (!m_FrontCells.empty() && iter < m_MaxIterations)
+    {
+    // compute the new state of the front from the current one...
+    m_FrontLabels.resize(m_FrontCells.size());
+    m_FrontWeights.resize(m_FrontCells.size());
+
+    unsigned int numberOfThreads = static_cast< unsigned int >(
+      vcl_min(static_cast< size_t >(this->GetNumberOfThreads()), 
+              m_FrontCells.size() / 1024 + 1));
+    this->GetMultiThreader()->SetNumberOfThreads(numberOfThreads);
+    this->GetMultiThreader()->SetSingleMethod(&Self::UpdateFrontThreaderCallback, this);
+    this->GetMultiThreader()->SingleMethodExecute();
+
+    // ...then apply it, the neighbors of the conquered cells are the next front
+    stamp = static_cast< unsigned char >((stamp == 255) ? 1 : stamp + 1);
+    if(stamp == 1)
+      {
+      vcl_fill(stamps.begin(), stamps.end(), 0);
+      }
+    vcl_vector< OffsetValueType > nextFront;
+    for (size_t i = 0; i < m_FrontCells.size(); i++)
+      {
+      OffsetValueType cell = m_FrontCells[i];
+      if(m_FrontWeights[i] == weights[cell] && m_FrontLabels[i] == labels[cell])
+        {
+        continue;
+        }
+      labels[cell] = m_FrontLabels[i];
+      weights[cell] = m_FrontWeights[i];
+      this->AddNeighborsToFront(cell, roi, stamp, stamps, nextFront);
+      }
+    m_FrontCells.swap(nextFront);
+
+    ++iter;
+    iterate.CompletedStep();
+    this->UpdateProgress(iter/static_cast<float>(m_MaxIterations));
+    }
+
+  // release the memory of the front
+  vcl_vector< OffsetValueType >().swap(m_FrontCells);
+  vcl_vector< OutputPixelType >().swap(m_FrontLabels);
+  vcl_vector< WeightPixelType >().swap(m_FrontWeights);
+  this->UpdateProgress(1.0);
+
+  // the output is the label image masked by the strength, the state is
+  // left untouched for the next run
+  typename OutputImageType::Pointer output = this->GetOutput();
+  this->Initialize(output);
+
+  ImageRegionConstIterator< OutputImageType > label( m_LabelImage, region);
+  ImageRegionConstIterator< WeightImageType > weight( m_WeightImage, region);
+  ImageRegionIterator< OutputImageType > out( output, region);
+  for(label.GoToBegin(), weight.GoToBegin(), out.GoToBegin(); !out.IsAtEnd();
+      ++label, ++weight, ++out)
+    {
+    out.Set( (weight.Get() < m_ConfThresh) ? m_UnknownLabel : label.Get());
+    }
+}
+
+template <class TInputImage, class TOutputImage, class TWeightPixelType>
+void 
+GrowCutSegmentationImageFilter<TInputImage, TOutputImage, TWeightPixelType>
+::AddNeighborsToFront(OffsetValueType cell, const OutputImageRegionType &roi,
+                      unsigned char stamp, vcl_vector< unsigned char > &stamps,
+                      vcl_vector< OffsetValueType > &front)
+{
+  OutputIndexType index = m_LabelImage->ComputeIndex(cell);
+  OutputIndexType roiStart = roi.GetIndex();
+  OutputSizeType roiSize = roi.GetSize();
+
+  for (unsigned k = 0; k < m_NeighborSteps.size(); k++)
+    {
+    OutputIndexType neighbor = index + m_NeighborSteps[k];
+    if(!roi.IsInside(neighbor))
+      {
+      continue;
+      }
+    OffsetValueType roiOffset = 0;
+    OffsetValueType stride = 1;
+    for (unsigned d = 0; d < ImageDimension; d++)
+      {
+      roiOffset += (neighbor[d] - roiStart[d]) * stride;
+      stride *= static_cast< OffsetValueType >(roiSize[d]);
+      }
+    if(stamps[roiOffset] == stamp)
+      {
+      continue;
+      }
+    stamps[roiOffset] = stamp;
+    front.push_back(cell + m_NeighborOffsets[k]);
+    }
+}
+
+template <class TInputImage, class TOutputImage, class TWeightPixelType>
+ITK_THREAD_RETURN_TYPE
+GrowCutSegmentationImageFilter<TInputImage, TOutputImage, TWeightPixelType>
+::UpdateFrontThreaderCallback(void *arg)
+{
+  MultiThreader::ThreadInfoStruct *info = 
+    static_cast< MultiThreader::ThreadInfoStruct *>(arg);
+  Self *self = static_cast< Self *>(info->UserData);
+  self->ThreadedUpdateFront(info->ThreadID, info->NumberOfThreads);
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template <class TInputImage, class TOutputImage, class TWeightPixelType>
+void 
+GrowCutSegmentationImageFilter<TInputImage, TOutputImage, TWeightPixelType>
+::ThreadedUpdateFront(unsigned int threadId, unsigned int numberOfThreads)
+{
+  // each thread reads the current state and writes the new state of its
+  // share of the front, so that the threads don't depend on each other
+  const InputPixelType *intensities = 
+    static_cast< const InputImageType *>(this->ProcessObject::GetInput(0))->GetBufferPointer();
+  const OutputPixelType *labels = m_LabelImage->GetBufferPointer();
+  const WeightPixelType *weights = m_WeightImage->GetBufferPointer();
+
+  OutputImageRegionType region = m_LabelImage->GetBufferedRegion();
+  OutputIndexType start = region.GetIndex();
+  OutputSizeType size = region.GetSize();
+
+  size_t numberOfCells = m_FrontCells.size();
+  size_t first = numberOfCells * threadId / numberOfThreads;
+  size_t last = numberOfCells * (threadId + 1) / numberOfThreads;
+  unsigned int numberOfNeighbors = static_cast< unsigned int >(m_NeighborSteps.size());
+  vcl_vector< bool > inside(numberOfNeighbors, true);
+
+  for (size_t i = first; i < last; i++)
+    {
+    OffsetValueType cell = m_FrontCells[i];
+    OutputIndexType index = m_LabelImage->ComputeIndex(cell);
+
+    bool interior = true;
+    for (unsigned d = 0; d < ImageDimension; d++)
+      {
+      interior = interior && index[d] > start[d] &&
+        index[d] < start[d] + static_cast< OffsetValueType >(size[d]) - 1;
+      }
+    for (unsigned k = 0; k < numberOfNeighbors; k++)
+      {
+      inside[k] = interior || region.IsInside(index + m_NeighborSteps[k]);
+      }
+
+    // the attack force is normalized by the largest difference of
+    // intensity in the neighborhood, as in InitializeDistancesImage
+    WeightPixelType center = static_cast< WeightPixelType >(intensities[cell]);
+    WeightPixelType maxDist = 0.0;
+    for (unsigned k = 0; k < numberOfNeighbors; k++)
+      {
+      if(!inside[k])
+        {
+        continue;
+        }
+      WeightPixelType diff = 
+        static_cast< WeightPixelType >(intensities[cell + m_NeighborOffsets[k]]) - center;
+      maxDist = (diff*diff > maxDist) ? diff*diff : maxDist;
+      }
+
+    OutputPixelType winnerLabel = labels[cell];
+    WeightPixelType winnerWeight = weights[cell];
+    for (unsigned k = 0; k < numberOfNeighbors; k++)
+      {
+      if(!inside[k])
+        {
+        continue;
+        }
+      OffsetValueType neighbor = cell + m_NeighborOffsets[k];
+      WeightPixelType w = weights[neighbor];
+      // the attack force is at most the strength of the attacker
+      if(w <= winnerWeight)
+        {
+        continue;
+        }
+      WeightPixelType diff = static_cast< WeightPixelType >(intensities[neighbor]) - center;
+      WeightPixelType attackWeight = (maxDist > 0) ? (1.0 - diff*diff/maxDist) : 1.0;
+      attackWeight *= w;
+      if(attackWeight > winnerWeight)
+        {
+        winnerWeight = attackWeight;
+        winnerLabel = labels[neighbor];
+        }
+      }
+    m_FrontLabels[i] = winnerLabel;
+    m_FrontWeights[i] = winnerWeight;
+    }
+}
+
+
 }//namespace itk
 
 #endif
@@ -5,6 +5,7 @@
 #include "itkObject.h"
 #include "itkObjectFactory.h"
 #include "itkNumericTraits.h"
+#include "itkThreadedImageHistogramCalculator.h"
 
 namespace itk
 {
@@ -17,6 +18,10 @@ namespace itk
  * histogram of image intensities. The basic idea is to maximize the 
  * between-class variance.
  *
+ * The intensity range and the histogram are computed in threads by
+ * ThreadedImageHistogramCalculator, optionally only over the pixels where
+ * the mask image is not zero.
+ *
  * This class is templated over the input image type.
  *
  * \warning This method assumes that the input image consists of scalar pixel
@@ -51,10 +56,21 @@ public:
 
   /** Type definition for the input image pixel type. */
   typedef typename TInputImage::PixelType PixelType;
+
+  /** Type definition for the mask image. */
+  typedef Image<unsigned char, TInputImage::ImageDimension> MaskImageType;
+  typedef typename MaskImageType::ConstPointer MaskImageConstPointer;
   
   /** Set the input image. */
   itkSetConstObjectMacro(Image,ImageType);
 
+  /** Set the mask image, NULL (the default) uses all the pixels. */
+  itkSetConstObjectMacro(MaskImage,MaskImageType);
+
+  /** Set/Get the number of threads computing the histogram. */
+  itkSetClampMacro( NumberOfThreads, int, 1, ITK_MAX_THREADS );
+  itkGetMacro( NumberOfThreads, int );
+
   /** Compute the Otsu's threshold for the input image. */
   void Compute(void);
 
@@ -77,11 +93,15 @@ protected:
 private:
   NewOtsuThresholdImageCalculator(const Self&); //purposely not implemented
   void operator=(const Self&); //purposely not implemented
+
+  typedef ThreadedImageHistogramCalculator<TInputImage, MaskImageType> HistogramCalculatorType;
   
   PixelType            m_Threshold;
   unsigned long        m_NumberOfHistogramBins;
   double m_Omega;
   ImageConstPointer    m_Image;
+  MaskImageConstPointer m_MaskImage;
+  int                  m_NumberOfThreads;
 
 };
 
@@ -18,8 +18,6 @@
 #define _itkNewOtsuThresholdImageCalculator_txx
 
 #include "itkNewOtsuThresholdImageCalculator.h"
-#include "itkImageRegionConstIteratorWithIndex.h"
-#include "itkMinimumMaximumImageCalculator.h"
 
 #include "math.h"
 
@@ -34,6 +32,8 @@ NewOtsuThresholdImageCalculator<TInputImage>
 ::NewOtsuThresholdImageCalculator()
 {
   m_Image = NULL;
+  m_MaskImage = NULL;
+  m_NumberOfThreads = MultiThreader::GetGlobalDefaultNumberOfThreads();
   m_Threshold = NumericTraits<PixelType>::Zero;
   m_NumberOfHistogramBins = 128;
   m_Omega = 2;
@@ -53,18 +53,20 @@ NewOtsuThresholdImageCalculator<TInputImage>
 
   if ( !m_Image ) { return; }
 
-  double totalPixels = (double) m_Image->GetBufferedRegion().GetNumberOfPixels();
-  if ( totalPixels == 0 ) { return; }
-
+  // compute image max and min, then the histogram, in threads
+  typename HistogramCalculatorType::Pointer histogramCalculator = HistogramCalculatorType::New();
+  histogramCalculator->SetImage( m_Image );
+  histogramCalculator->SetMaskImage( m_MaskImage );
+  histogramCalculator->SetNumberOfThreads( m_NumberOfThreads );
+  histogramCalculator->SetNumberOfHistogramBins( m_NumberOfHistogramBins );
+  histogramCalculator->SetBinRule( HistogramCalculatorType::UPPER_INCLUSIVE_BINS );
+  histogramCalculator->ComputeStatistics();
 
-  // compute image max and min
-  typedef MinimumMaximumImageCalculator<TInputImage> RangeCalculator;
-  typename RangeCalculator::Pointer rangeCalculator = RangeCalculator::New();
-  rangeCalculator->SetImage( m_Image );
-  rangeCalculator->Compute();
+  double totalPixels = (double) histogramCalculator->GetNumberOfPixels();
+  if ( totalPixels == 0 ) { return; }
 
-  PixelType imageMin = rangeCalculator->GetMinimum();
-  PixelType imageMax = rangeCalculator->GetMaximum();
+  PixelType imageMin = histogramCalculator->GetMinimum();
+  PixelType imageMax = histogramCalculator->GetMaximum();
 
   if ( imageMin >= imageMax )
     {
@@ -73,42 +75,20 @@ NewOtsuThresholdImageCalculator<TInputImage>
     }
 
   // create a histogram
+  histogramCalculator->SetHistogramMinimum( static_cast<double>( imageMin ) );
+  histogramCalculator->SetHistogramMaximum( static_cast<double>( imageMax ) );
+  histogramCalculator->ComputeHistogram();
+
   std::vector<double> relativeFrequency;
   relativeFrequency.resize( m_NumberOfHistogramBins );
   for ( j = 0; j < m_NumberOfHistogramBins; j++ )
     {
-    relativeFrequency[j] = 0.0;
+    relativeFrequency[j] = (double) histogramCalculator->GetFrequency( j );
     }
 
   double binMultiplier = (double) m_NumberOfHistogramBins /
     (double) ( imageMax - imageMin );
 
-  typedef ImageRegionConstIteratorWithIndex<TInputImage> Iterator;
-  Iterator iter( m_Image, m_Image->GetBufferedRegion() );
-
-  while ( !iter.IsAtEnd() )
-    {
-    unsigned int binNumber;
-    PixelType value = iter.Get();
-
-    if ( value == imageMin ) 
-      {
-      binNumber = 0;
-      }
-    else
-      {
-      binNumber = (unsigned int) ceil( (value - imageMin) * binMultiplier ) - 1;
-      if ( binNumber == m_NumberOfHistogramBins ) // in case of rounding errors
-        {
-        binNumber -= 1;
-        }
-      }
-
-    relativeFrequency[binNumber] += 1.0;
-    ++iter;
-
-    }
- 
   // normalize the frequencies
   double totalMean = 0.0;
   for ( j = 0; j < m_NumberOfHistogramBins; j++ )
@@ -174,6 +154,8 @@ NewOtsuThresholdImageCalculator<TInputImage>
   os << indent << "Threshold: " << m_Threshold << std::endl;
   os << indent << "NumberOfHistogramBins: " << m_NumberOfHistogramBins << std::endl;
   os << indent << "Image: " << m_Image.GetPointer() << std::endl;
+  os << indent << "MaskImage: " << m_MaskImage.GetPointer() << std::endl;
+  os << indent << "NumberOfThreads: " << m_NumberOfThreads << std::endl;
 }
 
 } // end namespace itk
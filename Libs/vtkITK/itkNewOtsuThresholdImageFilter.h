@@ -19,6 +19,7 @@
 
 #include "itkImageToImageFilter.h"
 #include "itkFixedArray.h"
+#include "itkNewOtsuThresholdImageCalculator.h"
 
 namespace itk
 {
@@ -32,7 +33,9 @@ namespace itk
  * applies that theshold to the input image using the
  * BinaryThresholdImageFilter. The NunberOfHistogram bins can be set
  * for the Calculator. The InsideValue and OutsideValue can be set
- * for the BinaryThresholdImageFilter.
+ * for the BinaryThresholdImageFilter. The histogram is computed in the
+ * threads of the filter, optionally only over the pixels where the mask
+ * image is not zero.
  *
  * \sa NewOtsuThresholdImageCalculator
  * \sa BinaryThresholdImageFilter
@@ -99,6 +102,11 @@ public:
   itkSetMacro ( Omega, double);
   itkGetMacro ( Omega, double);
 
+  /** Set the mask of the pixels the threshold is computed from, NULL (the
+   * default) uses all the pixels. The whole image is thresholded. */
+  typedef typename NewOtsuThresholdImageCalculator<TInputImage>::MaskImageType MaskImageType;
+  itkSetConstObjectMacro(MaskImage, MaskImageType);
+
   /** Get the computed threshold. */
   itkGetMacro(Threshold,InputPixelType);
 
@@ -120,6 +128,7 @@ private:
   OutputPixelType     m_OutsideValue;
   unsigned long       m_NumberOfHistogramBins;
   double             m_Omega; 
+  typename MaskImageType::ConstPointer m_MaskImage;
 } ; /// end of class
 
 } /// end namespace itk
@@ -33,6 +33,7 @@ NewOtsuThresholdImageFilter<TInputImage, TOutputImage>
   m_Threshold      = NumericTraits<InputPixelType>::Zero;
   m_NumberOfHistogramBins = 128;
   m_Omega = 2;
+  m_MaskImage = NULL;
 }
 
 template<class TInputImage, class TOutputImage>
@@ -47,6 +48,8 @@ NewOtsuThresholdImageFilter<TInputImage, TOutputImage>
   typename NewOtsuThresholdImageCalculator<TInputImage>::Pointer otsu =
     NewOtsuThresholdImageCalculator<TInputImage>::New();
   otsu->SetImage (this->GetInput());
+  otsu->SetMaskImage (m_MaskImage);
+  otsu->SetNumberOfThreads (this->GetNumberOfThreads());
   otsu->SetNumberOfHistogramBins (m_NumberOfHistogramBins);
   otsu->SetOmega(m_Omega);
   otsu->Compute();
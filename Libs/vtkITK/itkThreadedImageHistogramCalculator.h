@@ -0,0 +1,244 @@
+#ifndef __itkThreadedImageHistogramCalculator_h
+#define __itkThreadedImageHistogramCalculator_h
+
+#include "itkImage.h"
+#include "itkMultiThreader.h"
+#include "itkNumericTraits.h"
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "math.h"
+
+namespace itk
+{
+
+/** \class ThreadedImageHistogramCalculator
+ * \brief Computes the intensity statistics and histogram of an image in threads.
+ *
+ * The buffer of the image is shared out between the threads.  Each thread
+ * computes the minimum, maximum and sum of its pixels, or fills its own
+ * histogram, and the results of the threads are merged at the end.  Only
+ * the pixels where the optional mask image is not zero are counted; the
+ * mask must have the same buffered region as the image.
+ *
+ * The histogram has NumberOfHistogramBins bins between HistogramMinimum
+ * and HistogramMaximum, or the bins given by their boundaries.  The
+ * pixels outside of the range are not counted.  With LOWER_INCLUSIVE_BINS
+ * a bin holds the values from its minimum (included) to its maximum
+ * (excluded), as in itk::Statistics::Histogram.  With
+ * UPPER_INCLUSIVE_BINS it holds the values from its minimum (excluded) to
+ * its maximum (included), the minimum going to the first bin, as in
+ * itk::OtsuThresholdImageCalculator.
+ *
+ * The pixels of an integer image whose histogram range spans at most
+ * MaximumNumberOfValueBins values (8 and 16 bit images) are counted per
+ * value, and the values are put in the histogram bins at the end.
+ *
+ * \warning This class assumes that the input image consists of scalar
+ * pixel types.
+ */
+template <class TInputImage,
+          class TMaskImage = Image<unsigned char, TInputImage::ImageDimension> >
+class ITK_EXPORT ThreadedImageHistogramCalculator : public Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef ThreadedImageHistogramCalculator Self;
+  typedef Object                           Superclass;
+  typedef SmartPointer<Self>               Pointer;
+  typedef SmartPointer<const Self>         ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(ThreadedImageHistogramCalculator, Object);
+
+  typedef TInputImage                       ImageType;
+  typedef typename TInputImage::ConstPointer ImageConstPointer;
+  typedef typename TInputImage::PixelType    PixelType;
+
+  typedef TMaskImage                         MaskImageType;
+  typedef typename TMaskImage::ConstPointer  MaskImageConstPointer;
+  typedef typename TMaskImage::PixelType     MaskPixelType;
+
+  typedef std::vector<unsigned long> FrequencyContainerType;
+
+  enum BinRuleEnumType { LOWER_INCLUSIVE_BINS,
+                         UPPER_INCLUSIVE_BINS };
+
+  /** Largest number of values counted one by one for integer images. */
+  itkStaticConstMacro(MaximumNumberOfValueBins, unsigned long, 65536);
+
+  /** Set the input image. */
+  itkSetConstObjectMacro(Image, ImageType);
+
+  /** Set the mask image, NULL (the default) counts all the pixels. */
+  itkSetConstObjectMacro(MaskImage, MaskImageType);
+
+  /** Set/Get the number of threads.  Defaults to the global default. */
+  itkSetClampMacro(NumberOfThreads, int, 1, ITK_MAX_THREADS);
+  itkGetConstMacro(NumberOfThreads, int);
+
+  /** Set/Get the number of uniform histogram bins. Default is 128. */
+  itkSetClampMacro(NumberOfHistogramBins, unsigned long, 1,
+                   NumericTraits<unsigned long>::max() );
+  itkGetConstMacro(NumberOfHistogramBins, unsigned long);
+
+  /** Set/Get the range of the uniform histogram bins. */
+  itkSetMacro(HistogramMinimum, double);
+  itkGetConstMacro(HistogramMinimum, double);
+  itkSetMacro(HistogramMaximum, double);
+  itkGetConstMacro(HistogramMaximum, double);
+
+  /** Use the given (increasing) bin boundaries instead of uniform bins:
+   * bin i goes from boundaries[i] to boundaries[i+1].  Only supported with
+   * LOWER_INCLUSIVE_BINS.  An empty vector (the default) uses uniform bins. */
+  void SetBinBoundaries(const std::vector<double> & boundaries);
+
+  /** Set/Get the bins the bounds belong to. Default is LOWER_INCLUSIVE_BINS. */
+  itkSetMacro(BinRule, BinRuleEnumType);
+  itkGetConstMacro(BinRule, BinRuleEnumType);
+
+  /** Compute the statistics, then the histogram over the intensity range. */
+  void Compute();
+
+  /** Compute the minimum, maximum and mean of the (masked) pixels. */
+  void ComputeStatistics();
+
+  /** Compute the histogram of the (masked) pixels. */
+  void ComputeHistogram();
+
+  /** Statistics of the (masked) pixels. */
+  itkGetConstMacro(Minimum, PixelType);
+  itkGetConstMacro(Maximum, PixelType);
+  itkGetConstMacro(Mean, double);
+  itkGetConstMacro(NumberOfPixels, unsigned long);
+
+  /** Number of pixels in each bin of the histogram. */
+  const FrequencyContainerType & GetFrequencies() const
+  {
+    return m_Frequencies;
+  }
+  unsigned long GetFrequency(unsigned long bin) const
+  {
+    return m_Frequencies[bin];
+  }
+  /** Number of pixels in the histogram. */
+  itkGetConstMacro(TotalFrequency, unsigned long);
+
+  double GetBinMinimum(unsigned long bin) const
+  {
+    return m_Boundaries[bin];
+  }
+  double GetBinMaximum(unsigned long bin) const
+  {
+    return m_Boundaries[bin + 1];
+  }
+
+  /** Value below which the fraction p of the histogram lies, interpolated
+   * within the bins as itk::Statistics::Histogram::Quantile. */
+  double Quantile(double p) const;
+
+protected:
+  ThreadedImageHistogramCalculator();
+  virtual ~ThreadedImageHistogramCalculator() {};
+  void PrintSelf(std::ostream& os, Indent indent) const;
+
+private:
+  ThreadedImageHistogramCalculator(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  enum ThreadTaskEnumType { STATISTICS_TASK,
+                            HISTOGRAM_TASK };
+
+  struct ThreadStatistics
+    {
+    PixelType     Minimum;
+    PixelType     Maximum;
+    double        Sum;
+    unsigned long Count;
+    };
+
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback(void * arg);
+
+  void RunThreads(ThreadTaskEnumType task);
+
+  void ThreadedComputeStatistics(unsigned int threadId, unsigned int numberOfThreads);
+
+  void ThreadedComputeHistogram(unsigned int threadId, unsigned int numberOfThreads);
+
+  // Get the bin of a value, false if it is outside of the histogram
+  bool GetBin(PixelType value, unsigned long & bin) const
+  {
+    const double v = static_cast<double>(value);
+    if ( v < m_Boundaries.front() || v > m_Boundaries.back() )
+      {
+      return false;
+      }
+    if ( m_BinRule == UPPER_INCLUSIVE_BINS )
+      {
+      bin = ( v == m_Boundaries.front() ) ? 0 :
+        static_cast<unsigned long>( ceil( ( v - m_Boundaries.front() ) * m_BinMultiplier ) ) - 1;
+      }
+    else if ( m_UniformBins )
+      {
+      bin = static_cast<unsigned long>( ( v - m_Boundaries.front() ) * m_BinMultiplier );
+      }
+    else
+      {
+      bin = static_cast<unsigned long>(
+        std::upper_bound( m_Boundaries.begin(), m_Boundaries.end() - 1, v ) - m_Boundaries.begin() ) - 1;
+      }
+    if ( bin >= m_NumberOfBins ) // the maximum, or rounding errors
+      {
+      bin = m_NumberOfBins - 1;
+      }
+    return true;
+  }
+
+  ImageConstPointer     m_Image;
+  MaskImageConstPointer m_MaskImage;
+
+  int                   m_NumberOfThreads;
+  MultiThreader::Pointer m_Threader;
+  ThreadTaskEnumType    m_ThreadTask;
+
+  unsigned long         m_NumberOfHistogramBins;
+  double                m_HistogramMinimum;
+  double                m_HistogramMaximum;
+  std::vector<double>   m_BinBoundaries;
+  BinRuleEnumType       m_BinRule;
+
+  // Bins of the histogram being computed
+  unsigned long         m_NumberOfBins;
+  std::vector<double>   m_Boundaries;
+  bool                  m_UniformBins;
+  double                m_BinMultiplier;
+  // Integer values counted one by one, from m_FirstValue
+  bool                  m_CountValues;
+  PixelType             m_FirstValue;
+  unsigned long         m_NumberOfValues;
+
+  PixelType             m_Minimum;
+  PixelType             m_Maximum;
+  double                m_Mean;
+  unsigned long         m_NumberOfPixels;
+
+  std::vector<ThreadStatistics>       m_ThreadStatistics;
+  std::vector<FrequencyContainerType> m_ThreadFrequencies;
+
+  FrequencyContainerType m_Frequencies;
+  unsigned long          m_TotalFrequency;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkThreadedImageHistogramCalculator.txx"
+#endif
+
+#endif
@@ -0,0 +1,421 @@
+#ifndef _itkThreadedImageHistogramCalculator_txx
+#define _itkThreadedImageHistogramCalculator_txx
+
+#include "itkThreadedImageHistogramCalculator.h"
+
+namespace itk
+{
+
+/*
+ * Constructor
+ */
+template<class TInputImage, class TMaskImage>
+ThreadedImageHistogramCalculator<TInputImage, TMaskImage>
+::ThreadedImageHistogramCalculator()
+{
+  m_Image = NULL;
+  m_MaskImage = NULL;
+  m_NumberOfThreads = MultiThreader::GetGlobalDefaultNumberOfThreads();
+  m_Threader = MultiThreader::New();
+  m_ThreadTask = STATISTICS_TASK;
+  m_NumberOfHistogramBins = 128;
+  m_HistogramMinimum = 0.0;
+  m_HistogramMaximum = 0.0;
+  m_BinRule = LOWER_INCLUSIVE_BINS;
+  m_NumberOfBins = 0;
+  m_UniformBins = true;
+  m_BinMultiplier = 0.0;
+  m_CountValues = false;
+  m_FirstValue = NumericTraits<PixelType>::Zero;
+  m_NumberOfValues = 0;
+  m_Minimum = NumericTraits<PixelType>::Zero;
+  m_Maximum = NumericTraits<PixelType>::Zero;
+  m_Mean = 0.0;
+  m_NumberOfPixels = 0;
+  m_TotalFrequency = 0;
+}
+
+template<class TInputImage, class TMaskImage>
+void
+ThreadedImageHistogramCalculator<TInputImage, TMaskImage>
+::SetBinBoundaries(const std::vector<double> & boundaries)
+{
+  m_BinBoundaries = boundaries;
+  this->Modified();
+}
+
+/*
+ * Compute the statistics, then the histogram of the whole intensity range
+ */
+template<class TInputImage, class TMaskImage>
+void
+ThreadedImageHistogramCalculator<TInputImage, TMaskImage>
+::Compute()
+{
+  this->ComputeStatistics();
+  this->SetHistogramMinimum( static_cast<double>( m_Minimum ) );
+  this->SetHistogramMaximum( static_cast<double>( m_Maximum ) );
+  this->ComputeHistogram();
+}
+
+template<class TInputImage, class TMaskImage>
+void
+ThreadedImageHistogramCalculator<TInputImage, TMaskImage>
+::ComputeStatistics()
+{
+  this->RunThreads( STATISTICS_TASK );
+
+  m_NumberOfPixels = 0;
+  m_Minimum = NumericTraits<PixelType>::Zero;
+  m_Maximum = NumericTraits<PixelType>::Zero;
+  double sum = 0.0;
+  for ( unsigned int t = 0; t < m_ThreadStatistics.size(); t++ )
+    {
+    const ThreadStatistics & statistics = m_ThreadStatistics[t];
+    if ( statistics.Count == 0 )
+      {
+      continue;
+      }
+    if ( m_NumberOfPixels == 0 || statistics.Minimum < m_Minimum )
+      {
+      m_Minimum = statistics.Minimum;
+      }
+    if ( m_NumberOfPixels == 0 || statistics.Maximum > m_Maximum )
+      {
+      m_Maximum = statistics.Maximum;
+      }
+    sum += statistics.Sum;
+    m_NumberOfPixels += statistics.Count;
+    }
+  m_Mean = m_NumberOfPixels ? sum / m_NumberOfPixels : 0.0;
+}
+
+template<class TInputImage, class TMaskImage>
+void
+ThreadedImageHistogramCalculator<TInputImage, TMaskImage>
+::ComputeHistogram()
+{
+  // Bins
+  if ( !m_BinBoundaries.empty() )
+    {
+    if ( m_BinBoundaries.size() < 2 || m_BinRule == UPPER_INCLUSIVE_BINS )
+      {
+      itkExceptionMacro(<< "The bin boundaries need at least two values and LOWER_INCLUSIVE_BINS");
+      }
+    m_Boundaries = m_BinBoundaries;
+    m_NumberOfBins = m_Boundaries.size() - 1;
+    m_UniformBins = false;
+    m_BinMultiplier = 0.0;
+    }
+  else
+    {
+    m_NumberOfBins = m_NumberOfHistogramBins;
+    const double range = m_HistogramMaximum - m_HistogramMinimum;
+    m_BinMultiplier = ( range > 0.0 ) ? static_cast<double>( m_NumberOfBins ) / range : 0.0;
+    m_Boundaries.resize( m_NumberOfBins + 1 );
+    for ( unsigned long j = 0; j < m_NumberOfBins; j++ )
+      {
+      m_Boundaries[j] = m_HistogramMinimum + ( range * j ) / m_NumberOfBins;
+      }
+    m_Boundaries[m_NumberOfBins] = m_HistogramMaximum;
+    m_UniformBins = true;
+    }
+
+  // Integer values in a small range are counted one by one
+  m_CountValues = false;
+  if ( NumericTraits<PixelType>::is_integer )
+    {
+    const double first = ceil( std::max( m_Boundaries.front(),
+      static_cast<double>( NumericTraits<PixelType>::NonpositiveMin() ) ) );
+    const double last = floor( std::min( m_Boundaries.back(),
+      static_cast<double>( NumericTraits<PixelType>::max() ) ) );
+    if ( first <= last && last - first < MaximumNumberOfValueBins )
+      {
+      m_CountValues = true;
+      m_FirstValue = static_cast<PixelType>( first );
+      m_NumberOfValues = static_cast<unsigned long>( last - first ) + 1;
+      }
+    }
+
+  this->RunThreads( HISTOGRAM_TASK );
+
+  // Merge the histograms of the threads
+  m_Frequencies.assign( m_NumberOfBins, 0 );
+  if ( m_CountValues )
+    {
+    for ( unsigned long i = 0; i < m_NumberOfValues; i++ )
+      {
+      unsigned long count = 0;
+      for ( unsigned int t = 0; t < m_ThreadFrequencies.size(); t++ )
+        {
+        if ( !m_ThreadFrequencies[t].empty() )
+          {
+          count += m_ThreadFrequencies[t][i];
+          }
+        }
+      unsigned long bin;
+      if ( count && this->GetBin( static_cast<PixelType>( static_cast<double>( m_FirstValue ) + i ), bin ) )
+        {
+        m_Frequencies[bin] += count;
+        }
+      }
+    }
+  else
+    {
+    for ( unsigned int t = 0; t < m_ThreadFrequencies.size(); t++ )
+      {
+      for ( unsigned long j = 0; j < m_ThreadFrequencies[t].size(); j++ )
+        {
+        m_Frequencies[j] += m_ThreadFrequencies[t][j];
+        }
+      }
+    }
+  m_TotalFrequency = 0;
+  for ( unsigned long j = 0; j < m_NumberOfBins; j++ )
+    {
+    m_TotalFrequency += m_Frequencies[j];
+    }
+}
+
+template<class TInputImage, class TMaskImage>
+void
+ThreadedImageHistogramCalculator<TInputImage, TMaskImage>
+::ThreadedComputeStatistics(unsigned int threadId, unsigned int numberOfThreads)
+{
+  const unsigned long size = m_Image->GetBufferedRegion().GetNumberOfPixels();
+  const unsigned long begin = static_cast<unsigned long>( ( static_cast<double>( size ) * threadId ) / numberOfThreads );
+  const unsigned long end = static_cast<unsigned long>( ( static_cast<double>( size ) * ( threadId + 1 ) ) / numberOfThreads );
+  const PixelType *     buffer = m_Image->GetBufferPointer();
+  const MaskPixelType * mask = m_MaskImage ? m_MaskImage->GetBufferPointer() : 0;
+
+  PixelType     minimum = NumericTraits<PixelType>::max();
+  PixelType     maximum = NumericTraits<PixelType>::NonpositiveMin();
+  double        sum = 0.0;
+  unsigned long count = 0;
+  if ( !mask )
+    {
+    for ( unsigned long i = begin; i < end; i++ )
+      {
+      const PixelType value = buffer[i];
+      minimum = value < minimum ? value : minimum;
+      maximum = value > maximum ? value : maximum;
+      sum += static_cast<double>( value );
+      }
+    count = end - begin;
+    }
+  else
+    {
+    for ( unsigned long i = begin; i < end; i++ )
+      {
+      if ( mask[i] == NumericTraits<MaskPixelType>::Zero )
+        {
+        continue;
+        }
+      const PixelType value = buffer[i];
+      minimum = value < minimum ? value : minimum;
+      maximum = value > maximum ? value : maximum;
+      sum += static_cast<double>( value );
+      ++count;
+      }
+    }
+
+  ThreadStatistics & statistics = m_ThreadStatistics[threadId];
+  statistics.Minimum = minimum;
+  statistics.Maximum = maximum;
+  statistics.Sum = sum;
+  statistics.Count = count;
+}
+
+template<class TInputImage, class TMaskImage>
+void
+ThreadedImageHistogramCalculator<TInputImage, TMaskImage>
+::ThreadedComputeHistogram(unsigned int threadId, unsigned int numberOfThreads)
+{
+  const unsigned long size = m_Image->GetBufferedRegion().GetNumberOfPixels();
+  const unsigned long begin = static_cast<unsigned long>( ( static_cast<double>( size ) * threadId ) / numberOfThreads );
+  const unsigned long end = static_cast<unsigned long>( ( static_cast<double>( size ) * ( threadId + 1 ) ) / numberOfThreads );
+  const PixelType *     buffer = m_Image->GetBufferPointer();
+  const MaskPixelType * mask = m_MaskImage ? m_MaskImage->GetBufferPointer() : 0;
+
+  FrequencyContainerType & frequencies = m_ThreadFrequencies[threadId];
+  if ( m_CountValues )
+    {
+    // One bin per value, no floating point computation
+    frequencies.assign( m_NumberOfValues, 0 );
+    unsigned long *     counts = &frequencies[0];
+    const PixelType     first = m_FirstValue;
+    const PixelType     last = static_cast<PixelType>( static_cast<double>( first ) + ( m_NumberOfValues - 1 ) );
+    for ( unsigned long i = begin; i < end; i++ )
+      {
+      const PixelType value = buffer[i];
+      if ( value >= first && value <= last
+           && ( !mask || mask[i] != NumericTraits<MaskPixelType>::Zero ) )
+        {
+        ++counts[static_cast<unsigned long>( value - first )];
+        }
+      }
+    }
+  else
+    {
+    frequencies.assign( m_NumberOfBins, 0 );
+    unsigned long * counts = &frequencies[0];
+    unsigned long   bin;
+    for ( unsigned long i = begin; i < end; i++ )
+      {
+      if ( ( !mask || mask[i] != NumericTraits<MaskPixelType>::Zero )
+           && this->GetBin( buffer[i], bin ) )
+        {
+        ++counts[bin];
+        }
+      }
+    }
+}
+
+template<class TInputImage, class TMaskImage>
+ITK_THREAD_RETURN_TYPE
+ThreadedImageHistogramCalculator<TInputImage, TMaskImage>
+::ThreaderCallback(void * arg)
+{
+  MultiThreader::ThreadInfoStruct * info = static_cast<MultiThreader::ThreadInfoStruct *>( arg );
+  Self * calculator = static_cast<Self *>( info->UserData );
+  switch ( calculator->m_ThreadTask )
+    {
+    case STATISTICS_TASK:
+      calculator->ThreadedComputeStatistics( info->ThreadID, info->NumberOfThreads );
+      break;
+    case HISTOGRAM_TASK:
+      calculator->ThreadedComputeHistogram( info->ThreadID, info->NumberOfThreads );
+      break;
+    }
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template<class TInputImage, class TMaskImage>
+void
+ThreadedImageHistogramCalculator<TInputImage, TMaskImage>
+::RunThreads(ThreadTaskEnumType task)
+{
+  if ( !m_Image )
+    {
+    itkExceptionMacro(<< "No input image");
+    }
+  if ( m_MaskImage &&
+       m_MaskImage->GetBufferedRegion().GetSize() != m_Image->GetBufferedRegion().GetSize() )
+    {
+    itkExceptionMacro(<< "The mask image must have the same buffered region as the image");
+    }
+  const unsigned long size = m_Image->GetBufferedRegion().GetNumberOfPixels();
+  unsigned int numberOfThreads = static_cast<unsigned int>( m_NumberOfThreads );
+  if ( size < numberOfThreads )
+    {
+    numberOfThreads = size > 0 ? static_cast<unsigned int>( size ) : 1;
+    }
+
+  // The threader may run less threads, their results stay empty
+  m_ThreadTask = task;
+  ThreadStatistics noStatistics = { NumericTraits<PixelType>::Zero, NumericTraits<PixelType>::Zero, 0.0, 0 };
+  m_ThreadStatistics.assign( numberOfThreads, noStatistics );
+  m_ThreadFrequencies.assign( numberOfThreads, FrequencyContainerType() );
+  if ( numberOfThreads == 1 )
+    {
+    MultiThreader::ThreadInfoStruct info;
+    info.ThreadID = 0;
+    info.NumberOfThreads = 1;
+    info.UserData = this;
+    ThreaderCallback( &info );
+    return;
+    }
+  m_Threader->SetNumberOfThreads( numberOfThreads );
+  m_Threader->SetSingleMethod( ThreaderCallback, this );
+  m_Threader->SingleMethodExecute();
+}
+
+/*
+ * Same interpolation as itk::Statistics::Histogram::Quantile
+ */
+template<class TInputImage, class TMaskImage>
+double
+ThreadedImageHistogramCalculator<TInputImage, TMaskImage>
+::Quantile(double p) const
+{
+  if ( m_TotalFrequency == 0 )
+    {
+    return m_Boundaries.empty() ? 0.0 : m_Boundaries.front();
+    }
+  const unsigned long size = m_NumberOfBins;
+  const double        totalFrequency = static_cast<double>( m_TotalFrequency );
+  double              cumulated = 0.0;
+  double              p_n_prev = 0.0;
+  double              p_n;
+  double              f_n;
+
+  if ( p < 0.5 )
+    {
+    unsigned long n = 0;
+    p_n = 0.0;
+    do
+      {
+      f_n = static_cast<double>( m_Frequencies[n] );
+      cumulated += f_n;
+      p_n_prev = p_n;
+      p_n = cumulated / totalFrequency;
+      n++;
+      }
+    while ( n < size && p_n < p );
+
+    const double binProportion = f_n / totalFrequency;
+    const double min = this->GetBinMinimum( n - 1 );
+    const double interval = this->GetBinMaximum( n - 1 ) - min;
+    return min + ( ( p - p_n_prev ) / binProportion ) * interval;
+    }
+  else
+    {
+    long          n = static_cast<long>( size ) - 1;
+    unsigned long m = 0;
+    p_n = 1.0;
+    do
+      {
+      f_n = static_cast<double>( m_Frequencies[n] );
+      cumulated += f_n;
+      p_n_prev = p_n;
+      p_n = 1.0 - cumulated / totalFrequency;
+      n--;
+      m++;
+      }
+    while ( m < size && p_n > p );
+
+    const double binProportion = f_n / totalFrequency;
+    const double max = this->GetBinMaximum( n + 1 );
+    const double interval = max - this->GetBinMinimum( n + 1 );
+    return max - ( ( p_n_prev - p ) / binProportion ) * interval;
+    }
+}
+
+template<class TInputImage, class TMaskImage>
+void
+ThreadedImageHistogramCalculator<TInputImage, TMaskImage>
+::PrintSelf( std::ostream& os, Indent indent ) const
+{
+  Superclass::PrintSelf(os,indent);
+
+  os << indent << "Image: " << m_Image.GetPointer() << std::endl;
+  os << indent << "MaskImage: " << m_MaskImage.GetPointer() << std::endl;
+  os << indent << "NumberOfThreads: " << m_NumberOfThreads << std::endl;
+  os << indent << "NumberOfHistogramBins: " << m_NumberOfHistogramBins << std::endl;
+  os << indent << "HistogramMinimum: " << m_HistogramMinimum << std::endl;
+  os << indent << "HistogramMaximum: " << m_HistogramMaximum << std::endl;
+  os << indent << "NumberOfBinBoundaries: " << m_BinBoundaries.size() << std::endl;
+  os << indent << "BinRule: "
+     << ( m_BinRule == UPPER_INCLUSIVE_BINS ? "UPPER_INCLUSIVE_BINS" : "LOWER_INCLUSIVE_BINS" ) << std::endl;
+  os << indent << "Minimum: "
+     << static_cast<typename NumericTraits<PixelType>::PrintType>( m_Minimum ) << std::endl;
+  os << indent << "Maximum: "
+     << static_cast<typename NumericTraits<PixelType>::PrintType>( m_Maximum ) << std::endl;
+  os << indent << "Mean: " << m_Mean << std::endl;
+  os << indent << "NumberOfPixels: " << m_NumberOfPixels << std::endl;
+  os << indent << "TotalFrequency: " << m_TotalFrequency << std::endl;
+}
+
+} // end namespace itk
+
+#endif
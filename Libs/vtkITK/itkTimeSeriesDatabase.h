@@ -5,16 +5,12 @@
 #include <itkImage.h>
 #include <itkArray.h>
 #include <itkImageSource.h>
+#include <itkMultiThreader.h>
 #include <iostream>
 #include <fstream>
+#include <vector>
 #include <itkTimeSeriesDatabaseHelper.h>
 
-#define TimeSeriesBlockSize 16
-#define TimeSeriesBlockSizeP2 TimeSeriesBlockSize*TimeSeriesBlockSize
-#define TimeSeriesBlockSizeP3 TimeSeriesBlockSize*TimeSeriesBlockSize*TimeSeriesBlockSize
-#define TimeSeriesVolumeBlockSize TimeSeriesBlockSize*TimeSeriesBlockSize*TimeSeriesBlockSize
-#define TimeSeriesVolumeBlockSizeP3 TimeSeriesVolumeBlockSize*TimeSeriesVolumeBlockSize*TimeSeriesVolumeBlockSize
-
 namespace itk
 {
 
@@ -24,6 +20,14 @@ namespace itk
  * The main idea behind TimeSeriesDatabase is to have a representation of a 4 dimensional dataset that
  * is larger than main memory, but may still be accessed in a rapid manner.  Though not strictly
  * ITK conforming, this initial pass is strictly 4 dimensional datasets.
+ *
+ * The volumes are split into cubic blocks of BlockSize^3 voxels, the size of
+ * the blocks is chosen when the database is created and is stored in its
+ * header. The blocks intersecting the requested region are read by several
+ * threads and kept in a cache limited to CacheSizeInMiB. After an update,
+ * a background thread reads the same blocks for the PrefetchTimePoints next
+ * images so that playing the series as a cine loop only waits for the disk
+ * when the cache is too small to hold the prefetched images.
  */
 template <class TPixel> class TimeSeriesDatabase : public ImageSource<Image<TPixel,3> > {
 public:
@@ -46,6 +50,9 @@ public:
   typedef typename OutputSliceType::Pointer OutputSliceTypePointer;
   typedef Array<TPixel> ArrayType;
 
+  /** Size of the blocks of the databases created without block size */
+  itkStaticConstMacro ( DefaultBlockSize, unsigned int, 16 );
+
   /** Connect to an existing TimeSeriesDatabase file on disk
    * The idea behind the Connect method is to associate this
    * class with a pre-existing self-describing file containing
@@ -62,12 +69,14 @@ public:
   /** Create a new TimeSeriesDatabase from an Archetype filename
    * Find all the volumes matching the archetype pattern, loading
    * and checking that they are all the same size.  Write the data
-   * into a series of files.  The default filesize is 1 GiB, but may
-   * be changed using the overloaded method.
+   * into a series of files.  The default filesize is 1 GiB and the
+   * default block size is DefaultBlockSize, but may be changed using the
+   * overloaded methods.
    * A call to Connect in required to open the newly created TimeSeriesDatabase.
    */
   static void CreateFromFileArchetype ( const char* filename, const char* archetype );
-  static void CreateFromFileArchetype ( const char* filename, const char* archetype, unsigned long BlocksPerFile );
+  static void CreateFromFileArchetype ( const char* filename, const char* archetype, unsigned long FileSize );
+  static void CreateFromFileArchetype ( const char* filename, const char* archetype, unsigned long FileSize, unsigned int BlockSize );
 
   /** Set the image to be read when GenerateData is called.
    * This method selects the image to be returned by an Update
@@ -83,6 +92,8 @@ public:
   itkGetMacro ( OutputRegion, typename OutputImageType::RegionType );
   itkGetMacro ( OutputOrigin, typename OutputImageType::PointType );
   itkGetMacro ( OutputDirection, typename OutputImageType::DirectionType );
+  /** Edge length in voxels of the blocks of the database */
+  itkGetMacro ( BlockSize, unsigned int );
 
   /** Standard method for a ImageSource object */
   virtual void GenerateOutputInformation(void);
@@ -101,6 +112,14 @@ public:
    */
   float GetCacheSizeInMiB ();
 
+  /** Number of images after CurrentImage read in the background after an
+   * update. The series is considered as a loop: the first images are read
+   * after the last one. Fewer images are read when they don't fit in the
+   * cache with the current image. 0 disables the prefetching.
+   * Default is 1.
+   */
+  itkSetMacro ( PrefetchTimePoints, unsigned int );
+  itkGetMacro ( PrefetchTimePoints, unsigned int );
 
 protected:
   TimeSeriesDatabase();
@@ -114,20 +133,59 @@ protected:
   typename OutputImageType::PointType m_OutputOrigin;
   typename OutputImageType::DirectionType m_OutputDirection;
   typedef itk::TimeSeriesDatabaseHelper::counted_ptr<std::fstream> StreamPtr;
+  typedef std::vector<TPixel> BlockType;
 
-  static std::streampos CalculatePosition ( unsigned long index, unsigned long BlocksPerFile );
+  static std::streampos CalculatePosition ( unsigned long index, unsigned long BlocksPerFile, unsigned long BlockBytes );
 
   unsigned int CalculateFileIndex ( unsigned long Index );
   static unsigned int CalculateFileIndex ( unsigned long Index, unsigned long BlocksPerFile );
 
   unsigned long CalculateIndex ( Size<3> Position, int ImageCount );
-  static unsigned long CalculateIndex ( Size<3> Position, int ImageCount, unsigned int BlocksPerImage[3] );
+  static unsigned long CalculateIndex ( Size<3> Position, int ImageCount, unsigned int BlocksPerImage[3], unsigned long HeaderBlocks );
   /// Return true if this is a full block, false otherwise.  Assumes there is overlap!
   bool CalculateIntersection ( Size<3> BlockIndex, typename OutputImageType::RegionType RequestedRegion, 
                                typename OutputImageType::RegionType& BlockRegion,
                                typename OutputImageType::RegionType& ImageRegion );
   bool IsOpen() const;
 
+  /// Number of bytes of a block
+  unsigned long GetBlockBytes() const;
+  /// Read the block \a index into \a data with \a streams, the streams of the
+  /// database files are opened when needed. Thread safe as long as each
+  /// thread uses its own \a streams.
+  bool ReadBlock ( unsigned long index, std::vector<StreamPtr>& streams, TPixel* data ) const;
+  /// Copy the part of the block \a BlockIndex intersecting \a Region into
+  /// \a output. Different blocks can be copied at the same time.
+  void CopyBlock ( const TPixel* data, Size<3> BlockIndex,
+                   typename OutputImageType::RegionType Region, OutputImageType* output );
+  /// Return the blocks intersecting \a Region.
+  void GetBlockRange ( typename OutputImageType::RegionType Region, Size<3>& BlockStart, Size<3>& BlockCount ) const;
+
+  /// A block read by the decoding or the prefetching threads
+  struct BlockJob
+  {
+    Size<3> Block;
+    unsigned long Index;
+    /// Block found in the cache, 0 if it must be read into Data
+    const BlockType* Cached;
+    BlockType Data;
+  };
+  struct DecodeThreadStruct
+  {
+    Self* Filter;
+    std::vector<BlockJob>* Jobs;
+    typename OutputImageType::RegionType Region;
+    OutputImageType* Output;
+  };
+  static ITK_THREAD_RETURN_TYPE DecodeThreaderCallback ( void* arg );
+  static ITK_THREAD_RETURN_TYPE PrefetchThreaderCallback ( void* arg );
+
+  /// Start reading the blocks of \a Region for the images following
+  /// CurrentImage in a background thread.
+  void StartPrefetch ( typename OutputImageType::RegionType Region );
+  /// Stop the prefetching thread and add the blocks it has read to the cache.
+  void StopPrefetch();
+
   /// How many pixels are in the last block?
   Array<unsigned int> m_PixelRemainder;
   std::string m_Filename;
@@ -136,14 +194,19 @@ protected:
   std::vector<StreamPtr> m_DatabaseFiles;
   std::vector<std::string> m_DatabaseFileNames;
   unsigned long m_BlocksPerFile;
-
-  /// our cache
-  struct CacheBlock 
-  {
-    TPixel data[TimeSeriesBlockSize*TimeSeriesBlockSize*TimeSeriesBlockSize];
-  };
-  TimeSeriesDatabaseHelper::LRUCache<unsigned long, CacheBlock> m_Cache;
-  CacheBlock* GetCacheBlock ( unsigned long index );
+  unsigned int m_BlockSize;
+  /// Number of blocks used by the header at the beginning of the first file
+  unsigned long m_HeaderBlocks;
+
+  /// our cache, only accessed by the thread updating the filter
+  TimeSeriesDatabaseHelper::LRUCache<unsigned long, BlockType> m_Cache;
+  float m_CacheSizeInMiB;
+  BlockType* GetCacheBlock ( unsigned long index );
+
+  unsigned int m_PrefetchTimePoints;
+  int m_PrefetchThreadID;
+  volatile int m_AbortPrefetch;
+  std::vector<BlockJob> m_PrefetchJobs;
 };
 
 } // end namespace itk
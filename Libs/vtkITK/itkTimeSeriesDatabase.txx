@@ -14,10 +14,13 @@
 
 namespace itk {
 
-  // template<class TPixel> int TimeSeriesDatabase<TPixel>::BlockSize = 16;
   template<class T> T TSD_MIN ( T a, T b ) { return a < b ? a : b; }
   template<class T> T TSD_MAX ( T a, T b ) { return a > b ? a : b; }
 
+  // Space reserved for the header at the beginning of the first file,
+  // rounded up to a number of blocks.
+  static const unsigned long TSD_HEADER_BYTES = 16384;
+
   
 template <class TPixel>
 bool TimeSeriesDatabase<TPixel>::CalculateIntersection ( Size<3> BlockIndex, 
@@ -30,17 +33,17 @@ bool TimeSeriesDatabase<TPixel>::CalculateIntersection ( Size<3> BlockIndex,
   bool IsFullBlock = true;
   for ( unsigned int i = 0; i < 3; i++ )
   {
-    ImageRegion.SetIndex ( i, TSD_MAX ( (long unsigned int) RequestedRegion.GetIndex ( i ), TimeSeriesBlockSize * BlockIndex[i] ) );
-    BlockRegion.SetIndex ( i, ImageRegion.GetIndex(i) % TimeSeriesBlockSize );
+    ImageRegion.SetIndex ( i, TSD_MAX ( (long unsigned int) RequestedRegion.GetIndex ( i ), this->m_BlockSize * BlockIndex[i] ) );
+    BlockRegion.SetIndex ( i, ImageRegion.GetIndex(i) % this->m_BlockSize );
 
     // This is the end index
     long unsigned int Tmp = RequestedRegion.GetIndex ( i ) + RequestedRegion.GetSize ( i );
-    Tmp = TSD_MIN ( (long unsigned int) Tmp, TimeSeriesBlockSize * (BlockIndex[i]+1) );
+    Tmp = TSD_MIN ( (long unsigned int) Tmp, this->m_BlockSize * (BlockIndex[i]+1) );
     Tmp = Tmp - ImageRegion.GetIndex(i);
 
     ImageRegion.SetSize ( i, Tmp );
     BlockRegion.SetSize ( i, Tmp );
-    IsFullBlock = IsFullBlock & ( Tmp == TimeSeriesBlockSize );
+    IsFullBlock = IsFullBlock & ( Tmp == this->m_BlockSize );
   }
   return IsFullBlock;    
 }
@@ -57,12 +60,15 @@ bool TimeSeriesDatabase<TPixel>::IsOpen () const
 template <class TPixel>
 void TimeSeriesDatabase<TPixel>::Disconnect ()
 {
+  this->StopPrefetch();
   for ( int idx = 0; idx < this->m_DatabaseFiles.size(); idx++ )
     {
     this->m_DatabaseFiles[idx]->close();
     }
   this->m_DatabaseFiles.clear();
   this->m_DatabaseFileNames.clear();
+  // The blocks of another database must not be found in the cache
+  this->m_Cache.clear();
 }
   
 template <class TPixel>
@@ -76,23 +82,44 @@ void TimeSeriesDatabase<TPixel>::Connect ( const char* filename )
   // Open and make sure we have the correct header!
   this->m_Filename = filename;
   ::std::fstream db ( this->m_Filename.c_str(), ::std::ios::in | ::std::ios::binary );
-  // Read the first bits.
-  char* buffer = new char[TimeSeriesVolumeBlockSize*sizeof(TPixel)];
-  db.read ( buffer, TimeSeriesVolumeBlockSize * sizeof ( TPixel ) );
+  if ( !db.is_open() )
+  {
+    itkExceptionMacro ( "TimeSeriesDatabase::Connect: Can not open " << this->m_Filename );
+  }
+  // Read the first bits, version 1.0 headers fit in a block of 16^3 pixels.
+  const unsigned long HeaderBytes = TSD_MAX ( TSD_HEADER_BYTES, (unsigned long) ( 16 * 16 * 16 * sizeof ( TPixel ) ) );
+  char* buffer = new char[HeaderBytes+1];
+  db.read ( buffer, HeaderBytes );
+  buffer[db.gcount()] = '\0';
   db.close();
   // Associate it with a string
   std::string s ( buffer );
   delete[] buffer;
   ::std::istringstream o ( s );
   ::std::string foo;
-  float version;
+  float version = 0;
   o >> foo >> foo >> version;
-  if ( version != 1.0 )
+  std::string dummy;
+  if ( version == 1.0f )
+  {
+    // The blocks used to be fixed to 16^3 voxels, after a header block
+    this->m_BlockSize = 16;
+    this->m_HeaderBlocks = 1;
+  }
+  else if ( version == 1.1f )
+  {
+    o >> dummy >> this->m_BlockSize;
+    o >> dummy >> this->m_HeaderBlocks;
+  }
+  else
   {
-    itkExceptionMacro ( "TimeSeriesDatabase::Connect: Version string does not match.  Expecting 1.0, found " << version );
+    itkExceptionMacro ( "TimeSeriesDatabase::Connect: Version string does not match.  Expecting 1.0 or 1.1, found " << version );
+  }
+  if ( this->m_BlockSize == 0 )
+  {
+    itkExceptionMacro ( "TimeSeriesDatabase::Connect: Invalid block size in " << this->m_Filename );
   }
   // Start reading our data
-  std::string dummy;
   Size<3> sz;
   o >> dummy >> m_Dimensions[0] >> m_Dimensions[1] >> m_Dimensions[2] >> m_Dimensions[3];
   o >> dummy >> sz[0] >> sz[1] >> sz[2];
@@ -109,7 +136,7 @@ void TimeSeriesDatabase<TPixel>::Connect ( const char* filename )
     }
   for ( int idx = 0; idx < 3; idx++ )
     {
-    m_BlocksPerImage[idx] = (unsigned int) ceil ( m_Dimensions[idx] / (float)TimeSeriesBlockSize );
+    m_BlocksPerImage[idx] = (unsigned int) ceil ( m_Dimensions[idx] / (float)this->m_BlockSize );
     }
   // Number of files
   o >> dummy >> this->m_BlocksPerFile;
@@ -128,6 +155,9 @@ void TimeSeriesDatabase<TPixel>::Connect ( const char* filename )
     this->m_DatabaseFileNames.push_back ( Filename );
     this->m_DatabaseFiles.push_back ( StreamPtr ( new std::fstream ( Filename.c_str(), ::std::ios::in | ::std::ios::binary ) ) );
     }
+  // The number of blocks of the cache depends on the block size
+  this->SetCacheSizeInMiB ( this->m_CacheSizeInMiB );
+  this->Modified();
   /*
   std::cout << "ImageSize: " << m_OutputRegion.GetSize() << endl;
   std::cout << "ImageOrigin: " << m_OutputOrigin << endl;
@@ -151,10 +181,10 @@ unsigned int TimeSeriesDatabase<TPixel>::CalculateFileIndex ( unsigned long inde
 
 
 template <class TPixel>
-unsigned long TimeSeriesDatabase<TPixel>::CalculateIndex ( Size<3> p, int ImagePosition, unsigned int BlocksPerImage[3] )
+unsigned long TimeSeriesDatabase<TPixel>::CalculateIndex ( Size<3> p, int ImagePosition, unsigned int BlocksPerImage[3], unsigned long HeaderBlocks )
 {
-  // Remember that we use the first 16K as our header
-  unsigned long index = 1 + p[0] 
+  // Remember that we use the first blocks as our header
+  unsigned long index = HeaderBlocks + p[0] 
     + p[1] * BlocksPerImage[0]
     + p[2] * BlocksPerImage[0] * BlocksPerImage[1]
     + ImagePosition * BlocksPerImage[0] * BlocksPerImage[1] * BlocksPerImage[2];
@@ -169,28 +199,56 @@ unsigned long TimeSeriesDatabase<TPixel>::CalculateIndex ( Size<3> p, int ImageP
   t[0] = this->m_BlocksPerImage[0]; 
   t[1] = this->m_BlocksPerImage[1]; 
   t[2] = this->m_BlocksPerImage[2]; 
-  return this->CalculateIndex ( p, ImagePosition, t );
+  return this->CalculateIndex ( p, ImagePosition, t, this->m_HeaderBlocks );
 }
 
 template <class TPixel>
-::std::streampos TimeSeriesDatabase<TPixel>::CalculatePosition ( unsigned long index, unsigned long BlocksPerFile )
+::std::streampos TimeSeriesDatabase<TPixel>::CalculatePosition ( unsigned long index, unsigned long BlocksPerFile, unsigned long BlockBytes )
 {
-  ::std::streampos position = ( index % BlocksPerFile ) * sizeof ( TPixel ) * TimeSeriesVolumeBlockSize;
+  ::std::streampos position = static_cast< ::std::streamoff > ( index % BlocksPerFile ) * BlockBytes;
   return position;
 }
 
+template <class TPixel>
+unsigned long TimeSeriesDatabase<TPixel>::GetBlockBytes () const
+{
+  return (unsigned long) this->m_BlockSize * this->m_BlockSize * this->m_BlockSize * sizeof ( TPixel );
+}
+
+template <class TPixel>
+bool TimeSeriesDatabase<TPixel>::ReadBlock ( unsigned long index, std::vector<StreamPtr>& streams, TPixel* data ) const
+{
+  unsigned int FileIdx = CalculateFileIndex ( index, this->m_BlocksPerFile );
+  if ( FileIdx >= this->m_DatabaseFileNames.size() )
+    {
+    return false;
+    }
+  if ( streams.size() < this->m_DatabaseFileNames.size() )
+    {
+    streams.resize ( this->m_DatabaseFileNames.size() );
+    }
+  if ( streams[FileIdx].get() == 0 )
+    {
+    streams[FileIdx] = StreamPtr ( new std::fstream ( this->m_DatabaseFileNames[FileIdx].c_str(), ::std::ios::in | ::std::ios::binary ) );
+    }
+  std::fstream& stream = *streams[FileIdx];
+  stream.clear();
+  stream.seekg ( CalculatePosition ( index, this->m_BlocksPerFile, this->GetBlockBytes() ) );
+  stream.read ( reinterpret_cast<char*> ( data ), this->GetBlockBytes() );
+  return !stream.fail();
+}
 
 template <class TPixel>
-typename TimeSeriesDatabase<TPixel>::CacheBlock* TimeSeriesDatabase<TPixel>::GetCacheBlock ( unsigned long index )
+typename TimeSeriesDatabase<TPixel>::BlockType* TimeSeriesDatabase<TPixel>::GetCacheBlock ( unsigned long index )
 {
-  CacheBlock* Buffer = this->m_Cache.find ( index );
+  BlockType* Buffer = this->m_Cache.find ( index );
   if ( Buffer == 0 ) {
     // Fill it in
-    CacheBlock B;
-    int FileIdx = this->CalculateFileIndex ( index );
-    
-    this->m_DatabaseFiles[FileIdx]->seekg ( this->CalculatePosition ( index, this->m_BlocksPerFile ) );
-    this->m_DatabaseFiles[FileIdx]->read ( reinterpret_cast<char*> ( B.data ), TimeSeriesVolumeBlockSize * sizeof ( TPixel ) );
+    BlockType B ( this->GetBlockBytes() / sizeof ( TPixel ) );
+    if ( !this->ReadBlock ( index, this->m_DatabaseFiles, &B[0] ) )
+      {
+      itkExceptionMacro ( "TimeSeriesDatabase::GetCacheBlock: Failed to read block " << index );
+      }
     this->m_Cache.insert ( index, B );
     Buffer = this->m_Cache.find ( index );
   }
@@ -201,22 +259,28 @@ typename TimeSeriesDatabase<TPixel>::CacheBlock* TimeSeriesDatabase<TPixel>::Get
 template <class TPixel>
 void TimeSeriesDatabase<TPixel>::GetVoxelTimeSeries ( typename OutputImageType::IndexType idx, ArrayType& array )
 {
+  if ( !this->IsOpen() )
+  {
+    itkExceptionMacro ( "TimeSeriesDatabase::GetVoxelTimeSeries: not open for reading" );
+  }
+  // The prefetched blocks are added to the cache
+  this->StopPrefetch();
   // See if the index is inside the volume
   // and figure out which cache block we need
   Size<3> CurrentBlock;
   Size<3> Offset;
   for ( int i = 0; i < 3; i++ ) {
-    if ( idx[i] < 0 || idx[i] > this->m_OutputRegion.Size[i] ) {
-      throw 1;
+    if ( idx[i] < 0 || idx[i] >= (long) this->m_OutputRegion.GetSize(i) ) {
+      itkExceptionMacro ( "TimeSeriesDatabase::GetVoxelTimeSeries: " << idx << " is outside of the image" );
     }
-    CurrentBlock[i] = reinterpret_cast<unsigned long> ( idx[i] / (double)TimeSeriesBlockSize );
-    Offset[i] = idx[i] % TimeSeriesBlockSize;
+    CurrentBlock[i] = idx[i] / this->m_BlockSize;
+    Offset[i] = idx[i] % this->m_BlockSize;
   }
-  unsigned long offset = Offset[0] + Offset[1] * TimeSeriesBlockSize + Offset[2] * TimeSeriesBlockSizeP2;
-  array = ArrayType ( this->m_Dimensions[3] );
-  for ( int volume = 0; volume < this->m_Dimensions[3]; volume++ ) {
-    CacheBlock* cache = this->GetCacheBlock ( CurrentBlock, volume );
-    array[volume] = cache->data[offset];
+  unsigned long offset = Offset[0] + Offset[1] * this->m_BlockSize + Offset[2] * this->m_BlockSize * this->m_BlockSize;
+  array.SetSize ( this->m_Dimensions[3] );
+  for ( unsigned int volume = 0; volume < this->m_Dimensions[3]; volume++ ) {
+    BlockType* cache = this->GetCacheBlock ( this->CalculateIndex ( CurrentBlock, volume ) );
+    array[volume] = (*cache)[offset];
   }
 }
 
@@ -231,6 +295,86 @@ void TimeSeriesDatabase<TPixel>::GenerateOutputInformation ( )
   output->SetLargestPossibleRegion ( this->m_OutputRegion );
 }  
 
+template <class TPixel>
+void TimeSeriesDatabase<TPixel>::GetBlockRange ( typename OutputImageType::RegionType Region, Size<3>& BlockStart, Size<3>& BlockCount ) const
+{
+  for ( unsigned int i = 0; i < 3; i++ ) {
+    BlockStart[i] = (int) floor ( Region.GetIndex(i) / (double)this->m_BlockSize );
+    BlockCount[i] = (int) TSD_MAX ( 1.0, ceil ( (Region.GetIndex(i)+Region.GetSize(i)) / (double)this->m_BlockSize ) - BlockStart[i] );
+  }
+}
+
+template <class TPixel>
+void TimeSeriesDatabase<TPixel>::CopyBlock ( const TPixel* data, Size<3> CurrentBlock,
+                                             typename OutputImageType::RegionType Region, OutputImageType* output )
+{
+  typename OutputImageType::RegionType BR, IR;
+  if ( this->CalculateIntersection ( CurrentBlock, Region, BR, IR ) ) {
+    // Just iterate over whole block
+    // Good we can use an iterator!
+    ImageRegionIterator<OutputImageType> it ( output, IR );
+    it.GoToBegin();
+    const TPixel* ptr = data;
+    while ( !it.IsAtEnd() ) {
+      it.Set ( *ptr );
+      ++it;
+      ++ptr;
+    }
+  } else {
+    // Now we do it the hard way...
+    Index<3> ImageIndex;
+    Size<3> Count = BR.GetSize();
+    const unsigned long B = this->m_BlockSize;
+    unsigned int bx, by, bz, x, y, z;
+    for ( z = 0; z < Count[2]; z++ ) {
+      ImageIndex[2] = IR.GetIndex(2) + z;
+      bz = BR.GetIndex(2) + z;
+      for ( y = 0; y < Count[1]; y++ ) {
+        ImageIndex[1] = IR.GetIndex(1) + y;
+        by = BR.GetIndex(1) + y;
+        for ( x = 0; x < Count[0]; x++ ) {
+          ImageIndex[0] = IR.GetIndex(0) + x;
+          bx = BR.GetIndex(0) + x;
+          output->SetPixel ( ImageIndex, data[bx + B*by + B*B*bz] );
+        }
+      }
+    }
+  }
+}
+
+template <class TPixel>
+ITK_THREAD_RETURN_TYPE TimeSeriesDatabase<TPixel>::DecodeThreaderCallback ( void* arg )
+{
+  MultiThreader::ThreadInfoStruct* info = static_cast<MultiThreader::ThreadInfoStruct*> ( arg );
+  DecodeThreadStruct* str = static_cast<DecodeThreadStruct*> ( info->UserData );
+  std::vector<BlockJob>& jobs = *str->Jobs;
+  // Contiguous blocks for each thread, they are contiguous in the files too
+  ::size_t begin = jobs.size() * info->ThreadID / info->NumberOfThreads;
+  ::size_t end = jobs.size() * ( info->ThreadID + 1 ) / info->NumberOfThreads;
+  std::vector<StreamPtr> streams;
+  for ( ::size_t j = begin; j < end; j++ )
+    {
+    BlockJob& job = jobs[j];
+    const TPixel* data = 0;
+    if ( job.Cached )
+      {
+      data = &(*job.Cached)[0];
+      }
+    else if ( str->Filter->ReadBlock ( job.Index, streams, &job.Data[0] ) )
+      {
+      data = &job.Data[0];
+      }
+    else
+      {
+      // Reported by GenerateData
+      job.Data.clear();
+      continue;
+      }
+    str->Filter->CopyBlock ( data, job.Block, str->Region, str->Output );
+    }
+  return ITK_THREAD_RETURN_VALUE;
+}
+
 template <class TPixel>
 void TimeSeriesDatabase<TPixel>::GenerateData() 
 {
@@ -245,91 +389,154 @@ void TimeSeriesDatabase<TPixel>::GenerateData()
   {
     itkGenericExceptionMacro ( "TimeSeriesDatabase::GenerateOutputInformation: not open for reading" );
   }
+  // The prefetched blocks are added to the cache, they may be needed now
+  this->StopPrefetch();
 
   Size<3> BlockStart, BlockCount;
-  for ( unsigned int i = 0; i < 3; i++ ) {
-    BlockStart[i] = (int) floor ( Region.GetIndex(i) / (double)TimeSeriesBlockSize );
-    BlockCount[i] = (int) TSD_MAX ( 1.0, ceil ( (Region.GetIndex(i)+Region.GetSize(i)) / (double)TimeSeriesBlockSize ) - BlockStart[i] );
-  }
-
-  bool print = Region.GetIndex(0) == 0 && Region.GetIndex(1) == 0 && Region.GetIndex(2) == 80;
-  print = false;
-  if ( print ) 
-    {
-    std::cout << "GenerateData for " << output->GetRequestedRegion() << std::endl;
-    output->Print ( std::cout );
-    }
+  this->GetBlockRange ( Region, BlockStart, BlockCount );
 
+  // Fetch only the blocks we need. The cache is searched before starting
+  // the threads, they only read the missing blocks.
+  const unsigned long BlockPixels = this->GetBlockBytes() / sizeof ( TPixel );
+  std::vector<BlockJob> jobs;
+  jobs.reserve ( BlockCount[0] * BlockCount[1] * BlockCount[2] );
   Size<3> CurrentBlock;
-  // Now, read our data, caching as we go, in future, make this thread safe
-  Size<3> BlockSize = { {TimeSeriesBlockSize, TimeSeriesBlockSize, TimeSeriesBlockSize }};
-  ImageRegion<3> BlockRegion;
-  BlockRegion.SetSize ( BlockSize );
-  // Fetch only the blocks we need
   for ( CurrentBlock[2] = BlockStart[2]; CurrentBlock[2] < BlockStart[2] + BlockCount[2]; CurrentBlock[2]++ ) {
     for ( CurrentBlock[1] = BlockStart[1]; CurrentBlock[1] < BlockStart[1] + BlockCount[1]; CurrentBlock[1]++ ) {
       for ( CurrentBlock[0] = BlockStart[0]; CurrentBlock[0] < BlockStart[0] + BlockCount[0]; CurrentBlock[0]++ ) {
-        typename OutputImageType::RegionType BR, IR;
-        if ( print ) {  std::cout << "For Block Index: " << CurrentBlock << std::endl; }
-        unsigned long index = this->CalculateIndex ( CurrentBlock, this->m_CurrentImage );
-        CacheBlock* Buffer = this->GetCacheBlock ( index );
-        if ( this->CalculateIntersection ( CurrentBlock, Region, BR, IR ) ) {
-          // Just iterate over whole block
-          // Good we can use an iterator!
-          if ( print ) {
-            std::cout << "The easy way! " << std::endl;
-            std::cout << "Block Region: " << BR;
-            std::cout << "Image Region: " << IR;
-          }
-          Index<3> BlockIndex = {{ CurrentBlock[0] * TimeSeriesBlockSize,  CurrentBlock[1] * TimeSeriesBlockSize,  CurrentBlock[2] * TimeSeriesBlockSize }};
-          BlockRegion.SetIndex ( BlockIndex );
-          ImageRegionIterator<OutputImageType> it ( output, IR );
-          it.GoToBegin();
-          TPixel* ptr = Buffer->data;
-          while ( !it.IsAtEnd() ) {
-            it.Set ( *ptr );
-            ++it;
-            ++ptr;
-          }
-        } else {
-          // Now we do it the hard way...
-          Index<3> ImageIndex;
-          Size<3> Count = BR.GetSize();
-          if ( print ) {
-            std::cout << "The Hard way" << std::endl;
-            std::cout << "Count: " << Count << std::endl;
-            std::cout << "Block Region: " << BR;
-            std::cout << "Image Region: " << IR;
-            std::cout << "First voxel: " << Buffer->data[0] << std::endl;
+        BlockJob job;
+        job.Block = CurrentBlock;
+        job.Index = this->CalculateIndex ( CurrentBlock, this->m_CurrentImage );
+        job.Cached = this->m_Cache.find ( job.Index );
+        jobs.push_back ( job );
+        if ( !job.Cached )
+          {
+          jobs.back().Data.resize ( BlockPixels );
           }
-          unsigned int bx, by, bz, x, y, z;
-          for ( z = 0; z < Count[2]; z++ ) {
-            ImageIndex[2] = IR.GetIndex(2) + z;
-            bz = BR.GetIndex(2) + z;
-            for ( y = 0; y < Count[1]; y++ ) {
-              ImageIndex[1] = IR.GetIndex(1) + y;
-              by = BR.GetIndex(1) + y;
-              for ( x = 0; x < Count[0]; x++ ) {
-                ImageIndex[0] = IR.GetIndex(0) + x;
-                bx = BR.GetIndex(0) + x;
-                /*
-                int BufferIndex = bx + TimeSeriesBlockSize*by + TimeSeriesBlockSize*TimeSeriesBlockSize*bz;
-                if ( ImageIndex[0] == 45 && ImageIndex[1] == 0 && ImageIndex[2] == 0 ) {
-                  std::cout << "Index: " << ImageIndex << " Volume Value: " << output->GetPixel ( ImageIndex ) << " buffer: " << Buffer->data[BufferIndex] << std::endl;
-                std::cout << "Index: " << ImageIndex << " From " << BufferIndex << " ( " << bx << ", " << by << ", " << bz << " )\n" << std::endl;
-                }
-                */
+        }
+      }
+    }
 
-                output->SetPixel ( ImageIndex, Buffer->data[bx + TimeSeriesBlockSize*by + TimeSeriesBlockSize*TimeSeriesBlockSize*bz] );
-                }
-              }
+  DecodeThreadStruct str;
+  str.Filter = this;
+  str.Jobs = &jobs;
+  str.Region = Region;
+  str.Output = output.GetPointer();
+  MultiThreader* threader = this->GetMultiThreader();
+  threader->SetNumberOfThreads ( TSD_MAX ( 1, TSD_MIN ( (int) this->GetNumberOfThreads(), (int) jobs.size() ) ) );
+  threader->SetSingleMethod ( DecodeThreaderCallback, &str );
+  threader->SingleMethodExecute();
+
+  // The cache is only modified once all the threads are done, the cached
+  // blocks given to the threads stay valid.
+  bool failed = false;
+  for ( ::size_t j = 0; j < jobs.size(); j++ )
+    {
+    if ( jobs[j].Cached )
+      {
+      continue;
+      }
+    if ( jobs[j].Data.empty() )
+      {
+      failed = true;
+      continue;
+      }
+    this->m_Cache.insert ( jobs[j].Index, jobs[j].Data );
+    }
+  if ( failed )
+    {
+    itkExceptionMacro ( "TimeSeriesDatabase::GenerateData: Failed to read image " << this->m_CurrentImage << " from " << this->m_Filename );
+    }
+
+  this->StartPrefetch ( Region );
+}
+
+template <class TPixel>
+ITK_THREAD_RETURN_TYPE TimeSeriesDatabase<TPixel>::PrefetchThreaderCallback ( void* arg )
+{
+  Self* self = static_cast<Self*> ( static_cast<MultiThreader::ThreadInfoStruct*> ( arg )->UserData );
+  const unsigned long BlockPixels = self->GetBlockBytes() / sizeof ( TPixel );
+  std::vector<StreamPtr> streams;
+  for ( typename std::vector<BlockJob>::iterator it = self->m_PrefetchJobs.begin();
+        it != self->m_PrefetchJobs.end() && !self->m_AbortPrefetch; ++it )
+    {
+    it->Data.resize ( BlockPixels );
+    if ( !self->ReadBlock ( it->Index, streams, &it->Data[0] ) )
+      {
+      it->Data.clear();
+      }
+    }
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template <class TPixel>
+void TimeSeriesDatabase<TPixel>::StartPrefetch ( typename OutputImageType::RegionType Region )
+{
+  if ( this->m_PrefetchTimePoints == 0 || this->m_Dimensions[3] < 2 || this->m_PrefetchThreadID != -1 )
+    {
+    return;
+    }
+  Size<3> BlockStart, BlockCount;
+  this->GetBlockRange ( Region, BlockStart, BlockCount );
+  // Only prefetch the images that fit in the cache with the current one
+  unsigned long BlocksPerImage = BlockCount[0] * BlockCount[1] * BlockCount[2];
+  unsigned long CachedImages = this->m_Cache.get_maxsize() / BlocksPerImage;
+  if ( CachedImages < 2 )
+    {
+    return;
+    }
+  unsigned int TimePoints = TSD_MIN ( this->m_PrefetchTimePoints, this->m_Dimensions[3] - 1 );
+  TimePoints = (unsigned int) TSD_MIN ( (unsigned long) TimePoints, CachedImages - 1 );
+
+  this->m_PrefetchJobs.clear();
+  for ( unsigned int t = 1; t <= TimePoints; t++ )
+    {
+    unsigned int Image = ( this->m_CurrentImage + t ) % this->m_Dimensions[3];
+    Size<3> CurrentBlock;
+    for ( CurrentBlock[2] = BlockStart[2]; CurrentBlock[2] < BlockStart[2] + BlockCount[2]; CurrentBlock[2]++ ) {
+      for ( CurrentBlock[1] = BlockStart[1]; CurrentBlock[1] < BlockStart[1] + BlockCount[1]; CurrentBlock[1]++ ) {
+        for ( CurrentBlock[0] = BlockStart[0]; CurrentBlock[0] < BlockStart[0] + BlockCount[0]; CurrentBlock[0]++ ) {
+          BlockJob job;
+          job.Block = CurrentBlock;
+          job.Index = this->CalculateIndex ( CurrentBlock, Image );
+          job.Cached = 0;
+          // find() also keeps the cached blocks of the next images from
+          // being the first ones removed.
+          if ( this->m_Cache.find ( job.Index ) == 0 )
+            {
+            this->m_PrefetchJobs.push_back ( job );
             }
           }
         }
       }
     }
-  
-  return;
+  if ( this->m_PrefetchJobs.empty() )
+    {
+    return;
+    }
+  this->m_AbortPrefetch = 0;
+  this->m_PrefetchThreadID = this->GetMultiThreader()->SpawnThread ( PrefetchThreaderCallback, this );
+}
+
+template <class TPixel>
+void TimeSeriesDatabase<TPixel>::StopPrefetch()
+{
+  if ( this->m_PrefetchThreadID == -1 )
+    {
+    return;
+    }
+  this->m_AbortPrefetch = 1;
+  this->GetMultiThreader()->TerminateThread ( this->m_PrefetchThreadID );
+  this->m_PrefetchThreadID = -1;
+  for ( typename std::vector<BlockJob>::iterator it = this->m_PrefetchJobs.begin();
+        it != this->m_PrefetchJobs.end(); ++it )
+    {
+    if ( !it->Data.empty() )
+      {
+      this->m_Cache.insert ( it->Index, it->Data );
+      }
+    }
+  this->m_PrefetchJobs.clear();
 }
   
 
@@ -345,8 +552,20 @@ void TimeSeriesDatabase<TPixel>::CreateFromFileArchetype ( const char* TSDFilena
 template <class TPixel>
 void TimeSeriesDatabase<TPixel>::CreateFromFileArchetype ( const char* TSDFilename, const char* archetype, unsigned long FileSize )
 {
+  CreateFromFileArchetype ( TSDFilename, archetype, FileSize, DefaultBlockSize );
+}
 
-  unsigned long BlocksPerFile = FileSize / ( TimeSeriesVolumeBlockSize * sizeof ( TPixel ) );
+template <class TPixel>
+void TimeSeriesDatabase<TPixel>::CreateFromFileArchetype ( const char* TSDFilename, const char* archetype, unsigned long FileSize, unsigned int BlockSize )
+{
+  if ( BlockSize == 0 )
+    {
+    itkGenericExceptionMacro ( "TimeSeriesDatabase::CreateFromFileArchetype: Invalid block size " << BlockSize );
+    }
+  const unsigned long BlockPixels = (unsigned long) BlockSize * BlockSize * BlockSize;
+  const unsigned long BlockBytes = BlockPixels * sizeof ( TPixel );
+  unsigned long BlocksPerFile = TSD_MAX ( 1UL, FileSize / BlockBytes );
+  unsigned long HeaderBlocks = ( TSD_HEADER_BYTES + BlockBytes - 1 ) / BlockBytes;
 
   std::vector<std::string> candidateFiles;
   std::string fileNameCollapsed = itksys::SystemTools::CollapseFullPath( archetype);
@@ -393,7 +612,7 @@ void TimeSeriesDatabase<TPixel>::CreateFromFileArchetype ( const char* TSDFilena
   std::vector<std::string> Filenames;
   Filenames.push_back ( std::string ( TSDFilename ) );
 
-  // Start reading and writing out the images, 16x16x16 blocks at a time.
+  // Start reading and writing out the images, one block at a time.
   for ( unsigned int i = 0; i < candidateFiles.size(); i++ )
     {
     reader->SetFileName ( itksys::SystemTools::CollapseFullPath ( candidateFiles[i].c_str() ) );
@@ -424,15 +643,15 @@ void TimeSeriesDatabase<TPixel>::CreateFromFileArchetype ( const char* TSDFilena
     }
     
     // Build and write our blocks
-    TPixel buffer[TimeSeriesBlockSize*TimeSeriesBlockSize*TimeSeriesBlockSize];
-    Size<3> BlockSize = { {TimeSeriesBlockSize, TimeSeriesBlockSize, TimeSeriesBlockSize }};
+    std::vector<TPixel> buffer ( BlockPixels );
+    Size<3> BlockRegionSize = { {BlockSize, BlockSize, BlockSize }};
     ImageRegion<3> BlockRegion;
     unsigned int m_BlocksPerImage[3];
     
-    BlockRegion.SetSize ( BlockSize );
+    BlockRegion.SetSize ( BlockRegionSize );
     for ( int idx = 0; idx < 3; idx++ )
       {
-      m_BlocksPerImage[idx] = (unsigned int) ceil ( m_Dimensions[idx] / (float)TimeSeriesBlockSize );
+      m_BlocksPerImage[idx] = (unsigned int) ceil ( m_Dimensions[idx] / (float)BlockSize );
       }
     Size<3> CurrentBlock;
     for ( CurrentBlock[2] = 0; CurrentBlock[2] < m_BlocksPerImage[2]; CurrentBlock[2]++ )
@@ -443,21 +662,21 @@ void TimeSeriesDatabase<TPixel>::CreateFromFileArchetype ( const char* TSDFilena
           {
           /*
           std::cout << "Reading/Writing Block: " << CurrentBlock[0] << ", " << CurrentBlock[1] << ", " << CurrentBlock[2] << endl;
-          std::cout << "Debug: " << ( ( CurrentBlock[2] * TimeSeriesBlockSize + TimeSeriesBlockSize ) < region.GetSize()[2] ) << endl;
-          std::cout << "Debug: " << CurrentBlock[2] * TimeSeriesBlockSize + TimeSeriesBlockSize << " Region size  " << region.GetSize()[2] << endl;
+          std::cout << "Debug: " << ( ( CurrentBlock[2] * BlockSize + BlockSize ) < region.GetSize()[2] ) << endl;
+          std::cout << "Debug: " << CurrentBlock[2] * BlockSize + BlockSize << " Region size  " << region.GetSize()[2] << endl;
           */
           // Load up the block, and save it at the proper index
           // Is this block fully within the image?
-          if ( ( ( CurrentBlock[0] * TimeSeriesBlockSize + TimeSeriesBlockSize ) < region.GetSize()[0] )
-               && ( ( CurrentBlock[1] * TimeSeriesBlockSize + TimeSeriesBlockSize ) < region.GetSize()[1] )
-               && ( ( CurrentBlock[2] * TimeSeriesBlockSize + TimeSeriesBlockSize ) < region.GetSize()[2] ) )
+          if ( ( ( CurrentBlock[0] * BlockSize + BlockSize ) < region.GetSize()[0] )
+               && ( ( CurrentBlock[1] * BlockSize + BlockSize ) < region.GetSize()[1] )
+               && ( ( CurrentBlock[2] * BlockSize + BlockSize ) < region.GetSize()[2] ) )
             {
             // Good we can use an iterator!
-            Index<3> BlockIndex = { {CurrentBlock[0] * TimeSeriesBlockSize,  CurrentBlock[1] * TimeSeriesBlockSize,  CurrentBlock[2] * TimeSeriesBlockSize }};
+            Index<3> BlockIndex = { {CurrentBlock[0] * BlockSize,  CurrentBlock[1] * BlockSize,  CurrentBlock[2] * BlockSize }};
             BlockRegion.SetIndex ( BlockIndex );
             ImageRegionIteratorWithIndex<ImageType> it ( reader->GetOutput(), BlockRegion );
             it.GoToBegin();
-            TPixel* ptr = buffer;
+            TPixel* ptr = &buffer[0];
             while ( !it.IsAtEnd() )
               {
               *ptr = it.Value();
@@ -473,8 +692,8 @@ void TimeSeriesDatabase<TPixel>::CreateFromFileArchetype ( const char* TSDFilena
             Size<3> StartIndex, EndIndex;
             for ( int ii = 0; ii < 3; ii++ ) 
               {
-              StartIndex[ii] = CurrentBlock[ii]*TimeSeriesBlockSize;
-              EndIndex[ii] = TSD_MIN ( StartIndex[ii] + TimeSeriesBlockSize, region.GetSize()[ii] );
+              StartIndex[ii] = CurrentBlock[ii]*BlockSize;
+              EndIndex[ii] = TSD_MIN ( StartIndex[ii] + BlockSize, region.GetSize()[ii] );
               }            
             for ( unsigned int bz = StartIndex[2]; bz < EndIndex[2]; bz++ ) 
               {
@@ -487,15 +706,15 @@ void TimeSeriesDatabase<TPixel>::CreateFromFileArchetype ( const char* TSDFilena
                   // Put bx,by,bz into bx-xoff,by-yoff,bz-zoff
                   BlockIndex[0] = bx;
                   TPixel value = reader->GetOutput()->GetPixel ( BlockIndex );
-                  buffer[bx-StartIndex[0] + TimeSeriesBlockSize*(by-StartIndex[1]) + TimeSeriesBlockSize*TimeSeriesBlockSize*(bz-StartIndex[2])] = value;
+                  buffer[bx-StartIndex[0] + BlockSize*(by-StartIndex[1]) + BlockSize*BlockSize*(bz-StartIndex[2])] = value;
                   }
                 }
               }
             }
           // Calculate where to write...  This code is copied from CalculatePosition and CalculateIndex
-          unsigned long index = CalculateIndex ( CurrentBlock, i, m_BlocksPerImage );
+          unsigned long index = CalculateIndex ( CurrentBlock, i, m_BlocksPerImage, HeaderBlocks );
           // Adjust the position, based on the FileIndex
-          ::std::streampos position = CalculatePosition ( index, BlocksPerFile );
+          ::std::streampos position = CalculatePosition ( index, BlocksPerFile, BlockBytes );
           unsigned long FileIndex = CalculateFileIndex ( index, BlocksPerFile );
           // std::cout << "Found FileIndex : " << FileIndex << " For index: " << index << " position: " << position << std::endl;
 
@@ -510,7 +729,7 @@ void TimeSeriesDatabase<TPixel>::CreateFromFileArchetype ( const char* TSDFilena
             }
           
           db[FileIndex]->seekp ( position );
-          db[FileIndex]->write ( reinterpret_cast<char*> ( buffer ), TimeSeriesBlockSize*TimeSeriesBlockSize*TimeSeriesBlockSize*sizeof(TPixel) );
+          db[FileIndex]->write ( reinterpret_cast<char*> ( &buffer[0] ), BlockBytes );
           }
         }
       }
@@ -519,7 +738,9 @@ void TimeSeriesDatabase<TPixel>::CreateFromFileArchetype ( const char* TSDFilena
   db[0]->seekp ( 0 );
   ::std::ostringstream b;
   b << "TimeSeriesDatabase" << ::std::endl;
-  b << "Version 1.0" << ::std::endl;
+  b << "Version 1.1" << ::std::endl;
+  b << "BlockSize: " << BlockSize << std::endl;
+  b << "HeaderBlocks: " << HeaderBlocks << std::endl;
   b << "Dimensions: " << m_Dimensions[0] << " " << m_Dimensions[1] << " " << m_Dimensions[2] << " " << m_Dimensions[3] << std::endl;
   b << "ImageSize: " << m_OutputRegion.GetSize()[0] << " "<< m_OutputRegion.GetSize()[1] << " " << m_OutputRegion.GetSize()[2] << std::endl;
   b << "ImageOrigin: " << m_OutputOrigin[0] << " " << m_OutputOrigin[1] << " " << m_OutputOrigin[2] << std::endl;
@@ -541,6 +762,15 @@ void TimeSeriesDatabase<TPixel>::CreateFromFileArchetype ( const char* TSDFilena
     b << Filenames[idx] << std::endl;
     }
   // std::cout << b.str() << endl;
+  if ( b.str().size() >= HeaderBlocks * BlockBytes )
+    {
+    for ( ::size_t idx = 0; idx < db.size(); idx++ )
+      {
+      db[idx]->close();
+      }
+    itkGenericExceptionMacro ( << "TimeSeriesDatabase::CreateFromFileArchetype: the header of " << TSDFilename
+                               << " is larger than " << HeaderBlocks * BlockBytes << " bytes" );
+    }
   db[0]->write ( b.str().c_str(), strlen ( b.str().c_str() ) );
   for ( ::size_t idx = 0; idx < db.size(); idx++ )
     {
@@ -552,17 +782,19 @@ void TimeSeriesDatabase<TPixel>::CreateFromFileArchetype ( const char* TSDFilena
 template <class TPixel>
 float TimeSeriesDatabase<TPixel>::GetCacheSizeInMiB() 
 {
-  unsigned cachesize = this->m_Cache.get_maxsize();
-  return (float) cachesize * sizeof ( TPixel ) * TimeSeriesVolumeBlockSize / ( 1024*1024.);
+  return this->m_CacheSizeInMiB;
 }
 
 template <class TPixel>
 void TimeSeriesDatabase<TPixel>::SetCacheSizeInMiB ( float sz )
 {
+  // The prefetched blocks are added before the cache is resized
+  this->StopPrefetch();
+  this->m_CacheSizeInMiB = sz;
   // How many blocks is this?
-  double BlockSizeInMiB = sizeof ( TPixel ) * TimeSeriesVolumeBlockSize / ( 1024*1024.);
-  unsigned long int blocks = (unsigned long int) ceil ( sz * BlockSizeInMiB );
-  this->m_Cache.set_maxsize ( blocks );
+  double BlockSizeInMiB = this->GetBlockBytes() / ( 1024*1024.);
+  unsigned long int blocks = (unsigned long int) floor ( sz / BlockSizeInMiB );
+  this->m_Cache.set_maxsize ( TSD_MAX ( 1UL, blocks ) );
 }
 
 
@@ -570,11 +802,21 @@ void TimeSeriesDatabase<TPixel>::SetCacheSizeInMiB ( float sz )
 template <class TPixel>
 TimeSeriesDatabase<TPixel>::TimeSeriesDatabase () : m_Cache ( 1024 ){
   this->m_Dimensions.SetSize ( 4 );
+  this->m_Dimensions.Fill ( 0 );
   this->m_BlocksPerImage.SetSize ( 4 );
+  this->m_CurrentImage = 0;
+  this->m_BlocksPerFile = 1;
+  this->m_BlockSize = DefaultBlockSize;
+  this->m_HeaderBlocks = 1;
+  this->m_PrefetchTimePoints = 1;
+  this->m_PrefetchThreadID = -1;
+  this->m_AbortPrefetch = 0;
+  this->SetCacheSizeInMiB ( 256 );
 }
   
 template <class TPixel>
 TimeSeriesDatabase<TPixel>::~TimeSeriesDatabase () {
+  this->StopPrefetch();
   // m_Cache.statistics ( std::cout );
 }
   
@@ -589,6 +831,9 @@ TimeSeriesDatabase<TPixel>
   os << indent << "Dimensions: " << m_Dimensions << "\n";
   os << indent << "Filename: " << m_Filename << "\n";
   os << indent << "BlocksPerImage: " << m_BlocksPerImage[0] << " "  << "\n";
+  os << indent << "BlockSize: " << m_BlockSize << "\n";
+  os << indent << "CacheSizeInMiB: " << m_CacheSizeInMiB << "\n";
+  os << indent << "PrefetchTimePoints: " << m_PrefetchTimePoints << "\n";
   os << indent << "OutputSpacing: " << m_OutputSpacing << "\n";
   os << indent << "OutputRegion: " << m_OutputRegion;
   os << indent << "OutputOrigin: " << m_OutputOrigin << "\n";
@@ -128,8 +128,18 @@ namespace itk {
       {
       }
 
+      /// Set the maximal size of the cache, the LRU elements are
+      /// removed if the cache is larger.
+      ///
       void set_maxsize ( unsigned maxsize_ ) {
         maxsize = maxsize_;
+        while (lru_list.size() > maxsize)
+          {
+            table.erase(lru_list.back());
+            lru_list.pop_back();
+
+            IF_DEBUG(stats.removed++);
+          }
       }
 
       unsigned get_maxsize () {
@@ -25,9 +25,18 @@
 #include <itkMetaDataDictionary.h>
 #include <itkMetaDataObjectBase.h>
 #include <itkMetaDataObject.h>
+#include <itkMultiThreader.h>
+#include <itkMutexLock.h>
+#include <itkMutexLockHolder.h>
 #include <itkTimeProbe.h>
+#include <itksys/Directory.hxx>
+#include <itksys/SystemTools.hxx>
 
 // STD includes
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
 #include <vector>
 
 // Commented out redefinition of ExceptionMacro
@@ -74,7 +83,6 @@
 #include "itkArchetypeSeriesFileNames.h"
 #include "itkOrientImageFilter.h"
 #include "itkImageSeriesReader.h"
-#include "itkGDCMSeriesFileNames.h"
 #include "itkGDCMImageIO.h"
 #if ITK_VERSION_MAJOR < 4
 #include "itkBrains2MaskImageIOFactory.h"
@@ -85,6 +93,348 @@
 #include "itkAnalyzeImageIO.h"
 #endif
 
+//----------------------------------------------------------------------------
+namespace
+{
+
+/// DICOM tags read by the header scanner: the tags used to group the files
+/// of a directory into series and to sort them, and the tags analyzed by
+/// vtkITKArchetypeImageSeriesReader::AnalyzeDicomHeaders().
+enum ScannedTagType
+{
+  SeriesInstanceUIDTag = 0,
+  ContentTimeTag,
+  TriggerTimeTag,
+  EchoNumbersTag,
+  DiffusionGradientOrientationTag,
+  SliceLocationTag,
+  ImageOrientationPatientTag,
+  ImagePositionPatientTag,
+  SeriesNumberTag,
+  SequenceNameTag,
+  SliceThicknessTag,
+  RowsTag,
+  ColumnsTag,
+  InstanceNumberTag,
+  NumberOfScannedTags
+};
+
+const char* const ScannedTags[NumberOfScannedTags] =
+{
+  "0020|000e",
+  "0008|0033",
+  "0018|1060",
+  "0018|0086",
+  "0010|9089",
+  "0020|1041",
+  "0020|0037",
+  "0020|0032",
+  "0020|0011",
+  "0018|0024",
+  "0018|0050",
+  "0028|0010",
+  "0028|0011",
+  "0020|0013"
+};
+
+/// Values of the scanned tags of a file, empty if the file is not a
+/// readable DICOM file.
+typedef std::vector<std::string> DicomHeaderType;
+
+/// Result of the scan of a directory, cached until the modification time
+/// of the directory changes.
+struct DicomDirectoryType
+{
+  DicomDirectoryType() : ModifiedTime(0) {}
+  long int ModifiedTime;
+  /// Sorted names (without path) of the files of each series
+  std::vector<std::vector<std::string> > Series;
+  /// Headers of the DICOM files of the directory, by file name (without
+  /// path)
+  std::map<std::string, DicomHeaderType> Headers;
+};
+
+typedef std::map<std::string, DicomDirectoryType> DicomDirectoryCacheType;
+DicomDirectoryCacheType DicomDirectoryCache;
+itk::SimpleMutexLock DicomDirectoryCacheLock;
+
+struct DicomHeaderScanType
+{
+  const std::vector<std::string>* FileNames;
+  std::vector<DicomHeaderType>* Headers;
+};
+
+//----------------------------------------------------------------------------
+ITK_THREAD_RETURN_TYPE DicomHeaderScanCallback(void* arg)
+{
+  itk::MultiThreader::ThreadInfoStruct* info =
+    static_cast<itk::MultiThreader::ThreadInfoStruct*>(arg);
+  DicomHeaderScanType* scan = static_cast<DicomHeaderScanType*>(info->UserData);
+
+  // Each thread reads every NumberOfThreads-th file with its own ImageIO.
+  itk::GDCMImageIO::Pointer gdcmIO = itk::GDCMImageIO::New();
+  for (size_t f = info->ThreadID; f < scan->FileNames->size();
+       f += info->NumberOfThreads)
+    {
+    const std::string& fileName = (*scan->FileNames)[f];
+    DicomHeaderType& header = (*scan->Headers)[f];
+    header.clear();
+    try
+      {
+      if (!gdcmIO->CanReadFile(fileName.c_str()))
+        {
+        continue;
+        }
+      gdcmIO->SetFileName(fileName);
+      gdcmIO->ReadImageInformation();
+      }
+    catch (...)
+      {
+      continue;
+      }
+    itk::MetaDataDictionary& dict = gdcmIO->GetMetaDataDictionary();
+    header.resize(NumberOfScannedTags);
+    for (int t = 0; t < NumberOfScannedTags; ++t)
+      {
+      itk::ExposeMetaData<std::string>(dict, ScannedTags[t], header[t]);
+      }
+    }
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+/// Read the headers of \a fileNames with as many threads as ITK uses by
+/// default.
+void ReadDicomHeaders(const std::vector<std::string>& fileNames,
+                      std::vector<DicomHeaderType>& headers)
+{
+  headers.clear();
+  headers.resize(fileNames.size());
+  if (fileNames.empty())
+    {
+    return;
+    }
+  DicomHeaderScanType scan;
+  scan.FileNames = &fileNames;
+  scan.Headers = &headers;
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  int numberOfThreads = std::min(
+    static_cast<int>(fileNames.size()),
+    static_cast<int>(itk::MultiThreader::GetGlobalDefaultNumberOfThreads()));
+  threader->SetNumberOfThreads(std::max(numberOfThreads, 1));
+  threader->SetSingleMethod(DicomHeaderScanCallback, &scan);
+  threader->SingleMethodExecute();
+}
+
+//----------------------------------------------------------------------------
+/// Identifier of the series of a file. As for itk::GDCMSeriesFileNames, the
+/// files of a series instance UID that differ by their series number,
+/// sequence name, slice thickness or size are put in different series.
+std::string GetSeriesIdentifier(const DicomHeaderType& header)
+{
+  std::string identifier = header[SeriesInstanceUIDTag];
+  const int details[] =
+    { SeriesNumberTag, SequenceNameTag, SliceThicknessTag, RowsTag, ColumnsTag };
+  for (unsigned int d = 0; d < sizeof(details) / sizeof(int); ++d)
+    {
+    identifier += "." + header[details[d]];
+    }
+  return identifier;
+}
+
+//----------------------------------------------------------------------------
+struct SliceKeyCompare
+{
+  bool operator()(const std::pair<double, std::string>& a,
+                  const std::pair<double, std::string>& b)const
+  {
+    return a.first < b.first;
+  }
+};
+
+//----------------------------------------------------------------------------
+/// Sort the files of a series along the normal of their image orientation,
+/// or by instance number if some files have no position, or by file name
+/// otherwise (the order of itk::GDCMSeriesFileNames).
+void SortSeries(std::vector<std::string>& fileNames,
+                const std::map<std::string, DicomHeaderType>& headers)
+{
+  std::vector<std::pair<double, std::string> > positionKeys;
+  std::vector<std::pair<double, std::string> > instanceKeys;
+  double normal[3] = {0., 0., 0.};
+  bool hasNormal = false;
+  for (size_t f = 0; f < fileNames.size(); ++f)
+    {
+    const DicomHeaderType& header = headers.find(fileNames[f])->second;
+    float orientation[6];
+    float position[3];
+    if (!hasNormal &&
+        sscanf(header[ImageOrientationPatientTag].c_str(),
+               "%f\\%f\\%f\\%f\\%f\\%f", orientation, orientation + 1,
+               orientation + 2, orientation + 3, orientation + 4,
+               orientation + 5) == 6)
+      {
+      normal[0] = orientation[1] * orientation[5] - orientation[2] * orientation[4];
+      normal[1] = orientation[2] * orientation[3] - orientation[0] * orientation[5];
+      normal[2] = orientation[0] * orientation[4] - orientation[1] * orientation[3];
+      hasNormal = true;
+      }
+    if (hasNormal &&
+        sscanf(header[ImagePositionPatientTag].c_str(), "%f\\%f\\%f",
+               position, position + 1, position + 2) == 3)
+      {
+      positionKeys.push_back(std::make_pair(
+        normal[0] * position[0] + normal[1] * position[1] + normal[2] * position[2],
+        fileNames[f]));
+      }
+    if (!header[InstanceNumberTag].empty())
+      {
+      instanceKeys.push_back(std::make_pair(
+        atof(header[InstanceNumberTag].c_str()), fileNames[f]));
+      }
+    }
+
+  std::vector<std::pair<double, std::string> >* keys = 0;
+  if (positionKeys.size() == fileNames.size())
+    {
+    keys = &positionKeys;
+    }
+  else if (instanceKeys.size() == fileNames.size())
+    {
+    keys = &instanceKeys;
+    }
+  if (!keys)
+    {
+    std::sort(fileNames.begin(), fileNames.end());
+    return;
+    }
+  std::stable_sort(keys->begin(), keys->end(), SliceKeyCompare());
+  for (size_t f = 0; f < fileNames.size(); ++f)
+    {
+    fileNames[f] = (*keys)[f].second;
+    }
+}
+
+//----------------------------------------------------------------------------
+/// Scan the DICOM files of \a directory, group them into series and sort
+/// each series. The result is cached until the modification time of the
+/// directory changes (a file is added, removed or renamed).
+DicomDirectoryType ScanDicomDirectory(const std::string& directory)
+{
+  std::string path = itksys::SystemTools::CollapseFullPath(directory.c_str());
+  long int modifiedTime = itksys::SystemTools::ModifiedTime(path.c_str());
+  {
+  itk::MutexLockHolder<itk::SimpleMutexLock> lockHolder(DicomDirectoryCacheLock);
+  DicomDirectoryCacheType::const_iterator cached =
+    DicomDirectoryCache.find(path);
+  if (cached != DicomDirectoryCache.end() &&
+      cached->second.ModifiedTime == modifiedTime)
+    {
+    return cached->second;
+    }
+  }
+
+  std::vector<std::string> names;
+  std::vector<std::string> fileNames;
+  itksys::Directory dir;
+  if (dir.Load(path.c_str()))
+    {
+    for (unsigned long i = 0; i < dir.GetNumberOfFiles(); ++i)
+      {
+      std::string fileName = path + "/" + dir.GetFile(i);
+      if (!itksys::SystemTools::FileIsDirectory(fileName.c_str()))
+        {
+        names.push_back(dir.GetFile(i));
+        fileNames.push_back(fileName);
+        }
+      }
+    }
+  std::vector<DicomHeaderType> headers;
+  ReadDicomHeaders(fileNames, headers);
+
+  DicomDirectoryType scan;
+  scan.ModifiedTime = modifiedTime;
+  std::map<std::string, size_t> seriesIndices;
+  for (size_t f = 0; f < fileNames.size(); ++f)
+    {
+    if (headers[f].empty())
+      {
+      continue;
+      }
+    scan.Headers[names[f]] = headers[f];
+    std::string identifier = GetSeriesIdentifier(headers[f]);
+    std::map<std::string, size_t>::iterator it = seriesIndices.find(identifier);
+    if (it == seriesIndices.end())
+      {
+      it = seriesIndices.insert(
+        std::make_pair(identifier, scan.Series.size())).first;
+      scan.Series.push_back(std::vector<std::string>());
+      }
+    scan.Series[it->second].push_back(names[f]);
+    }
+  for (size_t s = 0; s < scan.Series.size(); ++s)
+    {
+    SortSeries(scan.Series[s], scan.Headers);
+    }
+
+  itk::MutexLockHolder<itk::SimpleMutexLock> lockHolder(DicomDirectoryCacheLock);
+  DicomDirectoryCache[path] = scan;
+  return scan;
+}
+
+//----------------------------------------------------------------------------
+/// Get the headers of \a fileNames from the directory cache, the files
+/// that are not cached are read in parallel.
+void GetDicomHeaders(const std::vector<std::string>& fileNames,
+                     std::vector<DicomHeaderType>& headers)
+{
+  headers.clear();
+  headers.resize(fileNames.size());
+  std::vector<std::string> missingFileNames;
+  std::vector<size_t> missingIndices;
+  {
+  std::map<std::string, bool> upToDateDirectories;
+  itk::MutexLockHolder<itk::SimpleMutexLock> lockHolder(DicomDirectoryCacheLock);
+  for (size_t f = 0; f < fileNames.size(); ++f)
+    {
+    std::string fileName =
+      itksys::SystemTools::CollapseFullPath(fileNames[f].c_str());
+    std::string path = itksys::SystemTools::GetFilenamePath(fileName);
+    DicomDirectoryCacheType::const_iterator cached =
+      DicomDirectoryCache.find(path);
+    if (cached != DicomDirectoryCache.end() &&
+        upToDateDirectories.find(path) == upToDateDirectories.end())
+      {
+      upToDateDirectories[path] = (cached->second.ModifiedTime ==
+        itksys::SystemTools::ModifiedTime(path.c_str()));
+      }
+    std::map<std::string, DicomHeaderType>::const_iterator header;
+    if (cached != DicomDirectoryCache.end() && upToDateDirectories[path] &&
+        (header = cached->second.Headers.find(
+          itksys::SystemTools::GetFilenameName(fileName)))
+          != cached->second.Headers.end())
+      {
+      headers[f] = header->second;
+      }
+    else
+      {
+      missingFileNames.push_back(fileNames[f]);
+      missingIndices.push_back(f);
+      }
+    }
+  }
+  std::vector<DicomHeaderType> missingHeaders;
+  ReadDicomHeaders(missingFileNames, missingHeaders);
+  for (size_t m = 0; m < missingIndices.size(); ++m)
+    {
+    headers[missingIndices[m]] = missingHeaders[m];
+    }
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
 vtkCxxRevisionMacro(vtkITKArchetypeImageSeriesReader, "$Revision$");
 vtkStandardNewMacro(vtkITKArchetypeImageSeriesReader);
 
@@ -307,7 +657,6 @@ void vtkITKArchetypeImageSeriesReader::ExecuteInformation()
 {
   vtkImageData *output = this->GetOutput();
   std::vector<std::string> candidateFiles;
-  std::vector<std::string> candidateSeries;
   int extent[6];  
   std::string fileNameCollapsed = itksys::SystemTools::CollapseFullPath( this->Archetype);
 
@@ -374,29 +723,33 @@ void vtkITKArchetypeImageSeriesReader::ExecuteInformation()
   {
     if ( isDicomFile && !this->GetSingleFile() )
     {
-      typedef itk::GDCMSeriesFileNames DICOMNameGeneratorType;
-      DICOMNameGeneratorType::Pointer inputImageFileGenerator = DICOMNameGeneratorType::New();
       std::string fileNameName = itksys::SystemTools::GetFilenameName( this->Archetype );
       std::string fileNamePath = itksys::SystemTools::GetFilenamePath( this->Archetype );
       if (fileNamePath == "")
       {
         fileNamePath = ".";
       }
-      inputImageFileGenerator->SetDirectory( fileNamePath );
 
-      // determine if the file is diffusion weighted MR file
-
-      // Find the series that contains the archetype
-      candidateSeries = inputImageFileGenerator->GetSeriesUIDs();
+      // Scan the headers of the directory in parallel (or get them from
+      // the cache if the directory didn't change since the last scan).
+      DicomDirectoryType directoryScan = ScanDicomDirectory( fileNamePath );
+      std::vector<std::vector<std::string> > candidateSeriesFiles(
+        directoryScan.Series.size() );
+      for (unsigned int s = 0; s < directoryScan.Series.size(); s++)
+      {
+        for (unsigned int f = 0; f < directoryScan.Series[s].size(); f++)
+        {
+          candidateSeriesFiles[s].push_back(
+            fileNamePath + "/" + directoryScan.Series[s][f] );
+        }
+      }
 
       // Find all dicom files in the directory 
-      for (unsigned int s = 0; s < candidateSeries.size(); s++)
+      for (unsigned int s = 0; s < candidateSeriesFiles.size(); s++)
       {
-        std::vector<std::string> seriesFileNames;
-        seriesFileNames = inputImageFileGenerator->GetFileNames( candidateSeries[s] ); 
-        for (unsigned int f = 0; f < seriesFileNames.size(); f++)
+        for (unsigned int f = 0; f < candidateSeriesFiles[s].size(); f++)
         {
-          this->AllFileNames.push_back( seriesFileNames[f] );
+          this->AllFileNames.push_back( candidateSeriesFiles[s][f] );
         }
       }
       //int nFiles = this->AllFileNames.size(); UNUSED
@@ -410,9 +763,9 @@ void vtkITKArchetypeImageSeriesReader::ExecuteInformation()
       // the following for loop set up candidate files with same series number 
       // that include the given Archetype;
       int found = 0;
-      for (unsigned int s = 0; s < candidateSeries.size() && found == 0; s++)
+      for (unsigned int s = 0; s < candidateSeriesFiles.size() && found == 0; s++)
       {
-        candidateFiles = inputImageFileGenerator->GetFileNames(candidateSeries[s]);
+        candidateFiles = candidateSeriesFiles[s];
         for (unsigned int f = 0; f < candidateFiles.size(); f++)
         {
           if (itksys::SystemTools::CollapseFullPath(candidateFiles[f].c_str()) ==
@@ -994,17 +1347,20 @@ void vtkITKArchetypeImageSeriesReader::AnalyzeDicomHeaders()
     return;
   }
 
-  // if Archetype is a Dicom File
-  gdcmIO->SetFileName( this->Archetype );
+  // if Archetype is a Dicom File, the headers come from the directory
+  // scan or are read in parallel
+  std::vector<DicomHeaderType> headers;
+  GetDicomHeaders( this->AllFileNames, headers );
   for (int f = 0; f < nFiles; f++)
   {
-    gdcmIO->SetFileName( this->AllFileNames[f] );
-    gdcmIO->ReadImageInformation();
-    itk::MetaDataDictionary &dict = gdcmIO->GetMetaDataDictionary();
+    if ( headers[f].empty() )
+    {
+      headers[f].resize( NumberOfScannedTags );
+    }
     std::string tagValue;
 
     // series instance UID
-    tagValue.clear(); itk::ExposeMetaData<std::string>( dict, "0020|000e", tagValue );
+    tagValue = headers[f][SeriesInstanceUIDTag];
     if ( tagValue.length() > 0 )
     {
       int idx = InsertSeriesInstanceUIDs( tagValue.c_str() );
@@ -1016,7 +1372,7 @@ void vtkITKArchetypeImageSeriesReader::AnalyzeDicomHeaders()
     }
 
     // content time
-    tagValue.clear(); itk::ExposeMetaData<std::string>( dict, "0008|0033", tagValue );
+    tagValue = headers[f][ContentTimeTag];
     if ( tagValue.length() > 0 )
     {
       int idx = InsertContentTime( tagValue.c_str() );
@@ -1028,7 +1384,7 @@ void vtkITKArchetypeImageSeriesReader::AnalyzeDicomHeaders()
     }
 
     // trigger time
-    tagValue.clear(); itk::ExposeMetaData<std::string>( dict, "0018|1060", tagValue );
+    tagValue = headers[f][TriggerTimeTag];
     if ( tagValue.length() > 0 )
     {
       int idx = InsertTriggerTime( tagValue.c_str() );
@@ -1040,7 +1396,7 @@ void vtkITKArchetypeImageSeriesReader::AnalyzeDicomHeaders()
     }
 
     // echo numbers
-    tagValue.clear(); itk::ExposeMetaData<std::string>( dict, "0018|0086", tagValue );
+    tagValue = headers[f][EchoNumbersTag];
     if ( tagValue.length() > 0 )
     {
       int idx = InsertEchoNumbers( tagValue.c_str() );
@@ -1052,7 +1408,7 @@ void vtkITKArchetypeImageSeriesReader::AnalyzeDicomHeaders()
     }
     
     // diffision gradient orientation
-    tagValue.clear(); itk::ExposeMetaData<std::string>( dict, "0010|9089", tagValue );
+    tagValue = headers[f][DiffusionGradientOrientationTag];
     if ( tagValue.length() > 0 )
     {
       float a[3];
@@ -1066,7 +1422,7 @@ void vtkITKArchetypeImageSeriesReader::AnalyzeDicomHeaders()
     }
 
     // slice location
-    tagValue.clear(); itk::ExposeMetaData<std::string>( dict, "0020|1041", tagValue );
+    tagValue = headers[f][SliceLocationTag];
     if ( tagValue.length() > 0 )
     {
       float a;
@@ -1080,7 +1436,7 @@ void vtkITKArchetypeImageSeriesReader::AnalyzeDicomHeaders()
     }
 
     // image orientation patient
-    tagValue.clear(); itk::ExposeMetaData<std::string>( dict, "0020|0037", tagValue );
+    tagValue = headers[f][ImageOrientationPatientTag];
     if ( tagValue.length() > 0 )
     {
       float a[6];
@@ -1093,7 +1449,7 @@ void vtkITKArchetypeImageSeriesReader::AnalyzeDicomHeaders()
       this->IndexImageOrientationPatient[f] = -1;
     }
     // image position patient
-    tagValue.clear(); itk::ExposeMetaData<std::string>( dict, "0020|0032", tagValue );
+    tagValue = headers[f][ImagePositionPatientTag];
     if( tagValue.length() > 0 )
     {
         float a[3];
@@ -20,9 +20,151 @@
 #include "vtkPointData.h"
 #include <vtkCommand.h>
 
+#include "itkImageIOFactory.h"
+#include "itkMultiThreader.h"
 #include "itkOrientImageFilter.h"
 #include "itkImageSeriesReader.h"
 
+// STD includes
+#include <algorithm>
+#include <typeinfo>
+
+//----------------------------------------------------------------------------
+namespace
+{
+
+struct SeriesSliceReadType
+{
+  const std::vector<std::string>* FileNames;
+  char* Buffer;
+  const std::type_info* ComponentType;
+  unsigned long SliceDimensions[2];
+  size_t SliceSize;
+  bool Failed;
+};
+
+//----------------------------------------------------------------------------
+bool ReadSlice(itk::ImageIOBase* imageIO, const std::string& fileName,
+               SeriesSliceReadType* read, void* buffer)
+{
+  imageIO->SetFileName(fileName.c_str());
+  imageIO->ReadImageInformation();
+
+  // Only 2D slices of the scalar type of the output can be read in place,
+  // anything else requires the conversions of itk::ImageSeriesReader.
+  unsigned int dimensions = imageIO->GetNumberOfDimensions();
+  if (dimensions < 2 || (dimensions > 2 && imageIO->GetDimensions(2) != 1) ||
+      imageIO->GetDimensions(0) != read->SliceDimensions[0] ||
+      imageIO->GetDimensions(1) != read->SliceDimensions[1] ||
+      imageIO->GetNumberOfComponents() != 1 ||
+      imageIO->GetComponentTypeInfo() != *read->ComponentType ||
+      imageIO->GetImageSizeInBytes() != read->SliceSize)
+    {
+    return false;
+    }
+  itk::ImageIORegion ioRegion(dimensions);
+  for (unsigned int d = 0; d < dimensions; ++d)
+    {
+    ioRegion.SetSize(d, imageIO->GetDimensions(d));
+    }
+  imageIO->SetIORegion(ioRegion);
+  imageIO->Read(buffer);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+ITK_THREAD_RETURN_TYPE SeriesSliceReadCallback(void* arg)
+{
+  itk::MultiThreader::ThreadInfoStruct* info =
+    static_cast<itk::MultiThreader::ThreadInfoStruct*>(arg);
+  SeriesSliceReadType* read = static_cast<SeriesSliceReadType*>(info->UserData);
+
+  // Each thread decodes every NumberOfThreads-th slice with its own ImageIO.
+  itk::ImageIOBase::Pointer imageIO;
+  for (size_t z = info->ThreadID;
+       z < read->FileNames->size() && !read->Failed;
+       z += info->NumberOfThreads)
+    {
+    const std::string& fileName = (*read->FileNames)[z];
+    try
+      {
+      // The slices of a series have the same format, the ImageIO found
+      // for the first one is used for the others.
+      if (imageIO.IsNull())
+        {
+        imageIO = itk::ImageIOFactory::CreateImageIO(
+          fileName.c_str(), itk::ImageIOFactory::ReadMode);
+        }
+      if (imageIO.IsNull() ||
+          !ReadSlice(imageIO, fileName, read, read->Buffer + z * read->SliceSize))
+        {
+        read->Failed = true;
+        }
+      }
+    catch (...)
+      {
+      read->Failed = true;
+      }
+    }
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+/// Read the slices of \a reader in parallel into a new image that has the
+/// information (origin, spacing, direction, region) computed by
+/// \a reader. Return 0 if the series can't be read this way.
+template <class TImage>
+typename TImage::Pointer ReadSeriesInParallel(itk::ImageSeriesReader<TImage>* reader)
+{
+  typedef typename TImage::PixelType PixelType;
+  const std::vector<std::string>& fileNames = reader->GetFileNames();
+  typename TImage::Pointer image;
+  try
+    {
+    reader->UpdateOutputInformation();
+    }
+  catch (...)
+    {
+    return image;
+    }
+  typename TImage::RegionType region =
+    reader->GetOutput()->GetLargestPossibleRegion();
+  if (region.GetSize()[2] != fileNames.size())
+    {
+    return image;
+    }
+
+  image = TImage::New();
+  image->CopyInformation(reader->GetOutput());
+  image->SetRegions(region);
+  image->Allocate();
+
+  SeriesSliceReadType read;
+  read.FileNames = &fileNames;
+  read.Buffer = reinterpret_cast<char*>(image->GetBufferPointer());
+  read.ComponentType = &typeid(PixelType);
+  read.SliceDimensions[0] = region.GetSize()[0];
+  read.SliceDimensions[1] = region.GetSize()[1];
+  read.SliceSize = region.GetSize()[0] * region.GetSize()[1] * sizeof(PixelType);
+  read.Failed = false;
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  int numberOfThreads = std::min(
+    static_cast<int>(fileNames.size()),
+    static_cast<int>(itk::MultiThreader::GetGlobalDefaultNumberOfThreads()));
+  threader->SetNumberOfThreads(std::max(numberOfThreads, 1));
+  threader->SetSingleMethod(SeriesSliceReadCallback, &read);
+  threader->SingleMethodExecute();
+  if (read.Failed)
+    {
+    image = 0;
+    }
+  return image;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
 vtkCxxRevisionMacro(vtkITKArchetypeImageSeriesScalarReader, "$Revision$");
 vtkStandardNewMacro(vtkITKArchetypeImageSeriesScalarReader);
 
@@ -30,6 +172,7 @@ vtkStandardNewMacro(vtkITKArchetypeImageSeriesScalarReader);
 //----------------------------------------------------------------------------
 vtkITKArchetypeImageSeriesScalarReader::vtkITKArchetypeImageSeriesScalarReader()
 {
+  this->ParallelSeriesRead = 1;
 }
 
 //----------------------------------------------------------------------------
@@ -42,6 +185,7 @@ void vtkITKArchetypeImageSeriesScalarReader::PrintSelf(ostream& os, vtkIndent in
 {
   this->Superclass::PrintSelf(os,indent);
   os << indent << "vtk ITK Archetype Image Series Scalar Reader\n";
+  os << indent << "ParallelSeriesRead: " << this->ParallelSeriesRead << "\n";
 }
 
 //----------------------------------------------------------------------------
@@ -70,6 +214,7 @@ void vtkITKArchetypeImageSeriesScalarReader::ExecuteData(vtkDataObject *output)
       typedef itk::Image<type,3> image##typeN;\
       typedef itk::ImageSource<image##typeN> FilterType; \
       FilterType::Pointer filter; \
+      image##typeN::Pointer seriesImage##typeN; \
       itk::ImageSeriesReader<image##typeN>::Pointer reader##typeN = \
           itk::ImageSeriesReader<image##typeN>::New(); \
           itk::CStyleCommand::Pointer pcl=itk::CStyleCommand::New(); \
@@ -78,6 +223,10 @@ void vtkITKArchetypeImageSeriesScalarReader::ExecuteData(vtkDataObject *output)
           reader##typeN->AddObserver(itk::ProgressEvent(),pcl); \
       reader##typeN->SetFileNames(this->FileNames); \
       reader##typeN->ReleaseDataFlagOn(); \
+      if (this->ParallelSeriesRead) \
+        { \
+        seriesImage##typeN = ReadSeriesInParallel<image##typeN>(reader##typeN); \
+        } \
       if (this->UseNativeCoordinateOrientation) \
         { \
         filter = reader##typeN; \
@@ -87,14 +236,25 @@ void vtkITKArchetypeImageSeriesScalarReader::ExecuteData(vtkDataObject *output)
         itk::OrientImageFilter<image##typeN,image##typeN>::Pointer orient##typeN = \
             itk::OrientImageFilter<image##typeN,image##typeN>::New(); \
         if (this->Debug) {orient##typeN->DebugOn();} \
-        orient##typeN->SetInput(reader##typeN->GetOutput()); \
+        if (seriesImage##typeN.IsNotNull()) \
+          { \
+          orient##typeN->SetInput(seriesImage##typeN); \
+          } \
+        else \
+          { \
+          orient##typeN->SetInput(reader##typeN->GetOutput()); \
+          } \
         orient##typeN->UseImageDirectionOn(); \
         orient##typeN->SetDesiredCoordinateOrientation(this->DesiredCoordinateOrientation); \
         filter = orient##typeN; \
         }\
-      filter->UpdateLargestPossibleRegion(); \
+      if (seriesImage##typeN.IsNull() || !this->UseNativeCoordinateOrientation) \
+        { \
+        filter->UpdateLargestPossibleRegion(); \
+        seriesImage##typeN = filter->GetOutput(); \
+        } \
       itk::ImportImageContainer<unsigned long, type>::Pointer PixelContainer##typeN;\
-      PixelContainer##typeN = filter->GetOutput()->GetPixelContainer();\
+      PixelContainer##typeN = seriesImage##typeN->GetPixelContainer();\
       void *ptr = static_cast<void *> (PixelContainer##typeN->GetBufferPointer());\
       (dynamic_cast<vtkImageData *>( output))->GetPointData()->GetScalars()->SetVoidArray(ptr, PixelContainer##typeN->Size(), 0);\
       PixelContainer##typeN->ContainerManageMemoryOff();\
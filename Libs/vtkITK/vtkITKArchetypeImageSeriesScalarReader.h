@@ -26,12 +26,23 @@ class VTK_ITK_EXPORT vtkITKArchetypeImageSeriesScalarReader : public vtkITKArche
   vtkTypeRevisionMacro(vtkITKArchetypeImageSeriesScalarReader,vtkITKArchetypeImageSeriesReader);
   void PrintSelf(ostream& os, vtkIndent indent);
 
+  ///
+  /// Decode the slices of a series with several threads, each slice being
+  /// read straight into its place in the output buffer. The series is read
+  /// with itk::ImageSeriesReader instead if its files are not 2D images
+  /// of the output scalar type. (Default is 1)
+  vtkGetMacro(ParallelSeriesRead, int);
+  vtkSetMacro(ParallelSeriesRead, int);
+  vtkBooleanMacro(ParallelSeriesRead, int);
+
  protected:
   vtkITKArchetypeImageSeriesScalarReader();
   ~vtkITKArchetypeImageSeriesScalarReader();
 
   void ExecuteData(vtkDataObject *data);
   static void ReadProgressCallback(itk::ProcessObject* obj,const itk::ProgressEvent&, void* data);
+
+  int ParallelSeriesRead;
   /// private:
 };
 
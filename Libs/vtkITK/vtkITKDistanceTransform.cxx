@@ -13,6 +13,7 @@
 ==========================================================================*/
 
 #include "vtkITKDistanceTransform.h"
+#include "vtkITKImageBridge.h"
 #include "vtkObjectFactory.h"
 
 #include "vtkDataArray.h"
@@ -39,32 +40,13 @@ vtkITKDistanceTransform::~vtkITKDistanceTransform()
 
 template <class T>
 void vtkITKDistanceTransformExecute(vtkITKDistanceTransform *self, vtkImageData* input,
-                vtkImageData* vtkNotUsed(output),
-                T* inPtr, T* outPtr)
+                vtkImageData* output,
+                T* inPtr)
 {
-
-  int dims[3];
-  input->GetDimensions(dims);
-  double spacing[3];
-  input->GetSpacing(spacing);
-
-  // Wrap scalars into an ITK image
-  // - mostly rely on defaults for spacing, origin etc for this filter
+  // Wrap scalars into an ITK image, no copy
   typedef itk::Image<T, 3> ImageType;
-  typename ImageType::Pointer inImage = ImageType::New();
-  inImage->GetPixelContainer()->SetImportPointer(inPtr, dims[0]*dims[1]*dims[2], false);
-  typename ImageType::RegionType region;
-  typename ImageType::IndexType index;
-  typename ImageType::SizeType size;
-  index[0] = index[1] = index[2] = 0;
-  size[0] = dims[0];
-  size[1] = dims[1];
-  size[2] = dims[2];
-  region.SetIndex(index);
-  region.SetSize(size);
-  inImage->SetLargestPossibleRegion(region);
-  inImage->SetBufferedRegion(region);
-  inImage->SetSpacing(spacing);
+  typename ImageType::Pointer inImage =
+    vtkITKWrapImageScalars<ImageType>(input, inPtr);
 
 
   // Calculate the distance transform
@@ -78,12 +60,13 @@ void vtkITKDistanceTransformExecute(vtkITKDistanceTransform *self, vtkImageData*
   dist->SetSquaredDistance(self->GetSquaredDistance());
 
   dist->SetInput( inImage );
-  dist->Update();
 
-  // Copy to the output
-  memcpy(outPtr, dist->GetOutput()->GetBufferPointer(),
-         dist->GetOutput()->GetBufferedRegion().GetNumberOfPixels() * sizeof(T));
+  // The output scalars take the buffer of the ITK output, release their
+  // memory so that both are never allocated together.
+  output->GetPointData()->GetScalars()->Initialize();
+  dist->Update();
 
+  vtkITKTakeImageScalars(dist->GetOutput(), output);
 }
 
 
@@ -115,29 +98,13 @@ void vtkITKDistanceTransform::SimpleExecute(vtkImageData *input, vtkImageData *o
 
   if (inScalars->GetNumberOfComponents() == 1 )
     {
-
-////////// These types are not defined in itk ////////////
-#undef VTK_TYPE_USE_LONG_LONG
-#undef VTK_TYPE_USE___INT64
-
-#define CALL  vtkITKDistanceTransformExecute(this, input, output, static_cast<VTK_TT *>(inPtr), static_cast<VTK_TT *>(outPtr));
-
     void* inPtr = input->GetScalarPointer();
-    void* outPtr = output->GetScalarPointer();
 
     switch (inScalars->GetDataType())
       {
-      vtkTemplateMacroCase(VTK_DOUBLE, double, CALL);                           \
-      vtkTemplateMacroCase(VTK_FLOAT, float, CALL);                             \
-      vtkTemplateMacroCase(VTK_LONG, long, CALL);                               \
-      vtkTemplateMacroCase(VTK_UNSIGNED_LONG, unsigned long, CALL);             \
-      vtkTemplateMacroCase(VTK_INT, int, CALL);                                 \
-      vtkTemplateMacroCase(VTK_UNSIGNED_INT, unsigned int, CALL);               \
-      vtkTemplateMacroCase(VTK_SHORT, short, CALL);                             \
-      vtkTemplateMacroCase(VTK_UNSIGNED_SHORT, unsigned short, CALL);           \
-      vtkTemplateMacroCase(VTK_CHAR, char, CALL);                               \
-      vtkTemplateMacroCase(VTK_SIGNED_CHAR, signed char, CALL);                 \
-      vtkTemplateMacroCase(VTK_UNSIGNED_CHAR, unsigned char, CALL);
+      vtkITKTemplateMacro(
+        vtkITKDistanceTransformExecute(this, input, output,
+                                       static_cast<VTK_TT *>(inPtr)));
       } //switch
     }
   else 
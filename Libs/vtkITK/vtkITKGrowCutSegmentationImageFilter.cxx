@@ -16,6 +16,11 @@
 #include <itkImageRegionIteratorWithIndex.h>
 #include <itkRegionOfInterestImageFilter.h>
 
+// STD includes
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
 //-----------------------------------------------------------------------------
 vtkCxxRevisionMacro(vtkITKGrowCutSegmentationImageFilter, "$Revision: 1.3 $");
 vtkStandardNewMacro(vtkITKGrowCutSegmentationImageFilter);
@@ -319,12 +324,301 @@ void vtkITKImageGrowCutExecute3D(vtkImageData *inData,
          outputImage->GetBufferedRegion().GetNumberOfPixels()*sizeof(OT) );
 }
 
+//-----------------------------------------------------------------------------
+// Seed the state with the gestures painted where the previous output was
+// empty. Return false if a voxel of the previous output was modified, the
+// state can't be updated incrementally then.
+template<class OT>
+bool vtkITKGrowCutAddGestures(const OT *gestures, const short *previousOutput,
+                              short *labels, float *strengths,
+                              vtkIdType numberOfVoxels, float seedStrength,
+                              std::vector<vtkIdType> &front)
+{
+  for (vtkIdType i = 0; i < numberOfVoxels; ++i)
+    {
+    short gesture = static_cast<short>(gestures[i]);
+    if (gesture == previousOutput[i])
+      {
+      continue;
+      }
+    if (previousOutput[i] != 0)
+      {
+      return false;
+      }
+    labels[i] = gesture;
+    strengths[i] = seedStrength;
+    front.push_back(i);
+    }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+vtkImageData* vtkITKGrowCutNewStateImage(int extent[6], int scalarType)
+{
+  vtkImageData* image = vtkImageData::New();
+  image->SetExtent(extent);
+  image->SetScalarType(scalarType);
+  image->SetNumberOfScalarComponents(1);
+  image->AllocateScalars();
+  memset(image->GetScalarPointer(), 0,
+         image->GetNumberOfPoints() * image->GetScalarSize());
+  return image;
+}
+
+//-----------------------------------------------------------------------------
+//// 3D filter keeping the state of the automaton between executions
+template<class IT1, class OT>
+void vtkITKImageGrowCutIncrementalExecute3D(vtkITKGrowCutSegmentationImageFilter *self,
+  vtkImageData *inData, IT1 *inPtr1, OT *inPtr2, OT *inPtr3, OT *output,
+  itk::CStyleCommand::Pointer progressCommand)
+{
+  int extent[6];
+  inData->GetExtent(extent);
+  vtkIdType numberOfVoxels = inData->GetNumberOfPoints();
+
+  double contrastNoiseRatio = self->ContrastNoiseRatio;
+  if(contrastNoiseRatio > 1.0)
+    {
+    contrastNoiseRatio /= 100.0;
+    }
+  double priorSegmentStrength = self->PriorSegmentConfidence;
+  if(priorSegmentStrength > 1.0)
+    {
+    priorSegmentStrength /= 100.0;
+    }
+
+  bool validState = self->LabelState != NULL &&
+    self->StateInputMTime == inData->GetMTime() &&
+    self->StateMTime == self->GetMTime();
+  for (int i = 0; validState && i < 6; ++i)
+    {
+    validState = self->LabelState->GetExtent()[i] == extent[i];
+    }
+
+  std::vector<vtkIdType> front;
+  bool updated = false;
+  while (!updated)
+    {
+    if (!validState)
+      {
+      self->ResetState();
+      self->LabelState = vtkITKGrowCutNewStateImage(extent, VTK_SHORT);
+      self->StrengthState = vtkITKGrowCutNewStateImage(extent, VTK_FLOAT);
+      self->OutputState = vtkITKGrowCutNewStateImage(extent, VTK_SHORT);
+      self->StateInputMTime = inData->GetMTime();
+      self->StateMTime = self->GetMTime();
+      validState = true;
+      }
+    front.clear();
+    updated = vtkITKGrowCutAddGestures(inPtr2,
+      static_cast<short*>(self->OutputState->GetScalarPointer()),
+      static_cast<short*>(self->LabelState->GetScalarPointer()),
+      static_cast<float*>(self->StrengthState->GetScalarPointer()),
+      numberOfVoxels, contrastNoiseRatio, front);
+    validState = updated;
+    }
+
+  short *labels = static_cast<short*>(self->LabelState->GetScalarPointer());
+  float *strengths = static_cast<float*>(self->StrengthState->GetScalarPointer());
+
+  // the previous segmentation is a weak seed of a new state
+  bool newState = self->StateROI[0] > self->StateROI[1];
+  if (newState && inPtr3)
+    {
+    for (vtkIdType i = 0; i < numberOfVoxels; ++i)
+      {
+      if (inPtr3[i] != 0 && strengths[i] == 0.0)
+        {
+        labels[i] = static_cast<short>(inPtr3[i]);
+        strengths[i] = priorSegmentStrength;
+        front.push_back(i);
+        }
+      }
+    }
+
+  // the automaton runs on the bounding box of all the seeds, enlarged by
+  // the object size
+  int dims[3];
+  inData->GetDimensions(dims);
+  int roi[6];
+  for (int i = 0; i < 3; ++i)
+    {
+    roi[2*i] = self->StateROI[2*i];
+    roi[2*i+1] = self->StateROI[2*i+1];
+    }
+  int radius = static_cast<int>(self->ObjectSize);
+  for (std::vector<vtkIdType>::const_iterator it = front.begin(); it != front.end(); ++it)
+    {
+    int ijk[3] = { static_cast<int>(*it % dims[0]),
+                   static_cast<int>((*it / dims[0]) % dims[1]),
+                   static_cast<int>(*it / (static_cast<vtkIdType>(dims[0]) * dims[1])) };
+    for (int i = 0; i < 3; ++i)
+      {
+      int start = std::max(extent[2*i], extent[2*i] + ijk[i] - radius);
+      int end = std::min(extent[2*i+1], extent[2*i] + ijk[i] + radius);
+      bool emptyROI = roi[0] > roi[1];
+      roi[2*i] = emptyROI ? start : std::min(roi[2*i], start);
+      roi[2*i+1] = emptyROI ? end : std::max(roi[2*i+1], end);
+      }
+    }
+
+  // the labeled voxels on the border of the previous ROI can attack the
+  // voxels added to the ROI
+  if (!newState)
+    {
+    bool grown = false;
+    for (int i = 0; i < 6; ++i)
+      {
+      grown = grown || roi[i] != self->StateROI[i];
+      }
+    for (int k = self->StateROI[4]; grown && k <= self->StateROI[5]; ++k)
+      {
+      for (int j = self->StateROI[2]; j <= self->StateROI[3]; ++j)
+        {
+        bool face = k == self->StateROI[4] || k == self->StateROI[5] ||
+          j == self->StateROI[2] || j == self->StateROI[3];
+        int step = face ? 1 : std::max(1, self->StateROI[1] - self->StateROI[0]);
+        for (int i = self->StateROI[0]; i <= self->StateROI[1]; i += step)
+          {
+          vtkIdType voxel = (i - extent[0]) +
+            (static_cast<vtkIdType>(k - extent[4]) * dims[1] + (j - extent[2])) * dims[0];
+          if (strengths[voxel] > 0.0)
+            {
+            front.push_back(voxel);
+            }
+          }
+        }
+      }
+    }
+  for (int i = 0; i < 6; ++i)
+    {
+    self->StateROI[i] = roi[i];
+    }
+
+  typedef itk::Image<IT1, 3> InImageType;
+  typedef itk::Image<short, 3> LabelImageType;
+  typedef itk::Image<float, 3> WeightImageType;
+
+  typename InImageType::RegionType region;
+  typename InImageType::IndexType index;
+  typename InImageType::SizeType size;
+  for (int i = 0; i < 3; ++i)
+    {
+    index[i] = extent[2*i];
+    size[i] = extent[2*i+1] - extent[2*i] + 1;
+    }
+  region.SetIndex( index );
+  region.SetSize( size );
+
+  double spacing[3], origin[3];
+  inData->GetOrigin(origin);
+  inData->GetSpacing(spacing);
+
+  typename InImageType::Pointer image = InImageType::New();
+  image->SetOrigin( origin );
+  image->SetSpacing( spacing );
+  image->SetRegions( region );
+  image->GetPixelContainer()->SetImportPointer(inPtr1, numberOfVoxels, false);
+
+  typename LabelImageType::Pointer labelImage = LabelImageType::New();
+  labelImage->SetOrigin( origin );
+  labelImage->SetSpacing( spacing );
+  labelImage->SetRegions( region );
+  labelImage->GetPixelContainer()->SetImportPointer(labels, numberOfVoxels, false);
+
+  typename WeightImageType::Pointer weightImage = WeightImageType::New();
+  weightImage->SetOrigin( origin );
+  weightImage->SetSpacing( spacing );
+  weightImage->SetRegions( region );
+  weightImage->GetPixelContainer()->SetImportPointer(strengths, numberOfVoxels, false);
+
+  typedef itk::GrowCutSegmentationImageFilter<InImageType, LabelImageType> FilterType;
+  typename FilterType::Pointer filter = FilterType::New();
+  filter->AddObserver(itk::ProgressEvent(), progressCommand );
+
+  typename FilterType::NodeContainerPointer activeFront = FilterType::NodeContainer::New();
+  activeFront->Reserve(static_cast<unsigned int>(front.size()));
+  for (size_t n = 0; n < front.size(); ++n)
+    {
+    typename FilterType::IndexType idx;
+    idx[0] = extent[0] + static_cast<int>(front[n] % dims[0]);
+    idx[1] = extent[2] + static_cast<int>((front[n] / dims[0]) % dims[1]);
+    idx[2] = extent[4] + static_cast<int>(front[n] / (static_cast<vtkIdType>(dims[0]) * dims[1]));
+    activeFront->SetElement(static_cast<unsigned int>(n), idx);
+    }
+
+  typename LabelImageType::IndexType roiStart;
+  typename LabelImageType::IndexType roiEnd;
+  for (int i = 0; i < 3; ++i)
+    {
+    roiStart[i] = roi[2*i];
+    roiEnd[i] = roi[2*i+1];
+    }
+
+  filter->IncrementalOn();
+  filter->SetInput( image );
+  filter->SetLabelImage( labelImage );
+  filter->SetStrengthImage( weightImage );
+  filter->SetActiveFront( activeFront );
+  filter->SetROIStart( roiStart );
+  filter->SetROIEnd( roiEnd );
+  filter->SetSeedStrength( contrastNoiseRatio );
+  filter->SetObjectRadius( static_cast<unsigned int>(self->ObjectSize) );
+  filter->Update();
+
+  const short *segmentation = filter->GetOutput()->GetBufferPointer();
+  memcpy(self->OutputState->GetScalarPointer(), segmentation,
+         numberOfVoxels * sizeof(short));
+  for (vtkIdType i = 0; i < numberOfVoxels; ++i)
+    {
+    output[i] = static_cast<OT>(segmentation[i]);
+    }
+}
+
 //-----------------------------------------------------------------------------
 vtkITKGrowCutSegmentationImageFilter::vtkITKGrowCutSegmentationImageFilter()
 {
   this->ObjectSize = 20;
   this->ContrastNoiseRatio = 1.0;
   this->PriorSegmentConfidence = 0.003;
+  this->PersistentState = 0;
+  this->LabelState = NULL;
+  this->StrengthState = NULL;
+  this->OutputState = NULL;
+  this->ResetState();
+}
+
+//-----------------------------------------------------------------------------
+vtkITKGrowCutSegmentationImageFilter::~vtkITKGrowCutSegmentationImageFilter()
+{
+  this->ResetState();
+}
+
+//-----------------------------------------------------------------------------
+void vtkITKGrowCutSegmentationImageFilter::ResetState()
+{
+  if (this->LabelState)
+    {
+    this->LabelState->Delete();
+    this->LabelState = NULL;
+    }
+  if (this->StrengthState)
+    {
+    this->StrengthState->Delete();
+    this->StrengthState = NULL;
+    }
+  if (this->OutputState)
+    {
+    this->OutputState->Delete();
+    this->OutputState = NULL;
+    }
+  for (int i = 0; i < 3; ++i)
+    {
+    this->StateROI[2*i] = 0;
+    this->StateROI[2*i+1] = -1;
+    }
+  this->StateInputMTime = 0;
+  this->StateMTime = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -366,6 +660,22 @@ void ExecuteGrowCut( vtkITKGrowCutSegmentationImageFilter *self,
   progressCommand->SetCallback(vtkITKImageGrowCutHandleProgressEvent );
 
 
+  if (self->GetPersistentState())
+    {
+    // the output has the scalar type of the gestures, the previous
+    // segmentation is ignored if its scalar type differs
+    void *priorPtr = (input3->GetScalarType() == input2->GetScalarType()) ?
+      inPtr3 : NULL;
+    switch(input2->GetScalarType())
+      {
+      vtkTemplateMacro( vtkITKImageGrowCutIncrementalExecute3D(self, input1,
+        static_cast<IT1*>(inPtr1), static_cast<VTK_TT*>(inPtr2),
+        static_cast<VTK_TT*>(priorPtr), static_cast<VTK_TT*>(outPtr),
+        progressCommand));
+      }
+    return;
+    }
+
   std::cout << " Input2 type is " <<input2->GetScalarType() << std::endl;
 
   if(input2->GetScalarType() != input3->GetScalarType() )
@@ -604,4 +914,5 @@ void vtkITKGrowCutSegmentationImageFilter::PrintSelf(ostream& os, vtkIndent inde
 
   os << indent << "Object Size : " << this->ObjectSize << std::endl;
   os << indent << "ContrastNoiseRatio : " << this->ContrastNoiseRatio << std::endl;
+  os << indent << "PersistentState : " << this->PersistentState << std::endl;
 }
@@ -23,6 +23,10 @@ class vtkImageData;
 ///
 /// This filter is implemented only for scalar images gray scale images. 
 /// The current implementation supports n-class segmentation.
+///
+/// When PersistentState is on, the labels and strengths of the automaton
+/// are kept between executions and only the gestures painted since the
+/// previous execution are propagated, from an active front.
 class VTK_ITK_EXPORT vtkITKGrowCutSegmentationImageFilter : public vtkImageMultipleInputFilter 
 {
 public:
@@ -43,15 +47,40 @@ public:
   vtkSetMacro(PriorSegmentConfidence, double);
   vtkGetMacro(PriorSegmentConfidence, double);
 
+  /// Keep the labels and strengths computed by the automaton between
+  /// executions. The voxels painted where the previous output was empty
+  /// are then the only new seeds, and the previous segmentation (SetInput3)
+  /// is only used when the state is reset. The state is reset when the
+  /// input image, the geometry or the parameters change, or when voxels
+  /// of the previous output are modified. Off by default.
+  vtkSetMacro(PersistentState, int);
+  vtkGetMacro(PersistentState, int);
+  vtkBooleanMacro(PersistentState, int);
+
+  /// Forget the state kept for PersistentState
+  void ResetState();
+
 public:
   double ObjectSize;
   double PriorSegmentConfidence;
   double ContrastNoiseRatio;
 
+  int PersistentState;
+
+  /// State kept between executions when PersistentState is on: the
+  /// labels, strengths and output of the previous execution, and the
+  /// region the automaton was run on.
+  vtkImageData* LabelState;
+  vtkImageData* StrengthState;
+  vtkImageData* OutputState;
+  int StateROI[6];
+  unsigned long StateInputMTime;
+  unsigned long StateMTime;
+
 
 protected:
   vtkITKGrowCutSegmentationImageFilter();
-  ~vtkITKGrowCutSegmentationImageFilter(){}
+  ~vtkITKGrowCutSegmentationImageFilter();
 
   virtual void ExecuteData(vtkDataObject *outData);
 
@@ -0,0 +1,88 @@
+/*=========================================================================
+
+  Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+==========================================================================*/
+
+#ifndef __vtkITKImageBridge_h
+#define __vtkITKImageBridge_h
+
+#include "vtkDataArray.h"
+#include "vtkImageData.h"
+#include "vtkPointData.h"
+#include "vtkType.h"
+
+#include "itkImage.h"
+
+/// Helpers to share the image buffers between VTK and ITK without copying
+/// them, for the vtkITK filters that run an ITK filter in their execute
+/// method.
+
+/// Wrap the scalars of a VTK image into an ITK image. The ITK image does
+/// not own the buffer, the VTK image must outlive it.
+template <class TImage>
+typename TImage::Pointer vtkITKWrapImageScalars(vtkImageData* image,
+                                                typename TImage::PixelType* scalars)
+{
+  int dims[3];
+  image->GetDimensions(dims);
+  double* spacing = image->GetSpacing();
+  double* origin = image->GetOrigin();
+
+  typename TImage::Pointer itkImage = TImage::New();
+  typename TImage::RegionType region;
+  typename TImage::IndexType index;
+  typename TImage::SizeType size;
+  typename TImage::SpacingType itkSpacing;
+  typename TImage::PointType itkOrigin;
+  for (unsigned int i = 0; i < TImage::ImageDimension; ++i)
+    {
+    index[i] = 0;
+    size[i] = i < 3 ? dims[i] : 1;
+    itkSpacing[i] = i < 3 ? spacing[i] : 1.;
+    itkOrigin[i] = i < 3 ? origin[i] : 0.;
+    }
+  region.SetIndex(index);
+  region.SetSize(size);
+  itkImage->SetRegions(region);
+  itkImage->SetSpacing(itkSpacing);
+  itkImage->SetOrigin(itkOrigin);
+  itkImage->GetPixelContainer()->SetImportPointer(
+    scalars, region.GetNumberOfPixels(), false);
+  return itkImage;
+}
+
+/// Hand the buffer of an ITK image over to the scalars of a VTK image with
+/// the same dimensions and scalar type. The VTK scalars take the ownership
+/// of the buffer, the ITK image can be deleted.
+/// The VTK scalars memory can be released with
+/// output->GetPointData()->GetScalars()->Initialize() before running the ITK
+/// filter so that the VTK and ITK outputs are never allocated together.
+template <class TImage>
+void vtkITKTakeImageScalars(TImage* itkImage, vtkImageData* output)
+{
+  vtkDataArray* scalars = output->GetPointData()->GetScalars();
+  typename TImage::PixelContainer* container = itkImage->GetPixelContainer();
+  scalars->SetVoidArray(container->GetBufferPointer(),
+                        container->Size() * scalars->GetNumberOfComponents(), 0);
+  container->ContainerManageMemoryOff();
+}
+
+/// Like vtkTemplateMacro, over the scalar types ITK is instantiated for.
+#define vtkITKTemplateMacro(call)                                \
+  vtkTemplateMacroCase(VTK_DOUBLE, double, call);                \
+  vtkTemplateMacroCase(VTK_FLOAT, float, call);                  \
+  vtkTemplateMacroCase(VTK_LONG, long, call);                    \
+  vtkTemplateMacroCase(VTK_UNSIGNED_LONG, unsigned long, call);  \
+  vtkTemplateMacroCase(VTK_INT, int, call);                      \
+  vtkTemplateMacroCase(VTK_UNSIGNED_INT, unsigned int, call);    \
+  vtkTemplateMacroCase(VTK_SHORT, short, call);                  \
+  vtkTemplateMacroCase(VTK_UNSIGNED_SHORT, unsigned short, call);\
+  vtkTemplateMacroCase(VTK_CHAR, char, call);                    \
+  vtkTemplateMacroCase(VTK_SIGNED_CHAR, signed char, call);      \
+  vtkTemplateMacroCase(VTK_UNSIGNED_CHAR, unsigned char, call)
+
+#endif
@@ -0,0 +1,53 @@
+/*=========================================================================
+
+  Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+==========================================================================*/
+
+#include "vtkITKImageCast.h"
+
+#include "vtkImageData.h"
+#include "vtkInformation.h"
+#include "vtkInformationVector.h"
+#include "vtkObjectFactory.h"
+#include "vtkPointData.h"
+
+vtkCxxRevisionMacro(vtkITKImageCast, "$Revision$");
+vtkStandardNewMacro(vtkITKImageCast);
+
+vtkITKImageCast::vtkITKImageCast()
+{
+  this->PassInputScalars = 0;
+}
+
+vtkITKImageCast::~vtkITKImageCast()
+{
+}
+
+int vtkITKImageCast::RequestData(vtkInformation* request,
+                                 vtkInformationVector** inputVector,
+                                 vtkInformationVector* outputVector)
+{
+  vtkImageData* input = vtkImageData::GetData(inputVector[0]);
+  vtkImageData* output = vtkImageData::GetData(outputVector);
+  if (this->PassInputScalars && input && output &&
+      input->GetPointData()->GetScalars() &&
+      input->GetScalarType() == this->GetOutputScalarType())
+    {
+    vtkDebugMacro(<< "Passing the input scalars, no cast needed");
+    output->SetExtent(input->GetExtent());
+    output->GetPointData()->PassData(input->GetPointData());
+    return 1;
+    }
+  return this->Superclass::RequestData(request, inputVector, outputVector);
+}
+
+void vtkITKImageCast::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+
+  os << indent << "PassInputScalars: " << this->PassInputScalars << std::endl;
+}
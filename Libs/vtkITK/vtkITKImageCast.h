@@ -0,0 +1,50 @@
+/*=========================================================================
+
+  Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+==========================================================================*/
+
+#ifndef __vtkITKImageCast_h
+#define __vtkITKImageCast_h
+
+#include "vtkITK.h"
+#include "vtkImageCast.h"
+
+/// \brief Image cast that shares the input scalars when no cast is needed.
+///
+/// vtkImageCast always copies the input, even if it already has the output
+/// scalar type. When PassInputScalars is on and the input scalar type is the
+/// output scalar type, vtkITKImageCast passes the input scalars to the output
+/// instead, so that the ITK importer downstream uses the input buffer as is.
+/// The consumer must not modify the output scalars.
+class VTK_ITK_EXPORT vtkITKImageCast : public vtkImageCast
+{
+public:
+  static vtkITKImageCast *New();
+  vtkTypeRevisionMacro(vtkITKImageCast, vtkImageCast);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  /// Off by default.
+  vtkSetMacro(PassInputScalars, int);
+  vtkGetMacro(PassInputScalars, int);
+  vtkBooleanMacro(PassInputScalars, int);
+
+protected:
+  vtkITKImageCast();
+  ~vtkITKImageCast();
+
+  virtual int RequestData(vtkInformation* request,
+                          vtkInformationVector** inputVector,
+                          vtkInformationVector* outputVector);
+
+  int PassInputScalars;
+
+private:
+  vtkITKImageCast(const vtkITKImageCast&);  /// Not implemented.
+  void operator=(const vtkITKImageCast&);  /// Not implemented.
+};
+
+#endif
@@ -21,7 +21,7 @@
 #include "vtkImageImport.h"
 #include "vtkImageExport.h"
 #include "vtkImageToImageFilter.h"
-#include "vtkImageCast.h"
+#include "vtkITKImageCast.h"
 #include "vtkImageData.h"
 
 #include "vtkITK.h"
@@ -190,7 +190,7 @@ public:
   vtkITKImageToImageFilter()
   {
     /// Need an import, export, and a ITK pipeline
-    this->vtkCast = vtkImageCast::New();
+    this->vtkCast = vtkITKImageCast::New();
     this->vtkExporter = vtkImageExport::New();
     this->vtkImporter = vtkImageImport::New();
     this->vtkExporter->SetInput ( this->vtkCast->GetOutput() );
@@ -232,7 +232,7 @@ public:
   
   /// ITK Progress object
   /// To/from VTK
-  vtkImageCast* vtkCast;
+  vtkITKImageCast* vtkCast;
   vtkImageImport* vtkImporter;
   vtkImageExport* vtkExporter;  
   
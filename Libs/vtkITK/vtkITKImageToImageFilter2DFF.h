@@ -18,6 +18,7 @@
 #include "vtkITKImageToImageFilter.h"
 #include "vtkImageToImageFilter.h"
 #include "itkImageToImageFilter.h"
+#include "itkInPlaceImageFilter.h"
 #include "itkVTKImageExport.h"
 #include "itkVTKImageImport.h"
 #include "vtkITKUtility.h"
@@ -63,6 +64,10 @@ protected:
     m_Filter->SetInput ( this->itkImporter->GetOutput() );
     this->itkExporter->SetInput ( m_Filter->GetOutput() );
     this->vtkCast->SetOutputScalarTypeToFloat ();
+    /// Use the input scalars as is if they have the pixel type already,
+    /// unless the filter would then run in place on them
+    this->vtkCast->SetPassInputScalars(
+      dynamic_cast<itk::InPlaceImageFilter<InputImageType,OutputImageType>*>(filter) == 0);
   };
 
   ~vtkITKImageToImageFilter2DFF()
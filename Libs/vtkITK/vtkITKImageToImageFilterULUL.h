@@ -18,6 +18,7 @@
 #include "vtkITKImageToImageFilter.h"
 #include "vtkImageToImageFilter.h"
 #include "itkImageToImageFilter.h"
+#include "itkInPlaceImageFilter.h"
 #include "itkVTKImageExport.h"
 #include "itkVTKImageImport.h"
 #include "vtkITKUtility.h"
@@ -61,6 +62,10 @@ protected:
     this->itkExporter->SetInput ( m_Filter->GetOutput() );
     this->LinkITKProgressToVTKProgress ( m_Filter );
     this->vtkCast->SetOutputScalarTypeToUnsignedLong();
+    /// Use the input scalars as is if they have the pixel type already,
+    /// unless the filter would then run in place on them
+    this->vtkCast->SetPassInputScalars(
+      dynamic_cast<itk::InPlaceImageFilter<InputImageType,OutputImageType>*>(filter) == 0);
   };
 
   ~vtkITKImageToImageFilterULUL()
@@ -0,0 +1,408 @@
+/*=========================================================================
+
+  Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+==========================================================================*/
+
+#include "vtkITKIslandLabeler.h"
+
+// VTK includes
+#include <vtkMultiThreader.h>
+#include <vtkObjectFactory.h>
+
+// STD includes
+#include <algorithm>
+
+vtkCxxRevisionMacro(vtkITKIslandLabeler, "$Revision: 1.0 $");
+vtkStandardNewMacro(vtkITKIslandLabeler);
+
+// While a slab is labeled, the background voxels are set to -1, the
+// root of each region to -2 minus the index of the region in the slab
+// and the other voxels to the index of their root.
+#define ISLAND_BACKGROUND -1
+#define ISLAND_ROOT(index) (-2 - (index))
+
+//----------------------------------------------------------------------------
+static VTK_THREAD_RETURN_TYPE vtkITKIslandLabeler_LabelSlab( void *arg )
+{
+  vtkMultiThreader::ThreadInfo *info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  vtkITKIslandLabeler *self = static_cast<vtkITKIslandLabeler *>(info->UserData);
+  self->LabelSlab(info->ThreadID, info->NumberOfThreads);
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+static VTK_THREAD_RETURN_TYPE vtkITKIslandLabeler_RelabelSlab( void *arg )
+{
+  vtkMultiThreader::ThreadInfo *info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  vtkITKIslandLabeler *self = static_cast<vtkITKIslandLabeler *>(info->UserData);
+  self->RelabelSlab(info->ThreadID, info->NumberOfThreads);
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+vtkITKIslandLabeler::vtkITKIslandLabeler()
+{
+  this->Connectivity = 6;
+  this->SliceBySlice = 0;
+  this->MultiThreader = vtkMultiThreader::New();
+  this->NumberOfThreads = this->MultiThreader->GetNumberOfThreads();
+  this->Mask = NULL;
+  this->Labels = NULL;
+  this->Dimensions[0] = this->Dimensions[1] = this->Dimensions[2] = 0;
+}
+
+//----------------------------------------------------------------------------
+vtkITKIslandLabeler::~vtkITKIslandLabeler()
+{
+  this->MultiThreader->Delete();
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkITKIslandLabeler::Label(const unsigned char* mask,
+                                     const int dims[3], vtkIdType* labels)
+{
+  this->IslandSizes.assign(1, 0);
+  vtkIdType numberOfVoxels = static_cast<vtkIdType>(dims[0]) * dims[1] * dims[2];
+  if (numberOfVoxels <= 0 || !mask || !labels)
+    {
+    return 0;
+    }
+  this->Mask = mask;
+  this->Labels = labels;
+  for (int i = 0; i < 3; ++i)
+    {
+    this->Dimensions[i] = dims[i];
+    }
+
+  // steps to the neighbors that precede a voxel in memory
+  this->Steps.clear();
+  for (int dk = -1; dk <= 0; ++dk)
+    {
+    for (int dj = -1; dj <= 1; ++dj)
+      {
+      for (int di = -1; di <= 1; ++di)
+        {
+        bool before = dk < 0 || (dk == 0 && (dj < 0 || (dj == 0 && di < 0)));
+        int distance = (di != 0) + (dj != 0) + (dk != 0);
+        if (!before ||
+            (this->SliceBySlice && dk != 0) ||
+            (this->Connectivity <= 6 && distance > 1) ||
+            (this->Connectivity <= 18 && distance > 2))
+          {
+          continue;
+          }
+        this->Steps.push_back(di);
+        this->Steps.push_back(dj);
+        this->Steps.push_back(dk);
+        }
+      }
+    }
+
+  // the slabs are ranges of rows, so that 2D images are split too
+  vtkIdType numberOfRows = static_cast<vtkIdType>(dims[1]) * dims[2];
+  int numberOfSlabs = static_cast<int>(
+    std::min(static_cast<vtkIdType>(this->NumberOfThreads), numberOfRows));
+  this->SlabStarts.resize(numberOfSlabs + 1);
+  for (int slab = 0; slab <= numberOfSlabs; ++slab)
+    {
+    this->SlabStarts[slab] = numberOfRows * slab / numberOfSlabs;
+    }
+  this->SlabRegionSizes.clear();
+  this->SlabRegionSizes.resize(numberOfSlabs);
+
+  if (numberOfSlabs > 1)
+    {
+    this->MultiThreader->SetNumberOfThreads(numberOfSlabs);
+    this->MultiThreader->SetSingleMethod(vtkITKIslandLabeler_LabelSlab, this);
+    this->MultiThreader->SingleMethodExecute();
+    }
+  else
+    {
+    this->LabelSlab(0, 1);
+    }
+
+  this->MergeSlabs();
+
+  if (numberOfSlabs > 1)
+    {
+    this->MultiThreader->SetSingleMethod(vtkITKIslandLabeler_RelabelSlab, this);
+    this->MultiThreader->SingleMethodExecute();
+    }
+  else
+    {
+    this->RelabelSlab(0, 1);
+    }
+
+  // release the memory of the regions
+  std::vector<std::vector<vtkIdType> >().swap(this->SlabRegionSizes);
+  std::vector<vtkIdType>().swap(this->SlabRegionOffsets);
+  std::vector<vtkIdType>().swap(this->RegionParents);
+  std::vector<vtkIdType>().swap(this->RegionLabels);
+  this->Mask = NULL;
+  this->Labels = NULL;
+
+  return this->GetNumberOfIslands();
+}
+
+//----------------------------------------------------------------------------
+void vtkITKIslandLabeler::LabelSlab(int threadId, int vtkNotUsed(numberOfThreads))
+{
+  const unsigned char* mask = this->Mask;
+  vtkIdType* labels = this->Labels;
+  const int* dims = this->Dimensions;
+  vtkIdType startRow = this->SlabStarts[threadId];
+  vtkIdType endRow = this->SlabStarts[threadId + 1];
+  size_t numberOfSteps = this->Steps.size() / 3;
+  const int* steps = numberOfSteps > 0 ? &this->Steps[0] : NULL;
+
+  // union-find of the voxels with the neighbors of the same slab, the
+  // root of a region is always its first voxel
+  for (vtkIdType row = startRow; row < endRow; ++row)
+    {
+    int j = static_cast<int>(row % dims[1]);
+    int k = static_cast<int>(row / dims[1]);
+    for (int i = 0; i < dims[0]; ++i)
+      {
+      vtkIdType voxel = row * dims[0] + i;
+      if (!mask[voxel])
+        {
+        labels[voxel] = ISLAND_BACKGROUND;
+        continue;
+        }
+      labels[voxel] = voxel;
+      for (size_t s = 0; s < numberOfSteps; ++s)
+        {
+        int ni = i + steps[3*s];
+        int nj = j + steps[3*s+1];
+        int nk = k + steps[3*s+2];
+        if (ni < 0 || ni >= dims[0] || nj < 0 || nj >= dims[1] || nk < 0)
+          {
+          continue;
+          }
+        vtkIdType neighborRow = static_cast<vtkIdType>(nk) * dims[1] + nj;
+        vtkIdType neighbor = neighborRow * dims[0] + ni;
+        if (neighborRow < startRow || labels[neighbor] == ISLAND_BACKGROUND)
+          {
+          continue;
+          }
+        vtkIdType root = neighbor;
+        while (labels[root] != root)
+          {
+          labels[root] = labels[labels[root]];
+          root = labels[root];
+          }
+        vtkIdType voxelRoot = voxel;
+        while (labels[voxelRoot] != voxelRoot)
+          {
+          voxelRoot = labels[voxelRoot];
+          }
+        if (root < voxelRoot)
+          {
+          labels[voxelRoot] = root;
+          }
+        else if (voxelRoot < root)
+          {
+          labels[root] = voxelRoot;
+          }
+        }
+      }
+    }
+
+  // point every voxel to its root and count the voxels of each region,
+  // the parents precede the voxels so they are already flattened
+  std::vector<vtkIdType>& sizes = this->SlabRegionSizes[threadId];
+  vtkIdType endVoxel = endRow * dims[0];
+  for (vtkIdType voxel = startRow * dims[0]; voxel < endVoxel; ++voxel)
+    {
+    vtkIdType parent = labels[voxel];
+    if (parent == ISLAND_BACKGROUND)
+      {
+      continue;
+      }
+    if (parent == voxel)
+      {
+      labels[voxel] = ISLAND_ROOT(static_cast<vtkIdType>(sizes.size()));
+      sizes.push_back(1);
+      continue;
+      }
+    vtkIdType root = labels[parent] < ISLAND_BACKGROUND ? parent : labels[parent];
+    labels[voxel] = root;
+    ++sizes[ISLAND_ROOT(labels[root])];
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkITKIslandLabeler::GetRegion(vtkIdType voxel)
+{
+  vtkIdType row = voxel / this->Dimensions[0];
+  size_t slab = std::upper_bound(this->SlabStarts.begin(), this->SlabStarts.end(), row)
+    - this->SlabStarts.begin() - 1;
+  vtkIdType label = this->Labels[voxel];
+  vtkIdType index = ISLAND_ROOT(label < ISLAND_BACKGROUND ? label : this->Labels[label]);
+  return this->SlabRegionOffsets[slab] + index;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkITKIslandLabeler::FindRegion(vtkIdType region)
+{
+  std::vector<vtkIdType>& parents = this->RegionParents;
+  while (parents[region] != region)
+    {
+    parents[region] = parents[parents[region]];
+    region = parents[region];
+    }
+  return region;
+}
+
+//----------------------------------------------------------------------------
+void vtkITKIslandLabeler::MergeSlabs()
+{
+  const int* dims = this->Dimensions;
+  vtkIdType* labels = this->Labels;
+  size_t numberOfSlabs = this->SlabRegionSizes.size();
+  size_t numberOfSteps = this->Steps.size() / 3;
+
+  this->SlabRegionOffsets.resize(numberOfSlabs);
+  vtkIdType numberOfRegions = 0;
+  for (size_t slab = 0; slab < numberOfSlabs; ++slab)
+    {
+    this->SlabRegionOffsets[slab] = numberOfRegions;
+    numberOfRegions += static_cast<vtkIdType>(this->SlabRegionSizes[slab].size());
+    }
+  this->RegionParents.resize(numberOfRegions);
+  for (vtkIdType region = 0; region < numberOfRegions; ++region)
+    {
+    this->RegionParents[region] = region;
+    }
+
+  // merge the regions that touch across the slab boundaries, only the
+  // first rows of a slab have neighbors in the previous slabs
+  for (size_t slab = 1; slab < numberOfSlabs; ++slab)
+    {
+    vtkIdType startRow = this->SlabStarts[slab];
+    vtkIdType endRow = std::min(this->SlabStarts[slab + 1],
+                                startRow + dims[1] + 1);
+    for (vtkIdType row = startRow; row < endRow; ++row)
+      {
+      int j = static_cast<int>(row % dims[1]);
+      int k = static_cast<int>(row / dims[1]);
+      for (int i = 0; i < dims[0]; ++i)
+        {
+        vtkIdType voxel = row * dims[0] + i;
+        if (labels[voxel] == ISLAND_BACKGROUND)
+          {
+          continue;
+          }
+        for (size_t s = 0; s < numberOfSteps; ++s)
+          {
+          int ni = i + this->Steps[3*s];
+          int nj = j + this->Steps[3*s+1];
+          int nk = k + this->Steps[3*s+2];
+          if (ni < 0 || ni >= dims[0] || nj < 0 || nj >= dims[1] || nk < 0)
+            {
+            continue;
+            }
+          vtkIdType neighborRow = static_cast<vtkIdType>(nk) * dims[1] + nj;
+          vtkIdType neighbor = neighborRow * dims[0] + ni;
+          if (neighborRow >= startRow || labels[neighbor] == ISLAND_BACKGROUND)
+            {
+            continue;
+            }
+          vtkIdType root = this->FindRegion(this->GetRegion(neighbor));
+          vtkIdType voxelRoot = this->FindRegion(this->GetRegion(voxel));
+          if (root < voxelRoot)
+            {
+            this->RegionParents[voxelRoot] = root;
+            }
+          else if (voxelRoot < root)
+            {
+            this->RegionParents[root] = voxelRoot;
+            }
+          }
+        }
+      }
+    }
+
+  // number the islands in the order of their first region, which is the
+  // order of their first voxel, and sum the sizes of their regions
+  this->RegionLabels.resize(numberOfRegions);
+  this->IslandSizes.assign(1, 0);
+  vtkIdType foreground = 0;
+  for (size_t slab = 0; slab < numberOfSlabs; ++slab)
+    {
+    const std::vector<vtkIdType>& sizes = this->SlabRegionSizes[slab];
+    for (size_t index = 0; index < sizes.size(); ++index)
+      {
+      vtkIdType region = this->SlabRegionOffsets[slab] + static_cast<vtkIdType>(index);
+      vtkIdType root = this->FindRegion(region);
+      if (root == region)
+        {
+        this->RegionLabels[region] = static_cast<vtkIdType>(this->IslandSizes.size());
+        this->IslandSizes.push_back(0);
+        }
+      else
+        {
+        this->RegionLabels[region] = this->RegionLabels[root];
+        }
+      this->IslandSizes[this->RegionLabels[region]] += sizes[index];
+      foreground += sizes[index];
+      }
+    }
+  this->IslandSizes[0] =
+    static_cast<vtkIdType>(dims[0]) * dims[1] * dims[2] - foreground;
+}
+
+//----------------------------------------------------------------------------
+void vtkITKIslandLabeler::RelabelSlab(int threadId, int vtkNotUsed(numberOfThreads))
+{
+  vtkIdType* labels = this->Labels;
+  vtkIdType offset = this->SlabRegionOffsets[threadId];
+  vtkIdType startVoxel = this->SlabStarts[threadId] * this->Dimensions[0];
+  vtkIdType endVoxel = this->SlabStarts[threadId + 1] * this->Dimensions[0];
+
+  // the roots precede the voxels of their region, so they are relabeled last
+  for (vtkIdType voxel = endVoxel - 1; voxel >= startVoxel; --voxel)
+    {
+    vtkIdType label = labels[voxel];
+    if (label == ISLAND_BACKGROUND)
+      {
+      labels[voxel] = 0;
+      }
+    else
+      {
+      vtkIdType root = label < ISLAND_BACKGROUND ? label : labels[label];
+      labels[voxel] = this->RegionLabels[offset + ISLAND_ROOT(root)];
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkITKIslandLabeler::GetNumberOfIslands()
+{
+  return static_cast<vtkIdType>(this->IslandSizes.size()) - 1;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkITKIslandLabeler::GetIslandSize(vtkIdType label)
+{
+  if (label < 0 || label >= static_cast<vtkIdType>(this->IslandSizes.size()))
+    {
+    return 0;
+    }
+  return this->IslandSizes[label];
+}
+
+//----------------------------------------------------------------------------
+void vtkITKIslandLabeler::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+
+  os << indent << "Connectivity: " << this->Connectivity << std::endl;
+  os << indent << "SliceBySlice: " << this->SliceBySlice << std::endl;
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << std::endl;
+  os << indent << "NumberOfIslands: " << this->GetNumberOfIslands() << std::endl;
+}
@@ -0,0 +1,110 @@
+/*=========================================================================
+
+  Copyright Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+==========================================================================*/
+
+#ifndef __vtkITKIslandLabeler_h
+#define __vtkITKIslandLabeler_h
+
+#include "vtkITK.h"
+
+// VTK includes
+#include <vtkObject.h>
+
+// STD includes
+#include <vector>
+
+class vtkMultiThreader;
+
+/// \brief Label the connected regions of a mask with several threads.
+///
+/// The rows of the mask are split in as many slabs as threads. The
+/// voxels of each slab are labeled by a union-find in one pass that also
+/// counts the voxels of each region, then the regions that touch across
+/// the slab boundaries are merged and the labels are made consecutive.
+/// The islands are numbered from 1 in the order of their first voxel in
+/// memory, like a sequential flood fill would do, 0 is the background.
+class VTK_ITK_EXPORT vtkITKIslandLabeler : public vtkObject
+{
+public:
+  static vtkITKIslandLabeler *New();
+  vtkTypeRevisionMacro(vtkITKIslandLabeler, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  ///
+  /// Number of neighbors of a voxel: 6 (faces), 18 (faces and edges) or
+  /// 26 (faces, edges and vertices). Default is 6.
+  vtkSetMacro(Connectivity, int);
+  vtkGetMacro(Connectivity, int);
+  void SetConnectivityTo6() {this->SetConnectivity(6);}
+  void SetConnectivityTo18() {this->SetConnectivity(18);}
+  void SetConnectivityTo26() {this->SetConnectivity(26);}
+
+  ///
+  /// If non-zero, voxels of different slices (along K) are never connected
+  vtkSetMacro(SliceBySlice, int);
+  vtkGetMacro(SliceBySlice, int);
+  vtkBooleanMacro(SliceBySlice, int);
+
+  ///
+  /// Maximum number of threads used to label the mask
+  vtkSetClampMacro(NumberOfThreads, int, 1, VTK_MAX_THREADS);
+  vtkGetMacro(NumberOfThreads, int);
+
+  ///
+  /// Label the islands of the non-zero voxels of mask, an image of
+  /// dimensions dims stored I first. Labels must have room for as many
+  /// values as the mask. Return the number of islands.
+  vtkIdType Label(const unsigned char* mask, const int dims[3], vtkIdType* labels);
+
+  ///
+  /// Number of islands found by the last Label()
+  vtkIdType GetNumberOfIslands();
+
+  ///
+  /// Number of voxels of an island, the label 0 counts the background
+  vtkIdType GetIslandSize(vtkIdType label);
+
+  ///
+  /// Label a slab of rows, called by the threads of Label()
+  void LabelSlab(int threadId, int numberOfThreads);
+
+  ///
+  /// Write the final labels of a slab, called by the threads of Label()
+  void RelabelSlab(int threadId, int numberOfThreads);
+
+protected:
+  vtkITKIslandLabeler();
+  ~vtkITKIslandLabeler();
+
+  void MergeSlabs();
+  vtkIdType GetRegion(vtkIdType voxel);
+  vtkIdType FindRegion(vtkIdType region);
+
+  int Connectivity;
+  int SliceBySlice;
+  int NumberOfThreads;
+  vtkMultiThreader* MultiThreader;
+
+  /// State of the current Label()
+  const unsigned char* Mask;
+  vtkIdType* Labels;
+  int Dimensions[3];
+  std::vector<int> Steps;
+  std::vector<vtkIdType> SlabStarts;
+  std::vector<std::vector<vtkIdType> > SlabRegionSizes;
+  std::vector<vtkIdType> SlabRegionOffsets;
+  std::vector<vtkIdType> RegionParents;
+  std::vector<vtkIdType> RegionLabels;
+  std::vector<vtkIdType> IslandSizes;
+
+private:
+  vtkITKIslandLabeler(const vtkITKIslandLabeler&);  /// Not implemented.
+  void operator=(const vtkITKIslandLabeler&);  /// Not implemented.
+};
+
+#endif
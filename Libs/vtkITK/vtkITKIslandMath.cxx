@@ -20,9 +20,13 @@
 #include "vtkImageData.h"
 #include "vtkProcessObject.h"
 
-#include "itkConnectedComponentImageFilter.h"
-#include "itkRelabelComponentImageFilter.h"
-#include "itkCommand.h"
+#include "vtkNew.h"
+
+#include "vtkITKIslandLabeler.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
 
 vtkCxxRevisionMacro(vtkITKIslandMath, "$Revision: 1900 $");
 vtkStandardNewMacro(vtkITKIslandMath);
@@ -54,76 +58,58 @@ void vtkITKIslandMath::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "OriginalNumberOfIslands: " << OriginalNumberOfIslands << std::endl;
 }
 
-// Note: local function not method - conforms to signature in itkCommand.h
-void vtkITKIslandMathHandleProgressEvent (itk::Object *caller, 
-                                          const itk::EventObject& vtkNotUsed(eventObject), 
-                                          void *clientdata)
-{
-  itk::ProcessObject *itkFilter = static_cast<itk::ProcessObject*>(caller);
-  vtkProcessObject *vtkFilter = static_cast<vtkProcessObject*>(clientdata);
-  if ( itkFilter && vtkFilter )
-    {
-    vtkFilter->UpdateProgress ( itkFilter->GetProgress() );
-    }
-};
-
 template <class T>
 void vtkITKIslandMathExecute(vtkITKIslandMath *self, vtkImageData* input,
                 vtkImageData* vtkNotUsed(output),
                 T* inPtr, T* outPtr)
 {
-
   int dims[3];
   input->GetDimensions(dims);
-  double spacing[3];
-  input->GetSpacing(spacing);
-
-  // Wrap scalars into an ITK image
-  // - mostly rely on defaults for spacing, origin etc for this filter
-  typedef itk::Image<T, 3> ImageType;
-  typename ImageType::Pointer inImage = ImageType::New();
-  typename ImageType::RegionType region;
-  typename ImageType::IndexType index;
-  typename ImageType::SizeType size;
-
-  inImage->GetPixelContainer()->SetImportPointer(inPtr, dims[0]*dims[1]*dims[2], false);
-  index[0] = index[1] = index[2] = 0;
-  region.SetIndex(index);
-  size[0] = dims[0]; size[1] = dims[1]; size[2] = dims[2];
-  region.SetSize(size);
-  inImage->SetLargestPossibleRegion(region);
-  inImage->SetBufferedRegion(region);
-  inImage->SetSpacing(spacing);
-
-  // set up the progress callback
-  itk::CStyleCommand::Pointer progressCommand = itk::CStyleCommand::New();
-  progressCommand->SetClientData( static_cast<void *>(self) );
-  progressCommand->SetCallback( vtkITKIslandMathHandleProgressEvent );
-
+  vtkIdType numberOfVoxels = static_cast<vtkIdType>(dims[0]) * dims[1] * dims[2];
 
   // Calculate the island operation
-  // ccfilter - identifies the islands
-  // relabel - sorts them by size
-  typedef itk::ConnectedComponentImageFilter<ImageType, ImageType> ConnectedComponentType;
-  typename ConnectedComponentType::Pointer ccfilter = ConnectedComponentType::New();
-  typedef itk::RelabelComponentImageFilter<ImageType, ImageType> RelabelComponentType;
-  typename RelabelComponentType::Pointer relabel = RelabelComponentType::New();
-
-  ccfilter->AddObserver(itk::ProgressEvent(), progressCommand);
-  relabel->AddObserver(itk::ProgressEvent(), progressCommand);
-
-  ccfilter->SetFullyConnected(self->GetFullyConnected());
-  ccfilter->SetInput( inImage );
-  relabel->SetInput( ccfilter->GetOutput() );
-  relabel->SetMinimumObjectSize( self->GetMinimumSize() );
-  relabel->Update();
-  self->SetNumberOfIslands(relabel->GetNumberOfObjects());
-  self->SetOriginalNumberOfIslands(relabel->GetOriginalNumberOfObjects());
+  // labeler - identifies the islands and measures them
+  // then the islands are sorted by size, like itk::RelabelComponentImageFilter does
+  std::vector<unsigned char> mask(numberOfVoxels);
+  for (vtkIdType i = 0; i < numberOfVoxels; ++i)
+    {
+    mask[i] = (inPtr[i] != 0);
+    }
 
-  // Copy to the output
-  memcpy(outPtr, relabel->GetOutput()->GetBufferPointer(),
-         relabel->GetOutput()->GetBufferedRegion().GetNumberOfPixels() * sizeof(T));
+  vtkNew<vtkITKIslandLabeler> labeler;
+  labeler->SetConnectivity(self->GetFullyConnected() ? 26 : 6);
+  std::vector<vtkIdType> labels(numberOfVoxels);
+  vtkIdType numberOfIslands = numberOfVoxels > 0 ?
+    labeler->Label(&mask[0], dims, &labels[0]) : 0;
+  std::vector<unsigned char>().swap(mask);
+  self->UpdateProgress(0.5);
+
+  // largest islands first, islands of the same size keep their order
+  std::vector<std::pair<vtkIdType, vtkIdType> > islands;
+  for (vtkIdType label = 1; label <= numberOfIslands; ++label)
+    {
+    islands.push_back(std::make_pair(-labeler->GetIslandSize(label), label));
+    }
+  std::sort(islands.begin(), islands.end());
+
+  std::vector<vtkIdType> relabel(numberOfIslands + 1, 0);
+  unsigned long numberOfObjects = 0;
+  for (size_t i = 0; i < islands.size(); ++i)
+    {
+    if (-islands[i].first >= self->GetMinimumSize())
+      {
+      relabel[islands[i].second] = ++numberOfObjects;
+      }
+    }
+  self->SetNumberOfIslands(numberOfObjects);
+  self->SetOriginalNumberOfIslands(static_cast<unsigned long>(numberOfIslands));
 
+  // Copy to the output
+  for (vtkIdType i = 0; i < numberOfVoxels; ++i)
+    {
+    outPtr[i] = static_cast<T>(relabel[labels[i]]);
+    }
+  self->UpdateProgress(1.0);
 }
 
 
@@ -155,17 +141,11 @@ void vtkITKIslandMath::SimpleExecute(vtkImageData *input, vtkImageData *output)
   if (inScalars->GetNumberOfComponents() == 1 )
     {
 
-////////// These types are not defined in itk ////////////
-#undef VTK_TYPE_USE_LONG_LONG
-#undef VTK_TYPE_USE___INT64
-
 #define CALL  vtkITKIslandMathExecute(this, input, output, static_cast<VTK_TT *>(inPtr), static_cast<VTK_TT *>(outPtr));
 
     void* inPtr = input->GetScalarPointer();
     void* outPtr = output->GetScalarPointer();
 
-#if (ITK_VERSION_MAJOR > 3) || \
-      ((ITK_VERSION_MAJOR == 3 && ITK_VERSION_MINOR >= 14))
     switch (inScalars->GetDataType())
       {
       vtkTemplateMacroCase(VTK_LONG, long, CALL);                               \
@@ -179,19 +159,9 @@ void vtkITKIslandMath::SimpleExecute(vtkImageData *input, vtkImageData *output)
       vtkTemplateMacroCase(VTK_UNSIGNED_CHAR, unsigned char, CALL);             \
       default:
         {
-        vtkErrorMacro(<< "Incompatible data type for this version of ITK.");
-        }
-      } //switch
-#else
-    switch (inScalars->GetDataType())
-      {
-      vtkTemplateMacroCase(VTK_UNSIGNED_LONG, unsigned long, CALL);             \
-      default:
-        {
-        vtkErrorMacro(<< "Incompatible data type for this version of ITK.");
+        vtkErrorMacro(<< "Incompatible data type for island math.");
         }
       } //switch
-#endif
     }
   else 
     {
@@ -14,17 +14,17 @@ PURPOSE.  See the above copyright notice for more information.
 
 =========================================================================*/
 #include "vtkITKLevelTracingImageFilter.h"
-#include "itkLevelTracingImageFilter.h"
 
 #include "vtkCellArray.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkPointData.h"
-#include "vtkStructuredPoints.h"
+#include "vtkPolyData.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
-#include "vtkSmartPointer.h"
+#include "vtkUnsignedCharArray.h"
 
-#include "itkExtractImageFilter.h"
+// STD includes
+#include <algorithm>
 
 vtkCxxRevisionMacro(vtkITKLevelTracingImageFilter, "$Revision: 1.0 $");
 vtkStandardNewMacro(vtkITKLevelTracingImageFilter);
@@ -39,154 +39,183 @@ vtkITKLevelTracingImageFilter::vtkITKLevelTracingImageFilter()
   this->Seed[2] = 0;
 
   this->Plane = 2;  // Default to XY plane
+  this->WindowRadius = 0;
+  this->WindowClipped = 0;
+
+  this->CurveBounds[0] = this->CurveBounds[2] = 0;
+  this->CurveBounds[1] = this->CurveBounds[3] = -1;
+  this->CurveLevel = 0.;
+  this->CurveClipped = 0;
+  this->CurvePlane = -1;
+  this->CurveScalars = 0;
+  this->CurveInputTime = 0;
+  this->Curve = vtkPolyData::New();
 }
 
 vtkITKLevelTracingImageFilter::~vtkITKLevelTracingImageFilter()
 {
+  this->Curve->Delete();
 }
 
+namespace
+{
 
+// 8 connected neighbor offsets, in the order of itk::LevelTracingImageFilter
+const int Neighbors[8][2]= {{-1, -1},
+                            {-1,  0},
+                            {-1,  1},
+                            { 0,  1},
+                            { 1,  1},
+                            { 1,  0},
+                            { 1, -1},
+                            { 0, -1}};
+
+// Pixels of a slice of the volume, addressed by their (u, v) coordinates in
+// the plane. Pixels out of the window are below the level.
 template <class T>
-void vtkITKLevelTracingTrace(vtkITKLevelTracingImageFilter *vtkNotUsed(self), T* scalars,
-                             int dims[3], int extent[6], double origin[3], double spacing[3],
-                             vtkPoints *newPoints,
-                             vtkCellArray *newPolys,
-                             int seed[3], int plane)
+struct LevelTracingSlice
 {
-
-  // Wrap scalars into an ITK image
-  typedef itk::Image<T, 3> ImageType;
-  typename ImageType::Pointer image = ImageType::New();
-  image->GetPixelContainer()->SetImportPointer(scalars, dims[0]*dims[1]*dims[2], false);
-  image->SetOrigin( origin );
-  image->SetSpacing( spacing );
-
-  typename ImageType::RegionType region;
-  typename ImageType::IndexType index;
-  typename ImageType::SizeType size;
-  index[0] = extent[0];   
-  index[1] = extent[2];
-  index[2] = extent[4];
-  region.SetIndex( index );
-  size[0] = extent[1] - extent[0] + 1;
-  size[1] = extent[3] - extent[2] + 1;
-  size[2] = extent[5] - extent[4] + 1;
-  region.SetSize( size );
-  image->SetRegions(region);
-
-  // Extract the 2D slice to process
-  typedef itk::Image<T,2> Image2DType;
-  typedef itk::ExtractImageFilter<ImageType, Image2DType> ExtractType;
-  typename ExtractType::Pointer extract = ExtractType::New();
-#if  ITK_VERSION_MAJOR >=4
-  extract->SetDirectionCollapseToIdentity(); //If you don't care about resulting image dimension
-#endif
-
-  typedef typename ExtractType::InputImageRegionType ExtractionRegionType;
-  ExtractionRegionType extractRegion;
-  typename ExtractionRegionType::IndexType extractIndex;
-  typename ExtractionRegionType::SizeType extractSize;
-
-  extractIndex = index;
-  extractSize = size;
-  extract->SetInput( image );
-
-  // Trace the level curve using itk::LevelTracingImageFilter
-  typedef itk::LevelTracingImageFilter<Image2DType, Image2DType> LevelTracingType;
-  typename LevelTracingType::Pointer tracing = LevelTracingType::New();
-
-  itk::Index<2> seed2D = {{0,0}};
-  switch(plane)
+  const T* Scalars;
+  vtkIdType SliceOffset;
+  vtkIdType Increments[2];
+  int Extent[4];
+  int Window[4];
+  T Level;
+
+  vtkIdType Offset(int u, int v) const
   {
-  case 0: //JK plane
-    seed2D[0] = seed[1];
-    seed2D[1] = seed[2];
-    extractSize[0] = 0;
-    extractIndex[0] = seed[0];
-    break;
-  case 1:  //IK plane
-    seed2D[0] = seed[0];
-    seed2D[1] = seed[2];
-    extractSize[1] = 0;
-    extractIndex[1] = seed[1];
-    break;
-  case 2:  //IJ plane (axials)
-    seed2D[0] = seed[0];
-    seed2D[1] = seed[1];
-    extractSize[2] = 0;
-    extractIndex[2] = seed[2];
-    break;
+    return this->SliceOffset +
+      (u - this->Extent[0]) * this->Increments[0] +
+      (v - this->Extent[2]) * this->Increments[1];
   }
+  bool IsAbove(int u, int v) const
+  {
+    return u >= this->Window[0] && u <= this->Window[1] &&
+           v >= this->Window[2] && v <= this->Window[3] &&
+           this->Scalars[this->Offset(u, v)] >= this->Level;
+  }
+};
 
-  extractRegion.SetIndex( extractIndex );
-  extractRegion.SetSize( extractSize );
-  extract->SetExtractionRegion( extractRegion );  
-
-  tracing->SetSeed(seed2D);
-
-  tracing->SetInput( extract->GetOutput() );
-  tracing->Update();
-
-  // Convert chain code output to points and polys (remember to put
-  // them on the right slice: IJ, IK, JK)
-  // Also put the scalars in...
-
-  typedef itk::ChainCodePath<2> ChainCodePathType;
-  ChainCodePathType::Pointer chain;
-  typedef ChainCodePathType::OffsetType OffsetType;
-
-  chain = tracing->GetPathOutput();
-
-  typename Image2DType::IndexType chainTemp = chain->GetStart();
-  OffsetType offset;
-
-  const unsigned int numberChain = chain->NumberOfSteps();
+} // end of anonymous namespace
 
-  if ( numberChain == 0 )
+// Trace the level curve through the seed like itk::LevelTracingImageFilter
+// does, but in the buffer of the volume: the pixels above the level are 8
+// connected and the curve is followed from a 4 connected neighbor of the
+// seed that is below the level. The pixels of the curve are appended to
+// curve as (u, v) pairs, nothing is appended if the seed is not on a curve.
+template <class T>
+void vtkITKLevelTracingTrace(const T* scalars, int dims[3], int extent[6],
+                             int seed[3], int plane, int windowRadius,
+                             std::vector<int>& curve, int& clipped)
+{
+  // (u, v) axes of the plane (IJ=2, IK=1, JK=0)
+  int u = (plane == 0) ? 1 : 0;
+  int v = (plane == 2) ? 1 : 2;
+  int w = 3 - u - v;
+  vtkIdType increments[3] = {1, dims[0], static_cast<vtkIdType>(dims[0]) * dims[1]};
+
+  LevelTracingSlice<T> slice;
+  slice.Scalars = scalars;
+  slice.SliceOffset = (seed[w] - extent[2*w]) * increments[w];
+  slice.Increments[0] = increments[u];
+  slice.Increments[1] = increments[v];
+  slice.Extent[0] = extent[2*u];
+  slice.Extent[1] = extent[2*u+1];
+  slice.Extent[2] = extent[2*v];
+  slice.Extent[3] = extent[2*v+1];
+  for (int i = 0; i < 4; ++i)
     {
-    return;
+    slice.Window[i] = slice.Extent[i];
+    }
+  if (windowRadius > 0)
+    {
+    slice.Window[0] = std::max(slice.Extent[0], seed[u] - windowRadius);
+    slice.Window[1] = std::min(slice.Extent[1], seed[u] + windowRadius);
+    slice.Window[2] = std::max(slice.Extent[2], seed[v] - windowRadius);
+    slice.Window[3] = std::min(slice.Extent[3], seed[v] + windowRadius);
+    }
+  slice.Level = scalars[slice.Offset(seed[u], seed[v])];
+
+  int pix[2] = {seed[u], seed[v]};
+  int start[2] = {seed[u], seed[v]};
+
+  // We use the standard convention that the foreground is 8
+  // connectected and the background is 4 connected.  This implies
+  // that for a seed point to be on the boundary of the foreground, it
+  // must have a 4 connected neighbor that is the background.
+  int zeroIndex = 1;
+  while (zeroIndex < 8 &&
+         slice.IsAbove(pix[0] + Neighbors[zeroIndex][0], pix[1] + Neighbors[zeroIndex][1]))
+    {
+    zeroIndex += 2;
+    }
+  if (zeroIndex >= 8)
+    {
+    // if no 4 connected neighbor is background, look for an 8 connected
+    // neighbor that is background and move the seed to the 4 connected
+    // neighbor of the original seed that is 4 connected to it.
+    zeroIndex = 0;
+    while (zeroIndex < 8 &&
+           slice.IsAbove(pix[0] + Neighbors[zeroIndex][0], pix[1] + Neighbors[zeroIndex][1]))
+      {
+      zeroIndex += 2;
+      }
+    if (zeroIndex >= 8)
+      {
+      // not near a boundary, no boundary to trace
+      return;
+      }
+    int newSeedIndex = (zeroIndex+1)%8;
+    start[0] = pix[0] + Neighbors[newSeedIndex][0];
+    start[1] = pix[1] + Neighbors[newSeedIndex][1];
+    pix[0] = start[0];
+    pix[1] = start[1];
+    zeroIndex = (newSeedIndex+6)%8;
     }
 
-  vtkIdType * ptIds;
-  ptIds = new vtkIdType [numberChain];
-
-  unsigned int i=0;
-  typename ImageType::IndexType chain3D;
-
+  // follow the curve until it comes back to its start
+  size_t first = curve.size();
   do
     {
-    switch( plane )
+    curve.push_back(pix[0]);
+    curve.push_back(pix[1]);
+    int s = 0;
+    for (; s < 8; ++s)
       {
-      default:
-      case 0:  //JK plane
-        chain3D[0] = seed[0];
-        chain3D[1] = chainTemp[0] ;
-        chain3D[2] = chainTemp[1] ;
-        break;
-      case 1:  //IK plane
-        chain3D[1] = seed[1];
-        chain3D[0] = chainTemp[0] ;
-        chain3D[2] = chainTemp[1] ;
-        break;
-      case 2:  //IJ plane
-        chain3D[2] = seed[2];
-        chain3D[0] = chainTemp[0] ;
-        chain3D[1] = chainTemp[1] ;
+      int neighbor = (s + zeroIndex + 1)%8;
+      int next[2] = {pix[0] + Neighbors[neighbor][0], pix[1] + Neighbors[neighbor][1]};
+      if (slice.IsAbove(next[0], next[1]))
+        {
+        pix[0] = next[0];
+        pix[1] = next[1];
+        // the current pixel is last neighbor to check in next iteration
+        zeroIndex = (neighbor + 4)%8;
         break;
+        }
+      }
+    if (s == 8)
+      {
+      // isolated pixel, no curve
+      curve.resize(first);
+      return;
       }
-  
-    newPoints->InsertPoint(i, chain3D[0], chain3D[1], chain3D[2]);
-    ptIds[i] = i;
-    offset = chain->IncrementInput(i);
-    chainTemp[0] = chainTemp[0] + offset[0];
-    chainTemp[1] = chainTemp[1] + offset[1];
-    //vtkGenericWarningMacro( << "Chain point: "  << chainTemp );  
     }
-  while( i < numberChain );
-
-  newPolys->InsertNextCell( i, ptIds );
+  while (pix[0] != start[0] || pix[1] != start[1]);
 
-  delete [] ptIds;
+  // the curve is cut by the window if it goes along one of its borders
+  // that is not a border of the slice
+  clipped = 0;
+  for (size_t i = first; i < curve.size(); i += 2)
+    {
+    if ((curve[i] == slice.Window[0] && slice.Window[0] > slice.Extent[0]) ||
+        (curve[i] == slice.Window[1] && slice.Window[1] < slice.Extent[1]) ||
+        (curve[i+1] == slice.Window[2] && slice.Window[2] > slice.Extent[2]) ||
+        (curve[i+1] == slice.Window[3] && slice.Window[3] < slice.Extent[3]))
+      {
+      clipped = 1;
+      break;
+      }
+    }
 }
 
 //
@@ -207,13 +236,9 @@ int vtkITKLevelTracingImageFilter::RequestData(
   vtkPolyData *output = vtkPolyData::SafeDownCast(
     outInfo->Get(vtkDataObject::DATA_OBJECT()));
 
-  vtkPoints *newPts;
-  vtkCellArray *newPolys;
   vtkPointData *pd;
   vtkDataArray *inScalars;
   int dims[3], extent[6];
-  int estimatedSize;
-  double spacing[3], origin[3];
 
   vtkDebugMacro(<< "Executing level tracing");
 
@@ -232,59 +257,82 @@ int vtkITKLevelTracingImageFilter::RequestData(
     vtkErrorMacro(<<"Scalars must be defined for level tracing");
     return 1;
   }
+  if (inScalars->GetNumberOfComponents() != 1 &&
+      inScalars->GetNumberOfComponents() != 3)
+    {
+    vtkErrorMacro(<< "Can only trace scalar and RGB images.");
+    return 1;
+    }
 
   input->GetDimensions(dims);
-  input->GetOrigin(origin);
-  input->GetSpacing(spacing);
-
   inInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), extent);
 
-  // estimate the number of points from the volume dimensions
-  estimatedSize = (int) pow ((double) (dims[0] * dims[1] * dims[2]), .75);
-  estimatedSize = estimatedSize / 1024 * 1024; //multiple of 1024
-  if (estimatedSize < 1024)
-  {
-    estimatedSize = 1024;
-  }
-  vtkDebugMacro(<< "Estimated allocation size is " << estimatedSize);
-  
-  newPts = vtkPoints::New(); 
-  newPts->Allocate(estimatedSize,estimatedSize/2);
-
-  newPolys = vtkCellArray::New();
-  newPolys->Allocate(newPolys->EstimateSize(estimatedSize,2));
-
-////////// These types are not defined in itk::NumericTraits ////////////
-#ifdef vtkTemplateMacroCase_ui64
-#undef vtkTemplateMacroCase_ui64
-# define vtkTemplateMacroCase_ui64(typeN, type, call)
-#endif
-#ifdef vtkTemplateMacroCase_si64
-#undef vtkTemplateMacroCase_si64
-# define vtkTemplateMacroCase_si64(typeN, type, call)
-#endif
-#ifdef vtkTemplateMacroCase_ll
-#undef vtkTemplateMacroCase_ll
-# define vtkTemplateMacroCase_ll(typeN, type, call)
-#endif
+  this->WindowClipped = 0;
+  for (int i = 0; i < 3; ++i)
+    {
+    if (this->Seed[i] < extent[2*i] || this->Seed[i] > extent[2*i+1])
+      {
+      // the seed is outside the image, no curve
+      return 1;
+      }
+    }
+  vtkIdType seedId = (this->Seed[0] - extent[0]) +
+    (this->Seed[1] - extent[2]) * static_cast<vtkIdType>(dims[0]) +
+    (this->Seed[2] - extent[4]) * static_cast<vtkIdType>(dims[0]) * dims[1];
+  double level;
+  if (inScalars->GetNumberOfComponents() == 1)
+    {
+    level = inScalars->GetComponent(seedId, 0);
+    }
+  else
+    {
+    double in[3];
+    inScalars->GetTuple(seedId, in);
+    level = static_cast<unsigned char>((2125.0 * in[0] +  7154.0 * in[1] +  0721.0 * in[2]) / 10000.0);
+    }
+
+  //
+  // The curve through a pixel of the last curve at the same level is the
+  // last curve, as long as the window doesn't cut it
+  //
+  int u = (this->Plane == 0) ? 1 : 0;
+  int v = (this->Plane == 2) ? 1 : 2;
+  bool windowContainsCurve = this->WindowRadius == 0 ||
+    (this->CurveBounds[0] > this->Seed[u] - this->WindowRadius &&
+     this->CurveBounds[1] < this->Seed[u] + this->WindowRadius &&
+     this->CurveBounds[2] > this->Seed[v] - this->WindowRadius &&
+     this->CurveBounds[3] < this->Seed[v] + this->WindowRadius);
+  if (this->CurveScalars == inScalars->GetVoidPointer(0) &&
+      this->CurveInputTime == input->GetMTime() &&
+      this->CurvePlane == this->Plane &&
+      this->CurveLevel == level &&
+      !this->CurveClipped && windowContainsCurve &&
+      std::binary_search(this->CurvePixels.begin(), this->CurvePixels.end(), seedId))
+    {
+    vtkDebugMacro(<< "Reusing the last curve");
+    output->ShallowCopy(this->Curve);
+    return 1;
+    }
+
+  std::vector<int> curve;
+  int clipped = 0;
   if (inScalars->GetNumberOfComponents() == 1 )
   {
     void* scalars = inScalars->GetVoidPointer(0);
     switch (inScalars->GetDataType())
     {
       vtkTemplateMacro(
-        vtkITKLevelTracingTrace(this, static_cast<VTK_TT*>(scalars),
-        dims,extent,origin,spacing,
-        newPts,newPolys,this->Seed, this->Plane
+        vtkITKLevelTracingTrace(static_cast<VTK_TT*>(scalars),
+        dims, extent, this->Seed, this->Plane, this->WindowRadius,
+        curve, clipped
         )
         );
     } //switch
   }
-  else if (inScalars->GetNumberOfComponents() == 3) 
+  else
     {
     // RGB - convert for now...
-    vtkSmartPointer<vtkUnsignedCharArray> grayScalars
-      = vtkUnsignedCharArray::New();
+    vtkUnsignedCharArray* grayScalars = vtkUnsignedCharArray::New();
     grayScalars->SetNumberOfTuples( inScalars->GetNumberOfTuples() );
       
     double in[3];
@@ -298,36 +346,63 @@ int vtkITKLevelTracingImageFilter::RequestData(
       grayScalars->SetTupleValue(i, &out);
       }
 
-    vtkITKLevelTracingTrace(this,
-                            (unsigned char *)grayScalars->GetVoidPointer(0),
-                            dims, extent, origin, spacing, 
-                            newPts, newPolys, this->Seed, this->Plane);
+    vtkITKLevelTracingTrace(grayScalars->GetPointer(0),
+                            dims, extent, this->Seed, this->Plane,
+                            this->WindowRadius, curve, clipped);
+    grayScalars->Delete();
     }
-  else
+
+  //
+  // Convert the curve to points and a polyline on the right slice (IJ,
+  // IK, JK) and remember its pixels
+  //
+  vtkIdType numberOfPoints = static_cast<vtkIdType>(curve.size() / 2);
+  vtkPoints *newPts = vtkPoints::New();
+  newPts->SetNumberOfPoints(numberOfPoints);
+  vtkCellArray *newPolys = vtkCellArray::New();
+  this->CurvePixels.resize(numberOfPoints);
+  this->CurveBounds[0] = this->CurveBounds[2] = VTK_INT_MAX;
+  this->CurveBounds[1] = this->CurveBounds[3] = VTK_INT_MIN;
+  if (numberOfPoints > 0)
     {
-    vtkErrorMacro(<< "Can only trace scalar and RGB images.");
+    newPolys->InsertNextCell(numberOfPoints);
     }
+  int point[3] = {this->Seed[0], this->Seed[1], this->Seed[2]};
+  for (vtkIdType i = 0; i < numberOfPoints; ++i)
+    {
+    point[u] = curve[2*i];
+    point[v] = curve[2*i+1];
+    newPts->SetPoint(i, point[0], point[1], point[2]);
+    newPolys->InsertCellPoint(i);
+    this->CurvePixels[i] = (point[0] - extent[0]) +
+      (point[1] - extent[2]) * static_cast<vtkIdType>(dims[0]) +
+      (point[2] - extent[4]) * static_cast<vtkIdType>(dims[0]) * dims[1];
+    this->CurveBounds[0] = std::min(this->CurveBounds[0], point[u]);
+    this->CurveBounds[1] = std::max(this->CurveBounds[1], point[u]);
+    this->CurveBounds[2] = std::min(this->CurveBounds[2], point[v]);
+    this->CurveBounds[3] = std::max(this->CurveBounds[3], point[v]);
+    }
+  std::sort(this->CurvePixels.begin(), this->CurvePixels.end());
+  this->WindowClipped = clipped;
+  this->CurveClipped = clipped;
+  this->CurveLevel = level;
+  this->CurvePlane = this->Plane;
+  this->CurveScalars = inScalars->GetVoidPointer(0);
+  this->CurveInputTime = input->GetMTime();
 
   vtkDebugMacro(<<"Created: " 
     << newPts->GetNumberOfPoints() << " points. " );
-  //
-  // Update ourselves.  Because we don't know up front how many edges
-  // we've created, take care to reclaim memory. 
-  //
+
   output->SetPoints(newPts);
   newPts->Delete();
 
   output->SetLines(newPolys);
   newPolys->Delete();
 
-  output->Squeeze();
+  this->Curve->ShallowCopy(output);
   return 1;
 }
 
-
-
-
-
 int vtkITKLevelTracingImageFilter::FillInputPortInformation(int, vtkInformation *info)
 {
   info->Set(vtkAlgorithm::INPUT_REQUIRED_DATA_TYPE(), "vtkImageData");
@@ -352,4 +427,6 @@ void vtkITKLevelTracingImageFilter::PrintSelf(ostream& os, vtkIndent indent)
     default: os << "(unknown)" << std::endl;
       break;
     }
+  os << indent << "WindowRadius: " << this->WindowRadius << std::endl;
+  os << indent << "WindowClipped: " << this->WindowClipped << std::endl;
 }
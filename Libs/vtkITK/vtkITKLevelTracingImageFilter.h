@@ -6,6 +6,9 @@
 #include "vtkPolyDataAlgorithm.h"
 #include "vtkObjectFactory.h"
 
+// STD includes
+#include <vector>
+
 /// \brief Wrapper class around itk::LevelTracingImageFilterImageFilter.
 ///
 /// itk::LevelTracingImageFilter
@@ -16,6 +19,12 @@
 /// This filter is specialized to volumes. If you are interested in 
 /// contouring other types of data, use the general vtkContourFilter. If you
 /// want to contour an image (i.e., a volume slice), use vtkMarchingSquares.
+///
+/// The curve is traced in the buffer of the input, in a time proportional
+/// to its length. It is kept between updates and is reused while the seed
+/// moves along it at the same level, which is what happens when the cursor
+/// follows a boundary. A window around the seed can bound the tracing for
+/// previews.
 class VTK_ITK_EXPORT vtkITKLevelTracingImageFilter : public vtkPolyDataAlgorithm
 {
 public:
@@ -35,6 +44,16 @@ public:
   void SetPlaneToIK() {this->SetPlane(1);}
   void SetPlaneToJK() {this->SetPlane(0);}
 
+  /// Half size in pixels of the window around the seed the curve is traced
+  /// in, the pixels out of it are below the level. 0 (default) traces in
+  /// the whole slice.
+  vtkSetClampMacro(WindowRadius, int, 0, VTK_INT_MAX);
+  vtkGetMacro(WindowRadius, int);
+
+  /// Non-zero if the last curve reached the border of the window, it is
+  /// then not the curve of the whole slice
+  vtkGetMacro(WindowClipped, int);
+
 protected:
   vtkITKLevelTracingImageFilter();
   ~vtkITKLevelTracingImageFilter();
@@ -44,6 +63,19 @@ protected:
 
   int Seed[3];
   int Plane;
+  int WindowRadius;
+  int WindowClipped;
+
+  /// Last traced curve: the sorted voxel ids of its pixels, its bounds in
+  /// the plane and what it was traced in
+  std::vector<vtkIdType> CurvePixels;
+  int CurveBounds[4];
+  double CurveLevel;
+  int CurveClipped;
+  int CurvePlane;
+  void* CurveScalars;
+  unsigned long CurveInputTime;
+  vtkPolyData* Curve;
 
 private:
   vtkITKLevelTracingImageFilter(const vtkITKLevelTracingImageFilter&);  /// Not implemented.
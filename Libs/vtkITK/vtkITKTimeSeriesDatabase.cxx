@@ -14,9 +14,47 @@
 #include "vtkITKTimeSeriesDatabase.h"
 
 #include <vtkDataArray.h>
+#include <vtkMatrix4x4.h>
 
 vtkCxxRevisionMacro(vtkITKTimeSeriesDatabase, "$Revision: 6383 $");
 vtkStandardNewMacro(vtkITKTimeSeriesDatabase);
+
+bool vtkITKTimeSeriesDatabase::Connect ( const char* filename )
+  {
+  try
+    {
+    this->m_Filter->Connect ( filename );
+    }
+  catch ( itk::ExceptionObject& e )
+    {
+    vtkErrorMacro ( "Connect: failed to open " << ( filename ? filename : "(null)" ) << ": " << e );
+    return false;
+    }
+  this->Modified();
+  return true;
+  };
+
+void vtkITKTimeSeriesDatabase::GetIJKToRASMatrix ( vtkMatrix4x4* ijkToRAS )
+  {
+  if ( !ijkToRAS )
+    {
+    return;
+    }
+  // ITK images are in LPS, flip the first two axes
+  const double lpsToRAS[3] = { -1., -1., 1. };
+  SourceType::OutputImageType::DirectionType direction = this->m_Filter->GetOutputDirection();
+  SourceType::OutputImageType::SpacingType spacing = this->m_Filter->GetOutputSpacing();
+  SourceType::OutputImageType::PointType origin = this->m_Filter->GetOutputOrigin();
+  ijkToRAS->Identity();
+  for ( int i = 0; i < 3; i++ )
+    {
+    for ( int j = 0; j < 3; j++ )
+      {
+      ijkToRAS->SetElement ( i, j, lpsToRAS[i] * direction[i][j] * spacing[j] );
+      }
+    ijkToRAS->SetElement ( i, 3, lpsToRAS[i] * origin[i] );
+    }
+  };
 void vtkITKTimeSeriesDatabase::ExecuteInformation()
   {
   vtkImageData *output = this->GetOutput();
@@ -47,6 +85,11 @@ void vtkITKTimeSeriesDatabase::ExecuteInformation()
 void  vtkITKTimeSeriesDatabase::ExecuteData(vtkDataObject *output) 
   {
     vtkImageData *data = vtkImageData::SafeDownCast(output);
+    // Read the current image, the output of the filter is given to VTK
+    // below and must be generated again.
+    this->m_Filter->GetOutput()->SetRequestedRegion ( this->m_Filter->GetOutputRegion() );
+    this->m_Filter->Modified();
+    this->m_Filter->Update();
     data->SetExtent(0,0,0,0,0,0);
     data->AllocateScalars();
     data->SetExtent(data->GetWholeExtent());
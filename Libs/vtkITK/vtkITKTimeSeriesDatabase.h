@@ -23,6 +23,7 @@
 #include "itkTimeSeriesDatabase.h"
 #include "vtkImageImport.h"
 #include "itkVTKImageExport.h"
+class vtkMatrix4x4;
 
 #include "vtkITK.h"
 #include "vtkITKUtility.h"
@@ -33,6 +34,11 @@
 /// stored on disk.  The database allows efficient access to volumes,
 /// slices and voxels through time.
 ///
+/// The blocks read from the database are cached within CacheSizeInMiB and
+/// the PrefetchTimePoints images following CurrentImage are read in the
+/// background after each update: stepping through the images of a cine
+/// loop doesn't wait for the disk when they fit in the cache.
+///
 /// \note
 /// This work is part of the National Alliance for Medical Image Computing
 /// (NAMIC), funded by the National Institutes of Health through the NIH Roadmap
@@ -51,10 +57,18 @@ public:
   {
     itk::TimeSeriesDatabase<OutputImagePixelType>::CreateFromFileArchetype ( TSDFilename, ArchetypeFilename );
   };
+  /// Create a TimeSeriesDatabase split into blocks of BlockSize^3 voxels
+  /// in files of FileSize bytes
+  static void CreateFromFileArchetype ( const char* TSDFilename, const char* ArchetypeFilename,
+                                        unsigned long FileSize, unsigned int BlockSize )
+  {
+    itk::TimeSeriesDatabase<OutputImagePixelType>::CreateFromFileArchetype ( TSDFilename, ArchetypeFilename, FileSize, BlockSize );
+  };
   
   /// Connect/Disconnect to a database
-  /// void Connect ( const char* filename ) { this->m_Filter->Connect ( filename ); this->Modified(); };
-  /// void Disconnect() { this->m_Filter->Disconnect(); }
+  /// Return false if the database can't be opened.
+  bool Connect ( const char* filename );
+  void Disconnect() { this->m_Filter->Disconnect(); this->Modified(); }
 
   /// Get/Set the current time stamp to read 
   void SetCurrentImage ( unsigned int value )
@@ -64,6 +78,27 @@ public:
 
   int GetNumberOfVolumes() 
   { DelegateITKOutputMacro ( GetNumberOfVolumes ); }; 
+
+  /// Edge length in voxels of the blocks of the database
+  unsigned int GetBlockSize()
+  { DelegateITKOutputMacro ( GetBlockSize ); };
+
+  /// Get/Set the memory used to cache the blocks of the database
+  void SetCacheSizeInMiB ( float value )
+  { DelegateITKInputMacro ( SetCacheSizeInMiB, value ); };
+  float GetCacheSizeInMiB()
+  { DelegateITKOutputMacro ( GetCacheSizeInMiB ); };
+
+  /// Get/Set the number of images read in the background after an update
+  void SetPrefetchTimePoints ( unsigned int value )
+  { DelegateITKInputMacro ( SetPrefetchTimePoints, value ); };
+  unsigned int GetPrefetchTimePoints()
+  { DelegateITKOutputMacro ( GetPrefetchTimePoints ); };
+
+  /// Fill \a ijkToRAS with the IJK to RAS matrix of the images of the
+  /// connected database. The output image has the spacing and the origin
+  /// of the database in LPS like the other vtkITK readers.
+  void GetIJKToRASMatrix ( vtkMatrix4x4* ijkToRAS );
   
 protected:
   vtkITKTimeSeriesDatabase() 
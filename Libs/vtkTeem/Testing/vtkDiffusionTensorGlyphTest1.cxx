@@ -0,0 +1,146 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// vtkTeem includes
+#include <vtkDiffusionTensorGlyph.h>
+
+// VTK includes
+#include <vtkCellArray.h>
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkMath.h>
+#include <vtkMatrix4x4.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+#include <vtkSphereSource.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Check the bounds of the points of the glyph number glyph
+bool CheckGlyphBounds(vtkPolyData* output, vtkIdType numberOfSourcePoints,
+                      int glyph, const double expectedBounds[6])
+{
+  double bounds[6] = {VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX, VTK_DOUBLE_MAX,
+                      -VTK_DOUBLE_MAX, VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX};
+  for (vtkIdType i = 0; i < numberOfSourcePoints; ++i)
+    {
+    double* x = output->GetPoint(glyph * numberOfSourcePoints + i);
+    for (int j = 0; j < 3; ++j)
+      {
+      bounds[2 * j] = std::min(bounds[2 * j], x[j]);
+      bounds[2 * j + 1] = std::max(bounds[2 * j + 1], x[j]);
+      }
+    }
+  for (int j = 0; j < 6; ++j)
+    {
+    if (fabs(bounds[j] - expectedBounds[j]) > 1e-4)
+      {
+      std::cerr << "Wrong bounds of glyph " << glyph << ": "
+                << bounds[0] << " " << bounds[1] << " " << bounds[2] << " "
+                << bounds[3] << " " << bounds[4] << " " << bounds[5] << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkDiffusionTensorGlyphTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  // Three tensors along x: elongated along x, elongated along y and empty
+  vtkSmartPointer<vtkImageData> tensorImage = vtkSmartPointer<vtkImageData>::New();
+  tensorImage->SetDimensions(3, 1, 1);
+  tensorImage->SetSpacing(10., 10., 10.);
+  vtkDataArray* tensors = vtkDataArray::CreateDataArray(VTK_FLOAT);
+  tensors->SetNumberOfComponents(9);
+  tensors->SetNumberOfTuples(3);
+  double tensor[9] = {4., 0., 0., 0., 1., 0., 0., 0., 1.};
+  tensors->SetTuple(0, tensor);
+  tensor[0] = 1.; tensor[4] = 4.;
+  tensors->SetTuple(1, tensor);
+  tensor[0] = tensor[4] = tensor[8] = 0.;
+  tensors->SetTuple(2, tensor);
+  tensorImage->GetPointData()->SetTensors(tensors);
+  tensors->Delete();
+
+  vtkSmartPointer<vtkSphereSource> sphere = vtkSmartPointer<vtkSphereSource>::New();
+  sphere->SetThetaResolution(8);
+  sphere->SetPhiResolution(8);
+  sphere->Update();
+  vtkIdType numberOfSourcePoints = sphere->GetOutput()->GetNumberOfPoints();
+
+  vtkSmartPointer<vtkDiffusionTensorGlyph> glyph =
+    vtkSmartPointer<vtkDiffusionTensorGlyph>::New();
+  glyph->SetInput(tensorImage);
+  glyph->SetSource(sphere->GetOutput());
+  glyph->SetScaleFactor(1.);
+  glyph->ColorGlyphsByFractionalAnisotropy();
+  glyph->Update();
+
+  // The scales are the square roots of the eigenvalues
+  vtkPolyData* output = glyph->GetOutput();
+  if (output->GetNumberOfPoints() != 2 * numberOfSourcePoints ||
+      output->GetPolys()->GetNumberOfCells() !=
+        2 * sphere->GetOutput()->GetPolys()->GetNumberOfCells() ||
+      !output->GetPointData()->GetScalars() ||
+      output->GetPointData()->GetScalars()->GetNumberOfTuples() != 2 * numberOfSourcePoints ||
+      !output->GetPointData()->GetNormals())
+    {
+    std::cerr << "Wrong glyph output: " << output->GetNumberOfPoints() << " points "
+              << output->GetPolys()->GetNumberOfCells() << " polys" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const double xBounds[6] = {-1., 1., -0.5, 0.5, -0.5, 0.5};
+  const double yBounds[6] = {9.5, 10.5, -1., 1., -0.5, 0.5};
+  if (!CheckGlyphBounds(output, numberOfSourcePoints, 0, xBounds) ||
+      !CheckGlyphBounds(output, numberOfSourcePoints, 1, yBounds))
+    {
+    return EXIT_FAILURE;
+    }
+  vtkDataArray* normals = output->GetPointData()->GetNormals();
+  for (vtkIdType i = 0; i < normals->GetNumberOfTuples(); ++i)
+    {
+    double normal[3];
+    normals->GetTuple(i, normal);
+    if (fabs(vtkMath::Norm(normal) - 1.) > 1e-4)
+      {
+      std::cerr << "Normal " << i << " is not normalized" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // The tensors are rotated but not the glyph positions
+  vtkSmartPointer<vtkMatrix4x4> rotation = vtkSmartPointer<vtkMatrix4x4>::New();
+  rotation->SetElement(0, 0, 0.);
+  rotation->SetElement(0, 1, -1.);
+  rotation->SetElement(1, 0, 1.);
+  rotation->SetElement(1, 1, 0.);
+  glyph->SetTensorRotationMatrix(rotation);
+  glyph->Update();
+  const double rotatedXBounds[6] = {-0.5, 0.5, -1., 1., -0.5, 0.5};
+  const double rotatedYBounds[6] = {9., 11., -0.5, 0.5, -0.5, 0.5};
+  if (!CheckGlyphBounds(glyph->GetOutput(), numberOfSourcePoints, 0, rotatedXBounds) ||
+      !CheckGlyphBounds(glyph->GetOutput(), numberOfSourcePoints, 1, rotatedYBounds))
+    {
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
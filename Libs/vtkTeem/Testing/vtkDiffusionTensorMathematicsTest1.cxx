@@ -123,5 +123,43 @@ int vtkDiffusionTensorMathematicsTest1(int vtkNotUsed(argc), char* vtkNotUsed(ar
       }
     std::cout << std::endl << std::endl;
     }
+
+  // The cached eigen systems must give the same results, also after the
+  // tensors are modified
+  filter->SetMaskWithScalars(0);
+  vtkSmartPointer<vtkDiffusionTensorMathematics> cachedFilter =
+    vtkSmartPointer<vtkDiffusionTensorMathematics>::New();
+  cachedFilter->SetInput(tensorImage);
+  cachedFilter->CacheEigenSystemsOn();
+  const int operations[5] = {
+    vtkDiffusionTensorMathematics::VTK_TENS_FRACTIONAL_ANISOTROPY,
+    vtkDiffusionTensorMathematics::VTK_TENS_MAX_EIGENVALUE,
+    vtkDiffusionTensorMathematics::VTK_TENS_MAX_EIGENVEC_PROJX,
+    vtkDiffusionTensorMathematics::VTK_TENS_MIN_EIGENVALUE,
+    vtkDiffusionTensorMathematics::VTK_TENS_FRACTIONAL_ANISOTROPY};
+  for (int i = 0; i < 5; ++i)
+    {
+    if (i == 4)
+      {
+      ptr = reinterpret_cast<float*>(scalars->GetVoidPointer(0));
+      ptr[0] = 3.f;
+      scalars->Modified();
+      }
+    filter->SetOperation(operations[i]);
+    filter->Update();
+    cachedFilter->SetOperation(operations[i]);
+    cachedFilter->Update();
+    float* expected = reinterpret_cast<float*>(filter->GetOutput()->GetScalarPointer());
+    float* cached = reinterpret_cast<float*>(cachedFilter->GetOutput()->GetScalarPointer());
+    for (int j = 0; j < dimensions[0]*dimensions[1]*dimensions[2]; ++j)
+      {
+      if (expected[j] != cached[j])
+        {
+        std::cerr << "Operation " << operations[i] << " with cache failed: "
+                  << cached[j] << " instead of " << expected[j] << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,121 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// vtkTeem includes
+#include <vtkNRRDReader.h>
+#include <vtkNRRDWriter.h>
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkPointData.h>
+#include <vtkSmartPointer.h>
+
+// STD includes
+#include <iostream>
+#include <string>
+
+//----------------------------------------------------------------------------
+int vtkNRRDReaderMemoryMappingTest1(int argc, char* argv[])
+{
+  if (argc < 2)
+    {
+    std::cerr << "Usage: vtkNRRDReaderMemoryMappingTest1 temporary_directory"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::string fileName =
+    std::string(argv[1]) + "/vtkNRRDReaderMemoryMappingTest1.nrrd";
+
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(4, 3, 2);
+  image->SetScalarTypeToShort();
+  image->SetNumberOfScalarComponents(1);
+  image->AllocateScalars();
+  short* values = static_cast<short*>(image->GetScalarPointer());
+  for (int i = 0; i < 24; ++i)
+    {
+    values[i] = static_cast<short>(i * 10);
+    }
+
+  vtkSmartPointer<vtkNRRDWriter> writer = vtkSmartPointer<vtkNRRDWriter>::New();
+  writer->SetFileName(fileName.c_str());
+  writer->SetInput(image);
+  writer->UseCompressionOff();
+  writer->Write();
+
+  vtkSmartPointer<vtkNRRDReader> reader = vtkSmartPointer<vtkNRRDReader>::New();
+  reader->SetFileName(fileName.c_str());
+  reader->UseMemoryMappingOn();
+  reader->Update();
+  if (!reader->GetMemoryMapped())
+    {
+    std::cerr << "Line " << __LINE__
+              << " - An uncompressed file should be mapped" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  vtkSmartPointer<vtkImageData> mappedImage =
+    vtkSmartPointer<vtkImageData>::New();
+  mappedImage->ShallowCopy(reader->GetOutput());
+  short* mappedValues = static_cast<short*>(mappedImage->GetScalarPointer());
+  for (int i = 0; i < 24; ++i)
+    {
+    if (mappedValues[i] != values[i])
+      {
+      std::cerr << "Line " << __LINE__ << " - Wrong mapped value at " << i
+                << ": " << mappedValues[i] << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // Writing in the mapped data doesn't modify the file
+  mappedValues[0] = 1234;
+  vtkSmartPointer<vtkNRRDReader> reader2 = vtkSmartPointer<vtkNRRDReader>::New();
+  reader2->SetFileName(fileName.c_str());
+  reader2->Update();
+  if (reader2->GetMemoryMapped() ||
+      static_cast<short*>(reader2->GetOutput()->GetScalarPointer())[0] != 0)
+    {
+    std::cerr << "Line " << __LINE__
+              << " - The mapped file has been modified" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Unmapping keeps the values, including the modified ones
+  reader = 0;
+  vtkNRRDReader::UnmapFile(mappedImage, fileName.c_str());
+  vtkDataArray* scalars = mappedImage->GetPointData()->GetScalars();
+  if (!scalars || scalars->GetVoidPointer(0) == mappedValues ||
+      scalars->GetComponent(0, 0) != 1234 ||
+      scalars->GetComponent(23, 0) != 230)
+    {
+    std::cerr << "Line " << __LINE__
+              << " - Problem with vtkNRRDReader::UnmapFile()" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Compressed files are read
+  writer->UseCompressionOn();
+  writer->Write();
+  vtkSmartPointer<vtkNRRDReader> reader3 = vtkSmartPointer<vtkNRRDReader>::New();
+  reader3->SetFileName(fileName.c_str());
+  reader3->UseMemoryMappingOn();
+  reader3->Update();
+  if (reader3->GetMemoryMapped() ||
+      static_cast<short*>(reader3->GetOutput()->GetScalarPointer())[23] != 230)
+    {
+    std::cerr << "Line " << __LINE__
+              << " - A compressed file should not be mapped" << std::endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
@@ -26,7 +26,33 @@
 #include "vtkImageData.h"
 #include "vtkDiffusionTensorMathematics.h"
 
+#include <cstring>
 #include <ctime>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// a = a * b, for 4x4 row major matrices
+void vtkDiffusionTensorGlyphConcatenate(double a[16], const double b[16])
+{
+  double c[16];
+  vtkMatrix4x4::Multiply4x4(a, b, c);
+  memcpy(a, c, sizeof(c));
+}
+
+//----------------------------------------------------------------------------
+// Source cells of one type (verts, lines, polys or strips) and the output
+// cells they are copied to for each glyph.
+struct vtkDiffusionTensorGlyphCells
+{
+  vtkCellArray* Output;
+  // npts, id0, id1, ... for each source cell
+  std::vector<vtkIdType> Connectivity;
+};
+
+} // end of anonymous namespace
 
 vtkCxxSetObjectMacro(vtkDiffusionTensorGlyph,Mask,vtkImageData);
 vtkCxxSetObjectMacro(vtkDiffusionTensorGlyph,VolumePositionMatrix,vtkMatrix4x4);
@@ -158,7 +184,7 @@ int vtkDiffusionTensorGlyph::RequestData(
 
   vtkDataArray *inTensors;
   vtkDataArray *inScalars;
-  vtkIdType numPts, numSourcePts, numSourceCells, inPtId, i;
+  vtkIdType numPts, numSourcePts, inPtId, i;
   int j;
   vtkPoints *sourcePts;
   vtkDataArray *sourceNormals;
@@ -167,19 +193,17 @@ int vtkDiffusionTensorGlyph::RequestData(
   vtkFloatArray *newScalars=NULL;
   vtkFloatArray *newNormals=NULL;
   double x[3], x2[3], s;
-  vtkTransform *trans;
-  vtkCell *cell;
-  vtkIdList *cellPts;
   int npts;
   vtkIdType *pts;
-  vtkIdType cellId;
   vtkIdType subIncr;
   int numDirs, dir, eigen_dir, symmetric_dir;
-  vtkMatrix4x4 *matrix;
   double *m[3], w[3], *v[3];
   double m0[3], m1[3], m2[3];
   double v0[3], v1[3], v2[3];
   double xv[3], yv[3], zv[3];
+  double instance[16], eigenvectors[16], normalMatrix[16];
+  const double rotateZ90[16] = {0,-1,0,0, 1,0,0,0, 0,0,1,0, 0,0,0,1};
+  const double rotateYMinus90[16] = {0,0,-1,0, 0,1,0,0, 1,0,0,0, 0,0,0,1};
   double maxScale;
   vtkPointData *pd, *outPD;
 
@@ -202,8 +226,6 @@ int vtkDiffusionTensorGlyph::RequestData(
   numDirs = (this->ThreeGlyphs?3:1)*(this->Symmetric+1);
   
   pts = new vtkIdType[source->GetMaxCellSize()];
-  trans = vtkTransform::New();
-  matrix = vtkMatrix4x4::New();
   
   // set up working matrices
   m[0] = m0; m[1] = m1; m[2] = m2; 
@@ -219,8 +241,7 @@ int vtkDiffusionTensorGlyph::RequestData(
   if ( !inTensors || numPts < 1 )
     {
     vtkErrorMacro(<<"No data to glyph!");
-    trans->Delete();
-    matrix->Delete();
+    delete [] pts;
     return 1;
     }
 
@@ -261,7 +282,6 @@ int vtkDiffusionTensorGlyph::RequestData(
   //
   sourcePts = source->GetPoints();
   numSourcePts = sourcePts->GetNumberOfPoints();
-  numSourceCells = source->GetNumberOfCells();
 
   newPts = vtkPoints::New();
   // Allocate as if we will glyph every point
@@ -269,6 +289,15 @@ int vtkDiffusionTensorGlyph::RequestData(
   // TO DO allocate less for lower resolution
   newPts->Allocate(numDirs*numInputPts*numSourcePts);
 
+  // The source glyph is copied once for each glyph (an instance) and moved
+  // by the instance matrix, its topology is offset by the instance points.
+  std::vector<vtkDiffusionTensorGlyphCells> sourceCellTypes;
+  std::vector<double> sourceXYZ(3*numSourcePts);
+  for (i=0; i < numSourcePts; i++)
+    {
+    sourcePts->GetPoint(i, &sourceXYZ[3*i]);
+    }
+
   // Setting up for calls to PolyData::InsertNextCell()
   if ( (sourceCells=source->GetVerts())->GetNumberOfCells() > 0 )
     {
@@ -276,6 +305,10 @@ int vtkDiffusionTensorGlyph::RequestData(
     cells->Allocate(numDirs*numInputPts*sourceCells->GetSize());
     output->SetVerts(cells);
     cells->Delete();
+    sourceCellTypes.push_back(vtkDiffusionTensorGlyphCells());
+    sourceCellTypes.back().Output = cells;
+    sourceCellTypes.back().Connectivity.assign(
+      sourceCells->GetPointer(), sourceCells->GetPointer() + sourceCells->GetNumberOfConnectivityEntries());
     }
   if ( (sourceCells=this->GetSource()->GetLines())->GetNumberOfCells() > 0 )
     {
@@ -283,6 +316,10 @@ int vtkDiffusionTensorGlyph::RequestData(
     cells->Allocate(numDirs*numInputPts*sourceCells->GetSize());
     output->SetLines(cells);
     cells->Delete();
+    sourceCellTypes.push_back(vtkDiffusionTensorGlyphCells());
+    sourceCellTypes.back().Output = cells;
+    sourceCellTypes.back().Connectivity.assign(
+      sourceCells->GetPointer(), sourceCells->GetPointer() + sourceCells->GetNumberOfConnectivityEntries());
     }
   if ( (sourceCells=this->GetSource()->GetPolys())->GetNumberOfCells() > 0 )
     {
@@ -290,6 +327,10 @@ int vtkDiffusionTensorGlyph::RequestData(
     cells->Allocate(numDirs*numInputPts*sourceCells->GetSize());
     output->SetPolys(cells);
     cells->Delete();
+    sourceCellTypes.push_back(vtkDiffusionTensorGlyphCells());
+    sourceCellTypes.back().Output = cells;
+    sourceCellTypes.back().Connectivity.assign(
+      sourceCells->GetPointer(), sourceCells->GetPointer() + sourceCells->GetNumberOfConnectivityEntries());
     }
   if ( (sourceCells=this->GetSource()->GetStrips())->GetNumberOfCells() > 0 )
     {
@@ -297,6 +338,10 @@ int vtkDiffusionTensorGlyph::RequestData(
     cells->Allocate(numDirs*numInputPts*sourceCells->GetSize());
     output->SetStrips(cells);
     cells->Delete();
+    sourceCellTypes.push_back(vtkDiffusionTensorGlyphCells());
+    sourceCellTypes.back().Output = cells;
+    sourceCellTypes.back().Connectivity.assign(
+      sourceCells->GetPointer(), sourceCells->GetPointer() + sourceCells->GetNumberOfConnectivityEntries());
     }
 
 
@@ -319,11 +364,17 @@ int vtkDiffusionTensorGlyph::RequestData(
     outPD->CopyScalarsOn();
     outPD->CopyAllocate(pd,numDirs*numInputPts*numSourcePts);
     }
+  std::vector<double> sourceNormalsXYZ;
   if ( (sourceNormals = pd->GetNormals()) )
     {
     newNormals = vtkFloatArray::New();
     newNormals->SetNumberOfComponents(3);
     newNormals->Allocate(numDirs*3*numInputPts*numSourcePts);
+    sourceNormalsXYZ.resize(3*numSourcePts);
+    for (i=0; i < numSourcePts; i++)
+      {
+      sourceNormals->GetTuple(i, &sourceNormalsXYZ[3*i]);
+      }
     }
 
   // Don't copy all topology here as in superclass because
@@ -363,8 +414,6 @@ int vtkDiffusionTensorGlyph::RequestData(
   // and outputting it at each point.  (Input points are not all used, only
   // those not masked and included by this->Resolution.)
   //
-  trans->PreMultiply();
-
   for (inPtId=0; inPtId < numPts; inPtId += skipCols)
     {
     if (col >= rowLength)
@@ -404,25 +453,25 @@ int vtkDiffusionTensorGlyph::RequestData(
     if (( ( inMask != NULL ) && inMask->GetTuple1( inPtId ) ) || ( !this->MaskGlyphs && trace > 0 )) 
       {
       // copy topology of output glyph for this point
-      for (cellId=0; cellId < numSourceCells; cellId++)
+      for (size_t type=0; type < sourceCellTypes.size(); type++)
         {
-        cell = this->GetSource()->GetCell(cellId);
-        cellPts = cell->GetPointIds();
-        npts = cellPts->GetNumberOfIds();
-        for (dir=0; dir < numDirs; dir++)
+        const std::vector<vtkIdType>& connectivity = sourceCellTypes[type].Connectivity;
+        cells = sourceCellTypes[type].Output;
+        for (size_t cellLoc=0; cellLoc < connectivity.size(); cellLoc += npts + 1)
           {
-          // This variable may be removed, but that 
-          // will not improve readability
-          //subIncr = ptIncr + dir*numSourcePts;
-
-          // Add offset calculated from all non-masked points added to output so far
-          subIncr = ptOffset + dir*numSourcePts;
-
-          for (i=0; i < npts; i++)
+          npts = static_cast<int>(connectivity[cellLoc]);
+          const vtkIdType* cellPtIds = &connectivity[cellLoc + 1];
+          for (dir=0; dir < numDirs; dir++)
             {
-            pts[i] = cellPts->GetId(i) + subIncr;
+            // Add offset calculated from all non-masked points added to output so far
+            subIncr = ptOffset + dir*numSourcePts;
+
+            for (i=0; i < npts; i++)
+              {
+              pts[i] = cellPtIds[i] + subIncr;
+              }
+            cells->InsertNextCell(npts,pts);
             }
-          output->InsertNextCell(cell->GetCellType(),npts,pts);
           }
         }
 
@@ -603,18 +652,13 @@ int vtkDiffusionTensorGlyph::RequestData(
         eigen_dir = dir%(this->ThreeGlyphs?3:1);
         symmetric_dir = dir/(this->ThreeGlyphs?3:1);
 
-        // Remove previous scales ...
-        trans->Identity();
-
-
-
         // Actually output the scalar invariant calculated above
         if ( newScalars != NULL )
           {
+          float* scalars = newScalars->WritePointer(ptOffset, numSourcePts);
           for (i=0; i < numSourcePts; i++) 
             {
-
-            newScalars->InsertTuple(ptOffset+i, &s);
+            scalars[i] = static_cast<float>(s);
             }        
           }
         else
@@ -635,57 +679,67 @@ int vtkDiffusionTensorGlyph::RequestData(
         if ( userVolumeTransform != NULL )
           {
           userVolumeTransform->TransformPoint(x,x2);
-          trans->Translate(x2[0], x2[1], x2[2]);
           }  
         else
           {
-          trans->Translate(x[0], x[1], x[2]);
+          x2[0] = x[0]; x2[1] = x[1]; x2[2] = x[2];
           }
-
+        vtkMatrix4x4::Identity(instance);
+        instance[3] = x2[0];
+        instance[7] = x2[1];
+        instance[11] = x2[2];
         
         // If we have a user-specified matrix rotating each tensor
         if (this->TensorRotationMatrix)
           {
-          trans->Concatenate(this->TensorRotationMatrix);
+          vtkDiffusionTensorGlyphConcatenate(instance, *this->TensorRotationMatrix->Element);
           }
 
         // normalized eigenvectors rotate object for eigen direction 0
-        matrix->Element[0][0] = xv[0];
-        matrix->Element[0][1] = yv[0];
-        matrix->Element[0][2] = zv[0];
-        matrix->Element[1][0] = xv[1];
-        matrix->Element[1][1] = yv[1];
-        matrix->Element[1][2] = zv[1];
-        matrix->Element[2][0] = xv[2];
-        matrix->Element[2][1] = yv[2];
-        matrix->Element[2][2] = zv[2];
-        trans->Concatenate(matrix);
+        vtkMatrix4x4::Identity(eigenvectors);
+        for (i=0; i<3; i++)
+          {
+          eigenvectors[4*i] = xv[i];
+          eigenvectors[4*i+1] = yv[i];
+          eigenvectors[4*i+2] = zv[i];
+          }
+        vtkDiffusionTensorGlyphConcatenate(instance, eigenvectors);
 
         if (eigen_dir == 1) 
           {
-          trans->RotateZ(90.0);
+          vtkDiffusionTensorGlyphConcatenate(instance, rotateZ90);
           }
 
         if (eigen_dir == 2)
           {
-          trans->RotateY(-90.0);
+          vtkDiffusionTensorGlyphConcatenate(instance, rotateYMinus90);
           }
 
+        double scale[3];
         if (this->ThreeGlyphs) 
           {
-          trans->Scale(w[eigen_dir], this->ScaleFactor, this->ScaleFactor);
+          scale[0] = w[eigen_dir];
+          scale[1] = this->ScaleFactor;
+          scale[2] = this->ScaleFactor;
           }
         else
           {
-
-          trans->Scale(w[0], w[1], w[2]);
-
+          scale[0] = w[0];
+          scale[1] = w[1];
+          scale[2] = w[2];
           }
 
         // Mirror second set to the symmetric position
         if (symmetric_dir == 1)
           {
-          trans->Scale(-1.,1.,1.);
+          scale[0] = -scale[0];
+          }
+        for (i=0; i<3; i++)
+          {
+          for (j=0; j<3; j++)
+            {
+            instance[4*i+j] *= scale[j];
+            }
           }
 
         // if the eigenvalue is negative, shift to reverse direction.
@@ -694,27 +748,47 @@ int vtkDiffusionTensorGlyph::RequestData(
         // in case there is an oriented glyph, e.g. an arrow.
         if (w[eigen_dir] < 0 && numDirs > 1) 
           {
-          trans->Translate(-this->Length, 0., 0.);
+          for (i=0; i<3; i++)
+            {
+            instance[4*i+3] -= this->Length * instance[4*i];
+            }
           }
 
-        // multiply points (and normals if available) by resulting
-        // matrix.
-        // This also appends them to the output "new" data.
-        trans->TransformPoints(sourcePts,newPts); 
-
-        // Apply the transformation to a series of points, 
-        // and append the results to outPts.
-        if ( newNormals )
+        // multiply points (and normals if available) by the instance
+        // matrix and append them to the output "new" data.
+        float* outPt = vtkFloatArray::SafeDownCast(newPts->GetData())
+          ->WritePointer(3*ptOffset, 3*numSourcePts);
+        const double* inPt = &sourceXYZ[0];
+        for (i=0; i < numSourcePts; i++, inPt += 3, outPt += 3)
           {
-          if ( flipNormals )
+          for (j=0; j<3; j++)
             {
-            trans->Scale(-1.,-1.,-1.);
-            trans->TransformNormals(sourceNormals,newNormals);
-            trans->Scale(-1.,-1.,-1.);
+            outPt[j] = static_cast<float>(
+              instance[4*j]*inPt[0] + instance[4*j+1]*inPt[1] + instance[4*j+2]*inPt[2] +
+              instance[4*j+3]);
             }
-          else
+          }
+
+        // Normals are transformed by the inverse transpose of the instance
+        // matrix and renormalized.
+        if ( newNormals )
+          {
+          vtkMatrix4x4::Invert(instance, normalMatrix);
+          float* outNormal = newNormals->WritePointer(3*ptOffset, 3*numSourcePts);
+          const double* inNormal = &sourceNormalsXYZ[0];
+          for (i=0; i < numSourcePts; i++, inNormal += 3, outNormal += 3)
             {
-            trans->TransformNormals(sourceNormals,newNormals);
+            double normal[3];
+            for (j=0; j<3; j++)
+              {
+              normal[j] = normalMatrix[j]*inNormal[0] + normalMatrix[4+j]*inNormal[1] +
+                normalMatrix[8+j]*inNormal[2];
+              }
+            vtkMath::Normalize(normal);
+            for (j=0; j<3; j++)
+              {
+              outNormal[j] = static_cast<float>(flipNormals ? -normal[j] : normal[j]);
+              }
             }
           }
         
@@ -754,8 +828,6 @@ int vtkDiffusionTensorGlyph::RequestData(
     }
 
   output->Squeeze();
-  trans->Delete();
-  matrix->Delete();
 
   if ( userVolumeTransform )
     {
@@ -19,6 +19,7 @@
 
 // But, if you are on VS6.0 you don't get the define...
 #include "vtkDataArray.h"
+#include "vtkDoubleArray.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkImageData.h"
@@ -28,6 +29,7 @@
 #include "vtkObjectFactory.h"
 #include "vtkTransform.h"
 #include "vtkPointData.h"
+#include "vtkUnsignedCharArray.h"
 #ifndef M_SQRT2
 #define M_SQRT2    1.41421356237309504880168872421      /* sqrt(2) */
 #endif
@@ -66,6 +68,11 @@ vtkDiffusionTensorMathematics::vtkDiffusionTensorMathematics()
   this->MaskWithScalars = 0;
   this->FixNegativeEigenvalues = 1;
   this->MaskLabelValue = 1;
+  this->CacheEigenSystems = 0;
+  this->EigenSystems = vtkDoubleArray::New();
+  this->EigenSystems->SetNumberOfComponents(12);
+  this->EigenSystemsComputed = vtkUnsignedCharArray::New();
+  this->EigenSystemsTensors = NULL;
 }
 
 //----------------------------------------------------------------------------     
@@ -79,6 +86,8 @@ vtkDiffusionTensorMathematics::vtkDiffusionTensorMathematics()
      {     
      this->ScalarMask->Delete();     
      }     
+   this->EigenSystems->Delete();
+   this->EigenSystemsComputed->Delete();
  }
 
 //----------------------------------------------------------------------------
@@ -143,6 +152,11 @@ int vtkDiffusionTensorMathematics
 ::RequestData(vtkInformation* request, vtkInformationVector** inputVector,
               vtkInformationVector* outputVector)
 {
+  vtkInformation* inInfo = inputVector[0]->GetInformationObject(0);
+  vtkImageData* inData = inInfo ? vtkImageData::SafeDownCast(
+    inInfo->Get(vtkDataObject::DATA_OBJECT())) : 0;
+  this->UpdateEigenSystemsCache(this->CacheEigenSystems ? inData : 0);
+
   int res = this->Superclass::RequestData(request, inputVector, outputVector);
   for (int i = 0; i < this->GetNumberOfOutputPorts(); ++i)
     {
@@ -154,6 +168,54 @@ int vtkDiffusionTensorMathematics
   return res;
 }
 
+//----------------------------------------------------------------------------
+void vtkDiffusionTensorMathematics::UpdateEigenSystemsCache(vtkImageData* inData)
+{
+  vtkDataArray* tensors = inData ? inData->GetPointData()->GetTensors() : 0;
+  if (tensors == NULL)
+    {
+    // release the memory
+    this->EigenSystems->Initialize();
+    this->EigenSystemsComputed->Initialize();
+    this->EigenSystemsTensors = NULL;
+    return;
+    }
+  // the pipeline may regenerate the tensors in the same array, the update
+  // time of the input tells
+  unsigned long tensorsTime = tensors->GetMTime();
+  tensorsTime = MAX(tensorsTime, inData->GetMTime());
+  tensorsTime = MAX(tensorsTime, inData->GetUpdateTime());
+  if (tensors == this->EigenSystemsTensors &&
+      tensorsTime < this->EigenSystemsTime.GetMTime() &&
+      tensors->GetNumberOfTuples() == this->EigenSystems->GetNumberOfTuples())
+    {
+    // up to date
+    return;
+    }
+  this->EigenSystems->SetNumberOfTuples(tensors->GetNumberOfTuples());
+  this->EigenSystemsComputed->SetNumberOfTuples(tensors->GetNumberOfTuples());
+  this->EigenSystemsComputed->FillComponent(0, 0.);
+  this->EigenSystemsTensors = tensors;
+  this->EigenSystemsTime.Modified();
+}
+
+//----------------------------------------------------------------------------
+int vtkDiffusionTensorMathematics::GetEigenSystemsCache(vtkDataArray* tensors,
+  double*& eigenSystems, unsigned char*& computed)
+{
+  if (!this->CacheEigenSystems || tensors == NULL ||
+      tensors != this->EigenSystemsTensors ||
+      tensors->GetNumberOfTuples() != this->EigenSystems->GetNumberOfTuples())
+    {
+    eigenSystems = NULL;
+    computed = NULL;
+    return 0;
+    }
+  eigenSystems = this->EigenSystems->GetPointer(0);
+  computed = this->EigenSystemsComputed->GetPointer(0);
+  return 1;
+}
+
 //----------------------------------------------------------------------------
 static void GetContinuousIncrements(vtkImageData* img, int extent[6], vtkIdType &incX,
                                     vtkIdType &incY, vtkIdType &incZ)
@@ -446,6 +508,27 @@ static void vtkDiffusionTensorMathematicsExecute1Eigen(vtkDiffusionTensorMathema
   // decide whether to extract eigenfunctions or just use input cols
   extractEigenvalues = self->GetExtractEigenvalues();
 
+  // eigen systems solved by previous executions
+  double* eigenSystems = 0;
+  unsigned char* eigenSystemsComputed = 0;
+  const float* tensorsPtr = reinterpret_cast<float*>(inTensors->GetVoidPointer(0));
+  self->GetEigenSystemsCache(inTensors, eigenSystems, eigenSystemsComputed);
+
+  // without cache, only solve the eigenvectors if the operation uses them
+  bool needEigenvectors = eigenSystems != 0 ||
+    (op != vtkDiffusionTensorMathematics::VTK_TENS_RELATIVE_ANISOTROPY &&
+     op != vtkDiffusionTensorMathematics::VTK_TENS_FRACTIONAL_ANISOTROPY &&
+     op != vtkDiffusionTensorMathematics::VTK_TENS_LINEAR_MEASURE &&
+     op != vtkDiffusionTensorMathematics::VTK_TENS_PLANAR_MEASURE &&
+     op != vtkDiffusionTensorMathematics::VTK_TENS_SPHERICAL_MEASURE &&
+     op != vtkDiffusionTensorMathematics::VTK_TENS_MAX_EIGENVALUE &&
+     op != vtkDiffusionTensorMathematics::VTK_TENS_MID_EIGENVALUE &&
+     op != vtkDiffusionTensorMathematics::VTK_TENS_MIN_EIGENVALUE &&
+     op != vtkDiffusionTensorMathematics::VTK_TENS_PARALLEL_DIFFUSIVITY &&
+     op != vtkDiffusionTensorMathematics::VTK_TENS_PERPENDICULAR_DIFFUSIVITY &&
+     op != vtkDiffusionTensorMathematics::VTK_TENS_MODE &&
+     op != vtkDiffusionTensorMathematics::VTK_TENS_COLOR_MODE);
+
   // transformation of tensor orientations for coloring
   vtkTransform *trans = vtkTransform::New();
   int useTransform = 0;
@@ -520,17 +603,49 @@ static void vtkDiffusionTensorMathematicsExecute1Eigen(vtkDiffusionTensorMathema
           // get eigenvalues and eigenvectors appropriately
           if (extractEigenvalues) 
             {
-            for (j=0; j<3; j++)
+            double* eigenSystem = 0;
+            vtkIdType tensorId = 0;
+            if (eigenSystems)
+              {
+              tensorId = (inPtr - tensorsPtr) / 9;
+              eigenSystem = eigenSystems + 12 * tensorId;
+              }
+            if (eigenSystem && eigenSystemsComputed[tensorId])
               {
+              // solved by a previous execution
+              w[0] = eigenSystem[0]; w[1] = eigenSystem[1]; w[2] = eigenSystem[2];
               for (i=0; i<3; i++)
                 {
-                // transpose
-                m[i][j] = tensor[j][i];
+                v[i][0] = eigenSystem[3 + 3*i];
+                v[i][1] = eigenSystem[4 + 3*i];
+                v[i][2] = eigenSystem[5 + 3*i];
+                }
+              }
+            else
+              {
+              for (j=0; j<3; j++)
+                {
+                for (i=0; i<3; i++)
+                  {
+                  // transpose
+                  m[i][j] = tensor[j][i];
+                  }
+                }
+              // compute eigensystem
+              //vtkMath::Jacobi(m, w, v);
+              vtkDiffusionTensorMathematics::TeemEigenSolver(m,w,needEigenvectors ? v : NULL);
+              if (eigenSystem)
+                {
+                eigenSystem[0] = w[0]; eigenSystem[1] = w[1]; eigenSystem[2] = w[2];
+                for (i=0; i<3; i++)
+                  {
+                  eigenSystem[3 + 3*i] = v[i][0];
+                  eigenSystem[4 + 3*i] = v[i][1];
+                  eigenSystem[5 + 3*i] = v[i][2];
+                  }
+                eigenSystemsComputed[tensorId] = 1;
                 }
               }
-            // compute eigensystem
-            //vtkMath::Jacobi(m, w, v);
-            vtkDiffusionTensorMathematics::TeemEigenSolver(m,w,v);
             }
           else
             {
@@ -1141,6 +1256,7 @@ void vtkDiffusionTensorMathematics::PrintSelf(ostream& os, vtkIndent indent)
   this->Superclass::PrintSelf(os,indent);
 
   os << indent << "Operation: " << this->Operation << "\n";
+  os << indent << "CacheEigenSystems: " << this->CacheEigenSystems << "\n";
 }
 
 // Colormap: convert our mode value (-1..1) to RGB
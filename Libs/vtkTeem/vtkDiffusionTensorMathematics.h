@@ -29,8 +29,11 @@
 #include "vtkTeemConfigure.h"
 #include "vtkThreadedImageAlgorithm.h"
 
+class vtkDataArray;
+class vtkDoubleArray;
 class vtkMatrix4x4;
 class vtkImageData;
+class vtkUnsignedCharArray;
 class VTK_Teem_EXPORT vtkDiffusionTensorMathematics : public vtkThreadedImageAlgorithm
 {
 public:
@@ -226,6 +229,22 @@ public:
   vtkSetMacro(MaskLabelValue, int);
   vtkGetMacro(MaskLabelValue, int);
 
+  /// 
+  /// Keep the eigen systems of the input tensors between executions, so
+  /// that changing the operation does not solve them again until the
+  /// tensors are modified. The cache takes 12 doubles per input tensor and
+  /// is meant for slice sized inputs. Off by default.
+  vtkBooleanMacro(CacheEigenSystems, int);
+  vtkSetMacro(CacheEigenSystems, int);
+  vtkGetMacro(CacheEigenSystems, int);
+
+  /// Public for access from threads
+  /// Get the cached eigenvalues (3) and eigenvectors (9) of each tensor and
+  /// whether they are already computed. Returns 0 if there is no cache for
+  /// these tensors.
+  int GetEigenSystemsCache(vtkDataArray* tensors,
+                           double*& eigenSystems, unsigned char*& computed);
+
   /// Public for access from threads
   static void ModeToRGB(double Mode, double FA,
                  double &R, double &G, double &B);
@@ -281,6 +300,17 @@ protected:
   vtkMatrix4x4 *TensorRotationMatrix;
   int FixNegativeEigenvalues;
 
+  int CacheEigenSystems;
+  vtkDoubleArray *EigenSystems;
+  vtkUnsignedCharArray *EigenSystemsComputed;
+  /// Tensors of the cache, only used for comparison
+  vtkDataArray *EigenSystemsTensors;
+  vtkTimeStamp EigenSystemsTime;
+
+  /// Reset the cache if the input tensors changed or were regenerated by
+  /// the pipeline, before the threads execute
+  void UpdateEigenSystemsCache(vtkImageData* inData);
+
   virtual int RequestInformation (vtkInformation*,
                                   vtkInformationVector**,
                                   vtkInformationVector*);
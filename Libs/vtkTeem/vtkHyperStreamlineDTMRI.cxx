@@ -15,12 +15,16 @@
 
 #include "vtkCellArray.h"
 #include "vtkFloatArray.h"
+#include "vtkGenericCell.h"
 #include "vtkMath.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 
+#include <algorithm>
+#include <vector>
+
 // the superclass had these classes in the vtkHyperStreamline.cxx
 // file: being compiled via CMakeListsLocal.txt
 #if (VTK_MAJOR_VERSION == 4 && VTK_MINOR_VERSION >= 3)
@@ -139,25 +143,103 @@ vtkDataSet *input = vtkDataSet::SafeDownCast(
 vtkPolyData *output = vtkPolyData::SafeDownCast(
   outInfo->Get(vtkDataObject::DATA_OBJECT()));
 
+  vtkDebugMacro(<<"Generating hyperstreamline(s)");
+  this->NumberOfStreamers = 0;
+
+  if ( ! input->GetPointData()->GetTensors() )
+    {
+    vtkErrorMacro(<<"No tensor data defined!");
+    return 0;
+    }
+
+  vtkFloatingPointType startPosition[3];
+  if ( this->StartFrom == VTK_START_FROM_POSITION )
+    {
+    for (int i=0; i<3; i++)
+      {
+      startPosition[i] = this->StartPosition[i];
+      }
+    }
+  else //VTK_START_FROM_LOCATION
+    {
+    vtkFloatingPointType *w = new vtkFloatingPointType[input->GetMaxCellSize()];
+    vtkCell *cell = input->GetCell(this->StartCell);
+    cell->EvaluateLocation(this->StartSubId, this->StartPCoords, startPosition, w);
+    delete [] w;
+    }
+
+  vtkFloatingPointType tol2 = input->GetLength() / 1000.0;
+  tol2 = tol2 * tol2;
+
+  this->Streamers = new vtkTractographyArray[2];
+  vtkGenericCell *cell = vtkGenericCell::New();
+  this->NumberOfStreamers =
+    this->IntegrateStreamers(input, tol2, startPosition, this->Streamers, cell);
+  cell->Delete();
+
+  this->BuildLines(input,output);
+
+  // note: these two lines fix memory leak in code copied from vtk
+  delete [] this->Streamers;
+  this->Streamers = NULL;
+  return 1;
+}
+
+// Interpolate the tensor and the scalar at the weights w of the points
+// of the cell, the tuples of the points are read without the shared
+// tuple buffer of the arrays so that threads can interpolate at once.
+static void InterpolateTensor(vtkDataArray *inTensors, vtkDataArray *inScalars,
+                              vtkCell *cell, const vtkFloatingPointType *w,
+                              vtkFloatingPointType **m, vtkFloatingPointType *s)
+{
+  int i, j, k;
+  double tensor[9];
+  for (j=0; j<3; j++)
+    {
+    for (i=0; i<3; i++)
+      {
+      m[i][j] = 0.0;
+      }
+    }
+  for (k=0; k < cell->GetNumberOfPoints(); k++)
+    {
+    inTensors->GetTuple(cell->PointIds->GetId(k), tensor);
+    for (j=0; j<3; j++)
+      {
+      for (i=0; i<3; i++)
+        {
+        m[i][j] += tensor[i+3*j] * w[k];
+        }
+      }
+    }
+  if ( inScalars && s )
+    {
+    for (*s=0.0, k=0; k < cell->GetNumberOfPoints(); k++)
+      {
+      *s += inScalars->GetComponent(cell->PointIds->GetId(k), 0) * w[k];
+      }
+    }
+}
 
+int vtkHyperStreamlineDTMRI::IntegrateStreamers(vtkDataSet *input,
+                                                vtkFloatingPointType tol2,
+                                                vtkFloatingPointType startPosition[3],
+                                                vtkTractographyArray *streamers,
+                                                vtkGenericCell *cell)
+{
   vtkPointData *pd=input->GetPointData();
-  vtkDataArray *inScalars;
-  vtkDataArray *inTensors;
-  vtkFloatingPointType *tensor;
+  vtkDataArray *inScalars = pd->GetScalars();
+  vtkDataArray *inTensors = pd->GetTensors();
   vtkTractographyPoint *sNext, *sPtr;
-  int i, j, k, ptId, subId, iv, ix, iy;
-  vtkCell *cell;
+  int i, ptId, subId, iv, ix, iy;
   vtkFloatingPointType ev[3];
   vtkFloatingPointType xNext[3];
-  vtkFloatingPointType d, step, dir, tol2, p[3];
-  vtkFloatingPointType *w;
+  vtkFloatingPointType d, step, dir, p[3];
   vtkFloatingPointType dist2;
   vtkFloatingPointType closestPoint[3];
   vtkFloatingPointType *m[3], *v[3];
   vtkFloatingPointType m0[3], m1[3], m2[3];
   vtkFloatingPointType v0[3], v1[3], v2[3];
-  vtkDataArray *cellTensors = 0;
-  vtkDataArray *cellScalars = 0;
   int pointCount;
   vtkTractographyPoint *sPrev, *sPrevPrev;
   vtkFloatingPointType kv1[3], kv2[3], ku1[3], ku2[3], kl1, kl2, kn[3], K = 0.0;
@@ -165,113 +247,54 @@ vtkPolyData *output = vtkPolyData::SafeDownCast(
   v[0] = v0; v[1] = v1; v[2] = v2;
   m[0] = m0; m[1] = m1; m[2] = m2;
   float stop = 0.0;
-  //static const float sqrt3halves = sqrt((float)3/2);
   int keepIntegrating;
 
-  vtkDebugMacro(<<"Generating hyperstreamline(s)");
-  this->NumberOfStreamers = 0;
-
-  if ( ! (inTensors=pd->GetTensors()) )
+  if ( !inTensors )
     {
-    vtkErrorMacro(<<"No tensor data defined!");
     return 0;
     }
-  w = new vtkFloatingPointType[input->GetMaxCellSize()];
+  std::vector<vtkFloatingPointType> weights(std::max(input->GetMaxCellSize(), 1));
+  vtkFloatingPointType *w = &weights[0];
 
-  inScalars = pd->GetScalars();
-  if (inTensors)
-    {
-    cellTensors = vtkDataArray::CreateDataArray(inTensors->GetDataType());
-    }
-  if (inScalars)
-    {
-    cellScalars = vtkDataArray::CreateDataArray(inScalars->GetDataType());
-    }
-  int numComp;
-  if (inTensors && cellTensors)
-    {
-    numComp = inTensors->GetNumberOfComponents();
-    cellTensors->SetNumberOfComponents(numComp);
-    cellTensors->SetNumberOfTuples(VTK_CELL_SIZE);
-    }
-  if (inScalars && cellScalars)
-    {
-    numComp = inScalars->GetNumberOfComponents();
-    cellScalars->SetNumberOfComponents(numComp);
-    cellScalars->SetNumberOfTuples(VTK_CELL_SIZE);
-    }
-
-
-  tol2 = input->GetLength() / 1000.0;
-  tol2 = tol2 * tol2;
   iv = this->IntegrationEigenvector;
   ix = (iv + 1) % 3;
   iy = (iv + 2) % 3;
   //
   // Create starting points
   //
-  this->NumberOfStreamers = 1;
+  int numberOfStreamers = 1;
 
   if ( this->IntegrationDirection == VTK_INTEGRATE_BOTH_DIRECTIONS )
     {
-    this->NumberOfStreamers *= 2;
+    numberOfStreamers *= 2;
     }
-
-  this->Streamers = new vtkTractographyArray[this->NumberOfStreamers];
-
-  if ( this->StartFrom == VTK_START_FROM_POSITION )
+  for (ptId=0; ptId < numberOfStreamers; ptId++)
     {
-    sPtr = this->Streamers[0].InsertNextTractographyPoint();
-    for (i=0; i<3; i++)
-      {
-      sPtr->X[i] = this->StartPosition[i];
-      }
-    sPtr->CellId = input->FindCell(this->StartPosition, NULL, (-1), 0.0, 
-                                   sPtr->SubId, sPtr->P, w);
+    streamers[ptId].Reset();
     }
 
-  else //VTK_START_FROM_LOCATION
+  sPtr = streamers[0].InsertNextTractographyPoint();
+  for (i=0; i<3; i++)
     {
-    sPtr = this->Streamers[0].InsertNextTractographyPoint();
-    cell =  input->GetCell(sPtr->CellId);
-    cell->EvaluateLocation(sPtr->SubId, sPtr->P, sPtr->X, w);
+    sPtr->X[i] = startPosition[i];
     }
+  sPtr->CellId = input->FindCell(startPosition, NULL, cell, (-1), 0.0,
+                                 sPtr->SubId, sPtr->P, w);
   //
   // Finish initializing each hyperstreamline
   //
-  this->Streamers[0].Direction = 1.0;
-  sPtr = this->Streamers[0].GetTractographyPoint(0);
+  streamers[0].Direction = 1.0;
   sPtr->D = 0.0;
   if ( sPtr->CellId >= 0 ) //starting point in dataset
     {
-    cell = input->GetCell(sPtr->CellId);
+    input->GetCell(sPtr->CellId, cell);
     cell->EvaluateLocation(sPtr->SubId, sPtr->P, xNext, w);
 
-    inTensors->GetTuples(cell->PointIds, cellTensors);
-
     // interpolate tensor, compute eigenfunctions
-    for (j=0; j<3; j++)
-      {
-      for (i=0; i<3; i++)
-        {
-        m[i][j] = 0.0;
-        }
-      }
-    for (k=0; k < cell->GetNumberOfPoints(); k++)
-      {
-      tensor = cellTensors->GetTuple(k);
-      for (j=0; j<3; j++) 
-        {
-        for (i=0; i<3; i++) 
-          {
-          m[i][j] += tensor[i+3*j] * w[k];
+    InterpolateTensor(inTensors, inScalars, cell, w, m, &sPtr->S);
 
-          }
-        }
-      }
-    
     // store tensor at start point
-    for (j=0; j<3; j++) 
+    for (int j=0; j<3; j++) 
       {
       for (i=0; i<3; i++) 
         {
@@ -283,48 +306,38 @@ vtkPolyData *output = vtkPolyData::SafeDownCast(
     vtkDiffusionTensorMathematics::TeemEigenSolver(m,sPtr->W,sPtr->V);
     FixVectors(NULL, sPtr->V, iv, ix, iy);
 
-    if ( inScalars )
-      {
-      inScalars->GetTuples(cell->PointIds, cellScalars);
-      for (sPtr->S=0, i=0; i < cell->GetNumberOfPoints(); i++)
-        {
-        sPtr->S += cellScalars->GetTuple(i)[0] * w[i];
-        // for curvature coloring for debugging purposes:
-        //sPtr->S =0;
-        }
-      }
-
     if ( this->IntegrationDirection == VTK_INTEGRATE_BOTH_DIRECTIONS )
       {
-      this->Streamers[1].Direction = -1.0;
-      sNext = this->Streamers[1].InsertNextTractographyPoint();
+      streamers[1].Direction = -1.0;
+      sNext = streamers[1].InsertNextTractographyPoint();
       *sNext = *sPtr;
       }
     else if ( this->IntegrationDirection == VTK_INTEGRATE_BACKWARD )
       {
-      this->Streamers[0].Direction = -1.0;
+      streamers[0].Direction = -1.0;
       }
     } //for hyperstreamline in dataset
 
   //
   // For each hyperstreamline, integrate in appropriate direction (using RK2).
   //
-  for (ptId=0; ptId < this->NumberOfStreamers; ptId++)
+  for (ptId=0; ptId < numberOfStreamers; ptId++)
     {
     //get starting step
-    sPtr = this->Streamers[ptId].GetTractographyPoint(0);
+    if ( streamers[ptId].GetNumberOfPoints() < 1 )
+      {
+      continue;
+      }
+    sPtr = streamers[ptId].GetTractographyPoint(0);
     if ( sPtr->CellId < 0 )
       {
       continue;
       }
 
-    dir = this->Streamers[ptId].Direction;
-    cell = input->GetCell(sPtr->CellId);
+    dir = streamers[ptId].Direction;
+    input->GetCell(sPtr->CellId, cell);
     cell->EvaluateLocation(sPtr->SubId, sPtr->P, xNext, w);
     step = this->IntegrationStepLength;
-    inTensors->GetTuples(cell->PointIds, cellTensors);
-    if ( inScalars ) {inScalars->GetTuples(cell->PointIds, cellScalars);}
-
 
     // This is the flag for integration to continue if FA, curvature
     // are within limits
@@ -352,8 +365,8 @@ vtkPolyData *output = vtkPolyData::SafeDownCast(
             // kn=2*(u2-u1)/(norm(v1)+norm(v2));
             // absk=norm(kn);  % absolute value of the curvature
 
-            sPrev = this->Streamers[ptId].GetTractographyPoint(pointCount-1);
-            sPrevPrev = this->Streamers[ptId].GetTractographyPoint(pointCount-2);
+            sPrev = streamers[ptId].GetTractographyPoint(pointCount-1);
+            sPrevPrev = streamers[ptId].GetTractographyPoint(pointCount-2);
             kl2=0;
             kl1=0;
             for (i=0; i<3; i++)
@@ -408,24 +421,7 @@ vtkPolyData *output = vtkPolyData::SafeDownCast(
       cell->EvaluatePosition(xNext, closestPoint, subId, p, dist2, w);
 
       //interpolate tensor
-      for (j=0; j<3; j++)
-        {
-        for (i=0; i<3; i++)
-          {
-          m[i][j] = 0.0;
-          }
-        }
-      for (k=0; k < cell->GetNumberOfPoints(); k++)
-        {
-        tensor = cellTensors->GetTuple(k);
-        for (j=0; j<3; j++)
-          {
-          for (i=0; i<3; i++)
-            {
-            m[i][j] += tensor[i+3*j] * w[k];
-            }
-          }
-        }
+      InterpolateTensor(inTensors, NULL, cell, w, m, NULL);
 
       //vtkMath::Jacobi(m, ev, v);
       vtkDiffusionTensorMathematics::TeemEigenSolver(m,ev,v);
@@ -437,7 +433,9 @@ vtkPolyData *output = vtkPolyData::SafeDownCast(
         xNext[i] = sPtr->X[i] + 
                    dir * (step/2.0) * (sPtr->V[i][iv] + v[i][iv]);
         }
-      sNext = this->Streamers[ptId].InsertNextTractographyPoint();
+      sNext = streamers[ptId].InsertNextTractographyPoint();
+      // sPtr may have moved if the array was resized
+      sPtr = streamers[ptId].GetTractographyPoint(streamers[ptId].GetNumberOfPoints() - 2);
 
       if ( cell->EvaluatePosition(xNext, closestPoint, sNext->SubId, 
       sNext->P, dist2, w) )
@@ -451,7 +449,7 @@ vtkPolyData *output = vtkPolyData::SafeDownCast(
         }
       else
         { //integration has passed out of cell
-        sNext->CellId = input->FindCell(xNext, cell, sPtr->CellId, tol2, 
+        sNext->CellId = input->FindCell(xNext, cell, cell, sPtr->CellId, tol2, 
                                         sNext->SubId, sNext->P, w);
         if ( sNext->CellId >= 0 ) //make sure not out of dataset
           {
@@ -459,9 +457,7 @@ vtkPolyData *output = vtkPolyData::SafeDownCast(
             {
             sNext->X[i] = xNext[i];
             }
-          cell = input->GetCell(sNext->CellId);
-          inTensors->GetTuples(cell->PointIds, cellTensors);
-          if (inScalars){inScalars->GetTuples(cell->PointIds, cellScalars);}
+          input->GetCell(sNext->CellId, cell);
           step = this->IntegrationStepLength;
           }
         }
@@ -469,31 +465,14 @@ vtkPolyData *output = vtkPolyData::SafeDownCast(
       if ( sNext->CellId >= 0 )
         {
         cell->EvaluateLocation(sNext->SubId, sNext->P, xNext, w);
-        for (j=0; j<3; j++)
-          {
-          for (i=0; i<3; i++)
-            {
-            m[i][j] = 0.0;
-            }
-          }
-        for (k=0; k < cell->GetNumberOfPoints(); k++)
-          {
-          tensor = cellTensors->GetTuple(k);
-          for (j=0; j<3; j++) 
-            {
-            for (i=0; i<3; i++) 
-              {
-              m[i][j] += tensor[i+3*j] * w[k];
-              }
-            }
-          }
+        InterpolateTensor(inTensors, inScalars, cell, w, m, &sNext->S);
 
         //vtkMath::Jacobi(m, sNext->W, sNext->V);
         vtkDiffusionTensorMathematics::TeemEigenSolver(m,sNext->W,sNext->V);
         FixVectors(sPtr->V, sNext->V, iv, ix, iy);
 
         // compute invariants at final position                                         
-        switch (this->GetStoppingMode()) {
+        switch (this->StoppingMode) {
         case vtkDiffusionTensorMathematics::VTK_TENS_FRACTIONAL_ANISOTROPY:
             stop = vtkDiffusionTensorMathematics::FractionalAnisotropy(sNext->W);
             break;
@@ -516,20 +495,8 @@ vtkPolyData *output = vtkPolyData::SafeDownCast(
           keepIntegrating=0;
           }
 
-        if ( inScalars )
-          {
-          for (sNext->S=0.0, i=0; i < cell->GetNumberOfPoints(); i++)
-            {
-              // output interpolated scalar data
-              sNext->S += cellScalars->GetTuple(i)[0] * w[i];
-              // for curvature coloring for debugging purposes:
-              //sNext->S =K;
-
-            }
-          }
-
         // output tensor at final position
-        for (j=0; j<3; j++) 
+        for (int j=0; j<3; j++) 
             {
             for (i=0; i<3; i++) 
               {
@@ -550,22 +517,7 @@ vtkPolyData *output = vtkPolyData::SafeDownCast(
 
     } //for each hyperstreamline
 
-  this->BuildLines(input,output);
-
-  delete [] w;
-  if (inTensors)
-    {
-    cellTensors->Delete();
-    }
-  if (inScalars)
-    {
-    cellScalars->Delete();
-    }
-
-  // note: these two lines fix memory leak in code copied from vtk
-  delete [] this->Streamers;
-  this->Streamers = NULL;
-  return 1;
+  return numberOfStreamers;
 }
 
 void vtkHyperStreamlineDTMRI::BuildLines(vtkDataSet *input, vtkPolyData *output)
@@ -20,6 +20,8 @@
 #include "vtkDiffusionTensorMathematics.h" /// for VTK_TENS_FRACTIONAL_ANISOTROPY
 #include "vtkTractographyPointAndArray.h"
 
+class vtkGenericCell;
+
 /// \brief Generate hyperstreamline in arbitrary dataset.
 ///
 /// vtkHyperStreamlineDTMRI is a filter that integrates through a tensor field to 
@@ -100,6 +102,19 @@ public:
   vtkSetMacro(OneTrajectoryPerSeedPoint, int);
   vtkBooleanMacro(OneTrajectoryPerSeedPoint, int);
 
+  /// 
+  /// Integrate the trajectories of a start position (in the coordinates
+  /// of input) as RequestData() does, into streamers which must hold two
+  /// arrays. tol2 is the squared tolerance to find the cells along the way.
+  /// Only the settings of this object are read and the cells are fetched
+  /// in cell, so that threads can integrate seeds of the same input at once
+  /// with their own streamers and cell. Return the number of integrated
+  /// streamers, 2 when integrating in both directions.
+  int IntegrateStreamers(vtkDataSet *input, vtkFloatingPointType tol2,
+                         vtkFloatingPointType startPosition[3],
+                         vtkTractographyArray *streamers,
+                         vtkGenericCell *cell);
+
 protected:
   vtkHyperStreamlineDTMRI();
   ~vtkHyperStreamlineDTMRI();
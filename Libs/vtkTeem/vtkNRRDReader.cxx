@@ -45,8 +45,153 @@
 #include "vtkDoubleArray.h"
 #include "vtkFloatArray.h" 
 
+#include "vtkCallbackCommand.h"
+#include "vtkCriticalSection.h"
+#include "vtkSmartPointer.h"
+
+#include <vtksys/SystemTools.hxx>
+
 #include "teem/ten.h"
 
+#include <fstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+//----------------------------------------------------------------------------
+namespace
+{
+
+/// File region mapped copy-on-write for the point data of a vtkNRRDReader
+/// output. The region is unmapped when the array that wraps it is deleted.
+struct vtkNRRDMappedFile
+{
+  vtkNRRDMappedFile() : Address(0), Length(0)
+#ifdef _WIN32
+    , File(INVALID_HANDLE_VALUE), Mapping(0)
+#endif
+    {}
+  std::string HeaderFileName;
+  std::string DataFileName;
+  void* Address;
+  size_t Length;
+#ifdef _WIN32
+  HANDLE File;
+  HANDLE Mapping;
+#endif
+};
+
+typedef std::map<vtkDataArray*, vtkNRRDMappedFile*> vtkNRRDMappedArraysType;
+vtkNRRDMappedArraysType vtkNRRDMappedArrays;
+vtkSimpleCriticalSection vtkNRRDMappedArraysLock;
+
+//----------------------------------------------------------------------------
+void vtkNRRDUnmap(vtkNRRDMappedFile* mapped)
+{
+#ifdef _WIN32
+  if (mapped->Address)
+    {
+    UnmapViewOfFile(mapped->Address);
+    }
+  if (mapped->Mapping)
+    {
+    CloseHandle(mapped->Mapping);
+    }
+  if (mapped->File != INVALID_HANDLE_VALUE)
+    {
+    CloseHandle(mapped->File);
+    }
+#else
+  if (mapped->Address)
+    {
+    munmap(mapped->Address, mapped->Length);
+    }
+#endif
+  mapped->Address = 0;
+}
+
+//----------------------------------------------------------------------------
+/// Map \a size bytes of \a mapped->DataFileName starting at \a offset.
+/// Return the address of the first byte or 0 on failure.
+char* vtkNRRDMap(vtkNRRDMappedFile* mapped, vtkTypeInt64 offset, size_t size)
+{
+  // The mapping must start at a multiple of the page size (of the
+  // allocation granularity on Windows)
+#ifdef _WIN32
+  SYSTEM_INFO systemInfo;
+  GetSystemInfo(&systemInfo);
+  vtkTypeInt64 granularity = systemInfo.dwAllocationGranularity;
+#else
+  vtkTypeInt64 granularity = sysconf(_SC_PAGESIZE);
+#endif
+  vtkTypeInt64 start = (offset / granularity) * granularity;
+  mapped->Length = static_cast<size_t>(offset - start) + size;
+#ifdef _WIN32
+  mapped->File = CreateFileA(mapped->DataFileName.c_str(), GENERIC_READ,
+                             FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                             FILE_ATTRIBUTE_NORMAL, NULL);
+  if (mapped->File == INVALID_HANDLE_VALUE)
+    {
+    return 0;
+    }
+  mapped->Mapping = CreateFileMapping(mapped->File, NULL, PAGE_WRITECOPY,
+                                      0, 0, NULL);
+  if (mapped->Mapping)
+    {
+    mapped->Address = MapViewOfFile(mapped->Mapping, FILE_MAP_COPY,
+                                    static_cast<DWORD>(start >> 32),
+                                    static_cast<DWORD>(start & 0xFFFFFFFF),
+                                    mapped->Length);
+    }
+#else
+  int fd = open(mapped->DataFileName.c_str(), O_RDONLY);
+  if (fd < 0)
+    {
+    return 0;
+    }
+  void* address = mmap(0, mapped->Length, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE, fd, static_cast<off_t>(start));
+  // the mapping keeps a reference to the file
+  close(fd);
+  mapped->Address = (address == MAP_FAILED) ? 0 : address;
+#endif
+  if (!mapped->Address)
+    {
+    vtkNRRDUnmap(mapped);
+    return 0;
+    }
+  return static_cast<char*>(mapped->Address) + (offset - start);
+}
+
+//----------------------------------------------------------------------------
+void vtkNRRDMappedArrayDeleted(vtkObject* caller, unsigned long,
+                               void* vtkNotUsed(clientData), void*)
+{
+  vtkNRRDMappedFile* mapped = 0;
+  vtkNRRDMappedArraysLock.Lock();
+  vtkNRRDMappedArraysType::iterator it =
+    vtkNRRDMappedArrays.find(static_cast<vtkDataArray*>(caller));
+  if (it != vtkNRRDMappedArrays.end())
+    {
+    mapped = it->second;
+    vtkNRRDMappedArrays.erase(it);
+    }
+  vtkNRRDMappedArraysLock.Unlock();
+  if (mapped)
+    {
+    vtkNRRDUnmap(mapped);
+    delete mapped;
+    }
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
 vtkCxxRevisionMacro(vtkNRRDReader, "$Revision: 1.7.2.1 $");
 vtkStandardNewMacro(vtkNRRDReader);
 
@@ -60,6 +205,9 @@ vtkNRRDReader::vtkNRRDReader()
   nrrd = nrrdNew();
   UseNativeOrigin = true;
   ReadStatus = 0;
+  UseMemoryMapping = 0;
+  MemoryMapped = false;
+  MappableDataOffset = 0;
 }
 
 vtkNRRDReader::~vtkNRRDReader() 
@@ -258,6 +406,8 @@ void vtkNRRDReader::ExecuteInformation()
 
    this->CurrentFileName = new char[1 + strlen(this->GetFileName())];
    strcpy (this->CurrentFileName, this->GetFileName());
+   this->MappableDataFileName.clear();
+   this->MappableDataOffset = 0;
 
    nrrdNuke(this->nrrd); // nuke and reallocate to reset the state
    this->nrrd = nrrdNew();
@@ -658,6 +808,61 @@ void vtkNRRDReader::ExecuteInformation()
       }
    }
 
+   // Find where the data is for it to be mapped in memory if needed
+#ifdef VTK_WORDS_BIGENDIAN
+   int nativeEndian = airEndianBig;
+#else
+   int nativeEndian = airEndianLittle;
+#endif
+   size_t dataSize = nrrdElementNumber(this->nrrd) * nrrdElementSize(this->nrrd);
+   if (nio->encoding == nrrdEncodingRaw && nio->lineSkip == 0 &&
+       (nio->endian == nativeEndian || nrrdElementSize(this->nrrd) == 1))
+     {
+     std::string dataFileName;
+     vtkTypeInt64 dataOffset = -1;
+     if (!nio->detachedHeader && nio->byteSkip == 0)
+       {
+       // attached header: the data starts after the first empty line
+       dataFileName = this->GetFileName();
+       std::ifstream file(dataFileName.c_str(), std::ios::in | std::ios::binary);
+       std::string line;
+       while (std::getline(file, line))
+         {
+         if (line.empty() || line == "\r")
+           {
+           dataOffset = static_cast<vtkTypeInt64>(file.tellg());
+           break;
+           }
+         }
+       }
+     else if (nio->detachedHeader && nio->dataFNArr->len == 1 &&
+              !nio->dataFNFormat)
+       {
+       dataFileName = nio->dataFN[0];
+       if (!vtksys::SystemTools::FileIsFullPath(dataFileName.c_str()))
+         {
+         dataFileName = std::string(nio->path ? nio->path : ".") + "/"
+           + dataFileName;
+         }
+       dataOffset = nio->byteSkip;
+       if (nio->byteSkip == -1)
+         {
+         // the data is at the end of the file
+         dataOffset = static_cast<vtkTypeInt64>(
+           vtksys::SystemTools::FileLength(dataFileName.c_str())) - dataSize;
+         }
+       }
+     if (dataOffset >= 0 &&
+         dataOffset + static_cast<vtkTypeInt64>(dataSize) <=
+           static_cast<vtkTypeInt64>(
+             vtksys::SystemTools::FileLength(dataFileName.c_str())))
+       {
+       this->MappableDataFileName =
+         vtksys::SystemTools::CollapseFullPath(dataFileName.c_str());
+       this->MappableDataOffset = dataOffset;
+       }
+     }
+
    this->vtkImageReader2::ExecuteInformation();
    nio = nrrdIoStateNix(nio);
 }
@@ -871,6 +1076,107 @@ vtkNRRDReader::tenSpaceDirectionReduce(Nrrd *nout, const Nrrd *nin, double SD[9]
 }
 
 
+//----------------------------------------------------------------------------
+bool vtkNRRDReader::MapPointData(vtkImageData *out)
+{
+  unsigned int rangeAxisNum, rangeAxisIdx[NRRD_DIM_MAX];
+  rangeAxisNum = nrrdRangeAxesGet(this->nrrd, rangeAxisIdx);
+  // Tensors are expanded and range axes that are not the fastest axis are
+  // permuted: the data in the file is not the data of the output.
+  if (this->MappableDataFileName.empty() ||
+      this->PointDataType == vtkDataSetAttributes::TENSORS ||
+      rangeAxisNum > 1 || (rangeAxisNum == 1 && rangeAxisIdx[0] != 0))
+    {
+    return false;
+    }
+  vtkIdType numberOfValues = static_cast<vtkIdType>(out->GetNumberOfPoints())
+    * this->GetNumberOfComponents();
+  size_t dataSize = nrrdElementNumber(this->nrrd) * nrrdElementSize(this->nrrd);
+  if (static_cast<size_t>(numberOfValues) != nrrdElementNumber(this->nrrd))
+    {
+    return false;
+    }
+
+  vtkNRRDMappedFile* mapped = new vtkNRRDMappedFile;
+  mapped->HeaderFileName =
+    vtksys::SystemTools::CollapseFullPath(this->GetFileName());
+  mapped->DataFileName = this->MappableDataFileName;
+  char* data = vtkNRRDMap(mapped, this->MappableDataOffset, dataSize);
+  if (!data)
+    {
+    vtkWarningMacro("Unable to map " << this->MappableDataFileName
+                    << " in memory, the file is read instead");
+    delete mapped;
+    return false;
+    }
+
+  vtkDataArray* pd = vtkDataArray::CreateDataArray(this->DataType);
+  pd->SetNumberOfComponents(this->GetNumberOfComponents());
+  // save = 1: the array doesn't free the mapped memory
+  pd->SetVoidArray(data, numberOfValues, 1);
+  pd->SetName("NRRDImage");
+  vtkNRRDMappedArraysLock.Lock();
+  vtkNRRDMappedArrays[pd] = mapped;
+  vtkNRRDMappedArraysLock.Unlock();
+  vtkSmartPointer<vtkCallbackCommand> unmapCommand =
+    vtkSmartPointer<vtkCallbackCommand>::New();
+  unmapCommand->SetCallback(vtkNRRDMappedArrayDeleted);
+  pd->AddObserver(vtkCommand::DeleteEvent, unmapCommand);
+
+  switch (this->PointDataType)
+    {
+    case vtkDataSetAttributes::SCALARS:
+      out->SetScalarType(this->DataType);
+      out->GetPointData()->SetScalars(pd);
+      out->SetNumberOfScalarComponents(this->GetNumberOfComponents());
+      break;
+    case vtkDataSetAttributes::VECTORS:
+      out->GetPointData()->SetVectors(pd);
+      break;
+    case vtkDataSetAttributes::NORMALS:
+      out->GetPointData()->SetNormals(pd);
+      break;
+    }
+  pd->Delete();
+  this->MemoryMapped = true;
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkNRRDReader::UnmapFile(vtkImageData* image, const char* fileName)
+{
+  if (!image || !fileName)
+    {
+    return;
+    }
+  std::string collapsedFileName =
+    vtksys::SystemTools::CollapseFullPath(fileName);
+  vtkPointData* pointData = image->GetPointData();
+  for (int attribute = 0; attribute < vtkDataSetAttributes::NUM_ATTRIBUTES;
+       ++attribute)
+    {
+    vtkDataArray* array = pointData->GetAttribute(attribute);
+    bool mappedFromFile = false;
+    vtkNRRDMappedArraysLock.Lock();
+    vtkNRRDMappedArraysType::const_iterator it = vtkNRRDMappedArrays.find(array);
+    if (it != vtkNRRDMappedArrays.end())
+      {
+      mappedFromFile = (it->second->HeaderFileName == collapsedFileName ||
+                        it->second->DataFileName == collapsedFileName);
+      }
+    vtkNRRDMappedArraysLock.Unlock();
+    if (!mappedFromFile)
+      {
+      continue;
+      }
+    vtkDataArray* copy = array->NewInstance();
+    copy->DeepCopy(array);
+    copy->SetName(array->GetName());
+    pointData->SetAttribute(copy, attribute);
+    copy->Delete();
+    }
+}
+
 //----------------------------------------------------------------------------
 // This function reads a data from a file.  The datas extent/axes
 // are assumed to be the same as the file extent/order.
@@ -878,6 +1184,22 @@ void vtkNRRDReader::ExecuteData(vtkDataObject *output)
 {
 
   output->SetUpdateExtentToWholeExtent();
+
+  this->MemoryMapped = false;
+  if (this->UseMemoryMapping && this->GetFileName() != NULL)
+    {
+    vtkImageData *mappedData = vtkImageData::SafeDownCast(output);
+    if (mappedData)
+      {
+      this->ExecuteInformation();
+      mappedData->SetExtent(mappedData->GetUpdateExtent());
+      if (this->MapPointData(mappedData))
+        {
+        return;
+        }
+      }
+    }
+
   vtkImageData *data = this->AllocateOutputData(output);
 
   if (this->GetFileName() == NULL)
@@ -1077,5 +1399,7 @@ void vtkNRRDReader::ExecuteData(vtkDataObject *output)
 void vtkNRRDReader::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os,indent);
+  os << indent << "UseMemoryMapping: " << this->UseMemoryMapping << "\n";
+  os << indent << "MemoryMapped: " << this->MemoryMapped << "\n";
 }
 
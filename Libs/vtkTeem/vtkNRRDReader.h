@@ -40,6 +40,7 @@
 
 #include <vtkMatrix4x4.h>
 #include <vtkPointData.h>
+class vtkDataArray;
 
 #include "teem/nrrd.h"
 
@@ -133,6 +134,30 @@ public:
     UseNativeOrigin = false;
   }
 
+  ///
+  /// Map the data of the file in memory instead of reading it, if it is
+  /// uncompressed ("raw" encoding), of the native byte order, stored in a
+  /// single file (attached header or detached header with one data
+  /// file) and doesn't need to be permuted or expanded (tensors). The
+  /// mapping is copy-on-write: the pages are loaded when they are first
+  /// accessed, the pages that are written to are copied and the file is
+  /// never modified. The file must not be overwritten while it is mapped,
+  /// see UnmapFile(). Other files are read as usual. (Default is 0)
+  vtkSetMacro(UseMemoryMapping, int);
+  vtkGetMacro(UseMemoryMapping, int);
+  vtkBooleanMacro(UseMemoryMapping, int);
+
+  ///
+  /// Return true if the point data of the last read has been mapped in
+  /// memory.
+  vtkGetMacro(MemoryMapped, bool);
+
+  ///
+  /// Replace the point data arrays of \a image that are mapped from the
+  /// NRRD file \a fileName (header or data file) by in-memory copies,
+  /// e.g. before \a fileName is overwritten.
+  static void UnmapFile(vtkImageData* image, const char* fileName);
+
   int NrrdToVTKScalarType( const int nrrdPixelType ) const
   {
   switch( nrrdPixelType )
@@ -243,6 +268,12 @@ protected:
   int NumberOfComponents;
   bool UseNativeOrigin;
 
+  int UseMemoryMapping;
+  bool MemoryMapped;
+  /// File and offset of the data if it can be mapped, empty otherwise
+  std::string MappableDataFileName;
+  vtkTypeInt64 MappableDataOffset;
+
   std::map <std::string, std::string> HeaderKeyValue;
 
   virtual void ExecuteInformation();
@@ -250,6 +281,10 @@ protected:
 
   int tenSpaceDirectionReduce(Nrrd *nout, const Nrrd *nin, double SD[9]);
 
+  /// Set the mapped data of the file as point data of \a out.
+  /// Return false if the data can't be mapped.
+  bool MapPointData(vtkImageData *out);
+
 private:
   vtkNRRDReader(const vtkNRRDReader&);  /// Not implemented.
   void operator=(const vtkNRRDReader&);  /// Not implemented.
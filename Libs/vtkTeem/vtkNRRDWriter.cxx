@@ -1,4 +1,8 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
 #include <map>
+#include <vector>
 
 #include "vtkNRRDWriter.h"
 
@@ -7,9 +11,107 @@
 #include "vtkPointData.h"
 #include "vtkObjectFactory.h"
 #include "vtkInformation.h"
+#include "vtk_zlib.h"
+
+#include <vtksys/SystemTools.hxx>
 
 class AttributeMapType: public std::map<std::string, std::string> {};
 
+namespace
+{
+
+//----------------------------------------------------------------------------
+/// Number of bytes of the data deflated by a thread at a time.
+const size_t GzipBlockSize = 1 << 20;
+/// Each block is deflated with the preceding 32kB of data as dictionary to
+/// compress as well as a single deflate stream.
+const size_t GzipDictionarySize = 32768;
+
+//----------------------------------------------------------------------------
+struct GzipBlockType
+{
+  GzipBlockType() : Size(0), Crc(0), Deflated(false) {}
+  /// Number of bytes of data in the block
+  size_t Size;
+  uLong Crc;
+  bool Deflated;
+  std::vector<unsigned char> Buffer;
+};
+
+//----------------------------------------------------------------------------
+struct GzipCompressionType
+{
+  const unsigned char* Data;
+  size_t Size;
+  int Level;
+  std::vector<GzipBlockType> Blocks;
+};
+
+//----------------------------------------------------------------------------
+/// Deflate the block \a blockIndex into a raw deflate stream ended with a
+/// sync flush so that the blocks can be concatenated. Only the last block
+/// ends the stream.
+void DeflateBlock(GzipCompressionType* compression, size_t blockIndex)
+{
+  GzipBlockType& block = compression->Blocks[blockIndex];
+  const size_t begin = blockIndex * GzipBlockSize;
+  block.Size = std::min(GzipBlockSize, compression->Size - begin);
+  const bool lastBlock = (blockIndex + 1 == compression->Blocks.size());
+  const Bytef* data = compression->Data + begin;
+  block.Crc = crc32(crc32(0L, Z_NULL, 0), data, static_cast<uInt>(block.Size));
+
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  if (deflateInit2(&stream, compression->Level, Z_DEFLATED, -MAX_WBITS, 8,
+                   Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+    return;
+    }
+  if (begin > 0)
+    {
+    const size_t dictionarySize = std::min(GzipDictionarySize, begin);
+    deflateSetDictionary(&stream, data - dictionarySize,
+                         static_cast<uInt>(dictionarySize));
+    }
+  // The sync flush adds a few bytes to the worst case size.
+  block.Buffer.resize(deflateBound(&stream, static_cast<uLong>(block.Size)) + 16);
+  stream.next_in = const_cast<Bytef*>(data);
+  stream.avail_in = static_cast<uInt>(block.Size);
+  stream.next_out = &block.Buffer[0];
+  stream.avail_out = static_cast<uInt>(block.Buffer.size());
+  int res = deflate(&stream, lastBlock ? Z_FINISH : Z_SYNC_FLUSH);
+  block.Deflated = lastBlock ? res == Z_STREAM_END :
+    (res == Z_OK && stream.avail_in == 0 && stream.avail_out > 0);
+  block.Buffer.resize(stream.total_out);
+  deflateEnd(&stream);
+}
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE DeflateBlocksCallback(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info =
+    static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  GzipCompressionType* compression =
+    static_cast<GzipCompressionType*>(info->UserData);
+  for (size_t i = info->ThreadID; i < compression->Blocks.size();
+       i += info->NumberOfThreads)
+    {
+    DeflateBlock(compression, i);
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+void WriteLittleEndian32(std::ostream& stream, vtkTypeUInt32 value)
+{
+  for (int i = 0; i < 4; ++i)
+    {
+    stream.put(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+}
+
+} // end of anonymous namespace
+
 vtkCxxRevisionMacro(vtkNRRDWriter, "$Revision: 1.28 $");
 vtkStandardNewMacro(vtkNRRDWriter);
 
@@ -22,6 +124,8 @@ vtkNRRDWriter::vtkNRRDWriter()
   this->IJKToRASMatrix = vtkMatrix4x4::New();
   this->MeasurementFrameMatrix = vtkMatrix4x4::New();
   this->UseCompression = 1;
+  this->CompressionLevel = -1;
+  this->NumberOfThreads = 0;
   this->DiffusionWeigthedData = 0;
   this->FileType = VTK_BINARY;
   this->WriteErrorOff();
@@ -345,11 +449,26 @@ void vtkNRRDWriter::WriteData()
       }
     }
 
+  nio->zlibLevel = this->CompressionLevel;
+
   // set endianness as unknown of output
   nio->endian = airEndianUnknown;
 
+  int numberOfThreads = this->NumberOfThreads > 0 ? this->NumberOfThreads :
+    vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
+  std::string extension = vtksys::SystemTools::LowerCase(
+    vtksys::SystemTools::GetFilenameLastExtension(this->GetFileName()));
+  if (nio->encoding == nrrdEncodingGzip && numberOfThreads > 1 &&
+      extension == ".nrrd" &&
+      nrrdElementNumber(nrrd) * nrrdElementSize(nrrd) > GzipBlockSize)
+    {
+    if (!this->WriteParallelCompressedData(nrrd, nio))
+      {
+      this->WriteErrorOn();
+      }
+    }
   // Write the nrrd to file.
-  if (nrrdSave(this->GetFileName(), nrrd, nio))
+  else if (nrrdSave(this->GetFileName(), nrrd, nio))
     {
     char *err = biffGetDone(NRRD); // would be nice to free(err)
     vtkErrorMacro("Write: Error writing " 
@@ -362,10 +481,76 @@ void vtkNRRDWriter::WriteData()
   return;
 }
 
+//----------------------------------------------------------------------------
+bool vtkNRRDWriter::WriteParallelCompressedData(Nrrd *nrrd, NrrdIoState *nio)
+{
+  // Let teem write the header ("encoding: gzip") but not the data.
+  nio->skipData = AIR_TRUE;
+  if (nrrdSave(this->GetFileName(), nrrd, nio))
+    {
+    char *err = biffGetDone(NRRD); // would be nice to free(err)
+    vtkErrorMacro("Write: Error writing "
+                      << this->GetFileName() << ":\n" << err);
+    return false;
+    }
+
+  GzipCompressionType compression;
+  compression.Data = static_cast<const unsigned char*>(nrrd->data);
+  compression.Size = nrrdElementNumber(nrrd) * nrrdElementSize(nrrd);
+  compression.Level = this->CompressionLevel;
+  compression.Blocks.resize(
+    (compression.Size + GzipBlockSize - 1) / GzipBlockSize);
+
+  int numberOfThreads = this->NumberOfThreads > 0 ? this->NumberOfThreads :
+    vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
+  numberOfThreads = static_cast<int>(std::min(
+    static_cast<size_t>(numberOfThreads), compression.Blocks.size()));
+  vtkMultiThreader* threader = vtkMultiThreader::New();
+  threader->SetNumberOfThreads(numberOfThreads);
+  threader->SetSingleMethod(DeflateBlocksCallback, &compression);
+  threader->SingleMethodExecute();
+  threader->Delete();
+
+  std::ofstream file(this->GetFileName(),
+                     std::ios::out | std::ios::app | std::ios::binary);
+  // gzip member header: deflate method, no flag, no time, unknown OS
+  const unsigned char gzipHeader[10] =
+    {0x1f, 0x8b, Z_DEFLATED, 0, 0, 0, 0, 0, 0, 0xff};
+  file.write(reinterpret_cast<const char*>(gzipHeader), sizeof(gzipHeader));
+  uLong crc = crc32(0L, Z_NULL, 0);
+  for (size_t i = 0; i < compression.Blocks.size(); ++i)
+    {
+    const GzipBlockType& block = compression.Blocks[i];
+    if (!block.Deflated)
+      {
+      vtkErrorMacro("Write: Error compressing the data of "
+                    << this->GetFileName());
+      return false;
+      }
+    file.write(reinterpret_cast<const char*>(&block.Buffer[0]),
+               block.Buffer.size());
+    crc = crc32_combine(crc, block.Crc, static_cast<z_off_t>(block.Size));
+    }
+  WriteLittleEndian32(file, static_cast<vtkTypeUInt32>(crc));
+  WriteLittleEndian32(file, static_cast<vtkTypeUInt32>(compression.Size));
+  file.close();
+  if (file.fail())
+    {
+    vtkErrorMacro("Write: Error writing the data of " << this->GetFileName());
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
 void vtkNRRDWriter::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os,indent);
 
+  os << indent << "UseCompression: " << this->UseCompression << "\n";
+  os << indent << "CompressionLevel: " << this->CompressionLevel << "\n";
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << "\n";
+
   os << indent << "RAS to IJK Matrix: ";
      this->IJKToRASMatrix->PrintSelf(os,indent);
   os << indent << "Measurement frame: ";
@@ -6,6 +6,7 @@
 
 #include "vtkMatrix4x4.h"
 #include "vtkDoubleArray.h"
+#include "vtkMultiThreader.h"
 #include "teem/nrrd.h"
 
 #include "vtkTeemConfigure.h"
@@ -52,6 +53,19 @@ public:
   vtkSetMacro(UseCompression,int);
   vtkGetMacro(UseCompression,int);
   vtkBooleanMacro(UseCompression,int);
+
+  /// Level of the gzip compression, from 0 (no compression) to 9 (best
+  /// compression). -1 (default) uses the zlib default level.
+  vtkSetClampMacro(CompressionLevel,int,-1,9);
+  vtkGetMacro(CompressionLevel,int);
+
+  /// Number of threads compressing the data, 0 (default) for
+  /// vtkMultiThreader::GetGlobalDefaultNumberOfThreads().
+  /// With more than one thread, blocks of the data are deflated in parallel
+  /// and concatenated into a single gzip stream. This is only done for files
+  /// with an attached header (.nrrd).
+  vtkSetClampMacro(NumberOfThreads,int,0,VTK_MAX_THREADS);
+  vtkGetMacro(NumberOfThreads,int);
   
   vtkSetClampMacro(FileType,int,VTK_ASCII,VTK_BINARY);
   vtkGetMacro(FileType,int);
@@ -77,6 +91,11 @@ protected:
   /// Write method. It is called by vtkWriter::Write();
   void WriteData();
 
+  ///
+  /// Write the header with teem and append the data deflated by
+  /// NumberOfThreads threads. Return false on error.
+  bool WriteParallelCompressedData(Nrrd *nrrd, NrrdIoState *nio);
+
   /// 
   /// Flag to set to on when a write error occured
   int WriteError;
@@ -90,6 +109,8 @@ protected:
   vtkMatrix4x4 *MeasurementFrameMatrix;
 
   int UseCompression;
+  int CompressionLevel;
+  int NumberOfThreads;
   int FileType;
   
   AttributeMapType *Attributes;
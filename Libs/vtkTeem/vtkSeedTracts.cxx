@@ -14,6 +14,10 @@
 
 #include "vtkSeedTracts.h"
 #include "vtkCellArray.h"
+#include "vtkFloatArray.h"
+#include "vtkGenericCell.h"
+#include "vtkMultiThreader.h"
+#include "vtkPoints.h"
 #include "vtkTransformPolyDataFilter.h"
 #include "vtkSmartPointer.h"
 #include "vtkPolyDataWriter.h"
@@ -23,11 +27,102 @@
 
 #include "vtkPointData.h"
 
+#include <algorithm>
 #include <sstream>
+#include <vector>
 
 //----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkSeedTracts);
 
+namespace
+{
+// The seeds are shared out between the threads by blocks of this size,
+// block b going to the thread b % numberOfThreads
+const vtkIdType SeedsPerBlock = 64;
+
+//----------------------------------------------------------------------------
+// Paths kept by a thread, in the order of their seeds
+struct ThreadPaths
+{
+  std::vector<double> Points;
+  std::vector<float> Tensors;
+  std::vector<vtkIdType> NumberOfPoints;
+  std::vector<vtkIdType> Seeds;
+};
+}
+
+//----------------------------------------------------------------------------
+class vtkSeedTracts::vtkInternal
+{
+public:
+  vtkInternal()
+  {
+    this->Tracker = 0;
+    this->Tolerance2 = 0.;
+  }
+
+  void ClearPaths()
+  {
+    this->Points.clear();
+    this->Tensors.clear();
+    this->NumberOfPoints.clear();
+  }
+
+  /// Seeds to integrate, in scaled ijk of the tensors
+  std::vector<double> Seeds;
+
+  /// State of the current TrackSeeds()
+  vtkHyperStreamlineDTMRI* Tracker;
+  double Tolerance2;
+  std::vector<vtkSmartPointer<vtkGenericCell> > Cells;
+  std::vector<ThreadPaths> Threads;
+
+  /// Merged paths, in scaled ijk of the tensors, with the tensors
+  /// at their points
+  std::vector<double> Points;
+  std::vector<float> Tensors;
+  std::vector<vtkIdType> NumberOfPoints;
+};
+
+//----------------------------------------------------------------------------
+static VTK_THREAD_RETURN_TYPE vtkSeedTracts_ThreadedTrack( void *arg )
+{
+  vtkMultiThreader::ThreadInfo *info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  vtkSeedTracts *self = static_cast<vtkSeedTracts *>(info->UserData);
+  self->ThreadedTrack(info->ThreadID, info->NumberOfThreads);
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+// Rotate a tensor stored row by row by R T R'
+static void vtkSeedTractsRotateTensor(double matrix3x3[3][3],
+                                      double matrixTranspose3x3[3][3],
+                                      double tensor[9])
+{
+  double tensor3x3[3][3];
+  double temp3x3[3][3];
+  int idx = 0;
+  for (int row = 0; row < 3; row++)
+    {
+    for (int col = 0; col < 3; col++)
+      {
+      tensor3x3[row][col] = tensor[idx];
+      idx++;
+      }
+    }
+  vtkMath::Multiply3x3(matrix3x3,tensor3x3,temp3x3);
+  vtkMath::Multiply3x3(temp3x3,matrixTranspose3x3,tensor3x3);
+  idx = 0;
+  for (int row = 0; row < 3; row++)
+    {
+    for (int col = 0; col < 3; col++)
+      {
+      tensor[idx] = tensor3x3[row][col];
+      idx++;
+      }
+    }
+}
+
 //----------------------------------------------------------------------------
 vtkSeedTracts::vtkSeedTracts()
 {
@@ -40,6 +135,7 @@ vtkSeedTracts::vtkSeedTracts()
 
   // The user must set these for the class to function.
   this->InputTensorField = NULL;
+  this->InputEigenvalues = NULL;
   
   // The user may need to set these, depending on class usage
   this->InputROI = NULL;
@@ -71,6 +167,10 @@ vtkSeedTracts::vtkSeedTracts()
   this->FilePrefix = NULL;
   this->UseStartingThreshold = 0;
   this->StartingThreshold = 0;
+
+  this->MultiThreader = vtkMultiThreader::New();
+  this->NumberOfThreads = this->MultiThreader->GetNumberOfThreads();
+  this->Internal = new vtkInternal;
 }
 
 //----------------------------------------------------------------------------
@@ -84,6 +184,7 @@ vtkSeedTracts::~vtkSeedTracts()
 
   // volumes
   if (this->InputTensorField) this->InputTensorField->Delete();
+  if (this->InputEigenvalues) this->InputEigenvalues->Delete();
   if (this->InputROI) this->InputROI->Delete();
   if (this->InputROI2) this->InputROI2->Delete();
 
@@ -111,6 +212,8 @@ vtkSeedTracts::~vtkSeedTracts()
     {
     delete [] FilePrefix;
     }
+  this->MultiThreader->Delete();
+  delete this->Internal;
 }
 
 
@@ -421,7 +524,13 @@ void vtkSeedTracts::SeedStreamlineFromPoint(double x,
       vtkErrorMacro("Point " << x << ", " << y << ", " << z << " outside of tensor dataset.");
       return;
     }
-    
+
+  if (this->UseBatchTracking())
+    {
+    this->Internal->Seeds.insert(this->Internal->Seeds.end(), point, point + 3);
+    this->TrackSeeds();
+    return;
+    }
     
   newStreamline=(vtkHyperStreamlineDTMRI *)this->CreateHyperStreamline();
                       
@@ -452,6 +561,202 @@ void vtkSeedTracts::SeedStreamlineFromPoint(double x,
   //newStreamline->Delete();
 }
 
+//----------------------------------------------------------------------------
+void vtkSeedTracts::SeedStreamlinesFromPoints(vtkPoints *points)
+{
+  // test we have input
+  if (this->InputTensorField == NULL)
+    {
+      vtkErrorMacro("No tensor data input.");
+      return;      
+    }
+  if (points == NULL)
+    {
+    return;
+    }
+
+  bool batch = this->UseBatchTracking();
+  for (vtkIdType i = 0; i < points->GetNumberOfPoints(); i++)
+    {
+    double pointw[3], point[3];
+    points->GetPoint(i, pointw);
+    if (!batch)
+      {
+      this->SeedStreamlineFromPoint(pointw[0], pointw[1], pointw[2]);
+      continue;
+      }
+
+    // Transform from world coords to scaled ijk of the input tensors
+    this->WorldToTensorScaledIJK->TransformPoint(pointw,point);
+    if (this->PointWithinTensorData(point,pointw))
+      {
+      this->Internal->Seeds.insert(this->Internal->Seeds.end(), point, point + 3);
+      }
+    }
+  if (batch)
+    {
+    this->TrackSeeds();
+    }
+}
+
+//----------------------------------------------------------------------------
+bool vtkSeedTracts::UseBatchTracking()
+{
+  return this->TypeOfHyperStreamline == USE_VTK_HYPERSTREAMLINE_POINTS &&
+    this->FileDirectoryName == NULL;
+}
+
+//----------------------------------------------------------------------------
+void vtkSeedTracts::TrackSeeds()
+{
+  vtkInternal *internal = this->Internal;
+  vtkIdType numberOfSeeds = static_cast<vtkIdType>(internal->Seeds.size() / 3);
+  if (numberOfSeeds == 0)
+    {
+    return;
+    }
+
+  // One object holds the settings of all the paths
+  internal->Tracker = (vtkHyperStreamlineDTMRI *) this->CreateHyperStreamline();
+  // the bounds are computed here rather than by the threads
+  internal->Tolerance2 = this->InputTensorField->GetLength() / 1000.0;
+  internal->Tolerance2 *= internal->Tolerance2;
+
+  vtkIdType numberOfBlocks = (numberOfSeeds + SeedsPerBlock - 1) / SeedsPerBlock;
+  int numberOfThreads = static_cast<int>(
+    std::min(static_cast<vtkIdType>(this->NumberOfThreads), numberOfBlocks));
+  internal->Threads.clear();
+  internal->Threads.resize(numberOfThreads);
+  internal->Cells.resize(numberOfThreads);
+  for (int i = 0; i < numberOfThreads; i++)
+    {
+    if (!internal->Cells[i])
+      {
+      internal->Cells[i] = vtkSmartPointer<vtkGenericCell>::New();
+      }
+    }
+
+  if (numberOfThreads > 1)
+    {
+    this->MultiThreader->SetNumberOfThreads(numberOfThreads);
+    this->MultiThreader->SetSingleMethod(vtkSeedTracts_ThreadedTrack, this);
+    this->MultiThreader->SingleMethodExecute();
+    }
+  else
+    {
+    this->ThreadedTrack(0, 1);
+    }
+
+  // Merge the paths in the order of their seeds
+  std::vector<size_t> pathCursors(numberOfThreads, 0);
+  std::vector<size_t> pointCursors(numberOfThreads, 0);
+  for (vtkIdType block = 0; block < numberOfBlocks; block++)
+    {
+    int threadId = static_cast<int>(block % numberOfThreads);
+    ThreadPaths &paths = internal->Threads[threadId];
+    vtkIdType lastSeed = (block + 1) * SeedsPerBlock;
+    size_t &path = pathCursors[threadId];
+    size_t &point = pointCursors[threadId];
+    while (path < paths.Seeds.size() && paths.Seeds[path] < lastSeed)
+      {
+      vtkIdType numberOfPoints = paths.NumberOfPoints[path];
+      internal->Points.insert(internal->Points.end(),
+                              paths.Points.begin() + 3 * point,
+                              paths.Points.begin() + 3 * (point + numberOfPoints));
+      internal->Tensors.insert(internal->Tensors.end(),
+                               paths.Tensors.begin() + 9 * point,
+                               paths.Tensors.begin() + 9 * (point + numberOfPoints));
+      internal->NumberOfPoints.push_back(numberOfPoints);
+      point += numberOfPoints;
+      path++;
+      }
+    }
+
+  internal->Threads.clear();
+  internal->Seeds.clear();
+  internal->Tracker->Delete();
+  internal->Tracker = 0;
+}
+
+//----------------------------------------------------------------------------
+void vtkSeedTracts::ThreadedTrack(int threadId, int numberOfThreads)
+{
+  vtkInternal *internal = this->Internal;
+  ThreadPaths &paths = internal->Threads[threadId];
+  vtkGenericCell *cell = internal->Cells[threadId];
+  vtkTractographyArray streamers[2];
+  double stepLength = internal->Tracker->GetIntegrationStepLength();
+  vtkIdType numberOfSeeds = static_cast<vtkIdType>(internal->Seeds.size() / 3);
+
+  for (vtkIdType block = threadId * SeedsPerBlock; block < numberOfSeeds;
+       block += numberOfThreads * SeedsPerBlock)
+    {
+    vtkIdType lastSeed = std::min(block + SeedsPerBlock, numberOfSeeds);
+    for (vtkIdType seed = block; seed < lastSeed; seed++)
+      {
+      vtkFloatingPointType startPosition[3];
+      for (int i = 0; i < 3; i++)
+        {
+        startPosition[i] = internal->Seeds[3 * seed + i];
+        }
+      int numberOfStreamers = internal->Tracker->IntegrateStreamers(
+        this->InputTensorField, internal->Tolerance2, startPosition, streamers, cell);
+      if (numberOfStreamers <= 0)
+        {
+        continue;
+        }
+
+      // Same single trajectory as BuildLinesForSingleTrajectory():
+      // the first streamer backwards without the seed point, then
+      // the second streamer forwards until it leaves the data
+      size_t firstPoint = paths.Points.size() / 3;
+      for (vtkIdType i = streamers[0].GetNumberOfPoints() - 1; i > 0; i--)
+        {
+        vtkTractographyPoint *sPtr = streamers[0].GetTractographyPoint(i);
+        if (sPtr->CellId >= 0)
+          {
+          paths.Points.insert(paths.Points.end(), sPtr->X, sPtr->X + 3);
+          for (int row = 0; row < 3; row++)
+            {
+            paths.Tensors.insert(paths.Tensors.end(), sPtr->T[row], sPtr->T[row] + 3);
+            }
+          }
+        }
+      if (numberOfStreamers > 1)
+        {
+        for (vtkIdType i = 0; i < streamers[1].GetNumberOfPoints(); i++)
+          {
+          vtkTractographyPoint *sPtr = streamers[1].GetTractographyPoint(i);
+          if (sPtr->CellId < 0)
+            {
+            break;
+            }
+          paths.Points.insert(paths.Points.end(), sPtr->X, sPtr->X + 3);
+          for (int row = 0; row < 3; row++)
+            {
+            paths.Tensors.insert(paths.Tensors.end(), sPtr->T[row], sPtr->T[row] + 3);
+            }
+          }
+        }
+
+      // See if we like it enough to keep it, as for the streamlines
+      // of the collection
+      vtkIdType numberOfPoints =
+        static_cast<vtkIdType>(paths.Points.size() / 3 - firstPoint);
+      if ((numberOfPoints - 1) * stepLength > this->MinimumPathLength)
+        {
+        paths.NumberOfPoints.push_back(numberOfPoints);
+        paths.Seeds.push_back(seed);
+        }
+      else
+        {
+        paths.Points.resize(3 * firstPoint);
+        paths.Tensors.resize(9 * firstPoint);
+        }
+      }
+    }
+}
+
 // Seed in an ROI using a continous grid with the resolution given by 
 //this->IsotropicSeedingResolution.
 //----------------------------------------------------------------------------
@@ -502,6 +807,16 @@ void vtkSeedTracts::SeedStreamlinesInROI()
 
   // make sure we are creating objects with points
   this->UseVtkHyperStreamlinePoints();
+  bool batch = this->UseBatchTracking();
+
+  vtkDataArray *eigenvalues = this->InputEigenvalues;
+  if (eigenvalues && (eigenvalues->GetNumberOfComponents() != 3 ||
+                      eigenvalues->GetNumberOfTuples() !=
+                      this->InputTensorField->GetNumberOfPoints()))
+    {
+    vtkWarningMacro("Input eigenvalues do not match the tensors, they are ignored.");
+    eigenvalues = NULL;
+    }
  
   int extent[6];
   double spacing[3];
@@ -622,18 +937,26 @@ void vtkSeedTracts::SeedStreamlinesInROI()
                       vtkIdType tensorId = this->GetInputTensorField()->ComputePointId  (ijk );
                      
                       vtkDataArray *inTensors = this->GetInputTensorField()->GetPointData()->GetTensors();
-                      inTensors->GetTuple(tensorId,(double *)tensor);
-                      for (int j=0; j<3; j++)
+                      if (eigenvalues)
                         {
-                        for (int i=0; i<3; i++)
+                        // eigen-systems shared with the other consumers of the tensors
+                        eigenvalues->GetTuple(tensorId, w);
+                        }
+                      else
+                        {
+                        inTensors->GetTuple(tensorId,(double *)tensor);
+                        for (int j=0; j<3; j++)
                           {
-                          // transpose
-                          m[i][j] = tensor[j][i];
+                          for (int i=0; i<3; i++)
+                            {
+                            // transpose
+                            m[i][j] = tensor[j][i];
+                            }
                           }
+                        // compute eigensystem
+                        //vtkMath::Jacobi(m, w, v);
+                        vtkDiffusionTensorMathematics::TeemEigenSolver(m,w,v);
                         }
-                      // compute eigensystem
-                      //vtkMath::Jacobi(m, w, v);
-                      vtkDiffusionTensorMathematics::TeemEigenSolver(m,w,v);
                       double cl = vtkDiffusionTensorMathematics::LinearMeasure(w);
                       if (cl < this->StartingThreshold) 
                         {
@@ -641,6 +964,12 @@ void vtkSeedTracts::SeedStreamlinesInROI()
                         }
                       } // end if (UseStartingThreshold)
 
+                      if (batch)
+                        {
+                        this->Internal->Seeds.insert(this->Internal->Seeds.end(), point, point + 3);
+                        continue;
+                        }
+
                       // Now create a streamline 
                       newStreamline=(vtkHyperStreamlineDTMRI *) 
                         this->CreateHyperStreamline();
@@ -706,6 +1035,10 @@ void vtkSeedTracts::SeedStreamlinesInROI()
 
     }
 
+  if (batch)
+    {
+    this->TrackSeeds();
+    }
 }
 
 
@@ -781,6 +1114,9 @@ void vtkSeedTracts::TransformStreamlinesToRASAndAppendToPolyData(vtkPolyData *ou
     npts += streamline->GetOutput()->GetNumberOfPoints();
     ncells += streamline->GetOutput()->GetNumberOfLines();
     }
+  // and the paths merged by the threads
+  npts += static_cast<int>(this->Internal->Points.size() / 3);
+  ncells += static_cast<int>(this->Internal->NumberOfPoints.size());
   if (npts == 0 || ncells == 0)
     {
     return;
@@ -795,7 +1131,7 @@ void vtkSeedTracts::TransformStreamlinesToRASAndAppendToPolyData(vtkPolyData *ou
   vtkCellArray *outFibersCellArray = vtkCellArray::New();
   outFibers->SetLines(outFibersCellArray);
   outFibersCellArray->Delete();
-  outFibersCellArray->SetNumberOfCells(this->Streamlines->GetNumberOfItems());
+  outFibersCellArray->SetNumberOfCells(ncells);
   outFibersCellArray = outFibers->GetLines();
   cellArray=outFibersCellArray->GetData();
   cellArray->SetNumberOfTuples(npts+ncells);
@@ -806,6 +1142,22 @@ void vtkSeedTracts::TransformStreamlinesToRASAndAppendToPolyData(vtkPolyData *ou
   newTensors->Delete();
   newTensors = static_cast<vtkFloatArray *> (outFibers->GetPointData()->GetTensors());
 
+  // transform any tensors as well (rotate them)
+  // this should be a vtk class but leave that for slicer3/vtk5
+  // Here we rotate the tensors into the same (world) coordinate system.
+  double (*matrix)[4] = this->TensorRotationMatrix->Element;
+  double tensor[9];
+  double matrix3x3[3][3];
+  double matrixTranspose3x3[3][3];
+  for (int row = 0; row < 3; row++)
+    {
+    for (int col = 0; col < 3; col++)
+      {
+        matrix3x3[row][col] = matrix[row][col];
+        matrixTranspose3x3[row][col] = matrix[col][row];
+      }
+    }
+
   int ptId=0;
   int cellId=0;
   int ptOffset = 0;
@@ -835,65 +1187,50 @@ void vtkSeedTracts::TransformStreamlinesToRASAndAppendToPolyData(vtkPolyData *ou
       }
     ptOffset += transformer->GetOutput()->GetNumberOfPoints();
 
-    // transform any tensors as well (rotate them)
-    // this should be a vtk class but leave that for slicer3/vtk5
-    // Here we rotate the tensors into the same (world) coordinate system.
     // -------------------------------------------------
     vtkDebugMacro("Rotating tensors");
     int numPts = transformer->GetOutput()->GetNumberOfPoints();
-    //vtkFloatArray *newTensors = vtkFloatArray::New();
-    //newTensors->SetNumberOfComponents(9);
-    //newTensors->Allocate(9*numPts);
-                          
-    vtkDebugMacro("Rotating tensors: init");
-    double (*matrix)[4] = this->TensorRotationMatrix->Element;
-    double tensor[9];
-    double tensor3x3[3][3];
-    double temp3x3[3][3];
-    double matrix3x3[3][3];
-    double matrixTranspose3x3[3][3];
-    for (int row = 0; row < 3; row++)
+    vtkDataArray *oldTensors = transformer->GetOutput()->GetPointData()->GetTensors();
+    for (vtkIdType ii = 0; ii < numPts; ii++)
       {
-      for (int col = 0; col < 3; col++)
-        {
-          matrix3x3[row][col] = matrix[row][col];
-          matrixTranspose3x3[row][col] = matrix[col][row];
-        }
+      oldTensors->GetTuple(ii,tensor);
+      // rotate by our matrix
+      // R T R'
+      vtkSeedTractsRotateTensor(matrix3x3,matrixTranspose3x3,tensor);
+      newTensors->InsertNextTuple(tensor);
       }
-                          
-     vtkDebugMacro("Rotating tensors: get tensors from probe");        
-     vtkDataArray *oldTensors = transformer->GetOutput()->GetPointData()->GetTensors();
-     vtkDebugMacro("Rotating tensors: rotate");
-     for (vtkIdType ii = 0; ii < numPts; ii++)
-       {
-         oldTensors->GetTuple(ii,tensor);
-         int idx = 0;
-         for (int row = 0; row < 3; row++)
-           {
-             for (int col = 0; col < 3; col++)
-               {
-                 tensor3x3[row][col] = tensor[idx];
-                 idx++;
-               }
-           }          
-         // rotate by our matrix
-         // R T R'
-         vtkMath::Multiply3x3(matrix3x3,tensor3x3,temp3x3);
-         vtkMath::Multiply3x3(temp3x3,matrixTranspose3x3,tensor3x3);
-         idx =0;
-         for (int row = 0; row < 3; row++)
-           {
-             for (int col = 0; col < 3; col++)
-                {
-                  tensor[idx] = tensor3x3[row][col];
-                  idx++;
-                }
-            }  
-          newTensors->InsertNextTuple(tensor);
-        }
     // End of tensor rotation code.
     // -------------------------------------------------
     }
+
+  // Paths merged by the threads, in scaled ijk of the tensors as well
+  vtkInternal *internal = this->Internal;
+  size_t point = 0;
+  for (size_t i = 0; i < internal->NumberOfPoints.size(); i++)
+    {
+    vtkIdType numPts = internal->NumberOfPoints[i];
+    cellIndex = numPts;
+    cellArray->SetTupleValue(cellId, &cellIndex);
+    cellId++;
+    for (vtkIdType k = 0; k < numPts; k++, point++)
+      {
+      double x[3];
+      transform->TransformPoint(&internal->Points[3 * point], x);
+      outFibers->GetPoints()->InsertNextPoint(x);
+      ptId++;
+      cellIndex = ptOffset + k;
+      cellArray->SetTupleValue(cellId, &cellIndex);
+      cellId++;
+
+      for (int j = 0; j < 9; j++)
+        {
+        tensor[j] = internal->Tensors[9 * point + j];
+        }
+      vtkSeedTractsRotateTensor(matrix3x3,matrixTranspose3x3,tensor);
+      newTensors->InsertNextTuple(tensor);
+      }
+    ptOffset += numPts;
+    }
   outFibers->SetLines(outFibersCellArray);
   outFibers->GetPointData()->SetTensors(newTensors);
   // Remove the scalars if any, we don't need
@@ -1154,7 +1491,7 @@ void vtkSeedTracts::DeleteAllStreamlines()
       this->DeleteStreamline(0);
       i++;
     }
-  
+  this->Internal->ClearPaths();
 }
 
 // Delete one streamline and all of its associated objects.
@@ -35,8 +35,18 @@
 #define USE_VTK_PRECISE_HYPERSTREAMLINE_POINTS 2
 #define USE_VTK_HYPERSTREAMLINE_TEEM 3
 
+class vtkMultiThreader;
+class vtkPoints;
+
 /// Individual streamlines can be started at a point, or 
 /// many can be started inside a region of interest.
+///
+/// When streamlines are created with points (UseVtkHyperStreamlinePoints())
+/// and not written to files, the seeds of a call are integrated by
+/// NumberOfThreads threads with a single vtkHyperStreamlineDTMRI that holds
+/// the settings, and the kept paths are merged into one polydata instead
+/// of one vtkHyperStreamline per path in Streamlines.
+/// TransformStreamlinesToRASAndAppendToPolyData() outputs both.
 class VTK_Teem_EXPORT vtkSeedTracts : public vtkObject
 {
 public:
@@ -72,6 +82,22 @@ public:
   /// The point should be in the world coordinates of the scene.
   void SeedStreamlineFromPoint(double x, double y, double z);
 
+  /// Description
+  /// Start a streamline from each of the points, in the world coordinates
+  /// of the scene. The seeds are integrated by threads when the streamlines
+  /// have points and are not written to files.
+  void SeedStreamlinesFromPoints(vtkPoints *points);
+
+  /// Description
+  /// Maximum number of threads used to integrate the seeds
+  vtkSetClampMacro(NumberOfThreads, int, 1, VTK_MAX_THREADS);
+  vtkGetMacro(NumberOfThreads, int);
+
+  /// Description
+  /// Integrate the share of the seeds of a thread, called by the seeding
+  /// methods.
+  void ThreadedTrack(int threadId, int numberOfThreads);
+
   /// Description
   /// Input tensor field in which to seed streamlines
   vtkSetObjectMacro(InputTensorField, vtkImageData);
@@ -222,7 +248,7 @@ public:
  void UpdateAllHyperStreamlineSettings();
 
   /// Description
-  /// Delete all streamlines
+  /// Delete all streamlines, the merged ones of the threads as well
   void DeleteAllStreamlines();
 
   /// Description
@@ -241,6 +267,13 @@ public:
  vtkGetMacro(StartingThreshold,double);
  vtkSetMacro(StartingThreshold,double);
 
+  /// Description
+  /// Sorted eigenvalues of the voxels of InputTensorField, used by the
+  /// starting threshold instead of solving the seed tensors when set.
+  /// \sa vtkMRMLDiffusionTensorVolumeNode::GetEigenvalues()
+  vtkSetObjectMacro(InputEigenvalues, vtkDataArray);
+  vtkGetObjectMacro(InputEigenvalues, vtkDataArray);
+
   /// 
   /// Whether to randomly jitter seed points. 
   /// (They stay within same grid cube or voxel.)
@@ -277,6 +310,7 @@ protected:
   int RandomGrid;
 
   vtkImageData *InputTensorField;
+  vtkDataArray *InputEigenvalues;
   vtkImageData *InputROI;
   vtkImageData *InputROI2;
 
@@ -315,6 +349,19 @@ protected:
   void UpdateHyperStreamlinePointsSettings( vtkHyperStreamlineDTMRI *currHSP);
   void UpdateHyperStreamlineTeemSettings( vtkHyperStreamlineTeem *currHST);
 
+  /// Whether the seeds are queued and integrated by threads rather than
+  /// with one vtkHyperStreamline each
+  bool UseBatchTracking();
+  /// Integrate the queued seeds (in scaled ijk of the tensors) by threads
+  /// and merge the paths longer than MinimumPathLength
+  void TrackSeeds();
+
+  int NumberOfThreads;
+  vtkMultiThreader *MultiThreader;
+
+  class vtkInternal;
+  vtkInternal *Internal;
+
 };
 
 #endif
@@ -16,6 +16,10 @@
 #include "vtkPointData.h"
 #include "vtkImageData.h"
 #include "vtkFloatArray.h"
+#include "vtkMath.h"
+
+// STD includes
+#include <algorithm>
 
 
 #define VTKEPS 10e-12
@@ -53,6 +57,10 @@ vtkTeemEstimateDiffusionTensor::vtkTeemEstimateDiffusionTensor()
   this->knownB0 = 0;
   this->ShiftNegativeEigenvalues = 0;
 
+  this->Mask = NULL;
+  this->BatchEstimation = 0;
+  this->BatchReady = 0;
+
   // Output images beside the estimated tensor
   this->Baseline = vtkImageData::New();
   this->AverageDWI = vtkImageData::New();
@@ -82,6 +90,10 @@ vtkTeemEstimateDiffusionTensor::~vtkTeemEstimateDiffusionTensor()
     {
     this->Transform->Delete();
     }
+  if (this->Mask)
+    {
+    this->Mask->Delete();
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -102,6 +114,8 @@ void vtkTeemEstimateDiffusionTensor::PrintSelf(ostream& os, vtkIndent indent)
          <<  "B value: "
          << this->BValues->GetValue(i) << "\n"; 
     }
+  os << indent << "Mask: " << this->Mask << "\n";
+  os << indent << "BatchEstimation: " << this->BatchEstimation << "\n";
 }
 
 //----------------------------------------------------------------------------
@@ -257,6 +271,32 @@ void vtkTeemEstimateDiffusionTensor::ExecuteData(vtkDataObject *out)
   // if the user has transformed the coordinate system
   this->TransformDiffusionGradients();
 
+  if (this->Mask)
+    {
+    int *maskExt = this->Mask->GetExtent();
+    int *outExt = output->GetUpdateExtent();
+    if (this->Mask->GetScalarType() != VTK_UNSIGNED_CHAR ||
+        this->Mask->GetNumberOfScalarComponents() != 1 ||
+        maskExt[0] > outExt[0] || maskExt[1] < outExt[1] ||
+        maskExt[2] > outExt[2] || maskExt[3] < outExt[3] ||
+        maskExt[4] > outExt[4] || maskExt[5] < outExt[5])
+      {
+      vtkErrorMacro("The mask must have one unsigned char component and cover the input extent");
+      return;
+      }
+    }
+
+  // The pseudo-inverse is shared by all the threads
+  this->BatchReady = 0;
+  if (this->BatchEstimation && this->EstimationMethod != tenEstimateMethodNLS)
+    {
+    this->BatchReady = this->ComputeDesignMatrix();
+    if (!this->BatchReady)
+      {
+      vtkWarningMacro("Singular design matrix, the tensors are estimated voxel by voxel");
+      }
+    }
+
   // jump back into normal pipeline: call standard superclass method here
   //Do not jump to do the proper allocation of output data
   this->vtkImageToImageFilter::ExecuteData(out);
@@ -285,6 +325,9 @@ static void vtkTeemEstimateDiffusionTensorExecute(vtkTeemEstimateDiffusionTensor
   double *dwi;
   double averageDWI;
   int numDWI;
+  double averageB0;
+  int numB0;
+  double estimatedB0;
   vtkDataArray *outTensors;
   float outT[3][3];
   int ptId;
@@ -323,6 +366,15 @@ static void vtkTeemEstimateDiffusionTensorExecute(vtkTeemEstimateDiffusionTensor
   baselinePtr = (T *) self->GetBaseline()->GetScalarPointerForExtent(outExt);
   averageDWIPtr = (T *) self->GetAverageDWI()->GetScalarPointerForExtent(outExt);
 
+  // Get pointer to the mask, if any
+  unsigned char *maskPtr = NULL;
+  vtkIdType maskIncX = 0, maskIncY = 0, maskIncZ = 0;
+  if (self->GetMask())
+    {
+    maskPtr = (unsigned char *) self->GetMask()->GetScalarPointerForExtent(outExt);
+    self->GetMask()->GetContinuousIncrements(outExt, maskIncX, maskIncY, maskIncZ);
+    }
+
   // find the region to loop over
   maxX = outExt[1] - outExt[0];
   maxY = outExt[3] - outExt[2]; 
@@ -357,6 +409,8 @@ static void vtkTeemEstimateDiffusionTensorExecute(vtkTeemEstimateDiffusionTensor
              // create tensor from combination of gradient inputs
              averageDWI = 0.0;
              numDWI =0;
+             averageB0 = 0.0;
+             numB0 = 0;
              for (int k=0; k< numInputs; k++) 
              {
                dwi[k] = (double) inPtr[k];
@@ -365,24 +419,39 @@ static void vtkTeemEstimateDiffusionTensorExecute(vtkTeemEstimateDiffusionTensor
                  averageDWI += dwi[k];
                  numDWI++;
                  }
+               else
+                 {
+                 averageB0 += dwi[k];
+                 numB0++;
+                 }
              }
-             // Set dwi to context
-             //Main method
-              tenEstimate1TensorSingle_d(tec,_ten, dwi);
-              outT[0][0] = _ten[1];
-              outT[0][1] = outT[1][0] = _ten[2];
-              outT[0][2] = outT[2][0] = _ten[3];
-              outT[1][1] = _ten[4];
-              outT[1][2] = outT[2][1] = _ten[5];
-              outT[2][2] = _ten[6];
+             if (maskPtr && !*maskPtr)
+               {
+               // Do not fit the voxels out of the mask
+               memset(outT, 0, sizeof(outT));
+               estimatedB0 = (numB0 > 0) ? averageB0/numB0 : 0.0;
+               }
+             else
+               {
+               // Set dwi to context
+               //Main method
+               tenEstimate1TensorSingle_d(tec,_ten, dwi);
+               outT[0][0] = _ten[1];
+               outT[0][1] = outT[1][0] = _ten[2];
+               outT[0][2] = outT[2][0] = _ten[3];
+               outT[1][1] = _ten[4];
+               outT[1][2] = outT[2][1] = _ten[5];
+               outT[2][2] = _ten[6];
+               estimatedB0 = tec->estimatedB0;
+               }
 
               // Pixel operation              
               outTensors->SetTuple(ptId,(float *)outT);
               // copy no diffusion data through for scalars
-              *outPtr = (T) tec->estimatedB0;
+              *outPtr = (T) estimatedB0;
 
               // Copy B0 and DWI
-             *baselinePtr = (T) tec->estimatedB0;
+             *baselinePtr = (T) estimatedB0;
              if (numDWI > 0)
                 *averageDWIPtr = (T) (averageDWI/numDWI);
               else
@@ -397,18 +466,30 @@ static void vtkTeemEstimateDiffusionTensorExecute(vtkTeemEstimateDiffusionTensor
               outPtr++;
               baselinePtr++;
               averageDWIPtr++;
+              if (maskPtr)
+                {
+                maskPtr++;
+                }
             }
           outPtr += outIncY;
           ptId += outIncY;
           baselinePtr += outIncY;
           averageDWIPtr += outIncY;
           inPtr += inIncY;
+          if (maskPtr)
+            {
+            maskPtr += maskIncY;
+            }
          }
       outPtr += outIncZ;
       ptId += outIncZ;
       baselinePtr += outIncZ;
       averageDWIPtr += outIncZ;
       inPtr += inIncZ;
+      if (maskPtr)
+        {
+        maskPtr += maskIncZ;
+        }
     }
 
   delete [] dwi;
@@ -418,6 +499,379 @@ static void vtkTeemEstimateDiffusionTensorExecute(vtkTeemEstimateDiffusionTensor
   nrrdNuke(nbmat);
 }
 
+//----------------------------------------------------------------------------
+// Same as vtkTeemEstimateDiffusionTensorExecute, but the voxels of a row
+// that are inside the mask are gathered and fitted at once by FitBatch.
+template <class T>
+static void vtkTeemEstimateDiffusionTensorBatchExecute(vtkTeemEstimateDiffusionTensor *self,
+                                           vtkImageData *inData, 
+                                           T * inPtr,
+                                           vtkImageData *outData, 
+                                           T * outPtr,
+                                           int outExt[6], int id)
+{
+  int idxX, idxY, idxZ;
+  int maxX, maxY, maxZ;
+  vtkIdType inIncX, inIncY, inIncZ;
+  vtkIdType outIncX, outIncY, outIncZ;
+  unsigned long count = 0;
+  unsigned long target;
+  float outT[3][3];
+  int ptId;
+
+  // Get information to march through output tensor data
+  vtkDataArray *outTensors = self->GetOutput()->GetPointData()->GetTensors();
+  vtkIdType *outInc = self->GetOutput()->GetIncrements();
+  int *outFullUpdateExt = self->GetOutput()->GetUpdateExtent();
+  ptId = ((outExt[0] - outFullUpdateExt[0]) * outInc[0]
+         + (outExt[2] - outFullUpdateExt[2]) * outInc[1]
+         + (outExt[4] - outFullUpdateExt[4]) * outInc[2]);
+
+  // Get pointer to Baseline and AverageDWI Images
+  T *baselinePtr = (T *) self->GetBaseline()->GetScalarPointerForExtent(outExt);
+  T *averageDWIPtr = (T *) self->GetAverageDWI()->GetScalarPointerForExtent(outExt);
+
+  // Get pointer to the mask, if any
+  unsigned char *maskPtr = NULL;
+  vtkIdType maskIncX = 0, maskIncY = 0, maskIncZ = 0;
+  if (self->GetMask())
+    {
+    maskPtr = (unsigned char *) self->GetMask()->GetScalarPointerForExtent(outExt);
+    self->GetMask()->GetContinuousIncrements(outExt, maskIncX, maskIncY, maskIncZ);
+    }
+
+  // find the region to loop over
+  maxX = outExt[1] - outExt[0];
+  maxY = outExt[3] - outExt[2]; 
+  maxZ = outExt[5] - outExt[4];
+  target = (unsigned long)(outData->GetNumberOfScalarComponents()*
+                           (maxZ+1)*(maxY+1)/50.0);
+  target++;
+
+  // Get increments to march through image data 
+  inData->GetContinuousIncrements(outExt, inIncX, inIncY, inIncZ);
+  outData->GetContinuousIncrements(outExt, outIncX, outIncY, outIncZ);
+
+  const int numInputs = inData->GetNumberOfScalarComponents();
+  const int numX = maxX + 1;
+  std::vector<int> weighted(numInputs);
+  for (int k = 0; k < numInputs; k++)
+    {
+    weighted[k] = (self->GetBValues()->GetValue(k) > 1);
+    }
+  // Batch of the fitted voxels of a row, stored voxel first
+  std::vector<int> fitted(numX);
+  std::vector<double> signals(numInputs * numX);
+  std::vector<double> params(7 * numX);
+
+  for (idxZ = 0; idxZ <= maxZ; idxZ++)
+    {
+      for (idxY = 0; !self->AbortExecute && idxY <= maxY; idxY++)
+        {
+          if (!id) 
+            {
+              if (!(count%target)) 
+                {
+                  self->UpdateProgress(count/(50.0*target));
+                }
+              count++;
+            }
+          // Skip the voxels out of the mask before fitting
+          int n = 0;
+          for (idxX = 0; idxX <= maxX; idxX++)
+            {
+            fitted[idxX] = (!maskPtr || maskPtr[idxX]) ? n++ : -1;
+            }
+          for (idxX = 0; idxX <= maxX; idxX++)
+            {
+            if (fitted[idxX] >= 0)
+              {
+              const T *dwi = inPtr + idxX * numInputs;
+              for (int k = 0; k < numInputs; k++)
+                {
+                signals[k * n + fitted[idxX]] = (double) dwi[k];
+                }
+              }
+            }
+          if (n > 0)
+            {
+            self->FitBatch(&signals[0], n, &params[0]);
+            }
+
+          for (idxX = 0; idxX <= maxX; idxX++)
+            {
+              double averageDWI = 0.0;
+              int numDWI = 0;
+              double averageB0 = 0.0;
+              int numB0 = 0;
+              for (int k = 0; k < numInputs; k++)
+                {
+                if (weighted[k])
+                  {
+                  averageDWI += (double) inPtr[k];
+                  numDWI++;
+                  }
+                else
+                  {
+                  averageB0 += (double) inPtr[k];
+                  numB0++;
+                  }
+                }
+              double estimatedB0;
+              const int v = fitted[idxX];
+              if (v < 0)
+                {
+                memset(outT, 0, sizeof(outT));
+                estimatedB0 = (numB0 > 0) ? averageB0/numB0 : 0.0;
+                }
+              else
+                {
+                double ten[3][3];
+                ten[0][0] = params[1 * n + v];
+                ten[0][1] = ten[1][0] = params[2 * n + v];
+                ten[0][2] = ten[2][0] = params[3 * n + v];
+                ten[1][1] = params[4 * n + v];
+                ten[1][2] = ten[2][1] = params[5 * n + v];
+                ten[2][2] = params[6 * n + v];
+                if (self->GetShiftNegativeEigenvalues())
+                  {
+                  // Same as Teem's negEvalShift
+                  double w[3], e[3][3];
+                  vtkMath::Diagonalize3x3(ten, w, e);
+                  double minEigenvalue = std::min(w[0], std::min(w[1], w[2]));
+                  if (minEigenvalue < 0)
+                    {
+                    for (int i = 0; i < 3; i++)
+                      {
+                      ten[i][i] -= minEigenvalue;
+                      }
+                    }
+                  }
+                for (int j = 0; j < 3; j++)
+                  {
+                  for (int i = 0; i < 3; i++)
+                    {
+                    outT[i][j] = (float) ten[i][j];
+                    }
+                  }
+                estimatedB0 = exp(params[v]);
+                }
+
+              // Pixel operation              
+              outTensors->SetTuple(ptId,(float *)outT);
+              // copy no diffusion data through for scalars
+              *outPtr = (T) estimatedB0;
+
+              // Copy B0 and DWI
+              *baselinePtr = (T) estimatedB0;
+              if (numDWI > 0)
+                *averageDWIPtr = (T) (averageDWI/numDWI);
+              else
+                *averageDWIPtr = (T) 0;
+
+              inPtr += numInputs;
+              ptId ++;
+              outPtr++;
+              baselinePtr++;
+              averageDWIPtr++;
+            }
+          if (maskPtr)
+            {
+            maskPtr += numX + maskIncY;
+            }
+          outPtr += outIncY;
+          ptId += outIncY;
+          baselinePtr += outIncY;
+          averageDWIPtr += outIncY;
+          inPtr += inIncY;
+         }
+      outPtr += outIncZ;
+      ptId += outIncZ;
+      baselinePtr += outIncZ;
+      averageDWIPtr += outIncZ;
+      inPtr += inIncZ;
+      if (maskPtr)
+        {
+        maskPtr += maskIncZ;
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkTeemEstimateDiffusionTensor::ComputeDesignMatrix()
+{
+  const int numGradients = this->NumberOfGradients;
+  if (numGradients < 7)
+    {
+    return 0;
+    }
+
+  // Same b-matrix as SetGradientsToContext: the gradients scaled by
+  // sqrt(b/MaxB) and the MaxB b-value give log(S) = log(B0) - b g^t D g
+  this->DesignMatrix.resize(numGradients * 7);
+  for (int i = 0; i < numGradients; i++)
+    {
+    double g[3];
+    this->GetDiffusionGradient(i, g);
+    const double b = this->BValues->GetValue(i);
+    double *row = &this->DesignMatrix[i * 7];
+    row[0] = 1.0;
+    row[1] = -b * g[0] * g[0];
+    row[2] = -2.0 * b * g[0] * g[1];
+    row[3] = -2.0 * b * g[0] * g[2];
+    row[4] = -b * g[1] * g[1];
+    row[5] = -2.0 * b * g[1] * g[2];
+    row[6] = -b * g[2] * g[2];
+    }
+
+  // pseudo-inverse = (A^t A)^-1 A^t
+  double normal[7][7];
+  double inverse[7][7];
+  double *normalRows[7];
+  double *inverseRows[7];
+  for (int a = 0; a < 7; a++)
+    {
+    normalRows[a] = normal[a];
+    inverseRows[a] = inverse[a];
+    for (int c = 0; c < 7; c++)
+      {
+      normal[a][c] = 0.0;
+      for (int i = 0; i < numGradients; i++)
+        {
+        normal[a][c] += this->DesignMatrix[i * 7 + a] * this->DesignMatrix[i * 7 + c];
+        }
+      }
+    }
+  if (!vtkMath::InvertMatrix(normalRows, inverseRows, 7))
+    {
+    return 0;
+    }
+  this->PseudoInverse.resize(7 * numGradients);
+  for (int a = 0; a < 7; a++)
+    {
+    for (int i = 0; i < numGradients; i++)
+      {
+      double value = 0.0;
+      for (int c = 0; c < 7; c++)
+        {
+        value += inverse[a][c] * this->DesignMatrix[i * 7 + c];
+        }
+      this->PseudoInverse[a * numGradients + i] = value;
+      }
+    }
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+// The loops over the voxels are the inner ones so that they vectorize.
+void vtkTeemEstimateDiffusionTensor::FitBatch(const double *signals, int n, double *params)
+{
+  const int numGradients = this->NumberOfGradients;
+  const double *design = &this->DesignMatrix[0];
+  const double *pseudoInverse = &this->PseudoInverse[0];
+
+  // Clamp the signal to the minimum detectable value as Teem does
+  std::vector<double> logs(numGradients * n);
+  for (int k = 0; k < numGradients * n; k++)
+    {
+    logs[k] = log(signals[k] > this->MinimumSignalValue ?
+                  signals[k] : this->MinimumSignalValue);
+    }
+
+  // Linear least squares
+  for (int j = 0; j < 7; j++)
+    {
+    double *p = params + j * n;
+    for (int v = 0; v < n; v++)
+      {
+      p[v] = 0.0;
+      }
+    for (int k = 0; k < numGradients; k++)
+      {
+      const double c = pseudoInverse[j * numGradients + k];
+      const double *l = &logs[k * n];
+      for (int v = 0; v < n; v++)
+        {
+        p[v] += c * l[v];
+        }
+      }
+    }
+  if (this->EstimationMethod != tenEstimateMethodWLS)
+    {
+    return;
+    }
+
+  // Weighted least squares, weighted by the square of the fitted signal.
+  // The normal equations are accumulated for all the voxels, the lower
+  // triangle only, then solved voxel by voxel.
+  std::vector<double> normal(28 * n);
+  std::vector<double> rhs(7 * n);
+  std::vector<double> weights(n);
+  for (int iter = 0; iter < this->NumberOfWLSIterations; iter++)
+    {
+    std::fill(normal.begin(), normal.end(), 0.0);
+    std::fill(rhs.begin(), rhs.end(), 0.0);
+    for (int k = 0; k < numGradients; k++)
+      {
+      const double *a = design + k * 7;
+      const double *l = &logs[k * n];
+      for (int v = 0; v < n; v++)
+        {
+        double fittedLog = 0.0;
+        for (int j = 0; j < 7; j++)
+          {
+          fittedLog += a[j] * params[j * n + v];
+          }
+        weights[v] = exp(2.0 * fittedLog);
+        }
+      for (int r = 0, idx = 0; r < 7; r++)
+        {
+        double *b = &rhs[r * n];
+        for (int v = 0; v < n; v++)
+          {
+          b[v] += a[r] * weights[v] * l[v];
+          }
+        for (int c = 0; c <= r; c++, idx++)
+          {
+          const double ac = a[r] * a[c];
+          if (ac == 0.0)
+            {
+            continue;
+            }
+          double *m = &normal[idx * n];
+          for (int v = 0; v < n; v++)
+            {
+            m[v] += ac * weights[v];
+            }
+          }
+        }
+      }
+    for (int v = 0; v < n; v++)
+      {
+      double m[7][7];
+      double *rows[7];
+      double x[7];
+      for (int r = 0, idx = 0; r < 7; r++)
+        {
+        rows[r] = m[r];
+        x[r] = rhs[r * n + v];
+        for (int c = 0; c <= r; c++, idx++)
+          {
+          m[r][c] = m[c][r] = normal[idx * n + v];
+          }
+        }
+      // Keep the previous estimate if the system is singular
+      if (vtkMath::SolveLinearSystem(rows, x, 7))
+        {
+        for (int j = 0; j < 7; j++)
+          {
+          params[j * n + v] = x[j];
+          }
+        }
+      }
+    }
+}
+
 int vtkTeemEstimateDiffusionTensor::SetGradientsToContext(tenEstimateContext *tec,Nrrd *ngrad, Nrrd *nbmat) 
 {
   char *err = NULL;
@@ -536,6 +990,20 @@ void vtkTeemEstimateDiffusionTensor::ThreadedExecute(vtkImageData *inData,
   // Loop through to fill input pointer array
   inPtrs = inData->GetScalarPointerForExtent(outExt);
 
+  if (this->BatchReady)
+    {
+    switch (inData->GetScalarType())
+      {
+      vtkTemplateMacro(vtkTeemEstimateDiffusionTensorBatchExecute(this,
+                        inData, static_cast<VTK_TT*>(inPtrs),
+                        outData, static_cast<VTK_TT*>(outPtr),
+                        outExt, id));
+      default:
+        vtkErrorMacro(<< "Execute: Unknown ScalarType");
+      }
+    return;
+    }
+
   // call Execute method to handle all data at the same time
   switch (inData->GetScalarType())
     {
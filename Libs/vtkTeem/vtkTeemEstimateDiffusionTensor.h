@@ -21,6 +21,9 @@
 #include "vtkTransform.h"
 #include "teem/nrrd.h"
 
+// STD includes
+#include <vector>
+
 /* avoid name conflicts with symbols from python */
 #undef ECHO 
 #undef B0
@@ -116,9 +119,31 @@ class VTK_Teem_EXPORT vtkTeemEstimateDiffusionTensor : public vtkImageToImageFil
   vtkSetObjectMacro(Transform, vtkTransform);
   vtkGetObjectMacro(Transform, vtkTransform);
  
+  /// 
+  /// Voxels where the mask is 0 are not fitted: their tensor is null and
+  /// their baseline is the average of the non diffusion weighted values.
+  /// The mask has one unsigned char component and covers the input extent.
+  vtkSetObjectMacro(Mask, vtkImageData);
+  vtkGetObjectMacro(Mask, vtkImageData);
+
+  /// 
+  /// Fit the LLS and WLS tensors of the voxels of a row all at once with
+  /// the pseudo-inverse of the design matrix, computed once per execution,
+  /// instead of one Teem estimation per voxel. NLS is always estimated
+  /// with Teem. Off by default.
+  vtkSetMacro(BatchEstimation, int);
+  vtkGetMacro(BatchEstimation, int);
+  vtkBooleanMacro(BatchEstimation, int);
+
   /// 
   /// Internal class use only
   void TransformDiffusionGradients();
+  int ComputeDesignMatrix();
+  int IsBatchReady() { return this->BatchReady; }
+  /// Fit n voxels: signals is NumberOfGradients x n and the 7 x n params
+  /// are the log baseline and the Dxx, Dxy, Dxz, Dyy, Dyz, Dzz components.
+  /// Both are stored with the voxels contiguous.
+  void FitBatch(const double *signals, int n, double *params);
   int SetGradientsToContext ( tenEstimateContext *tec,Nrrd *ngrad, Nrrd *nbmat);
   int SetTenContext(  tenEstimateContext *tec,Nrrd *ngrad, Nrrd *nbmat);
 
@@ -171,6 +196,15 @@ class VTK_Teem_EXPORT vtkTeemEstimateDiffusionTensor : public vtkImageToImageFil
   /// 
   int NumberOfWLSIterations;
 
+  vtkImageData *Mask;
+
+  int BatchEstimation;
+  int BatchReady;
+  /// NumberOfGradients x 7 design matrix of the log signal
+  std::vector<double> DesignMatrix;
+  /// 7 x NumberOfGradients pseudo-inverse of the design matrix
+  std::vector<double> PseudoInverse;
+
   void ExecuteInformation(vtkImageData *inData, vtkImageData *outData);
   void ExecuteInformation(){this->vtkImageToImageFilter::ExecuteInformation();};
   void ThreadedExecute(vtkImageData *inData, vtkImageData *outData,
@@ -36,28 +36,30 @@ vtkTensorMask::~vtkTensorMask()
 
 
 //----------------------------------------------------------------------------
-// Replace superclass Execute with a function that allocates tensors
-// as well as scalars.  This gets called before multithreader starts
-// (after which we can't allocate, for example in ThreadedExecute).
-// Note we return to the regular pipeline at the end of this function.
-void vtkTensorMask::ExecuteData(vtkDataObject *out)
+// The superclass passes the input tensors through to the output, which
+// would then be masked in place. Allocate output tensors instead: this is
+// called before the multithreader starts, after which each thread only
+// writes the tensors of its extent.
+void vtkTensorMask::CopyAttributeData(vtkImageData *input,
+                                      vtkImageData *output,
+                                      vtkInformationVector **inputVector)
 {
-  vtkImageData *output = vtkImageData::SafeDownCast(out);
+  this->Superclass::CopyAttributeData(input, output, inputVector);
 
-  // set extent so we know how many tensors to allocate
-  output->SetExtent(output->GetUpdateExtent());
+  vtkDataArray *inTensors = input ? input->GetPointData()->GetTensors() : NULL;
+  if (!inTensors)
+    {
+    return;
+    }
 
-  // allocate output tensors
+  // allocate output tensors over the output extent
   vtkFloatArray* data = vtkFloatArray::New();
   int* dims = output->GetDimensions();
   data->SetNumberOfComponents(9);
   data->SetNumberOfTuples(dims[0]*dims[1]*dims[2]);
+  data->SetName(inTensors->GetName());
   output->GetPointData()->SetTensors(data);
   data->Delete();
-
-  // jump back into normal pipeline: call standard superclass method here
-  //  this->vtkImageMultipleInputFilter::ExecuteData(out);
-  this->vtkImageMask::ExecuteData(out);
 }
 
 
@@ -180,6 +182,7 @@ static void vtkTensorMaskExecuteTensor(vtkTensorMask *self, int ext[6],
   vtkFloatingPointType outT[3][3];
 
   int ptId;
+  int inPtId;
 
   // do we NOT the mask?
   maskState = self->GetNotMask();
@@ -206,6 +209,13 @@ static void vtkTensorMaskExecuteTensor(vtkTensorMask *self, int ext[6],
   ptId = ((ext[0] - outFullUpdateExt[0]) * outInc[0]
          + (ext[2] - outFullUpdateExt[2]) * outInc[1]
          + (ext[4] - outFullUpdateExt[4]) * outInc[2]);
+  // The input tensors are laid out over the input extent
+  vtkIdType inInc[3];
+  int *inExt = in1Data->GetExtent();
+  in1Data->GetIncrements(inInc);
+  inPtId = ((ext[0] - inExt[0]) * inInc[0]
+           + (ext[2] - inExt[2]) * inInc[1]
+           + (ext[4] - inExt[4]) * inInc[2]);
   
   // Get information to march through data 
   in1Data->GetContinuousIncrements(ext, in1Inc0, in1Inc1, in1Inc2);
@@ -233,7 +243,7 @@ static void vtkTensorMaskExecuteTensor(vtkTensorMask *self, int ext[6],
         }
       for (idx0 = 0; idx0 < num0; ++idx0)
         {
-          inTensors->GetTuple(ptId,(vtkFloatingPointType *)inT);
+          inTensors->GetTuple(inPtId,(vtkFloatingPointType *)inT);
           //outTensors->GetTuple(ptId,outT);
 
           // Pixel operation: clear or copy
@@ -275,11 +285,16 @@ static void vtkTensorMaskExecuteTensor(vtkTensorMask *self, int ext[6],
           outTensors->SetTuple(ptId,(vtkFloatingPointType *)outT);
           
           ptId += 1;
+          inPtId += 1;
           in2Ptr += 1;
         }
       ptId += outInc1;
+      inPtId += in1Inc1;
+      in2Ptr += in2Inc1;
     }
       ptId += outInc2;
+      inPtId += in1Inc2;
+      in2Ptr += in2Inc2;
     }
 }
 
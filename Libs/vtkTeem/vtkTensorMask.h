@@ -50,9 +50,11 @@ protected:
   void operator=(const vtkTensorMask&);
 
   /// We override this in order to allocate output tensors
-  /// before threading happens.  This replaces the superclass 
-  /// vtkImageMultipleInputFilter's Execute function.
-  void ExecuteData(vtkDataObject *out);
+  /// before threading happens, instead of masking the input
+  /// tensors passed through by the superclass.
+  virtual void CopyAttributeData(vtkImageData *input,
+                                 vtkImageData *output,
+                                 vtkInformationVector **inputVector);
 
   virtual void ThreadedRequestData(vtkInformation *request, 
                                    vtkInformationVector **inputVector, 
@@ -62,12 +62,26 @@ public:
     m_CostFunction = fn;
   }
 
+  /// Publish the transform as an intermediate result of the output
+  /// transform fileName after each iteration.
+  void SetIntermediateTransform(const itk::TransformBase* transform,
+                                const itk::TransformBase* bulkTransform,
+                                const std::string& fileName)
+  {
+    m_Transform = transform;
+    m_BulkTransform = bulkTransform;
+    m_OutputTransform = fileName;
+  }
+
 protected:
   CommandIterationUpdate()
   {
   };
   itk::ProcessObject::Pointer m_Registration;
   CostFunctionType::Pointer   m_CostFunction;
+  itk::TransformBase::ConstPointer m_Transform;
+  itk::TransformBase::ConstPointer m_BulkTransform;
+  std::string                      m_OutputTransform;
 public:
   typedef itk::LBFGSBOptimizer OptimizerType;
   typedef OptimizerType *      OptimizerPointer;
@@ -93,6 +107,11 @@ public:
         static_cast<double>(optimizer->GetCurrentIteration() )
         / static_cast<double>(optimizer->GetMaximumNumberOfIterations() ) );
       }
+    if( m_Transform && !m_OutputTransform.empty() )
+      {
+      itk::WriteIntermediateTransform(m_Transform, m_OutputTransform,
+                                      m_BulkTransform);
+      }
   }
 
 };
@@ -358,6 +377,8 @@ int DoIt( int argc, char * argv[], T )
   typename CommandIterationUpdate::Pointer observer = CommandIterationUpdate::New();
   observer->SetRegistration( registration );
   observer->SetCostFunction( metric );
+  observer->SetIntermediateTransform( transform, transform->GetBulkTransform(),
+                                      OutputTransform );
 
   optimizer->AddObserver( itk::IterationEvent(), observer );
 
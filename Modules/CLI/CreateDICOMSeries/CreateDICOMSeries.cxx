@@ -11,10 +11,20 @@ command line processing and additional features have been added.
 
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
-#include "itkExtractImageFilter.h"
 #include "itkShiftScaleImageFilter.h"
 #include "itkGDCMImageIO.h"
 #include "itkMetaDataObject.h"
+#include "itkMultiThreader.h"
+#include "itkSimpleFastMutexLock.h"
+
+#if ITK_VERSION_MAJOR < 4
+#include "gdcmUtil.h"
+#else
+#include "gdcmUIDGenerator.h"
+#endif
+
+#include <algorithm>
+#include <vector>
 
 #include "CreateDICOMSeriesCLP.h"
 
@@ -26,6 +36,188 @@ command line processing and additional features have been added.
 namespace
 {
 
+std::string GenerateUID(const std::string& prefix)
+{
+#if ITK_VERSION_MAJOR < 4
+  return gdcm::Util::CreateUniqueUID( prefix );
+#else
+  gdcm::UIDGenerator::SetRoot( prefix.c_str() );
+  gdcm::UIDGenerator uid;
+  return std::string( uid.Generate() );
+#endif
+}
+
+// Shared by the threads that write the slices of the series.  Slices are
+// dealt out to the threads in turn, each thread writes them with its own
+// writer and GDCMImageIO.
+template <class TPixel>
+struct SeriesWriteInfo
+  {
+  typedef itk::Image<TPixel, 3>                Image3DType;
+  typedef itk::Image<TPixel, 2>                Image2DType;
+  typedef itk::ImageFileWriter<Image2DType>    WriterType;
+
+  const Image3DType *                          Image;
+  const itk::MetaDataDictionary *              Dictionary;
+  const std::vector<std::string> *             FileNames;
+  const std::vector<std::string> *             SOPInstanceUIDs;
+  bool                                         ReverseImages;
+  std::vector<typename WriterType::Pointer>    Writers;
+  std::vector<std::string>                     Errors;
+
+  // Progress of all the threads
+  itk::SimpleFastMutexLock                     ProgressLock;
+  unsigned int                                 NumberOfWrittenSlices;
+  };
+
+// Write the files of the thread.  The slices are not extracted: the image
+// written is a 2D image over the slice in the volume buffer, and only the
+// per slice fields are set in a copy of the shared dictionary.
+template <class TPixel>
+ITK_THREAD_RETURN_TYPE WriteSlicesThreaderCallback( void * arg )
+{
+  typedef SeriesWriteInfo<TPixel>              InfoType;
+  typedef typename InfoType::Image3DType       Image3DType;
+  typedef typename InfoType::Image2DType       Image2DType;
+  typedef typename Image2DType::PixelContainer PixelContainerType;
+
+  itk::MultiThreader::ThreadInfoStruct * threadInfo =
+    static_cast<itk::MultiThreader::ThreadInfoStruct *>( arg );
+  InfoType * info = static_cast<InfoType *>( threadInfo->UserData );
+  const unsigned int threadId = threadInfo->ThreadID;
+  const unsigned int numberOfSlices = info->FileNames->size();
+
+  const Image3DType * image = info->Image;
+  const typename Image3DType::SizeType    size = image->GetBufferedRegion().GetSize();
+  const typename Image3DType::SpacingType spacing = image->GetSpacing();
+  const typename Image3DType::DirectionType direction = image->GetDirection();
+  const unsigned long slicePixels = size[0] * size[1];
+
+  // Geometry of the slices as extracted with the ITKv3 compatible direction
+  // collapse: the in plane part of the direction, or the identity if it is
+  // singular
+  typename Image2DType::RegionType sliceRegion;
+  typename Image2DType::SizeType   sliceSize;
+  typename Image2DType::SpacingType sliceSpacing;
+  typename Image2DType::DirectionType sliceDirection;
+  sliceSize[0] = size[0];
+  sliceSize[1] = size[1];
+  sliceRegion.SetSize( sliceSize );
+  sliceSpacing[0] = spacing[0];
+  sliceSpacing[1] = spacing[1];
+  if( direction[0][0] * direction[1][1] - direction[0][1] * direction[1][0] != 0.0 )
+    {
+    for( unsigned int r = 0; r < 2; r++ )
+      {
+      for( unsigned int c = 0; c < 2; c++ )
+        {
+        sliceDirection[r][c] = direction[r][c];
+        }
+      }
+    }
+  else
+    {
+    sliceDirection.SetIdentity();
+    }
+
+  typename InfoType::WriterType * writer = info->Writers[threadId];
+  itksys_ios::ostringstream value;
+
+  for( unsigned int i = threadId; i < numberOfSlices; i += threadInfo->NumberOfThreads )
+    {
+    const unsigned int slice = info->ReverseImages ? numberOfSlices - i - 1 : i;
+    itk::MetaDataDictionary dictionary = *info->Dictionary;
+
+    typename Image3DType::PointType origin;
+    typename Image3DType::IndexType index;
+    index.Fill(0);
+    index[2] = i;
+    image->TransformIndexToPhysicalPoint(index, origin);
+
+    // Set the per slice DICOM fields
+    value.str("");
+    value << origin[0] << "\\" << origin[1] << "\\" << origin[2];
+    itk::EncapsulateMetaData<std::string>(dictionary, "0020|0032", value.str() ); // Image Position (Patient)
+
+    value.str("");
+    value << i + 1;
+    itk::EncapsulateMetaData<std::string>(dictionary, "0020|0013", value.str() ); // Instance Number
+
+    itk::EncapsulateMetaData<std::string>(dictionary, "0008|0018", (*info->SOPInstanceUIDs)[i] ); // SOP
+                                                                                                  // Instance
+                                                                                                  // UID
+
+    // The slice in the volume buffer, not owned by the slice image
+    TPixel * sliceBuffer = const_cast<TPixel *>( image->GetBufferPointer() ) + slice * slicePixels;
+    typename PixelContainerType::Pointer container = PixelContainerType::New();
+    container->SetImportPointer( sliceBuffer, slicePixels, false );
+
+    typename Image3DType::PointType sliceOrigin3D;
+    index[2] = slice;
+    image->TransformIndexToPhysicalPoint(index, sliceOrigin3D);
+    typename Image2DType::PointType sliceOrigin;
+    sliceOrigin[0] = sliceOrigin3D[0];
+    sliceOrigin[1] = sliceOrigin3D[1];
+
+    typename Image2DType::Pointer sliceImage = Image2DType::New();
+    sliceImage->SetRegions( sliceRegion );
+    sliceImage->SetSpacing( sliceSpacing );
+    sliceImage->SetOrigin( sliceOrigin );
+    sliceImage->SetDirection( sliceDirection );
+    sliceImage->SetPixelContainer( container );
+
+    TPixel minValue = itk::NumericTraits<TPixel>::max();
+    TPixel maxValue = itk::NumericTraits<TPixel>::min();
+    const TPixel * sliceEnd = sliceBuffer + slicePixels;
+    for( const TPixel * p = sliceBuffer; p != sliceEnd; ++p )
+      {
+      if( *p > maxValue )
+        {
+        maxValue = *p;
+        }
+      if( *p < minValue )
+        {
+        minValue = *p;
+        }
+      }
+    TPixel windowCenter = (minValue + maxValue) / 2;
+    TPixel windowWidth = (maxValue - minValue);
+
+    value.str("");
+    value << windowCenter;
+    itk::EncapsulateMetaData<std::string>(dictionary, "0028|1050", value.str() );
+    value.str("");
+    value << windowWidth;
+    itk::EncapsulateMetaData<std::string>(dictionary, "0028|1051", value.str() );
+
+    sliceImage->SetMetaDataDictionary(dictionary);
+
+    writer->SetFileName( (*info->FileNames)[i].c_str() );
+    writer->SetInput( sliceImage );
+    try
+      {
+      writer->Update();
+      }
+    catch( itk::ExceptionObject & excp )
+      {
+      itksys_ios::ostringstream msg;
+      msg << (*info->FileNames)[i] << ": " << excp;
+      info->Errors[threadId] = msg.str();
+      return ITK_THREAD_RETURN_VALUE;
+      }
+
+    info->ProgressLock.Lock();
+    ++info->NumberOfWrittenSlices;
+    std::cout << "<filter-progress>"
+              << static_cast<float>( info->NumberOfWrittenSlices ) / static_cast<float>( numberOfSlices )
+              << "</filter-progress>"
+              << std::endl
+              << std::flush;
+    info->ProgressLock.Unlock();
+    }
+  return ITK_THREAD_RETURN_VALUE;
+}
+
 template <class Tin>
 int DoIt( int argc, char * argv[])
 {
@@ -91,6 +283,170 @@ int DoIt( int argc, char * argv[])
   typename ImageIOType::Pointer gdcmIO = ImageIOType::New();
   DictionaryType       dictionary;
 
+  // The fields shared by all the slices are set once, the threads copy the
+  // dictionary and only set the per slice fields
+  itksys_ios::ostringstream value;
+  itk::EncapsulateMetaData<std::string>(dictionary, "0008|0008", std::string("ORIGINAL\\PRIMARY\\AXIAL") );  // Image
+                                                                                                             // Type
+  itk::EncapsulateMetaData<std::string>(dictionary, "0008|0016", std::string("1.2.840.10008.5.1.4.1.1.2") ); // SOP
+                                                                                                             // Class
+                                                                                                             // UID
+  itk::EncapsulateMetaData<std::string>(dictionary, "0010|0030", std::string("20060101") );                  //
+                                                                                                             // Patient's
+                                                                                                             // Birthdate
+  itk::EncapsulateMetaData<std::string>(dictionary, "0010|0032", std::string("010100.000000") );             //
+                                                                                                             // Patient's
+                                                                                                             // Birth
+                                                                                                             // Time
+  itk::EncapsulateMetaData<std::string>(dictionary, "0010|0040", std::string("M") );                         //
+                                                                                                             // Patient's
+                                                                                                             // Sex
+  itk::EncapsulateMetaData<std::string>(dictionary, "0008|0020", std::string("20050101") );                  // Study
+                                                                                                             // Date
+  itk::EncapsulateMetaData<std::string>(dictionary, "0008|0030", std::string("010100.000000") );             // Study
+                                                                                                             // Time
+  itk::EncapsulateMetaData<std::string>(dictionary, "0008|0050", std::string("1") );                         //
+                                                                                                             // Accession
+                                                                                                             // Number
+  itk::EncapsulateMetaData<std::string>(dictionary, "0008|0090", std::string("Unknown") );                   //
+                                                                                                             // Referring
+                                                                                                             // Physician's
+                                                                                                             // Name
+  itk::EncapsulateMetaData<std::string>(dictionary, "0018|5100", std::string("HFS") );                       //
+                                                                                                             // Patient
+                                                                                                             // Position
+  itk::EncapsulateMetaData<std::string>(dictionary, "0020|1040", std::string("SN") );                        //
+                                                                                                             // Position
+                                                                                                             // Reference
+                                                                                                             // Indicator
+  // itk::EncapsulateMetaData<std::string>(dictionary,"0020|0037",
+  // std::string("1.000000\\0.000000\\0.000000\\0.000000\\1.000000\\0.000000")); // Image Orientation (Patient)
+  value.str("");
+  value << oMatrix[0][0] << "\\" << oMatrix[1][0] << "\\" << oMatrix[2][0] << "\\";
+  value << oMatrix[0][1] << "\\" << oMatrix[1][1] << "\\" << oMatrix[2][1];
+  itk::EncapsulateMetaData<std::string>(dictionary, "0020|0037", value.str() ); // Image Orientation (Patient)
+  value.str("");
+  value << spacing[2];
+  itk::EncapsulateMetaData<std::string>(dictionary, "0018|0050", value.str() ); // Slice Thickness
+
+  // Parameters from the command line
+  if( patientName.size() > 0 )
+    {
+    itk::EncapsulateMetaData<std::string>(dictionary, "0010|0010", patientName);
+    }
+  if( patientID.size() > 0 )
+    {
+    itk::EncapsulateMetaData<std::string>(dictionary, "0010|0020", patientID);
+    }
+  if( patientComments.size() > 0 )
+    {
+    itk::EncapsulateMetaData<std::string>(dictionary, "0010|4000", patientComments);
+    }
+  if( studyID.size() > 0 )
+    {
+    itk::EncapsulateMetaData<std::string>(dictionary, "0020|0010", studyID);
+    }
+  if( studyDate.size() > 0 )
+    {
+    itk::EncapsulateMetaData<std::string>(dictionary, "0008|0020", studyDate);
+    }
+  if( studyComments.size() > 0 )
+    {
+    itk::EncapsulateMetaData<std::string>(dictionary, "0032|4000", studyComments);
+    }
+  if( studyDescription.size() > 0 )
+    {
+    itk::EncapsulateMetaData<std::string>(dictionary, "0008|1030", studyDescription);
+    }
+  if( modality.size() > 0 )
+    {
+    itk::EncapsulateMetaData<std::string>(dictionary, "0008|0060", modality);
+    }
+  if( manufacturer.size() > 0 )
+    {
+    itk::EncapsulateMetaData<std::string>(dictionary, "0008|0070", manufacturer);
+    }
+  if( model.size() > 0 )
+    {
+    itk::EncapsulateMetaData<std::string>(dictionary, "0008|1090", model);
+    }
+  if( seriesNumber.size() > 0 )
+    {
+    itk::EncapsulateMetaData<std::string>(dictionary, "0020|0011", seriesNumber);
+    }
+  if( seriesDescription.size() > 0 )
+    {
+    itk::EncapsulateMetaData<std::string>(dictionary, "0008|103e", seriesDescription);
+    }
+
+  // Always set the rescale interscept and rescale slope (even if
+  // they are at their defaults of 0 and 1 respectively).
+  // value.str("");
+  // value << rescaleIntercept;
+  // itk::EncapsulateMetaData<std::string>(dictionary, "0028|1052", value.str());
+  // value.str("");
+  // value << rescaleSlope;
+  // itk::EncapsulateMetaData<std::string>(dictionary, "0028|1053", value.str());
+
+  // A GDCMImageIO generates the study, series and frame of reference UIDs
+  // the first time it writes, the slices are written by one GDCMImageIO per
+  // thread: generate the UIDs of the series here and keep them.
+  std::string uidPrefix = gdcmIO->GetUIDPrefix();
+  itk::EncapsulateMetaData<std::string>(dictionary, "0020|000d", GenerateUID(uidPrefix) ); // Study
+                                                                                          // Instance
+                                                                                          // UID
+  itk::EncapsulateMetaData<std::string>(dictionary, "0020|000e", GenerateUID(uidPrefix) ); // Series
+                                                                                          // Instance
+                                                                                          // UID
+  itk::EncapsulateMetaData<std::string>(dictionary, "0020|0052", GenerateUID(uidPrefix) ); // Frame
+                                                                                          // of
+                                                                                          // Reference
+                                                                                          // UID
+  std::vector<std::string> sopInstanceUIDs( numberOfSlices );
+  std::vector<std::string> fileNames( numberOfSlices );
+  for( unsigned int i = 0; i < numberOfSlices; i++ )
+    {
+    sopInstanceUIDs[i] = GenerateUID(uidPrefix);
+
+    char                imageNumber[BUFSIZ];
+#if WIN32
+#define snprintf sprintf_s
+#endif
+    snprintf(imageNumber, BUFSIZ, dicomNumberFormat.c_str(), i + 1);
+    value.str("");
+    value << dicomDirectory << "/" << dicomPrefix << imageNumber << ".dcm";
+    fileNames[i] = value.str();
+    }
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  if( numberOfThreads > 0 )
+    {
+    threader->SetNumberOfThreads( numberOfThreads );
+    }
+  const unsigned int nThreads =
+    std::max( 1u, std::min<unsigned int>( threader->GetNumberOfThreads(), numberOfSlices ) );
+  threader->SetNumberOfThreads( nThreads );
+
+  SeriesWriteInfo<InputPixelType> writeInfo;
+  writeInfo.Image = image;
+  writeInfo.Dictionary = &dictionary;
+  writeInfo.FileNames = &fileNames;
+  writeInfo.SOPInstanceUIDs = &sopInstanceUIDs;
+  writeInfo.ReverseImages = reverseImages;
+  writeInfo.NumberOfWrittenSlices = 0;
+  writeInfo.Errors.resize( nThreads );
+  // The first writer and IO are created before the others, the others
+  // before the threads start as the object factories are not thread safe
+  for( unsigned int t = 0; t < nThreads; t++ )
+    {
+    typename ImageIOType::Pointer io = ( t == 0 ) ? gdcmIO : ImageIOType::New();
+    io->KeepOriginalUIDOn();
+    typename WriterType::Pointer writer = WriterType::New();
+    writer->SetImageIO( io );
+    writer->SetUseCompression( useCompression );
+    writeInfo.Writers.push_back( writer );
+    }
+
   // Progress
   std::cout << "<filter-start>"
             << std::endl;
@@ -105,206 +461,16 @@ int DoIt( int argc, char * argv[])
   std::cout << "</filter-start>"
             << std::endl;
   std::cout << std::flush;
-  float progress = 1.0 / (float) numberOfSlices;
-  for( unsigned int i = 0; i < numberOfSlices; i++ )
-    {
-    std::cout << "<filter-progress>"
-              << (i + 1) * progress
-              << "</filter-progress>"
-              << std::endl
-              << std::flush;
-
-    itksys_ios::ostringstream value;
-    typename Image3DType::PointType    origin;
-    typename Image3DType::IndexType    index;
-    index.Fill(0);
-    index[2] = i;
-    image->TransformIndexToPhysicalPoint(index, origin);
-
-    // Set all required DICOM fields
-    value.str("");
-    value << origin[0] << "\\" << origin[1] << "\\" << origin[2];
-    itk::EncapsulateMetaData<std::string>(dictionary, "0020|0032", value.str() );
-
-    value.str("");
-    value << i + 1;
-    itk::EncapsulateMetaData<std::string>(dictionary, "0020|0013", value.str() );
-
-    itk::EncapsulateMetaData<std::string>(dictionary, "0008|0008", std::string("ORIGINAL\\PRIMARY\\AXIAL") );  // Image
-                                                                                                               // Type
-    itk::EncapsulateMetaData<std::string>(dictionary, "0008|0016", std::string("1.2.840.10008.5.1.4.1.1.2") ); // SOP
-                                                                                                               // Class
-                                                                                                               // UID
-    itk::EncapsulateMetaData<std::string>(dictionary, "0010|0030", std::string("20060101") );                  //
-                                                                                                               // Patient's
-                                                                                                               // Birthdate
-    itk::EncapsulateMetaData<std::string>(dictionary, "0010|0032", std::string("010100.000000") );             //
-                                                                                                               // Patient's
-                                                                                                               // Birth
-                                                                                                               // Time
-    itk::EncapsulateMetaData<std::string>(dictionary, "0010|0040", std::string("M") );                         //
-                                                                                                               // Patient's
-                                                                                                               // Sex
-    itk::EncapsulateMetaData<std::string>(dictionary, "0008|0020", std::string("20050101") );                  // Study
-                                                                                                               // Date
-    itk::EncapsulateMetaData<std::string>(dictionary, "0008|0030", std::string("010100.000000") );             // Study
-                                                                                                               // Time
-    itk::EncapsulateMetaData<std::string>(dictionary, "0008|0050", std::string("1") );                         //
-                                                                                                               // Accession
-                                                                                                               // Number
-    itk::EncapsulateMetaData<std::string>(dictionary, "0008|0090", std::string("Unknown") );                   //
-                                                                                                               // Referring
-                                                                                                               // Physician's
-                                                                                                               // Name
-    itk::EncapsulateMetaData<std::string>(dictionary, "0018|5100", std::string("HFS") );                       //
-                                                                                                               // Patient
-                                                                                                               // Position
-    itk::EncapsulateMetaData<std::string>(dictionary, "0020|1040", std::string("SN") );                        //
-                                                                                                               // Position
-                                                                                                               // Reference
-                                                                                                               // Indicator
-    // itk::EncapsulateMetaData<std::string>(dictionary,"0020|0037",
-    // std::string("1.000000\\0.000000\\0.000000\\0.000000\\1.000000\\0.000000")); // Image Orientation (Patient)
-    value.str("");
-    value << oMatrix[0][0] << "\\" << oMatrix[1][0] << "\\" << oMatrix[2][0] << "\\";
-    value << oMatrix[0][1] << "\\" << oMatrix[1][1] << "\\" << oMatrix[2][1];
-    itk::EncapsulateMetaData<std::string>(dictionary, "0020|0037", value.str() ); // Image Orientation (Patient)
-    value.str("");
-    value << spacing[2];
-    itk::EncapsulateMetaData<std::string>(dictionary, "0018|0050", value.str() ); // Slice Thickness
-
-    // Parameters from the command line
-    if( patientName.size() > 0 )
-      {
-      itk::EncapsulateMetaData<std::string>(dictionary, "0010|0010", patientName);
-      }
-    if( patientID.size() > 0 )
-      {
-      itk::EncapsulateMetaData<std::string>(dictionary, "0010|0020", patientID);
-      }
-    if( patientComments.size() > 0 )
-      {
-      itk::EncapsulateMetaData<std::string>(dictionary, "0010|4000", patientComments);
-      }
-    if( studyID.size() > 0 )
-      {
-      itk::EncapsulateMetaData<std::string>(dictionary, "0020|0010", studyID);
-      }
-    if( studyDate.size() > 0 )
-      {
-      itk::EncapsulateMetaData<std::string>(dictionary, "0008|0020", studyDate);
-      }
-    if( studyComments.size() > 0 )
-      {
-      itk::EncapsulateMetaData<std::string>(dictionary, "0032|4000", studyComments);
-      }
-    if( studyDescription.size() > 0 )
-      {
-      itk::EncapsulateMetaData<std::string>(dictionary, "0008|1030", studyDescription);
-      }
-    if( modality.size() > 0 )
-      {
-      itk::EncapsulateMetaData<std::string>(dictionary, "0008|0060", modality);
-      }
-    if( manufacturer.size() > 0 )
-      {
-      itk::EncapsulateMetaData<std::string>(dictionary, "0008|0070", manufacturer);
-      }
-    if( model.size() > 0 )
-      {
-      itk::EncapsulateMetaData<std::string>(dictionary, "0008|1090", model);
-      }
-    if( seriesNumber.size() > 0 )
-      {
-      itk::EncapsulateMetaData<std::string>(dictionary, "0020|0011", seriesNumber);
-      }
-    if( seriesDescription.size() > 0 )
-      {
-      itk::EncapsulateMetaData<std::string>(dictionary, "0008|103e", seriesDescription);
-      }
 
-    // Always set the rescale interscept and rescale slope (even if
-    // they are at their defaults of 0 and 1 respectively).
-    // value.str("");
-    // value << rescaleIntercept;
-    // itk::EncapsulateMetaData<std::string>(dictionary, "0028|1052", value.str());
-    // value.str("");
-    // value << rescaleSlope;
-    // itk::EncapsulateMetaData<std::string>(dictionary, "0028|1053", value.str());
-
-    typename Image3DType::RegionType extractRegion;
-    typename Image3DType::SizeType   extractSize;
-    typename Image3DType::IndexType  extractIndex;
-    extractSize = image->GetLargestPossibleRegion().GetSize();
-    extractIndex.Fill(0);
-    if( reverseImages )
-      {
-      extractIndex[2] = numberOfSlices - i - 1;
-      }
-    else
-      {
-      extractIndex[2] = i;
-      }
-    extractSize[2] = 0;
-    extractRegion.SetSize(extractSize);
-    extractRegion.SetIndex(extractIndex);
-
-    typedef itk::ExtractImageFilter<Image3DType, Image2DType> ExtractType;
-    typename ExtractType::Pointer extract = ExtractType::New();
-#if  ITK_VERSION_MAJOR >= 4
-    extract->SetDirectionCollapseToGuess();  // ITKv3 compatible, but not recommended
-#endif
-    extract->SetInput(image );
-    extract->SetExtractionRegion(extractRegion);
-    extract->GetOutput()->SetMetaDataDictionary(dictionary);
-    extract->Update();
-
-    itk::ImageRegionIterator<Image2DType> it( extract->GetOutput(), extract->GetOutput()->GetLargestPossibleRegion() );
-    typename Image2DType::PixelType                minValue = itk::NumericTraits<typename Image2DType::PixelType>::max();
-    typename Image2DType::PixelType                maxValue = itk::NumericTraits<typename Image2DType::PixelType>::min();
-    for( it.GoToBegin(); !it.IsAtEnd(); ++it )
-      {
-      typename Image2DType::PixelType p = it.Get();
-      if( p > maxValue )
-        {
-        maxValue = p;
-        }
-      if( p < minValue )
-        {
-        minValue = p;
-        }
-      }
-    typename Image2DType::PixelType windowCenter = (minValue + maxValue) / 2;
-    typename Image2DType::PixelType windowWidth = (maxValue - minValue);
+  threader->SetSingleMethod( WriteSlicesThreaderCallback<InputPixelType>, &writeInfo );
+  threader->SingleMethodExecute();
 
-    value.str("");
-    value << windowCenter;
-    itk::EncapsulateMetaData<std::string>(dictionary, "0028|1050", value.str() );
-    value.str("");
-    value << windowWidth;
-    itk::EncapsulateMetaData<std::string>(dictionary, "0028|1051", value.str() );
-
-    typename WriterType::Pointer writer = WriterType::New();
-    char                imageNumber[BUFSIZ];
-#if WIN32
-#define snprintf sprintf_s
-#endif
-    snprintf(imageNumber, BUFSIZ, dicomNumberFormat.c_str(), i + 1);
-    value.str("");
-    value << dicomDirectory << "/" << dicomPrefix << imageNumber << ".dcm";
-    writer->SetFileName(value.str().c_str() );
-
-    writer->SetInput(extract->GetOutput() );
-    writer->SetUseCompression(useCompression);
-    try
-      {
-      writer->SetImageIO(gdcmIO);
-      writer->Update();
-      }
-    catch( itk::ExceptionObject & excp )
+  for( unsigned int t = 0; t < nThreads; t++ )
+    {
+    if( !writeInfo.Errors[t].empty() )
       {
       std::cerr << "Exception thrown while writing the file " << std::endl;
-      std::cerr << excp << std::endl;
+      std::cerr << writeInfo.Errors[t] << std::endl;
       return EXIT_FAILURE;
       }
     }
@@ -12,7 +12,6 @@
 #include <vtkNRRDReader.h>
 #include <vtkNRRDWriter.h>
 #include <vtkTeemEstimateDiffusionTensor.h>
-#include <vtkTensorMask.h>
 
 // VTK includes
 #include <vtkMath.h>
@@ -110,9 +109,6 @@ int main( int argc, char * argv[] )
       {
       estim->SetEstimationMethodToWLS();
       }
-    estim->Update();
-    vtkImageData *tensorImage = estim->GetOutput();
-    tensorImage->GetPointData()->SetScalars(NULL);
 
     // Read the tensor mask
     vtkSmartPointer<vtkImageData> mask = vtkSmartPointer<vtkImageData>::New();
@@ -149,19 +145,16 @@ int main( int argc, char * argv[] )
       applyMask = false;
       }
 
-    // Mask tensor
-    vtkSmartPointer<vtkTensorMask> tensorMask =
-      vtkSmartPointer<vtkTensorMask>::New();
-    tensorMask->SetNumberOfThreads(1);
+    // The voxels out of the mask are not fitted
     if( applyMask )
       {
-      tensorMask->SetMaskAlpha(0.0);
-      tensorMask->SetInput(tensorImage);
-      tensorMask->SetMaskInput(mask);
-      tensorMask->Update();
-      tensorImage = tensorMask->GetOutput();
+      estim->SetMask(mask);
       }
-    /**/
+    estim->BatchEstimationOn();
+    estim->Update();
+    vtkImageData *tensorImage = estim->GetOutput();
+    tensorImage->GetPointData()->SetScalars(NULL);
+
     // Compute IjkToRas (used by Writer)
     vtkSmartPointer<vtkMatrix4x4> ijkToRasMatrix = reader->GetRasToIjkMatrix();
     ijkToRasMatrix->Invert();
@@ -221,6 +221,8 @@ int DoIt( int argc, char * argv[], PixelType )
     iNumNeighbors = 5;
     }
   filter->SetNeighbours( iNumNeighbors );
+  filter->SetFastMode( fastMode );
+  filter->SetBlockStep( blockStep );
 // ======================================================================================================
 // Noise estimation
   typedef itk::Image<float, DiffusionImageType::ImageDimension>           NoiseImageType;
@@ -109,6 +109,31 @@ public:
   itkSetMacro( RComp,      InputImageSizeType );
   itkGetMacro( RComp,      InputImageSizeType );
 
+  /** Fast mode: the input is copied once to a float buffer with the
+   *  channels of a voxel contiguous, and the patch distances of all the
+   *  filtered channels (and their neighbouring gradients) are computed in
+   *  the same pass over the patch. */
+  itkSetMacro( FastMode,      bool         );
+  itkGetMacro( FastMode,      bool         );
+  itkBooleanMacro( FastMode );
+  /** Fast mode only: skip the candidates whose local mean or variance
+   *  (over the patch, of the average of the filtered channels) is too
+   *  different from the one of the voxel being filtered, i.e. whose ratio
+   *  is not in [MeanRatio, 1/MeanRatio] and [VarianceRatio, 1/VarianceRatio] */
+  itkSetMacro( Preselection,  bool         );
+  itkGetMacro( Preselection,  bool         );
+  itkBooleanMacro( Preselection );
+  itkSetMacro( MeanRatio,     float        );
+  itkGetMacro( MeanRatio,     float        );
+  itkSetMacro( VarianceRatio, float        );
+  itkGetMacro( VarianceRatio, float        );
+  /** Fast mode only: with a step larger than 1, the weights are estimated
+   *  for blocks centred on a grid of that step (at most the comparison
+   *  radius plus one), each block filters its whole patch and the
+   *  estimates of the blocks covering a voxel are averaged. */
+  itkSetMacro( BlockStep,     unsigned int );
+  itkGetMacro( BlockStep,     unsigned int );
+
   /** Add a new gradient direction: */
   void AddGradientDirection( GradientType grad )
   {
@@ -170,8 +195,20 @@ protected:
 #endif
   void BeforeThreadedGenerateData();
 
+  void AfterThreadedGenerateData();
+
   void GenerateInputRequestedRegion();
 
+  /** Fast mode: fill the buffers shared by the threads */
+  void BuildFastBuffers();
+
+  /** Fast mode: filter the region of a thread */
+  void FastThreadedGenerateData( const OutputImageRegionType & outputRegionForThread );
+
+  /** Increment idx in [lo, hi] by step, the first dimension first; return
+    * false past the last index */
+  static bool NextIndex( long* idx, const long* lo, const long* hi, const long* step );
+
 private:
   UNLMFilter(const Self &);        // purposely not implemented
   void operator=(const Self &);    // purposely not implemented
@@ -194,6 +231,33 @@ private:
   float              m_H;
   InputImageSizeType m_RSearch;
   InputImageSizeType m_RComp;
+  // The fast mode parameters:
+  bool         m_FastMode;
+  bool         m_Preselection;
+  float        m_MeanRatio;
+  float        m_VarianceRatio;
+  unsigned int m_BlockStep;
+  // The fast mode buffers. The input is padded by the comparison radius
+  // (zero flux Neumann), the channels of a voxel are contiguous:
+  std::vector<float> m_FastBuffer;
+  unsigned int       m_FastChannels;
+  long               m_FastStrides[TInputImage::ImageDimension];
+  // Local mean and variance used for preselection, for each input voxel:
+  std::vector<float> m_LocalMeans;
+  std::vector<float> m_LocalVariances;
+  // The comparison patch: offsets in the buffer and Gaussian weights:
+  std::vector<long>  m_PatchOffsets;
+  std::vector<float> m_PatchWeights;
+  // The channels that are filtered, baselines then DWI:
+  std::vector<unsigned int> m_OutputChannels;
+  // The channel pairs compared (the channel of the voxel being filtered and
+  // the one of the candidate), the output they contribute to, the scale of
+  // their distance, and whether they compare a channel with itself:
+  std::vector<unsigned int> m_PairCenterChannels;
+  std::vector<unsigned int> m_PairCandidateChannels;
+  std::vector<unsigned int> m_PairOutputs;
+  std::vector<float>        m_PairScales;
+  std::vector<bool>         m_PairSelf;
 };
 
 } // end namespace itk
@@ -22,7 +22,9 @@
 #include "itkImageRegionIterator.h"
 #include "itkNeighborhoodAlgorithm.h"
 #include "itkZeroFluxNeumannBoundaryCondition.h"
+#include "itkImageRegionConstIterator.h"
 #include "math.h"
+#include <algorithm>
 
 namespace itk
 {
@@ -41,6 +43,12 @@ UNLMFilter<TInputImage, TOutputImage>
   m_H             = 1.0f;
   m_RSearch.Fill(3);
   m_RComp.Fill(1);
+  m_FastMode      = false;
+  m_Preselection  = true;
+  m_MeanRatio     = 0.95f;
+  m_VarianceRatio = 0.5f;
+  m_BlockStep     = 1;
+  m_FastChannels  = 0;
 }
 
 template <class TInputImage, class TOutputImage>
@@ -95,9 +103,202 @@ void UNLMFilter<TInputImage, TOutputImage>
       m_NeighboursInd[g][k] = m_DWI[(unsigned int)(distances[k][0])];
       }
     }
+  if( m_FastMode )
+    {
+    this->BuildFastBuffers();
+    }
   return;
 }
 
+template <class TInputImage, class TOutputImage>
+void UNLMFilter<TInputImage, TOutputImage>
+::AfterThreadedGenerateData( void )
+{
+  // Release the fast mode buffers:
+  std::vector<float>().swap( m_FastBuffer );
+  std::vector<float>().swap( m_LocalMeans );
+  std::vector<float>().swap( m_LocalVariances );
+}
+
+template <class TInputImage, class TOutputImage>
+bool UNLMFilter<TInputImage, TOutputImage>
+::NextIndex( long* idx, const long* lo, const long* hi, const long* step )
+{
+  for( unsigned int d = 0; d < TInputImage::ImageDimension; ++d )
+    {
+    idx[d] += step[d];
+    if( idx[d] <= hi[d] )
+      {
+      return true;
+      }
+    idx[d] = lo[d];
+    }
+  return false;
+}
+
+template <class TInputImage, class TOutputImage>
+void UNLMFilter<TInputImage, TOutputImage>
+::BuildFastBuffers( void )
+{
+  const unsigned int     D = TInputImage::ImageDimension;
+  InputImageConstPointer input = this->GetInput();
+  InputImageRegionType   region = input->GetLargestPossibleRegion();
+  m_FastChannels = input->GetPixel( region.GetIndex() ).Size();
+  // -------------------------------------------------------------------------------------------------------------
+  // Copy the input padded by the comparison radius:
+  long paddedSize[D];
+  long totalPadded = 1;
+  long totalInput = 1;
+  for( unsigned int d = 0; d < D; ++d )
+    {
+    paddedSize[d] = region.GetSize()[d] + 2 * m_RComp[d];
+    m_FastStrides[d] = totalPadded;
+    totalPadded *= paddedSize[d];
+    totalInput *= region.GetSize()[d];
+    }
+  m_FastBuffer.resize( totalPadded * m_FastChannels );
+  long                lo[D], hi[D], one[D], p[D];
+  InputImageIndexType index;
+  for( unsigned int d = 0; d < D; ++d )
+    {
+    lo[d] = 0;
+    hi[d] = paddedSize[d] - 1;
+    one[d] = 1;
+    p[d] = 0;
+    }
+  float* buffer = &m_FastBuffer[0];
+  do
+    {
+    for( unsigned int d = 0; d < D; ++d )
+      {
+      long i = p[d] - static_cast<long>( m_RComp[d] );
+      i = std::max( 0L, std::min( i, static_cast<long>( region.GetSize()[d] ) - 1 ) );
+      index[d] = region.GetIndex()[d] + i;
+      }
+    const InputPixelType pixel = input->GetPixel( index );
+    for( unsigned int c = 0; c < m_FastChannels; ++c )
+      {
+      *buffer++ = static_cast<float>( pixel[c] );
+      }
+    }
+  while( NextIndex( p, lo, hi, one ) );
+  // -------------------------------------------------------------------------------------------------------------
+  // The comparison patch, the same Gaussian window as the pixel by pixel implementation
+  m_PatchOffsets.clear();
+  m_PatchWeights.clear();
+  long  r[D];
+  float sum = itk::NumericTraits<float>::Zero;
+  for( unsigned int d = 0; d < D; ++d )
+    {
+    r[d] = static_cast<long>( m_RComp[d] );
+    lo[d] = -r[d];
+    hi[d] = r[d];
+    p[d] = -r[d];
+    }
+  do
+    {
+    long  offset = 0;
+    float dist = itk::NumericTraits<float>::Zero;
+    for( unsigned int d = 0; d < D; ++d )
+      {
+      offset += p[d] * m_FastStrides[d];
+      dist += static_cast<float>( p[d] * p[d] );
+      }
+    // In the center of the neighbourhood, we correct the weight to avoid over-weighting
+    float weight = ( offset == 0 ) ? ::exp( -0.5f ) : ::exp( -dist / 2 );
+    m_PatchOffsets.push_back( offset );
+    m_PatchWeights.push_back( weight );
+    sum += weight;
+    }
+  while( NextIndex( p, lo, hi, one ) );
+  if( m_PatchOffsets.size() == 1 )
+    {
+    m_PatchWeights[0] = sum = 1.0f;
+    }
+  for( unsigned int k = 0; k < m_PatchWeights.size(); ++k )
+    {
+    m_PatchWeights[k] /= sum;
+    }
+  // -------------------------------------------------------------------------------------------------------------
+  // The channels filtered and the channel pairs compared
+  float sqh = 1.0f / (m_H * m_H);
+  m_OutputChannels.clear();
+  m_PairCenterChannels.clear();
+  m_PairCandidateChannels.clear();
+  m_PairOutputs.clear();
+  m_PairScales.clear();
+  m_PairSelf.clear();
+  for( unsigned int j = 0; j < m_NBaselines; ++j )
+    {
+    m_PairCenterChannels.push_back( m_Baselines[j] );
+    m_PairCandidateChannels.push_back( m_Baselines[j] );
+    m_PairOutputs.push_back( m_OutputChannels.size() );
+    m_PairScales.push_back( sqh * 0.0625f );
+    m_PairSelf.push_back( true );
+    m_OutputChannels.push_back( m_Baselines[j] );
+    }
+  for( unsigned int j = 0; j < m_NDWI; ++j )
+    {
+    for( unsigned int g = 0; g < m_Neighbours; ++g )
+      {
+      m_PairCenterChannels.push_back( m_DWI[j] );
+      m_PairCandidateChannels.push_back( g == 0 ? m_DWI[j] : m_NeighboursInd[j][g] );
+      m_PairOutputs.push_back( m_OutputChannels.size() );
+      m_PairScales.push_back( sqh );
+      m_PairSelf.push_back( g == 0 );
+      }
+    m_OutputChannels.push_back( m_DWI[j] );
+    }
+  // -------------------------------------------------------------------------------------------------------------
+  // Local statistics of the average of the filtered channels, for preselection
+  m_LocalMeans.clear();
+  m_LocalVariances.clear();
+  if( !m_Preselection || m_OutputChannels.empty() )
+    {
+    return;
+    }
+  std::vector<float> guide( totalPadded );
+  for( long v = 0; v < totalPadded; ++v )
+    {
+    float value = itk::NumericTraits<float>::Zero;
+    for( unsigned int o = 0; o < m_OutputChannels.size(); ++o )
+      {
+      value += m_FastBuffer[v * m_FastChannels + m_OutputChannels[o]];
+      }
+    guide[v] = value / m_OutputChannels.size();
+    }
+  m_LocalMeans.resize( totalInput );
+  m_LocalVariances.resize( totalInput );
+  for( unsigned int d = 0; d < D; ++d )
+    {
+    lo[d] = 0;
+    hi[d] = region.GetSize()[d] - 1;
+    p[d] = 0;
+    }
+  long v = 0;
+  do
+    {
+    long center = 0;
+    for( unsigned int d = 0; d < D; ++d )
+      {
+      center += ( p[d] + r[d] ) * m_FastStrides[d];
+      }
+    float mean = itk::NumericTraits<float>::Zero;
+    float squares = itk::NumericTraits<float>::Zero;
+    for( unsigned int k = 0; k < m_PatchOffsets.size(); ++k )
+      {
+      float value = guide[center + m_PatchOffsets[k]];
+      mean += value;
+      squares += value * value;
+      }
+    mean /= m_PatchOffsets.size();
+    m_LocalMeans[v] = mean;
+    m_LocalVariances[v] = std::max( squares / m_PatchOffsets.size() - mean * mean, 0.0f );
+    ++v;
+    }
+  while( NextIndex( p, lo, hi, one ) );
+}
+
 template <class TInputImage, class TOutputImage>
 void UNLMFilter<TInputImage, TOutputImage>
 ::GenerateInputRequestedRegion()
@@ -114,6 +315,13 @@ void UNLMFilter<TInputImage, TOutputImage>
     return;
     }
 
+  // The fast mode buffers the whole input
+  if( m_FastMode )
+    {
+    inputPtr->SetRequestedRegionToLargestPossibleRegion();
+    return;
+    }
+
   // Get a copy of the input requested region (should equal the output
   // requested region)
   InputImageRegionType inputRequestedRegion = inputPtr->GetRequestedRegion();
@@ -140,6 +348,11 @@ void UNLMFilter<TInputImage, TOutputImage>
                         ThreadIdType itkNotUsed(threadId) )
 #endif
 {
+  if( m_FastMode )
+    {
+    this->FastThreadedGenerateData( outputRegionForThread );
+    return;
+    }
   // Boundary conditions for this filter; Neumann conditions are fine
   ZeroFluxNeumannBoundaryCondition<InputImageType> nbc;
   // Iterators:
@@ -401,6 +614,243 @@ void UNLMFilter<TInputImage, TOutputImage>
   delete[] valsD;
 }
 
+
+template <class TInputImage, class TOutputImage>
+void UNLMFilter<TInputImage, TOutputImage>
+::FastThreadedGenerateData( const OutputImageRegionType& outputRegionForThread )
+{
+  const unsigned int     D = TInputImage::ImageDimension;
+  InputImageConstPointer input   =  this->GetInput();
+  OutputImagePointer     output  =  this->GetOutput();
+  InputImageRegionType   region  =  input->GetLargestPossibleRegion();
+  const unsigned int     nc       = m_FastChannels;
+  const unsigned int     nOutputs = m_OutputChannels.size();
+  const unsigned int     nPairs   = m_PairCenterChannels.size();
+  const unsigned int     nPatch   = m_PatchOffsets.size();
+  const float*           buffer   = &m_FastBuffer[0];
+  // -------------------------------------------------------------------------------------------------------------
+  // The region of the thread and the block centres, relative to the input region:
+  long rStart[D], rEnd[D], rStrides[D], step[D], lo[D], hi[D], one[D], inputStrides[D];
+  long nRegion = 1;
+  long nInput = 1;
+  bool blockwise = false;
+  for( unsigned int d = 0; d < D; ++d )
+    {
+    rStart[d] = outputRegionForThread.GetIndex()[d] - region.GetIndex()[d];
+    rEnd[d] = rStart[d] + outputRegionForThread.GetSize()[d] - 1;
+    rStrides[d] = nRegion;
+    nRegion *= outputRegionForThread.GetSize()[d];
+    inputStrides[d] = nInput;
+    nInput *= region.GetSize()[d];
+    // Every voxel must be within the comparison radius of a block centre
+    step[d] = std::max( 1L, std::min( static_cast<long>( m_BlockStep ), static_cast<long>( m_RComp[d] ) + 1 ) );
+    blockwise = blockwise || step[d] > 1;
+    one[d] = 1;
+    }
+  for( unsigned int d = 0; d < D; ++d )
+    {
+    long margin = blockwise ? static_cast<long>( m_RComp[d] ) : 0;
+    lo[d] = std::max( 0L, rStart[d] - margin );
+    lo[d] = ( ( lo[d] + step[d] - 1 ) / step[d] ) * step[d];
+    hi[d] = std::min( static_cast<long>( region.GetSize()[d] ) - 1, rEnd[d] + margin );
+    }
+  // A block filters its whole patch, a voxel only itself:
+  std::vector<long> aggregationOffsets;
+  std::vector<long> aggregationDisplacements;
+  if( blockwise )
+    {
+    long p[D], plo[D], phi[D];
+    for( unsigned int d = 0; d < D; ++d )
+      {
+      plo[d] = -static_cast<long>( m_RComp[d] );
+      phi[d] = static_cast<long>( m_RComp[d] );
+      p[d] = plo[d];
+      }
+    do
+      {
+      long offset = 0;
+      for( unsigned int d = 0; d < D; ++d )
+        {
+        offset += p[d] * m_FastStrides[d];
+        aggregationDisplacements.push_back( p[d] );
+        }
+      aggregationOffsets.push_back( offset );
+      }
+    while( NextIndex( p, plo, phi, one ) );
+    }
+  else
+    {
+    aggregationOffsets.push_back( 0 );
+    aggregationDisplacements.resize( D, 0 );
+    }
+  // -------------------------------------------------------------------------------------------------------------
+  // Auxiliar variables:
+  std::vector<double> accumulated( nRegion * nOutputs, 0.0 );
+  std::vector<int>    counts( nRegion, 0 );
+  std::vector<float>  distances( nPairs );
+  std::vector<float>  weights;
+  std::vector<long>   candidates;
+  std::vector<float>  norms( nOutputs );
+  std::vector<float>  maxs( nOutputs );
+  std::vector<float>  centreWeights( nOutputs );
+  std::vector<double> estimates( nOutputs );
+  const bool          preselection = !m_LocalMeans.empty();
+  const float         minMeanRatio = std::min( m_MeanRatio, 1.0f / m_MeanRatio );
+  const float         minVarianceRatio = std::min( m_VarianceRatio, 1.0f / m_VarianceRatio );
+  long                c[D], q[D], qlo[D], qhi[D];
+  bool                empty = ( nOutputs == 0 || nRegion == 0 );
+  for( unsigned int d = 0; d < D; ++d )
+    {
+    c[d] = lo[d];
+    empty = empty || lo[d] > hi[d];
+    }
+  while( !empty )
+    {
+    // ---------------------------------------------------------------------------------------------------------
+    // CREATE THE REGION TO SEARCH:
+    long cBuffer = 0;
+    long cInput = 0;
+    for( unsigned int d = 0; d < D; ++d )
+      {
+      cBuffer += ( c[d] + static_cast<long>( m_RComp[d] ) ) * m_FastStrides[d];
+      cInput += c[d] * inputStrides[d];
+      qlo[d] = std::max( 0L, c[d] - static_cast<long>( m_RSearch[d] ) );
+      qhi[d] = std::min( static_cast<long>( region.GetSize()[d] ) - 1, c[d] + static_cast<long>( m_RSearch[d] ) );
+      q[d] = qlo[d];
+      }
+    std::fill( norms.begin(), norms.end(), 0.0f );
+    std::fill( maxs.begin(), maxs.end(), -100.0f );
+    weights.clear();
+    candidates.clear();
+    // ---------------------------------------------------------------------------------------------------------
+    // COMPUTE THE WEIGHTS OF ALL THE CHANNEL PAIRS FOR EACH CANDIDATE
+    do
+      {
+      long qBuffer = 0;
+      long qInput = 0;
+      for( unsigned int d = 0; d < D; ++d )
+        {
+        qBuffer += ( q[d] + static_cast<long>( m_RComp[d] ) ) * m_FastStrides[d];
+        qInput += q[d] * inputStrides[d];
+        }
+      const bool isCentre = ( qBuffer == cBuffer );
+      if( preselection && !isCentre )
+        {
+        float meanC = m_LocalMeans[cInput];
+        float meanQ = m_LocalMeans[qInput];
+        float varC = m_LocalVariances[cInput];
+        float varQ = m_LocalVariances[qInput];
+        float meanRatio = ( meanC < meanQ ) ? meanC / meanQ : meanQ / meanC;
+        float varRatio = ( varC < varQ ) ? varC / varQ : varQ / varC;
+        if( meanC != meanQ && !( meanRatio >= minMeanRatio ) )
+          {
+          continue;
+          }
+        if( varC != varQ && !( varRatio >= minVarianceRatio ) )
+          {
+          continue;
+          }
+        }
+      // One pass over the patch for all the channel pairs:
+      std::fill( distances.begin(), distances.end(), 0.0f );
+      for( unsigned int k = 0; k < nPatch; ++k )
+        {
+        const float* a = buffer + ( cBuffer + m_PatchOffsets[k] ) * nc;
+        const float* b = buffer + ( qBuffer + m_PatchOffsets[k] ) * nc;
+        const float  gw = m_PatchWeights[k];
+        for( unsigned int p = 0; p < nPairs; ++p )
+          {
+          float aux = a[m_PairCenterChannels[p]] - b[m_PairCandidateChannels[p]];
+          distances[p] += gw * aux * aux;
+          }
+        }
+      candidates.push_back( qBuffer );
+      for( unsigned int p = 0; p < nPairs; ++p )
+        {
+        float w = itk::NumericTraits<float>::Zero;
+        // The central value of a channel is weighted afterwards
+        if( !( isCentre && m_PairSelf[p] ) )
+          {
+          w = ::exp( -distances[p] * m_PairScales[p] );
+          norms[m_PairOutputs[p]] += w;
+          maxs[m_PairOutputs[p]] = std::max( maxs[m_PairOutputs[p]], w );
+          }
+        weights.push_back( w );
+        }
+      }
+    while( NextIndex( q, qlo, qhi, one ) );
+    // To avoid over-weighting of the central value:
+    for( unsigned int o = 0; o < nOutputs; ++o )
+      {
+      centreWeights[o] = ( maxs[o] > 1e-6 ) ? maxs[o] : 1.0f;
+      norms[o] = 1.0f / ( centreWeights[o] + norms[o] );
+      }
+    // ---------------------------------------------------------------------------------------------------------
+    // AGGREGATE THE ESTIMATES OF THE VOXELS OF THE THREAD REGION
+    const unsigned int nCandidates = candidates.size();
+    for( unsigned int k = 0; k < aggregationOffsets.size(); ++k )
+      {
+      long x = 0;
+      bool inside = true;
+      for( unsigned int d = 0; d < D && inside; ++d )
+        {
+        long xd = c[d] + aggregationDisplacements[k * D + d];
+        inside = ( xd >= rStart[d] && xd <= rEnd[d] );
+        x += ( xd - rStart[d] ) * rStrides[d];
+        }
+      if( !inside )
+        {
+        continue;
+        }
+      const float* centre = buffer + ( cBuffer + aggregationOffsets[k] ) * nc;
+      for( unsigned int o = 0; o < nOutputs; ++o )
+        {
+        estimates[o] = centreWeights[o] * centre[m_OutputChannels[o]] * centre[m_OutputChannels[o]];
+        }
+      for( unsigned int n = 0; n < nCandidates; ++n )
+        {
+        const float* b = buffer + ( candidates[n] + aggregationOffsets[k] ) * nc;
+        const float* w = &weights[n * nPairs];
+        for( unsigned int p = 0; p < nPairs; ++p )
+          {
+          float aux = b[m_PairCandidateChannels[p]];
+          estimates[m_PairOutputs[p]] += w[p] * aux * aux;
+          }
+        }
+      for( unsigned int o = 0; o < nOutputs; ++o )
+        {
+        accumulated[x * nOutputs + o] += estimates[o] * norms[o];
+        }
+      ++counts[x];
+      }
+    if( !NextIndex( c, lo, hi, step ) )
+      {
+      break;
+      }
+    }
+  // -------------------------------------------------------------------------------------------------------------
+  // SET THE OUTPUT PIXELS
+  ImageRegionConstIterator<InputImageType> iit( input, outputRegionForThread );
+  ImageRegionIterator<OutputImageType>     oit( output, outputRegionForThread );
+  long                                     x = 0;
+  for( iit.GoToBegin(), oit.GoToBegin(); !oit.IsAtEnd(); ++iit, ++oit, ++x )
+    {
+    OutputPixelType op = iit.Get();
+    if( counts[x] > 0 )
+      {
+      for( unsigned int o = 0; o < nOutputs; ++o )
+        {
+        float value = static_cast<float>( accumulated[x * nOutputs + o] / counts[x] );
+        // Remove Rician bias:
+        value -= 2.0f * m_Sigma * m_Sigma;
+        value = ( value > 1e-10 ? ::sqrt(value) : itk::NumericTraits<float>::Zero );
+        op[m_OutputChannels[o]] = static_cast<ScalarType>(value);
+        }
+      }
+    oit.Set( op );
+    }
+}
+
 } // end namespace itk
 
 #endif
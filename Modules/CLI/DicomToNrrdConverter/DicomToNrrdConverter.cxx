@@ -35,15 +35,18 @@ gradient directions is the same as the ImageOrientationPatient
 
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <string>
 #include <iomanip>
 #include <algorithm> //Needed for trasforom to convert string tolower
+#include <cstring>
 
 #include "itkXMLFilterWatcher.h"
 
 #include "itkNrrdImageIO.h"
 #include "itkImage.h"
 #include "itkImageSeriesReader.h"
+#include "itkMultiThreader.h"
 #include "itkMetaDataDictionary.h"
 #include "itkSmoothingRecursiveGaussianImageFilter.h"
 #include "itkRecursiveGaussianImageFilter.h"
@@ -154,6 +157,7 @@ namespace {
   typedef short PixelValueType;
   typedef itk::Image< PixelValueType, 3 > VolumeType;
   typedef itk::ImageSeriesReader< VolumeType > ReaderType;
+  typedef itk::ImageFileReader< VolumeType > SliceReaderType;
   typedef itk::GDCMImageIO ImageIOType;
   typedef itk::GDCMSeriesFileNames InputNamesGeneratorType;
 
@@ -298,6 +302,76 @@ namespace {
       }
     }
 
+  // Shared by the threads that load the dicom headers and decode the
+  // slices.  Files are dealt out to the threads in turn.
+  struct SeriesReadInfo
+    {
+    const std::vector<std::string> *   FileNames;
+    std::vector<gdcm::File *> *        Headers;
+    VolumeType *                       Volume;
+    std::vector<SliceReaderType::Pointer> SliceReaders;
+    std::vector<std::string>           Errors;
+    };
+
+  ITK_THREAD_RETURN_TYPE LoadHeadersThreaderCallback( void * arg )
+    {
+    itk::MultiThreader::ThreadInfoStruct * threadInfo =
+      static_cast<itk::MultiThreader::ThreadInfoStruct *>( arg );
+    SeriesReadInfo * info = static_cast<SeriesReadInfo *>( threadInfo->UserData );
+    const unsigned int nFiles = info->FileNames->size();
+
+    for (unsigned int k = threadInfo->ThreadID; k < nFiles; k += threadInfo->NumberOfThreads)
+      {
+      gdcm::File * header = (*info->Headers)[k];
+      header->SetFileName( (*info->FileNames)[k] );
+      header->SetMaxSizeLoadEntry( 65535 );
+      header->SetLoadMode( gdcm::LD_NOSEQ );
+      header->Load();
+      }
+    return ITK_THREAD_RETURN_VALUE;
+    }
+
+  // Decode each file of the series with the reader of the thread and copy it
+  // into its slice of the volume.
+  ITK_THREAD_RETURN_TYPE ReadSlicesThreaderCallback( void * arg )
+    {
+    itk::MultiThreader::ThreadInfoStruct * threadInfo =
+      static_cast<itk::MultiThreader::ThreadInfoStruct *>( arg );
+    SeriesReadInfo * info = static_cast<SeriesReadInfo *>( threadInfo->UserData );
+    const unsigned int threadId = threadInfo->ThreadID;
+    const unsigned int nFiles = info->FileNames->size();
+
+    const VolumeType::SizeType volumeSize = info->Volume->GetBufferedRegion().GetSize();
+    const unsigned long slicePixels = volumeSize[0] * volumeSize[1];
+    SliceReaderType * sliceReader = info->SliceReaders[threadId];
+
+    for (unsigned int k = threadId; k < nFiles; k += threadInfo->NumberOfThreads)
+      {
+      try
+        {
+        sliceReader->SetFileName( (*info->FileNames)[k] );
+        sliceReader->Update();
+        }
+      catch (itk::ExceptionObject &excp)
+        {
+        std::ostringstream msg;
+        msg << (*info->FileNames)[k] << ": " << excp;
+        info->Errors[threadId] = msg.str();
+        return ITK_THREAD_RETURN_VALUE;
+        }
+
+      const VolumeType * slice = sliceReader->GetOutput();
+      if ( slice->GetBufferedRegion().GetNumberOfPixels() != slicePixels )
+        {
+        info->Errors[threadId] = (*info->FileNames)[k] + ": slice size differs from the rest of the series";
+        return ITK_THREAD_RETURN_VALUE;
+        }
+      memcpy( info->Volume->GetBufferPointer() + k * slicePixels,
+              slice->GetBufferPointer(), slicePixels * sizeof( VolumeType::PixelType ) );
+      }
+    return ITK_THREAD_RETURN_VALUE;
+    }
+
 } // end of anonymous namespace
 
 
@@ -570,37 +644,34 @@ int main(int argc, char* argv[])
     }
 
 
-  //////////////////////////////////////////////////
-  // 1) Read the input series as an array of slices
-  ReaderType::Pointer reader = ReaderType::New();
-  itk::GDCMImageIO::Pointer gdcmIO = itk::GDCMImageIO::New();
-  reader->SetImageIO( gdcmIO );
-  reader->SetFileNames( filenames );
   const unsigned int nSlice = filenames.size();
-  try
-    {
-    reader->Update();
-    }
-  catch (itk::ExceptionObject &excp)
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  if ( numberOfThreads > 0 )
     {
-    std::cerr << "Exception thrown while reading the series" << std::endl;
-    std::cerr << excp << std::endl;
-    return EXIT_FAILURE;
+    threader->SetNumberOfThreads( numberOfThreads );
     }
-  VolumeType::Pointer dmImage = VolumeType::New();
+  const unsigned int nThreads = std::max( 1u, std::min<unsigned int>( threader->GetNumberOfThreads(), nSlice ) );
+  threader->SetNumberOfThreads( nThreads );
 
   //////////////////////////////////////////////////
-  // 1-A) Read the input dicom headers
+  // 1) Read the input dicom headers.  The headers stay in the order of the
+  //    files, the slices are decoded once the order of the volume is known.
   std::vector<gdcm::File *> allHeaders( filenames.size() );
   for (unsigned int k = 0; k < filenames.size(); k ++)
     {
     allHeaders[k] = new gdcm::File;
-    allHeaders[k]->SetFileName( filenames[k] );
-    allHeaders[k]->SetMaxSizeLoadEntry( 65535 );
-    allHeaders[k]->SetLoadMode( gdcm::LD_NOSEQ );
-    allHeaders[k]->Load();
     }
 
+  SeriesReadInfo readInfo;
+  readInfo.FileNames = &filenames;
+  readInfo.Headers = &allHeaders;
+  readInfo.Volume = NULL;
+  readInfo.Errors.resize( nThreads );
+  threader->SetSingleMethod( LoadHeadersThreaderCallback, &readInfo );
+  threader->SingleMethodExecute();
+
+  VolumeType::Pointer dmImage = VolumeType::New();
+
   /////////////////////////////////////////////////////
   // 2) Analyze the DICOM header to determine the
   //    number of gradient directions, gradient
@@ -684,46 +755,22 @@ int main(int argc, char* argv[])
   unsigned int numberOfSlicesPerVolume=sliceLocations.size();
   std::cout << "=================== numberOfSlicesPerVolume:" << numberOfSlicesPerVolume << std::endl;
 
+  ReaderType::FileNamesContainer volumeFilenames = filenames;
   if ( nSlice >= 2)
     {
     if (sliceLocationIndicator[0] == sliceLocationIndicator[1])
       {
       std::cout << "Dicom images are ordered in a slice interleaving way." << std::endl;
-      // reorder slices into a volume interleaving manner
+      // reorder slices into a volume interleaving manner, by decoding the
+      // files in that order
       int Ns = numberOfSlicesPerVolume;
       int Nv = nSlice / Ns; // do we need to do error check here
 
-      VolumeType::RegionType R = reader->GetOutput()->GetLargestPossibleRegion();
-      R.SetSize(2,1);
-      std::vector<VolumeType::PixelType> v(nSlice);
-      std::vector<VolumeType::PixelType> w(nSlice);
-
-      itk::ImageRegionIteratorWithIndex<VolumeType> I( reader->GetOutput(), R );
-      for (I.GoToBegin(); !I.IsAtEnd(); ++I)
+      for (int k = 0; k < Nv; k++)
         {
-        VolumeType::IndexType idx = I.GetIndex();
-
-        // extract all values in one "column"
-        for (unsigned int k = 0; k < nSlice; k++)
-          {
-          idx[2] = k;
-          v[k] = reader->GetOutput()->GetPixel( idx );
-          }
-
-        // permute
-        for (int k = 0; k < Nv; k++)
-          {
-          for (int m = 0; m < Ns; m++)
-            {
-            w[k*Ns+m] = v[m*Nv+k];
-            }
-          }
-
-        // put things back in order
-        for (unsigned int k = 0; k < nSlice; k++)
+        for (int m = 0; m < Ns; m++)
           {
-          idx[2] = k;
-          reader->GetOutput()->SetPixel( idx, w[k] );
+          volumeFilenames[k*Ns+m] = filenames[m*Nv+k];
           }
         }
       }
@@ -733,6 +780,50 @@ int main(int argc, char* argv[])
       }
     }
 
+  //////////////////////////////////////////////////
+  // 1-A) Read the input series as an array of slices.  The series reader
+  //      only provides the geometry of the volume, the slices are decoded
+  //      by the threads straight into the volume.
+  ReaderType::Pointer reader = ReaderType::New();
+  itk::GDCMImageIO::Pointer gdcmIO = itk::GDCMImageIO::New();
+  reader->SetImageIO( gdcmIO );
+  reader->SetFileNames( volumeFilenames );
+  VolumeType::Pointer volume = VolumeType::New();
+  try
+    {
+    reader->UpdateOutputInformation();
+    }
+  catch (itk::ExceptionObject &excp)
+    {
+    std::cerr << "Exception thrown while reading the series" << std::endl;
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+    }
+  volume->CopyInformation( reader->GetOutput() );
+  volume->SetRegions( reader->GetOutput()->GetLargestPossibleRegion() );
+  volume->Allocate();
+
+  readInfo.FileNames = &volumeFilenames;
+  readInfo.Volume = volume;
+  for (unsigned int t = 0; t < nThreads; t++)
+    {
+    SliceReaderType::Pointer sliceReader = SliceReaderType::New();
+    sliceReader->SetImageIO( ImageIOType::New() );
+    readInfo.SliceReaders.push_back( sliceReader );
+    }
+  threader->SetSingleMethod( ReadSlicesThreaderCallback, &readInfo );
+  threader->SingleMethodExecute();
+  readInfo.SliceReaders.clear();
+  for (unsigned int t = 0; t < nThreads; t++)
+    {
+    if ( !readInfo.Errors[t].empty() )
+      {
+      std::cerr << "Exception thrown while reading the series" << std::endl;
+      std::cerr << readInfo.Errors[t] << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
   itk::Matrix<double,3,3> MeasurementFrame;
   MeasurementFrame.SetIdentity();
 
@@ -887,7 +978,7 @@ int main(int argc, char* argv[])
     {
     std::cout << " Warning: vendor type not valid" << std::endl;
     // treate the dicom series as an ordinary image and write a straight nrrd file.
-    WriteVolume( reader->GetOutput(), nhdrname );
+    WriteVolume( volume, nhdrname );
     return EXIT_SUCCESS;
     }
 
@@ -1599,7 +1690,7 @@ int main(int argc, char* argv[])
     {
     if (nUsableVolumes == 1)
       {
-      imgWriter->SetInput( reader->GetOutput() );
+      imgWriter->SetInput( volume );
       imgWriter->SetFileName( nhdrname.c_str() );
       try
         {
@@ -1617,7 +1708,7 @@ int main(int argc, char* argv[])
       {
       if ( !NrrdFormat )
         {
-        rawWriter->SetInput( reader->GetOutput() );
+        rawWriter->SetInput( volume );
         try
           {
           rawWriter->Update();
@@ -1643,7 +1734,7 @@ int main(int argc, char* argv[])
     ImageOrigin[1] = -(nRows*(NRRDSpaceDirection[1][0]) + nCols*(NRRDSpaceDirection[1][1]) + nSliceInVolume*(NRRDSpaceDirection[1][2]))/2.0;
     ImageOrigin[2] = -(nRows*(NRRDSpaceDirection[2][0]) + nCols*(NRRDSpaceDirection[2][1]) + nSliceInVolume*(NRRDSpaceDirection[2][2]))/2.0;
 
-    VolumeType::Pointer img = reader->GetOutput();
+    VolumeType::Pointer img = volume;
 
     VolumeType::RegionType region = img->GetLargestPossibleRegion();
     VolumeType::SizeType size = region.GetSize();
@@ -1752,7 +1843,7 @@ int main(int argc, char* argv[])
     }
   else if (vendor.find("PHILIPS") != std::string::npos)
     {
-    VolumeType::Pointer img = reader->GetOutput();
+    VolumeType::Pointer img = volume;
 
     VolumeType::RegionType region = img->GetLargestPossibleRegion();
     VolumeType::SizeType size = region.GetSize();
@@ -1819,7 +1910,7 @@ int main(int argc, char* argv[])
       {
       if ( !NrrdFormat )
         {
-        rawWriter->SetInput( reader->GetOutput() );
+        rawWriter->SetInput( volume );
         try
           {
           rawWriter->Update();
@@ -1852,7 +1943,7 @@ int main(int argc, char* argv[])
   else
     {
     std::cout << "Warning:  invalid vendor found." << std::endl;
-    WriteVolume( reader->GetOutput(), nhdrname );
+    WriteVolume( volume, nhdrname );
     return EXIT_SUCCESS;
     }
 
@@ -2027,8 +2118,8 @@ int main(int argc, char* argv[])
       }
     else if (NrrdFormat)
       {
-      unsigned long nVoxels = reader->GetOutput()->GetBufferedRegion().GetNumberOfPixels();
-      header.write( reinterpret_cast<char *>(reader->GetOutput()->GetBufferPointer()),
+      unsigned long nVoxels = volume->GetBufferedRegion().GetNumberOfPixels();
+      header.write( reinterpret_cast<char *>(volume->GetBufferPointer()),
         nVoxels*sizeof(short) );
       }
 
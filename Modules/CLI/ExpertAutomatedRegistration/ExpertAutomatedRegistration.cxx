@@ -371,6 +371,20 @@ int DoIt( int argc, char *argv[] )
     std::cout << "###MinimizeMemory: " << minimizeMemory << std::endl;
     }
 
+  reger->SetCacheFixedImageSamples( cacheSamples );
+  if( verbosity >= STANDARD )
+    {
+    std::cout << "###CacheSamples: " << cacheSamples << std::endl;
+    }
+
+  reger->SetUseThreadedMetric( threadedMetric );
+  reger->SetUseSinglePrecisionMetric( floatMetric );
+  if( verbosity >= STANDARD )
+    {
+    std::cout << "###ThreadedMetric: " << threadedMetric << std::endl;
+    std::cout << "###FloatMetric: " << floatMetric << std::endl;
+    }
+
   reger->SetRandomNumberSeed( randomNumberSeed );
 
   reger->SetRigidMaxIterations( rigidMaxIterations );
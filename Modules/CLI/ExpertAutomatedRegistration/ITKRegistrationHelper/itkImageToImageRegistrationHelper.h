@@ -331,6 +331,25 @@ public:
   itkGetMacro( MinimizeMemory, bool );
   itkBooleanMacro( MinimizeMemory );
 
+  // Multithreaded Mattes metric for the rigid and affine stages, and the
+  //   precision of its histograms
+  itkSetMacro( UseThreadedMetric, bool );
+  itkGetMacro( UseThreadedMetric, bool );
+  itkBooleanMacro( UseThreadedMetric );
+
+  itkSetMacro( UseSinglePrecisionMetric, bool );
+  itkGetMacro( UseSinglePrecisionMetric, bool );
+  itkBooleanMacro( UseSinglePrecisionMetric );
+
+  // **************
+  //  Registration session: the fixed image voxels that meet the region of
+  //  interest, intensity threshold and mask criteria are found once per
+  //  update and the metric samples of all the stages are drawn from them
+  // **************
+  itkSetMacro( CacheFixedImageSamples, bool );
+  itkGetMacro( CacheFixedImageSamples, bool );
+  itkBooleanMacro( CacheFixedImageSamples );
+
   //
   // Loaded transforms parameters
   //
@@ -436,6 +455,10 @@ private:
   LandmarkPointType;
   typedef typename InitialRegistrationMethodType::LandmarkPointContainer
   LandmarkPointContainer;
+  typedef typename OptimizedRegistrationMethodType::FixedImageIndexContainer
+  FixedImageIndexContainer;
+
+  void ShareFixedImageSampleCandidates( OptimizedRegistrationMethodType * reg );
 
   ImageToImageRegistrationHelper( const Self & );   // Purposely not implemented
   void operator =( const Self & );                  // Purposely not implemented
@@ -497,6 +520,13 @@ private:
 
   bool m_MinimizeMemory;
 
+  bool m_UseThreadedMetric;
+  bool m_UseSinglePrecisionMetric;
+
+  bool                     m_CacheFixedImageSamples;
+  bool                     m_ComputedFixedImageSampleCandidates;
+  FixedImageIndexContainer m_FixedImageSampleCandidates;
+
   //  Loaded Tansform
   typename MatrixTransformType::Pointer   m_LoadedMatrixTransform;
   typename BSplineTransformType::Pointer  m_LoadedBSplineTransform;
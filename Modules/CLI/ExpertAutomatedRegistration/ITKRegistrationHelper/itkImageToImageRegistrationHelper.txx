@@ -105,6 +105,12 @@ ImageToImageRegistrationHelper<TImage>
 
   m_MinimizeMemory = false;
 
+  m_UseThreadedMetric = false;
+  m_UseSinglePrecisionMetric = false;
+
+  m_CacheFixedImageSamples = false;
+  m_ComputedFixedImageSampleCandidates = false;
+
   // Loaded
   m_LoadedMatrixTransform = NULL;
   m_LoadedBSplineTransform = NULL;
@@ -408,6 +414,26 @@ ImageToImageRegistrationHelper<TImage>
   unsigned long fixedImageNumPixels = m_FixedImage->GetLargestPossibleRegion()
     .GetNumberOfPixels();
 
+  // The fixed image intensity range is the same for all the stages
+  PixelType fixedImageSamplesIntensityThreshold = 0;
+  if( m_SampleIntensityPortion > 0 )
+    {
+    typedef MinimumMaximumImageCalculator<ImageType> MinMaxCalcType;
+    typename MinMaxCalcType::Pointer calc = MinMaxCalcType::New();
+    calc->SetImage( m_FixedImage );
+    calc->Compute();
+    PixelType fixedImageMax = calc->GetMaximum();
+    PixelType fixedImageMin = calc->GetMinimum();
+
+    fixedImageSamplesIntensityThreshold = static_cast<PixelType>(
+        ( m_SampleIntensityPortion * (fixedImageMax - fixedImageMin) )
+        + fixedImageMin );
+    }
+
+  // The stages share the fixed image sample candidates of the first one
+  m_FixedImageSampleCandidates.clear();
+  m_ComputedFixedImageSampleCandidates = false;
+
   if( m_EnableRigidRegistration )
     {
     if( this->GetReportProgress() )
@@ -425,6 +451,8 @@ ImageToImageRegistrationHelper<TImage>
                                                   * fixedImageNumPixels ) );
     regRigid->SetSampleFromOverlap( m_SampleFromOverlap );
     regRigid->SetMinimizeMemory( m_MinimizeMemory );
+    regRigid->SetUseThreadedMetric( m_UseThreadedMetric );
+    regRigid->SetUseSinglePrecisionMetric( m_UseSinglePrecisionMetric );
     regRigid->SetMaxIterations( m_RigidMaxIterations );
     regRigid->SetTargetError( m_RigidTargetError );
     if( m_UseFixedImageMaskObject )
@@ -443,17 +471,7 @@ ImageToImageRegistrationHelper<TImage>
       }
     if( m_SampleIntensityPortion > 0 )
       {
-      typedef MinimumMaximumImageCalculator<ImageType> MinMaxCalcType;
-      typename MinMaxCalcType::Pointer calc = MinMaxCalcType::New();
-      calc->SetImage( m_FixedImage );
-      calc->Compute();
-      PixelType fixedImageMax = calc->GetMaximum();
-      PixelType fixedImageMin = calc->GetMinimum();
-
-      regRigid->SetFixedImageSamplesIntensityThreshold( static_cast<PixelType>(
-                                                          ( m_SampleIntensityPortion
-                                                            * (fixedImageMax - fixedImageMin) )
-                                                          + fixedImageMin ) );
+      regRigid->SetFixedImageSamplesIntensityThreshold( fixedImageSamplesIntensityThreshold );
       }
     if( m_UseRegionOfInterest )
       {
@@ -503,6 +521,7 @@ ImageToImageRegistrationHelper<TImage>
         }
       }*/
     regRigid->SetTransformParametersScales( scales );
+    this->ShareFixedImageSampleCandidates( regRigid );
 
     if( m_CurrentMatrixTransform.IsNotNull() )
       {
@@ -550,6 +569,8 @@ ImageToImageRegistrationHelper<TImage>
       }
     regAff->SetSampleFromOverlap( m_SampleFromOverlap );
     regAff->SetMinimizeMemory( m_MinimizeMemory );
+    regAff->SetUseThreadedMetric( m_UseThreadedMetric );
+    regAff->SetUseSinglePrecisionMetric( m_UseSinglePrecisionMetric );
     regAff->SetMaxIterations( m_AffineMaxIterations );
     regAff->SetTargetError( m_AffineTargetError );
     if( m_EnableRigidRegistration )
@@ -573,17 +594,7 @@ ImageToImageRegistrationHelper<TImage>
       }
     if( m_SampleIntensityPortion > 0 )
       {
-      typedef MinimumMaximumImageCalculator<ImageType> MinMaxCalcType;
-      typename MinMaxCalcType::Pointer calc = MinMaxCalcType::New();
-      calc->SetImage( m_FixedImage );
-      calc->Compute();
-      PixelType fixedImageMax = calc->GetMaximum();
-      PixelType fixedImageMin = calc->GetMinimum();
-
-      regAff->SetFixedImageSamplesIntensityThreshold( static_cast<PixelType>(
-                                                        ( m_SampleIntensityPortion
-                                                          * (fixedImageMax - fixedImageMin) )
-                                                        + fixedImageMin ) );
+      regAff->SetFixedImageSamplesIntensityThreshold( fixedImageSamplesIntensityThreshold );
       }
     regAff->SetMetricMethodEnum( m_AffineMetricMethodEnum );
     regAff->SetInterpolationMethodEnum( m_AffineInterpolationMethodEnum );
@@ -627,6 +638,7 @@ ImageToImageRegistrationHelper<TImage>
         }
       }*/
     regAff->SetTransformParametersScales( scales );
+    this->ShareFixedImageSampleCandidates( regAff );
 
     if( m_CurrentMatrixTransform.IsNotNull() )
       {
@@ -693,21 +705,12 @@ ImageToImageRegistrationHelper<TImage>
       }
     if( m_SampleIntensityPortion > 0 )
       {
-      typedef MinimumMaximumImageCalculator<ImageType> MinMaxCalcType;
-      typename MinMaxCalcType::Pointer calc = MinMaxCalcType::New();
-      calc->SetImage( m_FixedImage );
-      calc->Compute();
-      PixelType fixedImageMax = calc->GetMaximum();
-      PixelType fixedImageMin = calc->GetMinimum();
-
-      regBspline->SetFixedImageSamplesIntensityThreshold( static_cast<PixelType>(
-                                                            ( m_SampleIntensityPortion
-                                                              * (fixedImageMax - fixedImageMin) )
-                                                            + fixedImageMin ) );
+      regBspline->SetFixedImageSamplesIntensityThreshold( fixedImageSamplesIntensityThreshold );
       }
     regBspline->SetMetricMethodEnum( m_BSplineMetricMethodEnum );
     regBspline->SetInterpolationMethodEnum( m_BSplineInterpolationMethodEnum );
     regBspline->SetNumberOfControlPoints( (int)(fixedImageSize[0] / m_BSplineControlPointPixelSpacing) );
+    this->ShareFixedImageSampleCandidates( regBspline );
 
     regBspline->Update();
 
@@ -726,6 +729,32 @@ ImageToImageRegistrationHelper<TImage>
       }
     }
   // this->SaveImage("c:/result.mha",m_CurrentMovingImage);
+
+  // Release the shared sample candidates
+  FixedImageIndexContainer().swap( m_FixedImageSampleCandidates );
+  m_ComputedFixedImageSampleCandidates = false;
+}
+
+template <class TImage>
+void
+ImageToImageRegistrationHelper<TImage>
+::ShareFixedImageSampleCandidates( OptimizedRegistrationMethodType * reg )
+{
+  // The candidates are only worth keeping when the criteria that do not
+  //   depend on the transform are in use
+  if( !m_CacheFixedImageSamples
+      || !( m_UseRegionOfInterest
+            || m_SampleIntensityPortion > 0
+            || ( m_UseFixedImageMaskObject && m_FixedImageMaskObject.IsNotNull() ) ) )
+    {
+    return;
+    }
+  if( !m_ComputedFixedImageSampleCandidates )
+    {
+    reg->ComputeFixedImageSampleCandidates( m_FixedImageSampleCandidates );
+    m_ComputedFixedImageSampleCandidates = true;
+    }
+  reg->SetFixedImageSampleCandidates( &m_FixedImageSampleCandidates );
 }
 
 template <class TImage>
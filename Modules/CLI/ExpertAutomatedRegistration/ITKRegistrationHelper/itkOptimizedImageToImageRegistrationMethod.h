@@ -21,6 +21,7 @@
 #include "itkImage.h"
 
 #include "itkImageToImageRegistrationMethod.h"
+#include "itkImageToImageMetric.h"
 
 namespace itk
 {
@@ -61,6 +62,9 @@ public:
   //
   // Custom Typedefs
   //
+  typedef typename ImageToImageMetric<TImage, TImage>::FixedImageIndexContainer
+  FixedImageIndexContainer;
+
   enum TransformMethodEnumType { RIGID_TRANSFORM,
                                  AFFINE_TRANSFORM,
                                  BSPLINE_TRANSFORM };
@@ -100,6 +104,15 @@ public:
   itkSetMacro( MinimizeMemory, bool );
   itkGetConstMacro( MinimizeMemory, bool );
 
+  // Use ThreadedMattesMutualInformationImageToImageMetric for the Mattes
+  //   metric of rigid and affine registrations
+  itkSetMacro( UseThreadedMetric, bool );
+  itkGetConstMacro( UseThreadedMetric, bool );
+
+  // Accumulate the histograms of the threaded metric in single precision
+  itkSetMacro( UseSinglePrecisionMetric, bool );
+  itkGetConstMacro( UseSinglePrecisionMetric, bool );
+
   itkSetMacro( MaxIterations, unsigned int );
   itkGetConstMacro( MaxIterations, unsigned int );
 
@@ -115,6 +128,17 @@ public:
 
   itkGetConstMacro( FixedImageSamplesIntensityThreshold, PixelType );
 
+  // The fixed image voxels that are in the region of interest, above the
+  //   samples intensity threshold and inside the fixed image mask.  The
+  //   metric samples are drawn from them.  Finding them visits the whole
+  //   fixed image, so the stages of a pipeline that share these criteria
+  //   may compute them once and pass them to each other.
+  void ComputeFixedImageSampleCandidates( FixedImageIndexContainer & candidates );
+
+  // The candidates are not copied and must outlive the update.  NULL (the
+  //   default) computes them at each update.
+  void SetFixedImageSampleCandidates( const FixedImageIndexContainer * candidates );
+
   itkSetMacro( TargetError, double );
   itkGetConstMacro( TargetError, double );
 
@@ -162,6 +186,10 @@ private:
 
   bool m_MinimizeMemory;
 
+  bool m_UseThreadedMetric;
+
+  bool m_UseSinglePrecisionMetric;
+
   unsigned int m_MaxIterations;
 
   bool m_UseEvolutionaryOptimization;
@@ -171,6 +199,8 @@ private:
   bool      m_UseFixedImageSamplesIntensityThreshold;
   PixelType m_FixedImageSamplesIntensityThreshold;
 
+  const FixedImageIndexContainer * m_FixedImageSampleCandidates;
+
   double m_TargetError;
 
   int m_RandomNumberSeed;
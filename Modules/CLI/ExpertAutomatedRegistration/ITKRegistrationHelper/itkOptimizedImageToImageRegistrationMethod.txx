@@ -21,6 +21,7 @@
 #include "itkOptimizedImageToImageRegistrationMethod.h"
 
 #include "itkMattesMutualInformationImageToImageMetric.h"
+#include "itkThreadedMattesMutualInformationImageToImageMetric.h"
 #include "itkNormalizedCorrelationImageToImageMetric.h"
 #include "itkMeanSquaresImageToImageMetric.h"
 
@@ -162,6 +163,8 @@ OptimizedImageToImageRegistrationMethod<TImage>
   m_MaxIterations = 100;
   m_SampleFromOverlap = false;
   m_MinimizeMemory = false;
+  m_UseThreadedMetric = false;
+  m_UseSinglePrecisionMetric = false;
 
   m_UseEvolutionaryOptimization = true;
 
@@ -171,6 +174,7 @@ OptimizedImageToImageRegistrationMethod<TImage>
   m_NumberOfSamples = 100000;
   m_FixedImageSamplesIntensityThreshold = 0;
   m_UseFixedImageSamplesIntensityThreshold = false;
+  m_FixedImageSampleCandidates = NULL;
 
   m_TargetError = 0.00001;
 
@@ -219,6 +223,28 @@ OptimizedImageToImageRegistrationMethod<TImage>
   switch( this->GetMetricMethodEnum() )
     {
     case MATTES_MI_METRIC:
+      // The B-spline transform keeps the ITK metric, that makes use of its
+      //   sparse Jacobian, and the B-spline interpolator is not thread safe
+      if( m_UseThreadedMetric
+          && m_TransformMethodEnum != BSPLINE_TRANSFORM
+          && m_InterpolationMethodEnum != BSPLINE_INTERPOLATION )
+        {
+        if( m_UseSinglePrecisionMetric )
+          {
+          typedef ThreadedMattesMutualInformationImageToImageMetric<TImage, TImage, float> TypedMetricType;
+          typename TypedMetricType::Pointer typedMetric = TypedMetricType::New();
+          typedMetric->SetNumberOfHistogramBins( 100 );
+          metric = typedMetric;
+          }
+        else
+          {
+          typedef ThreadedMattesMutualInformationImageToImageMetric<TImage, TImage> TypedMetricType;
+          typename TypedMetricType::Pointer typedMetric = TypedMetricType::New();
+          typedMetric->SetNumberOfHistogramBins( 100 );
+          metric = typedMetric;
+          }
+        }
+      else
         {
         typedef MattesMutualInformationImageToImageMetric<TImage, TImage> TypedMetricType;
 
@@ -264,72 +290,39 @@ OptimizedImageToImageRegistrationMethod<TImage>
       this->GetUseFixedImageSamplesIntensityThreshold() ||
       this->GetUseFixedImageMaskObject() )
     {
-    if( this->GetReportProgress() )
+    FixedImageIndexContainer computedCandidates;
+    const FixedImageIndexContainer * candidates = m_FixedImageSampleCandidates;
+    if( candidates == NULL )
       {
-      std::cout << "Creating fixed image samples" << std::endl;
+      this->ComputeFixedImageSampleCandidates( computedCandidates );
+      candidates = &computedCandidates;
+      }
+    else if( this->GetReportProgress() )
+      {
+      std::cout << "...Reusing " << candidates->size() << " sample candidates" << std::endl;
       }
 
-    itk::ImageRegionConstIteratorWithIndex<ImageType> iter( fixedImage,
-                                                            fixedImage->GetLargestPossibleRegion() );
-    typename ImageType::IndexType index;
-    typename ImageType::IndexType movingIndex;
-    typename MetricType::InputPointType fixedPoint;
-    typename MetricType::InputPointType movingPoint;
-
-    iter.GoToBegin();
-    int count = 0;
-    for( iter.GoToBegin(); !iter.IsAtEnd(); ++iter )
+    // The overlap depends on the transform of this update
+    FixedImageIndexContainer overlappingCandidates;
+    if( this->GetSampleFromOverlap() )
       {
-      index = iter.GetIndex();
-      fixedImage->TransformIndexToPhysicalPoint(index, fixedPoint);
-      if( this->GetSampleFromOverlap() )
+      typename ImageType::IndexType movingIndex;
+      typename MetricType::InputPointType fixedPoint;
+      typename MetricType::InputPointType movingPoint;
+      for( typename FixedImageIndexContainer::const_iterator it = candidates->begin();
+           it != candidates->end(); ++it )
         {
+        fixedImage->TransformIndexToPhysicalPoint( *it, fixedPoint );
         movingPoint = this->GetTransform()->TransformPoint( fixedPoint );
-        if( !movingImage->TransformPhysicalPointToIndex( movingPoint, movingIndex ) )
+        if( movingImage->TransformPhysicalPointToIndex( movingPoint, movingIndex ) )
           {
-          continue;
+          overlappingCandidates.push_back( *it );
           }
         }
-      if( this->GetUseFixedImageSamplesIntensityThreshold() )
-        {
-        if( iter.Get() < this->m_FixedImageSamplesIntensityThreshold )
-          {
-          continue;
-          }
-        }
-      if( this->GetUseFixedImageMaskObject() )
-        {
-        double val;
-        if( this->GetFixedImageMaskObject()->ValueAt( fixedPoint, val ) )
-          {
-          if( val == 0 )
-            {
-            continue;
-            }
-          }
-        }
-      if( this->GetUseRegionOfInterest() )
-        {
-        bool isInside = true;
-        for( unsigned int i = 0; i < ImageDimension; i++ )
-          {
-          if( !( (fixedPoint[i] >= this->GetRegionOfInterestPoint1()[i] &&
-                  fixedPoint[i] <= this->GetRegionOfInterestPoint2()[i])
-                 || (fixedPoint[i] >= this->GetRegionOfInterestPoint2()[i] &&
-                     fixedPoint[i] <= this->GetRegionOfInterestPoint1()[i]) ) )
-            {
-            isInside = false;
-            break;
-            }
-          }
-        if( !isInside )
-          {
-          continue;
-          }
-        }
-
-      ++count;
+      candidates = &overlappingCandidates;
       }
+
+    int count = candidates->size();
     double samplingRate = (double)(m_NumberOfSamples + 2) / (double)count;
     if( this->GetReportProgress() )
       {
@@ -346,40 +339,13 @@ OptimizedImageToImageRegistrationMethod<TImage>
     double step = 0;
     typename MetricType::FixedImageIndexContainer indexList;
     indexList.clear();
-    for( iter.GoToBegin(); !iter.IsAtEnd(); ++iter )
+    for( typename FixedImageIndexContainer::const_iterator it = candidates->begin();
+         it != candidates->end(); ++it )
       {
-      index = iter.GetIndex();
-      fixedImage->TransformIndexToPhysicalPoint(index, fixedPoint);
-      if( this->GetSampleFromOverlap() )
-        {
-        movingPoint = this->GetTransform()->TransformPoint( fixedPoint );
-        if( !movingImage->TransformPhysicalPointToIndex( movingPoint, movingIndex ) )
-          {
-          continue;
-          }
-        }
-      if( this->GetUseFixedImageSamplesIntensityThreshold() )
-        {
-        if( iter.Get() < this->m_FixedImageSamplesIntensityThreshold )
-          {
-          continue;
-          }
-        }
-      if( this->GetUseFixedImageMaskObject() )
-        {
-        double val;
-        if( this->GetFixedImageMaskObject()->ValueAt( fixedPoint, val ) )
-          {
-          if( val == 0 )
-            {
-            continue;
-            }
-          }
-        }
       step = step + samplingRate;
       if( step > 1 )
         {
-        indexList.push_back( index );
+        indexList.push_back( *it );
         while( step > 1 )
           {
           step -= 1;
@@ -449,6 +415,81 @@ OptimizedImageToImageRegistrationMethod<TImage>
     }
 }
 
+template <class TImage>
+void
+OptimizedImageToImageRegistrationMethod<TImage>
+::ComputeFixedImageSampleCandidates( FixedImageIndexContainer & candidates )
+{
+  if( this->GetReportProgress() )
+    {
+    std::cout << "Creating fixed image samples" << std::endl;
+    }
+
+  typename ImageType::ConstPointer fixedImage = this->GetFixedImage();
+
+  candidates.clear();
+  itk::ImageRegionConstIteratorWithIndex<ImageType> iter( fixedImage,
+                                                          fixedImage->GetLargestPossibleRegion() );
+  typename ImageType::IndexType index;
+  typename MetricType::InputPointType fixedPoint;
+  for( iter.GoToBegin(); !iter.IsAtEnd(); ++iter )
+    {
+    index = iter.GetIndex();
+    fixedImage->TransformIndexToPhysicalPoint(index, fixedPoint);
+    if( this->GetUseFixedImageSamplesIntensityThreshold() )
+      {
+      if( iter.Get() < this->m_FixedImageSamplesIntensityThreshold )
+        {
+        continue;
+        }
+      }
+    if( this->GetUseFixedImageMaskObject() )
+      {
+      double val;
+      if( this->GetFixedImageMaskObject()->ValueAt( fixedPoint, val ) )
+        {
+        if( val == 0 )
+          {
+          continue;
+          }
+        }
+      }
+    if( this->GetUseRegionOfInterest() )
+      {
+      bool isInside = true;
+      for( unsigned int i = 0; i < ImageDimension; i++ )
+        {
+        if( !( (fixedPoint[i] >= this->GetRegionOfInterestPoint1()[i] &&
+                fixedPoint[i] <= this->GetRegionOfInterestPoint2()[i])
+               || (fixedPoint[i] >= this->GetRegionOfInterestPoint2()[i] &&
+                   fixedPoint[i] <= this->GetRegionOfInterestPoint1()[i]) ) )
+          {
+          isInside = false;
+          break;
+          }
+        }
+      if( !isInside )
+        {
+        continue;
+        }
+      }
+
+    candidates.push_back( index );
+    }
+}
+
+template <class TImage>
+void
+OptimizedImageToImageRegistrationMethod<TImage>
+::SetFixedImageSampleCandidates( const FixedImageIndexContainer * candidates )
+{
+  if( m_FixedImageSampleCandidates != candidates )
+    {
+    m_FixedImageSampleCandidates = candidates;
+    this->Modified();
+    }
+}
+
 template <class TImage>
 void
 OptimizedImageToImageRegistrationMethod<TImage>
@@ -677,6 +718,10 @@ OptimizedImageToImageRegistrationMethod<TImage>
 
   os << indent << "Minimize Memory = " << m_MinimizeMemory << std::endl;
 
+  os << indent << "Use Threaded Metric = " << m_UseThreadedMetric << std::endl;
+
+  os << indent << "Use Single Precision Metric = " << m_UseSinglePrecisionMetric << std::endl;
+
   os << indent << "Number of Samples = " << m_NumberOfSamples << std::endl;
 
   os << indent << "Samples threshold = " << m_FixedImageSamplesIntensityThreshold << std::endl;
@@ -0,0 +1,200 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    $RCSfile: itkThreadedMattesMutualInformationImageToImageMetric.h,v $
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+
+#ifndef __ThreadedMattesMutualInformationImageToImageMetric_h
+#define __ThreadedMattesMutualInformationImageToImageMetric_h
+
+#include "itkImageToImageMetric.h"
+#include "itkMultiThreader.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/** \class ThreadedMattesMutualInformationImageToImageMetric
+ * \brief Mattes mutual information with one joint histogram per thread.
+ *
+ * Computes the same value and derivative as
+ * MattesMutualInformationImageToImageMetric for transforms with a dense
+ * Jacobian (rigid, affine):  the fixed image values are binned with a
+ * zero order kernel, the moving image values with a cubic B-spline Parzen
+ * window, and the derivative is computed from the ratios of the joint
+ * histogram to the moving marginal, without explicit joint PDF
+ * derivatives.
+ *
+ * The fixed image samples are shared out between the threads.  Each thread
+ * fills its own joint histogram and derivative, that are then summed by
+ * all the threads, each over a slice of the bins or of the parameters.
+ * The samples of a thread are mapped by batches before being accumulated,
+ * and the mapped samples of the value pass are reused by the derivative
+ * pass.  TInternalComputationValueType sets the precision of the
+ * histograms and of the accumulators.
+ *
+ * The interpolator must be thread safe.  With ITK 3, the metric needs the
+ * optimized registration methods (ITK_USE_OPTIMIZED_REGISTRATION_METHODS)
+ * and, since the transforms only provide a shared Jacobian, the derivative
+ * pass runs in one thread.
+ */
+template <class TFixedImage, class TMovingImage, class TInternalComputationValueType = double>
+class ThreadedMattesMutualInformationImageToImageMetric
+  : public ImageToImageMetric<TFixedImage, TMovingImage>
+{
+public:
+
+  typedef ThreadedMattesMutualInformationImageToImageMetric Self;
+  typedef ImageToImageMetric<TFixedImage, TMovingImage>     Superclass;
+  typedef SmartPointer<Self>                                Pointer;
+  typedef SmartPointer<const Self>                          ConstPointer;
+
+  itkNewMacro( Self );
+
+  itkTypeMacro( ThreadedMattesMutualInformationImageToImageMetric,
+                ImageToImageMetric );
+
+  //
+  // Typedefs from Superclass
+  //
+  typedef typename Superclass::MeasureType           MeasureType;
+  typedef typename Superclass::DerivativeType        DerivativeType;
+  typedef typename Superclass::ParametersType        ParametersType;
+  typedef typename Superclass::FixedImageType        FixedImageType;
+  typedef typename Superclass::MovingImageType       MovingImageType;
+  typedef typename Superclass::OutputPointType       MovingImagePointType;
+  typedef typename Superclass::GradientPixelType     GradientPixelType;
+  typedef typename Superclass::GradientImageType     GradientImageType;
+  typedef typename Superclass::TransformJacobianType TransformJacobianType;
+
+  typedef TInternalComputationValueType InternalComputationValueType;
+
+  itkStaticConstMacro( MovingImageDimension, unsigned int,
+                       TMovingImage::ImageDimension );
+
+  //
+  // Methods from Superclass
+  //
+  virtual void Initialize( void ) throw ( ExceptionObject );
+
+  MeasureType GetValue( const ParametersType & parameters ) const;
+
+  void GetDerivative( const ParametersType & parameters,
+                      DerivativeType & derivative ) const;
+
+  void GetValueAndDerivative( const ParametersType & parameters,
+                              MeasureType & value,
+                              DerivativeType & derivative ) const;
+
+  //
+  // Custom Methods
+  //
+  itkSetClampMacro( NumberOfHistogramBins, unsigned int,
+                    5, NumericTraits<unsigned int>::max() );
+  itkGetConstMacro( NumberOfHistogramBins, unsigned int );
+
+  // Number of samples a thread maps before accumulating them
+  itkSetClampMacro( SampleBatchSize, unsigned int,
+                    1, NumericTraits<unsigned int>::max() );
+  itkGetConstMacro( SampleBatchSize, unsigned int );
+
+protected:
+
+  ThreadedMattesMutualInformationImageToImageMetric( void );
+  virtual ~ThreadedMattesMutualInformationImageToImageMetric( void );
+
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+private:
+
+  ThreadedMattesMutualInformationImageToImageMetric( const Self & ); // Purposely not implemented
+  void operator =( const Self & );                                  // Purposely not implemented
+
+  enum ThreadTaskEnumType { JOINT_PDF_TASK,
+                            REDUCE_JOINT_PDF_TASK,
+                            DERIVATIVE_TASK,
+                            REDUCE_DERIVATIVE_TASK };
+
+  // A fixed image sample mapped into the moving image
+  struct MappedSample
+    {
+    unsigned int                 Sample;
+    InternalComputationValueType MovingParzenWindowTerm;
+    GradientPixelType            MovingImageGradient;
+    };
+
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback( void * arg );
+
+  static void SplitRange( unsigned int size, unsigned int threadId,
+                          unsigned int numberOfThreads,
+                          unsigned int & begin, unsigned int & end );
+
+  static InternalComputationValueType CubicBSpline( InternalComputationValueType x );
+
+  static InternalComputationValueType CubicBSplineDerivative( InternalComputationValueType x );
+
+  bool MapSample( unsigned int sample, bool computeGradient, MappedSample & mapped ) const;
+
+  void ThreadedComputeJointPDF( unsigned int threadId, unsigned int numberOfThreads ) const;
+
+  void ThreadedReduceJointPDF( unsigned int threadId, unsigned int numberOfThreads ) const;
+
+  void ThreadedComputeDerivative( unsigned int threadId, unsigned int numberOfThreads ) const;
+
+  void ThreadedReduceDerivative( unsigned int threadId, unsigned int numberOfThreads ) const;
+
+  void RunThreads( ThreadTaskEnumType task, unsigned int numberOfThreads ) const;
+
+  // Fill the joint PDF and the marginals, returns the metric value
+  MeasureType ComputeJointPDF( const ParametersType & parameters, bool computeGradients ) const;
+
+  void ComputeDerivative( DerivativeType & derivative ) const;
+
+  unsigned int m_NumberOfHistogramBins;
+  unsigned int m_SampleBatchSize;
+
+  double m_FixedImageBinSize;
+  double m_FixedImageNormalizedMin;
+  double m_MovingImageBinSize;
+  double m_MovingImageNormalizedMin;
+
+  // Histogram row of each fixed image sample
+  std::vector<unsigned int> m_FixedImageSampleBins;
+
+  MultiThreader::Pointer m_SampleThreader;
+  unsigned int           m_NumberOfSampleThreads;
+
+  mutable ThreadTaskEnumType m_ThreadTask;
+  mutable bool               m_ComputeGradients;
+
+  mutable std::vector<std::vector<InternalComputationValueType> > m_ThreadJointPDFs;
+  mutable std::vector<std::vector<InternalComputationValueType> > m_ThreadDerivatives;
+  mutable std::vector<std::vector<MappedSample> >                 m_ThreadMappedSamples;
+
+  mutable std::vector<InternalComputationValueType> m_JointPDF;
+  mutable std::vector<InternalComputationValueType> m_MovingImageMarginalPDF;
+  // log( p(f,m) / p(m) ), zero where the histogram is empty
+  mutable std::vector<InternalComputationValueType> m_PRatio;
+  mutable std::vector<InternalComputationValueType> m_Derivative;
+  mutable unsigned long                               m_NumberOfValidSamples;
+};
+
+}
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkThreadedMattesMutualInformationImageToImageMetric.txx"
+#endif
+
+#endif
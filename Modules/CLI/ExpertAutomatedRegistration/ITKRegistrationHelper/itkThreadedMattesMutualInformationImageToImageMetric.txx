@@ -0,0 +1,560 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    $RCSfile: itkThreadedMattesMutualInformationImageToImageMetric.txx,v $
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+
+#ifndef __ThreadedMattesMutualInformationImageToImageMetric_txx
+#define __ThreadedMattesMutualInformationImageToImageMetric_txx
+
+#include "itkThreadedMattesMutualInformationImageToImageMetric.h"
+
+#include "itkImageRegionConstIterator.h"
+#include "itkMinimumMaximumImageCalculator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace itk
+{
+
+// Padding of the histograms, so that the cubic B-spline window of the
+//   extreme values stays inside
+static const int ThreadedMattesHistogramPadding = 2;
+
+template <class TFixedImage, class TMovingImage, class TInternalComputationValueType>
+ThreadedMattesMutualInformationImageToImageMetric<TFixedImage, TMovingImage, TInternalComputationValueType>
+::ThreadedMattesMutualInformationImageToImageMetric( void )
+{
+  m_NumberOfHistogramBins = 50;
+  m_SampleBatchSize = 256;
+
+  m_FixedImageBinSize = 0.0;
+  m_FixedImageNormalizedMin = 0.0;
+  m_MovingImageBinSize = 0.0;
+  m_MovingImageNormalizedMin = 0.0;
+
+  m_SampleThreader = MultiThreader::New();
+  m_NumberOfSampleThreads = 1;
+
+  m_ThreadTask = JOINT_PDF_TASK;
+  m_ComputeGradients = false;
+  m_NumberOfValidSamples = 0;
+
+  // The gradient image is only needed by the derivative
+  this->SetComputeGradient( true );
+}
+
+template <class TFixedImage, class TMovingImage, class TInternalComputationValueType>
+ThreadedMattesMutualInformationImageToImageMetric<TFixedImage, TMovingImage, TInternalComputationValueType>
+::~ThreadedMattesMutualInformationImageToImageMetric( void )
+{
+}
+
+template <class TFixedImage, class TMovingImage, class TInternalComputationValueType>
+void
+ThreadedMattesMutualInformationImageToImageMetric<TFixedImage, TMovingImage, TInternalComputationValueType>
+::Initialize( void ) throw ( ExceptionObject )
+{
+  this->Superclass::Initialize();
+
+  // Same intensity ranges as MattesMutualInformationImageToImageMetric
+  typedef MinimumMaximumImageCalculator<FixedImageType>  FixedMinMaxCalcType;
+  typedef MinimumMaximumImageCalculator<MovingImageType> MovingMinMaxCalcType;
+  typename FixedMinMaxCalcType::Pointer fixedCalc = FixedMinMaxCalcType::New();
+  fixedCalc->SetImage( this->m_FixedImage );
+  fixedCalc->SetRegion( this->GetFixedImageRegion() );
+  fixedCalc->Compute();
+  typename MovingMinMaxCalcType::Pointer movingCalc = MovingMinMaxCalcType::New();
+  movingCalc->SetImage( this->m_MovingImage );
+  movingCalc->Compute();
+
+  const double numberOfBins = m_NumberOfHistogramBins - 2 * ThreadedMattesHistogramPadding;
+  const double fixedMin = fixedCalc->GetMinimum();
+  const double movingMin = movingCalc->GetMinimum();
+  m_FixedImageBinSize = ( fixedCalc->GetMaximum() - fixedMin ) / numberOfBins;
+  m_MovingImageBinSize = ( movingCalc->GetMaximum() - movingMin ) / numberOfBins;
+  if( m_FixedImageBinSize <= 0 )
+    {
+    m_FixedImageBinSize = 1.0;
+    }
+  if( m_MovingImageBinSize <= 0 )
+    {
+    m_MovingImageBinSize = 1.0;
+    }
+  m_FixedImageNormalizedMin = fixedMin / m_FixedImageBinSize - ThreadedMattesHistogramPadding;
+  m_MovingImageNormalizedMin = movingMin / m_MovingImageBinSize - ThreadedMattesHistogramPadding;
+
+  // The histogram row of a fixed image sample does not depend on the transform
+  const unsigned int numberOfSamples = this->m_FixedImageSamples.size();
+  m_FixedImageSampleBins.resize( numberOfSamples );
+  for( unsigned int i = 0; i < numberOfSamples; i++ )
+    {
+    double windowTerm = this->m_FixedImageSamples[i].value / m_FixedImageBinSize
+      - m_FixedImageNormalizedMin;
+    int bin = static_cast<int>( vcl_floor( windowTerm ) );
+    bin = std::max( bin, ThreadedMattesHistogramPadding );
+    bin = std::min( bin, static_cast<int>( m_NumberOfHistogramBins ) - ThreadedMattesHistogramPadding - 1 );
+    m_FixedImageSampleBins[i] = bin;
+    }
+
+  m_NumberOfSampleThreads = std::max( 1u, static_cast<unsigned int>( this->GetNumberOfThreads() ) );
+  m_NumberOfSampleThreads = std::min( m_NumberOfSampleThreads,
+                                      std::max( 1u, numberOfSamples ) );
+  m_SampleThreader->SetNumberOfThreads( m_NumberOfSampleThreads );
+
+  const unsigned int histogramSize = m_NumberOfHistogramBins * m_NumberOfHistogramBins;
+  m_ThreadJointPDFs.assign( m_NumberOfSampleThreads,
+                            std::vector<InternalComputationValueType>( histogramSize ) );
+  m_ThreadDerivatives.assign( m_NumberOfSampleThreads,
+                              std::vector<InternalComputationValueType>( this->m_NumberOfParameters ) );
+  m_ThreadMappedSamples.assign( m_NumberOfSampleThreads, std::vector<MappedSample>() );
+  m_JointPDF.resize( histogramSize );
+  m_PRatio.resize( histogramSize );
+  m_MovingImageMarginalPDF.resize( m_NumberOfHistogramBins );
+  m_Derivative.resize( this->m_NumberOfParameters );
+}
+
+template <class TFixedImage, class TMovingImage, class TInternalComputationValueType>
+void
+ThreadedMattesMutualInformationImageToImageMetric<TFixedImage, TMovingImage, TInternalComputationValueType>
+::SplitRange( unsigned int size, unsigned int threadId, unsigned int numberOfThreads,
+              unsigned int & begin, unsigned int & end )
+{
+  begin = static_cast<unsigned int>( ( static_cast<double>( size ) * threadId ) / numberOfThreads );
+  end = static_cast<unsigned int>( ( static_cast<double>( size ) * ( threadId + 1 ) ) / numberOfThreads );
+}
+
+template <class TFixedImage, class TMovingImage, class TInternalComputationValueType>
+TInternalComputationValueType
+ThreadedMattesMutualInformationImageToImageMetric<TFixedImage, TMovingImage, TInternalComputationValueType>
+::CubicBSpline( InternalComputationValueType x )
+{
+  const InternalComputationValueType absX = vcl_abs( x );
+  if( absX < 1 )
+    {
+    return ( 4 - 6 * absX * absX + 3 * absX * absX * absX ) / 6;
+    }
+  if( absX < 2 )
+    {
+    return ( 2 - absX ) * ( 2 - absX ) * ( 2 - absX ) / 6;
+    }
+  return 0;
+}
+
+template <class TFixedImage, class TMovingImage, class TInternalComputationValueType>
+TInternalComputationValueType
+ThreadedMattesMutualInformationImageToImageMetric<TFixedImage, TMovingImage, TInternalComputationValueType>
+::CubicBSplineDerivative( InternalComputationValueType x )
+{
+  const InternalComputationValueType absX = vcl_abs( x );
+  InternalComputationValueType value = 0;
+  if( absX < 1 )
+    {
+    value = ( -4 * absX + 3 * absX * absX ) / 2;
+    }
+  else if( absX < 2 )
+    {
+    value = -( 2 - absX ) * ( 2 - absX ) / 2;
+    }
+  return ( x < 0 ) ? -value : value;
+}
+
+template <class TFixedImage, class TMovingImage, class TInternalComputationValueType>
+bool
+ThreadedMattesMutualInformationImageToImageMetric<TFixedImage, TMovingImage, TInternalComputationValueType>
+::MapSample( unsigned int sample, bool computeGradient, MappedSample & mapped ) const
+{
+  const MovingImagePointType mappedPoint =
+    this->m_Transform->TransformPoint( this->m_FixedImageSamples[sample].point );
+
+  if( this->m_MovingImageMask && !this->m_MovingImageMask->IsInside( mappedPoint ) )
+    {
+    return false;
+    }
+  if( !this->m_Interpolator->IsInsideBuffer( mappedPoint ) )
+    {
+    return false;
+    }
+  if( computeGradient )
+    {
+    typename GradientImageType::IndexType index;
+    if( !this->m_GradientImage->TransformPhysicalPointToIndex( mappedPoint, index ) )
+      {
+      return false;
+      }
+    mapped.MovingImageGradient = this->m_GradientImage->GetPixel( index );
+    }
+
+  const double movingValue = this->m_Interpolator->Evaluate( mappedPoint );
+  mapped.Sample = sample;
+  mapped.MovingParzenWindowTerm = static_cast<InternalComputationValueType>(
+      movingValue / m_MovingImageBinSize - m_MovingImageNormalizedMin );
+  return true;
+}
+
+template <class TFixedImage, class TMovingImage, class TInternalComputationValueType>
+void
+ThreadedMattesMutualInformationImageToImageMetric<TFixedImage, TMovingImage, TInternalComputationValueType>
+::ThreadedComputeJointPDF( unsigned int threadId, unsigned int numberOfThreads ) const
+{
+  unsigned int begin;
+  unsigned int end;
+  SplitRange( this->m_FixedImageSamples.size(), threadId, numberOfThreads, begin, end );
+
+  const int                      numberOfBins = m_NumberOfHistogramBins;
+  InternalComputationValueType * jointPDF = &m_ThreadJointPDFs[threadId][0];
+  std::fill( m_ThreadJointPDFs[threadId].begin(), m_ThreadJointPDFs[threadId].end(),
+             static_cast<InternalComputationValueType>( 0 ) );
+
+  std::vector<MappedSample> & mappedSamples = m_ThreadMappedSamples[threadId];
+  mappedSamples.clear();
+  MappedSample mapped;
+  for( unsigned int batchBegin = begin; batchBegin < end; batchBegin += m_SampleBatchSize )
+    {
+    // Map the samples of the batch, then accumulate them
+    const unsigned int batchEnd = std::min( end, batchBegin + m_SampleBatchSize );
+    const unsigned int firstMapped = mappedSamples.size();
+    for( unsigned int sample = batchBegin; sample < batchEnd; sample++ )
+      {
+      if( this->MapSample( sample, m_ComputeGradients, mapped ) )
+        {
+        mappedSamples.push_back( mapped );
+        }
+      }
+    for( unsigned int i = firstMapped; i < mappedSamples.size(); i++ )
+      {
+      const InternalComputationValueType term = mappedSamples[i].MovingParzenWindowTerm;
+      int movingIndex = static_cast<int>( vcl_floor( term ) );
+      movingIndex = std::max( movingIndex, ThreadedMattesHistogramPadding );
+      movingIndex = std::min( movingIndex, numberOfBins - ThreadedMattesHistogramPadding - 1 );
+
+      InternalComputationValueType * row = jointPDF
+        + m_FixedImageSampleBins[mappedSamples[i].Sample] * numberOfBins + movingIndex - 1;
+      const InternalComputationValueType arg = static_cast<InternalComputationValueType>( movingIndex - 1 ) - term;
+      for( int k = 0; k < 4; k++ )
+        {
+        row[k] += CubicBSpline( arg + k );
+        }
+      }
+    }
+}
+
+template <class TFixedImage, class TMovingImage, class TInternalComputationValueType>
+void
+ThreadedMattesMutualInformationImageToImageMetric<TFixedImage, TMovingImage, TInternalComputationValueType>
+::ThreadedReduceJointPDF( unsigned int threadId, unsigned int numberOfThreads ) const
+{
+  unsigned int begin;
+  unsigned int end;
+  SplitRange( m_JointPDF.size(), threadId, numberOfThreads, begin, end );
+  for( unsigned int i = begin; i < end; i++ )
+    {
+    InternalComputationValueType sum = 0;
+    for( unsigned int t = 0; t < m_ThreadJointPDFs.size(); t++ )
+      {
+      sum += m_ThreadJointPDFs[t][i];
+      }
+    m_JointPDF[i] = sum;
+    }
+}
+
+template <class TFixedImage, class TMovingImage, class TInternalComputationValueType>
+void
+ThreadedMattesMutualInformationImageToImageMetric<TFixedImage, TMovingImage, TInternalComputationValueType>
+::ThreadedComputeDerivative( unsigned int threadId, unsigned int numberOfThreads ) const
+{
+  const unsigned int             numberOfParameters = this->m_NumberOfParameters;
+  const int                      numberOfBins = m_NumberOfHistogramBins;
+  InternalComputationValueType * derivative = &m_ThreadDerivatives[threadId][0];
+  std::fill( m_ThreadDerivatives[threadId].begin(), m_ThreadDerivatives[threadId].end(),
+             static_cast<InternalComputationValueType>( 0 ) );
+
+  // Each thread goes through the samples it mapped, or through all of
+  //   them when it is the only one
+  unsigned int firstThread = threadId;
+  unsigned int lastThread = threadId + 1;
+  if( numberOfThreads == 1 )
+    {
+    firstThread = 0;
+    lastThread = m_ThreadMappedSamples.size();
+    for( unsigned int t = 1; t < m_ThreadDerivatives.size(); t++ )
+      {
+      std::fill( m_ThreadDerivatives[t].begin(), m_ThreadDerivatives[t].end(),
+                 static_cast<InternalComputationValueType>( 0 ) );
+      }
+    }
+
+#if ITK_VERSION_MAJOR >= 4
+  TransformJacobianType jacobian( MovingImageDimension, numberOfParameters );
+#endif
+  std::vector<InternalComputationValueType> weights( m_SampleBatchSize );
+  for( unsigned int t = firstThread; t < lastThread; t++ )
+    {
+    const std::vector<MappedSample> & mappedSamples = m_ThreadMappedSamples[t];
+    for( unsigned int batchBegin = 0; batchBegin < mappedSamples.size(); batchBegin += m_SampleBatchSize )
+      {
+      const unsigned int batchEnd = std::min( static_cast<unsigned int>( mappedSamples.size() ),
+                                              batchBegin + m_SampleBatchSize );
+      // Derivative of the metric with respect to the moving value of each
+      //   sample of the batch: only the histogram is read
+      for( unsigned int i = batchBegin; i < batchEnd; i++ )
+        {
+        const InternalComputationValueType term = mappedSamples[i].MovingParzenWindowTerm;
+        int movingIndex = static_cast<int>( vcl_floor( term ) );
+        movingIndex = std::max( movingIndex, ThreadedMattesHistogramPadding );
+        movingIndex = std::min( movingIndex, numberOfBins - ThreadedMattesHistogramPadding - 1 );
+
+        const InternalComputationValueType * pRatio = &m_PRatio[0]
+          + m_FixedImageSampleBins[mappedSamples[i].Sample] * numberOfBins + movingIndex - 1;
+        const InternalComputationValueType arg = static_cast<InternalComputationValueType>( movingIndex - 1 ) - term;
+        InternalComputationValueType weight = 0;
+        for( int k = 0; k < 4; k++ )
+          {
+          weight += CubicBSplineDerivative( arg + k ) * pRatio[k];
+          }
+        weights[i - batchBegin] = weight;
+        }
+      // Then through the transform
+      for( unsigned int i = batchBegin; i < batchEnd; i++ )
+        {
+        const InternalComputationValueType weight = weights[i - batchBegin];
+        if( weight == 0 )
+          {
+          continue;
+          }
+#if ITK_VERSION_MAJOR >= 4
+        this->m_Transform->ComputeJacobianWithRespectToParameters(
+          this->m_FixedImageSamples[mappedSamples[i].Sample].point, jacobian );
+#else
+        const TransformJacobianType & jacobian =
+          this->m_Transform->GetJacobian( this->m_FixedImageSamples[mappedSamples[i].Sample].point );
+#endif
+        const GradientPixelType & gradient = mappedSamples[i].MovingImageGradient;
+        for( unsigned int p = 0; p < numberOfParameters; p++ )
+          {
+          InternalComputationValueType innerProduct = 0;
+          for( unsigned int d = 0; d < MovingImageDimension; d++ )
+            {
+            innerProduct += jacobian[d][p] * gradient[d];
+            }
+          derivative[p] += weight * innerProduct;
+          }
+        }
+      }
+    }
+}
+
+template <class TFixedImage, class TMovingImage, class TInternalComputationValueType>
+void
+ThreadedMattesMutualInformationImageToImageMetric<TFixedImage, TMovingImage, TInternalComputationValueType>
+::ThreadedReduceDerivative( unsigned int threadId, unsigned int numberOfThreads ) const
+{
+  unsigned int begin;
+  unsigned int end;
+  SplitRange( m_Derivative.size(), threadId, numberOfThreads, begin, end );
+  for( unsigned int p = begin; p < end; p++ )
+    {
+    InternalComputationValueType sum = 0;
+    for( unsigned int t = 0; t < m_ThreadDerivatives.size(); t++ )
+      {
+      sum += m_ThreadDerivatives[t][p];
+      }
+    m_Derivative[p] = sum;
+    }
+}
+
+template <class TFixedImage, class TMovingImage, class TInternalComputationValueType>
+ITK_THREAD_RETURN_TYPE
+ThreadedMattesMutualInformationImageToImageMetric<TFixedImage, TMovingImage, TInternalComputationValueType>
+::ThreaderCallback( void * arg )
+{
+  MultiThreader::ThreadInfoStruct * info = static_cast<MultiThreader::ThreadInfoStruct *>( arg );
+  const Self *                      metric = static_cast<const Self *>( info->UserData );
+  const unsigned int                threadId = info->ThreadID;
+  const unsigned int                numberOfThreads = info->NumberOfThreads;
+
+  switch( metric->m_ThreadTask )
+    {
+    case JOINT_PDF_TASK:
+      metric->ThreadedComputeJointPDF( threadId, numberOfThreads );
+      break;
+    case REDUCE_JOINT_PDF_TASK:
+      metric->ThreadedReduceJointPDF( threadId, numberOfThreads );
+      break;
+    case DERIVATIVE_TASK:
+      metric->ThreadedComputeDerivative( threadId, numberOfThreads );
+      break;
+    case REDUCE_DERIVATIVE_TASK:
+      metric->ThreadedReduceDerivative( threadId, numberOfThreads );
+      break;
+    }
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template <class TFixedImage, class TMovingImage, class TInternalComputationValueType>
+void
+ThreadedMattesMutualInformationImageToImageMetric<TFixedImage, TMovingImage, TInternalComputationValueType>
+::RunThreads( ThreadTaskEnumType task, unsigned int numberOfThreads ) const
+{
+  m_ThreadTask = task;
+  if( numberOfThreads <= 1 )
+    {
+    MultiThreader::ThreadInfoStruct info;
+    info.ThreadID = 0;
+    info.NumberOfThreads = 1;
+    info.UserData = const_cast<Self *>( this );
+    ThreaderCallback( &info );
+    return;
+    }
+  m_SampleThreader->SetNumberOfThreads( numberOfThreads );
+  m_SampleThreader->SetSingleMethod( ThreaderCallback, const_cast<Self *>( this ) );
+  m_SampleThreader->SingleMethodExecute();
+}
+
+template <class TFixedImage, class TMovingImage, class TInternalComputationValueType>
+typename ThreadedMattesMutualInformationImageToImageMetric<TFixedImage, TMovingImage,
+                                                           TInternalComputationValueType>::MeasureType
+ThreadedMattesMutualInformationImageToImageMetric<TFixedImage, TMovingImage, TInternalComputationValueType>
+::ComputeJointPDF( const ParametersType & parameters, bool computeGradients ) const
+{
+  this->SetTransformParameters( parameters );
+
+  m_ComputeGradients = computeGradients;
+  this->RunThreads( JOINT_PDF_TASK, m_NumberOfSampleThreads );
+  this->RunThreads( REDUCE_JOINT_PDF_TASK, m_NumberOfSampleThreads );
+
+  m_NumberOfValidSamples = 0;
+  for( unsigned int t = 0; t < m_ThreadMappedSamples.size(); t++ )
+    {
+    m_NumberOfValidSamples += m_ThreadMappedSamples[t].size();
+    }
+  if( m_NumberOfValidSamples < this->m_FixedImageSamples.size() / 16 )
+    {
+    itkExceptionMacro( "Too many samples map outside moving image buffer: "
+                       << m_NumberOfValidSamples << " / "
+                       << this->m_FixedImageSamples.size() << std::endl );
+    }
+  this->m_NumberOfPixelsCounted = m_NumberOfValidSamples;
+
+  // Each sample adds up to one in its row
+  const unsigned int                 numberOfBins = m_NumberOfHistogramBins;
+  const InternalComputationValueType normalization =
+    static_cast<InternalComputationValueType>( 1.0 / m_NumberOfValidSamples );
+  std::fill( m_MovingImageMarginalPDF.begin(), m_MovingImageMarginalPDF.end(),
+             static_cast<InternalComputationValueType>( 0 ) );
+  for( unsigned int i = 0; i < m_JointPDF.size(); i++ )
+    {
+    m_JointPDF[i] *= normalization;
+    m_MovingImageMarginalPDF[i % numberOfBins] += m_JointPDF[i];
+    }
+
+  const double closeToZero = 1e-16;
+  double       mutualInformation = 0.0;
+  for( unsigned int f = 0; f < numberOfBins; f++ )
+    {
+    const InternalComputationValueType * row = &m_JointPDF[f * numberOfBins];
+    InternalComputationValueType *       pRatio = &m_PRatio[f * numberOfBins];
+    double                               fixedMarginal = 0.0;
+    for( unsigned int m = 0; m < numberOfBins; m++ )
+      {
+      fixedMarginal += row[m];
+      }
+    for( unsigned int m = 0; m < numberOfBins; m++ )
+      {
+      const double jointValue = row[m];
+      const double movingMarginal = m_MovingImageMarginalPDF[m];
+      pRatio[m] = 0;
+      if( jointValue > closeToZero && movingMarginal > closeToZero )
+        {
+        const double ratio = vcl_log( jointValue / movingMarginal );
+        pRatio[m] = static_cast<InternalComputationValueType>( ratio );
+        if( fixedMarginal > closeToZero )
+          {
+          mutualInformation += jointValue * ( ratio - vcl_log( fixedMarginal ) );
+          }
+        }
+      }
+    }
+  return static_cast<MeasureType>( -mutualInformation );
+}
+
+template <class TFixedImage, class TMovingImage, class TInternalComputationValueType>
+void
+ThreadedMattesMutualInformationImageToImageMetric<TFixedImage, TMovingImage, TInternalComputationValueType>
+::ComputeDerivative( DerivativeType & derivative ) const
+{
+#if ITK_VERSION_MAJOR >= 4
+  this->RunThreads( DERIVATIVE_TASK, m_NumberOfSampleThreads );
+#else
+  // The Jacobian of an ITK 3 transform is shared
+  this->RunThreads( DERIVATIVE_TASK, 1 );
+#endif
+  this->RunThreads( REDUCE_DERIVATIVE_TASK, m_NumberOfSampleThreads );
+
+  // - d MI / d mu = sum over the samples of
+  //   B'(m - t) log( p(f,m) / p(m) ) grad(M) J / ( N bin size )
+  const double factor = 1.0 / ( m_NumberOfValidSamples * m_MovingImageBinSize );
+  derivative = DerivativeType( this->m_NumberOfParameters );
+  for( unsigned int p = 0; p < this->m_NumberOfParameters; p++ )
+    {
+    derivative[p] = factor * m_Derivative[p];
+    }
+}
+
+template <class TFixedImage, class TMovingImage, class TInternalComputationValueType>
+typename ThreadedMattesMutualInformationImageToImageMetric<TFixedImage, TMovingImage,
+                                                           TInternalComputationValueType>::MeasureType
+ThreadedMattesMutualInformationImageToImageMetric<TFixedImage, TMovingImage, TInternalComputationValueType>
+::GetValue( const ParametersType & parameters ) const
+{
+  return this->ComputeJointPDF( parameters, false );
+}
+
+template <class TFixedImage, class TMovingImage, class TInternalComputationValueType>
+void
+ThreadedMattesMutualInformationImageToImageMetric<TFixedImage, TMovingImage, TInternalComputationValueType>
+::GetDerivative( const ParametersType & parameters, DerivativeType & derivative ) const
+{
+  this->ComputeJointPDF( parameters, true );
+  this->ComputeDerivative( derivative );
+}
+
+template <class TFixedImage, class TMovingImage, class TInternalComputationValueType>
+void
+ThreadedMattesMutualInformationImageToImageMetric<TFixedImage, TMovingImage, TInternalComputationValueType>
+::GetValueAndDerivative( const ParametersType & parameters, MeasureType & value,
+                         DerivativeType & derivative ) const
+{
+  value = this->ComputeJointPDF( parameters, true );
+  this->ComputeDerivative( derivative );
+}
+
+template <class TFixedImage, class TMovingImage, class TInternalComputationValueType>
+void
+ThreadedMattesMutualInformationImageToImageMetric<TFixedImage, TMovingImage, TInternalComputationValueType>
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "Number of Histogram Bins = " << m_NumberOfHistogramBins << std::endl;
+  os << indent << "Sample Batch Size = " << m_SampleBatchSize << std::endl;
+  os << indent << "Number of Sample Threads = " << m_NumberOfSampleThreads << std::endl;
+  os << indent << "Fixed Image Bin Size = " << m_FixedImageBinSize << std::endl;
+  os << indent << "Moving Image Bin Size = " << m_MovingImageBinSize << std::endl;
+}
+
+}
+
+#endif
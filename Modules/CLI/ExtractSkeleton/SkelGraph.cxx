@@ -743,6 +743,19 @@ void SkelGraph::Sample_along_axis(int n_dim, list<point> * axis_points)
 // Private Methods
 // -------------------------------------------------------------------------
 
+static bool point_xyz_less(const point & p1, const point & p2)
+{
+  if( p1.x != p2.x )
+    {
+    return p1.x < p2.x;
+    }
+  if( p1.y != p2.y )
+    {
+    return p1.y < p2.y;
+    }
+  return p1.z < p2.z;
+}
+
 void SkelGraph::find_endpoints()
 // find all endpoints in image
 {
@@ -750,14 +763,16 @@ void SkelGraph::find_endpoints()
 
   endpoints = new list<point>;
 
-  // search image
-  for( int x = 1; x < dim[0] - 1; x++ )
+  // search image in memory order, then sort the endpoints by x, y, z as
+  // the graph extraction follows them in this order
+  for( int z = 1; z < dim[2] - 1; z++ )
     {
     for( int y = 1; y < dim[1] - 1; y++ )
       {
-      for( int z = 1; z < dim[2] - 1; z++ )
+      const unsigned char * row = image + dim[0] * ( y + dim[1] * z );
+      for( int x = 1; x < dim[0] - 1; x++ )
         {
-        if( image[x + dim[0] * ( y + dim[1] * z )] && endpoint_Test(x, y, z) )
+        if( row[x] && endpoint_Test(x, y, z) )
           {
           // x,y,z is an endpoint
           elem.x = x;
@@ -769,6 +784,7 @@ void SkelGraph::find_endpoints()
         }
       }
     }
+  endpoints->sort(point_xyz_less);
 
 }
 
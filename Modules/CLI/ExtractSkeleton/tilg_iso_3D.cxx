@@ -20,9 +20,14 @@
 /* Autor:       Patrick Drozz  IIIC/9   ETHZ                          */
 // adapted to C++: Martin Styner 20.July.2000
 // integrated into slicer: Stephen Aylward, 20, Aug, 2007
+// border voxel list and multithreading: only the voxels of the object
+// border are tested, the tests of a subcycle are shared out between the
+// threads.
 /*****************************************************************************/
-#include <cstdio>
+#include "itkMultiThreader.h"
+
 #include <cstdlib>
+#include <vector>
 
 /********************************  Konstanten  *******************************/
 #define LIM  1 /* Voxelwert >= LIM => Objekt (Input-Bild) */
@@ -34,97 +39,87 @@
 #define P(n, x, y, z) n[(x) + nx * ( (y) + (z) * ny)]
 
 /**************************** globale Variablen  *****************************/
+// read-only while the threads test the voxels
 static int            nx, ny, nz, nzz;
 static unsigned char *workbuf, *result;
 static int            f_tab[26];
-static unsigned char  p[5][5][5];
+// nb_tab[b]: code of the 26-neighbors of the voxel of bit b in the 3x3x3 code
+static int            nb_tab[27];
+// bit_tab[i]: number of 1s in the byte i
+static unsigned char  bit_tab[256];
 
 /*******************************  Hilfsprozeduren ****************************/
 int bitcount(int i)
 /* gibt die Anzahl 1-en in i zurueck */
 {
-  int c = 0;
-  int m;
-
-  while( i != 0 )
-    {
-    c++;
-    m = i - 1;
-    i &= m;
-    }
-
-  return c;
+  return bit_tab[i & 255] + bit_tab[(i >> 8) & 255]
+    + bit_tab[(i >> 16) & 255] + bit_tab[(i >> 24) & 255];
 }
 
 void init_data()
-/* initialisiert p */
+/* initialisiert nb_tab und bit_tab */
 {
-  int x, y, z;
+  int x, y, z, i, j, k;
 
-  for( z = 0; z < 5; z++ )
+  for( z = 0; z < 3; z++ )
     {
-    for( y = 0; y < 5; y++ )
+    for( y = 0; y < 3; y++ )
       {
-      for( x = 0; x < 5; x++ )
+      for( x = 0; x < 3; x++ )
         {
-        p[x][y][z] = BG;
+        int nb = 0;
+        for( k = 0; k < 3; k++ )
+          {
+          for( j = 0; j < 3; j++ )
+            {
+            for( i = 0; i < 3; i++ )
+              {
+              if( abs(i - x) <= 1 && abs(j - y) <= 1 && abs(k - z) <= 1 )
+                {
+                nb |= 1 << (i + 3 * j + 9 * k);
+                }
+              }
+            }
+          }
+        nb_tab[x + 3 * y + 9 * z] = nb & ~(1 << (x + 3 * y + 9 * z));
         }
       }
     }
-}
-
-void mark(int x, int y, int z)
-/* markiert alles was von x,y,z aus erreichbar ist */
-/* einfache rekursive Version                      */
-{
-  int i, j, k;
-
-  p[x][y][z] = BG;
-  for( k = z - 1; k < z + 2; k++ )
+  for( i = 0; i < 256; i++ )
     {
-    for( j = y - 1; j < y + 2; j++ )
+    int c = 0;
+    for( j = i; j != 0; j &= j - 1 )
       {
-      for( i = x - 1; i < x + 2; i++ )
-        {
-        if( p[i][j][k] == OBJ )
-          {
-          mark(i, j, k);
-          }
-        }
+      c++;
       }
+    bit_tab[i] = c;
     }
 }
 
 int count_components(int nc)
 /* zaehlt die Komponenten im 26-Sinn des nc's */
-/* einfache rekursive Version                 */
+/* Wellenausbreitung mit nb_tab, ohne globalen Zwischenspeicher, damit */
+/* die Threads sie gleichzeitig aufrufen koennen                       */
 {
-  int x, y, z, count;
+  int count = 0;
 
-  for( z = 1; z < 4; z++ )
+  while( nc != 0 )
     {
-    for( y = 1; y < 4; y++ )
+    count++;
+    int front = nc & -nc;
+    nc &= ~front;
+    while( front != 0 )
       {
-      for( x = 1; x < 4; x++ )
+      int next = 0;
+      for( int b = 0; b < 27; b++ )
         {
-        p[x][y][z] = (nc & 1) ? OBJ : BG;
-        nc /= 2;
-        }
-      }
-    }
-  count = 0;
-  for( z = 1; z < 4; z++ )
-    {
-    for( y = 1; y < 4; y++ )
-      {
-      for( x = 1; x < 4; x++ )
-        {
-        if( p[x][y][z] != BG )
+        if( front & (1 << b) )
           {
-          count++;
-          mark(x, y, z);
+          next |= nb_tab[b];
           }
         }
+      front = next & nc;
+      nc &= ~front;
       }
     }
   return count;
@@ -592,6 +587,134 @@ int Tilg_Test_3(int c, int d, int type)
   return OBJ;
 }
 
+namespace
+{
+
+// Border voxels (object voxels with a background 6-neighbor), the only ones
+// that a subcycle can remove.
+struct BorderList
+  {
+  std::vector<int>  Voxels;
+  std::vector<bool> InList;
+
+  void Add(int i)
+    {
+    if( !InList[i] )
+      {
+      InList[i] = true;
+      Voxels.push_back(i);
+      }
+    }
+
+  // removes the voxels from the image and adds their object 6-neighbors
+  void Remove(const std::vector<int> & removed)
+    {
+    const int offsets[6] = { -1, 1, -nx, nx, -nzz, nzz };
+
+    for( size_t k = 0; k < removed.size(); k++ )
+      {
+      result[removed[k]] = BG;
+      }
+    for( size_t k = 0; k < removed.size(); k++ )
+      {
+      for( int o = 0; o < 6; o++ )
+        {
+        if( result[removed[k] + offsets[o]] == OBJ )
+          {
+          this->Add(removed[k] + offsets[o]);
+          }
+        }
+      }
+    size_t n = 0;
+    for( size_t k = 0; k < Voxels.size(); k++ )
+      {
+      if( result[Voxels[k]] == OBJ )
+        {
+        Voxels[n++] = Voxels[k];
+        }
+      }
+    Voxels.resize(n);
+    }
+  };
+
+// A subcycle: the border voxels are shared out between the threads, that
+// test them on the image as it was at the start of the subcycle.
+struct SubcycleInfo
+  {
+  const std::vector<int> *        Voxels;
+  int                             Dir;
+  int                             DirMask;
+  int                             Type;
+  int                             Subfield; // -1 if all the voxels are tested
+  std::vector<std::vector<int> >  Removed;  // per thread
+  };
+
+ITK_THREAD_RETURN_TYPE SubcycleThreaderCallback( void * arg )
+{
+  itk::MultiThreader::ThreadInfoStruct * threadInfo =
+    static_cast<itk::MultiThreader::ThreadInfoStruct *>( arg );
+  SubcycleInfo * info = static_cast<SubcycleInfo *>( threadInfo->UserData );
+  const std::vector<int> & voxels = *info->Voxels;
+  std::vector<int> &       removed = info->Removed[threadInfo->ThreadID];
+
+  const size_t n = voxels.size();
+  const size_t begin = n * threadInfo->ThreadID / threadInfo->NumberOfThreads;
+  const size_t end = n * (threadInfo->ThreadID + 1) / threadInfo->NumberOfThreads;
+  for( size_t k = begin; k < end; k++ )
+    {
+    int i = voxels[k];
+    if( info->Subfield >= 0 )
+      {
+      int x = i % nx;
+      int y = (i / nx) % ny;
+      int z = i / nzz;
+      if( (x & 1) + 2 * (y & 1) + 4 * (z & 1) != info->Subfield )
+        {
+        continue;
+        }
+      }
+    int nc = Env_Code_3(i);
+    if( ( (~ nc) & info->DirMask) == info->DirMask )
+      {
+      if( bitcount(nc) > 2 )
+        {
+        if( Tilg_Test_3(nc, info->Dir, info->Type) == BG )
+          {
+          removed.push_back(i);
+          }
+        }
+      }
+    }
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+// returns the number of removed voxels
+int RunSubcycle(itk::MultiThreader * threader, BorderList & border,
+                int dir, int dirMask, int type, int subfield)
+{
+  SubcycleInfo info;
+
+  info.Voxels = &border.Voxels;
+  info.Dir = dir;
+  info.DirMask = dirMask;
+  info.Type = type;
+  info.Subfield = subfield;
+  info.Removed.resize(threader->GetNumberOfThreads() );
+  threader->SetSingleMethod(SubcycleThreaderCallback, &info);
+  threader->SingleMethodExecute();
+
+  // merged in thread order, the border list does not depend on the timing
+  std::vector<int> removed;
+  for( size_t t = 0; t < info.Removed.size(); t++ )
+    {
+    removed.insert(removed.end(), info.Removed[t].begin(), info.Removed[t].end() );
+    }
+  border.Remove(removed);
+  return static_cast<int>(removed.size() );
+}
+
+} // end of anonymous namespace
+
 void tilg_iso_3D(int dx, int dy, int dz,
                  unsigned char *data,
                  unsigned char *res,
@@ -602,15 +725,11 @@ void tilg_iso_3D(int dx, int dy, int dz,
 // if type == 0 -> full tilg
 {
 
-  int cnt = 0, cnt1 = 0;
-  int nc, x, y, z;
-  int end, i, dir, dir_mask;
-  // int free_mask;
-  int *list;
+  int cnt = 0;
+  int x, y, z;
+  int end, i, dir;
   int  dir_tab[26];
 
-  // int b[3][3][3];
-
   nx = dx; ny = dy; nz = dz;
   init_data();
   /* Speicher allozieren */
@@ -618,12 +737,6 @@ void tilg_iso_3D(int dx, int dy, int dz,
 
   workbuf = data;
   nzz = nx * ny;
-  /* Speicher allozieren */
-  if( (list = (int *) malloc(nzz * nz * sizeof(int) / 4) ) == NULL )
-    {
-    printf("out of memory\n");
-    return;
-    }
   /* Arbeitskopie des Bildes erstellen und binaerisieren */
   end = nx * ny * nz;
   for( i = 0; i < end; i++ )
@@ -693,63 +806,46 @@ void tilg_iso_3D(int dx, int dy, int dz,
   f_tab[16] =   131072;    /* 17 */
   f_tab[17] =      512;    /*  9 */
 
+  /* Randvoxel suchen: nur sie koennen getilgt werden */
+  /* (jede Richtungsmaske verlangt einen leeren 6-Nachbarn) */
+  BorderList border;
+  border.InList.resize(end, false);
+  for( i = nzz + nx + 1; i < end - nzz - nx - 1; i++ )
+    {
+    if( result[i] == OBJ &&
+        (result[i - 1] == BG || result[i + 1] == BG ||
+         result[i - nx] == BG || result[i + nx] == BG ||
+         result[i - nzz] == BG || result[i + nzz] == BG) )
+      {
+      border.Add(i);
+      }
+    }
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+
   /* eigentliches Bildparsing */
-  end = end - nzz - nx - 1;
+  /* in einem Subzyklus haengt die Tilgbarkeit nur vom Bild zu Beginn des */
+  /* Subzyklus ab: die Voxel werden parallel getestet                     */
   cnt = 1;
   while( cnt )
     {
     cnt = 0;
     for( dir = 0; dir < 18; dir++ )
       {
-      cnt1 = 0;
-      dir_mask = dir_tab[dir];
-      for( i = nzz + nx + 1; i < end; i++ )
-        {
-        if( result[i] == OBJ )
-          {
-          nc = Env_Code_3(i);
-          if( ( (~ nc) & dir_mask) == dir_mask )
-            {
-            if( bitcount(nc) > 2 )
-              {
-              if( Tilg_Test_3(nc, dir, type) == BG )
-                {
-                list[cnt1++] = i;
-                }
-              }
-            }
-          }
-        }
-      /* Voxel der Liste loeschen */
-      for( i = 0; i < cnt1; i++ )
-        {
-        result[list[i]] = BG;
-        }
-      cnt += cnt1;
+      cnt += RunSubcycle(threader, border, dir, dir_tab[dir], type, -1);
       }
     }
 
-  /* sequentiell maximal Verduennen */
+  /* maximal Verduennen, in 8 Teilfeldern (Paritaet von x,y,z):       */
+  /* die Voxel eines Teilfeldes sind keine 26-Nachbarn, ihre parallele */
+  /* Tilgung ist gleichwertig zu einer sequentiellen                   */
   cnt = 1;
   while( cnt )
     {
     cnt = 0;
-    for( i = nzz + nx + 1; i < end; i++ )
+    for( int subfield = 0; subfield < 8; subfield++ )
       {
-      if( result[i] == OBJ )
-        {
-        nc = Env_Code_3(i);
-        if( bitcount(nc) > 2 )
-          {
-          if( Tilg_Test_3(nc, 18, type) == BG )
-            {
-            cnt++;
-            result[i] = BG;
-            }
-          }
-        }
+      cnt += RunSubcycle(threader, border, 18, 0, type, subfield);
       }
     }
-
-  free(list);
 }
@@ -33,6 +33,195 @@
 #include "vtkXMLPolyDataReader.h"
 #include "vtkTransform.h"
 #include "vtkXMLPolyDataWriter.h"
+#include "vtkMultiThreader.h"
+
+#include <cmath>
+#include <vector>
+
+namespace
+{
+
+enum LabelClassType
+{
+  NoLabelClass = 0,
+  PassLabelClass,
+  NotPassLabelClass
+};
+
+enum LineSelectionType
+{
+  RejectedLine = 0,
+  SelectedLine,
+  ShortLine
+};
+
+// Shared by the threads that select the lines and copy them. Each thread
+// processes a contiguous range of lines.
+struct LabelSelectInfo
+{
+  vtkPoints*    Points;
+  vtkDataArray* Tensors;
+  short*        Labels;
+  int           Extent[6];
+  double        RASToIJK[3][4];
+  // Class of each short label, indexed by label - VTK_SHORT_MIN
+  std::vector<unsigned char> LabelClasses;
+  // If there is no label not to pass through, a line is selected as soon
+  // as it reaches a label to pass through
+  bool          StopAtPass;
+
+  vtkIdType*             Cells;
+  std::vector<vtkIdType> CellLocations;
+  std::vector<unsigned char> Selection;
+
+  std::vector<vtkIdType> ThreadNumberOfCells;
+  std::vector<vtkIdType> ThreadNumberOfPoints;
+  std::vector<vtkIdType> ThreadFirstCell;
+  std::vector<vtkIdType> ThreadFirstPoint;
+
+  vtkIdType*    OutCells;
+  vtkPoints*    OutPoints;
+  vtkDataArray* OutTensors;
+};
+
+//----------------------------------------------------------------------------
+void ThreadLineRange(vtkMultiThreader::ThreadInfo* threadInfo,
+                     vtkIdType numLines, vtkIdType& begin, vtkIdType& end)
+{
+  begin = numLines * threadInfo->ThreadID / threadInfo->NumberOfThreads;
+  end = numLines * (threadInfo->ThreadID + 1) / threadInfo->NumberOfThreads;
+}
+
+//----------------------------------------------------------------------------
+bool SelectLine(const LabelSelectInfo* info, vtkIdType npts, const vtkIdType* pts,
+                std::vector<double>& ijk)
+{
+  // Transform all the points of the line at once
+  ijk.resize(3 * npts);
+  const double (*m)[4] = info->RASToIJK;
+  double p[3];
+  for (vtkIdType j = 0; j < npts; ++j)
+    {
+    info->Points->GetPoint(pts[j], p);
+    double* pIJK = &ijk[3 * j];
+    pIJK[0] = m[0][0] * p[0] + m[0][1] * p[1] + m[0][2] * p[2] + m[0][3];
+    pIJK[1] = m[1][0] * p[0] + m[1][1] * p[1] + m[1][2] * p[2] + m[1][3];
+    pIJK[2] = m[2][0] * p[0] + m[2][1] * p[1] + m[2][2] * p[2] + m[2][3];
+    }
+
+  const int* ext = info->Extent;
+  const vtkIdType dimX = ext[1] - ext[0] + 1;
+  const vtkIdType dimXY = dimX * (ext[3] - ext[2] + 1);
+  bool pass = false;
+  for (vtkIdType j = 0; j < npts; ++j)
+    {
+    int pt[3];
+    pt[0] = static_cast<int>(floor(ijk[3 * j]));
+    pt[1] = static_cast<int>(floor(ijk[3 * j + 1]));
+    pt[2] = static_cast<int>(floor(ijk[3 * j + 2]));
+    if (pt[0] < ext[0] || pt[0] > ext[1] ||
+        pt[1] < ext[2] || pt[1] > ext[3] ||
+        pt[2] < ext[4] || pt[2] > ext[5])
+      {
+      // outside of the label map
+      continue;
+      }
+    short label = info->Labels[(pt[0] - ext[0]) + (pt[1] - ext[2]) * dimX
+                               + (pt[2] - ext[4]) * dimXY];
+    switch (info->LabelClasses[label - VTK_SHORT_MIN])
+      {
+      case NotPassLabelClass:
+        return false;
+      case PassLabelClass:
+        if (info->StopAtPass)
+          {
+          return true;
+          }
+        pass = true;
+        break;
+      default:
+        break;
+      }
+    }
+  return pass;
+}
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE SelectLinesThreaderCallback(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* threadInfo =
+    static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  LabelSelectInfo* info = static_cast<LabelSelectInfo*>(threadInfo->UserData);
+
+  vtkIdType begin, end;
+  ThreadLineRange(threadInfo, info->CellLocations.size(), begin, end);
+  vtkIdType numNewCells = 0;
+  vtkIdType numNewPts = 0;
+  std::vector<double> ijk;
+  for (vtkIdType inCellId = begin; inCellId < end; ++inCellId)
+    {
+    vtkIdType* cell = info->Cells + info->CellLocations[inCellId];
+    vtkIdType npts = cell[0];
+    if (npts < 2)
+      {
+      info->Selection[inCellId] = ShortLine;
+      continue; //skip this polyline
+      }
+    if (SelectLine(info, npts, cell + 1, ijk))
+      {
+      info->Selection[inCellId] = SelectedLine;
+      ++numNewCells;
+      numNewPts += npts;
+      }
+    else
+      {
+      info->Selection[inCellId] = RejectedLine;
+      }
+    }
+  info->ThreadNumberOfCells[threadInfo->ThreadID] = numNewCells;
+  info->ThreadNumberOfPoints[threadInfo->ThreadID] = numNewPts;
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE CopyLinesThreaderCallback(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* threadInfo =
+    static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  LabelSelectInfo* info = static_cast<LabelSelectInfo*>(threadInfo->UserData);
+
+  vtkIdType begin, end;
+  ThreadLineRange(threadInfo, info->CellLocations.size(), begin, end);
+  vtkIdType ptId = info->ThreadFirstPoint[threadInfo->ThreadID];
+  vtkIdType* outCell = info->OutCells
+    + info->ThreadFirstCell[threadInfo->ThreadID] + ptId;
+  double p[3];
+  double tensor[9];
+  for (vtkIdType inCellId = begin; inCellId < end; ++inCellId)
+    {
+    if (info->Selection[inCellId] != SelectedLine)
+      {
+      continue;
+      }
+    vtkIdType* cell = info->Cells + info->CellLocations[inCellId];
+    vtkIdType npts = cell[0];
+    *outCell++ = npts;
+    for (vtkIdType j = 1; j <= npts; ++j)
+      {
+      info->Points->GetPoint(cell[j], p);
+      info->OutPoints->SetPoint(ptId, p);
+      if (info->Tensors)
+        {
+        info->Tensors->GetTuple(cell[j], tensor);
+        info->OutTensors->SetTuple(ptId, tensor);
+        }
+      *outCell++ = ptId++;
+      }
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+} // end of anonymous namespace
 
 
 int main( int argc, char * argv[] )
@@ -85,131 +274,125 @@ int main( int argc, char * argv[] )
   trans->Inverse();
  ***/
 
-  // 2. Find polylines
+  // 2. Select the polylines
+  vtkImageData *labelImage = imageCastLabel_A->GetOutput();
   int inExt[6];
-  imageCastLabel_A->GetOutput()->GetWholeExtent(inExt);
+  labelImage->GetExtent(inExt);
 
   vtkPolyData *input = vtkPolyData::SafeDownCast(readerPD->GetOutput());
 
   vtkPoints *inPts =input->GetPoints();
-  vtkIdType numPts = inPts->GetNumberOfPoints();
   vtkCellArray *inLines = input->GetLines();
-  vtkIdType numLines = inLines->GetNumberOfCells();
-  vtkIdType npts=0, *pts=NULL;
 
-  if ( !inPts || numPts  < 1 || !inLines || numLines < 1 )
+  if ( !inPts || inPts->GetNumberOfPoints() < 1 ||
+       !inLines || inLines->GetNumberOfCells() < 1 )
     {
     return EXIT_SUCCESS;
     }
 
-  std::vector<bool> addLines;
-  vtkIdType numNewPts = 0;
-  vtkIdType numNewCells = 0;
-  vtkIdType j;
-  double p[3];
+  LabelSelectInfo info;
+  info.Points = inPts;
+  info.Tensors = input->GetPointData()->GetTensors();
+  info.Labels = static_cast<short*>(labelImage->GetScalarPointer());
+  for (int i = 0; i < 6; ++i)
+    {
+    info.Extent[i] = inExt[i];
+    }
+  for (int i = 0; i < 3; ++i)
+    {
+    for (int k = 0; k < 4; ++k)
+      {
+      info.RASToIJK[i][k] = trans->GetMatrix()->GetElement(i, k);
+      }
+    }
 
-  // Check lines
-  vtkIdType inCellId;
-  for (inCellId=0, inLines->InitTraversal(); 
-       inLines->GetNextCell(npts,pts); inCellId++)
+  // Not passing takes precedence over passing (same as listing the label
+  // in both)
+  info.LabelClasses.assign(VTK_SHORT_MAX - VTK_SHORT_MIN + 1, NoLabelClass);
+  for (unsigned int label = 0; label < PassLabel.size(); ++label)
     {
-    if (npts < 2)
+    if (PassLabel[label] >= VTK_SHORT_MIN && PassLabel[label] <= VTK_SHORT_MAX)
       {
-      addLines.push_back(false);
-      std::cerr << "Less than two points in line " << inCellId << std::endl;
-      continue; //skip this polyline
+      info.LabelClasses[PassLabel[label] - VTK_SHORT_MIN] = PassLabelClass;
       }
-    double pIJK[3];
-    int pt[3];
-    unsigned int label;
-    short *inPtr;
-    bool addLine = false;
-    bool pass = false;
-    bool nopass = false;
-    for (j=0; j < npts; j++)
+    }
+  for (unsigned int label = 0; label < NotPassLabel.size(); ++label)
+    {
+    if (NotPassLabel[label] >= VTK_SHORT_MIN && NotPassLabel[label] <= VTK_SHORT_MAX)
       {
-      inPts->GetPoint(pts[j],p);
-      trans->TransformPoint(p,pIJK);
-      pt[0]= (int) floor(pIJK[0]);
-      pt[1]= (int) floor(pIJK[1]);
-      pt[2]= (int) floor(pIJK[2]);
-      inPtr = (short *) imageCastLabel_A->GetOutput()->GetScalarPointer(pt);
-
-      for(label=0; label<NotPassLabel.size() && !nopass; label++)
-        {
-        nopass = (*inPtr == NotPassLabel[label]);
-        }
-      if (nopass)
-        break; //Skip this one
-
-      for(label=0; label<PassLabel.size() &&  !pass; label++)
-        {
-          pass = (*inPtr == PassLabel[label]);
-        }
+      info.LabelClasses[NotPassLabel[label] - VTK_SHORT_MIN] = NotPassLabelClass;
       }
-    addLine = pass && !nopass;
+    }
+  info.StopAtPass = NotPassLabel.empty();
+
+  // Start of each line in the connectivity array, so that the lines can be
+  // shared out between the threads
+  vtkIdType numLines = inLines->GetNumberOfCells();
+  info.Cells = inLines->GetPointer();
+  info.CellLocations.resize(numLines);
+  vtkIdType loc = 0;
+  for (vtkIdType inCellId = 0; inCellId < numLines; ++inCellId)
+    {
+    info.CellLocations[inCellId] = loc;
+    loc += info.Cells[loc] + 1;
+    }
+  info.Selection.resize(numLines);
 
-    addLines.push_back(addLine);
-    if (addLine)
+  vtkSmartPointer<vtkMultiThreader> threader =
+    vtkSmartPointer<vtkMultiThreader>::New();
+  int numThreads = threader->GetNumberOfThreads();
+  info.ThreadNumberOfCells.resize(numThreads);
+  info.ThreadNumberOfPoints.resize(numThreads);
+  threader->SetSingleMethod(SelectLinesThreaderCallback, &info);
+  threader->SingleMethodExecute();
+
+  for (vtkIdType inCellId = 0; inCellId < numLines; ++inCellId)
+    {
+    if (info.Selection[inCellId] == ShortLine)
       {
-      // Add line to the output
-      numNewPts += npts;
-      numNewCells++;
+      std::cerr << "Less than two points in line " << inCellId << std::endl;
       }
     }
-  
-  // Add lines
 
-  //Preallocate PolyData elements
+  // First output cell and point of each thread
+  vtkIdType numNewPts = 0;
+  vtkIdType numNewCells = 0;
+  info.ThreadFirstCell.resize(numThreads);
+  info.ThreadFirstPoint.resize(numThreads);
+  for (int thread = 0; thread < numThreads; ++thread)
+    {
+    info.ThreadFirstCell[thread] = numNewCells;
+    info.ThreadFirstPoint[thread] = numNewPts;
+    numNewCells += info.ThreadNumberOfCells[thread];
+    numNewPts += info.ThreadNumberOfPoints[thread];
+    }
+
+  // 3. Copy the selected lines, the threads write directly into the
+  // preallocated output arrays
   vtkSmartPointer<vtkPolyData> outFibers = vtkSmartPointer<vtkPolyData>::New();
 
   vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
-  points->Allocate(numNewPts);
+  points->SetNumberOfPoints(numNewPts);
   outFibers->SetPoints(points);
 
   vtkSmartPointer<vtkCellArray> outFibersCellArray = vtkSmartPointer<vtkCellArray>::New();
-  outFibersCellArray->Allocate(numNewPts+numNewCells);
+  info.OutCells = outFibersCellArray->WritePointer(numNewCells, numNewPts+numNewCells);
   outFibers->SetLines(outFibersCellArray);
 
-  //outFibersCellArray->SetNumberOfCells(numNewCells);
-  //outFibersCellArray = outFibers->GetLines();
-
-  //vtkIdTypeArray *cellArray=outFibersCellArray->GetData();
-  //cellArray->SetNumberOfTuples(numNewPts+numNewCells);
-
   vtkSmartPointer<vtkFloatArray> newTensors = vtkSmartPointer<vtkFloatArray>::New();
   newTensors->SetNumberOfComponents(9);
-  newTensors->Allocate(9*numNewPts);
-  outFibers->GetPointData()->SetTensors(newTensors);
-  newTensors = static_cast<vtkFloatArray *> (outFibers->GetPointData()->GetTensors());
-
-
-  vtkIdType ptId = 0;
-  vtkDataArray *oldTensors = input->GetPointData()->GetTensors();
-  double tensor[9];
-
-  for (inCellId=0, inLines->InitTraversal(); 
-       inLines->GetNextCell(npts,pts); inCellId++)
+  if (info.Tensors)
     {
-    if (addLines[inCellId])
-      {
-      outFibersCellArray->InsertNextCell(npts);
-      for (j=0; j < npts; j++)
-        {
-        inPts->GetPoint(pts[j],p);
-        points->InsertPoint(ptId,p);
-        outFibersCellArray->InsertCellPoint(ptId);
-        if (oldTensors)
-          {
-          oldTensors->GetTuple(pts[j],tensor);
-          newTensors->InsertNextTuple(tensor);
-          }
-        ptId++;
-        }
-      }
+    newTensors->SetNumberOfTuples(numNewPts);
     }
+  outFibers->GetPointData()->SetTensors(newTensors);
+
+  info.OutPoints = points;
+  info.OutTensors = newTensors;
+  threader->SetSingleMethod(CopyLinesThreaderCallback, &info);
+  threader->SingleMethodExecute();
 
-  //3. Save the output
+  //4. Save the output
   vtkSmartPointer<vtkXMLPolyDataWriter> writer = vtkSmartPointer<vtkXMLPolyDataWriter>::New();
   writer->SetFileName(OutputFibers.c_str());
   writer->SetInput( outFibers );
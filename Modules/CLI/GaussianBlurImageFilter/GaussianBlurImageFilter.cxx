@@ -1,6 +1,11 @@
 #include "itkImageFileWriter.h"
 
 #include "itkSmoothingRecursiveGaussianImageFilter.h"
+#ifdef ITK_USE_GPU
+#include "itkCastImageFilter.h"
+#include "itkGPUImage.h"
+#include "itkGPUDiscreteGaussianImageFilter.h"
+#endif
 
 #include "itkPluginUtilities.h"
 
@@ -14,11 +19,59 @@
 namespace
 {
 
+#ifdef ITK_USE_GPU
+template <class T>
+int DoItGPU( int argc, char * argv[], T )
+{
+  PARSE_ARGS;
+
+  typedef itk::GPUImage<float, 3> GPUImageType;
+  typedef itk::Image<T, 3>        OutputImageType;
+
+  typedef itk::ImageFileReader<GPUImageType>    ReaderType;
+  typedef itk::ImageFileWriter<OutputImageType> WriterType;
+
+  // There is no GPU recursive gaussian: the discrete gaussian kernel is
+  // used, with the variance in physical units
+  typedef itk::GPUDiscreteGaussianImageFilter<
+    GPUImageType, GPUImageType>  FilterType;
+  typedef itk::CastImageFilter<GPUImageType, OutputImageType> CastType;
+
+  typename ReaderType::Pointer reader = ReaderType::New();
+
+  reader->SetFileName( inputVolume.c_str() );
+
+  typename FilterType::Pointer filter = FilterType::New();
+  filter->SetInput( reader->GetOutput() );
+  filter->SetVariance( sigma * sigma );
+  filter->SetUseImageSpacing( true );
+
+  typename CastType::Pointer cast = CastType::New();
+  cast->SetInput( filter->GetOutput() );
+
+  typename WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName( outputVolume.c_str() );
+  writer->SetInput( cast->GetOutput() );
+  writer->SetUseCompression(1);
+  writer->Update();
+
+  return EXIT_SUCCESS;
+}
+
+#endif
+
 template <class T>
 int DoIt( int argc, char * argv[], T )
 {
   PARSE_ARGS;
 
+  if( itk::UseGPUDevice( device ) )
+    {
+#ifdef ITK_USE_GPU
+    return DoItGPU( argc, argv, T() );
+#endif
+    }
+
   typedef    T InputPixelType;
   typedef    T OutputPixelType;
 
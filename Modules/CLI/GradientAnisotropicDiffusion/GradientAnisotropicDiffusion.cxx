@@ -18,6 +18,10 @@
 #include "itkCastImageFilter.h"
 
 #include "itkGradientAnisotropicDiffusionImageFilter.h"
+#ifdef ITK_USE_GPU
+#include "itkGPUImage.h"
+#include "itkGPUGradientAnisotropicDiffusionImageFilter.h"
+#endif
 
 #include "itkPluginUtilities.h"
 #include "GradientAnisotropicDiffusionCLP.h"
@@ -30,12 +34,72 @@
 namespace
 {
 
+#ifdef ITK_USE_GPU
+template <class T>
+int DoItGPU( int argc, char * argv[], T )
+{
+
+  PARSE_ARGS;
+
+  typedef    float InputPixelType;
+  typedef    T     OutputPixelType;
+
+  typedef itk::GPUImage<InputPixelType, 3> InputImageType;
+  typedef itk::Image<OutputPixelType, 3>   OutputImageType;
+
+  typedef itk::ImageFileReader<InputImageType>  ReaderType;
+  typedef itk::ImageFileWriter<OutputImageType> WriterType;
+
+  typedef itk::GPUGradientAnisotropicDiffusionImageFilter<
+    InputImageType, InputImageType>  FilterType;
+  typedef itk::CastImageFilter<InputImageType, OutputImageType> CastType;
+
+  typename ReaderType::Pointer reader = ReaderType::New();
+  itk::PluginFilterWatcher watchReader(reader, "Read Volume",
+                                       CLPProcessInformation);
+
+  reader->SetFileName( inputVolume.c_str() );
+
+  typename FilterType::Pointer filter = FilterType::New();
+  itk::PluginFilterWatcher watchFilter(filter, "Gradient Anisotropic Diffusion (GPU)",
+                                       CLPProcessInformation);
+
+  filter->SetInput( reader->GetOutput() );
+  filter->SetNumberOfIterations( numberOfIterations );
+  filter->SetTimeStep( timeStep );
+  filter->SetConductanceParameter( conductance );
+  filter->SetUseImageSpacing( useImageSpacing );
+
+  // The diffused image is copied back from the device by the cast
+  typename CastType::Pointer cast = CastType::New();
+  cast->SetInput( filter->GetOutput() );
+
+  typename WriterType::Pointer writer = WriterType::New();
+  itk::PluginFilterWatcher watchWriter(writer, "Write Volume",
+                                       CLPProcessInformation);
+  writer->SetFileName( outputVolume.c_str() );
+  writer->SetInput( cast->GetOutput() );
+  writer->SetUseCompression(1);
+  writer->Update();
+
+  return EXIT_SUCCESS;
+}
+
+#endif
+
 template <class T>
 int DoIt( int argc, char * argv[], T )
 {
 
   PARSE_ARGS;
 
+  if( itk::UseGPUDevice( device ) )
+    {
+#ifdef ITK_USE_GPU
+    return DoItGPU( argc, argv, T() );
+#endif
+    }
+
   typedef    float InputPixelType;
   typedef    T     OutputPixelType;
 
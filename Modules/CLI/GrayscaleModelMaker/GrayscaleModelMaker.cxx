@@ -25,12 +25,254 @@ Version:   $Revision$
 #include "vtkStripper.h"
 #include "vtkXMLPolyDataWriter.h"
 #include "vtkImageChangeInformation.h"
+#include "vtkQuadricClustering.h"
+#include "vtkDataArray.h"
+#include "vtkPointData.h"
+#include "vtkPolyData.h"
+#include "vtkMultiThreader.h"
+#include "vtkCriticalSection.h"
 
 #include "vtkPluginFilterWatcher.h"
 #include "ModuleDescriptionParser.h"
 #include "ModuleDescription.h"
 #include "vtkDebugLeaks.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+
+// Passes of the slab workers
+enum
+  {
+  CountPass = 0,
+  SurfacePass
+  };
+
+//----------------------------------------------------------------------------
+// State shared by the threads that make the isosurface slab by slab. A slab
+// is a range of slices of the image, consecutive slabs share a slice so that
+// their surfaces meet. The surface of each slab is appended to the quadric
+// clustering in the order of the slabs, and released.
+struct SlabWorkerPool
+{
+  vtkImageData*               Image;
+  double                      Threshold;
+  int                         NumberOfSlabs;
+  int                         Pass;
+  vtkQuadricClustering*       Clustering;
+  ModuleProcessInformation*   ProcessInformation;
+
+  // guards the fields below
+  vtkSimpleCriticalSection    Lock;
+  int                         NextSlab;
+  int                         NextAppendedSlab;
+  std::vector<vtkPolyData*>   Surfaces;
+  vtkIdType                   NumberOfCrossings;
+  vtkIdType                   NumberOfTriangles;
+};
+
+//----------------------------------------------------------------------------
+// First and last slices of a slab
+void GetSlabSlices(vtkImageData* image, int numberOfSlabs, int slab,
+                   int& firstSlice, int& lastSlice)
+{
+  int extent[6];
+  image->GetExtent(extent);
+  int numberOfCubes = extent[5] - extent[4];
+  firstSlice = extent[4] + numberOfCubes * slab / numberOfSlabs;
+  lastSlice = extent[4] + numberOfCubes * (slab + 1) / numberOfSlabs;
+}
+
+//----------------------------------------------------------------------------
+// Number of voxel edges of the slices [firstSlice, lastSlice[ that cross the
+// threshold, about the number of points marching cubes makes from them.
+template <class T>
+vtkIdType CountThresholdCrossings(vtkImageData* image, T* vtkNotUsed(dummy),
+                                  double threshold, int firstSlice, int lastSlice)
+{
+  int extent[6];
+  image->GetExtent(extent);
+  vtkIdType increments[3];
+  image->GetIncrements(increments);
+  vtkIdType numberOfCrossings = 0;
+  for (int k = firstSlice; k < lastSlice; k++)
+    {
+    for (int j = extent[2]; j <= extent[3]; j++)
+      {
+      T* inPtr = static_cast<T*>(image->GetScalarPointer(extent[0], j, k));
+      for (int i = extent[0]; i <= extent[1]; i++, inPtr += increments[0])
+        {
+        bool inside = (*inPtr >= threshold);
+        if (i < extent[1] && inside != (inPtr[increments[0]] >= threshold))
+          {
+          numberOfCrossings++;
+          }
+        if (j < extent[3] && inside != (inPtr[increments[1]] >= threshold))
+          {
+          numberOfCrossings++;
+          }
+        if (k < extent[5] && inside != (inPtr[increments[2]] >= threshold))
+          {
+          numberOfCrossings++;
+          }
+        }
+      }
+    }
+  return numberOfCrossings;
+}
+
+//----------------------------------------------------------------------------
+// Isosurface of the slices [firstSlice, lastSlice] of the image, the slab
+// shares the memory of the image.
+vtkPolyData* MakeSlabSurface(vtkImageData* image, double threshold,
+                             int firstSlice, int lastSlice)
+{
+  int extent[6];
+  image->GetExtent(extent);
+  extent[4] = firstSlice;
+  extent[5] = lastSlice;
+  vtkDataArray* imageScalars = image->GetPointData()->GetScalars();
+  vtkDataArray* scalars = vtkDataArray::CreateDataArray(imageScalars->GetDataType());
+  scalars->SetNumberOfComponents(imageScalars->GetNumberOfComponents());
+  vtkIdType numberOfValues = static_cast<vtkIdType>(extent[1] - extent[0] + 1) *
+    (extent[3] - extent[2] + 1) * (lastSlice - firstSlice + 1) *
+    imageScalars->GetNumberOfComponents();
+  scalars->SetVoidArray(image->GetScalarPointer(extent[0], extent[2], firstSlice),
+                        numberOfValues, 1);
+
+  vtkImageData* slab = vtkImageData::New();
+  slab->SetOrigin(image->GetOrigin());
+  slab->SetSpacing(image->GetSpacing());
+  slab->SetExtent(extent);
+  slab->SetWholeExtent(extent);
+  slab->SetScalarType(image->GetScalarType());
+  slab->SetNumberOfScalarComponents(imageScalars->GetNumberOfComponents());
+  slab->GetPointData()->SetScalars(scalars);
+  scalars->Delete();
+
+  vtkMarchingCubes* mcubes = vtkMarchingCubes::New();
+  mcubes->SetInput(slab);
+  mcubes->SetValue(0, threshold);
+  mcubes->ComputeScalarsOff();
+  mcubes->ComputeGradientsOff();
+  mcubes->ComputeNormalsOff();
+  mcubes->Update();
+
+  vtkPolyData* surface = vtkPolyData::New();
+  surface->ShallowCopy(mcubes->GetOutput());
+  mcubes->Delete();
+  slab->Delete();
+  return surface;
+}
+
+//----------------------------------------------------------------------------
+void ReportSlabProgress(SlabWorkerPool* pool, double progress, const char* comment)
+{
+  ModuleProcessInformation* info = pool->ProcessInformation;
+  if (info)
+    {
+    strncpy(info->ProgressMessage, comment, 1023);
+    info->Progress = progress;
+    info->StageProgress = 0;
+    if (info->ProgressCallbackFunction && info->ProgressCallbackClientData)
+      {
+      (*(info->ProgressCallbackFunction))(info->ProgressCallbackClientData);
+      }
+    }
+  else
+    {
+    std::cout << "<filter-progress>" << progress << "</filter-progress>" << std::endl;
+    std::cout << std::flush;
+    }
+}
+
+//----------------------------------------------------------------------------
+// Worker of the pool: process the next slab until there is none left
+VTK_THREAD_RETURN_TYPE SlabWorker(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  SlabWorkerPool* pool = static_cast<SlabWorkerPool*>(info->UserData);
+  while (true)
+    {
+    pool->Lock.Lock();
+    int slab = pool->NextSlab++;
+    pool->Lock.Unlock();
+    if (slab >= pool->NumberOfSlabs)
+      {
+      break;
+      }
+    int firstSlice = 0;
+    int lastSlice = 0;
+    GetSlabSlices(pool->Image, pool->NumberOfSlabs, slab, firstSlice, lastSlice);
+
+    if (pool->Pass == CountPass)
+      {
+      int extent[6];
+      pool->Image->GetExtent(extent);
+      if (slab == pool->NumberOfSlabs - 1)
+        {
+        // the last slice has no next slab
+        lastSlice = extent[5] + 1;
+        }
+      vtkIdType numberOfCrossings = 0;
+      switch (pool->Image->GetScalarType())
+        {
+        vtkTemplateMacro(numberOfCrossings = CountThresholdCrossings(
+                           pool->Image, static_cast<VTK_TT*>(0), pool->Threshold,
+                           firstSlice, lastSlice));
+        default:
+          break;
+        }
+      pool->Lock.Lock();
+      pool->NumberOfCrossings += numberOfCrossings;
+      pool->Lock.Unlock();
+      continue;
+      }
+
+    vtkPolyData* surface = MakeSlabSurface(pool->Image, pool->Threshold, firstSlice, lastSlice);
+
+    // append the slabs that are ready, in order, so that the output
+    // doesn't depend on the threads
+    pool->Lock.Lock();
+    pool->Surfaces[slab] = surface;
+    while (pool->NextAppendedSlab < pool->NumberOfSlabs &&
+           pool->Surfaces[pool->NextAppendedSlab] != NULL)
+      {
+      vtkPolyData* readySurface = pool->Surfaces[pool->NextAppendedSlab];
+      pool->NumberOfTriangles += readySurface->GetNumberOfPolys();
+      if (readySurface->GetNumberOfPolys() > 0)
+        {
+        pool->Clustering->Append(readySurface);
+        }
+      readySurface->Delete();
+      pool->Surfaces[pool->NextAppendedSlab] = NULL;
+      pool->NextAppendedSlab++;
+      ReportSlabProgress(pool, 2.0 / 7.0 * pool->NextAppendedSlab / pool->NumberOfSlabs,
+                         "Marching Cubes and Decimation");
+      }
+    pool->Lock.Unlock();
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+void RunSlabPass(SlabWorkerPool* pool, int pass, int numberOfThreads)
+{
+  pool->Pass = pass;
+  pool->NextSlab = 0;
+  vtkMultiThreader* threader = vtkMultiThreader::New();
+  threader->SetNumberOfThreads(std::min(numberOfThreads, pool->NumberOfSlabs));
+  threader->SetSingleMethod(SlabWorker, pool);
+  threader->SingleMethodExecute();
+  threader->Delete();
+}
+
+}
+
 int main(int argc, char * argv[])
 {
   PARSE_ARGS;
@@ -68,6 +310,8 @@ int main(int argc, char * argv[])
   vtkWindowedSincPolyDataFilter *   smootherSinc = NULL;
   vtkDecimatePro *                  decimator = NULL;
   vtkMarchingCubes *                mcubes = NULL;
+  vtkQuadricClustering *            clustering = NULL;
+  vtkPolyData *                     streamedSurface = NULL;
   vtkTransform *                    transformIJKtoRAS = NULL;
   vtkReverseSense *                 reverser = NULL;
   vtkTransformPolyDataFilter *      transformer = NULL;
@@ -138,46 +382,122 @@ int main(int argc, char * argv[])
     transformIJKtoRAS->GetMatrix()->Print(std::cout);
     }
   transformIJKtoRAS->Inverse();
-  mcubes = vtkMarchingCubes::New();
-  vtkPluginFilterWatcher watchMCubes(mcubes,
-                                     "Marching Cubes",
-                                     CLPProcessInformation,
-                                     1.0 / 7.0, 0.0);
-
-  mcubes->SetInput(ici->GetOutput() );
-  mcubes->SetValue(0, Threshold);
-  mcubes->ComputeScalarsOff();
-  mcubes->ComputeGradientsOff();
-  mcubes->ComputeNormalsOff();
-  (mcubes->GetOutput() )->ReleaseDataFlagOn();
-  mcubes->Update();
-
-  if( debug )
+  int numberOfThreads = NumberOfThreads;
+  if( numberOfThreads == 0 )
+    {
+    numberOfThreads = vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
+    }
+  vtkPolyData * decimatedSurface = NULL;
+  if( NumberOfSlabs > 1 )
     {
-    std::cout << "Number of polygons = " << (mcubes->GetOutput() )->GetNumberOfPolys() << endl;
+    // Streaming: the marching cubes surface of each slab is simplified by
+    // quadric clustering as soon as it is made, so that the whole
+    // undecimated surface is never in memory. The bins of the clustering
+    // are the same for all the slabs, which stitches them.
+    SlabWorkerPool pool;
+    pool.Image = image;
+    pool.Threshold = Threshold;
+    pool.NumberOfSlabs = std::min(NumberOfSlabs, extents[5] - extents[4]);
+    pool.ProcessInformation = CLPProcessInformation;
+    pool.NextAppendedSlab = 0;
+    pool.NumberOfCrossings = 0;
+    pool.NumberOfTriangles = 0;
+
+    double keptRatio = 1.0 - Decimate;
+    if( TargetTriangles > 0 )
+      {
+      // marching cubes makes about 2 triangles per point
+      RunSlabPass(&pool, CountPass, numberOfThreads);
+      keptRatio = static_cast<double>(TargetTriangles) / std::max(2.0 * pool.NumberOfCrossings, 1.0);
+      }
+    keptRatio = std::min(1.0, std::max(keptRatio, 0.0001) );
+    // the clustering keeps about a point per bin, bins binSize voxels wide
+    // keep 1 / binSize^2 of the points of the surface
+    double binSize = 1.0 / sqrt(keptRatio);
+    if( debug )
+      {
+      std::cout << "Streaming " << pool.NumberOfSlabs << " slabs with " << numberOfThreads
+                << " threads, clustering bins of " << binSize << " voxels" << endl;
+      }
+
+    clustering = vtkQuadricClustering::New();
+    clustering->SetDivisionOrigin(extents[0], extents[2], extents[4]);
+    clustering->SetDivisionSpacing(binSize, binSize, binSize);
+    clustering->UseInputPointsOff();
+    clustering->UseFeatureEdgesOff();
+    clustering->UseInternalTrianglesOn();
+    clustering->CopyCellDataOff();
+    double bounds[6];
+    for( int i = 0; i < 6; i++ )
+      {
+      bounds[i] = extents[i];
+      }
+    clustering->StartAppend(bounds);
+    pool.Clustering = clustering;
+    pool.Surfaces.assign(pool.NumberOfSlabs, static_cast<vtkPolyData*>(NULL) );
+    std::cout << "Marching cubes and decimating " << pool.NumberOfSlabs << " slabs...\n";
+    RunSlabPass(&pool, SurfacePass, numberOfThreads);
+    clustering->EndAppend();
+
+    streamedSurface = vtkPolyData::New();
+    streamedSurface->DeepCopy(clustering->GetOutput() );
+    decimatedSurface = streamedSurface;
+    if( debug )
+      {
+      std::cout << "Number of polygons = " << pool.NumberOfTriangles << endl;
+      std::cout << "After decimation, number of polygons = " << decimatedSurface->GetNumberOfPolys() << endl;
+      }
     }
+  else
+    {
+    mcubes = vtkMarchingCubes::New();
+    vtkPluginFilterWatcher watchMCubes(mcubes,
+                                       "Marching Cubes",
+                                       CLPProcessInformation,
+                                       1.0 / 7.0, 0.0);
 
-  // TODO: look at vtkQuadraticDecimation
-  decimator = vtkDecimatePro::New();
-  vtkPluginFilterWatcher watchDecimator(decimator,
-                                        "Decimator",
-                                        CLPProcessInformation,
-                                        1.0 / 7.0, 1.0 / 7.0);
-  decimator->SetInput(mcubes->GetOutput() );
-  decimator->SetFeatureAngle(60);
-  decimator->SplittingOff();
-  decimator->PreserveTopologyOn();
+    mcubes->SetInput(ici->GetOutput() );
+    mcubes->SetValue(0, Threshold);
+    mcubes->ComputeScalarsOff();
+    mcubes->ComputeGradientsOff();
+    mcubes->ComputeNormalsOff();
+    (mcubes->GetOutput() )->ReleaseDataFlagOn();
+    mcubes->Update();
 
-  decimator->SetMaximumError(1);
-  decimator->SetTargetReduction(Decimate);
-  (decimator->GetOutput() )->ReleaseDataFlagOff();
+    if( debug )
+      {
+      std::cout << "Number of polygons = " << (mcubes->GetOutput() )->GetNumberOfPolys() << endl;
+      }
 
-  std::cout << "Decimating ... \n";
-  // TODO add progress to decimator
-  decimator->Update();
-  if( debug )
-    {
-    std::cout << "After decimation, number of polygons = " << (decimator->GetOutput() )->GetNumberOfPolys() << endl;
+    // TODO: look at vtkQuadraticDecimation
+    decimator = vtkDecimatePro::New();
+    vtkPluginFilterWatcher watchDecimator(decimator,
+                                          "Decimator",
+                                          CLPProcessInformation,
+                                          1.0 / 7.0, 1.0 / 7.0);
+    decimator->SetInput(mcubes->GetOutput() );
+    decimator->SetFeatureAngle(60);
+    decimator->SplittingOff();
+    decimator->PreserveTopologyOn();
+
+    decimator->SetMaximumError(1);
+    double targetReduction = Decimate;
+    if( TargetTriangles > 0 && (mcubes->GetOutput() )->GetNumberOfPolys() > 0 )
+      {
+      targetReduction = std::max(0.0, 1.0 - static_cast<double>(TargetTriangles)
+                                 / (mcubes->GetOutput() )->GetNumberOfPolys() );
+      }
+    decimator->SetTargetReduction(targetReduction);
+    (decimator->GetOutput() )->ReleaseDataFlagOff();
+
+    std::cout << "Decimating ... \n";
+    // TODO add progress to decimator
+    decimator->Update();
+    if( debug )
+      {
+      std::cout << "After decimation, number of polygons = " << (decimator->GetOutput() )->GetNumberOfPolys() << endl;
+      }
+    decimatedSurface = decimator->GetOutput();
     }
 
   if( (transformIJKtoRAS->GetMatrix() )->Determinant() < 0 )
@@ -192,7 +512,7 @@ int main(int argc, char * argv[])
                                          "Reversor",
                                          CLPProcessInformation,
                                          1.0 / 7.0, 2.0 / 7.0);
-    reverser->SetInput(decimator->GetOutput() );
+    reverser->SetInput(decimatedSurface);
     reverser->ReverseNormalsOn();
     (reverser->GetOutput() )->ReleaseDataFlagOn();
     // TODO: add progress
@@ -215,7 +535,7 @@ int main(int argc, char * argv[])
     }
   else
     {
-    smootherSinc->SetInput(decimator->GetOutput() );
+    smootherSinc->SetInput(decimatedSurface);
     }
   smootherSinc->SetNumberOfIterations(Smooth);
   smootherSinc->FeatureEdgeSmoothingOff();
@@ -237,7 +557,7 @@ int main(int argc, char * argv[])
     }
   else
     {
-    transformer->SetInput(decimator->GetOutput() );
+    transformer->SetInput(decimatedSurface);
     }
 
   transformer->SetTransform(transformIJKtoRAS);
@@ -312,6 +632,14 @@ int main(int argc, char * argv[])
     {
     decimator->Delete();
     }
+  if( clustering )
+    {
+    clustering->Delete();
+    }
+  if( streamedSurface )
+    {
+    streamedSurface->Delete();
+    }
   if( reverser )
     {
     reverser->Delete();
@@ -23,7 +23,7 @@
 #include "itkImageFileWriter.h"
 #include "itkPluginUtilities.h"
 
-#include "itkHistogramMatchingImageFilter.h"
+#include "itkThreadedHistogramMatchingImageFilter.h"
 
 #include "HistogramMatchingCLP.h"
 
@@ -53,8 +53,8 @@ int DoIt( int argc, char * argv[], T )
   typedef itk::ImageFileReader<InputImageType>  ReaderType;
   typedef itk::ImageFileWriter<OutputImageType> WriterType;
 
-  // define the histogram matching
-  typedef itk::HistogramMatchingImageFilter<
+  // define the histogram matching, with the histograms computed in threads
+  typedef itk::ThreadedHistogramMatchingImageFilter<
     InputImageType,
     OutputImageType, InputPixelType>  FilterType;
 
@@ -0,0 +1,167 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    $HeadURL$
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkThreadedHistogramMatchingImageFilter_h
+#define __itkThreadedHistogramMatchingImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkThreadedImageHistogramCalculator.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/** \class ThreadedHistogramMatchingImageFilter
+ * \brief Normalize the grayscale values between two images by histogram
+ * matching, with the histograms computed in threads.
+ *
+ * Maps the source image intensities as HistogramMatchingImageFilter: the
+ * quantiles of NumberOfMatchPoints match points of the source and
+ * reference histograms, of NumberOfHistogramLevels bins computed above the
+ * minimum or the mean intensity, are matched, and the intensities are
+ * mapped linearly between them.
+ *
+ * The intensity statistics and the histograms of both images are computed
+ * by ThreadedImageHistogramCalculator, optionally only over the pixels
+ * where the source and reference masks are not zero.  The bins have the
+ * bounds of an itk::Statistics::Histogram of THistogramMeasurement, so that
+ * the mapping is the one of HistogramMatchingImageFilter.
+ *
+ * \ingroup IntensityImageFilters Multithreaded
+ */
+template <class TInputImage, class TOutputImage,
+          class THistogramMeasurement = typename TInputImage::PixelType>
+class ITK_EXPORT ThreadedHistogramMatchingImageFilter
+  : public ImageToImageFilter<TInputImage, TOutputImage>
+{
+public:
+  /** Standard class typedefs. */
+  typedef ThreadedHistogramMatchingImageFilter          Self;
+  typedef ImageToImageFilter<TInputImage, TOutputImage> Superclass;
+  typedef SmartPointer<Self>                            Pointer;
+  typedef SmartPointer<const Self>                      ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(ThreadedHistogramMatchingImageFilter, ImageToImageFilter);
+
+  /** ImageDimension enumeration. */
+  itkStaticConstMacro(ImageDimension, unsigned int,
+                      TInputImage::ImageDimension);
+
+  typedef TInputImage                             InputImageType;
+  typedef typename InputImageType::PixelType      InputPixelType;
+  typedef TOutputImage                            OutputImageType;
+  typedef typename OutputImageType::PixelType     OutputPixelType;
+  typedef typename OutputImageType::RegionType    OutputImageRegionType;
+  typedef Image<unsigned char, itkGetStaticConstMacro(ImageDimension)> MaskImageType;
+
+  /** Set/Get the source image. */
+  void SetSourceImage(const InputImageType * source)
+  {
+    this->SetInput( source );
+  }
+  const InputImageType * GetSourceImage()
+  {
+    return this->GetInput();
+  }
+
+  /** Set/Get the reference image. */
+  void SetReferenceImage(const InputImageType * reference);
+  const InputImageType * GetReferenceImage();
+
+  /** Set the masks of the pixels the histograms are computed from, NULL
+   * (the default) uses all the pixels.  The whole source image is mapped. */
+  itkSetConstObjectMacro(SourceMaskImage, MaskImageType);
+  itkSetConstObjectMacro(ReferenceMaskImage, MaskImageType);
+
+  /** Set/Get the number of histogram levels used. */
+  itkSetMacro(NumberOfHistogramLevels, unsigned long);
+  itkGetConstMacro(NumberOfHistogramLevels, unsigned long);
+
+  /** Set/Get the number of match points used. */
+  itkSetMacro(NumberOfMatchPoints, unsigned long);
+  itkGetConstMacro(NumberOfMatchPoints, unsigned long);
+
+  /** Set/Get the threshold at mean intensity flag.  If true, only
+   * the pixels above the mean intensity are used in the histograms. */
+  itkSetMacro(ThresholdAtMeanIntensity, bool);
+  itkGetConstMacro(ThresholdAtMeanIntensity, bool);
+  itkBooleanMacro(ThresholdAtMeanIntensity);
+
+protected:
+  ThreadedHistogramMatchingImageFilter();
+  ~ThreadedHistogramMatchingImageFilter() {};
+  void PrintSelf(std::ostream& os, Indent indent) const;
+
+  void GenerateInputRequestedRegion();
+
+  void BeforeThreadedGenerateData();
+
+#if ITK_VERSION_MAJOR < 4
+  void ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                            int threadId);
+#else
+  void ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                            ThreadIdType threadId);
+#endif
+
+private:
+  ThreadedHistogramMatchingImageFilter(const Self &); //purposely not implemented
+  void operator=(const Self &); //purposely not implemented
+
+  typedef ThreadedImageHistogramCalculator<InputImageType, MaskImageType> HistogramCalculatorType;
+
+  // Compute the minimum, maximum and mean of an image, then its histogram
+  //   above the intensity threshold
+  void ComputeHistogram(const InputImageType * image, const MaskImageType * mask,
+                        HistogramCalculatorType * calculator,
+                        THistogramMeasurement & minValue, THistogramMeasurement & maxValue,
+                        THistogramMeasurement & intensityThreshold);
+
+  unsigned long m_NumberOfHistogramLevels;
+  unsigned long m_NumberOfMatchPoints;
+  bool          m_ThresholdAtMeanIntensity;
+
+  typename MaskImageType::ConstPointer m_SourceMaskImage;
+  typename MaskImageType::ConstPointer m_ReferenceMaskImage;
+
+  THistogramMeasurement m_SourceIntensityThreshold;
+  THistogramMeasurement m_ReferenceIntensityThreshold;
+  THistogramMeasurement m_SourceMinValue;
+  THistogramMeasurement m_SourceMaxValue;
+  THistogramMeasurement m_ReferenceMinValue;
+  THistogramMeasurement m_ReferenceMaxValue;
+
+  // Intensities of the match points, with the threshold first and the
+  //   maximum last
+  std::vector<double> m_SourceQuantiles;
+  std::vector<double> m_ReferenceQuantiles;
+  std::vector<double> m_Gradients;
+  double              m_LowerGradient;
+  double              m_UpperGradient;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkThreadedHistogramMatchingImageFilter.txx"
+#endif
+
+#endif
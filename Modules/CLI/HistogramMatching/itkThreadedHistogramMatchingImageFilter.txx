@@ -0,0 +1,236 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    $HeadURL$
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkThreadedHistogramMatchingImageFilter_txx
+#define __itkThreadedHistogramMatchingImageFilter_txx
+
+#include "itkThreadedHistogramMatchingImageFilter.h"
+
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkProgressReporter.h"
+
+namespace itk
+{
+
+template <class TInputImage, class TOutputImage, class THistogramMeasurement>
+ThreadedHistogramMatchingImageFilter<TInputImage, TOutputImage, THistogramMeasurement>
+::ThreadedHistogramMatchingImageFilter()
+{
+  this->SetNumberOfRequiredInputs( 2 );
+
+  m_NumberOfHistogramLevels = 256;
+  m_NumberOfMatchPoints = 1;
+  m_ThresholdAtMeanIntensity = true;
+
+  m_SourceMaskImage = NULL;
+  m_ReferenceMaskImage = NULL;
+
+  m_SourceIntensityThreshold = 0;
+  m_ReferenceIntensityThreshold = 0;
+  m_SourceMinValue = 0;
+  m_SourceMaxValue = 0;
+  m_ReferenceMinValue = 0;
+  m_ReferenceMaxValue = 0;
+  m_LowerGradient = 0.0;
+  m_UpperGradient = 0.0;
+}
+
+template <class TInputImage, class TOutputImage, class THistogramMeasurement>
+void
+ThreadedHistogramMatchingImageFilter<TInputImage, TOutputImage, THistogramMeasurement>
+::SetReferenceImage(const InputImageType * reference)
+{
+  this->ProcessObject::SetNthInput( 1, const_cast<InputImageType *>( reference ) );
+}
+
+template <class TInputImage, class TOutputImage, class THistogramMeasurement>
+const typename ThreadedHistogramMatchingImageFilter<TInputImage, TOutputImage, THistogramMeasurement>
+::InputImageType
+* ThreadedHistogramMatchingImageFilter<TInputImage, TOutputImage, THistogramMeasurement>
+::GetReferenceImage()
+{
+  if( this->GetNumberOfInputs() < 2 )
+    {
+    return NULL;
+    }
+  return dynamic_cast<const InputImageType *>( this->ProcessObject::GetInput( 1 ) );
+}
+
+template <class TInputImage, class TOutputImage, class THistogramMeasurement>
+void
+ThreadedHistogramMatchingImageFilter<TInputImage, TOutputImage, THistogramMeasurement>
+::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  // The histograms need the whole images
+  for( unsigned int idx = 0; idx < this->GetNumberOfInputs(); ++idx )
+    {
+    InputImageType * input = const_cast<InputImageType *>( this->GetInput( idx ) );
+    if( input )
+      {
+      input->SetRequestedRegionToLargestPossibleRegion();
+      }
+    }
+}
+
+template <class TInputImage, class TOutputImage, class THistogramMeasurement>
+void
+ThreadedHistogramMatchingImageFilter<TInputImage, TOutputImage, THistogramMeasurement>
+::ComputeHistogram(const InputImageType * image, const MaskImageType * mask,
+                   HistogramCalculatorType * calculator,
+                   THistogramMeasurement & minValue, THistogramMeasurement & maxValue,
+                   THistogramMeasurement & intensityThreshold)
+{
+  calculator->SetImage( image );
+  calculator->SetMaskImage( mask );
+  calculator->SetNumberOfThreads( this->GetNumberOfThreads() );
+  calculator->ComputeStatistics();
+
+  minValue = static_cast<THistogramMeasurement>( calculator->GetMinimum() );
+  maxValue = static_cast<THistogramMeasurement>( calculator->GetMaximum() );
+  intensityThreshold = m_ThresholdAtMeanIntensity ?
+    static_cast<THistogramMeasurement>( calculator->GetMean() ) : minValue;
+
+  // Same bins as an itk::Statistics::Histogram initialized from the
+  //   threshold to the maximum
+  const unsigned long levels = m_NumberOfHistogramLevels;
+  const float interval = static_cast<float>( maxValue - intensityThreshold ) / static_cast<float>( levels );
+  std::vector<double> boundaries( levels + 1 );
+  for( unsigned long j = 0; j < levels; j++ )
+    {
+    boundaries[j] = static_cast<THistogramMeasurement>(
+      intensityThreshold + static_cast<float>( j ) * interval );
+    }
+  boundaries[levels] = maxValue;
+  calculator->SetBinBoundaries( boundaries );
+  calculator->ComputeHistogram();
+}
+
+template <class TInputImage, class TOutputImage, class THistogramMeasurement>
+void
+ThreadedHistogramMatchingImageFilter<TInputImage, TOutputImage, THistogramMeasurement>
+::BeforeThreadedGenerateData()
+{
+  typename HistogramCalculatorType::Pointer source = HistogramCalculatorType::New();
+  typename HistogramCalculatorType::Pointer reference = HistogramCalculatorType::New();
+  this->ComputeHistogram( this->GetSourceImage(), m_SourceMaskImage, source,
+                          m_SourceMinValue, m_SourceMaxValue, m_SourceIntensityThreshold );
+  this->ComputeHistogram( this->GetReferenceImage(), m_ReferenceMaskImage, reference,
+                          m_ReferenceMinValue, m_ReferenceMaxValue, m_ReferenceIntensityThreshold );
+
+  // Fill in the quantile table
+  const unsigned long numberOfPoints = m_NumberOfMatchPoints + 2;
+  m_SourceQuantiles.resize( numberOfPoints );
+  m_ReferenceQuantiles.resize( numberOfPoints );
+  m_SourceQuantiles[0] = m_SourceIntensityThreshold;
+  m_ReferenceQuantiles[0] = m_ReferenceIntensityThreshold;
+  m_SourceQuantiles[numberOfPoints - 1] = m_SourceMaxValue;
+  m_ReferenceQuantiles[numberOfPoints - 1] = m_ReferenceMaxValue;
+  const double delta = 1.0 / ( static_cast<double>( m_NumberOfMatchPoints ) + 1.0 );
+  for( unsigned long j = 1; j < numberOfPoints - 1; j++ )
+    {
+    m_SourceQuantiles[j] = source->Quantile( static_cast<double>( j ) * delta );
+    m_ReferenceQuantiles[j] = reference->Quantile( static_cast<double>( j ) * delta );
+    }
+
+  // Fill in the gradient array
+  m_Gradients.resize( numberOfPoints - 1 );
+  for( unsigned long j = 0; j < numberOfPoints - 1; j++ )
+    {
+    const double denominator = m_SourceQuantiles[j + 1] - m_SourceQuantiles[j];
+    m_Gradients[j] = ( denominator != 0 ) ?
+      ( m_ReferenceQuantiles[j + 1] - m_ReferenceQuantiles[j] ) / denominator : 0.0;
+    }
+
+  double denominator = m_SourceQuantiles[0] - m_SourceMinValue;
+  m_LowerGradient = ( denominator != 0 ) ?
+    ( m_ReferenceQuantiles[0] - m_ReferenceMinValue ) / denominator : 0.0;
+
+  denominator = m_SourceQuantiles[numberOfPoints - 1] - m_SourceMaxValue;
+  m_UpperGradient = ( denominator != 0 ) ?
+    ( m_ReferenceQuantiles[numberOfPoints - 1] - m_ReferenceMaxValue ) / denominator : 0.0;
+}
+
+template <class TInputImage, class TOutputImage, class THistogramMeasurement>
+void
+ThreadedHistogramMatchingImageFilter<TInputImage, TOutputImage, THistogramMeasurement>
+#if ITK_VERSION_MAJOR < 4
+::ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread, int threadId)
+#else
+::ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread, ThreadIdType threadId)
+#endif
+{
+  ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() );
+
+  ImageRegionConstIterator<InputImageType> inIter( this->GetSourceImage(), outputRegionForThread );
+  ImageRegionIterator<OutputImageType>     outIter( this->GetOutput(), outputRegionForThread );
+
+  const unsigned long numberOfPoints = m_NumberOfMatchPoints + 2;
+  const double *      sourceQuantiles = &m_SourceQuantiles[0];
+  for( ; !inIter.IsAtEnd(); ++inIter, ++outIter )
+    {
+    const double srcValue = static_cast<double>( inIter.Get() );
+    unsigned long j = 0;
+    while( j < numberOfPoints && srcValue >= sourceQuantiles[j] )
+      {
+      ++j;
+      }
+
+    double mappedValue;
+    if( j == 0 )
+      {
+      // Linear interpolate from min to point[0]
+      mappedValue = m_ReferenceMinValue + ( srcValue - m_SourceMinValue ) * m_LowerGradient;
+      }
+    else if( j == numberOfPoints )
+      {
+      // Linear interpolate from point[m_NumberOfMatchPoints+1] to max
+      mappedValue = m_ReferenceMaxValue + ( srcValue - m_SourceMaxValue ) * m_UpperGradient;
+      }
+    else
+      {
+      // Linear interpolate from point[j] and point[j+1]
+      mappedValue = m_ReferenceQuantiles[j - 1]
+        + ( srcValue - sourceQuantiles[j - 1] ) * m_Gradients[j - 1];
+      }
+    outIter.Set( static_cast<OutputPixelType>( mappedValue ) );
+    progress.CompletedPixel();
+    }
+}
+
+template <class TInputImage, class TOutputImage, class THistogramMeasurement>
+void
+ThreadedHistogramMatchingImageFilter<TInputImage, TOutputImage, THistogramMeasurement>
+::PrintSelf(std::ostream& os, Indent indent) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "NumberOfHistogramLevels: " << m_NumberOfHistogramLevels << std::endl;
+  os << indent << "NumberOfMatchPoints: " << m_NumberOfMatchPoints << std::endl;
+  os << indent << "ThresholdAtMeanIntensity: " << m_ThresholdAtMeanIntensity << std::endl;
+  os << indent << "SourceMaskImage: " << m_SourceMaskImage.GetPointer() << std::endl;
+  os << indent << "ReferenceMaskImage: " << m_ReferenceMaskImage.GetPointer() << std::endl;
+  os << indent << "SourceIntensityThreshold: " << m_SourceIntensityThreshold << std::endl;
+  os << indent << "ReferenceIntensityThreshold: " << m_ReferenceIntensityThreshold << std::endl;
+  os << indent << "LowerGradient: " << m_LowerGradient << std::endl;
+  os << indent << "UpperGradient: " << m_UpperGradient << std::endl;
+}
+
+} // end namespace itk
+
+#endif
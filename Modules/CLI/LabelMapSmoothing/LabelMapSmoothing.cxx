@@ -21,11 +21,18 @@
 
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkMultiThreader.h"
+#include "itkSimpleFastMutexLock.h"
 
 #include "itkPluginFilterWatcher.h"
 
 #include "LabelMapSmoothingCLP.h"
 
+#include <algorithm>
+#include <vector>
+
 // Use an anonymous namespace to keep class types and function names
 // from colliding when module is used as shared object module.  Every
 // thing should be in an anonymous namespace except for the module
@@ -34,6 +41,208 @@
 namespace
 {
 
+typedef itk::Image<float, 3>         SmoothedImageType;
+typedef itk::Image<unsigned char, 3> LabelMapType;
+
+// A label cropped to its padded bounding box, smoothed by a worker
+struct LabelSmoothingTask
+  {
+  unsigned char              Label;
+  LabelMapType::RegionType   Region;
+  SmoothedImageType::Pointer Smoothed;
+  };
+
+bool CompareTaskSizes( const LabelSmoothingTask & a, const LabelSmoothingTask & b )
+{
+  return a.Region.GetNumberOfPixels() > b.Region.GetNumberOfPixels();
+}
+
+struct LabelSmoothingThreadData
+  {
+  const LabelMapType *              Input;
+  std::vector<LabelSmoothingTask> * Tasks;
+  unsigned int                      NumberOfIterations;
+  unsigned int                      NumberOfLayers;
+  double                            MaxRMSError;
+  double                            Variance;
+
+  // next task to start, and the first error of the workers
+  itk::SimpleFastMutexLock Lock;
+  size_t                   NextTask;
+  std::string              Error;
+  };
+
+// Anti-alias and smooth one label.  The workers only read the input label
+// map, and each one runs its own single threaded filters.
+void SmoothLabel( const LabelSmoothingThreadData & data, LabelSmoothingTask & task )
+{
+  // binary image of the label in its bounding box, in the index space of
+  // the input
+  LabelMapType::Pointer binary = LabelMapType::New();
+  binary->CopyInformation( data.Input );
+  binary->SetRegions( task.Region );
+  binary->Allocate();
+
+  itk::ImageRegionConstIterator<LabelMapType> inputIt( data.Input, task.Region );
+  itk::ImageRegionIterator<LabelMapType>      binaryIt( binary, task.Region );
+  for( ; !inputIt.IsAtEnd(); ++inputIt, ++binaryIt )
+    {
+    binaryIt.Set( inputIt.Get() == task.Label ? 1 : 0 );
+    }
+
+  typedef itk::AntiAliasBinaryImageFilter<LabelMapType, SmoothedImageType>      AntiAliasType;
+  typedef itk::DiscreteGaussianImageFilter<SmoothedImageType, SmoothedImageType> GaussianType;
+
+  AntiAliasType::Pointer antiAliasFilter = AntiAliasType::New();
+  antiAliasFilter->SetInput( binary );
+  antiAliasFilter->SetMaximumRMSError( data.MaxRMSError );
+  antiAliasFilter->SetNumberOfIterations( data.NumberOfIterations );
+  antiAliasFilter->SetNumberOfLayers( data.NumberOfLayers );
+  antiAliasFilter->SetNumberOfThreads( 1 );
+  antiAliasFilter->Update();
+
+  GaussianType::Pointer gaussianFilter = GaussianType::New();
+  gaussianFilter->SetInput( antiAliasFilter->GetOutput() );
+  gaussianFilter->SetVariance( data.Variance );
+  gaussianFilter->SetNumberOfThreads( 1 );
+  gaussianFilter->Update();
+
+  task.Smoothed = gaussianFilter->GetOutput();
+  task.Smoothed->DisconnectPipeline();
+}
+
+ITK_THREAD_RETURN_TYPE SmoothLabelsThreaderCallback( void * arg )
+{
+  itk::MultiThreader::ThreadInfoStruct * threadInfo =
+    static_cast<itk::MultiThreader::ThreadInfoStruct *>( arg );
+  LabelSmoothingThreadData * data =
+    static_cast<LabelSmoothingThreadData *>( threadInfo->UserData );
+
+  while( true )
+    {
+    data->Lock.Lock();
+    const size_t task = data->NextTask++;
+    const bool   failed = !data->Error.empty();
+    data->Lock.Unlock();
+    if( task >= data->Tasks->size() || failed )
+      {
+      break;
+      }
+    try
+      {
+      SmoothLabel( *data, ( *data->Tasks )[task] );
+      }
+    catch( itk::ExceptionObject & exc )
+      {
+      data->Lock.Lock();
+      if( data->Error.empty() )
+        {
+        data->Error = exc.what();
+        }
+      data->Lock.Unlock();
+      }
+    }
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+// Smooth all the labels of the input concurrently, each in its padded
+// bounding box, then give each voxel the label with the largest smoothed
+// response.  Voxels outside of all the smoothed labels are set to 0.
+LabelMapType::Pointer SmoothAllLabels( const LabelMapType * input, unsigned int boundingBoxPadding,
+                                       unsigned int numberOfIterations, unsigned int numberOfLayers,
+                                       double maxRMSError, double variance )
+{
+  // bounding boxes of all the labels in one pass
+  typedef itk::LabelStatisticsImageFilter<LabelMapType, LabelMapType> LabelStatisticsType;
+  LabelStatisticsType::Pointer labelStatisticsFilter = LabelStatisticsType::New();
+  labelStatisticsFilter->SetInput( input );
+  labelStatisticsFilter->SetLabelInput( input );
+  labelStatisticsFilter->Update();
+
+  const LabelMapType::RegionType  largestRegion = input->GetLargestPossibleRegion();
+  std::vector<LabelSmoothingTask> tasks;
+  for( unsigned int label = 1; label <= 255; ++label )
+    {
+    if( !labelStatisticsFilter->HasLabel( label ) )
+      {
+      continue;
+      }
+    LabelStatisticsType::BoundingBoxType boundingBox = labelStatisticsFilter->GetBoundingBox( label );
+    LabelMapType::IndexType              regionIndex;
+    LabelMapType::SizeType               regionSize;
+    for( unsigned int i = 0; i < 3; i++ )
+      {
+      const int lower = vnl_math_max( (int)largestRegion.GetIndex(i),
+                                      (int)(boundingBox[2 * i] - boundingBoxPadding) );
+      const int upper = vnl_math_min( (int)(largestRegion.GetIndex(i) + largestRegion.GetSize(i) - 1),
+                                      (int)(boundingBox[2 * i + 1] + boundingBoxPadding) );
+      regionIndex[i] = lower;
+      regionSize[i] = upper - lower + 1;
+      }
+    LabelSmoothingTask task;
+    task.Label = static_cast<unsigned char>( label );
+    task.Region.SetIndex( regionIndex );
+    task.Region.SetSize( regionSize );
+    tasks.push_back( task );
+    }
+  // start with the largest labels to balance the workers
+  std::sort( tasks.begin(), tasks.end(), CompareTaskSizes );
+
+  LabelSmoothingThreadData data;
+  data.Input = input;
+  data.Tasks = &tasks;
+  data.NumberOfIterations = numberOfIterations;
+  data.NumberOfLayers = numberOfLayers;
+  data.MaxRMSError = maxRMSError;
+  data.Variance = variance;
+  data.NextTask = 0;
+
+  if( !tasks.empty() )
+    {
+    itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+    const int                   numberOfThreads = threader->GetNumberOfThreads();
+    threader->SetNumberOfThreads( vnl_math_min( numberOfThreads, (int)tasks.size() ) );
+    threader->SetSingleMethod( SmoothLabelsThreaderCallback, &data );
+    threader->SingleMethodExecute();
+    }
+  if( !data.Error.empty() )
+    {
+    itkGenericExceptionMacro( << data.Error );
+    }
+
+  // maximum response recombination, inside is where the smoothed response
+  // is positive as in the single label mode
+  LabelMapType::Pointer output = LabelMapType::New();
+  output->CopyInformation( input );
+  output->SetRegions( largestRegion );
+  output->Allocate();
+  output->FillBuffer( 0 );
+
+  SmoothedImageType::Pointer response = SmoothedImageType::New();
+  response->CopyInformation( input );
+  response->SetRegions( largestRegion );
+  response->Allocate();
+  response->FillBuffer( 0 );
+
+  for( size_t t = 0; t < tasks.size(); ++t )
+    {
+    const LabelSmoothingTask &                       task = tasks[t];
+    itk::ImageRegionConstIterator<SmoothedImageType> smoothedIt( task.Smoothed, task.Region );
+    itk::ImageRegionIterator<SmoothedImageType>      responseIt( response, task.Region );
+    itk::ImageRegionIterator<LabelMapType>           outputIt( output, task.Region );
+    for( ; !smoothedIt.IsAtEnd(); ++smoothedIt, ++responseIt, ++outputIt )
+      {
+      const float value = smoothedIt.Get();
+      if( value >= 0 && ( outputIt.Get() == 0 || value > responseIt.Get() ) )
+        {
+        responseIt.Set( value );
+        outputIt.Set( task.Label );
+        }
+      }
+    }
+  return output;
+}
+
 } // end of anonymous namespace
 
 int main( int argc, char * argv[] )
@@ -87,6 +296,17 @@ int main( int argc, char * argv[] )
     reader->SetFileName(inputVolume.c_str() );
     reader->Update();
 
+    if( smoothAllLabels )
+      {
+      writer->SetInput( SmoothAllLabels( reader->GetOutput(), boundingBoxPadding,
+                                         numberOfIterations, numberOfLayers,
+                                         maxRMSError, gaussianSigma * gaussianSigma ) );
+      writer->SetFileName( outputVolume.c_str() );
+      writer->SetUseCompression(1);
+      writer->Update();
+      return EXIT_SUCCESS;
+      }
+
     // Choose a label to smooth.  All others will be ignored.
     // If the chosen label is greater than the largest label in the
     // image or lower than the smallest, the label will be set to the
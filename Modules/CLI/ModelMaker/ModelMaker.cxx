@@ -36,6 +36,9 @@ Version:   $Revision$
 #include "vtkSmartPointer.h"
 #include "vtkLookupTable.h"
 #include "vtkImageConstantPad.h"
+#include "vtkMatrix4x4.h"
+#include "vtkMultiThreader.h"
+#include "vtkCriticalSection.h"
 
 #include "vtkPluginFilterWatcher.h"
 
@@ -50,6 +53,506 @@ Version:   $Revision$
 #include "vtkMRMLColorTableStorageNode.h"
 #include "vtkDebugLeaks.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// A label made into a model by the worker pool
+struct LabelTask
+{
+  int         Label;
+  std::string Name;
+  // bounding box of the label voxels in the image, and their number
+  int         Extent[6];
+  vtkIdType   NumberOfVoxels;
+  // set by the worker once the model is written
+  std::string FileName;
+  bool        Made;
+};
+
+//----------------------------------------------------------------------------
+// State shared by the threads that make the label models concurrently.
+// The filters of each label are only used by the thread that makes it, the
+// input image and the IJK to RAS matrix are only read.
+struct LabelWorkerPool
+{
+  std::vector<LabelTask>*   Tasks;
+  vtkImageData*             Image;
+  vtkMatrix4x4*             IJKToRAS;
+  bool                      Reverse;
+  bool                      SincFilter;
+  int                       Smooth;
+  float                     Decimate;
+  bool                      SplitNormals;
+  bool                      PointNormals;
+  bool                      Pad;
+  bool                      SaveIntermediateModels;
+  bool                      Debug;
+  std::string               RootDir;
+  ModuleProcessInformation* ProcessInformation;
+  double                    ProgressStart;
+
+  // guards the fields below and the console output
+  vtkSimpleCriticalSection  Lock;
+  ::size_t                  NextTask;
+  ::size_t                  DoneTasks;
+  bool                      Failed;
+};
+
+//----------------------------------------------------------------------------
+std::string ModelFileName(const std::string& rootDir, const std::string& name)
+{
+  if (rootDir != "")
+    {
+    return rootDir + std::string("/") + name;
+    }
+  return name;
+}
+
+//----------------------------------------------------------------------------
+// Bounding box and number of voxels of the labels of the tasks in one pass
+// over the image. taskOfLabel gives the task of each label from minLabel.
+template <class T>
+void ComputeLabelBounds(vtkImageData* image, T* inPtr, int minLabel,
+                        const std::vector<int>& taskOfLabel,
+                        std::vector<LabelTask>& tasks)
+{
+  int extent[6];
+  image->GetExtent(extent);
+  int numberOfComponents = image->GetNumberOfScalarComponents();
+  int maxLabel = minLabel + static_cast<int>(taskOfLabel.size()) - 1;
+  for (int k = extent[4]; k <= extent[5]; k++)
+    {
+    for (int j = extent[2]; j <= extent[3]; j++)
+      {
+      for (int i = extent[0]; i <= extent[1]; i++, inPtr += numberOfComponents)
+        {
+        double value = static_cast<double>(*inPtr);
+        if (value < minLabel || value > maxLabel ||
+            value != floor(value))
+          {
+          continue;
+          }
+        int task = taskOfLabel[static_cast<int>(value) - minLabel];
+        if (task < 0)
+          {
+          continue;
+          }
+        LabelTask& labelTask = tasks[task];
+        if (labelTask.NumberOfVoxels == 0)
+          {
+          labelTask.Extent[0] = labelTask.Extent[1] = i;
+          labelTask.Extent[2] = labelTask.Extent[3] = j;
+          labelTask.Extent[4] = labelTask.Extent[5] = k;
+          }
+        else
+          {
+          labelTask.Extent[0] = std::min(labelTask.Extent[0], i);
+          labelTask.Extent[1] = std::max(labelTask.Extent[1], i);
+          labelTask.Extent[2] = std::min(labelTask.Extent[2], j);
+          labelTask.Extent[3] = std::max(labelTask.Extent[3], j);
+          labelTask.Extent[5] = k;
+          }
+        labelTask.NumberOfVoxels++;
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Threshold the label into labelImage, whose extent is the bounding box of
+// the label grown by a voxel. The voxels out of the image are 0, like the
+// padding of the whole image.
+template <class T>
+void ExtractLabel(vtkImageData* image, T* vtkNotUsed(dummy), int label,
+                  vtkImageData* labelImage)
+{
+  int extent[6];
+  image->GetExtent(extent);
+  int labelExtent[6];
+  labelImage->GetExtent(labelExtent);
+  int numberOfComponents = image->GetNumberOfScalarComponents();
+  int rowLength = labelExtent[1] - labelExtent[0] + 1;
+  int iMin = std::max(extent[0], labelExtent[0]);
+  int iMax = std::min(extent[1], labelExtent[1]);
+  T labelValue = static_cast<T>(label);
+  unsigned char* outPtr = static_cast<unsigned char*>(labelImage->GetScalarPointer());
+  for (int k = labelExtent[4]; k <= labelExtent[5]; k++)
+    {
+    for (int j = labelExtent[2]; j <= labelExtent[3]; j++, outPtr += rowLength)
+      {
+      memset(outPtr, 0, rowLength);
+      if (k < extent[4] || k > extent[5] || j < extent[2] || j > extent[3])
+        {
+        continue;
+        }
+      T* inPtr = static_cast<T*>(image->GetScalarPointer(iMin, j, k));
+      for (int i = iMin; i <= iMax; i++, inPtr += numberOfComponents)
+        {
+        if (*inPtr == labelValue)
+          {
+          outPtr[i - labelExtent[0]] = 200;
+          }
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void WriteIntermediateModel(LabelWorkerPool* pool, vtkPolyData* polyData,
+                            const std::string& name)
+{
+  std::string fileName = ModelFileName(pool->RootDir, name);
+  vtkSmartPointer<vtkPolyDataWriter> writer = vtkSmartPointer<vtkPolyDataWriter>::New();
+  writer->SetInput(polyData);
+  writer->SetFileType(2);
+  writer->SetFileName(fileName.c_str());
+  if (!writer->Write())
+    {
+    pool->Lock.Lock();
+    std::cerr << "ERROR: Failed to write intermediate file " << fileName.c_str() << std::endl;
+    pool->Lock.Unlock();
+    }
+  writer->SetInput(NULL);
+}
+
+//----------------------------------------------------------------------------
+// Same filters as the serial loop, on the cropped label, without joint
+// smoothing. Return false if the model can't be made.
+bool MakeLabelModel(LabelWorkerPool* pool, LabelTask& task)
+{
+  // grow the bounding box by a voxel so that the surface is closed, but
+  // not out of the image if it isn't padded
+  int labelExtent[6];
+  int imageExtent[6];
+  pool->Image->GetExtent(imageExtent);
+  for (int axis = 0; axis < 3; axis++)
+    {
+    labelExtent[2 * axis] = task.Extent[2 * axis] - 1;
+    labelExtent[2 * axis + 1] = task.Extent[2 * axis + 1] + 1;
+    if (!pool->Pad)
+      {
+      labelExtent[2 * axis] = std::max(labelExtent[2 * axis], imageExtent[2 * axis]);
+      labelExtent[2 * axis + 1] = std::min(labelExtent[2 * axis + 1], imageExtent[2 * axis + 1]);
+      }
+    }
+  vtkSmartPointer<vtkImageData> labelImage = vtkSmartPointer<vtkImageData>::New();
+  labelImage->SetOrigin(pool->Image->GetOrigin());
+  labelImage->SetSpacing(pool->Image->GetSpacing());
+  labelImage->SetExtent(labelExtent);
+  labelImage->SetWholeExtent(labelExtent);
+  labelImage->SetScalarTypeToUnsignedChar();
+  labelImage->SetNumberOfScalarComponents(1);
+  labelImage->AllocateScalars();
+  switch (pool->Image->GetScalarType())
+    {
+    vtkTemplateMacro(ExtractLabel(pool->Image, static_cast<VTK_TT*>(0),
+                                  task.Label, labelImage));
+    default:
+      return false;
+    }
+
+  vtkSmartPointer<vtkMarchingCubes> mcubes = vtkSmartPointer<vtkMarchingCubes>::New();
+  mcubes->SetInput(labelImage);
+  mcubes->SetValue(0, 100.5);
+  mcubes->ComputeScalarsOff();
+  mcubes->ComputeGradientsOff();
+  mcubes->ComputeNormalsOff();
+  mcubes->Update();
+  if ((mcubes->GetOutput())->GetNumberOfPolys() == 0)
+    {
+    pool->Lock.Lock();
+    std::cout << "Cannot create a model from label " << task.Label
+              << "\nNo polygons can be created,\nthere may be no voxels with this label in the volume." << endl;
+    pool->Lock.Unlock();
+    return false;
+    }
+  if (pool->SaveIntermediateModels)
+    {
+    WriteIntermediateModel(pool, mcubes->GetOutput(), task.Name + std::string("-MarchingCubes.vtk"));
+    }
+
+  vtkSmartPointer<vtkDecimatePro> decimator = vtkSmartPointer<vtkDecimatePro>::New();
+  decimator->SetInput(mcubes->GetOutput());
+  decimator->SetFeatureAngle(60);
+  decimator->SplittingOff();
+  decimator->PreserveTopologyOn();
+  decimator->SetMaximumError(1);
+  decimator->SetTargetReduction(pool->Decimate);
+  decimator->Update();
+  if (pool->SaveIntermediateModels)
+    {
+    WriteIntermediateModel(pool, decimator->GetOutput(), task.Name + std::string("-Decimated.vtk"));
+    }
+
+  vtkPolyData* polyData = decimator->GetOutput();
+  vtkSmartPointer<vtkReverseSense> reverser;
+  if (pool->Reverse)
+    {
+    reverser = vtkSmartPointer<vtkReverseSense>::New();
+    reverser->SetInput(polyData);
+    reverser->ReverseNormalsOn();
+    polyData = reverser->GetOutput();
+    }
+
+  vtkSmartPointer<vtkWindowedSincPolyDataFilter> smootherSinc;
+  vtkSmartPointer<vtkSmoothPolyDataFilter>       smootherPoly;
+  if (pool->SincFilter)
+    {
+    smootherSinc = vtkSmartPointer<vtkWindowedSincPolyDataFilter>::New();
+    smootherSinc->SetPassBand(0.1);
+    smootherSinc->SetInput(polyData);
+    smootherSinc->SetNumberOfIterations(pool->Smooth);
+    smootherSinc->FeatureEdgeSmoothingOff();
+    smootherSinc->BoundarySmoothingOff();
+    smootherSinc->Update();
+    polyData = smootherSinc->GetOutput();
+    }
+  else
+    {
+    smootherPoly = vtkSmartPointer<vtkSmoothPolyDataFilter>::New();
+    smootherPoly->SetRelaxationFactor(0.33);
+    smootherPoly->SetFeatureAngle(60);
+    smootherPoly->SetConvergence(0);
+    smootherPoly->SetInput(polyData);
+    smootherPoly->SetNumberOfIterations(pool->Smooth);
+    smootherPoly->FeatureEdgeSmoothingOff();
+    smootherPoly->BoundarySmoothingOff();
+    smootherPoly->Update();
+    polyData = smootherPoly->GetOutput();
+    }
+  if (pool->SaveIntermediateModels)
+    {
+    WriteIntermediateModel(pool, polyData, task.Name + std::string("-Smoothed.vtk"));
+    }
+
+  // each thread has its own transform
+  vtkSmartPointer<vtkTransform> transformIJKtoRAS = vtkSmartPointer<vtkTransform>::New();
+  transformIJKtoRAS->SetMatrix(pool->IJKToRAS);
+  vtkSmartPointer<vtkTransformPolyDataFilter> transformer = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
+  transformer->SetInput(polyData);
+  transformer->SetTransform(transformIJKtoRAS);
+
+  vtkSmartPointer<vtkPolyDataNormals> normals = vtkSmartPointer<vtkPolyDataNormals>::New();
+  normals->SetComputePointNormals(pool->PointNormals);
+  normals->SetInput(transformer->GetOutput());
+  normals->SetFeatureAngle(60);
+  normals->SetSplitting(pool->SplitNormals);
+
+  vtkSmartPointer<vtkStripper> stripper = vtkSmartPointer<vtkStripper>::New();
+  stripper->SetInput(normals->GetOutput());
+  (stripper->GetOutput())->Update();
+
+  task.FileName = ModelFileName(pool->RootDir, task.Name + std::string(".vtk"));
+  vtkSmartPointer<vtkPolyDataWriter> writer = vtkSmartPointer<vtkPolyDataWriter>::New();
+  writer->SetInput(stripper->GetOutput());
+  writer->SetFileType(2);
+  writer->SetFileName(task.FileName.c_str());
+  if (!writer->Write())
+    {
+    pool->Lock.Lock();
+    std::cerr << "ERROR: Failed to write model file " << task.FileName.c_str() << std::endl;
+    pool->Lock.Unlock();
+    }
+  writer->SetInput(NULL);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void ReportLabelProgress(LabelWorkerPool* pool, const LabelTask& task)
+{
+  double progress = pool->ProgressStart + (1.0 - pool->ProgressStart) *
+    pool->DoneTasks / pool->Tasks->size();
+  std::string comment = "Made " + task.Name;
+  ModuleProcessInformation* info = pool->ProcessInformation;
+  if (info)
+    {
+    strncpy(info->ProgressMessage, comment.c_str(), 1023);
+    info->Progress = progress;
+    info->StageProgress = 0;
+    if (info->ProgressCallbackFunction && info->ProgressCallbackClientData)
+      {
+      (*(info->ProgressCallbackFunction))(info->ProgressCallbackClientData);
+      }
+    }
+  else if (!pool->Debug)
+    {
+    std::cout << "<filter-progress>" << progress << "</filter-progress>" << std::endl;
+    std::cout << std::flush;
+    }
+}
+
+//----------------------------------------------------------------------------
+// Worker of the pool: make the next label until there is none left
+VTK_THREAD_RETURN_TYPE LabelWorker(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  LabelWorkerPool* pool = static_cast<LabelWorkerPool*>(info->UserData);
+  while (true)
+    {
+    pool->Lock.Lock();
+    if (pool->Failed || pool->NextTask >= pool->Tasks->size() ||
+        (pool->ProcessInformation && pool->ProcessInformation->Abort))
+      {
+      pool->Lock.Unlock();
+      break;
+      }
+    LabelTask& task = (*pool->Tasks)[pool->NextTask++];
+    if (pool->Debug)
+      {
+      std::cout << "Thread " << info->ThreadID << " makes model " << task.Name << std::endl;
+      }
+    pool->Lock.Unlock();
+
+    bool made = false;
+    bool failed = false;
+    try
+      {
+      made = MakeLabelModel(pool, task);
+      }
+    catch(...)
+      {
+      failed = true;
+      }
+
+    pool->Lock.Lock();
+    task.Made = made;
+    if (failed)
+      {
+      std::cerr << "ERROR while making the model of label " << task.Label << std::endl;
+      pool->Failed = true;
+      }
+    pool->DoneTasks++;
+    ReportLabelProgress(pool, task);
+    pool->Lock.Unlock();
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+// Add the model node, its storage and display nodes to the scene, under the
+// matching color hierarchy node if any, or under the model hierarchy node.
+void AddModelToScene(vtkMRMLScene* modelScene, const std::string& labelName,
+                     const std::string& fileName, int i,
+                     vtkMRMLColorTableNode* colorNode,
+                     vtkMRMLModelHierarchyNode* topColorHierarchyNode,
+                     vtkMRMLNode* rnd, bool debug)
+{
+  // each model needs a mrml node, a storage node and a display node
+  vtkSmartPointer<vtkMRMLModelNode> mnode = vtkSmartPointer<vtkMRMLModelNode>::New();
+  mnode->SetScene(modelScene);
+  mnode->SetName(labelName.c_str());
+
+  vtkSmartPointer<vtkMRMLModelStorageNode> snode = vtkSmartPointer<vtkMRMLModelStorageNode>::New();
+  snode->SetFileName(fileName.c_str());
+  if (modelScene->AddNode(snode) == NULL)
+    {
+    std::cerr << "ERROR: unable to add the storage node to the model scene" << endl;
+    }
+  vtkSmartPointer<vtkMRMLModelDisplayNode> dnode = vtkSmartPointer<vtkMRMLModelDisplayNode>::New();
+  dnode->SetColor(0.5, 0.5, 0.5);
+  double *rgba;
+  if (colorNode != NULL)
+    {
+    rgba = colorNode->GetLookupTable()->GetTableValue(i);
+    if (rgba != NULL)
+      {
+      if (debug)
+        {
+        std::cout << "Got colour: " << rgba[0] << " " << rgba[1] << " " << rgba[2] << " " << rgba[3] << endl;
+        }
+      dnode->SetColor(rgba[0], rgba[1], rgba[2]);
+      }
+    else
+      {
+      std::cerr << "Couldn't get look up table value for " << i << ", display node colour is not set (grey)"
+                << endl;
+      }
+    }
+
+  dnode->SetVisibility(1);
+  modelScene->AddNode(dnode);
+  if (debug)
+    {
+    std::cout << "Added display node: id = " << (dnode->GetID() == NULL ? "(null)" : dnode->GetID()) << endl;
+    std::cout << "Setting model's storage node: id = "
+              << (snode->GetID() == NULL ? "(null)" : snode->GetID()) << endl;
+    }
+  mnode->SetAndObserveStorageNodeID(snode->GetID());
+  mnode->SetAndObserveDisplayNodeID(dnode->GetID());
+  modelScene->AddNode(mnode);
+
+  // put it in the hierarchy, either the flat one by default or 
+  // try to find the matching color hierarchy node to make this an
+  // associated node
+  std::string colorName;
+  if (colorNode != NULL)
+    {
+    colorName = std::string(colorNode->GetColorNameAsFileName(i));
+    }
+  else
+    {
+    // might be in a testing case where the hierarchy nodes are
+    // numbered (made from the generic colors)
+    std::stringstream ss;
+    ss << i;
+    colorName = ss.str();
+    if (debug)
+      {
+      std::cout << "No color node, guessing at color name being same as label number " << colorName.c_str() << std::endl;
+      }
+    }
+  vtkMRMLNode *mrmlNode = NULL;
+  if (colorName.compare("") != 0)
+    {
+    mrmlNode = modelScene->GetFirstNodeByName(colorName.c_str());
+    }
+  // if there's no color hierarchy, or no color name or the mrml node
+  // named for the color isn't a model hierarchy node, use a flat hierarchy
+  if (topColorHierarchyNode == NULL ||
+      colorName.compare("") == 0 ||
+      mrmlNode == NULL ||
+      strcmp(mrmlNode->GetClassName(),"vtkMRMLModelHierarchyNode") != 0)
+    {
+    vtkSmartPointer<vtkMRMLModelHierarchyNode> mhnd = vtkSmartPointer<vtkMRMLModelHierarchyNode>::New();
+    mhnd->SetHideFromEditors(1);
+    modelScene->AddNode(mhnd);
+    mhnd->SetParentNodeID(rnd->GetID());
+    mhnd->SetModelNodeID(mnode->GetID());
+    mhnd = NULL;
+    }
+  else
+    {
+    // use the template color hierarchy
+    vtkMRMLModelHierarchyNode *colorHierarchyNode = vtkMRMLModelHierarchyNode::SafeDownCast(mrmlNode);
+    if (colorHierarchyNode)
+      {
+      colorHierarchyNode->SetAssociatedNodeID(mnode->GetID());
+      // and hide it so that it doesn't clutter up the tree
+      colorHierarchyNode->SetHideFromEditors(1);
+      if (debug)
+        {
+        std::cout << "Found a color hierarchy node with name " << colorHierarchyNode->GetName() << ", set it's associated node to this model id: " << mnode->GetID() << std::endl;
+        }
+      }
+    }
+  if (debug)
+    {
+    std::cout << "...done adding model to output scene" << endl;
+    }
+  // clean up
+  dnode = NULL;
+  snode = NULL;
+  mnode = NULL;
+}
+
+}
+
 int main(int argc, char * argv[])
 {
   PARSE_ARGS;
@@ -74,6 +577,7 @@ int main(int argc, char * argv[])
     std::cout << "Split normals? " << SplitNormals << std::endl;
     std::cout << "Calculate point normals? " << PointNormals << std::endl;
     std::cout << "Pad? " << Pad << std::endl;
+    std::cout << "Number of threads: " << NumberOfThreads << std::endl;
     std::cout << "Filter type: " << FilterType << std::endl;
     std::cout << "Input color hierarchy scene file: "
               << (ModelHierarchyFile.size() > 0 ? ModelHierarchyFile.c_str() : "None")  << std::endl;
@@ -858,6 +1362,20 @@ int main(int argc, char * argv[])
       loopLabels.push_back(Labels[i]);
       }
     }
+
+  // without joint smoothing, the labels can be made concurrently
+  int numberOfThreads = NumberOfThreads;
+  if (numberOfThreads == 0)
+    {
+    numberOfThreads = vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
+    }
+  bool                   parallel = (JointSmoothing == 0 && numberOfThreads > 1 && loopLabels.size() > 1);
+  std::vector<LabelTask> tasks;
+  if (debug)
+    {
+    std::cout << "Number of threads = " << numberOfThreads << ", parallel = " << parallel << endl;
+    }
+
   for(::size_t l = 0; l < loopLabels.size(); l++)
     {
     // get the label out of the vector
@@ -968,6 +1486,18 @@ int main(int argc, char * argv[])
       */
       }
 
+    if (parallel)
+      {
+      // the model is made by the worker pool after the loop
+      LabelTask task;
+      task.Label = i;
+      task.Name = labelName;
+      task.NumberOfVoxels = 0;
+      task.Made = false;
+      tasks.push_back(task);
+      continue;
+      }
+
     // threshold
     if (JointSmoothing == 0)
       {
@@ -1612,115 +2142,108 @@ int main(int argc, char * argv[])
           std::cout << "Adding model " << labelName << " to the output scene, with filename " << fileName.c_str()
                     << endl;
           }
-        // each model needs a mrml node, a storage node and a display node
-        vtkSmartPointer<vtkMRMLModelNode> mnode = vtkSmartPointer<vtkMRMLModelNode>::New();
-        mnode->SetScene(modelScene);
-        mnode->SetName(labelName.c_str());
-
-        vtkSmartPointer<vtkMRMLModelStorageNode> snode = vtkSmartPointer<vtkMRMLModelStorageNode>::New();
-        snode->SetFileName(fileName.c_str());
-        if (modelScene->AddNode(snode) == NULL)
-          {
-          std::cerr << "ERROR: unable to add the storage node to the model scene" << endl;
-          }
-        vtkSmartPointer<vtkMRMLModelDisplayNode> dnode = vtkSmartPointer<vtkMRMLModelDisplayNode>::New();
-        dnode->SetColor(0.5, 0.5, 0.5);
-        double *rgba;
-        if (colorNode != NULL)
-          {
-          rgba = colorNode->GetLookupTable()->GetTableValue(i);
-          if (rgba != NULL)
-            {
-            if (debug)
-              {
-              std::cout << "Got colour: " << rgba[0] << " " << rgba[1] << " " << rgba[2] << " " << rgba[3] << endl;
-              }
-            dnode->SetColor(rgba[0], rgba[1], rgba[2]);
-            }
-          else
-            {
-            std::cerr << "Couldn't get look up table value for " << i << ", display node colour is not set (grey)"
-                      << endl;
-            }
-          }
+        AddModelToScene(modelScene, labelName, fileName, i, colorNode,
+                        topColorHierarchyNode, rnd, debug);
+        }
+      } // end of skipping an empty label
+    }   // end of loop over labels
 
-        dnode->SetVisibility(1);
-        modelScene->AddNode(dnode);
-        if (debug)
-          {
-          std::cout << "Added display node: id = " << (dnode->GetID() == NULL ? "(null)" : dnode->GetID()) << endl;
-          std::cout << "Setting model's storage node: id = "
-                    << (snode->GetID() == NULL ? "(null)" : snode->GetID()) << endl;
-          }
-        mnode->SetAndObserveStorageNodeID(snode->GetID());
-        mnode->SetAndObserveDisplayNodeID(dnode->GetID());
-        modelScene->AddNode(mnode);
-
-        // put it in the hierarchy, either the flat one by default or 
-        // try to find the matching color hierarchy node to make this an
-        // associated node
-        std::string colorName;
-        if (colorNode != NULL)
-          {
-          colorName = std::string(colorNode->GetColorNameAsFileName(i));
-          }
-        else
-          {
-          // might be in a testing case where the hierarchy nodes are
-          // numbered (made from the generic colors)
-          std::stringstream ss;
-          ss << i;
-          colorName = ss.str();
-          if (debug)
-            {
-            std::cout << "No color node, guessing at color name being same as label number " << colorName.c_str() << std::endl;
-            }
-          }
-        vtkMRMLNode *mrmlNode = NULL;
-        if (colorName.compare("") != 0)
-          {
-          mrmlNode = modelScene->GetFirstNodeByName(colorName.c_str());
-          }
-        // if there's no color hierarchy, or no color name or the mrml node
-        // named for the color isn't a model hierarchy node, use a flat hierarchy
-        if (topColorHierarchyNode == NULL ||
-            colorName.compare("") == 0 ||
-            mrmlNode == NULL ||
-            strcmp(mrmlNode->GetClassName(),"vtkMRMLModelHierarchyNode") != 0)
-          {
-          vtkSmartPointer<vtkMRMLModelHierarchyNode> mhnd = vtkSmartPointer<vtkMRMLModelHierarchyNode>::New();
-          mhnd->SetHideFromEditors(1);
-          modelScene->AddNode(mhnd);
-          mhnd->SetParentNodeID(rnd->GetID());
-          mhnd->SetModelNodeID(mnode->GetID());
-          mhnd = NULL;
-          }
-        else
-          {
-          // use the template color hierarchy
-          vtkMRMLModelHierarchyNode *colorHierarchyNode = vtkMRMLModelHierarchyNode::SafeDownCast(mrmlNode);
-          if (colorHierarchyNode)
-            {
-            colorHierarchyNode->SetAssociatedNodeID(mnode->GetID());
-            // and hide it so that it doesn't clutter up the tree
-            colorHierarchyNode->SetHideFromEditors(1);
-            if (debug)
-              {
-              std::cout << "Found a color hierarchy node with name " << colorHierarchyNode->GetName() << ", set it's associated node to this model id: " << mnode->GetID() << std::endl;
-              }
-            }
-          }
+  if (parallel && tasks.size() > 0)
+    {
+    // find the bounding box of all the labels in one pass, so that each
+    // model is made from the subvolume of its label only
+    int minLabel = tasks[0].Label;
+    int maxLabel = tasks[0].Label;
+    for(::size_t t = 0; t < tasks.size(); t++)
+      {
+      minLabel = std::min(minLabel, tasks[t].Label);
+      maxLabel = std::max(maxLabel, tasks[t].Label);
+      }
+    std::vector<int> taskOfLabel(maxLabel - minLabel + 1, -1);
+    for(::size_t t = 0; t < tasks.size(); t++)
+      {
+      taskOfLabel[tasks[t].Label - minLabel] = static_cast<int>(t);
+      }
+    switch (image->GetScalarType())
+      {
+      vtkTemplateMacro(ComputeLabelBounds(image, static_cast<VTK_TT*>(image->GetScalarPointer()),
+                                          minLabel, taskOfLabel, tasks));
+      default:
+        std::cerr << "ERROR: unknown scalar type of the input volume." << std::endl;
+        return EXIT_FAILURE;
+      }
+    // the labels without voxels make no model
+    std::vector<LabelTask> labelTasks;
+    for(::size_t t = 0; t < tasks.size(); t++)
+      {
+      if (tasks[t].NumberOfVoxels > 0)
+        {
+        labelTasks.push_back(tasks[t]);
+        }
+      else
+        {
+        std::cout << "Cannot create a model from label " << tasks[t].Label
+                  << "\nthere are no voxels with this label in the volume." << endl;
+        }
+      }
+
+    if (strcmp(FilterType.c_str(), "Sinc") == 0 && Smooth == 1)
+      {
+      std::cerr << "Warning: Smoothing iterations of 1 not allowed for Sinc filter, using 2" << endl;
+      Smooth = 2;
+      }
+    vtkSmartPointer<vtkMatrix4x4> matrixIJKtoRAS = vtkSmartPointer<vtkMatrix4x4>::New();
+    matrixIJKtoRAS->DeepCopy(transformIJKtoRAS->GetMatrix());
+
+    LabelWorkerPool pool;
+    pool.Tasks = &labelTasks;
+    pool.Image = image;
+    pool.IJKToRAS = matrixIJKtoRAS;
+    pool.Reverse = (matrixIJKtoRAS->Determinant() < 0);
+    pool.SincFilter = (strcmp(FilterType.c_str(), "Sinc") == 0);
+    pool.Smooth = Smooth;
+    pool.Decimate = Decimate;
+    pool.SplitNormals = SplitNormals;
+    pool.PointNormals = PointNormals;
+    pool.Pad = Pad;
+    pool.SaveIntermediateModels = SaveIntermediateModels;
+    pool.Debug = debug;
+    pool.RootDir = rootDir;
+    pool.ProcessInformation = CLPProcessInformation;
+    pool.ProgressStart = currentFilterOffset / numFilterSteps;
+    pool.NextTask = 0;
+    pool.DoneTasks = 0;
+    pool.Failed = false;
+
+    if (labelTasks.size() > 0)
+      {
+      vtkSmartPointer<vtkMultiThreader> threader = vtkSmartPointer<vtkMultiThreader>::New();
+      threader->SetNumberOfThreads(
+        static_cast<int>(std::min(static_cast< ::size_t>(numberOfThreads), labelTasks.size())));
+      threader->SetSingleMethod(LabelWorker, &pool);
+      threader->SingleMethodExecute();
+      }
+    if (pool.Failed)
+      {
+      return EXIT_FAILURE;
+      }
+
+    // add the models to the scene in the order of the labels, like the
+    // serial loop
+    for(::size_t t = 0; t < labelTasks.size(); t++)
+      {
+      if (labelTasks[t].Made && modelScene != NULL)
+        {
         if (debug)
           {
-          std::cout << "...done adding model to output scene" << endl;
+          std::cout << "Adding model " << labelTasks[t].Name << " to the output scene, with filename "
+                    << labelTasks[t].FileName.c_str() << endl;
           }
-        // clean up
-        dnode = NULL;
-        snode = NULL;
-        mnode = NULL;
+        AddModelToScene(modelScene, labelTasks[t].Name, labelTasks[t].FileName, labelTasks[t].Label,
+                        colorNode, topColorHierarchyNode, rnd, debug);
         }
-      } // end of skipping an empty label
-    }   // end of loop over labels
+      }
+    }
   if (debug)
     {
     std::cout << "End of looping over labels" << endl;
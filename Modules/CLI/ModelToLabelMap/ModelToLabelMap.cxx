@@ -25,6 +25,7 @@
 #include "itkBinaryThresholdImageFunction.h"
 #include "itkFloodFilledImageFunctionConditionalIterator.h"
 #include "itkImageFileWriter.h"
+#include "itkMultiThreader.h"
 #include "itkPluginUtilities.h"
 #ifdef ITKV3_COMPATIBILITY
 #include "itkAnalyzeImageIOFactory.h"
@@ -36,8 +37,14 @@
 #include <vtkSmartPointer.h>
 #include <vtkPolyDataPointSampler.h>
 #include <vtkPolyDataReader.h>
+#include <vtkTriangleFilter.h>
 #include <vtkXMLPolyDataReader.h>
 
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 typedef itk::Image<unsigned char, 3> LabelImageType;
 
 LabelImageType::Pointer BinaryErodeFilter3D( LabelImageType::Pointer & img, unsigned int ballsize )
@@ -93,6 +100,219 @@ LabelImageType::Pointer BinaryClosingFilter3D( LabelImageType::Pointer & img, un
   return BinaryErodeFilter3D( imgDilate, ballsize );
 }
 
+vtkSmartPointer<vtkPolyData> ReadPolyData( const std::string & fileName )
+{
+  vtkSmartPointer<vtkPolyData> polyData;
+
+  // do we have vtk or vtp models?
+  std::string::size_type loc = fileName.find_last_of(".");
+  if( loc == std::string::npos )
+    {
+    std::cerr << "Failed to find an extension for " << fileName << std::endl;
+    return polyData;
+    }
+  std::string extension = fileName.substr(loc);
+
+  if( extension == std::string(".vtk") )
+    {
+    vtkNew<vtkPolyDataReader> pdReader;
+    pdReader->SetFileName(fileName.c_str() );
+    pdReader->Update();
+    polyData = pdReader->GetOutput();
+    }
+  else if( extension == std::string(".vtp") )
+    {
+    vtkNew<vtkXMLPolyDataReader> pdxReader;
+    pdxReader->SetFileName(fileName.c_str() );
+    pdxReader->Update();
+    polyData = pdxReader->GetOutput();
+    }
+  if( polyData == NULL )
+    {
+    std::cerr << "Failed to read surface " << fileName << std::endl;
+    }
+  return polyData;
+}
+
+// Triangles of a model in the continuous index space of the label map
+struct RasterModel
+{
+  // x, y, z of each point
+  std::vector<double> Points;
+  // 3 point ids by triangle
+  std::vector<vtkIdType> Triangles;
+  // Triangles crossing the plane of each slice
+  std::vector<std::vector<vtkIdType> > SliceTriangles;
+  unsigned char Label;
+};
+
+struct RasterThreadData
+{
+  std::vector<RasterModel> * Models;
+  LabelImageType::PixelType *Buffer;
+  int                        Size[3];
+};
+
+// A voxel centre is inside a model when the number of times the model
+// surface crosses its row, before it, is odd.  The half-open tests
+// (a < k) != (b < k) count a vertex lying on a slice plane or on a row
+// once, so closed surfaces always give an even number of crossings.
+void RasterizeSlice( const RasterModel & model, int slice, const int size[3],
+                     std::vector<std::vector<double> > & rowCrossings,
+                     LabelImageType::PixelType * sliceBuffer )
+{
+  for( int j = 0; j < size[1]; ++j )
+    {
+    rowCrossings[j].clear();
+    }
+
+  const std::vector<vtkIdType> & triangles = model.SliceTriangles[slice];
+  const double                   z = slice;
+  for( size_t t = 0; t < triangles.size(); ++t )
+    {
+    const vtkIdType * ids = &model.Triangles[3 * triangles[t]];
+    // intersection of the triangle with the slice plane
+    double segment[2][2];
+    int    numberOfEnds = 0;
+    for( int e = 0; e < 3 && numberOfEnds < 2; ++e )
+      {
+      const double * a = &model.Points[3 * ids[e]];
+      const double * b = &model.Points[3 * ids[(e + 1) % 3]];
+      if( (a[2] < z) != (b[2] < z) )
+        {
+        const double s = (z - a[2]) / (b[2] - a[2]);
+        segment[numberOfEnds][0] = a[0] + s * (b[0] - a[0]);
+        segment[numberOfEnds][1] = a[1] + s * (b[1] - a[1]);
+        ++numberOfEnds;
+        }
+      }
+    if( numberOfEnds < 2 || segment[0][1] == segment[1][1] )
+      {
+      continue;
+      }
+    // crossings of the segment with the rows (p.y, q.y]
+    const double * p = segment[0];
+    const double * q = segment[1];
+    if( p[1] > q[1] )
+      {
+      std::swap(p, q);
+      }
+    const int firstRow = std::max(static_cast<int>(std::floor(p[1]) ) + 1, 0);
+    const int lastRow = std::min(static_cast<int>(std::floor(q[1]) ), size[1] - 1);
+    const double slope = (q[0] - p[0]) / (q[1] - p[1]);
+    for( int j = firstRow; j <= lastRow; ++j )
+      {
+      rowCrossings[j].push_back(p[0] + (j - p[1]) * slope);
+      }
+    }
+
+  // even-odd filling of the spans [x0, x1) of each row
+  for( int j = 0; j < size[1]; ++j )
+    {
+    std::vector<double> & crossings = rowCrossings[j];
+    std::sort(crossings.begin(), crossings.end() );
+    LabelImageType::PixelType * row = sliceBuffer + j * size[0];
+    for( size_t c = 0; c + 1 < crossings.size(); c += 2 )
+      {
+      const int first = std::max(static_cast<int>(std::ceil(crossings[c]) ), 0);
+      const int last = std::min(static_cast<int>(std::ceil(crossings[c + 1]) ) - 1,
+                                size[0] - 1);
+      if( first <= last )
+        {
+        std::fill(row + first, row + last + 1, model.Label);
+        }
+      }
+    }
+}
+
+ITK_THREAD_RETURN_TYPE RasterizeThreaderCallback( void * arg )
+{
+  itk::MultiThreader::ThreadInfoStruct * threadInfo =
+    static_cast<itk::MultiThreader::ThreadInfoStruct *>(arg);
+  RasterThreadData * data = static_cast<RasterThreadData *>(threadInfo->UserData);
+
+  // the slices are interleaved between the threads and each thread only
+  // writes to its own slices
+  std::vector<std::vector<double> > rowCrossings(data->Size[1]);
+  const size_t                      sliceSize = static_cast<size_t>(data->Size[0]) * data->Size[1];
+  for( int k = threadInfo->ThreadID; k < data->Size[2]; k += threadInfo->NumberOfThreads )
+    {
+    for( size_t m = 0; m < data->Models->size(); ++m )
+      {
+      RasterizeSlice( (*data->Models)[m], k, data->Size, rowCrossings,
+                      data->Buffer + k * sliceSize );
+      }
+    }
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+// Transform the triangles of a RAS model into the index space of the label
+// map and sort them by slice
+bool BuildRasterModel( vtkPolyData * polyData, LabelImageType * label,
+                       unsigned char labelValue, RasterModel & model )
+{
+  const int numberOfSlices = label->GetLargestPossibleRegion().GetSize()[2];
+  model.Label = labelValue;
+  model.SliceTriangles.resize(numberOfSlices);
+
+  vtkNew<vtkTriangleFilter> triangulator;
+  triangulator->SetInput( polyData );
+  triangulator->PassVertsOff();
+  triangulator->PassLinesOff();
+  triangulator->Update();
+  vtkPolyData * triangles = triangulator->GetOutput();
+  if( triangles->GetNumberOfPolys() == 0 )
+    {
+    return false;
+    }
+
+  model.Points.resize(3 * triangles->GetNumberOfPoints() );
+  for( vtkIdType k = 0; k < triangles->GetNumberOfPoints(); ++k )
+    {
+    double *                  pt = triangles->GetPoint( k );
+    LabelImageType::PointType pitk;
+    // LPS vs RAS
+    pitk[0] = -pt[0];
+    pitk[1] = -pt[1];
+    pitk[2] = pt[2];
+    itk::ContinuousIndex<double, 3> cidx;
+    label->TransformPhysicalPointToContinuousIndex( pitk, cidx );
+    for( int m = 0; m < 3; ++m )
+      {
+      model.Points[3 * k + m] = cidx[m];
+      }
+    }
+
+  model.Triangles.reserve(3 * triangles->GetNumberOfPolys() );
+  vtkCellArray * polys = triangles->GetPolys();
+  vtkIdType      npts = 0;
+  vtkIdType *    pts = 0;
+  for( polys->InitTraversal(); polys->GetNextCell(npts, pts); )
+    {
+    if( npts != 3 )
+      {
+      continue;
+      }
+    const vtkIdType triangle = model.Triangles.size() / 3;
+    double          zmin = model.Points[3 * pts[0] + 2];
+    double          zmax = zmin;
+    for( int m = 0; m < 3; ++m )
+      {
+      model.Triangles.push_back(pts[m]);
+      zmin = std::min(zmin, model.Points[3 * pts[m] + 2]);
+      zmax = std::max(zmax, model.Points[3 * pts[m] + 2]);
+      }
+    // the triangle crosses the planes in (zmin, zmax]
+    const int first = std::max(static_cast<int>(std::floor(zmin) ) + 1, 0);
+    const int last = std::min(static_cast<int>(std::floor(zmax) ), numberOfSlices - 1);
+    for( int k = first; k <= last; ++k )
+      {
+      model.SliceTriangles[k].push_back(triangle);
+      }
+    }
+  return true;
+}
+
 //
 // Description: A templated procedure to execute the algorithm
 template <class T>
@@ -123,37 +343,71 @@ int DoIt( int argc, char * argv[])
   label->Allocate();
   label->FillBuffer( 0 );
 
-  // read the poly data
-  vtkSmartPointer<vtkPolyData> polyData;
-  vtkSmartPointer<vtkPolyDataReader> pdReader;
-  vtkSmartPointer<vtkXMLPolyDataReader> pdxReader;
+  typename WriterType::Pointer writer = WriterType::New();
+  itk::PluginFilterWatcher watchWriter(writer,
+                                       "Write Volume",
+                                       CLPProcessInformation);
+  writer->SetFileName( OutputVolume.c_str() );
+  writer->SetInput( label );
+  writer->SetUseCompression(1);
 
-  // do we have vtk or vtp models?
-  std::string::size_type loc = surface.find_last_of(".");
-  if( loc == std::string::npos )
+  if( method == "Scanline" )
     {
-    std::cerr << "Failed to find an extension for " << surface << std::endl;
-    return EXIT_FAILURE;
-    }
-  std::string extension = surface.substr(loc);
+    std::vector<std::string> modelFiles(1, surface);
+    modelFiles.insert(modelFiles.end(), additionalModels.begin(), additionalModels.end() );
 
-  if( extension == std::string(".vtk") )
-    {
-    pdReader = vtkSmartPointer<vtkPolyDataReader>::New();
-    pdReader->SetFileName(surface.c_str() );
-    pdReader->Update();
-    polyData = pdReader->GetOutput();
+    std::vector<RasterModel> models(modelFiles.size() );
+    for( size_t m = 0; m < modelFiles.size(); ++m )
+      {
+      int modelLabel = labelValue;
+      if( m > 0 )
+        {
+        modelLabel = m - 1 < additionalLabels.size() ? additionalLabels[m - 1] : static_cast<int>(m);
+        }
+      if( modelLabel < 1 || modelLabel > 255 )
+        {
+        std::cerr << "Label " << modelLabel << " of " << modelFiles[m]
+                  << " is out of range [1, 255]" << std::endl;
+        return EXIT_FAILURE;
+        }
+      vtkSmartPointer<vtkPolyData> modelPolyData = ReadPolyData( modelFiles[m] );
+      if( modelPolyData == NULL )
+        {
+        return EXIT_FAILURE;
+        }
+      if( !BuildRasterModel( modelPolyData, label, modelLabel, models[m] ) )
+        {
+        std::cerr << "No polygons in surface " << modelFiles[m] << std::endl;
+        }
+      }
+
+    RasterThreadData data;
+    data.Models = &models;
+    data.Buffer = label->GetBufferPointer();
+    for( int m = 0; m < 3; ++m )
+      {
+      data.Size[m] = label->GetLargestPossibleRegion().GetSize()[m];
+      }
+    itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+    const int numberOfThreads = threader->GetNumberOfThreads();
+    threader->SetNumberOfThreads( std::max(std::min(numberOfThreads, data.Size[2]), 1) );
+    threader->SetSingleMethod( RasterizeThreaderCallback, &data );
+    threader->SingleMethodExecute();
+
+    writer->Update();
+    return EXIT_SUCCESS;
     }
-  else if( extension == std::string(".vtp") )
+
+  if( !additionalModels.empty() )
     {
-    pdxReader = vtkSmartPointer<vtkXMLPolyDataReader>::New();
-    pdxReader->SetFileName(surface.c_str() );
-    pdxReader->Update();
-    polyData = pdxReader->GetOutput();
+    std::cerr << "Additional models need the Scanline method" << std::endl;
+    return EXIT_FAILURE;
     }
+
+  // read the poly data
+  vtkSmartPointer<vtkPolyData> polyData = ReadPolyData( surface );
   if( polyData == NULL )
     {
-    std::cerr << "Failed to read surface " << surface << std::endl;
     return EXIT_FAILURE;
     }
 
@@ -237,16 +491,9 @@ int DoIt( int argc, char * argv[])
   for( itLabel.GoToBegin(); !itLabel.IsAtEnd(); ++itLabel )
     {
     LabelImageType::IndexType i = itLabel.GetIndex();
-    label->SetPixel( i, finalLabel->GetPixel(i) );
+    label->SetPixel( i, finalLabel->GetPixel(i) ? labelValue : 0 );
     }
 
-  typename WriterType::Pointer writer = WriterType::New();
-  itk::PluginFilterWatcher watchWriter(writer,
-                                       "Write Volume",
-                                       CLPProcessInformation);
-  writer->SetFileName( OutputVolume.c_str() );
-  writer->SetInput( label );
-  writer->SetUseCompression(1);
   writer->Update();
 
   return EXIT_SUCCESS;
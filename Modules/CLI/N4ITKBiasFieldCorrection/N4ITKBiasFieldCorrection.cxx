@@ -3,6 +3,9 @@
 #include "itkImageFileWriter.h"
 #include "itkOtsuThresholdImageFilter.h"
 #include "itkShrinkImageFilter.h"
+#include "itkStreamingImageFilter.h"
+
+#include "itkBSplineControlPointLatticeImageSource.h"
 
 #if ITK_VERSION_MAJOR >= 4
 // This is  now officially part of ITKv4
@@ -74,6 +77,31 @@ int SaveIt(ImageType::Pointer img, const char* fname, T)
   return EXIT_SUCCESS;
 }
 
+// Cast and write the output of a streamable pipeline, that runs on slabs
+template <class T>
+int StreamIt(ImageType* img, const char* fname, unsigned int numberOfDivisions, T)
+{
+  typedef itk::Image<T, 3>                                 OutputImageType;
+  typedef itk::CastImageFilter<ImageType, OutputImageType> CastType;
+
+  typename CastType::Pointer caster = CastType::New();
+  caster->SetInput(img);
+
+  typedef itk::StreamingImageFilter<OutputImageType, OutputImageType> StreamerType;
+  typename StreamerType::Pointer streamer = StreamerType::New();
+  streamer->SetInput( caster->GetOutput() );
+  streamer->SetNumberOfStreamDivisions( numberOfDivisions );
+
+  typedef  itk::ImageFileWriter<OutputImageType> WriterType;
+  typename WriterType::Pointer writer = WriterType::New();
+  writer->SetInput( streamer->GetOutput() );
+  writer->SetFileName( fname );
+  writer->SetUseCompression(1);
+  writer->Update();
+
+  return EXIT_SUCCESS;
+}
+
 };
 
 int main(int argc, char* * argv)
@@ -99,6 +127,10 @@ int main(int argc, char* * argv)
   reader->SetFileName( inputImageName.c_str() );
   reader->Update();
   inputImage = reader->GetOutput();
+  // Kept to reconstruct the output when streaming: the padded images are
+  // released once they are shrunk
+  ImageType::Pointer originalInputImage = inputImage;
+  const bool         streamOutput = numberOfStreamDivisions > 1;
 
   /**
    * handle he mask image
@@ -277,11 +309,29 @@ int main(int argc, char* * argv)
   shrinker->Update();
   maskshrinker->Update();
 
+  // Domain of the B-spline lattice at full resolution
+  const ImageType::SizeType      domainSize = inputImage->GetLargestPossibleRegion().GetSize();
+  const ImageType::SpacingType   domainSpacing = inputImage->GetSpacing();
+  const ImageType::DirectionType domainDirection = inputImage->GetDirection();
+
+  ImageType::Pointer     shrunkImage = shrinker->GetOutput();
+  MaskImageType::Pointer shrunkMaskImage = maskshrinker->GetOutput();
+  if( streamOutput )
+    {
+    // Only the shrunk images and the input are kept during the fit
+    shrunkImage->DisconnectPipeline();
+    shrunkMaskImage->DisconnectPipeline();
+    shrinker = NULL;
+    maskshrinker = NULL;
+    maskImage = NULL;
+    inputImage = NULL;
+    }
+
   itk::TimeProbe timer;
   timer.Start();
 
-  correcter->SetInput( shrinker->GetOutput() );
-  correcter->SetMaskImage( maskshrinker->GetOutput() );
+  correcter->SetInput( shrunkImage );
+  correcter->SetMaskImage( shrunkMaskImage );
   if( weightImage )
     {
     typedef itk::ShrinkImageFilter<ImageType, ImageType> WeightShrinkerType;
@@ -290,7 +340,13 @@ int main(int argc, char* * argv)
     weightshrinker->SetShrinkFactors( 1 );
     weightshrinker->SetShrinkFactors( shrinkFactor );
     weightshrinker->Update();
-    correcter->SetConfidenceImage( weightshrinker->GetOutput() );
+    ImageType::Pointer shrunkWeightImage = weightshrinker->GetOutput();
+    if( streamOutput )
+      {
+      shrunkWeightImage->DisconnectPipeline();
+      weightImage = NULL;
+      }
+    correcter->SetConfidenceImage( shrunkWeightImage );
     }
 
   typedef CommandIterationUpdate<CorrecterType> CommandType;
@@ -337,7 +393,112 @@ int main(int argc, char* * argv)
   /**
    * ouput
    */
-  if( outputImageName != "" )
+  if( streamOutput && ( outputImageName != "" || outputBiasFieldName != "" ) )
+    {
+    /**
+     * Evaluate the bias field directly on the input grid, slab by slab,
+     * so that the full resolution images are never all in memory.
+     */
+    typedef itk::BSplineControlPointLatticeImageSource<
+      CorrecterType::BiasFieldControlPointLatticeType, ImageType> LogFieldSourceType;
+    LogFieldSourceType::Pointer logField = LogFieldSourceType::New();
+    logField->SetControlPointLattice( correcter->GetLogBiasFieldControlPointLattice() );
+    logField->SetSplineOrder( correcter->GetSplineOrder() );
+    logField->SetDomainOrigin( newOrigin );
+    logField->SetDomainSpacing( domainSpacing );
+    logField->SetDomainSize( domainSize );
+    logField->SetDomainDirection( domainDirection );
+    logField->SetOrigin( originalInputImage->GetOrigin() );
+    logField->SetSpacing( originalInputImage->GetSpacing() );
+    logField->SetDirection( originalInputImage->GetDirection() );
+    logField->SetRegion( originalInputImage->GetLargestPossibleRegion() );
+
+    typedef itk::ExpImageFilter<ImageType, ImageType> ExpFilterType;
+    ExpFilterType::Pointer expFilter = ExpFilterType::New();
+    expFilter->SetInput( logField->GetOutput() );
+
+    if( outputBiasFieldName != "" )
+      {
+      typedef itk::StreamingImageFilter<ImageType, ImageType> StreamerType;
+      StreamerType::Pointer streamer = StreamerType::New();
+      streamer->SetInput( expFilter->GetOutput() );
+      streamer->SetNumberOfStreamDivisions( numberOfStreamDivisions );
+
+      typedef itk::ImageFileWriter<ImageType> WriterType;
+      WriterType::Pointer writer = WriterType::New();
+      writer->SetFileName( outputBiasFieldName.c_str() );
+      writer->SetInput( streamer->GetOutput() );
+      writer->SetUseCompression(1);
+      writer->Update();
+      }
+
+    if( outputImageName == "" )
+      {
+      return EXIT_SUCCESS;
+      }
+
+    typedef itk::DivideImageFilter<ImageType, ImageType, ImageType> DividerType;
+    DividerType::Pointer divider = DividerType::New();
+    divider->SetInput1( originalInputImage );
+    divider->SetInput2( expFilter->GetOutput() );
+
+    try
+      {
+      itk::ImageIOBase::IOPixelType     pixelType;
+      itk::ImageIOBase::IOComponentType componentType;
+
+      itk::GetImageType(inputImageName, pixelType, componentType);
+
+      const char * fname = outputImageName.c_str();
+      ImageType *  corrected = divider->GetOutput();
+
+      switch( componentType )
+        {
+        case itk::ImageIOBase::UCHAR:
+          return StreamIt( corrected, fname, numberOfStreamDivisions, static_cast<unsigned char>(0) );
+          break;
+        case itk::ImageIOBase::CHAR:
+          return StreamIt( corrected, fname, numberOfStreamDivisions, static_cast<char>(0) );
+          break;
+        case itk::ImageIOBase::USHORT:
+          return StreamIt( corrected, fname, numberOfStreamDivisions, static_cast<unsigned short>(0) );
+          break;
+        case itk::ImageIOBase::SHORT:
+          return StreamIt( corrected, fname, numberOfStreamDivisions, static_cast<short>(0) );
+          break;
+        case itk::ImageIOBase::UINT:
+          return StreamIt( corrected, fname, numberOfStreamDivisions, static_cast<unsigned int>(0) );
+          break;
+        case itk::ImageIOBase::INT:
+          return StreamIt( corrected, fname, numberOfStreamDivisions, static_cast<int>(0) );
+          break;
+        case itk::ImageIOBase::ULONG:
+          return StreamIt( corrected, fname, numberOfStreamDivisions, static_cast<unsigned long>(0) );
+          break;
+        case itk::ImageIOBase::LONG:
+          return StreamIt( corrected, fname, numberOfStreamDivisions, static_cast<long>(0) );
+          break;
+        case itk::ImageIOBase::FLOAT:
+          return StreamIt( corrected, fname, numberOfStreamDivisions, static_cast<float>(0) );
+          break;
+        case itk::ImageIOBase::DOUBLE:
+          return StreamIt( corrected, fname, numberOfStreamDivisions, static_cast<double>(0) );
+          break;
+        case itk::ImageIOBase::UNKNOWNCOMPONENTTYPE:
+          std::cerr << "Cannot saved the result using the requested pixel type" << std::endl;
+          return EXIT_FAILURE;
+        default:
+          std::cout << "unknown component type" << std::endl;
+          break;
+        }
+      }
+    catch( itk::ExceptionObject & e )
+      {
+      std::cerr << "Failed to save the data: " << e << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  else if( outputImageName != "" )
     {
     /**
      * Reconsruct the bias field at full image resoluion.  Divide
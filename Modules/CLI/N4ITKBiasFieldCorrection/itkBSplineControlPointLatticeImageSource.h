@@ -0,0 +1,144 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    $RCSfile: itkBSplineControlPointLatticeImageSource.h,v $
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkBSplineControlPointLatticeImageSource_h
+#define __itkBSplineControlPointLatticeImageSource_h
+
+#include "itkImageSource.h"
+#include "itkMatrix.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/**
+ * \class BSplineControlPointLatticeImageSource
+ *
+ * \brief Evaluate the first component of a uniform B-spline control point
+ * lattice on an image grid, one requested region at a time.
+ *
+ * The lattice is parametrized over a domain given by its origin, spacing,
+ * size and direction, as the output of BSplineControlPointImageFilter.  The
+ * output grid can be any part of that domain, and each requested region is
+ * evaluated on its own, so that the source can be streamed: only the
+ * requested region of the output is allocated.
+ */
+template <class TControlPointLattice, class TOutputImage>
+class BSplineControlPointLatticeImageSource
+  : public ImageSource<TOutputImage>
+{
+public:
+  typedef BSplineControlPointLatticeImageSource Self;
+  typedef ImageSource<TOutputImage>             Superclass;
+  typedef SmartPointer<Self>                    Pointer;
+  typedef SmartPointer<const Self>              ConstPointer;
+
+  itkNewMacro( Self );
+
+  itkTypeMacro( BSplineControlPointLatticeImageSource, ImageSource );
+
+  itkStaticConstMacro( ImageDimension, unsigned int,
+                       TOutputImage::ImageDimension );
+
+  typedef TControlPointLattice                     ControlPointLatticeType;
+  typedef TOutputImage                             OutputImageType;
+  typedef typename OutputImageType::PixelType      PixelType;
+  typedef typename OutputImageType::RegionType     RegionType;
+  typedef typename OutputImageType::SizeType       SizeType;
+  typedef typename OutputImageType::PointType      PointType;
+  typedef typename OutputImageType::SpacingType    SpacingType;
+  typedef typename OutputImageType::DirectionType  DirectionType;
+  typedef RegionType                               OutputImageRegionType;
+
+  /** Control point lattice and spline order */
+  itkSetConstObjectMacro( ControlPointLattice, ControlPointLatticeType );
+  itkGetConstObjectMacro( ControlPointLattice, ControlPointLatticeType );
+  itkSetMacro( SplineOrder, unsigned int );
+  itkGetConstMacro( SplineOrder, unsigned int );
+
+  /** Parametric domain of the lattice */
+  itkSetMacro( DomainOrigin, PointType );
+  itkGetConstReferenceMacro( DomainOrigin, PointType );
+  itkSetMacro( DomainSpacing, SpacingType );
+  itkGetConstReferenceMacro( DomainSpacing, SpacingType );
+  itkSetMacro( DomainSize, SizeType );
+  itkGetConstReferenceMacro( DomainSize, SizeType );
+  itkSetMacro( DomainDirection, DirectionType );
+  itkGetConstReferenceMacro( DomainDirection, DirectionType );
+
+  /** Output grid */
+  itkSetMacro( Origin, PointType );
+  itkGetConstReferenceMacro( Origin, PointType );
+  itkSetMacro( Spacing, SpacingType );
+  itkGetConstReferenceMacro( Spacing, SpacingType );
+  itkSetMacro( Direction, DirectionType );
+  itkGetConstReferenceMacro( Direction, DirectionType );
+  itkSetMacro( Region, RegionType );
+  itkGetConstReferenceMacro( Region, RegionType );
+
+protected:
+  BSplineControlPointLatticeImageSource();
+  ~BSplineControlPointLatticeImageSource()
+  {
+  };
+
+  void PrintSelf( std::ostream& os, Indent indent ) const;
+
+  void GenerateOutputInformation();
+
+  void BeforeThreadedGenerateData();
+
+#if ITK_VERSION_MAJOR < 4
+  void ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread, int threadId );
+
+#else
+  void ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread, ThreadIdType threadId );
+
+#endif
+private:
+  BSplineControlPointLatticeImageSource( const Self & ); // purposely not implemented
+  void operator=( const Self & );                       // purposely not implemented
+
+  /** Centered uniform B-spline of degree m_SplineOrder */
+  double BSpline( double x ) const;
+
+  typename ControlPointLatticeType::ConstPointer m_ControlPointLattice;
+  unsigned int                                   m_SplineOrder;
+
+  PointType     m_DomainOrigin;
+  SpacingType   m_DomainSpacing;
+  SizeType      m_DomainSize;
+  DirectionType m_DomainDirection;
+
+  PointType     m_Origin;
+  SpacingType   m_Spacing;
+  DirectionType m_Direction;
+  RegionType    m_Region;
+
+  // Physical point to parametric coordinate
+  Matrix<double, ImageDimension, ImageDimension> m_PhysicalPointToParameter;
+  std::vector<double>                            m_BinomialCoefficients;
+  double                                         m_InverseFactorial;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkBSplineControlPointLatticeImageSource.txx"
+#endif
+
+#endif
@@ -0,0 +1,218 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    $RCSfile: itkBSplineControlPointLatticeImageSource.txx,v $
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkBSplineControlPointLatticeImageSource_txx
+#define __itkBSplineControlPointLatticeImageSource_txx
+
+#include "itkBSplineControlPointLatticeImageSource.h"
+
+#include "itkImageRegionIteratorWithIndex.h"
+
+#include "vnl/vnl_math.h"
+#include "vnl/vnl_matrix.h"
+#include "vnl/algo/vnl_matrix_inverse.h"
+
+namespace itk
+{
+
+template <class TControlPointLattice, class TOutputImage>
+BSplineControlPointLatticeImageSource<TControlPointLattice, TOutputImage>
+::BSplineControlPointLatticeImageSource()
+{
+  this->m_SplineOrder = 3;
+  this->m_DomainOrigin.Fill( 0.0 );
+  this->m_DomainSpacing.Fill( 1.0 );
+  this->m_DomainSize.Fill( 0 );
+  this->m_DomainDirection.SetIdentity();
+  this->m_Origin.Fill( 0.0 );
+  this->m_Spacing.Fill( 1.0 );
+  this->m_Direction.SetIdentity();
+  this->m_InverseFactorial = 1.0;
+}
+
+template <class TControlPointLattice, class TOutputImage>
+void
+BSplineControlPointLatticeImageSource<TControlPointLattice, TOutputImage>
+::GenerateOutputInformation()
+{
+  typename OutputImageType::Pointer output = this->GetOutput();
+  output->SetOrigin( this->m_Origin );
+  output->SetSpacing( this->m_Spacing );
+  output->SetDirection( this->m_Direction );
+  output->SetLargestPossibleRegion( this->m_Region );
+}
+
+template <class TControlPointLattice, class TOutputImage>
+void
+BSplineControlPointLatticeImageSource<TControlPointLattice, TOutputImage>
+::BeforeThreadedGenerateData()
+{
+  if( !this->m_ControlPointLattice )
+    {
+    itkExceptionMacro( "The control point lattice is not set." );
+    }
+  const SizeType latticeSize =
+    this->m_ControlPointLattice->GetLargestPossibleRegion().GetSize();
+
+  // index = ( direction * spacing )^-1 ( point - origin ), and the
+  //   parameter spans the lattice from the first to the last index
+  vnl_matrix<double> indexToPhysical( ImageDimension, ImageDimension );
+  for( unsigned int i = 0; i < ImageDimension; i++ )
+    {
+    if( latticeSize[i] <= this->m_SplineOrder )
+      {
+      itkExceptionMacro( "The control point lattice is too small for the spline order." );
+      }
+    for( unsigned int j = 0; j < ImageDimension; j++ )
+      {
+      indexToPhysical( i, j ) = this->m_DomainDirection[i][j] * this->m_DomainSpacing[j];
+      }
+    }
+  const vnl_matrix<double> physicalToIndex =
+    vnl_matrix_inverse<double>( indexToPhysical ).inverse();
+  for( unsigned int i = 0; i < ImageDimension; i++ )
+    {
+    const double spans = static_cast<double>( latticeSize[i] - this->m_SplineOrder );
+    const double scale = this->m_DomainSize[i] > 1
+      ? spans / static_cast<double>( this->m_DomainSize[i] - 1 ) : 0.0;
+    for( unsigned int j = 0; j < ImageDimension; j++ )
+      {
+      this->m_PhysicalPointToParameter[i][j] = scale * physicalToIndex( i, j );
+      }
+    }
+
+  const unsigned int order = this->m_SplineOrder;
+  this->m_BinomialCoefficients.assign( order + 2, 1.0 );
+  for( unsigned int k = 1; k <= order + 1; k++ )
+    {
+    this->m_BinomialCoefficients[k] = this->m_BinomialCoefficients[k - 1]
+      * static_cast<double>( order + 2 - k ) / static_cast<double>( k );
+    }
+  this->m_InverseFactorial = 1.0;
+  for( unsigned int k = 2; k <= order; k++ )
+    {
+    this->m_InverseFactorial /= static_cast<double>( k );
+    }
+}
+
+template <class TControlPointLattice, class TOutputImage>
+double
+BSplineControlPointLatticeImageSource<TControlPointLattice, TOutputImage>
+::BSpline( double x ) const
+{
+  const unsigned int order = this->m_SplineOrder;
+  const double       shift = 0.5 * static_cast<double>( order + 1 );
+  double             value = 0.0;
+  for( unsigned int k = 0; k <= order + 1; k++ )
+    {
+    const double t = x + shift - static_cast<double>( k );
+    if( t <= 0.0 )
+      {
+      break;
+      }
+    const double term = this->m_BinomialCoefficients[k] * vcl_pow( t, static_cast<int>( order ) );
+    value += ( k % 2 ) ? -term : term;
+    }
+  return value * this->m_InverseFactorial;
+}
+
+template <class TControlPointLattice, class TOutputImage>
+void
+#if ITK_VERSION_MAJOR < 4
+BSplineControlPointLatticeImageSource<TControlPointLattice, TOutputImage>
+::ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+                        int itkNotUsed(threadId) )
+#else
+BSplineControlPointLatticeImageSource<TControlPointLattice, TOutputImage>
+::ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+                        ThreadIdType itkNotUsed(threadId) )
+#endif
+{
+  typename OutputImageType::Pointer output = this->GetOutput();
+  const ControlPointLatticeType *   lattice = this->m_ControlPointLattice;
+  const SizeType                    latticeSize = lattice->GetLargestPossibleRegion().GetSize();
+  const typename ControlPointLatticeType::IndexType latticeStart =
+    lattice->GetLargestPossibleRegion().GetIndex();
+
+  const unsigned int order = this->m_SplineOrder;
+  const double       center = 0.5 * ( static_cast<double>( order ) - 1.0 );
+  unsigned int       numberOfNeighbors = 1;
+  for( unsigned int i = 0; i < ImageDimension; i++ )
+    {
+    numberOfNeighbors *= order + 1;
+    }
+
+  std::vector<double> weights( ImageDimension * ( order + 1 ) );
+  long                span[ImageDimension];
+
+  ImageRegionIteratorWithIndex<OutputImageType> It( output, outputRegionForThread );
+  for( It.GoToBegin(); !It.IsAtEnd(); ++It )
+    {
+    PointType point;
+    output->TransformIndexToPhysicalPoint( It.GetIndex(), point );
+    for( unsigned int i = 0; i < ImageDimension; i++ )
+      {
+      double u = 0.0;
+      for( unsigned int j = 0; j < ImageDimension; j++ )
+        {
+        u += this->m_PhysicalPointToParameter[i][j] * ( point[j] - this->m_DomainOrigin[j] );
+        }
+      // The last parameter is evaluated on the last span
+      const long lastSpan = static_cast<long>( latticeSize[i] - order ) - 1;
+      span[i] = static_cast<long>( vcl_floor( u ) );
+      span[i] = vnl_math_max( 0L, vnl_math_min( span[i], lastSpan ) );
+      const double t = u - static_cast<double>( span[i] );
+      for( unsigned int k = 0; k <= order; k++ )
+        {
+        weights[i * ( order + 1 ) + k] = this->BSpline( t - static_cast<double>( k ) + center );
+        }
+      }
+
+    double value = 0.0;
+    for( unsigned int n = 0; n < numberOfNeighbors; n++ )
+      {
+      typename ControlPointLatticeType::IndexType latticeIndex;
+      double       weight = 1.0;
+      unsigned int offset = n;
+      for( unsigned int i = 0; i < ImageDimension; i++ )
+        {
+        const unsigned int k = offset % ( order + 1 );
+        offset /= order + 1;
+        weight *= weights[i * ( order + 1 ) + k];
+        latticeIndex[i] = latticeStart[i] + span[i] + k;
+        }
+      value += weight * lattice->GetPixel( latticeIndex )[0];
+      }
+    It.Set( static_cast<PixelType>( value ) );
+    }
+}
+
+template <class TControlPointLattice, class TOutputImage>
+void
+BSplineControlPointLatticeImageSource<TControlPointLattice, TOutputImage>
+::PrintSelf( std::ostream& os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "Spline order: " << this->m_SplineOrder << std::endl;
+  os << indent << "Domain origin: " << this->m_DomainOrigin << std::endl;
+  os << indent << "Domain spacing: " << this->m_DomainSpacing << std::endl;
+  os << indent << "Domain size: " << this->m_DomainSize << std::endl;
+  os << indent << "Region: " << this->m_Region << std::endl;
+}
+
+} // end namespace itk
+
+#endif
@@ -16,11 +16,13 @@
 // Software Guide : BeginLatex
 //
 // This example illustrates how to use the \doxygen{OtsuThresholdImageFilter}.
+// The NewOtsuThresholdImageFilter of vtkITK computes the same threshold,
+// with the histogram computed in threads.
 //
 // Software Guide : EndLatex
 
 // Software Guide : BeginCodeSnippet
-#include "itkOtsuThresholdImageFilter.h"
+#include "itkNewOtsuThresholdImageFilter.h"
 // Software Guide : EndCodeSnippet
 
 #include "itkImageFileReader.h"
@@ -77,7 +79,7 @@ int main( int argc, char * argv[] )
   //  Software Guide : EndLatex
 
   // Software Guide : BeginCodeSnippet
-  typedef itk::OtsuThresholdImageFilter<
+  typedef itk::NewOtsuThresholdImageFilter<
     InputImageType, OutputImageType>  FilterType;
   // Software Guide : EndCodeSnippet
 
@@ -13,7 +13,7 @@
      PURPOSE.  See the above copyright notices for more information.
 
 =========================================================================*/
-#include "itkOtsuThresholdImageFilter.h"
+#include "itkNewOtsuThresholdImageFilter.h"
 #include "itkConnectedComponentImageFilter.h"
 #include "itkRelabelComponentImageFilter.h"
 
@@ -48,7 +48,7 @@ int main( int argc, char * argv[] )
   typedef itk::Image<OutputPixelType, 3>   OutputImageType;
 
 // Filter Types
-  typedef itk::OtsuThresholdImageFilter<
+  typedef itk::NewOtsuThresholdImageFilter<
     InputImageType, InputImageType>  OtsuFilterType;
   typedef itk::ConnectedComponentImageFilter<
     InputImageType, InternalImageType>  CCFilterType;
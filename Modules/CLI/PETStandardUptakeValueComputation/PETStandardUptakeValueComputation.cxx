@@ -10,10 +10,8 @@
 
 // VTK includes
 #include <vtkGlobFileNames.h>
-#include <vtkImageAccumulate.h>
 #include <vtkImageData.h>
-#include <vtkImageThreshold.h>
-#include <vtkImageToImageStencil.h>
+#include <vtkPointData.h>
 #include <vtkSmartPointer.h>
 
 // ITK includes
@@ -24,10 +22,20 @@
 #include <itkImageSeriesReader.h>
 #include <itkMetaDataDictionary.h>
 #include <itkNumericSeriesFileNames.h>
+#include <itksys/Directory.hxx>
+#include <itksys/SystemTools.hxx>
 
 #undef HAVE_SSTREAM // stupid DCMTK Header issue
 #include "itkDCMTKFileReader.h"
 
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <vector>
+
 // ...
 // ...............................................................................................
 // ...
@@ -108,6 +116,7 @@ struct parameters
     std::string decayFactor;
     std::string radionuclideHalfLife;
     std::string frameReferenceTime;
+    std::string DICOMHeaderCacheFile;
 };
 
 // ...
@@ -732,12 +741,9 @@ double DecayCorrection(parameters & list, double inVal )
 // ...
 // ...............................................................................................
 // ...
-const char * MapLabelIDtoColorName( int id, std::string colorFile )
+vtkSmartPointer<vtkMRMLColorTableNode> ReadColorTable( std::string colorFile )
 {
   // use the colour table that was passed in with the VOI volume
-
-  const char *colorName = "";
-
   vtkSmartPointer<vtkMRMLColorTableNode>        colorNode = vtkSmartPointer<vtkMRMLColorTableNode>::New();
   vtkSmartPointer<vtkMRMLColorTableStorageNode> colorStorageNode = vtkSmartPointer<vtkMRMLColorTableStorageNode>::New();
   colorStorageNode->SetFileName(colorFile.c_str() );
@@ -745,163 +751,99 @@ const char * MapLabelIDtoColorName( int id, std::string colorFile )
   if( !colorStorageNode->ReadData(colorNode) )
     {
     std::cerr << "Error reading colour file " << colorStorageNode->GetFileName() << endl;
+    return NULL;
     }
-  else
-    {
-    colorName = colorNode->GetColorName(id);
-    }
-  return colorName;
+  return colorNode;
 }
 
 // ...
 // ...............................................................................................
 // ...
-template <class T>
-int LoadImagesAndComputeSUV( parameters & list, T )
+std::string MapLabelIDtoColorName( int id, vtkMRMLColorTableNode * colorNode )
 {
+  const char *colorName = colorNode ? colorNode->GetColorName(id) : NULL;
+  return colorName ? colorName : "";
+}
 
+// ...
+// ...............................................................................................
+// ...
+struct LabelStatistics
+  {
+  LabelStatistics() : Count(0), Min(0.), Max(0.), Sum(0.) {}
+  int Count;
+  double Min;
+  double Max;
+  double Sum;
+  };
 
-  typedef    T                           InputPixelType;
-  typedef itk::Image<InputPixelType,  3> InputImageType;
-
-  typedef itk::Image<unsigned char, 3> LabelImageType;
-
-  typedef    T                           OutputPixelType;
-  typedef itk::Image<OutputPixelType, 3> OutputImageType;
-
-  typedef itk::ImageFileReader<InputImageType>  ReaderType;
-  typedef itk::ImageFileReader<LabelImageType>  LabelReaderType;
-  typedef itk::ImageFileWriter<OutputImageType> WriterType;
-
-  //
-  // for writing csv output files
-  //
-  std::string   outputFile = list.SUVOutputTable;
-  std::ofstream ofile;
-  std::string  outputStringFile = list.SUVOutputStringFile;
-  std::ofstream stringFile;
-  vtkImageData *                    petVolume;
-  vtkImageData *                    voiVolume;
-  vtkITKArchetypeImageSeriesReader *reader1 = NULL;
-  vtkITKArchetypeImageSeriesReader *reader2 = NULL;
-
-  // check for the input files
-  FILE * petfile;
-  petfile = fopen(list.PETVolumeName.c_str(), "r");
-  if( petfile == NULL )
-    {
-    std::cerr << "ERROR: cannot open input volume file '" << list.PETVolumeName.c_str() << "'" << endl;
-    return EXIT_FAILURE;
-    }
-  fclose(petfile);
-
-  FILE * voifile;
-  voifile = fopen(list.VOIVolumeName.c_str(), "r");
-  if( voifile == NULL )
-    {
-    std::cerr << "ERROR: cannot open ROI Volume  file '" << list.VOIVolumeName.c_str() << "'" << endl;
-    return EXIT_FAILURE;
-    }
-  fclose(voifile);
-
-  // Read the PET file
-
-  reader1 = vtkITKArchetypeImageSeriesScalarReader::New();
-//    vtkPluginFilterWatcher watchReader1 ( reader1, "Reading PET Volume", CLPProcessInformation );
-  reader1->SetArchetype(list.PETVolumeName.c_str() );
-  reader1->SetOutputScalarTypeToNative();
-  reader1->SetDesiredCoordinateOrientationToNative();
-  reader1->SetUseNativeOriginOn();
-  reader1->Update();
-  std::cout << "Done reading the file " << list.PETVolumeName.c_str() << endl;
-
-
-  // Read the VOI file
-  reader2 = vtkITKArchetypeImageSeriesScalarReader::New();
-//    vtkPluginFilterWatcher watchReader2 ( reader2, "Reading VOI Volume", CLPProcessInformation );
-  reader2->SetArchetype(list.VOIVolumeName.c_str() );
-  reader2->SetOutputScalarTypeToNative();
-  reader2->SetDesiredCoordinateOrientationToNative();
-  reader2->SetUseNativeOriginOn();
-  reader2->Update();
-  std::cout << "Done reading the file " << list.VOIVolumeName.c_str() << endl;
-
-  // stuff the images.
-//  reader1->Update();
-//  reader2->Update();
-  petVolume = reader1->GetOutput();
-  petVolume->Update();
-  voiVolume = reader2->GetOutput();
-  voiVolume->Update();
-
-
-  //
-  // COMPUTE SUV ///////////////////////////////////////////////////////////////////////////////RSNA CHANGE//////////////////////////
-  //
-
-  if( petVolume == NULL )
-    {
-    std::cerr << "No input PET volume found." << std::endl;
-    return EXIT_FAILURE;
-    }
-
-  // find input labelmap volume
-  if( voiVolume == NULL )
-    {
-    std::cerr <<  "No input VOI volume found" << std::endl;
-    return EXIT_FAILURE;
-    }
-
-  // read the DICOM dir to get the radiological data
-
-  typedef short PixelValueType;
-  typedef itk::Image< PixelValueType, 3 > VolumeType;
-  typedef itk::ImageSeriesReader< VolumeType > VolumeReaderType;
-  typedef itk::Image< PixelValueType, 2 > SliceType;
-  typedef itk::ImageFileReader< SliceType > SliceReaderType;
-  typedef itk::GDCMImageIO ImageIOType;
-  typedef itk::GDCMSeriesFileNames InputNamesGeneratorType;
-  typedef itk::VectorImage< PixelValueType, 3 > NRRDImageType;
-
-  if ( !list.PETDICOMPath.compare(""))
-    {
-    std::cerr << "GetParametersFromDicomHeader:Got empty list.PETDICOMPath." << std::endl;
-    return EXIT_FAILURE;
-    }
-
-
-  //--- catch non-dicom data
-  vtkGlobFileNames* gfn = vtkGlobFileNames::New();
-  gfn->SetDirectory(list.PETDICOMPath.c_str());
-  gfn->AddFileNames("*.nhdr");
-  gfn->AddFileNames("*.nrrd");
-  gfn->AddFileNames("*.hdr");
-  gfn->AddFileNames("*.mha");
-  gfn->AddFileNames("*.img");
-  gfn->AddFileNames("*.nii");
-  gfn->AddFileNames("*.nia");
-
-  int notDICOM = 0;
-  int nFiles = gfn->GetNumberOfFileNames();
-  if (nFiles > 0)
-    {
-    notDICOM = 1;
-    }
-  gfn->Delete();
-  if ( notDICOM )
+// ...
+// ...............................................................................................
+// ...
+// Statistics of the PET values under each label of the VOI volume, in a
+// single pass over the volumes.  As with a stencil, the voxels are matched by
+// their index.  lo and hi are the smallest and largest labels of the VOI volume.
+void ComputeLabelStatistics( vtkImageData * petVolume, vtkImageData * voiVolume,
+                             int & lo, int & hi, std::map<int, LabelStatistics> & statistics )
+{
+  vtkDataArray * petScalars = petVolume->GetPointData()->GetScalars();
+  vtkDataArray * voiScalars = voiVolume->GetPointData()->GetScalars();
+  int            petExtent[6];
+  int            voiExtent[6];
+  petVolume->GetExtent(petExtent);
+  voiVolume->GetExtent(voiExtent);
+  const vtkIdType petRowSize = petExtent[1] - petExtent[0] + 1;
+  const vtkIdType petSliceSize = petRowSize * (petExtent[3] - petExtent[2] + 1);
+
+  statistics.clear();
+  double    minLabel = VTK_DOUBLE_MAX;
+  double    maxLabel = VTK_DOUBLE_MIN;
+  vtkIdType voiId = 0;
+  for( int k = voiExtent[4]; k <= voiExtent[5]; ++k )
     {
-    std::cerr << "PET Dicom parameter doesn't point to a dicom directory!" << std::endl;
-    return EXIT_FAILURE;
+    for( int j = voiExtent[2]; j <= voiExtent[3]; ++j )
+      {
+      const bool      insideRow = k >= petExtent[4] && k <= petExtent[5]
+        && j >= petExtent[2] && j <= petExtent[3];
+      const vtkIdType petRowId = (k - petExtent[4]) * petSliceSize + (j - petExtent[2]) * petRowSize;
+      for( int i = voiExtent[0]; i <= voiExtent[1]; ++i, ++voiId )
+        {
+        const double labelValue = voiScalars->GetComponent(voiId, 0);
+        minLabel = std::min(minLabel, labelValue);
+        maxLabel = std::max(maxLabel, labelValue);
+        if( !insideRow || i < petExtent[0] || i > petExtent[1] ||
+            labelValue != std::floor(labelValue) )
+          {
+          continue;
+          }
+        const double      petValue = petScalars->GetComponent(petRowId + i - petExtent[0], 0);
+        LabelStatistics & labelStatistics = statistics[static_cast<int>(labelValue)];
+        if( labelStatistics.Count == 0 )
+          {
+          labelStatistics.Min = petValue;
+          labelStatistics.Max = petValue;
+          }
+        else
+          {
+          labelStatistics.Min = std::min(labelStatistics.Min, petValue);
+          labelStatistics.Max = std::max(labelStatistics.Max, petValue);
+          }
+        labelStatistics.Sum += petValue;
+        ++labelStatistics.Count;
+        }
+      }
     }
+  lo = voiId > 0 ? static_cast<int>(minLabel) : 0;
+  hi = voiId > 0 ? static_cast<int>(maxLabel) : 0;
+}
 
-
-  InputNamesGeneratorType::Pointer inputNames = InputNamesGeneratorType::New();
-  inputNames->SetUseSeriesDetails(true);
-  inputNames->SetDirectory(list.PETDICOMPath);
-  itk::SerieUIDContainer seriesUIDs = inputNames->GetSeriesUIDs();
-
-  const VolumeReaderType::FileNamesContainer & filenames = inputNames->GetFileNames(seriesUIDs[0]);
-
+// ...
+// ...............................................................................................
+// ...
+// Reads the radiopharmaceutical and timing values of a PET DICOM file into the
+// parameter list, returns 1 when the file has a radiopharmaceutical sequence
+int ParseDICOMHeader( const std::string & fileName, parameters & list )
+{
   std::string tag;
   std::string yearstr;
   std::string monthstr;
@@ -921,7 +863,7 @@ int LoadImagesAndComputeSUV( parameters & list, T )
 */
     int parsingDICOM = 0;
     itk::DCMTKFileReader fileReader;
-    fileReader.SetFileName(filenames[0]);
+    fileReader.SetFileName(fileName);
     fileReader.LoadFile();
 
     itk::DCMTKSequence seq;
@@ -1313,6 +1255,371 @@ int LoadImagesAndComputeSUV( parameters & list, T )
         }
       }
 
+  return parsingDICOM;
+}
+
+// ...
+// ...............................................................................................
+// ...
+// The SUV header values of a PET series are cached by DICOM directory, so
+// that the directory is only scanned and parsed once for all the VOI requests
+// of a study.  A cache entry is a line of tab separated fields:  the
+// directory, its signature, the series UID and the header values.  It is
+// valid while the directory holds the same files with the same sizes and
+// modification times.
+const char * DICOMHeaderCacheVersion = "# PETStandardUptakeValueComputation DICOM header cache 1";
+
+std::string DICOMDirectorySignature( const std::string & directory )
+{
+  itksys::Directory dir;
+  if( !dir.Load( directory.c_str() ) )
+    {
+    return "";
+    }
+  unsigned long numberOfFiles = 0;
+  unsigned long totalLength = 0;
+  long int      lastModified = 0;
+  for( unsigned long i = 0; i < dir.GetNumberOfFiles(); ++i )
+    {
+    const std::string fileName = dir.GetFile(i);
+    const std::string path = directory + "/" + fileName;
+    if( fileName == "." || fileName == ".." || itksys::SystemTools::FileIsDirectory( path.c_str() ) )
+      {
+      continue;
+      }
+    ++numberOfFiles;
+    totalLength += itksys::SystemTools::FileLength( path.c_str() );
+    lastModified = std::max(lastModified, itksys::SystemTools::ModifiedTime( path.c_str() ) );
+    }
+  std::stringstream ss;
+  ss << numberOfFiles << ":" << totalLength << ":" << lastModified;
+  return ss.str();
+}
+
+std::vector<std::string parameters::*> DICOMHeaderStringValues()
+{
+  std::vector<std::string parameters::*> values;
+  values.push_back(&parameters::patientName);
+  values.push_back(&parameters::studyDate);
+  values.push_back(&parameters::radioactivityUnits);
+  values.push_back(&parameters::tissueRadioactivityUnits);
+  values.push_back(&parameters::weightUnits);
+  values.push_back(&parameters::volumeUnits);
+  values.push_back(&parameters::seriesReferenceTime);
+  values.push_back(&parameters::injectionTime);
+  values.push_back(&parameters::decayCorrection);
+  values.push_back(&parameters::decayFactor);
+  values.push_back(&parameters::radionuclideHalfLife);
+  values.push_back(&parameters::frameReferenceTime);
+  return values;
+}
+
+std::vector<double parameters::*> DICOMHeaderDoubleValues()
+{
+  std::vector<double parameters::*> values;
+  values.push_back(&parameters::injectedDose);
+  values.push_back(&parameters::calibrationFactor);
+  values.push_back(&parameters::patientWeight);
+  return values;
+}
+
+void SplitCacheEntry( const std::string & line, std::vector<std::string> & fields )
+{
+  fields.clear();
+  std::string::size_type start = 0;
+  std::string::size_type end;
+  while( (end = line.find('\t', start) ) != std::string::npos )
+    {
+    fields.push_back(line.substr(start, end - start) );
+    start = end + 1;
+    }
+  fields.push_back(line.substr(start) );
+}
+
+std::string CacheEntryField( std::string value )
+{
+  // the fields can't hold the separators
+  std::replace(value.begin(), value.end(), '\t', ' ');
+  std::replace(value.begin(), value.end(), '\n', ' ');
+  std::replace(value.begin(), value.end(), '\r', ' ');
+  return value;
+}
+
+void ReadDICOMHeaderCache( const std::string & cacheFile, std::vector<std::string> & entries )
+{
+  entries.clear();
+  std::ifstream cache(cacheFile.c_str() );
+  std::string   line;
+  if( !std::getline(cache, line) || line != DICOMHeaderCacheVersion )
+    {
+    return;
+    }
+  while( std::getline(cache, line) )
+    {
+    if( !line.empty() )
+      {
+      entries.push_back(line);
+      }
+    }
+}
+
+// Returns 1 and fills the header values of the list when the cache has a
+// valid entry for the directory
+int ReadCachedDICOMHeader( const std::string & cacheFile, const std::string & directory,
+                           const std::string & signature, std::string & seriesUID,
+                           parameters & list )
+{
+  if( cacheFile.empty() || signature.empty() )
+    {
+    return 0;
+    }
+  const std::vector<std::string parameters::*> stringValues = DICOMHeaderStringValues();
+  const std::vector<double parameters::*>      doubleValues = DICOMHeaderDoubleValues();
+
+  std::vector<std::string> entries;
+  ReadDICOMHeaderCache(cacheFile, entries);
+  std::vector<std::string> fields;
+  for( size_t e = 0; e < entries.size(); ++e )
+    {
+    SplitCacheEntry(entries[e], fields);
+    if( fields.size() != 3 + stringValues.size() + doubleValues.size() ||
+        fields[0] != CacheEntryField(directory) || fields[1] != signature )
+      {
+      continue;
+      }
+    seriesUID = fields[2];
+    size_t f = 3;
+    for( size_t v = 0; v < stringValues.size(); ++v )
+      {
+      list.*stringValues[v] = fields[f++];
+      }
+    for( size_t v = 0; v < doubleValues.size(); ++v )
+      {
+      list.*doubleValues[v] = atof(fields[f++].c_str() );
+      }
+    return 1;
+    }
+  return 0;
+}
+
+void WriteCachedDICOMHeader( const std::string & cacheFile, const std::string & directory,
+                             const std::string & signature, const std::string & seriesUID,
+                             const parameters & list )
+{
+  if( cacheFile.empty() || signature.empty() )
+    {
+    return;
+    }
+  const std::vector<std::string parameters::*> stringValues = DICOMHeaderStringValues();
+  const std::vector<double parameters::*>      doubleValues = DICOMHeaderDoubleValues();
+
+  std::stringstream entry;
+  entry.precision(17);
+  entry << CacheEntryField(directory) << "\t" << signature << "\t" << CacheEntryField(seriesUID);
+  for( size_t v = 0; v < stringValues.size(); ++v )
+    {
+    entry << "\t" << CacheEntryField(list.*stringValues[v]);
+    }
+  for( size_t v = 0; v < doubleValues.size(); ++v )
+    {
+    entry << "\t" << list.*doubleValues[v];
+    }
+
+  // replace the previous entry of the directory
+  std::vector<std::string> entries;
+  ReadDICOMHeaderCache(cacheFile, entries);
+  const std::string prefix = CacheEntryField(directory) + "\t";
+  std::ofstream     cache(cacheFile.c_str(), ios::out | ios::trunc);
+  if( !cache.is_open() )
+    {
+    std::cerr << "Warning: cannot write the DICOM header cache '" << cacheFile << "'" << std::endl;
+    return;
+    }
+  cache << DICOMHeaderCacheVersion << std::endl;
+  for( size_t e = 0; e < entries.size(); ++e )
+    {
+    if( entries[e].compare(0, prefix.size(), prefix) != 0 )
+      {
+      cache << entries[e] << std::endl;
+      }
+    }
+  cache << entry.str() << std::endl;
+}
+
+// ...
+// ...............................................................................................
+// ...
+template <class T>
+int LoadImagesAndComputeSUV( parameters & list, T )
+{
+
+
+  typedef    T                           InputPixelType;
+  typedef itk::Image<InputPixelType,  3> InputImageType;
+
+  typedef itk::Image<unsigned char, 3> LabelImageType;
+
+  typedef    T                           OutputPixelType;
+  typedef itk::Image<OutputPixelType, 3> OutputImageType;
+
+  typedef itk::ImageFileReader<InputImageType>  ReaderType;
+  typedef itk::ImageFileReader<LabelImageType>  LabelReaderType;
+  typedef itk::ImageFileWriter<OutputImageType> WriterType;
+
+  //
+  // for writing csv output files
+  //
+  std::string   outputFile = list.SUVOutputTable;
+  std::ofstream ofile;
+  std::string  outputStringFile = list.SUVOutputStringFile;
+  std::ofstream stringFile;
+  vtkImageData *                    petVolume;
+  vtkImageData *                    voiVolume;
+  vtkITKArchetypeImageSeriesReader *reader1 = NULL;
+  vtkITKArchetypeImageSeriesReader *reader2 = NULL;
+
+  // check for the input files
+  FILE * petfile;
+  petfile = fopen(list.PETVolumeName.c_str(), "r");
+  if( petfile == NULL )
+    {
+    std::cerr << "ERROR: cannot open input volume file '" << list.PETVolumeName.c_str() << "'" << endl;
+    return EXIT_FAILURE;
+    }
+  fclose(petfile);
+
+  FILE * voifile;
+  voifile = fopen(list.VOIVolumeName.c_str(), "r");
+  if( voifile == NULL )
+    {
+    std::cerr << "ERROR: cannot open ROI Volume  file '" << list.VOIVolumeName.c_str() << "'" << endl;
+    return EXIT_FAILURE;
+    }
+  fclose(voifile);
+
+  // Read the PET file
+
+  reader1 = vtkITKArchetypeImageSeriesScalarReader::New();
+//    vtkPluginFilterWatcher watchReader1 ( reader1, "Reading PET Volume", CLPProcessInformation );
+  reader1->SetArchetype(list.PETVolumeName.c_str() );
+  reader1->SetOutputScalarTypeToNative();
+  reader1->SetDesiredCoordinateOrientationToNative();
+  reader1->SetUseNativeOriginOn();
+  reader1->Update();
+  std::cout << "Done reading the file " << list.PETVolumeName.c_str() << endl;
+
+
+  // Read the VOI file
+  reader2 = vtkITKArchetypeImageSeriesScalarReader::New();
+//    vtkPluginFilterWatcher watchReader2 ( reader2, "Reading VOI Volume", CLPProcessInformation );
+  reader2->SetArchetype(list.VOIVolumeName.c_str() );
+  reader2->SetOutputScalarTypeToNative();
+  reader2->SetDesiredCoordinateOrientationToNative();
+  reader2->SetUseNativeOriginOn();
+  reader2->Update();
+  std::cout << "Done reading the file " << list.VOIVolumeName.c_str() << endl;
+
+  // stuff the images.
+//  reader1->Update();
+//  reader2->Update();
+  petVolume = reader1->GetOutput();
+  petVolume->Update();
+  voiVolume = reader2->GetOutput();
+  voiVolume->Update();
+
+
+  //
+  // COMPUTE SUV ///////////////////////////////////////////////////////////////////////////////RSNA CHANGE//////////////////////////
+  //
+
+  if( petVolume == NULL )
+    {
+    std::cerr << "No input PET volume found." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // find input labelmap volume
+  if( voiVolume == NULL )
+    {
+    std::cerr <<  "No input VOI volume found" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // read the DICOM dir to get the radiological data
+
+  typedef short PixelValueType;
+  typedef itk::Image< PixelValueType, 3 > VolumeType;
+  typedef itk::ImageSeriesReader< VolumeType > VolumeReaderType;
+  typedef itk::Image< PixelValueType, 2 > SliceType;
+  typedef itk::ImageFileReader< SliceType > SliceReaderType;
+  typedef itk::GDCMImageIO ImageIOType;
+  typedef itk::GDCMSeriesFileNames InputNamesGeneratorType;
+  typedef itk::VectorImage< PixelValueType, 3 > NRRDImageType;
+
+  if ( !list.PETDICOMPath.compare(""))
+    {
+    std::cerr << "GetParametersFromDicomHeader:Got empty list.PETDICOMPath." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+
+  //--- catch non-dicom data
+  vtkGlobFileNames* gfn = vtkGlobFileNames::New();
+  gfn->SetDirectory(list.PETDICOMPath.c_str());
+  gfn->AddFileNames("*.nhdr");
+  gfn->AddFileNames("*.nrrd");
+  gfn->AddFileNames("*.hdr");
+  gfn->AddFileNames("*.mha");
+  gfn->AddFileNames("*.img");
+  gfn->AddFileNames("*.nii");
+  gfn->AddFileNames("*.nia");
+
+  int notDICOM = 0;
+  int nFiles = gfn->GetNumberOfFileNames();
+  if (nFiles > 0)
+    {
+    notDICOM = 1;
+    }
+  gfn->Delete();
+  if ( notDICOM )
+    {
+    std::cerr << "PET Dicom parameter doesn't point to a dicom directory!" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+
+  // the directory is only scanned and parsed when the cache has no valid
+  // entry for it
+  std::string directorySignature = DICOMDirectorySignature(list.PETDICOMPath);
+  std::string seriesUID;
+  int         parsingDICOM = ReadCachedDICOMHeader(list.DICOMHeaderCacheFile, list.PETDICOMPath,
+                                                   directorySignature, seriesUID, list);
+  if( parsingDICOM )
+    {
+    std::cout << "Using the cached DICOM header of series " << seriesUID << std::endl;
+    }
+  else
+    {
+    InputNamesGeneratorType::Pointer inputNames = InputNamesGeneratorType::New();
+    inputNames->SetUseSeriesDetails(true);
+    inputNames->SetDirectory(list.PETDICOMPath);
+    itk::SerieUIDContainer seriesUIDs = inputNames->GetSeriesUIDs();
+    if( seriesUIDs.empty() )
+      {
+      std::cerr << "No DICOM series found in " << list.PETDICOMPath << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    const VolumeReaderType::FileNamesContainer & filenames = inputNames->GetFileNames(seriesUIDs[0]);
+    seriesUID = seriesUIDs[0];
+    parsingDICOM = ParseDICOMHeader(filenames[0], list);
+    if( parsingDICOM )
+      {
+      WriteCachedDICOMHeader(list.DICOMHeaderCacheFile, list.PETDICOMPath,
+                             directorySignature, seriesUID, list);
+      }
+    }
+
 
     // check.... did we get all params we need for computation?
     if ( (parsingDICOM) &&
@@ -1359,13 +1666,14 @@ int LoadImagesAndComputeSUV( parameters & list, T )
   std::string outputSUVMeanString = "SUVMean = ";
   std::string outputSUVMinString = "SUVMin = ";
 
-  // --- find the max and min label in mask
-  vtkImageAccumulate *stataccum = vtkImageAccumulate::New();
-  stataccum->SetInput( voiVolume );
-  stataccum->Update();
-  int lo = static_cast<int>(stataccum->GetMin()[0]);
-  int hi = static_cast<int>(stataccum->GetMax()[0]);
-  stataccum->Delete();
+  // --- find the max and min label in mask, and the statistics of all the
+  // --- labels in the same pass
+  int                             lo;
+  int                             hi;
+  std::map<int, LabelStatistics> statistics;
+  ComputeLabelStatistics(petVolume, voiVolume, lo, hi, statistics);
+
+  vtkSmartPointer<vtkMRMLColorTableNode> colorNode = ReadColorTable(list.VOIVolumeColorTableFile);
 
   std::string labelName;
   int         NumberOfVOIs = 0;
@@ -1379,7 +1687,7 @@ int LoadImagesAndComputeSUV( parameters & list, T )
       }
 
     labelName.clear();
-    labelName = MapLabelIDtoColorName(i, list.VOIVolumeColorTableFile);
+    labelName = MapLabelIDtoColorName(i, colorNode);
     if( labelName.empty() )
       {
       labelName.clear();
@@ -1391,38 +1699,17 @@ int LoadImagesAndComputeSUV( parameters & list, T )
     suvmax = 0.0;
     suvmean = 0.0;
 
-    // create the binary volume of the label
-    vtkImageThreshold *thresholder = vtkImageThreshold::New();
-    thresholder->SetInput(voiVolume);
-    thresholder->SetInValue(1);
-    thresholder->SetOutValue(0);
-    thresholder->ReplaceOutOn();
-    thresholder->ThresholdBetween(i, i);
-    thresholder->SetOutputScalarType(petVolume->GetScalarType() );
-    thresholder->Update();
-
-    // use vtk's statistics class with the binary labelmap as a stencil
-    vtkImageToImageStencil *stencil = vtkImageToImageStencil::New();
-    stencil->SetInput(thresholder->GetOutput() );
-    stencil->ThresholdBetween(1, 1);
-
-    vtkImageAccumulate *labelstat = vtkImageAccumulate::New();
-    labelstat->SetInput(petVolume);
-    labelstat->SetStencil(stencil->GetOutput() );
-    labelstat->Update();
-
-    stencil->Delete();
-
     // --- For how many labels was SUV computed?
 
-    int voxNumber = labelstat->GetVoxelCount();
+    const LabelStatistics labelstat = statistics[i];
+    int                   voxNumber = labelstat.Count;
     if( voxNumber > 0 )
       {
       NumberOfVOIs++;
 
-      double CPETmin = (labelstat->GetMin() )[0];
-      double CPETmax = (labelstat->GetMax() )[0];
-      double CPETmean = (labelstat->GetMean() )[0];
+      double CPETmin = labelstat.Min;
+      double CPETmax = labelstat.Max;
+      double CPETmean = labelstat.Sum / voxNumber;
 
       // --- we want to use the following units as noted at file top:
       // --- CPET(t) -- tissue radioactivity in pixels-- kBq/mlunits
@@ -1517,10 +1804,6 @@ int LoadImagesAndComputeSUV( parameters & list, T )
         std::cout << "Wrote output for label " << labelName.c_str() << " to " << outputFile.c_str() << std::endl;
         }
       }
-
-
-    thresholder->Delete();
-    labelstat->Delete();
     }
   // --- write output return string file
   std::stringstream ss;
@@ -1602,6 +1885,18 @@ int main( int argc, char * argv[] )
     // GenerateCLP makes a temporary file with the path saved to
     // returnParameterFile, write the output strings in there as key = value pairs
     list.SUVOutputStringFile = returnParameterFile;
+    list.DICOMHeaderCacheFile = DICOMHeaderCache;
+    if( list.DICOMHeaderCacheFile.empty() )
+      {
+      std::string tempDirectory;
+      if( !itksys::SystemTools::GetEnv("TMPDIR", tempDirectory) &&
+          !itksys::SystemTools::GetEnv("TEMP", tempDirectory) &&
+          !itksys::SystemTools::GetEnv("TMP", tempDirectory) )
+        {
+        tempDirectory = "/tmp";
+        }
+      list.DICOMHeaderCacheFile = tempDirectory + "/PETStandardUptakeValueComputationDICOMHeaders.txt";
+      }
     std::cout << "list.SUVOutputStringFile = " << list.SUVOutputStringFile << std::endl;
     LoadImagesAndComputeSUV( list, static_cast<double>(0) );
     }
@@ -5,7 +5,11 @@
 #include <vtkNRRDReader.h>
 
 // VTK includes
+#include <vtkDataArray.h>
 #include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
+#include <vtkMultiThreader.h>
+#include <vtkPointData.h>
 #include <vtkPolyData.h>
 #include <vtkPolyDataReader.h>
 #include <vtkProbeFilter.h>
@@ -14,6 +18,221 @@
 #include <vtkXMLPolyDataReader.h>
 #include <vtkXMLPolyDataWriter.h>
 
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Interleaves the low 10 bits of x, y and z
+unsigned int MortonCode(unsigned int x, unsigned int y, unsigned int z)
+{
+  unsigned int code = 0;
+  for (int bit = 0; bit < 10; ++bit)
+    {
+    code |= ((x >> bit) & 1u) << (3 * bit);
+    code |= ((y >> bit) & 1u) << (3 * bit + 1);
+    code |= ((z >> bit) & 1u) << (3 * bit + 2);
+    }
+  return code;
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+inline T RoundIfNecessary(double value)
+{
+  if (std::numeric_limits<T>::is_integer)
+    {
+    return static_cast<T>(std::floor(value + 0.5));
+    }
+  return static_cast<T>(value);
+}
+
+//----------------------------------------------------------------------------
+struct SampleThreadData
+{
+  // continuous index of each point in the scalar array of the volume
+  const std::vector<double>* Indices;
+  // points sorted by Morton code of their voxel
+  const std::vector<std::pair<unsigned int, vtkIdType> >* Order;
+  vtkImageData* Volume;
+  vtkDataArray* Output;
+};
+
+//----------------------------------------------------------------------------
+// Trilinear interpolation of all the components, zero outside the volume
+// like vtkProbeFilter
+template <class T>
+void SamplePoints(const T* scalars, const int dims[3], int numberOfComponents,
+                  const std::vector<double>& indices,
+                  const std::vector<std::pair<unsigned int, vtkIdType> >& order,
+                  vtkIdType begin, vtkIdType end, T* output)
+{
+  const double tolerance = 1e-6;
+  const vtkIdType increments[3] =
+    {
+    numberOfComponents,
+    static_cast<vtkIdType>(numberOfComponents) * dims[0],
+    static_cast<vtkIdType>(numberOfComponents) * dims[0] * dims[1]
+    };
+  for (vtkIdType k = begin; k < end; ++k)
+    {
+    const vtkIdType pointId = order[k].second;
+    const double* index = &indices[3 * pointId];
+    T* tuple = output + pointId * numberOfComponents;
+
+    int base[3];
+    double weights[3];
+    vtkIdType offsets[3];
+    bool inside = true;
+    for (int axis = 0; axis < 3 && inside; ++axis)
+      {
+      double x = index[axis];
+      if (x < -tolerance || x > dims[axis] - 1 + tolerance)
+        {
+        inside = false;
+        break;
+        }
+      x = std::max(0., std::min(x, dims[axis] - 1.));
+      base[axis] = std::min(static_cast<int>(x), std::max(dims[axis] - 2, 0));
+      weights[axis] = x - base[axis];
+      offsets[axis] = dims[axis] > 1 ? increments[axis] : 0;
+      }
+    if (!inside)
+      {
+      std::fill(tuple, tuple + numberOfComponents, static_cast<T>(0));
+      continue;
+      }
+
+    const T* v000 = scalars + base[0] * increments[0] + base[1] * increments[1]
+      + base[2] * increments[2];
+    const double fx = weights[0], fy = weights[1], fz = weights[2];
+    const double w[8] =
+      {
+      (1 - fx) * (1 - fy) * (1 - fz), fx * (1 - fy) * (1 - fz),
+      (1 - fx) * fy * (1 - fz), fx * fy * (1 - fz),
+      (1 - fx) * (1 - fy) * fz, fx * (1 - fy) * fz,
+      (1 - fx) * fy * fz, fx * fy * fz
+      };
+    const T* corners[8] =
+      {
+      v000, v000 + offsets[0],
+      v000 + offsets[1], v000 + offsets[0] + offsets[1],
+      v000 + offsets[2], v000 + offsets[0] + offsets[2],
+      v000 + offsets[1] + offsets[2], v000 + offsets[0] + offsets[1] + offsets[2]
+      };
+    for (int c = 0; c < numberOfComponents; ++c)
+      {
+      double value = 0.;
+      for (int n = 0; n < 8; ++n)
+        {
+        value += w[n] * corners[n][c];
+        }
+      tuple[c] = RoundIfNecessary<T>(value);
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE SampleThreaderCallback(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info =
+    static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  SampleThreadData* data = static_cast<SampleThreadData*>(info->UserData);
+
+  // each thread samples a contiguous range of the sorted points, so that
+  // neighbouring points read the same voxels
+  const vtkIdType numberOfPoints = static_cast<vtkIdType>(data->Order->size());
+  const vtkIdType begin = numberOfPoints * info->ThreadID / info->NumberOfThreads;
+  const vtkIdType end = numberOfPoints * (info->ThreadID + 1) / info->NumberOfThreads;
+
+  vtkDataArray* scalars = data->Volume->GetPointData()->GetScalars();
+  switch (scalars->GetDataType())
+    {
+    vtkTemplateMacro(
+      SamplePoints(static_cast<VTK_TT*>(scalars->GetVoidPointer(0)),
+                   data->Volume->GetDimensions(),
+                   scalars->GetNumberOfComponents(),
+                   *data->Indices, *data->Order, begin, end,
+                   static_cast<VTK_TT*>(data->Output->GetVoidPointer(0))));
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+// Samples the scalars of the volume at the points of the model, that is
+// left untouched except for the new scalar array.
+void ProbeScalars(vtkNRRDReader* readerVol, vtkPolyData* polyData)
+{
+  vtkImageData* volume = readerVol->GetOutput();
+  vtkDataArray* scalars = volume->GetPointData()->GetScalars();
+
+  // RAS to the continuous index of the scalar array, as vtkProbeFilter would
+  // see it after the model is put into the scaled IJK space of the volume
+  vtkMatrix4x4* rasToIJK = readerVol->GetRasToIjkMatrix();
+  double origin[3];
+  int extent[6];
+  volume->GetOrigin(origin);
+  volume->GetExtent(extent);
+  double spacing[3];
+  volume->GetSpacing(spacing);
+  int dims[3];
+  volume->GetDimensions(dims);
+
+  const vtkIdType numberOfPoints = polyData->GetNumberOfPoints();
+  std::vector<double> indices(3 * numberOfPoints);
+  std::vector<std::pair<unsigned int, vtkIdType> > order(numberOfPoints);
+  for (vtkIdType pointId = 0; pointId < numberOfPoints; ++pointId)
+    {
+    double ras[4] = {0., 0., 0., 1.};
+    polyData->GetPoint(pointId, ras);
+    double ijk[4];
+    rasToIJK->MultiplyPoint(ras, ijk);
+    unsigned int voxel[3];
+    for (int axis = 0; axis < 3; ++axis)
+      {
+      double index = ijk[axis] - origin[axis] / spacing[axis] - extent[2 * axis];
+      indices[3 * pointId + axis] = index;
+      int v = static_cast<int>(std::floor(index));
+      voxel[axis] = static_cast<unsigned int>(std::max(0, std::min(v, dims[axis] - 1)));
+      }
+    order[pointId] = std::make_pair(MortonCode(voxel[0], voxel[1], voxel[2]), pointId);
+    }
+  std::sort(order.begin(), order.end());
+
+  vtkDataArray* output = scalars->NewInstance();
+  output->SetName(scalars->GetName() ? scalars->GetName() : "NRRDImage");
+  output->SetNumberOfComponents(scalars->GetNumberOfComponents());
+  output->SetNumberOfTuples(numberOfPoints);
+
+  if (numberOfPoints > 0)
+    {
+    SampleThreadData data;
+    data.Indices = &indices;
+    data.Order = &order;
+    data.Volume = volume;
+    data.Output = output;
+
+    vtkMultiThreader* threader = vtkMultiThreader::New();
+    const int numberOfThreads = static_cast<int>(
+      std::min(static_cast<vtkIdType>(threader->GetNumberOfThreads()), numberOfPoints));
+    threader->SetNumberOfThreads(numberOfThreads);
+    threader->SetSingleMethod(SampleThreaderCallback, &data);
+    threader->SingleMethodExecute();
+    threader->Delete();
+    }
+
+  polyData->GetPointData()->AddArray(output);
+  polyData->GetPointData()->SetActiveScalars(output->GetName());
+  output->Delete();
+}
+
+} // end of anonymous namespace
+
 int main( int argc, char * argv[] )
 {
 
@@ -48,6 +267,26 @@ int main( int argc, char * argv[] )
     return -1;
   }
 
+  // Scalar volumes are sampled directly, vtkProbeFilter still interpolates
+  // the tensors of diffusion volumes
+  vtkImageData* volume = readerVol->GetOutput();
+  if (volume->GetPointData()->GetScalars() != NULL &&
+      volume->GetPointData()->GetTensors() == NULL)
+    {
+    ProbeScalars(readerVol, polyDataRead);
+
+    vtkXMLPolyDataWriter *writer = vtkXMLPolyDataWriter::New();
+    writer->SetFileName(OutputModel.c_str() );
+    writer->SetInput( polyDataRead );
+    writer->Write();
+
+    writer->Delete();
+    readerXMLPD->Delete();
+    readerVTKPD->Delete();
+    readerVol->Delete();
+    return EXIT_SUCCESS;
+    }
+
   vtkProbeFilter *probe = vtkProbeFilter::New();
 
   // 1. Probe's source is region of interest volume
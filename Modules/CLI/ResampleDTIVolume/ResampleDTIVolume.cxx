@@ -905,12 +905,14 @@ int Do( parameters list )
       vectorNull.Fill( 0.0 );
       field->FillBuffer( vectorNull );
       }
-    // Compute the transformation field adding all the transforms together
+    // Compute the transformation field adding all the transforms together,
+    // in one pass over the field
+    typedef itk::TransformDeformationFieldFilter<double, double, 3> itkTransformDeformationFieldFilterType;
+    typename itkTransformDeformationFieldFilterType::Pointer transformDeformationFieldFilter =
+      itkTransformDeformationFieldFilterType::New();
+    bool addedTransforms = false;
     while( list.transformationFile.compare( "" ) && transformFile->GetTransformList()->size() )
       {
-      typedef itk::TransformDeformationFieldFilter<double, double, 3> itkTransformDeformationFieldFilterType;
-      typename itkTransformDeformationFieldFilterType::Pointer transformDeformationFieldFilter =
-        itkTransformDeformationFieldFilterType::New();
       transform = SetTransform<PixelType>( list, image, transformFile, outputImageCenter );
       // check if there is a bspline transform and a bulk transform with it
       if( !list.notbulk && transform->GetTransform()->GetTransformTypeAsString() ==
@@ -935,12 +937,16 @@ int Do( parameters list )
           BSplineTransform->SetBulkTransform( bulkTransform->GetTransform() );
           }
         }
+      transformDeformationFieldFilter->AddTransform( transform->GetTransform() );
+      addedTransforms = true;
+      }
+    if( addedTransforms )
+      {
       if( list.numberOfThread )
         {
         transformDeformationFieldFilter->SetNumberOfThreads( list.numberOfThread );
         }
       transformDeformationFieldFilter->SetInput( field );
-      transformDeformationFieldFilter->SetTransform( transform->GetTransform() );
       transformDeformationFieldFilter->Update();
       field = transformDeformationFieldFilter->GetOutput();
       field->DisconnectPipeline();
@@ -7,6 +7,7 @@
 #include <itkImageRegionIteratorWithIndex.h>
 #include <itkImageRegionConstIteratorWithIndex.h>
 #include <itkTransform.h>
+#include <vector>
 
 namespace itk
 {
@@ -47,7 +48,12 @@ public:
 
   itkNewMacro( Self );
 // /Set the transform
-  itkSetObjectMacro( Transform, TransformType );
+  void SetTransform( TransformType * transform );
+
+// /Append a transform, that is applied to the points mapped by the
+// /transforms already set, in the same pass over the deformation field
+  void AddTransform( TransformType * transform );
+
 #if 0 // HACK ITK_VERSION_MAJOR < 4
 // /Set the input deformation field
   void SetInput( const InputDeformationFieldType * inputDeformationField );
@@ -81,7 +87,7 @@ protected:
   void GenerateInputRequestedRegion();
 
 private:
-  typename TransformType::Pointer m_Transform;
+  std::vector<typename TransformType::Pointer> m_Transforms;
 // InputDeformationFieldPointerType m_Input ;
 };
 
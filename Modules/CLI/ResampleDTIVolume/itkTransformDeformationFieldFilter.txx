@@ -13,6 +13,27 @@ TransformDeformationFieldFilter<TInput, TOutput, NDimensions>
   this->SetNumberOfRequiredInputs( 1 );
 }
 
+template <class TInput, class TOutput, int NDimensions>
+void
+TransformDeformationFieldFilter<TInput, TOutput, NDimensions>
+::SetTransform( TransformType * transform )
+{
+  m_Transforms.clear();
+  this->AddTransform( transform );
+}
+
+template <class TInput, class TOutput, int NDimensions>
+void
+TransformDeformationFieldFilter<TInput, TOutput, NDimensions>
+::AddTransform( TransformType * transform )
+{
+  if( transform )
+    {
+    m_Transforms.push_back( transform );
+    }
+  this->Modified();
+}
+
 template <class TInput, class TOutput, int NDimensions>
 unsigned long
 TransformDeformationFieldFilter<TInput, TOutput, NDimensions>
@@ -20,11 +41,11 @@ TransformDeformationFieldFilter<TInput, TOutput, NDimensions>
 {
   unsigned long latestTime = Object::GetMTime();
 
-  if( m_Transform.IsNotNull() )
+  for( ::size_t i = 0; i < m_Transforms.size(); i++ )
     {
-    if( latestTime < m_Transform->GetMTime() )
+    if( latestTime < m_Transforms[i]->GetMTime() )
       {
-      latestTime = m_Transform->GetMTime();
+      latestTime = m_Transforms[i]->GetMTime();
       }
     }
   return latestTime;
@@ -35,7 +56,7 @@ void
 TransformDeformationFieldFilter<TInput, TOutput, NDimensions>
 ::BeforeThreadedGenerateData()
 {
-  if( m_Transform.IsNull() )
+  if( m_Transforms.empty() )
     {
     itkExceptionMacro( << "Transform not set" );
     }
@@ -85,7 +106,11 @@ TransformDeformationFieldFilter<TInput, TOutput, NDimensions>
       {
       tempPoint[i] = point[i] + static_cast<double>( vector[i] );
       }
-    outputPoint = m_Transform->TransformPoint( tempPoint );
+    outputPoint = tempPoint;
+    for( ::size_t t = 0; t < m_Transforms.size(); t++ )
+      {
+      outputPoint = m_Transforms[t]->TransformPoint( outputPoint );
+      }
     OutputDeformationPixelType outputVector;
     for( int i = 0; i < NDimensions; i++ )
       {
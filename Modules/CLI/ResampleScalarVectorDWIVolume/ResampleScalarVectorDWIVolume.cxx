@@ -28,6 +28,7 @@
 
 // ResampleScalarVectorDWIVolume includes
 #include "ResampleScalarVectorDWIVolumeCLP.h"
+#include "itkResampleVectorImageWithDeformationFieldFilter.h"
 
 // ResampleDTIVolume includes
 #include "dtiprocessFiles/deformationfieldio.h"
@@ -72,6 +73,7 @@ struct parameters
   std::string imageCenter;
   std::string transformsOrder;
   bool notbulk;
+  bool fastWarpResampling;
   };
 
 // To check the image voxel type
@@ -552,12 +554,14 @@ SetAllTransform( parameters & list,
       vectorNull.Fill( 0.0 );
       field->FillBuffer( vectorNull );
       }
-    // Compute the transformation field adding all the transforms together
+    // Compute the transformation field adding all the transforms together,
+    // in one pass over the field
+    typedef itk::TransformDeformationFieldFilter<double, double, 3> itkTransformDeformationFieldFilterType;
+    typename itkTransformDeformationFieldFilterType::Pointer transformDeformationFieldFilter =
+      itkTransformDeformationFieldFilterType::New();
+    bool addedTransforms = false;
     while( list.transformationFile.compare( "" ) && transformFile->GetTransformList()->size() )
       {
-      typedef itk::TransformDeformationFieldFilter<double, double, 3> itkTransformDeformationFieldFilterType;
-      typename itkTransformDeformationFieldFilterType::Pointer transformDeformationFieldFilter =
-        itkTransformDeformationFieldFilterType::New();
       transform = SetTransform<ImageType>( list, image, transformFile, outputImageCenter  );
       // check if there is a bspline transform and a bulk transform with it
       if( !list.notbulk && transform->GetTransformTypeAsString() == "BSplineDeformableTransform_double_3_3"  &&
@@ -581,12 +585,16 @@ SetAllTransform( parameters & list,
           BSplineTransform->SetBulkTransform( bulkTransform );
           }
         }
+      transformDeformationFieldFilter->AddTransform( transform );
+      addedTransforms = true;
+      }
+    if( addedTransforms )
+      {
       if( list.numberOfThread )
         {
         transformDeformationFieldFilter->SetNumberOfThreads( list.numberOfThread );
         }
       transformDeformationFieldFilter->SetInput( field );
-      transformDeformationFieldFilter->SetTransform( transform );
       transformDeformationFieldFilter->Update();
       field = transformDeformationFieldFilter->GetOutput();
       field->DisconnectPipeline();
@@ -1179,6 +1187,7 @@ int Rotate( parameters & list )
   typedef itk::Transform<double, 3, 3>                     TransformType;
   typedef itk::VectorImage<PixelType, 3>                   VectorImageType;
   typename ImageType::Pointer image;
+  typename VectorImageType::Pointer        inputImage;
   std::vector<typename ImageType::Pointer> vectorOfImage;
   itk::MetaDataDictionary                  dico;
   try
@@ -1194,8 +1203,9 @@ int Rotate( parameters & list )
       }
     // Save metadata dictionary
     dico = reader->GetOutput()->GetMetaDataDictionary();
+    inputImage = reader->GetOutput();
     // Separate the vector image into a vector of images
-    SeparateImages<PixelType>( reader->GetOutput(), vectorOfImage );
+    SeparateImages<PixelType>( inputImage, vectorOfImage );
     }
   catch( itk::ExceptionObject exception )
     {
@@ -1215,21 +1225,47 @@ int Rotate( parameters & list )
     {
     return EXIT_FAILURE;
     }
-  resample->SetTransform( transform );
-  resample->SetInterpolator( interpol );
-  std::vector<typename ImageType::Pointer> vectorOutputImage;
-  // Resample all the images separately
-  for( ::size_t idx = 0; idx < vectorOfImage.size(); idx++ )
+  typename itk::VectorImage<PixelType, 3>::Pointer outputImage;
+  // The deformation field of a composed transform is on the output grid:
+  // all the components can be resampled in one pass through it
+  typedef itk::WarpTransform3D<double> WarpTransformType;
+  typename WarpTransformType::Pointer warpTransform = dynamic_cast<WarpTransformType *>( transform.GetPointer() );
+  if( list.fastWarpResampling && warpTransform
+      && ( !list.interpolationType.compare( "linear" ) || !list.interpolationType.compare( "nn" ) ) )
     {
-    resample->SetInput( vectorOfImage[idx] );
-    resample->Update();
-    vectorOutputImage.push_back( resample->GetOutput() );
-    vectorOutputImage[idx]->DisconnectPipeline();
+    vectorOfImage.clear();
+    typedef itk::ResampleVectorImageWithDeformationFieldFilter<PixelType, 3> WarpResampleType;
+    typename WarpResampleType::Pointer warpResample = WarpResampleType::New();
+    warpResample->SetInput( inputImage );
+    warpResample->SetDeformationField( warpTransform->GetDeformationField() );
+    warpResample->SetNearestNeighborInterpolation( !list.interpolationType.compare( "nn" ) );
+    warpResample->SetDefaultPixelValue( list.defaultPixelValue );
+    if( list.numberOfThread )
+      {
+      warpResample->SetNumberOfThreads( list.numberOfThread );
+      }
+    warpResample->Update();
+    outputImage = warpResample->GetOutput();
+    outputImage->DisconnectPipeline();
+    }
+  else
+    {
+    inputImage = NULL;
+    resample->SetTransform( transform );
+    resample->SetInterpolator( interpol );
+    std::vector<typename ImageType::Pointer> vectorOutputImage;
+    // Resample all the images separately
+    for( ::size_t idx = 0; idx < vectorOfImage.size(); idx++ )
+      {
+      resample->SetInput( vectorOfImage[idx] );
+      resample->Update();
+      vectorOutputImage.push_back( resample->GetOutput() );
+      vectorOutputImage[idx]->DisconnectPipeline();
+      }
+    outputImage = itk::VectorImage<PixelType, 3>::New();
+    AddImage<PixelType>( outputImage, vectorOutputImage );
+    vectorOutputImage.clear();
     }
-  typename itk::VectorImage<PixelType, 3>::Pointer outputImage;
-  outputImage = itk::VectorImage<PixelType, 3>::New();
-  AddImage<PixelType>( outputImage, vectorOutputImage );
-  vectorOutputImage.clear();
   // If necessary, transform gradient vectors with the loaded transformations
   int dwmriProblem = CheckDWMRI( dico, transform );
   if( list.space ) // && list.transformationFile.compare( "" ) )
@@ -1290,6 +1326,7 @@ int main( int argc, char * argv[] )
   list.imageCenter = imageCenter;
   list.transformsOrder = transformsOrder;
   list.notbulk = notbulk;
+  list.fastWarpResampling = fastWarpResampling;
   // verify if all the vector parameters have the good length
   if( list.outputImageSpacing.size() != 3 || list.outputImageSize.size() != 3
       || ( list.outputImageOrigin.size() != 3
@@ -0,0 +1,79 @@
+#ifndef __itkResampleVectorImageWithDeformationFieldFilter_h
+#define __itkResampleVectorImageWithDeformationFieldFilter_h
+
+#include <itkImageToImageFilter.h>
+#include <itkVectorImage.h>
+#include <itkImage.h>
+#include <itkVector.h>
+
+namespace itk
+{
+/** \class ResampleVectorImageWithDeformationFieldFilter
+ *
+ * Resample all the components of a vector image in one pass through a
+ * deformation field defined on the output grid: the output voxel at index i
+ * takes the value of the input image at the physical point of i moved by the
+ * displacement of i.  The position and the interpolation weights of a voxel
+ * are computed once and used for all the components.
+ *
+ * This is the same result as resampling every component with a
+ * WarpTransform3D set to the deformation field, for linear and nearest
+ * neighbor interpolations.
+ */
+
+template <class TPixel, int NDimensions>
+class ResampleVectorImageWithDeformationFieldFilter
+  : public ImageToImageFilter<VectorImage<TPixel, NDimensions>, VectorImage<TPixel, NDimensions> >
+{
+public:
+  typedef TPixel                                                PixelType;
+  typedef VectorImage<PixelType, NDimensions>                   ImageType;
+  typedef ImageToImageFilter<ImageType, ImageType>              Superclass;
+  typedef ResampleVectorImageWithDeformationFieldFilter         Self;
+  typedef SmartPointer<Self>                                    Pointer;
+  typedef SmartPointer<const Self>                              ConstPointer;
+  typedef Image<itk::Vector<double, NDimensions>, NDimensions>  DeformationFieldType;
+  typedef typename DeformationFieldType::Pointer                DeformationFieldPointerType;
+  typedef typename ImageType::RegionType                        OutputImageRegionType;
+
+  itkNewMacro( Self );
+// /Set the deformation field, that also sets the output grid
+  itkSetObjectMacro( DeformationField, DeformationFieldType );
+// /Use a nearest neighbor instead of a linear interpolation
+  itkSetMacro( NearestNeighborInterpolation, bool );
+  itkGetConstMacro( NearestNeighborInterpolation, bool );
+// /Value of the voxels that map outside the input image
+  itkSetMacro( DefaultPixelValue, double );
+  itkGetConstMacro( DefaultPixelValue, double );
+
+// /Get the time of the last modification of the object
+  unsigned long GetMTime() const;
+
+protected:
+  ResampleVectorImageWithDeformationFieldFilter();
+#if ITK_VERSION_MAJOR < 4
+  void ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread, int threadId );
+
+#else
+  void ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread, ThreadIdType threadId );
+
+#endif
+  void BeforeThreadedGenerateData();
+
+  void GenerateOutputInformation();
+
+  void GenerateInputRequestedRegion();
+
+private:
+  DeformationFieldPointerType m_DeformationField;
+  bool                        m_NearestNeighborInterpolation;
+  double                      m_DefaultPixelValue;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkResampleVectorImageWithDeformationFieldFilter.txx"
+#endif
+
+#endif
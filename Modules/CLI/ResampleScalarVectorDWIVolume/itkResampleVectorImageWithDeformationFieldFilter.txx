@@ -0,0 +1,232 @@
+#ifndef __itkResampleVectorImageWithDeformationFieldFilter_txx
+#define __itkResampleVectorImageWithDeformationFieldFilter_txx
+
+#include "itkResampleVectorImageWithDeformationFieldFilter.h"
+
+#include <itkContinuousIndex.h>
+#include <itkImageRegionConstIteratorWithIndex.h>
+#include <itkImageRegionIterator.h>
+#include <itkNumericTraits.h>
+#include <vnl/vnl_math.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace itk
+{
+
+template <class TPixel, int NDimensions>
+ResampleVectorImageWithDeformationFieldFilter<TPixel, NDimensions>
+::ResampleVectorImageWithDeformationFieldFilter()
+{
+  this->SetNumberOfRequiredInputs( 1 );
+  m_NearestNeighborInterpolation = false;
+  m_DefaultPixelValue = 0.0;
+}
+
+template <class TPixel, int NDimensions>
+unsigned long
+ResampleVectorImageWithDeformationFieldFilter<TPixel, NDimensions>
+::GetMTime() const
+{
+  unsigned long latestTime = Superclass::GetMTime();
+
+  if( m_DeformationField.IsNotNull() )
+    {
+    if( latestTime < m_DeformationField->GetMTime() )
+      {
+      latestTime = m_DeformationField->GetMTime();
+      }
+    }
+  return latestTime;
+}
+
+template <class TPixel, int NDimensions>
+void
+ResampleVectorImageWithDeformationFieldFilter<TPixel, NDimensions>
+::BeforeThreadedGenerateData()
+{
+  if( m_DeformationField.IsNull() )
+    {
+    itkExceptionMacro( << "Deformation field not set" );
+    }
+  if( !this->GetInput( 0 ) )
+    {
+    itkExceptionMacro( << "Input image not set" );
+    }
+}
+
+template <class TPixel, int NDimensions>
+void
+#if ITK_VERSION_MAJOR < 4
+ResampleVectorImageWithDeformationFieldFilter<TPixel, NDimensions>
+::ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+                        int itkNotUsed(threadId) )
+#else
+ResampleVectorImageWithDeformationFieldFilter<TPixel, NDimensions>
+::ThreadedGenerateData( const OutputImageRegionType &outputRegionForThread,
+                        ThreadIdType itkNotUsed(threadId) )
+#endif
+  {
+  const ImageType * inputImagePtr = this->GetInput( 0 );
+  typename ImageType::Pointer outputImagePtr = this->GetOutput( 0 );
+
+  typedef ImageRegionConstIteratorWithIndex<DeformationFieldType> FieldIteratorType;
+  typedef ImageRegionIterator<ImageType>                          OutputIteratorType;
+  FieldIteratorType  field( m_DeformationField, outputRegionForThread );
+  OutputIteratorType out( outputImagePtr, outputRegionForThread );
+
+  const unsigned int                          numberOfComponents = inputImagePtr->GetNumberOfComponentsPerPixel();
+  const PixelType *                           inputBuffer = inputImagePtr->GetBufferPointer();
+  const typename ImageType::RegionType        bufferedRegion = inputImagePtr->GetBufferedRegion();
+  const typename ImageType::IndexType         bufferStart = bufferedRegion.GetIndex();
+  const typename ImageType::SizeType          bufferSize = bufferedRegion.GetSize();
+  const typename ImageType::OffsetValueType * offsetTable = inputImagePtr->GetOffsetTable();
+
+  const double minValue = static_cast<double>( NumericTraits<PixelType>::NonpositiveMin() );
+  const double maxValue = static_cast<double>( NumericTraits<PixelType>::max() );
+
+  VariableLengthVector<PixelType> defaultValue( numberOfComponents );
+  defaultValue.Fill( static_cast<PixelType>( m_DefaultPixelValue ) );
+  VariableLengthVector<PixelType> value( numberOfComponents );
+  std::vector<double>             accumulator( numberOfComponents );
+
+  itk::Point<double, NDimensions>           point;
+  itk::ContinuousIndex<double, NDimensions> continuousIndex;
+  for( field.GoToBegin(), out.GoToBegin(); !field.IsAtEnd(); ++field, ++out )
+    {
+    m_DeformationField->TransformIndexToPhysicalPoint( field.GetIndex(), point );
+    point += field.Get();
+    inputImagePtr->TransformPhysicalPointToContinuousIndex( point, continuousIndex );
+    // Same test as InterpolateImageFunction::IsInsideBuffer()
+    bool inside = true;
+    for( int i = 0; i < NDimensions && inside; i++ )
+      {
+      inside = continuousIndex[i] >= bufferStart[i] - 0.5
+        && continuousIndex[i] < bufferStart[i] + static_cast<double>( bufferSize[i] ) - 0.5;
+      }
+    if( !inside )
+      {
+      out.Set( defaultValue );
+      continue;
+      }
+    if( m_NearestNeighborInterpolation )
+      {
+      typename ImageType::OffsetValueType offset = 0;
+      for( int i = 0; i < NDimensions; i++ )
+        {
+        long index = static_cast<long>( vnl_math_rnd( continuousIndex[i] ) );
+        index = std::max( index, static_cast<long>( bufferStart[i] ) );
+        index = std::min( index, static_cast<long>( bufferStart[i] + bufferSize[i] ) - 1 );
+        offset += ( index - bufferStart[i] ) * offsetTable[i];
+        }
+      const PixelType * voxel = inputBuffer + offset * numberOfComponents;
+      for( unsigned int c = 0; c < numberOfComponents; c++ )
+        {
+        value[c] = voxel[c];
+        }
+      out.Set( value );
+      continue;
+      }
+    // Linear interpolation: the weights of the 2^N neighbors are shared
+    //   by all the components, neighbors outside the buffer are clamped
+    long   baseIndex[NDimensions];
+    double distance[NDimensions];
+    for( int i = 0; i < NDimensions; i++ )
+      {
+      baseIndex[i] = static_cast<long>( vcl_floor( continuousIndex[i] ) );
+      distance[i] = continuousIndex[i] - static_cast<double>( baseIndex[i] );
+      }
+    std::fill( accumulator.begin(), accumulator.end(), 0.0 );
+    const unsigned int numberOfNeighbors = 1 << NDimensions;
+    for( unsigned int neighbor = 0; neighbor < numberOfNeighbors; neighbor++ )
+      {
+      double                              weight = 1.0;
+      typename ImageType::OffsetValueType offset = 0;
+      for( int i = 0; i < NDimensions; i++ )
+        {
+        long index = baseIndex[i];
+        if( neighbor & ( 1 << i ) )
+          {
+          index++;
+          weight *= distance[i];
+          }
+        else
+          {
+          weight *= 1.0 - distance[i];
+          }
+        index = std::max( index, static_cast<long>( bufferStart[i] ) );
+        index = std::min( index, static_cast<long>( bufferStart[i] + bufferSize[i] ) - 1 );
+        offset += ( index - bufferStart[i] ) * offsetTable[i];
+        }
+      if( weight == 0.0 )
+        {
+        continue;
+        }
+      const PixelType * voxel = inputBuffer + offset * numberOfComponents;
+      for( unsigned int c = 0; c < numberOfComponents; c++ )
+        {
+        accumulator[c] += weight * static_cast<double>( voxel[c] );
+        }
+      }
+    for( unsigned int c = 0; c < numberOfComponents; c++ )
+      {
+      const double clamped = std::min( std::max( accumulator[c], minValue ), maxValue );
+      value[c] = static_cast<PixelType>( clamped );
+      }
+    out.Set( value );
+    }
+  }
+
+/**
+ * The output has the grid of the deformation field
+ */
+template <class TPixel, int NDimensions>
+void
+ResampleVectorImageWithDeformationFieldFilter<TPixel, NDimensions>
+::GenerateOutputInformation()
+{
+  // call the superclass' implementation of this method
+  Superclass::GenerateOutputInformation();
+  // get pointers to the input and output
+  typename ImageType::Pointer outputPtr = this->GetOutput( 0 );
+  if( !outputPtr || m_DeformationField.IsNull() )
+    {
+    return;
+    }
+  outputPtr->SetSpacing( m_DeformationField->GetSpacing() );
+  outputPtr->SetOrigin( m_DeformationField->GetOrigin() );
+  outputPtr->SetDirection( m_DeformationField->GetDirection() );
+  outputPtr->SetLargestPossibleRegion( m_DeformationField->GetLargestPossibleRegion() );
+  if( this->GetInput( 0 ) )
+    {
+    outputPtr->SetVectorLength( this->GetInput( 0 )->GetNumberOfComponentsPerPixel() );
+    }
+  return;
+}
+
+/**
+ * Inform pipeline of necessary input image region
+ *
+ * As in TransformDeformationFieldFilter, nothing is assumed about the
+ * deformation and the entire input image is requested.
+ */
+template <class TPixel, int NDimensions>
+void
+ResampleVectorImageWithDeformationFieldFilter<TPixel, NDimensions>
+::GenerateInputRequestedRegion()
+{
+  // call the superclass's implementation of this method
+  Superclass::GenerateInputRequestedRegion();
+
+  if( !this->GetInput() )
+    {
+    return;
+    }
+  typename ImageType::Pointer inputPtr = const_cast<ImageType *>( this->GetInput() );
+  inputPtr->SetRequestedRegion( inputPtr->GetLargestPossibleRegion() );
+  return;
+}
+
+} // end namespace itk
+#endif
@@ -76,6 +76,7 @@ int main(int argc, char* * argv)
 
   seg.setIntensityHomogeneity(intensityHomogeneity);
   seg.setCurvatureWeight(curvatureWeight / 1.5);
+  seg.setNumberOfThreads(numberOfThreads);
 
   seg.doSegmenation();
 
@@ -2,7 +2,7 @@
 #define SFLS_h_
 
 // std
-#include <list>
+#include <vector>
 
 // itk
 #include "vnl/vnl_vector_fixed.h"
@@ -13,7 +13,10 @@ public:
   typedef CSFLS Self;
 
   typedef vnl_vector_fixed<int, 3> NodeType;
-  typedef std::list<NodeType>      CSFLSLayer;
+  /* The layers are contiguous: they are visited by index, shared out
+     between threads, and compacted in order instead of erasing in the
+     middle. */
+  typedef std::vector<NodeType>    CSFLSLayer;
 
   // typedef boost::shared_ptr< Self > Pointer;
 
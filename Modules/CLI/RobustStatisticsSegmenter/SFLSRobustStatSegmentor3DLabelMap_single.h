@@ -55,6 +55,8 @@ public:
   typedef typename SuperClassType::TSize   TSize;
   typedef typename SuperClassType::TRegion TRegion;
 
+  typedef typename SuperClassType::ZeroLayerChunk ZeroLayerChunk;
+
   /* ============================================================
    * functions
    * ============================================================*/
@@ -91,7 +93,13 @@ protected:
 
   double m_kernelWidthFactor; // kernel_width = empirical_std/m_kernelWidthFactor, Eric has it at 10.0
 
+  /* curvature and image force on the zero layer, filled by the chunks */
+  std::vector<double> m_kappaOnZeroLS;
+  std::vector<double> m_cvForce;
+
   /* fn */
+  void threadedComputeForce(ZeroLayerChunk& chunk);
+
   void initFeatureComputedImage();
 
   void initFeatureImage();
@@ -79,38 +79,59 @@ void
 CSFLSRobustStatSegmentor3DLabelMap<TPixel>
 ::computeForce()
 {
+  long n = this->m_lz.size();
+
+  m_kappaOnZeroLS.resize(n);
+  m_cvForce.resize(n);
+
+  this->executeOnZeroLayer(SuperClassType::ZeroLayerForceTask);
+
   double fmax = std::numeric_limits<double>::min();
   double kappaMax = std::numeric_limits<double>::min();
+  for( size_t ichunk = 0; ichunk < this->m_zeroLayerChunks.size(); ++ichunk )
+    {
+    fmax = std::max(fmax, this->m_zeroLayerChunks[ichunk].forceMax);
+    kappaMax = std::max(kappaMax, this->m_zeroLayerChunks[ichunk].kappaMax);
+    }
 
-  long    n = this->m_lz.size();
-  double* kappaOnZeroLS = new double[n];
-  double* cvForce = new double[n];
+  // std::cout<<"fmax = "<<fmax<<std::endl;
 
-  std::vector<typename CSFLSLayer::iterator> m_lzIterVct( n );
+  this->m_force.resize(n);
+  for( long i = 0; i < n; ++i )
     {
-    long iiizzz = 0;
-    for( typename CSFLSLayer::iterator itz = this->m_lz.begin(); itz != this->m_lz.end(); ++itz )
-      {
-      m_lzIterVct[iiizzz++] = itz;
-      }
+    // this->m_force.push_back(cvForce[i]/(fmax + 1e-10) +  (this->m_curvatureWeight)*kappaOnZeroLS[i]);
+    this->m_force[i] = (1 - (this->m_curvatureWeight) ) * m_cvForce[i] / (fmax + 1e-10) \
+      +  (this->m_curvatureWeight) * m_kappaOnZeroLS[i] / (kappaMax + 1e-10);
     }
+}
+
+/* ============================================================
+   threadedComputeForce
+
+   The features are cached at the points of the chunk only, so that the
+   chunks can be computed concurrently.  */
+template <typename TPixel>
+void
+CSFLSRobustStatSegmentor3DLabelMap<TPixel>
+::threadedComputeForce(ZeroLayerChunk& chunk)
+{
+  double fmax = std::numeric_limits<double>::min();
+  double kappaMax = std::numeric_limits<double>::min();
+
+  std::vector<double> f(m_numberOfFeature);
 
 // #ifndef NDEBUG
 //     std::ofstream ff("/tmp/force.txt");
 // #endif
-  for( long i = 0; i < n; ++i )
+  for( long i = chunk.begin; i < chunk.end; ++i )
     {
-    typename CSFLSLayer::iterator itz = m_lzIterVct[i];
-
-    long ix = (*itz)[0];
-    long iy = (*itz)[1];
-    long iz = (*itz)[2];
+    long ix = this->m_lz[i][0];
+    long iy = this->m_lz[i][1];
+    long iz = this->m_lz[i][2];
 
     TIndex idx = {{ix, iy, iz}};
 
-    kappaOnZeroLS[i] = this->computeKappa(ix, iy, iz);
-
-    std::vector<double> f(m_numberOfFeature);
+    m_kappaOnZeroLS[i] = this->computeKappa(ix, iy, iz);
 
     computeFeatureAt(idx, f);
 
@@ -118,23 +139,13 @@ CSFLSRobustStatSegmentor3DLabelMap<TPixel>
     double a = -kernelEvaluationUsingPDF(f);
 
     fmax = fmax > fabs(a) ? fmax : fabs(a);
-    kappaMax = kappaMax > fabs(kappaOnZeroLS[i]) ? kappaMax : fabs(kappaOnZeroLS[i]);
+    kappaMax = kappaMax > fabs(m_kappaOnZeroLS[i]) ? kappaMax : fabs(m_kappaOnZeroLS[i]);
 
-    cvForce[i] = a;
-    }
-
-  // std::cout<<"fmax = "<<fmax<<std::endl;
-
-  this->m_force.resize(n);
-  for( long i = 0; i < n; ++i )
-    {
-    // this->m_force.push_back(cvForce[i]/(fmax + 1e-10) +  (this->m_curvatureWeight)*kappaOnZeroLS[i]);
-    this->m_force[i] = (1 - (this->m_curvatureWeight) ) * cvForce[i] / (fmax + 1e-10) \
-      +  (this->m_curvatureWeight) * kappaOnZeroLS[i] / (kappaMax + 1e-10);
+    m_cvForce[i] = a;
     }
 
-  delete[] kappaOnZeroLS;
-  delete[] cvForce;
+  chunk.forceMax = fmax;
+  chunk.kappaMax = kappaMax;
 }
 
 /* ============================================================  */
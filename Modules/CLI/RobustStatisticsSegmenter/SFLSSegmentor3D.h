@@ -11,6 +11,7 @@
 
 // itk
 #include "itkImage.h"
+#include "itkMultiThreader.h"
 
 template <typename TPixel>
 class CSFLSSegmentor3D : public CSFLS
@@ -55,6 +56,10 @@ public:
 
   void setNumIter(unsigned long n);
 
+  /* Number of threads sharing the zero layer, the result doesn't depend
+     on it. 0 for the ITK default. */
+  void setNumberOfThreads(int n);
+
   void setImage(typename ImageType::Pointer img);
   void setMask(typename MaskImageType::Pointer mask);
 
@@ -154,6 +159,52 @@ protected:
     return a - b < eps && b - a < eps;
   }
 
+  /*----------------------------------------------------------------------
+    The zero layer is cut in consecutive chunks, one per thread. The
+    force and the new phi of the points of a chunk are computed
+    concurrently; what a chunk produces is kept in the chunk and merged
+    in chunk order, so that the layers are the same as with one thread. */
+  struct ZeroLayerChunk
+  {
+    long begin;
+    long end;
+    /* maxima of the chunk, for the force normalization */
+    double forceMax;
+    double kappaMax;
+    /* points of [begin, end) that stay in the zero layer, moved to
+       [begin, begin + kept) */
+    long       kept;
+    CSFLSLayer in2out;
+    CSFLSLayer out2in;
+    CSFLSLayer sp1;
+    CSFLSLayer sn1;
+  };
+
+  enum ZeroLayerTask
+    {
+    ZeroLayerForceTask,
+    ZeroLayerEvolutionTask
+    };
+
+  /* Split m_lz and run the task on every chunk, in parallel */
+  void executeOnZeroLayer(ZeroLayerTask task);
+
+  /* Compute the force on the chunk, the subclasses that compute
+     their force with executeOnZeroLayer() implement it */
+  virtual void threadedComputeForce(ZeroLayerChunk& )
+  {
+  }
+
+  /* Step 1 of the evolution: add the force to phi on the chunk */
+  void threadedEvolveZeroLayer(ZeroLayerChunk& chunk);
+
+  static ITK_THREAD_RETURN_TYPE zeroLayerThreaderCallback(void* arg);
+
+  int                         m_numberOfThreads;
+  itk::MultiThreader::Pointer m_threader;
+  ZeroLayerTask               m_zeroLayerTask;
+  std::vector<ZeroLayerChunk> m_zeroLayerChunks;
+
   bool                    m_keepZeroLayerHistory;
   std::vector<CSFLSLayer> m_zeroLayerHistory;
 
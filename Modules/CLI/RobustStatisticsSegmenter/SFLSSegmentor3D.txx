@@ -16,6 +16,8 @@ template <typename TPixel>
 CSFLSSegmentor3D<TPixel>
 ::CSFLSSegmentor3D() : CSFLS()
 {
+  m_threader = itk::MultiThreader::New();
+
   basicInit();
 }
 
@@ -47,6 +49,9 @@ CSFLSSegmentor3D<TPixel>
 
   m_keepZeroLayerHistory = false;
 
+  m_numberOfThreads = 0;
+  m_zeroLayerTask = ZeroLayerForceTask;
+
   m_done = false;
 }
 
@@ -60,6 +65,16 @@ CSFLSSegmentor3D<TPixel>
   m_numIter = n;
 }
 
+/* ============================================================
+   setNumberOfThreads    */
+template <typename TPixel>
+void
+CSFLSSegmentor3D<TPixel>
+::setNumberOfThreads(int n)
+{
+  m_numberOfThreads = n > 0 ? n : 0;
+}
+
 /* ============================================================
    setImage    */
 template <typename TPixel>
@@ -399,6 +414,134 @@ CSFLSSegmentor3D<TPixel>
   return;
 }
 
+/* ============================================================
+   executeOnZeroLayer    */
+template <typename TPixel>
+void
+CSFLSSegmentor3D<TPixel>
+::executeOnZeroLayer(ZeroLayerTask task)
+{
+  long nz = m_lz.size();
+
+  int numberOfThreads = m_numberOfThreads > 0 ?
+    m_numberOfThreads : itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+
+  // on a small zero layer, starting the threads costs more than it saves
+  const long minChunkSize = 1024;
+  long       numberOfChunks = std::min(static_cast<long>(numberOfThreads), nz / minChunkSize);
+  numberOfChunks = std::max(numberOfChunks, 1L);
+
+  m_zeroLayerChunks.resize(numberOfChunks);
+  for( long ichunk = 0; ichunk < numberOfChunks; ++ichunk )
+    {
+    ZeroLayerChunk& chunk = m_zeroLayerChunks[ichunk];
+    chunk.begin = nz * ichunk / numberOfChunks;
+    chunk.end = nz * (ichunk + 1) / numberOfChunks;
+    chunk.forceMax = 0;
+    chunk.kappaMax = 0;
+    chunk.kept = 0;
+    chunk.in2out.clear();
+    chunk.out2in.clear();
+    chunk.sp1.clear();
+    chunk.sn1.clear();
+    }
+
+  m_zeroLayerTask = task;
+  if( numberOfChunks == 1 )
+    {
+    itk::MultiThreader::ThreadInfoStruct info;
+    info.ThreadID = 0;
+    info.NumberOfThreads = 1;
+    info.UserData = this;
+    zeroLayerThreaderCallback(&info);
+    }
+  else
+    {
+    m_threader->SetNumberOfThreads(numberOfChunks);
+    m_threader->SetSingleMethod(zeroLayerThreaderCallback, this);
+    m_threader->SingleMethodExecute();
+    }
+}
+
+/* ============================================================
+   zeroLayerThreaderCallback    */
+template <typename TPixel>
+ITK_THREAD_RETURN_TYPE
+CSFLSSegmentor3D<TPixel>
+::zeroLayerThreaderCallback(void* arg)
+{
+  itk::MultiThreader::ThreadInfoStruct* info =
+    static_cast<itk::MultiThreader::ThreadInfoStruct *>(arg);
+  Self* self = static_cast<Self *>(info->UserData);
+
+  // the threader may give less threads than asked for
+  long numberOfChunks = self->m_zeroLayerChunks.size();
+  for( long ichunk = info->ThreadID; ichunk < numberOfChunks; ichunk += info->NumberOfThreads )
+    {
+    if( self->m_zeroLayerTask == ZeroLayerForceTask )
+      {
+      self->threadedComputeForce(self->m_zeroLayerChunks[ichunk]);
+      }
+    else
+      {
+      self->threadedEvolveZeroLayer(self->m_zeroLayerChunks[ichunk]);
+      }
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+/* ============================================================
+   threadedEvolveZeroLayer
+
+   Only the phi of the points of the chunk is written, the points that
+   stay in the zero layer are moved to the front of the chunk.  */
+template <typename TPixel>
+void
+CSFLSSegmentor3D<TPixel>
+::threadedEvolveZeroLayer(ZeroLayerChunk& chunk)
+{
+  long kept = chunk.begin;
+  for( long itf = chunk.begin; itf < chunk.end; ++itf )
+    {
+    const NodeType node = m_lz[itf];
+
+    TIndex idx = {{node[0], node[1], node[2]}};
+
+    double phi_old = mp_phi->GetPixel(idx);
+    double phi_new = phi_old + m_force[itf];
+
+    /*----------------------------------------------------------------------
+      Update the lists of pt who change the state, for faster
+      energy fnal computation. */
+    if( phi_old <= 0 && phi_new > 0 )
+      {
+      chunk.in2out.push_back(node);
+      }
+
+    if( phi_old > 0  && phi_new <= 0 )
+      {
+      chunk.out2in.push_back(node);
+      }
+
+    mp_phi->SetPixel(idx, phi_new);
+
+    if( phi_new > 0.5 )
+      {
+      chunk.sp1.push_back(node);
+      }
+    else if( phi_new < -0.5 )
+      {
+      chunk.sn1.push_back(node);
+      }
+    else
+      {
+      m_lz[kept++] = node;
+      }
+    }
+  chunk.kept = kept - chunk.begin;
+}
+
 /* ============================================================
    oneStepLevelSetEvolution    */
 template <typename TPixel>
@@ -421,78 +564,28 @@ CSFLSSegmentor3D<TPixel>
     scan Lz values [-2.5 -1.5)[-1.5 -.5)[-.5 .5](.5 1.5](1.5 2.5]
     ========                */
     {
-    // std::list<double>::const_iterator itf = m_force.begin();
-
-    long                              nz = m_lz.size();
-    std::vector<CSFLSLayer::iterator> m_lzIterVct( nz );
-      {
-      long iiizzz = 0;
-      for( CSFLSLayer::iterator itz = m_lz.begin(); itz != m_lz.end(); ++itz )
-        {
-        m_lzIterVct[iiizzz++] = itz;
-        }
-      }
-    //    for (CSFLSLayer::iterator itz = m_lz.begin(); itz != m_lz.end(); ++itf)
-    // #pragma omp parallel for
-    for( long iiizzz = 0; iiizzz < nz; ++iiizzz )
+    executeOnZeroLayer(ZeroLayerEvolutionTask);
+
+    /*--------------------------------------------------
+      Merge the chunks in order: the points that stay are moved down
+      to the front of m_lz, the lists are concatenated.
+      NOTE, mp_label are (should) NOT update here. They should
+      be updated with Sz, Sn/p's
+      --------------------------------------------------*/
+    long nz = 0;
+    for( size_t ichunk = 0; ichunk < m_zeroLayerChunks.size(); ++ichunk )
       {
-      long itf = iiizzz;
-
-      CSFLSLayer::iterator itz = m_lzIterVct[iiizzz];
-
-      long ix = (*itz)[0];
-      long iy = (*itz)[1];
-      long iz = (*itz)[2];
-
-      TIndex idx = {{ix, iy, iz}};
-
-      double phi_old = mp_phi->GetPixel(idx);
-      double phi_new = phi_old + m_force[itf];
-
-      /*----------------------------------------------------------------------
-        Update the lists of pt who change the state, for faster
-        energy fnal computation. */
-      if( phi_old <= 0 && phi_new > 0 )
-        {
-        m_lIn2out.push_back(NodeType(ix, iy, iz) );
-        }
-
-      if( phi_old > 0  && phi_new <= 0 )
-        {
-        m_lOut2in.push_back(NodeType(ix, iy, iz) );
-        }
-
-      //           // DEBUG
-      //           if (phi_new > 3.1 || phi_new < -3.1)
-      //             {
-      //               std::cout<<"phi_old = "<<phi_old<<std::endl;
-      //               std::cout<<"its lbl = "<<(int)mp_label->get(ix, iy)<<std::endl;
-
-      //               std::cerr<<"phi_new > 3.1 || phi_new < -3.1\n";
-      //               raise(SIGABRT);
-      //             }
+      const ZeroLayerChunk& chunk = m_zeroLayerChunks[ichunk];
 
-      mp_phi->SetPixel(idx, phi_new);
+      std::copy(m_lz.begin() + chunk.begin, m_lz.begin() + chunk.begin + chunk.kept, m_lz.begin() + nz);
+      nz += chunk.kept;
 
-      if( phi_new > 0.5 )
-        {
-        Sp1.push_back(*itz);
-        itz = m_lz.erase(itz);
-        }
-      else if( phi_new < -0.5 )
-        {
-        Sn1.push_back(*itz);
-        itz = m_lz.erase(itz);
-        }
-      else
-        {
-        ++itz;
-        }
-      /*--------------------------------------------------
-        NOTE, mp_label are (should) NOT update here. They should
-        be updated with Sz, Sn/p's
-        --------------------------------------------------*/
+      m_lIn2out.insert(m_lIn2out.end(), chunk.in2out.begin(), chunk.in2out.end() );
+      m_lOut2in.insert(m_lOut2in.end(), chunk.out2in.begin(), chunk.out2in.end() );
+      Sp1.insert(Sp1.end(), chunk.sp1.begin(), chunk.sp1.end() );
+      Sn1.insert(Sn1.end(), chunk.sn1.begin(), chunk.sn1.end() );
       }
+    m_lz.resize(nz);
     }
 
   //     // debug
@@ -502,7 +595,8 @@ CSFLSSegmentor3D<TPixel>
 
     2.1 scan Ln1 values [-2.5 -1.5)[-1.5 -.5)[-.5 .5](.5 1.5](1.5 2.5]
     ==========                     */
-  for( CSFLSLayer::iterator itn1 = m_ln1.begin(); itn1 != m_ln1.end(); )
+  CSFLSLayer::iterator keptn1 = m_ln1.begin();
+  for( CSFLSLayer::iterator itn1 = m_ln1.begin(); itn1 != m_ln1.end(); ++itn1 )
     {
     long ix = (*itn1)[0];
     long iy = (*itn1)[1];
@@ -521,16 +615,14 @@ CSFLSSegmentor3D<TPixel>
       if( phi_new >= -0.5 )
         {
         Sz.push_back(*itn1);
-        itn1 = m_ln1.erase(itn1);
         }
       else if( phi_new < -1.5 )
         {
         Sn2.push_back(*itn1);
-        itn1 = m_ln1.erase(itn1);
         }
       else
         {
-        ++itn1;
+        *keptn1++ = *itn1;
         }
       }
     else
@@ -540,18 +632,19 @@ CSFLSSegmentor3D<TPixel>
         should go to Sn2. And the phi shold be further -1
       */
       Sn2.push_back(*itn1);
-      itn1 = m_ln1.erase(itn1);
 
       mp_phi->SetPixel(idx, mp_phi->GetPixel(idx) - 1);
       }
     }
+  m_ln1.erase(keptn1, m_ln1.end() );
 
   //     // debug
   //     labelsCoherentCheck1();
   /*--------------------------------------------------
     2.2 scan Lp1 values [-2.5 -1.5)[-1.5 -.5)[-.5 .5](.5 1.5](1.5 2.5]
     ========          */
-  for( CSFLSLayer::iterator itp1 = m_lp1.begin(); itp1 != m_lp1.end(); )
+  CSFLSLayer::iterator keptp1 = m_lp1.begin();
+  for( CSFLSLayer::iterator itp1 = m_lp1.begin(); itp1 != m_lp1.end(); ++itp1 )
     {
     long ix = (*itp1)[0];
     long iy = (*itp1)[1];
@@ -570,16 +663,14 @@ CSFLSSegmentor3D<TPixel>
       if( phi_new <= 0.5 )
         {
         Sz.push_back(*itp1);
-        itp1 = m_lp1.erase(itp1);
         }
       else if( phi_new > 1.5 )
         {
         Sp2.push_back(*itp1);
-        itp1 = m_lp1.erase(itp1);
         }
       else
         {
-        ++itp1;
+        *keptp1++ = *itp1;
         }
       }
     else
@@ -590,18 +681,19 @@ CSFLSSegmentor3D<TPixel>
       */
 
       Sp2.push_back(*itp1);
-      itp1 = m_lp1.erase(itp1);
 
       mp_phi->SetPixel(idx, mp_phi->GetPixel(idx) + 1);
       }
     }
+  m_lp1.erase(keptp1, m_lp1.end() );
 
   //     // debug
   //     labelsCoherentCheck1();
   /*--------------------------------------------------
     2.3 scan Ln2 values [-2.5 -1.5)[-1.5 -.5)[-.5 .5](.5 1.5](1.5 2.5]
     ==========                                      */
-  for( CSFLSLayer::iterator itn2 = m_ln2.begin(); itn2 != m_ln2.end(); )
+  CSFLSLayer::iterator keptn2 = m_ln2.begin();
+  for( CSFLSLayer::iterator itn2 = m_ln2.begin(); itn2 != m_ln2.end(); ++itn2 )
     {
     long ix = (*itn2)[0];
     long iy = (*itn2)[1];
@@ -620,33 +712,32 @@ CSFLSSegmentor3D<TPixel>
       if( phi_new >= -1.5 )
         {
         Sn1.push_back(*itn2);
-        itn2 = m_ln2.erase(itn2);
         }
       else if( phi_new < -2.5 )
         {
-        itn2 = m_ln2.erase(itn2);
         mp_phi->SetPixel(idx, -3);
         mp_label->SetPixel(idx, -3);
         }
       else
         {
-        ++itn2;
+        *keptn2++ = *itn2;
         }
       }
     else
       {
-      itn2 = m_ln2.erase(itn2);
       mp_phi->SetPixel(idx, -3);
       mp_label->SetPixel(idx, -3);
       }
     }
+  m_ln2.erase(keptn2, m_ln2.end() );
 
   //     // debug
   //     labelsCoherentCheck1();
   /*--------------------------------------------------
     2.4 scan Lp2 values [-2.5 -1.5)[-1.5 -.5)[-.5 .5](.5 1.5](1.5 2.5]
     ========= */
-  for( CSFLSLayer::iterator itp2 = m_lp2.begin(); itp2 != m_lp2.end(); )
+  CSFLSLayer::iterator keptp2 = m_lp2.begin();
+  for( CSFLSLayer::iterator itp2 = m_lp2.begin(); itp2 != m_lp2.end(); ++itp2 )
     {
     long   ix = (*itp2)[0];
     long   iy = (*itp2)[1];
@@ -664,26 +755,24 @@ CSFLSSegmentor3D<TPixel>
       if( phi_new <= 1.5 )
         {
         Sp1.push_back(*itp2);
-        itp2 = m_lp2.erase(itp2);
         }
       else if( phi_new > 2.5 )
         {
-        itp2 = m_lp2.erase(itp2);
         mp_phi->SetPixel(idx, 3);
         mp_label->SetPixel(idx, 3);
         }
       else
         {
-        ++itp2;
+        *keptp2++ = *itp2;
         }
       }
     else
       {
-      itp2 = m_lp2.erase(itp2);
       mp_phi->SetPixel(idx, 3);
       mp_label->SetPixel(idx, 3);
       }
     }
+  m_lp2.erase(keptp2, m_lp2.end() );
 
   //     // debug
   //     labelsCoherentCheck1();
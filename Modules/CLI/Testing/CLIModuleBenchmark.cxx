@@ -0,0 +1,561 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH)
+  All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+/// CLI module scaling benchmark.
+///
+/// Generates synthetic volumes of increasing size and runs CLI modules on
+/// them through the ModuleEntryPoint of their shared library, once per
+/// number of threads. Each run is a child process, so that its wall time,
+/// CPU time and peak resident memory are measured by the system. The
+/// results and the parallel efficiency (T1 / (N * TN)) are printed as a
+/// table, and written as JSON with --output, e.g.:
+///
+///   CLIModuleBenchmark --module-dir lib/Slicer-4.2/cli-modules
+///     --sizes 64,128,256 --threads 1,2,4,8,16,32 --output scaling.json
+///
+/// Run with --help for the list of options and of the default cases. A case
+/// is a module name and its arguments, where {input}, {moving}, {label},
+/// {output} and {threads} are replaced for each run.
+
+// ITK includes
+#include <itkImage.h>
+#include <itkImageFileWriter.h>
+#include <itkImageRegionIteratorWithIndex.h>
+#include <itkMultiThreader.h>
+
+// KWSys includes
+#include <itksys/DynamicLoader.hxx>
+#include <itksys/SystemTools.hxx>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// POSIX includes
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+
+typedef int (*ModuleEntryPointType)(int argc, char* argv[]);
+
+//----------------------------------------------------------------------------
+struct BenchmarkCase
+{
+  std::string Module;
+  std::string Arguments;
+  ModuleEntryPointType EntryPoint;
+};
+
+//----------------------------------------------------------------------------
+// Default cases: filters, resampling, registration and surface extraction
+const char* DefaultCases[][2] = {
+  {"GaussianBlurImageFilter", "--sigma 2 {input} {output}"},
+  {"MedianImageFilter", "--neighborhood 2,2,2 {input} {output}"},
+  {"GradientAnisotropicDiffusion", "--iterations 5 {input} {output}"},
+  {"CurvatureAnisotropicDiffusion", "--iterations 5 {input} {output}"},
+  {"ResampleScalarVolume", "--spacing 0.7,0.7,0.7 --interpolation linear {input} {output}"},
+  {"ExpertAutomatedRegistration", "--registration PipelineAffine --numberOfThreads {threads}"
+                                  " --resampledImage {output} {input} {moving}"},
+  {"ModelMaker", "--generateAll --numberOfThreads {threads} --modelSceneFile {output}.mrml {label}"}
+};
+
+//----------------------------------------------------------------------------
+struct BenchmarkParameters
+{
+  BenchmarkParameters()
+    {
+    this->Sizes.push_back(64);
+    this->Sizes.push_back(128);
+    this->Sizes.push_back(256);
+    this->Threads.push_back(1);
+    this->Threads.push_back(2);
+    this->Threads.push_back(4);
+    this->Threads.push_back(8);
+    this->Threads.push_back(16);
+    this->Threads.push_back(32);
+    this->Repeat = 1;
+    this->Verbose = false;
+    }
+  std::string ModuleDirectory;
+  std::string TemporaryDirectory;
+  std::vector<int> Sizes;
+  std::vector<int> Threads;
+  std::vector<std::string> Modules;
+  std::vector<BenchmarkCase> Cases;
+  int Repeat;
+  bool Verbose;
+  std::string Output;
+};
+
+//----------------------------------------------------------------------------
+struct RunResult
+{
+  RunResult() : WallTime(0.), CPUTime(0.), PeakRSS(0.), Status(0) {}
+  double WallTime;  // seconds
+  double CPUTime;   // seconds, user + system of all the threads
+  double PeakRSS;   // MB
+  int Status;
+};
+
+//----------------------------------------------------------------------------
+void printUsage(const char* program)
+{
+  std::cout
+    << "Usage: " << program << " --module-dir dir [options]\n"
+    << "  --module-dir dir         directory of the CLI module libraries\n"
+    << "  --temp-dir dir           directory of the generated volumes"
+    << " (default: current directory)\n"
+    << "  --sizes N,N,...          edge length of the cubic volumes"
+    << " (default: 64,128,256)\n"
+    << "  --threads N,N,...        numbers of threads (default: 1,2,4,8,16,32)\n"
+    << "  --modules M,M,...        run only these default cases\n"
+    << "  --case \"M args\"          add a case, may be repeated; replaces"
+    << " the default cases\n"
+    << "  --repeat N               runs per measure, the fastest is kept"
+    << " (default: 1)\n"
+    << "  --verbose                show the output of the modules\n"
+    << "  --output file.json       write the results in a file\n"
+    << "Default cases:\n";
+  for (size_t i = 0; i < sizeof(DefaultCases) / sizeof(DefaultCases[0]); ++i)
+    {
+    std::cout << "  " << DefaultCases[i][0] << " " << DefaultCases[i][1] << "\n";
+    }
+}
+
+//----------------------------------------------------------------------------
+bool parseList(const char* text, std::vector<int>& values)
+{
+  std::string list(text);
+  std::replace(list.begin(), list.end(), ',', ' ');
+  std::istringstream stream(list);
+  values.clear();
+  int value;
+  while (stream >> value)
+    {
+    if (value < 1)
+      {
+      return false;
+      }
+    values.push_back(value);
+    }
+  return stream.eof() && !values.empty();
+}
+
+//----------------------------------------------------------------------------
+std::vector<std::string> splitWords(const std::string& text, char separator)
+{
+  std::vector<std::string> words;
+  std::string word;
+  std::istringstream stream(text);
+  while (std::getline(stream, word, separator))
+    {
+    if (!word.empty())
+      {
+      words.push_back(word);
+      }
+    }
+  return words;
+}
+
+//----------------------------------------------------------------------------
+bool parseArguments(int argc, char* argv[], BenchmarkParameters& parameters)
+{
+  for (int i = 1; i < argc; ++i)
+    {
+    std::string option(argv[i]);
+    if (option == "--help" || option == "-h")
+      {
+      return false;
+      }
+    if (option == "--verbose")
+      {
+      parameters.Verbose = true;
+      continue;
+      }
+    if (i + 1 >= argc)
+      {
+      std::cerr << "Missing value for " << option << std::endl;
+      return false;
+      }
+    const char* value = argv[++i];
+    bool valid = true;
+    if (option == "--module-dir")
+      {
+      parameters.ModuleDirectory = value;
+      }
+    else if (option == "--temp-dir")
+      {
+      parameters.TemporaryDirectory = value;
+      }
+    else if (option == "--sizes")
+      {
+      valid = parseList(value, parameters.Sizes);
+      }
+    else if (option == "--threads")
+      {
+      valid = parseList(value, parameters.Threads);
+      }
+    else if (option == "--modules")
+      {
+      parameters.Modules = splitWords(value, ',');
+      }
+    else if (option == "--case")
+      {
+      std::string text(value);
+      const size_t space = text.find(' ');
+      BenchmarkCase benchmarkCase;
+      benchmarkCase.Module = text.substr(0, space);
+      benchmarkCase.Arguments = space == std::string::npos ? "" : text.substr(space + 1);
+      benchmarkCase.EntryPoint = 0;
+      valid = !benchmarkCase.Module.empty();
+      parameters.Cases.push_back(benchmarkCase);
+      }
+    else if (option == "--repeat")
+      {
+      parameters.Repeat = atoi(value);
+      valid = parameters.Repeat >= 1;
+      }
+    else if (option == "--output")
+      {
+      parameters.Output = value;
+      }
+    else
+      {
+      std::cerr << "Unknown option " << option << std::endl;
+      return false;
+      }
+    if (!valid)
+      {
+      std::cerr << "Invalid value for " << option << ": " << value << std::endl;
+      return false;
+      }
+    }
+  if (parameters.ModuleDirectory.empty())
+    {
+    std::cerr << "Missing --module-dir" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// Smooth pattern with some structure in all the directions, shifted by
+// offset voxels, and nested blobs for the label map.
+template <class TImage>
+bool writeImage(const std::string& fileName, int size, double offset, bool labels)
+{
+  typename TImage::Pointer image = TImage::New();
+  typename TImage::SizeType imageSize;
+  imageSize.Fill(size);
+  typename TImage::RegionType region(imageSize);
+  image->SetRegions(region);
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<TImage> it(image, region);
+  const double center = 0.5 * size;
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+    const typename TImage::IndexType index = it.GetIndex();
+    const double x = index[0] + offset;
+    const double y = index[1];
+    const double z = index[2];
+    if (labels)
+      {
+      const double r = sqrt((x - center) * (x - center) + (y - center) * (y - center) +
+                            (z - center) * (z - center)) / center;
+      it.Set(r < 0.3 ? 3 : r < 0.6 ? 2 : r < 0.9 ? 1 : 0);
+      continue;
+      }
+    const double value = sin(x * 0.05) + cos(y * 0.07) + sin(z * 0.11);
+    it.Set(static_cast<typename TImage::PixelType>(1000. * (value + 3.) / 6.));
+    }
+
+  typename itk::ImageFileWriter<TImage>::Pointer writer =
+    itk::ImageFileWriter<TImage>::New();
+  writer->SetInput(image);
+  writer->SetFileName(fileName.c_str());
+  try
+    {
+    writer->Update();
+    }
+  catch (itk::ExceptionObject& e)
+    {
+    std::cerr << "Can't write " << fileName << ": " << e << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+std::string replaceAll(std::string text, const std::string& key, const std::string& value)
+{
+  for (size_t position = text.find(key); position != std::string::npos;
+       position = text.find(key, position + value.size()))
+    {
+    text.replace(position, key.size(), value);
+    }
+  return text;
+}
+
+//----------------------------------------------------------------------------
+double seconds(const struct timeval& time)
+{
+  return time.tv_sec + time.tv_usec * 1e-6;
+}
+
+//----------------------------------------------------------------------------
+// Run the module in a child process limited to the given number of threads.
+// The library is already loaded by the parent.
+RunResult runCase(const BenchmarkCase& benchmarkCase, const std::vector<std::string>& arguments,
+                  int threads, bool verbose)
+{
+  RunResult result;
+  struct timeval start;
+  gettimeofday(&start, 0);
+  pid_t pid = fork();
+  if (pid < 0)
+    {
+    result.Status = -1;
+    return result;
+    }
+  if (pid == 0)
+    {
+    std::ostringstream threadCount;
+    threadCount << threads;
+    setenv("ITK_GLOBAL_DEFAULT_NUMBER_OF_THREADS", threadCount.str().c_str(), 1);
+    itk::MultiThreader::SetGlobalMaximumNumberOfThreads(threads);
+    itk::MultiThreader::SetGlobalDefaultNumberOfThreads(threads);
+    if (!verbose)
+      {
+      int devNull = open("/dev/null", O_WRONLY);
+      dup2(devNull, STDOUT_FILENO);
+      dup2(devNull, STDERR_FILENO);
+      }
+    std::vector<char*> argv;
+    argv.push_back(const_cast<char*>(benchmarkCase.Module.c_str()));
+    for (size_t i = 0; i < arguments.size(); ++i)
+      {
+      argv.push_back(const_cast<char*>(arguments[i].c_str()));
+      }
+    argv.push_back(0);
+    const int status = benchmarkCase.EntryPoint(static_cast<int>(argv.size()) - 1, &argv[0]);
+    std::cout.flush();
+    _exit(status == EXIT_SUCCESS ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+  int status = 0;
+  struct rusage usage;
+  wait4(pid, &status, 0, &usage);
+  struct timeval end;
+  gettimeofday(&end, 0);
+  result.WallTime = seconds(end) - seconds(start);
+  result.CPUTime = seconds(usage.ru_utime) + seconds(usage.ru_stime);
+#if defined(__APPLE__)
+  result.PeakRSS = usage.ru_maxrss / (1024. * 1024.);
+#else
+  result.PeakRSS = usage.ru_maxrss / 1024.;
+#endif
+  result.Status = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+  return result;
+}
+
+}
+
+//----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+  BenchmarkParameters parameters;
+  if (!parseArguments(argc, argv, parameters))
+    {
+    printUsage(argv[0]);
+    return EXIT_FAILURE;
+    }
+  if (parameters.Cases.empty())
+    {
+    for (size_t i = 0; i < sizeof(DefaultCases) / sizeof(DefaultCases[0]); ++i)
+      {
+      if (!parameters.Modules.empty() &&
+          std::find(parameters.Modules.begin(), parameters.Modules.end(),
+                    DefaultCases[i][0]) == parameters.Modules.end())
+        {
+        continue;
+        }
+      BenchmarkCase benchmarkCase;
+      benchmarkCase.Module = DefaultCases[i][0];
+      benchmarkCase.Arguments = DefaultCases[i][1];
+      benchmarkCase.EntryPoint = 0;
+      parameters.Cases.push_back(benchmarkCase);
+      }
+    }
+
+  // Load the libraries once, the children only run the entry points.
+  // Modules that are not built are skipped.
+  std::vector<BenchmarkCase> cases;
+  for (size_t i = 0; i < parameters.Cases.size(); ++i)
+    {
+    BenchmarkCase benchmarkCase = parameters.Cases[i];
+    const std::string library = parameters.ModuleDirectory + "/" +
+      itksys::DynamicLoader::LibPrefix() + benchmarkCase.Module + "Lib" +
+      itksys::DynamicLoader::LibExtension();
+    itksys::DynamicLoader::LibraryHandle handle =
+      itksys::DynamicLoader::OpenLibrary(library.c_str());
+    if (handle)
+      {
+      benchmarkCase.EntryPoint = reinterpret_cast<ModuleEntryPointType>(
+        itksys::DynamicLoader::GetSymbolAddress(handle, "ModuleEntryPoint"));
+      }
+    if (!benchmarkCase.EntryPoint)
+      {
+      std::cerr << "Skipping " << benchmarkCase.Module << ": no ModuleEntryPoint in "
+                << library << std::endl;
+      continue;
+      }
+    cases.push_back(benchmarkCase);
+    }
+  if (cases.empty())
+    {
+    std::cerr << "No module to run" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::string temporaryDirectory = parameters.TemporaryDirectory.empty() ?
+    itksys::SystemTools::GetCurrentWorkingDirectory() : parameters.TemporaryDirectory;
+  itksys::SystemTools::MakeDirectory(temporaryDirectory.c_str());
+
+  typedef itk::Image<short, 3>         ImageType;
+  typedef itk::Image<unsigned char, 3> LabelMapType;
+
+  bool failed = false;
+  std::ostringstream json;
+  json << "{\n"
+       << "  \"benchmark\": \"CLIModuleBenchmark\",\n"
+       << "  \"repeat\": " << parameters.Repeat << ",\n"
+       << "  \"runs\": [";
+  std::cout << std::left << std::setw(32) << "module" << std::right
+            << std::setw(6) << "size" << std::setw(8) << "threads"
+            << std::setw(10) << "wall (s)" << std::setw(10) << "cpu (s)"
+            << std::setw(10) << "rss (MB)" << std::setw(9) << "speedup"
+            << std::setw(11) << "efficiency" << std::endl;
+  bool firstRun = true;
+  for (size_t s = 0; s < parameters.Sizes.size(); ++s)
+    {
+    const int size = parameters.Sizes[s];
+    std::ostringstream prefix;
+    prefix << temporaryDirectory << "/CLIModuleBenchmark" << size;
+    const std::string input = prefix.str() + "Input.nrrd";
+    const std::string moving = prefix.str() + "Moving.nrrd";
+    const std::string label = prefix.str() + "Label.nrrd";
+    const std::string output = prefix.str() + "Output.nrrd";
+    if (!writeImage<ImageType>(input, size, 0., false) ||
+        !writeImage<ImageType>(moving, size, 0.05 * size, false) ||
+        !writeImage<LabelMapType>(label, size, 0., true))
+      {
+      return EXIT_FAILURE;
+      }
+
+    for (size_t c = 0; c < cases.size(); ++c)
+      {
+      double referenceTime = 0.;
+      for (size_t t = 0; t < parameters.Threads.size(); ++t)
+        {
+        const int threads = parameters.Threads[t];
+        std::ostringstream threadCount;
+        threadCount << threads;
+        std::vector<std::string> arguments = splitWords(cases[c].Arguments, ' ');
+        for (size_t i = 0; i < arguments.size(); ++i)
+          {
+          arguments[i] = replaceAll(arguments[i], "{input}", input);
+          arguments[i] = replaceAll(arguments[i], "{moving}", moving);
+          arguments[i] = replaceAll(arguments[i], "{label}", label);
+          arguments[i] = replaceAll(arguments[i], "{output}", output);
+          arguments[i] = replaceAll(arguments[i], "{threads}", threadCount.str());
+          }
+
+        RunResult best;
+        for (int r = 0; r < parameters.Repeat; ++r)
+          {
+          RunResult run = runCase(cases[c], arguments, threads, parameters.Verbose);
+          if (r == 0 || run.Status != 0 || run.WallTime < best.WallTime)
+            {
+            best = run;
+            }
+          if (run.Status != 0)
+            {
+            break;
+            }
+          }
+        if (best.Status != 0)
+          {
+          std::cerr << cases[c].Module << " failed on " << size << "^3 with "
+                    << threads << " threads" << std::endl;
+          failed = true;
+          }
+        if (t == 0)
+          {
+          // Speedups are relative to the first number of threads
+          referenceTime = best.WallTime;
+          }
+        const double speedup = best.WallTime > 0. ? referenceTime / best.WallTime : 0.;
+        const double efficiency = speedup * parameters.Threads[0] / threads;
+
+        std::cout << std::left << std::setw(32) << cases[c].Module << std::right
+                  << std::setw(6) << size << std::setw(8) << threads
+                  << std::fixed << std::setprecision(3)
+                  << std::setw(10) << best.WallTime << std::setw(10) << best.CPUTime
+                  << std::setprecision(1) << std::setw(10) << best.PeakRSS
+                  << std::setprecision(2) << std::setw(9) << speedup
+                  << std::setw(11) << efficiency
+                  << (best.Status != 0 ? "  FAILED" : "") << std::endl;
+
+        json << (firstRun ? "\n" : ",\n")
+             << "    {\"module\": \"" << cases[c].Module << "\""
+             << ", \"size\": " << size
+             << ", \"threads\": " << threads
+             << ", \"status\": " << best.Status
+             << ", \"wallSeconds\": " << best.WallTime
+             << ", \"cpuSeconds\": " << best.CPUTime
+             << ", \"peakRSSMB\": " << best.PeakRSS
+             << ", \"speedup\": " << speedup
+             << ", \"efficiency\": " << efficiency << "}";
+        firstRun = false;
+        }
+      }
+    itksys::SystemTools::RemoveFile(input.c_str());
+    itksys::SystemTools::RemoveFile(moving.c_str());
+    itksys::SystemTools::RemoveFile(label.c_str());
+    }
+  json << "\n  ]\n}\n";
+
+  if (!parameters.Output.empty())
+    {
+    std::ofstream outputFile(parameters.Output.c_str());
+    if (!outputFile)
+      {
+      std::cerr << "Can't write " << parameters.Output << std::endl;
+      return EXIT_FAILURE;
+      }
+    outputFile << json.str();
+    }
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
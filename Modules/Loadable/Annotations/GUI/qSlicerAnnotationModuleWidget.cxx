@@ -21,6 +21,7 @@
 #include <QGraphicsRectItem>
 #include <QBuffer>
 #include <QImageWriter>
+#include <QTimer>
 
 #include "qSlicerMouseModeToolBar.h"
 #include "qMRMLSceneDisplayableModel.h"
@@ -59,6 +60,9 @@ public:
   vtkSlicerAnnotationModuleLogic* logic() const;
 
   qSlicerAnnotationModuleSnapShotDialog* m_SnapShotDialog;
+
+  // Coalesce the refresh requests of the logic
+  QTimer* RefreshTreeTimer;
 };
 
 //-----------------------------------------------------------------------------
@@ -74,6 +78,7 @@ qSlicerAnnotationModuleWidgetPrivate::qSlicerAnnotationModuleWidgetPrivate(qSlic
   : q_ptr(&object)
 {
   this->m_SnapShotDialog = 0;
+  this->RefreshTreeTimer = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -150,8 +155,14 @@ void qSlicerAnnotationModuleWidgetPrivate::setupUi(qSlicerWidget* widget)
   // listen for updates to the logic to update the active hierarchy label
   q->qvtkConnect(this->logic(), vtkCommand::ModifiedEvent,
                  q, SLOT(updateActiveHierarchyLabel()));
+  // the logic requests a refresh for each modification of an annotation,
+  // only refresh once for all the requests of an interaction
+  this->RefreshTreeTimer = new QTimer(q);
+  this->RefreshTreeTimer->setSingleShot(true);
+  this->RefreshTreeTimer->setInterval(50);
+  q->connect(this->RefreshTreeTimer, SIGNAL(timeout()), q, SLOT(refreshTree()));
   q->qvtkConnect(this->logic(), vtkSlicerAnnotationModuleLogic::RefreshRequestEvent,
-                 q, SLOT(refreshTree()));
+                 q, SLOT(requestRefreshTree()));
   // listen to the logic for when it adds a new hierarchy node that has to be
   // expanded
   q->qvtkConnect(this->logic(), vtkSlicerAnnotationModuleLogic::HierarchyNodeAddedEvent,
@@ -501,6 +512,16 @@ void qSlicerAnnotationModuleWidget::refreshTree()
   d->hierarchyTreeView->hideScene();
 }
 
+//-----------------------------------------------------------------------------
+void qSlicerAnnotationModuleWidget::requestRefreshTree()
+{
+  Q_D(qSlicerAnnotationModuleWidget);
+  if (!d->RefreshTreeTimer->isActive())
+    {
+    d->RefreshTreeTimer->start();
+    }
+}
+
 //-----------------------------------------------------------------------------
 void qSlicerAnnotationModuleWidget::onHierarchyNodeAddedEvent(vtkObject *vtkNotUsed(caller), vtkObject *callData)
 {
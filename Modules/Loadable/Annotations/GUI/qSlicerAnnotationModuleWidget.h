@@ -53,6 +53,9 @@ protected:
 public slots:
     /// a public slot that will refresh the tree view 
     void refreshTree();
+    /// refresh the tree view a little later, once for all the requests
+    /// made in the meantime
+    void requestRefreshTree();
     /// a public slot that will expand a newly added hierarchy node item
     void onHierarchyNodeAddedEvent(vtkObject *caller, vtkObject *obj);
 
@@ -425,7 +425,14 @@ void vtkSlicerAnnotationModuleLogic::OnMRMLAnnotationNodeModifiedEvent(vtkMRMLNo
     return;
     }
 
-  this->InvokeEvent(RefreshRequestEvent);
+  // the widgets are refreshed once at the end of the batch
+  if (this->GetMRMLScene() &&
+      this->GetMRMLScene()->IsBatchProcessing())
+    {
+    return;
+    }
+
+  this->InvokeEvent(RefreshRequestEvent, annotationNode);
 }
 
 //-----------------------------------------------------------------------------
@@ -596,7 +603,7 @@ void vtkSlicerAnnotationModuleLogic::AddNodeCompleted(vtkMRMLAnnotationNode* ann
     return;
     }
 
-  this->InvokeEvent(RefreshRequestEvent);
+  this->InvokeEvent(RefreshRequestEvent, annotationNode);
 
   this->m_LastAddedAnnotationNode = annotationNode;
 
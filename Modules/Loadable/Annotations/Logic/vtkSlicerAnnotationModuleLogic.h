@@ -20,6 +20,10 @@ class VTK_SLICER_ANNOTATIONS_MODULE_LOGIC_EXPORT vtkSlicerAnnotationModuleLogic
   :public vtkSlicerModuleLogic
 {
 public:
+  /// RefreshRequestEvent is invoked each time an annotation node is added or
+  /// modified, with the node as call data. Observers that refresh widgets
+  /// should defer and coalesce the refreshes, an annotation being modified
+  /// for each mouse move while it is dragged.
   enum Events{
     RefreshRequestEvent = vtkCommand::UserEvent,
     HierarchyNodeAddedEvent
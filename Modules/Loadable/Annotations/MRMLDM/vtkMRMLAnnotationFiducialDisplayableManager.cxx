@@ -21,18 +21,29 @@
 
 // MRML includes
 #include <vtkMRMLInteractionNode.h>
+#include <vtkMRMLScene.h>
 #include <vtkMRMLSliceNode.h>
 
 // VTK includes
 #include <vtkAbstractWidget.h>
+#include <vtkActor.h>
+#include <vtkActor2D.h>
+#include <vtkCamera.h>
 #include <vtkFollower.h>
+#include <vtkGlyph3D.h>
 #include <vtkHandleRepresentation.h>
+#include <vtkInteractorObserver.h>
 #include <vtkInteractorStyle.h>
+#include <vtkLabeledDataMapper.h>
 #include <vtkMath.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkOrientedPolygonalHandleRepresentation3D.h>
+#include <vtkPointData.h>
 #include <vtkPointHandleRepresentation2D.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataMapper.h>
 #include <vtkProperty2D.h>
 #include <vtkProperty.h>
 #include <vtkRenderer.h>
@@ -41,9 +52,16 @@
 #include <vtkSmartPointer.h>
 #include <vtkSeedRepresentation.h>
 #include <vtkSphereSource.h>
+#include <vtkStringArray.h>
+#include <vtkTextProperty.h>
 
 // STD includes
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <set>
 #include <string>
+#include <vector>
 
 //---------------------------------------------------------------------------
 vtkStandardNewMacro (vtkMRMLAnnotationFiducialDisplayableManager);
@@ -172,13 +190,108 @@ public:
   bool IsMoving;
 };
 
+//---------------------------------------------------------------------------
+// Distance in pixels under which the mouse is over a bulk fiducial
+static const double BulkPickTolerance = 10.;
+
+//---------------------------------------------------------------------------
+class vtkMRMLAnnotationFiducialDisplayableManager::vtkInternal
+{
+public:
+  vtkInternal();
+
+  /// Glyphs and labels of the bulk fiducials that look the same:
+  /// Points feeds the glyphs, Labels has the same points and the names
+  struct Group
+    {
+    vtkSmartPointer<vtkPolyData> Points;
+    vtkSmartPointer<vtkPolyData> Labels;
+    vtkSmartPointer<vtkActor> Actor;
+    vtkSmartPointer<vtkActor2D> LabelActor;
+    };
+  /// Groups indexed by the glyph, material and text properties
+  typedef std::map<std::vector<double>, Group> GroupMapType;
+
+  /// Fiducials drawn by the groups instead of a widget
+  std::set<vtkMRMLAnnotationFiducialNode*> BulkNodes;
+  GroupMapType Groups;
+  bool BulkModified;
+
+  /// Fiducial given a widget because the mouse is over it
+  vtkMRMLAnnotationFiducialNode* HoveredNode;
+
+  /// Display positions of the bulk fiducials binned in square cells of
+  /// BulkPickTolerance pixels, rebuilt when the camera or the fiducials change
+  std::vector<vtkMRMLAnnotationFiducialNode*> PickNodes;
+  std::vector<double> PickPositions;
+  std::vector<int> PickCellOffsets;
+  std::vector<int> PickCellNodes;
+  int PickGridSize[2];
+  int PickViewSize[2];
+  unsigned long PickCameraTime;
+  bool PickModified;
+};
+
+//---------------------------------------------------------------------------
+vtkMRMLAnnotationFiducialDisplayableManager::vtkInternal::vtkInternal()
+{
+  this->BulkModified = false;
+  this->HoveredNode = 0;
+  this->PickGridSize[0] = this->PickGridSize[1] = 0;
+  this->PickViewSize[0] = this->PickViewSize[1] = 0;
+  this->PickCameraTime = 0;
+  this->PickModified = true;
+}
+
+//---------------------------------------------------------------------------
+// Glyph of the bulk display, the same as the one of the 3D handles
+static vtkSmartPointer<vtkPolyData> vtkBulkFiducialGlyph(int glyphType)
+{
+  vtkSmartPointer<vtkPolyData> glyph = vtkSmartPointer<vtkPolyData>::New();
+  if (glyphType == vtkMRMLAnnotationPointDisplayNode::Sphere3D)
+    {
+    vtkNew<vtkSphereSource> sphereSource;
+    sphereSource->SetRadius(0.5);
+    sphereSource->SetPhiResolution(10);
+    sphereSource->SetThetaResolution(10);
+    sphereSource->Update();
+    glyph->ShallowCopy(sphereSource->GetOutput());
+    return glyph;
+    }
+  vtkNew<vtkAnnotationGlyphSource2D> glyphSource;
+  // the 3d diamond isn't supported yet, use a 2d diamond like the handles
+  glyphSource->SetGlyphType(glyphType == vtkMRMLAnnotationPointDisplayNode::Diamond3D ?
+                            vtkMRMLAnnotationPointDisplayNode::Diamond2D : glyphType);
+  glyphSource->SetScale(1.0);
+  glyphSource->Update();
+  glyph->ShallowCopy(glyphSource->GetOutput());
+  return glyph;
+}
+
 //---------------------------------------------------------------------------
 // vtkMRMLAnnotationFiducialDisplayableManager methods
 
+//---------------------------------------------------------------------------
+vtkMRMLAnnotationFiducialDisplayableManager::vtkMRMLAnnotationFiducialDisplayableManager()
+{
+  this->m_Focus = "vtkMRMLAnnotationFiducialNode";
+  this->BulkDisplayThreshold = 100;
+  this->Internal = new vtkInternal;
+}
+
+//---------------------------------------------------------------------------
+vtkMRMLAnnotationFiducialDisplayableManager::~vtkMRMLAnnotationFiducialDisplayableManager()
+{
+  delete this->Internal;
+}
+
 //---------------------------------------------------------------------------
 void vtkMRMLAnnotationFiducialDisplayableManager::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+
+  os << indent << "BulkDisplayThreshold = " << this->BulkDisplayThreshold << std::endl;
+  os << indent << "Number of bulk fiducials = " << this->Internal->BulkNodes.size() << std::endl;
 }
 
 //---------------------------------------------------------------------------
@@ -844,6 +957,8 @@ void vtkMRMLAnnotationFiducialDisplayableManager::AdditionnalInitializeStep()
   // don't add the key press event, as it triggers a crash on start up
   //vtkDebugMacro("Adding an observer on the key press event");
   this->AddInteractorStyleObservableEvent(vtkCommand::KeyPressEvent);
+  // give a widget to the bulk fiducial under the mouse
+  this->AddInteractorStyleObservableEvent(vtkCommand::MouseMoveEvent);
 }
 
 
@@ -885,6 +1000,10 @@ void vtkMRMLAnnotationFiducialDisplayableManager::OnInteractorStyleEvent(int eve
     {
     vtkDebugMacro("Got a key release event");
     }
+  else if (eventid == vtkCommand::MouseMoveEvent)
+    {
+    this->UpdateHoveredFiducial();
+    }
 }
 
 
@@ -998,4 +1117,530 @@ void vtkMRMLAnnotationFiducialDisplayableManager::OnMRMLSceneEndClose()
 {
   // clear out the map of glyph types
   this->NodeGlyphTypes.clear();
+
+  // and the bulk display
+  this->Internal->BulkNodes.clear();
+  this->Internal->HoveredNode = 0;
+  this->UpdateBulkGlyphs();
+}
+
+//---------------------------------------------------------------------------
+bool vtkMRMLAnnotationFiducialDisplayableManager::IsBulkDisplay()
+{
+  int numberOfFiducials = static_cast<int>(
+    this->Helper->AnnotationNodeList.size() + this->Internal->BulkNodes.size());
+  return this->BulkDisplayThreshold > 0 &&
+    numberOfFiducials >= this->BulkDisplayThreshold &&
+    !this->Is2DDisplayableManager();
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLAnnotationFiducialDisplayableManager::UpdateFromMRML()
+{
+  if (this->GetMRMLScene() == NULL || this->Is2DDisplayableManager())
+    {
+    this->Superclass::UpdateFromMRML();
+    return;
+    }
+  // same as the superclass but the fiducials that don't need a widget
+  // go to the bulk display, so that loading a large list doesn't create
+  // a widget per fiducial
+  this->SetUpdateFromMRMLRequested(0);
+  bool bulk = this->BulkDisplayThreshold > 0 &&
+    this->GetMRMLScene()->GetNumberOfNodesByClass(this->m_Focus) >= this->BulkDisplayThreshold;
+  this->GetMRMLScene()->InitTraversal();
+  vtkMRMLNode *node = this->GetMRMLScene()->GetNextNodeByClass(this->m_Focus);
+  while (node != NULL)
+    {
+    vtkMRMLAnnotationFiducialNode *fiducialNode = vtkMRMLAnnotationFiducialNode::SafeDownCast(node);
+    if (fiducialNode &&
+        this->GetWidget(fiducialNode) == NULL &&
+        this->Internal->BulkNodes.count(fiducialNode) == 0)
+      {
+      if (bulk && !fiducialNode->GetSelected())
+        {
+        this->Internal->BulkNodes.insert(fiducialNode);
+        this->SetAndObserveNode(fiducialNode);
+        this->Internal->BulkModified = true;
+        }
+      else if (this->AddAnnotation(fiducialNode))
+        {
+        this->PropagateMRMLToWidget(fiducialNode, this->GetWidget(fiducialNode));
+        }
+      }
+    node = this->GetMRMLScene()->GetNextNodeByClass(this->m_Focus);
+    }
+  this->UpdateBulkDisplayMode();
+  if (this->Internal->BulkModified)
+    {
+    this->RequestRender();
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLAnnotationFiducialDisplayableManager::OnMRMLSceneNodeAdded(vtkMRMLNode* node)
+{
+  vtkMRMLAnnotationFiducialNode *fiducialNode = vtkMRMLAnnotationFiducialNode::SafeDownCast(node);
+  if (!fiducialNode || !this->GetMRMLScene() ||
+      this->GetMRMLScene()->IsBatchProcessing() ||
+      !this->IsManageable(fiducialNode) ||
+      fiducialNode->GetSelected())
+    {
+    this->Superclass::OnMRMLSceneNodeAdded(node);
+    this->UpdateBulkDisplayMode();
+    return;
+    }
+
+  // the new fiducial counts for the bulk display
+  this->Internal->BulkNodes.insert(fiducialNode);
+  if (!this->IsBulkDisplay())
+    {
+    this->Internal->BulkNodes.erase(fiducialNode);
+    this->Superclass::OnMRMLSceneNodeAdded(node);
+    return;
+    }
+  this->SetAndObserveNode(fiducialNode);
+  this->Internal->BulkModified = true;
+  this->Helper->RemoveSeeds();
+  this->UpdateBulkDisplayMode();
+  this->RequestRender();
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLAnnotationFiducialDisplayableManager::OnMRMLSceneNodeRemoved(vtkMRMLNode* node)
+{
+  vtkMRMLAnnotationFiducialNode *fiducialNode = vtkMRMLAnnotationFiducialNode::SafeDownCast(node);
+  if (fiducialNode && fiducialNode == this->Internal->HoveredNode)
+    {
+    this->Internal->HoveredNode = 0;
+    }
+  if (fiducialNode && this->Internal->BulkNodes.erase(fiducialNode))
+    {
+    vtkUnObserveMRMLNodeMacro(fiducialNode);
+    this->Internal->BulkModified = true;
+    }
+  else
+    {
+    this->Superclass::OnMRMLSceneNodeRemoved(node);
+    }
+  this->UpdateBulkDisplayMode();
+  this->RequestRender();
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLAnnotationFiducialDisplayableManager::RemoveMRMLObservers()
+{
+  std::set<vtkMRMLAnnotationFiducialNode*>::iterator it;
+  for (it = this->Internal->BulkNodes.begin(); it != this->Internal->BulkNodes.end(); ++it)
+    {
+    vtkUnObserveMRMLNodeMacro(*it);
+    }
+  this->Superclass::RemoveMRMLObservers();
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLAnnotationFiducialDisplayableManager::RequestRender()
+{
+  if (!this->GetMRMLScene() || this->GetMRMLScene()->IsBatchProcessing())
+    {
+    return;
+    }
+  // the bulk fiducials changed since the last render, update them once
+  if (this->Internal->BulkModified)
+    {
+    this->UpdateBulkGlyphs();
+    }
+  this->Superclass::RequestRender();
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLAnnotationFiducialDisplayableManager::OnMRMLAnnotationNodeModifiedEvent(vtkMRMLNode* node)
+{
+  if (this->m_Updating)
+    {
+    return;
+    }
+  vtkMRMLAnnotationFiducialNode *fiducialNode = vtkMRMLAnnotationFiducialNode::SafeDownCast(node);
+  if (fiducialNode && this->Internal->BulkNodes.count(fiducialNode))
+    {
+    if (fiducialNode->GetSelected())
+      {
+      // selected fiducials are interactive
+      this->AddFiducialWidget(fiducialNode);
+      }
+    this->Internal->BulkModified = true;
+    this->RequestRender();
+    return;
+    }
+  this->Superclass::OnMRMLAnnotationNodeModifiedEvent(node);
+  if (fiducialNode && !fiducialNode->GetSelected() &&
+      fiducialNode != this->Internal->HoveredNode && this->IsBulkDisplay())
+    {
+    // unselected, back to the bulk display
+    this->RemoveFiducialWidget(fiducialNode);
+    this->RequestRender();
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLAnnotationFiducialDisplayableManager::OnMRMLAnnotationNodeTransformModifiedEvent(vtkMRMLNode* node)
+{
+  vtkMRMLAnnotationFiducialNode *fiducialNode = vtkMRMLAnnotationFiducialNode::SafeDownCast(node);
+  if (fiducialNode && this->Internal->BulkNodes.count(fiducialNode))
+    {
+    this->Internal->BulkModified = true;
+    this->RequestRender();
+    return;
+    }
+  this->Superclass::OnMRMLAnnotationNodeTransformModifiedEvent(node);
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLAnnotationFiducialDisplayableManager::OnMRMLAnnotationDisplayNodeModifiedEvent(vtkMRMLNode* node)
+{
+  if (!this->m_Updating && !this->Internal->BulkNodes.empty())
+    {
+    // the display node may be the one of a bulk fiducial, that is not
+    // known by the helper
+    this->Internal->BulkModified = true;
+    this->RequestRender();
+    }
+  this->Superclass::OnMRMLAnnotationDisplayNodeModifiedEvent(node);
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLAnnotationFiducialDisplayableManager::OnMRMLAnnotationControlPointModifiedEvent(vtkMRMLNode* node)
+{
+  vtkMRMLAnnotationFiducialNode *fiducialNode = vtkMRMLAnnotationFiducialNode::SafeDownCast(node);
+  if (fiducialNode && this->Internal->BulkNodes.count(fiducialNode))
+    {
+    this->Internal->BulkModified = true;
+    this->RequestRender();
+    return;
+    }
+  this->Superclass::OnMRMLAnnotationControlPointModifiedEvent(node);
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLAnnotationFiducialDisplayableManager::UpdateBulkDisplayMode()
+{
+  if (this->IsBulkDisplay())
+    {
+    // take the widgets back from the fiducials that don't need one
+    std::vector<vtkMRMLAnnotationFiducialNode*> fiducialNodes;
+    vtkMRMLAnnotationDisplayableManagerHelper::AnnotationNodeListIt it;
+    for (it = this->Helper->AnnotationNodeList.begin();
+         it != this->Helper->AnnotationNodeList.end(); ++it)
+      {
+      vtkMRMLAnnotationFiducialNode *fiducialNode = vtkMRMLAnnotationFiducialNode::SafeDownCast(*it);
+      if (fiducialNode && !fiducialNode->GetSelected() &&
+          fiducialNode != this->Internal->HoveredNode)
+        {
+        fiducialNodes.push_back(fiducialNode);
+        }
+      }
+    for (size_t i = 0; i < fiducialNodes.size(); ++i)
+      {
+      this->RemoveFiducialWidget(fiducialNodes[i]);
+      }
+    }
+  else if (!this->Internal->BulkNodes.empty())
+    {
+    // few enough fiducials for a widget each
+    std::vector<vtkMRMLAnnotationFiducialNode*> fiducialNodes(
+      this->Internal->BulkNodes.begin(), this->Internal->BulkNodes.end());
+    for (size_t i = 0; i < fiducialNodes.size(); ++i)
+      {
+      this->AddFiducialWidget(fiducialNodes[i]);
+      }
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLAnnotationFiducialDisplayableManager::AddFiducialWidget(vtkMRMLAnnotationFiducialNode* node)
+{
+  if (this->Internal->BulkNodes.erase(node))
+    {
+    this->Internal->BulkModified = true;
+    }
+  if (this->GetWidget(node) == NULL && this->AddAnnotation(node))
+    {
+    this->PropagateMRMLToWidget(node, this->GetWidget(node));
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLAnnotationFiducialDisplayableManager::RemoveFiducialWidget(vtkMRMLAnnotationFiducialNode* node)
+{
+  vtkSeedWidget* seedWidget = vtkSeedWidget::SafeDownCast(this->GetWidget(node));
+  if (!seedWidget || seedWidget->GetWidgetState() == vtkSeedWidget::MovingSeed)
+    {
+    return;
+    }
+  // the node stays observed
+  this->Helper->RemoveWidgetAndNode(node);
+  this->Internal->BulkNodes.insert(node);
+  this->Internal->BulkModified = true;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLAnnotationFiducialDisplayableManager::UpdateHoveredFiducial()
+{
+  vtkMRMLInteractionNode *interactionNode = this->GetInteractionNode();
+  if (!this->IsBulkDisplay() || !this->GetInteractor() ||
+      (interactionNode &&
+       interactionNode->GetCurrentInteractionMode() == vtkMRMLInteractionNode::Place))
+    {
+    return;
+    }
+  int* eventPosition = this->GetInteractor()->GetEventPosition();
+  double x = eventPosition[0];
+  double y = eventPosition[1];
+
+  vtkMRMLAnnotationFiducialNode* hoveredNode = this->Internal->HoveredNode;
+  if (hoveredNode)
+    {
+    vtkSeedWidget* seedWidget = vtkSeedWidget::SafeDownCast(this->GetWidget(hoveredNode));
+    if (seedWidget && seedWidget->GetWidgetState() == vtkSeedWidget::MovingSeed)
+      {
+      return;
+      }
+    // still over the widget
+    double worldCoordinates[4] = {0.0, 0.0, 0.0, 1.0};
+    double displayCoordinates[4] = {0.0, 0.0, 0.0, 1.0};
+    hoveredNode->GetControlPointWorldCoordinates(0, worldCoordinates);
+    this->GetWorldToDisplayCoordinates(worldCoordinates, displayCoordinates);
+    double dx = displayCoordinates[0] - x;
+    double dy = displayCoordinates[1] - y;
+    if (dx * dx + dy * dy <= BulkPickTolerance * BulkPickTolerance)
+      {
+      return;
+      }
+    }
+
+  vtkMRMLAnnotationFiducialNode* pickedNode = this->PickBulkFiducial(x, y);
+  if (pickedNode == hoveredNode)
+    {
+    return;
+    }
+  this->Internal->HoveredNode = pickedNode;
+  if (hoveredNode && !hoveredNode->GetSelected())
+    {
+    this->RemoveFiducialWidget(hoveredNode);
+    }
+  if (pickedNode)
+    {
+    this->AddFiducialWidget(pickedNode);
+    }
+  this->RequestRender();
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLAnnotationFiducialDisplayableManager::UpdateBulkGlyphs()
+{
+  vtkInternal* internal = this->Internal;
+  vtkRenderer* renderer = this->GetRenderer();
+  vtkInternal::GroupMapType::iterator groupIt;
+  if (renderer)
+    {
+    for (groupIt = internal->Groups.begin(); groupIt != internal->Groups.end(); ++groupIt)
+      {
+      renderer->RemoveActor(groupIt->second.Actor);
+      renderer->RemoveActor2D(groupIt->second.LabelActor);
+      }
+    }
+  internal->Groups.clear();
+  internal->BulkModified = false;
+  internal->PickModified = true;
+
+  std::set<vtkMRMLAnnotationFiducialNode*>::iterator it;
+  for (it = internal->BulkNodes.begin(); it != internal->BulkNodes.end(); ++it)
+    {
+    vtkMRMLAnnotationFiducialNode* fiducialNode = *it;
+    if (!fiducialNode->GetDisplayVisibility())
+      {
+      continue;
+      }
+    vtkMRMLAnnotationPointDisplayNode *displayNode = fiducialNode->GetAnnotationPointDisplayNode();
+    vtkMRMLAnnotationTextDisplayNode *textDisplayNode = fiducialNode->GetAnnotationTextDisplayNode();
+
+    // the fiducials that look the same share a group
+    std::vector<double> style;
+    style.push_back(displayNode ? displayNode->GetGlyphType() : vtkMRMLAnnotationPointDisplayNode::Sphere3D);
+    style.push_back(displayNode ? displayNode->GetGlyphScale() : 1.);
+    double color[3] = {1., 1., 1.};
+    if (displayNode)
+      {
+      displayNode->GetColor(color);
+      }
+    style.insert(style.end(), color, color + 3);
+    style.push_back(displayNode ? displayNode->GetOpacity() : 1.);
+    style.push_back(displayNode ? displayNode->GetAmbient() : 0.);
+    style.push_back(displayNode ? displayNode->GetDiffuse() : 1.);
+    style.push_back(displayNode ? displayNode->GetSpecular() : 0.);
+    double textColor[3] = {1., 1., 1.};
+    if (textDisplayNode)
+      {
+      textDisplayNode->GetColor(textColor);
+      }
+    style.insert(style.end(), textColor, textColor + 3);
+    style.push_back(textDisplayNode ? textDisplayNode->GetOpacity() : 1.);
+
+    vtkInternal::Group& group = internal->Groups[style];
+    if (!group.Actor)
+      {
+      vtkNew<vtkPoints> points;
+      group.Points = vtkSmartPointer<vtkPolyData>::New();
+      group.Points->SetPoints(points.GetPointer());
+      vtkNew<vtkStringArray> names;
+      names->SetName("Names");
+      group.Labels = vtkSmartPointer<vtkPolyData>::New();
+      group.Labels->SetPoints(points.GetPointer());
+      group.Labels->GetPointData()->AddArray(names.GetPointer());
+
+      vtkNew<vtkGlyph3D> glyph;
+      glyph->SetInput(group.Points);
+      glyph->SetSource(vtkBulkFiducialGlyph(static_cast<int>(style[0])));
+      glyph->SetScaleModeToDataScalingOff();
+      glyph->SetScaleFactor(style[1]);
+      glyph->OrientOff();
+      vtkNew<vtkPolyDataMapper> mapper;
+      mapper->SetInputConnection(glyph->GetOutputPort());
+      mapper->ScalarVisibilityOff();
+      group.Actor = vtkSmartPointer<vtkActor>::New();
+      group.Actor->SetMapper(mapper.GetPointer());
+      vtkProperty* property = group.Actor->GetProperty();
+      property->SetColor(color);
+      property->SetOpacity(style[5]);
+      property->SetAmbient(style[6]);
+      property->SetDiffuse(style[7]);
+      property->SetSpecular(style[8]);
+
+      vtkNew<vtkLabeledDataMapper> labelMapper;
+      labelMapper->SetInput(group.Labels);
+      labelMapper->SetLabelModeToLabelFieldData();
+      labelMapper->SetFieldDataName("Names");
+      labelMapper->GetLabelTextProperty()->SetColor(textColor);
+      labelMapper->GetLabelTextProperty()->SetOpacity(style[12]);
+      group.LabelActor = vtkSmartPointer<vtkActor2D>::New();
+      group.LabelActor->SetMapper(labelMapper.GetPointer());
+      }
+    double worldCoordinates[4] = {0.0, 0.0, 0.0, 1.0};
+    fiducialNode->GetControlPointWorldCoordinates(0, worldCoordinates);
+    group.Points->GetPoints()->InsertNextPoint(worldCoordinates);
+    vtkStringArray::SafeDownCast(group.Labels->GetPointData()->GetAbstractArray("Names"))
+      ->InsertNextValue(fiducialNode->GetName() ? fiducialNode->GetName() : "");
+    }
+
+  if (renderer)
+    {
+    for (groupIt = internal->Groups.begin(); groupIt != internal->Groups.end(); ++groupIt)
+      {
+      renderer->AddActor(groupIt->second.Actor);
+      renderer->AddActor2D(groupIt->second.LabelActor);
+      }
+    }
+}
+
+//---------------------------------------------------------------------------
+vtkMRMLAnnotationFiducialNode* vtkMRMLAnnotationFiducialDisplayableManager::PickBulkFiducial(double x, double y)
+{
+  vtkInternal* internal = this->Internal;
+  vtkRenderer* renderer = this->GetRenderer();
+  if (!renderer || !renderer->GetActiveCamera())
+    {
+    return 0;
+    }
+  if (internal->BulkModified)
+    {
+    this->UpdateBulkGlyphs();
+    }
+  int* viewSize = renderer->GetSize();
+  int* viewOrigin = renderer->GetOrigin();
+  if (internal->PickModified ||
+      internal->PickCameraTime != renderer->GetActiveCamera()->GetMTime() ||
+      internal->PickViewSize[0] != viewSize[0] ||
+      internal->PickViewSize[1] != viewSize[1])
+    {
+    // bin the display positions of the visible fiducials
+    internal->PickModified = false;
+    internal->PickCameraTime = renderer->GetActiveCamera()->GetMTime();
+    internal->PickViewSize[0] = viewSize[0];
+    internal->PickViewSize[1] = viewSize[1];
+    internal->PickGridSize[0] = static_cast<int>(viewSize[0] / BulkPickTolerance) + 1;
+    internal->PickGridSize[1] = static_cast<int>(viewSize[1] / BulkPickTolerance) + 1;
+    internal->PickNodes.clear();
+    internal->PickPositions.clear();
+    std::vector<int> cells;
+    std::set<vtkMRMLAnnotationFiducialNode*>::iterator it;
+    for (it = internal->BulkNodes.begin(); it != internal->BulkNodes.end(); ++it)
+      {
+      if (!(*it)->GetDisplayVisibility())
+        {
+        continue;
+        }
+      double worldCoordinates[4] = {0.0, 0.0, 0.0, 1.0};
+      double displayCoordinates[4] = {0.0, 0.0, 0.0, 1.0};
+      (*it)->GetControlPointWorldCoordinates(0, worldCoordinates);
+      this->GetWorldToDisplayCoordinates(worldCoordinates, displayCoordinates);
+      double viewX = displayCoordinates[0] - viewOrigin[0];
+      double viewY = displayCoordinates[1] - viewOrigin[1];
+      if (viewX < 0. || viewY < 0. || viewX >= viewSize[0] || viewY >= viewSize[1] ||
+          displayCoordinates[2] < 0. || displayCoordinates[2] > 1.)
+        {
+        // out of the view
+        continue;
+        }
+      internal->PickNodes.push_back(*it);
+      internal->PickPositions.insert(internal->PickPositions.end(),
+                                     displayCoordinates, displayCoordinates + 3);
+      cells.push_back(static_cast<int>(viewY / BulkPickTolerance) * internal->PickGridSize[0] +
+                      static_cast<int>(viewX / BulkPickTolerance));
+      }
+    int numberOfCells = internal->PickGridSize[0] * internal->PickGridSize[1];
+    internal->PickCellOffsets.assign(numberOfCells + 1, 0);
+    for (size_t i = 0; i < cells.size(); ++i)
+      {
+      ++internal->PickCellOffsets[cells[i] + 1];
+      }
+    for (int cell = 0; cell < numberOfCells; ++cell)
+      {
+      internal->PickCellOffsets[cell + 1] += internal->PickCellOffsets[cell];
+      }
+    internal->PickCellNodes.resize(cells.size());
+    std::vector<int> cellEnds(internal->PickCellOffsets.begin(), internal->PickCellOffsets.end() - 1);
+    for (size_t i = 0; i < cells.size(); ++i)
+      {
+      internal->PickCellNodes[cellEnds[cells[i]]++] = static_cast<int>(i);
+      }
+    }
+
+  // closest fiducial in the cells around the position, the front one on ties
+  vtkMRMLAnnotationFiducialNode* pickedNode = 0;
+  double pickedDistance = BulkPickTolerance * BulkPickTolerance;
+  double pickedDepth = VTK_DOUBLE_MAX;
+  int cellX = static_cast<int>(floor((x - viewOrigin[0]) / BulkPickTolerance));
+  int cellY = static_cast<int>(floor((y - viewOrigin[1]) / BulkPickTolerance));
+  for (int j = std::max(0, cellY - 1); j <= std::min(internal->PickGridSize[1] - 1, cellY + 1); ++j)
+    {
+    for (int i = std::max(0, cellX - 1); i <= std::min(internal->PickGridSize[0] - 1, cellX + 1); ++i)
+      {
+      int cell = j * internal->PickGridSize[0] + i;
+      for (int k = internal->PickCellOffsets[cell]; k < internal->PickCellOffsets[cell + 1]; ++k)
+        {
+        int index = internal->PickCellNodes[k];
+        const double* position = &internal->PickPositions[3 * index];
+        double distance = (position[0] - x) * (position[0] - x) +
+          (position[1] - y) * (position[1] - y);
+        if (distance < pickedDistance ||
+            (distance == pickedDistance && position[2] < pickedDepth))
+          {
+          pickedNode = internal->PickNodes[index];
+          pickedDistance = distance;
+          pickedDepth = position[2];
+          }
+        }
+      }
+    }
+  return pickedNode;
 }
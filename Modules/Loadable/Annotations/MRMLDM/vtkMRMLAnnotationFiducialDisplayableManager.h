@@ -38,10 +38,21 @@ public:
   vtkTypeRevisionMacro(vtkMRMLAnnotationFiducialDisplayableManager, vtkMRMLAnnotationDisplayableManager);
   void PrintSelf(ostream& os, vtkIndent indent);
 
+  /// From this number of fiducials in the scene, the 3D views draw the
+  /// fiducials with one glyph actor per display style instead of one seed
+  /// widget per fiducial. Only the selected fiducials and the fiducial
+  /// under the mouse get a widget, so that they can still be moved.
+  /// 0 disables the bulk display. 100 by default.
+  vtkSetClampMacro(BulkDisplayThreshold, int, 0, VTK_INT_MAX);
+  vtkGetMacro(BulkDisplayThreshold, int);
+
+  /// Return true if the fiducials are drawn in bulk in this view
+  bool IsBulkDisplay();
+
 protected:
 
-  vtkMRMLAnnotationFiducialDisplayableManager(){this->m_Focus="vtkMRMLAnnotationFiducialNode";}
-  virtual ~vtkMRMLAnnotationFiducialDisplayableManager(){}
+  vtkMRMLAnnotationFiducialDisplayableManager();
+  virtual ~vtkMRMLAnnotationFiducialDisplayableManager();
 
   /// Callback for click in RenderWindow
   virtual void OnClickInRenderWindow(double x, double y, const char *associatedNodeID);
@@ -69,6 +80,36 @@ protected:
   // clean up when scene closes
   virtual void OnMRMLSceneEndClose();
 
+  /// Keep the fiducials of the bulk display out of the widgets
+  virtual void UpdateFromMRML();
+  virtual void OnMRMLSceneNodeAdded(vtkMRMLNode* node);
+  virtual void OnMRMLSceneNodeRemoved(vtkMRMLNode* node);
+  virtual void RemoveMRMLObservers();
+  virtual void RequestRender();
+  virtual void OnMRMLAnnotationNodeModifiedEvent(vtkMRMLNode* node);
+  virtual void OnMRMLAnnotationNodeTransformModifiedEvent(vtkMRMLNode* node);
+  virtual void OnMRMLAnnotationDisplayNodeModifiedEvent(vtkMRMLNode *node);
+  virtual void OnMRMLAnnotationControlPointModifiedEvent(vtkMRMLNode *node);
+
+  /// Give a widget to the fiducials that need one and take it back from
+  /// the others, depending on the number of fiducials
+  void UpdateBulkDisplayMode();
+  /// Move a fiducial from the bulk display to a widget and back
+  void AddFiducialWidget(vtkMRMLAnnotationFiducialNode* node);
+  void RemoveFiducialWidget(vtkMRMLAnnotationFiducialNode* node);
+  /// Give a widget to the bulk fiducial under the mouse
+  void UpdateHoveredFiducial();
+  /// Rebuild the glyph actors of the bulk fiducials
+  void UpdateBulkGlyphs();
+  /// Return the bulk fiducial closest to the display position
+  /// within a few pixels, if any
+  vtkMRMLAnnotationFiducialNode* PickBulkFiducial(double x, double y);
+
+  int BulkDisplayThreshold;
+
+  class vtkInternal;
+  vtkInternal* Internal;
+
 private:
 
   vtkMRMLAnnotationFiducialDisplayableManager(const vtkMRMLAnnotationFiducialDisplayableManager&); /// Not implemented
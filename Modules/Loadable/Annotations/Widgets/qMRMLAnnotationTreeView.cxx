@@ -482,10 +482,14 @@ void qMRMLAnnotationTreeView::mouseMoveEvent(QMouseEvent* e)
 //------------------------------------------------------------------------------
 void qMRMLAnnotationTreeView::hideScene()
 {
-  // set the column widths
+  // set the column widths, setting the mode again would resize the
+  // columns to the contents of all the rows
   for (int i = 0; i < this->header()->count(); ++i)
     {
-    this->header()->setResizeMode(i, QHeaderView::ResizeToContents);
+    if (this->header()->resizeMode(i) != QHeaderView::ResizeToContents)
+      {
+      this->header()->setResizeMode(i, QHeaderView::ResizeToContents);
+      }
     }
 }
 
@@ -59,6 +59,12 @@ void qMRMLSceneAnnotationModelPrivate::init()
 
   q->setHorizontalHeaderLabels(
     QStringList() << "" << "Vis" << "Lock" << "Edit" << "Value" << "Name" << "Description");
+
+  // About the rate the slice and 3D views are rendered at while interacting
+  this->PendingNodesTimer.setSingleShot(true);
+  this->PendingNodesTimer.setInterval(50);
+  QObject::connect(&this->PendingNodesTimer, SIGNAL(timeout()),
+                   q, SLOT(updatePendingNodeItems()));
 }
 
 //------------------------------------------------------------------------------
@@ -237,6 +243,43 @@ void qMRMLSceneAnnotationModel::updateItemDataFromNode(QStandardItem* item, vtkM
     }
 }
 
+//------------------------------------------------------------------------------
+void qMRMLSceneAnnotationModel::onMRMLNodeModified(vtkObject* node)
+{
+  Q_D(qMRMLSceneAnnotationModel);
+  vtkMRMLNode* modifiedNode = vtkMRMLNode::SafeDownCast(node);
+  if (!modifiedNode || !modifiedNode->GetID())
+    {
+    return;
+    }
+  d->PendingNodeIDs.insert(QString(modifiedNode->GetID()));
+  if (!d->PendingNodesTimer.isActive())
+    {
+    d->PendingNodesTimer.start();
+    }
+}
+
+//------------------------------------------------------------------------------
+void qMRMLSceneAnnotationModel::updatePendingNodeItems()
+{
+  Q_D(qMRMLSceneAnnotationModel);
+  QSet<QString> nodeIDs = d->PendingNodeIDs;
+  d->PendingNodeIDs.clear();
+  if (!this->mrmlScene())
+    {
+    return;
+    }
+  foreach(const QString& nodeID, nodeIDs)
+    {
+    // the node may have been removed since it was modified
+    vtkMRMLNode* node = this->mrmlScene()->GetNodeByID(nodeID.toLatin1());
+    if (node)
+      {
+      this->updateNodeItems(node, nodeID);
+      }
+    }
+}
+
 //------------------------------------------------------------------------------
 QFlags<Qt::ItemFlag> qMRMLSceneAnnotationModel::nodeFlags(vtkMRMLNode* node, int column)const
 {
@@ -125,6 +125,17 @@ public:
   virtual vtkMRMLNode* parentNode(vtkMRMLNode* node)const;
   virtual bool canBeAParent(vtkMRMLNode* node)const;
 
+protected slots:
+  /// The items of a modified node are not updated right away but with the
+  /// next update of the pending nodes. Dragging an annotation modifies it
+  /// for each mouse move: its measurement and text are then only computed
+  /// a few times per second.
+  /// \sa updatePendingNodeItems()
+  virtual void onMRMLNodeModified(vtkObject* node);
+
+  /// Update the items of the nodes modified since the last update.
+  void updatePendingNodeItems();
+
 protected:
   qMRMLSceneAnnotationModel(qMRMLSceneAnnotationModelPrivate* pimpl,
                              QObject *parent=0);
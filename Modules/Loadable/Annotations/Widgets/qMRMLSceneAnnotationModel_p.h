@@ -25,6 +25,10 @@
 #include "qMRMLSceneAnnotationModel.h"
 #include "qMRMLSceneDisplayableModel_p.h"
 
+// Qt includes
+#include <QSet>
+#include <QTimer>
+
 //------------------------------------------------------------------------------
 // qMRMLSceneAnnotationModelPrivate
 //------------------------------------------------------------------------------
@@ -48,6 +52,10 @@ public:
   int TextColumn;
 
   vtkSlicerAnnotationModuleLogic* AnnotationLogic;
+
+  /// IDs of the nodes modified since the last update of their items
+  QSet<QString> PendingNodeIDs;
+  QTimer        PendingNodesTimer;
 };
 
 #endif
@@ -20,17 +20,45 @@ Version:   $Revision: 1.2 $
 // MRML includes
 
 // VTK includes
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkMultiThreader.h>
+#include <vtkPointData.h>
+#include <vtkStringArray.h>
+
+// ITKSys includes
+#include <itksys/Process.h>
+#include <itksys/System.h>
 
 // STD includes
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <vector>
 
 //----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkAtlasCreatorLogic);
 
+//----------------------------------------------------------------------------
+template <class T>
+static void vtkAtlasCreatorLogicAddToMean(const T* labels, vtkIdType numberOfVoxels,
+                                          int numberOfComponents, double label,
+                                          float weight, float* mean)
+{
+  for (vtkIdType i = 0; i < numberOfVoxels; ++i, labels += numberOfComponents)
+    {
+    float mask = (static_cast<double>(*labels) == label) ? 1.f : 0.f;
+    mean[i] += (mask - mean[i]) * weight;
+    }
+}
 
 //----------------------------------------------------------------------------
 vtkAtlasCreatorLogic::vtkAtlasCreatorLogic()
 {
   this->AtlasCreatorNode = NULL;
+  this->MaximumNumberOfJobs = 0;
+  this->NumberOfAtlasSegmentations = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -43,6 +71,8 @@ vtkAtlasCreatorLogic::~vtkAtlasCreatorLogic()
 void vtkAtlasCreatorLogic::PrintSelf(ostream& os, vtkIndent indent)
 {
   Superclass::PrintSelf(os, indent);
+  os << indent << "MaximumNumberOfJobs: " << this->MaximumNumberOfJobs << "\n";
+  os << indent << "NumberOfAtlasSegmentations: " << this->NumberOfAtlasSegmentations << "\n";
 }
 
 //----------------------------------------------------------------------------
@@ -55,3 +85,178 @@ void vtkAtlasCreatorLogic::Apply()
 {
 }
 
+//----------------------------------------------------------------------------
+int vtkAtlasCreatorLogic::RunJobs(vtkStringArray* jobs)
+{
+  if (!jobs)
+    {
+    return 0;
+    }
+  vtkIdType numberOfJobs = jobs->GetNumberOfValues();
+  const char* schedulerCommand =
+    (this->AtlasCreatorNode && this->AtlasCreatorNode->GetUseCluster()) ?
+    this->AtlasCreatorNode->GetSchedulerCommand() : 0;
+
+  int maximumNumberOfJobs = this->MaximumNumberOfJobs;
+  if (schedulerCommand)
+    {
+    // the cluster queues the jobs
+    maximumNumberOfJobs = static_cast<int>(numberOfJobs);
+    }
+  else if (maximumNumberOfJobs <= 0)
+    {
+    int threadsPerJob =
+      this->AtlasCreatorNode ? this->AtlasCreatorNode->GetNumberOfThreads() : -1;
+    maximumNumberOfJobs = vtkMultiThreader::GetGlobalDefaultNumberOfThreads() /
+      (threadsPerJob > 0 ? threadsPerJob : 1);
+    }
+  maximumNumberOfJobs = std::max(maximumNumberOfJobs, 1);
+
+  std::vector<itksysProcess*> processes(numberOfJobs, static_cast<itksysProcess*>(0));
+  vtkIdType nextJob = 0;
+  int numberOfRunningJobs = 0;
+  int numberOfFailedJobs = 0;
+  while (nextJob < numberOfJobs || numberOfRunningJobs > 0)
+    {
+    for (; nextJob < numberOfJobs && numberOfRunningJobs < maximumNumberOfJobs; ++nextJob)
+      {
+      std::string command = jobs->GetValue(nextJob);
+      if (schedulerCommand && strlen(schedulerCommand) > 0)
+        {
+        command = std::string(schedulerCommand) + " " + command;
+        }
+      char** commandLine = itksysSystem_Parse_CommandForUnix(command.c_str(), 0);
+      if (!commandLine || !commandLine[0])
+        {
+        vtkErrorMacro(<< "RunJobs: empty job " << nextJob);
+        ++numberOfFailedJobs;
+        }
+      else
+        {
+        itksysProcess* process = itksysProcess_New();
+        itksysProcess_SetCommand(process, commandLine);
+        itksysProcess_SetOption(process, itksysProcess_Option_HideWindow, 1);
+        // the output of the jobs is not parsed, it goes to the terminal
+        itksysProcess_SetPipeShared(process, itksysProcess_Pipe_STDOUT, 1);
+        itksysProcess_SetPipeShared(process, itksysProcess_Pipe_STDERR, 1);
+        itksysProcess_Execute(process);
+        processes[nextJob] = process;
+        ++numberOfRunningJobs;
+        }
+      for (char** argument = commandLine; argument && *argument; ++argument)
+        {
+        free(*argument);
+        }
+      free(commandLine);
+      }
+
+    for (vtkIdType job = 0; job < nextJob; ++job)
+      {
+      if (!processes[job])
+        {
+        continue;
+        }
+      double timeout = 0.01;
+      if (!itksysProcess_WaitForExit(processes[job], &timeout))
+        {
+        continue;
+        }
+      if (itksysProcess_GetState(processes[job]) != itksysProcess_State_Exited ||
+          itksysProcess_GetExitValue(processes[job]) != 0)
+        {
+        vtkErrorMacro(<< "RunJobs: job failed: " << jobs->GetValue(job));
+        ++numberOfFailedJobs;
+        }
+      itksysProcess_Delete(processes[job]);
+      processes[job] = 0;
+      --numberOfRunningJobs;
+      }
+    }
+  return numberOfFailedJobs;
+}
+
+//----------------------------------------------------------------------------
+void vtkAtlasCreatorLogic::InitializeAtlases()
+{
+  this->Atlases.clear();
+  this->NumberOfAtlasSegmentations = 0;
+  if (!this->AtlasCreatorNode || !this->AtlasCreatorNode->GetLabelsList())
+    {
+    return;
+    }
+  std::istringstream labels(this->AtlasCreatorNode->GetLabelsList());
+  int label;
+  while (labels >> label)
+    {
+    this->Atlases[label] = 0;
+    }
+}
+
+//----------------------------------------------------------------------------
+bool vtkAtlasCreatorLogic::AddToAtlases(vtkImageData* alignedSegmentation)
+{
+  if (!alignedSegmentation || this->Atlases.empty())
+    {
+    return false;
+    }
+  alignedSegmentation->Update();
+  vtkDataArray* labels = alignedSegmentation->GetPointData()->GetScalars();
+  if (!labels)
+    {
+    vtkErrorMacro(<< "AddToAtlases: segmentation without scalars");
+    return false;
+    }
+  vtkImageData* firstAtlas = this->Atlases.begin()->second;
+  if (firstAtlas)
+    {
+    int atlasDimensions[3];
+    int dimensions[3];
+    firstAtlas->GetDimensions(atlasDimensions);
+    alignedSegmentation->GetDimensions(dimensions);
+    if (atlasDimensions[0] != dimensions[0] ||
+        atlasDimensions[1] != dimensions[1] ||
+        atlasDimensions[2] != dimensions[2])
+      {
+      vtkErrorMacro(<< "AddToAtlases: the segmentation is not aligned with the "
+                    << "previous segmentations");
+      return false;
+      }
+    }
+
+  ++this->NumberOfAtlasSegmentations;
+  float weight = 1.f / this->NumberOfAtlasSegmentations;
+  vtkIdType numberOfVoxels = labels->GetNumberOfTuples();
+  for (std::map<int, vtkSmartPointer<vtkImageData> >::iterator it =
+         this->Atlases.begin(); it != this->Atlases.end(); ++it)
+    {
+    if (!it->second)
+      {
+      it->second = vtkSmartPointer<vtkImageData>::New();
+      it->second->CopyStructure(alignedSegmentation);
+      it->second->SetScalarTypeToFloat();
+      it->second->SetNumberOfScalarComponents(1);
+      it->second->AllocateScalars();
+      memset(it->second->GetScalarPointer(), 0, numberOfVoxels * sizeof(float));
+      }
+    float* mean = static_cast<float*>(it->second->GetScalarPointer());
+    switch (labels->GetDataType())
+      {
+      vtkTemplateMacro(vtkAtlasCreatorLogicAddToMean(
+        static_cast<VTK_TT*>(labels->GetVoidPointer(0)), numberOfVoxels,
+        labels->GetNumberOfComponents(), it->first, weight, mean));
+      default:
+        break;
+      }
+    it->second->Modified();
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+vtkImageData* vtkAtlasCreatorLogic::GetAtlas(int label)
+{
+  std::map<int, vtkSmartPointer<vtkImageData> >::iterator it =
+    this->Atlases.find(label);
+  return it != this->Atlases.end() ? it->second.GetPointer() : 0;
+}
+
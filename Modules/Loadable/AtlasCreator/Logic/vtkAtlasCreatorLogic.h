@@ -25,6 +25,14 @@
 
 // TODO Node registration needs to be done in the Logic. See RegisterNodes
 
+// VTK includes
+#include <vtkSmartPointer.h>
+class vtkImageData;
+class vtkStringArray;
+
+// STD includes
+#include <map>
+
 class vtkITKGradientAnisotropicDiffusionImageFilter;
 
 class VTK_SLICER_ATLASCREATOR_MODULE_LOGIC_EXPORT vtkAtlasCreatorLogic :
@@ -41,7 +49,39 @@ class VTK_SLICER_ATLASCREATOR_MODULE_LOGIC_EXPORT vtkAtlasCreatorLogic :
 
   // The method that creates and runs VTK or ITK pipeline
   void Apply();
-  
+
+  // Description: Run the per-subject jobs (registrations, resamplings) and
+  // wait for them. Each job is a command line, arguments separated by
+  // spaces and grouped by quotes. With UseCluster, the SchedulerCommand of
+  // the node is prefixed to the jobs and they are all submitted at once,
+  // otherwise at most GetMaximumNumberOfJobs() jobs run at the same time.
+  // Returns the number of jobs that failed.
+  int RunJobs(vtkStringArray* jobs);
+
+  // Description: Maximum number of jobs running on this computer at the
+  // same time. 0 (the default) uses all the cores: the number of cores
+  // divided by the NumberOfThreads of each job.
+  vtkSetMacro(MaximumNumberOfJobs, int);
+  vtkGetMacro(MaximumNumberOfJobs, int);
+
+  // Description: Start new atlases, one per label of the LabelsList of the
+  // node.
+  void InitializeAtlases();
+
+  // Description: Add an aligned segmentation to the atlases. The atlas of
+  // a label is the running mean of the label masks of the segmentations
+  // added so far, so that the segmentations can be added one at a time as
+  // their registrations are done, without keeping the cohort in memory.
+  // Returns false if the segmentation doesn't match the previous ones.
+  bool AddToAtlases(vtkImageData* alignedSegmentation);
+
+  // Description: Atlas (float probabilities) of a label, NULL if the label
+  // is not in the LabelsList or if no segmentation has been added.
+  vtkImageData* GetAtlas(int label);
+
+  // Description: Number of segmentations added to the atlases.
+  vtkGetMacro(NumberOfAtlasSegmentations, int);
+
 protected:
   vtkAtlasCreatorLogic();
   virtual ~vtkAtlasCreatorLogic();
@@ -51,6 +91,11 @@ protected:
   vtkMRMLAtlasCreatorNode* AtlasCreatorNode;
   vtkITKGradientAnisotropicDiffusionImageFilter* GradientAnisotropicDiffusionImageFilter;
 
+  int MaximumNumberOfJobs;
+
+  std::map<int, vtkSmartPointer<vtkImageData> > Atlases;
+  int NumberOfAtlasSegmentations;
+
 };
 
 #endif
@@ -0,0 +1,272 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Cameras Logic includes
+#include "vtkSlicerCameraFlythrough.h"
+
+// MRML includes
+#include <vtkMRMLCameraNode.h>
+#include <vtkMRMLLinearTransformNode.h>
+#include <vtkMRMLScene.h>
+#include <vtkMRMLSliceNode.h>
+
+// VTK includes
+#include <vtkCamera.h>
+#include <vtkMath.h>
+#include <vtkMatrix4x4.h>
+#include <vtkObjectFactory.h>
+#include <vtkPoints.h>
+
+// STD includes
+#include <cmath>
+#include <vector>
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkSlicerCameraFlythrough);
+
+//----------------------------------------------------------------------------
+class vtkSlicerCameraFlythrough::vtkInternal
+{
+public:
+  struct Pose
+    {
+    double Position[3];
+    double FocalPoint[3];
+    double ViewUp[3];
+    };
+  std::vector<Pose> Track;
+};
+
+//----------------------------------------------------------------------------
+vtkSlicerCameraFlythrough::vtkSlicerCameraFlythrough()
+{
+  this->CameraNode = 0;
+  this->TransformNode = 0;
+  this->Frame = 0;
+  this->SliceUpdateInterval = 0;
+  this->FramesSinceSliceUpdate = 0;
+  this->Internal = new vtkInternal;
+}
+
+//----------------------------------------------------------------------------
+vtkSlicerCameraFlythrough::~vtkSlicerCameraFlythrough()
+{
+  this->SetCameraNode(0);
+  this->SetTransformNode(0);
+  delete this->Internal;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCameraFlythrough::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "CameraNode: " << this->CameraNode << "\n";
+  os << indent << "TransformNode: " << this->TransformNode << "\n";
+  os << indent << "NumberOfFrames: " << this->GetNumberOfFrames() << "\n";
+  os << indent << "Frame: " << this->Frame << "\n";
+  os << indent << "SliceUpdateInterval: " << this->SliceUpdateInterval << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCameraFlythrough::SetCameraNode(vtkMRMLCameraNode* cameraNode)
+{
+  vtkSetObjectBodyMacro(CameraNode, vtkMRMLCameraNode, cameraNode);
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCameraFlythrough::SetTransformNode(vtkMRMLLinearTransformNode* transformNode)
+{
+  vtkSetObjectBodyMacro(TransformNode, vtkMRMLLinearTransformNode, transformNode);
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCameraFlythrough::SetPath(vtkPoints* path)
+{
+  this->Internal->Track.clear();
+  this->Frame = 0;
+  this->FramesSinceSliceUpdate = 0;
+  vtkIdType numberOfPoints = path ? path->GetNumberOfPoints() : 0;
+  if (numberOfPoints < 2)
+    {
+    this->Modified();
+    return;
+    }
+
+  double viewUp[3] = {0., 0., 1.};
+  if (this->CameraNode && this->CameraNode->GetCamera())
+    {
+    this->CameraNode->GetCamera()->GetViewUp(viewUp);
+    }
+
+  this->Internal->Track.resize(numberOfPoints - 1);
+  for (vtkIdType i = 0; i < numberOfPoints - 1; ++i)
+    {
+    vtkInternal::Pose& pose = this->Internal->Track[i];
+    path->GetPoint(i, pose.Position);
+    path->GetPoint(i + 1, pose.FocalPoint);
+    double direction[3];
+    vtkMath::Subtract(pose.FocalPoint, pose.Position, direction);
+    if (vtkMath::Normalize(direction) == 0.)
+      {
+      // Duplicated point, keep the previous orientation
+      pose.ViewUp[0] = viewUp[0];
+      pose.ViewUp[1] = viewUp[1];
+      pose.ViewUp[2] = viewUp[2];
+      continue;
+      }
+    // Carry the view up along the path: remove its component along the
+    // new direction (parallel transport), so the camera doesn't roll.
+    double along = vtkMath::Dot(viewUp, direction);
+    double up[3] = {viewUp[0] - along * direction[0],
+                    viewUp[1] - along * direction[1],
+                    viewUp[2] - along * direction[2]};
+    if (vtkMath::Normalize(up) < 1e-6)
+      {
+      // The view up is along the direction, take any perpendicular vector
+      double unused[3];
+      vtkMath::Perpendiculars(direction, up, unused, 0.);
+      }
+    pose.ViewUp[0] = viewUp[0] = up[0];
+    pose.ViewUp[1] = viewUp[1] = up[1];
+    pose.ViewUp[2] = viewUp[2] = up[2];
+    }
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerCameraFlythrough::GetNumberOfFrames()const
+{
+  return static_cast<int>(this->Internal->Track.size());
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCameraFlythrough::GetFramePosition(int frame, double position[3])const
+{
+  if (frame < 0 || frame >= this->GetNumberOfFrames())
+    {
+    vtkErrorMacro("GetFramePosition: invalid frame " << frame);
+    return;
+    }
+  const vtkInternal::Pose& pose = this->Internal->Track[frame];
+  position[0] = pose.Position[0];
+  position[1] = pose.Position[1];
+  position[2] = pose.Position[2];
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCameraFlythrough::GetFrameFocalPoint(int frame, double focalPoint[3])const
+{
+  if (frame < 0 || frame >= this->GetNumberOfFrames())
+    {
+    vtkErrorMacro("GetFrameFocalPoint: invalid frame " << frame);
+    return;
+    }
+  const vtkInternal::Pose& pose = this->Internal->Track[frame];
+  focalPoint[0] = pose.FocalPoint[0];
+  focalPoint[1] = pose.FocalPoint[1];
+  focalPoint[2] = pose.FocalPoint[2];
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCameraFlythrough::GetFrameViewUp(int frame, double viewUp[3])const
+{
+  if (frame < 0 || frame >= this->GetNumberOfFrames())
+    {
+    vtkErrorMacro("GetFrameViewUp: invalid frame " << frame);
+    return;
+    }
+  const vtkInternal::Pose& pose = this->Internal->Track[frame];
+  viewUp[0] = pose.ViewUp[0];
+  viewUp[1] = pose.ViewUp[1];
+  viewUp[2] = pose.ViewUp[2];
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCameraFlythrough::SetFrame(int frame)
+{
+  if (frame < 0 || frame >= this->GetNumberOfFrames())
+    {
+    vtkErrorMacro("SetFrame: invalid frame " << frame);
+    return;
+    }
+  this->Frame = frame;
+  const vtkInternal::Pose& pose = this->Internal->Track[frame];
+
+  vtkCamera* camera = this->CameraNode ? this->CameraNode->GetCamera() : 0;
+  if (camera)
+    {
+    camera->SetPosition(const_cast<double*>(pose.Position));
+    camera->SetFocalPoint(const_cast<double*>(pose.FocalPoint));
+    camera->SetViewUp(const_cast<double*>(pose.ViewUp));
+    }
+
+  vtkMatrix4x4* matrix = this->TransformNode ?
+    this->TransformNode->GetMatrixTransformToParent() : 0;
+  if (matrix)
+    {
+    // Set the translation at once, each SetElement() would modify it
+    double elements[16];
+    vtkMatrix4x4::DeepCopy(elements, matrix);
+    elements[3] = pose.Position[0];
+    elements[7] = pose.Position[1];
+    elements[11] = pose.Position[2];
+    matrix->DeepCopy(elements);
+    }
+
+  ++this->FramesSinceSliceUpdate;
+  if (this->SliceUpdateInterval > 0 &&
+      (this->FramesSinceSliceUpdate >= this->SliceUpdateInterval ||
+       frame == this->GetNumberOfFrames() - 1))
+    {
+    this->UpdateSlices();
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerCameraFlythrough::Step(int steps)
+{
+  int numberOfFrames = this->GetNumberOfFrames();
+  if (numberOfFrames == 0)
+    {
+    return 0;
+    }
+  int frame = this->Frame + steps;
+  if (frame >= numberOfFrames || frame < 0)
+    {
+    frame = 0;
+    }
+  this->SetFrame(frame);
+  return this->Frame;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerCameraFlythrough::UpdateSlices()
+{
+  this->FramesSinceSliceUpdate = 0;
+  vtkMRMLScene* scene = this->CameraNode ? this->CameraNode->GetScene() : 0;
+  if (!scene)
+    {
+    return;
+    }
+  const vtkInternal::Pose& pose = this->Internal->Track[this->Frame];
+  std::vector<vtkMRMLNode*> sliceNodes;
+  scene->GetNodesByClass("vtkMRMLSliceNode", sliceNodes);
+  for (std::vector<vtkMRMLNode*>::iterator it = sliceNodes.begin();
+       it != sliceNodes.end(); ++it)
+    {
+    vtkMRMLSliceNode::SafeDownCast(*it)->JumpSlice(
+      pose.Position[0], pose.Position[1], pose.Position[2]);
+    }
+}
@@ -0,0 +1,101 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkSlicerCameraFlythrough_h
+#define __vtkSlicerCameraFlythrough_h
+
+// Slicer includes
+#include "vtkSlicerCamerasModuleLogicExport.h"
+
+// VTK includes
+#include <vtkObject.h>
+
+class vtkMRMLCameraNode;
+class vtkMRMLLinearTransformNode;
+class vtkPoints;
+
+/// \brief Move a camera along a precomputed track.
+///
+/// SetPath() computes once the pose of the camera at each point of a path
+/// (e.g. the Endoscopy module spline): the camera is at the point, looks at
+/// the next one, and its view up is carried along the path without twist
+/// from the initial view up of the camera. SetFrame() then only copies a
+/// pose into the camera and a translation into the optional cursor
+/// transform node, whose matrix is modified once. The render requests of a
+/// frame are coalesced by the render scheduler.
+/// The slice views follow the camera every SliceUpdateInterval frames: the
+/// slices are jumped to the camera position at a lower rate than the 3D
+/// view is updated.
+class VTK_SLICER_CAMERAS_LOGIC_EXPORT vtkSlicerCameraFlythrough
+  : public vtkObject
+{
+public:
+  static vtkSlicerCameraFlythrough *New();
+  vtkTypeMacro(vtkSlicerCameraFlythrough, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  /// Camera to move
+  void SetCameraNode(vtkMRMLCameraNode* cameraNode);
+  vtkGetObjectMacro(CameraNode, vtkMRMLCameraNode);
+
+  /// Optional transform whose translation follows the camera position
+  void SetTransformNode(vtkMRMLLinearTransformNode* transformNode);
+  vtkGetObjectMacro(TransformNode, vtkMRMLLinearTransformNode);
+
+  /// Compute the track from the points of \a path. A track has one frame
+  /// less than the path as the camera looks at the next point.
+  /// The initial view up is the one of the camera node, if any.
+  void SetPath(vtkPoints* path);
+  int GetNumberOfFrames()const;
+
+  /// Get the precomputed pose of \a frame
+  void GetFramePosition(int frame, double position[3])const;
+  void GetFrameFocalPoint(int frame, double focalPoint[3])const;
+  void GetFrameViewUp(int frame, double viewUp[3])const;
+
+  /// Move the camera to \a frame
+  void SetFrame(int frame);
+  vtkGetMacro(Frame, int);
+
+  /// Move the camera \a steps frames further, back to the first frame
+  /// after the last one. Return the new frame.
+  int Step(int steps = 1);
+
+  /// Jump the slices to the camera position every SliceUpdateInterval
+  /// frames, and on the last frame. 0 (default) never moves the slices.
+  vtkSetClampMacro(SliceUpdateInterval, int, 0, VTK_INT_MAX);
+  vtkGetMacro(SliceUpdateInterval, int);
+
+protected:
+  vtkSlicerCameraFlythrough();
+  virtual ~vtkSlicerCameraFlythrough();
+
+  void UpdateSlices();
+
+  vtkMRMLCameraNode* CameraNode;
+  vtkMRMLLinearTransformNode* TransformNode;
+  int Frame;
+  int SliceUpdateInterval;
+  int FramesSinceSliceUpdate;
+
+  class vtkInternal;
+  vtkInternal* Internal;
+
+private:
+  vtkSlicerCameraFlythrough(const vtkSlicerCameraFlythrough&); // Not implemented
+  void operator=(const vtkSlicerCameraFlythrough&);            // Not implemented
+};
+
+#endif
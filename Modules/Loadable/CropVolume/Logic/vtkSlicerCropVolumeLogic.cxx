@@ -37,15 +37,127 @@
 
 // VTK includes
 #include <vtkImageData.h>
-#include <vtkImageClip.h>
+#include <vtkImageReslice.h>
 #include <vtkNew.h>
 #include <vtkMatrix4x4.h>
+#include <vtkPointData.h>
 #include <vtkSmartPointer.h>
 
 // STD includes
 #include <cassert>
+#include <cstring>
 #include <iostream>
 
+//----------------------------------------------------------------------------
+// Copy the voxels of the extent of the input image into the output image,
+// whose extent starts at 0, one row at a time.
+static bool vtkSlicerCropVolumeLogicCopyExtent(vtkImageData* input, const int extent[6],
+                                              vtkImageData* output)
+{
+  if (!input->GetPointData()->GetScalars() ||
+      extent[0] > extent[1] || extent[2] > extent[3] || extent[4] > extent[5])
+    {
+    return false;
+    }
+  output->SetExtent(0, extent[1] - extent[0], 0, extent[3] - extent[2], 0, extent[5] - extent[4]);
+  output->SetSpacing(input->GetSpacing());
+  output->SetOrigin(input->GetOrigin());
+  output->SetScalarType(input->GetScalarType());
+  output->SetNumberOfScalarComponents(input->GetNumberOfScalarComponents());
+  output->AllocateScalars();
+
+  size_t rowSize = static_cast<size_t>(extent[1] - extent[0] + 1) *
+    input->GetScalarSize() * input->GetNumberOfScalarComponents();
+  unsigned char* outputPtr = static_cast<unsigned char*>(output->GetScalarPointer());
+  for (int z = extent[4]; z <= extent[5]; ++z)
+    {
+    for (int y = extent[2]; y <= extent[3]; ++y)
+      {
+      memcpy(outputPtr, input->GetScalarPointer(extent[0], y, z), rowSize);
+      outputPtr += rowSize;
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// Resample the input volume on the output grid with a (threaded)
+// vtkImageReslice. Return false if the interpolation or the transform of the
+// input volume needs the resampling CLI.
+static bool vtkSlicerCropVolumeLogicReslice(vtkMRMLVolumeNode* inputVolume,
+                                           int interpolationMode,
+                                           vtkMatrix4x4* outputIJKToRAS,
+                                           const int outputDimensions[3],
+                                           vtkMRMLVolumeNode* outputVolume)
+{
+  vtkImageData* inputImageData = inputVolume->GetImageData();
+  if (!inputImageData || (interpolationMode != 1 && interpolationMode != 2))
+    {
+    return false;
+    }
+  vtkMRMLTransformNode* inputTransform = inputVolume->GetParentTransformNode();
+  if (inputTransform && !inputTransform->IsTransformToWorldLinear())
+    {
+    return false;
+    }
+
+  // output ijk -> RAS -> input RAS -> input ijk -> input image coordinates
+  vtkNew<vtkMatrix4x4> outputIJKToInput;
+  outputIJKToInput->DeepCopy(outputIJKToRAS);
+  if (inputTransform)
+    {
+    vtkNew<vtkMatrix4x4> worldToInputRAS;
+    inputTransform->GetMatrixTransformToWorld(worldToInputRAS.GetPointer());
+    worldToInputRAS->Invert();
+    vtkMatrix4x4::Multiply4x4(worldToInputRAS.GetPointer(), outputIJKToInput.GetPointer(),
+                              outputIJKToInput.GetPointer());
+    }
+  vtkNew<vtkMatrix4x4> inputRASToImage;
+  inputVolume->GetRASToIJKMatrix(inputRASToImage.GetPointer());
+  double* inputSpacing = inputImageData->GetSpacing();
+  double* inputOrigin = inputImageData->GetOrigin();
+  for (int i = 0; i < 3; ++i)
+    {
+    for (int j = 0; j < 4; ++j)
+      {
+      inputRASToImage->SetElement(i, j, inputRASToImage->GetElement(i, j) * inputSpacing[i]);
+      }
+    inputRASToImage->SetElement(i, 3, inputRASToImage->GetElement(i, 3) + inputOrigin[i]);
+    }
+  vtkMatrix4x4::Multiply4x4(inputRASToImage.GetPointer(), outputIJKToInput.GetPointer(),
+                            outputIJKToInput.GetPointer());
+
+  vtkNew<vtkImageReslice> reslice;
+  reslice->SetInput(inputImageData);
+  reslice->SetResliceAxes(outputIJKToInput.GetPointer());
+  reslice->SetOutputOrigin(0., 0., 0.);
+  reslice->SetOutputSpacing(1., 1., 1.);
+  reslice->SetOutputExtent(0, outputDimensions[0] - 1,
+                           0, outputDimensions[1] - 1,
+                           0, outputDimensions[2] - 1);
+  reslice->SetBackgroundLevel(0.);
+  if (interpolationMode == 1)
+    {
+    reslice->SetInterpolationModeToNearestNeighbor();
+    }
+  else
+    {
+    reslice->SetInterpolationModeToLinear();
+    }
+  reslice->Update();
+
+  vtkNew<vtkImageData> outputImageData;
+  outputImageData->ShallowCopy(reslice->GetOutput());
+
+  vtkNew<vtkMatrix4x4> outputRASToIJK;
+  outputRASToIJK->DeepCopy(outputIJKToRAS);
+  outputRASToIJK->Invert();
+  outputVolume->SetAndObserveImageData(outputImageData.GetPointer());
+  outputVolume->SetIJKToRASMatrix(outputIJKToRAS);
+  outputVolume->SetRASToIJKMatrix(outputRASToIJK);
+  return true;
+}
+
 //----------------------------------------------------------------------------
 class vtkSlicerCropVolumeLogic::vtkInternal
 {
@@ -213,6 +325,9 @@ int vtkSlicerCropVolumeLogic::Apply(vtkMRMLCropVolumeParametersNode* pnode)
   else  // interpolated cropping selected
     {
       vtkMRMLScalarVolumeNode *refVolume;
+      // the resampling CLI also reorients the vectors and gradients of the
+      // vector and diffusion volumes, scalar volumes are resampled in process
+      bool resliceInput = svnode && !vvnode && !dwvnode;
       vtkMatrix4x4 *inputRASToIJK = vtkMatrix4x4::New();
       vtkMatrix4x4 *inputIJKToRAS = vtkMatrix4x4::New();
       vtkMatrix4x4 *outputRASToIJK = vtkMatrix4x4::New();
@@ -299,11 +414,25 @@ int vtkSlicerCropVolumeLogic::Apply(vtkMRMLCropVolumeParametersNode* pnode)
       refVolume->SetIJKToRASMatrix(outputIJKToRAS);
       refVolume->SetRASToIJKMatrix(outputRASToIJK);
 
+      if (resliceInput)
+        {
+        resliceInput = vtkSlicerCropVolumeLogicReslice(
+          inputVolume, pnode->GetInterpolationMode(), outputIJKToRAS, outputExtent, outputVolume);
+        }
+
       inputRASToIJK->Delete();
       inputIJKToRAS->Delete();
       outputRASToIJK->Delete();
       outputIJKToRAS->Delete();
 
+      if (resliceInput)
+        {
+        this->GetMRMLScene()->RemoveNode(refVolume);
+        outputVolume->SetAndObserveTransformNodeID(NULL);
+        pnode->SetOutputVolumeNodeID(outputVolume->GetID());
+        return 0;
+        }
+
       if (this->Internal->ResampleLogic == 0)
         {
           std::cerr << "CropVolume: ERROR: resample logic is not set!";
@@ -363,8 +492,9 @@ void vtkSlicerCropVolumeLogic::CropVoxelBased(vtkMRMLAnnotationROINode* roi, vtk
   if(!roi || !inputVolume || !outputVolume)
     return;
 
-  vtkNew<vtkImageData> imageDataWorkingCopy;
-  imageDataWorkingCopy->DeepCopy(inputVolume->GetImageData());
+  vtkImageData* inputImageData = inputVolume->GetImageData();
+  if (!inputImageData)
+    return;
 
   vtkNew<vtkMatrix4x4> inputRASToIJK;
   inputVolume->GetRASToIJKMatrix(inputRASToIJK.GetPointer());
@@ -409,7 +539,7 @@ void vtkSlicerCropVolumeLogic::CropVoxelBased(vtkMRMLAnnotationROINode* roi, vtk
   double maxZ = std::max(minXYZIJK[2],maxXYZIJK[2]) + 0.5;
 
   int originalImageExtents[6];
-  imageDataWorkingCopy->GetExtent(originalImageExtents);
+  inputImageData->GetExtent(originalImageExtents);
 
   minX = std::max(minX,0.);
   maxX = std::min(maxX,static_cast<double>(originalImageExtents[1]));
@@ -426,13 +556,14 @@ void vtkSlicerCropVolumeLogic::CropVoxelBased(vtkMRMLAnnotationROINode* roi, vtk
   inputIJKToRAS->MultiplyPoint(ijkNewOrigin,rasNewOrigin);
 
 
-  vtkNew<vtkImageClip> imageClip;
-  imageClip->SetInput(imageDataWorkingCopy.GetPointer());
-  imageClip->SetOutputWholeExtent(outputWholeExtent);
-  imageClip->SetClipData(true);
-
-  imageClip->Update();
-
+  // the voxels of the ROI are copied straight from the input volume
+  vtkNew<vtkImageData> outputImageData;
+  if (!vtkSlicerCropVolumeLogicCopyExtent(inputImageData, outputWholeExtent,
+                                         outputImageData.GetPointer()))
+    {
+    vtkErrorMacro("CropVoxelBased: the ROI does not intersect the input volume");
+    return;
+    }
 
   vtkNew<vtkMatrix4x4> outputIJKToRAS;
   outputIJKToRAS->DeepCopy(inputIJKToRAS.GetPointer());
@@ -447,14 +578,6 @@ void vtkSlicerCropVolumeLogic::CropVoxelBased(vtkMRMLAnnotationROINode* roi, vtk
   outputRASToIJK->DeepCopy(outputIJKToRAS.GetPointer());
   outputRASToIJK->Invert();
 
-  vtkNew<vtkImageData> outputImageData;
-  outputImageData->DeepCopy(imageClip->GetOutput());
-
-  int extent[6];
-  imageClip->GetOutput()->GetExtent(extent);
-
-  outputImageData->SetExtent(0, extent[1]-extent[0], 0, extent[3]-extent[2], 0, extent[5]-extent[4]);
-
   outputVolume->SetAndObserveImageData(outputImageData.GetPointer());
   outputVolume->SetIJKToRASMatrix(outputIJKToRAS.GetPointer());
   outputVolume->SetRASToIJKMatrix(outputRASToIJK.GetPointer());
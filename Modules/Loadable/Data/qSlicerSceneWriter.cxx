@@ -22,6 +22,7 @@
 #include <QDateTime>
 #include <QDebug>
 #include <QDir>
+#include <QFile>
 #include <QFileInfo>
 #include <QPixmap>
 
@@ -46,6 +47,9 @@
 #include <vtkNew.h>
 #include <vtkSmartPointer.h>
 
+// STD includes
+#include <cstdio>
+
 //----------------------------------------------------------------------------
 qSlicerSceneWriter::qSlicerSceneWriter(QObject* parentObject)
   : Superclass(parentObject)
@@ -167,7 +171,30 @@ bool qSlicerSceneWriter::writeToMRML(const qSlicerIO::IOProperties& properties)
 
   this->mrmlScene()->SetURL(fileName.toLatin1());
   this->mrmlScene()->SetVersion("Slicer4");
-  bool res = this->mrmlScene()->Commit();
+
+  // The scene is written into a temporary file next to the scene file that
+  // then replaces it: an existing scene file is never left half written.
+  QString temporaryFileName = fileName + ".tmp";
+  QFile::remove(temporaryFileName);
+  this->mrmlScene()->Commit(temporaryFileName.toLatin1());
+  if (this->mrmlScene()->GetErrorCode() != 0)
+    {
+    QFile::remove(temporaryFileName);
+    return false;
+    }
+#ifdef Q_OS_WIN
+  // rename() doesn't replace existing files on Windows
+  QFile::remove(fileName);
+  bool res = QFile::rename(temporaryFileName, fileName);
+#else
+  bool res = (std::rename(temporaryFileName.toLocal8Bit(),
+                          fileName.toLocal8Bit()) == 0);
+#endif
+  if (!res)
+    {
+    qWarning() << "Failed to write scene file" << fileName;
+    QFile::remove(temporaryFileName);
+    }
   return res;
 }
 
@@ -233,9 +260,11 @@ bool qSlicerSceneWriter::writeToMRB(const qSlicerIO::IOProperties& properties)
     return false;
     }
 
+  // The files are removed as they are zipped: the bundle doesn't need
+  // twice its size on disk.
   qDebug() << "zipping to " << fileInfo.absoluteFilePath();
   if ( !applicationLogic->Zip(fileInfo.absoluteFilePath().toLatin1(),
-                              bundlePath.toLatin1()) )
+                              bundlePath.toLatin1(), true) )
     {
     QMessageBox::critical(0, tr("Save scene as MRB"), tr("Could not compress bundle"));
     return false;
@@ -27,6 +27,14 @@
 #include "vtkFetchMIParserXND.h"
 #include "vtkFetchMIWebServicesClientXND.h"
 
+// VTK includes
+#include <vtkIntArray.h>
+#include <vtkNew.h>
+#include <vtkStringArray.h>
+
+// STD includes
+#include <sstream>
+
 //----------------------------------------------------------------------------
 //--- a word about language:
 //--- Methods and vars in this module assume that:
@@ -2341,19 +2349,32 @@ void vtkFetchMILogic::QueryServerForTagValues ( )
   // Parse the response from the server. Invoke an event on the node that will be caught by GUI.
   // In GUI, the value menus for each attribute will be updated to show all current values
   // for each tag in the DB.
-  std::string att;
+  // The queries for all the tags are sent at once, each response is
+  // saved in its own file.
+  vtkNew<vtkStringArray> atts;
+  vtkNew<vtkStringArray> responseFileNames;
   std::map<std::string, std::vector<std::string> >::iterator iter;
   for ( iter = this->CurrentWebServiceMetadata.begin();
         iter != this->CurrentWebServiceMetadata.end();
         iter++ )
     {
-    att.clear();
-    att = iter->first;
-    int retval = this->CurrentWebService->GetWebServicesClient()->QueryServerForTagValues ( att.c_str(),  this->GetHTTPResponseFileName() );
-    if ( retval)
+    std::stringstream responseFileName;
+    responseFileName << this->GetHTTPResponseFileName() << "." << atts->GetNumberOfValues();
+    atts->InsertNextValue ( iter->first );
+    responseFileNames->InsertNextValue ( responseFileName.str() );
+    }
+  vtkNew<vtkIntArray> status;
+  this->CurrentWebService->GetWebServicesClient()->QueryServerForTagValues (
+    atts.GetPointer(), responseFileNames.GetPointer(), status.GetPointer() );
+
+  for ( vtkIdType i = 0; i < atts->GetNumberOfValues(); i++ )
+    {
+    std::string att = atts->GetValue(i);
+    if ( status->GetValue(i) )
       {
       //--- clear out the container for values for this tagname.
-      this->ParseValuesForTagQueryResponse ( att.c_str() );
+      this->ParseValuesForTagQueryResponse ( att.c_str(), responseFileNames->GetValue(i).c_str() );
+      vtksys::SystemTools::RemoveFile ( responseFileNames->GetValue(i).c_str() );
       //--- and Update MRML's tagtable. make sure
       //--- each tag's value is in the logic's new list.
       //--- if so, leave it selected. otherwise, reset
@@ -2937,13 +2958,17 @@ void vtkFetchMILogic::QueryServerForResources ( )
 
 
 //----------------------------------------------------------------------------
-void vtkFetchMILogic::ParseValuesForTagQueryResponse ( const char *att )
+void vtkFetchMILogic::ParseValuesForTagQueryResponse ( const char *att, const char *responseFileName )
 {
+  if ( responseFileName == NULL )
+    {
+    responseFileName = this->GetHTTPResponseFileName();
+    }
   if ( this->GetCurrentWebService()->GetParser () )
     {
     this->GetCurrentWebService()->GetParser()->SetFetchMINode ( this->FetchMINode );
     this->ClearExistingValuesForTag ( att );
-    this->GetCurrentWebService()->GetParser()->ParseValuesForAttributeQueryResponse ( this->GetHTTPResponseFileName(), att );
+    this->GetCurrentWebService()->GetParser()->ParseValuesForAttributeQueryResponse ( responseFileName, att );
     this->RefreshValuesForTag ( att );
     this->GetCurrentWebService()->GetParser()->SetFetchMINode ( NULL );
     }
@@ -190,7 +190,9 @@ class VTK_SLICER_FETCHMI_MODULE_LOGIC_EXPORT vtkFetchMILogic : public vtkSlicerM
   // values for each tag in the GUI. If the query returns with an error,
   // the node's error message is filled.
   // moved to Parser->ParseMetadataValuesQueryResponse()
-  void ParseValuesForTagQueryResponse ( const char *att);
+  // The response is read from responseFileName, or from the
+  // HTTPResponseFileName if it is NULL.
+  void ParseValuesForTagQueryResponse ( const char *att, const char *responseFileName = NULL );
 
   // Description:
   // Using XND supported and user specified tags,
@@ -2,6 +2,15 @@
 #include "vtkObjectFactory.h"
 #include "vtkFetchMIWebServicesClient.h"
 
+// VTK includes
+#include <vtkIntArray.h>
+#include <vtkStringArray.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <fstream>
+#include <sstream>
+
 
 //---------------------------------------------------------------------------
 vtkStandardNewMacro (vtkFetchMIWebServicesClient );
@@ -13,6 +22,7 @@ vtkFetchMIWebServicesClient::vtkFetchMIWebServicesClient ( )
 {
   this->Name = NULL;
   this->URIHandler = NULL;
+  this->ResponseCacheLifetime = 300.0;
 }
 
 
@@ -34,6 +44,87 @@ vtkFetchMIWebServicesClient::~vtkFetchMIWebServicesClient ( )
 void vtkFetchMIWebServicesClient::PrintSelf ( ostream& os, vtkIndent indent )
 {
     this->vtkObject::PrintSelf ( os, indent );
+    os << indent << "ResponseCacheLifetime: " << this->ResponseCacheLifetime << "\n";
+    os << indent << "Number of cached responses: " << this->ResponseCache.size() << "\n";
+}
+
+
+//---------------------------------------------------------------------------
+int vtkFetchMIWebServicesClient::QueryServerForTagValues ( vtkStringArray *atts,
+                                                         vtkStringArray *responseFileNames,
+                                                         vtkIntArray *status )
+{
+  if ( atts == NULL || responseFileNames == NULL || status == NULL ||
+       atts->GetNumberOfValues() != responseFileNames->GetNumberOfValues() )
+    {
+    vtkErrorMacro ( "QueryServerForTagValues: attributes and response files don't match." );
+    return 0;
+    }
+  int succeeded = 0;
+  status->SetNumberOfValues ( atts->GetNumberOfValues() );
+  for ( vtkIdType i = 0; i < atts->GetNumberOfValues(); i++ )
+    {
+    int retval = this->QueryServerForTagValues ( atts->GetValue(i).c_str(),
+                                                 responseFileNames->GetValue(i).c_str() );
+    status->SetValue ( i, retval ? 1 : 0 );
+    succeeded += retval ? 1 : 0;
+    }
+  return succeeded;
+}
+
+
+//---------------------------------------------------------------------------
+void vtkFetchMIWebServicesClient::ClearResponseCache ( )
+{
+  this->ResponseCache.clear();
+}
+
+
+//---------------------------------------------------------------------------
+int vtkFetchMIWebServicesClient::ReadCachedResponse ( const char *query, const char *responseFileName )
+{
+  if ( query == NULL || responseFileName == NULL || this->ResponseCacheLifetime <= 0.0 )
+    {
+    return 0;
+    }
+  std::map<std::string, std::pair<double, std::string> >::iterator it =
+    this->ResponseCache.find ( query );
+  if ( it == this->ResponseCache.end() )
+    {
+    return 0;
+    }
+  if ( vtkTimerLog::GetUniversalTime() - it->second.first > this->ResponseCacheLifetime )
+    {
+    this->ResponseCache.erase ( it );
+    return 0;
+    }
+  std::ofstream response ( responseFileName, std::ios::out | std::ios::binary );
+  if ( !response )
+    {
+    return 0;
+    }
+  response << it->second.second;
+  vtkDebugMacro ( "ReadCachedResponse: reuse the response to " << query );
+  return 1;
+}
+
+
+//---------------------------------------------------------------------------
+void vtkFetchMIWebServicesClient::CacheResponse ( const char *query, const char *responseFileName )
+{
+  if ( query == NULL || responseFileName == NULL || this->ResponseCacheLifetime <= 0.0 )
+    {
+    return;
+    }
+  std::ifstream response ( responseFileName, std::ios::in | std::ios::binary );
+  if ( !response )
+    {
+    return;
+    }
+  std::stringstream content;
+  content << response.rdbuf();
+  this->ResponseCache[query] =
+    std::make_pair ( vtkTimerLog::GetUniversalTime(), content.str() );
 }
 
 
@@ -7,6 +7,12 @@
 
 // VTK includes
 #include "vtkObject.h"
+class vtkIntArray;
+class vtkStringArray;
+
+// STD includes
+#include <map>
+#include <string>
 
 #include "vtkSlicerFetchMIModuleLogicExport.h"
 
@@ -29,6 +35,16 @@ public:
   virtual int QueryServerForTags ( const char *vtkNotUsed(responseFileName) ) { return 0; };
   virtual int QueryServerForTagValues ( const char *vtkNotUsed(att),
                                         const char *vtkNotUsed(responseFilename) ) { return 0; };
+
+  // Description:
+  // Query the server for the values of all the attributes atts, the
+  // response for the nth attribute is saved in the nth response file and
+  // the nth value of status is set to 1 if the query succeeded, 0
+  // otherwise. Returns the number of successful queries. The default
+  // implementation sends the queries one after the other.
+  virtual int QueryServerForTagValues ( vtkStringArray *atts,
+                                        vtkStringArray *responseFileNames,
+                                        vtkIntArray *status );
   virtual int QueryServerForResources ( vtkTagTable *vtkNotUsed(table),
                                         const char *vtkNotUsed(responseFileName) ) { return 0; };
   virtual int DeleteResourceFromServer ( const char *vtkNotUsed(uri),
@@ -49,12 +65,33 @@ public:
 
   virtual void Download ( const char *vtkNotUsed(src), const char *vtkNotUsed(dest) ) { };
   virtual void Upload ( const char *vtkNotUsed(src), const char *vtkNotUsed(dest) ) { };
+
+  // Description:
+  // Number of seconds the responses of the server to the queries are
+  // reused instead of querying the server again, 300 by default. 0
+  // disables the cache. Clients clear the cache when they modify the
+  // server (new tag, new or deleted resource).
+  vtkSetMacro ( ResponseCacheLifetime, double );
+  vtkGetMacro ( ResponseCacheLifetime, double );
+  void ClearResponseCache ( );
   
  protected:
   vtkFetchMIWebServicesClient();
   virtual ~vtkFetchMIWebServicesClient();
   vtkURIHandler *URIHandler;
   char *Name;
+
+  // Description:
+  // Copy the cached response to query into responseFileName. Returns 0
+  // if there is no cached response or if it is too old.
+  int ReadCachedResponse ( const char *query, const char *responseFileName );
+  // Description:
+  // Cache the response to query saved in responseFileName.
+  void CacheResponse ( const char *query, const char *responseFileName );
+
+  double ResponseCacheLifetime;
+  // Time and content of the response to each query
+  std::map<std::string, std::pair<double, std::string> > ResponseCache;
   
   vtkFetchMIWebServicesClient(const vtkFetchMIWebServicesClient&); // Not implemented
   void operator=(const vtkFetchMIWebServicesClient&); // Not Implemented
@@ -1,6 +1,31 @@
 #include "vtkFetchMIWebServicesClientXND.h"
 #include "vtkXNDHandler.h"
+
+// VTK includes
+#include <vtkCallbackCommand.h>
+#include <vtkIntArray.h>
+#include <vtkNew.h>
+#include <vtkStringArray.h>
+
+// STD includes
 #include <sstream>
+#include <vector>
+
+namespace
+{
+//---------------------------------------------------------------------------
+void onQueryResponseStaged(vtkObject* vtkNotUsed(caller),
+                           unsigned long vtkNotUsed(eid),
+                           void* clientData, void* callData)
+{
+  vtkIntArray *staged = reinterpret_cast<vtkIntArray*>(clientData);
+  vtkIdType index = *reinterpret_cast<vtkIdType*>(callData);
+  if ( index >= 0 && index < staged->GetNumberOfTuples() )
+    {
+    staged->SetValue ( index, 1 );
+    }
+}
+}
 
 
 
@@ -47,9 +72,14 @@ int vtkFetchMIWebServicesClientXND::QueryServerForTags ( const char *responseFil
   q << hostname;
   q << "/tags";
   std::string query = q.str();
+  if ( this->ReadCachedResponse ( query.c_str(), responseFileName ) )
+    {
+    return 1;
+    }
   const char *errorString = h->QueryServer (query.c_str(), responseFileName );
   if ( !strcmp (errorString, "OK"))
     {
+    this->CacheResponse ( query.c_str(), responseFileName );
     return 1;
     }
   return 0;
@@ -77,9 +107,14 @@ int vtkFetchMIWebServicesClientXND::QueryServerForTags ( const char *responseFil
   q << "/search??";
   q << att;
   std::string query = q.str();
+  if ( this->ReadCachedResponse ( query.c_str(), responseFilename ) )
+    {
+    return 1;
+    }
   const char *errorString = h->QueryServer ( query.c_str(), responseFilename );
   if ( !strcmp ( errorString, "OK" ) )
     {
+    this->CacheResponse ( query.c_str(), responseFilename );
     return 1;
     }
   return 0;
@@ -87,6 +122,84 @@ int vtkFetchMIWebServicesClientXND::QueryServerForTags ( const char *responseFil
 
 
 
+//---------------------------------------------------------------------------
+int vtkFetchMIWebServicesClientXND::QueryServerForTagValues ( vtkStringArray *atts,
+                                                            vtkStringArray *responseFileNames,
+                                                            vtkIntArray *status )
+{
+  vtkXNDHandler *h = vtkXNDHandler::SafeDownCast ( this->GetURIHandler() );
+  if ( h == NULL )
+    {
+    vtkErrorMacro ( "QueryServerForTagValues: No handler set on Client.");
+    return 0;
+    }
+  if  ( h->GetHostName() == NULL )
+    {
+    vtkErrorMacro ( "QueryServerForTagValues: No host name set on URIHandler." );
+    return 0;
+    }
+  if ( atts == NULL || responseFileNames == NULL || status == NULL ||
+       atts->GetNumberOfValues() != responseFileNames->GetNumberOfValues() )
+    {
+    vtkErrorMacro ( "QueryServerForTagValues: attributes and response files don't match." );
+    return 0;
+    }
+
+  //--- the cached responses are reused, the other queries are sent
+  int succeeded = 0;
+  status->SetNumberOfValues ( atts->GetNumberOfValues() );
+  vtkNew<vtkStringArray> queries;
+  vtkNew<vtkStringArray> destinations;
+  std::vector<vtkIdType> queryAtts;
+  for ( vtkIdType i = 0; i < atts->GetNumberOfValues(); i++ )
+    {
+    std::stringstream q;
+    q << h->GetHostName();
+    q << "/search??";
+    q << atts->GetValue(i);
+    std::string query = q.str();
+    if ( this->ReadCachedResponse ( query.c_str(), responseFileNames->GetValue(i).c_str() ) )
+      {
+      status->SetValue ( i, 1 );
+      ++succeeded;
+      continue;
+      }
+    status->SetValue ( i, 0 );
+    queries->InsertNextValue ( query );
+    destinations->InsertNextValue ( responseFileNames->GetValue(i) );
+    queryAtts.push_back ( i );
+    }
+  if ( queries->GetNumberOfValues() == 0 )
+    {
+    return succeeded;
+    }
+
+  //--- the queries are plain GETs: they don't need the shared curl
+  //--- handle of the XND handler and can be sent at the same time.
+  vtkNew<vtkIntArray> staged;
+  staged->SetNumberOfValues ( queries->GetNumberOfValues() );
+  staged->FillComponent ( 0, 0 );
+  vtkNew<vtkCallbackCommand> callback;
+  callback->SetCallback ( onQueryResponseStaged );
+  callback->SetClientData ( staged.GetPointer() );
+  unsigned long tag = h->AddObserver ( vtkURIHandler::FileStagedEvent, callback.GetPointer() );
+  h->vtkHTTPHandler::StageFilesRead ( queries.GetPointer(), destinations.GetPointer() );
+  h->RemoveObserver ( tag );
+
+  for ( vtkIdType i = 0; i < queries->GetNumberOfValues(); i++ )
+    {
+    if ( staged->GetValue(i) )
+      {
+      this->CacheResponse ( queries->GetValue(i).c_str(), destinations->GetValue(i).c_str() );
+      status->SetValue ( queryAtts[i], 1 );
+      ++succeeded;
+      }
+    }
+  return succeeded;
+}
+
+
+
 //---------------------------------------------------------------------------
 void vtkFetchMIWebServicesClientXND::Download ( const char *src, const char *dest )
 {
@@ -198,9 +311,14 @@ int vtkFetchMIWebServicesClientXND::QueryServerForResources ( vtkTagTable *table
   //--- TODO: trim off the last ampersand in the query string!!!
   //---
   query = q.str();
+  if ( this->ReadCachedResponse ( query.c_str(), responseFileName ) )
+    {
+    return 1;
+    }
   const char *errorString = h->QueryServer ( query.c_str(), responseFileName );
   if ( !strcmp(errorString, "OK" ))
     {
+    this->CacheResponse ( query.c_str(), responseFileName );
     return 1;
     }
   return 0;
@@ -243,6 +361,11 @@ int vtkFetchMIWebServicesClientXND::AddTagToServer ( const char *att,
 
   //--- do the post
   int retval = h->PostTag ( h->GetHostName(), att, responseFileName );
+  if ( retval )
+    {
+    //--- the tags and their values have changed
+    this->ClearResponseCache();
+    }
 
   //--- return 1 if successful, 0 if not
   return (retval );
@@ -282,6 +405,10 @@ int vtkFetchMIWebServicesClientXND::DeleteResourceFromServer ( const char *uri,
     }
 
   int retval = h->DeleteResource ( uri, responseFileName );
+  if ( retval )
+    {
+    this->ClearResponseCache();
+    }
 
   //--- returns 1 if successful, 0 if not.
   return ( retval );
@@ -342,6 +469,10 @@ int vtkFetchMIWebServicesClientXND::CreateNewURIForResource( const char *resourc
                                       resourceName,
                                       uploadFileName,
                                       responseFileName );
+  if ( retval )
+    {
+    this->ClearResponseCache();
+    }
   //--- return 1 if successful, 0 if not
   return (retval );
 }
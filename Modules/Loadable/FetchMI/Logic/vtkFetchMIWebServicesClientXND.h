@@ -20,6 +20,12 @@ public:
 
   virtual int QueryServerForTags ( const char *responseFileName );
   virtual int QueryServerForTagValues ( const char *att, const char *responseFilename );
+  // Description:
+  // Send all the queries at the same time with the curl multi interface
+  // of vtkHTTPHandler.
+  virtual int QueryServerForTagValues ( vtkStringArray *atts,
+                                        vtkStringArray *responseFileNames,
+                                        vtkIntArray *status );
   virtual int QueryServerForResources ( vtkTagTable *table, const char *responseFileName );
   virtual int DeleteResourceFromServer ( const char *uri, const char *responseFileName );
 
@@ -19,10 +19,12 @@
 #include <vtkMRMLFreeSurferModelStorageNode.h>
 #include <vtkMRMLModelDisplayNode.h>
 #include <vtkMRMLModelNode.h>
+#include <vtkMRMLModelStorageNode.h>
 #include <vtkMRMLTransformNode.h>
 
 /// VTK includes
 #include <vtkGeneralTransform.h>
+#include <vtkMultiThreader.h>
 #include <vtkNew.h>
 #include <vtkPolyDataNormals.h>
 #include <vtkSmartPointer.h>
@@ -33,7 +35,27 @@
 #include <itksys/SystemTools.hxx>
 
 /// STD includes
+#include <algorithm>
 #include <cassert>
+#include <vector>
+
+//----------------------------------------------------------------------------
+namespace
+{
+VTK_THREAD_RETURN_TYPE PreloadModelFiles(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info =
+    static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  const std::vector<std::string>* fileNames =
+    static_cast<std::vector<std::string>*>(info->UserData);
+  for (size_t i = info->ThreadID; i < fileNames->size();
+       i += info->NumberOfThreads)
+    {
+    vtkMRMLModelStorageNode::PreloadFile((*fileNames)[i].c_str());
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+}
 
 vtkCxxRevisionMacro(vtkSlicerModelsLogic, "$Revision$");
 vtkStandardNewMacro(vtkSlicerModelsLogic);
@@ -44,6 +66,7 @@ vtkSlicerModelsLogic::vtkSlicerModelsLogic()
 {
   this->ActiveModelNode = NULL;
   this->ColorLogic = NULL;
+  this->DeferScalarOverlays = false;
 }
 
 //----------------------------------------------------------------------------
@@ -111,7 +134,7 @@ int vtkSlicerModelsLogic::AddModels (const char* dirname, const char* suffix )
   dir.Load(dirname);
 
   int nfiles = dir.GetNumberOfFiles();
-  int res = 1;
+  std::vector<std::string> fullPaths;
   for (int i=0; i<nfiles; i++) {
     const char* filename = dir.GetFile(i);
     std::string sname = filename;
@@ -119,15 +142,31 @@ int vtkSlicerModelsLogic::AddModels (const char* dirname, const char* suffix )
       {
       if ( sname.find(ssuf) != std::string::npos )
         {
-        std::string fullPath = std::string(dir.GetPath())
-            + "/" + filename;
-        if (this->AddModel(fullPath.c_str()) == NULL)
-          {
-          res = 0;
-          }
+        fullPaths.push_back(std::string(dir.GetPath()) + "/" + filename);
         }
       }
   }
+
+  // Read the models in parallel, AddModel() then takes the preloaded
+  // polydata.
+  if (fullPaths.size() > 1)
+    {
+    vtkNew<vtkMultiThreader> threader;
+    threader->SetNumberOfThreads(std::min(
+      threader->GetNumberOfThreads(), static_cast<int>(fullPaths.size())));
+    threader->SetSingleMethod(PreloadModelFiles, &fullPaths);
+    threader->SingleMethodExecute();
+    }
+
+  int res = 1;
+  for (size_t i = 0; i < fullPaths.size(); ++i)
+    {
+    if (this->AddModel(fullPaths[i].c_str()) == NULL)
+      {
+      res = 0;
+      }
+    }
+  vtkMRMLModelStorageNode::ReleasePreloadedFiles();
   return res;
 }
 
@@ -286,6 +325,7 @@ void vtkSlicerModelsLogic::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "vtkSlicerModelsLogic:             " << this->GetClassName() << "\n";
   os << indent << "ActiveModelNode: " <<
     (this->ActiveModelNode ? this->ActiveModelNode->GetName() : "(none)") << "\n";
+  os << indent << "DeferScalarOverlays: " << this->DeferScalarOverlays << "\n";
   if (this->ColorLogic)
     {
     os << indent << "ColorLogic: ";
@@ -304,6 +344,7 @@ vtkMRMLStorageNode* vtkSlicerModelsLogic::AddScalar(const char* filename, vtkMRM
     }
 
   vtkMRMLFreeSurferModelOverlayStorageNode *fsmoStorageNode = vtkMRMLFreeSurferModelOverlayStorageNode::New();
+  fsmoStorageNode->SetDeferRead(this->DeferScalarOverlays);
   vtkMRMLStorageNode *storageNode = NULL;
 
   // check for local or remote files
@@ -70,6 +70,14 @@ class VTK_SLICER_MODELS_MODULE_LOGIC_EXPORT vtkSlicerModelsLogic
   /// Read in a scalar overlay and add it to the model node
   vtkMRMLStorageNode* AddScalar(const char* filename, vtkMRMLModelNode *modelNode);
 
+  /// If true, the scalar overlays added by AddScalar() are only read when
+  /// they are displayed: a model with many overlays only keeps the array of
+  /// its active scalars in memory. False by default.
+  /// \sa vtkMRMLFreeSurferModelOverlayStorageNode::SetDeferRead()
+  vtkSetMacro(DeferScalarOverlays, bool);
+  vtkGetMacro(DeferScalarOverlays, bool);
+  vtkBooleanMacro(DeferScalarOverlays, bool);
+
   /// Transfor models's polydata
   static void TransformModel(vtkMRMLTransformNode *tnode, 
                               vtkMRMLModelNode *modelNode, 
@@ -98,6 +106,8 @@ protected:
   /// Color logic
   vtkMRMLColorLogic* ColorLogic;
 
+  bool DeferScalarOverlays;
+
 };
 
 #endif
@@ -0,0 +1,561 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Tractography includes
+#include "vtkExtractPolyDataFibers.h"
+
+// VTK includes
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkDataArray.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkMultiThreader.h>
+#include <vtkObjectFactory.h>
+#include <vtkPlanes.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+#include <vtkWeakPointer.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+//----------------------------------------------------------------------------
+vtkCxxRevisionMacro(vtkExtractPolyDataFibers, "$Revision$");
+vtkStandardNewMacro(vtkExtractPolyDataFibers);
+
+//----------------------------------------------------------------------------
+namespace
+{
+/// Below this number of bins per thread, less threads are used
+const vtkIdType BinsPerThread = 256;
+
+//----------------------------------------------------------------------------
+/// Consecutive points of a fiber that are in the same bin: the point ids
+/// in the connectivity of the lines from First to First+Count-1
+struct FiberRun
+{
+  vtkIdType Fiber;
+  vtkIdType First;
+  vtkIdType Count;
+};
+
+//----------------------------------------------------------------------------
+/// The points of the lines of a polydata binned in a regular grid, as runs
+/// of the fibers, with the bounds of the points of each bin.
+struct FiberGrid
+{
+  FiberGrid() : MTime(0), LinesMTime(0), PointsPerBin(0) {}
+  void Build(vtkPolyData* polyData, int pointsPerBin);
+  bool IsUpToDate(vtkPolyData* polyData, int pointsPerBin) const
+  {
+    return this->PolyData.GetPointer() == polyData &&
+      this->MTime == polyData->GetMTime() &&
+      this->LinesMTime == polyData->GetLines()->GetMTime() &&
+      this->PointsPerBin == pointsPerBin;
+  }
+
+  vtkWeakPointer<vtkPolyData> PolyData;
+  unsigned long MTime;
+  unsigned long LinesMTime;
+  int PointsPerBin;
+  /// Location in the connectivity of the lines of the fiber i
+  std::vector<vtkIdType> FiberLocations;
+  /// Only the bins that have points are kept, the runs of the bin b are
+  /// Runs[RunOffsets[b]] to Runs[RunOffsets[b+1]-1] and its bounds are
+  /// BinBounds[6*b] to BinBounds[6*b+5]
+  std::vector<vtkIdType> RunOffsets;
+  std::vector<FiberRun> Runs;
+  std::vector<double> BinBounds;
+};
+
+//----------------------------------------------------------------------------
+void FiberGrid::Build(vtkPolyData* polyData, int pointsPerBin)
+{
+  this->PolyData = polyData;
+  this->MTime = polyData->GetMTime();
+  this->LinesMTime = polyData->GetLines()->GetMTime();
+  this->PointsPerBin = pointsPerBin;
+  std::vector<vtkIdType>().swap(this->FiberLocations);
+  std::vector<vtkIdType>(1, 0).swap(this->RunOffsets);
+  std::vector<FiberRun>().swap(this->Runs);
+  std::vector<double>().swap(this->BinBounds);
+
+  vtkPoints* points = polyData->GetPoints();
+  vtkCellArray* lines = polyData->GetLines();
+  if (!points || points->GetNumberOfPoints() == 0 || lines->GetNumberOfCells() == 0)
+    {
+    return;
+    }
+  const vtkIdType* connectivity = lines->GetPointer();
+  vtkIdType size = lines->GetNumberOfConnectivityEntries();
+  vtkIdType numberOfLinePoints = 0;
+  for (vtkIdType location = 0; location < size; location += connectivity[location] + 1)
+    {
+    this->FiberLocations.push_back(location);
+    numberOfLinePoints += connectivity[location];
+    }
+  vtkIdType numberOfFibers = static_cast<vtkIdType>(this->FiberLocations.size());
+
+  // a grid over the bounds of the points with about pointsPerBin points
+  // per bin, the bins are as cubic as the axes of the bounds that are
+  // not flat allow
+  double bounds[6];
+  points->GetBounds(bounds);
+  double extents[3];
+  double measure = 1.;
+  int numberOfAxes = 0;
+  for (int i = 0; i < 3; ++i)
+    {
+    extents[i] = bounds[2*i+1] - bounds[2*i];
+    if (extents[i] > 0.)
+      {
+      measure *= extents[i];
+      ++numberOfAxes;
+      }
+    }
+  double numberOfBins = std::max(1., static_cast<double>(numberOfLinePoints) / pointsPerBin);
+  double binsPerLength = (numberOfAxes > 0) ?
+    pow(numberOfBins / measure, 1. / numberOfAxes) : 0.;
+  int dims[3];
+  for (int i = 0; i < 3; ++i)
+    {
+    dims[i] = static_cast<int>(std::min(1024., std::max(1., extents[i] * binsPerLength)));
+    }
+  vtkIdType totalBins = static_cast<vtkIdType>(dims[0]) * dims[1] * dims[2];
+
+  // the runs are counted, then stored, per bin. The bins of the points
+  // are computed twice rather than kept for all the points.
+  std::vector<vtkIdType> runCounts(totalBins + 1, 0);
+  std::vector<double> binBounds;
+  for (int pass = 0; pass < 2; ++pass)
+    {
+    for (vtkIdType fiber = 0; fiber < numberOfFibers; ++fiber)
+      {
+      vtkIdType location = this->FiberLocations[fiber];
+      vtkIdType npts = connectivity[location];
+      vtkIdType previousBin = -1;
+      FiberRun* run = 0;
+      for (vtkIdType p = location + 1; p <= location + npts; ++p)
+        {
+        double x[3];
+        points->GetPoint(connectivity[p], x);
+        vtkIdType bin = 0;
+        for (int i = 2; i >= 0; --i)
+          {
+          int index = 0;
+          if (extents[i] > 0.)
+            {
+            double position = (x[i] - bounds[2*i]) / extents[i] * dims[i];
+            index = std::max(0, std::min(dims[i] - 1, static_cast<int>(position)));
+            }
+          bin = bin * dims[i] + index;
+          }
+        if (pass == 0)
+          {
+          if (bin != previousBin)
+            {
+            ++runCounts[bin + 1];
+            }
+          previousBin = bin;
+          continue;
+          }
+        if (bin != previousBin)
+          {
+          run = &this->Runs[runCounts[bin]++];
+          run->Fiber = fiber;
+          run->First = p;
+          run->Count = 0;
+          }
+        ++run->Count;
+        previousBin = bin;
+        double* pointBinBounds = &binBounds[6 * bin];
+        for (int i = 0; i < 3; ++i)
+          {
+          pointBinBounds[2*i] = std::min(pointBinBounds[2*i], x[i]);
+          pointBinBounds[2*i+1] = std::max(pointBinBounds[2*i+1], x[i]);
+          }
+        }
+      }
+    if (pass == 0)
+      {
+      for (vtkIdType bin = 0; bin < totalBins; ++bin)
+        {
+        runCounts[bin + 1] += runCounts[bin];
+        }
+      this->Runs.resize(runCounts[totalBins]);
+      binBounds.resize(6 * totalBins);
+      for (vtkIdType bin = 0; bin < totalBins; ++bin)
+        {
+        for (int i = 0; i < 3; ++i)
+          {
+          binBounds[6*bin + 2*i] = VTK_DOUBLE_MAX;
+          binBounds[6*bin + 2*i + 1] = -VTK_DOUBLE_MAX;
+          }
+        }
+      }
+    }
+
+  // after the second pass runCounts[bin] is the end of the runs of bin,
+  // keep the bins that have runs
+  vtkIdType begin = 0;
+  for (vtkIdType bin = 0; bin < totalBins; ++bin)
+    {
+    vtkIdType end = runCounts[bin];
+    if (end == begin)
+      {
+      continue;
+      }
+    this->RunOffsets.push_back(end);
+    this->BinBounds.insert(this->BinBounds.end(),
+                           binBounds.begin() + 6 * bin, binBounds.begin() + 6 * bin + 6);
+    begin = end;
+    }
+}
+}
+
+//----------------------------------------------------------------------------
+class vtkExtractPolyDataFibers::vtkInternal
+{
+public:
+  vtkInternal() : Generation(0) {}
+
+  FiberGrid Grid;
+
+  /// State of the current RequestData()
+  vtkPoints* Points;
+  const vtkIdType* Connectivity;
+  std::vector<double> Normals;
+  std::vector<double> Offsets;
+  /// Fibers which points are in the region, found by each thread
+  std::vector<std::vector<vtkIdType> > ThreadFibers;
+
+  /// Selected fibers, reused from one RequestData() to the next
+  std::vector<unsigned char> Selected;
+  /// Output id of the input points, valid when their stamp is Generation
+  std::vector<vtkIdType> PointMap;
+  std::vector<unsigned int> PointStamps;
+  unsigned int Generation;
+
+  /// The implicit function of the planes at x, as vtkPlanes computes it
+  double Evaluate(const double x[3]) const
+  {
+    double value = -VTK_DOUBLE_MAX;
+    for (size_t i = 0; i < this->Offsets.size(); ++i)
+      {
+      const double* n = &this->Normals[3 * i];
+      value = std::max(value, n[0] * x[0] + n[1] * x[1] + n[2] * x[2] - this->Offsets[i]);
+      }
+    return value;
+  }
+};
+
+//----------------------------------------------------------------------------
+static VTK_THREAD_RETURN_TYPE vtkExtractPolyDataFibers_ThreadedSelect( void *arg )
+{
+  vtkMultiThreader::ThreadInfo *info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  vtkExtractPolyDataFibers *self = static_cast<vtkExtractPolyDataFibers *>(info->UserData);
+  self->ThreadedSelect(info->ThreadID, info->NumberOfThreads);
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+vtkExtractPolyDataFibers::vtkExtractPolyDataFibers()
+{
+  this->Planes = 0;
+  this->ExtractInside = 1;
+  this->PointsPerBin = 32;
+  this->MultiThreader = vtkMultiThreader::New();
+  this->NumberOfThreads = this->MultiThreader->GetNumberOfThreads();
+  this->Internal = new vtkInternal;
+  this->Internal->Points = 0;
+  this->Internal->Connectivity = 0;
+}
+
+//----------------------------------------------------------------------------
+vtkExtractPolyDataFibers::~vtkExtractPolyDataFibers()
+{
+  this->SetPlanes(0);
+  this->MultiThreader->Delete();
+  delete this->Internal;
+}
+
+//----------------------------------------------------------------------------
+vtkCxxSetObjectMacro(vtkExtractPolyDataFibers, Planes, vtkPlanes);
+
+//----------------------------------------------------------------------------
+unsigned long vtkExtractPolyDataFibers::GetMTime()
+{
+  unsigned long mTime = this->Superclass::GetMTime();
+  if (this->Planes)
+    {
+    mTime = std::max(mTime, this->Planes->GetMTime());
+    }
+  return mTime;
+}
+
+//----------------------------------------------------------------------------
+int vtkExtractPolyDataFibers::RequestData(vtkInformation* vtkNotUsed(request),
+                                          vtkInformationVector** inputVector,
+                                          vtkInformationVector* outputVector)
+{
+  vtkPolyData* input = vtkPolyData::GetData(inputVector[0]);
+  vtkPolyData* output = vtkPolyData::GetData(outputVector);
+  if (!input || !output)
+    {
+    return 0;
+    }
+  if (!this->Planes)
+    {
+    vtkErrorMacro(<< "RequestData: no planes to extract the fibers with");
+    return 0;
+    }
+  if (!input->GetPoints())
+    {
+    return 1;
+    }
+
+  vtkInternal* internal = this->Internal;
+  if (!internal->Grid.IsUpToDate(input, this->PointsPerBin))
+    {
+    internal->Grid.Build(input, this->PointsPerBin);
+    }
+  const FiberGrid& grid = internal->Grid;
+  internal->Points = input->GetPoints();
+  internal->Connectivity = input->GetLines()->GetPointer();
+
+  int numberOfPlanes = this->Planes->GetNumberOfPlanes();
+  vtkPoints* planePoints = this->Planes->GetPoints();
+  vtkDataArray* planeNormals = this->Planes->GetNormals();
+  internal->Normals.resize(3 * numberOfPlanes);
+  internal->Offsets.resize(numberOfPlanes);
+  for (int i = 0; i < numberOfPlanes; ++i)
+    {
+    double origin[3];
+    double* normal = &internal->Normals[3 * i];
+    planePoints->GetPoint(i, origin);
+    planeNormals->GetTuple(i, normal);
+    internal->Offsets[i] = normal[0] * origin[0] + normal[1] * origin[1] +
+      normal[2] * origin[2];
+    }
+
+  // fibers that have a point in the region
+  vtkIdType numberOfFibers = static_cast<vtkIdType>(grid.FiberLocations.size());
+  internal->Selected.assign(numberOfFibers, 0);
+  if (numberOfPlanes == 0)
+    {
+    // no plane, the whole space is inside
+    internal->Selected.assign(numberOfFibers, 1);
+    }
+  else
+    {
+    vtkIdType numberOfBins = static_cast<vtkIdType>(grid.RunOffsets.size()) - 1;
+    int numberOfThreads = static_cast<int>(std::min(
+      static_cast<vtkIdType>(this->NumberOfThreads),
+      numberOfBins / BinsPerThread + 1));
+    internal->ThreadFibers.resize(numberOfThreads);
+    if (numberOfThreads > 1)
+      {
+      this->MultiThreader->SetNumberOfThreads(numberOfThreads);
+      this->MultiThreader->SetSingleMethod(vtkExtractPolyDataFibers_ThreadedSelect, this);
+      this->MultiThreader->SingleMethodExecute();
+      }
+    else
+      {
+      this->ThreadedSelect(0, 1);
+      }
+    for (int thread = 0; thread < numberOfThreads; ++thread)
+      {
+      const std::vector<vtkIdType>& fibers = internal->ThreadFibers[thread];
+      for (size_t i = 0; i < fibers.size(); ++i)
+        {
+        internal->Selected[fibers[i]] = 1;
+        }
+      }
+    std::vector<std::vector<vtkIdType> >().swap(internal->ThreadFibers);
+    }
+  if (!this->ExtractInside)
+    {
+    for (vtkIdType fiber = 0; fiber < numberOfFibers; ++fiber)
+      {
+      internal->Selected[fiber] = !internal->Selected[fiber];
+      }
+    }
+
+  // copy the selected fibers and the points they use, in the input order
+  vtkIdType numberOfPoints = input->GetNumberOfPoints();
+  if (static_cast<vtkIdType>(internal->PointMap.size()) != numberOfPoints)
+    {
+    internal->PointMap.resize(numberOfPoints);
+    internal->PointStamps.assign(numberOfPoints, 0);
+    internal->Generation = 0;
+    }
+  if (++internal->Generation == 0)
+    {
+    internal->PointStamps.assign(numberOfPoints, 0);
+    internal->Generation = 1;
+    }
+  const vtkIdType* connectivity = internal->Connectivity;
+  std::vector<vtkIdType> outputPoints;
+  vtkIdType numberOfSelectedFibers = 0;
+  vtkIdType connectivitySize = 0;
+  for (vtkIdType fiber = 0; fiber < numberOfFibers; ++fiber)
+    {
+    if (!internal->Selected[fiber])
+      {
+      continue;
+      }
+    vtkIdType location = grid.FiberLocations[fiber];
+    vtkIdType npts = connectivity[location];
+    for (vtkIdType p = location + 1; p <= location + npts; ++p)
+      {
+      vtkIdType pointId = connectivity[p];
+      if (internal->PointStamps[pointId] != internal->Generation)
+        {
+        internal->PointStamps[pointId] = internal->Generation;
+        internal->PointMap[pointId] = static_cast<vtkIdType>(outputPoints.size());
+        outputPoints.push_back(pointId);
+        }
+      }
+    ++numberOfSelectedFibers;
+    connectivitySize += npts + 1;
+    }
+
+  vtkPointData* inPD = input->GetPointData();
+  vtkPointData* outPD = output->GetPointData();
+  vtkCellData* inCD = input->GetCellData();
+  vtkCellData* outCD = output->GetCellData();
+  vtkIdType numberOfOutputPoints = static_cast<vtkIdType>(outputPoints.size());
+  vtkSmartPointer<vtkPoints> newPoints = vtkSmartPointer<vtkPoints>::New();
+  newPoints->SetDataType(input->GetPoints()->GetDataType());
+  newPoints->SetNumberOfPoints(numberOfOutputPoints);
+  outPD->CopyAllocate(inPD, numberOfOutputPoints);
+  for (vtkIdType i = 0; i < numberOfOutputPoints; ++i)
+    {
+    newPoints->SetPoint(i, input->GetPoint(outputPoints[i]));
+    outPD->CopyData(inPD, outputPoints[i], i);
+    }
+
+  vtkSmartPointer<vtkCellArray> newLines = vtkSmartPointer<vtkCellArray>::New();
+  newLines->Allocate(connectivitySize);
+  outCD->CopyAllocate(inCD, numberOfSelectedFibers);
+  vtkIdType firstLineId = input->GetNumberOfVerts();
+  for (vtkIdType fiber = 0; fiber < numberOfFibers; ++fiber)
+    {
+    if (!internal->Selected[fiber])
+      {
+      continue;
+      }
+    vtkIdType location = grid.FiberLocations[fiber];
+    vtkIdType npts = connectivity[location];
+    vtkIdType lineId = newLines->InsertNextCell(npts);
+    for (vtkIdType p = location + 1; p <= location + npts; ++p)
+      {
+      newLines->InsertCellPoint(internal->PointMap[connectivity[p]]);
+      }
+    outCD->CopyData(inCD, firstLineId + fiber, lineId);
+    }
+
+  output->SetPoints(newPoints);
+  output->SetLines(newLines);
+  output->Squeeze();
+
+  internal->Points = 0;
+  internal->Connectivity = 0;
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+// Look for the fibers that have a point in the region in a share of the
+// bins. With ExtractInside, a point on the planes is outside, otherwise
+// it is inside, as vtkExtractPolyDataGeometry does.
+void vtkExtractPolyDataFibers::ThreadedSelect(int threadId, int numberOfThreads)
+{
+  const vtkInternal* internal = this->Internal;
+  const FiberGrid& grid = internal->Grid;
+  std::vector<vtkIdType>& fibers = this->Internal->ThreadFibers[threadId];
+  fibers.clear();
+  vtkIdType numberOfBins = static_cast<vtkIdType>(grid.RunOffsets.size()) - 1;
+  vtkIdType firstBin = numberOfBins * threadId / numberOfThreads;
+  vtkIdType lastBin = numberOfBins * (threadId + 1) / numberOfThreads;
+  size_t numberOfPlanes = internal->Offsets.size();
+  bool strict = (this->ExtractInside != 0);
+
+  for (vtkIdType b = firstBin; b < lastBin; ++b)
+    {
+    // range of the function over the bounds of the bin: its maximum is
+    // the largest maximum of the planes, its minimum is at least the
+    // largest minimum of the planes
+    const double* bounds = &grid.BinBounds[6 * b];
+    double lower = -VTK_DOUBLE_MAX;
+    double upper = -VTK_DOUBLE_MAX;
+    for (size_t i = 0; i < numberOfPlanes; ++i)
+      {
+      const double* n = &internal->Normals[3 * i];
+      double distance = -internal->Offsets[i];
+      double radius = 0.;
+      for (int j = 0; j < 3; ++j)
+        {
+        distance += n[j] * 0.5 * (bounds[2*j] + bounds[2*j+1]);
+        radius += fabs(n[j]) * 0.5 * (bounds[2*j+1] - bounds[2*j]);
+        }
+      lower = std::max(lower, distance - radius);
+      upper = std::max(upper, distance + radius);
+      }
+    // look at the points of the bins that touch the planes despite the
+    // rounding errors
+    double tolerance = 1e-9 * (fabs(lower) + fabs(upper)) + VTK_DBL_EPSILON;
+    if (lower > tolerance)
+      {
+      continue;
+      }
+    bool inside = (upper < -tolerance);
+    for (vtkIdType r = grid.RunOffsets[b]; r < grid.RunOffsets[b + 1]; ++r)
+      {
+      const FiberRun& run = grid.Runs[r];
+      if (!fibers.empty() && fibers.back() == run.Fiber)
+        {
+        continue;
+        }
+      bool found = inside;
+      for (vtkIdType p = run.First; !found && p < run.First + run.Count; ++p)
+        {
+        double x[3];
+        internal->Points->GetPoint(internal->Connectivity[p], x);
+        double value = internal->Evaluate(x);
+        found = strict ? (value < 0.) : (value <= 0.);
+        }
+      if (found)
+        {
+        fibers.push_back(run.Fiber);
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkExtractPolyDataFibers::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+
+  os << indent << "Planes: " << this->Planes << "\n";
+  os << indent << "ExtractInside: " << this->ExtractInside << "\n";
+  os << indent << "PointsPerBin: " << this->PointsPerBin << "\n";
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << "\n";
+}
@@ -0,0 +1,104 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkExtractPolyDataFibers_h
+#define __vtkExtractPolyDataFibers_h
+
+// Tractography includes
+#include "vtkSlicerTractographyDisplayModuleMRMLExport.h"
+
+// VTK includes
+#include <vtkPolyDataAlgorithm.h>
+
+class vtkMultiThreader;
+class vtkPlanes;
+
+/// \brief Extract the fibers of a bundle that go through a region.
+///
+/// It selects the same lines as vtkExtractPolyDataGeometry with planes:
+/// with ExtractInside on, the lines that have a point inside the planes
+/// (ExtractBoundaryCells on), with ExtractInside off, the lines that have
+/// all their points outside (ExtractBoundaryCells off). The unused points
+/// are not copied to the output.
+/// The points of the lines are binned once per input and MTime in a grid
+/// that keeps, for each bin, the runs of consecutive points of a line that
+/// fall into it. When the planes move, the bins that are entirely inside or
+/// outside the region select or skip their lines without looking at their
+/// points, only the points of the bins crossed by the planes are evaluated.
+/// The bins are shared out between threads.
+/// Only the lines of the input are extracted.
+class VTK_SLICER_TRACTOGRAPHYDISPLAY_MODULE_MRML_EXPORT vtkExtractPolyDataFibers
+  : public vtkPolyDataAlgorithm
+{
+public:
+  static vtkExtractPolyDataFibers *New();
+  vtkTypeRevisionMacro(vtkExtractPolyDataFibers,vtkPolyDataAlgorithm);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  ///
+  /// Region to extract the fibers of
+  virtual void SetPlanes(vtkPlanes* planes);
+  vtkGetObjectMacro(Planes, vtkPlanes);
+
+  ///
+  /// Extract the fibers that have a point inside the planes (default)
+  /// or the fibers that are entirely outside
+  vtkSetMacro(ExtractInside, int);
+  vtkGetMacro(ExtractInside, int);
+  vtkBooleanMacro(ExtractInside, int);
+
+  ///
+  /// Average number of points per bin of the grid, 32 by default.
+  /// Changing it bins the points again.
+  vtkSetClampMacro(PointsPerBin, int, 1, VTK_INT_MAX);
+  vtkGetMacro(PointsPerBin, int);
+
+  ///
+  /// Maximum number of threads used to visit the bins
+  vtkSetClampMacro(NumberOfThreads, int, 1, VTK_MAX_THREADS);
+  vtkGetMacro(NumberOfThreads, int);
+
+  ///
+  /// Take the planes into account
+  virtual unsigned long GetMTime();
+
+  ///
+  /// Look for the fibers in the share of the bins of a thread,
+  /// called by RequestData()
+  void ThreadedSelect(int threadId, int numberOfThreads);
+
+protected:
+  vtkExtractPolyDataFibers();
+  ~vtkExtractPolyDataFibers();
+
+  virtual int RequestData(vtkInformation* request,
+                          vtkInformationVector** inputVector,
+                          vtkInformationVector* outputVector);
+
+  vtkPlanes* Planes;
+  int ExtractInside;
+  int PointsPerBin;
+  int NumberOfThreads;
+  vtkMultiThreader* MultiThreader;
+
+  class vtkInternal;
+  vtkInternal* Internal;
+
+private:
+  vtkExtractPolyDataFibers(const vtkExtractPolyDataFibers&);  /// Not implemented.
+  void operator=(const vtkExtractPolyDataFibers&);  /// Not implemented.
+};
+
+#endif
@@ -15,7 +15,6 @@ Version:   $Revision: 1.3 $
 // VTK includes
 #include <vtkCleanPolyData.h>
 #include <vtkCommand.h>
-#include <vtkExtractPolyDataGeometry.h>
 #include <vtkExtractSelectedPolyDataIds.h>
 #include <vtkIdTypeArray.h>
 #include <vtkInformation.h>
@@ -25,6 +24,7 @@ Version:   $Revision: 1.3 $
 #include <vtkSelectionNode.h>
 
 // TractographyMRML includes
+#include "vtkExtractPolyDataFibers.h"
 #include "vtkMRMLFiberBundleGlyphDisplayNode.h"
 #include "vtkMRMLFiberBundleLineDisplayNode.h"
 #include "vtkMRMLFiberBundleNode.h"
@@ -58,13 +58,12 @@ vtkMRMLFiberBundleNode::vtkMRMLFiberBundleNode()
   this->ShuffledIds = 0;
   this->ExtractSelectedPolyDataIds = 0;
   this->CleanPolyDataPostSubsampling = 0;
-  this->CleanPolyDataPostROISelection = 0;
   this->SubsamplingRatio = 0;
   this->SelectWithAnnotationNode = 0;
   this->SelectionWithAnnotationNodeMode = vtkMRMLFiberBundleNode::PositiveAnnotationNodeSelection;
   this->AnnotationNode = 0;
   this->AnnotationNodeID = 0;
-  this->ExtractPolyDataGeometry = 0;
+  this->ExtractPolyDataFibers = 0;
   this->Planes = 0;
   this->SelectWithAnnotationNode = 0;
   this->EnableShuffleIDs = 1;
@@ -257,7 +256,7 @@ vtkPolyData* vtkMRMLFiberBundleNode::GetFilteredPolyData()
 {
   if (this->SelectWithAnnotationNode)
     {
-    return this->CleanPolyDataPostROISelection->GetOutput();
+    return this->ExtractPolyDataFibers->GetOutput();
     }
   else
     {
@@ -478,11 +477,9 @@ void vtkMRMLFiberBundleNode::SetSelectionWithAnnotationNodeMode(int _arg)
 
     if (_arg == vtkMRMLFiberBundleNode::PositiveAnnotationNodeSelection)
     {
-      this->ExtractPolyDataGeometry->ExtractInsideOn();
-      this->ExtractPolyDataGeometry->ExtractBoundaryCellsOn();
+      this->ExtractPolyDataFibers->ExtractInsideOn();
     } else if (_arg == vtkMRMLFiberBundleNode::NegativeAnnotationNodeSelection) {
-      this->ExtractPolyDataGeometry->ExtractInsideOff();
-      this->ExtractPolyDataGeometry->ExtractBoundaryCellsOff();
+      this->ExtractPolyDataFibers->ExtractInsideOff();
     }
 
     this->Modified();
@@ -632,25 +629,19 @@ void vtkMRMLFiberBundleNode::PrepareROISelection()
   this->AnnotationNode = NULL;
   this->AnnotationNodeID = NULL;
 
-  this->ExtractPolyDataGeometry = vtkExtractPolyDataGeometry::New();
+  // the fibers are indexed once per subsampling, moving the ROI only
+  // visits the fibers near its faces. The unused points are not copied,
+  // no cleaning is needed after the selection.
+  this->ExtractPolyDataFibers = vtkExtractPolyDataFibers::New();
   this->Planes = vtkPlanes::New();
 
-  this->ExtractPolyDataGeometry->ExtractInsideOn();
-  this->ExtractPolyDataGeometry->ExtractBoundaryCellsOn();
-  this->ExtractPolyDataGeometry->SetInputConnection(
+  this->ExtractPolyDataFibers->ExtractInsideOn();
+  this->ExtractPolyDataFibers->SetPlanes(this->Planes);
+  this->ExtractPolyDataFibers->SetInputConnection(
     this->CleanPolyDataPostSubsampling->GetOutputPort());
 
   this->SelectionWithAnnotationNodeMode = vtkMRMLFiberBundleNode::PositiveAnnotationNodeSelection;
 
-  this->CleanPolyDataPostROISelection = vtkCleanPolyData::New();
-  this->CleanPolyDataPostROISelection->ConvertLinesToPointsOff();
-  this->CleanPolyDataPostROISelection->ConvertPolysToLinesOff();
-  this->CleanPolyDataPostROISelection->ConvertStripsToPolysOff();
-  this->CleanPolyDataPostROISelection->PointMergingOff();
-
-  this->CleanPolyDataPostROISelection->SetInputConnection(
-    this->ExtractPolyDataGeometry->GetOutputPort());
-
   this->SelectWithAnnotationNode = 0;
 }
 
@@ -662,7 +653,6 @@ void vtkMRMLFiberBundleNode::UpdateROISelection()
   if (AnnotationROI)
     {
     AnnotationROI->GetTransformedPlanes(this->Planes);
-    this->ExtractPolyDataGeometry->SetImplicitFunction(this->Planes);
     }
   if (this->GetSelectWithAnnotationNode())
     {
@@ -675,8 +665,7 @@ void vtkMRMLFiberBundleNode::UpdateROISelection()
 void vtkMRMLFiberBundleNode::CleanROISelection()
 {
   this->SetAndObserveAnnotationNodeID(NULL);
-  this->CleanPolyDataPostROISelection->Delete();
-  this->ExtractPolyDataGeometry->Delete();
+  this->ExtractPolyDataFibers->Delete();
   this->Planes->Delete();
 }
 
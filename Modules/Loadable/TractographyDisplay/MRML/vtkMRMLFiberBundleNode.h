@@ -32,7 +32,7 @@ class vtkMRMLFiberBundleDisplayNode;
 class vtkExtractSelectedPolyDataIds;
 class vtkMRMLAnnotationNode;
 class vtkIdTypeArray;
-class vtkExtractPolyDataGeometry;
+class vtkExtractPolyDataFibers;
 class vtkPlanes;
 class vtkCleanPolyData;
 
@@ -224,7 +224,6 @@ protected:
 
   vtkExtractSelectedPolyDataIds* ExtractSelectedPolyDataIds;
   vtkCleanPolyData* CleanPolyDataPostSubsampling;
-  vtkCleanPolyData* CleanPolyDataPostROISelection;
   float SubsamplingRatio;
 
   virtual void PrepareSubsampling();
@@ -238,7 +237,7 @@ protected:
 
   vtkMRMLAnnotationNode *AnnotationNode;
   char *AnnotationNodeID;
-  vtkExtractPolyDataGeometry *ExtractPolyDataGeometry;
+  vtkExtractPolyDataFibers *ExtractPolyDataFibers;
   vtkPlanes *Planes;
 
   virtual void PrepareROISelection();
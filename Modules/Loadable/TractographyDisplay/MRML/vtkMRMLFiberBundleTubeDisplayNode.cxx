@@ -45,6 +45,7 @@ vtkMRMLFiberBundleTubeDisplayNode::vtkMRMLFiberBundleTubeDisplayNode()
   this->TubeFilter = vtkTubeFilter::New();
   this->TubeNumberOfSides = 6;
   this->TubeRadius = 0.5;
+  this->TubeImpostors = 0;
 
   this->TubeFilter->SetNumberOfSides(this->GetTubeNumberOfSides());
   this->TubeFilter->SetRadius(this->GetTubeRadius());
@@ -80,6 +81,7 @@ void vtkMRMLFiberBundleTubeDisplayNode::WriteXML(ostream& of, int nIndent)
   vtkIndent indent(nIndent);
   of << indent << " tubeRadius =\"" << this->TubeRadius << "\"";
   of << indent << " tubeNumberOfSides =\"" << this->TubeNumberOfSides << "\"";
+  of << indent << " tubeImpostors =\"" << (this->TubeImpostors ? "true" : "false") << "\"";
 }
 
 
@@ -111,6 +113,11 @@ void vtkMRMLFiberBundleTubeDisplayNode::ReadXMLAttributes(const char** atts)
       ss << attValue;
       ss >> TubeNumberOfSides;
       }
+
+    if (!strcmp(attName, "tubeImpostors"))
+      {
+      this->TubeImpostors = strcmp(attValue, "true") ? 0 : 1;
+      }
     }
 
   this->EndModify(disabledModify);
@@ -130,6 +137,7 @@ void vtkMRMLFiberBundleTubeDisplayNode::Copy(vtkMRMLNode *anode)
 
   this->SetTubeNumberOfSides(node->TubeNumberOfSides);
   this->SetTubeRadius(node->TubeRadius);
+  this->SetTubeImpostors(node->TubeImpostors);
 
   this->EndModify(disabledModify);
 
@@ -141,6 +149,7 @@ void vtkMRMLFiberBundleTubeDisplayNode::PrintSelf(ostream& os, vtkIndent indent)
   this->Superclass::PrintSelf(os,indent);
   os << indent << "TubeNumberOfSides:             " << this->TubeNumberOfSides << "\n";
   os << indent << "TubeRadius:             " << this->TubeRadius << "\n";
+  os << indent << "TubeImpostors:             " << this->TubeImpostors << "\n";
 }
 
 //----------------------------------------------------------------------------
@@ -148,11 +157,21 @@ vtkAlgorithmOutput* vtkMRMLFiberBundleTubeDisplayNode::GetOutputPort()
 {
   if (this->GetColorMode () == vtkMRMLFiberBundleDisplayNode::colorModeScalarData)
     {
-    return this->TubeFilter->GetOutputPort();
+    // the lines fed to the tube filter when they are drawn as impostors
+    return this->TubeImpostors ?
+      this->TubeFilter->GetInputConnection(0, 0) : this->TubeFilter->GetOutputPort();
     }
   return this->TensorToColor->GetOutputPort();
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLFiberBundleTubeDisplayNode::UpdateTensorToColorInput()
+{
+  // impostors color the lines that would have been tubed
+  this->TensorToColor->SetInputConnection(this->TubeImpostors ?
+    this->TubeFilter->GetInputConnection(0, 0) : this->TubeFilter->GetOutputPort());
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLFiberBundleTubeDisplayNode::UpdatePolyDataPipeline()
 {
@@ -162,6 +181,7 @@ void vtkMRMLFiberBundleTubeDisplayNode::UpdatePolyDataPipeline()
     this->Superclass::GetOutputPort());
   this->TubeFilter->SetInputConnection(
     this->Superclass::GetOutputPort());
+  this->UpdateTensorToColorInput();
 
   if (!this->Visibility)
     {
@@ -199,6 +219,7 @@ void vtkMRMLFiberBundleTubeDisplayNode::UpdatePolyDataPipeline()
     this->ColorLinesByOrientation->SetColorMode(
       this->ColorLinesByOrientation->colorModeMeanFiberOrientation);
     this->TubeFilter->SetInputConnection(this->ColorLinesByOrientation->GetOutputPort());
+    this->UpdateTensorToColorInput();
     vtkMRMLNode* ColorNode = this->GetScene()->GetNodeByID("vtkMRMLColorTableNodeFullRainbow");
     if (ColorNode)
       {
@@ -212,6 +233,7 @@ void vtkMRMLFiberBundleTubeDisplayNode::UpdatePolyDataPipeline()
     this->ColorLinesByOrientation->SetColorMode(
       this->ColorLinesByOrientation->colorModePointFiberOrientation);
     this->TubeFilter->SetInputConnection(this->ColorLinesByOrientation->GetOutputPort());
+    this->UpdateTensorToColorInput();
     vtkMRMLNode* ColorNode = this->GetScene()->GetNodeByID("vtkMRMLColorTableNodeFullRainbow");
     if (ColorNode)
       {
@@ -77,6 +77,15 @@ class VTK_SLICER_TRACTOGRAPHYDISPLAY_MODULE_MRML_EXPORT vtkMRMLFiberBundleTubeDi
   vtkSetMacro ( TubeNumberOfSides , int );
   vtkGetMacro ( TubeNumberOfSides , int );
 
+  ///
+  /// Output the (colored) fiber polylines instead of their tubes, the 3D
+  /// views then expand them into tubes of TubeRadius with shaders.
+  /// Changing the radius or the colors doesn't rebuild the tube polygons.
+  /// Off by default.
+  vtkSetMacro ( TubeImpostors , int );
+  vtkGetMacro ( TubeImpostors , int );
+  vtkBooleanMacro ( TubeImpostors , int );
+
 
  protected:
   vtkMRMLFiberBundleTubeDisplayNode ( );
@@ -88,10 +97,15 @@ class VTK_SLICER_TRACTOGRAPHYDISPLAY_MODULE_MRML_EXPORT vtkMRMLFiberBundleTubeDi
   /// Gets resultin glyph PolyData
   virtual vtkAlgorithmOutput* GetOutputPort();
 
+  ///
+  /// Color the tubes, or the lines if they are drawn as impostors
+  void UpdateTensorToColorInput();
+
   /// Enumerated
 
   int    TubeNumberOfSides;
   double TubeRadius;
+  int    TubeImpostors;
 
   /// dispaly pipeline
   vtkTubeFilter *TubeFilter;
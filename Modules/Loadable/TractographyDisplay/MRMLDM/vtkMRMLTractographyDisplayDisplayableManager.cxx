@@ -37,14 +37,29 @@
 
 // VTK includes
 
+#include <vtkActor.h>
+#include <vtkCallbackCommand.h>
 #include "vtkInteractorStyle.h"
 #include <vtkNew.h>
 #include "vtkObjectFactory.h"
+#include <vtkOpenGLExtensionManager.h>
+#include <vtkOpenGLProperty.h>
+#include <vtkOpenGLRenderWindow.h>
 #include "vtkRenderWindow.h"
 #include "vtkRenderWindowInteractor.h"
 #include "vtkRenderer.h"
 #include "vtkPolyData.h"
 #include "vtkPointData.h"
+#include <vtkShader2.h>
+#include <vtkShader2Collection.h>
+#include <vtkShaderProgram2.h>
+#include <vtkSmartPointer.h>
+#include <vtkUniformVariables.h>
+#include <vtkWeakPointer.h>
+
+// STD includes
+#include <map>
+#include <set>
 
 // ITKSys includes
 //#include <itksys/SystemTools.hxx>
@@ -55,12 +70,153 @@ vtkStandardNewMacro (vtkMRMLTractographyDisplayDisplayableManager);
 vtkCxxRevisionMacro (vtkMRMLTractographyDisplayDisplayableManager, "$Revision: 1.0 $");
 
 //---------------------------------------------------------------------------
+namespace
+{
+// vtkOpenGLProperty links the shaders of a prop program with main()
+// functions that call propFuncVS() and propFuncFS().
+// The vertex shader leaves the points in eye coordinates, the geometry
+// shader expands each segment into a quad facing the camera that is
+// 2 * Radius wide, and the fragment shader lights the quad with the normals
+// of the cylinder around the segment.
+const char* TubeImpostorVertexShader =
+  "void propFuncVS()\n"
+  "{\n"
+  "  gl_FrontColor = gl_Color;\n"
+  "  gl_Position = gl_ModelViewMatrix * gl_Vertex;\n"
+  "}\n";
+
+const char* TubeImpostorGeometryShader =
+  "#extension GL_EXT_geometry_shader4 : enable\n"
+  "uniform float Radius;\n"
+  "varying out float Across;\n"
+  "varying out vec3 SideDirection;\n"
+  "varying out vec3 FrontDirection;\n"
+  "void main()\n"
+  "{\n"
+  "  vec3 p0 = gl_PositionIn[0].xyz / gl_PositionIn[0].w;\n"
+  "  vec3 p1 = gl_PositionIn[1].xyz / gl_PositionIn[1].w;\n"
+  "  vec3 axis = p1 - p0;\n"
+  "  if (dot(axis, axis) == 0.)\n"
+  "    {\n"
+  "    return;\n"
+  "    }\n"
+  "  vec3 eye = (gl_ProjectionMatrix[2][3] == 0.) ?\n"
+  "    vec3(0., 0., 1.) : -normalize(p0 + p1);\n"
+  "  vec3 side = cross(axis, eye);\n"
+  "  if (dot(side, side) == 0.)\n"
+  "    {\n"
+  "    return;\n"
+  "    }\n"
+  "  side = normalize(side);\n"
+  "  vec3 front = normalize(cross(side, axis));\n"
+  "  vec3 ends[2];\n"
+  "  ends[0] = p0;\n"
+  "  ends[1] = p1;\n"
+  "  for (int i = 0; i < 2; ++i)\n"
+  "    {\n"
+  "    for (int j = 0; j < 2; ++j)\n"
+  "      {\n"
+  "      float s = (j == 0) ? -1. : 1.;\n"
+  "      Across = s;\n"
+  "      SideDirection = side;\n"
+  "      FrontDirection = front;\n"
+  "      gl_FrontColor = gl_FrontColorIn[i];\n"
+  "      gl_Position = gl_ProjectionMatrix * vec4(ends[i] + s * Radius * side, 1.);\n"
+  "      EmitVertex();\n"
+  "      }\n"
+  "    }\n"
+  "  EndPrimitive();\n"
+  "}\n";
+
+const char* TubeImpostorFragmentShader =
+  "uniform float Ambient;\n"
+  "uniform float Diffuse;\n"
+  "varying float Across;\n"
+  "varying vec3 SideDirection;\n"
+  "varying vec3 FrontDirection;\n"
+  "void propFuncFS()\n"
+  "{\n"
+  "  float across = clamp(Across, -1., 1.);\n"
+  "  vec3 normal = normalize(across * SideDirection +\n"
+  "                         sqrt(1. - across * across) * FrontDirection);\n"
+  "  // the light of the view is a headlight\n"
+  "  vec3 light = normalize(gl_LightSource[0].position.xyz);\n"
+  "  float diffuse = max(dot(normal, light), 0.);\n"
+  "  float specular = 0.;\n"
+  "  float highlight = dot(normal, normalize(light + vec3(0., 0., 1.)));\n"
+  "  if (highlight > 0.)\n"
+  "    {\n"
+  "    specular = pow(highlight, max(gl_FrontMaterial.shininess, 1.));\n"
+  "    }\n"
+  "  gl_FragColor = vec4(gl_Color.rgb * (Ambient + Diffuse * diffuse) +\n"
+  "                      gl_FrontMaterial.specular.rgb * specular, gl_Color.a);\n"
+  "}\n";
+}
+
+//---------------------------------------------------------------------------
+class vtkMRMLTractographyDisplayDisplayableManager::vtkInternal
+{
+public:
+  vtkInternal();
+
+  /// Make the impostor program of the context
+  vtkShaderProgram2* NewTubeImpostorProgram(vtkOpenGLRenderWindow* context);
+
+  /// IDs of the tube display nodes of the scene
+  std::set<std::string> TubeDisplayNodeIDs;
+  /// Impostor program of the tube display nodes in impostor mode, one per
+  /// node for their uniforms
+  std::map<std::string, vtkSmartPointer<vtkShaderProgram2> > TubeImpostorPrograms;
+  /// -1 if not checked yet
+  int ImpostorsSupported;
+
+  vtkSmartPointer<vtkCallbackCommand> RenderStartCallbackCommand;
+  vtkWeakPointer<vtkRenderer>         ObservedRenderer;
+};
+
+//---------------------------------------------------------------------------
+vtkMRMLTractographyDisplayDisplayableManager::vtkInternal::vtkInternal()
+{
+  this->ImpostorsSupported = -1;
+  this->RenderStartCallbackCommand = vtkSmartPointer<vtkCallbackCommand>::New();
+}
+
+//---------------------------------------------------------------------------
+vtkShaderProgram2* vtkMRMLTractographyDisplayDisplayableManager::vtkInternal
+::NewTubeImpostorProgram(vtkOpenGLRenderWindow* context)
+{
+  vtkShaderProgram2* program = vtkShaderProgram2::New();
+  program->SetContext(context);
+  program->SetGeometryTypeIn(VTK_GEOMETRY_SHADER_IN_TYPE_LINES);
+  program->SetGeometryTypeOut(VTK_GEOMETRY_SHADER_OUT_TYPE_TRIANGLE_STRIP);
+  program->SetGeometryVerticesOut(4);
+
+  const char* sources[3] = {TubeImpostorVertexShader,
+                            TubeImpostorGeometryShader,
+                            TubeImpostorFragmentShader};
+  const int types[3] = {VTK_SHADER_TYPE_VERTEX,
+                        VTK_SHADER_TYPE_GEOMETRY,
+                        VTK_SHADER_TYPE_FRAGMENT};
+  for (int i = 0; i < 3; ++i)
+    {
+    vtkNew<vtkShader2> shader;
+    shader->SetType(types[i]);
+    shader->SetSourceCode(sources[i]);
+    shader->SetContext(context);
+    program->GetShaders()->AddItem(shader.GetPointer());
+    }
+  return program;
+}
 
 //---------------------------------------------------------------------------
 vtkMRMLTractographyDisplayDisplayableManager::vtkMRMLTractographyDisplayDisplayableManager()
 {
   this->EnableFiberEdit = 0;
   this->SelectedFiberBundleNode = 0;
+  this->Internal = new vtkInternal;
+  this->Internal->RenderStartCallbackCommand->SetClientData(this);
+  this->Internal->RenderStartCallbackCommand->SetCallback(
+    vtkMRMLTractographyDisplayDisplayableManager::RenderStartCallback);
 
   this->RemoveInteractorStyleObservableEvent(vtkCommand::LeftButtonPressEvent);
   this->RemoveInteractorStyleObservableEvent(vtkCommand::LeftButtonReleaseEvent);
@@ -78,6 +234,12 @@ vtkMRMLTractographyDisplayDisplayableManager::vtkMRMLTractographyDisplayDisplaya
 //---------------------------------------------------------------------------
 vtkMRMLTractographyDisplayDisplayableManager::~vtkMRMLTractographyDisplayDisplayableManager()
 {
+  if (this->Internal->ObservedRenderer)
+    {
+    this->Internal->ObservedRenderer->RemoveObserver(
+      this->Internal->RenderStartCallbackCommand);
+    }
+  delete this->Internal;
 }
 
 //---------------------------------------------------------------------------
@@ -93,6 +255,167 @@ int vtkMRMLTractographyDisplayDisplayableManager::ActiveInteractionModes()
 }
 
 
+//---------------------------------------------------------------------------
+void vtkMRMLTractographyDisplayDisplayableManager::AdditionalInitializeStep()
+{
+  // the impostor programs are set before each render
+  if (this->Internal->ObservedRenderer)
+    {
+    this->Internal->ObservedRenderer->RemoveObserver(
+      this->Internal->RenderStartCallbackCommand);
+    }
+  this->Internal->ObservedRenderer = this->GetRenderer();
+  if (this->Internal->ObservedRenderer)
+    {
+    this->Internal->ObservedRenderer->AddObserver(vtkCommand::StartEvent,
+      this->Internal->RenderStartCallbackCommand);
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLTractographyDisplayDisplayableManager::UpdateFromMRMLScene()
+{
+  this->Internal->TubeDisplayNodeIDs.clear();
+  if (this->GetMRMLScene())
+    {
+    std::vector<vtkMRMLNode*> nodes;
+    this->GetMRMLScene()->GetNodesByClass("vtkMRMLFiberBundleTubeDisplayNode", nodes);
+    for (size_t i = 0; i < nodes.size(); ++i)
+      {
+      this->Internal->TubeDisplayNodeIDs.insert(nodes[i]->GetID());
+      }
+    }
+  // forget the programs of the removed nodes
+  std::map<std::string, vtkSmartPointer<vtkShaderProgram2> >::iterator it =
+    this->Internal->TubeImpostorPrograms.begin();
+  while (it != this->Internal->TubeImpostorPrograms.end())
+    {
+    if (this->Internal->TubeDisplayNodeIDs.count(it->first))
+      {
+      ++it;
+      }
+    else
+      {
+      this->Internal->TubeImpostorPrograms.erase(it++);
+      }
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLTractographyDisplayDisplayableManager::OnMRMLSceneNodeAdded(vtkMRMLNode* node)
+{
+  if (vtkMRMLFiberBundleTubeDisplayNode::SafeDownCast(node))
+    {
+    this->Internal->TubeDisplayNodeIDs.insert(node->GetID());
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLTractographyDisplayDisplayableManager::OnMRMLSceneNodeRemoved(vtkMRMLNode* node)
+{
+  if (vtkMRMLFiberBundleTubeDisplayNode::SafeDownCast(node))
+    {
+    this->Internal->TubeDisplayNodeIDs.erase(node->GetID());
+    this->Internal->TubeImpostorPrograms.erase(node->GetID());
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLTractographyDisplayDisplayableManager::UpdateTubeImpostors()
+{
+  if (this->Internal->TubeDisplayNodeIDs.empty() || !this->GetMRMLScene() ||
+      !this->GetMRMLDisplayableManagerGroup())
+    {
+    return;
+    }
+  vtkMRMLModelDisplayableManager *modelDisplayableManager =
+    vtkMRMLModelDisplayableManager::SafeDownCast(
+      this->GetMRMLDisplayableManagerGroup()->GetDisplayableManagerByClassName(
+        "vtkMRMLModelDisplayableManager"));
+  vtkOpenGLRenderWindow* context = vtkOpenGLRenderWindow::SafeDownCast(
+    this->GetRenderer()->GetRenderWindow());
+  if (!modelDisplayableManager || !context)
+    {
+    return;
+    }
+
+  std::set<std::string>::iterator it;
+  for (it = this->Internal->TubeDisplayNodeIDs.begin();
+       it != this->Internal->TubeDisplayNodeIDs.end(); ++it)
+    {
+    vtkMRMLFiberBundleTubeDisplayNode* displayNode =
+      vtkMRMLFiberBundleTubeDisplayNode::SafeDownCast(
+        this->GetMRMLScene()->GetNodeByID(it->c_str()));
+    vtkActor* actor = vtkActor::SafeDownCast(
+      modelDisplayableManager->GetActorByID(it->c_str()));
+    vtkOpenGLProperty* property = actor ?
+      vtkOpenGLProperty::SafeDownCast(actor->GetProperty()) : 0;
+    if (!displayNode || !property)
+      {
+      continue;
+      }
+    std::map<std::string, vtkSmartPointer<vtkShaderProgram2> >::iterator
+      programIt = this->Internal->TubeImpostorPrograms.find(*it);
+
+    if (displayNode->GetTubeImpostors() && this->Internal->ImpostorsSupported == -1)
+      {
+      this->Internal->ImpostorsSupported =
+        vtkShaderProgram2::IsSupported(context) &&
+        context->GetExtensionManager()->ExtensionSupported("GL_EXT_geometry_shader4");
+      if (!this->Internal->ImpostorsSupported)
+        {
+        vtkWarningMacro(<< "UpdateTubeImpostors: geometry shaders are not "
+                        << "supported, the tube impostors are drawn as lines");
+        }
+      }
+    if (!displayNode->GetTubeImpostors() || !this->Internal->ImpostorsSupported)
+      {
+      if (programIt != this->Internal->TubeImpostorPrograms.end())
+        {
+        if (property->GetPropProgram() == programIt->second)
+          {
+          property->SetPropProgram(0);
+          }
+        this->Internal->TubeImpostorPrograms.erase(programIt);
+        }
+      continue;
+      }
+
+    if (programIt == this->Internal->TubeImpostorPrograms.end())
+      {
+      vtkShaderProgram2* program = this->Internal->NewTubeImpostorProgram(context);
+      programIt = this->Internal->TubeImpostorPrograms.insert(
+        std::make_pair(*it, vtkSmartPointer<vtkShaderProgram2>(program))).first;
+      program->Delete();
+      }
+    vtkShaderProgram2* program = programIt->second;
+    // the radius and the lighting are uniforms, changing them doesn't touch
+    // the polylines
+    float radius = static_cast<float>(displayNode->GetTubeRadius());
+    float ambient = static_cast<float>(displayNode->GetAmbient());
+    float diffuse = static_cast<float>(displayNode->GetDiffuse());
+    program->GetUniformVariables()->SetUniformf("Radius", 1, &radius);
+    program->GetUniformVariables()->SetUniformf("Ambient", 1, &ambient);
+    program->GetUniformVariables()->SetUniformf("Diffuse", 1, &diffuse);
+    // the actor may have been created again by the model displayable manager
+    if (property->GetPropProgram() != program)
+      {
+      property->SetPropProgram(program);
+      }
+    }
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLTractographyDisplayDisplayableManager
+::RenderStartCallback(vtkObject* vtkNotUsed(caller),
+                      unsigned long vtkNotUsed(event),
+                      void* clientData, void* vtkNotUsed(callData))
+{
+  vtkMRMLTractographyDisplayDisplayableManager* self =
+    reinterpret_cast<vtkMRMLTractographyDisplayDisplayableManager*>(clientData);
+  self->UpdateTubeImpostors();
+}
+
 //---------------------------------------------------------------------------
 void vtkMRMLTractographyDisplayDisplayableManager::OnInteractorStyleEvent(int eventid)
 {
@@ -260,7 +583,12 @@ vtkMRMLTractographyDisplayDisplayableManager::GetPickedFiber(vtkMRMLFiberBundleD
   vtkMRMLFiberBundleTubeDisplayNode *tubeDisplayNode = vtkMRMLFiberBundleTubeDisplayNode::SafeDownCast(displayNode);
   vtkMRMLFiberBundleGlyphDisplayNode *glyphDisplayNode = vtkMRMLFiberBundleGlyphDisplayNode::SafeDownCast(displayNode);
 
-  if (tubeDisplayNode)
+  if (tubeDisplayNode && tubeDisplayNode->GetTubeImpostors())
+    {
+    // the impostors are the lines
+    cellID = pickedCell;
+    }
+  else if (tubeDisplayNode)
     {
     int numSides = tubeDisplayNode->GetTubeNumberOfSides();
     cellID = pickedCell/numSides;
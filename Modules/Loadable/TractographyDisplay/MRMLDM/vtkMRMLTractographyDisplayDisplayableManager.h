@@ -31,8 +31,16 @@ class vtkMRMLFiberBundleNode;
 #include <vtkMRMLAbstractThreeDViewDisplayableManager.h>
 
 // VTK includes
+class vtkObject;
 
 /// \ingroup Slicer_QtModules_Tractography
+///
+/// Edits the fibers picked in the 3D views, and draws the tubes of the
+/// fiber bundle tube display nodes in impostor mode
+/// (vtkMRMLFiberBundleTubeDisplayNode::TubeImpostors): the polylines
+/// mapped by the model displayable manager are expanded into tubes by a
+/// geometry shader. It requires GL_EXT_geometry_shader4, the fibers are
+/// drawn as lines otherwise.
 class VTK_SLICER_TRACTOGRAPHYDISPLAY_MODULE_MRMLDISPLAYABLEMANAGER_EXPORT vtkMRMLTractographyDisplayDisplayableManager
   : public vtkMRMLAbstractThreeDViewDisplayableManager
 {
@@ -57,6 +65,18 @@ protected:
 
   virtual void OnInteractorStyleEvent(int eventId);
 
+  virtual void AdditionalInitializeStep();
+  virtual void UpdateFromMRMLScene();
+  virtual void OnMRMLSceneNodeAdded(vtkMRMLNode* node);
+  virtual void OnMRMLSceneNodeRemoved(vtkMRMLNode* node);
+
+  /// Give the actors of the tube display nodes in impostor mode their
+  /// shader program and its uniforms, restore the others.
+  /// Called before each render of the view.
+  void UpdateTubeImpostors();
+  static void RenderStartCallback(vtkObject* caller, unsigned long event,
+                                  void* clientData, void* callData);
+
   vtkMRMLFiberBundleNode* GetPickedFiber(vtkMRMLFiberBundleDisplayNode* displayNode,
                                                          vtkIdType pickedCell, vtkIdType &cellID);
   void DeleteSelectedFibers();
@@ -69,6 +89,9 @@ protected:
   int EnableFiberEdit;
   vtkMRMLFiberBundleNode* SelectedFiberBundleNode;
   std::map <vtkIdType, std::vector<double> > SelectedCells;
+
+  class vtkInternal;
+  vtkInternal* Internal;
 };
 
 #endif
@@ -0,0 +1,165 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// TractographyMRML includes
+#include <vtkExtractPolyDataFibers.h>
+
+// VTK includes
+#include <vtkCellArray.h>
+#include <vtkCleanPolyData.h>
+#include <vtkDoubleArray.h>
+#include <vtkExtractPolyDataGeometry.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkPlanes.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkTransform.h>
+
+// STD includes
+#include <iostream>
+
+namespace
+{
+//----------------------------------------------------------------------------
+/// Random walks in a 100mm cube
+void MakeFibers(vtkPolyData* polyData, int numberOfFibers, int numberOfPoints)
+{
+  vtkMath::RandomSeed(1234);
+  vtkNew<vtkPoints> points;
+  vtkNew<vtkCellArray> lines;
+  for (int fiber = 0; fiber < numberOfFibers; ++fiber)
+    {
+    double x[3];
+    double direction[3];
+    for (int i = 0; i < 3; ++i)
+      {
+      x[i] = vtkMath::Random(0., 100.);
+      direction[i] = vtkMath::Random(-1., 1.);
+      }
+    lines->InsertNextCell(numberOfPoints);
+    for (int p = 0; p < numberOfPoints; ++p)
+      {
+      lines->InsertCellPoint(points->InsertNextPoint(x));
+      for (int i = 0; i < 3; ++i)
+        {
+        direction[i] += vtkMath::Random(-0.3, 0.3);
+        x[i] += direction[i];
+        }
+      }
+    }
+  polyData->SetPoints(points.GetPointer());
+  polyData->SetLines(lines.GetPointer());
+}
+
+//----------------------------------------------------------------------------
+bool CompareExtractions(vtkCleanPolyData* expected, vtkExtractPolyDataFibers* fibers,
+                        vtkExtractPolyDataGeometry* geometry, int extractInside)
+{
+  geometry->SetExtractInside(extractInside);
+  geometry->SetExtractBoundaryCells(extractInside);
+  fibers->SetExtractInside(extractInside);
+  expected->Update();
+  fibers->Update();
+  vtkPolyData* expectedOutput = expected->GetOutput();
+  vtkPolyData* output = fibers->GetOutput();
+  if (expectedOutput->GetNumberOfLines() != output->GetNumberOfLines() ||
+      expectedOutput->GetNumberOfPoints() != output->GetNumberOfPoints())
+    {
+    std::cerr << "ExtractInside " << extractInside << ": "
+              << output->GetNumberOfLines() << " lines instead of "
+              << expectedOutput->GetNumberOfLines() << ", "
+              << output->GetNumberOfPoints() << " points instead of "
+              << expectedOutput->GetNumberOfPoints() << std::endl;
+    return false;
+    }
+  return true;
+}
+}
+
+//----------------------------------------------------------------------------
+int vtkExtractPolyDataFibersTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  vtkNew<vtkPolyData> polyData;
+  MakeFibers(polyData.GetPointer(), 2000, 50);
+
+  vtkNew<vtkPlanes> planes;
+  vtkNew<vtkExtractPolyDataGeometry> geometry;
+  geometry->SetInput(polyData.GetPointer());
+  geometry->SetImplicitFunction(planes.GetPointer());
+  vtkNew<vtkCleanPolyData> expected;
+  expected->SetInputConnection(geometry->GetOutputPort());
+  expected->ConvertLinesToPointsOff();
+  expected->PointMergingOff();
+
+  vtkNew<vtkExtractPolyDataFibers> fibers;
+  fibers->SetInput(polyData.GetPointer());
+  fibers->SetPlanes(planes.GetPointer());
+
+  bool res = true;
+  for (int threads = 1; threads <= 4; threads *= 2)
+    {
+    fibers->SetNumberOfThreads(threads);
+    for (int i = -20; i <= 110; i += 13)
+      {
+      double x = static_cast<double>(i);
+      // axis aligned box
+      planes->SetBounds(x, x + 15., 20., 60., x / 2., x / 2. + 30.);
+      res = CompareExtractions(expected.GetPointer(), fibers.GetPointer(),
+                               geometry.GetPointer(), 1) && res;
+      res = CompareExtractions(expected.GetPointer(), fibers.GetPointer(),
+                               geometry.GetPointer(), 0) && res;
+      // rotated box, as a transformed ROI gives
+      vtkNew<vtkTransform> transform;
+      transform->RotateWXYZ(x, 0.3, -0.5, 0.8);
+      vtkNew<vtkPlanes> rotatedPlanes;
+      rotatedPlanes->SetBounds(x, x + 15., 20., 60., x / 2., x / 2. + 30.);
+      vtkNew<vtkPoints> points;
+      transform->TransformPoints(rotatedPlanes->GetPoints(), points.GetPointer());
+      planes->SetPoints(points.GetPointer());
+      vtkNew<vtkDoubleArray> normals;
+      normals->SetNumberOfComponents(3);
+      transform->TransformNormals(rotatedPlanes->GetNormals(), normals.GetPointer());
+      planes->SetNormals(normals.GetPointer());
+      res = CompareExtractions(expected.GetPointer(), fibers.GetPointer(),
+                               geometry.GetPointer(), 1) && res;
+      res = CompareExtractions(expected.GetPointer(), fibers.GetPointer(),
+                               geometry.GetPointer(), 0) && res;
+      }
+    }
+
+  // the points are binned again when the fibers are modified
+  planes->SetBounds(150., 160., 0., 100., 0., 100.);
+  res = CompareExtractions(expected.GetPointer(), fibers.GetPointer(),
+                           geometry.GetPointer(), 1) && res;
+  vtkPoints* points = polyData->GetPoints();
+  for (vtkIdType i = 0; i < points->GetNumberOfPoints(); ++i)
+    {
+    double x[3];
+    points->GetPoint(i, x);
+    x[0] += 100.;
+    points->SetPoint(i, x);
+    }
+  points->Modified();
+  res = CompareExtractions(expected.GetPointer(), fibers.GetPointer(),
+                           geometry.GetPointer(), 1) && res;
+  if (fibers->GetOutput()->GetNumberOfLines() == 0)
+    {
+    std::cerr << "The moved fibers are not extracted" << std::endl;
+    res = false;
+    }
+
+  return res ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -30,6 +30,7 @@
 #include <vtkDiffusionTensorMathematics.h>
 
 // VTK includes
+#include <vtkFloatArray.h>
 #include <vtkImageCast.h>
 #include <vtkImageChangeInformation.h>
 #include <vtkImageThreshold.h>
@@ -37,6 +38,7 @@
 #include <vtkMath.h>
 #include <vtkNew.h>
 #include <vtkPointData.h>
+#include <vtkPoints.h>
 #include <vtkSeedTracts.h>
 #include <vtkSmartPointer.h>
 
@@ -293,6 +295,9 @@ void vtkSlicerTractographyInteractiveSeedingLogic::CreateTractsForOneSeed(vtkSee
   vtkMRMLAnnotationControlPointsNode *annotationNode = vtkMRMLAnnotationControlPointsNode::SafeDownCast(transformableNode);
   vtkMRMLModelNode *modelNode = vtkMRMLModelNode::SafeDownCast(transformableNode);
 
+  // seeds are integrated together
+  vtkNew<vtkPoints> seedPoints;
+
 
   // if annotation
   if (annotationNode && annotationNode->GetNumberOfControlPoints() &&
@@ -312,8 +317,7 @@ void vtkSlicerTractographyInteractiveSeedingLogic::CreateTractsForOneSeed(vtkSee
             newXYZ[1] = xyzf[1] + y;
             newXYZ[2] = xyzf[2] + z;
             float *xyz = transFiducial->TransformFloatPoint(newXYZ);
-            //Run the thing
-            seed->SeedStreamlineFromPoint(xyz[0], xyz[1], xyz[2]);
+            seedPoints->InsertNextPoint(xyz[0], xyz[1], xyz[2]);
             }
           }
         }
@@ -333,11 +337,12 @@ void vtkSlicerTractographyInteractiveSeedingLogic::CreateTractsForOneSeed(vtkSee
       double *xyzf = mpoly->GetPoint(f);
 
       double *xyz = transFiducial->TransformDoublePoint(xyzf);
-
-      //Run the thing
-      seed->SeedStreamlineFromPoint(xyz[0], xyz[1], xyz[2]);
+      seedPoints->InsertNextPoint(xyz);
       }
     }
+
+  //Run the thing
+  seed->SeedStreamlinesFromPoints(seedPoints.GetPointer());
 }
 
 //----------------------------------------------------------------------------
@@ -910,6 +915,8 @@ int vtkSlicerTractographyInteractiveSeedingLogic::CreateTractsForLabelMap(
   seed->SetInputROIValue(ROIlabel);
   seed->UseStartingThresholdOn();
   seed->SetStartingThreshold(linearMeasureStart);
+  // The input tensor field shares the voxels of the volume
+  seed->SetInputEigenvalues(volumeNode->GetEigenvalues());
 
 
   // 4. Set Tractography specific parameters
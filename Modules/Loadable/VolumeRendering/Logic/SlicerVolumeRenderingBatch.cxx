@@ -0,0 +1,82 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// Volume Rendering includes
+#include "vtkSlicerVolumeRenderingBatchRenderer.h"
+#include "vtkSlicerVolumeRenderingLogic.h"
+
+// VTK includes
+#include <vtkNew.h>
+
+// STD includes
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+//----------------------------------------------------------------------------
+void printUsage(const char* program)
+{
+  std::cerr << "Usage: " << program
+            << " <presetsDirectory> <jobFile> [--workers N] [--gpu]"
+            << " [--size width height]" << std::endl
+            << "Each line of the job file is:" << std::endl
+            << "  volumeFile presetName outputImage"
+            << " [px py pz fx fy fz ux uy uz [viewAngle]]" << std::endl;
+}
+
+//----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+  if (argc < 3)
+    {
+    printUsage(argv[0]);
+    return EXIT_FAILURE;
+    }
+
+  vtkNew<vtkSlicerVolumeRenderingLogic> logic;
+  logic->SetModuleShareDirectory(argv[1]);
+
+  vtkNew<vtkSlicerVolumeRenderingBatchRenderer> batch;
+  batch->SetVolumeRenderingLogic(logic.GetPointer());
+  for (int i = 3; i < argc; ++i)
+    {
+    if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc)
+      {
+      batch->SetNumberOfWorkers(atoi(argv[++i]));
+      }
+    else if (strcmp(argv[i], "--gpu") == 0)
+      {
+      batch->SetRenderingMethod(vtkSlicerVolumeRenderingBatchRenderer::GPURayCast);
+      }
+    else if (strcmp(argv[i], "--size") == 0 && i + 2 < argc)
+      {
+      int width = atoi(argv[++i]);
+      int height = atoi(argv[++i]);
+      batch->SetImageSize(width, height);
+      }
+    else
+      {
+      printUsage(argv[0]);
+      return EXIT_FAILURE;
+      }
+    }
+
+  if (!batch->ReadJobFile(argv[2]))
+    {
+    return EXIT_FAILURE;
+    }
+  batch->Render();
+  std::cout << batch->GetNumberOfWrittenImages() << " images written, "
+            << batch->GetNumberOfFailedImages() << " failed in "
+            << batch->GetLastRenderTime() << "s ("
+            << batch->GetImagesPerSecond() << " images/s)" << std::endl;
+  return batch->GetNumberOfFailedImages() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,122 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// VolumeRendering includes
+#include <vtkSlicerVolumeRenderingBatchRenderer.h>
+#include <vtkSlicerVolumeRenderingLogic.h>
+
+// MRML includes
+#include <vtkMRMLCoreTestingMacros.h>
+
+// VTK includes
+#include <vtkNew.h>
+
+// STD includes
+#include <sstream>
+
+//----------------------------------------------------------------------------
+bool testReadJobs();
+bool testUnknownPreset(const std::string& moduleShareDirectory);
+
+//----------------------------------------------------------------------------
+int vtkSlicerVolumeRenderingBatchRendererTest(int argc, char* argv[])
+{
+  if (argc != 2)
+    {
+    std::cout << "Missing moduleShareDirectory argument !" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::string moduleShareDirectory(argv[1]);
+
+  vtkNew<vtkSlicerVolumeRenderingBatchRenderer> batch;
+  EXERCISE_BASIC_OBJECT_METHODS(batch.GetPointer());
+
+  bool res = true;
+  res = testReadJobs() && res;
+  res = testUnknownPreset(moduleShareDirectory) && res;
+  return res ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+//----------------------------------------------------------------------------
+bool testReadJobs()
+{
+  vtkNew<vtkSlicerVolumeRenderingBatchRenderer> batch;
+  std::istringstream jobs(
+    "# volume preset output camera\n"
+    "\n"
+    "head.nrrd CT-AAA head0.png\n"
+    "head.nrrd CT-AAA head1.png 0 500 0 0 0 0 0 0 1\n"
+    "head.nrrd MR-Default head2.jpg 0 500 0 0 0 0 0 0 1 20\n");
+  if (!batch->ReadJobs(jobs) ||
+      batch->GetNumberOfJobs() != 2 ||
+      batch->GetNumberOfImages() != 3)
+    {
+    std::cerr << "Line " << __LINE__
+              << " - Problem with vtkSlicerVolumeRenderingBatchRenderer::ReadJobs()"
+              << std::endl << "jobs: " << batch->GetNumberOfJobs()
+              << " images: " << batch->GetNumberOfImages() << std::endl;
+    return false;
+    }
+
+  // Malformed lines are reported, the valid ones are still added.
+  std::istringstream malformedJobs(
+    "head.nrrd CT-AAA\n"
+    "head.nrrd CT-AAA head3.png 0 500 0\n"
+    "head.nrrd CT-AAA head4.png 0 500 0 0 0 0 0 0 one\n"
+    "knee.nrrd CT-AAA knee.png\n");
+  if (batch->ReadJobs(malformedJobs) ||
+      batch->GetNumberOfJobs() != 3 ||
+      batch->GetNumberOfImages() != 4)
+    {
+    std::cerr << "Line " << __LINE__
+              << " - Problem with vtkSlicerVolumeRenderingBatchRenderer::ReadJobs()"
+              << std::endl << "jobs: " << batch->GetNumberOfJobs()
+              << " images: " << batch->GetNumberOfImages() << std::endl;
+    return false;
+    }
+
+  batch->RemoveAllJobs();
+  if (batch->GetNumberOfJobs() != 0 || batch->GetNumberOfImages() != 0)
+    {
+    std::cerr << "Line " << __LINE__
+              << " - Problem with vtkSlicerVolumeRenderingBatchRenderer::RemoveAllJobs()"
+              << std::endl;
+    return false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool testUnknownPreset(const std::string& moduleShareDirectory)
+{
+  vtkNew<vtkSlicerVolumeRenderingLogic> logic;
+  logic->SetModuleShareDirectory(moduleShareDirectory);
+
+  vtkNew<vtkSlicerVolumeRenderingBatchRenderer> batch;
+  batch->SetVolumeRenderingLogic(logic.GetPointer());
+  int job = batch->AddJob("head.nrrd", "NotAPreset");
+  batch->AddDefaultCamera(job, "head.png");
+  batch->AddDefaultCamera(job, "head2.png");
+
+  // No job to render: no render window is created.
+  if (batch->Render() != 0 ||
+      batch->GetNumberOfWrittenImages() != 0 ||
+      batch->GetNumberOfFailedImages() != 2 ||
+      batch->GetImagesPerSecond() != 0.)
+    {
+    std::cerr << "Line " << __LINE__
+              << " - Problem with vtkSlicerVolumeRenderingBatchRenderer::Render()"
+              << std::endl << "failed: " << batch->GetNumberOfFailedImages()
+              << std::endl;
+    return false;
+    }
+  return true;
+}
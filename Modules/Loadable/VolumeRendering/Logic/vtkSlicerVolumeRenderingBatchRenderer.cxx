@@ -0,0 +1,526 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+// Volume Rendering includes
+#include "vtkSlicerFixedPointVolumeRayCastMapper.h"
+#include "vtkSlicerGPURayCastVolumeMapper.h"
+#include "vtkSlicerVolumeRenderingBatchRenderer.h"
+#include "vtkSlicerVolumeRenderingLogic.h"
+
+// MRML includes
+#include <vtkMRMLScalarVolumeNode.h>
+#include <vtkMRMLScene.h>
+#include <vtkMRMLVolumeArchetypeStorageNode.h>
+#include <vtkMRMLVolumePropertyNode.h>
+
+// VTKSYS includes
+#include <itksys/SystemTools.hxx>
+
+// VTK includes
+#include <vtkCamera.h>
+#include <vtkImageData.h>
+#include <vtkJPEGWriter.h>
+#include <vtkMatrix4x4.h>
+#include <vtkMultiThreader.h>
+#include <vtkMutexLock.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkPNGWriter.h>
+#include <vtkRenderer.h>
+#include <vtkRenderWindow.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+#include <vtkVolume.h>
+#include <vtkVolumeProperty.h>
+#include <vtkWindowToImageFilter.h>
+
+// STD includes
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------------
+vtkCxxRevisionMacro(vtkSlicerVolumeRenderingBatchRenderer, "$Revision: 1.0 $");
+vtkStandardNewMacro(vtkSlicerVolumeRenderingBatchRenderer);
+
+//----------------------------------------------------------------------------
+class vtkSlicerVolumeRenderingBatchRenderer::vtkInternal
+{
+public:
+  struct CameraType
+  {
+    std::string OutputFile;
+    bool Default;
+    double Position[3];
+    double FocalPoint[3];
+    double ViewUp[3];
+    double ViewAngle;
+  };
+  struct JobType
+  {
+    std::string VolumeFile;
+    std::string Preset;
+    std::vector<CameraType> Cameras;
+    // Preset of the presets scene, resolved before the workers start
+    vtkVolumeProperty* PresetProperty;
+  };
+
+  vtkInternal(vtkSlicerVolumeRenderingBatchRenderer* external);
+  ~vtkInternal();
+
+  // Give the next job to a worker with its own copy of the preset.
+  // Return false when the queue is empty.
+  bool PopJob(JobType*& job, vtkVolumeProperty* property);
+  void AddResults(int written, int failed);
+  // Render the jobs of the queue until it is empty
+  void RenderJobs();
+  bool WriteImage(vtkWindowToImageFilter* windowToImage,
+                  const std::string& fileName);
+  static VTK_THREAD_RETURN_TYPE WorkerThread(void* arg);
+
+  vtkSlicerVolumeRenderingBatchRenderer* External;
+  std::vector<JobType> Jobs;
+
+  // Render state shared by the workers
+  vtkMutexLock* QueueLock;
+  // The ITK IO factories and readers are not safe to use concurrently.
+  vtkMutexLock* ReadLock;
+  size_t NextJob;
+  int MapperThreads;
+};
+
+//----------------------------------------------------------------------------
+vtkSlicerVolumeRenderingBatchRenderer::vtkInternal
+::vtkInternal(vtkSlicerVolumeRenderingBatchRenderer* external)
+{
+  this->External = external;
+  this->QueueLock = vtkMutexLock::New();
+  this->ReadLock = vtkMutexLock::New();
+  this->NextJob = 0;
+  this->MapperThreads = 1;
+}
+
+//----------------------------------------------------------------------------
+vtkSlicerVolumeRenderingBatchRenderer::vtkInternal::~vtkInternal()
+{
+  this->QueueLock->Delete();
+  this->ReadLock->Delete();
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerVolumeRenderingBatchRenderer::vtkInternal
+::PopJob(JobType*& job, vtkVolumeProperty* property)
+{
+  this->QueueLock->Lock();
+  job = 0;
+  while (!job && this->NextJob < this->Jobs.size())
+    {
+    JobType* nextJob = &this->Jobs[this->NextJob++];
+    if (nextJob->PresetProperty && !nextJob->Cameras.empty())
+      {
+      job = nextJob;
+      // The transfer functions cache their tables when the mappers sample
+      // them, the workers can't share the preset.
+      property->DeepCopy(job->PresetProperty);
+      }
+    }
+  this->QueueLock->Unlock();
+  return job != 0;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerVolumeRenderingBatchRenderer::vtkInternal
+::AddResults(int written, int failed)
+{
+  this->QueueLock->Lock();
+  this->External->NumberOfWrittenImages += written;
+  this->External->NumberOfFailedImages += failed;
+  this->QueueLock->Unlock();
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerVolumeRenderingBatchRenderer::vtkInternal
+::WriteImage(vtkWindowToImageFilter* windowToImage, const std::string& fileName)
+{
+  std::string extension = itksys::SystemTools::LowerCase(
+    itksys::SystemTools::GetFilenameLastExtension(fileName));
+  vtkSmartPointer<vtkImageWriter> writer;
+  if (extension == ".jpg" || extension == ".jpeg")
+    {
+    writer = vtkSmartPointer<vtkJPEGWriter>::New();
+    }
+  else
+    {
+    writer = vtkSmartPointer<vtkPNGWriter>::New();
+    }
+  windowToImage->Modified();
+  writer->SetInput(windowToImage->GetOutput());
+  writer->SetFileName(fileName.c_str());
+  writer->Write();
+  return writer->GetErrorCode() == 0;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerVolumeRenderingBatchRenderer::vtkInternal::RenderJobs()
+{
+  // Each worker owns its context, the mappers keep their textures and
+  // display lists from one job to the next.
+  vtkNew<vtkRenderWindow> renderWindow;
+  renderWindow->OffScreenRenderingOn();
+  renderWindow->SetSize(this->External->ImageSize);
+  vtkNew<vtkRenderer> renderer;
+  renderer->SetBackground(this->External->BackgroundColor);
+  renderWindow->AddRenderer(renderer.GetPointer());
+
+  vtkSmartPointer<vtkVolumeMapper> mapper;
+  if (this->External->RenderingMethod == GPURayCast)
+    {
+    vtkSlicerGPURayCastVolumeMapper* gpuMapper =
+      vtkSlicerGPURayCastVolumeMapper::New();
+    // No interaction: the full quality volume is needed in the first frame.
+    gpuMapper->AsynchronousUploadOff();
+    gpuMapper->SetFramerate(1.);
+    mapper.TakeReference(gpuMapper);
+    }
+  else
+    {
+    vtkSlicerFixedPointVolumeRayCastMapper* cpuMapper =
+      vtkSlicerFixedPointVolumeRayCastMapper::New();
+    cpuMapper->SetNumberOfThreads(this->MapperThreads);
+    cpuMapper->AutoAdjustSampleDistancesOff();
+    mapper.TakeReference(cpuMapper);
+    }
+  vtkNew<vtkVolume> volume;
+  vtkNew<vtkVolumeProperty> property;
+  volume->SetMapper(mapper);
+  volume->SetProperty(property.GetPointer());
+  renderer->AddVolume(volume.GetPointer());
+
+  vtkNew<vtkWindowToImageFilter> windowToImage;
+  windowToImage->SetInput(renderWindow.GetPointer());
+  windowToImage->ReadFrontBufferOff();
+
+  JobType* job = 0;
+  while (this->PopJob(job, property.GetPointer()))
+    {
+    const int cameraCount = static_cast<int>(job->Cameras.size());
+
+    vtkNew<vtkMRMLScene> scene;
+    vtkNew<vtkMRMLScalarVolumeNode> volumeNode;
+    scene->AddNode(volumeNode.GetPointer());
+    vtkNew<vtkMRMLVolumeArchetypeStorageNode> storageNode;
+    storageNode->SetFileName(job->VolumeFile.c_str());
+    scene->AddNode(storageNode.GetPointer());
+    volumeNode->SetAndObserveStorageNodeID(storageNode->GetID());
+
+    this->ReadLock->Lock();
+    int read = storageNode->ReadData(volumeNode.GetPointer());
+    this->ReadLock->Unlock();
+    if (!read || !volumeNode->GetImageData())
+      {
+      vtkErrorWithObjectMacro(this->External, << "Failed to read volume "
+                              << job->VolumeFile);
+      this->AddResults(0, cameraCount);
+      continue;
+      }
+
+    vtkNew<vtkMatrix4x4> ijkToRAS;
+    volumeNode->GetIJKToRASMatrix(ijkToRAS.GetPointer());
+    volume->SetUserMatrix(ijkToRAS.GetPointer());
+    mapper->SetInput(volumeNode->GetImageData());
+
+    int written = 0;
+    for (int i = 0; i < cameraCount; ++i)
+      {
+      const CameraType& camera = job->Cameras[i];
+      vtkCamera* activeCamera = renderer->GetActiveCamera();
+      if (camera.Default)
+        {
+        activeCamera->SetFocalPoint(0., 0., 0.);
+        activeCamera->SetPosition(0., 1., 0.);
+        activeCamera->SetViewUp(0., 0., 1.);
+        activeCamera->SetViewAngle(30.);
+        renderer->ResetCamera();
+        }
+      else
+        {
+        activeCamera->SetPosition(const_cast<double*>(camera.Position));
+        activeCamera->SetFocalPoint(const_cast<double*>(camera.FocalPoint));
+        activeCamera->SetViewUp(const_cast<double*>(camera.ViewUp));
+        activeCamera->SetViewAngle(camera.ViewAngle);
+        renderer->ResetCameraClippingRange();
+        }
+      renderWindow->Render();
+      if (this->WriteImage(windowToImage.GetPointer(), camera.OutputFile))
+        {
+        ++written;
+        }
+      else
+        {
+        vtkErrorWithObjectMacro(this->External, << "Failed to write image "
+                                << camera.OutputFile);
+        }
+      }
+    this->AddResults(written, cameraCount - written);
+    }
+  volume->ReleaseGraphicsResources(renderWindow.GetPointer());
+}
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkSlicerVolumeRenderingBatchRenderer::vtkInternal
+::WorkerThread(void* arg)
+{
+  vtkInternal* self = static_cast<vtkInternal*>(
+    static_cast<vtkMultiThreader::ThreadInfo*>(arg)->UserData);
+  self->RenderJobs();
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+vtkSlicerVolumeRenderingBatchRenderer::vtkSlicerVolumeRenderingBatchRenderer()
+{
+  this->VolumeRenderingLogic = 0;
+  this->RenderingMethod = CPURayCast;
+  this->NumberOfWorkers = vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
+  this->ImageSize[0] = 256;
+  this->ImageSize[1] = 256;
+  this->BackgroundColor[0] = 0.;
+  this->BackgroundColor[1] = 0.;
+  this->BackgroundColor[2] = 0.;
+  this->NumberOfWrittenImages = 0;
+  this->NumberOfFailedImages = 0;
+  this->LastRenderTime = 0.;
+  this->Internal = new vtkInternal(this);
+}
+
+//----------------------------------------------------------------------------
+vtkSlicerVolumeRenderingBatchRenderer::~vtkSlicerVolumeRenderingBatchRenderer()
+{
+  this->SetVolumeRenderingLogic(0);
+  delete this->Internal;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerVolumeRenderingBatchRenderer::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "VolumeRenderingLogic: " << this->VolumeRenderingLogic << "\n";
+  os << indent << "RenderingMethod: " << this->RenderingMethod << "\n";
+  os << indent << "NumberOfWorkers: " << this->NumberOfWorkers << "\n";
+  os << indent << "ImageSize: " << this->ImageSize[0] << " "
+     << this->ImageSize[1] << "\n";
+  os << indent << "BackgroundColor: " << this->BackgroundColor[0] << " "
+     << this->BackgroundColor[1] << " " << this->BackgroundColor[2] << "\n";
+  os << indent << "NumberOfJobs: " << this->GetNumberOfJobs() << "\n";
+  os << indent << "NumberOfImages: " << this->GetNumberOfImages() << "\n";
+  os << indent << "NumberOfWrittenImages: " << this->NumberOfWrittenImages << "\n";
+  os << indent << "NumberOfFailedImages: " << this->NumberOfFailedImages << "\n";
+  os << indent << "LastRenderTime: " << this->LastRenderTime << "\n";
+}
+
+//----------------------------------------------------------------------------
+vtkCxxSetObjectMacro(vtkSlicerVolumeRenderingBatchRenderer,
+                     VolumeRenderingLogic, vtkSlicerVolumeRenderingLogic);
+
+//----------------------------------------------------------------------------
+int vtkSlicerVolumeRenderingBatchRenderer
+::AddJob(const char* volumeFile, const char* presetName)
+{
+  vtkInternal::JobType job;
+  job.VolumeFile = volumeFile ? volumeFile : "";
+  job.Preset = presetName ? presetName : "";
+  job.PresetProperty = 0;
+  this->Internal->Jobs.push_back(job);
+  this->Modified();
+  return static_cast<int>(this->Internal->Jobs.size()) - 1;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerVolumeRenderingBatchRenderer
+::AddCamera(int job, const char* outputFile,
+            const double position[3], const double focalPoint[3],
+            const double viewUp[3], double viewAngle)
+{
+  if (job < 0 || job >= this->GetNumberOfJobs() || !outputFile)
+    {
+    vtkErrorMacro(<< "AddCamera: invalid job " << job << " or output file");
+    return;
+    }
+  vtkInternal::CameraType camera;
+  camera.OutputFile = outputFile;
+  camera.Default = (position == 0);
+  for (int i = 0; i < 3; ++i)
+    {
+    camera.Position[i] = position ? position[i] : 0.;
+    camera.FocalPoint[i] = focalPoint ? focalPoint[i] : 0.;
+    camera.ViewUp[i] = viewUp ? viewUp[i] : 0.;
+    }
+  camera.ViewAngle = viewAngle;
+  this->Internal->Jobs[job].Cameras.push_back(camera);
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerVolumeRenderingBatchRenderer
+::AddDefaultCamera(int job, const char* outputFile)
+{
+  this->AddCamera(job, outputFile, 0, 0, 0);
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerVolumeRenderingBatchRenderer::ReadJobFile(const char* fileName)
+{
+  std::ifstream stream(fileName ? fileName : "");
+  if (!stream.is_open())
+    {
+    vtkErrorMacro(<< "Failed to open job file " << (fileName ? fileName : "(null)"));
+    return false;
+    }
+  return this->ReadJobs(stream);
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerVolumeRenderingBatchRenderer::ReadJobs(istream& stream)
+{
+  bool res = true;
+  std::string line;
+  int lineNumber = 0;
+  while (std::getline(stream, line))
+    {
+    ++lineNumber;
+    std::istringstream lineStream(line);
+    std::string volumeFile, presetName, outputFile;
+    lineStream >> volumeFile;
+    if (volumeFile.empty() || volumeFile[0] == '#')
+      {
+      continue;
+      }
+    lineStream >> presetName >> outputFile;
+    std::vector<double> values;
+    double value;
+    while (lineStream >> value)
+      {
+      values.push_back(value);
+      }
+    if (outputFile.empty() || !lineStream.eof() ||
+        (!values.empty() && values.size() != 9 && values.size() != 10))
+      {
+      vtkErrorMacro(<< "Malformed job at line " << lineNumber << ": " << line);
+      res = false;
+      continue;
+      }
+    int job = this->GetNumberOfJobs() - 1;
+    if (job < 0 ||
+        this->Internal->Jobs[job].VolumeFile != volumeFile ||
+        this->Internal->Jobs[job].Preset != presetName)
+      {
+      job = this->AddJob(volumeFile.c_str(), presetName.c_str());
+      }
+    if (values.empty())
+      {
+      this->AddDefaultCamera(job, outputFile.c_str());
+      }
+    else
+      {
+      this->AddCamera(job, outputFile.c_str(), &values[0], &values[3],
+                      &values[6], values.size() == 10 ? values[9] : 30.);
+      }
+    }
+  return res;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerVolumeRenderingBatchRenderer::RemoveAllJobs()
+{
+  this->Internal->Jobs.clear();
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerVolumeRenderingBatchRenderer::GetNumberOfJobs()
+{
+  return static_cast<int>(this->Internal->Jobs.size());
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerVolumeRenderingBatchRenderer::GetNumberOfImages()
+{
+  size_t count = 0;
+  for (size_t i = 0; i < this->Internal->Jobs.size(); ++i)
+    {
+    count += this->Internal->Jobs[i].Cameras.size();
+    }
+  return static_cast<int>(count);
+}
+
+//----------------------------------------------------------------------------
+double vtkSlicerVolumeRenderingBatchRenderer::GetImagesPerSecond()
+{
+  return this->LastRenderTime > 0. ?
+    this->NumberOfWrittenImages / this->LastRenderTime : 0.;
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerVolumeRenderingBatchRenderer::Render()
+{
+  double startTime = vtkTimerLog::GetUniversalTime();
+  this->NumberOfWrittenImages = 0;
+  this->NumberOfFailedImages = 0;
+  this->LastRenderTime = 0.;
+
+  // The presets scene is loaded on first use, not from the workers.
+  vtkMRMLScene* presetsScene = this->VolumeRenderingLogic ?
+    this->VolumeRenderingLogic->GetPresetsScene() : 0;
+  int jobCount = 0;
+  for (size_t i = 0; i < this->Internal->Jobs.size(); ++i)
+    {
+    vtkInternal::JobType& job = this->Internal->Jobs[i];
+    vtkMRMLVolumePropertyNode* presetNode = presetsScene ?
+      vtkMRMLVolumePropertyNode::SafeDownCast(
+        presetsScene->GetFirstNodeByName(job.Preset.c_str())) : 0;
+    job.PresetProperty = presetNode ? presetNode->GetVolumeProperty() : 0;
+    if (!job.PresetProperty)
+      {
+      vtkErrorMacro(<< "Render: no preset named \"" << job.Preset << "\"");
+      this->NumberOfFailedImages += static_cast<int>(job.Cameras.size());
+      continue;
+      }
+    if (!job.Cameras.empty())
+      {
+      ++jobCount;
+      }
+    }
+  if (jobCount == 0)
+    {
+    return 0;
+    }
+
+  const int workers = std::min(this->NumberOfWorkers, jobCount);
+  this->Internal->NextJob = 0;
+  this->Internal->MapperThreads = std::max(1,
+    vtkMultiThreader::GetGlobalDefaultNumberOfThreads() / workers);
+  if (workers == 1)
+    {
+    this->Internal->RenderJobs();
+    }
+  else
+    {
+    vtkNew<vtkMultiThreader> threader;
+    threader->SetNumberOfThreads(workers);
+    threader->SetSingleMethod(vtkInternal::WorkerThread, this->Internal);
+    threader->SingleMethodExecute();
+    }
+
+  this->LastRenderTime = vtkTimerLog::GetUniversalTime() - startTime;
+  return this->NumberOfWrittenImages;
+}
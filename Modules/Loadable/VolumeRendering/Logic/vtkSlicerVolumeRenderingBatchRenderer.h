@@ -0,0 +1,139 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Program:   3D Slicer
+
+=========================================================================auto=*/
+
+#ifndef __vtkSlicerVolumeRenderingBatchRenderer_h
+#define __vtkSlicerVolumeRenderingBatchRenderer_h
+
+// VolumeRendering includes
+#include "vtkSlicerVolumeRenderingModuleLogicExport.h"
+class vtkSlicerVolumeRenderingLogic;
+
+// VTK includes
+#include <vtkObject.h>
+
+/// \ingroup Slicer_QtModules_VolumeRendering
+/// Render volumes offscreen without any view or widget.
+/// A job is a volume file rendered with a preset of the presets scene
+/// (presets.xml) from a list of cameras; each camera writes one image.
+/// Render() processes the job queue with \a NumberOfWorkers threads, each
+/// owning its render window (and OpenGL context), mapper and MRML scene.
+/// The jobs can be read from a text file where each line is:
+/// \verbatim
+/// volumeFile presetName outputImage [px py pz fx fy fz ux uy uz [viewAngle]]
+/// \endverbatim
+/// Consecutive lines with the same volume and preset are grouped into one job
+/// so the volume is only loaded once. Without camera, the volume is seen from
+/// the anterior side, superior up, as in the default 3D view.
+/// The output image format is chosen from its extension (png or jpg).
+/// \code
+/// vtkNew<vtkSlicerVolumeRenderingLogic> logic;
+/// logic->SetModuleShareDirectory(shareDirectory);
+/// vtkNew<vtkSlicerVolumeRenderingBatchRenderer> batch;
+/// batch->SetVolumeRenderingLogic(logic.GetPointer());
+/// batch->ReadJobFile("thumbnails.txt");
+/// batch->Render();
+/// \endcode
+/// \sa vtkSlicerVolumeRenderingLogic::GetPresetsScene()
+class VTK_SLICER_VOLUMERENDERING_MODULE_LOGIC_EXPORT vtkSlicerVolumeRenderingBatchRenderer
+  : public vtkObject
+{
+public:
+  static vtkSlicerVolumeRenderingBatchRenderer *New();
+  vtkTypeRevisionMacro(vtkSlicerVolumeRenderingBatchRenderer,vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  enum RenderingMethodType
+  {
+    CPURayCast = 0,
+    GPURayCast
+  };
+
+  /// Logic providing the presets scene. Required to render.
+  void SetVolumeRenderingLogic(vtkSlicerVolumeRenderingLogic* logic);
+  vtkGetObjectMacro(VolumeRenderingLogic, vtkSlicerVolumeRenderingLogic);
+
+  /// Mapper used by the workers: vtkSlicerFixedPointVolumeRayCastMapper
+  /// (CPURayCast, default) or vtkSlicerGPURayCastVolumeMapper (GPURayCast).
+  vtkSetClampMacro(RenderingMethod, int, CPURayCast, GPURayCast);
+  vtkGetMacro(RenderingMethod, int);
+
+  /// Number of threads rendering the jobs in parallel.
+  /// The CPU mapper splits the remaining cores between the workers.
+  /// vtkMultiThreader::GetGlobalDefaultNumberOfThreads() by default.
+  vtkSetClampMacro(NumberOfWorkers, int, 1, VTK_INT_MAX);
+  vtkGetMacro(NumberOfWorkers, int);
+
+  /// Size in pixels of the written images. 256x256 by default.
+  vtkSetVector2Macro(ImageSize, int);
+  vtkGetVector2Macro(ImageSize, int);
+
+  /// Background color of the written images. Black by default.
+  vtkSetVector3Macro(BackgroundColor, double);
+  vtkGetVector3Macro(BackgroundColor, double);
+
+  /// Add a job rendering \a volumeFile with the preset named \a presetName.
+  /// Return the index of the job to add cameras to.
+  int AddJob(const char* volumeFile, const char* presetName);
+  /// Add a camera to the job \a job, the image is written in \a outputFile.
+  /// Positions are in RAS.
+  void AddCamera(int job, const char* outputFile,
+                 const double position[3], const double focalPoint[3],
+                 const double viewUp[3], double viewAngle = 30.);
+  /// Add a camera looking at the volume from the anterior side.
+  void AddDefaultCamera(int job, const char* outputFile);
+
+  /// Add the jobs of a job file (see class description). Lines starting
+  /// with '#' and empty lines are skipped.
+  /// Return false if the file can't be read or a line is malformed, the
+  /// jobs of the valid lines are still added.
+  bool ReadJobFile(const char* fileName);
+  bool ReadJobs(istream& stream);
+
+  void RemoveAllJobs();
+  int GetNumberOfJobs();
+  /// Total number of cameras of all the jobs.
+  int GetNumberOfImages();
+
+  /// Render and write the images of all the jobs.
+  /// Return the number of written images.
+  int Render();
+
+  /// Statistics of the last Render()
+  vtkGetMacro(NumberOfWrittenImages, int);
+  vtkGetMacro(NumberOfFailedImages, int);
+  /// Wall time of the last Render() in seconds.
+  vtkGetMacro(LastRenderTime, double);
+  /// Throughput of the last Render(), 0 if nothing was written.
+  double GetImagesPerSecond();
+
+protected:
+  vtkSlicerVolumeRenderingBatchRenderer();
+  virtual ~vtkSlicerVolumeRenderingBatchRenderer();
+
+  vtkSlicerVolumeRenderingLogic* VolumeRenderingLogic;
+  int RenderingMethod;
+  int NumberOfWorkers;
+  int ImageSize[2];
+  double BackgroundColor[3];
+
+  int NumberOfWrittenImages;
+  int NumberOfFailedImages;
+  double LastRenderTime;
+
+  class vtkInternal;
+  vtkInternal* Internal;
+
+private:
+  vtkSlicerVolumeRenderingBatchRenderer(const vtkSlicerVolumeRenderingBatchRenderer&); // Not implemented
+  void operator=(const vtkSlicerVolumeRenderingBatchRenderer&);                       // Not implemented
+};
+
+#endif
@@ -42,6 +42,10 @@ vtkMRMLNCIRayCastVolumeRenderingDisplayNode::vtkMRMLNCIRayCastVolumeRenderingDis
   this->ICPESmoothness = 0.5f;
 
   this->RaycastTechnique = vtkMRMLNCIRayCastVolumeRenderingDisplayNode::Composite;
+
+  this->BrickedRendering = 0;
+
+  this->PreIntegration = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -95,6 +99,20 @@ void vtkMRMLNCIRayCastVolumeRenderingDisplayNode::ReadXMLAttributes(const char**
       ss >> this->RaycastTechnique;
       continue;
       }
+    if (!strcmp(attName,"brickedRendering"))
+      {
+      std::stringstream ss;
+      ss << attValue;
+      ss >> this->BrickedRendering;
+      continue;
+      }
+    if (!strcmp(attName,"preIntegration"))
+      {
+      std::stringstream ss;
+      ss << attValue;
+      ss >> this->PreIntegration;
+      continue;
+      }
     }
 }
 
@@ -110,6 +128,8 @@ void vtkMRMLNCIRayCastVolumeRenderingDisplayNode::WriteXML(ostream& of, int nInd
   of << indent << " icpeScale=\"" << this->ICPEScale << "\"";
   of << indent << " icpeSmoothness=\"" << this->ICPESmoothness << "\"";
   of << indent << " raycastTechnique=\"" << this->RaycastTechnique << "\"";
+  of << indent << " brickedRendering=\"" << this->BrickedRendering << "\"";
+  of << indent << " preIntegration=\"" << this->PreIntegration << "\"";
 }
 
 //----------------------------------------------------------------------------
@@ -124,6 +144,8 @@ void vtkMRMLNCIRayCastVolumeRenderingDisplayNode::Copy(vtkMRMLNode *anode)
   this->SetICPEScale(node->GetICPEScale());
   this->SetICPESmoothness(node->GetICPESmoothness());
   this->SetRaycastTechnique(node->GetRaycastTechnique());
+  this->SetBrickedRendering(node->GetBrickedRendering());
+  this->SetPreIntegration(node->GetPreIntegration());
 
   this->EndModify(wasModifying);
 }
@@ -138,4 +160,6 @@ void vtkMRMLNCIRayCastVolumeRenderingDisplayNode::PrintSelf(ostream& os, vtkInde
   os << "ICPEScale: " << this->ICPEScale << "\n";
   os << "ICPESmoothness: " << this->ICPESmoothness << "\n";
   os << "RaycastTechnique: " << this->RaycastTechnique << "\n";
+  os << "BrickedRendering: " << this->BrickedRendering << "\n";
+  os << "PreIntegration: " << this->PreIntegration << "\n";
 }
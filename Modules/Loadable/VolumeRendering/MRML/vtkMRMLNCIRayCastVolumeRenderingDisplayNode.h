@@ -64,6 +64,22 @@ public:
   vtkGetMacro (RaycastTechnique, int);
   vtkSetMacro (RaycastTechnique, int);
 
+  /// Page the volume into the GPU memory by bricks instead of downsampling
+  /// it to fit GPUMemorySize. Only the visible bricks are uploaded.
+  /// 0 by default.
+  vtkGetMacro (BrickedRendering, int);
+  vtkSetMacro (BrickedRendering, int);
+  vtkBooleanMacro (BrickedRendering, int);
+
+  /// Use a preintegrated transfer function table to remove the slicing
+  /// artifacts of high frequency transfer functions, which allows larger
+  /// sample distances. Only used with single component volumes and the
+  /// compositing techniques.
+  /// 0 by default.
+  vtkGetMacro (PreIntegration, int);
+  vtkSetMacro (PreIntegration, int);
+  vtkBooleanMacro (PreIntegration, int);
+
 protected:
   vtkMRMLNCIRayCastVolumeRenderingDisplayNode();
   ~vtkMRMLNCIRayCastVolumeRenderingDisplayNode();
@@ -77,6 +93,10 @@ protected:
   float ICPESmoothness;
 
   int RaycastTechnique;
+
+  int BrickedRendering;
+
+  int PreIntegration;
 };
 
 #endif
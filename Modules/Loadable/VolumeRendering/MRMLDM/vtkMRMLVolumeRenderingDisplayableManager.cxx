@@ -84,6 +84,20 @@ vtkCxxRevisionMacro (vtkMRMLVolumeRenderingDisplayableManager, "$Revision: 1.0 $
 //---------------------------------------------------------------------------
 bool vtkMRMLVolumeRenderingDisplayableManager::First = true;
 int vtkMRMLVolumeRenderingDisplayableManager::DefaultGPUMemorySize = 256;
+vtkMRMLVolumeRenderingDisplayableManager::FrameStatistics
+vtkMRMLVolumeRenderingDisplayableManager::LastFrameStatistics;
+
+//---------------------------------------------------------------------------
+vtkMRMLVolumeRenderingDisplayableManager::FrameStatistics::FrameStatistics()
+{
+  this->UploadedBytes = 0;
+  this->UploadTime = 0.;
+  this->TransferFunctionTime = 0.;
+  this->RayCastTime = 0.;
+  this->PreprocessingTime = 0.;
+  this->ExpectedFPS = 0.;
+  this->AchievedFPS = 0.;
+}
 
 //---------------------------------------------------------------------------
 vtkMRMLVolumeRenderingDisplayableManager::vtkMRMLVolumeRenderingDisplayableManager()
@@ -231,9 +245,13 @@ void vtkMRMLVolumeRenderingDisplayableManager::Reset()
                                       mapperEvents.GetPointer());
   // GPU raycast
   vtkNew<vtkSlicerGPURayCastVolumeMapper> newMapperGPURaycast;
+  vtkNew<vtkIntArray> newMapperGPURaycastEvents;
+  // the mapper renders again until the volume is loaded
+  newMapperGPURaycastEvents->InsertNextValue(
+    vtkCommand::VolumeMapperRenderProgressEvent);
   vtkSetAndObserveMRMLNodeEventsMacro(this->MapperGPURaycast,
                                       newMapperGPURaycast.GetPointer(),
-                                      mapperEvents.GetPointer());
+                                      newMapperGPURaycastEvents.GetPointer());
   // GPU raycast II
   vtkNew<vtkSlicerGPURayCastMultiVolumeMapper> newMapperGPURaycastII;
   vtkNew<vtkIntArray> newMapperGPURaycastIIEvents;
@@ -541,6 +559,14 @@ void vtkMRMLVolumeRenderingDisplayableManager
   mapper->SetInternalVolumeSize(this->GetMaxMemory(mapper, vspNode));
   mapper->SetFramerate(this->GetFramerate(vspNode));
 
+  // In bricked mode, the GPU memory budget goes to the brick cache
+  vtkIdType memory = vspNode->GetGPUMemorySize() ?
+    vspNode->GetGPUMemorySize() :
+    vtkMRMLVolumeRenderingDisplayableManager::DefaultGPUMemorySize;
+  mapper->SetMaxMemoryInBytes(memory * 1024 * 1024);
+  mapper->SetBrickedRendering(vspNode->GetBrickedRendering());
+  mapper->SetPreIntegration(vspNode->GetPreIntegration());
+
   mapper->SetDepthPeelingThreshold(vspNode->GetDepthPeelingThreshold());
   mapper->SetDistanceColorBlending(vspNode->GetDistanceColorBlending());
   mapper->SetICPEScale(vspNode->GetICPEScale());
@@ -661,6 +687,55 @@ int vtkMRMLVolumeRenderingDisplayableManager
   return supported;
 }
 
+//---------------------------------------------------------------------------
+bool vtkMRMLVolumeRenderingDisplayableManager
+::GetFrameStatistics(FrameStatistics& statistics)
+{
+  statistics = FrameStatistics();
+  vtkVolumeMapper* mapper = this->GetVolumeMapper(this->DisplayedNode);
+  if (!mapper || !this->Volume || !this->Volume->GetVisibility())
+    {
+    return false;
+    }
+  statistics.RayCastTime = mapper->GetTimeToDraw();
+  vtkSlicerGPURayCastVolumeMapper* gpuMapper =
+    vtkSlicerGPURayCastVolumeMapper::SafeDownCast(mapper);
+  if (gpuMapper)
+    {
+    statistics.UploadedBytes = gpuMapper->GetLastUploadedBytes();
+    statistics.UploadTime = gpuMapper->GetLastUploadTime();
+    statistics.TransferFunctionTime = gpuMapper->GetLastTransferFunctionTime();
+    statistics.PreprocessingTime = gpuMapper->GetLastPreprocessingTime();
+    }
+  statistics.ExpectedFPS = this->DisplayedNode->GetExpectedFPS();
+  double renderTime = this->GetRenderer() ?
+    this->GetRenderer()->GetLastRenderTimeInSeconds() : 0.;
+  statistics.AchievedFPS = renderTime > 0. ? 1. / renderTime : 0.;
+  return true;
+}
+
+//---------------------------------------------------------------------------
+unsigned long vtkMRMLVolumeRenderingDisplayableManager::GetPipelineMemorySize()
+{
+  // The gradients are only allocated when shading or gradient opacity is used
+  if (!this->MapperRaycast || !this->MapperRaycast->GetGradientNormal() ||
+      !this->MapperRaycast->GetInput())
+    {
+    return 0;
+    }
+  vtkImageData* input = this->MapperRaycast->GetInput();
+  int components = input->GetNumberOfScalarComponents();
+  if (this->Volume && this->Volume->GetProperty() &&
+      !this->Volume->GetProperty()->GetIndependentComponents())
+    {
+    components = 1;
+    }
+  // A normal index and a magnitude per voxel and component
+  double size = static_cast<double>(input->GetNumberOfPoints()) * components *
+    (sizeof(unsigned short) + sizeof(unsigned char));
+  return static_cast<unsigned long>(size / 1024.);
+}
+
 //---------------------------------------------------------------------------
 vtkVolumeMapper* vtkMRMLVolumeRenderingDisplayableManager
 ::GetVolumeMapper(vtkMRMLVolumeRenderingDisplayNode* vspNode)
@@ -1140,6 +1215,15 @@ void vtkMRMLVolumeRenderingDisplayableManager::OnCreate()
     events->InsertNextValue(vtkMRMLViewNode::GraphicalResourcesCreatedEvent);
     vtkObserveMRMLNodeEventsMacro(viewNode, events.GetPointer());
     }
+  // collect the frame statistics after each render
+  vtkRenderer* renderer = this->GetRenderer();
+  if (renderer && !vtkIsObservedMRMLNodeEventMacro(
+        renderer, vtkCommand::EndEvent))
+    {
+    vtkNew<vtkIntArray> rendererEvents;
+    rendererEvents->InsertNextValue(vtkCommand::EndEvent);
+    vtkObserveMRMLNodeEventsMacro(renderer, rendererEvents.GetPointer());
+    }
 
   this->UpdateDisplayNodeList();
 
@@ -1206,6 +1290,20 @@ void vtkMRMLVolumeRenderingDisplayableManager
       this->RequestRender();
       }
     }
+  else if (event == vtkCommand::VolumeMapperRenderProgressEvent)
+    {
+    // The GPU ray cast mapper is still loading the volume in the
+    // background, schedule the next frame
+    this->RequestRender();
+    }
+  else if (event == vtkCommand::EndEvent && caller == this->GetRenderer())
+    {
+    FrameStatistics statistics;
+    if (this->GetFrameStatistics(statistics))
+      {
+      vtkMRMLVolumeRenderingDisplayableManager::LastFrameStatistics = statistics;
+      }
+    }
   else if (event == vtkCommand::StartEvent ||
            event == vtkCommand::StartInteractionEvent)
     {
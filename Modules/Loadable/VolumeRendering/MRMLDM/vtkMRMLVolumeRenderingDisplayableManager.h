@@ -151,6 +151,40 @@ public:
 
   static int DefaultGPUMemorySize;
 
+  /// Rendering statistics of a frame of the displayed volume. Times are in
+  /// seconds. The upload, transfer function and preprocessing counters are
+  /// only measured by the NCI GPU ray cast mapper, they are 0 otherwise.
+  struct FrameStatistics
+    {
+    FrameStatistics();
+    /// Bytes uploaded into the textures
+    vtkIdType UploadedBytes;
+    double UploadTime;
+    /// Time to sample the transfer functions into the lookup tables
+    double TransferFunctionTime;
+    /// Time the mapper took to draw the volume
+    double RayCastTime;
+    /// Time to compute the volumes and brick ranges on the CPU
+    double PreprocessingTime;
+    double ExpectedFPS;
+    double AchievedFPS;
+    };
+
+  /// Fill statistics with the last frame rendered in the view.
+  /// Return false if no volume is displayed.
+  bool GetFrameStatistics(FrameStatistics& statistics);
+
+  /// Approximate memory (in kibibytes) of the intermediate data computed on
+  /// the CPU by the mappers: the gradients of the CPU ray cast mapper. The
+  /// mappers render the volume image data without copying it, the textures
+  /// of the GPU mappers are in the graphics memory (see
+  /// FrameStatistics::UploadedBytes).
+  unsigned long GetPipelineMemorySize();
+
+  /// Statistics of the last frame rendered by any volume rendering
+  /// displayable manager, updated at the end of each render.
+  static FrameStatistics LastFrameStatistics;
+
 protected:
   vtkMRMLVolumeRenderingDisplayableManager();
   ~vtkMRMLVolumeRenderingDisplayableManager();
@@ -398,6 +398,92 @@ void vtkSlicerFixedPointCompositeHelperGenerateImageOneTrilin( T *data,
 }
 
 
+// This method is used when the interpolation type is linear and the data
+// has one unsigned short or short component, the most common case. It
+// renders the same image as
+// vtkSlicerFixedPointCompositeHelperGenerateImageOneSimpleTrilin() (SIMPLE)
+// and vtkSlicerFixedPointCompositeHelperGenerateImageOneTrilin() but casts
+// VTKKWRCHelper_PacketSize neighbor rays of a row together. The lanes that
+// don't sample this step (end of the ray, early termination, space leaping,
+// cropping or transparent sample) composite a zero color and opacity,
+// which leaves their color and remaining opacity unchanged.
+template <class T>
+void vtkSlicerFixedPointCompositeHelperGenerateImageOneTrilinPacket( T *data,
+                                                       int threadID,
+                                                       int threadCount,
+                                                       vtkSlicerFixedPointVolumeRayCastMapper *mapper,
+                                                       vtkVolume *vtkNotUsed(vol))
+{
+  VTKKWRCHelper_PacketLoopStartTrilin();
+
+  const int simple = ( scale[0] == 1.0 && shift[0] == 0.0 );
+  unsigned int   color[VTKKWRCHelper_PacketSize][3];
+  unsigned short remainingOpacity[VTKKWRCHelper_PacketSize];
+  unsigned short tmp[VTKKWRCHelper_PacketSize][4];
+  for ( l = 0; l < VTKKWRCHelper_PacketSize; l++ )
+    {
+    color[l][0] = color[l][1] = color[l][2] = 0;
+    remainingOpacity[l] = 0x7fff;
+    }
+
+  for ( k = 0; k < maxSteps; k++ )
+    {
+    for ( l = 0; l < VTKKWRCHelper_PacketSize; l++ )
+      {
+      pSample[l] = 0;
+      if ( !pActive[l] )
+        {
+        continue;
+        }
+      VTKKWRCHelper_PacketMoveToNextSample( l );
+      VTKKWRCHelper_PacketSpaceLeapCheck( l );
+      VTKKWRCHelper_PacketCroppingCheck( l );
+      VTKKWRCHelper_PacketGetCellScalarValues( l, data, simple, scale[0], shift[0] );
+      pSample[l] = 1;
+      }
+
+    VTKKWRCHelper_PacketInterpolateScalars();
+
+    for ( l = 0; l < VTKKWRCHelper_PacketSize; l++ )
+      {
+      tmp[l][0] = tmp[l][1] = tmp[l][2] = tmp[l][3] = 0;
+      if ( !pSample[l] )
+        {
+        continue;
+        }
+      VTKKWRCHelper_LookupColorUS( colorTable[0], scalarOpacityTable[0], pVal[l], tmp[l] );
+      }
+
+    for ( l = 0; l < VTKKWRCHelper_PacketSize; l++ )
+      {
+      color[l][0] += (tmp[l][0]*remainingOpacity[l]+0x7fff)>>VTKKW_FP_SHIFT;
+      color[l][1] += (tmp[l][1]*remainingOpacity[l]+0x7fff)>>VTKKW_FP_SHIFT;
+      color[l][2] += (tmp[l][2]*remainingOpacity[l]+0x7fff)>>VTKKW_FP_SHIFT;
+      remainingOpacity[l] =
+        (remainingOpacity[l]*((~(tmp[l][3])&VTKKW_FP_MASK))+0x7fff)>>VTKKW_FP_SHIFT;
+      }
+
+    VTKKWRCHelper_PacketCheckTermination( remainingOpacity[l] < 0xff );
+    if ( !numberOfActiveRays )
+      {
+      break;
+      }
+    }
+
+  for ( l = 0; l < numberOfRays; l++ )
+    {
+    unsigned short *pixelPtr = imagePtr + 4*l;
+    if ( pNumSteps[l] == 0 )
+      {
+      pixelPtr[0] = pixelPtr[1] = pixelPtr[2] = pixelPtr[3] = 0;
+      continue;
+      }
+    VTKKWRCHelper_SetPixelColor( pixelPtr, color[l], remainingOpacity[l] );
+    }
+
+  VTKKWRCHelper_PacketIncrementAndLoopEnd();
+}
+
 // This method is used when the interpolation type is linear, the data has 
 // two components and the components are not considered independent. In the
 // inner loop we get the data value for the eight cell corners (if we have 
@@ -710,8 +796,19 @@ void vtkSlicerFixedPointVolumeRayCastCompositeHelper::GenerateImage( int threadI
     // One component
     if ( mapper->GetInput()->GetNumberOfScalarComponents() == 1 )
       {
+      // Unsigned short or short - packets of rays
+      if ( scalarType == VTK_UNSIGNED_SHORT )
+        {
+        vtkSlicerFixedPointCompositeHelperGenerateImageOneTrilinPacket(
+          static_cast<unsigned short *>(data), threadID, threadCount, mapper, vol );
+        }
+      else if ( scalarType == VTK_SHORT )
+        {
+        vtkSlicerFixedPointCompositeHelperGenerateImageOneTrilinPacket(
+          static_cast<short *>(data), threadID, threadCount, mapper, vol );
+        }
       // Scale == 1.0 and shift == 0.0 - simple case (faster)
-      if ( mapper->GetTableScale()[0] == 1.0 && mapper->GetTableShift()[0] == 0.0 )
+      else if ( mapper->GetTableScale()[0] == 1.0 && mapper->GetTableShift()[0] == 0.0 )
         {
         switch ( scalarType )
           {
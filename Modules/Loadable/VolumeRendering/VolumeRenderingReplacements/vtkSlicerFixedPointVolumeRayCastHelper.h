@@ -1151,6 +1151,201 @@
 
 #define VTKKWRCHelper_MIPSpaceLeapCheckMulti( COMP )  mmvalid[COMP]
 
+// Packet ray casting: VTKKWRCHelper_PacketSize neighbor rays of a row are
+// cast together. The state of each ray is kept in lane arrays, the per
+// ray checks and the table lookups are done lane by lane, and the
+// trilinear interpolation and the compositing are done in loops over the
+// lanes without any branch or dependency between the rays so that the
+// compiler vectorizes them (SSE2 on any x86_64 build, AVX when enabled).
+// The fixed point arithmetic is the same as the one ray helpers.
+#ifndef VTKKWRCHelper_PacketSize
+#define VTKKWRCHelper_PacketSize 4
+#endif
+
+#define VTKKWRCHelper_InitializePacketTrilin()                          \
+  T *dptr;                                                              \
+  unsigned int   k, maxSteps;                                           \
+  int            l, numberOfRays, numberOfActiveRays;                   \
+  unsigned int   spos[3];                                               \
+  unsigned int   pNumSteps[VTKKWRCHelper_PacketSize];                   \
+  unsigned int   pPos[VTKKWRCHelper_PacketSize][3];                     \
+  unsigned int   pDir[VTKKWRCHelper_PacketSize][3];                     \
+  unsigned int   pOldSPos[VTKKWRCHelper_PacketSize][3];                 \
+  unsigned int   pMMPos[VTKKWRCHelper_PacketSize][3];                   \
+  int            pMMValid[VTKKWRCHelper_PacketSize];                    \
+  int            pActive[VTKKWRCHelper_PacketSize];                     \
+  int            pSample[VTKKWRCHelper_PacketSize];                     \
+  unsigned int   pA[VTKKWRCHelper_PacketSize], pB[VTKKWRCHelper_PacketSize]; \
+  unsigned int   pC[VTKKWRCHelper_PacketSize], pD[VTKKWRCHelper_PacketSize]; \
+  unsigned int   pE[VTKKWRCHelper_PacketSize], pF[VTKKWRCHelper_PacketSize]; \
+  unsigned int   pG[VTKKWRCHelper_PacketSize], pH[VTKKWRCHelper_PacketSize]; \
+  unsigned short pVal[VTKKWRCHelper_PacketSize];
+
+#define VTKKWRCHelper_PacketInnerInitialization()                       \
+  numberOfRays = rowBounds[j*2+1] - i + 1;                              \
+  numberOfRays = ( numberOfRays < VTKKWRCHelper_PacketSize ) ?          \
+    ( numberOfRays ) : ( VTKKWRCHelper_PacketSize );                    \
+  maxSteps = 0;                                                         \
+  for ( l = 0; l < VTKKWRCHelper_PacketSize; l++ )                      \
+    {                                                                   \
+    pNumSteps[l] = 0;                                                   \
+    pPos[l][0] = pPos[l][1] = pPos[l][2] = 0;                           \
+    if ( l < numberOfRays )                                             \
+      {                                                                 \
+      mapper->ComputeRayInfo( i+l, j, pPos[l], pDir[l], &pNumSteps[l] ); \
+      }                                                                 \
+    maxSteps = ( pNumSteps[l] > maxSteps ) ? ( pNumSteps[l] ) : ( maxSteps ); \
+    pActive[l] = ( pNumSteps[l] > 0 );                                  \
+    pOldSPos[l][0] = (pPos[l][0] >> VTKKW_FP_SHIFT) + 1;                \
+    pOldSPos[l][1] = pOldSPos[l][2] = 0;                                \
+    pMMPos[l][0] = (pPos[l][0] >> VTKKW_FPMM_SHIFT) + 1;                \
+    pMMPos[l][1] = pMMPos[l][2] = 0;                                    \
+    pMMValid[l] = 0;                                                    \
+    pA[l] = pB[l] = pC[l] = pD[l] = pE[l] = pF[l] = pG[l] = pH[l] = 0;  \
+    }
+
+#define VTKKWRCHelper_PacketLoopStartTrilin()                           \
+  VTKKWRCHelper_InitializeVariables();                                  \
+  VTKKWRCHelper_InitializeTrilinVariables();                            \
+  VTKKWRCHelper_InitializePacketTrilin();                               \
+  for ( j = 0; j < imageInUseSize[1]; j++ )                             \
+    {                                                                   \
+    VTKKWRCHelper_OuterInitialization();                                \
+    for ( i = rowBounds[j*2]; i <= rowBounds[j*2+1];                    \
+          i += VTKKWRCHelper_PacketSize,                                \
+          imagePtr += 4*VTKKWRCHelper_PacketSize )                      \
+      {                                                                 \
+      VTKKWRCHelper_PacketInnerInitialization();
+
+// The lane checks are used in a loop over the lanes, continue skips the
+// sample of the lane
+#define VTKKWRCHelper_PacketMoveToNextSample( L )                       \
+  if ( k )                                                              \
+    {                                                                   \
+    mapper->FixedPointIncrement( pPos[L], pDir[L] );                    \
+    }
+
+#define VTKKWRCHelper_PacketSpaceLeapCheck( L )                         \
+  if ( pPos[L][0] >> VTKKW_FPMM_SHIFT != pMMPos[L][0] ||                \
+       pPos[L][1] >> VTKKW_FPMM_SHIFT != pMMPos[L][1] ||                \
+       pPos[L][2] >> VTKKW_FPMM_SHIFT != pMMPos[L][2] )                 \
+    {                                                                   \
+    pMMPos[L][0] = pPos[L][0] >> VTKKW_FPMM_SHIFT;                      \
+    pMMPos[L][1] = pPos[L][1] >> VTKKW_FPMM_SHIFT;                      \
+    pMMPos[L][2] = pPos[L][2] >> VTKKW_FPMM_SHIFT;                      \
+    pMMValid[L] = mapper->CheckMinMaxVolumeFlag( pMMPos[L], 0 );        \
+    }                                                                   \
+  if ( !pMMValid[L] )                                                   \
+    {                                                                   \
+    continue;                                                           \
+    }
+
+#define VTKKWRCHelper_PacketMIPSpaceLeapCheck( L, MAXIDX, MAXIDXDEF )   \
+  if ( pPos[L][0] >> VTKKW_FPMM_SHIFT != pMMPos[L][0] ||                \
+       pPos[L][1] >> VTKKW_FPMM_SHIFT != pMMPos[L][1] ||                \
+       pPos[L][2] >> VTKKW_FPMM_SHIFT != pMMPos[L][2] )                 \
+    {                                                                   \
+    pMMPos[L][0] = pPos[L][0] >> VTKKW_FPMM_SHIFT;                      \
+    pMMPos[L][1] = pPos[L][1] >> VTKKW_FPMM_SHIFT;                      \
+    pMMPos[L][2] = pPos[L][2] >> VTKKW_FPMM_SHIFT;                      \
+    pMMValid[L] = (MAXIDXDEF)?                                          \
+      (mapper->CheckMIPMinMaxVolumeFlag( pMMPos[L], 0, MAXIDX )):(1);   \
+    }                                                                   \
+  if ( !pMMValid[L] )                                                   \
+    {                                                                   \
+    continue;                                                           \
+    }
+
+#define VTKKWRCHelper_PacketCroppingCheck( L )                          \
+  if ( cropping )                                                       \
+    {                                                                   \
+    if ( mapper->CheckIfCropped( pPos[L] ) )                            \
+      {                                                                 \
+      continue;                                                         \
+      }                                                                 \
+    }
+
+// Fetch the 8 scalars of the cell of the lane if it changed, with
+// scale/shift unless SIMPLE
+#define VTKKWRCHelper_PacketGetCellScalarValues( L, DATA, SIMPLE, SCALE, SHIFT ) \
+  mapper->ShiftVectorDown( pPos[L], spos );                             \
+  if ( spos[0] != pOldSPos[L][0] ||                                     \
+       spos[1] != pOldSPos[L][1] ||                                     \
+       spos[2] != pOldSPos[L][2] )                                      \
+    {                                                                   \
+    pOldSPos[L][0] = spos[0];                                           \
+    pOldSPos[L][1] = spos[1];                                           \
+    pOldSPos[L][2] = spos[2];                                           \
+    dptr = DATA + spos[0]*inc[0] + spos[1]*inc[1] + spos[2]*inc[2];     \
+    if ( SIMPLE )                                                       \
+      {                                                                 \
+      pA[L] = static_cast<unsigned int >(*(dptr     ));                 \
+      pB[L] = static_cast<unsigned int >(*(dptr+Binc));                 \
+      pC[L] = static_cast<unsigned int >(*(dptr+Cinc));                 \
+      pD[L] = static_cast<unsigned int >(*(dptr+Dinc));                 \
+      pE[L] = static_cast<unsigned int >(*(dptr+Einc));                 \
+      pF[L] = static_cast<unsigned int >(*(dptr+Finc));                 \
+      pG[L] = static_cast<unsigned int >(*(dptr+Ginc));                 \
+      pH[L] = static_cast<unsigned int >(*(dptr+Hinc));                 \
+      }                                                                 \
+    else                                                                \
+      {                                                                 \
+      pA[L] = static_cast<unsigned int >(SCALE*(*(dptr     ) + SHIFT)); \
+      pB[L] = static_cast<unsigned int >(SCALE*(*(dptr+Binc) + SHIFT)); \
+      pC[L] = static_cast<unsigned int >(SCALE*(*(dptr+Cinc) + SHIFT)); \
+      pD[L] = static_cast<unsigned int >(SCALE*(*(dptr+Dinc) + SHIFT)); \
+      pE[L] = static_cast<unsigned int >(SCALE*(*(dptr+Einc) + SHIFT)); \
+      pF[L] = static_cast<unsigned int >(SCALE*(*(dptr+Finc) + SHIFT)); \
+      pG[L] = static_cast<unsigned int >(SCALE*(*(dptr+Ginc) + SHIFT)); \
+      pH[L] = static_cast<unsigned int >(SCALE*(*(dptr+Hinc) + SHIFT)); \
+      }                                                                 \
+    }
+
+// Same as VTKKWRCHelper_ComputeWeights() and
+// VTKKWRCHelper_InterpolateScalar() for all the lanes
+#define VTKKWRCHelper_PacketInterpolateScalars()                        \
+  for ( l = 0; l < VTKKWRCHelper_PacketSize; l++ )                      \
+    {                                                                   \
+    unsigned int w2X = (pPos[l][0]&VTKKW_FP_MASK);                      \
+    unsigned int w2Y = (pPos[l][1]&VTKKW_FP_MASK);                      \
+    unsigned int w2Z = (pPos[l][2]&VTKKW_FP_MASK);                      \
+    unsigned int w1X = ((~w2X)&VTKKW_FP_MASK);                          \
+    unsigned int w1Y = ((~w2Y)&VTKKW_FP_MASK);                          \
+    unsigned int w1Z = ((~w2Z)&VTKKW_FP_MASK);                          \
+    unsigned int w1Xw1Y = (0x4000+(w1X*w1Y))>>VTKKW_FP_SHIFT;           \
+    unsigned int w2Xw1Y = (0x4000+(w2X*w1Y))>>VTKKW_FP_SHIFT;           \
+    unsigned int w1Xw2Y = (0x4000+(w1X*w2Y))>>VTKKW_FP_SHIFT;           \
+    unsigned int w2Xw2Y = (0x4000+(w2X*w2Y))>>VTKKW_FP_SHIFT;           \
+    pVal[l] = static_cast<unsigned short>(                              \
+      (0x7fff + ((pA[l]*((0x4000 + w1Xw1Y*w1Z)>>VTKKW_FP_SHIFT)) +      \
+                 (pB[l]*((0x4000 + w2Xw1Y*w1Z)>>VTKKW_FP_SHIFT)) +      \
+                 (pC[l]*((0x4000 + w1Xw2Y*w1Z)>>VTKKW_FP_SHIFT)) +      \
+                 (pD[l]*((0x4000 + w2Xw2Y*w1Z)>>VTKKW_FP_SHIFT)) +      \
+                 (pE[l]*((0x4000 + w1Xw1Y*w2Z)>>VTKKW_FP_SHIFT)) +      \
+                 (pF[l]*((0x4000 + w2Xw1Y*w2Z)>>VTKKW_FP_SHIFT)) +      \
+                 (pG[l]*((0x4000 + w1Xw2Y*w2Z)>>VTKKW_FP_SHIFT)) +      \
+                 (pH[l]*((0x4000 + w2Xw2Y*w2Z)>>VTKKW_FP_SHIFT)))) >> VTKKW_FP_SHIFT); \
+    }
+
+// A lane stops at the end of its ray or when TERMINATED
+#define VTKKWRCHelper_PacketCheckTermination( TERMINATED )              \
+  numberOfActiveRays = 0;                                               \
+  for ( l = 0; l < VTKKWRCHelper_PacketSize; l++ )                      \
+    {                                                                   \
+    pActive[l] = pActive[l] && k+1 < pNumSteps[l] && !(TERMINATED);     \
+    numberOfActiveRays += pActive[l];                                   \
+    }
+
+#define VTKKWRCHelper_PacketIncrementAndLoopEnd()                       \
+      }                                                                 \
+    if ( j%32 == 0 && threadID==0 )                                     \
+      {                                                                 \
+      float fargs[1];                                                   \
+      fargs[0] = static_cast<float>(j)/static_cast<float>(imageInUseSize[1]-1); \
+      mapper->InvokeEvent( vtkCommand::ProgressEvent, fargs );          \
+      }                                                                 \
+    }
+
 #include "vtkObject.h"
 #include "VolumeRenderingReplacementsExport.h"
 
@@ -394,6 +394,97 @@ void vtkSlicerFixedPointMIPHelperGenerateImageOneTrilin( T *dataPtr,
   VTKKWRCHelper_IncrementAndLoopEnd();
 }
 
+// This method is used when the interpolation type is linear and the data
+// has one unsigned short or short component. It renders the same image as
+// vtkSlicerFixedPointMIPHelperGenerateImageOneSimpleTrilin() (SIMPLE) and
+// vtkSlicerFixedPointMIPHelperGenerateImageOneTrilin() but casts
+// VTKKWRCHelper_PacketSize neighbor rays of a row together.
+template <class T>
+void vtkSlicerFixedPointMIPHelperGenerateImageOneTrilinPacket( T *dataPtr,
+                                                   int threadID,
+                                                   int threadCount,
+                                                   vtkSlicerFixedPointVolumeRayCastMapper *mapper,
+                                                   vtkVolume *vtkNotUsed(vol))
+{
+  VTKKWRCHelper_PacketLoopStartTrilin();
+
+  const int simple = ( scale[0] == 1.0 && shift[0] == 0.0 );
+  int            maxValueDefined[VTKKWRCHelper_PacketSize];
+  unsigned short maxValue[VTKKWRCHelper_PacketSize];
+  unsigned short maxIdx[VTKKWRCHelper_PacketSize];
+  for ( l = 0; l < VTKKWRCHelper_PacketSize; l++ )
+    {
+    maxValueDefined[l] = 0;
+    maxValue[l] = 0;
+    maxIdx[l] = 0;
+    }
+
+  for ( k = 0; k < maxSteps; k++ )
+    {
+    for ( l = 0; l < VTKKWRCHelper_PacketSize; l++ )
+      {
+      pSample[l] = 0;
+      if ( !pActive[l] )
+        {
+        continue;
+        }
+      VTKKWRCHelper_PacketMoveToNextSample( l );
+      VTKKWRCHelper_PacketMIPSpaceLeapCheck( l, maxIdx[l], maxValueDefined[l] );
+      VTKKWRCHelper_PacketCroppingCheck( l );
+      VTKKWRCHelper_PacketGetCellScalarValues( l, dataPtr, simple, scale[0], shift[0] );
+      if ( simple && maxValueDefined[l] )
+        {
+        // the interpolated value can't exceed the cell maximum
+        unsigned short maxScalar = (pA[l]>pB[l])?(pA[l]):(pB[l]);
+        maxScalar = (pC[l]>maxScalar)?(pC[l]):(maxScalar);
+        maxScalar = (pD[l]>maxScalar)?(pD[l]):(maxScalar);
+        maxScalar = (pE[l]>maxScalar)?(pE[l]):(maxScalar);
+        maxScalar = (pF[l]>maxScalar)?(pF[l]):(maxScalar);
+        maxScalar = (pG[l]>maxScalar)?(pG[l]):(maxScalar);
+        maxScalar = (pH[l]>maxScalar)?(pH[l]):(maxScalar);
+        if ( maxScalar <= maxValue[l] )
+          {
+          continue;
+          }
+        }
+      pSample[l] = 1;
+      }
+
+    VTKKWRCHelper_PacketInterpolateScalars();
+
+    for ( l = 0; l < VTKKWRCHelper_PacketSize; l++ )
+      {
+      if ( pSample[l] && ( !maxValueDefined[l] || pVal[l] > maxValue[l] ) )
+        {
+        maxValue[l] = pVal[l];
+        maxIdx[l] = maxValue[l];
+        maxValueDefined[l] = 1;
+        }
+      }
+
+    VTKKWRCHelper_PacketCheckTermination( 0 );
+    if ( !numberOfActiveRays )
+      {
+      break;
+      }
+    }
+
+  for ( l = 0; l < numberOfRays; l++ )
+    {
+    unsigned short *pixelPtr = imagePtr + 4*l;
+    if ( maxValueDefined[l] )
+      {
+      VTKKWRCHelper_LookupColorMax( colorTable[0], scalarOpacityTable[0], maxIdx[l], pixelPtr );
+      }
+    else
+      {
+      pixelPtr[0] = pixelPtr[1] = pixelPtr[2] = pixelPtr[3] = 0;
+      }
+    }
+
+  VTKKWRCHelper_PacketIncrementAndLoopEnd();
+}
+
 // This method is used when the interpolation type is linear, the data has 
 // two or four components and the components are not considered independent. 
 // For four component d>>(VTKKW_FP_SHIFT - 8));ata, the data must be unsigned char in type. In the
@@ -607,8 +698,19 @@ void vtkSlicerFixedPointVolumeRayCastMIPHelper::GenerateImage( int threadID,
     // One component
     if ( mapper->GetInput()->GetNumberOfScalarComponents() == 1 )
       {
+      // Unsigned short or short - packets of rays
+      if ( scalarType == VTK_UNSIGNED_SHORT )
+        {
+        vtkSlicerFixedPointMIPHelperGenerateImageOneTrilinPacket(
+          static_cast<unsigned short *>(dataPtr), threadID, threadCount, mapper, vol );
+        }
+      else if ( scalarType == VTK_SHORT )
+        {
+        vtkSlicerFixedPointMIPHelperGenerateImageOneTrilinPacket(
+          static_cast<short *>(dataPtr), threadID, threadCount, mapper, vol );
+        }
       // Scale == 1.0 and shift == 0.0 - simple case (faster)
-      if ( mapper->GetTableScale()[0] == 1.0 && mapper->GetTableShift()[0] == 0.0 )
+      else if ( mapper->GetTableScale()[0] == 1.0 && mapper->GetTableShift()[0] == 0.0 )
         {
         switch ( scalarType )
           {
@@ -40,6 +40,9 @@ PURPOSE.  See the above copyright notice for more information.
 #include "vtkVolumeProperty.h"
 #include "vtkSlicerFixedPointRayCastImage.h"
 
+#include <cstring>
+#include <vector>
+
 
 vtkCxxRevisionMacro(vtkSlicerFixedPointVolumeRayCastMapper, "$Revision: 1.20.4.1 $");
 vtkStandardNewMacro(vtkSlicerFixedPointVolumeRayCastMapper);
@@ -81,19 +84,27 @@ template <class T>
 void vtkSlicerFixedPointVolumeRayCastMapperFillInMinMaxVolume( T *dataPtr, unsigned short *minMaxVolume,
                                                               int fullDim[3], int smallDim[4],
                                                               int independent, int components,
-                                                              float *shift, float *scale )
+                                                              float *shift, float *scale,
+                                                              int zStart, int zLimit )
 {
     int i, j, k, c;
     int sx1, sx2, sy1, sy2, sz1, sz2;
     int x, y, z;
 
-    T *dptr = dataPtr;
+    // Only fill in the min/max slices [zStart, zLimit[, they are made of the
+    // input slices [4*zStart, 4*zLimit]
+    int kStart = 4*zStart;
+    int kLimit = (4*zLimit+1 < fullDim[2])?(4*zLimit+1):(fullDim[2]);
+
+    T *dptr = dataPtr + static_cast<vtkIdType>(kStart)*fullDim[0]*fullDim[1]*components;
 
-    for ( k = 0; k < fullDim[2]; k++ )
+    for ( k = kStart; k < kLimit; k++ )
     {
         sz1 = (k < 1)?(0):(static_cast<int>((k-1)/4));
         sz2 =              static_cast<int>((k  )/4);
         sz2 = ( k == fullDim[2]-1 )?(sz1):(sz2);
+        sz1 = (sz1 < zStart)?(zStart):(sz1);
+        sz2 = (sz2 > zLimit-1)?(zLimit-1):(sz2);
         for ( j = 0; j < fullDim[1]; j++ )
         {
             sy1 = (j < 1)?(0):(static_cast<int>((j-1)/4));
@@ -152,7 +163,8 @@ void vtkSlicerFixedPointVolumeRayCastMapperComputeGradients( T *dataPtr,
                                                             unsigned short **gradientNormal,
                                                             unsigned char  **gradientMagnitude,
                                                             vtkDirectionEncoder *directionEncoder,
-                                                            vtkSlicerFixedPointVolumeRayCastMapper *me )
+                                                            vtkSlicerFixedPointVolumeRayCastMapper *me,
+                                                            int thread_id, int thread_count )
 {
     int                 x, y, z, c;
     int                 x_start, x_limit;
@@ -169,10 +181,6 @@ void vtkSlicerFixedPointVolumeRayCastMapperComputeGradients( T *dataPtr,
     unsigned char       *magPtr, *cmagPtr;
 
 
-
-
-    me->InvokeEvent( vtkCommand::VolumeMapperComputeGradientsStartEvent, NULL );
-
     double avgSpacing = (spacing[0]+spacing[1]+spacing[2])/3.0;
 
     // adjust the aspect
@@ -212,9 +220,6 @@ void vtkSlicerFixedPointVolumeRayCastMapperComputeGradients( T *dataPtr,
     }
 
 
-    int thread_id = 0;
-    int thread_count = 1;
-
     x_start = 0;
     x_limit = dim[0];
     y_start = 0;
@@ -384,7 +389,9 @@ void vtkSlicerFixedPointVolumeRayCastMapperComputeGradients( T *dataPtr,
                 magPtr  +=   increment;
             }
         }
-        if ( z%8 == 7 )
+        // The first thread runs in the calling thread, it reports the
+        // progress of its slab for all of them
+        if ( thread_id == 0 && z%8 == 7 )
         {
             float args[1];
             args[0] =
@@ -393,8 +400,148 @@ void vtkSlicerFixedPointVolumeRayCastMapperComputeGradients( T *dataPtr,
             me->InvokeEvent( vtkCommand::VolumeMapperComputeGradientsProgressEvent, args );
         }
     }
+}
+
+// Split size slices into thread_count slabs, return the slab of thread_id
+static void vtkSlicerFixedPointVolumeRayCastMapperComputeSlab( int thread_id, int thread_count,
+                                                              int size, int &start, int &limit )
+{
+    start = static_cast<int>( static_cast<vtkIdType>(size) * thread_id / thread_count );
+    limit = static_cast<int>( static_cast<vtkIdType>(size) * (thread_id + 1) / thread_count );
+}
+
+// Arguments shared by the threads computing the gradients and the min/max
+// volume, each thread works on a slab of slices.
+struct vtkSlicerFixedPointVolumeRayCastMapperPrecomputeArgs
+{
+    vtkSlicerFixedPointVolumeRayCastMapper *Mapper;
+    void   *DataPtr;
+    int     ScalarType;
+    int     Dimensions[3];
+    double  Spacing[3];
+    int     Components;
+    int     Independent;
+    double  ScalarRange[4][2];
+
+    // Min/max volume: same bits as needToUpdate in UpdateMinMaxVolume()
+    int     NeedToUpdate;
+    // recompute the flags of all the cells, otherwise only the cells
+    // whose scalar range intersects ChangedRange
+    int     UpdateAllFlags;
+    int     ChangedRange[4][2];
+    unsigned short MinNonZeroScalarIndex[4];
+    unsigned char  MinNonZeroGradientMagnitudeIndex[4];
+    // number of non zero opacity entries before each scalar index
+    std::vector<int> NonZeroScalarOpacityCount[4];
+};
+
+VTK_THREAD_RETURN_TYPE SlicerFixedPointVolumeRayCastMapper_ComputeGradients( void *arg )
+{
+    int threadID    = ((vtkMultiThreader::ThreadInfo *)(arg))->ThreadID;
+    int threadCount = ((vtkMultiThreader::ThreadInfo *)(arg))->NumberOfThreads;
+    vtkSlicerFixedPointVolumeRayCastMapperPrecomputeArgs *args =
+        static_cast<vtkSlicerFixedPointVolumeRayCastMapperPrecomputeArgs *>(
+        ((vtkMultiThreader::ThreadInfo *)(arg))->UserData);
+    vtkSlicerFixedPointVolumeRayCastMapper *me = args->Mapper;
+
+    switch ( args->ScalarType )
+    {
+        vtkTemplateMacro(
+            vtkSlicerFixedPointVolumeRayCastMapperComputeGradients(
+            (VTK_TT *)(args->DataPtr), args->Dimensions, args->Spacing,
+            args->Components, args->Independent, args->ScalarRange,
+            me->GradientNormal,
+            me->GradientMagnitude,
+            me->DirectionEncoder,
+            me, threadID, threadCount) );
+    }
+    return VTK_THREAD_RETURN_VALUE;
+}
+
+VTK_THREAD_RETURN_TYPE SlicerFixedPointVolumeRayCastMapper_UpdateMinMaxVolume( void *arg )
+{
+    int threadID    = ((vtkMultiThreader::ThreadInfo *)(arg))->ThreadID;
+    int threadCount = ((vtkMultiThreader::ThreadInfo *)(arg))->NumberOfThreads;
+    vtkSlicerFixedPointVolumeRayCastMapperPrecomputeArgs *args =
+        static_cast<vtkSlicerFixedPointVolumeRayCastMapperPrecomputeArgs *>(
+        ((vtkMultiThreader::ThreadInfo *)(arg))->UserData);
+    vtkSlicerFixedPointVolumeRayCastMapper *me = args->Mapper;
+
+    // The slabs are made of min/max slices so that no two threads write
+    // the same cell, the input slices at the slab borders are read twice.
+    int *smallDim = me->MinMaxVolumeSize;
+    int zStart, zLimit;
+    vtkSlicerFixedPointVolumeRayCastMapperComputeSlab( threadID, threadCount,
+                                                      smallDim[2], zStart, zLimit );
+    if ( zStart >= zLimit )
+    {
+        return VTK_THREAD_RETURN_VALUE;
+    }
+
+    vtkIdType sliceSize = static_cast<vtkIdType>(3) * smallDim[0] * smallDim[1] * smallDim[3];
+    unsigned short *slabPtr = me->MinMaxVolume + zStart * sliceSize;
+    unsigned short *slabEnd = me->MinMaxVolume + zLimit * sliceSize;
+    unsigned short *tmpPtr;
+
+    if ( args->NeedToUpdate&0x02 )
+    {
+        // Initialize the structure
+        for ( tmpPtr = slabPtr; tmpPtr < slabEnd; tmpPtr += 3 )
+        {
+            tmpPtr[0] = 0xffff;  // Min Scalar
+            tmpPtr[1] = 0;       // Max Scalar
+            tmpPtr[2] = 0;       // Max Gradient Magnitude and
+        }                        // Flag computed from transfer functions
+
+        // Now put the scalar data values into the structure
+        switch ( args->ScalarType )
+        {
+            vtkTemplateMacro(
+                vtkSlicerFixedPointVolumeRayCastMapperFillInMinMaxVolume(
+                (VTK_TT *)(args->DataPtr), me->MinMaxVolume, args->Dimensions, smallDim,
+                args->Independent, args->Components, me->TableShift, me->TableScale,
+                zStart, zLimit) );
+        }
+    }
+
+    if ( args->NeedToUpdate&0x04 )
+    {
+        // Now put the gradient magnitude values into the structure
+        me->FillInMaxGradientMagnitudes( args->Dimensions, smallDim, zStart, zLimit );
+    }
+
+    // Update the flags now
+    int c = 0;
+    for ( tmpPtr = slabPtr; tmpPtr < slabEnd; tmpPtr += 3 )
+    {
+        unsigned short minScalar = tmpPtr[0];
+        unsigned short maxScalar = tmpPtr[1];
+        if ( args->UpdateAllFlags ||
+             ( minScalar <= args->ChangedRange[c][1] &&
+               maxScalar >= args->ChangedRange[c][0] ) )
+        {
+            tmpPtr[2] &= 0xff00;
+            // We definitely have 0 opacity because our maximum scalar value in
+            // this region is below the minimum scalar value with non-zero opacity
+            // for this component, or because we are using gradient magnitudes and
+            // the maximum gradient magnitude in this area is below the minimum
+            // gradient magnitude with non-zero opacity for this component.
+            // Otherwise non-zero opacity entries between the min and max
+            // scalar values set the flag.
+            if ( maxScalar >= args->MinNonZeroScalarIndex[c] &&
+                 !( me->GradientOpacityRequired &&
+                    (tmpPtr[2]>>8) < args->MinNonZeroGradientMagnitudeIndex[c] ) &&
+                 minScalar <= maxScalar &&
+                 args->NonZeroScalarOpacityCount[c][maxScalar + 1] -
+                 args->NonZeroScalarOpacityCount[c][minScalar] > 0 )
+            {
+                tmpPtr[2] |= 0x0001;
+            }
+        }
+        c = ( c + 1 == smallDim[3] )?(0):(c + 1);
+    }
 
-    me->InvokeEvent( vtkCommand::VolumeMapperComputeGradientsEndEvent, NULL );
+    return VTK_THREAD_RETURN_VALUE;
 }
 
 // Construct a new vtkSlicerFixedPointVolumeRayCastMapper with default values
@@ -505,6 +652,12 @@ vtkSlicerFixedPointVolumeRayCastMapper::vtkSlicerFixedPointVolumeRayCastMapper()
     this->MinMaxVolumeSize[2] = 0;
     this->MinMaxVolumeSize[3] = 0;
     this->SavedMinMaxInput = NULL;
+    this->SavedMinMaxGradientOpacityRequired = -1;
+    for ( i = 0; i < 4; i++ )
+    {
+        this->SavedMinNonZeroGradientMagnitudeIndex[i] = 0;
+        memset( this->SavedNonZeroScalarOpacity[i], 0, 32768 );
+    }
 
     this->Volume = NULL;
     //SLICERADD
@@ -774,18 +927,24 @@ int vtkSlicerFixedPointVolumeRayCastMapper::GetNumberOfThreads()
 }
 
 void vtkSlicerFixedPointVolumeRayCastMapper::FillInMaxGradientMagnitudes( int fullDim[3],
-                                                                         int smallDim[4] )
+                                                                         int smallDim[4],
+                                                                         int zStart,
+                                                                         int zLimit )
 {
     int i, j, k, c;
     int sx1, sx2, sy1, sy2, sz1, sz2;
     int x, y, z;
 
+    int kStart = 4*zStart;
+    int kLimit = (4*zLimit+1 < fullDim[2])?(4*zLimit+1):(fullDim[2]);
 
-    for ( k = 0; k < fullDim[2]; k++ )
+    for ( k = kStart; k < kLimit; k++ )
     {
         sz1 = (k < 1)?(0):(static_cast<int>((k-1)/4));
         sz2 =              static_cast<int>((k  )/4);
         sz2 = ( k == fullDim[2]-1 )?(sz1):(sz2);
+        sz1 = (sz1 < zStart)?(zStart):(sz1);
+        sz2 = (sz2 > zLimit-1)?(zLimit-1):(sz2);
 
         unsigned char *dptr = this->GradientMagnitude[k];
 
@@ -836,7 +995,7 @@ void vtkSlicerFixedPointVolumeRayCastMapper::FillInMaxGradientMagnitudes( int fu
 // as well as the last built time for the color tables.
 void vtkSlicerFixedPointVolumeRayCastMapper::UpdateMinMaxVolume( vtkVolume *vol )
 {
-    int i, j, k, c;
+    int i, c;
 
     // A three bit variable:
     //   first bit indicates need to update flags
@@ -870,11 +1029,9 @@ void vtkSlicerFixedPointVolumeRayCastMapper::UpdateMinMaxVolume( vtkVolume *vol
     }
 
     // Have the parameters changed which means the flags need
-    // to be recomputed. Actually, we could be checking just
-    // a subset of these parameters (we don't need to recompute
-    // the flags if the colors change, but unless these seems
-    // like a significant performance problem, I'd rather not
-    // complicate the code)
+    // to be recomputed. Only the zero / non-zero opacity entries matter,
+    // the cells affected by a change of the transfer functions are found
+    // below.
     if ( !(needToUpdate&0x01) &&
         this->SavedParametersMTime.GetMTime() >
         this->SavedMinMaxFlagTime.GetMTime() )
@@ -888,6 +1045,17 @@ void vtkSlicerFixedPointVolumeRayCastMapper::UpdateMinMaxVolume( vtkVolume *vol
         return;
     }
 
+    vtkSlicerFixedPointVolumeRayCastMapperPrecomputeArgs args;
+    args.Mapper       = this;
+    args.DataPtr      = input->GetScalarPointer();
+    args.ScalarType   = input->GetScalarType();
+    args.Dimensions[0] = dim[0];
+    args.Dimensions[1] = dim[1];
+    args.Dimensions[2] = dim[2];
+    args.Components   = components;
+    args.Independent  = independent;
+    args.NeedToUpdate = needToUpdate;
+
     // Regenerate the min max values if necessary
     if ( needToUpdate&0x02 )
     {
@@ -935,51 +1103,17 @@ void vtkSlicerFixedPointVolumeRayCastMapper::UpdateMinMaxVolume( vtkVolume *vol
             this->MinMaxVolumeSize[1] = targetSize[1];
             this->MinMaxVolumeSize[2] = targetSize[2];
             this->MinMaxVolumeSize[3] = targetSize[3];
-
-            // Initialize the structure
-            unsigned short *tmpPtr = this->MinMaxVolume;
-            for ( i = 0; i < targetSize[0] * targetSize[1] * targetSize[2]; i++ )
-            {
-                for ( j = 0; j < targetSize[3]; j++ )
-                {
-                    *(tmpPtr++) = 0xffff;  // Min Scalar
-                    *(tmpPtr++) = 0;       // Max Scalar
-                    *(tmpPtr++) = 0;       // Max Gradient Magnitude and
-                }                      // Flag computed from transfer functions
-            }
-
-            // Now put the scalar data values into the structure
-            int scalarType   = input->GetScalarType();
-            void *dataPtr = input->GetScalarPointer();
-
-            switch ( scalarType )
-            {
-                vtkTemplateMacro(
-                    vtkSlicerFixedPointVolumeRayCastMapperFillInMinMaxVolume(
-                    (VTK_TT *)(dataPtr), this->MinMaxVolume, dim, targetSize,
-                    independent, components, this->TableShift, this->TableScale) );
-            }
         }
-
-        this->SavedMinMaxInput = input;
-        this->SavedMinMaxBuildTime.Modified();
-    }
-
-    if ( needToUpdate&0x04 )
-    {
-        // Now put the gradient magnitude values into the structure
-        this->FillInMaxGradientMagnitudes( dim, this->MinMaxVolumeSize );
-
-        // It is OK to use this same variable for scalars and gradient magnitudes - either
-        // we just rebuilt the min max volume from the scalars, or the MTime on the input
-        // is already less than this build time so updating it again won't matter for
-        // future checks
-        this->SavedMinMaxBuildTime.Modified();
+        // The structure is initialized and filled in by the threads
     }
 
-    // Update the flags now
-    unsigned short *minNonZeroScalarIndex = new unsigned short [this->MinMaxVolumeSize[3]];
-    for ( c = 0; c < this->MinMaxVolumeSize[3]; c++ )
+    // Find the first scalar and gradient magnitude with non-zero opacity,
+    // and what changed since the flags were last computed
+    int numberOfComponents = this->MinMaxVolumeSize[3];
+    args.UpdateAllFlags = (needToUpdate&0x06) ||
+        this->SavedMinMaxGradientOpacityRequired != this->GradientOpacityRequired;
+    int flagsChanged = args.UpdateAllFlags;
+    for ( c = 0; c < numberOfComponents; c++ )
     {
         for ( i = 0; i < this->TableSize[c]; i++ )
         {
@@ -988,12 +1122,8 @@ void vtkSlicerFixedPointVolumeRayCastMapper::UpdateMinMaxVolume( vtkVolume *vol
                 break;
             }
         }
-        minNonZeroScalarIndex[c] = i;
-    }
+        args.MinNonZeroScalarIndex[c] = i;
 
-    unsigned char *minNonZeroGradientMagnitudeIndex = new unsigned char [this->MinMaxVolumeSize[3]];
-    for ( c = 0; c < this->MinMaxVolumeSize[3]; c++ )
-    {
         for ( i = 0; i < 256; i++ )
         {
             if ( this->GradientOpacityTable[c][i] )
@@ -1001,82 +1131,58 @@ void vtkSlicerFixedPointVolumeRayCastMapper::UpdateMinMaxVolume( vtkVolume *vol
                 break;
             }
         }
-        minNonZeroGradientMagnitudeIndex[c] = i;
-    }
-
-    unsigned short *tmpPtr = this->MinMaxVolume;
-    int zero = 0;
-    int nonZero = 0;
+        args.MinNonZeroGradientMagnitudeIndex[c] = i;
+        if ( this->GradientOpacityRequired &&
+             i != this->SavedMinNonZeroGradientMagnitudeIndex[c] )
+        {
+            args.UpdateAllFlags = 1;
+        }
+        this->SavedMinNonZeroGradientMagnitudeIndex[c] = i;
 
-    for ( k = 0; k < this->MinMaxVolumeSize[2]; k++ )
-    {
-        for ( j = 0; j < this->MinMaxVolumeSize[1]; j++ )
+        // The min/max values index the whole table (the scalar indices
+        // are stored on 16 bits)
+        std::vector<int> &count = args.NonZeroScalarOpacityCount[c];
+        count.resize( 65537 );
+        count[0] = 0;
+        args.ChangedRange[c][0] = VTK_INT_MAX;
+        args.ChangedRange[c][1] = -1;
+        for ( i = 0; i < 65536; i++ )
         {
-            for ( i = 0; i < this->MinMaxVolumeSize[0]; i++ )
+            unsigned char nonZero = ( i < 32768 && this->ScalarOpacityTable[c][i] ) ? 1 : 0;
+            count[i + 1] = count[i] + nonZero;
+            if ( i < 32768 && nonZero != this->SavedNonZeroScalarOpacity[c][i] )
             {
-                for ( c = 0; c < this->MinMaxVolumeSize[3]; c++ )
-                {
-                    // We definite have 0 opacity because our maximum scalar value in
-                    // this region is below the minimum scalar value with non-zero opacity
-                    // for this component
-                    if ( tmpPtr[1] < minNonZeroScalarIndex[c] )
-                    {
-                        tmpPtr[2] &= 0xff00;
-                        zero++;
-                    }
-                    // We have 0 opacity because we are using gradient magnitudes and
-                    // the maximum gradient magnitude in this area is below the minimum
-                    // gradient magnitude with non-zero opacity for this component
-                    else if ( this->GradientOpacityRequired &&
-                        (tmpPtr[2]>>8) < minNonZeroGradientMagnitudeIndex[c] )
-                    {
-                        tmpPtr[2] &= 0xff00;
-                        zero++;
-                    }
-                    // We definitely have non-zero opacity because our minimum scalar
-                    // value is lower than our first scalar with non-zero opacity, and
-                    // the maximum scalar value is greater than this threshold - so
-                    // we must encounter scalars with opacity in between
-                    else if ( tmpPtr[0] < minNonZeroScalarIndex[c] )
-                    {
-                        tmpPtr[2] &= 0xff00;
-                        tmpPtr[2] |= 0x0001;
-                        nonZero++;
-                    }
-                    // We have to search between min scalar value and the
-                    // max scalar stored in the minmax volume to look for non-zero
-                    // opacity since both values must be above our first non-zero
-                    // threshold so we don't have information in this area
-                    else
-                    {
-                        int loop;
-                        for ( loop = tmpPtr[0]; loop <= tmpPtr[1]; loop++ )
-                        {
-                            if ( this->ScalarOpacityTable[c][loop] )
-                            {
-                                break;
-                            }
-                        }
-                        if ( loop <= tmpPtr[1] )
-                        {
-                            tmpPtr[2] &= 0xff00;
-                            tmpPtr[2] |= 0x0001;
-                            nonZero++;
-                        }
-                        else
-                        {
-                            tmpPtr[2] &= 0xff00;
-                            zero++;
-                        }
-                    }
-                    tmpPtr += 3;
-                }
+                args.ChangedRange[c][0] =
+                    (args.ChangedRange[c][0] < i)?(args.ChangedRange[c][0]):(i);
+                args.ChangedRange[c][1] = i;
+                this->SavedNonZeroScalarOpacity[c][i] = nonZero;
             }
         }
+        flagsChanged |= ( args.ChangedRange[c][1] >= 0 );
     }
+    flagsChanged |= args.UpdateAllFlags;
+    this->SavedMinMaxGradientOpacityRequired = this->GradientOpacityRequired;
 
-    this->SavedMinMaxFlagTime.Modified();
+    // Moving the opacity function without changing which entries are
+    // transparent (or editing the colors) doesn't change the flags
+    if ( flagsChanged && this->MinMaxVolume )
+    {
+        this->Threader->SetSingleMethod( SlicerFixedPointVolumeRayCastMapper_UpdateMinMaxVolume,
+                                         static_cast<void *>(&args) );
+        this->Threader->SingleMethodExecute();
+    }
 
+    if ( needToUpdate&0x06 )
+    {
+        // It is OK to use this same variable for scalars and gradient magnitudes - either
+        // we just rebuilt the min max volume from the scalars, or the MTime on the input
+        // is already less than this build time so updating it again won't matter for
+        // future checks
+        this->SavedMinMaxInput = input;
+        this->SavedMinMaxBuildTime.Modified();
+    }
+
+    this->SavedMinMaxFlagTime.Modified();
 }
 
 void vtkSlicerFixedPointVolumeRayCastMapper::UpdateCroppingRegions()
@@ -2627,17 +2733,31 @@ void vtkSlicerFixedPointVolumeRayCastMapper::ComputeGradients( vtkVolume *vol )
 
 
 
-    switch ( scalarType )
+    // The slices are split among the threads
+    vtkSlicerFixedPointVolumeRayCastMapperPrecomputeArgs args;
+    args.Mapper       = this;
+    args.DataPtr      = dataPtr;
+    args.ScalarType   = scalarType;
+    args.Components   = components;
+    args.Independent  = independent;
+    for ( i = 0; i < 3; i++ )
     {
-        vtkTemplateMacro(
-            vtkSlicerFixedPointVolumeRayCastMapperComputeGradients(
-            (VTK_TT *)(dataPtr), dim, spacing, components,
-            independent, scalarRange,
-            this->GradientNormal,
-            this->GradientMagnitude,
-            this->DirectionEncoder,
-            this) );
+        args.Dimensions[i] = dim[i];
+        args.Spacing[i]    = spacing[i];
     }
+    for ( c = 0; c < components; c++ )
+    {
+        args.ScalarRange[c][0] = scalarRange[c][0];
+        args.ScalarRange[c][1] = scalarRange[c][1];
+    }
+
+    this->InvokeEvent( vtkCommand::VolumeMapperComputeGradientsStartEvent, NULL );
+
+    this->Threader->SetSingleMethod( SlicerFixedPointVolumeRayCastMapper_ComputeGradients,
+                                     static_cast<void *>(&args) );
+    this->Threader->SingleMethodExecute();
+
+    this->InvokeEvent( vtkCommand::VolumeMapperComputeGradientsEndEvent, NULL );
 }
 
 int vtkSlicerFixedPointVolumeRayCastMapper::UpdateShadingTable( vtkRenderer *ren,
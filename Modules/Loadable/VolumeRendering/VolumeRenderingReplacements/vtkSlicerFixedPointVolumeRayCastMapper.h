@@ -85,6 +85,8 @@ class vtkSlicerFixedPointRayCastImage;
 
 // Forward declaration needed for use by friend declaration below.
 VTK_THREAD_RETURN_TYPE SlicerFixedPointVolumeRayCastMapper_CastRays( void *arg );
+VTK_THREAD_RETURN_TYPE SlicerFixedPointVolumeRayCastMapper_ComputeGradients( void *arg );
+VTK_THREAD_RETURN_TYPE SlicerFixedPointVolumeRayCastMapper_UpdateMinMaxVolume( void *arg );
 
 /// \ingroup Slicer_QtModules_VolumeRendering
 class Q_SLICER_QTMODULES_VOLUMERENDERING_REPLACEMENTS_EXPORT vtkSlicerFixedPointVolumeRayCastMapper : public vtkVolumeMapper
@@ -301,6 +303,8 @@ protected:
   void CaptureZBuffer( vtkRenderer *ren );
 
   friend VTK_THREAD_RETURN_TYPE SlicerFixedPointVolumeRayCastMapper_CastRays( void *arg );
+  friend VTK_THREAD_RETURN_TYPE SlicerFixedPointVolumeRayCastMapper_ComputeGradients( void *arg );
+  friend VTK_THREAD_RETURN_TYPE SlicerFixedPointVolumeRayCastMapper_UpdateMinMaxVolume( void *arg );
 
   vtkMultiThreader  *Threader;
 
@@ -438,9 +442,19 @@ protected:
   vtkTimeStamp    SavedMinMaxGradientTime;
   vtkTimeStamp    SavedMinMaxFlagTime;
 
+  // Transfer functions the flags were computed with, to only update the
+  // cells affected by a change of the opacity
+  unsigned char   SavedNonZeroScalarOpacity[4][32768];
+  int             SavedMinNonZeroGradientMagnitudeIndex[4];
+  int             SavedMinMaxGradientOpacityRequired;
+
+  // Description:
+  // Build the min/max volume and its flags, the work is split in slabs
+  // of slices among the threads.
   void            UpdateMinMaxVolume( vtkVolume *vol );
   void            FillInMaxGradientMagnitudes( int fullDim[3],
-                                               int smallDim[3] );
+                                               int smallDim[3],
+                                               int zStart, int zLimit );
 
 private:
   vtkSlicerFixedPointVolumeRayCastMapper(const vtkSlicerFixedPointVolumeRayCastMapper&);  // Not implemented.
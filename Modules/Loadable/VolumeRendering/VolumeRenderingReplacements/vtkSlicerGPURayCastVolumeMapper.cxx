@@ -15,11 +15,19 @@
 
 
 =========================================================================*/
+#include <algorithm>
+#include <cmath>
+#include <list>
+#include <map>
 #include <sstream>
+#include <vector>
 
 #include "vtkSlicerGPURayCastVolumeMapper.h"
 
+#include "vtkCommand.h"
 #include "vtkImageData.h"
+#include "vtkMultiThreader.h"
+#include "vtkMutexLock.h"
 #include "vtkObjectFactory.h"
 #include "vtkPlaneCollection.h"
 #include "vtkRenderWindow.h"
@@ -36,6 +44,428 @@ vtkCxxRevisionMacro(vtkSlicerGPURayCastVolumeMapper, "$Revision: 1.2 $");
 vtkStandardNewMacro(vtkSlicerGPURayCastVolumeMapper);
 //#endif
 
+// Edge length in voxels of the bricks used for empty space skipping
+static const int vtkSlicerGPURayCastBrickSize = 8;
+// Edge length in voxels of the bricks paged in by the bricked rendering
+static const int vtkSlicerGPURayCastPageBrickSize = 32;
+// The coarsest pyramid level is not smaller than this along its largest axis
+static const int vtkSlicerGPURayCastPyramidMinDimension = 64;
+// Bytes of the volume textures uploaded per frame by the asynchronous upload
+static const int vtkSlicerGPURayCastUploadBytesPerFrame = 16*1024*1024;
+
+//----------------------------------------------------------------------------
+// Bookkeeping of the bricks resident in the atlas slots
+class vtkSlicerGPURayCastBrickCache
+{
+public:
+  vtkSlicerGPURayCastBrickCache()
+  {
+    int empty[3] = {0, 0, 0};
+    this->Reset(empty, empty);
+    this->MemoryInBytes = 0;
+  }
+
+  void Reset(const int brickDimensions[3], const int slotDimensions[3])
+  {
+    for (int i = 0; i < 3; i++)
+      {
+      this->BrickDimensions[i] = brickDimensions[i];
+      this->SlotDimensions[i] = slotDimensions[i];
+      }
+    int numberOfBricks = brickDimensions[0] * brickDimensions[1] * brickDimensions[2];
+    this->NumberOfSlots = slotDimensions[0] * slotDimensions[1] * slotDimensions[2];
+    this->BrickSlot.assign(numberOfBricks, -1);
+    this->SlotBrick.assign(this->NumberOfSlots, -1);
+    this->SlotLastUsed.assign(this->NumberOfSlots, 0);
+    this->PageTable.assign(4 * numberOfBricks, 0);
+    this->Frame = 0;
+    this->NumberOfRenderedBricks = 0;
+  }
+
+  // budget the atlases were allocated for
+  vtkIdType MemoryInBytes;
+
+  int BrickDimensions[3];
+  int SlotDimensions[3];
+  int NumberOfSlots;
+  // atlas slot of each brick, -1 if not resident
+  std::vector<int> BrickSlot;
+  // brick stored in each slot, -1 if free
+  std::vector<int> SlotBrick;
+  // last frame each slot was rendered, for the LRU eviction
+  std::vector<unsigned long> SlotLastUsed;
+  // RGBA page table: slot coordinates and resident flag
+  std::vector<unsigned char> PageTable;
+  std::vector<unsigned char> Staging;
+  unsigned long Frame;
+  int NumberOfRenderedBricks;
+};
+
+//----------------------------------------------------------------------------
+// Downsampled copies of Volume1 and Volume2, built in a background thread.
+// Level 0 points to the full resolution volumes of the mapper.
+class vtkSlicerGPURayCastVolumePyramid
+{
+public:
+  struct Level
+  {
+    int Dimensions[3];
+    const unsigned char *Volume1;
+    const unsigned char *Volume2;
+    std::vector<unsigned char> Volume1Data;
+    std::vector<unsigned char> Volume2Data;
+  };
+
+  vtkSlicerGPURayCastVolumePyramid()
+  {
+    this->Threader = vtkMultiThreader::New();
+    this->Lock = vtkMutexLock::New();
+    this->ThreadID = -1;
+    this->Abort = 0;
+    this->NumberOfBuiltLevels = 0;
+  }
+
+  ~vtkSlicerGPURayCastVolumePyramid()
+  {
+    this->Stop();
+    this->Threader->Delete();
+    this->Lock->Delete();
+  }
+
+  void Start(const unsigned char *volume1, const unsigned char *volume2,
+             const int dimensions[3])
+  {
+    this->Clear();
+    Level level;
+    level.Volume1 = volume1;
+    level.Volume2 = volume2;
+    for (int i = 0; i < 3; i++)
+      {
+      level.Dimensions[i] = dimensions[i];
+      }
+    this->Levels.push_back(level);
+    for (;;)
+      {
+      for (int i = 0; i < 3; i++)
+        {
+        level.Dimensions[i] = (level.Dimensions[i] + 1) / 2;
+        }
+      if (std::max(level.Dimensions[0], std::max(level.Dimensions[1], level.Dimensions[2])) <
+          vtkSlicerGPURayCastPyramidMinDimension)
+        {
+        break;
+        }
+      level.Volume1 = NULL;
+      level.Volume2 = NULL;
+      this->Levels.push_back(level);
+      }
+    this->NumberOfBuiltLevels = 1;
+    if (this->Levels.size() > 1)
+      {
+      this->Abort = 0;
+      this->ThreadID = this->Threader->SpawnThread(
+        vtkSlicerGPURayCastVolumePyramid::BuildThread, this);
+      }
+  }
+
+  void Stop()
+  {
+    if (this->ThreadID == -1)
+      {
+      return;
+      }
+    this->Abort = 1;
+    this->Threader->TerminateThread(this->ThreadID);
+    this->ThreadID = -1;
+  }
+
+  void Clear()
+  {
+    this->Stop();
+    this->Levels.clear();
+    this->NumberOfBuiltLevels = 0;
+  }
+
+  // Number of levels that can be rendered, including the full resolution
+  int GetNumberOfLevels()
+  {
+    this->Lock->Lock();
+    int numberOfLevels = this->NumberOfBuiltLevels;
+    this->Lock->Unlock();
+    return numberOfLevels;
+  }
+
+  static VTK_THREAD_RETURN_TYPE BuildThread(void *arg)
+  {
+    vtkSlicerGPURayCastVolumePyramid *self =
+      static_cast<vtkSlicerGPURayCastVolumePyramid *>(
+        static_cast<vtkMultiThreader::ThreadInfo *>(arg)->UserData);
+    for (size_t l = 1; l < self->Levels.size(); l++)
+      {
+      Level &level = self->Levels[l];
+      const Level &source = self->Levels[l - 1];
+      size_t size = 4 * static_cast<size_t>(level.Dimensions[0]) *
+        level.Dimensions[1] * level.Dimensions[2];
+      level.Volume1Data.resize(size);
+      level.Volume2Data.resize(size);
+      if (!self->Downsample(source.Volume1, source.Dimensions,
+                            &level.Volume1Data[0], level.Dimensions) ||
+          !self->Downsample(source.Volume2, source.Dimensions,
+                            &level.Volume2Data[0], level.Dimensions))
+        {
+        break;
+        }
+      level.Volume1 = &level.Volume1Data[0];
+      level.Volume2 = &level.Volume2Data[0];
+      self->Lock->Lock();
+      self->NumberOfBuiltLevels = static_cast<int>(l) + 1;
+      self->Lock->Unlock();
+      }
+    return VTK_THREAD_RETURN_VALUE;
+  }
+
+  // Average the 2x2x2 RGBA voxels of in into each voxel of out, return 0
+  // if aborted.
+  int Downsample(const unsigned char *in, const int inDims[3],
+                 unsigned char *out, const int outDims[3])
+  {
+    const size_t inRow = 4 * static_cast<size_t>(inDims[0]);
+    const size_t inSlice = inRow * inDims[1];
+    for (int k = 0; k < outDims[2]; k++)
+      {
+      if (this->Abort)
+        {
+        return 0;
+        }
+      size_t z[2] = {inSlice * (2 * k), inSlice * std::min(2 * k + 1, inDims[2] - 1)};
+      for (int j = 0; j < outDims[1]; j++)
+        {
+        size_t y[2] = {inRow * (2 * j), inRow * std::min(2 * j + 1, inDims[1] - 1)};
+        for (int i = 0; i < outDims[0]; i++)
+          {
+          size_t x[2] = {4 * static_cast<size_t>(2 * i),
+                         4 * static_cast<size_t>(std::min(2 * i + 1, inDims[0] - 1))};
+          for (int c = 0; c < 4; c++)
+            {
+            int sum = 4;
+            for (int n = 0; n < 8; n++)
+              {
+              sum += in[z[n >> 2] + y[(n >> 1) & 1] + x[n & 1] + c];
+              }
+            *(out++) = static_cast<unsigned char>(sum >> 3);
+            }
+          }
+        }
+      }
+    return 1;
+  }
+
+  std::vector<Level> Levels;
+
+  vtkMultiThreader *Threader;
+  int ThreadID;
+  volatile int Abort;
+  // guards NumberOfBuiltLevels
+  vtkMutexLock *Lock;
+  int NumberOfBuiltLevels;
+};
+
+//----------------------------------------------------------------------------
+// Computes Volume1 and Volume2 of the mapper in a background thread, the
+// textures are then uploaded in chunks by the mapper.
+class vtkSlicerGPURayCastVolumeLoader
+{
+public:
+  enum
+  {
+    Idle,
+    Computing,
+    Uploading
+  };
+
+  vtkSlicerGPURayCastVolumeLoader()
+  {
+    this->Threader = vtkMultiThreader::New();
+    this->Lock = vtkMutexLock::New();
+    this->ThreadID = -1;
+    this->Mapper = NULL;
+    this->Computed = 0;
+    this->State = Idle;
+  }
+
+  ~vtkSlicerGPURayCastVolumeLoader()
+  {
+    this->Stop();
+    this->Threader->Delete();
+    this->Lock->Delete();
+  }
+
+  // The volumes must have been allocated with PrepareVolumes()
+  void Start(vtkSlicerGPURayCastVolumeMapper *mapper)
+  {
+    this->Stop();
+    this->Mapper = mapper;
+    this->Computed = 0;
+    this->State = Computing;
+    this->ThreadID = this->Threader->SpawnThread(
+      vtkSlicerGPURayCastVolumeLoader::ComputeThread, this);
+  }
+
+  void Stop()
+  {
+    if (this->ThreadID == -1)
+      {
+      return;
+      }
+    this->Mapper->AbortComputeVolumes = 1;
+    this->Threader->TerminateThread(this->ThreadID);
+    this->ThreadID = -1;
+  }
+
+  // Stop the computation, the volumes are computed again at the next frame
+  void Cancel()
+  {
+    this->Stop();
+    this->State = Idle;
+  }
+
+  int IsComputed()
+  {
+    this->Lock->Lock();
+    int computed = this->Computed;
+    this->Lock->Unlock();
+    return computed;
+  }
+
+  static VTK_THREAD_RETURN_TYPE ComputeThread(void *arg)
+  {
+    vtkSlicerGPURayCastVolumeLoader *self =
+      static_cast<vtkSlicerGPURayCastVolumeLoader *>(
+        static_cast<vtkMultiThreader::ThreadInfo *>(arg)->UserData);
+    // the progress events can't be invoked from this thread
+    self->Mapper->ComputeVolumes(0);
+    int computed = !self->Mapper->AbortComputeVolumes;
+    self->Lock->Lock();
+    self->Computed = computed;
+    self->Lock->Unlock();
+    return VTK_THREAD_RETURN_VALUE;
+  }
+
+  vtkSlicerGPURayCastVolumeMapper *Mapper;
+  int State;
+
+  vtkMultiThreader *Threader;
+  int ThreadID;
+  // guards Computed
+  vtkMutexLock *Lock;
+  int Computed;
+};
+
+//----------------------------------------------------------------------------
+// Volume textures uploaded in an OpenGL context group, shared by the mappers
+// of the same input.
+struct vtkSlicerGPURayCastSharedTextures
+{
+  vtkRenderWindow *Context;
+  vtkImageData *Input;
+  unsigned long InputMTime;
+  int Dimensions[3];
+  GLuint Volume1Index;
+  GLuint Volume2Index;
+  int ReferenceCount;
+};
+
+class vtkSlicerGPURayCastTextureCache
+{
+public:
+  static vtkSlicerGPURayCastTextureCache *GetInstance()
+  {
+    static vtkSlicerGPURayCastTextureCache cache;
+    return &cache;
+  }
+
+  // First window of the group of contexts sharing their objects with window
+  vtkRenderWindow *GetContext(vtkRenderWindow *window)
+  {
+    std::map<vtkRenderWindow *, vtkRenderWindow *>::const_iterator it =
+      this->SharedContexts.find(window);
+    while (it != this->SharedContexts.end())
+      {
+      window = it->second;
+      it = this->SharedContexts.find(window);
+      }
+    return window;
+  }
+
+  // Return the textures of input in context and reference them, NULL if
+  // they are not uploaded in the context group
+  vtkSlicerGPURayCastSharedTextures *Acquire(vtkRenderWindow *context,
+                                             vtkImageData *input,
+                                             unsigned long inputMTime,
+                                             const int dimensions[3])
+  {
+    for (std::list<vtkSlicerGPURayCastSharedTextures>::iterator it =
+           this->Textures.begin(); it != this->Textures.end(); ++it)
+      {
+      if (it->Context == context && it->Input == input &&
+          it->InputMTime == inputMTime &&
+          std::equal(dimensions, dimensions + 3, it->Dimensions))
+        {
+        ++it->ReferenceCount;
+        return &(*it);
+        }
+      }
+    return NULL;
+  }
+
+  vtkSlicerGPURayCastSharedTextures *Add(vtkRenderWindow *context,
+                                         vtkImageData *input,
+                                         unsigned long inputMTime,
+                                         const int dimensions[3],
+                                         GLuint volume1Index,
+                                         GLuint volume2Index)
+  {
+    vtkSlicerGPURayCastSharedTextures textures;
+    textures.Context = context;
+    textures.Input = input;
+    textures.InputMTime = inputMTime;
+    std::copy(dimensions, dimensions + 3, textures.Dimensions);
+    textures.Volume1Index = volume1Index;
+    textures.Volume2Index = volume2Index;
+    textures.ReferenceCount = 1;
+    this->Textures.push_back(textures);
+    return &this->Textures.back();
+  }
+
+  // The textures are deleted with the last reference if deleteTextures is
+  // set, a context of the group must then be current.
+  void Release(vtkSlicerGPURayCastSharedTextures *textures, bool deleteTextures)
+  {
+    if (--textures->ReferenceCount > 0)
+      {
+      return;
+      }
+    if (deleteTextures)
+      {
+      GLuint indices[2] = {textures->Volume1Index, textures->Volume2Index};
+      glDeleteTextures(2, indices);
+      }
+    for (std::list<vtkSlicerGPURayCastSharedTextures>::iterator it =
+           this->Textures.begin(); it != this->Textures.end(); ++it)
+      {
+      if (&(*it) == textures)
+        {
+        this->Textures.erase(it);
+        break;
+        }
+      }
+  }
+
+  std::map<vtkRenderWindow *, vtkRenderWindow *> SharedContexts;
+  // list to keep the pointers to the elements valid
+  std::list<vtkSlicerGPURayCastSharedTextures> Textures;
+};
+
 vtkSlicerGPURayCastVolumeMapper::vtkSlicerGPURayCastVolumeMapper()
 {
   this->Initialized          =  0;
@@ -49,6 +479,7 @@ vtkSlicerGPURayCastVolumeMapper::vtkSlicerGPURayCastVolumeMapper()
   this->Volume1Index         =  0;
   this->Volume2Index         =  0;
   this->ColorLookupIndex         =  0;
+  this->OccupancyIndex           =  0;
   this->RayCastVertexShader      =  0;
   this->RayCastFragmentShader    =  0;
   this->RayCastProgram           =  0;
@@ -60,24 +491,82 @@ vtkSlicerGPURayCastVolumeMapper::vtkSlicerGPURayCastVolumeMapper()
   this->ICPESmoothness       = 0.5f;
 
   this->DistanceColorBlending   = 0.0f;
+
+  this->EmptySpaceSkipping   = 1;
+  this->BrickMinMax          = NULL;
+  this->BrickOccupancy       = NULL;
+  this->BrickDimensions[0]   = 0;
+  this->BrickDimensions[1]   = 0;
+  this->BrickDimensions[2]   = 0;
+
+  this->BrickedRendering     = 0;
+  this->MaxMemoryInBytes     = 256*1024*1024;
+  this->BrickCache           = new vtkSlicerGPURayCastBrickCache;
+
+  this->MultiResolution      = 1;
+  this->Pyramid              = new vtkSlicerGPURayCastVolumePyramid;
+  this->PyramidLevel         = 0;
+  this->InteractivePyramidLevel = 0;
+  this->Interacting          = 0;
+  this->PyramidVolume1Index  = 0;
+  this->PyramidVolume2Index  = 0;
+  this->UploadedPyramidLevel = 0;
+
+  this->AsynchronousUpload   = 1;
+  this->Loader               = new vtkSlicerGPURayCastVolumeLoader;
+  this->UploadedSlices       = 0;
+
+  this->SharedVolumeTextures = NULL;
+  this->VolumesInputMTime    = 0;
+
+  this->PreIntegration       = 0;
+  this->PreIntegrationTableComputed = 0;
+  this->PreIntegrationIndex  = 0;
+  this->GradientOpacityIndex = 0;
+
+  this->LastUploadedBytes    = 0;
+  this->LastUploadTime       = 0.0;
+  this->LastTransferFunctionTime = 0.0;
+  this->LastPreprocessingTime = 0.0;
 }
 
 vtkSlicerGPURayCastVolumeMapper::~vtkSlicerGPURayCastVolumeMapper()
 {
+  this->ClearBrickRanges();
+  delete this->BrickCache;
+  // stop the threads reading and writing Volume1 and Volume2
+  delete this->Pyramid;
+  delete this->Loader;
+  if ( this->SharedVolumeTextures )
+    {
+    // no context is current, the textures are only deleted by the
+    // ReleaseGraphicsResources() of the other mappers
+    vtkSlicerGPURayCastTextureCache::GetInstance()->Release(
+      this->SharedVolumeTextures, false);
+    }
 }
 
 // Release the graphics resources used by this texture.
 void vtkSlicerGPURayCastVolumeMapper::ReleaseGraphicsResources(vtkWindow
                                 *renWin)
 {
-  if (( this->Volume1Index || this->Volume2Index || this->ColorLookupIndex ) && renWin)
+  if (( this->Volume1Index || this->Volume2Index || this->ColorLookupIndex ||
+        this->OccupancyIndex || this->PyramidVolume1Index ||
+        this->PyramidVolume2Index || this->PreIntegrationIndex ||
+        this->GradientOpacityIndex ) && renWin)
     {
     static_cast<vtkRenderWindow *>(renWin)->MakeCurrent();
 #ifdef GL_VERSION_1_1
     // free any textures
+    this->ReleaseSharedVolumeTextures();
     this->DeleteTextureIndex( &this->Volume1Index );
     this->DeleteTextureIndex( &this->Volume2Index );
     this->DeleteTextureIndex( &this->ColorLookupIndex );
+    this->DeleteTextureIndex( &this->OccupancyIndex );
+    this->DeleteTextureIndex( &this->PyramidVolume1Index );
+    this->DeleteTextureIndex( &this->PyramidVolume2Index );
+    this->DeleteTextureIndex( &this->PreIntegrationIndex );
+    this->DeleteTextureIndex( &this->GradientOpacityIndex );
 #endif
     }
   if ( this->RayCastVertexShader || this->RayCastFragmentShader || this->RayCastProgram)
@@ -90,6 +579,17 @@ void vtkSlicerGPURayCastVolumeMapper::ReleaseGraphicsResources(vtkWindow
   this->Volume1Index     = 0;
   this->Volume2Index     = 0;
   this->ColorLookupIndex = 0;
+  this->OccupancyIndex   = 0;
+  this->PyramidVolume1Index  = 0;
+  this->PyramidVolume2Index  = 0;
+  this->UploadedPyramidLevel = 0;
+  this->PreIntegrationIndex  = 0;
+  this->GradientOpacityIndex = 0;
+  if ( this->Loader->State == vtkSlicerGPURayCastVolumeLoader::Uploading )
+    {
+    // the computed volumes are uploaded again from the first slice
+    this->Loader->State = vtkSlicerGPURayCastVolumeLoader::Computing;
+    }
   this->RayCastVertexShader   = 0;
   this->RayCastFragmentShader = 0;
   this->RayCastProgram    = 0;
@@ -100,6 +600,12 @@ void vtkSlicerGPURayCastVolumeMapper::ReleaseGraphicsResources(vtkWindow
 void vtkSlicerGPURayCastVolumeMapper::Render(vtkRenderer *ren, vtkVolume *vol)
 {
   ren->GetRenderWindow()->MakeCurrent();
+  this->RenderWindow = ren->GetRenderWindow();
+
+  this->LastUploadedBytes = 0;
+  this->LastUploadTime = 0.0;
+  this->LastTransferFunctionTime = 0.0;
+  this->LastPreprocessingTime = 0.0;
 
   if ( !this->Initialized )
   {
@@ -117,6 +623,7 @@ void vtkSlicerGPURayCastVolumeMapper::Render(vtkRenderer *ren, vtkVolume *vol)
     this->TimeToDraw = 0.0001;
   }
   
+  this->UpdatePyramidLevel(vol);
   this->AdaptivePerformanceControl();
   
   glPushAttrib(GL_ENABLE_BIT | GL_TEXTURE_BIT | GL_LIGHTING_BIT);
@@ -171,7 +678,7 @@ void vtkSlicerGPURayCastVolumeMapper::AdaptivePerformanceControl()
   this->RaySteps *= targetTime/(this->TimeToDraw*1.5);
   
   int dim[3];
-  this->GetVolumeDimensions(dim);
+  this->GetPyramidLevelDimensions(this->PyramidLevel, dim);
 
   float maxRaysteps = dim[0];
   maxRaysteps = maxRaysteps > dim[1] ? maxRaysteps : dim[1];
@@ -188,6 +695,64 @@ void vtkSlicerGPURayCastVolumeMapper::AdaptivePerformanceControl()
 //  cout.flush();
 }
 
+void vtkSlicerGPURayCastVolumeMapper::UpdatePyramidLevel(vtkVolume *vol)
+{
+  int numberOfLevels = 1;
+  if ( this->MultiResolution && !this->BrickedRendering )
+    {
+    numberOfLevels = std::max(this->Pyramid->GetNumberOfLevels(), 1);
+    }
+
+  // still frames are rendered at full resolution
+  int interacting = vol->GetAllocatedRenderTime() < 1.0;
+  if ( !interacting || numberOfLevels == 1 )
+    {
+    this->Interacting = interacting;
+    this->PyramidLevel = 0;
+    return;
+    }
+
+  // The first interactive frame starts from the level of the last
+  // interaction, the time of the still frame before is meaningless.
+  int level = std::min(this->InteractivePyramidLevel, numberOfLevels - 1);
+  if ( this->Interacting )
+    {
+    float targetTime = this->Framerate <= 0.01f ? 1.0f : 1.0 / this->Framerate;
+    int dim[3];
+    this->GetPyramidLevelDimensions(level, dim);
+    float maxRaysteps = 1.8f * std::max(dim[0], std::max(dim[1], dim[2]));
+
+    // Coarser level once the ray steps can't be reduced anymore, finer
+    // level when the frames are fast with the most ray steps.
+    if ( this->TimeToDraw > 1.1 * targetTime && this->RaySteps <= 200.0f &&
+         level < numberOfLevels - 1 )
+      {
+      level++;
+      }
+    else if ( this->TimeToDraw < 0.5 * targetTime && this->RaySteps >= maxRaysteps &&
+              level > 0 )
+      {
+      level--;
+      }
+    }
+  this->Interacting = 1;
+  this->InteractivePyramidLevel = level;
+  this->PyramidLevel = level;
+}
+
+void vtkSlicerGPURayCastVolumeMapper::GetPyramidLevelDimensions(int level, int dim[3])
+{
+  if ( level <= 0 || level >= static_cast<int>(this->Pyramid->Levels.size()) )
+    {
+    this->GetVolumeDimensions(dim);
+    return;
+    }
+  for (int i = 0; i < 3; i++)
+    {
+    dim[i] = this->Pyramid->Levels[level].Dimensions[i];
+    }
+}
+
 //needs to be cleaned, 2008/10/20, Yanling Liu
 void vtkSlicerGPURayCastVolumeMapper::SetupRayCastParameters(vtkRenderer *vtkNotUsed(pRen),
                                                                       vtkVolume *pVol)
@@ -452,133 +1017,1136 @@ void vtkSlicerGPURayCastVolumeMapper::SetupRayCastParameters(vtkRenderer *vtkNot
   matrix->Delete();
 }
 
-void vtkSlicerGPURayCastVolumeMapper::RenderGLSL( vtkRenderer *ren, vtkVolume *vol )
-{
-  //force shader program reinit in dual 3D view mode
-  if (vol->GetNumberOfConsumers() > 1)
-    this->InitializeRayCast();
-    
-  vtkgl::UseProgram(RayCastProgram);
+void vtkSlicerGPURayCastVolumeMapper::RenderGLSL( vtkRenderer *ren, vtkVolume *vol )
+{
+  //force shader program reinit in dual 3D view mode
+  if (vol->GetNumberOfConsumers() > 1)
+    this->InitializeRayCast();
+    
+  vtkgl::UseProgram(RayCastProgram);
+
+  if ( !this->SetupTextures( ren, vol ) )
+    {
+    // The volume is being loaded, render its outline instead and request
+    // another frame until the textures are uploaded.
+    this->SetupRayCastParameters(ren, vol);
+    vtkgl::UseProgram(0);
+    this->DrawVolumeOutline();
+
+    double progress = 0.0;
+    int dim[3];
+    this->GetVolumeDimensions(dim);
+    if ( this->Loader->State == vtkSlicerGPURayCastVolumeLoader::Uploading &&
+         dim[2] > 0 )
+      {
+      progress = static_cast<double>(this->UploadedSlices) / dim[2];
+      }
+    this->InvokeEvent(vtkCommand::VolumeMapperRenderProgressEvent, &progress);
+    return;
+    }
+  this->SetupRayCastParameters(ren, vol);
+  if (this->BrickedRendering)
+    {
+    this->UpdateBrickCache(ren, vol);
+    }
+
+  glEnable(GL_CULL_FACE);
+
+  // Start the timer now
+  this->Timer->StartTimer();
+  
+  this->DrawVolumeBBox();
+  glFinish();
+
+  this->Timer->StopTimer();
+  
+  vtkgl::UseProgram(0);
+}
+
+void vtkSlicerGPURayCastVolumeMapper::DeleteTextureIndex( GLuint *index )
+{
+  if (glIsTexture(*index))
+  {
+    GLuint tempIndex;
+    tempIndex = *index;
+    glDeleteTextures(1, &tempIndex);
+    *index = 0;
+  }
+}
+
+void vtkSlicerGPURayCastVolumeMapper::CreateTextureIndex( GLuint *index )
+{
+  GLuint tempIndex=0;
+  glGenTextures(1, &tempIndex);
+  *index = static_cast<long>(tempIndex);
+}
+
+void vtkSlicerGPURayCastVolumeMapper::Setup3DTextureParameters( vtkVolumeProperty *property )
+{
+  if ( property->GetInterpolationType() == VTK_NEAREST_INTERPOLATION )
+    {
+    glTexParameterf( vtkgl::TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
+    glTexParameterf( vtkgl::TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
+    }
+  else
+    {
+    glTexParameterf( vtkgl::TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+    glTexParameterf( vtkgl::TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+    }
+  glTexParameterf( vtkgl::TEXTURE_3D, vtkgl::TEXTURE_WRAP_R, GL_CLAMP );
+  glTexParameterf( vtkgl::TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP );
+  glTexParameterf( vtkgl::TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP );
+}
+
+int vtkSlicerGPURayCastVolumeMapper::UpdateVolumesAsynchronously(vtkVolume *vol,
+                                                                 int& uploaded)
+{
+  uploaded = 0;
+
+  vtkImageData *input = this->GetInput();
+  input->Update();
+  if ( this->NeedToUpdateVolumes() )
+    {
+    // the pyramid and loader threads read and write Volume1 and Volume2,
+    // PrepareVolumes() is about to reallocate them
+    this->Pyramid->Clear();
+    this->Loader->Cancel();
+    this->VolumesInputMTime = input->GetMTime();
+    this->PrepareVolumes();
+    if ( !this->AsynchronousUpload || this->BrickedRendering ||
+         vol->GetNumberOfConsumers() > 1 )
+      {
+      double startTime = vtkTimerLog::GetUniversalTime();
+      this->ComputeVolumes(1);
+      this->LastPreprocessingTime += vtkTimerLog::GetUniversalTime() - startTime;
+      return 1;
+      }
+    this->Loader->Start(this);
+    }
+
+  if ( this->Loader->State == vtkSlicerGPURayCastVolumeLoader::Idle )
+    {
+    return 0;
+    }
+  if ( this->Loader->State == vtkSlicerGPURayCastVolumeLoader::Computing )
+    {
+    if ( !this->Loader->IsComputed() )
+      {
+      return -1;
+      }
+    this->Loader->Stop();
+    this->Loader->State = vtkSlicerGPURayCastVolumeLoader::Uploading;
+    this->UploadedSlices = 0;
+    }
+
+  int dim[3];
+  this->GetVolumeDimensions(dim);
+  const size_t sliceSize = 4 * static_cast<size_t>(dim[0]) * dim[1];
+  if ( this->UploadedSlices == 0 )
+    {
+    if ( this->AcquireSharedVolumeTextures() )
+      {
+      // another mapper already uploaded the volume in this context group
+      this->Loader->State = vtkSlicerGPURayCastVolumeLoader::Idle;
+      uploaded = 1;
+      return 1;
+      }
+    vtkgl::ActiveTexture( vtkgl::TEXTURE7 );
+    this->DeleteTextureIndex(&this->Volume1Index);
+    this->CreateTextureIndex(&this->Volume1Index);
+    glBindTexture(vtkgl::TEXTURE_3D, this->Volume1Index);
+    vtkgl::TexImage3D( vtkgl::TEXTURE_3D, 0, GL_RGBA8, dim[0], dim[1], dim[2], 0,
+               GL_RGBA, GL_UNSIGNED_BYTE, NULL );
+
+    vtkgl::ActiveTexture( vtkgl::TEXTURE5 );
+    this->DeleteTextureIndex(&this->Volume2Index);
+    this->CreateTextureIndex(&this->Volume2Index);
+    glBindTexture(vtkgl::TEXTURE_3D, this->Volume2Index);
+    vtkgl::TexImage3D( vtkgl::TEXTURE_3D, 0, GL_RGBA8, dim[0], dim[1], dim[2], 0,
+               GL_RGBA, GL_UNSIGNED_BYTE, NULL );
+    }
+
+  // both volumes are uploaded for each slice
+  int numberOfSlices = std::max(1, static_cast<int>(
+    vtkSlicerGPURayCastUploadBytesPerFrame / (2 * sliceSize)));
+  numberOfSlices = std::min(numberOfSlices, dim[2] - this->UploadedSlices);
+  const size_t offset = sliceSize * this->UploadedSlices;
+
+  double startTime = vtkTimerLog::GetUniversalTime();
+  vtkgl::ActiveTexture( vtkgl::TEXTURE7 );
+  glBindTexture(vtkgl::TEXTURE_3D, this->Volume1Index);
+  vtkgl::TexSubImage3D( vtkgl::TEXTURE_3D, 0, 0, 0, this->UploadedSlices,
+                        dim[0], dim[1], numberOfSlices,
+                        GL_RGBA, GL_UNSIGNED_BYTE, this->Volume1 + offset );
+
+  vtkgl::ActiveTexture( vtkgl::TEXTURE5 );
+  glBindTexture(vtkgl::TEXTURE_3D, this->Volume2Index);
+  vtkgl::TexSubImage3D( vtkgl::TEXTURE_3D, 0, 0, 0, this->UploadedSlices,
+                        dim[0], dim[1], numberOfSlices,
+                        GL_RGBA, GL_UNSIGNED_BYTE, this->Volume2 + offset );
+  this->AddUploadStatistics( startTime,
+    static_cast<vtkIdType>(2 * sliceSize * numberOfSlices) );
+
+  this->UploadedSlices += numberOfSlices;
+  if ( this->UploadedSlices < dim[2] )
+    {
+    return -1;
+    }
+  this->Loader->State = vtkSlicerGPURayCastVolumeLoader::Idle;
+  this->ShareVolumeTextures();
+  uploaded = 1;
+  return 1;
+}
+
+int vtkSlicerGPURayCastVolumeMapper::AcquireSharedVolumeTextures()
+{
+  this->ReleaseSharedVolumeTextures();
+  int dim[3];
+  this->GetVolumeDimensions(dim);
+  vtkSlicerGPURayCastTextureCache *cache =
+    vtkSlicerGPURayCastTextureCache::GetInstance();
+  this->SharedVolumeTextures = cache->Acquire(
+    cache->GetContext(this->RenderWindow), this->GetInput(),
+    this->VolumesInputMTime, dim);
+  if ( !this->SharedVolumeTextures )
+    {
+    return 0;
+    }
+  this->DeleteTextureIndex(&this->Volume1Index);
+  this->DeleteTextureIndex(&this->Volume2Index);
+  this->Volume1Index = this->SharedVolumeTextures->Volume1Index;
+  this->Volume2Index = this->SharedVolumeTextures->Volume2Index;
+  return 1;
+}
+
+void vtkSlicerGPURayCastVolumeMapper::ShareVolumeTextures()
+{
+  int dim[3];
+  this->GetVolumeDimensions(dim);
+  vtkSlicerGPURayCastTextureCache *cache =
+    vtkSlicerGPURayCastTextureCache::GetInstance();
+  this->SharedVolumeTextures = cache->Add(
+    cache->GetContext(this->RenderWindow), this->GetInput(),
+    this->VolumesInputMTime, dim, this->Volume1Index, this->Volume2Index);
+}
+
+void vtkSlicerGPURayCastVolumeMapper::ReleaseSharedVolumeTextures()
+{
+  if ( !this->SharedVolumeTextures )
+    {
+    return;
+    }
+  vtkSlicerGPURayCastTextureCache::GetInstance()->Release(
+    this->SharedVolumeTextures, true);
+  this->SharedVolumeTextures = NULL;
+  // the textures are not owned by this mapper
+  this->Volume1Index = 0;
+  this->Volume2Index = 0;
+}
+
+void vtkSlicerGPURayCastVolumeMapper::ShareContext(vtkRenderWindow *window,
+                                                   vtkRenderWindow *sharedWindow)
+{
+  std::map<vtkRenderWindow *, vtkRenderWindow *> &sharedContexts =
+    vtkSlicerGPURayCastTextureCache::GetInstance()->SharedContexts;
+  if ( sharedWindow && sharedWindow != window )
+    {
+    sharedContexts[window] = sharedWindow;
+    }
+  else
+    {
+    sharedContexts.erase(window);
+    }
+}
+
+int vtkSlicerGPURayCastVolumeMapper::IsLoading()
+{
+  return this->Loader->State != vtkSlicerGPURayCastVolumeLoader::Idle;
+}
+
+void vtkSlicerGPURayCastVolumeMapper::AddUploadStatistics(double startTime,
+                                                          vtkIdType bytes)
+{
+  this->LastUploadTime += vtkTimerLog::GetUniversalTime() - startTime;
+  this->LastUploadedBytes += bytes;
+}
+
+int vtkSlicerGPURayCastVolumeMapper::SetupTextures(vtkRenderer *vtkNotUsed(ren),
+                                                             vtkVolume *vol )
+{
+  //0, 1, 2, 3
+  //7, 6, 5, 4
+  // Update the volume containing the 2 byte scalar / gradient magnitude
+  // copy texture into GPU memory every frame for Dual 3D view mode
+  int uploaded = 0;
+  int volumeUpdated = this->UpdateVolumesAsynchronously( vol, uploaded );
+  if ( volumeUpdated < 0 )
+    {
+    return 0;
+    }
+  int components = this->GetInput()->GetNumberOfScalarComponents();
+  if ( volumeUpdated )
+    {
+    this->ClearBrickRanges();
+    this->Pyramid->Clear();
+    this->UploadedPyramidLevel = 0;
+    }
+  if ( this->MultiResolution && !this->BrickedRendering &&
+       this->Pyramid->Levels.empty() )
+    {
+    int dim[3];
+    this->GetVolumeDimensions(dim);
+    this->Pyramid->Start(this->Volume1, this->Volume2, dim);
+    }
+  if ( this->BrickedRendering )
+    {
+    // The bricks are uploaded on demand in UpdateBrickCache()
+    if ( components == 1 && !this->BrickMinMax )
+      {
+      this->ComputeBrickMinMax();
+      }
+    if ( volumeUpdated || !this->Volume1Index || !this->Volume2Index ||
+         this->BrickCache->MemoryInBytes != this->MaxMemoryInBytes ||
+         vol->GetNumberOfConsumers() > 1)
+      {
+      this->AllocateBrickAtlases();
+      }
+    }
+  else if ( vol->GetNumberOfConsumers() <= 1 &&
+            ( ( volumeUpdated && !uploaded ) || !this->Volume1Index ||
+              !this->Volume2Index ) &&
+            this->AcquireSharedVolumeTextures() )
+    {
+    // the volume is already uploaded by another mapper
+    }
+  else if ( ( volumeUpdated && !uploaded ) || !this->Volume1Index ||
+            !this->Volume2Index || vol->GetNumberOfConsumers() > 1)
+    {
+    int dim[3];
+    this->GetVolumeDimensions(dim);
+
+    // the shared textures can't be replaced
+    this->ReleaseSharedVolumeTextures();
+    double startTime = vtkTimerLog::GetUniversalTime();
+    vtkgl::ActiveTexture( vtkgl::TEXTURE7 );
+    this->DeleteTextureIndex(&this->Volume1Index);
+    this->CreateTextureIndex(&this->Volume1Index);
+    glBindTexture(vtkgl::TEXTURE_3D, this->Volume1Index);
+    vtkgl::TexImage3D( vtkgl::TEXTURE_3D, 0, GL_RGBA8, dim[0], dim[1], dim[2], 0,
+               GL_RGBA, GL_UNSIGNED_BYTE, this->Volume1 );
+
+
+    vtkgl::ActiveTexture( vtkgl::TEXTURE5 );
+    this->DeleteTextureIndex(&this->Volume2Index);
+    this->CreateTextureIndex(&this->Volume2Index);
+    glBindTexture(vtkgl::TEXTURE_3D, this->Volume2Index);
+    vtkgl::TexImage3D( vtkgl::TEXTURE_3D, 0, GL_RGBA8, dim[0], dim[1], dim[2], 0,
+               GL_RGBA, GL_UNSIGNED_BYTE, this->Volume2 );
+    this->AddUploadStatistics( startTime,
+      2 * 4 * static_cast<vtkIdType>(dim[0]) * dim[1] * dim[2] );
+    if ( vol->GetNumberOfConsumers() <= 1 )
+      {
+      this->ShareVolumeTextures();
+      }
+    }
+
+  GLuint volume1Index = this->Volume1Index;
+  GLuint volume2Index = this->Volume2Index;
+  if ( this->PyramidLevel >= this->Pyramid->GetNumberOfLevels() )
+    {
+    // the pyramid is being rebuilt for a new volume
+    this->PyramidLevel = 0;
+    }
+  if ( this->PyramidLevel > 0 )
+    {
+    this->UploadPyramidLevel( vol, volume1Index, volume2Index );
+    }
+
+  vtkgl::ActiveTexture( vtkgl::TEXTURE7 );
+  glBindTexture(vtkgl::TEXTURE_3D, volume1Index);
+  this->Setup3DTextureParameters( vol->GetProperty() );
+
+  vtkgl::ActiveTexture( vtkgl::TEXTURE5 );
+  glBindTexture(vtkgl::TEXTURE_3D, volume2Index);
+  this->Setup3DTextureParameters( vol->GetProperty() );
+
+  vtkgl::ActiveTexture( vtkgl::TEXTURE6 );
+
+  // Update the dependent 2D color table mapping scalar value and
+  // gradient magnitude to RGBA
+  double startTime = vtkTimerLog::GetUniversalTime();
+  int colorLookupUpdated = this->UpdateColorLookup( vol );
+  this->LastTransferFunctionTime += vtkTimerLog::GetUniversalTime() - startTime;
+  if ( colorLookupUpdated || !this->ColorLookupIndex || vol ->GetNumberOfConsumers() > 1)
+    {
+    startTime = vtkTimerLog::GetUniversalTime();
+    this->DeleteTextureIndex( &this->ColorLookupIndex );
+
+    this->CreateTextureIndex( &this->ColorLookupIndex );
+    glBindTexture(GL_TEXTURE_2D, this->ColorLookupIndex);
+
+    glTexParameterf( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameterf( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+    glTexParameterf( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP );
+    glTexParameterf( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP );
+
+    glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA8, 256, 256, 0,
+          GL_RGBA, GL_UNSIGNED_BYTE, this->ColorLookup );
+    this->AddUploadStatistics( startTime, 256 * 256 * 4 );
+    }
+
+  vtkgl::ActiveTexture( vtkgl::TEXTURE6 );
+  glBindTexture(GL_TEXTURE_2D, this->ColorLookupIndex);
+
+  GLint loc = vtkgl::GetUniformLocation(RayCastProgram, "TextureVol");
+  if (loc >= 0)
+    vtkgl::Uniform1i(loc, 7);
+  loc = vtkgl::GetUniformLocation(RayCastProgram, "TextureVol1");
+  if (loc >= 0)
+    vtkgl::Uniform1i(loc, 5);
+  loc = vtkgl::GetUniformLocation(RayCastProgram, "TextureColorLookup");
+  if (loc >= 0)
+    vtkgl::Uniform1i(loc, 6);
+
+  if ( this->UsePreIntegration() )
+    {
+    this->UpdatePreIntegrationTextures( vol, colorLookupUpdated );
+    }
+
+  // Bricks without any visible voxel are skipped by the rays
+  if ( this->BrickedRendering )
+    {
+    if ( components == 1 && ( colorLookupUpdated || !this->BrickOccupancy ) )
+      {
+      this->ComputeOccupancy();
+      }
+    }
+  else
+    {
+    if ( !this->EmptySpaceSkipping || components != 1 )
+      {
+      return 1;
+      }
+    if ( !this->BrickMinMax )
+      {
+      this->ComputeBrickMinMax();
+      }
+    vtkgl::ActiveTexture( vtkgl::TEXTURE4 );
+    if ( volumeUpdated || colorLookupUpdated || !this->OccupancyIndex || vol->GetNumberOfConsumers() > 1)
+      {
+      this->UpdateOccupancy();
+      }
+    glBindTexture(vtkgl::TEXTURE_3D, this->OccupancyIndex);
+    }
+
+  int dim[3];
+  this->GetVolumeDimensions(dim);
+  const int brickSize = this->GetBrickSize();
+  GLfloat brickSizes[3];
+  GLfloat occupancyScale[3];
+  GLfloat volumeDimensions[3];
+  for (int i = 0; i < 3; i++)
+    {
+    brickSizes[i] = static_cast<GLfloat>(brickSize) / dim[i];
+    occupancyScale[i] = 1.0f / ((dim[i] + brickSize - 1) / brickSize);
+    volumeDimensions[i] = static_cast<GLfloat>(dim[i]);
+    }
+  loc = vtkgl::GetUniformLocation(RayCastProgram, "TextureOccupancy");
+  if (loc >= 0)
+    vtkgl::Uniform1i(loc, 4);
+  loc = vtkgl::GetUniformLocation(RayCastProgram, "BrickSize");
+  if (loc >= 0)
+    vtkgl::Uniform3fv(loc, 1, brickSizes);
+  loc = vtkgl::GetUniformLocation(RayCastProgram, "OccupancyScale");
+  if (loc >= 0)
+    vtkgl::Uniform3fv(loc, 1, occupancyScale);
+  if ( this->BrickedRendering )
+    {
+    GLfloat atlasScale[3];
+    for (int i = 0; i < 3; i++)
+      {
+      atlasScale[i] = 1.0f / (this->BrickCache->SlotDimensions[i] * (brickSize + 2));
+      }
+    loc = vtkgl::GetUniformLocation(RayCastProgram, "VolumeDimensions");
+    if (loc >= 0)
+      vtkgl::Uniform3fv(loc, 1, volumeDimensions);
+    loc = vtkgl::GetUniformLocation(RayCastProgram, "AtlasScale");
+    if (loc >= 0)
+      vtkgl::Uniform3fv(loc, 1, atlasScale);
+    loc = vtkgl::GetUniformLocation(RayCastProgram, "BrickVoxels");
+    if (loc >= 0)
+      vtkgl::Uniform1f(loc, static_cast<GLfloat>(brickSize));
+    }
+  return 1;
+}
+
+void vtkSlicerGPURayCastVolumeMapper::UploadPyramidLevel(vtkVolume *vol,
+                                                         GLuint& volume1Index,
+                                                         GLuint& volume2Index)
+{
+  // The full resolution stays resident, only the coarse level is uploaded
+  // when the level changes.
+  if ( this->UploadedPyramidLevel != this->PyramidLevel ||
+       !this->PyramidVolume1Index || !this->PyramidVolume2Index ||
+       vol->GetNumberOfConsumers() > 1 )
+    {
+    const vtkSlicerGPURayCastVolumePyramid::Level &level =
+      this->Pyramid->Levels[this->PyramidLevel];
+    const int *dim = level.Dimensions;
+
+    double startTime = vtkTimerLog::GetUniversalTime();
+    vtkgl::ActiveTexture( vtkgl::TEXTURE7 );
+    this->DeleteTextureIndex(&this->PyramidVolume1Index);
+    this->CreateTextureIndex(&this->PyramidVolume1Index);
+    glBindTexture(vtkgl::TEXTURE_3D, this->PyramidVolume1Index);
+    vtkgl::TexImage3D( vtkgl::TEXTURE_3D, 0, GL_RGBA8, dim[0], dim[1], dim[2], 0,
+               GL_RGBA, GL_UNSIGNED_BYTE, level.Volume1 );
+
+    vtkgl::ActiveTexture( vtkgl::TEXTURE5 );
+    this->DeleteTextureIndex(&this->PyramidVolume2Index);
+    this->CreateTextureIndex(&this->PyramidVolume2Index);
+    glBindTexture(vtkgl::TEXTURE_3D, this->PyramidVolume2Index);
+    vtkgl::TexImage3D( vtkgl::TEXTURE_3D, 0, GL_RGBA8, dim[0], dim[1], dim[2], 0,
+               GL_RGBA, GL_UNSIGNED_BYTE, level.Volume2 );
+    this->AddUploadStatistics( startTime,
+      2 * 4 * static_cast<vtkIdType>(dim[0]) * dim[1] * dim[2] );
+
+    this->UploadedPyramidLevel = this->PyramidLevel;
+    }
+  volume1Index = this->PyramidVolume1Index;
+  volume2Index = this->PyramidVolume2Index;
+}
+
+int vtkSlicerGPURayCastVolumeMapper::UsePreIntegration()
+{
+  return this->PreIntegration &&
+         this->GetInput()->GetNumberOfScalarComponents() == 1 &&
+         this->Technique != 2 && this->Technique != 3;
+}
+
+void vtkSlicerGPURayCastVolumeMapper::ComputePreIntegrationTable()
+{
+  // Extinction coefficient and color of the 256 scalars of Volume1, the
+  // scalars beyond ColorTableSize are transparent as in ColorLookup
+  const int tableSize = 256;
+  double tau[256];
+  double rgb[256][3];
+  for (int i = 0; i < tableSize; i++)
+    {
+    double opacity = 0.0;
+    rgb[i][0] = rgb[i][1] = rgb[i][2] = 0.0;
+    if ( i < this->ColorTableSize )
+      {
+      opacity = std::min(static_cast<double>(this->TempArray2[i]), 0.999);
+      for (int c = 0; c < 3; c++)
+        {
+        rgb[i][c] = this->SavedColorChannels == 1 ?
+          this->TempArray1[i] : this->TempArray1[3*i + c];
+        }
+      }
+    tau[i] = -log(1.0 - std::max(opacity, 0.0));
+    }
+
+  // Integrals of the extinction and of the weighted color from the first
+  // scalar, with a linear interpolation between the scalars
+  double tauIntegral[256];
+  double rgbIntegral[256][3];
+  tauIntegral[0] = 0.0;
+  rgbIntegral[0][0] = rgbIntegral[0][1] = rgbIntegral[0][2] = 0.0;
+  for (int i = 1; i < tableSize; i++)
+    {
+    tauIntegral[i] = tauIntegral[i-1] + 0.5 * (tau[i-1] + tau[i]);
+    for (int c = 0; c < 3; c++)
+      {
+      rgbIntegral[i][c] = rgbIntegral[i-1][c] +
+        0.5 * (tau[i-1] * rgb[i-1][c] + tau[i] * rgb[i][c]);
+      }
+    }
+
+  // The opacity of a segment is the one of a sample with the average
+  // extinction between its scalars, so that a constant segment has the
+  // opacity of ColorLookup.
+  unsigned char *ptr = this->PreIntegrationTable;
+  for (int back = 0; back < tableSize; back++)
+    {
+    for (int front = 0; front < tableSize; front++)
+      {
+      const int lo = std::min(front, back);
+      const int hi = std::max(front, back);
+      double segmentTau = tau[lo];
+      double color[3] = {rgb[lo][0], rgb[lo][1], rgb[lo][2]};
+      if ( hi > lo )
+        {
+        const double integral = tauIntegral[hi] - tauIntegral[lo];
+        segmentTau = integral / (hi - lo);
+        for (int c = 0; c < 3; c++)
+          {
+          color[c] = integral > 0.0 ?
+            (rgbIntegral[hi][c] - rgbIntegral[lo][c]) / integral :
+            0.5 * (rgb[lo][c] + rgb[hi][c]);
+          }
+        }
+      for (int c = 0; c < 3; c++)
+        {
+        *(ptr++) = static_cast<unsigned char>(
+          std::min(std::max(color[c], 0.0), 1.0) * 255.0 + 0.5);
+        }
+      *(ptr++) = static_cast<unsigned char>(
+        (1.0 - exp(-segmentTau)) * 255.0 + 0.5);
+      }
+    }
+  this->PreIntegrationTableComputed = 1;
+}
+
+void vtkSlicerGPURayCastVolumeMapper::UpdatePreIntegrationTextures(vtkVolume *vol,
+                                                                  int colorLookupUpdated)
+{
+  int tableUpdated = 0;
+  if ( colorLookupUpdated || !this->PreIntegrationTableComputed )
+    {
+    double startTime = vtkTimerLog::GetUniversalTime();
+    this->ComputePreIntegrationTable();
+    this->LastTransferFunctionTime += vtkTimerLog::GetUniversalTime() - startTime;
+    tableUpdated = 1;
+    }
+
+  vtkgl::ActiveTexture( vtkgl::TEXTURE3 );
+  if ( tableUpdated || !this->PreIntegrationIndex || vol->GetNumberOfConsumers() > 1 )
+    {
+    double startTime = vtkTimerLog::GetUniversalTime();
+    this->DeleteTextureIndex( &this->PreIntegrationIndex );
+    this->CreateTextureIndex( &this->PreIntegrationIndex );
+    glBindTexture(GL_TEXTURE_2D, this->PreIntegrationIndex);
+
+    glTexParameterf( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameterf( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+    glTexParameterf( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP );
+    glTexParameterf( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP );
+
+    glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA8, 256, 256, 0,
+          GL_RGBA, GL_UNSIGNED_BYTE, this->PreIntegrationTable );
+    this->AddUploadStatistics( startTime, 256 * 256 * 4 );
+    }
+  glBindTexture(GL_TEXTURE_2D, this->PreIntegrationIndex);
 
-  this->SetupTextures( ren, vol );
-  this->SetupRayCastParameters(ren, vol);
+  vtkgl::ActiveTexture( vtkgl::TEXTURE2 );
+  if ( tableUpdated || !this->GradientOpacityIndex || vol->GetNumberOfConsumers() > 1 )
+    {
+    double startTime = vtkTimerLog::GetUniversalTime();
+    unsigned char gradientOpacity[256];
+    for (int i = 0; i < 256; i++)
+      {
+      gradientOpacity[i] = static_cast<unsigned char>(
+        std::min(std::max(this->GradientOpacityTable[i], 0.0f), 1.0f) * 255.0 + 0.5);
+      }
+    this->DeleteTextureIndex( &this->GradientOpacityIndex );
+    this->CreateTextureIndex( &this->GradientOpacityIndex );
+    glBindTexture(GL_TEXTURE_1D, this->GradientOpacityIndex);
 
-  glEnable(GL_CULL_FACE);
+    glTexParameterf( GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameterf( GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+    glTexParameterf( GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, GL_CLAMP );
 
-  // Start the timer now
-  this->Timer->StartTimer();
-  
-  this->DrawVolumeBBox();
-  glFinish();
+    glTexImage1D( GL_TEXTURE_1D, 0, GL_LUMINANCE8, 256, 0,
+          GL_LUMINANCE, GL_UNSIGNED_BYTE, gradientOpacity );
+    this->AddUploadStatistics( startTime, 256 );
+    }
+  glBindTexture(GL_TEXTURE_1D, this->GradientOpacityIndex);
 
-  this->Timer->StopTimer();
-  
-  vtkgl::UseProgram(0);
+  GLint loc = vtkgl::GetUniformLocation(RayCastProgram, "TexturePreIntegration");
+  if (loc >= 0)
+    vtkgl::Uniform1i(loc, 3);
+  loc = vtkgl::GetUniformLocation(RayCastProgram, "TextureGradientOpacity");
+  if (loc >= 0)
+    vtkgl::Uniform1i(loc, 2);
 }
 
-void vtkSlicerGPURayCastVolumeMapper::DeleteTextureIndex( GLuint *index )
+int vtkSlicerGPURayCastVolumeMapper::GetBrickSize()
 {
-  if (glIsTexture(*index))
-  {
-    GLuint tempIndex;
-    tempIndex = *index;
-    glDeleteTextures(1, &tempIndex);
-    *index = 0;
-  }
+  return this->BrickedRendering ?
+    vtkSlicerGPURayCastPageBrickSize : vtkSlicerGPURayCastBrickSize;
 }
 
-void vtkSlicerGPURayCastVolumeMapper::CreateTextureIndex( GLuint *index )
+void vtkSlicerGPURayCastVolumeMapper::ClearBrickRanges()
 {
-  GLuint tempIndex=0;
-  glGenTextures(1, &tempIndex);
-  *index = static_cast<long>(tempIndex);
+  delete [] this->BrickMinMax;
+  this->BrickMinMax = NULL;
+  delete [] this->BrickOccupancy;
+  this->BrickOccupancy = NULL;
 }
 
-void vtkSlicerGPURayCastVolumeMapper::Setup3DTextureParameters( vtkVolumeProperty *property )
+void vtkSlicerGPURayCastVolumeMapper::ComputeBrickMinMax()
 {
-  if ( property->GetInterpolationType() == VTK_NEAREST_INTERPOLATION )
+  double startTime = vtkTimerLog::GetUniversalTime();
+  int dim[3];
+  this->GetVolumeDimensions(dim);
+
+  const int brickSize = this->GetBrickSize();
+  for (int i = 0; i < 3; i++)
     {
-    glTexParameterf( vtkgl::TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
-    glTexParameterf( vtkgl::TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
+    this->BrickDimensions[i] = (dim[i] + brickSize - 1) / brickSize;
     }
-  else
+  this->ClearBrickRanges();
+  this->BrickMinMax = new unsigned char[4 * this->BrickDimensions[0] *
+                                        this->BrickDimensions[1] * this->BrickDimensions[2]];
+
+  unsigned char *range = this->BrickMinMax;
+  int brick[3];
+  for (brick[2] = 0; brick[2] < this->BrickDimensions[2]; brick[2]++)
     {
-    glTexParameterf( vtkgl::TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
-    glTexParameterf( vtkgl::TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+    for (brick[1] = 0; brick[1] < this->BrickDimensions[1]; brick[1]++)
+      {
+      for (brick[0] = 0; brick[0] < this->BrickDimensions[0]; brick[0]++)
+        {
+        // Trilinear interpolation reaches one voxel around the brick, and
+        // the texture border (zero) on the sides of the volume.
+        int lo[3], hi[3];
+        bool border = false;
+        for (int i = 0; i < 3; i++)
+          {
+          lo[i] = brick[i] * brickSize - 1;
+          hi[i] = brick[i] * brickSize + brickSize;
+          if (lo[i] < 0)
+            {
+            lo[i] = 0;
+            border = true;
+            }
+          if (hi[i] > dim[i] - 1)
+            {
+            hi[i] = dim[i] - 1;
+            border = true;
+            }
+          }
+        unsigned char scalarMin = border ? 0 : 255;
+        unsigned char scalarMax = 0;
+        unsigned char gradientMin = border ? 0 : 255;
+        unsigned char gradientMax = 0;
+        for (int z = lo[2]; z <= hi[2]; z++)
+          {
+          for (int y = lo[1]; y <= hi[1]; y++)
+            {
+            const unsigned char *voxel =
+              this->Volume1 + 4 * (lo[0] + dim[0] * (y + dim[1] * z));
+            for (int x = lo[0]; x <= hi[0]; x++, voxel += 4)
+              {
+              scalarMin = voxel[0] < scalarMin ? voxel[0] : scalarMin;
+              scalarMax = voxel[0] > scalarMax ? voxel[0] : scalarMax;
+              gradientMin = voxel[3] < gradientMin ? voxel[3] : gradientMin;
+              gradientMax = voxel[3] > gradientMax ? voxel[3] : gradientMax;
+              }
+            }
+          }
+        *(range++) = scalarMin;
+        *(range++) = scalarMax;
+        *(range++) = gradientMin;
+        *(range++) = gradientMax;
+        }
+      }
     }
-  glTexParameterf( vtkgl::TEXTURE_3D, vtkgl::TEXTURE_WRAP_R, GL_CLAMP );
+  this->LastPreprocessingTime += vtkTimerLog::GetUniversalTime() - startTime;
+}
+
+void vtkSlicerGPURayCastVolumeMapper::ComputeOccupancy()
+{
+  // Part of the transfer function time, it only depends on ColorLookup
+  double startTime = vtkTimerLog::GetUniversalTime();
+  // Summed area table of the visible entries of the color lookup table,
+  // rows are gradient magnitudes, columns are scalars.
+  std::vector<int> visible(257 * 257, 0);
+  for (int g = 0; g < 256; g++)
+    {
+    int rowSum = 0;
+    for (int s = 0; s < 256; s++)
+      {
+      rowSum += this->ColorLookup[(g * 256 + s) * 4 + 3] > 0 ? 1 : 0;
+      visible[(g + 1) * 257 + s + 1] = visible[g * 257 + s + 1] + rowSum;
+      }
+    }
+
+  const int numberOfBricks = this->BrickDimensions[0] *
+    this->BrickDimensions[1] * this->BrickDimensions[2];
+  delete [] this->BrickOccupancy;
+  this->BrickOccupancy = new unsigned char[numberOfBricks];
+  const unsigned char *range = this->BrickMinMax;
+  for (int i = 0; i < numberOfBricks; i++, range += 4)
+    {
+    // Linear filtering of the lookup table blends the neighbor entries
+    int s0 = range[0] > 0 ? range[0] - 1 : 0;
+    int s1 = range[1] < 255 ? range[1] + 1 : 255;
+    int g0 = range[2] > 0 ? range[2] - 1 : 0;
+    int g1 = range[3] < 255 ? range[3] + 1 : 255;
+    int count = visible[(g1 + 1) * 257 + s1 + 1] - visible[g0 * 257 + s1 + 1]
+      - visible[(g1 + 1) * 257 + s0] + visible[g0 * 257 + s0];
+    this->BrickOccupancy[i] = count > 0 ? 255 : 0;
+    }
+  this->LastTransferFunctionTime += vtkTimerLog::GetUniversalTime() - startTime;
+}
+
+void vtkSlicerGPURayCastVolumeMapper::UpdateOccupancy()
+{
+  this->ComputeOccupancy();
+
+  double startTime = vtkTimerLog::GetUniversalTime();
+  this->DeleteTextureIndex( &this->OccupancyIndex );
+  this->CreateTextureIndex( &this->OccupancyIndex );
+  glBindTexture(vtkgl::TEXTURE_3D, this->OccupancyIndex);
+  glTexParameterf( vtkgl::TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
+  glTexParameterf( vtkgl::TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
   glTexParameterf( vtkgl::TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP );
   glTexParameterf( vtkgl::TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP );
+  glTexParameterf( vtkgl::TEXTURE_3D, vtkgl::TEXTURE_WRAP_R, GL_CLAMP );
+  glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+  vtkgl::TexImage3D( vtkgl::TEXTURE_3D, 0, GL_LUMINANCE8, this->BrickDimensions[0],
+             this->BrickDimensions[1], this->BrickDimensions[2], 0,
+             GL_LUMINANCE, GL_UNSIGNED_BYTE, this->BrickOccupancy );
+  glPixelStorei( GL_UNPACK_ALIGNMENT, 4 );
+  this->AddUploadStatistics( startTime, static_cast<vtkIdType>(this->BrickDimensions[0]) *
+    this->BrickDimensions[1] * this->BrickDimensions[2] );
 }
 
-void vtkSlicerGPURayCastVolumeMapper::SetupTextures(vtkRenderer *vtkNotUsed(ren),
-                                                             vtkVolume *vol )
+void vtkSlicerGPURayCastVolumeMapper::AllocateBrickAtlases()
 {
-  //0, 1, 2, 3
-  //7, 6, 5, 4
-  // Update the volume containing the 2 byte scalar / gradient magnitude
-  // copy texture into GPU memory every frame for Dual 3D view mode
-  if ( this->UpdateVolumes( vol ) || !this->Volume1Index || !this->Volume2Index || vol->GetNumberOfConsumers() > 1)
+  int dim[3];
+  this->GetVolumeDimensions(dim);
+  const int brickSize = vtkSlicerGPURayCastPageBrickSize;
+  const int slotSize = brickSize + 2;
+  int brickDimensions[3];
+  for (int i = 0; i < 3; i++)
     {
-    int dim[3];
-    this->GetVolumeDimensions(dim);
+    brickDimensions[i] = (dim[i] + brickSize - 1) / brickSize;
+    }
+  const int numberOfBricks =
+    brickDimensions[0] * brickDimensions[1] * brickDimensions[2];
+
+  // Two RGBA atlases (scalars and normals) share the budget left by the
+  // color lookup table and the page table.
+  const vtkIdType slotBytes = 2 * 4 * slotSize * slotSize * slotSize;
+  vtkIdType budget = this->MaxMemoryInBytes - 65536 * 4 - 4 * numberOfBricks;
+  vtkIdType numberOfSlots = budget / slotBytes;
+
+  GLint max3DTextureSize = 0;
+  glGetIntegerv( vtkgl::MAX_3D_TEXTURE_SIZE, &max3DTextureSize );
+  // slot coordinates are written in 8 bit page table entries
+  int maxSlotsPerAxis = max3DTextureSize / slotSize;
+  maxSlotsPerAxis = maxSlotsPerAxis > 256 ? 256 : maxSlotsPerAxis;
+  maxSlotsPerAxis = maxSlotsPerAxis < 1 ? 1 : maxSlotsPerAxis;
+
+  if (numberOfSlots > numberOfBricks)
+    {
+    numberOfSlots = numberOfBricks;
+    }
+  const vtkIdType maxSlots = static_cast<vtkIdType>(maxSlotsPerAxis) *
+    maxSlotsPerAxis * maxSlotsPerAxis;
+  if (numberOfSlots > maxSlots)
+    {
+    numberOfSlots = maxSlots;
+    }
+  if (numberOfSlots < 1)
+    {
+    vtkWarningMacro(<< "Not enough GPU memory for a single brick, "
+                    << this->MaxMemoryInBytes << " bytes available");
+    numberOfSlots = 1;
+    }
 
+  int slotDimensions[3];
+  GLenum error = GL_OUT_OF_MEMORY;
+  while (error == GL_OUT_OF_MEMORY)
+    {
+    // Arrange the slots as a cube
+    int n = static_cast<int>(numberOfSlots);
+    slotDimensions[0] = static_cast<int>(ceil(pow(static_cast<double>(n), 1. / 3.)));
+    slotDimensions[0] = slotDimensions[0] > maxSlotsPerAxis ? maxSlotsPerAxis : slotDimensions[0];
+    slotDimensions[1] = static_cast<int>(ceil(sqrt(static_cast<double>(n) / slotDimensions[0])));
+    slotDimensions[1] = slotDimensions[1] > maxSlotsPerAxis ? maxSlotsPerAxis : slotDimensions[1];
+    if (slotDimensions[0] * slotDimensions[1] > n)
+      {
+      slotDimensions[1] = n / slotDimensions[0];
+      }
+    slotDimensions[2] = n / (slotDimensions[0] * slotDimensions[1]);
+    slotDimensions[2] = slotDimensions[2] > maxSlotsPerAxis ? maxSlotsPerAxis : slotDimensions[2];
+
+    // Flush previous errors
+    while (glGetError() != GL_NO_ERROR)
+      {
+      }
+    this->ReleaseSharedVolumeTextures();
     vtkgl::ActiveTexture( vtkgl::TEXTURE7 );
     this->DeleteTextureIndex(&this->Volume1Index);
     this->CreateTextureIndex(&this->Volume1Index);
     glBindTexture(vtkgl::TEXTURE_3D, this->Volume1Index);
-    vtkgl::TexImage3D( vtkgl::TEXTURE_3D, 0, GL_RGBA8, dim[0], dim[1], dim[2], 0,
-               GL_RGBA, GL_UNSIGNED_BYTE, this->Volume1 );
-
-
+    vtkgl::TexImage3D( vtkgl::TEXTURE_3D, 0, GL_RGBA8, slotDimensions[0] * slotSize,
+               slotDimensions[1] * slotSize, slotDimensions[2] * slotSize, 0,
+               GL_RGBA, GL_UNSIGNED_BYTE, NULL );
     vtkgl::ActiveTexture( vtkgl::TEXTURE5 );
     this->DeleteTextureIndex(&this->Volume2Index);
     this->CreateTextureIndex(&this->Volume2Index);
     glBindTexture(vtkgl::TEXTURE_3D, this->Volume2Index);
-    vtkgl::TexImage3D( vtkgl::TEXTURE_3D, 0, GL_RGBA8, dim[0], dim[1], dim[2], 0,
-               GL_RGBA, GL_UNSIGNED_BYTE, this->Volume2 );
+    vtkgl::TexImage3D( vtkgl::TEXTURE_3D, 0, GL_RGBA8, slotDimensions[0] * slotSize,
+               slotDimensions[1] * slotSize, slotDimensions[2] * slotSize, 0,
+               GL_RGBA, GL_UNSIGNED_BYTE, NULL );
+    error = glGetError();
+    if (error == GL_OUT_OF_MEMORY)
+      {
+      if (numberOfSlots == 1)
+        {
+        vtkErrorMacro(<< "Failed to allocate the brick atlases");
+        break;
+        }
+      // The driver could not give us the budget, try with less
+      numberOfSlots /= 2;
+      }
     }
 
-  vtkgl::ActiveTexture( vtkgl::TEXTURE7 );
-  glBindTexture(vtkgl::TEXTURE_3D, this->Volume1Index);
-  this->Setup3DTextureParameters( vol->GetProperty() );
+  // The page table is recreated at the first upload
+  this->DeleteTextureIndex( &this->OccupancyIndex );
+  this->BrickCache->Reset(brickDimensions, slotDimensions);
+  this->BrickCache->MemoryInBytes = this->MaxMemoryInBytes;
+}
 
-  vtkgl::ActiveTexture( vtkgl::TEXTURE5 );
-  glBindTexture(vtkgl::TEXTURE_3D, this->Volume2Index);
-  this->Setup3DTextureParameters( vol->GetProperty() );
+void vtkSlicerGPURayCastVolumeMapper::UploadBrick(int brick, int slot)
+{
+  int dim[3];
+  this->GetVolumeDimensions(dim);
+  const int brickSize = vtkSlicerGPURayCastPageBrickSize;
+  const int slotSize = brickSize + 2;
+  const int *brickDimensions = this->BrickCache->BrickDimensions;
+  const int *slotDimensions = this->BrickCache->SlotDimensions;
+
+  // first voxel of the brick border
+  int origin[3];
+  origin[0] = (brick % brickDimensions[0]) * brickSize - 1;
+  origin[1] = ((brick / brickDimensions[0]) % brickDimensions[1]) * brickSize - 1;
+  origin[2] = (brick / (brickDimensions[0] * brickDimensions[1])) * brickSize - 1;
+  int offset[3];
+  offset[0] = (slot % slotDimensions[0]) * slotSize;
+  offset[1] = ((slot / slotDimensions[0]) % slotDimensions[1]) * slotSize;
+  offset[2] = (slot / (slotDimensions[0] * slotDimensions[1])) * slotSize;
+
+  // Voxels out of the volume are zero, as the border of the whole volume
+  // texture was.
+  int xMin = origin[0] < 0 ? 0 : origin[0];
+  int xMax = origin[0] + slotSize > dim[0] ? dim[0] : origin[0] + slotSize;
+  std::vector<unsigned char>& staging = this->BrickCache->Staging;
+  staging.resize(4 * slotSize * slotSize * slotSize);
+
+  double startTime = vtkTimerLog::GetUniversalTime();
+  unsigned char *volumes[2] = {this->Volume1, this->Volume2};
+  GLenum units[2] = {vtkgl::TEXTURE7, vtkgl::TEXTURE5};
+  GLuint indices[2] = {this->Volume1Index, this->Volume2Index};
+  for (int v = 0; v < 2; v++)
+    {
+    std::fill(staging.begin(), staging.end(), 0);
+    for (int k = 0; k < slotSize; k++)
+      {
+      int z = origin[2] + k;
+      if (z < 0 || z >= dim[2])
+        {
+        continue;
+        }
+      for (int j = 0; j < slotSize; j++)
+        {
+        int y = origin[1] + j;
+        if (y < 0 || y >= dim[1] || xMax <= xMin)
+          {
+          continue;
+          }
+        memcpy(&staging[4 * ((k * slotSize + j) * slotSize + xMin - origin[0])],
+               volumes[v] + 4 * ((z * dim[1] + y) * dim[0] + xMin),
+               4 * (xMax - xMin));
+        }
+      }
+    vtkgl::ActiveTexture( units[v] );
+    glBindTexture(vtkgl::TEXTURE_3D, indices[v]);
+    vtkgl::TexSubImage3D( vtkgl::TEXTURE_3D, 0, offset[0], offset[1], offset[2],
+                  slotSize, slotSize, slotSize, GL_RGBA, GL_UNSIGNED_BYTE, &staging[0] );
+    }
+  this->AddUploadStatistics( startTime, 2 * static_cast<vtkIdType>(staging.size()) );
+}
 
-  vtkgl::ActiveTexture( vtkgl::TEXTURE6 );
+void vtkSlicerGPURayCastVolumeMapper::UpdateBrickCache(vtkRenderer *vtkNotUsed(ren),
+                                                       vtkVolume *vol)
+{
+  vtkSlicerGPURayCastBrickCache *cache = this->BrickCache;
+  cache->Frame++;
 
-  // Update the dependent 2D color table mapping scalar value and
-  // gradient magnitude to RGBA
-  if ( this->UpdateColorLookup( vol ) || !this->ColorLookupIndex || vol ->GetNumberOfConsumers() > 1)
+  int dim[3];
+  this->GetVolumeDimensions(dim);
+  const int brickSize = vtkSlicerGPURayCastPageBrickSize;
+
+  // texture coordinates to clip coordinates
+  double bounds[6];
+  this->GetInput()->GetBounds(bounds);
+  vtkMatrix4x4 *textureToClip = vtkMatrix4x4::New();
+  textureToClip->Identity();
+  for (int i = 0; i < 3; i++)
     {
-    this->DeleteTextureIndex( &this->ColorLookupIndex );
+    textureToClip->SetElement(i, i, bounds[2*i+1] - bounds[2*i]);
+    textureToClip->SetElement(i, 3, bounds[2*i]);
+    }
+  vtkMatrix4x4 *matrix = vtkMatrix4x4::New();
+  vol->GetMatrix(matrix);
+  vtkMatrix4x4::Multiply4x4(matrix, textureToClip, textureToClip);
+  double glMatrix[16];
+  glGetDoublev(GL_MODELVIEW_MATRIX, glMatrix);
+  matrix->DeepCopy(glMatrix);
+  matrix->Transpose();
+  vtkMatrix4x4::Multiply4x4(matrix, textureToClip, textureToClip);
+  glGetDoublev(GL_PROJECTION_MATRIX, glMatrix);
+  matrix->DeepCopy(glMatrix);
+  matrix->Transpose();
+  vtkMatrix4x4::Multiply4x4(matrix, textureToClip, textureToClip);
+  matrix->Delete();
 
-    this->CreateTextureIndex( &this->ColorLookupIndex );
-    glBindTexture(GL_TEXTURE_2D, this->ColorLookupIndex);
+  // clipped bounds and eye position in texture coordinates
+  const double clipMin[3] = {this->ParaMatrix[4], this->ParaMatrix[5], this->ParaMatrix[6]};
+  const double clipMax[3] = {this->ParaMatrix[7], this->ParaMatrix[8], this->ParaMatrix[9]};
+  const double eye[3] = {this->ParaMatrix[0], this->ParaMatrix[1], this->ParaMatrix[2]};
 
-    glTexParameterf( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameterf( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
-    glTexParameterf( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP );
-    glTexParameterf( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP );
+  // MIP and MinIP look at all the bricks whatever their opacity
+  const unsigned char *occupancy =
+    (this->Technique == 2 || this->Technique == 3) ? NULL : this->BrickOccupancy;
 
-    glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA8, 256, 256, 0,
-          GL_RGBA, GL_UNSIGNED_BYTE, this->ColorLookup );
+  std::vector<std::pair<double, int> > candidates;
+  const int *brickDimensions = cache->BrickDimensions;
+  int brick[3];
+  int index = 0;
+  for (brick[2] = 0; brick[2] < brickDimensions[2]; brick[2]++)
+    {
+    for (brick[1] = 0; brick[1] < brickDimensions[1]; brick[1]++)
+      {
+      for (brick[0] = 0; brick[0] < brickDimensions[0]; brick[0]++, index++)
+        {
+        if (occupancy && !occupancy[index])
+          {
+          continue;
+          }
+        double lo[3], hi[3];
+        bool clipped = false;
+        double distance2 = 0.;
+        for (int i = 0; i < 3; i++)
+          {
+          lo[i] = static_cast<double>(brick[i] * brickSize) / dim[i];
+          hi[i] = static_cast<double>((brick[i] + 1) * brickSize) / dim[i];
+          hi[i] = hi[i] > 1. ? 1. : hi[i];
+          clipped = clipped || hi[i] < clipMin[i] || lo[i] > clipMax[i];
+          double center = (lo[i] + hi[i]) * 0.5 - eye[i];
+          distance2 += center * center;
+          }
+        if (clipped)
+          {
+          continue;
+          }
+        // The brick is out of the view frustum if all its corners are on
+        // the outer side of one of the frustum planes.
+        int outside[6] = {0, 0, 0, 0, 0, 0};
+        for (int c = 0; c < 8; c++)
+          {
+          double corner[4] = {c & 1 ? hi[0] : lo[0], c & 2 ? hi[1] : lo[1],
+                              c & 4 ? hi[2] : lo[2], 1.};
+          textureToClip->MultiplyPoint(corner, corner);
+          for (int i = 0; i < 3; i++)
+            {
+            outside[2*i] += corner[i] < -corner[3] ? 1 : 0;
+            outside[2*i+1] += corner[i] > corner[3] ? 1 : 0;
+            }
+          }
+        bool visible = true;
+        for (int i = 0; i < 6; i++)
+          {
+          visible = visible && outside[i] < 8;
+          }
+        if (visible)
+          {
+          candidates.push_back(std::make_pair(distance2, index));
+          }
+        }
+      }
     }
+  textureToClip->Delete();
 
-  vtkgl::ActiveTexture( vtkgl::TEXTURE6 );
-  glBindTexture(GL_TEXTURE_2D, this->ColorLookupIndex);
+  // Closest bricks first, the farthest ones are dropped when they don't fit
+  std::sort(candidates.begin(), candidates.end());
+  if (static_cast<int>(candidates.size()) > cache->NumberOfSlots)
+    {
+    vtkDebugMacro(<< static_cast<int>(candidates.size()) - cache->NumberOfSlots
+                  << " bricks do not fit in the GPU memory budget");
+    candidates.resize(cache->NumberOfSlots);
+    }
+  for (size_t i = 0; i < candidates.size(); i++)
+    {
+    int slot = cache->BrickSlot[candidates[i].second];
+    if (slot >= 0)
+      {
+      cache->SlotLastUsed[slot] = cache->Frame;
+      }
+    }
 
-  GLint loc = vtkgl::GetUniformLocation(RayCastProgram, "TextureVol");
-  if (loc >= 0)
-    vtkgl::Uniform1i(loc, 7);
-  loc = vtkgl::GetUniformLocation(RayCastProgram, "TextureVol1");
-  if (loc >= 0)
-    vtkgl::Uniform1i(loc, 5);
-  loc = vtkgl::GetUniformLocation(RayCastProgram, "TextureColorLookup");
-  if (loc >= 0)
-    vtkgl::Uniform1i(loc, 6);
+  // Least recently used slots are recycled first
+  std::vector<std::pair<unsigned long, int> > freeSlots;
+  for (int slot = 0; slot < cache->NumberOfSlots; slot++)
+    {
+    if (cache->SlotLastUsed[slot] != cache->Frame)
+      {
+      freeSlots.push_back(std::make_pair(cache->SlotLastUsed[slot], slot));
+      }
+    }
+  std::sort(freeSlots.begin(), freeSlots.end());
+
+  std::fill(cache->PageTable.begin(), cache->PageTable.end(), 0);
+  size_t nextFreeSlot = 0;
+  const int *slotDimensions = cache->SlotDimensions;
+  for (size_t i = 0; i < candidates.size(); i++)
+    {
+    int brickIndex = candidates[i].second;
+    int slot = cache->BrickSlot[brickIndex];
+    if (slot < 0)
+      {
+      slot = freeSlots[nextFreeSlot++].second;
+      if (cache->SlotBrick[slot] >= 0)
+        {
+        cache->BrickSlot[cache->SlotBrick[slot]] = -1;
+        }
+      cache->SlotBrick[slot] = brickIndex;
+      cache->BrickSlot[brickIndex] = slot;
+      cache->SlotLastUsed[slot] = cache->Frame;
+      this->UploadBrick(brickIndex, slot);
+      }
+    unsigned char *page = &cache->PageTable[4 * brickIndex];
+    page[0] = static_cast<unsigned char>(slot % slotDimensions[0]);
+    page[1] = static_cast<unsigned char>((slot / slotDimensions[0]) % slotDimensions[1]);
+    page[2] = static_cast<unsigned char>(slot / (slotDimensions[0] * slotDimensions[1]));
+    page[3] = 255;
+    }
+  cache->NumberOfRenderedBricks = static_cast<int>(candidates.size());
+
+  double startTime = vtkTimerLog::GetUniversalTime();
+  vtkgl::ActiveTexture( vtkgl::TEXTURE4 );
+  if (!this->OccupancyIndex)
+    {
+    this->CreateTextureIndex( &this->OccupancyIndex );
+    glBindTexture(vtkgl::TEXTURE_3D, this->OccupancyIndex);
+    glTexParameterf( vtkgl::TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
+    glTexParameterf( vtkgl::TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
+    glTexParameterf( vtkgl::TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP );
+    glTexParameterf( vtkgl::TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP );
+    glTexParameterf( vtkgl::TEXTURE_3D, vtkgl::TEXTURE_WRAP_R, GL_CLAMP );
+    vtkgl::TexImage3D( vtkgl::TEXTURE_3D, 0, GL_RGBA8, brickDimensions[0],
+               brickDimensions[1], brickDimensions[2], 0,
+               GL_RGBA, GL_UNSIGNED_BYTE, &cache->PageTable[0] );
+    }
+  else
+    {
+    glBindTexture(vtkgl::TEXTURE_3D, this->OccupancyIndex);
+    vtkgl::TexSubImage3D( vtkgl::TEXTURE_3D, 0, 0, 0, 0, brickDimensions[0],
+                  brickDimensions[1], brickDimensions[2],
+                  GL_RGBA, GL_UNSIGNED_BYTE, &cache->PageTable[0] );
+    }
+  this->AddUploadStatistics( startTime, static_cast<vtkIdType>(cache->PageTable.size()) );
+}
+
+int vtkSlicerGPURayCastVolumeMapper::GetNumberOfRenderedBricks()
+{
+  return this->BrickCache->NumberOfRenderedBricks;
 }
 
 int  vtkSlicerGPURayCastVolumeMapper::IsRenderSupported(vtkRenderWindow* window, vtkVolumeProperty *property )
@@ -667,6 +2235,12 @@ void vtkSlicerGPURayCastVolumeMapper::Initialize(vtkRenderWindow* window)
 
 int vtkSlicerGPURayCastVolumeMapper::IsTextureSizeSupported( int size[3] )
 {
+  if ( this->BrickedRendering )
+    {
+    // Only the visible bricks are uploaded, the whole volume just needs to
+    // be addressable in host memory.
+    return static_cast<double>(size[0]) * size[1] * size[2] <= VTK_INT_MAX / 4;
+    }
   if ( this->GetInput()->GetNumberOfScalarComponents() < 4 )
     {
     long maxSize = this->InternalVolumeSize * this->InternalVolumeSize * this->InternalVolumeSize;
@@ -720,6 +2294,18 @@ void vtkSlicerGPURayCastVolumeMapper::PrintSelf(ostream& os, vtkIndent indent)
     }
   extensions->Delete();
 
+  os << indent << "EmptySpaceSkipping: " << this->EmptySpaceSkipping << endl;
+  os << indent << "BrickedRendering: " << this->BrickedRendering << endl;
+  os << indent << "MaxMemoryInBytes: " << this->MaxMemoryInBytes << endl;
+  os << indent << "MultiResolution: " << this->MultiResolution << endl;
+  os << indent << "PyramidLevel: " << this->PyramidLevel << endl;
+  os << indent << "AsynchronousUpload: " << this->AsynchronousUpload << endl;
+  os << indent << "PreIntegration: " << this->PreIntegration << endl;
+  os << indent << "LastUploadedBytes: " << this->LastUploadedBytes << endl;
+  os << indent << "LastUploadTime: " << this->LastUploadTime << endl;
+  os << indent << "LastTransferFunctionTime: " << this->LastTransferFunctionTime << endl;
+  os << indent << "LastPreprocessingTime: " << this->LastPreprocessingTime << endl;
+
   this->Superclass::PrintSelf(os,indent);
 }
 
@@ -837,6 +2423,28 @@ void vtkSlicerGPURayCastVolumeMapper::DrawVolumeBBox()
     glEnd();
 }
 
+void vtkSlicerGPURayCastVolumeMapper::DrawVolumeOutline()
+{
+  // the 12 edges of the bounding box computed by SetupRayCastParameters()
+  static const int edges[12][2] = {
+    {0, 1}, {1, 2}, {2, 3}, {3, 0},
+    {4, 5}, {5, 6}, {6, 7}, {7, 4},
+    {0, 4}, {1, 5}, {2, 6}, {3, 7}};
+
+  glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT);
+  glDisable(GL_CULL_FACE);
+  glDisable(GL_LIGHTING);
+  glColor3d(1.0, 1.0, 1.0);
+  glBegin(GL_LINES);
+  for (int i = 0; i < 12; i++)
+    {
+    glVertex3dv(VolumeBBoxVertices[edges[i][0]]);
+    glVertex3dv(VolumeBBoxVertices[edges[i][1]]);
+    }
+  glEnd();
+  glPopAttrib();
+}
+
 void vtkSlicerGPURayCastVolumeMapper::InitializeRayCast()
 {
     RayCastInitialized = 1;
@@ -914,6 +2522,12 @@ void vtkSlicerGPURayCastVolumeMapper::LoadFragmentShaders()
       "uniform sampler3D TextureVol;                                                         \n"
       "uniform sampler3D TextureVol1;                                                        \n"
       "uniform sampler2D TextureColorLookup;                                                 \n"
+      "uniform sampler3D TextureOccupancy;                                                   \n"
+      "uniform vec3 BrickSize;                                                               \n"
+      "uniform vec3 OccupancyScale;                                                          \n"
+      "uniform vec3 VolumeDimensions;                                                        \n"
+      "uniform vec3 AtlasScale;                                                              \n"
+      "uniform float BrickVoxels;                                                            \n"
       "uniform mat4 ParaMatrix;                                                              \n"
       "uniform mat4 VolumeMatrix;                                                            \n"
       "//uniform mat4 ParaMatrix1;                                                             \n"
@@ -967,14 +2581,88 @@ void vtkSlicerGPURayCastVolumeMapper::LoadFragmentShaders()
       "    return gl_TexCoord[0];                                                            \n"
       "}                                                                                     \n"
       "                                                                                      \n";
+  //brick lookup
+  fp_oss <<
+    "vec4 brickPage(vec3 coord)                                                           \n"
+    "{                                                                                    \n"
+    "  return texture3D(TextureOccupancy, (floor(coord/BrickSize) + 0.5)*OccupancyScale); \n"
+    "}                                                                                    \n"
+    "                                                                                     \n";
+
+  //volume sampling
+  if (this->BrickedRendering)
+  {
+    // The bricks are stored with a one voxel border in the atlas slot given
+    // by the page table. Bricks that are not resident are skipped by the rays.
+    fp_oss <<
+      "vec3 atlasCoord(vec3 coord, vec4 page)                                               \n"
+      "{                                                                                    \n"
+      "  vec3 slot = floor(page.xyz*255.0 + 0.5);                                           \n"
+      "  vec3 voxel = coord*VolumeDimensions - floor(coord/BrickSize)*BrickVoxels;          \n"
+      "  return (slot*(BrickVoxels + 2.0) + 1.0 + voxel)*AtlasScale;                        \n"
+      "}                                                                                    \n"
+      "                                                                                     \n"
+      "vec4 sampleVol(vec3 coord)                                                           \n"
+      "{                                                                                    \n"
+      "  vec4 page = brickPage(coord);                                                      \n"
+      "  if (page.w < 0.5)                                                                  \n"
+      "    return vec4(0.0);                                                                \n"
+      "  return texture3D(TextureVol, atlasCoord(coord, page));                             \n"
+      "}                                                                                    \n"
+      "                                                                                     \n"
+      "vec4 sampleVol1(vec3 coord)                                                          \n"
+      "{                                                                                    \n"
+      "  vec4 page = brickPage(coord);                                                      \n"
+      "  if (page.w < 0.5)                                                                  \n"
+      "    return vec4(0.0);                                                                \n"
+      "  return texture3D(TextureVol1, atlasCoord(coord, page));                            \n"
+      "}                                                                                    \n"
+      "                                                                                     \n";
+  }
+  else
+  {
+    fp_oss <<
+      "vec4 sampleVol(vec3 coord)                                                           \n"
+      "{                                                                                    \n"
+      "  return texture3D(TextureVol, coord);                                               \n"
+      "}                                                                                    \n"
+      "                                                                                     \n"
+      "vec4 sampleVol1(vec3 coord)                                                          \n"
+      "{                                                                                    \n"
+      "  return texture3D(TextureVol1, coord);                                              \n"
+      "}                                                                                    \n"
+      "                                                                                     \n";
+  }
+
   //color lookup    
   switch(this->GetInput()->GetNumberOfScalarComponents())
   {
   case 1:
+    if (this->UsePreIntegration())
+    {
+      // The segment from the previous sample of the ray is looked up in the
+      // preintegrated table. The gradient opacity is applied at the sample.
+      fp_oss <<
+        "uniform sampler2D TexturePreIntegration;                                             \n"
+        "uniform sampler1D TextureGradientOpacity;                                            \n"
+        "float PreviousScalar = -1.0;                                                         \n"
+        "                                                                                     \n"
+        "vec4 voxelColor(vec3 coord)                                                          \n"
+        "{                                                                                    \n"
+        "  vec4 scalar = sampleVol(coord);                                                    \n"
+        "  float front = PreviousScalar < 0.0 ? scalar.x : PreviousScalar;                    \n"
+        "  PreviousScalar = scalar.x;                                                         \n"
+        "  vec4 color = texture2D(TexturePreIntegration, vec2(front, scalar.x));              \n"
+        "  color.w *= texture1D(TextureGradientOpacity, scalar.w).x;                          \n"
+        "  return color;                                                                      \n"
+        "}                                                                                    \n"
+        "                                                                                     \n";
+      break;
+    }
     fp_oss <<
       "vec4 voxelColor(vec3 coord)                                                          \n"
       "{                                                                                    \n"
-      "  vec4 scalar = texture3D(TextureVol, coord);                                        \n"
+      "  vec4 scalar = sampleVol(coord);                                                    \n"
       "  return texture2D(TextureColorLookup, vec2(scalar.x, scalar.w));                    \n"
       "}                                                                                    \n"
       "                                                                                     \n";
@@ -984,7 +2672,7 @@ void vtkSlicerGPURayCastVolumeMapper::LoadFragmentShaders()
       "vec4 voxelColor(vec3 coord)                                                          \n"
       "{                                                                                    \n"
       "  vec4 color = vec4(0);                                                              \n"
-      "  vec4 scalar = texture3D(TextureVol, coord);                                        \n"
+      "  vec4 scalar = sampleVol(coord);                                                    \n"
       "  color = texture2D(TextureColorLookup, vec2(scalar.x, scalar.w));                   \n"
       "  vec4 opacity = texture2D(TextureAlphaLookup, vec2(scalar.y, scalar.w));            \n"
       "  color.w = opacity.w;                                                               \n"
@@ -997,8 +2685,8 @@ void vtkSlicerGPURayCastVolumeMapper::LoadFragmentShaders()
       "vec4 voxelColor(vec3 coord)                                                          \n"
       "{                                                                                    \n"
       "  vec4 color = vec4(0);                                                              \n"
-      "  color = texture3D(TextureVol, coord);                                              \n"
-      "  vec4 scalar = texture3D(TextureVol1, coord);                                       \n"
+      "  color = sampleVol(coord);                                                          \n"
+      "  vec4 scalar = sampleVol1(coord);                                                   \n"
       "  vec4 opacity = texture2D(TextureAlphaLookup, vec2(color.w, scalar.w));             \n"
       "  color.w = opacity.w;                                                               \n"
       "  return color;                                                                      \n"
@@ -1014,7 +2702,7 @@ void vtkSlicerGPURayCastVolumeMapper::LoadFragmentShaders()
       fp_oss <<
         "float voxelScalar(vec3 coord)                                                        \n"
         "{                                                                                    \n"
-        "  return texture3D(TextureVol, coord).x;                                             \n"
+        "  return sampleVol(coord).x;                                                         \n"
         "}                                                                                    \n";
       break;
     case 3:
@@ -1022,7 +2710,7 @@ void vtkSlicerGPURayCastVolumeMapper::LoadFragmentShaders()
       fp_oss <<
         "float voxelScalar(vec3 coord)                                                        \n"
         "{                                                                                    \n"
-        "  return texture3D(TextureVol, coord).w;                                             \n"
+        "  return sampleVol(coord).w;                                                         \n"
         "}                                                                                    \n";
       break;
   }
@@ -1046,7 +2734,7 @@ void vtkSlicerGPURayCastVolumeMapper::LoadFragmentShaders()
         "   //return gl_NormalMatrix * normal.xyz;                                            \n"
         "  }                                                                                  \n"
         "  {                                                                                  \n"
-        "   vec4 normal = texture3D(TextureVol1, coord);                                      \n"
+        "   vec4 normal = sampleVol1(coord);                                                  \n"
         "   normal = normal * 2.0 - 1.0;                                                      \n"
         "   normal = VolumeMatrix * normal;                                                   \n"
         "   return gl_NormalMatrix * normal.xyz;                                              \n"
@@ -1091,7 +2779,7 @@ void vtkSlicerGPURayCastVolumeMapper::LoadFragmentShaders()
     fp_oss <<
       "float ICPE(vec3 coord, float shading, float alpha, float dist)                           \n"
       "{                                                                                        \n"
-      "   float gradMag = texture3D(TextureVol, coord).w;                                       \n"
+      "   float gradMag = sampleVol(coord).w;                                                   \n"
       "   float base = shading*ParaMatrix[3][3]*(1.0-dist)*(1.0-alpha);                         \n"
       "   if (base > 0.0)                                                                       \n"
       "     return pow(gradMag, pow(base, ParaMatrix[3][0]));                                   \n"
@@ -1100,6 +2788,38 @@ void vtkSlicerGPURayCastVolumeMapper::LoadFragmentShaders()
       "}                                                                                        \n";
   }
       
+  // Jump to the next brick when the current one is fully transparent. The
+  // ray moves by whole steps to sample the same positions as without skipping.
+  // In bricked mode the rays skip the bricks that are not resident whatever
+  // the technique.
+  std::string skipBricks;
+  if (this->BrickedRendering ||
+      (this->EmptySpaceSkipping && this->GetInput()->GetNumberOfScalarComponents() == 1))
+  {
+    skipBricks = this->BrickedRendering ?
+      "    if (brickPage(nextRayOrigin).w < 0.5)                                           \n" :
+      "    if (brickPage(nextRayOrigin).x < 0.5)                                           \n";
+    skipBricks +=
+      "    {                                                                               \n"
+      "      vec3 brickEnd = (floor(nextRayOrigin/BrickSize) + step(0.0, rayDir))*BrickSize;\n"
+      "      vec3 brickDist = abs(brickEnd - nextRayOrigin)/max(abs(rayDir), vec3(0.000001));\n"
+      "      float n = ceil(min(min(brickDist.x, brickDist.y), brickDist.z)/ParaMatrix[0][3]);\n"
+      "      n = max(n, 1.0);                                                              \n"
+      "      t += n*ParaMatrix[0][3];                                                      \n"
+      "      nextRayOrigin += n*rayStep;                                                   \n"
+      "      fading -= n*ParaMatrix[3][1]*ParaMatrix[0][3];                                \n";
+    if (this->UsePreIntegration())
+    {
+      // the skipped segment is transparent, don't integrate over it
+      skipBricks +=
+      "      PreviousScalar = -1.0;                                                        \n";
+    }
+    skipBricks +=
+      "      continue;                                                                     \n"
+      "    }                                                                               \n";
+  }
+  const std::string skipAllBricks = this->BrickedRendering ? skipBricks : std::string();
+
   fp_oss <<      
     "void main()                                                                            \n"
     "{                                                                                      \n"
@@ -1141,6 +2861,7 @@ void vtkSlicerGPURayCastVolumeMapper::LoadFragmentShaders()
     "                                                                                       \n"
     "  while( t < rayLen)                                                                   \n"
     "  {                                                                                    \n"
+    << skipAllBricks <<
     "    if ( voxelScalar(nextRayOrigin) >= depthPeeling )                                  \n"
     "      break;                                                                           \n"
     "    t += ParaMatrix[0][3];                                                             \n"
@@ -1154,6 +2875,7 @@ void vtkSlicerGPURayCastVolumeMapper::LoadFragmentShaders()
       fp_oss <<
         "  while( (t < rayLen) && (alpha < 0.985) )                                          \n"
         "  {                                                                                 \n"
+        << skipBricks <<
         "    vec4 nextColor = voxelColor(nextRayOrigin);                                     \n"
         "    float tempAlpha = nextColor.w;                                                  \n"
         "    nextColor *= vec4(fading, fading, fading, 1.0);                                 \n"
@@ -1178,6 +2900,7 @@ void vtkSlicerGPURayCastVolumeMapper::LoadFragmentShaders()
       fp_oss <<
         "  while( (t < rayLen) && (alpha < 0.985) )                                          \n"
         "  {                                                                                 \n"
+        << skipBricks <<
         "    vec4 nextColor = voxelColor(nextRayOrigin);                                     \n"
         "    float tempAlpha = nextColor.w;                                                  \n"
         "    nextColor *= vec4(fading, fading, fading, 1.0);                                 \n"
@@ -1205,6 +2928,7 @@ void vtkSlicerGPURayCastVolumeMapper::LoadFragmentShaders()
         "                                                                                    \n"
         "  while( t < rayLen )                                                               \n"
         "  {                                                                                 \n"
+        << skipAllBricks <<
         "    float scalar = voxelScalar(nextRayOrigin);                                      \n"
         "    if (maxScalar < scalar)                                                         \n"
         "    {                                                                               \n"
@@ -1229,6 +2953,7 @@ void vtkSlicerGPURayCastVolumeMapper::LoadFragmentShaders()
         "  vec3 minScalarCoord = nextRayOrigin;                                              \n"
         "  while( t < rayLen )                                                               \n"
         "  {                                                                                 \n"
+        << skipAllBricks <<
         "    float scalar = voxelScalar(nextRayOrigin);                                      \n"
         "    if (minScalar > scalar)                                                         \n"
         "    {                                                                               \n"
@@ -1249,6 +2974,7 @@ void vtkSlicerGPURayCastVolumeMapper::LoadFragmentShaders()
       fp_oss <<
         "  while( (t < rayLen) && (alpha < 0.985) )                                          \n"
         "  {                                                                                 \n"
+        << skipBricks <<
         "    vec4 nextColor = voxelColor(nextRayOrigin);                                     \n"
         "    float tempAlpha = nextColor.w;                                                  \n"
         "    nextColor *= vec4(fading, fading, fading, 1.0);                                 \n"
@@ -1257,7 +2983,7 @@ void vtkSlicerGPURayCastVolumeMapper::LoadFragmentShaders()
         "    {                                                                               \n"
         "      nextColor = directionalLight(nextRayOrigin, lightDir, nextColor);             \n"
         "                                                                                    \n"
-        "      tempAlpha = (1.0-alpha)*tempAlpha*texture3D(TextureVol, nextRayOrigin).w;     \n"
+        "      tempAlpha = (1.0-alpha)*tempAlpha*sampleVol(nextRayOrigin).w;                 \n"
         "      pixelColor += nextColor*tempAlpha;                                            \n"
         "      alpha += tempAlpha;                                                           \n"
         "    }                                                                               \n"
@@ -1274,6 +3000,7 @@ void vtkSlicerGPURayCastVolumeMapper::LoadFragmentShaders()
         "  vec3 eyePos = vec3(ParaMatrix[0][0], ParaMatrix[0][1], ParaMatrix[0][2]);         \n"
         "  while( (t < rayLen) && (alpha < 0.985) )                                          \n"
         "  {                                                                                 \n"
+        << skipBricks <<
         "    vec4 nextColor = voxelColor(nextRayOrigin);                                     \n"
         "    float tempAlpha = nextColor.w;                                                  \n"
         "                                                                                    \n"
@@ -1357,6 +3084,59 @@ void vtkSlicerGPURayCastVolumeMapper::SetTechnique(int tech)
     this->ReloadShaderFlag = 1;
 }
 
+void vtkSlicerGPURayCastVolumeMapper::SetEmptySpaceSkipping(int skip)
+{
+  if (this->EmptySpaceSkipping == skip)
+    {
+    return;
+    }
+  this->EmptySpaceSkipping = skip;
+  // the brick ranges are not maintained while skipping is off
+  this->ClearBrickRanges();
+  this->ReloadShaderFlag = 1;
+  this->Modified();
+}
+
+void vtkSlicerGPURayCastVolumeMapper::SetPreIntegration(int preIntegration)
+{
+  if (this->PreIntegration == preIntegration)
+    {
+    return;
+    }
+  this->PreIntegration = preIntegration;
+  this->ReloadShaderFlag = 1;
+  this->Modified();
+}
+
+void vtkSlicerGPURayCastVolumeMapper::SetBrickedRendering(int bricked)
+{
+  if (this->BrickedRendering == bricked)
+    {
+    return;
+    }
+  this->BrickedRendering = bricked;
+  // the brick size and the volume resolution change
+  this->ClearBrickRanges();
+  this->SavedTextureInput = NULL;//dirty input, force reprocess input
+  this->ReloadShaderFlag = 1;
+  this->Modified();
+}
+
+void vtkSlicerGPURayCastVolumeMapper::SetMultiResolution(int multiResolution)
+{
+  if (this->MultiResolution == multiResolution)
+    {
+    return;
+    }
+  this->MultiResolution = multiResolution;
+  // the pyramid is built again from the current volume when turned on
+  this->Pyramid->Clear();
+  this->PyramidLevel = 0;
+  this->InteractivePyramidLevel = 0;
+  this->UploadedPyramidLevel = 0;
+  this->Modified();
+}
+
 void vtkSlicerGPURayCastVolumeMapper::SetInternalVolumeSize(int size)
 {
     if (this->InternalVolumeSize != size)
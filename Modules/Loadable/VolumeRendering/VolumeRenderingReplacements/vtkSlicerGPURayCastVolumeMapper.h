@@ -37,6 +37,10 @@
 
 class vtkMatrix4x4;
 class vtkRenderWindow;
+class vtkSlicerGPURayCastBrickCache;
+struct vtkSlicerGPURayCastSharedTextures;
+class vtkSlicerGPURayCastVolumeLoader;
+class vtkSlicerGPURayCastVolumePyramid;
 class vtkVolumeProperty;
 
 /// \ingroup Slicer_QtModules_VolumeRendering
@@ -78,6 +82,100 @@ public:
   // Set technique
   void SetTechnique(int tech);
 
+  // Description:
+  // Enable/Disable empty space skipping. When enabled, rays jump over the
+  // 8x8x8 voxel bricks that are fully transparent under the current
+  // transfer functions instead of sampling them.
+  // Only used for single component volumes, default is on.
+  void SetEmptySpaceSkipping(int skip);
+  vtkGetMacro(EmptySpaceSkipping, int);
+  vtkBooleanMacro(EmptySpaceSkipping, int);
+
+  // Description:
+  // Enable/Disable bricked rendering. The volume is split into 32x32x32
+  // voxel bricks and only the visible, non transparent bricks are paged
+  // into the GPU memory, the least recently used ones being evicted when
+  // MaxMemoryInBytes is reached. It allows rendering volumes larger than
+  // the graphics memory at their full resolution.
+  // Default is off.
+  void SetBrickedRendering(int bricked);
+  vtkGetMacro(BrickedRendering, int);
+  vtkBooleanMacro(BrickedRendering, int);
+
+  // Description:
+  // Graphics memory the bricked rendering can use for the bricks.
+  // Default is 256MB.
+  vtkSetMacro(MaxMemoryInBytes, vtkIdType);
+  vtkGetMacro(MaxMemoryInBytes, vtkIdType);
+
+  // Description:
+  // Number of bricks rendered in the last frame in bricked rendering mode.
+  int GetNumberOfRenderedBricks();
+
+  // Description:
+  // Enable/Disable multi-resolution rendering. A pyramid of downsampled
+  // copies of the volume is built in a background thread when the volume
+  // is loaded. Interactive frames render from the level that reaches
+  // the desired frame rate once the ray steps can't be reduced anymore,
+  // still frames always use the full resolution.
+  // Not used in bricked rendering mode, default is on.
+  void SetMultiResolution(int multiResolution);
+  vtkGetMacro(MultiResolution, int);
+  vtkBooleanMacro(MultiResolution, int);
+
+  // Description:
+  // Resolution level rendered in the last frame, 0 is the full resolution
+  // and each level halves the dimensions of the previous one.
+  vtkGetMacro(PyramidLevel, int);
+
+  // Description:
+  // Enable/Disable the asynchronous upload of the volume. The RGBA volumes
+  // are computed in a background thread when the input changes and
+  // uploaded a few slices per frame, the outline of the volume is rendered
+  // meanwhile and VolumeMapperRenderProgressEvent is invoked with the
+  // fraction of the volume that is loaded so that the application renders
+  // again.
+  // Not used in bricked rendering mode, default is on.
+  vtkSetMacro(AsynchronousUpload, int);
+  vtkGetMacro(AsynchronousUpload, int);
+  vtkBooleanMacro(AsynchronousUpload, int);
+
+  // Description:
+  // Enable/Disable the preintegrated transfer function. The color and
+  // opacity of each ray segment are looked up in a table integrating the
+  // transfer function between the scalars at both ends of the segment,
+  // instead of the transfer function at the sample. It removes the slicing
+  // artifacts of high frequency transfer functions at large sample
+  // distances.
+  // Only used for single component volumes in the compositing techniques,
+  // default is off.
+  void SetPreIntegration(int preIntegration);
+  vtkGetMacro(PreIntegration, int);
+  vtkBooleanMacro(PreIntegration, int);
+
+  // Description:
+  // Return 1 while the volume is being computed or uploaded.
+  int IsLoading();
+
+  // Description:
+  // Statistics of the last rendered frame: bytes uploaded into the
+  // textures and time in seconds spent uploading them, sampling the
+  // transfer functions into the lookup tables and computing the volumes
+  // and brick ranges on the CPU. The ray cast time is GetTimeToDraw().
+  vtkGetMacro(LastUploadedBytes, vtkIdType);
+  vtkGetMacro(LastUploadTime, double);
+  vtkGetMacro(LastTransferFunctionTime, double);
+  vtkGetMacro(LastPreprocessingTime, double);
+
+  // Description:
+  // Declare that the OpenGL context of window shares its objects with the
+  // one of sharedWindow (e.g. QGLWidgets created with a share widget). The
+  // mappers rendering the same input into any window of the group then
+  // upload the volume textures only once. A NULL sharedWindow removes
+  // window from its group.
+  // The textures are shared by the mappers of the same render window.
+  static void ShareContext(vtkRenderWindow *window, vtkRenderWindow *sharedWindow);
+
   // Description:
   // Is hardware rendering supported? No if the input data is
   // more than one independent component, or if the hardware does
@@ -122,6 +220,7 @@ protected:
   GLuint           Volume1Index;
   GLuint           Volume2Index;
   GLuint           ColorLookupIndex;
+  GLuint           OccupancyIndex; // page table in bricked rendering
   GLuint           RayCastVertexShader;
   GLuint           RayCastFragmentShader;
   GLuint           RayCastProgram;
@@ -140,17 +239,116 @@ protected:
   float            ICPEScale;
   float            ICPESmoothness;
 
+  int              EmptySpaceSkipping;
+  // scalar min, scalar max, gradient min, gradient max of each brick
+  unsigned char   *BrickMinMax;
+  // non zero for the bricks with a visible voxel
+  unsigned char   *BrickOccupancy;
+  int              BrickDimensions[3];
+
+  int              BrickedRendering;
+  vtkIdType        MaxMemoryInBytes;
+  vtkSlicerGPURayCastBrickCache *BrickCache;
+
+  int              MultiResolution;
+  vtkSlicerGPURayCastVolumePyramid *Pyramid;
+  // level rendered, level used by the interactive frames
+  int              PyramidLevel;
+  int              InteractivePyramidLevel;
+  int              Interacting;
+  // textures of the downsampled level, 0 is not a valid uploaded level
+  GLuint           PyramidVolume1Index;
+  GLuint           PyramidVolume2Index;
+  int              UploadedPyramidLevel;
+
+  int              AsynchronousUpload;
+  vtkSlicerGPURayCastVolumeLoader *Loader;
+  // number of slices of the volume textures uploaded so far
+  int              UploadedSlices;
+
+  int              PreIntegration;
+  int              PreIntegrationTableComputed;
+  GLuint           PreIntegrationIndex;
+  GLuint           GradientOpacityIndex;
+  // RGBA indexed by the front and back scalars of the ray segments
+  unsigned char    PreIntegrationTable[256*256*4];
+
+  // Volume1Index and Volume2Index when they are shared with other mappers
+  vtkSlicerGPURayCastSharedTextures *SharedVolumeTextures;
+  unsigned long    VolumesInputMTime;
+
+  vtkIdType        LastUploadedBytes;
+  double           LastUploadTime;
+  double           LastTransferFunctionTime;
+  double           LastPreprocessingTime;
+
   void Initialize(vtkRenderWindow* ren);
   void InitializeRayCast();
 
   void RenderGLSL(vtkRenderer *pRen, vtkVolume *pVol);
-  void SetupTextures( vtkRenderer *ren, vtkVolume *vol );
+  // Description:
+  // Return 0 if the volume is not loaded yet and can't be rendered.
+  int SetupTextures( vtkRenderer *ren, vtkVolume *vol );
+
+  // Description:
+  // Same as UpdateVolumes() but computes the volumes in the background
+  // thread of the Loader and uploads them in chunks when AsynchronousUpload
+  // is on. Return -1 while loading, 1 if the volumes changed and 0
+  // otherwise. uploaded is set to 1 if the textures are already uploaded.
+  int UpdateVolumesAsynchronously( vtkVolume *vol, int& uploaded );
+  void DrawVolumeOutline();
+
+  // Description:
+  // Use the volume textures already uploaded by another mapper in this
+  // context group, return 0 if there are none. ShareVolumeTextures() makes
+  // the uploaded textures available to the other mappers.
+  int AcquireSharedVolumeTextures();
+  void ShareVolumeTextures();
+  void ReleaseSharedVolumeTextures();
+
+  // Description:
+  // Return 1 if the preintegrated transfer function is rendered with the
+  // current input and technique.
+  int UsePreIntegration();
+  // Description:
+  // Compute PreIntegrationTable from the transfer functions sampled by
+  // UpdateColorLookup() and upload it with the gradient opacity table.
+  void ComputePreIntegrationTable();
+  void UpdatePreIntegrationTextures(vtkVolume *vol, int colorLookupUpdated);
+
+  // Description:
+  // Add an upload started at startTime to the frame statistics.
+  void AddUploadStatistics( double startTime, vtkIdType bytes );
 
   void DeleteTextureIndex( GLuint *index );
   void CreateTextureIndex( GLuint *index );
 
   void DrawVolumeBBox();
 
+  // Description:
+  // Edge length in voxels of the bricks, depends on the rendering mode.
+  int GetBrickSize();
+
+  // Description:
+  // Compute the range of the scalars and gradient magnitudes sampled in
+  // each brick of Volume1. Must be called when Volume1 changes.
+  void ComputeBrickMinMax();
+  void ClearBrickRanges();
+
+  // Description:
+  // Flag the bricks that have a non transparent voxel in the current
+  // color lookup table. UpdateOccupancy() also uploads the flags into the
+  // occupancy texture.
+  void ComputeOccupancy();
+  void UpdateOccupancy();
+
+  // Description:
+  // Bricked rendering: allocate the atlases within MaxMemoryInBytes, upload
+  // the bricks needed by the current view and the page table.
+  void AllocateBrickAtlases();
+  void UploadBrick(int brick, int slot);
+  void UpdateBrickCache(vtkRenderer *ren, vtkVolume *vol);
+
   void SetupRayCastParameters( vtkRenderer *pRen, vtkVolume *pVol);
 
   void LoadVertexShader();
@@ -159,6 +357,14 @@ protected:
   void LoadRayCastProgram();
 
   void AdaptivePerformanceControl();
+  // Description:
+  // Choose the pyramid level of the next frame from the time the last
+  // frame took to draw.
+  void UpdatePyramidLevel(vtkVolume *vol);
+  void GetPyramidLevelDimensions(int level, int dim[3]);
+  // Description:
+  // Upload the current pyramid level and return the textures to render.
+  void UploadPyramidLevel(vtkVolume *vol, GLuint& volume1Index, GLuint& volume2Index);
   void PerformanceControl();
 
   // Description:
@@ -170,6 +376,8 @@ protected:
   void Setup3DTextureParameters( vtkVolumeProperty *property );
 
 private:
+  friend class vtkSlicerGPURayCastVolumeLoader;
+
   vtkSlicerGPURayCastVolumeMapper(const vtkSlicerGPURayCastVolumeMapper&);  // Not implemented.
   void operator=(const vtkSlicerGPURayCastVolumeMapper&);  // Not implemented.
 
@@ -451,7 +451,11 @@ VTK_THREAD_RETURN_TYPE vtkSlicerGPUVolumeMapperComputeGradients( void *arg)
   int thread_id    = ((vtkMultiThreader::ThreadInfo *)(arg))->ThreadID;
   int thread_count = ((vtkMultiThreader::ThreadInfo *)(arg))->NumberOfThreads;
 
-  if (thread_id == 0)
+  // The progress is reported from the first thread, which is the calling
+  // thread, unless the volumes are computed in a background thread
+  int reportProgress = pArgs->reportProgress && thread_id == 0;
+
+  if (reportProgress)
     me->InvokeEvent( vtkCommand::VolumeMapperComputeGradientsStartEvent, NULL );
 
   x_start = 0;
@@ -489,7 +493,7 @@ VTK_THREAD_RETURN_TYPE vtkSlicerGPUVolumeMapperComputeGradients( void *arg)
 
   // Loop through all the data and compute the encoded normal and
   // gradient magnitude for each scalar location
-  for ( z = z_start; z < z_limit; z++ )
+  for ( z = z_start; z < z_limit && !me->AbortComputeVolumes; z++ )
   {
     floc[2] = z*sampleRate[2];
     floc[2] = (floc[2]>=(dim[2]-1))?(dim[2]-1.001):(floc[2]);
@@ -623,7 +627,7 @@ VTK_THREAD_RETURN_TYPE vtkSlicerGPUVolumeMapperComputeGradients( void *arg)
       float args[1];
       args[0] = static_cast<float>(z - z_start) / static_cast<float>(z_limit - z_start - 1);
 
-      if (thread_id == 0)
+      if (reportProgress)
         me->InvokeEvent( vtkCommand::VolumeMapperComputeGradientsProgressEvent, args );
     }
   }
@@ -631,7 +635,7 @@ VTK_THREAD_RETURN_TYPE vtkSlicerGPUVolumeMapperComputeGradients( void *arg)
   {
     float args[1] = {1.0f};
 
-    if (thread_id == 0)
+    if (reportProgress)
       me->InvokeEvent( vtkCommand::VolumeMapperComputeGradientsProgressEvent, args );
   }
 
@@ -661,6 +665,7 @@ vtkSlicerGPUVolumeMapper::vtkSlicerGPUVolumeMapper()
   this->Framerate                    = 5.0f;
 
   this->GradientsArgs                 = NULL;
+  this->AbortComputeVolumes           = 0;
 
   this->Threader               = vtkMultiThreader::New();
 }
@@ -703,26 +708,35 @@ vtkSlicerGPUVolumeMapper *vtkSlicerGPUVolumeMapper::New()
 
 int vtkSlicerGPUVolumeMapper::UpdateVolumes(vtkVolume *vtkNotUsed(vol))
 {
-  int needToUpdate = 0;
-
   // Get the image data
   vtkImageData *input = this->GetInput();
   input->Update();
 
-  // Has the volume changed in some way?
-  if ( this->SavedTextureInput != input ||
-       this->SavedTextureMTime.GetMTime() < input->GetMTime() )
-  {
-    needToUpdate = 1;
-  }
-
-  if ( !needToUpdate )
+  if ( !this->NeedToUpdateVolumes() )
   {
     return 0;
   }
 
+  this->PrepareVolumes();
+  this->ComputeVolumes(1);
+  return 1;
+}
+
+int vtkSlicerGPUVolumeMapper::NeedToUpdateVolumes()
+{
+  // Has the volume changed in some way?
+  vtkImageData *input = this->GetInput();
+  return this->SavedTextureInput != input ||
+         this->SavedTextureMTime.GetMTime() < input->GetMTime();
+}
+
+void vtkSlicerGPUVolumeMapper::PrepareVolumes()
+{
+  vtkImageData *input = this->GetInput();
+
   this->SavedTextureInput = input;
   this->SavedTextureMTime.Modified();
+  this->AbortComputeVolumes = 0;
 
   // How big does the Volume need to be?
   int dim[3];
@@ -830,16 +844,27 @@ int vtkSlicerGPUVolumeMapper::UpdateVolumes(vtkVolume *vtkNotUsed(vol))
     (static_cast<double>(dim[1])-1.01)*(double)spacing[1] / static_cast<double>(this->VolumeDimensions[1]-1);
   this->VolumeSpacing[2] =
     (static_cast<double>(dim[2])-1.01)*(double)spacing[2] / static_cast<double>(this->VolumeDimensions[2]-1);
+}
+
+void vtkSlicerGPUVolumeMapper::ComputeVolumes(int reportProgress)
+{
+  vtkImageData *input = this->GetInput();
+
+  int dim[3];
+  input->GetDimensions(dim);
+  int components = input->GetNumberOfScalarComponents();
+  double scalarRange[2];
+  input->GetPointData()->GetScalars()->GetRange(scalarRange, components-1);
 
   // Transfer the input volume to the RGBA volume
   void*  dataPtr = input->GetScalarPointer();
 
-  switch ( scalarType )
+  switch ( input->GetScalarType() )
     {
     vtkTemplateMacro(
       vtkSlicerGPUVolumeMapperComputeScalars(
         (VTK_TT *)(dataPtr), this,
-        offset, scale,
+        this->ScalarOffset, this->ScalarScale,
         this->Volume1));
     }
 
@@ -861,14 +886,13 @@ int vtkSlicerGPUVolumeMapper::UpdateVolumes(vtkVolume *vtkNotUsed(vol))
   this->GradientsArgs->scalarRange[1] = scalarRange[1];
   this->GradientsArgs->volume1 = this->Volume1;
   this->GradientsArgs->volume2 = this->Volume2;
+  this->GradientsArgs->reportProgress = reportProgress;
 
   this->Threader->SetSingleMethod( vtkSlicerGPUVolumeMapperComputeGradients, (void *)(this->GradientsArgs) );
 
   this->Threader->SingleMethodExecute();
 
   delete [] floatDataPtr;
-
-  return 1;
 }
 
 void vtkSlicerGPUVolumeMapper::CopyToFloatBuffer(vtkImageData* input, float* floatDataPtr, int dataPtrSize)
@@ -1069,7 +1093,7 @@ int vtkSlicerGPUVolumeMapper::UpdateColorLookup( vtkVolume *vol )
   scalarOpacityFunc->GetTable( scalarRange[0], scalarRange[1],
                                arraySizeNeeded, this->TempArray2 );
 
-  float goArray[256];
+  float *goArray = this->GradientOpacityTable;
   gradientOpacityFunc->GetTable( 0, (scalarRange[1] - scalarRange[0])*0.25,
                                  256, goArray );
 
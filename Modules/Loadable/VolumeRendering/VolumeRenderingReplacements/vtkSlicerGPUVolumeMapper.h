@@ -74,6 +74,7 @@ struct GradientsArgsType
   double scalarRange[2];
   unsigned char *volume1;
   unsigned char *volume2;
+  int reportProgress;
 };
 
 /// \ingroup Slicer_QtModules_VolumeRendering
@@ -142,6 +143,8 @@ protected:
   unsigned char             ColorLookup[65536*4];
   float                     TempArray1[3*4096];
   float                     TempArray2[4096];
+  // gradient opacity of the 256 gradient magnitudes of Volume1
+  float                     GradientOpacityTable[256];
   int                       ColorTableSize;
   
   vtkTimeStamp              SavedTextureMTime;
@@ -155,6 +158,18 @@ protected:
   // Update the internal RGBA representation of the volume. Return 1 if
   // anything change, 0 if nothing changed.
   int    UpdateVolumes( vtkVolume * );
+
+  // Description:
+  // The steps of UpdateVolumes(). PrepareVolumes() allocates the RGBA
+  // volumes and computes their dimensions and the scalar mapping, it must be
+  // called from the rendering thread. ComputeVolumes() fills in the volumes
+  // and can run in a background thread, the progress events are then not
+  // invoked (reportProgress = 0) and AbortComputeVolumes interrupts it.
+  int    NeedToUpdateVolumes();
+  void   PrepareVolumes();
+  void   ComputeVolumes(int reportProgress);
+  volatile int AbortComputeVolumes;
+
   int    UpdateColorLookup( vtkVolume * );
 
   void CopyToFloatBuffer(vtkImageData* input, float* floatDataPtr, int dataPtrSize);
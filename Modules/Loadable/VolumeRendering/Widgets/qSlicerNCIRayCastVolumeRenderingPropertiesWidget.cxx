@@ -77,6 +77,10 @@ void qSlicerNCIRayCastVolumeRenderingPropertiesWidgetPrivate
   this->populateRenderingTechniqueComboBox();
   QObject::connect(this->RenderingTechniqueComboBox, SIGNAL(currentIndexChanged(int)),
                    widget, SLOT(setRenderingTechnique(int)));
+  QObject::connect(this->BrickedRenderingCheckBox, SIGNAL(toggled(bool)),
+                   widget, SLOT(setBrickedRendering(bool)));
+  QObject::connect(this->PreIntegrationCheckBox, SIGNAL(toggled(bool)),
+                   widget, SLOT(setPreIntegration(bool)));
 }
 
 // --------------------------------------------------------------------------
@@ -154,6 +158,10 @@ void qSlicerNCIRayCastVolumeRenderingPropertiesWidget
     index = 0;
     }
   d->RenderingTechniqueComboBox->setCurrentIndex(index);
+  d->BrickedRenderingCheckBox->setChecked(
+    this->mrmlNCIRayCastDisplayNode()->GetBrickedRendering() != 0);
+  d->PreIntegrationCheckBox->setChecked(
+    this->mrmlNCIRayCastDisplayNode()->GetPreIntegration() != 0);
 }
 
 //-----------------------------------------------------------------------------
@@ -233,3 +241,25 @@ void qSlicerNCIRayCastVolumeRenderingPropertiesWidget
   int technique = d->RenderingTechniqueComboBox->itemData(index).toInt();
   this->mrmlNCIRayCastDisplayNode()->SetRaycastTechnique(technique);
 }
+
+//-----------------------------------------------------------------------------
+void qSlicerNCIRayCastVolumeRenderingPropertiesWidget
+::setBrickedRendering(bool bricked)
+{
+  if (!this->mrmlNCIRayCastDisplayNode())
+    {
+    return;
+    }
+  this->mrmlNCIRayCastDisplayNode()->SetBrickedRendering(bricked ? 1 : 0);
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerNCIRayCastVolumeRenderingPropertiesWidget
+::setPreIntegration(bool preIntegration)
+{
+  if (!this->mrmlNCIRayCastDisplayNode())
+    {
+    return;
+    }
+  this->mrmlNCIRayCastDisplayNode()->SetPreIntegration(preIntegration ? 1 : 0);
+}
@@ -46,6 +46,8 @@ protected slots:
   void setICPEScale(double value);
   void setICPESmoothness(double value);
   void setRenderingTechnique(int index);
+  void setBrickedRendering(bool bricked);
+  void setPreIntegration(bool preIntegration);
 
 protected:
   QScopedPointer<qSlicerNCIRayCastVolumeRenderingPropertiesWidgetPrivate> d_ptr;
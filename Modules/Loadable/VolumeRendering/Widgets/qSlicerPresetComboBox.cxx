@@ -151,6 +151,9 @@ void qSlicerPresetComboBoxPrivate::init()
   q->updateComboBoxTitleAndIcon(0);
   //comboBox->setMaximumHeight(comboBox->sizeHint().height());
   
+  // The scene model is customized (no name, icons), don't share it with the
+  // other comboboxes.
+  q->setSharedSceneModel(false);
   qMRMLSceneModel* sceneModel =
     qobject_cast<qMRMLSceneModel*>(q->sortFilterProxyModel()->sourceModel());
   sceneModel->setNameColumn(-1);
@@ -20,6 +20,7 @@
 
 // Qt includes
 #include <QLineEdit>
+#include <QTimer>
 
 // QtGUI includes
 #include "qSlicerApplication.h"
@@ -105,6 +106,14 @@ void qSlicerVolumeRenderingSettingsPanelPrivate::init()
 
   q->registerProperty("VolumeRendering/GPUMemorySize", q, "gpuMemory",
                       SIGNAL(gpuMemoryChanged(int)));
+
+  // The displayable managers of the views are not reachable from here,
+  // poll the statistics they share.
+  QTimer* frameStatisticsTimer = new QTimer(q);
+  frameStatisticsTimer->setInterval(1000);
+  QObject::connect(frameStatisticsTimer, SIGNAL(timeout()),
+                   q, SLOT(updateFrameStatistics()));
+  frameStatisticsTimer->start();
 }
 
 // --------------------------------------------------------------------------
@@ -301,3 +310,30 @@ void qSlicerVolumeRenderingSettingsPanel
   d->VolumeRenderingLogic->SetDefaultRenderingMethod(
     this->defaultRenderingMethod().toLatin1());
 }
+
+// --------------------------------------------------------------------------
+void qSlicerVolumeRenderingSettingsPanel::updateFrameStatistics()
+{
+  Q_D(qSlicerVolumeRenderingSettingsPanel);
+  if (!this->isVisible())
+    {
+    return;
+    }
+  const vtkMRMLVolumeRenderingDisplayableManager::FrameStatistics& statistics =
+    vtkMRMLVolumeRenderingDisplayableManager::LastFrameStatistics;
+  if (statistics.AchievedFPS == 0.)
+    {
+    d->FrameStatisticsValueLabel->setText(tr("No volume rendered"));
+    return;
+    }
+  QString text = tr("%1 fps achieved, %2 fps expected\n").arg(
+    statistics.AchievedFPS, 0, 'f', 1).arg(statistics.ExpectedFPS, 0, 'f', 1);
+  text += tr("Ray cast: %1 ms\n").arg(statistics.RayCastTime * 1000., 0, 'f', 2);
+  text += tr("Upload: %1 Ko in %2 ms\n").arg(statistics.UploadedBytes / 1024)
+    .arg(statistics.UploadTime * 1000., 0, 'f', 2);
+  text += tr("Transfer functions: %1 ms\n").arg(
+    statistics.TransferFunctionTime * 1000., 0, 'f', 2);
+  text += tr("CPU preprocessing: %1 ms").arg(
+    statistics.PreprocessingTime * 1000., 0, 'f', 2);
+  d->FrameStatisticsValueLabel->setText(text);
+}
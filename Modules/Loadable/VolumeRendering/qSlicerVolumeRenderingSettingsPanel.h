@@ -68,6 +68,8 @@ protected slots:
   void onGPUMemoryChanged();
   void onDefaultRenderingMethodChanged(int);
   void updateVolumeRenderingLogicDefaultRenderingMethod();
+  /// Display vtkMRMLVolumeRenderingDisplayableManager::LastFrameStatistics
+  void updateFrameStatistics();
 
 protected:
   QScopedPointer<qSlicerVolumeRenderingSettingsPanelPrivate> d_ptr;
@@ -0,0 +1,440 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Volumes includes
+#include "vtkSlicerVolumesCinePlayer.h"
+
+// MRML includes
+#include <vtkMRMLScalarVolumeDisplayNode.h>
+#include <vtkMRMLScalarVolumeNode.h>
+#include <vtkMRMLTimeSeriesDatabaseStorageNode.h>
+
+// VTK includes
+#include <vtkCollection.h>
+#include <vtkImageData.h>
+#include <vtkObjectFactory.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <utility>
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkSlicerVolumesCinePlayer);
+vtkCxxRevisionMacro(vtkSlicerVolumesCinePlayer, "$Revision$");
+
+//----------------------------------------------------------------------------
+class vtkSlicerVolumesCinePlayer::vtkInternal
+{
+public:
+  vtkInternal();
+
+  /// Next frame after \a frame, -1 after the last one when not looping
+  int NextFrame(int frame, int numberOfFrames, int loop)const;
+  /// Read the image of \a frame
+  vtkImageData* ReadFrame(int frame);
+  /// Take the image of \a frame out of the buffer, 0 if it isn't buffered
+  vtkSmartPointer<vtkImageData> TakeBufferedFrame(int frame);
+  bool IsBuffered(int frame)const;
+
+  vtkSmartPointer<vtkCollection> FrameNodes;
+  vtkSmartPointer<vtkMRMLTimeSeriesDatabaseStorageNode> StorageNode;
+  /// Volume node the images of the database are read into
+  vtkSmartPointer<vtkMRMLScalarVolumeNode> Decoder;
+
+  typedef std::deque<std::pair<int, vtkSmartPointer<vtkImageData> > > BufferType;
+  BufferType Buffer;
+
+  double StartTime;
+  int StartFrame;
+  /// Number of frame periods elapsed between Play() and the last shown frame
+  int ShownPeriods;
+
+  bool DisplaySaved;
+  int SavedAutoWindowLevel;
+  int SavedAutoThreshold;
+};
+
+//----------------------------------------------------------------------------
+vtkSlicerVolumesCinePlayer::vtkInternal::vtkInternal()
+{
+  this->StartTime = 0.;
+  this->StartFrame = 0;
+  this->ShownPeriods = 0;
+  this->DisplaySaved = false;
+  this->SavedAutoWindowLevel = 1;
+  this->SavedAutoThreshold = 0;
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerVolumesCinePlayer::vtkInternal
+::NextFrame(int frame, int numberOfFrames, int loop)const
+{
+  if (frame + 1 < numberOfFrames)
+    {
+    return frame + 1;
+    }
+  return (loop && numberOfFrames > 0) ? 0 : -1;
+}
+
+//----------------------------------------------------------------------------
+vtkImageData* vtkSlicerVolumesCinePlayer::vtkInternal::ReadFrame(int frame)
+{
+  if (this->FrameNodes)
+    {
+    vtkMRMLScalarVolumeNode* frameNode = vtkMRMLScalarVolumeNode::SafeDownCast(
+      this->FrameNodes->GetItemAsObject(frame));
+    return frameNode ? frameNode->GetImageData() : 0;
+    }
+  if (this->StorageNode)
+    {
+    if (!this->Decoder)
+      {
+      this->Decoder = vtkSmartPointer<vtkMRMLScalarVolumeNode>::New();
+      }
+    this->StorageNode->SetCurrentImage(frame);
+    if (!this->StorageNode->ReadData(this->Decoder))
+      {
+      return 0;
+      }
+    return this->Decoder->GetImageData();
+    }
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkImageData> vtkSlicerVolumesCinePlayer::vtkInternal
+::TakeBufferedFrame(int frame)
+{
+  for (BufferType::iterator it = this->Buffer.begin(); it != this->Buffer.end(); ++it)
+    {
+    if (it->first == frame)
+      {
+      vtkSmartPointer<vtkImageData> image = it->second;
+      this->Buffer.erase(it);
+      return image;
+      }
+    }
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+bool vtkSlicerVolumesCinePlayer::vtkInternal::IsBuffered(int frame)const
+{
+  for (BufferType::const_iterator it = this->Buffer.begin(); it != this->Buffer.end(); ++it)
+    {
+    if (it->first == frame)
+      {
+      return true;
+      }
+    }
+  return false;
+}
+
+//----------------------------------------------------------------------------
+vtkSlicerVolumesCinePlayer::vtkSlicerVolumesCinePlayer()
+{
+  this->VolumeNode = 0;
+  this->CurrentFrame = -1;
+  this->FramesPerSecond = 10.;
+  this->BufferSize = 8;
+  this->Loop = 1;
+  this->Playing = 0;
+  this->NumberOfShownFrames = 0;
+  this->NumberOfDroppedFrames = 0;
+  this->Internal = new vtkInternal;
+}
+
+//----------------------------------------------------------------------------
+vtkSlicerVolumesCinePlayer::~vtkSlicerVolumesCinePlayer()
+{
+  this->Stop();
+  this->SetVolumeNode(0);
+  delete this->Internal;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerVolumesCinePlayer::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "VolumeNode: " << this->VolumeNode << "\n";
+  os << indent << "NumberOfFrames: " << this->GetNumberOfFrames() << "\n";
+  os << indent << "CurrentFrame: " << this->CurrentFrame << "\n";
+  os << indent << "FramesPerSecond: " << this->FramesPerSecond << "\n";
+  os << indent << "BufferSize: " << this->BufferSize << "\n";
+  os << indent << "Loop: " << this->Loop << "\n";
+  os << indent << "Playing: " << this->Playing << "\n";
+  os << indent << "NumberOfShownFrames: " << this->NumberOfShownFrames << "\n";
+  os << indent << "NumberOfDroppedFrames: " << this->NumberOfDroppedFrames << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerVolumesCinePlayer::SetVolumeNode(vtkMRMLScalarVolumeNode* volumeNode)
+{
+  if (volumeNode == this->VolumeNode)
+    {
+    return;
+    }
+  this->Stop();
+  vtkSetObjectBodyMacro(VolumeNode, vtkMRMLScalarVolumeNode, volumeNode);
+  this->CurrentFrame = -1;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerVolumesCinePlayer::SetFrameNodes(vtkCollection* frameNodes)
+{
+  this->Stop();
+  this->Internal->FrameNodes = frameNodes;
+  this->Internal->StorageNode = 0;
+  this->Internal->Buffer.clear();
+  this->CurrentFrame = -1;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerVolumesCinePlayer
+::SetFrameStorageNode(vtkMRMLTimeSeriesDatabaseStorageNode* storageNode)
+{
+  this->Stop();
+  this->Internal->StorageNode = storageNode;
+  this->Internal->FrameNodes = 0;
+  this->Internal->Buffer.clear();
+  this->CurrentFrame = -1;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerVolumesCinePlayer::GetNumberOfFrames()
+{
+  if (this->Internal->FrameNodes)
+    {
+    return this->Internal->FrameNodes->GetNumberOfItems();
+    }
+  if (this->Internal->StorageNode)
+    {
+    return this->Internal->StorageNode->GetNumberOfImages();
+    }
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerVolumesCinePlayer::SetCurrentFrame(int frame)
+{
+  if (frame < 0 || frame >= this->GetNumberOfFrames())
+    {
+    vtkErrorMacro("SetCurrentFrame: " << frame << " is not in [0, "
+                  << this->GetNumberOfFrames() << "[");
+    return;
+    }
+  this->ShowFrame(frame);
+  if (this->Playing)
+    {
+    // Continue playing from the new frame
+    this->Internal->StartTime = vtkTimerLog::GetUniversalTime();
+    this->Internal->StartFrame = frame;
+    this->Internal->ShownPeriods = 0;
+    this->FillBuffer();
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerVolumesCinePlayer::Play()
+{
+  if (this->Playing)
+    {
+    return;
+    }
+  if (!this->VolumeNode || this->GetNumberOfFrames() == 0)
+    {
+    vtkErrorMacro("Play: a volume node and frames are required");
+    return;
+    }
+  // The frames are shown with the same display mapping
+  vtkMRMLScalarVolumeDisplayNode* displayNode =
+    this->VolumeNode->GetScalarVolumeDisplayNode();
+  if (displayNode)
+    {
+    this->Internal->DisplaySaved = true;
+    this->Internal->SavedAutoWindowLevel = displayNode->GetAutoWindowLevel();
+    this->Internal->SavedAutoThreshold = displayNode->GetAutoThreshold();
+    displayNode->AutoWindowLevelOff();
+    displayNode->AutoThresholdOff();
+    }
+
+  this->NumberOfShownFrames = 0;
+  this->NumberOfDroppedFrames = 0;
+  this->Playing = 1;
+  if (this->CurrentFrame < 0 || this->CurrentFrame >= this->GetNumberOfFrames())
+    {
+    this->ShowFrame(0);
+    }
+  this->Internal->StartTime = vtkTimerLog::GetUniversalTime();
+  this->Internal->StartFrame = this->CurrentFrame;
+  this->Internal->ShownPeriods = 0;
+  this->FillBuffer();
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerVolumesCinePlayer::Stop()
+{
+  if (!this->Playing)
+    {
+    return;
+    }
+  this->Playing = 0;
+  this->Internal->Buffer.clear();
+  vtkMRMLScalarVolumeDisplayNode* displayNode = this->VolumeNode ?
+    this->VolumeNode->GetScalarVolumeDisplayNode() : 0;
+  if (displayNode && this->Internal->DisplaySaved)
+    {
+    displayNode->SetAutoWindowLevel(this->Internal->SavedAutoWindowLevel);
+    displayNode->SetAutoThreshold(this->Internal->SavedAutoThreshold);
+    }
+  this->Internal->DisplaySaved = false;
+  // The database reads the shown image again when the scene is reloaded
+  if (this->Internal->StorageNode && this->CurrentFrame >= 0)
+    {
+    this->Internal->StorageNode->SetCurrentImage(this->CurrentFrame);
+    }
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+double vtkSlicerVolumesCinePlayer::Tick()
+{
+  return this->Tick(vtkTimerLog::GetUniversalTime());
+}
+
+//----------------------------------------------------------------------------
+double vtkSlicerVolumesCinePlayer::Tick(double time)
+{
+  if (!this->Playing)
+    {
+    return -1.;
+    }
+  int numberOfFrames = this->GetNumberOfFrames();
+  int periods = static_cast<int>(
+    floor((time - this->Internal->StartTime) * this->FramesPerSecond));
+  if (periods > this->Internal->ShownPeriods)
+    {
+    int frame = this->Internal->StartFrame + periods;
+    if (frame >= numberOfFrames && !this->Loop)
+      {
+      // Show the last frame and stop
+      int lastFrame = numberOfFrames - 1;
+      this->NumberOfDroppedFrames += lastFrame - this->CurrentFrame - 1 > 0 ?
+        lastFrame - this->CurrentFrame - 1 : 0;
+      if (this->CurrentFrame != lastFrame)
+        {
+        this->ShowFrame(lastFrame);
+        }
+      this->Stop();
+      return -1.;
+      }
+    this->NumberOfDroppedFrames += periods - this->Internal->ShownPeriods - 1;
+    this->Internal->ShownPeriods = periods;
+    this->ShowFrame(frame % numberOfFrames);
+    }
+  this->FillBuffer();
+
+  double nextTime = this->Internal->StartTime +
+    (this->Internal->ShownPeriods + 1) / this->FramesPerSecond;
+  return nextTime > time ? nextTime - time : 0.;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerVolumesCinePlayer::ShowFrame(int frame)
+{
+  if (!this->VolumeNode)
+    {
+    return;
+    }
+  vtkSmartPointer<vtkImageData> image = this->Internal->TakeBufferedFrame(frame);
+  if (!image)
+    {
+    image = this->Internal->ReadFrame(frame);
+    }
+  if (!image)
+    {
+    vtkErrorMacro("ShowFrame: frame " << frame << " can't be read");
+    return;
+    }
+  // The views only see a new image pointer
+  this->VolumeNode->SetAndObserveImageData(image);
+  this->CurrentFrame = frame;
+  ++this->NumberOfShownFrames;
+}
+
+//----------------------------------------------------------------------------
+void vtkSlicerVolumesCinePlayer::FillBuffer()
+{
+  int numberOfFrames = this->GetNumberOfFrames();
+  int bufferSize = this->BufferSize < numberOfFrames ?
+    this->BufferSize : numberOfFrames;
+
+  // Frames to buffer, the next ones first
+  std::deque<int> frames;
+  int frame = this->CurrentFrame;
+  for (int i = 0; i < bufferSize; ++i)
+    {
+    frame = this->Internal->NextFrame(frame, numberOfFrames, this->Loop);
+    if (frame < 0 || frame == this->CurrentFrame)
+      {
+      break;
+      }
+    frames.push_back(frame);
+    }
+
+  // Drop the frames that have been passed
+  vtkInternal::BufferType::iterator it = this->Internal->Buffer.begin();
+  while (it != this->Internal->Buffer.end())
+    {
+    if (std::find(frames.begin(), frames.end(), it->first) == frames.end())
+      {
+      it = this->Internal->Buffer.erase(it);
+      }
+    else
+      {
+      ++it;
+      }
+    }
+
+  // Don't delay the next frame
+  double start = vtkTimerLog::GetUniversalTime();
+  double budget = 0.5 / this->FramesPerSecond;
+  std::deque<int>::const_iterator frameIt;
+  for (frameIt = frames.begin(); frameIt != frames.end(); ++frameIt)
+    {
+    if (this->Internal->IsBuffered(*frameIt))
+      {
+      continue;
+      }
+    if (vtkTimerLog::GetUniversalTime() - start > budget)
+      {
+      break;
+      }
+    vtkImageData* image = this->Internal->ReadFrame(*frameIt);
+    if (!image)
+      {
+      break;
+      }
+    this->Internal->Buffer.push_back(
+      std::make_pair(*frameIt, vtkSmartPointer<vtkImageData>(image)));
+    }
+}
@@ -0,0 +1,127 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkSlicerVolumesCinePlayer_h
+#define __vtkSlicerVolumesCinePlayer_h
+
+// VTK includes
+#include <vtkObject.h>
+
+#include "vtkSlicerVolumesModuleLogicExport.h"
+
+class vtkCollection;
+class vtkMRMLScalarVolumeNode;
+class vtkMRMLTimeSeriesDatabaseStorageNode;
+
+/// \brief Play the frames of a 4D series in a volume node.
+///
+/// The frames are either the volumes of a collection of scalar volume
+/// nodes (SetFrameNodes()) or the images of a time series database
+/// (SetFrameStorageNode()). The BufferSize frames following the current
+/// frame are read ahead into a ring buffer, and a frame is shown by setting
+/// its image data into VolumeNode: the views only see a new image pointer.
+/// Automatic window/level and threshold of the volume display node are
+/// turned off while playing, so all the frames are shown with the same
+/// display mapping and no histogram is computed per frame.
+///
+/// Tick() must be called by a timer at least FramesPerSecond times per
+/// second. It shows the frame due at the current time; when the calls are
+/// late, the frames in between are skipped and counted as dropped.
+/// The volume node keeps the last shown frame when the playback is stopped.
+class VTK_SLICER_VOLUMES_MODULE_LOGIC_EXPORT vtkSlicerVolumesCinePlayer
+  : public vtkObject
+{
+public:
+  static vtkSlicerVolumesCinePlayer *New();
+  vtkTypeRevisionMacro(vtkSlicerVolumesCinePlayer, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  /// Volume node that shows the frames
+  void SetVolumeNode(vtkMRMLScalarVolumeNode* volumeNode);
+  vtkGetObjectMacro(VolumeNode, vtkMRMLScalarVolumeNode);
+
+  /// Use the image data of the scalar volume nodes of \a frameNodes as
+  /// frames, in order. They must have the geometry of VolumeNode.
+  void SetFrameNodes(vtkCollection* frameNodes);
+
+  /// Use the images of the time series database of \a storageNode as
+  /// frames. The database prefetch of the storage node decodes the frames
+  /// after the buffered ones in the background.
+  void SetFrameStorageNode(vtkMRMLTimeSeriesDatabaseStorageNode* storageNode);
+
+  int GetNumberOfFrames();
+
+  /// Frame shown in VolumeNode, -1 if none has been shown yet.
+  vtkGetMacro(CurrentFrame, int);
+  /// Show \a frame now
+  void SetCurrentFrame(int frame);
+
+  /// Playback rate, 10 frames per second by default
+  vtkSetClampMacro(FramesPerSecond, double, 0.01, 1000.);
+  vtkGetMacro(FramesPerSecond, double);
+
+  /// Number of frames read ahead, 8 by default
+  vtkSetClampMacro(BufferSize, int, 1, 1024);
+  vtkGetMacro(BufferSize, int);
+
+  /// Restart from the first frame after the last one, on by default
+  vtkSetMacro(Loop, int);
+  vtkGetMacro(Loop, int);
+  vtkBooleanMacro(Loop, int);
+
+  /// Start playing from the current frame at FramesPerSecond
+  void Play();
+  /// Stop playing and restore the automatic display settings
+  void Stop();
+  vtkGetMacro(Playing, int);
+
+  /// Show the frame due now. Return the time in seconds until the next
+  /// frame is due, -1 if the playback is stopped (e.g. last frame reached).
+  double Tick();
+  /// Show the frame due at \a time (in seconds, see
+  /// vtkTimerLog::GetUniversalTime())
+  double Tick(double time);
+
+  /// Frames shown and skipped since Play()
+  vtkGetMacro(NumberOfShownFrames, int);
+  vtkGetMacro(NumberOfDroppedFrames, int);
+
+protected:
+  vtkSlicerVolumesCinePlayer();
+  virtual ~vtkSlicerVolumesCinePlayer();
+
+  /// Make sure the frames following the current one are buffered, within
+  /// half a frame period.
+  void FillBuffer();
+  void ShowFrame(int frame);
+
+  vtkMRMLScalarVolumeNode* VolumeNode;
+  int CurrentFrame;
+  double FramesPerSecond;
+  int BufferSize;
+  int Loop;
+  int Playing;
+  int NumberOfShownFrames;
+  int NumberOfDroppedFrames;
+
+  class vtkInternal;
+  vtkInternal* Internal;
+
+private:
+  vtkSlicerVolumesCinePlayer(const vtkSlicerVolumesCinePlayer&); // Not implemented
+  void operator=(const vtkSlicerVolumesCinePlayer&);             // Not implemented
+};
+
+#endif
@@ -0,0 +1,117 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Volumes logic
+#include "vtkSlicerVolumesCinePlayer.h"
+
+// MRML includes
+#include <vtkMRMLScalarVolumeDisplayNode.h>
+#include <vtkMRMLScalarVolumeNode.h>
+#include <vtkMRMLScene.h>
+
+// VTK includes
+#include <vtkCollection.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <iostream>
+
+//-----------------------------------------------------------------------------
+int vtkSlicerVolumesCinePlayerTest1( int vtkNotUsed(argc), char * vtkNotUsed(argv)[] )
+{
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLScalarVolumeDisplayNode> displayNode;
+  scene->AddNode(displayNode.GetPointer());
+  displayNode->AutoWindowLevelOn();
+  vtkNew<vtkMRMLScalarVolumeNode> volumeNode;
+  scene->AddNode(volumeNode.GetPointer());
+  volumeNode->SetAndObserveDisplayNodeID(displayNode->GetID());
+
+  const int numberOfFrames = 5;
+  vtkNew<vtkCollection> frameNodes;
+  for (int i = 0; i < numberOfFrames; ++i)
+    {
+    vtkNew<vtkImageData> image;
+    image->SetDimensions(4, 4, 4);
+    image->SetScalarTypeToShort();
+    image->AllocateScalars();
+    vtkNew<vtkMRMLScalarVolumeNode> frameNode;
+    frameNode->SetAndObserveImageData(image.GetPointer());
+    frameNodes->AddItem(frameNode.GetPointer());
+    }
+
+  vtkNew<vtkSlicerVolumesCinePlayer> player;
+  player->SetVolumeNode(volumeNode.GetPointer());
+  player->SetFrameNodes(frameNodes.GetPointer());
+  player->SetFramesPerSecond(10.);
+  player->SetBufferSize(2);
+  if (player->GetNumberOfFrames() != numberOfFrames)
+    {
+    std::cerr << "Wrong number of frames: " << player->GetNumberOfFrames() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  double start = vtkTimerLog::GetUniversalTime();
+  player->Play();
+  vtkMRMLScalarVolumeNode* frame0 =
+    vtkMRMLScalarVolumeNode::SafeDownCast(frameNodes->GetItemAsObject(0));
+  if (!player->GetPlaying() || player->GetCurrentFrame() != 0 ||
+      volumeNode->GetImageData() != frame0->GetImageData() ||
+      displayNode->GetAutoWindowLevel())
+    {
+    std::cerr << "Play failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Late by one frame
+  player->Tick(start + 2.5 / player->GetFramesPerSecond());
+  vtkMRMLScalarVolumeNode* frame2 =
+    vtkMRMLScalarVolumeNode::SafeDownCast(frameNodes->GetItemAsObject(2));
+  if (player->GetCurrentFrame() != 2 ||
+      volumeNode->GetImageData() != frame2->GetImageData() ||
+      player->GetNumberOfDroppedFrames() != 1)
+    {
+    std::cerr << "Tick failed: frame " << player->GetCurrentFrame()
+              << ", dropped " << player->GetNumberOfDroppedFrames() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Loop
+  player->Tick(start + 5.5 / player->GetFramesPerSecond());
+  if (player->GetCurrentFrame() != 0)
+    {
+    std::cerr << "Loop failed: frame " << player->GetCurrentFrame() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Stop at the last frame
+  player->LoopOff();
+  if (player->Tick(start + 20.5 / player->GetFramesPerSecond()) >= 0. ||
+      player->GetPlaying() || player->GetCurrentFrame() != numberOfFrames - 1)
+    {
+    std::cerr << "The playback didn't stop at the last frame" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (!displayNode->GetAutoWindowLevel())
+    {
+    std::cerr << "The automatic window/level is not restored" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -74,6 +74,12 @@ This work is supported by NA-MIC, NAC, BIRN, NCIGT, and the Slicer Community. Se
                 except (UserWarning,OSError) as message:
                   # TODO: how to put this into the error log?
                   print ('Problem trying to start DICOMListener:\n %s' % message)
+          # the watched folder is indexed incrementally in the background
+          watchedDirectory = settings.value('DICOM/WatchedDirectory')
+          if watchedDirectory and os.path.isdir(watchedDirectory):
+            if not hasattr(slicer, 'dicomWatchedFolder'):
+              slicer.dicomWatchedFolder = DICOMLib.DICOMWatchedFolder(slicer.dicomDatabase, watchedDirectory)
+              slicer.dicomWatchedFolder.start()
         if slicer.dicomDatabase:
           slicer.app.setDICOMDatabase(slicer.dicomDatabase)
 
@@ -100,6 +106,8 @@ This work is supported by NA-MIC, NAC, BIRN, NCIGT, and the Slicer Community. Se
     if hasattr(slicer, 'dicomListener'):
       print('trying to stop listener')
       slicer.dicomListener.stop()
+    if hasattr(slicer, 'dicomWatchedFolder'):
+      slicer.dicomWatchedFolder.stop()
 
 
 #
@@ -305,6 +313,10 @@ class DICOMWidget:
       slicer.dicomListener.fileToBeAddedCallback = self.onListenerToAddFile
       slicer.dicomListener.fileAddedCallback = self.onListenerAddedFile
 
+    if hasattr(slicer, 'dicomWatchedFolder'):
+      slicer.dicomWatchedFolder.filesToBeAddedCallback = self.onListenerToAddFile
+      slicer.dicomWatchedFolder.filesAddedCallback = self.onWatchedFolderAddedFiles
+
     self.contextMenu = qt.QMenu(self.tree)
     self.exportAction = qt.QAction("Export to Study", self.contextMenu)
     self.contextMenu.addAction(self.exportAction)
@@ -349,6 +361,7 @@ class DICOMWidget:
     that is not currently available.
     https://bugreports.qt-project.org/browse/QTBUG-10775
     """
+    DICOMLib.DICOMPlugin.clearFileValueCache()
     self.dicomApp.suspendModel()
     self.requestResumeModel()
     self.requestUpdateRecentActivity()
@@ -561,6 +574,15 @@ class DICOMWidget:
       slicer.util.showStatusMessage("Loaded: %s" % newFile, 1000)
     self.requestResumeModel()
 
+  def onWatchedFolderAddedFiles(self):
+    """Called after the watched folder has indexed a batch of files.
+    Restore and refresh the app model
+    """
+    newFiles = slicer.dicomWatchedFolder.lastFilesAdded
+    if newFiles:
+      slicer.util.showStatusMessage("Indexed %d files from %s" % (len(newFiles), slicer.dicomWatchedFolder.directory), 1000)
+    self.requestResumeModel()
+
   def onToggleServer(self):
     if self.testingServer and self.testingServer.qrRunning():
       self.testingServer.stop()
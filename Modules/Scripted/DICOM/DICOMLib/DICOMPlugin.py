@@ -89,6 +89,10 @@ class DICOMPlugin(object):
   """ Base class for DICOM plugins
   """
 
+  # values read from the dicom database, keyed by (file,tag),
+  # shared by all the plugins (see fileValues)
+  fileValueCache = {}
+
   def __init__(self):
     # displayed for the user as the pluging handling the load
     self.loadType = "Generic DICOM"
@@ -128,6 +132,34 @@ class DICOMPlugin(object):
     key = self.hashFiles(files)
     self.loadableCache[key] = loadables
 
+  def fileValues(self,files,tags):
+    """ Return a dictionary mapping each of the files to a dictionary
+    of the values of the tags (hex tag numbers, as in self.tags).
+    Plugins should query all the tags they need for a list of files
+    at once: each (file,tag) value is only read once from the
+    database, and is then kept until the database changes"""
+    cache = DICOMPlugin.fileValueCache
+    values = {}
+    for file in files:
+      fileValues = {}
+      for tag in tags:
+        key = (file,tag)
+        if not cache.has_key(key):
+          cache[key] = slicer.dicomDatabase.fileValue(file,tag)
+        fileValues[tag] = cache[key]
+      values[file] = fileValues
+    return values
+
+  def fileValue(self,file,tag):
+    """ Return the value of a tag for a file (see fileValues)"""
+    return self.fileValues([file],[tag])[file][tag]
+
+  @staticmethod
+  def clearFileValueCache():
+    """ Forget the values read from the database, to be called
+    when the database content changes"""
+    DICOMPlugin.fileValueCache.clear()
+
   def examine(self,fileList):
     """Look at the list of lists of filenames and return
     a list of DICOMLoadables that are options for loading
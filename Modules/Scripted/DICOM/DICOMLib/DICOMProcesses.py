@@ -190,6 +190,121 @@ class DICOMListener(DICOMProcess):
     stdErr = str(self.process.readAllStandardError())
     print ("processed stderr")
 
+class DICOMWatchedFolder(object):
+  """helper class to keep the database up to date with the content
+  of a folder (such as a PACS drop folder)
+  The folder is walked from a timer a batch of files at a time, and
+  only the files that are new or whose modification time or size
+  changed since the last scan are parsed and indexed, in place.
+  Once the whole folder has been walked, it is walked again after
+  rescanInterval seconds.  The modification time and size of the
+  indexed files are kept in the database directory so that the
+  scans are also incremental across sessions.
+  """
+
+  def __init__(self,database,directory,rescanInterval=60,batchSize=100,
+               filesToBeAddedCallback=None,filesAddedCallback=None):
+    self.dicomDatabase = database
+    self.directory = directory
+    self.indexer = ctk.ctkDICOMIndexer()
+    self.rescanInterval = rescanInterval
+    self.batchSize = batchSize
+    self.filesToBeAddedCallback = filesToBeAddedCallback
+    self.filesAddedCallback = filesAddedCallback
+    self.lastFilesAdded = []
+    self.stampsPath = os.path.dirname(database.databaseFilename) + "/watchedFolderStamps.txt"
+    self.stamps = {}
+    self.stampsModified = False
+    self.readStamps()
+    self.walker = None
+    self.timer = qt.QTimer()
+    self.timer.connect('timeout()', self.indexNextFiles)
+
+  def __del__(self):
+    self.stop()
+
+  def start(self):
+    self.walker = self.walk()
+    self.timer.start(0)
+
+  def stop(self):
+    self.timer.stop()
+    self.walker = None
+    self.writeStamps()
+
+  def readStamps(self):
+    """read the 'mtime size path' lines of the stamps file"""
+    self.stamps = {}
+    if not os.path.exists(self.stampsPath):
+      return
+    fp = open(self.stampsPath)
+    for line in fp:
+      fields = line.rstrip('\n').split(' ',2)
+      if len(fields) == 3:
+        self.stamps[fields[2]] = (float(fields[0]),long(fields[1]))
+    fp.close()
+
+  def writeStamps(self):
+    if not self.stampsModified:
+      return
+    fp = open(self.stampsPath,'w')
+    for path,(mtime,size) in self.stamps.iteritems():
+      fp.write('%r %d %s\n' % (mtime,size,path))
+    fp.close()
+    self.stampsModified = False
+
+  def walk(self):
+    """generate (path,stamp) for all the files of the folder, the
+    stamp being None if the file is unchanged since it was indexed"""
+    for root,dirs,files in os.walk(self.directory):
+      dirs.sort()
+      files.sort()
+      for name in files:
+        path = os.path.join(root,name)
+        try:
+          stat = os.stat(path)
+        except OSError:
+          continue
+        stamp = (stat.st_mtime,long(stat.st_size))
+        if self.stamps.get(path) == stamp:
+          yield path,None
+        else:
+          yield path,stamp
+
+  def indexNextFiles(self):
+    """index the changed files among the next files of the walk"""
+    if not self.walker:
+      self.start()
+      return
+    changedFiles = []
+    visitedCount = 0
+    finished = True
+    for path,stamp in self.walker:
+      visitedCount += 1
+      if stamp:
+        changedFiles.append((path,stamp))
+      if len(changedFiles) >= self.batchSize or visitedCount >= 100 * self.batchSize:
+        finished = False
+        break
+    if changedFiles:
+      if self.filesToBeAddedCallback:
+        self.filesToBeAddedCallback()
+      for path,stamp in changedFiles:
+        # files that are not dicom are also stamped, so that
+        # they are not parsed again at every scan
+        self.indexer.addFile(self.dicomDatabase, path, "")
+        self.stamps[path] = stamp
+      self.stampsModified = True
+      self.lastFilesAdded = [path for path,stamp in changedFiles]
+      if self.filesAddedCallback:
+        self.filesAddedCallback()
+    if finished:
+      self.writeStamps()
+      self.walker = None
+      self.timer.start(int(self.rescanInterval * 1000))
+    else:
+      self.timer.start(0)
+
 class DICOMSender(DICOMProcess):
   """Code to send files to a remote host
   (Uses storescu from dcmtk)
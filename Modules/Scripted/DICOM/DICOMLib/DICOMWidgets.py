@@ -28,6 +28,11 @@ class DICOMDetailsPopup(object):
   This is a helper used in the DICOMWidget class.
   """
 
+  # loadables of each plugin for each examined series, keyed by
+  # (plugin class, series UID), along with the insert stamp of
+  # the series files (see seriesInsertStamp)
+  examinedLoadables = {}
+
   def __init__(self,dicomApp,setBrowserPersistence=None):
     self.dicomApp = dicomApp
     self.setBrowserPersistence = setBrowserPersistence
@@ -214,27 +219,42 @@ class DICOMDetailsPopup(object):
         if loadable.confidence < highestConfidenceValue:
           loadable.selected = False
 
+  def seriesInsertStamp(self,files):
+    """Identify the content of a series in the database:
+    files that are inserted again or added to the series
+    change the stamp"""
+    stamps = [len(files)]
+    for file in (files[0],files[-1]):
+      instance = slicer.dicomDatabase.instanceForFile(file)
+      insertDateTime = slicer.dicomDatabase.insertDateTimeForInstance(instance)
+      stamps.append(insertDateTime.toString('yyyy-MM-dd hh:mm:ss.zzz'))
+    return tuple(stamps)
+
   def offerLoadables(self,uid,role):
     """Get all the loadable options at the currently selected level
-    and present them in the loadable table"""
-    fileLists = []
+    and present them in the loadable table.
+    The series are examined one after the other and the table is
+    updated as their loadables are found.  The loadables of the
+    series already examined are reused as long as the series
+    content is unchanged in the database."""
+    seriesUIDs = []
     if role == "Series":
-      fileLists.append(slicer.dicomDatabase.filesForSeries(uid))
+      seriesUIDs.append(uid)
     if role == "Study":
-      series = slicer.dicomDatabase.seriesForStudy(uid)
-      for serie in series:
-        fileLists.append(slicer.dicomDatabase.filesForSeries(serie))
+      seriesUIDs += slicer.dicomDatabase.seriesForStudy(uid)
     if role == "Patient":
       studies = slicer.dicomDatabase.studiesForPatient(uid)
       for study in studies:
-        series = slicer.dicomDatabase.seriesForStudy(study)
-        for serie in series:
-          fileList = slicer.dicomDatabase.filesForSeries(serie)
-          fileLists.append(fileList)
+        seriesUIDs += slicer.dicomDatabase.seriesForStudy(study)
+    fileListsBySeries = []
+    for seriesUID in seriesUIDs:
+      fileList = slicer.dicomDatabase.filesForSeries(seriesUID)
+      if len(fileList) > 0:
+        fileListsBySeries.append((seriesUID,fileList))
 
 
     allFileCount = missingFileCount = 0
-    for fileList in fileLists:
+    for seriesUID,fileList in fileListsBySeries:
         for filePath in fileList:
           allFileCount += 1
           if not os.path.exists(filePath):
@@ -252,37 +272,64 @@ class DICOMDetailsPopup(object):
     self.progress.minimumDuration = 0
     self.progress.show()
     self.progress.setValue(0)
-    self.progress.setMaximum(len(slicer.modules.dicomPlugins))
+    self.progress.setMaximum(len(fileListsBySeries) * len(slicer.modules.dicomPlugins))
     step = 0
 
-    loadEnabled = False
     self.loadablesByPlugin = {}
     for pluginClass in slicer.modules.dicomPlugins:
       if not self.pluginInstances.has_key(pluginClass):
         self.pluginInstances[pluginClass] = slicer.modules.dicomPlugins[pluginClass]()
-      plugin = self.pluginInstances[pluginClass]
+      self.loadablesByPlugin[self.pluginInstances[pluginClass]] = []
+    failedPlugins = []
+    for seriesUID,fileList in fileListsBySeries:
       if self.progress.wasCanceled:
         break
-      self.progress.labelText = '\nChecking %s' % pluginClass
-      slicer.app.processEvents()
+      insertStamp = self.seriesInsertStamp(fileList)
+      examined = False
+      for pluginClass in slicer.modules.dicomPlugins:
+        plugin = self.pluginInstances[pluginClass]
+        if self.progress.wasCanceled:
+          break
+        step +=1
+        key = (pluginClass,seriesUID)
+        if self.examinedLoadables.has_key(key) and self.examinedLoadables[key][0] == insertStamp:
+          self.loadablesByPlugin[plugin] += self.examinedLoadables[key][1]
+          continue
+        if pluginClass in failedPlugins:
+          continue
+        self.progress.labelText = '\nChecking %s' % pluginClass
+        self.progress.setValue(step)
+        slicer.app.processEvents()
+        try:
+          loadables = plugin.examine([fileList])
+          self.examinedLoadables[key] = (insertStamp,loadables)
+          self.loadablesByPlugin[plugin] += loadables
+          examined = True
+        except Exception,e:
+          failedPlugins.append(pluginClass)
+          import traceback
+          traceback.print_exc()
+          qt.QMessageBox.warning(self.window,
+              "DICOM", "Warning: Plugin failed: %s\n\nSee python console for error message." % pluginClass)
+          print("DICOM Plugin failed: %s", str(e))
+      if examined:
+        self.updateLoadables()
       self.progress.setValue(step)
-      slicer.app.processEvents()
-      try:
-        self.loadablesByPlugin[plugin] = plugin.examine(fileLists)
-        loadEnabled = loadEnabled or self.loadablesByPlugin[plugin] != []
-      except Exception,e:
-        import traceback
-        traceback.print_exc()
-        qt.QMessageBox.warning(self.window,
-            "DICOM", "Warning: Plugin failed: %s\n\nSee python console for error message." % pluginClass)
-        print("DICOM Plugin failed: %s", str(e))
+    self.updateLoadables()
+    self.progress.close()
+    self.progress = None
 
-      step +=1
+  def updateLoadables(self):
+    """Present the loadables found so far in the loadable table"""
+    loadEnabled = False
+    for plugin in self.loadablesByPlugin:
+      if hasattr(plugin,'seriesSorter'):
+        self.loadablesByPlugin[plugin].sort(plugin.seriesSorter)
+      loadEnabled = loadEnabled or self.loadablesByPlugin[plugin] != []
     self.loadButton.enabled = loadEnabled
     self.organizeLoadables()
     self.loadableTable.setLoadables(self.loadablesByPlugin)
-    self.progress.close()
-    self.progress = None
+    slicer.app.processEvents()
 
   def uncheckAllLoadables(self):
     self.loadableTable.uncheckAll()
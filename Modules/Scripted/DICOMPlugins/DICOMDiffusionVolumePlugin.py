@@ -78,8 +78,11 @@ class DICOMDiffusionVolumePluginClass(DICOMPlugin):
     dv.examine([['/media/extra650/data/DWI-examples/SiemensTrioTimB17-DWI/63000-000025-000001.dcm']])
     """
 
+    # query the values of the first file at once
+    values = self.fileValues([files[0]], self.tags.values())[files[0]]
+
     # get the series description to use as base for volume name
-    name = slicer.dicomDatabase.fileValue(files[0], self.tags['seriesDescription'])
+    name = values[self.tags['seriesDescription']]
     if name == "":
       name = "Unknown"
 
@@ -88,7 +91,7 @@ class DICOMDiffusionVolumePluginClass(DICOMPlugin):
     for vendor in self.diffusionTags:
       matchesVendor = True
       for tag in self.diffusionTags[vendor]:
-        value = slicer.dicomDatabase.fileValue(files[0], tag)
+        value = values[tag]
         hasTag = value != ""
         matchesVendor &= hasTag
       if matchesVendor:
@@ -58,11 +58,25 @@ class DICOMScalarVolumePluginClass(DICOMPlugin):
     files parameter.
     """
 
+    # make subseries volumes based on tag differences
+    subseriesTags = [
+        "seriesInstanceUID",
+        "contentTime",
+        "triggerTime",
+        "diffusionGradientOrientation",
+        "imageOrientationPatient",
+    ]
+
+    # query all the values used below at once
+    tagNames = ['seriesDescription', 'seriesNumber', 'position',
+                'orientation', 'pixelData', 'numberOfFrames'] + subseriesTags
+    values = self.fileValues(files, [self.tags[tagName] for tagName in tagNames])
+
     # get the series description to use as base for volume name
-    name = slicer.dicomDatabase.fileValue(files[0],self.tags['seriesDescription'])
+    name = values[files[0]][self.tags['seriesDescription']]
     if name == "":
       name = "Unknown"
-    num = slicer.dicomDatabase.fileValue(files[0],self.tags['seriesNumber'])
+    num = values[files[0]][self.tags['seriesNumber']]
     if num != "":
       name = num + ": " + name
 
@@ -79,16 +93,6 @@ class DICOMScalarVolumePluginClass(DICOMPlugin):
     positions = {}
     orientations = {}
 
-
-    # make subseries volumes based on tag differences
-    subseriesTags = [
-        "seriesInstanceUID",
-        "contentTime",
-        "triggerTime",
-        "diffusionGradientOrientation",
-        "imageOrientationPatient",
-    ]
-
     # it will be set to true if pixel data is found in any of the files
     pixelDataAvailable = False
 
@@ -102,16 +106,16 @@ class DICOMScalarVolumePluginClass(DICOMPlugin):
     for file in loadable.files:
 
       # save position and orientation
-      positions[file] = slicer.dicomDatabase.fileValue(file,self.tags['position'])
+      positions[file] = values[file][self.tags['position']]
       if positions[file] == "":
         positions[file] = None
-      orientations[file] = slicer.dicomDatabase.fileValue(file,self.tags['orientation'])
+      orientations[file] = values[file][self.tags['orientation']]
       if orientations[file] == "":
         orientations[file] = None
 
       # check for subseries values
       for tag in subseriesTags:
-        value = slicer.dicomDatabase.fileValue(file,self.tags[tag])
+        value = values[file][self.tags[tag]]
         if not subseriesValues.has_key(tag):
           subseriesValues[tag] = []
         if not subseriesValues[tag].__contains__(value):
@@ -145,7 +149,7 @@ class DICOMScalarVolumePluginClass(DICOMPlugin):
     for loadable in loadables:
       newFiles = []
       for file in loadable.files:
-        if slicer.dicomDatabase.fileValue(file,self.tags['pixelData'])!='':
+        if values[file][self.tags['pixelData']]!='':
           newFiles.append(file)
       if len(newFiles) > 0:
         loadable.files = newFiles
@@ -173,14 +177,14 @@ class DICOMScalarVolumePluginClass(DICOMPlugin):
       # series and calculate the scan direction (assumed to be perpendicular
       # to the acquisition plane)
       #
-      value = slicer.dicomDatabase.fileValue(loadable.files[0], self.tags['numberOfFrames'])
+      value = values[loadable.files[0]][self.tags['numberOfFrames']]
       if value != "":
         loadable.warning = "Multi-frame image. If slice orientation or spacing is non-uniform then the image may be displayed incorrectly. Use with caution."
 
       validGeometry = True
       ref = {}
       for tag in [self.tags['position'], self.tags['orientation']]:
-        value = slicer.dicomDatabase.fileValue(loadable.files[0], tag)
+        value = values[loadable.files[0]][tag]
         if not value or value == "":
           loadable.warning = "Reference image in series does not contain geometry information.  Please use caution."
           validGeometry = False
@@ -315,8 +319,9 @@ class DICOMScalarVolumePluginClass(DICOMPlugin):
       # corresponding to the loaded files
       #
       instanceUIDs = ""
+      values = self.fileValues(loadable.files, [self.tags['instanceUID']])
       for file in loadable.files:
-        uid = slicer.dicomDatabase.fileValue(file,self.tags['instanceUID'])
+        uid = values[file][self.tags['instanceUID']]
         if uid == "":
           uid = "Unknown"
         instanceUIDs += uid + " "
@@ -51,11 +51,12 @@ class DICOMSlicerDataBundlePluginClass(DICOMPlugin):
     loadables = []
     if len(files) == 1:
       f = files[0]
+      values = self.fileValues([f], [self.tags['seriesDescription'], self.tags['candygram']])[f]
       # get the series description to use as base for volume name
-      name = slicer.dicomDatabase.fileValue(f, self.tags['seriesDescription'])
+      name = values[self.tags['seriesDescription']]
       if name == "":
         name = "Unknown"
-      candygramValue = slicer.dicomDatabase.fileValue(f, self.tags['candygram'])
+      candygramValue = values[self.tags['candygram']]
       if candygramValue:
         # default loadable includes all files for series
         loadable = DICOMLib.DICOMLoadable()
@@ -73,7 +74,7 @@ class DICOMSlicerDataBundlePluginClass(DICOMPlugin):
 
     f = loadable.files[0]
     try:
-      zipSize = int(slicer.dicomDatabase.fileValue(f, self.tags['zipSize']))
+      zipSize = int(self.fileValue(f, self.tags['zipSize']))
     except ValueError:
       print("Could not get zipSize for %s" % f)
       return False
@@ -78,6 +78,13 @@ class DataProbeInfoWidget(object):
     self.styleObserverTags = []
     # keep a map of interactor styles to sliceWidgets so we can easily get sliceLogic
     self.sliceWidgetsPerStyle = {}
+    # the mouse moves faster than the display refreshes: the events are
+    # compressed and only the last position is probed when the timer fires
+    self.pendingProbe = None
+    self.probeTimer = qt.QTimer()
+    self.probeTimer.setSingleShot(True)
+    self.probeTimer.setInterval(16)
+    self.probeTimer.connect('timeout()', self.probePendingEvent)
     self.refreshObservers()
 
     layoutManager = slicer.app.layoutManager()
@@ -88,9 +95,6 @@ class DataProbeInfoWidget(object):
     if type == 'small':
       self.createSmall()
 
-    #Helper class to calculate and display tensor scalars
-    self.calculateTensorScalars = CalculateTensorScalars()
-
 
   def __del__(self):
     self.removeObservers()
@@ -109,6 +113,7 @@ class DataProbeInfoWidget(object):
       observee.RemoveObserver(tag)
     self.styleObserverTags = []
     self.sliceWidgetsPerStyle = {}
+    self.pendingProbe = None
 
   def refreshObservers(self):
     """ When the layout changes, drop the observers from
@@ -132,74 +137,9 @@ class DataProbeInfoWidget(object):
           self.styleObserverTags.append([style,tag])
       # TODO: also observe the slice nodes
 
-  def getPixelString(self,volumeNode,ijk):
-    """Given a volume node, create a human readable
-    string describing the contents"""
-    # TODO: the volume nodes should have a way to generate
-    # these strings in a generic way
-    if not volumeNode:
-      return "No volume"
-    imageData = volumeNode.GetImageData()
-    if not imageData:
-      return "No Image"
-    dims = imageData.GetDimensions()
-    for ele in xrange(3):
-      if ijk[ele] < 0 or ijk[ele] >= dims[ele]:
-        return "Out of Frame"
-    pixel = ""
-    if volumeNode.GetLabelMap():
-      labelIndex = int(imageData.GetScalarComponentAsDouble(ijk[0], ijk[1], ijk[2], 0))
-      labelValue = "Unknown"
-      colorNode = volumeNode.GetDisplayNode().GetColorNode()
-      if colorNode:
-        labelValue = colorNode.GetColorName(labelIndex)
-      return "%s (%d)" % (labelValue, labelIndex)
-
-    if volumeNode.IsA("vtkMRMLDiffusionTensorVolumeNode"):
-        point_idx = imageData.FindPoint(ijk[0], ijk[1], ijk[2])
-        if point_idx == -1:
-            return "Out of bounds"
-
-        if not imageData.GetPointData():
-            return "No Point Data"
-
-        tensors = imageData.GetPointData().GetTensors()
-        if not tensors:
-            return "No Tensor Data"
-
-        tensor = imageData.GetPointData().GetTensors().GetTuple9(point_idx)
-        scalarVolumeDisplayNode = volumeNode.GetScalarVolumeDisplayNode()
-
-        if scalarVolumeDisplayNode:
-            operation = scalarVolumeDisplayNode.GetScalarInvariant()
-        else:
-            operation = None
-
-        value = self.calculateTensorScalars(tensor, operation=operation)
-        if value is not None:
-            valueString = ("%f" % value).rstrip('0').rstrip('.')
-            return "%s %s"%(scalarVolumeDisplayNode.GetScalarInvariantAsString(), valueString)
-        else:
-            return scalarVolumeDisplayNode.GetScalarInvariantAsString()
-
-    # default - non label scalar volume
-    numberOfComponents = imageData.GetNumberOfScalarComponents()
-    if numberOfComponents > 3:
-      return "%d components" % numberOfComponents
-    for c in xrange(numberOfComponents):
-      component = imageData.GetScalarComponentAsDouble(ijk[0],ijk[1],ijk[2],c)
-      if component.is_integer():
-        component = int(component)
-      # format string according to suggestion here:
-      # http://stackoverflow.com/questions/2440692/formatting-floats-in-python-without-superfluous-zeros
-      componentString = ("%f" % component).rstrip('0').rstrip('.')
-      pixel += ("%s, " % componentString)
-    return pixel[:-2]
-
-
   def processEvent(self,observee,event):
-    # TODO: use a timer to delay calculation and compress events
     if event == 'LeaveEvent':
+      self.pendingProbe = None
       # reset all the readouts
       self.viewerColor.setText( "" )
       self.viewerName.setText( "" )
@@ -214,52 +154,53 @@ class DataProbeInfoWidget(object):
       return
     if self.sliceWidgetsPerStyle.has_key(observee):
       sliceWidget = self.sliceWidgetsPerStyle[observee]
-      sliceLogic = sliceWidget.sliceLogic()
-      sliceNode = sliceWidget.mrmlSliceNode()
       interactor = observee
       xy = interactor.GetEventPosition()
       xyz = sliceWidget.sliceView().convertDeviceToXYZ(xy);
-      # populate the widgets
-      self.viewerColor.setText( " " )
-      rgbColor = sliceNode.GetLayoutColor();
-      color = qt.QColor.fromRgbF(rgbColor[0], rgbColor[1], rgbColor[2])
-      if hasattr(color, 'name'):
-        self.viewerColor.setStyleSheet('QLabel {background-color : %s}' % color.name())
-      self.viewerName.setText( "  " + sliceNode.GetLayoutName() + "  " )
-      # TODO: get z value from lightbox
-      ras = sliceWidget.sliceView().convertXYZToRAS(xyz)
-      self.viewerRAS.setText( "RAS: (%.1f, %.1f, %.1f)" % ras )
-      self.viewerOrient.setText( "  " + sliceWidget.sliceOrientation )
-      self.viewerSpacing.setText( "%.1f" % sliceLogic.GetLowestVolumeSliceSpacing()[2] )
-      if sliceNode.GetSliceSpacingMode() == 1:
-        self.viewerSpacing.setText( "(" + self.viewerSpacing.text + ")" )
-      self.viewerSpacing.setText( " Sp: " + self.viewerSpacing.text )
-      layerLogicCalls = (('L', sliceLogic.GetLabelLayer),
-                         ('F', sliceLogic.GetForegroundLayer),
-                         ('B', sliceLogic.GetBackgroundLayer))
-      for layer,logicCall in layerLogicCalls:
-        layerLogic = logicCall()
-        volumeNode = layerLogic.GetVolumeNode()
-        nameLabel = "None"
-        ijkLabel = ""
-        valueLabel = ""
-        if volumeNode:
-          nameLabel = self.fitName(volumeNode.GetName())
-          xyToIJK = layerLogic.GetXYToIJKTransform().GetMatrix()
-          ijkFloat = xyToIJK.MultiplyPoint(xyz+(1,))[:3]
-          ijk = []
-          for element in ijkFloat:
-            try:
-              index = int(round(element))
-            except ValueError:
-              index = 0
-            ijk.append(index)
-            ijkLabel += "%d, " % index
-          ijkLabel = ijkLabel[:-2]
-          valueLabel = self.getPixelString(volumeNode,ijk)
-        self.layerNames[layer].setText( '<b>' + nameLabel )
-        self.layerIJKs[layer].setText( '(' + ijkLabel + ')' )
-        self.layerValues[layer].setText( '<b>' + valueLabel )
+      self.pendingProbe = (sliceWidget, xyz)
+      if not self.probeTimer.isActive():
+        self.probeTimer.start()
+
+  def probePendingEvent(self):
+    if not self.pendingProbe:
+      return
+    sliceWidget, xyz = self.pendingProbe
+    self.pendingProbe = None
+    sliceLogic = sliceWidget.sliceLogic()
+    sliceNode = sliceWidget.mrmlSliceNode()
+    # populate the widgets
+    self.viewerColor.setText( " " )
+    rgbColor = sliceNode.GetLayoutColor();
+    color = qt.QColor.fromRgbF(rgbColor[0], rgbColor[1], rgbColor[2])
+    if hasattr(color, 'name'):
+      self.viewerColor.setStyleSheet('QLabel {background-color : %s}' % color.name())
+    self.viewerName.setText( "  " + sliceNode.GetLayoutName() + "  " )
+    # TODO: get z value from lightbox
+    ras = sliceWidget.sliceView().convertXYZToRAS(xyz)
+    self.viewerRAS.setText( "RAS: (%.1f, %.1f, %.1f)" % ras )
+    self.viewerOrient.setText( "  " + sliceWidget.sliceOrientation )
+    self.viewerSpacing.setText( "%.1f" % sliceLogic.GetLowestVolumeSliceSpacing()[2] )
+    if sliceNode.GetSliceSpacingMode() == 1:
+      self.viewerSpacing.setText( "(" + self.viewerSpacing.text + ")" )
+    self.viewerSpacing.setText( " Sp: " + self.viewerSpacing.text )
+    # all the layers are probed in one call
+    sliceLogic.Probe(xyz)
+    layerLogicCalls = (('L', sliceLogic.GetLabelLayer),
+                       ('F', sliceLogic.GetForegroundLayer),
+                       ('B', sliceLogic.GetBackgroundLayer))
+    for layer,logicCall in layerLogicCalls:
+      layerLogic = logicCall()
+      volumeNode = layerLogic.GetVolumeNode()
+      nameLabel = "None"
+      ijkLabel = ""
+      valueLabel = ""
+      if volumeNode:
+        nameLabel = self.fitName(volumeNode.GetName())
+        ijkLabel = "%d, %d, %d" % layerLogic.GetProbeIJK()
+        valueLabel = layerLogic.GetProbeString()
+      self.layerNames[layer].setText( '<b>' + nameLabel )
+      self.layerIJKs[layer].setText( '(' + ijkLabel + ')' )
+      self.layerValues[layer].setText( '<b>' + valueLabel )
 
   def createSmall(self):
     """Make the internals of the widget to display in the
@@ -420,44 +361,6 @@ class DataProbeWidget:
     tester.runTest()
 
 
-class CalculateTensorScalars:
-    def __init__(self):
-        self.dti_math = slicer.vtkDiffusionTensorMathematics()
-
-        self.single_pixel_image = vtk.vtkImageData()
-        self.single_pixel_image.SetExtent(0, 0, 0, 0, 0, 0)
-        self.single_pixel_image.AllocateScalars()
-
-        self.tensor_data = vtk.vtkFloatArray()
-        self.tensor_data.SetNumberOfComponents(9)
-        self.tensor_data.SetNumberOfTuples(self.single_pixel_image.GetNumberOfPoints())
-        self.single_pixel_image.GetPointData().SetTensors(self.tensor_data)
-
-        self.dti_math.SetInput(self.single_pixel_image)
-
-    def __call__(self, tensor, operation=None):
-        if len(tensor) != 9:
-            raise ValueError("Invalid tensor a 9-array is required")
-
-        self.tensor_data.SetTupleValue(0, tensor)
-        self.tensor_data.Modified()
-        self.single_pixel_image.Modified()
-
-        if operation is not None:
-            self.dti_math.SetOperation(operation)
-        else:
-            self.dti_math.SetOperationToFractionalAnisotropy()
-
-        self.dti_math.Update()
-        output = self.dti_math.GetOutput()
-
-        if output and output.GetNumberOfScalarComponents() > 0:
-            value = output.GetScalarComponentAsDouble(0, 0, 0, 0)
-            return value
-        else:
-            return None
-
-
 #
 # DataProbeLogic
 #
@@ -128,29 +128,7 @@ class DilateEffectLogic(MorphologyEffect.MorphologyEffectLogic):
     super(DilateEffectLogic,self).__init__(sliceLogic)
 
   def erode(self,fill,neighborMode,iterations):
-
-    eroder = slicer.vtkImageErode()
-    eroder.SetInput( self.getScopedLabelInput() )
-    eroder.SetOutput( self.getScopedLabelOutput() )
-
-    eroder.SetForeground( fill )
-    eroder.SetBackground( self.editUtil.getLabel() )
-
-    if neighborMode == '8':
-      eroder.SetNeighborTo8()
-    elif neighborMode == '4':
-      eroder.SetNeighborTo4()
-    else:
-      # TODO: error feedback from effect logic?
-      # bad neighbor mode - silently use default
-      print('Bad neighborMode: %s' % neighborMode)
-
-    for i in xrange(iterations):
-      # TODO: $this setProgressFilter eroder "Dilate ($i)"
-      eroder.Update()
-
-    self.applyScopedLabel()
-    eroder.SetOutput( None )
+    self.morphology(fill, self.editUtil.getLabel(), neighborMode, iterations)
 
 
 
@@ -192,40 +192,37 @@ class EditUtil(object):
 
 
 class UndoRedo(object):
-  """ Code to manage a list of undo/redo volumes
-  stored in a compressed format using the vtkImageStash
-  class to compress label maps in a thread
+  """ Code to manage a list of undo/redo checkpoints.
+  Each checkpoint stores only the voxels changed by one
+  editing operation using the vtkImageRegionDiff class, so the
+  cost of a checkpoint is proportional to the size of the edit.
+  The changes are found by comparing the label map with a copy
+  of its state at the previous checkpoint.
   """
 
   class checkPoint(object):
     """Internal class to store one checkpoint
-    step consisting of the stashed data
+    step consisting of the changed region of the label map
     and the volumeNode it corresponds to
     """
-    def __init__(self,volumeNode):
+    def __init__(self,volumeNode,diff):
       self.volumeNode = volumeNode
-      self.stashImage = vtk.vtkImageData()
-      self.stash = slicer.vtkImageStash()
-      self.stashImage.DeepCopy( volumeNode.GetImageData() )
-      self.stash.SetStashImage( self.stashImage )
-      self.stash.ThreadedStash()
-
-    def restore(self):
-      """Unstash the volume but first check that the
-      stash operation is not still ongoing in the other thread.
-      TODO: the stash operation is determinisitic, so there's
-      no chance of a deadlock here, but it would still be better
-      to integrate the wait into the event queue to avoid locking
-      the interface.  In practice this would only happen if the user
-      clicks Undo while the thread is still executing, which is
-      unlikely.  And at worst this busy loop will consume two threads
-      (this one and the stashing one) for the time the stash takes to complete.
+      self.diff = diff
+
+    def restore(self,before,referenceImage=None):
+      """Patch the volume with the voxels before or after the
+      operation, as well as the reference image if given.
       """
-      while self.stash.GetStashing():
-        pass
-      self.stash.Unstash()
-      self.volumeNode.GetImageData().DeepCopy( self.stashImage )
+      if before:
+        restored = self.diff.ApplyBefore( self.volumeNode.GetImageData() )
+        if referenceImage:
+          self.diff.ApplyBefore( referenceImage )
+      else:
+        restored = self.diff.ApplyAfter( self.volumeNode.GetImageData() )
+        if referenceImage:
+          self.diff.ApplyAfter( referenceImage )
       EditUtil().markVolumeNodeAsModified(self.volumeNode)
+      return restored
 
 
   def __init__(self,undoSize=100):
@@ -235,6 +232,12 @@ class UndoRedo(object):
     self.redoList = []
     self.editUtil = EditUtil()
     self.stateChangedCallback = self.defaultStateChangedCallback
+    # copy of the label map at the last checkpoint
+    self.referenceImage = None
+    self.referenceVolumeNode = None
+    self.referenceMTime = 0
+    # label map being modified by an operation since saveState
+    self.pendingVolumeNode = None
 
   def defaultStateChangedCallback(self):
     """placeholder so that using class can define a callable
@@ -244,60 +247,118 @@ class UndoRedo(object):
 
   def undoEnabled(self):
     """for managing undo/redo button state"""
-    return self.enabled and self.undoList != []
+    return self.enabled and (self.undoList != [] or self.pendingVolumeNode != None)
 
   def redoEnabled(self):
     """for managing undo/redo button state"""
     return self.enabled and self.redoList != []
 
-  def storeVolume(self,checkPointList,volumeNode):
+  def scalarsMTime(self,volumeNode):
     """ Internal helper function
-    Save a stashed copy of the given volume node into
-    the passed list (could be undo or redo list)
+    Modification time of the voxels of the volume node
     """
-    if not self.enabled or not volumeNode or not volumeNode.GetImageData():
-      return
-    checkPointList.append( self.checkPoint(volumeNode) )
-    self.stateChangedCallback()
-    if len(checkPointList) >= self.undoSize:
-      return( checkPointList[1:] )
+    return volumeNode.GetImageData().GetPointData().GetScalars().GetMTime()
+
+  def updateReference(self,volumeNode):
+    """ Internal helper function
+    Copy the current state of the given volume node to compare
+    it with after the next operation
+    """
+    self.referenceImage = vtk.vtkImageData()
+    self.referenceImage.DeepCopy( volumeNode.GetImageData() )
+    self.referenceVolumeNode = volumeNode
+    self.referenceMTime = self.scalarsMTime(volumeNode)
+
+  def trimList(self,checkPointList):
+    """ Internal helper function
+    Drop the oldest checkpoints of the list
+    """
+    if len(checkPointList) > self.undoSize:
+      return( checkPointList[-self.undoSize:] )
     else:
       return( checkPointList )
 
+  def storePending(self):
+    """ Internal helper function
+    Store the changes made by the pending operation
+    as a checkpoint onto the undoList
+    """
+    volumeNode = self.pendingVolumeNode
+    self.pendingVolumeNode = None
+    if not volumeNode or not volumeNode.GetImageData():
+      return
+    if volumeNode != self.referenceVolumeNode:
+      return
+    diff = slicer.vtkImageRegionDiff()
+    changed = diff.Compute( self.referenceImage, volumeNode.GetImageData() )
+    if changed < 0:
+      # the geometry of the label map changed, its previous state is lost
+      self.updateReference(volumeNode)
+      return
+    if changed > 0:
+      diff.ApplyAfter( self.referenceImage )
+      self.undoList = self.trimList( self.undoList + [self.checkPoint(volumeNode, diff)] )
+    self.referenceMTime = self.scalarsMTime(volumeNode)
+
+  def referenceImageOf(self,volumeNode):
+    """ Internal helper function
+    The reference image if it is the copy of the given volume node
+    """
+    if volumeNode == self.referenceVolumeNode:
+      return self.referenceImage
+    return None
+
   def saveState(self):
     """Called by effects as they modify the label volume node
     """
-    # store current state onto undoList
-    self.undoList = self.storeVolume( self.undoList, self.editUtil.getLabelVolume() )
+    if not self.enabled:
+      return
+    # the previous operation is done
+    self.storePending()
+    volumeNode = self.editUtil.getLabelVolume()
+    if not volumeNode or not volumeNode.GetImageData():
+      return
+    # the volume could have been changed outside of the editor
+    if (volumeNode != self.referenceVolumeNode or
+        self.scalarsMTime(volumeNode) != self.referenceMTime):
+      self.updateReference(volumeNode)
+    self.pendingVolumeNode = volumeNode
     self.redoList = []
     self.stateChangedCallback()
 
   def undo(self):
     """Perform the operation when the user presses
     the undo button on the editor interface.
-    This pushes the current state onto the redoList and
-    removes a volume from the undoList.
+    This restores the voxels changed by the last operation
+    and moves its checkpoint to the redoList.
     """
+    self.storePending()
     if self.undoList == []:
+      self.stateChangedCallback()
       return
-    # store current state onto redoList
-    self.redoList = self.storeVolume( self.redoList, self.editUtil.getLabelVolume() )
     # get the checkPoint to restore and remove it from the list
-    self.undoList[-1].restore()
+    checkPoint = self.undoList[-1]
     self.undoList = self.undoList[:-1]
+    if checkPoint.restore( True, self.referenceImageOf(checkPoint.volumeNode) ):
+      self.redoList = self.trimList( self.redoList + [checkPoint] )
+    if checkPoint.volumeNode == self.referenceVolumeNode:
+      self.referenceMTime = self.scalarsMTime(checkPoint.volumeNode)
     self.stateChangedCallback()
 
   def redo(self):
     """Perform the operation when the user presses
     the undo button on the editor interface.
-    This pushes the current state onto the undo stack
-    and restores the state from the redo stack
+    This applies again the voxels changed by the last undone
+    operation and moves its checkpoint back to the undoList.
     """
     if self.redoList == []:
       return
-    # store current state onto undoList
-    self.undoList = self.storeVolume( self.undoList, self.editUtil.getLabelVolume() )
+    self.storePending()
     # get the checkPoint to restore and remove it from the list
-    self.redoList[-1].restore()
+    checkPoint = self.redoList[-1]
     self.redoList = self.redoList[:-1]
+    if checkPoint.restore( False, self.referenceImageOf(checkPoint.volumeNode) ):
+      self.undoList = self.trimList( self.undoList + [checkPoint] )
+    if checkPoint.volumeNode == self.referenceVolumeNode:
+      self.referenceMTime = self.scalarsMTime(checkPoint.volumeNode)
     self.stateChangedCallback()
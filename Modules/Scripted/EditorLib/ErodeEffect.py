@@ -128,30 +128,7 @@ class ErodeEffectLogic(MorphologyEffect.MorphologyEffectLogic):
     super(ErodeEffectLogic,self).__init__(sliceLogic)
 
   def erode(self,fill,neighborMode,iterations):
-
-    eroder = slicer.vtkImageErode()
-    eroder.SetInput( self.getScopedLabelInput() )
-    eroder.SetOutput( self.getScopedLabelOutput() )
-
-    eroder.SetForeground( self.editUtil.getLabel() )
-    eroder.SetBackground( fill )
-
-    if neighborMode == '8':
-      eroder.SetNeighborTo8()
-    elif neighborMode == '4':
-      eroder.SetNeighborTo4()
-    else:
-      # TODO: error feedback from effect logic?
-      # bad neighbor mode - silently use default
-      print('Bad neighborMode: %s' % neighborMode)
-
-    for i in xrange(iterations):
-      # TODO: $this setProgressFilter eroder "Erode ($i)"
-      print('updating')
-      eroder.Update()
-
-    self.applyScopedLabel()
-    eroder.SetOutput( None )
+    self.morphology(self.editUtil.getLabel(), fill, neighborMode, iterations)
 
 
 
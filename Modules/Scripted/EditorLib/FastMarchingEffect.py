@@ -60,6 +60,12 @@ class FastMarchingEffectOptions(Effect.EffectOptions):
     self.frame.layout().addWidget(self.march)
     self.widgets.append(self.march)
 
+    self.stop = qt.QPushButton("Stop", self.frame)
+    self.stop.setToolTip("Stop the Marching operation, the segmentation grown so far is kept")
+    self.stop.enabled = False
+    self.frame.layout().addWidget(self.stop)
+    self.widgets.append(self.stop)
+
     self.percentVolume = qt.QLabel('Maximum volume of the structure: ')
     self.percentVolume.setToolTip('Total maximum volume')
     self.frame.layout().addWidget(self.percentVolume)
@@ -74,9 +80,10 @@ class FastMarchingEffectOptions(Effect.EffectOptions):
     self.widgets.append(self.marcher)
     self.marcher.connect('valueChanged(double)',self.onMarcherChanged)
 
-    HelpButton(self.frame, "To use FastMarching effect, first mark the areas that belong to the structure of interest to initialize the algorithm. Define the expected volume of the structure you are trying to segment, and hit March.\nAfter computation is complete, use the Marcher slider to go over the segmentation history.")
+    HelpButton(self.frame, "To use FastMarching effect, first mark the areas that belong to the structure of interest to initialize the algorithm. Define the expected volume of the structure you are trying to segment, and hit March.\nThe segmentation is shown while it grows, hit Stop as soon as it looks right.\nAfter computation is complete, use the Marcher slider to go over the segmentation history.")
 
     self.march.connect('clicked()', self.onMarch)
+    self.stop.connect('clicked()', self.onStop)
 
     # Add vertical spacer
     self.frame.layout().addStretch(1)
@@ -111,7 +118,13 @@ class FastMarchingEffectOptions(Effect.EffectOptions):
     try:
       slicer.util.showStatusMessage('Running FastMarching...', 2000)
       self.logic.undoRedo = self.undoRedo
-      npoints = self.logic.fastMarching(self.percentMax.value)
+      self.march.enabled = False
+      self.stop.enabled = True
+      try:
+        npoints = self.logic.fastMarching(self.percentMax.value)
+      finally:
+        self.march.enabled = True
+        self.stop.enabled = False
       slicer.util.showStatusMessage('FastMarching finished', 2000)
       if npoints:
         self.marcher.minimum = 0
@@ -123,6 +136,9 @@ class FastMarchingEffectOptions(Effect.EffectOptions):
       print('No tools available!')
       pass
 
+  def onStop(self):
+    self.logic.stop()
+
   def onMarcherChanged(self,value):
     self.logic.updateLabel(value/self.marcher.maximum)
 
@@ -248,6 +264,12 @@ class FastMarchingEffectLogic(Effect.EffectLogic):
     if nSeeds == 0:
       return 0
 
+    # the label map is shown while the front grows, so that the user
+    # can stop it: save it before it changes
+    self.undoRedo.saveState()
+    self.fm.setPreview(1)
+    frontTag = self.fm.AddObserver(slicer.vtkPichonFastMarching.FrontEvent, self.onFront)
+
     self.fm.Modified()
     self.fm.Update()
 
@@ -259,8 +281,7 @@ class FastMarchingEffectLogic(Effect.EffectLogic):
     self.fm.show(1)
     self.fm.Modified()
     self.fm.Update()
-
-    self.undoRedo.saveState()
+    self.fm.RemoveObserver(frontTag)
 
     self.editUtil.getLabelImage().DeepCopy(self.fm.GetOutput())
     self.editUtil.markVolumeNodeAsModified(self.sliceLogic.GetLabelLayer().GetVolumeNode())
@@ -269,6 +290,17 @@ class FastMarchingEffectLogic(Effect.EffectLogic):
 
     return npoints
 
+  def onFront(self,caller,event):
+    """Show the points reached so far by the evolution"""
+    self.editUtil.getLabelImage().DeepCopy(self.fm.GetOutput())
+    self.editUtil.markVolumeNodeAsModified(self.sliceLogic.GetLabelLayer().GetVolumeNode())
+    # let the views render and the Stop button be clicked
+    slicer.app.processEvents()
+
+  def stop(self):
+    if self.fm:
+      self.fm.SetAbortExecute(1)
+
   def updateLabel(self,value):
     if not self.fm:
       return
@@ -120,11 +120,18 @@ class GrowCutEffectLogic(Effect.EffectLogic):
   by other code without the need for a view context.
   """
 
+  # the filter is shared so that successive runs only propagate
+  # the gestures painted since the previous one
+  growCutFilter = None
+
   def __init__(self,sliceLogic):
     super(GrowCutEffectLogic,self).__init__(sliceLogic)
 
   def growCut(self):
-    growCutFilter = vtkITK.vtkITKGrowCutSegmentationImageFilter()
+    if not GrowCutEffectLogic.growCutFilter:
+      GrowCutEffectLogic.growCutFilter = vtkITK.vtkITKGrowCutSegmentationImageFilter()
+      GrowCutEffectLogic.growCutFilter.PersistentStateOn()
+    growCutFilter = GrowCutEffectLogic.growCutFilter
     background = self.getScopedBackground()
     gestureInput = self.getScopedLabelInput()
     growCutOutput = self.getScopedLabelOutput()
@@ -349,30 +349,36 @@ class HelperBox(object):
     lo = int(accum.GetMin()[0])
     hi = int(accum.GetMax()[0])
 
-    # TODO: pending resolution of bug 1822, run the thresholding
-    # in single threaded mode to avoid data corruption observed on mac release
-    # builds
-    thresholder = vtk.vtkImageThreshold()
-    thresholder.SetNumberOfThreads(1)
+    # count the voxels of each label in one pass, only the labels
+    # present in the merge volume are split
+    histogram = vtk.vtkImageAccumulate()
+    histogram.SetInput(merge.GetImageData())
+    histogram.SetComponentExtent(lo, hi, 0, 0, 0, 0)
+    histogram.SetComponentOrigin(0, 0, 0)
+    histogram.SetComponentSpacing(1, 1, 1)
+    histogram.Update()
+    counts = histogram.GetOutput().GetPointData().GetScalars()
+
+    # keep label i and clear the others, in one threaded pass per label
+    change = slicer.vtkImageLabelChange()
+    change.SetInput( merge.GetImageData() )
+    change.ReplaceUnmappedLabelsOn()
+    change.SetUnmappedLabel( 0 )
     for i in xrange(lo,hi+1):
+      if i == 0 or counts.GetTuple1(i - lo) == 0:
+        continue
       self.statusText( "Splitting label %d..."%i )
-      thresholder.SetInput( merge.GetImageData() )
-      thresholder.SetInValue( i )
-      thresholder.SetOutValue( 0 )
-      thresholder.ReplaceInOn()
-      thresholder.ReplaceOutOn()
-      thresholder.ThresholdBetween( i, i )
-      thresholder.SetOutputScalarType( merge.GetImageData().GetScalarType() )
-      thresholder.Update()
-      if thresholder.GetOutput().GetScalarRange() != (0.0, 0.0):
-        labelName = colorNode.GetColorName(i)
-        self.statusText( "Creating structure volume %s..."%labelName )
-        structureVolume = self.structureVolume( labelName )
-        if not structureVolume:
-          self.addStructure( i, "noEdit" )
-        structureVolume = self.structureVolume( labelName )
-        structureVolume.GetImageData().DeepCopy( thresholder.GetOutput() )
-        self.editUtil.markVolumeNodeAsModified(structureVolume)
+      change.RemoveAllLabelMappings()
+      change.AddLabelMapping( i, i )
+      change.Update()
+      labelName = colorNode.GetColorName(i)
+      self.statusText( "Creating structure volume %s..."%labelName )
+      structureVolume = self.structureVolume( labelName )
+      if not structureVolume:
+        self.addStructure( i, "noEdit" )
+      structureVolume = self.structureVolume( labelName )
+      structureVolume.GetImageData().DeepCopy( change.GetOutput() )
+      self.editUtil.markVolumeNodeAsModified(structureVolume)
 
     self.statusText( "Finished splitting." )
 
@@ -106,6 +106,9 @@ class LevelTracingEffectTool(LabelEffect.LabelEffectTool):
     self.polyData = vtk.vtkPolyData()
 
     self.tracingFilter = vtkITK.vtkITKLevelTracingImageFilter()
+    # the preview is traced in this many pixels around the cursor
+    self.previewWindowRadius = 128
+    self.lastPreview = None
     self.ijkToXY = vtk.vtkTransform()
 
     self.mapper = vtk.vtkPolyDataMapper2D()
@@ -155,16 +158,34 @@ class LevelTracingEffectTool(LabelEffect.LabelEffectTool):
 
   def preview(self,xy):
     """calculate the current level trace view if the
-    mouse is inside the volume extent"""
-    self.xyPoints.Reset()
+    mouse is inside the volume extent.
+    The trace is bounded to a window around the cursor,
+    and nothing is recomputed while the cursor stays
+    on the same pixel of the same slice"""
     backgroundImage = self.editUtil.getBackgroundImage()
     ijk = self.logic.backgroundXYToIJK( xy )
     dimensions = backgroundImage.GetDimensions()
     for index in xrange(3):
       if ijk[index] < 0 or ijk[index] >= dimensions[index]:
+        self.xyPoints.Reset()
+        self.lastPreview = None
         return
+    ijkPlane = self.logic.sliceIJKPlane()
+    backgroundLayer = self.logic.sliceLogic.GetBackgroundLayer()
+    xyToIJK = backgroundLayer.GetXYToIJKTransform().GetMatrix()
+    previewKey = (tuple(ijk), ijkPlane, backgroundImage.GetMTime(),
+                  tuple([xyToIJK.GetElement(i,j) for i in xrange(3) for j in xrange(4)]))
+    if previewKey == self.lastPreview:
+      return
+    self.lastPreview = previewKey
+    self.trace(ijk, self.previewWindowRadius)
+
+  def trace(self,ijk,windowRadius):
+    """trace the level curve through ijk and show it"""
+    self.xyPoints.Reset()
     self.tracingFilter.SetInput( self.editUtil.getBackgroundImage() )
     self.tracingFilter.SetSeed( ijk )
+    self.tracingFilter.SetWindowRadius( windowRadius )
 
     # select the plane corresponding to current slice orientation
     # for the input volume
@@ -190,6 +211,10 @@ class LevelTracingEffectTool(LabelEffect.LabelEffectTool):
     self.sliceView.scheduleRender()
 
   def apply(self):
+    if self.tracingFilter.GetWindowClipped():
+      # the preview was cut by its window, trace the whole curve
+      self.trace(self.tracingFilter.GetSeed(), 0)
+      self.lastPreview = None
     lines = self.polyData.GetLines()
     if lines.GetNumberOfCells() == 0: return
     self.logic.undoRedo = self.undoRedo
@@ -10,10 +10,12 @@
 
 #include "vtkObjectFactory.h"
 #include "vtkImageData.h"
+#include "vtkNew.h"
 
-#include <limits.h>
-#include <assert.h>
-#include <stddef.h>
+// vtkITK includes
+#include "vtkITKIslandLabeler.h"
+
+#include <vector>
 
 //----------------------------------------------------------------------------
 vtkCxxRevisionMacro(vtkImageConnectivity, "$Revision$");
@@ -55,131 +57,7 @@ const char* vtkImageConnectivity::GetFunctionString()
     }
 }
 
-//************************************************************************
-// The following procedures were written by Andre Robatino 
-// in November, 1999
-//
-// connect
-// recursive_copy
-//************************************************************************
-
-int connect(unsigned int, size_t *, char *, char, size_t *, size_t *);
-static void recursive_copy(int, size_t);
-
-static size_t *g_axis_len, *g_outimagep, num_stride_index_bits;
-static char *g_inimagep, g_inbackground;
-
-int connect(
-     unsigned int rank,
-     size_t *axis_len,
-     char *inimage,
-     char inbackground,
-     size_t *outimage,
-     size_t *num_components) /* set to NULL if not interested */
-{
-  unsigned int i;
-  register unsigned int axisv;
-  size_t data_len;
-  register size_t label, *outimagep, *outimage_end, *imagep, *new_imagep, boundary_mask_start, component_mask, axis_mask;
-  register ptrdiff_t *stride, stridev;
-
-  //assert(rank >= 0); // Note: Always true !
-  if (rank == 0) {
-    *outimage = (*inimage != inbackground);
-    if (num_components) *num_components = *outimage;
-    return 0;
-  }
-  label = 2*rank;
-  num_stride_index_bits = 1;
-  while (label >>= 1) num_stride_index_bits++;
-  assert(num_stride_index_bits + 2*rank + 1 <= CHAR_BIT*sizeof(size_t));
-  boundary_mask_start = 1<<num_stride_index_bits;
-  axis_mask = boundary_mask_start - 1;
-  stride = (ptrdiff_t *)malloc((2*rank + 1)*sizeof(ptrdiff_t));
-  assert(stride);
-  data_len = 1;
-  for (i=0; i<rank; i++) {
-    assert(axis_len[i] > 1);
-    stride[2*i + 1] = -(stride[2*i] = data_len);
-    data_len *= axis_len[i];
-  }
-  stride[2*rank] = 0;
-  g_axis_len = axis_len;
-  g_inimagep = inimage;
-  g_inbackground = inbackground;
-  g_outimagep = outimage;
-  component_mask = 0;
-  component_mask = ~(~component_mask>>1);
-  recursive_copy(rank-1, component_mask);
-  outimagep = outimage;
-  outimage_end = outimage + data_len;
-  label = 0;
-  do {
-    if (!(*outimagep & component_mask)) continue;
-    imagep = outimagep;
-    *imagep ^= component_mask;
-    axisv = 0;
-    label++;
-    while (1) {
-      while ( (stridev = stride[axisv]) ) {
-        if ((*imagep & boundary_mask_start<<axisv) && (*(new_imagep = imagep + stridev) & component_mask)) {
-          imagep = new_imagep;
-          *imagep ^= component_mask;
-          *imagep |= axisv;
-          axisv = 0;
-          continue;
-        }
-        axisv++;
-      }
-      if (imagep == outimagep) break;
-      axisv = *imagep & axis_mask;
-      *imagep = label;
-      imagep -= stride[axisv++];
-    }
-    *outimagep = label;
-  } while (++outimagep < outimage_end);
-  if (num_components) *num_components = label;
-  free(stride);
-  return 0;
-}
-
-static void recursive_copy(
-     int axis,
-     register size_t mask)
-{
-  register size_t len = g_axis_len[axis] - 2;
-
-  if (axis == 0) {
-    register size_t *outimagep;
-    register char *inimagep, inbackground;
-
-    inimagep = g_inimagep;
-    inbackground = g_inbackground;
-    outimagep = g_outimagep;
-    mask |= 1<<num_stride_index_bits;
-    *outimagep++ = (*inimagep++ == inbackground)? 0 : mask;
-    mask |= 2<<num_stride_index_bits;
-    while (len--) *outimagep++ = (*inimagep++ == inbackground)? 0 : mask;
-    mask ^= 1<<num_stride_index_bits;
-    *outimagep++ = (*inimagep++ == inbackground)? 0 : mask;
-    g_outimagep = outimagep;
-    g_inimagep = inimagep;
-  } else {
-    mask |= 1<<(num_stride_index_bits + 2*axis);
-    recursive_copy(axis-1, mask);
-    mask |= 2<<(num_stride_index_bits + 2*axis);
-    while (len--) recursive_copy(axis-1, mask);
-    mask ^= 1<<(num_stride_index_bits + 2*axis);
-    recursive_copy(axis-1, mask);
-  }
-  return;
-}
-
-//***********************************************************************
-// End Andre's cool routines.
-//************************************************************************
-
-
+//----------------------------------------------------------------------------
 static void vtkImageConnectivityExecute(vtkImageConnectivity *self,
                      vtkImageData *inData, short *inPtr,
                      vtkImageData *outData, short *outPtr, 
@@ -195,8 +73,8 @@ static void vtkImageConnectivityExecute(vtkImageConnectivity *self,
   short maxForegnd = (short)self->GetMaxForeground();
   short newLabel = (short)self->GetOutputLabel();
   short seedLabel = 0;
-  int largest, len=1, nxy, z, nz = 0, j;
-  int *census = NULL;
+  int largest;
+  std::vector<int> census;
   int seed[3];
   int minSize = self->GetMinSize();
   short pix;
@@ -208,35 +86,24 @@ static void vtkImageConnectivityExecute(vtkImageConnectivity *self,
   int sliceBySlice    = self->GetSliceBySlice();
 
   // connect
-  size_t conSeedLabel = 0, i, idx, dz;
-  int rank;
-  size_t *axis_len=NULL;
+  vtkIdType conSeedLabel = 0, i, idx, len, numIslands = 0;
+  int axis_len[3];
   unsigned short bg = self->GetBackground();
-  short bgMask = 0;
-  short fgMask = 1;
-  char inbackground = (char)bgMask;
-  char *conInput=NULL;
-  size_t *conOutput=NULL;
-  size_t *numIslands=NULL;
+  unsigned char bgMask = 0;
+  unsigned char fgMask = 1;
 
   // Image bounds
   outMin0 = outExt[0];   outMax0 = outExt[1];
   outMin1 = outExt[2];   outMax1 = outExt[3];
   outMin2 = outExt[4];   outMax2 = outExt[5];
 
-  // Computer Parameters for connect().
-  rank = (outExt[5]==outExt[4]) ? 2 : 3;
-  axis_len = new size_t[rank+1];
+  // Computer Parameters for the labeler.
   axis_len[0] = outExt[1]-outExt[0]+1;
   axis_len[1] = outExt[3]-outExt[2]+1;
   axis_len[2] = outExt[5]-outExt[4]+1;
-  for (j=0; j<rank; j++)
-  {
-    len *= axis_len[j];
-  }
-  conInput = new char[len];
-  conOutput = new size_t[len];
-  numIslands = new size_t[axis_len[2]];
+  len = static_cast<vtkIdType>(axis_len[0]) * axis_len[1] * axis_len[2];
+  std::vector<unsigned char> conInput(len);
+  std::vector<vtkIdType> conOutput(len);
 
   // Get increments to march through data continuously
   outData->GetContinuousIncrements(outExt, outInc0, outInc1, outInc2);
@@ -408,32 +275,16 @@ static void vtkImageConnectivityExecute(vtkImageConnectivity *self,
   // Save, Change, Measure, Remove, Identify
   // ---------------------------------------
   // Run Connectivity
+  // If SliceBySlice, the islands don't extend across slices
   // 
   ///////////////////////////////////////////////////////////////
 
+  vtkNew<vtkITKIslandLabeler> labeler;
   if (saveIsland || changeIsland || measureIsland || removeIslands || identifyIslands)
     {
-    nz = 1;
-    if (sliceBySlice && removeIslands)
-      {
-      // If SliceBySlice, then call connect() for each slice
-      nxy = axis_len[0] * axis_len[1];
-      nz = axis_len[2];
-      rank = 2;
-      int axis_len2 = axis_len[2];
-      axis_len[2] = 1;
-
-      for (z=0; z < nz; z++)
-        {
-        connect(rank, axis_len, &conInput[nxy*z], inbackground, 
-          &conOutput[nxy*z], &numIslands[z]);
-        }
-      axis_len[2] = axis_len2;
-      }
-    else
-      {
-      connect(rank, axis_len, conInput, inbackground, conOutput, &numIslands[0]);
-      }
+    labeler->SetConnectivityTo6();
+    labeler->SetSliceBySlice(sliceBySlice && removeIslands);
+    numIslands = labeler->Label(&conInput[0], axis_len, &conOutput[0]);
     }
 
 
@@ -456,7 +307,7 @@ static void vtkImageConnectivityExecute(vtkImageConnectivity *self,
   ///////////////////////////////////////////////////////////////
   // Measure, Remove
   // -----------------------------
-  // Count size of each island in conOutput
+  // Get the size of each island, counted by the labeler
   //
   //   census[c] = COUNT(conOutput[c]),  forall c on [0,numIslands]
   //
@@ -464,60 +315,10 @@ static void vtkImageConnectivityExecute(vtkImageConnectivity *self,
 
   if (removeIslands || measureIsland)
     {
-    // For each label value, count the number of pixels with that label
-    // If SliceBySlice, then work on each slice one at a time
-    len = 0;
-    for (z=0; z<nz; z++)
-      {
-      len += numIslands[z] + 1;
-      }
-    census = new int[len];
-    memset(census, 0, len*sizeof(int));
-
-    if (nz == 1)
-      {
-      i = 0;
-      for (outIdx2 = outMin2; outIdx2 <= outMax2; outIdx2++)
-        {
-        for (outIdx1 = outMin1; outIdx1 <= outMax1; outIdx1++)
-          {
-          for (outIdx0 = outMin0; outIdx0 <= outMax0; outIdx0++)
-            {
-            idx = conOutput[i];
-            // Note: Since 'idx' is defined as 'size_t' it's of type 'unsigned'
-            // It means 'idx >= 0' is always true.
-            if (/*idx >= 0 && */idx <= numIslands[0])
-              {
-              census[idx] = census[idx] + 1;
-              }
-            i++;
-            }//for0
-          }//for1
-        }//for2
-      } 
-    else 
+    census.resize(numIslands + 1);
+    for (idx = 0; idx <= numIslands; idx++)
       {
-      dz = 0;
-      i = 0;
-      for (z=0; z < nz; z++)
-        {
-        for (outIdx1 = outMin1; outIdx1 <= outMax1; outIdx1++)
-          {
-          for (outIdx0 = outMin0; outIdx0 <= outMax0; outIdx0++)
-            {
-            idx = conOutput[i];
-            // Note: Since 'idx' is defined as 'size_t' it's of type 'unsigned'
-            // It means 'idx >= 0' is always true.
-            if (/*idx >= 0 && */idx <= numIslands[z])
-              {
-              census[dz+idx] = census[dz+idx] + 1;
-              }
-            i++;
-            }//for0
-          }//for1
-
-        dz += numIslands[z]+1;
-        }//forz
+      census[idx] = static_cast<int>(labeler->GetIslandSize(idx));
       }
     }
 
@@ -534,69 +335,33 @@ static void vtkImageConnectivityExecute(vtkImageConnectivity *self,
 
   if (removeIslands)
     {
-    if (nz == 1)
+    inPtr0 = inPtr;
+    outPtr0 = outPtr;
+    i = 0;
+    for (outIdx2 = outMin2; outIdx2 <= outMax2; outIdx2++)
       {
-      inPtr0 = inPtr;
-      outPtr0 = outPtr;
-      i = 0;
-      for (outIdx2 = outMin2; outIdx2 <= outMax2; outIdx2++)
+      for (outIdx1 = outMin1; outIdx1 <= outMax1; outIdx1++)
         {
-        for (outIdx1 = outMin1; outIdx1 <= outMax1; outIdx1++)
+        for (outIdx0 = outMin0; outIdx0 <= outMax0; outIdx0++)
           {
-          for (outIdx0 = outMin0; outIdx0 <= outMax0; outIdx0++)
+          if (census[conOutput[i]] >= minSize)
             {
-            if (census[conOutput[i]] >= minSize)
-              {
-              *outPtr0 = *inPtr0;
-              }
-            else
-              {
-              *outPtr0 = bg;
-              }
-            i++;
-            outPtr0++;
-            inPtr0++;
-            }//for0
-          outPtr0 += outInc1;
-          inPtr0 += inInc1;
-          }//for1
-        outPtr0 += outInc2;
-        inPtr0 += inInc2;
-        }//for2
-      }
-    else 
-      {
-      dz = 0;
-      i = 0;
-      inPtr0 = inPtr;
-      outPtr0 = outPtr;
-      for (z=0; z < nz; z++)
-        {
-        for (outIdx1 = outMin1; outIdx1 <= outMax1; outIdx1++)
-          {
-          for (outIdx0 = outMin0; outIdx0 <= outMax0; outIdx0++)
+            *outPtr0 = *inPtr0;
+            }
+          else
             {
-            if (census[dz+conOutput[i]] >= minSize)
-              {
-              *outPtr0 = *inPtr0;
-              }
-            else
-              {
-              *outPtr0 = bg;
-              }
-            i++;
-            outPtr0++;
-            inPtr0++;
-            }//for0
-          outPtr0 += outInc1;
-          inPtr0 += inInc1;
-          }//for1
-        outPtr0 += outInc2;
-        inPtr0 += inInc2;
-
-        dz += numIslands[z] + 1;
-        }//z
-      }//else
+            *outPtr0 = bg;
+            }
+          i++;
+          outPtr0++;
+          inPtr0++;
+          }//for0
+        outPtr0 += outInc1;
+        inPtr0 += inInc1;
+        }//for1
+      outPtr0 += outInc2;
+      inPtr0 += inInc2;
+      }//for2
     }
 
 
@@ -615,7 +380,7 @@ static void vtkImageConnectivityExecute(vtkImageConnectivity *self,
     {
     // Find largest island
     largest = 0;
-    for (i=0; i<=numIslands[0]; i++)
+    for (i=0; i<=numIslands; i++)
       {
       if (i != bg)
         {
@@ -720,12 +485,6 @@ static void vtkImageConnectivityExecute(vtkImageConnectivity *self,
       }
     }
 
-  if (removeIslands || measureIsland)
-    {
-    delete [] census;
-    }
-
-
   ///////////////////////////////////////////////////////////////
   // Save
   // -----------------------------
@@ -809,14 +568,6 @@ static void vtkImageConnectivityExecute(vtkImageConnectivity *self,
       }//for2
     }
 
-  ///////////////////////////////////////////////////////////////
-  // Cleanup
-  ///////////////////////////////////////////////////////////////
-
-  delete [] axis_len;
-  delete [] numIslands;
-  delete [] conInput;
-  delete [] conOutput;
 }
 
 
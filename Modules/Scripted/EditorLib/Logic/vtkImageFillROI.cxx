@@ -10,9 +10,20 @@
 
 #include "vtkObjectFactory.h"
 #include "vtkImageData.h"
+#include "vtkMultiThreader.h"
+#include "vtkPointData.h"
 #include "vtkPoints.h"
 
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 vtkCxxSetObjectMacro(vtkImageFillROI,Points,vtkPoints);
+vtkCxxSetObjectMacro(vtkImageFillROI,ThresholdImage,vtkImageData);
+
+// Contour of each slice to draw
+typedef std::vector<std::pair<int, vtkSmartPointer<vtkPoints> > > vtkImageFillROIContours;
 
 //------------------------------------------------------------------------------
 vtkCxxRevisionMacro(vtkImageFillROI, "$Revision$");
@@ -25,6 +36,10 @@ vtkImageFillROI::vtkImageFillROI()
   this->Value = 255;
   this->Shape = SHAPE_POLYGON;
   this->Radius = 0;
+  this->ThresholdImage = NULL;
+  this->ThresholdRange[0] = 0.;
+  this->ThresholdRange[1] = 0.;
+  this->InterpolateSliceContours = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -35,6 +50,34 @@ vtkImageFillROI::~vtkImageFillROI()
     {
     this->Points->UnRegister(this);
     }
+  if (this->ThresholdImage != NULL)
+    {
+    this->ThresholdImage->UnRegister(this);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkImageFillROI::AddSliceContour(int slice, vtkPoints* points)
+{
+  this->SliceContours[slice] = points;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkImageFillROI::RemoveAllSliceContours()
+{
+  if (this->SliceContours.empty())
+    {
+    return;
+    }
+  this->SliceContours.clear();
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+int vtkImageFillROI::GetNumberOfSliceContours()
+{
+  return static_cast<int>(this->SliceContours.size());
 }
 
 //----------------------------------------------------------------------------
@@ -56,267 +99,291 @@ void vtkImageFillROI::PrintSelf(ostream& os, vtkIndent indent)
     {
     os << "(none)\n";
     }
+
+  os << indent << "ThresholdImage: " << this->ThresholdImage << "\n";
+  os << indent << "ThresholdRange: " << this->ThresholdRange[0]
+     << " " << this->ThresholdRange[1] << "\n";
+  os << indent << "SliceContours: " << this->SliceContours.size() << "\n";
+  os << indent << "InterpolateSliceContours: "
+     << this->InterpolateSliceContours << "\n";
 }
 
 //----------------------------------------------------------------------------
+namespace
+{
+
 // small helper class to store edges for the edge table
 class Edge
 {
 public:
-  Edge() {this->next = NULL;};
-  int yUpper;
+  int yLower, yUpper;
   int dx, dy, dy2, dx2, dydx2, r, xInc, x;
-  Edge *next;
 };
 
-// Inserts edge into list in order of increasing x field
-void InsertEdge(Edge *list, Edge *edge)
+// Edges are sorted by lower y in the edge table
+bool EdgeIsBelow(const Edge& edge1, const Edge& edge2)
 {
-  Edge *p, *q = list;
-
-  p = q->next;
-  while (p != NULL) 
-    {
-    if (edge->x < p->x)
-      {
-      p = NULL;
-      }
-    else 
-      {
-      q = p;
-      p = p->next;
-      }
-    }
-  edge->next = q->next;
-  q->next = edge;
+  return edge1.yLower < edge2.yLower ||
+    (edge1.yLower == edge2.yLower && edge1.x < edge2.x);
 }
 
 // Store lower-y coordinate and inverse slope for each slope.
-// Adjust and store upper-y coordinate for edges that are the
-// lower member of a monotonically increasing or decreasing
-// pair of edges.
-void MakeEdgeRec(int x1, int y1, int x2, int y2, Edge *edge, Edge *edges[])
+void MakeEdgeRec(int x1, int y1, int x2, int y2, Edge& edge)
 {
   // p1 is lower than p2
-  edge->dx = abs(x2 - x1);
-  edge->dy = abs(y2 - y1);
-  edge->dx2 = edge->dx << 1;
-  edge->dy2 = edge->dy << 1;
+  edge.dx = abs(x2 - x1);
+  edge.dy = abs(y2 - y1);
+  edge.dx2 = edge.dx << 1;
+  edge.dy2 = edge.dy << 1;
   if (x1 < x2)
     {
-    edge->xInc = 1;
+    edge.xInc = 1;
     }
   else
     {
-    edge->xInc = -1;
+    edge.xInc = -1;
     }
-  edge->x = x1;
+  edge.x = x1;
 
   // < 45 degree slope
-  if (edge->dy <= edge->dx)
+  if (edge.dy <= edge.dx)
     {
-    edge->dydx2 = (edge->dy - edge->dx) << 1;
-    edge->r = edge->dy2 - edge->dx;
+    edge.dydx2 = (edge.dy - edge.dx) << 1;
+    edge.r = edge.dy2 - edge.dx;
     }
   // > 45 degree slope
   else
     {
-    edge->dydx2 = (edge->dx - edge->dy) << 1;
-    edge->r = edge->dx2 - edge->dy;
+    edge.dydx2 = (edge.dx - edge.dy) << 1;
+    edge.r = edge.dx2 - edge.dy;
     }
 
-  edge->yUpper = y2;
-
-  InsertEdge(edges[y1], edge);
+  edge.yLower = y1;
+  edge.yUpper = y2;
 }
 
-void BuildEdgeList(int nPts, int *xPts, int *yPts, Edge *edges[])
+// The edge table holds the non-horizontal edges of the polygon sorted
+// by lower y, its size only depends on the number of points.
+void BuildEdgeTable(int nPts, const int *xPts, const int *yPts,
+                    std::vector<Edge>& edges)
 {
-  Edge *edge;
   int i, x1, x2, y1, y2;
 
+  edges.clear();
+  edges.reserve(nPts);
+
   x1 = xPts[nPts-1];
   y1 = yPts[nPts-1];
 
-  for (i=0; i<nPts; i++) 
+  for (i=0; i<nPts; i++)
     {
     x2 = xPts[i];
     y2 = yPts[i];
 
-    if (y1 != y2) 
+    if (y1 != y2)
       {
       // non-horizontal line
-      edge = new Edge;
+      Edge edge;
       if (y1 < y2)
         {
         // up-going edge
-        MakeEdgeRec(x1, y1, x2, y2, edge, edges);
+        MakeEdgeRec(x1, y1, x2, y2, edge);
         }
       else
         {
         // down-going edge
-        MakeEdgeRec(x2, y2, x1, y1, edge, edges);
+        MakeEdgeRec(x2, y2, x1, y1, edge);
         }
+      edges.push_back(edge);
       }
     x1 = x2;
     y1 = y2;
     }
+
+  std::sort(edges.begin(), edges.end(), EdgeIsBelow);
 }
 
+// Move the 'x' field of the edge to the next scanline
+inline void UpdateEdge(Edge& edge)
+{
+  // < 45 degree slope
+  if (edge.dy <= edge.dx)
+    {
+    int done = 0;
+    while (done == 0)
+      {
+      edge.x += edge.xInc;
+      if (edge.r <= 0)
+        {
+        edge.r += edge.dy2;
+        }
+      else
+        {
+        done = 1;
+        edge.r += edge.dydx2;
+        }
+      }
+    }
+  // > 45
+  else
+    {
+    if (edge.r <= 0)
+      {
+      edge.r += edge.dx2;
+      }
+    else
+      {
+      edge.x += edge.xInc;
+      edge.r += edge.dydx2;
+      }
+    }
+}
+
+// Pixels of a slice whose threshold image value is within the range
+class ThresholdMask
+{
+public:
+  vtkDataArray *Scalars;
+  vtkIdType SliceOffset;
+  double Min, Max;
+
+  bool Accept(vtkIdType pixel) const
+    {
+    double v = this->Scalars->GetComponent(this->SliceOffset + pixel, 0);
+    return v >= this->Min && v <= this->Max;
+    }
+};
+
+// A polygon to fill in a slice of the output, in pixels relative to the
+// output extent.
+class PolygonSlice
+{
+public:
+  vtkIdType SliceOffset;
+  std::vector<int> xPts, yPts;
+  std::vector<Edge> Edges;
+};
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+// Fill the rows [rowBegin, rowEnd) of the polygon. The active edge list is
+// updated from the lowest edge whatever the rows, so that a block of rows
+// is filled exactly as when all the rows are filled at once.
 template <class T>
-static void vtkImageFillROIDrawPolygon(int nx, int ny, int nPts, int *xPts, int *yPts, 
-    T value, T *outPtr)
+static void vtkImageFillROIDrawPolygon(int nx, int rowBegin, int rowEnd,
+    const std::vector<Edge>& edges, T value, T *outPtr,
+    const ThresholdMask *mask)
 {
-  int    i, scan, done;
-  Edge *active, *p, *q, *del;
+  std::vector<Edge> active;
+  size_t nextEdge = 0;
+  size_t i, j, kept;
   int x, x1, x2;
   T *ptr;
 
-  // Build a list of edges for each pixel in y direction.
-  // The max possible number of edges is then the 
-  // height of the image, so allocate this many edge pointers.
-  Edge **edges = new Edge*[ny];
-
-  for (i=0; i<ny; i++)
+  if (edges.empty())
     {
-    edges[i] = new Edge;
+    return;
     }
+  active.reserve(edges.size());
 
-  BuildEdgeList(nPts, xPts, yPts, edges);
-  active = new Edge;
-
-  for (scan=0; scan < ny; scan++) 
+  for (int scan = edges[0].yLower;
+       scan < rowEnd && (nextEdge < edges.size() || !active.empty());
+       scan++)
     {
-    // BuildActiveList(int scan, Edge *active, Edge *edges[])
-    p = edges[scan]->next;
-    while (p) 
+    // Add the edges starting at this scanline
+    while (nextEdge < edges.size() && edges[nextEdge].yLower == scan)
       {
-      q = p->next;
-      InsertEdge(active, p);
-      p = q;
+      active.push_back(edges[nextEdge++]);
       }
 
-    if (active->next) 
+    // Delete the edges ending at this scanline
+    kept = 0;
+    for (i = 0; i < active.size(); ++i)
       {
-
-      // DeleteFromActiveList(int scan, Edge *active) 
-      q = active;
-      p = active->next;
-      while (p) 
+      if (scan < active[i].yUpper)
         {
-        if (scan >= p->yUpper) 
-          {
-          p = p->next;
-
-          // Delete After q
-          del = q->next;
-          q->next = del->next;
-          delete del;
-          } 
-        else 
-          {
-          q = p;
-          p = p->next;
-          }
+        active[kept++] = active[i];
         }
+      }
+    active.resize(kept);
 
-      // FillScan(int nx, int scan, Edge *active, T value, T *outPtr)
-      p = active->next;
-      ptr = &outPtr[scan*nx];
-      while (p) 
+    // Sort by x, the list is almost sorted from one scanline to the next
+    // so an insertion sort is the fastest.
+    for (i = 1; i < active.size(); ++i)
+      {
+      Edge edge = active[i];
+      for (j = i; j > 0 && edge.x < active[j-1].x; --j)
         {
-        q = p->next;
-        if (!q) 
-          {
-          fprintf(stderr, "ODD FILL: y=%d\n", scan);
-          break;
-          }
-        x1 = p->x;
-        x2 = q->x;
-
-        // Fill from left edge up to AND INCLUDING (x <= x2) right edge
-        // (this differs from conventional polygon fill)
-        for (x = x1; x < x2; x++)
-          {
-          ptr[x] = value;
-          }
-        p = q->next;
+        active[j] = active[j-1];
         }
+      active[j] = edge;
+      }
 
-      // UpdateActiveList(int scan, Edge *active)
-      // Update 'x' field 
-      q = active;
-      p = active->next;
-      while (p) 
+    if (scan >= rowBegin)
+      {
+      // Fill between the pairs of edges (even-odd rule). Each pair is
+      // filled from the left edge up to (not including) the right edge,
+      // the edges are drawn afterward by DrawLinesFast.
+      ptr = &outPtr[scan*nx];
+      for (i = 0; i + 1 < active.size(); i += 2)
         {
-        // < 45 degree slope
-        if (p->dy <= p->dx) 
+        x1 = active[i].x < 0 ? 0 : active[i].x;
+        x2 = active[i+1].x > nx ? nx : active[i+1].x;
+        if (mask)
           {
-          done = 0;
-          while (done == 0)
+          for (x = x1; x < x2; x++)
             {
-            p->x += p->xInc;
-            if (p->r <= 0)
-              {
-              p->r += p->dy2;
-              }
-            else 
+            if (mask->Accept(scan*nx + x))
               {
-              done = 1;
-              p->r += p->dydx2;
+              ptr[x] = value;
               }
             }
           }
-        // > 45
-        else 
+        else
           {
-          if (p->r <= 0)
+          for (x = x1; x < x2; x++)
             {
-            p->r += p->dx2;
-            }
-          else 
-            {
-            p->x += p->xInc;
-            p->r += p->dydx2;
+            ptr[x] = value;
             }
           }
-        q = p;
-        p = p->next;
         }
+      }
 
-      // ResortActiveList(Edge *active)
-      p = active->next;
-      active->next = NULL;
-      while (p) 
-        {
-        q = p->next;
-        InsertEdge(active, p);
-        p = q;
-        }
-      }//if(active->next)
-    }//for
+    for (i = 0; i < active.size(); ++i)
+      {
+      UpdateEdge(active[i]);
+      }
+    }
+}
 
-  // Free edge records that have been allocated
-  for (i=0; i<ny; i++)
+//----------------------------------------------------------------------------
+// Only the pixels in the rows [rowBegin, rowEnd) and accepted by the mask
+// (if any) are drawn by DrawLinesFast.
+template <class T>
+static inline void DrawPixelFast(int nx, int rowBegin, int rowEnd, int x, int y,
+                                 T value, T *outPtr, const ThresholdMask *mask)
+{
+  if (y < rowBegin || y >= rowEnd)
     {
-    delete edges[i];
+    return;
+    }
+  if (!mask || mask->Accept(y*nx+x))
+    {
+    outPtr[y*nx+x] = value;
     }
-  delete active;
-
-  // Free array of edge pointers.
-  delete [] edges;
 }
 
 // This corresponds to "DrawLine" in vtkImageDrawROI.cxx. Both are
 // used to draw the "Polygons" shape (before and after the shape is Applied).
 template <class T>
-static void DrawLinesFast(int nx, int ny, int nPts, int *xPts, int *yPts,
-                          T value, T *outPtr)
+static void DrawLinesFast(int nx, int rowBegin, int rowEnd,
+                          int nPts, const int *xPts, const int *yPts,
+                          T value, T *outPtr, const ThresholdMask *mask)
 {
   int i, x, y, x1, y1, x2, y2, xx1, xx2, yy1, yy2;
   int n = nPts;
   int dx, dy, dy2, dx2, r, dydx2, xInc;
-  (void)ny; // unused ??
 
   for (i=0; i < n-1; i++)
     {
@@ -341,6 +408,12 @@ static void DrawLinesFast(int nx, int ny, int nPts, int *xPts, int *yPts,
       y2 = yy1;
       }
 
+    // Skip the lines out of the rows
+    if (y2 < rowBegin || y1 >= rowEnd)
+      {
+      continue;
+      }
+
     dx = abs(x2 - x1);
     dy = abs(y2 - y1);
     dx2 = dx << 1;
@@ -357,7 +430,7 @@ static void DrawLinesFast(int nx, int ny, int nPts, int *xPts, int *yPts,
     y = y1;
 
     // Draw first point with radius r
-    outPtr[y*nx+x] = value;
+    DrawPixelFast(nx, rowBegin, rowEnd, x, y, value, outPtr, mask);
 
     // < 45 degree slope
     if (dy <= dx)
@@ -382,7 +455,7 @@ static void DrawLinesFast(int nx, int ny, int nPts, int *xPts, int *yPts,
             r += dydx2;
             }
           // Draw point with radius r
-          outPtr[y*nx+x] = value;
+          DrawPixelFast(nx, rowBegin, rowEnd, x, y, value, outPtr, mask);
           }
         }
       else
@@ -401,7 +474,7 @@ static void DrawLinesFast(int nx, int ny, int nPts, int *xPts, int *yPts,
             r += dydx2;
             }
           // Draw point with radius r
-          outPtr[y*nx+x] = value;
+          DrawPixelFast(nx, rowBegin, rowEnd, x, y, value, outPtr, mask);
           }
         }
       }
@@ -428,7 +501,7 @@ static void DrawLinesFast(int nx, int ny, int nPts, int *xPts, int *yPts,
           r += dydx2;
           }
         // Draw point with radius r
-        outPtr[y*nx+x] = value;
+        DrawPixelFast(nx, rowBegin, rowEnd, x, y, value, outPtr, mask);
         }
       }
     }//for
@@ -658,88 +731,267 @@ static void DrawPoints(int nx, int ny, int z, int radius,
     }
 }
 
+//----------------------------------------------------------------------------
+template <class T>
+struct vtkImageFillROIThreadStruct
+{
+  const std::vector<PolygonSlice> *Slices;
+  int nx, ny;
+  T Value;
+  T *OutPtr;
+  vtkDataArray *ThresholdScalars;
+  double ThresholdRange[2];
+};
+
+//----------------------------------------------------------------------------
+// Each thread fills its own block of rows in all the polygon slices
+template <class T>
+static VTK_THREAD_RETURN_TYPE vtkImageFillROIThreadedExecute(void *arg)
+{
+  vtkMultiThreader::ThreadInfo *info =
+    static_cast<vtkMultiThreader::ThreadInfo *>(arg);
+  vtkImageFillROIThreadStruct<T> *str =
+    static_cast<vtkImageFillROIThreadStruct<T> *>(info->UserData);
+
+  int rowBegin = str->ny * info->ThreadID / info->NumberOfThreads;
+  int rowEnd = str->ny * (info->ThreadID + 1) / info->NumberOfThreads;
+  if (rowBegin >= rowEnd)
+    {
+    return VTK_THREAD_RETURN_VALUE;
+    }
+
+  const std::vector<PolygonSlice>& slices = *str->Slices;
+  for (size_t i = 0; i < slices.size(); ++i)
+    {
+    const PolygonSlice& slice = slices[i];
+    ThresholdMask mask;
+    const ThresholdMask *maskPtr = NULL;
+    if (str->ThresholdScalars)
+      {
+      mask.Scalars = str->ThresholdScalars;
+      mask.SliceOffset = slice.SliceOffset;
+      mask.Min = str->ThresholdRange[0];
+      mask.Max = str->ThresholdRange[1];
+      maskPtr = &mask;
+      }
+    T *slicePtr = str->OutPtr + slice.SliceOffset;
+    vtkImageFillROIDrawPolygon(str->nx, rowBegin, rowEnd, slice.Edges,
+      str->Value, slicePtr, maskPtr);
+    // Draw lines too because polygons don't include top, right edges
+    DrawLinesFast(str->nx, rowBegin, rowEnd,
+      static_cast<int>(slice.xPts.size()), &slice.xPts[0], &slice.yPts[0],
+      str->Value, slicePtr, maskPtr);
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
 template <class T>
 static void vtkImageFillROIExecute(vtkImageFillROI* self,
-                                   vtkImageData *outData, T* outPtr)
+                                   vtkImageData *outData,
+                                   const vtkImageFillROIContours& contours,
+                                   vtkDataArray *thresholdScalars, T* outPtr)
 {
   T value = (T)(self->GetValue());
   int r = self->GetRadius();
-  int i, j, x, y, z, nPts, nx, ny, outExt[6];
-  int *xPts, *yPts;
+  int i, x, y, z, nx, ny, nz, outExt[6];
   vtkFloatingPointType *pt;
 
-  vtkPoints *points = self->GetPoints();
-  if (points == NULL)
-    return;
-
   outData->GetExtent(outExt);
   nx = outExt[1]-outExt[0]+1;
   ny = outExt[3]-outExt[2]+1;
-  z = outExt[4];
-
-  // Convert to int
-  nPts = points->GetNumberOfPoints();
-  if (nPts == 0) return;
-  xPts = new int[nPts];
-  yPts = new int[nPts];
-  for (i=0,j=0; i<nPts; i++)
-    {
-    pt = points->GetPoint(i);
-    x = (int)(pt[0]);
-    y = (int)(pt[1]);
-    if (x >= outExt[0] && x <= outExt[1] &&
-      y >= outExt[2] && y <= outExt[3])
-      {
-      xPts[j] = x;
-      yPts[j] = y;
-      j++;
-      }
-    }
-  nPts = j;
+  nz = outExt[5]-outExt[4]+1;
 
   outPtr = (T*)outData->GetScalarPointerForExtent(outExt);
 
   // zero out the background (added when filter switched from
   // in place to being image to image).
-  for (int xx = 0; xx < nx; xx++)
+  std::fill(outPtr, outPtr + static_cast<vtkIdType>(nx)*ny*nz, T(0));
+
+  std::vector<PolygonSlice> polygons;
+  std::vector<int> xPts, yPts;
+  for (vtkImageFillROIContours::const_iterator it = contours.begin();
+       it != contours.end(); ++it)
     {
-    for (int yy = 0; yy < ny; yy++)
+    z = it->first;
+    vtkPoints *points = it->second;
+
+    // Convert to int
+    int nPts = points->GetNumberOfPoints();
+    xPts.clear();
+    yPts.clear();
+    for (i=0; i<nPts; i++)
       {
-      outPtr[xx + nx*yy] = 0;
+      pt = points->GetPoint(i);
+      x = (int)(pt[0]);
+      y = (int)(pt[1]);
+      if (x >= outExt[0] && x <= outExt[1] &&
+        y >= outExt[2] && y <= outExt[3])
+        {
+        xPts.push_back(x);
+        yPts.push_back(y);
+        }
+      }
+    nPts = static_cast<int>(xPts.size());
+
+    switch (self->GetShape())
+      {
+      case SHAPE_POLYGON:
+      if (nPts >= 3)
+        {
+        // The polygons are filled by the threads, in pixels relative
+        // to the output extent
+        polygons.push_back(PolygonSlice());
+        PolygonSlice& polygon = polygons.back();
+        polygon.SliceOffset = static_cast<vtkIdType>(z - outExt[4])*nx*ny;
+        for (i=0; i<nPts; i++)
+          {
+          polygon.xPts.push_back(xPts[i] - outExt[0]);
+          polygon.yPts.push_back(yPts[i] - outExt[2]);
+          }
+        BuildEdgeTable(nPts, &polygon.xPts[0], &polygon.yPts[0], polygon.Edges);
+        }
+      break;
+
+      case SHAPE_LINES:
+      if (nPts >= 2)
+        {
+        DrawLines(nx, ny, z, r, nPts, &xPts[0], &yPts[0], value, outData);
+        }
+      break;
+
+      case SHAPE_POINTS:
+      if (nPts >= 1)
+        {
+        DrawPoints(nx, ny, z, r, nPts, &xPts[0], &yPts[0], value, outData);
+        }
+      break;
       }
     }
 
-  switch (self->GetShape())
+  if (polygons.empty())
+    {
+    return;
+    }
+
+  vtkImageFillROIThreadStruct<T> str;
+  str.Slices = &polygons;
+  str.nx = nx;
+  str.ny = ny;
+  str.Value = value;
+  str.OutPtr = outPtr;
+  str.ThresholdScalars = thresholdScalars;
+  self->GetThresholdRange(str.ThresholdRange);
+
+  int numberOfThreads = self->GetNumberOfThreads();
+  if (numberOfThreads > ny)
     {
-    case SHAPE_POLYGON:
-    if (nPts >= 3)
+    numberOfThreads = ny;
+    }
+  vtkSmartPointer<vtkMultiThreader> threader =
+    vtkSmartPointer<vtkMultiThreader>::New();
+  threader->SetNumberOfThreads(numberOfThreads > 0 ? numberOfThreads : 1);
+  threader->SetSingleMethod(vtkImageFillROIThreadedExecute<T>, &str);
+  threader->SingleMethodExecute();
+}
+
+//----------------------------------------------------------------------------
+namespace
+{
+
+// Resample a closed contour to n points evenly spaced along its perimeter
+void ResampleContour(vtkPoints *points, int n, std::vector<double>& xy)
+{
+  int nPts = points->GetNumberOfPoints();
+  std::vector<double> length(nPts + 1, 0.);
+  double p1[3], p2[3];
+  int i;
+
+  for (i = 0; i < nPts; ++i)
+    {
+    points->GetPoint(i, p1);
+    points->GetPoint((i + 1) % nPts, p2);
+    length[i+1] = length[i] +
+      sqrt((p2[0]-p1[0])*(p2[0]-p1[0]) + (p2[1]-p1[1])*(p2[1]-p1[1]));
+    }
+
+  xy.resize(2*n);
+  int segment = 0;
+  for (i = 0; i < n; ++i)
+    {
+    double s = length[nPts] * i / n;
+    while (segment < nPts - 1 && length[segment+1] <= s)
       {
-      vtkImageFillROIDrawPolygon(nx, ny, nPts, xPts, yPts,
-        (T)value, (T*)outPtr);
-      // Draw lines too because polygons don't include top, right edges
-      DrawLinesFast(nx, ny, nPts, xPts, yPts, value, (T*)outPtr);
+      ++segment;
       }
-    break;
+    points->GetPoint(segment, p1);
+    points->GetPoint((segment + 1) % nPts, p2);
+    double segmentLength = length[segment+1] - length[segment];
+    double t = segmentLength > 0. ? (s - length[segment]) / segmentLength : 0.;
+    xy[2*i] = p1[0] + t * (p2[0] - p1[0]);
+    xy[2*i+1] = p1[1] + t * (p2[1] - p1[1]);
+    }
+}
 
-    case SHAPE_LINES:
-    if (nPts >= 2)
+double SignedArea(const std::vector<double>& xy)
+{
+  size_t n = xy.size() / 2;
+  double area = 0.;
+  for (size_t i = 0; i < n; ++i)
+    {
+    size_t j = (i + 1) % n;
+    area += xy[2*i] * xy[2*j+1] - xy[2*j] * xy[2*i+1];
+    }
+  return area / 2.;
+}
+
+// Linear interpolation between two contours (t = 0 gives contour1). Both
+// contours are resampled to the same number of points, the points of
+// contour2 are matched to those of contour1 with the same orientation
+// starting from the nearest point.
+void InterpolateContour(vtkPoints *contour1, vtkPoints *contour2, double t,
+                        vtkPoints *contour)
+{
+  int n = std::max(contour1->GetNumberOfPoints(), contour2->GetNumberOfPoints());
+  std::vector<double> xy1, xy2;
+  ResampleContour(contour1, n, xy1);
+  ResampleContour(contour2, n, xy2);
+
+  int i;
+  if ((SignedArea(xy1) < 0.) != (SignedArea(xy2) < 0.))
+    {
+    for (i = 0; i < n / 2; ++i)
       {
-      DrawLines(nx, ny, z, r, nPts, xPts, yPts, value, outData);
+      std::swap(xy2[2*i], xy2[2*(n-1-i)]);
+      std::swap(xy2[2*i+1], xy2[2*(n-1-i)+1]);
       }
-    break;
+    }
 
-    case SHAPE_POINTS:
-    if (nPts >= 1)
+  int offset = 0;
+  double minDistance = VTK_DOUBLE_MAX;
+  for (i = 0; i < n; ++i)
+    {
+    double dx = xy2[2*i] - xy1[0];
+    double dy = xy2[2*i+1] - xy1[1];
+    if (dx*dx + dy*dy < minDistance)
       {
-      DrawPoints(nx, ny, z, r, nPts, xPts, yPts, value, outData);
+      minDistance = dx*dx + dy*dy;
+      offset = i;
       }
-    break;
     }
 
-  delete [] xPts;
-  delete [] yPts;
+  contour->SetNumberOfPoints(n);
+  for (i = 0; i < n; ++i)
+    {
+    int j = (i + offset) % n;
+    contour->SetPoint(i,
+      (1. - t) * xy1[2*i] + t * xy2[2*j],
+      (1. - t) * xy1[2*i+1] + t * xy2[2*j+1], 0.);
+    }
 }
 
+} // end of anonymous namespace
+
 //----------------------------------------------------------------------------
 void vtkImageFillROI::ExecuteData(vtkDataObject *out)
 {
@@ -759,9 +1011,10 @@ void vtkImageFillROI::ExecuteData(vtkDataObject *out)
     }
 
   vtkImageData *inData = (vtkImageData *) this->GetInput();
+  vtkImageData *outData = this->GetOutput();
 
   void *ptr = NULL;
-  int x1, *inExt;
+  int x1, *inExt, outExt[6];
 
   // ensure 1 component data
   x1 = inData->GetNumberOfScalarComponents();
@@ -771,17 +1024,66 @@ void vtkImageFillROI::ExecuteData(vtkDataObject *out)
     return;
     }
 
-  // Ensure intput is 2D
-  inExt = inData->GetWholeExtent();
-  if (inExt[5] != inExt[4])
+  outData->GetExtent(outExt);
+
+  vtkImageFillROIContours contours;
+  if (this->SliceContours.empty())
     {
-    vtkErrorMacro("Input must be 2D.");
-    return;
+    // Ensure intput is 2D
+    inExt = inData->GetWholeExtent();
+    if (inExt[5] != inExt[4])
+      {
+      vtkErrorMacro("Input must be 2D.");
+      return;
+      }
+    if (this->Points != NULL)
+      {
+      contours.push_back(std::make_pair(outExt[4], this->Points));
+      }
+    }
+  else
+    {
+    std::map<int, vtkSmartPointer<vtkPoints> >::const_iterator it, previous;
+    for (it = this->SliceContours.begin(); it != this->SliceContours.end(); ++it)
+      {
+      if (this->InterpolateSliceContours && it != this->SliceContours.begin() &&
+          previous->second->GetNumberOfPoints() > 0 &&
+          it->second->GetNumberOfPoints() > 0)
+        {
+        for (int z = std::max(previous->first + 1, outExt[4]);
+             z < it->first && z <= outExt[5]; ++z)
+          {
+          vtkPoints *contour = vtkPoints::New();
+          InterpolateContour(previous->second, it->second,
+            static_cast<double>(z - previous->first) / (it->first - previous->first),
+            contour);
+          contours.push_back(std::make_pair(z, contour));
+          contour->Delete();
+          }
+        }
+      if (it->first >= outExt[4] && it->first <= outExt[5])
+        {
+        contours.push_back(std::make_pair(it->first, it->second.GetPointer()));
+        }
+      previous = it;
+      }
+    }
+
+  vtkDataArray *thresholdScalars = NULL;
+  if (this->ThresholdImage != NULL)
+    {
+    thresholdScalars = this->ThresholdImage->GetPointData()->GetScalars();
+    if (thresholdScalars == NULL ||
+        thresholdScalars->GetNumberOfTuples() != outData->GetNumberOfPoints())
+      {
+      vtkErrorMacro("ThresholdImage must have the extent of the output.");
+      return;
+      }
     }
 
-  switch (this->GetOutput()->GetScalarType())
+  switch (outData->GetScalarType())
     {
-    vtkTemplateMacro( vtkImageFillROIExecute ( this, this->GetOutput(), static_cast<VTK_TT*>(ptr) ) );
+    vtkTemplateMacro( vtkImageFillROIExecute ( this, outData, contours, thresholdScalars, static_cast<VTK_TT*>(ptr) ) );
     default: 
       {
       vtkErrorMacro(<< "Execute: Unknown ScalarType\n");
@@ -17,6 +17,13 @@
 /// drawing (for temporary interactive display).  So it is
 /// important that the output from this filter (vtkImageFIllROI)
 /// correspond to that of the vtkImageDrawROI filter!
+///
+/// Polygons are filled with an edge table scanline fill (even-odd rule,
+/// so self-intersecting polygons are supported), the rows of the image
+/// being shared out between the threads.  The fill can be restricted to
+/// the pixels of a threshold image that are within a range, and the
+/// contours of several slices of a 3D image can be filled at once,
+/// optionally interpolating the contours of the slices in between.
 //
 
 #ifndef __vtkImageFillROI_h
@@ -26,11 +33,16 @@
 
 // VTK includes
 #include <vtkImageToImageFilter.h>
+#include <vtkSmartPointer.h>
+
+// STD includes
+#include <map>
 
 #define SHAPE_POLYGON 1
 #define SHAPE_LINES   2
 #define SHAPE_POINTS  3
 
+class vtkImageData;
 class vtkPoints;
 class VTK_SLICER_EDITORLIB_MODULE_LOGIC_EXPORT vtkImageFillROI : public vtkImageToImageFilter
 {
@@ -78,6 +90,27 @@ public:
   virtual void SetPoints(vtkPoints*);
   vtkGetObjectMacro(Points, vtkPoints);
 
+  /// If set, only the pixels whose threshold image value is within
+  /// ThresholdRange are filled. The threshold image must have the
+  /// extent of the output. Only used by the polygon shape.
+  virtual void SetThresholdImage(vtkImageData*);
+  vtkGetObjectMacro(ThresholdImage, vtkImageData);
+  vtkSetVector2Macro(ThresholdRange, double);
+  vtkGetVector2Macro(ThresholdRange, double);
+
+  /// Contours of the slices of a 3D input, in IJK coordinates. When
+  /// there is at least one slice contour, Points is ignored and each
+  /// contour is drawn in its slice.
+  void AddSliceContour(int slice, vtkPoints* points);
+  void RemoveAllSliceContours();
+  int GetNumberOfSliceContours();
+
+  /// If on, the slices between two slice contours are filled with a
+  /// contour interpolated between them. Off by default.
+  vtkSetMacro(InterpolateSliceContours, int);
+  vtkGetMacro(InterpolateSliceContours, int);
+  vtkBooleanMacro(InterpolateSliceContours, int);
+
 protected:
   vtkImageFillROI();
   ~vtkImageFillROI();
@@ -87,7 +120,13 @@ protected:
   int Radius;
   int Shape;
 
-  /// not threaded because too simple a filter
+  vtkImageData *ThresholdImage;
+  double ThresholdRange[2];
+
+  std::map<int, vtkSmartPointer<vtkPoints> > SliceContours;
+  int InterpolateSliceContours;
+
+  /// The polygons are filled in NumberOfThreads threads
   void ExecuteData(vtkDataObject *);
 
 private:
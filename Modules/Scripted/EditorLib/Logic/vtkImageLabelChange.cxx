@@ -9,6 +9,10 @@
 #include "vtkImageLabelChange.h"
 #include "vtkObjectFactory.h"
 #include "vtkImageData.h"
+#include "vtkTypeTraits.h"
+
+// STD includes
+#include <algorithm>
 
 //------------------------------------------------------------------------------
 vtkCxxRevisionMacro(vtkImageLabelChange, "$Revision$");
@@ -22,6 +26,90 @@ vtkImageLabelChange::vtkImageLabelChange()
 {
     this->InputLabel = 0;
     this->OutputLabel = 0;
+    this->ReplaceUnmappedLabels = 0;
+    this->UnmappedLabel = 0;
+    this->UseROIExtent = 0;
+    for (int i = 0; i < 6; i++) {
+        this->ROIExtent[i] = 0;
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkImageLabelChange::AddLabelMapping(double inputLabel, double outputLabel)
+{
+    std::map<double, double>::iterator it = this->LabelMappings.find(inputLabel);
+    if (it != this->LabelMappings.end() && it->second == outputLabel) {
+        return;
+    }
+    this->LabelMappings[inputLabel] = outputLabel;
+    this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkImageLabelChange::RemoveAllLabelMappings()
+{
+    if (this->LabelMappings.empty()) {
+        return;
+    }
+    this->LabelMappings.clear();
+    this->Modified();
+}
+
+//----------------------------------------------------------------------------
+int vtkImageLabelChange::GetNumberOfLabelMappings()
+{
+    return static_cast<int>(this->LabelMappings.size());
+}
+
+//----------------------------------------------------------------------------
+// Description:
+// The 8 and 16 bit integer types are mapped through a table
+template <class T>
+static bool vtkImageLabelChangeHasTable(T*) { return false; }
+static bool vtkImageLabelChangeHasTable(char*) { return true; }
+static bool vtkImageLabelChangeHasTable(signed char*) { return true; }
+static bool vtkImageLabelChangeHasTable(unsigned char*) { return true; }
+static bool vtkImageLabelChangeHasTable(short*) { return true; }
+static bool vtkImageLabelChangeHasTable(unsigned short*) { return true; }
+
+//----------------------------------------------------------------------------
+// Description:
+// Label of an input value: its mapping if any, the unmapped label or
+// the value itself otherwise
+template <class T>
+static T vtkImageLabelChangeMap(T value, const std::vector<double>& inLabels,
+                                const std::vector<double>& outLabels,
+                                bool replaceUnmapped, T unmappedLabel)
+{
+    std::vector<double>::const_iterator it =
+        std::lower_bound(inLabels.begin(), inLabels.end(), static_cast<double>(value));
+    if (it != inLabels.end() && *it == static_cast<double>(value)) {
+        return static_cast<T>(outLabels[it - inLabels.begin()]);
+    }
+    return replaceUnmapped ? unmappedLabel : value;
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+static void vtkImageLabelChangeBuildTable(T* dummy, vtkImageLabelChange *self,
+                                          const std::vector<double>& inLabels,
+                                          const std::vector<double>& outLabels,
+                                          std::vector<char>& table)
+{
+    table.clear();
+    if (!vtkImageLabelChangeHasTable(dummy)) {
+        return;
+    }
+    int min = static_cast<int>(vtkTypeTraits<T>::Min());
+    int max = static_cast<int>(vtkTypeTraits<T>::Max());
+    table.resize((max - min + 1) * sizeof(T));
+    T *labels = reinterpret_cast<T*>(&table[0]);
+    bool replaceUnmapped = self->GetReplaceUnmappedLabels() != 0;
+    T unmappedLabel = static_cast<T>(self->GetUnmappedLabel());
+    for (int v = min; v <= max; v++) {
+        labels[v - min] = vtkImageLabelChangeMap(static_cast<T>(v), inLabels,
+            outLabels, replaceUnmapped, unmappedLabel);
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -31,15 +119,29 @@ template <class T>
 static void vtkImageLabelChangeExecute(vtkImageLabelChange *self,
                      vtkImageData *vtkNotUsed(inData), T *inPtr,
                      vtkImageData *outData, 
-                     int outExt[6], int vtkNotUsed(id))
+                     int outExt[6], int vtkNotUsed(id),
+                     const std::vector<double>& inLabels,
+                     const std::vector<double>& outLabels,
+                     const std::vector<char>& table)
 {
     T *outPtr = (T *)outData->GetScalarPointerForExtent(outExt);
     // looping
     vtkIdType outIncX, outIncY, outIncZ;
     int idxX, idxY, idxZ, maxX, maxY, maxZ;
     // Other
-    T inLabel = (T) self->GetInputLabel();
-    T outLabel = (T) self->GetOutputLabel();
+    const T *labels = table.empty() ? 0 : reinterpret_cast<const T*>(&table[0]);
+    int min = labels ? static_cast<int>(vtkTypeTraits<T>::Min()) : 0;
+    bool replaceUnmapped = self->GetReplaceUnmappedLabels() != 0;
+    T unmappedLabel = static_cast<T>(self->GetUnmappedLabel());
+    T lastValue = 0;
+    T lastLabel = vtkImageLabelChangeMap(lastValue, inLabels, outLabels,
+        replaceUnmapped, unmappedLabel);
+
+    // Only the voxels in the ROI are changed
+    int roi[6];
+    for (int i = 0; i < 6; i++) {
+        roi[i] = self->GetUseROIExtent() ? self->GetROIExtent()[i] : outExt[i];
+    }
 
     // Get increments to march through data 
     outData->GetContinuousIncrements(outExt, outIncX, outIncY, outIncZ);
@@ -50,11 +152,24 @@ static void vtkImageLabelChangeExecute(vtkImageLabelChange *self,
     // Loop through ouput pixels
     for (idxZ = 0; idxZ <= maxZ; idxZ++) {
         for (idxY = 0; !self->AbortExecute && idxY <= maxY; idxY++) {
+            bool rowInROI =
+                outExt[4] + idxZ >= roi[4] && outExt[4] + idxZ <= roi[5] &&
+                outExt[2] + idxY >= roi[2] && outExt[2] + idxY <= roi[3];
             for (idxX = 0; idxX <= maxX; idxX++) {
-                if (*inPtr == inLabel)
-                    *outPtr = outLabel;
-                else
-                    *outPtr = *inPtr;
+                T value = *inPtr;
+                if (!rowInROI || outExt[0] + idxX < roi[0] || outExt[0] + idxX > roi[1])
+                    *outPtr = value;
+                else if (labels)
+                    *outPtr = labels[static_cast<int>(value) - min];
+                else {
+                    // labels come in runs, remember the last one
+                    if (value != lastValue) {
+                        lastValue = value;
+                        lastLabel = vtkImageLabelChangeMap(value, inLabels,
+                            outLabels, replaceUnmapped, unmappedLabel);
+                    }
+                    *outPtr = lastLabel;
+                }
                 outPtr++;
                 inPtr++;
             }
@@ -67,6 +182,39 @@ static void vtkImageLabelChangeExecute(vtkImageLabelChange *self,
 }
 
 
+//----------------------------------------------------------------------------
+// Description:
+// Sort the label mappings and build the table for the input scalar type
+// before the threads are started.
+void vtkImageLabelChange::ExecuteData(vtkDataObject *out)
+{
+    this->MappedInputLabels.clear();
+    this->MappedOutputLabels.clear();
+    if (this->LabelMappings.empty()) {
+        this->MappedInputLabels.push_back(this->InputLabel);
+        this->MappedOutputLabels.push_back(this->OutputLabel);
+    }
+    else {
+        std::map<double, double>::const_iterator it;
+        for (it = this->LabelMappings.begin(); it != this->LabelMappings.end(); ++it) {
+            this->MappedInputLabels.push_back(it->first);
+            this->MappedOutputLabels.push_back(it->second);
+        }
+    }
+
+    vtkImageData *inData = this->GetInput();
+    this->Table.clear();
+    if (inData) {
+        switch (inData->GetScalarType())
+        {
+        vtkTemplateMacro(vtkImageLabelChangeBuildTable(static_cast<VTK_TT*>(0),
+            this, this->MappedInputLabels, this->MappedOutputLabels, this->Table));
+        }
+    }
+
+    this->Superclass::ExecuteData(out);
+}
+
 //----------------------------------------------------------------------------
 // Description:
 // This method is passed a input and output data, and executes the filter
@@ -89,46 +237,9 @@ void vtkImageLabelChange::ThreadedExecute(vtkImageData *inData,
   
     switch (inData->GetScalarType())
     {
-        case VTK_DOUBLE:
-        vtkImageLabelChangeExecute(this, inData, (double *)(inPtr), 
-            outData, outExt, id);
-        break;
-    case VTK_FLOAT:
-        vtkImageLabelChangeExecute(this, inData, (float *)(inPtr), 
-            outData, outExt, id);
-        break;        
-    case VTK_LONG:
-        vtkImageLabelChangeExecute(this, inData, (long *)(inPtr), 
-            outData, outExt, id);
-        break;
-    case VTK_UNSIGNED_LONG:
-        vtkImageLabelChangeExecute(this, inData, (unsigned long *)(inPtr), 
-            outData, outExt, id);
-        break;
-    case VTK_INT:
-        vtkImageLabelChangeExecute(this, inData, (int *)(inPtr), 
-            outData, outExt, id);
-        break;
-    case VTK_UNSIGNED_INT:
-        vtkImageLabelChangeExecute(this, inData, (unsigned int *)(inPtr), 
-            outData, outExt, id);
-        break;
-    case VTK_SHORT:
-        vtkImageLabelChangeExecute(this, inData, (short *)(inPtr), 
-            outData, outExt, id);
-        break;
-    case VTK_UNSIGNED_SHORT:
-        vtkImageLabelChangeExecute(this, inData, (unsigned short *)(inPtr), 
-            outData, outExt, id);
-        break;
-    case VTK_CHAR:
-        vtkImageLabelChangeExecute(this, inData, (char *)(inPtr), 
-            outData, outExt, id);
-        break;
-    case VTK_UNSIGNED_CHAR:
-        vtkImageLabelChangeExecute(this, inData, (unsigned char *)(inPtr), 
-            outData, outExt, id);
-        break;
+    vtkTemplateMacro(vtkImageLabelChangeExecute(this, inData,
+        static_cast<VTK_TT*>(inPtr), outData, outExt, id,
+        this->MappedInputLabels, this->MappedOutputLabels, this->Table));
     default:
         vtkErrorMacro(<< "Execute: Unknown input ScalarType");
         return;
@@ -142,5 +253,11 @@ void vtkImageLabelChange::PrintSelf(ostream& os, vtkIndent indent)
         
     os << indent << "InputLabel: " << this->InputLabel << "\n";
     os << indent << "OutputLabel: " << this->OutputLabel << "\n";
+    os << indent << "LabelMappings: " << this->LabelMappings.size() << "\n";
+    os << indent << "ReplaceUnmappedLabels: " << this->ReplaceUnmappedLabels << "\n";
+    os << indent << "UnmappedLabel: " << this->UnmappedLabel << "\n";
+    os << indent << "UseROIExtent: " << this->UseROIExtent << "\n";
+    os << indent << "ROIExtent: " << this->ROIExtent[0] << " " << this->ROIExtent[1]
+       << " " << this->ROIExtent[2] << " " << this->ROIExtent[3]
+       << " " << this->ROIExtent[4] << " " << this->ROIExtent[5] << "\n";
 }
-
@@ -12,6 +12,14 @@
 //
 /// vtkImageLabelChange is will replace one voxel value with another.
 /// This is used for editing of labelmaps.
+///
+/// Any number of label mappings can be added with AddLabelMapping(), they
+/// are all applied in one threaded pass (InputLabel and OutputLabel are
+/// only used if there is no label mapping). For 8 and 16 bit scalars the
+/// mappings are precomputed into a table indexed by the voxel value.
+/// Labels without mapping are kept, or replaced by UnmappedLabel if
+/// ReplaceUnmappedLabels is on. With UseROIExtent on, only the voxels in
+/// ROIExtent are changed, the others are copied.
 //
 
 #ifndef __vtkImageLabelChange_h
@@ -22,6 +30,10 @@
 // VTK includes
 #include <vtkImageToImageFilter.h>
 
+// STD includes
+#include <map>
+#include <vector>
+
 class vtkImageData;
 class VTK_SLICER_EDITORLIB_MODULE_LOGIC_EXPORT vtkImageLabelChange : public vtkImageToImageFilter
 {
@@ -36,6 +48,30 @@ public:
     vtkSetMacro(OutputLabel, float);
     vtkGetMacro(OutputLabel, float);
 
+    ///
+    /// Change the voxels of inputLabel to outputLabel, in addition to the
+    /// mappings already added (replacing the one of inputLabel if any)
+    void AddLabelMapping(double inputLabel, double outputLabel);
+    void RemoveAllLabelMappings();
+    int GetNumberOfLabelMappings();
+
+    ///
+    /// Replace the labels without mapping by UnmappedLabel, off by default
+    vtkSetMacro(ReplaceUnmappedLabels, int);
+    vtkGetMacro(ReplaceUnmappedLabels, int);
+    vtkBooleanMacro(ReplaceUnmappedLabels, int);
+    vtkSetMacro(UnmappedLabel, float);
+    vtkGetMacro(UnmappedLabel, float);
+
+    ///
+    /// Only change the voxels inside ROIExtent if UseROIExtent is on (off
+    /// by default)
+    vtkSetVector6Macro(ROIExtent, int);
+    vtkGetVector6Macro(ROIExtent, int);
+    vtkSetMacro(UseROIExtent, int);
+    vtkGetMacro(UseROIExtent, int);
+    vtkBooleanMacro(UseROIExtent, int);
+
 protected:
     vtkImageLabelChange();
     ~vtkImageLabelChange() {};
@@ -44,7 +80,19 @@ protected:
 
     float InputLabel;
     float OutputLabel;
+    std::map<double, double> LabelMappings;
+    int ReplaceUnmappedLabels;
+    float UnmappedLabel;
+    int ROIExtent[6];
+    int UseROIExtent;
+
+    /// Mappings of the current execution sorted by input label, and the
+    /// label of each voxel value for 8 and 16 bit scalars
+    std::vector<double> MappedInputLabels;
+    std::vector<double> MappedOutputLabels;
+    std::vector<char> Table;
 
+    void ExecuteData(vtkDataObject *out);
     void ThreadedExecute(vtkImageData *inData, vtkImageData *outData, 
         int extent[6], int id);
 };
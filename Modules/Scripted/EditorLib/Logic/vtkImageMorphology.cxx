@@ -0,0 +1,352 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+#include "vtkImageMorphology.h"
+
+// vtkITK includes
+#include <vtkITKDistanceTransform.h>
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkMultiThreader.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+
+//------------------------------------------------------------------------------
+vtkCxxRevisionMacro(vtkImageMorphology, "$Revision$");
+vtkStandardNewMacro(vtkImageMorphology);
+
+namespace
+{
+// Passes of the filter
+enum
+  {
+  MaskPass = 0,
+  CrossPass,
+  BoxPass,
+  ApplyPass
+  };
+
+// Distance of the pixels that are too far from the Background pixels
+const int FarDistance = VTK_INT_MAX / 2;
+}
+
+//----------------------------------------------------------------------------
+static VTK_THREAD_RETURN_TYPE vtkImageMorphology_ThreadedPass( void *arg )
+{
+  vtkMultiThreader::ThreadInfo *info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  vtkImageMorphology *self = static_cast<vtkImageMorphology *>(info->UserData);
+  self->ThreadedPass(info->ThreadID, info->NumberOfThreads);
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+// The Background pixels of [begin, end) are at distance 0, the others far.
+template <class T>
+static void vtkImageMorphologyMask(const T* inPtr, vtkIdType begin, vtkIdType end,
+                                   T background, int* distances)
+{
+  for (vtkIdType i = begin; i < end; ++i)
+    {
+    distances[i] = (inPtr[i] == background) ? 0 : FarDistance;
+    }
+}
+
+//----------------------------------------------------------------------------
+// The Foreground pixels of [begin, end) within radius of a Background pixel
+// become Background.
+template <class T>
+static void vtkImageMorphologyApply(const T* inPtr, T* outPtr,
+                                    vtkIdType begin, vtkIdType end,
+                                    T foreground, T background,
+                                    const int* distances, int radius)
+{
+  for (vtkIdType i = begin; i < end; ++i)
+    {
+    T pix = inPtr[i];
+    outPtr[i] = (pix == foreground && distances[i] <= radius) ? background : pix;
+    }
+}
+
+//----------------------------------------------------------------------------
+// Description:
+// Constructor sets default values
+vtkImageMorphology::vtkImageMorphology()
+{
+  this->Background = 0;
+  this->Foreground = 1;
+  this->Radius = 1;
+  this->StructuringElement = Cross;
+  this->DistanceTransformRadius = 8;
+  this->MultiThreader = vtkMultiThreader::New();
+  this->NumberOfThreads = this->MultiThreader->GetNumberOfThreads();
+  this->Input = 0;
+  this->Output = 0;
+  this->Pass = MaskPass;
+  this->PassAxis = 0;
+  this->PassRadius = 0;
+}
+
+//----------------------------------------------------------------------------
+vtkImageMorphology::~vtkImageMorphology()
+{
+  this->MultiThreader->Delete();
+}
+
+//----------------------------------------------------------------------------
+void vtkImageMorphology::SimpleExecute(vtkImageData* input, vtkImageData* output)
+{
+  if (!input->GetPointData()->GetScalars())
+    {
+    vtkErrorMacro(<< "Execute: no input scalars");
+    return;
+    }
+  if (input->GetNumberOfScalarComponents() != 1)
+    {
+    vtkErrorMacro(<< "Execute: only images of one component are supported");
+    return;
+    }
+  int dims[3];
+  input->GetDimensions(dims);
+  vtkIdType numberOfPixels = static_cast<vtkIdType>(dims[0]) * dims[1] * dims[2];
+  if (numberOfPixels == 0)
+    {
+    return;
+    }
+
+  this->Input = input;
+  this->Output = output;
+  this->Distances.resize(numberOfPixels);
+
+  this->RunPass(MaskPass, 0, 0);
+  this->UpdateProgress(0.2);
+
+  int applyRadius = 0;
+  switch (this->StructuringElement)
+    {
+    case Cross:
+      // L1 distance to the Background pixels
+      for (int axis = 0; axis < 3; ++axis)
+        {
+        this->RunPass(CrossPass, axis, 0);
+        }
+      applyRadius = this->Radius;
+      break;
+    case Box:
+      for (int axis = 0; axis < 3; ++axis)
+        {
+        this->RunPass(BoxPass, axis, this->Radius);
+        }
+      break;
+    case Sphere:
+      if (this->Radius >= this->DistanceTransformRadius)
+        {
+        this->SphereDistance(input);
+        }
+      else
+        {
+        // a box followed by a cross makes a round enough element when
+        // the box is sqrt(2)-1 of the radius
+        int boxRadius = static_cast<int>(this->Radius * (sqrt(2.) - 1.) + 0.5);
+        for (int axis = 0; boxRadius > 0 && axis < 3; ++axis)
+          {
+          this->RunPass(BoxPass, axis, boxRadius);
+          }
+        for (int axis = 0; axis < 3; ++axis)
+          {
+          this->RunPass(CrossPass, axis, 0);
+          }
+        applyRadius = this->Radius - boxRadius;
+        }
+      break;
+    }
+  this->UpdateProgress(0.8);
+
+  this->RunPass(ApplyPass, 0, applyRadius);
+
+  std::vector<int>().swap(this->Distances);
+  this->Input = 0;
+  this->Output = 0;
+}
+
+//----------------------------------------------------------------------------
+void vtkImageMorphology::RunPass(int pass, int axis, int radius)
+{
+  this->Pass = pass;
+  this->PassAxis = axis;
+  this->PassRadius = radius;
+
+  int dims[3];
+  this->Input->GetDimensions(dims);
+  vtkIdType numberOfRows = static_cast<vtkIdType>(dims[0]) * dims[1] * dims[2] / dims[axis];
+  int numberOfThreads = static_cast<int>(
+    std::min(static_cast<vtkIdType>(this->NumberOfThreads), numberOfRows));
+  if (numberOfThreads > 1)
+    {
+    this->MultiThreader->SetNumberOfThreads(numberOfThreads);
+    this->MultiThreader->SetSingleMethod(vtkImageMorphology_ThreadedPass, this);
+    this->MultiThreader->SingleMethodExecute();
+    }
+  else
+    {
+    this->ThreadedPass(0, 1);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkImageMorphology::ThreadedPass(int threadId, int numberOfThreads)
+{
+  if (this->Pass == CrossPass || this->Pass == BoxPass)
+    {
+    this->DistancePass(threadId, numberOfThreads);
+    return;
+    }
+
+  int dims[3];
+  this->Input->GetDimensions(dims);
+  vtkIdType numberOfRows = static_cast<vtkIdType>(dims[1]) * dims[2];
+  vtkIdType begin = numberOfRows * threadId / numberOfThreads * dims[0];
+  vtkIdType end = numberOfRows * (threadId + 1) / numberOfThreads * dims[0];
+
+  void* inPtr = this->Input->GetScalarPointer();
+  void* outPtr = this->Output->GetScalarPointer();
+  int* distances = &this->Distances[0];
+  if (this->Pass == MaskPass)
+    {
+    switch (this->Input->GetScalarType())
+      {
+      vtkTemplateMacro(
+        vtkImageMorphologyMask(static_cast<VTK_TT*>(inPtr), begin, end,
+                               static_cast<VTK_TT>(this->Background), distances));
+      default:
+        vtkErrorMacro(<< "Execute: Unknown input ScalarType");
+        return;
+      }
+    }
+  else
+    {
+    switch (this->Input->GetScalarType())
+      {
+      vtkTemplateMacro(
+        vtkImageMorphologyApply(static_cast<VTK_TT*>(inPtr), static_cast<VTK_TT*>(outPtr),
+                                begin, end,
+                                static_cast<VTK_TT>(this->Foreground),
+                                static_cast<VTK_TT>(this->Background),
+                                distances, this->PassRadius));
+      default:
+        vtkErrorMacro(<< "Execute: Unknown input ScalarType");
+        return;
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Sweep the rows along PassAxis of the thread back and forth so that the
+// distances become the L1 distances of the axes done so far. The box pass
+// then keeps at 0 the pixels within PassRadius along the axis, which
+// dilates the Background pixels by a segment.
+void vtkImageMorphology::DistancePass(int threadId, int numberOfThreads)
+{
+  int dims[3];
+  this->Input->GetDimensions(dims);
+  int axis = this->PassAxis;
+  int axis1 = (axis + 1) % 3;
+  int axis2 = (axis + 2) % 3;
+  vtkIdType increments[3] = {1, dims[0], static_cast<vtkIdType>(dims[0]) * dims[1]};
+  vtkIdType step = increments[axis];
+  int length = dims[axis];
+  if (length < 2)
+    {
+    // the distances along this axis don't change
+    return;
+    }
+
+  vtkIdType numberOfRows = static_cast<vtkIdType>(dims[axis1]) * dims[axis2];
+  vtkIdType first = numberOfRows * threadId / numberOfThreads;
+  vtkIdType last = numberOfRows * (threadId + 1) / numberOfThreads;
+  int* distances = &this->Distances[0];
+  for (vtkIdType row = first; row < last; ++row)
+    {
+    int* d = distances + (row % dims[axis1]) * increments[axis1] +
+      (row / dims[axis1]) * increments[axis2];
+    for (int i = 1; i < length; ++i)
+      {
+      d[i * step] = std::min(d[i * step], d[(i - 1) * step] + 1);
+      }
+    for (int i = length - 2; i >= 0; --i)
+      {
+      d[i * step] = std::min(d[i * step], d[(i + 1) * step] + 1);
+      }
+    if (this->Pass == BoxPass)
+      {
+      for (int i = 0; i < length; ++i)
+        {
+        d[i * step] = (d[i * step] <= this->PassRadius) ? 0 : FarDistance;
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Exact Euclidean distances from the distance transform, the pixels
+// within Radius are at 0.
+void vtkImageMorphology::SphereDistance(vtkImageData* input)
+{
+  int* distances = &this->Distances[0];
+  vtkIdType numberOfPixels = static_cast<vtkIdType>(this->Distances.size());
+  if (std::find(distances, distances + numberOfPixels, 0) == distances + numberOfPixels)
+    {
+    // no Background pixel, nothing to change
+    return;
+    }
+
+  vtkNew<vtkImageData> mask;
+  mask->SetDimensions(input->GetDimensions());
+  mask->SetScalarTypeToFloat();
+  mask->SetNumberOfScalarComponents(1);
+  mask->AllocateScalars();
+  float* maskPtr = static_cast<float*>(mask->GetScalarPointer());
+  for (vtkIdType i = 0; i < numberOfPixels; ++i)
+    {
+    maskPtr[i] = (distances[i] == 0) ? 1.f : 0.f;
+    }
+
+  vtkNew<vtkITKDistanceTransform> distanceTransform;
+  distanceTransform->SetInput(mask.GetPointer());
+  distanceTransform->SetBackgroundValue(0);
+  distanceTransform->SetSquaredDistance(1);
+  distanceTransform->SetInsideIsPositive(0);
+  distanceTransform->SetUseImageSpacing(0);
+  distanceTransform->Update();
+
+  const float* squaredDistances = static_cast<float*>(
+    distanceTransform->GetOutput()->GetScalarPointer());
+  float squaredRadius = static_cast<float>(this->Radius) * this->Radius;
+  for (vtkIdType i = 0; i < numberOfPixels; ++i)
+    {
+    distances[i] = (squaredDistances[i] <= squaredRadius) ? 0 : FarDistance;
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkImageMorphology::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+
+  os << indent << "Background: " << this->Background << "\n";
+  os << indent << "Foreground: " << this->Foreground << "\n";
+  os << indent << "Radius: " << this->Radius << "\n";
+  os << indent << "StructuringElement: " << this->StructuringElement << "\n";
+  os << indent << "DistanceTransformRadius: " << this->DistanceTransformRadius << "\n";
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << "\n";
+}
@@ -0,0 +1,120 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+///  vtkImageMorphology -  Erosion or dilation by a structuring element
+///
+/// Pixels of the Foreground value that have a pixel of the Background
+/// value in their structuring element are set to the Background value:
+/// with a label as Foreground and 0 as Background it erodes the label,
+/// the other way round it dilates it. Pixels of other values are left
+/// alone.
+///
+/// The structuring element of Radius r is what r passes of vtkImageErode
+/// would reach: a cross (6 neighbors) or a box (26 neighbors), or an
+/// approximate sphere. The element is decomposed in passes along the
+/// rows of each axis that are threaded and cost the same for any radius.
+/// Spheres from DistanceTransformRadius are exact and computed with
+/// vtkITKDistanceTransform. Pixels of other values don't block the
+/// element like they block the passes of vtkImageErode.
+
+#ifndef __vtkImageMorphology_h
+#define __vtkImageMorphology_h
+
+#include "vtkSlicerEditorLibModuleLogicExport.h"
+
+// VTK includes
+#include <vtkSimpleImageToImageFilter.h>
+
+// STD includes
+#include <vector>
+
+class vtkMultiThreader;
+
+class VTK_SLICER_EDITORLIB_MODULE_LOGIC_EXPORT vtkImageMorphology : public vtkSimpleImageToImageFilter
+{
+public:
+  static vtkImageMorphology *New();
+  vtkTypeRevisionMacro(vtkImageMorphology,vtkSimpleImageToImageFilter);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  ///
+  /// Background and foreground pixel values in the image.
+  /// Usually 0 and some label value, respectively.
+  vtkSetMacro(Background, float);
+  vtkGetMacro(Background, float);
+  vtkSetMacro(Foreground, float);
+  vtkGetMacro(Foreground, float);
+
+  ///
+  /// Radius of the structuring element in pixels, 1 by default
+  vtkSetClampMacro(Radius, int, 0, VTK_INT_MAX);
+  vtkGetMacro(Radius, int);
+
+  enum
+    {
+    Cross = 0,
+    Box,
+    Sphere
+    };
+
+  ///
+  /// Shape of the structuring element, Cross by default
+  vtkSetClampMacro(StructuringElement, int, Cross, Sphere);
+  vtkGetMacro(StructuringElement, int);
+  void SetStructuringElementToCross() {this->SetStructuringElement(Cross);}
+  void SetStructuringElementToBox() {this->SetStructuringElement(Box);}
+  void SetStructuringElementToSphere() {this->SetStructuringElement(Sphere);}
+
+  ///
+  /// Radius from which spheres are computed with a distance transform
+  /// instead of a cross and a box, 8 by default
+  vtkSetClampMacro(DistanceTransformRadius, int, 1, VTK_INT_MAX);
+  vtkGetMacro(DistanceTransformRadius, int);
+
+  ///
+  /// Maximum number of threads used by the passes
+  vtkSetClampMacro(NumberOfThreads, int, 1, VTK_MAX_THREADS);
+  vtkGetMacro(NumberOfThreads, int);
+
+  ///
+  /// Run the current pass on a share of the rows, called by the threads
+  void ThreadedPass(int threadId, int numberOfThreads);
+
+protected:
+  vtkImageMorphology();
+  ~vtkImageMorphology();
+
+  virtual void SimpleExecute(vtkImageData* input, vtkImageData* output);
+
+  void RunPass(int pass, int axis, int radius);
+  void DistancePass(int threadId, int numberOfThreads);
+  void SphereDistance(vtkImageData* input);
+
+  float Background;
+  float Foreground;
+  int Radius;
+  int StructuringElement;
+  int DistanceTransformRadius;
+  int NumberOfThreads;
+  vtkMultiThreader* MultiThreader;
+
+  /// State of the current execution: the distance of every pixel to the
+  /// closest Background pixel, along the axes done so far
+  vtkImageData* Input;
+  vtkImageData* Output;
+  std::vector<int> Distances;
+  int Pass;
+  int PassAxis;
+  int PassRadius;
+
+private:
+  vtkImageMorphology(const vtkImageMorphology&);  /// Not implemented.
+  void operator=(const vtkImageMorphology&);  /// Not implemented.
+};
+
+#endif
@@ -0,0 +1,296 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+
+#include "vtkImageRegionDiff.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+
+// STD includes
+#include <algorithm>
+#include <cstring>
+
+vtkCxxRevisionMacro(vtkImageRegionDiff, "$Revision: 1.0 $");
+vtkStandardNewMacro(vtkImageRegionDiff);
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// The runs are stored as a 32 bits count followed by the bytes of the voxel.
+typedef unsigned int RunLength;
+
+//----------------------------------------------------------------------------
+void appendRun(std::vector<unsigned char>& runs, RunLength count,
+               const unsigned char* voxel, int voxelSize)
+{
+  size_t end = runs.size();
+  runs.resize(end + sizeof(RunLength) + voxelSize);
+  memcpy(&runs[end], &count, sizeof(RunLength));
+  memcpy(&runs[end + sizeof(RunLength)], voxel, voxelSize);
+}
+
+//----------------------------------------------------------------------------
+// Run-length encode the voxels of extent, row after row.
+void encodeRuns(vtkImageData* image, const int extent[6],
+                std::vector<unsigned char>& runs)
+{
+  runs.clear();
+  int voxelSize = image->GetScalarSize() * image->GetNumberOfScalarComponents();
+  int rowLength = extent[1] - extent[0] + 1;
+  const unsigned char* runVoxel = 0;
+  RunLength count = 0;
+  for (int z = extent[4]; z <= extent[5]; ++z)
+    {
+    for (int y = extent[2]; y <= extent[3]; ++y)
+      {
+      const unsigned char* voxel = static_cast<unsigned char*>(
+        image->GetScalarPointer(extent[0], y, z));
+      for (int x = 0; x < rowLength; ++x, voxel += voxelSize)
+        {
+        if (count > 0 && count < VTK_UNSIGNED_INT_MAX &&
+            memcmp(voxel, runVoxel, voxelSize) == 0)
+          {
+          ++count;
+          continue;
+          }
+        if (count > 0)
+          {
+          appendRun(runs, count, runVoxel, voxelSize);
+          }
+        runVoxel = voxel;
+        count = 1;
+        }
+      }
+    }
+  if (count > 0)
+    {
+    appendRun(runs, count, runVoxel, voxelSize);
+    }
+}
+
+//----------------------------------------------------------------------------
+// Write the run-length encoded voxels into the extent of image.
+void decodeRuns(const std::vector<unsigned char>& runs, const int extent[6],
+                vtkImageData* image)
+{
+  int voxelSize = image->GetScalarSize() * image->GetNumberOfScalarComponents();
+  int rowLength = extent[1] - extent[0] + 1;
+  size_t run = 0;
+  RunLength count = 0;
+  const unsigned char* runVoxel = 0;
+  for (int z = extent[4]; z <= extent[5]; ++z)
+    {
+    for (int y = extent[2]; y <= extent[3]; ++y)
+      {
+      unsigned char* voxel = static_cast<unsigned char*>(
+        image->GetScalarPointer(extent[0], y, z));
+      for (int x = 0; x < rowLength; ++x, voxel += voxelSize)
+        {
+        if (count == 0)
+          {
+          if (run + sizeof(RunLength) + voxelSize > runs.size())
+            {
+            return;
+            }
+          memcpy(&count, &runs[run], sizeof(RunLength));
+          runVoxel = &runs[run + sizeof(RunLength)];
+          run += sizeof(RunLength) + voxelSize;
+          }
+        memcpy(voxel, runVoxel, voxelSize);
+        --count;
+        }
+      }
+    }
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+vtkImageRegionDiff::vtkImageRegionDiff()
+{
+  this->ScalarType = VTK_VOID;
+  this->NumberOfScalarComponents = 0;
+  this->Initialize();
+}
+
+//----------------------------------------------------------------------------
+vtkImageRegionDiff::~vtkImageRegionDiff()
+{
+}
+
+//----------------------------------------------------------------------------
+void vtkImageRegionDiff::Initialize()
+{
+  for (int i = 0; i < 3; ++i)
+    {
+    this->Extent[2*i] = 0;
+    this->Extent[2*i+1] = -1;
+    this->WholeExtent[2*i] = 0;
+    this->WholeExtent[2*i+1] = -1;
+    }
+  // release the memory of the runs
+  std::vector<unsigned char>().swap(this->Before);
+  std::vector<unsigned char>().swap(this->After);
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkImageRegionDiff::Compute(vtkImageData* before, vtkImageData* after)
+{
+  this->Initialize();
+  if (!before || !after ||
+      !before->GetPointData()->GetScalars() ||
+      !after->GetPointData()->GetScalars())
+    {
+    vtkErrorMacro("Compute: no image scalars to compare");
+    return -1;
+    }
+  int* beforeExtent = before->GetExtent();
+  int* afterExtent = after->GetExtent();
+  for (int i = 0; i < 6; ++i)
+    {
+    if (beforeExtent[i] != afterExtent[i])
+      {
+      vtkDebugMacro("Compute: the images have different extents");
+      return -1;
+      }
+    }
+  if (before->GetScalarType() != after->GetScalarType() ||
+      before->GetNumberOfScalarComponents() != after->GetNumberOfScalarComponents())
+    {
+    vtkDebugMacro("Compute: the images have different scalars");
+    return -1;
+    }
+  if (beforeExtent[0] > beforeExtent[1] ||
+      beforeExtent[2] > beforeExtent[3] ||
+      beforeExtent[4] > beforeExtent[5])
+    {
+    return 0;
+    }
+
+  // rows that didn't change are skipped with a memcmp
+  int voxelSize = before->GetScalarSize() * before->GetNumberOfScalarComponents();
+  int rowLength = beforeExtent[1] - beforeExtent[0] + 1;
+  size_t rowSize = static_cast<size_t>(rowLength) * voxelSize;
+  int extent[6] = {VTK_INT_MAX, VTK_INT_MIN, VTK_INT_MAX, VTK_INT_MIN,
+                   VTK_INT_MAX, VTK_INT_MIN};
+  for (int z = beforeExtent[4]; z <= beforeExtent[5]; ++z)
+    {
+    for (int y = beforeExtent[2]; y <= beforeExtent[3]; ++y)
+      {
+      const unsigned char* beforeRow = static_cast<unsigned char*>(
+        before->GetScalarPointer(beforeExtent[0], y, z));
+      const unsigned char* afterRow = static_cast<unsigned char*>(
+        after->GetScalarPointer(beforeExtent[0], y, z));
+      if (memcmp(beforeRow, afterRow, rowSize) == 0)
+        {
+        continue;
+        }
+      int first = 0;
+      while (memcmp(beforeRow + first * voxelSize,
+                    afterRow + first * voxelSize, voxelSize) == 0)
+        {
+        ++first;
+        }
+      int last = rowLength - 1;
+      while (memcmp(beforeRow + last * voxelSize,
+                    afterRow + last * voxelSize, voxelSize) == 0)
+        {
+        --last;
+        }
+      extent[0] = std::min(extent[0], beforeExtent[0] + first);
+      extent[1] = std::max(extent[1], beforeExtent[0] + last);
+      extent[2] = std::min(extent[2], y);
+      extent[3] = std::max(extent[3], y);
+      extent[4] = std::min(extent[4], z);
+      extent[5] = std::max(extent[5], z);
+      }
+    }
+  if (extent[0] > extent[1])
+    {
+    return 0;
+    }
+
+  for (int i = 0; i < 6; ++i)
+    {
+    this->Extent[i] = extent[i];
+    this->WholeExtent[i] = beforeExtent[i];
+    }
+  this->ScalarType = before->GetScalarType();
+  this->NumberOfScalarComponents = before->GetNumberOfScalarComponents();
+  encodeRuns(before, this->Extent, this->Before);
+  encodeRuns(after, this->Extent, this->After);
+
+  return static_cast<vtkIdType>(extent[1] - extent[0] + 1) *
+    (extent[3] - extent[2] + 1) * (extent[5] - extent[4] + 1);
+}
+
+//----------------------------------------------------------------------------
+bool vtkImageRegionDiff::ApplyBefore(vtkImageData* image)
+{
+  return this->Apply(image, this->Before);
+}
+
+//----------------------------------------------------------------------------
+bool vtkImageRegionDiff::ApplyAfter(vtkImageData* image)
+{
+  return this->Apply(image, this->After);
+}
+
+//----------------------------------------------------------------------------
+bool vtkImageRegionDiff::Apply(vtkImageData* image,
+                               const std::vector<unsigned char>& runs)
+{
+  if (this->Extent[0] > this->Extent[1])
+    {
+    // nothing changed
+    return true;
+    }
+  if (!image || !image->GetPointData()->GetScalars())
+    {
+    vtkErrorMacro("Apply: no image scalars to patch");
+    return false;
+    }
+  int* extent = image->GetExtent();
+  for (int i = 0; i < 6; ++i)
+    {
+    if (extent[i] != this->WholeExtent[i])
+      {
+      vtkErrorMacro("Apply: the extent of the image changed");
+      return false;
+      }
+    }
+  if (image->GetScalarType() != this->ScalarType ||
+      image->GetNumberOfScalarComponents() != this->NumberOfScalarComponents)
+    {
+    vtkErrorMacro("Apply: the scalars of the image changed");
+    return false;
+    }
+  decodeRuns(runs, this->Extent, image);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkImageRegionDiff::GetDiffSize()
+{
+  return static_cast<vtkIdType>(this->Before.size() + this->After.size());
+}
+
+//----------------------------------------------------------------------------
+void vtkImageRegionDiff::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+
+  os << indent << "Extent: " << this->Extent[0] << " " << this->Extent[1] << " "
+     << this->Extent[2] << " " << this->Extent[3] << " "
+     << this->Extent[4] << " " << this->Extent[5] << "\n";
+  os << indent << "DiffSize: " << this->GetDiffSize() << "\n";
+}
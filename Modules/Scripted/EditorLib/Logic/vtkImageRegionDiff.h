@@ -0,0 +1,80 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+///  vtkImageRegionDiff - Store the voxels changed by an edit
+///
+/// vtkImageRegionDiff records the bounding extent of the voxels that differ
+/// between two images of the same geometry, and the run-length encoded
+/// voxels of that extent before and after the change. Either state can
+/// then be restored by patching the extent, so the cost of an undo step
+/// is proportional to the size of the edit rather than of the label map.
+//
+
+#ifndef __vtkImageRegionDiff_h
+#define __vtkImageRegionDiff_h
+
+#include "vtkSlicerEditorLibModuleLogicExport.h"
+
+// VTK includes
+#include <vtkObject.h>
+
+// STD includes
+#include <vector>
+
+class vtkImageData;
+
+class VTK_SLICER_EDITORLIB_MODULE_LOGIC_EXPORT vtkImageRegionDiff : public vtkObject
+{
+public:
+  static vtkImageRegionDiff *New();
+  vtkTypeRevisionMacro(vtkImageRegionDiff,vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  ///
+  /// Record the voxels that differ between before and after.
+  /// Return the number of voxels of the recorded extent, 0 if the images
+  /// are identical or -1 if their extents or scalar types differ.
+  vtkIdType Compute(vtkImageData* before, vtkImageData* after);
+
+  ///
+  /// Patch the extent of image with the voxels before or after the change.
+  /// Return false if image doesn't have the geometry of the compared images.
+  bool ApplyBefore(vtkImageData* image);
+  bool ApplyAfter(vtkImageData* image);
+
+  ///
+  /// Forget the recorded voxels
+  void Initialize();
+
+  ///
+  /// Bounding extent of the changed voxels, empty if nothing changed
+  vtkGetVector6Macro(Extent, int);
+
+  ///
+  /// Size in bytes of the recorded voxels
+  vtkIdType GetDiffSize();
+
+protected:
+  vtkImageRegionDiff();
+  ~vtkImageRegionDiff();
+
+  bool Apply(vtkImageData* image, const std::vector<unsigned char>& runs);
+
+  int Extent[6];
+  int WholeExtent[6];
+  int ScalarType;
+  int NumberOfScalarComponents;
+  std::vector<unsigned char> Before;
+  std::vector<unsigned char> After;
+
+private:
+  vtkImageRegionDiff(const vtkImageRegionDiff&);  /// Not implemented.
+  void operator=(const vtkImageRegionDiff&);  /// Not implemented.
+};
+
+#endif
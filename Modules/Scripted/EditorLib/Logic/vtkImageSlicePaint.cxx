@@ -17,6 +17,8 @@
 #include "vtkObjectFactory.h"
 #include "vtkSmartPointer.h"
 
+#include <algorithm>
+
 
 vtkCxxRevisionMacro(vtkImageSlicePaint, "$Revision$");
 vtkStandardNewMacro(vtkImageSlicePaint);
@@ -38,6 +40,7 @@ vtkImageSlicePaint::vtkImageSlicePaint()
   this->PaintLabel = 1;
   this->BrushCenter[0] = this->BrushCenter[1] = this->BrushCenter[2] = 0.0;
   this->BrushRadius = 0;
+  this->StrokeStart[0] = this->StrokeStart[1] = this->StrokeStart[2] = 0.0;
 
   this->BackgroundIJKToWorld = vtkMatrix4x4::New();
   this->BackgroundIJKToWorld->Identity();
@@ -412,6 +415,371 @@ void vtkImageSlicePaint::Paint()
   return;
 }
 
+//----------------------------------------------------------------------------
+// The voxels of a row of the working image are at origin + x * step, for
+// integer x. The spans below are the ranges of x inside a shape.
+static
+double dot3 (const double *a, const double *b)
+{
+  return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+//----------------------------------------------------------------------------
+// Solve a*x^2 + b*x + c < 0, return false if there is no solution
+static
+bool quadraticSpan (double a, double b, double c, double &first, double &last)
+{
+  if ( a == 0 )
+    {
+    // the row doesn't move with respect to the shape
+    if ( c >= 0 )
+      {
+      return false;
+      }
+    first = -VTK_DOUBLE_MAX;
+    last = VTK_DOUBLE_MAX;
+    return true;
+    }
+  double discr = b * b - 4. * a * c;
+  if ( discr <= 0 )
+    {
+    return false;
+    }
+  double root = sqrt(discr);
+  first = (-b - root) / (2. * a);
+  last = (-b + root) / (2. * a);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+static
+bool sphereSpan (const double *origin, const double *step,
+                 const double *center, double radiusSquared,
+                 double &first, double &last)
+{
+  double q[3];
+  for (int i = 0; i < 3; i++) { q[i] = origin[i] - center[i]; }
+  return quadraticSpan(dot3(step, step), 2. * dot3(q, step),
+                       dot3(q, q) - radiusSquared, first, last);
+}
+
+//----------------------------------------------------------------------------
+// The cylinder of the segment from start to start + length * axis, with a
+// unit axis. The caps of the stroke are the spheres at its ends.
+static
+bool cylinderSpan (const double *origin, const double *step,
+                   const double *start, const double *axis, double length,
+                   double radiusSquared, double &first, double &last)
+{
+  double q[3];
+  for (int i = 0; i < 3; i++) { q[i] = origin[i] - start[i]; }
+  double qAxis = dot3(q, axis);
+  double stepAxis = dot3(step, axis);
+  double qNormal[3], stepNormal[3];
+  for (int i = 0; i < 3; i++)
+    {
+    qNormal[i] = q[i] - qAxis * axis[i];
+    stepNormal[i] = step[i] - stepAxis * axis[i];
+    }
+  if ( !quadraticSpan(dot3(stepNormal, stepNormal), 2. * dot3(qNormal, stepNormal),
+                      dot3(qNormal, qNormal) - radiusSquared, first, last) )
+    {
+    return false;
+    }
+  // and the projection on the axis must be within the segment
+  if ( stepAxis == 0 )
+    {
+    return qAxis >= 0 && qAxis <= length;
+    }
+  double t0 = -qAxis / stepAxis;
+  double t1 = (length - qAxis) / stepAxis;
+  first = std::max(first, std::min(t0, t1));
+  last = std::min(last, std::max(t0, t1));
+  return first <= last;
+}
+
+//----------------------------------------------------------------------------
+// Paint count contiguous voxels, the masks are computed without branches
+// so that the compiler can vectorize the loop
+template <class T>
+void vtkImageSlicePaintSpan(T *workingPtr, int count, T label, int paintOver)
+{
+  for (int n = 0; n < count; n++)
+    {
+    bool paint = paintOver || workingPtr[n] == 0;
+    workingPtr[n] = paint ? label : workingPtr[n];
+    }
+}
+
+//----------------------------------------------------------------------------
+template <class T, class B>
+void vtkImageSlicePaintSpan(T *workingPtr, const B *backgroundPtr, int backgroundStep,
+                            int count, T label, int paintOver,
+                            double thresholdMin, double thresholdMax)
+{
+  for (int n = 0; n < count; n++)
+    {
+    double bgValue = static_cast<double>(backgroundPtr[n * backgroundStep]);
+    bool paint = (paintOver || workingPtr[n] == 0) &&
+                 bgValue > thresholdMin && bgValue < thresholdMax;
+    workingPtr[n] = paint ? label : workingPtr[n];
+    }
+}
+
+//----------------------------------------------------------------------------
+template <class T, class B>
+void vtkImageSlicePaintStrokeRows(vtkImageSlicePaint *self, T *vtkNotUsed(ptr),
+                                  B *vtkNotUsed(backgroundPtr))
+{
+  vtkImageData *working = self->GetWorkingImage();
+  vtkImageData *background = self->GetBackgroundImage();
+  int thresholdPaint = self->GetThresholdPaint();
+  if ( thresholdPaint && background == NULL )
+    {
+    vtkErrorWithObjectMacro (self, << "PaintStroke: ThresholdPaint needs a BackgroundImage\n");
+    return;
+    }
+
+  double workingMatrix[4][4]; // working IJK to world
+  double worldMatrix[4][4];   // world to working IJK
+  vtkSmartPointer<vtkMatrix4x4> workingWorldToIJK = vtkSmartPointer<vtkMatrix4x4>::New();
+  if ( self->GetWorkingIJKToWorld() )
+    {
+    workingWorldToIJK->DeepCopy( self->GetWorkingIJKToWorld() );
+    }
+  for (int i = 0; i < 4; i++)
+    {
+    for (int j = 0; j < 4; j++)
+      {
+      workingMatrix[i][j] = workingWorldToIJK->GetElement(i, j);
+      }
+    }
+  workingWorldToIJK->Invert();
+  for (int i = 0; i < 4; i++)
+    {
+    for (int j = 0; j < 4; j++)
+      {
+      worldMatrix[i][j] = workingWorldToIJK->GetElement(i, j);
+      }
+    }
+
+  // the stroke is a segment swept by a sphere
+  double *start = self->GetStrokeStart();
+  double *end = self->GetBrushCenter();
+  double radius = self->GetBrushRadius();
+  double radiusSquared = radius * radius;
+  double axis[3];
+  for (int i = 0; i < 3; i++) { axis[i] = end[i] - start[i]; }
+  double length = sqrt(dot3(axis, axis));
+  if ( length > 0 )
+    {
+    for (int i = 0; i < 3; i++) { axis[i] /= length; }
+    }
+
+  // bounding box of the stroke in working IJK: the sphere of radius r is
+  // an ellipsoid there, as wide as r times the norm of each row of the matrix
+  int box[6];
+  const int *workingExtent = working->GetExtent();
+  for (int i = 0; i < 3; i++)
+    {
+    double halfWidth = radius * sqrt(dot3(worldMatrix[i], worldMatrix[i]));
+    double startIJK = dot3(worldMatrix[i], start) + worldMatrix[i][3];
+    double endIJK = dot3(worldMatrix[i], end) + worldMatrix[i][3];
+    box[2*i] = std::max(workingExtent[2*i],
+      static_cast<int>(ceil(std::min(startIJK, endIJK) - halfWidth)));
+    box[2*i+1] = std::min(workingExtent[2*i+1],
+      static_cast<int>(floor(std::max(startIJK, endIJK) + halfWidth)));
+    if ( box[2*i] > box[2*i+1] )
+      {
+      return;
+      }
+    }
+
+  // the background is read at the same voxels when the grids match,
+  // otherwise each painted voxel is mapped to the nearest background voxel
+  double backgroundMatrix[3][4]; // working IJK to background IJK
+  int sameGrid = 0;
+  int backgroundStep = 1;
+  const int *backgroundExtent = NULL;
+  if ( thresholdPaint )
+    {
+    backgroundStep = background->GetNumberOfScalarComponents();
+    backgroundExtent = background->GetExtent();
+    vtkSmartPointer<vtkMatrix4x4> backgroundWorldToIJK = vtkSmartPointer<vtkMatrix4x4>::New();
+    backgroundWorldToIJK->DeepCopy( self->GetBackgroundIJKToWorld() );
+    backgroundWorldToIJK->Invert();
+    vtkSmartPointer<vtkMatrix4x4> workingToWorld = vtkSmartPointer<vtkMatrix4x4>::New();
+    if ( self->GetWorkingIJKToWorld() )
+      {
+      workingToWorld->DeepCopy( self->GetWorkingIJKToWorld() );
+      }
+    vtkSmartPointer<vtkMatrix4x4> workingToBackground = vtkSmartPointer<vtkMatrix4x4>::New();
+    vtkMatrix4x4::Multiply4x4( backgroundWorldToIJK, workingToWorld, workingToBackground );
+    sameGrid = 1;
+    for (int i = 0; i < 3; i++)
+      {
+      for (int j = 0; j < 4; j++)
+        {
+        backgroundMatrix[i][j] = workingToBackground->GetElement(i, j);
+        double identity = (i == j) ? 1. : 0.;
+        if ( fabs(backgroundMatrix[i][j] - identity) > 1e-6 )
+          {
+          sameGrid = 0;
+          }
+        }
+      if ( backgroundExtent[2*i] != workingExtent[2*i] ||
+           backgroundExtent[2*i+1] != workingExtent[2*i+1] )
+        {
+        sameGrid = 0;
+        }
+      }
+    }
+
+  T label = (T) self->GetPaintLabel();
+  int paintOver = self->GetPaintOver();
+  double *thresholdPaintRange = self->GetThresholdPaintRange();
+  double step[3] = { workingMatrix[0][0], workingMatrix[1][0], workingMatrix[2][0] };
+
+  for (int k = box[4]; k <= box[5]; k++)
+    {
+    for (int j = box[2]; j <= box[3]; j++)
+      {
+      // world position of the voxel (0, j, k)
+      double origin[3];
+      for (int i = 0; i < 3; i++)
+        {
+        origin[i] = workingMatrix[i][1] * j + workingMatrix[i][2] * k + workingMatrix[i][3];
+        }
+
+      // the stroke is convex, so the union of the spans of its parts is a span
+      double first = VTK_DOUBLE_MAX, last = -VTK_DOUBLE_MAX;
+      double partFirst, partLast;
+      if ( sphereSpan(origin, step, start, radiusSquared, partFirst, partLast) )
+        {
+        first = std::min(first, partFirst);
+        last = std::max(last, partLast);
+        }
+      if ( length > 0 &&
+           sphereSpan(origin, step, end, radiusSquared, partFirst, partLast) )
+        {
+        first = std::min(first, partFirst);
+        last = std::max(last, partLast);
+        }
+      if ( length > 0 &&
+           cylinderSpan(origin, step, start, axis, length, radiusSquared, partFirst, partLast) )
+        {
+        first = std::min(first, partFirst);
+        last = std::max(last, partLast);
+        }
+      if ( first > last )
+        {
+        continue;
+        }
+      // the voxels strictly inside, within the bounding box
+      int iFirst = box[0];
+      int iLast = box[1];
+      if ( first > iFirst - 1 )
+        {
+        iFirst = static_cast<int>(floor(first)) + 1;
+        }
+      if ( last < iLast + 1 )
+        {
+        iLast = static_cast<int>(ceil(last)) - 1;
+        }
+      if ( iFirst > iLast )
+        {
+        continue;
+        }
+      int count = iLast - iFirst + 1;
+      T *workingPtr = static_cast<T *>(working->GetScalarPointer(iFirst, j, k));
+
+      if ( !thresholdPaint )
+        {
+        vtkImageSlicePaintSpan(workingPtr, count, label, paintOver);
+        }
+      else if ( sameGrid )
+        {
+        B *backgroundPtr = static_cast<B *>(background->GetScalarPointer(iFirst, j, k));
+        vtkImageSlicePaintSpan(workingPtr, backgroundPtr, backgroundStep, count,
+                               label, paintOver,
+                               thresholdPaintRange[0], thresholdPaintRange[1]);
+        }
+      else
+        {
+        for (int i = iFirst; i <= iLast; i++)
+          {
+          int bgIJK[3];
+          for (int n = 0; n < 3; n++)
+            {
+            bgIJK[n] = paintRound( backgroundMatrix[n][0] * i + backgroundMatrix[n][1] * j +
+                                   backgroundMatrix[n][2] * k + backgroundMatrix[n][3] );
+            bgIJK[n] = std::max(backgroundExtent[2*n], std::min(backgroundExtent[2*n+1], bgIJK[n]));
+            }
+          B *backgroundPtr = static_cast<B *>(background->GetScalarPointer(bgIJK));
+          vtkImageSlicePaintSpan(workingPtr + (i - iFirst), backgroundPtr, 1, 1,
+                                 label, paintOver,
+                                 thresholdPaintRange[0], thresholdPaintRange[1]);
+          }
+        }
+      }
+    }
+
+  working->Modified();
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+void vtkImageSlicePaintStroke(vtkImageSlicePaint *self, T *ptr)
+{
+  vtkImageData *background = self->GetBackgroundImage();
+  if ( !self->GetThresholdPaint() || background == NULL )
+    {
+    // the background is not read
+    vtkImageSlicePaintStrokeRows(self, ptr, static_cast<T *>(NULL));
+    return;
+    }
+
+  switch (background->GetScalarType())
+    {
+    vtkTemplateMacro( 
+      vtkImageSlicePaintStrokeRows (self, ptr, static_cast<VTK_TT *>(NULL)) );
+    default: 
+      {
+      vtkErrorWithObjectMacro(self, << "PaintStroke: Unknown background ScalarType\n");
+      return;
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkImageSlicePaint::PaintStroke()
+{
+  void *ptr = NULL;
+  
+  if ( this->GetWorkingImage() == NULL )
+    {
+    vtkErrorMacro (<< "Working image cannot be NULL\n");
+    return;
+    }
+  this->GetWorkingImage()->Update();
+  if ( this->GetThresholdPaint() && this->GetBackgroundImage() )
+    {
+    this->GetBackgroundImage()->Update();
+    }
+
+  switch (this->GetWorkingImage()->GetScalarType())
+    {
+    vtkTemplateMacro( 
+      vtkImageSlicePaintStroke (this, (VTK_TT *)ptr ) );
+    default: 
+      {
+      vtkErrorMacro(<< "Execute: Unknown ScalarType\n");
+      return;
+      }
+    }
+  return;
+}
+
 //----------------------------------------------------------------------------
 void vtkImageSlicePaint::PrintSelf(ostream& os, vtkIndent indent)
 {
@@ -425,6 +793,7 @@ void vtkImageSlicePaint::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "PaintLabel: " << this->GetPaintLabel() << "\n";
   os << indent << "BrushCenter : " << this->BrushCenter[0] << " " << this->BrushCenter[1] << " " << this->BrushCenter[2] << "\n";
   os << indent << "BrushRadius: " << this->GetBrushRadius() << "\n";
+  os << indent << "StrokeStart : " << this->StrokeStart[0] << " " << this->StrokeStart[1] << " " << this->StrokeStart[2] << "\n";
 
   os << indent << "BackgroundImage: " << this->GetBackgroundImage() << "\n";
   os << indent << "WorkingImage: " << this->GetWorkingImage() << "\n";
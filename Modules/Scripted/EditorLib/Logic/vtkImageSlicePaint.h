@@ -38,6 +38,11 @@
 ///   PaintOver : always draw if true, only draw on non-zero Working if false
 ///   ThresholdPaint : Only draw if BackgroundImage is within ThresholdPaint range
 //
+/// PaintStroke() paints in 3D instead: all the voxels of the WorkingImage
+/// closer than BrushRadius to the segment from StrokeStart to BrushCenter
+/// are candidates, following the same rules. The voxels are found as one
+/// span per row of the WorkingImage, so their distance is never computed.
+//
 
 #ifndef __vtkImageSlicePaint_h
 #define __vtkImageSlicePaint_h
@@ -76,6 +81,12 @@ public:
   vtkSetMacro(BrushRadius, double);
   vtkGetMacro(BrushRadius, double);
 
+  /// 
+  /// The start of the segment painted by PaintStroke(), in world space.
+  /// Set it to the BrushCenter to paint a sphere.
+  vtkSetVector3Macro(StrokeStart, double);
+  vtkGetVector3Macro(StrokeStart, double);
+
   /// 
   /// The mask image: used instead of brush if non NULL
   /// - image corresponds to the PaintRegion but is
@@ -138,6 +149,10 @@ public:
   /// 
   /// Apply the paint operation
   void Paint();
+
+  /// 
+  /// Paint the 3D stroke from StrokeStart to BrushCenter
+  void PaintStroke();
  
 protected:
   vtkImageSlicePaint();
@@ -161,6 +176,7 @@ protected:
   double PaintLabel;
   double BrushCenter[3]; /// in World Coordinates
   double BrushRadius;
+  double StrokeStart[3]; /// in World Coordinates
   int ThresholdPaint;
   double ThresholdPaintRange[2];
   int PaintOver;
@@ -17,6 +17,10 @@
 #include "vtkPointData.h"
 #include "vtkObjectFactory.h"
 
+// STD includes
+#include <algorithm>
+#include <cstring>
+
 vtkCxxRevisionMacro(vtkImageStash, "$Revision: 12690 $");
 vtkStandardNewMacro(vtkImageStash);
 
@@ -28,8 +32,14 @@ vtkImageStash::vtkImageStash()
   this->MultiThreader = vtkMultiThreader::New();
   this->Compressor = vtkZLibDataCompressor::New();
   this->CompressionLevel = 1; // corresponds to Z_BEST_SPEED
+  this->CompressionMethod = vtkImageStash::ZLib;
+  this->BlockSize = 1024 * 1024;
   this->Stashing = 0;
   this->StashingThreadID = 0;
+  this->StashedBlockSize = 0;
+  this->ScalarSize = 0;
+  this->VoxelSize = 1;
+  this->ScalarPointer = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -68,6 +78,154 @@ static void *vtkImageStash_ThreadFunction( vtkMultiThreader::ThreadInfo *generic
   return NULL;
 }
 
+//----------------------------------------------------------------------------
+static VTK_THREAD_RETURN_TYPE vtkImageStash_StashBlocks( void *arg )
+{
+  vtkMultiThreader::ThreadInfo *info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  vtkImageStash *self = static_cast<vtkImageStash *>(info->UserData);
+  self->StashBlocks(info->ThreadID, info->NumberOfThreads);
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+static VTK_THREAD_RETURN_TYPE vtkImageStash_UnstashBlocks( void *arg )
+{
+  vtkMultiThreader::ThreadInfo *info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  vtkImageStash *self = static_cast<vtkImageStash *>(info->UserData);
+  self->UnstashBlocks(info->ThreadID, info->NumberOfThreads);
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+// The runs are a 32 bits count followed by the bytes of the voxel.
+// Return false if the runs would be larger than the data.
+static bool vtkImageStash_EncodeRuns(const unsigned char *data, vtkIdType size,
+                                     int voxelSize, std::vector<unsigned char> &runs)
+{
+  runs.clear();
+  runs.reserve(static_cast<size_t>(size));
+  const unsigned int runHeader = sizeof(unsigned int);
+  vtkIdType i = 0;
+  while (i < size)
+    {
+    const unsigned char *voxel = data + i;
+    unsigned int count = 1;
+    i += voxelSize;
+    while (i < size && count < VTK_UNSIGNED_INT_MAX &&
+           memcmp(data + i, voxel, voxelSize) == 0)
+      {
+      ++count;
+      i += voxelSize;
+      }
+    if (static_cast<vtkIdType>(runs.size() + runHeader + voxelSize) >= size)
+      {
+      return false;
+      }
+    size_t end = runs.size();
+    runs.resize(end + runHeader + voxelSize);
+    memcpy(&runs[end], &count, runHeader);
+    memcpy(&runs[end + runHeader], voxel, voxelSize);
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+static void vtkImageStash_DecodeRuns(const unsigned char *runs, vtkIdType runsSize,
+                                     int voxelSize, unsigned char *data, vtkIdType size)
+{
+  const unsigned int runHeader = sizeof(unsigned int);
+  vtkIdType i = 0;
+  for (vtkIdType run = 0; run + runHeader + voxelSize <= runsSize;
+       run += runHeader + voxelSize)
+    {
+    unsigned int count;
+    memcpy(&count, runs + run, runHeader);
+    for (; count > 0 && i + voxelSize <= size; --count, i += voxelSize)
+      {
+      memcpy(data + i, runs + run + runHeader, voxelSize);
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkImageStash::StashBlocks(int threadId, int numberOfThreads)
+{
+  vtkZLibDataCompressor *compressor = 0;
+  if (this->CompressionMethod == vtkImageStash::ZLib)
+    {
+    // zlib streams are not shared between the threads
+    compressor = vtkZLibDataCompressor::New();
+    compressor->SetCompressionLevel(this->GetCompressionLevel());
+    }
+  vtkIdType numberOfBlocks = static_cast<vtkIdType>(this->CompressedBlocks.size());
+  for (vtkIdType block = threadId; block < numberOfBlocks; block += numberOfThreads)
+    {
+    const unsigned char *data = this->ScalarPointer + block * this->StashedBlockSize;
+    vtkIdType size = std::min(this->StashedBlockSize,
+                              this->ScalarSize - block * this->StashedBlockSize);
+    std::vector<unsigned char> &compressed = this->CompressedBlocks[block];
+    bool isCompressed = false;
+    if (compressor)
+      {
+      size_t space = compressor->GetMaximumCompressionSpace(size);
+      compressed.resize(space);
+      size_t compressedSize = compressor->Compress(data, size, &compressed[0], space);
+      isCompressed = compressedSize > 0 &&
+        static_cast<vtkIdType>(compressedSize) < size;
+      compressed.resize(compressedSize);
+      }
+    else
+      {
+      isCompressed = vtkImageStash_EncodeRuns(data, size, this->VoxelSize, compressed);
+      }
+    // blocks that don't compress are stored as is
+    if (!isCompressed)
+      {
+      compressed.assign(data, data + size);
+      }
+    }
+  if (compressor)
+    {
+    compressor->Delete();
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkImageStash::UnstashBlocks(int threadId, int numberOfThreads)
+{
+  vtkZLibDataCompressor *compressor = 0;
+  if (this->CompressionMethod == vtkImageStash::ZLib)
+    {
+    compressor = vtkZLibDataCompressor::New();
+    }
+  unsigned char *stash_p = this->StashedScalars->GetPointer(0);
+  vtkIdType numberOfBlocks = static_cast<vtkIdType>(this->BlockOffsets.size()) - 1;
+  for (vtkIdType block = threadId; block < numberOfBlocks; block += numberOfThreads)
+    {
+    unsigned char *data = this->ScalarPointer + block * this->StashedBlockSize;
+    vtkIdType size = std::min(this->StashedBlockSize,
+                              this->ScalarSize - block * this->StashedBlockSize);
+    const unsigned char *compressed = stash_p + this->BlockOffsets[block];
+    vtkIdType compressedSize = this->BlockOffsets[block + 1] - this->BlockOffsets[block];
+    if (compressedSize == size)
+      {
+      memcpy(data, compressed, size);
+      }
+    else if (compressor)
+      {
+      compressor->Uncompress(compressed, compressedSize, data, size);
+      }
+    else
+      {
+      vtkImageStash_DecodeRuns(compressed, compressedSize, this->VoxelSize, data, size);
+      }
+    }
+  if (compressor)
+    {
+    compressor->Delete();
+    }
+}
+
 //----------------------------------------------------------------------------
 void vtkImageStash::ThreadedStash()
 {
@@ -105,8 +263,49 @@ void vtkImageStash::Stash()
 
   unsigned char *p = static_cast<unsigned char *>(scalars->WriteVoidPointer(0, numPrims));
   this->GetCompressor()->SetCompressionLevel(this->GetCompressionLevel());
-  this->SetStashedScalars(this->GetCompressor()->Compress(p, scalarSize));
-  this->GetStashedScalars()->Delete(); // reference count already set by Compress
+
+  // the blocks are made of whole voxels
+  this->ScalarPointer = p;
+  this->ScalarSize = scalarSize;
+  this->VoxelSize = static_cast<int>(size * scalars->GetNumberOfComponents());
+  this->StashedBlockSize = std::max(static_cast<vtkIdType>(this->VoxelSize),
+    this->BlockSize - this->BlockSize % this->VoxelSize);
+  vtkIdType numberOfBlocks =
+    (scalarSize + this->StashedBlockSize - 1) / this->StashedBlockSize;
+  this->CompressedBlocks.clear();
+  this->CompressedBlocks.resize(numberOfBlocks);
+  if (numberOfBlocks > 1 && this->MultiThreader->GetNumberOfThreads() > 1)
+    {
+    this->MultiThreader->SetSingleMethod(vtkImageStash_StashBlocks, this);
+    this->MultiThreader->SingleMethodExecute();
+    }
+  else
+    {
+    this->StashBlocks(0, 1);
+    }
+
+  // gather the blocks
+  this->BlockOffsets.resize(numberOfBlocks + 1);
+  this->BlockOffsets[0] = 0;
+  for (vtkIdType block = 0; block < numberOfBlocks; ++block)
+    {
+    this->BlockOffsets[block + 1] = this->BlockOffsets[block] +
+      static_cast<vtkIdType>(this->CompressedBlocks[block].size());
+    }
+  vtkUnsignedCharArray *stashedScalars = vtkUnsignedCharArray::New();
+  stashedScalars->SetNumberOfTuples(this->BlockOffsets[numberOfBlocks]);
+  for (vtkIdType block = 0; block < numberOfBlocks; ++block)
+    {
+    if (!this->CompressedBlocks[block].empty())
+      {
+      memcpy(stashedScalars->GetPointer(this->BlockOffsets[block]),
+             &this->CompressedBlocks[block][0], this->CompressedBlocks[block].size());
+      }
+    }
+  this->CompressedBlocks.clear();
+  this->ScalarPointer = 0;
+  this->SetStashedScalars(stashedScalars);
+  stashedScalars->Delete();
 
   // this will realloc a zero sized buffer
   scalars->SetNumberOfTuples(0);
@@ -155,12 +354,27 @@ void vtkImageStash::Unstash()
   // setting the number of tuples reallocates the right amount of data
   // so we can uncompress directly into the buffer
   scalars->SetNumberOfTuples(this->GetNumberOfTuples());
-  vtkIdType stashedSize = this->StashedScalars->GetNumberOfTuples();
   unsigned char *scalar_p = 
       static_cast<unsigned char *>(scalars->WriteVoidPointer(0, numPrims));
-  unsigned char *stash_p = 
-      static_cast<unsigned char *>(this->StashedScalars->WriteVoidPointer(0, stashedSize));
-  this->GetCompressor()->Uncompress(stash_p, stashedSize, scalar_p, scalarSize);
+  if (scalarSize != this->ScalarSize)
+    {
+    vtkErrorMacro ("Cannot unstash - the scalars changed since they were stashed");
+    return;
+    }
+
+  // the blocks are decompressed in parallel
+  this->ScalarPointer = scalar_p;
+  vtkIdType numberOfBlocks = static_cast<vtkIdType>(this->BlockOffsets.size()) - 1;
+  if (numberOfBlocks > 1 && this->MultiThreader->GetNumberOfThreads() > 1)
+    {
+    this->MultiThreader->SetSingleMethod(vtkImageStash_UnstashBlocks, this);
+    this->MultiThreader->SingleMethodExecute();
+    }
+  else
+    {
+    this->UnstashBlocks(0, 1);
+    }
+  this->ScalarPointer = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -173,6 +387,8 @@ void vtkImageStash::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Stashed Scalars: " << this->GetStashedScalars() << "\n";
   if ( this->GetStashedScalars()) this->GetStashedScalars()->PrintSelf(os,indent.GetNextIndent());
   os << indent << "CompressionLevel: " << this->GetCompressionLevel() << "\n";
+  os << indent << "CompressionMethod: " << this->GetCompressionMethod() << "\n";
+  os << indent << "BlockSize: " << this->GetBlockSize() << "\n";
   os << indent << "Compressor: \n";
   this->GetCompressor()->PrintSelf(os,indent.GetNextIndent());
 }
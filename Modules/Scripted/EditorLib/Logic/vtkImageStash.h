@@ -14,6 +14,10 @@
 =========================================================================*/
 ///  vtkImageStash - 
 ///  Store an image data in a compressed form to save memory
+///
+///  The scalars are split into blocks of BlockSize bytes that are
+///  compressed and decompressed independently by the threads of the
+///  MultiThreader.
 
 #ifndef __vtkImageStash_h
 #define __vtkImageStash_h
@@ -26,6 +30,9 @@
 #include <vtkUnsignedCharArray.h>
 #include <vtkZLibDataCompressor.h>
 
+// STD includes
+#include <vector>
+
 class VTK_SLICER_EDITORLIB_MODULE_LOGIC_EXPORT vtkImageStash : public vtkObject
 {
 public:
@@ -45,7 +52,7 @@ public:
 
   /// 
   /// The stashed scalars:
-  /// this is the zlib compressed image scalar data
+  /// this is the compressed image scalar data, block after block
   vtkSetObjectMacro(StashedScalars, vtkUnsignedCharArray);
   vtkGetObjectMacro(StashedScalars, vtkUnsignedCharArray);
 
@@ -81,6 +88,33 @@ public:
   vtkSetObjectMacro(Compressor, vtkZLibDataCompressor);
   vtkGetObjectMacro(Compressor, vtkZLibDataCompressor);
 
+  enum CompressionMethods
+    {
+    ZLib = 0,
+    RunLength
+    };
+
+  // Description:
+  // Get/Set the codec of the blocks: ZLib (default) or RunLength.
+  // RunLength encodes the runs of identical voxels, it is much faster
+  // than ZLib and well suited for label maps.
+  vtkSetClampMacro(CompressionMethod, int, ZLib, RunLength);
+  vtkGetMacro(CompressionMethod, int);
+  void SetCompressionMethodToZLib() {this->SetCompressionMethod(ZLib);}
+  void SetCompressionMethodToRunLength() {this->SetCompressionMethod(RunLength);}
+
+  // Description:
+  // Get/Set the size in bytes of the blocks compressed
+  // independently, 1MB by default.
+  vtkSetClampMacro(BlockSize, vtkIdType, 1, VTK_LARGE_ID);
+  vtkGetMacro(BlockSize, vtkIdType);
+
+  // Description:
+  // Compress or decompress the blocks assigned to a thread,
+  // called by the threads of the MultiThreader.
+  void StashBlocks(int threadId, int numberOfThreads);
+  void UnstashBlocks(int threadId, int numberOfThreads);
+
   // Description:
   // Check if compression thread is finished
   vtkSetMacro(Stashing, int);
@@ -96,8 +130,22 @@ protected:
   vtkIdType NumberOfTuples;
   vtkZLibDataCompressor *Compressor;
   int CompressionLevel;
+  int CompressionMethod;
+  vtkIdType BlockSize;
   int Stashing;
 
+  /// Size in bytes of the uncompressed blocks, the last one can be smaller
+  vtkIdType StashedBlockSize;
+  vtkIdType ScalarSize;
+  /// Size in bytes of a voxel, the runs are made of voxels
+  int VoxelSize;
+  /// Data of the blocks while they are compressed
+  std::vector< std::vector<unsigned char> > CompressedBlocks;
+  /// Offsets of the blocks in StashedScalars, followed by its size
+  std::vector<vtkIdType> BlockOffsets;
+  /// Pointer to the scalars being compressed or decompressed
+  unsigned char* ScalarPointer;
+
 private:
   int StashingThreadID;
 
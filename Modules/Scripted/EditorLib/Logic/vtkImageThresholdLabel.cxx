@@ -0,0 +1,252 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+#include "vtkImageThresholdLabel.h"
+
+// VTK includes
+#include <vtkDataSetAttributes.h>
+#include <vtkImageData.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkObjectFactory.h>
+
+//----------------------------------------------------------------------------
+vtkCxxRevisionMacro(vtkImageThresholdLabel, "$Revision$");
+vtkStandardNewMacro(vtkImageThresholdLabel);
+
+//----------------------------------------------------------------------------
+vtkImageThresholdLabel::vtkImageThresholdLabel()
+{
+  this->LowerThreshold = 0.;
+  this->UpperThreshold = 0.;
+  this->InValue = 1.;
+  this->OutValue = 0.;
+  this->OutputScalarType = -1;
+  this->Preview = 0;
+  for (int i = 0; i < 4; ++i)
+    {
+    this->PreviewColor[i] = 1.;
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkImageThresholdLabel::ThresholdBetween(double lower, double upper)
+{
+  if (this->LowerThreshold != lower || this->UpperThreshold != upper)
+    {
+    this->LowerThreshold = lower;
+    this->UpperThreshold = upper;
+    this->Modified();
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkImageThresholdLabel::RequestInformation(
+  vtkInformation *vtkNotUsed(request),
+  vtkInformationVector **inputVector,
+  vtkInformationVector *outputVector)
+{
+  vtkInformation *outInfo = outputVector->GetInformationObject(0);
+  vtkInformation *inInfo = inputVector[0]->GetInformationObject(0);
+
+  if (this->Preview)
+    {
+    vtkDataObject::SetPointDataActiveScalarInfo(outInfo, VTK_UNSIGNED_CHAR, 4);
+    return 1;
+    }
+
+  int scalarType = this->OutputScalarType;
+  if (scalarType == -1)
+    {
+    vtkInformation *inScalarInfo = vtkDataObject::GetActiveFieldInformation(
+      inInfo, vtkDataObject::FIELD_ASSOCIATION_POINTS,
+      vtkDataSetAttributes::SCALARS);
+    scalarType = inScalarInfo ?
+      inScalarInfo->Get(vtkDataObject::FIELD_ARRAY_TYPE()) : VTK_SHORT;
+    }
+  vtkDataObject::SetPointDataActiveScalarInfo(outInfo, scalarType, 1);
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+// Call the pixel operation on each pixel of the extent, with the progress
+// reported by the first thread.
+template <class IT, class OT, class PixelOperation>
+void vtkImageThresholdLabelLoop(vtkImageThresholdLabel *self,
+                                vtkImageData *inData, IT *inPtr,
+                                vtkImageData *outData, OT *outPtr,
+                                int outExt[6], int id,
+                                const PixelOperation& operation)
+{
+  vtkIdType inIncX, inIncY, inIncZ;
+  vtkIdType outIncX, outIncY, outIncZ;
+  inData->GetContinuousIncrements(outExt, inIncX, inIncY, inIncZ);
+  outData->GetContinuousIncrements(outExt, outIncX, outIncY, outIncZ);
+  inIncX = inData->GetNumberOfScalarComponents();
+  outIncX = outData->GetNumberOfScalarComponents();
+
+  double lower = self->GetLowerThreshold();
+  double upper = self->GetUpperThreshold();
+
+  int maxY = outExt[3] - outExt[2];
+  int maxZ = outExt[5] - outExt[4];
+  unsigned long count = 0;
+  unsigned long target = (unsigned long)((maxZ+1)*(maxY+1)/50.0);
+  target++;
+
+  for (int idxZ = 0; idxZ <= maxZ && !self->GetAbortExecute(); idxZ++)
+    {
+    for (int idxY = 0; idxY <= maxY && !self->GetAbortExecute(); idxY++)
+      {
+      if (!id)
+        {
+        if (!(count%target))
+          {
+          self->UpdateProgress(count/(50.0*target));
+          }
+        count++;
+        }
+      for (int idxX = outExt[0]; idxX <= outExt[1]; idxX++)
+        {
+        double value = static_cast<double>(*inPtr);
+        operation(value >= lower && value <= upper, outPtr);
+        inPtr += inIncX;
+        outPtr += outIncX;
+        }
+      inPtr += inIncY;
+      outPtr += outIncY;
+      }
+    inPtr += inIncZ;
+    outPtr += outIncZ;
+    }
+}
+
+//----------------------------------------------------------------------------
+template <class OT>
+class vtkImageThresholdLabelSetLabel
+{
+public:
+  OT InValue, OutValue;
+  void operator()(bool inside, OT *outPtr) const
+    {
+    *outPtr = inside ? this->InValue : this->OutValue;
+    }
+};
+
+class vtkImageThresholdLabelSetColor
+{
+public:
+  unsigned char InColor[4];
+  void operator()(bool inside, unsigned char *outPtr) const
+    {
+    if (inside)
+      {
+      outPtr[0] = this->InColor[0];
+      outPtr[1] = this->InColor[1];
+      outPtr[2] = this->InColor[2];
+      outPtr[3] = this->InColor[3];
+      }
+    else
+      {
+      outPtr[0] = outPtr[1] = outPtr[2] = outPtr[3] = 0;
+      }
+    }
+};
+
+//----------------------------------------------------------------------------
+template <class IT, class OT>
+void vtkImageThresholdLabelExecuteLabel(vtkImageThresholdLabel *self,
+                                        vtkImageData *inData, IT *inPtr,
+                                        vtkImageData *outData, OT *outPtr,
+                                        int outExt[6], int id)
+{
+  vtkImageThresholdLabelSetLabel<OT> operation;
+  operation.InValue = static_cast<OT>(self->GetInValue());
+  operation.OutValue = static_cast<OT>(self->GetOutValue());
+  vtkImageThresholdLabelLoop(self, inData, inPtr, outData, outPtr,
+                             outExt, id, operation);
+}
+
+//----------------------------------------------------------------------------
+template <class IT>
+void vtkImageThresholdLabelExecute(vtkImageThresholdLabel *self,
+                                   vtkImageData *inData, IT *inPtr,
+                                   vtkImageData *outData, int outExt[6], int id)
+{
+  void *outPtr = outData->GetScalarPointerForExtent(outExt);
+
+  if (self->GetPreview())
+    {
+    vtkImageThresholdLabelSetColor operation;
+    double *color = self->GetPreviewColor();
+    for (int i = 0; i < 4; ++i)
+      {
+      double c = color[i] < 0. ? 0. : (color[i] > 1. ? 1. : color[i]);
+      operation.InColor[i] = static_cast<unsigned char>(c * 255. + 0.5);
+      }
+    vtkImageThresholdLabelLoop(self, inData, inPtr, outData,
+                               static_cast<unsigned char*>(outPtr),
+                               outExt, id, operation);
+    return;
+    }
+
+  switch (outData->GetScalarType())
+    {
+    vtkTemplateMacro(
+      vtkImageThresholdLabelExecuteLabel(self, inData, inPtr, outData,
+        static_cast<VTK_TT*>(outPtr), outExt, id));
+    default:
+      vtkGenericWarningMacro("Execute: Unknown output ScalarType");
+      return;
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkImageThresholdLabel::ThreadedRequestData(
+  vtkInformation *vtkNotUsed(request),
+  vtkInformationVector **vtkNotUsed(inputVector),
+  vtkInformationVector *vtkNotUsed(outputVector),
+  vtkImageData ***inData,
+  vtkImageData **outData,
+  int outExt[6], int id)
+{
+  vtkImageData* input = inData[0][0];
+  if (this->Preview && (outData[0]->GetScalarType() != VTK_UNSIGNED_CHAR ||
+                        outData[0]->GetNumberOfScalarComponents() != 4))
+    {
+    vtkErrorMacro("Execute: preview output must be RGBA unsigned char");
+    return;
+    }
+  void* inPtr = input->GetScalarPointerForExtent(outExt);
+
+  switch (input->GetScalarType())
+    {
+    vtkTemplateMacro(
+      vtkImageThresholdLabelExecute(this, input, static_cast<VTK_TT*>(inPtr),
+        outData[0], outExt, id));
+    default:
+      vtkErrorMacro("Execute: Unknown input ScalarType");
+      return;
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkImageThresholdLabel::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+
+  os << indent << "LowerThreshold: " << this->LowerThreshold << "\n";
+  os << indent << "UpperThreshold: " << this->UpperThreshold << "\n";
+  os << indent << "InValue: " << this->InValue << "\n";
+  os << indent << "OutValue: " << this->OutValue << "\n";
+  os << indent << "OutputScalarType: " << this->OutputScalarType << "\n";
+  os << indent << "Preview: " << this->Preview << "\n";
+  os << indent << "PreviewColor: " << this->PreviewColor[0] << " "
+     << this->PreviewColor[1] << " " << this->PreviewColor[2] << " "
+     << this->PreviewColor[3] << "\n";
+}
@@ -0,0 +1,97 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+///  vtkImageThresholdLabel -  Label the pixels of an image within a range
+///
+/// Pixels whose value is within [LowerThreshold, UpperThreshold] are set
+/// to InValue, the others to OutValue. Only the first component of the
+/// input is thresholded. The execution is threaded over the output rows,
+/// reports its progress and stops as soon as AbortExecute is set, so that
+/// labeling a whole volume can be canceled.
+///
+/// With Preview on, the output is an unsigned char RGBA image of
+/// PreviewColor inside the range and transparent outside, that a
+/// vtkImageMapper displays as is: there is no intermediate label image
+/// nor lookup table pass. It is meant to be run on the resliced
+/// background of a slice view (vtkMRMLSliceLayerLogic::GetReslice()), so
+/// that the preview does not reslice the volume again.
+
+#ifndef __vtkImageThresholdLabel_h
+#define __vtkImageThresholdLabel_h
+
+#include "vtkSlicerEditorLibModuleLogicExport.h"
+
+// VTK includes
+#include <vtkThreadedImageAlgorithm.h>
+
+class VTK_SLICER_EDITORLIB_MODULE_LOGIC_EXPORT vtkImageThresholdLabel : public vtkThreadedImageAlgorithm
+{
+public:
+  static vtkImageThresholdLabel *New();
+  vtkTypeRevisionMacro(vtkImageThresholdLabel,vtkThreadedImageAlgorithm);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  ///
+  /// Range of the input values that are labeled (bounds included)
+  vtkSetMacro(LowerThreshold, double);
+  vtkGetMacro(LowerThreshold, double);
+  vtkSetMacro(UpperThreshold, double);
+  vtkGetMacro(UpperThreshold, double);
+  void ThresholdBetween(double lower, double upper);
+
+  ///
+  /// Output values inside and outside the range, 1 and 0 by default
+  vtkSetMacro(InValue, double);
+  vtkGetMacro(InValue, double);
+  vtkSetMacro(OutValue, double);
+  vtkGetMacro(OutValue, double);
+
+  ///
+  /// Scalar type of the label output, -1 (default) for the input type
+  vtkSetMacro(OutputScalarType, int);
+  vtkGetMacro(OutputScalarType, int);
+
+  ///
+  /// Output the RGBA preview instead of the labels, off by default
+  vtkSetMacro(Preview, int);
+  vtkGetMacro(Preview, int);
+  vtkBooleanMacro(Preview, int);
+
+  ///
+  /// RGBA color (0 to 1) of the preview inside the range, opaque white
+  /// by default
+  vtkSetVector4Macro(PreviewColor, double);
+  vtkGetVector4Macro(PreviewColor, double);
+
+protected:
+  vtkImageThresholdLabel();
+  ~vtkImageThresholdLabel() {};
+
+  virtual int RequestInformation(vtkInformation *, vtkInformationVector **,
+                                 vtkInformationVector *);
+  virtual void ThreadedRequestData(vtkInformation *request,
+                                   vtkInformationVector **inputVector,
+                                   vtkInformationVector *outputVector,
+                                   vtkImageData ***inData,
+                                   vtkImageData **outData,
+                                   int outExt[6], int id);
+
+  double LowerThreshold;
+  double UpperThreshold;
+  double InValue;
+  double OutValue;
+  int OutputScalarType;
+  int Preview;
+  double PreviewColor[4];
+
+private:
+  vtkImageThresholdLabel(const vtkImageThresholdLabel&);  /// Not implemented.
+  void operator=(const vtkImageThresholdLabel&);  /// Not implemented.
+};
+
+#endif
@@ -102,15 +102,15 @@ void vtkPichonFastMarching::setSeed( int index )
       return;
     }
 
-  if( node[index].status!=fmsFAR )
+  if( nodeStatus[index]!=fmsFAR )
     {
       // this seed has already been planted
       return;
     }
 
   // by definition, T=0, and that voxel is known
-  node[index].T=0.0;
-  node[index].status=fmsKNOWN;
+  nodeT[index]=0.0;
+  nodeStatus[index]=fmsKNOWN;
 
   knownPoints.push_back(index);
 
@@ -119,10 +119,10 @@ void vtkPichonFastMarching::setSeed( int index )
     {
       FMleaf f;
       f.nodeIndex=index + shiftNeighbor(n);
-      if( node[ f.nodeIndex ].status==fmsFAR )
+      if( nodeStatus[ f.nodeIndex ]==fmsFAR )
     {
-      node[f.nodeIndex].status=fmsTRIAL;
-      node[f.nodeIndex].T = (float) ( distanceNeighbor(n) / speed(f.nodeIndex) );
+      nodeStatus[f.nodeIndex]=fmsTRIAL;
+      nodeT[f.nodeIndex] = (float) ( distanceNeighbor(n) / speed(f.nodeIndex) );
       
       insert( f ); // insert in minheap
     }
@@ -180,8 +180,8 @@ void vtkPichonFastMarching::initNewExpansion( void )
   // empty interface points
   while(tree.size()>0)
     {
-      node[ tree[tree.size()-1].nodeIndex ].status=fmsFAR; 
-      node[ tree[tree.size()-1].nodeIndex ].T=(float)INF; 
+      nodeStatus[ tree[tree.size()-1].nodeIndex ]=fmsFAR; 
+      nodeT[ tree[tree.size()-1].nodeIndex ]=(float)INF; 
       tree.pop_back();
     }
 
@@ -202,7 +202,7 @@ void vtkPichonFastMarching::initNewExpansion( void )
     for(int j=0;j<dimY;j++)
       for(int i=0;i<dimX;i++)
     {
-      if( (outdata[index]==label) && (node[index].status!=fmsOUT) )
+      if( (outdata[index]==label) && (nodeStatus[index]!=fmsOUT) )
         {
             collectInfoSeed( index );
             for(int n=1;n<nNeighbors;n++)
@@ -222,13 +222,13 @@ void vtkPichonFastMarching::initNewExpansion( void )
 
           if(hasIntensityZeroNeighbor)
         {
-          node[index].status=fmsFAR;
+          nodeStatus[index]=fmsFAR;
           seedPoints.push_back( index );
         }
           else
         {
-          node[index].status=fmsDONE;
-          node[index].T=0.0;
+          nodeStatus[index]=fmsDONE;
+          nodeT[index]=0.0;
         }
 */
 
@@ -279,12 +279,12 @@ void vtkPichonFastMarchingExecute(vtkPichonFastMarching *self,
         for(int i=0;i<self->dimX;i++)
           {
 
-          self->node[index].T=(float)INF;
+          self->nodeT[index]=(float)INF;
 
           if(self->outdata[index]==0)
-            self->node[index].status=fmsFAR;
+            self->nodeStatus[index]=fmsFAR;
           else 
-            self->node[index].status=fmsDONE;
+            self->nodeStatus[index]=fmsDONE;
 
           self->inhomo[index]=-1; // meaning inhomo and median have not been computed there
 
@@ -301,7 +301,7 @@ void vtkPichonFastMarchingExecute(vtkPichonFastMarching *self,
               self->UpdateProgress(float(currentPercentage)/float(GRANULARITY_PROGRESS));
               }
 
-            self->node[index].status=fmsOUT;
+            self->nodeStatus[index]=fmsOUT;
 
             // we should never have to look at these values anyway !
             self->inhomo[ index ] = self->depth;
@@ -346,8 +346,8 @@ void vtkPichonFastMarchingExecute(vtkPichonFastMarching *self,
       for(k=self->nPointsBeforeLeakEvolution;k<(int)self->knownPoints.size();k++)
         {
         int index = self->knownPoints[k];
-        self->node[ index ].status = fmsFAR;
-        self->node[ index ].T = (float)INF;
+        self->nodeStatus[ index ] = fmsFAR;
+        self->nodeT[ index ] = (float)INF;
 
         /* 
            we also want to remove the neighbors of these points that would be in TRIAL
@@ -358,10 +358,10 @@ void vtkPichonFastMarchingExecute(vtkPichonFastMarching *self,
         for(n=1;n<=self->nNeighbors;n++)
           {
           int indexN=index+self->shiftNeighbor(n);
-          if( self->node[indexN].status==fmsTRIAL )
+          if( self->nodeStatus[indexN]==fmsTRIAL )
             {
-            self->node[indexN].T=(float)INF;
-            self->downTree( self->node[indexN].leafIndex );
+            self->nodeT[indexN]=(float)INF;
+            self->downTree( self->nodeLeafIndex[indexN] );
             }
           }
         }
@@ -376,16 +376,16 @@ void vtkPichonFastMarchingExecute(vtkPichonFastMarching *self,
         for(n=1;n<=self->nNeighbors;n++)
           {
           indexN=index+self->shiftNeighbor(n);
-          if( self->node[indexN].status==fmsKNOWN )
+          if( self->nodeStatus[indexN]==fmsKNOWN )
             hasKnownNeighbor=true;
           }
 
-        if( (hasKnownNeighbor) && (self->node[index].status!=fmsOUT) )
+        if( (hasKnownNeighbor) && (self->nodeStatus[index]!=fmsOUT) )
           {
           FMleaf f;
 
-          self->node[index].T=self->computeT(index);
-          self->node[index].status=fmsTRIAL;        
+          self->nodeT[index]=self->computeT(index);
+          self->nodeStatus[index]=fmsTRIAL;        
           f.nodeIndex=index;
 
           self->insert( f );
@@ -419,11 +419,24 @@ void vtkPichonFastMarchingExecute(vtkPichonFastMarching *self,
   self->pdfIntensityIn->setUpdateRate(self->nPointsEvolution/100);
   self->pdfInhomoIn->setUpdateRate(self->nPointsEvolution/100);
 
-  for(n=0;n<self->nPointsEvolution;n++)
+  int previewStep = self->nPointsEvolution/GRANULARITY_PROGRESS;
+  if( previewStep<1 )
+    previewStep=1;
+
+  self->AbortExecute = 0;
+  for(n=0;n<self->nPointsEvolution && !self->AbortExecute;n++)
     {
     if( (n*GRANULARITY_PROGRESS) % self->nPointsEvolution == 0 )
       self->UpdateProgress(float(n)/float(self->nPointsEvolution));
 
+    if( self->preview && n>0 && (n%previewStep)==0 )
+      {
+      // write the points known so far, the observers can look
+      // at the output and stop the evolution if it looks right
+      self->show(1.0);
+      self->InvokeEvent(vtkPichonFastMarching::FrontEvent);
+      }
+
     float T=self->step();
 
     // all the statistics should be gathered from a band 3 pixels from the interface
@@ -471,14 +484,14 @@ void vtkPichonFastMarching::show(float r)
   if( newIndex > oldIndex )
     for(int index=(oldIndex+1);index<=newIndex;index++)
       {
-    if( node[ knownPoints[index] ].status==fmsKNOWN )
+    if( nodeStatus[ knownPoints[index] ]==fmsKNOWN )
         if(outdata[ knownPoints[index] ]==0)
           outdata[ knownPoints[index] ]=label;
       }
   else if( newIndex < oldIndex )
     for(int index=oldIndex;index>newIndex;index--)
       {
-    if(node[ knownPoints[index] ].status==fmsKNOWN )
+    if(nodeStatus[ knownPoints[index] ]==fmsKNOWN )
         if(outdata[ knownPoints[index] ]==label)
           outdata[ knownPoints[index] ]=0;
       }
@@ -541,6 +554,11 @@ void vtkPichonFastMarching::setNPointsEvolution( int n )
   nPointsEvolution=n;
 }
 
+void vtkPichonFastMarching::setPreview( int _preview )
+{
+  this->preview=_preview;
+}
+
 void vtkPichonFastMarching::PrintSelf(ostream& os, vtkIndent indent)
 {
   vtkImageToImageFilter::PrintSelf(os,indent);
@@ -561,7 +579,7 @@ void vtkPichonFastMarching::insert(const FMleaf leaf) {
 
   // insert element at the back
   tree.push_back( leaf );
-  node[ leaf.nodeIndex ].leafIndex=(int)(tree.size()-1);
+  nodeLeafIndex[ leaf.nodeIndex ]=(int)(tree.size()-1);
 
   // trickle the element up until everything 
   // is sorted again
@@ -573,27 +591,33 @@ bool vtkPichonFastMarching::minHeapIsSorted( void )
   int N=(int)tree.size();
   int k;
 
-  for(k=(N-1);k>=1;k--)
+  for(k=(N-1);k>=0;k--)
     {
-      if(node[tree[k].nodeIndex].leafIndex!=k)
+      if(nodeLeafIndex[tree[k].nodeIndex]!=k)
     {
       vtkErrorMacro( "Error in vtkPichonFastMarching::minHeapIsSorted(): "
              << "tree[" << k << "] : pb leafIndex/nodeIndex (size=" 
              << (unsigned int)tree.size() << ")" );
+    }
+      if(tree[k].T!=nodeT[tree[k].nodeIndex])
+    {
+      vtkErrorMacro( "Error in vtkPichonFastMarching::minHeapIsSorted(): "
+             << "tree[" << k << "] : pb T of the leaf/T of the node (size=" 
+             << (unsigned int)tree.size() << ")" );
     }
     }
   for(k=(N-1);k>=1;k--)
     {
-      if( finite( node[tree[k].nodeIndex].T)==0 )
+      if( finite( tree[k].T)==0 )
     vtkErrorMacro( "Error in vtkPichonFastMarching::minHeapIsSorted(): "
-               << "NaN or Inf value in minHeap : " << node[tree[k].nodeIndex].T );
+               << "NaN or Inf value in minHeap : " << tree[k].T );
 
-      if( node[tree[k].nodeIndex].T<node[ (int)(tree[(k-1)/2].nodeIndex) ].T )
+      if( tree[k].T<tree[(k-1)/HEAP_ARITY].T )
     {
       vtkErrorMacro( "Error in vtkPichonFastMarching::minHeapIsSorted(): "
              << "minHeapIsSorted is false! : size=" << (unsigned int)tree.size() << "at leafIndex=" << k 
-             << " node[tree[k].nodeIndex].T=" << node[tree[k].nodeIndex].T
-             << "<node[ (int)(tree[(k-1)/2].nodeIndex) ].T=" << node[ (int)(tree[(k-1)/2].nodeIndex) ].T);
+             << " tree[k].T=" << tree[k].T
+             << "<tree[(k-1)/HEAP_ARITY].T=" << tree[(k-1)/HEAP_ARITY].T);
 
       return false;
     }
@@ -604,93 +628,77 @@ bool vtkPichonFastMarching::minHeapIsSorted( void )
 void vtkPichonFastMarching::downTree(int index) {
   /*
    * This routine sweeps downward from leaf 'index',
-   * swapping child and parent if the value of the child
-   * is smaller than that of the parent. Note that this only
+   * moving up the child with the smallest value while it is
+   * smaller than the value of the leaf. Note that this only
    * guarantees the heap property if the value at the
    * starting index is greater than all its parents.
+   * The leaf is only written once its place is found.
    */
-  int LeftChild = 2 * index + 1;
-  int RightChild = 2 * index + 2;
+  FMleaf leaf=tree[index];
+  // the T of the node may have changed since the leaf was sorted
+  leaf.T=nodeT[leaf.nodeIndex];
+
+  int N=(int)tree.size();
+  int FirstChild = HEAP_ARITY * index + 1;
   
-  while (LeftChild < (int)tree.size())
+  while (FirstChild < N)
     {
-      /*
-       * Terminate the process when the current leaf has no
-       * children. If no swap occurs at a higher leaf, this
-       * condition is forced.
-       */
-
       /* 
-       * Find the child with the smallest value. The node has at least
-       * one child, and so has at least a left child.
-       */
-      int MinChild = LeftChild;
-
-      /*
-       * If the node has a right child, and if the right child
-       * has smaller crossing time than the left child, then the 
-       * right child is the MinChild.
+       * Find the child with the smallest value. The leaf has at least
+       * one child, the children of a leaf are contiguous in the tree.
        */
-      if (RightChild < (int)tree.size()) {
-    
-    if (node[tree[LeftChild].nodeIndex].T>
-        node[tree[RightChild].nodeIndex].T) 
-      MinChild = RightChild;
-      }
+      int MinChild = FirstChild;
+      int LastChild = FirstChild + HEAP_ARITY;
+      if (LastChild > N)
+    LastChild = N;
+      for(int child=FirstChild+1;child<LastChild;child++)
+    if (tree[child].T<tree[MinChild].T)
+      MinChild = child;
     
       /*
-       * If the MinChild has smaller T than the current leaf,
-       * swap them, and move the current leaf to the MinChild.
+       * If the MinChild has smaller T than the leaf, move it up 
+       * and go on from the place it left.
        */
-      if (node[tree[MinChild].nodeIndex].T<
-      node[tree[index].nodeIndex].T)
+      if (tree[MinChild].T<leaf.T)
     {
-      FMleaf tmp=tree[index];
       tree[index]=tree[MinChild];
-      tree[MinChild]=tmp;
-
-      // make sure pointers remain correct
-      node[ tree[MinChild].nodeIndex ].leafIndex = MinChild;
-      node[ tree[index].nodeIndex ].leafIndex = index;
+      nodeLeafIndex[ tree[index].nodeIndex ] = index;
       
       index = MinChild;
-     
-      LeftChild = 2 * index + 1;
-      RightChild =  LeftChild + 1;
+      FirstChild = HEAP_ARITY * index + 1;
     }
       else
     /*
-     * If the current leaf has a lower value than its
+     * If the leaf has a lower value than its
      * MinChild, the job is done, force a stop.
      */
     break;
     } 
+
+  tree[index]=leaf;
+  nodeLeafIndex[ leaf.nodeIndex ] = index;
 }
 
 void vtkPichonFastMarching::upTree(int index) {
   /*
    * This routine sweeps upward from leaf 'index',
-   * swapping child and parent if the value of the child
-   * is less than that of the parent. Note that this only
+   * moving down the parents while the value of the leaf
+   * is less than theirs. Note that this only
    * guarantees the heap property if the value at the
    * starting leaf is less than all its children.
    */
+  FMleaf leaf=tree[index];
+  // the T of the node may have changed since the leaf was sorted
+  leaf.T=nodeT[leaf.nodeIndex];
+
   while( index>0 )
     {
-      int upIndex = (int) (index-1)/2;
+      int upIndex = (index-1)/HEAP_ARITY;
 
-      if( node[tree[index].nodeIndex].T < 
-      node[tree[upIndex].nodeIndex].T )
+      if( leaf.T < tree[upIndex].T )
     {
-      // then swap the 2 nodes
-
-      FMleaf tmp=tree[index];
       tree[index]=tree[upIndex];
-      tree[upIndex]=tmp;
-
-      // make sure pointers remain correct
-      node[ tree[upIndex].nodeIndex ].leafIndex = upIndex;
-      node[ tree[index].nodeIndex ].leafIndex = index;
+      nodeLeafIndex[ tree[index].nodeIndex ] = index;
     
       index = upIndex;
     }
@@ -699,6 +707,9 @@ void vtkPichonFastMarching::upTree(int index) {
     // force stop
     break;
     }
+
+  tree[index]=leaf;
+  nodeLeafIndex[ leaf.nodeIndex ] = index;
 }
 
 FMleaf vtkPichonFastMarching::removeSmallest( void ) {
@@ -709,16 +720,20 @@ FMleaf vtkPichonFastMarching::removeSmallest( void ) {
   /*
    * Now move the bottom, rightmost, leaf to the root.
    */
-  tree[0]=tree[ tree.size()-1 ];
+  FMleaf last=tree[ tree.size()-1 ];
+  tree.pop_back();
 
-  // make sure pointers remain correct
-  node[ tree[0].nodeIndex ].leafIndex = 0;
+  if( tree.size()>0 )
+    {
+      tree[0]=last;
 
-  tree.pop_back();
+      // make sure pointers remain correct
+      nodeLeafIndex[ tree[0].nodeIndex ] = 0;
 
-  // trickle the element down until everything 
-  // is sorted again
-  downTree( 0 );
+      // trickle the element down until everything 
+      // is sorted again
+      downTree( 0 );
+    }
 
   return f;
 }
@@ -730,6 +745,7 @@ vtkPichonFastMarching::vtkPichonFastMarching()
 { 
   initialized=false; 
   somethingReallyWrong=true;
+  preview=0;
 }
 
 void vtkPichonFastMarching::init(int _dimX, int _dimY, int _dimZ, double _depth, double _dx, double _dy, double _dz)
@@ -816,9 +832,11 @@ void vtkPichonFastMarching::init(int _dimX, int _dimY, int _dimZ, double _depth,
 
   this->depth = (int) _depth;
 
-  node = new FMnode[ dimX*dimY*dimZ ];
+  nodeT = new float[ dimX*dimY*dimZ ];
+  nodeStatus = new unsigned char[ dimX*dimY*dimZ ];
+  nodeLeafIndex = new int[ dimX*dimY*dimZ ];
   // assert( node!=NULL );
-  if(!(node!=NULL))
+  if(!(nodeT!=NULL && nodeStatus!=NULL && nodeLeafIndex!=NULL))
     {
       vtkErrorMacro("Error in void vtkPichonFastMarching::init(), not enough memory for allocation of 'node'");
       return;
@@ -903,9 +921,9 @@ int vtkPichonFastMarching::indexFather(int n )
   for(int k=1;k<=6;k++)
   {
     index = n+shiftNeighbor(k);
-    if( node[index].T<Tmin )
+    if( nodeT[index]<Tmin )
     {
-      Tmin = node[index].T;
+      Tmin = nodeT[index];
       indexMin = index;
     }
   }
@@ -942,9 +960,9 @@ float vtkPichonFastMarching::step( void )
 
   min=removeSmallest();
   
-  if( node[min.nodeIndex].T>=INF )
+  if( nodeT[min.nodeIndex]>=INF )
     {
-      vtkErrorMacro( " node[min.nodeIndex].T>=INF " << endl );      
+      vtkErrorMacro( " nodeT[min.nodeIndex]>=INF " << endl );      
 
       // this would happen if the only points left were artificially put back
       // by the user playing with the slider
@@ -959,7 +977,7 @@ float vtkPichonFastMarching::step( void )
   pdfIntensityIn->addRealization( I );
   pdfInhomoIn->addRealization( H );
 
-  node[min.nodeIndex].status=fmsKNOWN;
+  nodeStatus[min.nodeIndex]=fmsKNOWN;
   knownPoints.push_back(min.nodeIndex);
       
   /* then we consider all the neighbors */
@@ -977,34 +995,34 @@ float vtkPichonFastMarching::step( void )
        * If they are fmsFAR, recompute their crossing times, and move 
        * them into fmsTRIAL.
        */
-      if( node[indexN].status==fmsFAR )
+      if( nodeStatus[indexN]==fmsFAR )
     {
       FMleaf f;
-      node[indexN].T=computeT(indexN);
+      nodeT[indexN]=computeT(indexN);
       f.nodeIndex=indexN;
 
       insert( f );
 
-      node[indexN].status=fmsTRIAL;
+      nodeStatus[indexN]=fmsTRIAL;
     }
-      else if( node[indexN].status==fmsTRIAL )
+      else if( nodeStatus[indexN]==fmsTRIAL )
     {
       float t1,  t2;
-      t1 = node[indexN].T;
+      t1 = nodeT[indexN];
 
-      node[indexN].T=computeT(indexN);
+      nodeT[indexN]=computeT(indexN);
 
-      t2 = node[indexN].T;
+      t2 = nodeT[indexN];
 
       if( t2<t1 )
-          upTree( node[indexN].leafIndex );
+          upTree( nodeLeafIndex[indexN] );
       else
-          downTree( node[indexN].leafIndex );
+          downTree( nodeLeafIndex[indexN] );
 
     }
     }
 
-  return node[min.nodeIndex].T; 
+  return nodeT[min.nodeIndex]; 
 }
 
 float vtkPichonFastMarching::computeT(int index )
@@ -1029,16 +1047,16 @@ float vtkPichonFastMarching::computeT(int index )
 
   double Tij, Txm, Txp, Tym, Typ, Tzm, Tzp, TijNew;
 
-  Tij = node[index].T;
+  Tij = nodeT[index];
 
   /* we know that all neighbors are defined
      because this node is not fmsOUT */
-  Txm = node[index+shiftNeighbor(4)].T;
-  Txp = node[index+shiftNeighbor(2)].T;
-  Tym = node[index+shiftNeighbor(1)].T;
-  Typ = node[index+shiftNeighbor(3)].T;
-  Tzm = node[index+shiftNeighbor(5)].T;
-  Tzp = node[index+shiftNeighbor(6)].T;
+  Txm = nodeT[index+shiftNeighbor(4)];
+  Txp = nodeT[index+shiftNeighbor(2)];
+  Tym = nodeT[index+shiftNeighbor(1)];
+  Typ = nodeT[index+shiftNeighbor(3)];
+  Tzm = nodeT[index+shiftNeighbor(5)];
+  Tzp = nodeT[index+shiftNeighbor(6)];
   
   double Dxm, Dxp, Dym, Dyp, Dzm, Dzp;
 
@@ -1101,10 +1119,10 @@ float vtkPichonFastMarching::computeT(int index )
     for(int n=1;n<=nNeighbors;n++)
       {
     candidateIndex = index + shiftNeighbor(n);
-    if( (node[candidateIndex].status==fmsTRIAL) 
-        || (node[candidateIndex].status==fmsKNOWN) )
+    if( (nodeStatus[candidateIndex]==fmsTRIAL) 
+        || (nodeStatus[candidateIndex]==fmsKNOWN) )
       {
-        candidateT = node[candidateIndex].T + distanceNeighbor(n)/s;
+        candidateT = nodeT[candidateIndex] + distanceNeighbor(n)/s;
 
         if( candidateT<Tij )
           Tij=candidateT;
@@ -1271,7 +1289,9 @@ void vtkPichonFastMarching::unInit( void )
   if(somethingReallyWrong)
     return;
 
-  delete [] node;
+  delete [] nodeT;
+  delete [] nodeStatus;
+  delete [] nodeLeafIndex;
   delete [] inhomo;
   delete [] median;
 
@@ -13,6 +13,7 @@
 #include "vtkPichonFastMarchingPDF.h"
 
 // VTK includes
+#include <vtkCommand.h>
 #include <vtkImageData.h>
 #include <vtkImageToImageFilter.h>
 
@@ -35,20 +36,20 @@
 
 #define GRANULARITY_PROGRESS 20
 
+/// number of children of a leaf of the minheap
+#define HEAP_ARITY 4
+
 ///////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////
 
 typedef enum fmstatus { fmsDONE, fmsKNOWN, fmsTRIAL, fmsFAR, fmsOUT } FMstatus;
 #define MASK_BIT 256
 
-struct FMnode {
-  FMstatus status;
-  float T;
-  int leafIndex;
-};
-
+/// the leaves keep a copy of the arrival time of their node, so that
+/// sifting through the minheap never has to look up the nodes
 struct FMleaf {
   int nodeIndex;
+  float T;
 };
 
 /// these typedef are for tclwrapper...
@@ -69,6 +70,14 @@ public:
       vtkErrorMacro( << s );
     };
 
+  /// Invoked during an evolution in preview mode, when the points known
+  /// so far have been written in the output. A call to SetAbortExecute(1)
+  /// from an observer stops the evolution there.
+  enum
+    {
+      FrontEvent = vtkCommand::UserEvent + 1
+    };
+
   void unInit( void );
 
   void init(int dimX, int dimY, int dimZ, double depth, double dx, double dy, double dz);
@@ -82,6 +91,10 @@ public:
 
   void setNPointsEvolution( int n );
 
+  /// if non zero, the front is shown and FrontEvent invoked
+  /// GRANULARITY_PROGRESS times during each evolution
+  void setPreview( int preview );
+
   void setInData(short* data);
   void setOutData(short* data);
 
@@ -137,7 +150,11 @@ private:
   bool initialized;
   bool firstCall;
 
-  FMnode *node;  /// arrival time and status for all voxels
+  /// arrival time, status and leaf in the minheap for all voxels,
+  /// in separate arrays so that the status checks stay in cache
+  float *nodeT;
+  unsigned char *nodeStatus;
+  int *nodeLeafIndex;
   int *inhomo; /// inhomogeneity 
   int *median; /// medican intensity
 
@@ -175,6 +192,7 @@ private:
   int depth;
   
   int nPointsEvolution;
+  int preview;
   int nPointsBeforeLeakEvolution;
   int nEvolutions;
 
@@ -50,12 +50,32 @@ class MorphologyEffectOptions(Effect.EffectOptions):
     self.fourNeighbors.setToolTip("Do not treat diagonally adjacent voxels as neighbors.")
     self.frame.layout().addWidget(self.fourNeighbors)
     self.widgets.append(self.fourNeighbors)
+    self.sphereNeighbors = qt.QRadioButton("Sphere", self.frame)
+    self.sphereNeighbors.setToolTip("Treat the voxels within a sphere of the iterations as neighbors.")
+    self.frame.layout().addWidget(self.sphereNeighbors)
+    self.widgets.append(self.sphereNeighbors)
+
+    self.iterationsFrame = qt.QFrame(self.frame)
+    self.iterationsFrame.setLayout(qt.QHBoxLayout())
+    self.frame.layout().addWidget(self.iterationsFrame)
+    self.widgets.append(self.iterationsFrame)
+    self.iterationsLabel = qt.QLabel("Iterations:", self.iterationsFrame)
+    self.iterationsLabel.setToolTip("Number of voxel layers to remove or add, all done in one pass.")
+    self.iterationsFrame.layout().addWidget(self.iterationsLabel)
+    self.widgets.append(self.iterationsLabel)
+    self.iterationsSpinBox = qt.QSpinBox(self.iterationsFrame)
+    self.iterationsSpinBox.setToolTip("Number of voxel layers to remove or add, all done in one pass.")
+    self.iterationsSpinBox.minimum = 1
+    self.iterationsSpinBox.maximum = 100
+    self.iterationsFrame.layout().addWidget(self.iterationsSpinBox)
+    self.widgets.append(self.iterationsSpinBox)
 
     # TODO: fill option not yet supported
-    # TODO: iterations option not yet supported
 
     self.connections.append( (self.eightNeighbors, 'clicked()', self.updateMRMLFromGUI) )
     self.connections.append( (self.fourNeighbors, 'clicked()', self.updateMRMLFromGUI) )
+    self.connections.append( (self.sphereNeighbors, 'clicked()', self.updateMRMLFromGUI) )
+    self.connections.append( (self.iterationsSpinBox, 'valueChanged(int)', self.onIterationsChanged) )
 
   def destroy(self):
     super(MorphologyEffectOptions,self).destroy()
@@ -97,14 +117,17 @@ class MorphologyEffectOptions(Effect.EffectOptions):
     super(MorphologyEffectOptions,self).updateGUIFromMRML(caller,event)
     self.disconnectWidgets()
     neighborMode = self.parameterNode.GetParameter("MorphologyEffect,neighborMode")
-    if neighborMode == '8':
-      self.eightNeighbors.checked = True
-      self.fourNeighbors.checked = False
-    elif neighborMode == '4':
-      self.eightNeighbors.checked = False
-      self.fourNeighbors.checked = True
+    self.eightNeighbors.checked = neighborMode == '8'
+    self.fourNeighbors.checked = neighborMode == '4'
+    self.sphereNeighbors.checked = neighborMode == 'sphere'
+    self.iterationsSpinBox.value = int(self.parameterNode.GetParameter("MorphologyEffect,iterations"))
     self.connectWidgets()
-    # todo: handle iterations and fill options
+    # todo: handle fill option
+
+  def onIterationsChanged(self,value):
+    if self.updatingGUI:
+      return
+    self.updateMRMLFromGUI()
 
   def updateMRMLFromGUI(self):
     disableState = self.parameterNode.GetDisableModifiedEvent()
@@ -112,8 +135,11 @@ class MorphologyEffectOptions(Effect.EffectOptions):
     super(MorphologyEffectOptions,self).updateMRMLFromGUI()
     if self.eightNeighbors.checked:
       self.parameterNode.SetParameter( "MorphologyEffect,neighborMode", "8" )
+    elif self.sphereNeighbors.checked:
+      self.parameterNode.SetParameter( "MorphologyEffect,neighborMode", "sphere" )
     else:
       self.parameterNode.SetParameter( "MorphologyEffect,neighborMode", "4" )
+    self.parameterNode.SetParameter( "MorphologyEffect,iterations", str(self.iterationsSpinBox.value) )
     self.parameterNode.SetDisableModifiedEvent(disableState)
     if not disableState:
       self.parameterNode.InvokePendingModifiedEvent()
@@ -157,6 +183,35 @@ class MorphologyEffectLogic(Effect.EffectLogic):
   def __init__(self,sliceLogic):
     super(MorphologyEffectLogic,self).__init__(sliceLogic)
 
+  def morphology(self,foreground,background,neighborMode,iterations):
+    """set the foreground voxels that are within iterations
+    neighbors of a background voxel to background, in one pass
+    whatever the number of iterations"""
+
+    morphology = slicer.vtkImageMorphology()
+    morphology.SetInput( self.getScopedLabelInput() )
+    morphology.SetOutput( self.getScopedLabelOutput() )
+
+    morphology.SetForeground( foreground )
+    morphology.SetBackground( background )
+    morphology.SetRadius( iterations )
+
+    if neighborMode == '8':
+      morphology.SetStructuringElementToBox()
+    elif neighborMode == '4':
+      morphology.SetStructuringElementToCross()
+    elif neighborMode == 'sphere':
+      morphology.SetStructuringElementToSphere()
+    else:
+      # TODO: error feedback from effect logic?
+      # bad neighbor mode - silently use default
+      print('Bad neighborMode: %s' % neighborMode)
+
+    morphology.Update()
+
+    self.applyScopedLabel()
+    morphology.SetOutput( None )
+
 #
 # The MorphologyEffect class definition 
 #
@@ -111,10 +111,16 @@ class PaintEffectOptions(LabelEffect.LabelEffectOptions):
     self.frame.layout().addWidget(self.pixelMode)
     self.widgets.append(self.pixelMode)
 
+    self.sphere = qt.QCheckBox("Sphere", self.frame)
+    self.sphere.setToolTip("Paint a 3D sphere of the selected radius instead of a circle in the slice.")
+    self.frame.layout().addWidget(self.sphere)
+    self.widgets.append(self.sphere)
+
     EditorLib.HelpButton(self.frame, "Use this tool to paint with a round brush of the selected radius")
 
     self.connections.append( (self.smudge, 'clicked()', self.updateMRMLFromGUI) )
     self.connections.append( (self.pixelMode, 'clicked()', self.updateMRMLFromGUI) )
+    self.connections.append( (self.sphere, 'clicked()', self.updateMRMLFromGUI) )
     self.connections.append( (self.radius, 'valueChanged(double)', self.onRadiusValueChanged) )
     self.connections.append( (self.radiusSpinBox, 'valueChanged(double)', self.onRadiusSpinBoxChanged) )
 
@@ -146,6 +152,7 @@ class PaintEffectOptions(LabelEffect.LabelEffectOptions):
       ("radius", "5"),
       ("smudge", "0"),
       ("pixelMode", "0"),
+      ("sphere", "0"),
     )
     for d in defaults:
       param = "PaintEffect,"+d[0]
@@ -155,7 +162,7 @@ class PaintEffectOptions(LabelEffect.LabelEffectOptions):
     self.parameterNode.SetDisableModifiedEvent(disableState)
 
   def updateGUIFromMRML(self,caller,event):
-    params = ("radius", "smudge", "pixelMode")
+    params = ("radius", "smudge", "pixelMode", "sphere")
     for p in params:
       if self.parameterNode.GetParameter("PaintEffect,"+p) == '':
         # don't update if the parameter node has not got all values yet
@@ -166,6 +173,9 @@ class PaintEffectOptions(LabelEffect.LabelEffectOptions):
     self.smudge.setChecked( smudge )
     pixelMode = not (0 == int(self.parameterNode.GetParameter("PaintEffect,pixelMode")))
     self.pixelMode.setChecked( pixelMode )
+    sphere = not (0 == int(self.parameterNode.GetParameter("PaintEffect,sphere")))
+    self.sphere.setChecked( sphere )
+    self.sphere.enabled = not pixelMode
     self.radiusFrame.enabled = not pixelMode
     self.threshold.enabled = not pixelMode
     self.thresholdPaint.enabled = not pixelMode
@@ -177,6 +187,7 @@ class PaintEffectOptions(LabelEffect.LabelEffectOptions):
     for tool in self.tools:
       tool.smudge = smudge
       tool.pixelMode = pixelMode
+      tool.sphere = sphere
       tool.radius = radius
       tool.createGlyph(tool.brush)
     self.connectWidgets()
@@ -241,6 +252,10 @@ class PaintEffectOptions(LabelEffect.LabelEffectOptions):
       self.parameterNode.SetParameter( "PaintEffect,pixelMode", "1" )
     else:
       self.parameterNode.SetParameter( "PaintEffect,pixelMode", "0" )
+    if self.sphere.checked:
+      self.parameterNode.SetParameter( "PaintEffect,sphere", "1" )
+    else:
+      self.parameterNode.SetParameter( "PaintEffect,sphere", "0" )
     self.parameterNode.SetParameter( "PaintEffect,radius", str(self.radius.value) )
     self.parameterNode.SetDisableModifiedEvent(disableState)
     if not disableState:
@@ -270,6 +285,7 @@ class PaintEffectTool(LabelEffect.LabelEffectTool):
     self.parameterNode = self.editUtil.getParameterNode()
     self.smudge = not (0 == int(self.parameterNode.GetParameter("PaintEffect,smudge")))
     self.pixelMode = not (0 == int(self.parameterNode.GetParameter("PaintEffect,pixelMode")))
+    self.sphere = not (0 == int(self.parameterNode.GetParameter("PaintEffect,sphere")))
     self.radius = float(self.parameterNode.GetParameter("PaintEffect,radius"))
 
     # interaction state variables
@@ -277,6 +293,9 @@ class PaintEffectTool(LabelEffect.LabelEffectTool):
     self.paintCoordinates = []
     self.feedbackActors = []
     self.lastRadius = 0
+    self.lastStrokeXY = None
+    self.lastPaintedXY = None
+    self.xyRadius = 1
 
     # scratch variables
     self.rasToXY = vtk.vtkMatrix4x4()
@@ -332,6 +351,8 @@ class PaintEffectTool(LabelEffect.LabelEffectTool):
     # interactor events
     if event == "LeftButtonPressEvent":
       self.actionState = "painting"
+      self.lastStrokeXY = None
+      self.lastPaintedXY = None
       if not self.pixelMode:
         self.cursorOff()
       xy = self.interactor.GetEventPosition()
@@ -397,6 +418,7 @@ class PaintEffectTool(LabelEffect.LabelEffectTool):
 
     if self.pixelMode:
       xyRadius = 0.01
+    self.xyRadius = xyRadius
 
     # make a circle paint brush
     points = vtk.vtkPoints()
@@ -433,8 +455,24 @@ class PaintEffectTool(LabelEffect.LabelEffectTool):
     """
     depending on the delayedPaint mode, either paint the
     given point or queue it up with a marker for later 
-    painting
+    painting.
+    Points that don't move the brush by a pixel are dropped and fast
+    drags are filled so that the stroke has no gaps: points are added
+    every half radius in 2D and the segments between the points are
+    painted in 3D
     """
+    if self.lastStrokeXY and not self.pixelMode:
+      import math
+      lastX, lastY = self.lastStrokeXY
+      distance = math.sqrt( (x - lastX)**2 + (y - lastY)**2 )
+      if distance < 1:
+        return
+      if not self.sphere:
+        steps = int(math.ceil( distance / max(self.xyRadius / 2., 1.) ))
+        for step in xrange(1, steps):
+          self.paintCoordinates.append( (lastX + (x - lastX) * step / float(steps),
+                                         lastY + (y - lastY) * step / float(steps)) )
+    self.lastStrokeXY = (x, y)
     self.paintCoordinates.append( (x, y) )
     if self.delayedPaint and not self.pixelMode:
       self.paintFeedback()
@@ -472,8 +510,15 @@ class PaintEffectTool(LabelEffect.LabelEffectTool):
     for xy in self.paintCoordinates:
       if self.pixelMode:
         self.paintPixel(xy[0], xy[1])
+      elif self.sphere:
+        # a segment from the last painted point, a sphere to start
+        startXY = self.lastPaintedXY
+        if not startXY:
+          startXY = xy
+        self.paintStroke(startXY, xy)
       else:
         self.paintBrush(xy[0], xy[1])
+      self.lastPaintedXY = xy
     self.paintCoordinates = []
     self.paintFeedback()
 
@@ -518,6 +563,55 @@ class PaintEffectTool(LabelEffect.LabelEffectTool):
     labelImage.SetScalarComponentFromFloat(ijk[0],ijk[1],ijk[2],0, paintLabel)
     self.editUtil.markVolumeNodeAsModified(labelNode)
 
+  def paintStroke(self, startXY, endXY):
+    """
+    paint with a sphere that is round in RAS space
+     swept from startXY to endXY, so that the label is
+     painted in 3D and not only in the slice
+     - apply the threshold if selected
+    """
+    sliceLogic = self.sliceWidget.sliceLogic()
+    sliceNode = sliceLogic.GetSliceNode()
+    labelLogic = sliceLogic.GetLabelLayer()
+    labelNode = labelLogic.GetVolumeNode()
+    backgroundLogic = sliceLogic.GetBackgroundLayer()
+    backgroundNode = backgroundLogic.GetVolumeNode()
+
+    if not labelNode:
+      # if there's no label, we can't paint
+      return
+
+    xyToRAS = sliceNode.GetXYToRAS()
+    strokeStart = xyToRAS.MultiplyPoint( (startXY[0], startXY[1], 0, 1) )[:3]
+    brushCenter = xyToRAS.MultiplyPoint( (endXY[0], endXY[1], 0, 1) )[:3]
+
+    parameterNode = self.editUtil.getParameterNode()
+    paintLabel = int(parameterNode.GetParameter("label"))
+    paintOver = int(parameterNode.GetParameter("LabelEffect,paintOver"))
+    paintThreshold = int(parameterNode.GetParameter("LabelEffect,paintThreshold"))
+    paintThresholdMin = float(
+        parameterNode.GetParameter("LabelEffect,paintThresholdMin"))
+    paintThresholdMax = float(
+        parameterNode.GetParameter("LabelEffect,paintThresholdMax"))
+    if not backgroundNode:
+      paintThreshold = 0
+
+    if not hasattr(self,"painter"):
+      self.painter = slicer.vtkImageSlicePaint()
+    if backgroundNode:
+      self.painter.SetBackgroundImage(backgroundNode.GetImageData())
+      self.painter.SetBackgroundIJKToWorld(self.logic.getIJKToRASMatrix(backgroundNode))
+    self.painter.SetWorkingImage(labelNode.GetImageData())
+    self.painter.SetWorkingIJKToWorld(self.logic.getIJKToRASMatrix(labelNode))
+    self.painter.SetStrokeStart( strokeStart[0], strokeStart[1], strokeStart[2] )
+    self.painter.SetBrushCenter( brushCenter[0], brushCenter[1], brushCenter[2] )
+    self.painter.SetBrushRadius( self.radius )
+    self.painter.SetPaintLabel(paintLabel)
+    self.painter.SetPaintOver(paintOver)
+    self.painter.SetThresholdPaint(paintThreshold)
+    self.painter.SetThresholdPaintRange(paintThresholdMin, paintThresholdMax)
+    self.painter.PaintStroke()
+
   def paintBrush(self, x, y):
     """
     paint with a brush that is circular in XY space 
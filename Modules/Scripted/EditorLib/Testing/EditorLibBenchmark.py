@@ -0,0 +1,296 @@
+import os
+import math
+import time
+import unittest
+import vtk
+import slicer
+import vtkITK
+
+class EditorLibBenchmarkTest(unittest.TestCase):
+  """
+  Time the image operations behind the editor effects on synthetic
+  volumes, without views, so that slow downs of the interactive
+  segmentation path show up.  The volume sizes are given by the
+  EDITORLIB_BENCHMARK_SIZES environment variable, for example
+  "256 512 1024" (256 by default).
+  """
+  def setUp(self):
+    self.results = []
+
+  def runTest(self):
+    self.test_EditorLibBenchmark()
+
+  def peakMemory(self):
+    """peak resident memory of the process in MB,
+    or None where it can't be read"""
+    try:
+      import resource
+    except ImportError:
+      return None
+    peak = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+    if os.uname()[0] == 'Darwin':
+      # bytes on mac, kilobytes elsewhere
+      return peak / (1024. * 1024.)
+    return peak / 1024.
+
+  def measure(self, size, name, operation):
+    """run operation and report its time and how much it raised
+    the peak memory of the process"""
+    peakBefore = self.peakMemory()
+    start = time.time()
+    operation()
+    elapsed = time.time() - start
+    peakAfter = self.peakMemory()
+    if peakBefore is None:
+      memory = 'n/a'
+    else:
+      memory = '%.1f MB (+%.1f)' % (peakAfter, peakAfter - peakBefore)
+    print('%-24s %5d^3: %9.3f s  peak memory %s' % (name, size, elapsed, memory))
+    self.results.append( (name, size, elapsed, peakAfter) )
+
+  def makeVolumes(self, size):
+    """a grayscale ball on a darker background and a label map
+    with a smaller ball of label 1 in it"""
+    gray = vtk.vtkImageEllipsoidSource()
+    gray.SetWholeExtent(0, size-1, 0, size-1, 0, size-1)
+    gray.SetCenter(size/2., size/2., size/2.)
+    gray.SetRadius(size/3., size/3., size/3.)
+    gray.SetInValue(200)
+    gray.SetOutValue(50)
+    gray.SetOutputScalarTypeToShort()
+    gray.Update()
+    grayscale = vtk.vtkImageData()
+    grayscale.DeepCopy(gray.GetOutput())
+
+    label = vtk.vtkImageEllipsoidSource()
+    label.SetWholeExtent(0, size-1, 0, size-1, 0, size-1)
+    label.SetCenter(size/2., size/2., size/2.)
+    label.SetRadius(size/8., size/8., size/8.)
+    label.SetInValue(1)
+    label.SetOutValue(0)
+    label.SetOutputScalarTypeToShort()
+    label.Update()
+    labelMap = vtk.vtkImageData()
+    labelMap.DeepCopy(label.GetOutput())
+    return grayscale, labelMap
+
+  def test_EditorLibBenchmark(self):
+    sizes = [int(s) for s in os.environ.get('EDITORLIB_BENCHMARK_SIZES', '256').split()]
+    for size in sizes:
+      self.benchmark(size)
+    self.assertEqual(len(self.results), len(sizes) * 11)
+
+  def benchmark(self, size):
+    grayscale, labelMap = self.makeVolumes(size)
+    identity = vtk.vtkMatrix4x4()
+    center = size / 2.
+
+    #
+    # paint: one 3D stroke across the volume
+    #
+    painted = vtk.vtkImageData()
+    painted.DeepCopy(labelMap)
+    def paintStroke():
+      painter = slicer.vtkImageSlicePaint()
+      painter.SetWorkingImage(painted)
+      painter.SetWorkingIJKToWorld(identity)
+      painter.SetStrokeStart(size / 4., center, center)
+      painter.SetBrushCenter(3. * size / 4., center, center)
+      painter.SetBrushRadius(size / 16.)
+      painter.SetPaintLabel(2)
+      painter.SetPaintOver(1)
+      painter.PaintStroke()
+    self.measure(size, 'Paint stroke', paintStroke)
+
+    #
+    # draw: fill a polygon of 360 points in a slice
+    #
+    def draw():
+      points = vtk.vtkPoints()
+      for step in xrange(360):
+        angle = math.radians(step)
+        points.InsertNextPoint(center + size / 3. * math.cos(angle),
+                               center + size / 3. * math.sin(angle), 0)
+      imageData = vtk.vtkImageData()
+      imageData.SetDimensions(size, size, 1)
+      imageData.SetScalarTypeToShort()
+      imageData.AllocateScalars()
+      fill = slicer.vtkImageFillROI()
+      fill.SetInput(imageData)
+      fill.SetValue(1)
+      fill.SetPoints(points)
+      fill.GetOutput().Update()
+    self.measure(size, 'Draw (fill ROI)', draw)
+
+    #
+    # draw: fill the contours interpolated between two slices, only
+    # where the grayscale is in the threshold range
+    #
+    def drawSlices():
+      fill = slicer.vtkImageFillROI()
+      fill.SetInput(labelMap)
+      fill.SetValue(1)
+      for slice, radius in ((size / 4, size / 8.), (3 * size / 4, size / 3.)):
+        points = vtk.vtkPoints()
+        for step in xrange(360):
+          angle = math.radians(step)
+          points.InsertNextPoint(center + radius * math.cos(angle),
+                                 center + radius * math.sin(angle), slice)
+        fill.AddSliceContour(slice, points)
+      fill.InterpolateSliceContoursOn()
+      fill.SetThresholdImage(grayscale)
+      fill.SetThresholdRange(100, 300)
+      fill.GetOutput().Update()
+    self.measure(size, 'Draw slices (fill ROI)', drawSlices)
+
+    #
+    # threshold the grayscale into a label map
+    #
+    def threshold():
+      thresh = slicer.vtkImageThresholdLabel()
+      thresh.SetInput(grayscale)
+      thresh.ThresholdBetween(100, 300)
+      thresh.SetInValue(1)
+      thresh.SetOutValue(0)
+      thresh.SetOutputScalarType(labelMap.GetScalarType())
+      thresh.Update()
+    self.measure(size, 'Threshold', threshold)
+
+    #
+    # grow cut from the label ball and a background seed
+    #
+    def growCut():
+      gestures = vtk.vtkImageData()
+      gestures.DeepCopy(labelMap)
+      gestures.SetScalarComponentFromDouble(0, 0, 0, 0, 2)
+      output = vtk.vtkImageData()
+      output.DeepCopy(gestures)
+      growCutFilter = vtkITK.vtkITKGrowCutSegmentationImageFilter()
+      growCutFilter.SetInput(0, grayscale)
+      growCutFilter.SetInput(1, gestures)
+      growCutFilter.SetInput(2, output)
+      growCutFilter.SetObjectSize(10)
+      growCutFilter.SetContrastNoiseRatio(0.8)
+      growCutFilter.SetPriorSegmentConfidence(0.003)
+      growCutFilter.Update()
+    self.measure(size, 'GrowCut', growCut)
+
+    #
+    # fast marching from the label ball over 1% of the volume
+    #
+    def fastMarching():
+      fm = slicer.vtkPichonFastMarching()
+      scalarRange = grayscale.GetScalarRange()
+      fm.init(size, size, size, int(scalarRange[1] - scalarRange[0]), 1, 1, 1)
+      fm.SetInput(grayscale)
+      fm.setNPointsEvolution(size * size * size / 100)
+      fm.setActiveLabel(1)
+      fm.addSeedsFromImage(labelMap)
+      fm.Update()
+      fm.show(1)
+      fm.Modified()
+      fm.Update()
+    self.measure(size, 'FastMarching', fastMarching)
+
+    #
+    # islands: identify them all, then remove the small ones
+    #
+    def identifyIslands():
+      castIn = vtk.vtkImageCast()
+      castIn.SetInput(painted)
+      castIn.SetOutputScalarTypeToUnsignedLong()
+      islandMath = vtkITK.vtkITKIslandMath()
+      islandMath.SetInput(castIn.GetOutput())
+      islandMath.SetFullyConnected(0)
+      islandMath.SetMinimumSize(0)
+      islandMath.Update()
+    self.measure(size, 'Identify islands', identifyIslands)
+
+    def removeIslands():
+      connectivity = slicer.vtkImageConnectivity()
+      connectivity.SetFunctionToRemoveIslands()
+      connectivity.SetInput(painted)
+      connectivity.SetMinSize(100)
+      connectivity.SetBackground(0)
+      connectivity.SetMinForeground(1)
+      connectivity.SetMaxForeground(2)
+      connectivity.Update()
+    self.measure(size, 'Remove islands', removeIslands)
+
+    #
+    # morphology with a large radius
+    #
+    def dilate():
+      morphology = slicer.vtkImageMorphology()
+      morphology.SetInput(labelMap)
+      morphology.SetForeground(0)
+      morphology.SetBackground(1)
+      morphology.SetRadius(size / 32)
+      morphology.SetStructuringElementToSphere()
+      morphology.Update()
+    self.measure(size, 'Dilate', dilate)
+
+    #
+    # undo/redo: checkpoint the paint stroke, then undo and redo it
+    #
+    diff = slicer.vtkImageRegionDiff()
+    self.measure(size, 'Undo checkpoint',
+                 lambda: diff.Compute(labelMap, painted))
+    self.measure(size, 'Undo', lambda: diff.ApplyBefore(painted))
+    self.measure(size, 'Redo', lambda: diff.ApplyAfter(painted))
+
+#
+# EditorLibBenchmark
+#
+
+class EditorLibBenchmark:
+  """
+  This class is the 'hook' for slicer to detect and recognize the test
+  as a loadable scripted module (with a hidden interface)
+  """
+  def __init__(self, parent):
+    parent.title = "EditorLibBenchmark"
+    parent.categories = ["Testing"]
+    parent.contributors = ["Slicer developers"]
+    parent.helpText = """
+    Latency benchmark of the editor operations.
+    No module interface here, only used in SelfTests module
+    """
+    parent.acknowledgementText = """
+    """
+
+    # don't show this module
+    parent.hidden = True
+
+    # Add this test to the SelfTest module's list for discovery when the module
+    # is created.  Since this module may be discovered before SelfTests itself,
+    # create the list if it doesn't already exist.
+    try:
+      slicer.selfTests
+    except AttributeError:
+      slicer.selfTests = {}
+    slicer.selfTests['EditorLibBenchmark'] = self.runTest
+
+  def runTest(self):
+    tester = EditorLibBenchmarkTest()
+    tester.setUp()
+    tester.runTest()
+
+
+#
+# EditorLibBenchmarkWidget
+#
+
+class EditorLibBenchmarkWidget:
+  def __init__(self, parent = None):
+    self.parent = parent
+
+  def setup(self):
+    # don't display anything for this widget - it will be hidden anyway
+    pass
+
+  def enter(self):
+    pass
+
+  def exit(self):
+    pass
@@ -210,9 +210,7 @@ class ThresholdEffectTool(Effect.EffectTool):
     self.max = 0
 
     # class instances
-    self.lut = None
     self.thresh = None
-    self.map = None
 
     # feedback actor
     self.cursorDummyImage = vtk.vtkImageData()
@@ -249,19 +247,38 @@ class ThresholdEffectTool(Effect.EffectTool):
 
     if not self.editUtil.getBackgroundImage() or not self.editUtil.getLabelImage():
       return
-    node = self.editUtil.getParameterNode()
-
-    self.undoRedo.saveState()
 
-    thresh = vtk.vtkImageThreshold()
+    #
+    # threshold the whole background in threads, the progress dialog
+    # is updated (and can cancel the operation) from the progress events
+    #
+    thresh = slicer.vtkImageThresholdLabel()
     thresh.SetInput( self.editUtil.getBackgroundImage() )
     thresh.ThresholdBetween(self.min, self.max)
     thresh.SetInValue( self.editUtil.getLabel() )
     thresh.SetOutValue( 0 )
     thresh.SetOutputScalarType( self.editUtil.getLabelImage().GetScalarType() )
-    # $this setProgressFilter $thresh "Threshold"
+
+    progress = qt.QProgressDialog(slicer.util.mainWindow())
+    progress.setWindowModality(qt.Qt.WindowModal)
+    progress.minimumDuration = 500
+    progress.setLabelText("Threshold")
+    progress.setMaximum(100)
+    def onProgress(caller, event):
+      progress.setValue(int(100 * caller.GetProgress()))
+      slicer.app.processEvents()
+      if progress.wasCanceled:
+        caller.SetAbortExecute(1)
+    progressTag = thresh.AddObserver(vtk.vtkCommand.ProgressEvent, onProgress)
     thresh.Update()
+    thresh.RemoveObserver(progressTag)
+    canceled = progress.wasCanceled
+    progress.close()
+    if canceled:
+      # leave the label map as it was
+      return
 
+    self.undoRedo.saveState()
     self.editUtil.getLabelImage().DeepCopy( thresh.GetOutput() )
     self.editUtil.markVolumeNodeAsModified(self.editUtil.getLabelVolume())
 
@@ -271,44 +288,30 @@ class ThresholdEffectTool(Effect.EffectTool):
       return
 
     #
-    # make a lookup table where inside the threshold is opaque and colored
-    # by the label color, while the background is transparent (black)
+    # color the pixels inside the threshold with the label color, while
+    # the background is transparent (black)
     # - apply the threshold operation to the currently visible background
-    #   (output of the layer logic's vtkImageReslice instance)
+    #   (output of the layer logic's vtkImageReslice instance), in a
+    #   single pass straight to RGBA: the slice is not resliced again
+    #   and only the threshold pass runs when the color pulses
     #
 
     if not color:
       color = self.getPaintColor
 
-    if not self.lut:
-      self.lut = vtk.vtkLookupTable()
-
-    self.lut.SetRampToLinear()
-    self.lut.SetNumberOfTableValues( 2 )
-    self.lut.SetTableRange( 0, 1 )
-    self.lut.SetTableValue( 0,  0, 0, 0,  0 )
-    r,g,b,a = color
-    self.lut.SetTableValue( 1,  r, g, b,  a )
-
-    if not self.map:
-      self.map = vtk.vtkImageMapToRGBA()
-    self.map.SetOutputFormatToRGBA()
-    self.map.SetLookupTable( self.lut )
-
     if not self.thresh:
-      self.thresh = vtk.vtkImageThreshold()
+      self.thresh = slicer.vtkImageThresholdLabel()
+      self.thresh.PreviewOn()
     sliceLogic = self.sliceWidget.sliceLogic()
     backgroundLogic = sliceLogic.GetBackgroundLayer()
     self.thresh.SetInput( backgroundLogic.GetReslice().GetOutput() )
     self.thresh.ThresholdBetween( self.min, self.max )
-    self.thresh.SetInValue( 1 )
-    self.thresh.SetOutValue( 0 )
-    self.thresh.SetOutputScalarTypeToUnsignedChar()
-    self.map.SetInput( self.thresh.GetOutput() )
+    r,g,b,a = color
+    self.thresh.SetPreviewColor( r, g, b, a )
 
-    self.map.Update()
+    self.thresh.Update()
 
-    self.cursorMapper.SetInput( self.map.GetOutput() )
+    self.cursorMapper.SetInput( self.thresh.GetOutput() )
     self.cursorActor.VisibilityOn()
 
     self.sliceView.scheduleRender()
@@ -271,7 +271,7 @@ class WandEffectLogic(LabelEffect.LabelEffectLogic):
     #
     # Get the numpy array for the bg and label
     #
-    import vtk.util.numpy_support, numpy
+    import vtk.util.numpy_support, numpy, collections
     backgroundImage = backgroundNode.GetImageData()
     labelImage = labelNode.GetImageData()
     shape = list(backgroundImage.GetDimensions())
@@ -313,7 +313,8 @@ class WandEffectLogic(LabelEffect.LabelEffectLogic):
       lo = value - tolerance
       hi = value + tolerance
     pixelsSet = 0
-    toVisit = [ijk,]
+    # a deque so that the pixels are visited in constant time
+    toVisit = collections.deque([ijk,])
     # Create a map that contains the location of the pixels
     # that have been already visited (added or considered to be added).
     # This is required if paintOver is enabled because then we reconsider
@@ -321,8 +322,8 @@ class WandEffectLogic(LabelEffect.LabelEffectLogic):
     if paintOver:
       labelDrawVisitedArray = numpy.zeros(labelDrawArray.shape,dtype='bool')
 
-    while toVisit != []:
-      location = toVisit.pop(0)
+    while toVisit:
+      location = toVisit.popleft()
       try:
         l = labelDrawArray[location]
         b = backgroundDrawArray[location]
@@ -347,7 +348,7 @@ class WandEffectLogic(LabelEffect.LabelEffectLogic):
         # only count those pixels that were changed (to allow step-by-step growing by multiple mouse clicks)
         pixelsSet += 1
       if pixelsSet > maxPixels:
-        toVisit = []
+        toVisit.clear()
       else:
         if self.fillMode == 'Plane':
           # add the 4 neighbors to the stack
@@ -37,6 +37,7 @@ class EndoscopyWidget:
     self.transform = None
     self.path = None
     self.camera = None
+    self.flythrough = None
     self.skip = 0
     self.timer = qt.QTimer()
     self.timer.setInterval(20)
@@ -124,6 +125,16 @@ class EndoscopyWidget:
     frameDelaySlider.value = 20
     flythroughFormLayout.addRow("Frame delay:", frameDelaySlider)
     
+    # Slice update slider
+    sliceUpdateSlider = ctk.ctkSliderWidget()
+    sliceUpdateSlider.connect('valueChanged(double)', self.sliceUpdateSliderValueChanged)
+    sliceUpdateSlider.decimals = 0
+    sliceUpdateSlider.minimum = 0
+    sliceUpdateSlider.maximum = 50
+    sliceUpdateSlider.suffix = " frames"
+    sliceUpdateSlider.toolTip = "Move the slices to the camera every N frames, never if 0."
+    flythroughFormLayout.addRow("Slice update:", sliceUpdateSlider)
+    
     # View angle slider
     viewAngleSlider = ctk.ctkSliderWidget()
     viewAngleSlider.connect('valueChanged(double)', self.viewAngleSliderValueChanged)
@@ -148,6 +159,7 @@ class EndoscopyWidget:
     self.createPathButton = createPathButton
     self.flythroughCollapsibleButton = flythroughCollapsibleButton
     self.frameSlider = frameSlider
+    self.sliceUpdateSlider = sliceUpdateSlider
     self.viewAngleSlider = viewAngleSlider
     self.playButton = playButton
   
@@ -171,6 +183,8 @@ class EndoscopyWidget:
       
     self.cameraNode = newCameraNode
     self.camera = newCamera
+    if self.flythrough:
+      self.flythrough.SetCameraNode(newCameraNode)
     
     # Update UI
     self.updateWidgetFromMRML()
@@ -215,6 +229,17 @@ class EndoscopyWidget:
     self.transform = model.transform
     self.path = result.path
     
+    # The camera track is computed once, the flythrough only copies poses
+    if hasattr(slicer, 'vtkSlicerCameraFlythrough'):
+      points = vtk.vtkPoints()
+      for point in result.path:
+        points.InsertNextPoint(*point)
+      self.flythrough = slicer.vtkSlicerCameraFlythrough()
+      self.flythrough.SetCameraNode(self.cameraNode)
+      self.flythrough.SetTransformNode(self.transform)
+      self.flythrough.SetSliceUpdateInterval(int(self.sliceUpdateSlider.value))
+      self.flythrough.SetPath(points)
+    
     # Enable / Disable flythrough button
     self.flythroughCollapsibleButton.enabled = len(result.path) > 0
     
@@ -230,6 +255,10 @@ class EndoscopyWidget:
     #print "frameDelaySliderValueChanged:", newValue
     self.timer.interval = newValue
     
+  def sliceUpdateSliderValueChanged(self, newValue):
+    if self.flythrough:
+      self.flythrough.SetSliceUpdateInterval(int(newValue))
+    
   def viewAngleSliderValueChanged(self, newValue):
     if not self.cameraNode:
       return
@@ -245,6 +274,12 @@ class EndoscopyWidget:
       self.playButton.text = "Play"
   
   def flyToNext(self):
+    # Don't move the camera faster than the 3D view is rendered
+    layoutManager = slicer.app.layoutManager()
+    if layoutManager and layoutManager.threeDViewCount > 0:
+      threeDView = layoutManager.threeDWidget(0).threeDView()
+      if layoutManager.renderScheduler().isRenderPending(threeDView):
+        return
     currentStep = self.frameSlider.value
     nextStep = currentStep + self.skip + 1
     if nextStep > len(self.path) - 2:
@@ -254,6 +289,9 @@ class EndoscopyWidget:
   def flyTo(self, f):
     """ Apply the fth step in the path to the global camera"""
     f = int(f)
+    if self.flythrough:
+      self.flythrough.SetFrame(f)
+      return
     p = self.path[f]
     self.camera.SetPosition(*p)
     foc = self.path[f+1]
@@ -281,6 +281,16 @@ with point index of {pointIndex}
                self.sysInfo.GetAvailableVirtualMemory(),
                self.sysInfo.GetTotalVirtualMemory(),
                ))
+      slicePipelines = 0
+      sliceLogics = slicer.app.applicationLogic().GetSliceLogics()
+      for i in xrange(sliceLogics.GetNumberOfItems()):
+        slicePipelines += sliceLogics.GetItemAsObject(i).GetPipelineMemorySize()
+      self.sysInfoWindow.append('nodes: %d KB,  scene views: %d KB,  undo: %d KB,  slices: %d KB' %
+              (slicer.mrmlScene.GetNodesMemorySize(),
+               slicer.mrmlScene.GetSceneViewsMemorySize(),
+               slicer.mrmlScene.GetUndoStackDataMemorySize(),
+               slicePipelines,
+               ))
       qt.QTimer.singleShot(1000,self.memoryCallback)
 
   def memoryCheck(self):
@@ -118,9 +118,30 @@ class SampleDataWidget:
 #
 
 class SampleDataLogic:
+  """Download the sample data into the cache.
+
+  Downloads can run in parallel (downloadFiles), partial files are resumed
+  with HTTP Range requests, and files are checked against their SHA-256
+  checksum: from the manifest if one is loaded (loadManifest), otherwise
+  the one recorded in the cache when the file was first downloaded.
+  """
+  # number of files downloaded at the same time
+  maximumParallelDownloads = 4
+  # checksums recorded for the files downloaded into a folder
+  checksumsFileName = '.SampleDataChecksums.json'
+
   def __init__(self, logMessage=None):
     if logMessage:
       self.logMessage = logMessage
+    # file name -> 'sha256:<hex digest>'
+    self.manifest = {}
+
+  def loadManifest(self, manifestFilePath):
+    """Load the expected checksums of the files from a JSON file mapping
+    the file names to 'sha256:<hex digest>'."""
+    import json
+    with open(manifestFilePath) as manifestFile:
+      self.manifest.update(json.load(manifestFile))
 
   def logMessage(self,message):
     print(message)
@@ -154,20 +175,26 @@ class SampleDataLogic:
     return self.loadVolume(filePath, 'BaselineVolume')
 
   def downloadWhiteMatterExplorationDTIVolume(self):
-    self.downloadFileIntoCache('http://slicer.kitware.com/midas3/download/?items=2011,1', 'DTIVolume.raw.gz')
-    filePath = self.downloadFileIntoCache('http://slicer.kitware.com/midas3/download/?items=2010,1', 'DTIVolume.nhdr')
-    return self.loadVolume(filePath, 'DTIVolume');
+    filePaths = self.downloadFilesIntoCache((
+      ('http://slicer.kitware.com/midas3/download/?items=2011,1', 'DTIVolume.raw.gz'),
+      ('http://slicer.kitware.com/midas3/download/?items=2010,1', 'DTIVolume.nhdr')))
+    return self.loadVolume(filePaths[1], 'DTIVolume');
 
   def downloadDiffusionMRIDWIVolume(self):
-    self.downloadFileIntoCache('http://slicer.kitware.com/midas3/download/?items=2142,1', 'dwi.raw.gz')
-    filePath = self.downloadFileIntoCache('http://slicer.kitware.com/midas3/download/?items=2141,1', 'dwi.nhdr')
-    return self.loadVolume(filePath, 'dwi');
+    filePaths = self.downloadFilesIntoCache((
+      ('http://slicer.kitware.com/midas3/download/?items=2142,1', 'dwi.raw.gz'),
+      ('http://slicer.kitware.com/midas3/download/?items=2141,1', 'dwi.nhdr')))
+    return self.loadVolume(filePaths[1], 'dwi');
 
   def downloadAbdominalCTVolume(self):
     filePath = self.downloadFileIntoCache('http://slicer.kitware.com/midas3/download/?items=9073,1', 'Panoramix-cropped.nrrd')
     return self.loadVolume(filePath, 'Panoramix-cropped');
 
   def downloadDentalSurgery(self):
+    # download both volumes at once, loading them only finds them in the cache
+    self.downloadFilesIntoCache((
+      ('http://slicer.kitware.com/midas3/download/item/94510/Greyscale_presurg.gipl.gz', 'PreDentalSurgery.gipl.gz'),
+      ('http://slicer.kitware.com/midas3/download/item/94509/Greyscale_postsurg.gipl.gz', 'PostDentalSurgery.gipl.gz')))
     pre = self.downloadPreDentalSurgery()
     post = self.downloadPostDentalSurgery()
     return pre,post
@@ -180,9 +207,14 @@ class SampleDataLogic:
     filePath = self.downloadFileIntoCache('http://slicer.kitware.com/midas3/download/item/94509/Greyscale_postsurg.gipl.gz', 'PostDentalSurgery.gipl.gz')
     return self.loadVolume(filePath, 'PostDentalSurgery');
 
-  def downloadFileIntoCache(self, uri, name):
+  def downloadFileIntoCache(self, uri, name, checksum=None):
+    return self.downloadFilesIntoCache(((uri, name, checksum),))[0]
+
+  def downloadFilesIntoCache(self, files):
+    """Download the (uri, name[, checksum]) files into the cache at the same
+    time and return their paths."""
     destFolderPath = slicer.mrmlScene.GetCacheManager().GetRemoteCacheDirectory()
-    return self.downloadFile(uri, destFolderPath, name)
+    return self.downloadFiles([(f[0], destFolderPath, f[1], f[2] if len(f) > 2 else None) for f in files])
 
   def humanFormatSize(self,size):
     """ from http://stackoverflow.com/questions/1094841/reusable-library-to-get-human-readable-version-of-file-size"""
@@ -192,29 +224,144 @@ class SampleDataLogic:
       size /= 1024.0
     return "%3.1f%s" % (size, 'TB')
 
-  def reportHook(self,blocksSoFar,blockSize,totalSize):
-    percent = int((100. * blocksSoFar * blockSize) / totalSize)
-    if percent == 100 or (percent - self.downloadPercent >= 10):
-      humanSizeSoFar = self.humanFormatSize(blocksSoFar * blockSize)
-      humanSizeTotal = self.humanFormatSize(totalSize)
-      self.logMessage('<i>Downloaded %s (%d%% of %s)...</i>' % (humanSizeSoFar, percent, humanSizeTotal))
-      self.downloadPercent = percent
-
-  def downloadFile(self, uri, destFolderPath, name):
-    filePath = destFolderPath + '/' + name
-    if not os.path.exists(filePath) or os.stat(filePath).st_size == 0:
-      import urllib
+  def fileChecksum(self, filePath):
+    import hashlib
+    sha256 = hashlib.sha256()
+    with open(filePath, 'rb') as f:
+      for chunk in iter(lambda: f.read(1024 * 1024), ''):
+        sha256.update(chunk)
+    return 'sha256:' + sha256.hexdigest()
+
+  def loadChecksums(self, destFolderPath):
+    import json
+    try:
+      with open(os.path.join(destFolderPath, self.checksumsFileName)) as checksumsFile:
+        return json.load(checksumsFile)
+    except (IOError, ValueError):
+      return {}
+
+  def saveChecksums(self, destFolderPath, checksums):
+    import json
+    try:
+      with open(os.path.join(destFolderPath, self.checksumsFileName), 'w') as checksumsFile:
+        json.dump(checksums, checksumsFile, indent=2, sort_keys=True)
+    except IOError as e:
+      self.logMessage('<b><font color="red">\tFailed to save the checksums: %s</font></b>' % e)
+
+  def downloadFile(self, uri, destFolderPath, name, checksum=None):
+    return self.downloadFiles(((uri, destFolderPath, name, checksum),))[0]
+
+  def downloadFiles(self, files):
+    """Download the (uri, destFolderPath, name, checksum) files, at most
+    maximumParallelDownloads at the same time, and return their paths.
+    A cached file is reused if it matches its checksum (the given one,
+    the manifest one or the one recorded when it was downloaded), a file
+    without checksum is resumed as it may be a partial download."""
+    import threading
+    import Queue
+    cacheManager = slicer.mrmlScene.GetCacheManager()
+    cacheFolderPath = cacheManager.GetRemoteCacheDirectory()
+    folderChecksums = {}
+    filePaths = []
+    downloads = []
+    for uri, destFolderPath, name, checksum in files:
+      filePath = destFolderPath + '/' + name
+      filePaths.append(filePath)
+      if destFolderPath not in folderChecksums:
+        folderChecksums[destFolderPath] = self.loadChecksums(destFolderPath)
+      expectedChecksum = checksum or self.manifest.get(name) or folderChecksums[destFolderPath].get(name)
+      if os.path.exists(filePath) and expectedChecksum:
+        if self.fileChecksum(filePath) == expectedChecksum:
+          self.logMessage('<b>File already exists in cache - reusing it.</b>')
+          if destFolderPath == cacheFolderPath:
+            cacheManager.TouchCachedFile(filePath)
+          continue
+        self.logMessage('<b>Cached file %s does not match its checksum - downloading it again.</b>' % name)
+        os.remove(filePath)
       self.logMessage('<b>Requesting download</b> <i>%s</i> from %s...\n' % (name, uri))
-      # add a progress bar
-      self.downloadPercent = 0
+      downloads.append({'uri': uri, 'folder': destFolderPath, 'name': name,
+                        'filePath': filePath, 'checksum': expectedChecksum})
+
+    # the threads only download, messages are logged from here
+    messages = Queue.Queue()
+    slots = threading.BoundedSemaphore(self.maximumParallelDownloads)
+    def download(task):
+      with slots:
+        self.downloadTask(task, messages)
+    threads = [threading.Thread(target=download, args=(task,)) for task in downloads]
+    for thread in threads:
+      thread.start()
+    while threads:
+      threads[0].join(0.1)
+      threads = [thread for thread in threads if thread.isAlive()]
+      while not messages.empty():
+        self.logMessage(messages.get())
+    while not messages.empty():
+      self.logMessage(messages.get())
+
+    for task in downloads:
+      if task['error'] is None:
+        downloadedChecksum = self.fileChecksum(task['filePath'])
+        if task['checksum'] and downloadedChecksum != task['checksum']:
+          task['error'] = 'checksum mismatch'
+          os.remove(task['filePath'])
+      if task['error'] is not None:
+        self.logMessage('<b><font color="red">\tDownload of %s failed: %s</font></b>' % (task['name'], task['error']))
+        continue
+      self.logMessage('<b>Download finished</b>')
+      folderChecksums[task['folder']][task['name']] = downloadedChecksum
+      if task['folder'] == cacheFolderPath:
+        # index the file, identical content is stored once
+        cacheManager.AddCachedFile(task['uri'], task['filePath'])
+    for destFolderPath in set([task['folder'] for task in downloads]):
+      self.saveChecksums(destFolderPath, folderChecksums[destFolderPath])
+    return filePaths
+
+  def downloadTask(self, task, messages):
+    """Download (or resume) the file of the task, put the progress in the
+    messages queue and set task['error'] on failure."""
+    import urllib2
+    task['error'] = None
+    filePath = task['filePath']
+    start = os.path.getsize(filePath) if os.path.exists(filePath) else 0
+    request = urllib2.Request(task['uri'])
+    if start > 0:
+      request.add_header('Range', 'bytes=%d-' % start)
+    try:
       try:
-        urllib.urlretrieve(uri, filePath, self.reportHook)
-        self.logMessage('<b>Download finished</b>')
-      except IOError as e:
-        self.logMessage('<b><font color="red">\tDownload failed: %s</font></b>' % e)
-    else:
-      self.logMessage('<b>File already exists in cache - reusing it.</b>')
-    return filePath
+        response = urllib2.urlopen(request)
+      except urllib2.HTTPError as e:
+        if e.code == 416 and start > 0:
+          # nothing left to download
+          return
+        raise
+      if start > 0 and response.getcode() == 206:
+        messages.put('<i>Resuming download of %s at %s...</i>' % (task['name'], self.humanFormatSize(start)))
+        mode = 'ab'
+      else:
+        start = 0
+        mode = 'wb'
+      contentLength = response.info().getheader('Content-Length')
+      totalSize = start + int(contentLength) if contentLength else None
+      received = start
+      reportedPercent = 0
+      with open(filePath, mode) as f:
+        while True:
+          chunk = response.read(256 * 1024)
+          if not chunk:
+            break
+          f.write(chunk)
+          received += len(chunk)
+          if totalSize:
+            percent = int((100. * received) / totalSize)
+            if percent == 100 or percent - reportedPercent >= 10:
+              messages.put('<i>Downloaded %s (%d%% of %s) of %s...</i>' % (
+                self.humanFormatSize(received), percent, self.humanFormatSize(totalSize), task['name']))
+              reportedPercent = percent
+      if totalSize is not None and received != totalSize:
+        task['error'] = 'incomplete download, %d of %d bytes' % (received, totalSize)
+    except (IOError, ValueError) as e:
+      task['error'] = str(e)
 
   def loadVolume(self, uri, name):
     self.logMessage('<b>Requesting load</b> <i>%s</i> from %s...\n' % (name, uri))